@@ -0,0 +1,607 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+// Benchmarks animation runtime jobs.
+
+#include "benchmark.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/feature_database_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/raw_track.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/offline/skeleton_lod_builder.h"
+#include "ozz/animation/offline/synthetic_generator.h"
+#include "ozz/animation/offline/track_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/feature_database.h"
+#include "ozz/animation/runtime/ik_aim_job.h"
+#include "ozz/animation/runtime/ik_two_bone_job.h"
+#include "ozz/animation/runtime/lazy_model_pose.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/motion_matching_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_lod.h"
+#include "ozz/animation/runtime/track.h"
+#include "ozz/animation/runtime/track_sampling_job.h"
+#include "ozz/animation/runtime/track_triggering_job.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/simd_quaternion.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::benchmark::State;
+
+namespace {
+// Animations are built with a fixed duration, key density being expressed in
+// keys per second.
+const float kDuration = 10.f;
+
+// Builds a synthetic skeleton of _num_joints joints.
+ozz::unique_ptr<ozz::animation::Skeleton> BuildSkeleton(int _num_joints) {
+  ozz::animation::offline::SyntheticSkeletonGenerator generator;
+  generator.num_joints = _num_joints;
+  ozz::animation::offline::RawSkeleton raw_skeleton;
+  if (!generator(&raw_skeleton)) {
+    return nullptr;
+  }
+  return ozz::animation::offline::SkeletonBuilder()(raw_skeleton);
+}
+
+// Builds a synthetic animation of _num_tracks tracks, with _keys_per_second
+// noisy translation, rotation and scale keys per track, like motion capture
+// data.
+ozz::unique_ptr<ozz::animation::Animation> BuildAnimation(
+    int _num_tracks, int _keys_per_second, bool _random_access) {
+  ozz::animation::offline::SyntheticSkeletonGenerator skeleton_generator;
+  skeleton_generator.num_joints = _num_tracks;
+  ozz::animation::offline::RawSkeleton raw_skeleton;
+  ozz::animation::offline::SyntheticAnimationGenerator generator;
+  generator.duration = kDuration;
+  generator.key_frequency = static_cast<float>(_keys_per_second);
+  ozz::animation::offline::RawAnimation raw_animation;
+  if (!skeleton_generator(&raw_skeleton) ||
+      !generator(raw_skeleton, &raw_animation)) {
+    return nullptr;
+  }
+  ozz::animation::offline::AnimationBuilder builder;
+  builder.random_access = _random_access;
+  return builder(raw_animation);
+}
+
+// Defines ratio patterns used to sample animations.
+enum RatioPattern {
+  kForward,   // Playback at 60 fps.
+  kBackward,  // Backward playback at 60 fps.
+  kRandom,    // Pseudo random ratios.
+};
+
+// Gets the ratio of iteration _i, according to _pattern.
+float Ratio(int _pattern, int64_t _i) {
+  const int kFrames = static_cast<int>(kDuration * 60.f);
+  switch (_pattern) {
+    case kForward:
+      return static_cast<float>(_i % kFrames) / kFrames;
+    case kBackward:
+      return 1.f - static_cast<float>(_i % kFrames) / kFrames;
+    default:
+      // Knuth multiplicative hash, spreading ratios over the animation.
+      return static_cast<float>((static_cast<uint32_t>(_i) * 2654435761u) >>
+                                8) /
+             static_cast<float>(1 << 24);
+  }
+}
+
+// Samples an animation of arg(0) tracks, arg(1) keys per second, with ratio
+// pattern arg(2).
+void SamplingJob(State& _state) {
+  const int num_tracks = _state.arg(0);
+  ozz::unique_ptr<ozz::animation::Animation> animation =
+      BuildAnimation(num_tracks, _state.arg(1), false);
+  if (!animation) {
+    _state.SkipWithError("Failed to build animation.");
+    return;
+  }
+  ozz::animation::SamplingJob::Context context(num_tracks);
+  ozz::vector<ozz::math::SoaTransform> output(animation->num_soa_tracks());
+
+  ozz::animation::SamplingJob job;
+  job.animation = animation.get();
+  job.context = &context;
+  job.output = make_span(output);
+  for (int64_t i = 0; _state.KeepRunning(); ++i) {
+    job.ratio = Ratio(_state.arg(2), i);
+    if (!job.Run()) {
+      _state.SkipWithError("Job failed.");
+    }
+  }
+  _state.set_items_per_iteration(num_tracks);
+}
+OZZ_BENCHMARK(SamplingJob, {16, 30, kForward}, {64, 30, kForward},
+              {256, 30, kForward}, {64, 5, kForward}, {64, 120, kForward},
+              {64, 30, kBackward}, {64, 30, kRandom},
+              // Production scale.
+              {50, 60, kForward}, {128, 60, kForward}, {512, 60, kForward},
+              {ozz::animation::Skeleton::kMaxInlineJoints, 60, kForward},
+              {ozz::animation::Skeleton::kMaxJoints, 60, kForward});
+
+// Samples an animation of arg(0) tracks, arg(1) keys per second, forward,
+// with linear and angular velocities.
+void SamplingJobVelocities(State& _state) {
+  const int num_tracks = _state.arg(0);
+  ozz::unique_ptr<ozz::animation::Animation> animation =
+      BuildAnimation(num_tracks, _state.arg(1), false);
+  if (!animation) {
+    _state.SkipWithError("Failed to build animation.");
+    return;
+  }
+  ozz::animation::SamplingJob::Context context(num_tracks);
+  ozz::vector<ozz::math::SoaTransform> output(animation->num_soa_tracks());
+  ozz::vector<ozz::math::SoaFloat3> linear(animation->num_soa_tracks());
+  ozz::vector<ozz::math::SoaFloat3> angular(animation->num_soa_tracks());
+
+  ozz::animation::SamplingJob job;
+  job.animation = animation.get();
+  job.context = &context;
+  job.output = make_span(output);
+  job.linear_velocities = make_span(linear);
+  job.angular_velocities = make_span(angular);
+  for (int64_t i = 0; _state.KeepRunning(); ++i) {
+    job.ratio = Ratio(kForward, i);
+    if (!job.Run()) {
+      _state.SkipWithError("Job failed.");
+    }
+  }
+  _state.set_items_per_iteration(num_tracks);
+}
+OZZ_BENCHMARK(SamplingJobVelocities, {64, 30});
+
+// Samples a crowd of arg(0) instances playing forward one of 32 animations of
+// 64 tracks and 60 keys per second, with a prefetch distance of arg(1).
+// Instances are spread over the animations, and over time, so that keys and
+// contexts don't fit in cache: each instance samples cold data.
+void SamplingJobColdCrowd(State& _state) {
+  const int num_instances = _state.arg(0);
+  const int num_animations = 32;
+  const int num_tracks = 64;
+  ozz::vector<ozz::unique_ptr<ozz::animation::Animation>> animations;
+  for (int i = 0; i < num_animations; ++i) {
+    animations.push_back(BuildAnimation(num_tracks, 60, false));
+    if (!animations.back()) {
+      _state.SkipWithError("Failed to build animation.");
+      return;
+    }
+  }
+  ozz::animation::SamplingJob::ContextBank contexts(num_instances,
+                                                    num_tracks);
+  ozz::vector<ozz::math::SoaTransform> output(
+      animations[0]->num_soa_tracks());
+
+  ozz::animation::SamplingJob job;
+  job.output = make_span(output);
+  job.prefetch_distance = _state.arg(1);
+  for (int64_t i = 0; _state.KeepRunning(); ++i) {
+    for (int j = 0; j < num_instances; ++j) {
+      job.animation = animations[j % num_animations].get();
+      job.context = &contexts.contexts()[j];
+      job.ratio = Ratio(kForward, i + j * 37);
+      if (!job.Run()) {
+        _state.SkipWithError("Job failed.");
+      }
+    }
+  }
+  _state.set_items_per_iteration(num_tracks * num_instances);
+}
+OZZ_BENCHMARK(SamplingJobColdCrowd, {1024, 0}, {1024, 8});
+
+// Samples a random access animation of arg(0) tracks, arg(1) keys per second,
+// with random ratios.
+void StatelessSamplingJob(State& _state) {
+  const int num_tracks = _state.arg(0);
+  ozz::unique_ptr<ozz::animation::Animation> animation =
+      BuildAnimation(num_tracks, _state.arg(1), true);
+  if (!animation) {
+    _state.SkipWithError("Failed to build animation.");
+    return;
+  }
+  ozz::vector<ozz::math::SoaTransform> output(animation->num_soa_tracks());
+
+  ozz::animation::StatelessSamplingJob job;
+  job.animation = animation.get();
+  job.output = make_span(output);
+  for (int64_t i = 0; _state.KeepRunning(); ++i) {
+    job.ratio = Ratio(kRandom, i);
+    if (!job.Run()) {
+      _state.SkipWithError("Job failed.");
+    }
+  }
+  _state.set_items_per_iteration(num_tracks);
+}
+OZZ_BENCHMARK(StatelessSamplingJob, {64, 30}, {64, 120});
+
+// Defines blending layers modes.
+enum BlendingMode {
+  kFull,          // Every joint is blended.
+  kJointWeights,  // Per joint weights, half of them being 0.
+  kMask,          // Half of the joints masked out.
+};
+
+// Blends arg(1) layers of arg(0) joints, with blending mode arg(2).
+void BlendingJob(State& _state) {
+  const int num_soa_joints = (_state.arg(0) + 3) / 4;
+  const int num_layers = _state.arg(1);
+
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  ozz::vector<ozz::math::SoaTransform> rest_pose(num_soa_joints, identity);
+  ozz::vector<ozz::math::SoaTransform> output(num_soa_joints);
+  ozz::vector<ozz::math::SoaTransform> transforms(num_soa_joints, identity);
+  ozz::vector<ozz::math::SimdFloat4> joint_weights(num_soa_joints);
+  ozz::vector<uint8_t> mask((num_soa_joints + 7) / 8);
+  for (int i = 0; i < num_soa_joints; ++i) {
+    joint_weights[i] = ozz::math::simd_float4::Load1(i & 1 ? 1.f : 0.f);
+  }
+  for (size_t i = 0; i < mask.size(); ++i) {
+    mask[i] = 0x55;
+  }
+
+  ozz::vector<ozz::animation::BlendingJob::Layer> layers(num_layers);
+  for (int i = 0; i < num_layers; ++i) {
+    ozz::animation::BlendingJob::Layer& layer = layers[i];
+    layer.weight = 1.f / (i + 1);
+    layer.transform = make_span(transforms);
+    if (i != 0 && _state.arg(2) == kJointWeights) {
+      layer.joint_weights = make_span(joint_weights);
+    } else if (i != 0 && _state.arg(2) == kMask) {
+      layer.mask = make_span(mask);
+    }
+  }
+
+  ozz::animation::BlendingJob job;
+  job.layers = make_span(layers);
+  job.rest_pose = make_span(rest_pose);
+  job.output = make_span(output);
+  while (_state.KeepRunning()) {
+    if (!job.Run()) {
+      _state.SkipWithError("Job failed.");
+    }
+  }
+  _state.set_items_per_iteration(num_soa_joints * 4);
+}
+OZZ_BENCHMARK(BlendingJob, {64, 2, kFull}, {64, 4, kFull}, {64, 8, kFull},
+              {256, 4, kFull},
+              {ozz::animation::Skeleton::kMaxInlineJoints, 4, kFull},
+              {ozz::animation::Skeleton::kMaxJoints, 4, kFull},
+              {64, 4, kJointWeights}, {64, 4, kMask});
+
+// Converts arg(0) joints from local to model space.
+void LocalToModelJob(State& _state) {
+  ozz::unique_ptr<ozz::animation::Skeleton> skeleton =
+      BuildSkeleton(_state.arg(0));
+  if (!skeleton) {
+    _state.SkipWithError("Failed to build skeleton.");
+    return;
+  }
+  ozz::vector<ozz::math::Float4x4> output(skeleton->num_joints());
+
+  ozz::animation::LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.input = skeleton->joint_rest_poses();
+  job.output = make_span(output);
+  while (_state.KeepRunning()) {
+    if (!job.Run()) {
+      _state.SkipWithError("Job failed.");
+    }
+  }
+  _state.set_items_per_iteration(skeleton->num_joints());
+}
+OZZ_BENCHMARK(LocalToModelJob, {16}, {50}, {64}, {128}, {256}, {512},
+              {ozz::animation::Skeleton::kMaxInlineJoints},
+              {ozz::animation::Skeleton::kMaxJoints});
+
+// Converts arg(0) joints from local to model space, with skeleton joints
+// ordering arg(1) (see SkeletonBuilder::Ordering). If arg(2) isn't negative,
+// conversion is restricted to the joints of depth lower or equal to arg(2),
+// using a SkeletonLOD mask.
+void LocalToModelOrdering(State& _state) {
+  ozz::animation::offline::SyntheticSkeletonGenerator generator;
+  generator.num_joints = _state.arg(0);
+  ozz::animation::offline::RawSkeleton raw_skeleton;
+  ozz::animation::offline::SkeletonBuilder builder;
+  builder.ordering =
+      static_cast<ozz::animation::offline::SkeletonBuilder::Ordering>(
+          _state.arg(1));
+  ozz::unique_ptr<ozz::animation::Skeleton> skeleton;
+  if (generator(&raw_skeleton)) {
+    skeleton = builder(raw_skeleton);
+  }
+  if (!skeleton) {
+    _state.SkipWithError("Failed to build skeleton.");
+    return;
+  }
+  ozz::vector<ozz::math::Float4x4> output(skeleton->num_joints());
+
+  ozz::animation::LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.input = skeleton->joint_rest_poses();
+  job.output = make_span(output);
+
+  ozz::unique_ptr<ozz::animation::SkeletonLOD> lod;
+  if (_state.arg(2) >= 0) {
+    ozz::animation::offline::SkeletonLODBuilder lod_builder;
+    lod_builder.max_depth = _state.arg(2);
+    lod = lod_builder(*skeleton);
+    job.mask = lod->joints_mask();
+  }
+
+  while (_state.KeepRunning()) {
+    if (!job.Run()) {
+      _state.SkipWithError("Job failed.");
+    }
+  }
+  _state.set_items_per_iteration(lod ? lod->num_active_joints()
+                                     : skeleton->num_joints());
+}
+OZZ_BENCHMARK(LocalToModelOrdering, {64, 0, -1}, {64, 1, -1}, {256, 0, -1},
+              {256, 1, -1}, {256, 0, 3}, {256, 1, 3}, {512, 0, 4},
+              {512, 1, 4});
+
+// Evaluates arg(1) model-space matrices of a skeleton of arg(0) joints, every
+// frame, using LazyModelPose. Queried joints are evenly spread among the last
+// half of the skeleton, like hands or head of a character.
+void LazyModelPose(State& _state) {
+  ozz::unique_ptr<ozz::animation::Skeleton> skeleton =
+      BuildSkeleton(_state.arg(0));
+  ozz::animation::LazyModelPose pose;
+  if (!skeleton || !pose.Allocate(*skeleton)) {
+    _state.SkipWithError("Failed to build skeleton.");
+    return;
+  }
+  const int num_joints = skeleton->num_joints();
+  const int num_queries = _state.arg(1);
+
+  while (_state.KeepRunning()) {
+    if (!pose.Bind(skeleton->joint_rest_poses())) {
+      _state.SkipWithError("Bind failed.");
+    }
+    for (int i = 0; i < num_queries; ++i) {
+      const int joint = num_joints - 1 - i * num_joints / (2 * num_queries);
+      if (!pose.Evaluate(joint)) {
+        _state.SkipWithError("Evaluation failed.");
+      }
+    }
+  }
+  _state.set_items_per_iteration(num_queries);
+}
+OZZ_BENCHMARK(LazyModelPose, {64, 1}, {64, 4}, {256, 1}, {256, 4});
+
+// Solves a two bone IK chain, with moving targets.
+void IKTwoBoneJob(State& _state) {
+  const ozz::math::Float4x4 start = ozz::math::Float4x4::identity();
+  const ozz::math::Float4x4 mid = ozz::math::Float4x4::FromAffine(
+      ozz::math::simd_float4::y_axis(),
+      ozz::math::SimdQuaternion::FromAxisAngle(
+          ozz::math::simd_float4::z_axis(),
+          ozz::math::simd_float4::Load1(ozz::math::kPi_2))
+          .xyzw,
+      ozz::math::simd_float4::one());
+  const ozz::math::Float4x4 end = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::x_axis() + ozz::math::simd_float4::y_axis());
+
+  ozz::math::SimdQuaternion start_correction, mid_correction;
+  ozz::animation::IKTwoBoneJob job;
+  job.pole_vector = ozz::math::simd_float4::y_axis();
+  job.mid_axis = ozz::math::simd_float4::z_axis();
+  job.start_joint = &start;
+  job.mid_joint = &mid;
+  job.end_joint = &end;
+  job.start_joint_correction = &start_correction;
+  job.mid_joint_correction = &mid_correction;
+  for (int64_t i = 0; _state.KeepRunning(); ++i) {
+    const float ratio = Ratio(kRandom, i);
+    job.target = ozz::math::simd_float4::Load(ratio * 2.f, 1.f - ratio,
+                                              ratio - .5f, 0.f);
+    if (!job.Run()) {
+      _state.SkipWithError("Job failed.");
+    }
+  }
+  _state.set_items_per_iteration(1);
+}
+OZZ_BENCHMARK(IKTwoBoneJob);
+
+// Aims a joint at moving targets.
+void IKAimJob(State& _state) {
+  const ozz::math::Float4x4 joint = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::y_axis());
+
+  ozz::math::SimdQuaternion correction;
+  ozz::animation::IKAimJob job;
+  job.joint = &joint;
+  job.forward = ozz::math::simd_float4::x_axis();
+  job.up = ozz::math::simd_float4::y_axis();
+  job.pole_vector = ozz::math::simd_float4::y_axis();
+  job.joint_correction = &correction;
+  for (int64_t i = 0; _state.KeepRunning(); ++i) {
+    const float ratio = Ratio(kRandom, i);
+    job.target = ozz::math::simd_float4::Load(1.f - ratio, ratio * 2.f,
+                                              ratio - .5f, 0.f);
+    if (!job.Run()) {
+      _state.SkipWithError("Job failed.");
+    }
+  }
+  _state.set_items_per_iteration(1);
+}
+OZZ_BENCHMARK(IKAimJob);
+
+// Builds a float track of _num_keys keys, alternating 0 and 1 values.
+ozz::unique_ptr<ozz::animation::FloatTrack> BuildFloatTrack(int _num_keys) {
+  ozz::animation::offline::RawFloatTrack raw_track;
+  for (int i = 0; i < _num_keys; ++i) {
+    const ozz::animation::offline::RawFloatTrack::Keyframe key = {
+        ozz::animation::offline::RawTrackInterpolation::kLinear,
+        static_cast<float>(i) / (_num_keys - 1), static_cast<float>(i & 1)};
+    raw_track.keyframes.push_back(key);
+  }
+  return ozz::animation::offline::TrackBuilder()(raw_track);
+}
+
+// Samples a float track of arg(0) keys, with ratio pattern arg(1).
+void FloatTrackSamplingJob(State& _state) {
+  ozz::unique_ptr<ozz::animation::FloatTrack> track =
+      BuildFloatTrack(_state.arg(0));
+  if (!track) {
+    _state.SkipWithError("Failed to build track.");
+    return;
+  }
+  float result;
+  ozz::animation::FloatTrackSamplingJob job;
+  job.track = track.get();
+  job.result = &result;
+  for (int64_t i = 0; _state.KeepRunning(); ++i) {
+    job.ratio = Ratio(_state.arg(1), i);
+    if (!job.Run()) {
+      _state.SkipWithError("Job failed.");
+    }
+  }
+  _state.set_items_per_iteration(1);
+}
+OZZ_BENCHMARK(FloatTrackSamplingJob, {8, kForward}, {256, kForward},
+              {256, kRandom});
+
+// Detects edges of a float track of arg(0) keys, over a frame long range.
+void TrackTriggeringJob(State& _state) {
+  ozz::unique_ptr<ozz::animation::FloatTrack> track =
+      BuildFloatTrack(_state.arg(0));
+  if (!track) {
+    _state.SkipWithError("Failed to build track.");
+    return;
+  }
+  ozz::animation::TrackTriggeringJob::Iterator iterator;
+  ozz::animation::TrackTriggeringJob job;
+  job.track = track.get();
+  job.threshold = .5f;
+  job.iterator = &iterator;
+  int64_t edges = 0;
+  for (int64_t i = 0; _state.KeepRunning(); ++i) {
+    job.from = Ratio(kForward, i);
+    job.to = job.from + 1.f / 60.f;
+    if (!job.Run()) {
+      _state.SkipWithError("Job failed.");
+    }
+    for (; iterator != job.end(); ++iterator) {
+      ++edges;
+    }
+  }
+  _state.set_items_per_iteration(1);
+  (void)edges;
+}
+OZZ_BENCHMARK(TrackTriggeringJob, {8}, {256});
+
+// Builds a motion matching database of _num_clips synthetic 10s clips of a 32
+// joints skeleton, sampled at 30 fps, with 3 joints positions and velocities
+// and a 3 points trajectory (30 features).
+ozz::unique_ptr<ozz::animation::FeatureDatabase> BuildFeatureDatabase(
+    int _num_clips) {
+  ozz::animation::offline::SyntheticSkeletonGenerator skeleton_generator;
+  skeleton_generator.num_joints = 32;
+  ozz::animation::offline::RawSkeleton raw_skeleton;
+  if (!skeleton_generator(&raw_skeleton)) {
+    return nullptr;
+  }
+  const ozz::unique_ptr<ozz::animation::Skeleton> skeleton =
+      ozz::animation::offline::SkeletonBuilder()(raw_skeleton);
+  if (!skeleton) {
+    return nullptr;
+  }
+  ozz::vector<ozz::unique_ptr<ozz::animation::Animation>> animations;
+  ozz::vector<const ozz::animation::Animation*> clips;
+  for (int i = 0; i < _num_clips; ++i) {
+    ozz::animation::offline::SyntheticAnimationGenerator generator;
+    generator.duration = kDuration;
+    generator.seed = i;
+    generator.amplitude = .2f + (i % 8) * .1f;
+    ozz::animation::offline::RawAnimation raw_animation;
+    if (!generator(raw_skeleton, &raw_animation)) {
+      return nullptr;
+    }
+    animations.push_back(
+        ozz::animation::offline::AnimationBuilder()(raw_animation));
+    if (!animations.back()) {
+      return nullptr;
+    }
+    clips.push_back(animations.back().get());
+  }
+  ozz::animation::offline::FeatureDatabaseBuilder builder;
+  const int joints[] = {8, 20, 31};
+  for (const int joint : joints) {
+    const ozz::animation::offline::FeatureDatabaseBuilder::JointFeature
+        feature = {joint, 1.f, 1.f};
+    builder.joints.push_back(feature);
+  }
+  builder.trajectory_times.push_back(.33f);
+  builder.trajectory_times.push_back(.66f);
+  builder.trajectory_times.push_back(1.f);
+  return builder(*skeleton, make_span(clips));
+}
+
+// Searches a motion matching database of arg(0) clips, using bounding boxes
+// if arg(1) is 1. Queries are database frames features.
+void MotionMatchingJob(State& _state) {
+  const ozz::unique_ptr<ozz::animation::FeatureDatabase> database =
+      BuildFeatureDatabase(_state.arg(0));
+  if (!database) {
+    _state.SkipWithError("Failed to build database.");
+    return;
+  }
+  const int num_features = database->num_features();
+  const int kQueries = 64;
+  ozz::vector<float> queries(kQueries * num_features);
+  for (int i = 0; i < kQueries; ++i) {
+    const int frame = static_cast<int>(
+        (static_cast<uint32_t>(i) * 2654435761u) % database->num_frames());
+    database->GetFeatures(
+        frame, ozz::span<float>(queries.data() + i * num_features,
+                                static_cast<size_t>(num_features)));
+  }
+  ozz::animation::MotionMatchingJob::Match match;
+  ozz::animation::MotionMatchingJob job;
+  job.database = database.get();
+  job.accelerate = _state.arg(1) != 0;
+  job.output = &match;
+  for (int64_t i = 0; _state.KeepRunning(); ++i) {
+    job.query = ozz::span<const float>(
+        queries.data() + (i % kQueries) * num_features,
+        static_cast<size_t>(num_features));
+    if (!job.Run()) {
+      _state.SkipWithError("Job failed.");
+    }
+  }
+  _state.set_items_per_iteration(database->num_frames());
+}
+OZZ_BENCHMARK(MotionMatchingJob, {16, 0}, {16, 1}, {128, 0}, {128, 1});
+}  // namespace
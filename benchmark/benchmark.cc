@@ -0,0 +1,392 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+namespace ozz {
+namespace benchmark {
+
+namespace {
+// Registered benchmark, for a single arguments set. Registration happens
+// during static initialization, so the registry can't allocate memory:
+// allocator might not be initialized yet.
+struct Entry {
+  const char* name;
+  Function function;
+  int args[kMaxArgs];
+  int num_args;
+};
+
+enum { kMaxEntries = 256 };
+Entry g_entries[kMaxEntries];
+int g_num_entries = 0;
+
+void Register(const char* _name, Function _function, const int* _args,
+              int _num_args) {
+  assert(g_num_entries < kMaxEntries && "Too many benchmarks registered.");
+  assert(_num_args <= kMaxArgs && "Too many benchmark arguments.");
+  Entry& entry = g_entries[g_num_entries++];
+  entry.name = _name;
+  entry.function = _function;
+  entry.num_args = std::min(_num_args, static_cast<int>(kMaxArgs));
+  for (int i = 0; i < entry.num_args; ++i) {
+    entry.args[i] = _args[i];
+  }
+}
+
+// Appends printf formatted text to _output.
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((format(printf, 2, 3)))
+#endif
+void Append(ozz::string* _output, const char* _format, ...) {
+  char buffer[512];
+  va_list args;
+  va_start(args, _format);
+  const int len = std::vsnprintf(buffer, sizeof(buffer), _format, args);
+  va_end(args);
+  if (len > 0) {
+    _output->append(buffer, std::min(static_cast<size_t>(len),
+                                      sizeof(buffer) - 1));
+  }
+}
+
+// Tells if _name contains _filter, or one of its comma separated strings.
+// Empty filters match any name.
+bool MatchFilter(const char* _name, const char* _filter) {
+  if (_filter == nullptr || *_filter == 0) {
+    return true;
+  }
+  for (const char* begin = _filter;;) {
+    const char* end = std::strchr(begin, ',');
+    const ozz::string pattern =
+        end ? ozz::string(begin, end) : ozz::string(begin);
+    if (!pattern.empty() && std::strstr(_name, pattern.c_str()) != nullptr) {
+      return true;
+    }
+    if (!end) {
+      return false;
+    }
+    begin = end + 1;
+  }
+}
+
+// Runs a fixed workload of dependent scalar float and integer operations,
+// which doesn't depend on ozz code. See kCalibration.
+void Calibration(State& _state) {
+  float x = 1.f;
+  uint32_t hash = 2166136261u;
+  while (_state.KeepRunning()) {
+    for (uint32_t i = 0; i < 1024; ++i) {
+      hash = (hash ^ i) * 16777619u;
+      x = x * .999f + static_cast<float>(hash & 0xff) * 1e-3f;
+    }
+  }
+  volatile float sink = x;
+  (void)sink;
+}
+}  // namespace
+
+OZZ_BENCHMARK(Calibration);
+
+const char kCalibration[] = "Calibration";
+
+State::State(span<const int> _args, double _min_time)
+    : args_(_args),
+      min_time_(_min_time),
+      iterations_(0),
+      batch_end_(1),
+      elapsed_(0.),
+      items_per_iteration_(0),
+      error_(nullptr),
+      running_(false) {}
+
+bool State::KeepRunning() {
+  if (!running_) {
+    // Measure starts with the first call, unless run already failed.
+    if (iterations_ != 0 || error_ != nullptr) {
+      return false;
+    }
+    running_ = true;
+    start_ = Clock::now();
+  } else if (iterations_ == batch_end_) {
+    // End of a batch, checks if measure is long enough.
+    elapsed_ = std::chrono::duration<double>(Clock::now() - start_).count();
+    if (elapsed_ >= min_time_) {
+      running_ = false;
+      return false;
+    }
+    batch_end_ *= 2;
+  }
+  ++iterations_;
+  return true;
+}
+
+void State::SkipWithError(const char* _error) {
+  error_ = _error;
+  running_ = false;
+}
+
+Registrar::Registrar(const char* _name, Function _function,
+                     std::initializer_list<std::initializer_list<int>> _args) {
+  if (_args.size() == 0) {
+    Register(_name, _function, nullptr, 0);
+  }
+  for (const std::initializer_list<int>& args : _args) {
+    Register(_name, _function, args.begin(), static_cast<int>(args.size()));
+  }
+}
+
+ozz::vector<Result> RunBenchmarks(const char* _filter, double _min_time,
+                                  int _repetitions) {
+  ozz::vector<Result> results;
+  for (int e = 0; e < g_num_entries; ++e) {
+    const Entry& entry = g_entries[e];
+    ozz::string name = entry.name;
+    for (int i = 0; i < entry.num_args; ++i) {
+      Append(&name, "/%d", entry.args[i]);
+    }
+    if (!MatchFilter(name.c_str(), _filter)) {
+      continue;
+    }
+
+    Result result = {name, 0, 0., 0., ozz::string()};
+    for (int r = 0; r < std::max(_repetitions, 1); ++r) {
+      State state({entry.args, static_cast<size_t>(entry.num_args)},
+                  _min_time);
+      entry.function(state);
+      if (state.error() != nullptr) {
+        result.error = state.error();
+        break;
+      }
+      if (state.iterations() == 0) {
+        result.error = "Benchmark didn't iterate.";
+        break;
+      }
+      const double ns_per_iteration =
+          state.elapsed() * 1e9 / static_cast<double>(state.iterations());
+      if (r == 0 || ns_per_iteration < result.ns_per_iteration) {
+        result.iterations = state.iterations();
+        result.ns_per_iteration = ns_per_iteration;
+        result.items_per_second =
+            ns_per_iteration > 0.
+                ? static_cast<double>(state.items_per_iteration()) * 1e9 /
+                      ns_per_iteration
+                : 0.;
+      }
+    }
+    results.push_back(result);
+  }
+  return results;
+}
+
+void ReportConsole(span<const Result> _results, ozz::string* _output) {
+  size_t width = 9;
+  for (const Result& result : _results) {
+    width = std::max(width, result.name.size());
+  }
+  const int w = static_cast<int>(width);
+  Append(_output, "%-*s %15s %12s %15s\n", w, "Benchmark", "Time (ns)",
+         "Iterations", "Items/s");
+  _output->append(width + 45, '-');
+  _output->append("\n");
+  for (const Result& result : _results) {
+    if (!result.error.empty()) {
+      Append(_output, "%-*s ERROR: %s\n", w, result.name.c_str(),
+             result.error.c_str());
+      continue;
+    }
+    Append(_output, "%-*s %15.1f %12lld", w, result.name.c_str(),
+           result.ns_per_iteration,
+           static_cast<long long>(result.iterations));
+    if (result.items_per_second > 0.) {
+      Append(_output, " %14.4gM", result.items_per_second * 1e-6);
+    }
+    _output->append("\n");
+  }
+}
+
+void ReportJson(span<const Result> _results, ozz::string* _output) {
+  _output->append("{\n  \"context\": {\n");
+  Append(_output, "    \"library\": \"ozz-animation\",\n");
+#ifdef NDEBUG
+  Append(_output, "    \"library_build_type\": \"release\"\n");
+#else
+  Append(_output, "    \"library_build_type\": \"debug\"\n");
+#endif
+  _output->append("  },\n  \"benchmarks\": [");
+  for (size_t i = 0; i < _results.size(); ++i) {
+    const Result& result = _results[i];
+    _output->append(i == 0 ? "\n" : ",\n");
+    Append(_output, "    {\n      \"name\": \"%s\",\n", result.name.c_str());
+    Append(_output, "      \"run_name\": \"%s\",\n", result.name.c_str());
+    if (!result.error.empty()) {
+      Append(_output,
+             "      \"error_occurred\": true,\n"
+             "      \"error_message\": \"%s\"\n    }",
+             result.error.c_str());
+      continue;
+    }
+    Append(_output, "      \"iterations\": %lld,\n",
+           static_cast<long long>(result.iterations));
+    Append(_output, "      \"real_time\": %.3f,\n", result.ns_per_iteration);
+    Append(_output, "      \"cpu_time\": %.3f,\n", result.ns_per_iteration);
+    Append(_output, "      \"time_unit\": \"ns\"");
+    if (result.items_per_second > 0.) {
+      Append(_output, ",\n      \"items_per_second\": %.6g",
+             result.items_per_second);
+    }
+    _output->append("\n    }");
+  }
+  _output->append("\n  ]\n}\n");
+}
+
+void ReportCsv(span<const Result> _results, ozz::string* _output) {
+  _output->append(
+      "name,iterations,real_time,time_unit,items_per_second,error_message\n");
+  for (const Result& result : _results) {
+    if (!result.error.empty()) {
+      Append(_output, "\"%s\",,,,,\"%s\"\n", result.name.c_str(),
+             result.error.c_str());
+      continue;
+    }
+    Append(_output, "\"%s\",%lld,%.3f,ns,", result.name.c_str(),
+           static_cast<long long>(result.iterations), result.ns_per_iteration);
+    if (result.items_per_second > 0.) {
+      Append(_output, "%.6g", result.items_per_second);
+    }
+    _output->append(",\n");
+  }
+}
+
+bool ParseCsv(const char* _csv, ozz::vector<Result>* _results) {
+  _results->clear();
+  const char kHeader[] =
+      "name,iterations,real_time,time_unit,items_per_second,error_message\n";
+  if (std::strncmp(_csv, kHeader, sizeof(kHeader) - 1) != 0) {
+    return false;
+  }
+  for (const char* line = _csv + sizeof(kHeader) - 1; *line != 0;) {
+    const char* eol = std::strchr(line, '\n');
+    const ozz::string row = eol ? ozz::string(line, eol) : ozz::string(line);
+    line = eol ? eol + 1 : line + row.size();
+    if (row.empty()) {
+      continue;
+    }
+
+    // Name is quoted, and can't contain quotes.
+    const size_t name_end = row.find("\",");
+    if (row[0] != '"' || name_end == ozz::string::npos) {
+      _results->clear();
+      return false;
+    }
+    Result result = {row.substr(1, name_end - 1), 0, 0., 0., ozz::string()};
+    const char* fields = row.c_str() + name_end + 2;
+    long long iterations = 0;
+    if (std::sscanf(fields, "%lld,%lf,ns,%lf", &iterations,
+                    &result.ns_per_iteration, &result.items_per_second) >= 2) {
+      result.iterations = iterations;
+    } else {
+      // Failed benchmark, error message is the quoted last field.
+      const size_t error_begin = row.rfind(",\"");
+      result.error = error_begin != ozz::string::npos && row.size() > 2
+                         ? row.substr(error_begin + 2,
+                                      row.size() - error_begin - 3)
+                         : ozz::string("Unknown error.");
+    }
+    _results->push_back(result);
+  }
+  return true;
+}
+
+namespace {
+// Finds the successful result named _name in _results.
+const Result* Find(span<const Result> _results, const char* _name) {
+  for (const Result& result : _results) {
+    if (result.error.empty() && result.ns_per_iteration > 0. &&
+        result.name == _name) {
+      return &result;
+    }
+  }
+  return nullptr;
+}
+}  // namespace
+
+ozz::vector<Comparison> Compare(span<const Result> _results,
+                                span<const Result> _baseline,
+                                double _max_ratio) {
+  // Normalization factor, if calibration is available on both sides.
+  const Result* calibration = Find(_results, kCalibration);
+  const Result* baseline_calibration = Find(_baseline, kCalibration);
+  const double scale = calibration && baseline_calibration
+                           ? baseline_calibration->ns_per_iteration /
+                                 calibration->ns_per_iteration
+                           : 1.;
+
+  ozz::vector<Comparison> comparisons;
+  for (const Result& result : _results) {
+    if (!result.error.empty() || result.name == kCalibration) {
+      continue;
+    }
+    const Result* baseline = Find(_baseline, result.name.c_str());
+    if (!baseline) {
+      continue;
+    }
+    const double ratio =
+        result.ns_per_iteration * scale / baseline->ns_per_iteration;
+    const Comparison comparison = {result.name, baseline->ns_per_iteration,
+                                   result.ns_per_iteration, ratio,
+                                   ratio > _max_ratio};
+    comparisons.push_back(comparison);
+  }
+  return comparisons;
+}
+
+void ReportComparisons(span<const Comparison> _comparisons,
+                       ozz::string* _output) {
+  size_t width = 9;
+  for (const Comparison& comparison : _comparisons) {
+    width = std::max(width, comparison.name.size());
+  }
+  const int w = static_cast<int>(width);
+  Append(_output, "%-*s %15s %15s %9s\n", w, "Benchmark", "Baseline (ns)",
+         "Time (ns)", "Ratio");
+  _output->append(width + 42, '-');
+  _output->append("\n");
+  for (const Comparison& comparison : _comparisons) {
+    Append(_output, "%-*s %15.1f %15.1f %9.3f%s\n", w,
+           comparison.name.c_str(), comparison.baseline_ns, comparison.ns,
+           comparison.ratio, comparison.regressed ? " REGRESSED" : "");
+  }
+}
+}  // namespace benchmark
+}  // namespace ozz
@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_BENCHMARK_BENCHMARK_H_
+#define OZZ_BENCHMARK_BENCHMARK_H_
+
+// Minimal benchmark harness, whose registration, measurement and reports
+// follow Google Benchmark conventions (reports can be compared with its
+// tools), without adding a dependency.
+// Benchmark functions prepare their data first, then loop over the code to
+// measure as long as State::KeepRunning() returns true:
+//
+// void LocalToModel(ozz::benchmark::State& _state) {
+//   ... // Setup, not measured.
+//   while (_state.KeepRunning()) {
+//     job.Run();
+//   }
+//   _state.set_items_per_iteration(num_joints);
+// }
+// OZZ_BENCHMARK(LocalToModel, {64}, {256});
+
+#include <chrono>
+#include <initializer_list>
+
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace benchmark {
+
+// Measures a single benchmark run.
+class State {
+ public:
+  State(span<const int> _args, double _min_time);
+
+  // Gets argument _i of the arguments set this run was registered with, see
+  // OZZ_BENCHMARK.
+  int arg(size_t _i) const { return _i < args_.size() ? args_[_i] : 0; }
+
+  // Returns true as long as the measured loop must iterate. Measurement
+  // starts with the first call, and stops when the loop has run for at least
+  // min_time seconds. Iterations are counted by batches, which are doubled
+  // until min_time is reached, so the clock is rarely read.
+  bool KeepRunning();
+
+  // Sets the number of items (tracks, joints, vertices...) processed by each
+  // iteration, which is reported as a throughput.
+  void set_items_per_iteration(int64_t _items) {
+    items_per_iteration_ = _items;
+  }
+
+  // Flags the run as failed, typically because a job failed to run. Stops
+  // measured loop.
+  void SkipWithError(const char* _error);
+
+  // Gets run results.
+  int64_t iterations() const { return iterations_; }
+  double elapsed() const { return elapsed_; }  // In seconds.
+  int64_t items_per_iteration() const { return items_per_iteration_; }
+  const char* error() const { return error_; }
+
+ private:
+  typedef std::chrono::steady_clock Clock;
+
+  span<const int> args_;
+  double min_time_;
+  int64_t iterations_;
+  int64_t batch_end_;
+  double elapsed_;
+  int64_t items_per_iteration_;
+  const char* error_;
+  bool running_;
+  Clock::time_point start_;
+};
+
+// Maximum number of arguments of a benchmark.
+enum { kMaxArgs = 4 };
+
+// Benchmark function signature.
+typedef void (*Function)(State& _state);
+
+// Registers a benchmark function at static initialization time, to be run
+// once per arguments set, each set having up to kMaxArgs arguments. Use
+// OZZ_BENCHMARK macro instead.
+class Registrar {
+ public:
+  Registrar(const char* _name, Function _function,
+            std::initializer_list<std::initializer_list<int>> _args);
+};
+
+// Defines the result of a benchmark, for a given arguments set. Name is
+// formatted as "function/arg0/arg1...".
+struct Result {
+  ozz::string name;
+  int64_t iterations;
+  double ns_per_iteration;
+  double items_per_second;  // 0 if items per iteration wasn't set.
+  ozz::string error;        // Empty if run succeeded.
+};
+
+// Runs registered benchmarks whose name contains _filter, or one of its comma
+// separated strings (all if empty). Each benchmark is run _repetitions times,
+// keeping the fastest run.
+ozz::vector<Result> RunBenchmarks(const char* _filter, double _min_time,
+                                  int _repetitions);
+
+// Formats _results to _output, as a console table, Google Benchmark
+// compatible json, or csv.
+void ReportConsole(span<const Result> _results, ozz::string* _output);
+void ReportJson(span<const Result> _results, ozz::string* _output);
+void ReportCsv(span<const Result> _results, ozz::string* _output);
+
+// Parses a csv report, as formatted by ReportCsv, to _results. Returns false
+// if _csv isn't a valid report, in which case _results is left empty.
+bool ParseCsv(const char* _csv, ozz::vector<Result>* _results);
+
+// Name of the calibration benchmark, which runs a fixed scalar workload.
+// Comparisons to a baseline are normalized by calibration times, which
+// compensates for the speed difference between the host that recorded the
+// baseline and the one running the comparison.
+extern const char kCalibration[];
+
+// Defines the comparison of a benchmark result to its baseline.
+struct Comparison {
+  ozz::string name;
+  double baseline_ns;  // Baseline time per iteration.
+  double ns;           // Measured time per iteration.
+  double ratio;        // Normalized time ratio, greater than 1 when slower.
+  bool regressed;      // Ratio is greater than the allowed maximum.
+};
+
+// Compares successful _results to their _baseline result (same name), if
+// any. Ratios are normalized by calibration times if both _results and
+// _baseline contain it (see kCalibration). Benchmarks slower than
+// _max_ratio times their baseline are flagged as regressed.
+ozz::vector<Comparison> Compare(span<const Result> _results,
+                                span<const Result> _baseline,
+                                double _max_ratio);
+
+// Formats _comparisons to _output, as a console table.
+void ReportComparisons(span<const Comparison> _comparisons,
+                       ozz::string* _output);
+}  // namespace benchmark
+}  // namespace ozz
+
+// Registers benchmark function _function, followed by the arguments sets to
+// run it with, eg: OZZ_BENCHMARK(Sampling, {16, 2}, {64, 2}).
+#define OZZ_BENCHMARK(_function, ...)                                   \
+  static const ozz::benchmark::Registrar _function##_registrar(#_function, \
+                                                               &_function, \
+                                                               {__VA_ARGS__})
+
+#endif  // OZZ_BENCHMARK_BENCHMARK_H_
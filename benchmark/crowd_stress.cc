@@ -0,0 +1,547 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+// Headless crowd stress test, the reference scaling benchmark of the library.
+// It updates a crowd of up to 100k characters every frame, distributing them
+// across threads by batches: each character samples its animation layers,
+// blends them, computes model-space matrices and skins its mesh. Characters
+// are spread over a mix of synthetic skeletons and animations, a part of
+// them using a skeleton level of detail. Frame time percentiles and per stage
+// costs are reported to the console.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/offline/skeleton_lod_builder.h"
+#include "ozz/animation/offline/synthetic_generator.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_lod.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+#include "ozz/base/task_scheduler.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+#include "ozz/options/options.h"
+
+// Declares command line options.
+static bool ValidateCharacters(const ozz::options::Option& _option,
+                               int /*_argc*/) {
+  const ozz::options::IntOption& option =
+      static_cast<const ozz::options::IntOption&>(_option);
+  const bool valid = option.value() >= 1 && option.value() <= 100000;
+  if (!valid) {
+    ozz::log::Err() << "Invalid characters option \"" << option.value()
+                    << "\", must be in range [1,100000]." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_INT_FN(characters, "Number of characters of the crowd.",
+                           10000, false, &ValidateCharacters)
+
+// Validates options that must be greater than 0.
+static bool ValidatePositive(const ozz::options::Option& _option,
+                             int /*_argc*/) {
+  const ozz::options::IntOption& option =
+      static_cast<const ozz::options::IntOption&>(_option);
+  const bool valid = option.value() >= 1;
+  if (!valid) {
+    ozz::log::Err() << "Invalid " << option.name() << " option \""
+                    << option.value() << "\", must be greater than 0."
+                    << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_INT_FN(frames, "Number of measured frames.", 100, false,
+                           &ValidatePositive)
+
+OZZ_OPTIONS_DECLARE_INT(warmup,
+                        "Number of frames updated before measuring, to warm "
+                        "up caches and sampling contexts.",
+                        5, false)
+
+OZZ_OPTIONS_DECLARE_INT(workers,
+                        "Number of worker threads. Negative value uses as "
+                        "many workers as hardware threads, minus one for the "
+                        "main thread. 0 updates the crowd from the main "
+                        "thread only.",
+                        -1, false)
+
+OZZ_OPTIONS_DECLARE_INT_FN(grain,
+                           "Number of characters updated by each task.", 64,
+                           false, &ValidatePositive)
+
+OZZ_OPTIONS_DECLARE_INT_FN(skeletons,
+                           "Number of distinct skeletons. Characters are "
+                           "spread over them.",
+                           2, false, &ValidatePositive)
+
+OZZ_OPTIONS_DECLARE_INT_FN(animations,
+                           "Number of distinct animations per skeleton.", 4,
+                           false, &ValidatePositive)
+
+OZZ_OPTIONS_DECLARE_INT_FN(joints, "Number of joints per skeleton.", 64,
+                           false, &ValidatePositive)
+
+static bool ValidateLayers(const ozz::options::Option& _option,
+                           int /*_argc*/) {
+  const ozz::options::IntOption& option =
+      static_cast<const ozz::options::IntOption&>(_option);
+  const bool valid = option.value() >= 1 && option.value() <= 2;
+  if (!valid) {
+    ozz::log::Err() << "Invalid layers option \"" << option.value()
+                    << "\", must be 1 or 2." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_INT_FN(layers,
+                           "Number of animation layers sampled and blended "
+                           "per character (1 or 2).",
+                           2, false, &ValidateLayers)
+
+static bool ValidateLod(const ozz::options::Option& _option, int /*_argc*/) {
+  const ozz::options::FloatOption& option =
+      static_cast<const ozz::options::FloatOption&>(_option);
+  const bool valid = option.value() >= 0.f && option.value() <= 1.f;
+  if (!valid) {
+    ozz::log::Err() << "Invalid lod option \"" << option.value()
+                    << "\", must be in range [0,1]." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_FLOAT_FN(lod,
+                             "Ratio of characters using the skeleton level "
+                             "of detail, in range [0,1].",
+                             .5f, false, &ValidateLod)
+
+OZZ_OPTIONS_DECLARE_INT(lod_depth,
+                        "Maximum depth of the joints active in the skeleton "
+                        "level of detail.",
+                        3, false)
+
+OZZ_OPTIONS_DECLARE_INT(vertices,
+                        "Number of vertices of each skeleton mesh, skinned "
+                        "with 4 influences (positions and normals). 0 "
+                        "disables skinning.",
+                        1024, false)
+
+namespace {
+
+// Duration of synthetic animations, and update time step.
+const float kDuration = 2.f;
+const float kTimeStep = 1.f / 30.f;
+
+// Update stages, whose costs are measured.
+enum Stage { kSampling, kBlending, kLocalToModel, kSkinning, kNumStages };
+const char* kStageNames[kNumStages] = {"sampling", "blending",
+                                       "local_to_model", "skinning"};
+
+// Shared assets of a skeleton: the skeleton, its level of detail, animations
+// and mesh.
+struct Rig {
+  ozz::unique_ptr<ozz::animation::Skeleton> skeleton;
+  ozz::unique_ptr<ozz::animation::SkeletonLOD> lod;
+  ozz::vector<ozz::unique_ptr<ozz::animation::Animation>> animations;
+  ozz::vector<ozz::math::Float4x4> inverse_bind_poses;
+
+  // Mesh, skinned with 4 influences per vertex.
+  int num_vertices;
+  ozz::vector<float> positions;
+  ozz::vector<float> normals;
+  ozz::vector<uint16_t> joint_indices;
+  ozz::vector<float> joint_weights;
+};
+
+// Per character state.
+struct Character {
+  int rig;
+  int animations[2];  // Animation of each layer, in rig animations.
+  float times[2];     // Playback time of each layer.
+  float weight;       // Blending weight of the first layer.
+  bool lod;           // Uses rig level of detail.
+  ozz::animation::SamplingJob::Context contexts[2];
+};
+
+// Per task buffers and stage costs. Characters are updated in place, all
+// other intermediate buffers are shared by the characters of a task.
+struct Workspace {
+  ozz::vector<ozz::math::SoaTransform> layers[2];
+  ozz::vector<ozz::math::SoaTransform> locals;
+  ozz::vector<ozz::math::Float4x4> models;
+  ozz::vector<ozz::math::Float4x4> skinning_matrices;
+  ozz::vector<float> out_positions;
+  ozz::vector<float> out_normals;
+  double costs[kNumStages];  // In seconds.
+};
+
+typedef std::chrono::steady_clock Clock;
+
+// Gets the duration from _begin to _end, in seconds.
+double Elapsed(Clock::time_point _begin, Clock::time_point _end) {
+  return std::chrono::duration<double>(_end - _begin).count();
+}
+
+// Builds rig _index, with _num_animations animations.
+bool BuildRig(int _index, int _num_animations, Rig* _rig) {
+  // Skeletons differ by their topology.
+  ozz::animation::offline::SyntheticSkeletonGenerator skeleton_generator;
+  skeleton_generator.num_joints = OPTIONS_joints;
+  skeleton_generator.fan_out = 2 + _index % 3;
+  ozz::animation::offline::RawSkeleton raw_skeleton;
+  if (!skeleton_generator(&raw_skeleton)) {
+    return false;
+  }
+  _rig->skeleton = ozz::animation::offline::SkeletonBuilder()(raw_skeleton);
+  if (!_rig->skeleton) {
+    return false;
+  }
+
+  ozz::animation::offline::SkeletonLODBuilder lod_builder;
+  lod_builder.max_depth = OPTIONS_lod_depth;
+  _rig->lod = lod_builder(*_rig->skeleton);
+  if (!_rig->lod) {
+    return false;
+  }
+
+  ozz::animation::offline::SyntheticAnimationGenerator animation_generator;
+  animation_generator.duration = kDuration;
+  ozz::animation::offline::AnimationBuilder animation_builder;
+  for (int i = 0; i < _num_animations; ++i) {
+    animation_generator.seed = static_cast<uint32_t>(_index * 1000 + i);
+    ozz::animation::offline::RawAnimation raw_animation;
+    if (!animation_generator(raw_skeleton, &raw_animation)) {
+      return false;
+    }
+    _rig->animations.push_back(animation_builder(raw_animation));
+    if (!_rig->animations.back()) {
+      return false;
+    }
+  }
+
+  // Inverse bind poses are computed from the rest pose.
+  const ozz::animation::Skeleton& skeleton = *_rig->skeleton;
+  const int num_joints = skeleton.num_joints();
+  _rig->inverse_bind_poses.resize(num_joints);
+  ozz::animation::LocalToModelJob ltm_job;
+  ltm_job.skeleton = &skeleton;
+  ltm_job.input = skeleton.joint_rest_poses();
+  ltm_job.output = make_span(_rig->inverse_bind_poses);
+  if (!ltm_job.Run()) {
+    return false;
+  }
+  for (ozz::math::Float4x4& matrix : _rig->inverse_bind_poses) {
+    matrix = ozz::math::Invert(matrix);
+  }
+
+  // Mesh vertices are influenced by 4 consecutive joints.
+  const int num_vertices = std::max(OPTIONS_vertices.value(), 0);
+  _rig->num_vertices = num_vertices;
+  for (int i = 0; i < num_vertices; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      _rig->positions.push_back(static_cast<float>((i * (j + 3)) % 13) * .1f);
+      _rig->normals.push_back(j == 1 ? 1.f : 0.f);
+    }
+    for (int j = 0; j < 4; ++j) {
+      _rig->joint_indices.push_back(
+          static_cast<uint16_t>((i + j) % num_joints));
+    }
+    _rig->joint_weights.push_back(.4f);
+    _rig->joint_weights.push_back(.3f);
+    _rig->joint_weights.push_back(.2f);
+  }
+  return true;
+}
+
+// Arguments of the crowd update tasks.
+struct UpdateArgs {
+  const ozz::vector<Rig>* rigs;
+  ozz::vector<Character>* characters;
+  ozz::vector<Workspace>* workspaces;
+  std::atomic<bool>* success;
+};
+
+// Updates _character, using _workspace buffers.
+bool UpdateCharacter(const Rig& _rig, Character* _character,
+                     Workspace* _workspace) {
+  const ozz::animation::Skeleton& skeleton = *_rig.skeleton;
+  const ozz::span<const uint8_t> soa_mask =
+      _character->lod ? _rig.lod->soa_mask() : ozz::span<const uint8_t>();
+  const int num_soa_joints = skeleton.num_soa_joints();
+  const int num_joints = skeleton.num_joints();
+
+  // Samples layers.
+  const Clock::time_point sampling = Clock::now();
+  ozz::animation::BlendingJob::Layer layers[2];
+  const int num_layers = OPTIONS_layers;
+  for (int i = 0; i < num_layers; ++i) {
+    const ozz::animation::Animation& animation =
+        *_rig.animations[_character->animations[i]];
+    _character->times[i] =
+        std::fmod(_character->times[i] + kTimeStep, animation.duration());
+
+    ozz::animation::SamplingJob sampling_job;
+    sampling_job.animation = &animation;
+    sampling_job.context = &_character->contexts[i];
+    sampling_job.ratio = _character->times[i] / animation.duration();
+    sampling_job.mask = soa_mask;
+    sampling_job.output = {_workspace->layers[i].data(),
+                           static_cast<size_t>(num_soa_joints)};
+    if (!sampling_job.Run()) {
+      return false;
+    }
+    layers[i].weight = i == 0 ? _character->weight : 1.f - _character->weight;
+    layers[i].transform = sampling_job.output;
+    layers[i].mask = soa_mask;
+  }
+
+  // Blends layers.
+  const Clock::time_point blending = Clock::now();
+  ozz::animation::BlendingJob blending_job;
+  blending_job.layers = {layers, static_cast<size_t>(num_layers)};
+  blending_job.rest_pose = skeleton.joint_rest_poses();
+  blending_job.output = {_workspace->locals.data(),
+                         static_cast<size_t>(num_soa_joints)};
+  if (!blending_job.Run()) {
+    return false;
+  }
+
+  // Computes model-space matrices.
+  const Clock::time_point local_to_model = Clock::now();
+  ozz::animation::LocalToModelJob ltm_job;
+  ltm_job.skeleton = &skeleton;
+  ltm_job.mask =
+      _character->lod ? _rig.lod->joints_mask() : ozz::span<const uint8_t>();
+  ltm_job.input = blending_job.output;
+  ltm_job.output = {_workspace->models.data(),
+                    static_cast<size_t>(num_joints)};
+  if (!ltm_job.Run()) {
+    return false;
+  }
+
+  // Skins mesh.
+  const Clock::time_point skinning = Clock::now();
+  if (_rig.num_vertices > 0) {
+    for (int i = 0; i < num_joints; ++i) {
+      _workspace->skinning_matrices[i] =
+          _workspace->models[i] * _rig.inverse_bind_poses[i];
+    }
+    ozz::geometry::SkinningJob skinning_job;
+    skinning_job.vertex_count = _rig.num_vertices;
+    skinning_job.influences_count = 4;
+    skinning_job.joint_matrices = {_workspace->skinning_matrices.data(),
+                                   static_cast<size_t>(num_joints)};
+    skinning_job.joint_indices = make_span(_rig.joint_indices);
+    skinning_job.joint_indices_stride = sizeof(uint16_t) * 4;
+    skinning_job.joint_weights = make_span(_rig.joint_weights);
+    skinning_job.joint_weights_stride = sizeof(float) * 3;
+    skinning_job.in_positions = make_span(_rig.positions);
+    skinning_job.in_positions_stride = sizeof(float) * 3;
+    skinning_job.in_normals = make_span(_rig.normals);
+    skinning_job.in_normals_stride = sizeof(float) * 3;
+    skinning_job.out_positions = make_span(_workspace->out_positions);
+    skinning_job.out_positions_stride = sizeof(float) * 3;
+    skinning_job.out_normals = make_span(_workspace->out_normals);
+    skinning_job.out_normals_stride = sizeof(float) * 3;
+    if (!skinning_job.Run()) {
+      return false;
+    }
+  }
+  const Clock::time_point end = Clock::now();
+
+  double* costs = _workspace->costs;
+  costs[kSampling] += Elapsed(sampling, blending);
+  costs[kBlending] += Elapsed(blending, local_to_model);
+  costs[kLocalToModel] += Elapsed(local_to_model, skinning);
+  costs[kSkinning] += Elapsed(skinning, end);
+  return true;
+}
+
+// Updates the characters of task _task.
+void UpdateTask(int _task, void* _data) {
+  const UpdateArgs& args = *static_cast<const UpdateArgs*>(_data);
+  const int num_characters = static_cast<int>(args.characters->size());
+  const int begin = _task * OPTIONS_grain;
+  const int end = std::min(begin + OPTIONS_grain.value(), num_characters);
+  Workspace& workspace = (*args.workspaces)[_task];
+  bool success = true;
+  for (int i = begin; i < end; ++i) {
+    Character& character = (*args.characters)[i];
+    success &= UpdateCharacter((*args.rigs)[character.rig], &character,
+                               &workspace);
+  }
+  if (!success) {
+    args.success->store(false);
+  }
+}
+
+// Gets the _percentile (in range [0,1]) of sorted _values.
+double Percentile(const ozz::vector<double>& _values, double _percentile) {
+  const size_t index = static_cast<size_t>(_percentile * _values.size());
+  return _values[std::min(index, _values.size() - 1)];
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0", "Headless crowd stress test.");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  // Builds assets.
+  ozz::vector<Rig> rigs(OPTIONS_skeletons);
+  int max_joints = 0;
+  for (int i = 0; i < OPTIONS_skeletons; ++i) {
+    if (!BuildRig(i, OPTIONS_animations, &rigs[i])) {
+      ozz::log::Err() << "Failed to build crowd assets." << std::endl;
+      return EXIT_FAILURE;
+    }
+    max_joints = std::max(max_joints, rigs[i].skeleton->num_joints());
+  }
+
+  // Spreads characters over assets. Playback times and blending weights are
+  // deterministic, but uncorrelated between characters.
+  const int num_characters = OPTIONS_characters;
+  ozz::vector<Character> characters(num_characters);
+  for (int i = 0; i < num_characters; ++i) {
+    Character& character = characters[i];
+    character.rig = i % OPTIONS_skeletons;
+    const Rig& rig = rigs[character.rig];
+    character.lod = (i % 100) < static_cast<int>(OPTIONS_lod * 100.f);
+    character.weight = std::fmod(i * .618034f, 1.f);
+    for (int j = 0; j < OPTIONS_layers; ++j) {
+      character.animations[j] = (i / OPTIONS_skeletons + j) %
+                                static_cast<int>(rig.animations.size());
+      character.times[j] = std::fmod((i + j) * .618034f, 1.f) * kDuration;
+      character.contexts[j].Resize(rig.skeleton->num_joints());
+    }
+  }
+
+  // Allocates one workspace per task.
+  const int num_tasks = (num_characters + OPTIONS_grain - 1) / OPTIONS_grain;
+  const int num_soa_joints = (max_joints + 3) / 4;
+  const size_t num_floats = static_cast<size_t>(OPTIONS_vertices) * 3;
+  ozz::vector<Workspace> workspaces(num_tasks);
+  for (Workspace& workspace : workspaces) {
+    for (int i = 0; i < 2; ++i) {
+      workspace.layers[i].resize(num_soa_joints,
+                                 ozz::math::SoaTransform::identity());
+    }
+    workspace.locals.resize(num_soa_joints,
+                            ozz::math::SoaTransform::identity());
+    workspace.models.resize(max_joints, ozz::math::Float4x4::identity());
+    workspace.skinning_matrices.resize(max_joints);
+    workspace.out_positions.resize(num_floats);
+    workspace.out_normals.resize(num_floats);
+  }
+
+  ozz::WorkStealingScheduler scheduler(OPTIONS_workers);
+  ozz::log::Out() << "Crowd: " << num_characters << " characters, "
+                  << OPTIONS_skeletons << " skeletons of " << OPTIONS_joints
+                  << " joints, " << OPTIONS_animations
+                  << " animations per skeleton, " << OPTIONS_layers
+                  << " layers, " << OPTIONS_lod * 100.f << "% lod, "
+                  << OPTIONS_vertices << " vertices." << std::endl;
+  ozz::log::Out() << "Threading: " << scheduler.num_workers()
+                  << " workers, " << num_tasks << " tasks of "
+                  << OPTIONS_grain << " characters." << std::endl;
+
+  // Updates the crowd.
+  std::atomic<bool> success(true);
+  UpdateArgs args = {&rigs, &characters, &workspaces, &success};
+  ozz::vector<double> frame_times;
+  double costs[kNumStages] = {};
+  const int num_frames = std::max(OPTIONS_warmup.value(), 0) + OPTIONS_frames;
+  for (int frame = 0; frame < num_frames && success; ++frame) {
+    for (Workspace& workspace : workspaces) {
+      std::fill(workspace.costs, workspace.costs + kNumStages, 0.);
+    }
+    const Clock::time_point begin = Clock::now();
+    scheduler.ParallelFor(num_tasks, &UpdateTask, &args);
+    const Clock::time_point end = Clock::now();
+    if (frame < num_frames - OPTIONS_frames) {
+      continue;  // Warm up frame.
+    }
+    frame_times.push_back(Elapsed(begin, end));
+    for (const Workspace& workspace : workspaces) {
+      for (int i = 0; i < kNumStages; ++i) {
+        costs[i] += workspace.costs[i];
+      }
+    }
+  }
+  if (!success) {
+    ozz::log::Err() << "Failed to update crowd." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Reports frame times, in milliseconds.
+  double total_time = 0.;
+  for (const double time : frame_times) {
+    total_time += time;
+  }
+  std::sort(frame_times.begin(), frame_times.end());
+  const double ms = 1e3;
+  ozz::log::Out() << "Frame time (ms): mean "
+                  << total_time / frame_times.size() * ms << ", p50 "
+                  << Percentile(frame_times, .5) * ms << ", p90 "
+                  << Percentile(frame_times, .9) * ms << ", p99 "
+                  << Percentile(frame_times, .99) * ms << ", max "
+                  << frame_times.back() * ms << std::endl;
+  ozz::log::Out() << "Throughput: "
+                  << num_characters * frame_times.size() / total_time
+                  << " characters/s" << std::endl;
+
+  // Reports stage costs, which are cpu times summed over all threads.
+  ozz::log::Out() << "Stage costs (cpu time):" << std::endl;
+  const double updates = static_cast<double>(num_characters) *
+                         static_cast<double>(frame_times.size());
+  for (int i = 0; i < kNumStages; ++i) {
+    ozz::log::Out() << "  " << kStageNames[i] << ": "
+                    << costs[i] / frame_times.size() * ms << " ms/frame, "
+                    << costs[i] / updates * 1e9 << " ns/character"
+                    << std::endl;
+  }
+  return EXIT_SUCCESS;
+}
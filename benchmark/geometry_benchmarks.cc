@@ -0,0 +1,152 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+// Benchmarks geometry runtime jobs.
+
+#include "benchmark.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+using ozz::benchmark::State;
+
+namespace {
+// Interleaved skinning vertex formats, with up to 8 influences.
+struct SkinningVertexIn {
+  float position[3];
+  float normal[3];
+  float tangent[4];
+  uint16_t indices[8];
+  float weights[7];
+};
+struct SkinningVertexOut {
+  float position[3];
+  float normal[3];
+  float tangent[3];
+};
+
+// Defines skinned vertex components.
+enum SkinningComponents {
+  kPositions,                 // P
+  kPositionsNormals,          // PN
+  kPositionsNormalsTangents,  // PNT
+};
+
+// Skins 4096 vertices influenced by arg(0) joints, transforming arg(1)
+// components, using inverse transposed matrices for normals and tangents if
+// arg(2) is set. Arguments sets cover every SKINNING_FN specialization of
+// skinning_job.cc, influences above 4 using the generic one.
+void SkinningJob(State& _state) {
+  const int kVertexCount = 4096;
+  const int kJointCount = 64;
+  const int influences = _state.arg(0);
+  const int components = _state.arg(1);
+
+  ozz::vector<ozz::math::Float4x4> matrices(kJointCount);
+  for (int i = 0; i < kJointCount; ++i) {
+    matrices[i] = ozz::math::Float4x4::FromEuler(
+        ozz::math::simd_float4::Load(i * .1f, 0.f, i * -.05f, 0.f));
+  }
+
+  ozz::vector<SkinningVertexIn> in(kVertexCount);
+  for (int i = 0; i < kVertexCount; ++i) {
+    SkinningVertexIn& vertex = in[i];
+    for (int j = 0; j < 3; ++j) {
+      vertex.position[j] = static_cast<float>(i * (j + 1) % 17);
+      vertex.normal[j] = j == 1 ? 1.f : 0.f;
+      vertex.tangent[j] = j == 0 ? 1.f : 0.f;
+    }
+    vertex.tangent[3] = 1.f;
+    for (int j = 0; j < 8; ++j) {
+      vertex.indices[j] = static_cast<uint16_t>((i + j * 7) % kJointCount);
+    }
+    for (int j = 0; j < 7; ++j) {
+      vertex.weights[j] = 1.f / influences;
+    }
+  }
+  ozz::vector<SkinningVertexOut> out(kVertexCount);
+
+  // Spans end at the last vertex member, as strided arrays don't include the
+  // last vertex padding.
+  const SkinningVertexIn& in_last = in.back();
+  SkinningVertexOut& out_last = out.back();
+  ozz::geometry::SkinningJob job;
+  job.vertex_count = kVertexCount;
+  job.influences_count = influences;
+  job.joint_matrices = make_span(matrices);
+  job.joint_indices = {in[0].indices, in_last.indices + 8};
+  job.joint_indices_stride = sizeof(SkinningVertexIn);
+  job.joint_weights = {in[0].weights, in_last.weights + 7};
+  job.joint_weights_stride = sizeof(SkinningVertexIn);
+  job.in_positions = {in[0].position, in_last.position + 3};
+  job.in_positions_stride = sizeof(SkinningVertexIn);
+  job.out_positions = {out[0].position, out_last.position + 3};
+  job.out_positions_stride = sizeof(SkinningVertexOut);
+  if (components >= kPositionsNormals) {
+    job.in_normals = {in[0].normal, in_last.normal + 3};
+    job.in_normals_stride = sizeof(SkinningVertexIn);
+    job.out_normals = {out[0].normal, out_last.normal + 3};
+    job.out_normals_stride = sizeof(SkinningVertexOut);
+  }
+  if (components >= kPositionsNormalsTangents) {
+    job.in_tangents = {in[0].tangent, in_last.tangent + 3};
+    job.in_tangents_stride = sizeof(SkinningVertexIn);
+    job.out_tangents = {out[0].tangent, out_last.tangent + 3};
+    job.out_tangents_stride = sizeof(SkinningVertexOut);
+  }
+  if (_state.arg(2)) {
+    job.joint_inverse_transpose_matrices = make_span(matrices);
+  }
+
+  while (_state.KeepRunning()) {
+    if (!job.Run()) {
+      _state.SkipWithError("Job failed.");
+    }
+  }
+  _state.set_items_per_iteration(kVertexCount);
+}
+OZZ_BENCHMARK(SkinningJob,
+              // 1 influence.
+              {1, kPositions, 0}, {1, kPositionsNormals, 0},
+              {1, kPositionsNormalsTangents, 0}, {1, kPositionsNormals, 1},
+              {1, kPositionsNormalsTangents, 1},
+              // 2 influences.
+              {2, kPositions, 0}, {2, kPositionsNormals, 0},
+              {2, kPositionsNormalsTangents, 0}, {2, kPositionsNormals, 1},
+              {2, kPositionsNormalsTangents, 1},
+              // 3 influences.
+              {3, kPositions, 0}, {3, kPositionsNormals, 0},
+              {3, kPositionsNormalsTangents, 0}, {3, kPositionsNormals, 1},
+              {3, kPositionsNormalsTangents, 1},
+              // 4 influences.
+              {4, kPositions, 0}, {4, kPositionsNormals, 0},
+              {4, kPositionsNormalsTangents, 0}, {4, kPositionsNormals, 1},
+              {4, kPositionsNormalsTangents, 1},
+              // Any number of influences.
+              {8, kPositions, 0}, {8, kPositionsNormals, 0},
+              {8, kPositionsNormalsTangents, 0}, {8, kPositionsNormals, 1},
+              {8, kPositionsNormalsTangents, 1});
+}  // namespace
@@ -0,0 +1,224 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+// Runs ozz runtime jobs benchmarks, and reports results to the console or to
+// a machine readable (json or csv) file, for performance regression tracking.
+// Results can also be compared to a baseline csv report, failing if any
+// benchmark regressed beyond a tolerance.
+
+#include <cstdlib>
+#include <cstring>
+
+#include "benchmark.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/options/options.h"
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(filter,
+                           "Only runs benchmarks whose name contains this "
+                           "string, or one of its comma separated strings.",
+                           "", false)
+
+static bool ValidateMinTime(const ozz::options::Option& _option,
+                            int /*_argc*/) {
+  const ozz::options::FloatOption& option =
+      static_cast<const ozz::options::FloatOption&>(_option);
+  const bool valid = option.value() >= 0.f;
+  if (!valid) {
+    ozz::log::Err() << "Invalid min_time option \"" << option.value()
+                    << "\", must be positive." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_FLOAT_FN(min_time,
+                             "Minimum measuring time of each benchmark, in "
+                             "seconds. 0 runs a single iteration.",
+                             .5f, false, &ValidateMinTime)
+
+OZZ_OPTIONS_DECLARE_INT(repetitions,
+                        "Number of runs of each benchmark, the fastest one "
+                        "being reported.",
+                        1, false)
+
+static bool ValidateFormat(const ozz::options::Option& _option,
+                           int /*_argc*/) {
+  const ozz::options::StringOption& option =
+      static_cast<const ozz::options::StringOption&>(_option);
+  const bool valid = std::strcmp(option.value(), "console") == 0 ||
+                     std::strcmp(option.value(), "json") == 0 ||
+                     std::strcmp(option.value(), "csv") == 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid format option \"" << option << "\""
+                    << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_STRING_FN(
+    format, "Selects report format. Can be \"console\", \"json\" or \"csv\".",
+    "console", false, &ValidateFormat)
+
+OZZ_OPTIONS_DECLARE_STRING(output,
+                           "Specifies report output file. Report is printed "
+                           "to the console if empty.",
+                           "", false)
+
+OZZ_OPTIONS_DECLARE_STRING(baseline,
+                           "Specifies a baseline csv report to compare "
+                           "results with. Run fails if any benchmark "
+                           "regressed.",
+                           "", false)
+
+static bool ValidateMaxRegression(const ozz::options::Option& _option,
+                                  int /*_argc*/) {
+  const ozz::options::FloatOption& option =
+      static_cast<const ozz::options::FloatOption&>(_option);
+  const bool valid = option.value() > 0.f;
+  if (!valid) {
+    ozz::log::Err() << "Invalid max_regression option \"" << option.value()
+                    << "\", must be greater than 0." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_FLOAT_FN(max_regression,
+                             "Maximum ratio of a benchmark time to its "
+                             "baseline, normalized by calibration times.",
+                             1.5f, false, &ValidateMaxRegression)
+
+// Compares _results to the baseline report file, logging comparisons.
+// Returns false if baseline can't be loaded, or if any benchmark regressed.
+static bool CompareToBaseline(
+    ozz::vector<ozz::benchmark::Result>* _results) {
+  ozz::io::File file(OPTIONS_baseline, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open baseline file \"" << OPTIONS_baseline
+                    << "\"." << std::endl;
+    return false;
+  }
+  ozz::string csv(static_cast<size_t>(file.Size()), 0);
+  ozz::vector<ozz::benchmark::Result> baseline;
+  if (file.Read(&csv[0], csv.size()) != csv.size() ||
+      !ozz::benchmark::ParseCsv(csv.c_str(), &baseline)) {
+    ozz::log::Err() << "Failed to read baseline file \"" << OPTIONS_baseline
+                    << "\"." << std::endl;
+    return false;
+  }
+
+  // Calibration is required to normalize timings, even if filtered out.
+  bool calibrated = false;
+  for (const ozz::benchmark::Result& result : *_results) {
+    calibrated |= result.name == ozz::benchmark::kCalibration;
+  }
+  if (!calibrated) {
+    const ozz::vector<ozz::benchmark::Result> calibration =
+        ozz::benchmark::RunBenchmarks(ozz::benchmark::kCalibration,
+                                      OPTIONS_min_time, OPTIONS_repetitions);
+    _results->insert(_results->end(), calibration.begin(), calibration.end());
+  }
+
+  const ozz::vector<ozz::benchmark::Comparison> comparisons =
+      ozz::benchmark::Compare(make_span(*_results), make_span(baseline),
+                              OPTIONS_max_regression);
+  if (comparisons.empty()) {
+    ozz::log::Err() << "No benchmark result matches baseline \""
+                    << OPTIONS_baseline << "\"." << std::endl;
+    return false;
+  }
+
+  ozz::string report;
+  ozz::benchmark::ReportComparisons(make_span(comparisons), &report);
+  ozz::log::Log() << report;
+
+  int regressions = 0;
+  for (const ozz::benchmark::Comparison& comparison : comparisons) {
+    regressions += comparison.regressed;
+  }
+  if (regressions != 0) {
+    ozz::log::Err() << regressions << " benchmark(s) regressed beyond "
+                    << OPTIONS_max_regression << " times their baseline."
+                    << std::endl;
+    return false;
+  }
+  return true;
+}
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0", "Benchmarks ozz runtime jobs.");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  ozz::vector<ozz::benchmark::Result> results =
+      ozz::benchmark::RunBenchmarks(OPTIONS_filter, OPTIONS_min_time,
+                                    OPTIONS_repetitions);
+  if (results.empty()) {
+    ozz::log::Err() << "No benchmark matches filter \"" << OPTIONS_filter
+                    << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ozz::string report;
+  if (std::strcmp(OPTIONS_format, "json") == 0) {
+    ozz::benchmark::ReportJson(make_span(results), &report);
+  } else if (std::strcmp(OPTIONS_format, "csv") == 0) {
+    ozz::benchmark::ReportCsv(make_span(results), &report);
+  } else {
+    ozz::benchmark::ReportConsole(make_span(results), &report);
+  }
+
+  if (*OPTIONS_output.value() == 0) {
+    ozz::log::Out() << report;
+  } else {
+    ozz::io::File file(OPTIONS_output, "wb");
+    if (!file.opened() ||
+        file.Write(report.c_str(), report.size()) != report.size()) {
+      ozz::log::Err() << "Failed to write report file \"" << OPTIONS_output
+                      << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    ozz::log::Log() << "Benchmarks report written to \"" << OPTIONS_output
+                    << "\"." << std::endl;
+  }
+
+  // Failed benchmarks are reported, but fail the whole run.
+  for (const ozz::benchmark::Result& result : results) {
+    if (!result.error.empty()) {
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (*OPTIONS_baseline.value() != 0 && !CompareToBaseline(&results)) {
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
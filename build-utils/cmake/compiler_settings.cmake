@@ -42,6 +42,20 @@ if(ozz_build_simd_ref)
   add_compile_definitions(OZZ_BUILD_SIMD_REF)
 endif()
 
+# Runtime jobs profiling zones instrumentation
+if(ozz_build_profile)
+  add_compile_definitions(OZZ_BUILD_PROFILE)
+endif()
+
+# Maximum log level built in
+if(ozz_build_log_level STREQUAL "silent")
+  add_compile_definitions(OZZ_LOG_MAX_LEVEL=0)
+elseif(ozz_build_log_level STREQUAL "standard")
+  add_compile_definitions(OZZ_LOG_MAX_LEVEL=1)
+elseif(NOT ozz_build_log_level STREQUAL "verbose")
+  message(FATAL_ERROR "Invalid ozz_build_log_level \"${ozz_build_log_level}\", must be silent, standard or verbose.")
+endif()
+
 # --------------------------------------
 # Modify default MSVC compilation flags
 if(CMAKE_CXX_COMPILER_ID STREQUAL "MSVC")
@@ -104,9 +118,10 @@ else()
     SET(CMAKE_EXECUTABLE_SUFFIX ".html")
     add_link_options(-s DISABLE_DEPRECATED_FIND_EVENT_TARGET_BEHAVIOR=0)
 
-    # if(NOT ozz_build_simd_ref)
-    # set_property(DIRECTORY APPEND PROPERTY COMPILE_OPTIONS "-msse2")
-    # endif()
+    # Enables WebAssembly SIMD128 instructions, used by simd math library.
+    if(NOT ozz_build_simd_ref)
+      add_compile_options(-msimd128)
+    endif()
   endif()
 endif()
 
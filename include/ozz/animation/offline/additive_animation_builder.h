@@ -29,6 +29,7 @@
 #define OZZ_OZZ_ANIMATION_OFFLINE_ADDITIVE_ANIMATION_BUILDER_H_
 
 #include "ozz/animation/offline/export.h"
+#include "ozz/base/parallel_for.h"
 #include "ozz/base/platform.h"
 #include "ozz/base/span.h"
 
@@ -70,6 +71,29 @@ class OZZ_ANIMOFFLINE_DLL AdditiveAnimationBuilder {
   bool operator()(const RawAnimation& _input,
                   const span<const math::Transform>& _reference_pose,
                   RawAnimation* _output) const;
+
+  // Builds delta animations from all _inputs, against the same
+  // _reference_pose, and fills _outputs accordingly. The reference pose is
+  // prepared once for all clips, and deltas are computed 4 keys at a time.
+  // Every clip is a parallel_for task.
+  // Returns false if _outputs is smaller than _inputs or if any clip fails to
+  // build (see single clip version), in which case the corresponding output
+  // is reset to an empty animation.
+  bool operator()(span<const RawAnimation> _inputs,
+                  const span<const math::Transform>& _reference_pose,
+                  span<RawAnimation> _outputs) const;
+
+  // Task function and task scheduler hook, see ozz/base/parallel_for.h. Each
+  // task builds a clip.
+  typedef ozz::ParallelForTask ParallelForTask;
+  typedef ozz::ParallelForHook ParallelFor;
+
+  // Optional task scheduler hook, used by the batch version. If nullptr
+  // (default), clips are built serially by the calling thread.
+  ParallelFor parallel_for;
+
+  // User data provided to parallel_for.
+  void* parallel_for_user_data;
 };
 }  // namespace offline
 }  // namespace animation
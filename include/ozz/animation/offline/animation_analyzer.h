@@ -0,0 +1,141 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_ANALYZER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_ANALYZER_H_
+
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares runtime animation type.
+class Animation;
+
+namespace offline {
+
+// Defines the analysis of a runtime animation memory footprint and keys
+// density, used to prioritize compression work on animation libraries.
+// Sizes are expressed in bytes. Keys sizes include per key additional data
+// (previous key offsets of bidirectional animations, keys indices of random
+// access animations and tangents of cubic animations).
+struct OZZ_ANIMOFFLINE_DLL AnimationAnalysis {
+  AnimationAnalysis();
+
+  // Per track analysis.
+  struct Track {
+    // Number of keys per transformation type.
+    int translation_keys;
+    int rotation_keys;
+    int scale_keys;
+
+    // Keys (all transformation types) per second of animation.
+    float keys_per_second;
+
+    // Size of all track keys.
+    size_t size;
+
+    // Constant track candidates: transformation types with more than the 2
+    // keys a constant track requires, whose value doesn't vary more than the
+    // analyzer tolerance.
+    bool constant_translation;
+    bool constant_rotation;
+    bool constant_scale;
+  };
+
+  // Projected keys size when keys are limited to a lower frequency, as a
+  // level of detail would.
+  struct Tier {
+    float frequency;  // Maximum keys per second, per track.
+    size_t size;      // Projected keys size.
+  };
+
+  // Animation duration in seconds.
+  float duration;
+
+  // Animation size in memory, see Animation::size().
+  size_t size;
+
+  // Size of all animation keys, sum of tracks size.
+  size_t keys_size;
+
+  // Animation size per second of animation.
+  float bytes_per_second;
+
+  // Number of constant candidates, counting every transformation type.
+  int num_constant_candidates;
+
+  // Keys size saved by reducing constant candidates to 2 keys.
+  size_t constant_savings;
+
+  // Projected keys size with the most compact keys formats: 16 bits ratios,
+  // and rotations packed to 32 bits (see AnimationBuilder::compact_ratios and
+  // rotation_format).
+  size_t compact_size;
+
+  // Per track analysis, one per animation track.
+  ozz::vector<Track> tracks;
+
+  // Per level of detail projection, one per analyzer frequency.
+  ozz::vector<Tier> tiers;
+};
+
+// Analyzes a runtime animation. Keys are counted and measured in their runtime
+// format, while constant tracks are detected by sampling the animation at a
+// fixed frame rate.
+class OZZ_ANIMOFFLINE_DLL AnimationAnalyzer {
+ public:
+  // Initializes the analyzer with default parameters.
+  AnimationAnalyzer();
+
+  // Maximum translation and scale variation (per component) of a constant
+  // track. Default is 1e-3 (1mm for translations).
+  float translation_tolerance;
+  float scale_tolerance;
+
+  // Maximum rotation angle (radian) of a constant track. Default is 1e-3.
+  float rotation_tolerance;
+
+  // Frequency used to sample the animation, in frames per second. Must be
+  // greater than 0. Default is 30.
+  float frame_rate;
+
+  // Levels of detail frequencies to project keys size for, in keys per
+  // second. Default is {30, 15, 7.5}.
+  ozz::vector<float> tiers;
+
+  // Analyzes _animation to _analysis. Returns false if analyzer parameters are
+  // invalid, or if sampling failed, _analysis is then left empty.
+  bool operator()(const Animation& _animation,
+                  AnimationAnalysis* _analysis) const;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_ANALYZER_H_
@@ -47,12 +47,152 @@ struct RawAnimation;
 // No optimization at all is performed on the raw animation.
 class OZZ_ANIMOFFLINE_DLL AnimationBuilder {
  public:
+  // Initializes the builder with default parameters.
+  AnimationBuilder();
+
   // Creates an Animation based on _raw_animation and *this builder parameters.
   // Returns a valid Animation on success.
   // See RawAnimation::Validate() for more details about failure reasons.
   // The animation is returned as an unique_ptr as ownership is given back to
   // the caller.
   unique_ptr<Animation> operator()(const RawAnimation& _raw_animation) const;
+
+  // Builds _animation in place, based on _raw_animation and *this builder
+  // parameters. _animation buffer is reused if it's big enough, so rebuilding
+  // an animation of the same size (or smaller) doesn't allocate any runtime
+  // memory. Otherwise it's allocated with _animation allocator, see Animation
+  // constructor. Other animation members aren't affected, but sampling
+  // contexts bound to _animation must be invalidated.
+  // Returns false if _animation is nullptr, or if _raw_animation isn't valid,
+  // in which case _animation is left unchanged. See RawAnimation::Validate()
+  // for more details about failure reasons.
+  bool operator()(const RawAnimation& _raw_animation,
+                  Animation* _animation) const;
+
+  // Interval (in seconds) between two animation seek points. Seek points are
+  // snapshots of the sampling state that allow SamplingJob::Context to restart
+  // from the nearest point when an animation is sampled backward (looping,
+  // scrubbing...) or jumps far forward, in O(tracks) rather than O(keys). Each
+  // seek point costs 4 + 24 * num_soa_tracks bytes.
+  // Default value is 0, which disables seek points.
+  float seek_interval;
+
+  // Builds previous keys offsets, which allow SamplingJob to step backward
+  // (reverse playback, ping-pong loops...) as efficiently as forward, instead
+  // of resetting its context. This costs 2 bytes per key.
+  // Default value is false.
+  bool bidirectional;
+
+  // Defines rotation keys storage formats.
+  enum RotationFormat {
+    // 12 bytes per key: 32 bits ratio, 3 x 16 bits quaternion components.
+    kRotationDefault,
+    // 10 bytes per key: 16 bits ratio, 3 x 16 bits quaternion components.
+    kRotationCompact48,
+    // 8 bytes per key: 16 bits ratio, 11-11-10 bits quaternion components.
+    kRotationCompact32,
+  };
+
+  // Rotation keys storage format. Compact formats quantize key ratios to 16
+  // bits, which requires keys of a track to be at least duration / 65535
+  // apart. Builder falls back to kRotationDefault if it's not the case.
+  // Default value is kRotationDefault.
+  RotationFormat rotation_format;
+
+  // Quantizes translation and scale keys ratios to 16 bits, instead of 32 bits
+  // floats, which shrinks keys from 12 to 8 bytes. As for compact rotation
+  // formats, keys of a track must be at least duration / 65535 apart, or the
+  // builder falls back to 32 bits ratios for this type of keys. Rotation keys
+  // ratios are quantized according to rotation_format.
+  // Default value is false.
+  bool compact_ratios;
+
+  // Builds per track keys indices, which allow StatelessSamplingJob to sample
+  // the animation at any ratio without a context, in O(tracks * log(keys)).
+  // SamplingJob also uses them to search for keys when ratio changes a lot
+  // between two updates (decimated updates, jumps...), instead of iterating
+  // all the keys in between.
+  // Indices cost 4 bytes per key (and per track) at runtime, but aren't
+  // serialized as they are rebuilt when the animation is loaded.
+  // Default value is false.
+  bool random_access;
+
+  // Interpolates translations and scales with cubic Hermite curves instead of
+  // linearly, using tangents computed from neighbor keys (Catmull-Rom like).
+  // Smooth motions require far less keys than with linear interpolation, see
+  // AnimationOptimizer::cubic_interpolation. Rotations are still linearly
+  // interpolated. Tangents cost 6 bytes per translation and scale key.
+  // Default value is false.
+  bool cubic_interpolation;
+
+ private:
+  friend class IncrementalAnimationBuilder;
+
+  // Raw keys being built, see SortingKeys definition.
+  struct SortingKeys;
+
+  // Build stages, in order. Keys of all tracks must be copied before building
+  // _animation.
+  static void ReserveKeys(const RawAnimation& _input, SortingKeys* _keys);
+  static void CopyKeys(const RawAnimation& _input, int _begin, int _end,
+                       SortingKeys* _keys);
+  void Build(const RawAnimation& _input, SortingKeys* _keys,
+             Animation* _animation) const;
+};
+
+// Builds an animation incrementally, a bounded number of tracks per Step()
+// call, so that building a long animation can be spread over an editor ticks
+// (or over a coroutine resumptions) without freezing it nor requiring a
+// dedicated thread. Result is the same as AnimationBuilder::operator().
+// Raw tracks keys are copied Step() by Step(), the last step sorts all keys
+// and fills the runtime animation, which can't be divided as keys are sorted
+// across tracks.
+class OZZ_ANIMOFFLINE_DLL IncrementalAnimationBuilder {
+ public:
+  IncrementalAnimationBuilder();
+
+  // Disables copy and assignation.
+  IncrementalAnimationBuilder(IncrementalAnimationBuilder const&) = delete;
+  IncrementalAnimationBuilder& operator=(IncrementalAnimationBuilder const&) =
+      delete;
+
+  ~IncrementalAnimationBuilder();
+
+  // Starts building _input to _animation, with _builder settings which are
+  // copied. _input must remain valid and unchanged until the build is done,
+  // and _animation is only modified by the last step. Cancels any build in
+  // progress. Returns false if _animation is nullptr or if _input isn't
+  // valid, in which case the build is done and failed.
+  bool Begin(const AnimationBuilder& _builder, const RawAnimation& _input,
+             Animation* _animation);
+
+  // Processes at most _max_tracks tracks (at least 1). Returns true once the
+  // build is done, false if Step() must be called again.
+  bool Step(int _max_tracks);
+
+  // Cancels the build in progress, leaving the animation unchanged.
+  void Cancel();
+
+  // Tells if the build is done, either completed or failed.
+  bool done() const { return !keys_; }
+
+  // Tells if last build completed successfully.
+  bool succeeded() const { return succeeded_; }
+
+  // Gets build progress, in range [0,1].
+  float progress() const;
+
+ private:
+  AnimationBuilder builder_;
+  const RawAnimation* input_;
+  Animation* animation_;
+
+  // Keys being built, nullptr when no build is in progress.
+  AnimationBuilder::SortingKeys* keys_;
+
+  // Number of tracks whose keys are copied.
+  int copied_;
+  bool succeeded_;
 };
 }  // namespace offline
 }  // namespace animation
@@ -30,6 +30,8 @@
 
 #include "ozz/animation/offline/export.h"
 #include "ozz/base/containers/map.h"
+#include "ozz/base/parallel_for.h"
+#include "ozz/base/span.h"
 
 namespace ozz {
 namespace animation {
@@ -70,6 +72,20 @@ class OZZ_ANIMOFFLINE_DLL AnimationOptimizer {
   bool operator()(const RawAnimation& _input, const Skeleton& _skeleton,
                   RawAnimation* _output) const;
 
+  // Optimizes _input to a ladder of levels of detail in a single pass, one
+  // output animation per tolerance. _tolerances[i] replaces global setting
+  // tolerance (or error_budget if enabled) for level i, and joints tolerances
+  // are scaled in the same proportion. Hierarchical lengths and scales are
+  // only computed once for all levels. Note that each level is optimized from
+  // _input, so errors don't accumulate from one level to the next.
+  // Returns true on success and fills _outputs animations. Returns false on
+  // failure, if _outputs is smaller than _tolerances, or if a tolerance is
+  // negative (or positive while reference tolerance is 0), and resets _outputs
+  // to empty animations.
+  bool operator()(const RawAnimation& _input, const Skeleton& _skeleton,
+                  span<const float> _tolerances,
+                  span<RawAnimation> _outputs) const;
+
   // Optimization settings.
   struct Setting {
     // Default settings
@@ -97,6 +113,110 @@ class OZZ_ANIMOFFLINE_DLL AnimationOptimizer {
   // Per joint override of optimization settings.
   typedef ozz::map<int, Setting> JointsSetting;
   JointsSetting joints_setting_override;
+
+  // Defines keyframes reduction algorithms.
+  enum Reduction {
+    // Ramer-Douglas-Peucker decimation, which selects keys among input ones.
+    kDecimation,
+    // Least-squares curve fitting, which also moves remaining keys values so
+    // that the curve passes as close as possible to all input keys. This
+    // produces less keys for noisy data such as motion capture, at a higher
+    // optimization cost. Decimation result is used instead if it has less
+    // keys.
+    kFitting,
+  };
+
+  // Keyframes reduction algorithm.
+  // Default value is kDecimation.
+  Reduction reduction;
+
+  // Decimates translations and scales assuming they will be interpolated with
+  // cubic Hermite curves, which allows to remove far more keys from smooth
+  // motions. Output animation must then be built with
+  // AnimationBuilder::cubic_interpolation enabled. Rotations are still
+  // decimated assuming linear interpolation.
+  // Default value is false.
+  bool cubic_interpolation;
+
+  // Automatic tolerances mode, enabled if positive. It's the maximum error
+  // allowed on any end effector (measured at setting distance), which is
+  // distributed to joints tolerances, replacing setting and override ones
+  // (distances still apply). Joints sensitivity is first measured by
+  // optimizing every track with a ladder of tolerances. Then tolerances are
+  // allocated to minimize the total number of keys, while the sum of the
+  // tolerances along every chain from the root to a leaf remains within the
+  // budget. Leaves, whose tolerance affects a single chain, usually get more
+  // slack than root and spine joints.
+  // For levels of detail, tolerances scale the error budget instead of the
+  // global setting tolerance.
+  // Default value is 0, which uses setting and joints_setting_override
+  // tolerances.
+  float error_budget;
+
+  // Task function and task scheduler hook, see ozz/base/parallel_for.h.
+  typedef ozz::ParallelForTask ParallelForTask;
+  typedef ozz::ParallelForHook ParallelFor;
+
+  // Optional task scheduler hook. Tracks are independent once hierarchical
+  // lengths are computed, so every track (of every level of detail) is a
+  // task. If nullptr (default), tracks are optimized serially by the calling
+  // thread.
+  ParallelFor parallel_for;
+
+  // User data provided to parallel_for.
+  void* parallel_for_user_data;
+};
+
+// Optimizes an animation incrementally, a bounded number of tracks per Step()
+// call, so that optimizing a long animation can be spread over an editor
+// ticks (or over a coroutine resumptions) without freezing it nor requiring a
+// dedicated thread. Result is the same as AnimationOptimizer::operator().
+// Joints hierarchical specs (and error budget allocation, which optimizes all
+// tracks a few times) are computed by Begin(), then each track is optimized
+// independently. parallel_for hook is ignored, as tracks are optimized by the
+// thread calling Step().
+class OZZ_ANIMOFFLINE_DLL IncrementalAnimationOptimizer {
+ public:
+  IncrementalAnimationOptimizer();
+
+  // Disables copy and assignation.
+  IncrementalAnimationOptimizer(IncrementalAnimationOptimizer const&) = delete;
+  IncrementalAnimationOptimizer& operator=(
+      IncrementalAnimationOptimizer const&) = delete;
+
+  ~IncrementalAnimationOptimizer();
+
+  // Starts optimizing _input to _output, with _optimizer settings which are
+  // copied. _input and _skeleton must remain valid and unchanged until the
+  // optimization is done, and _output must not be used meanwhile. Cancels any
+  // optimization in progress. Returns false if _output is nullptr, if _input
+  // isn't valid or doesn't match _skeleton, in which case the optimization
+  // is done and failed.
+  bool Begin(const AnimationOptimizer& _optimizer, const RawAnimation& _input,
+             const Skeleton& _skeleton, RawAnimation* _output);
+
+  // Optimizes at most _max_tracks tracks (at least 1). Returns true once the
+  // optimization is done, false if Step() must be called again.
+  bool Step(int _max_tracks);
+
+  // Cancels the optimization in progress, leaving output animation partially
+  // optimized.
+  void Cancel();
+
+  // Tells if the optimization is done, either completed or failed.
+  bool done() const { return !impl_; }
+
+  // Tells if last optimization completed successfully.
+  bool succeeded() const { return succeeded_; }
+
+  // Gets optimization progress, in range [0,1].
+  float progress() const;
+
+ private:
+  // Optimization state, nullptr when no optimization is in progress.
+  struct Impl;
+  Impl* impl_;
+  bool succeeded_;
 };
 }  // namespace offline
 }  // namespace animation
@@ -0,0 +1,127 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_RECORDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_RECORDER_H_
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace math {
+struct SoaTransform;
+}
+namespace animation {
+
+// Forward declares the runtime animation type.
+class Animation;
+
+namespace offline {
+
+// Records poses computed at runtime (ragdoll, IK, procedural...) into an
+// Animation. Every recorded pose is decimated immediately, so only the keys
+// that can't be interpolated (within tolerances) are kept in memory, instead
+// of all recorded poses. Decimation is online: a pose is decided to be a key
+// (or not) at most max_latency frames after it was recorded, which bounds the
+// memory and cpu cost of each recorded frame.
+// The animation can be built at any time from the keys recorded so far.
+class OZZ_ANIMOFFLINE_DLL AnimationRecorder {
+ public:
+  // Initializes the recorder with default tolerances (favoring quality).
+  AnimationRecorder();
+
+  // Non-copyable.
+  AnimationRecorder(const AnimationRecorder&) = delete;
+  AnimationRecorder& operator=(const AnimationRecorder&) = delete;
+
+  ~AnimationRecorder();
+
+  // Starts a new recording of _num_tracks joints, named _name. Previous
+  // recording is discarded.
+  // Tolerances and max_latency are read by this function, they can't be
+  // changed during the recording.
+  void Start(int _num_tracks, const char* _name = "");
+
+  // Records pose _pose at time _time (in seconds). The first recorded pose
+  // defines the beginning of the animation.
+  // Returns false if recording wasn't started, if _pose is smaller than the
+  // number of recorded tracks, or if _time isn't after the previously
+  // recorded time.
+  bool Record(float _time, span<const math::SoaTransform> _pose);
+
+  // Builds _animation in place (see AnimationBuilder), from the poses recorded
+  // so far, with *this builder parameters. The last recorded pose ends the
+  // animation. Recording can go on afterwards.
+  // Returns false if less than 2 poses were recorded.
+  bool Build(Animation* _animation);
+
+  // Gets the number of recorded poses.
+  int num_frames() const { return num_frames_; }
+
+  // Gets the number of keys kept so far, all tracks and transformations
+  // included.
+  size_t num_keys() const;
+
+  // Translation tolerance, in meters.
+  // Default value is 1e-3 (1 mm).
+  float translation_tolerance;
+
+  // Rotation tolerance, in radians.
+  // Default value is 1e-3.
+  float rotation_tolerance;
+
+  // Scale tolerance, as a scale factor difference.
+  // Default value is 1e-3.
+  float scale_tolerance;
+
+  // Maximum number of frames a recorded pose can stay undecided, before it's
+  // forced as a key.
+  // Default value is 16.
+  int max_latency;
+
+  // Builder used to build the runtime animation.
+  AnimationBuilder builder;
+
+ private:
+  // Recorded keys and streaming decimators, declared in the implementation
+  // file as decimators are private.
+  struct Recording;
+  Recording* recording_;
+
+  // Time of the first and last recorded poses.
+  float first_time_;
+  float last_time_;
+
+  // Number of recorded poses.
+  int num_frames_;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_RECORDER_H_
@@ -0,0 +1,141 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_VALIDATOR_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_VALIDATOR_H_
+
+#include "ozz/animation/offline/animation_optimizer.h"
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declare runtime types.
+class Animation;
+class Skeleton;
+
+namespace offline {
+
+// Forward declare offline animation type.
+struct RawAnimation;
+
+// Measures the error of runtime animations against the raw animations they were
+// built (and optimized) from. AnimationOptimizer only estimates the error it
+// generates, this validator measures it: both animations are sampled at a fixed
+// rate and converted to model space, where the error of each joint is the
+// maximum distance between points transformed by the raw and the runtime
+// model-space matrices. Points are placed at Setting::distance from the joint,
+// along each of its axes, emulating skinned vertices as the optimizer does.
+// Validation of many clips can be distributed with the parallel_for hook.
+class OZZ_ANIMOFFLINE_DLL AnimationValidator {
+ public:
+  // Initializes the validator with AnimationOptimizer default settings.
+  AnimationValidator();
+
+  // Error measured for a joint, in the same unit as the animation.
+  struct JointError {
+    // Maximum error over all sampled frames.
+    float max;
+
+    // Error that percentile ratio of the sampled frames don't exceed.
+    float percentile;
+
+    // Time (in seconds) of the frame where max error was measured.
+    float max_time;
+
+    // Tolerance of this joint, from setting or joints_setting_override.
+    float tolerance;
+  };
+
+  // Validation report of a clip.
+  struct Report {
+    // Per joint errors, in skeleton joint order.
+    ozz::vector<JointError> joints;
+
+    // Number of sampled frames.
+    int num_frames;
+
+    // Joint with the highest max error, -1 if no joint.
+    int worst_joint;
+
+    // Number of joints whose max error exceeds their tolerance. Clip is within
+    // budget if it's 0.
+    int num_joints_over_tolerance;
+  };
+
+  // Validates _animation against _raw_animation, for _skeleton, and fills
+  // _report.
+  // Returns false if _raw_animation is invalid, or if animations tracks count
+  // doesn't match _skeleton joints count, in which case _report is cleared.
+  bool operator()(const RawAnimation& _raw_animation,
+                  const Animation& _animation, const Skeleton& _skeleton,
+                  Report* _report) const;
+
+  // A clip to validate.
+  struct Clip {
+    const RawAnimation* raw_animation;
+    const Animation* animation;
+  };
+
+  // Validates all _clips for _skeleton, and fills _reports accordingly. Every
+  // clip is a parallel_for task.
+  // Returns false if _reports is smaller than _clips or if any clip fails to
+  // validate (see single clip version).
+  bool operator()(span<const Clip> _clips, const Skeleton& _skeleton,
+                  span<Report> _reports) const;
+
+  // Global error settings, AnimationOptimizer ones.
+  AnimationOptimizer::Setting setting;
+
+  // Per joint override of error settings.
+  AnimationOptimizer::JointsSetting joints_setting_override;
+
+  // Sampling rate, in hertz.
+  // Default value is 30.
+  float frequency;
+
+  // Ratio of the frames used to compute JointError::percentile, in [0,1].
+  // Default value is .95.
+  float percentile;
+
+  // Task function and task scheduler hook, see AnimationOptimizer.
+  typedef AnimationOptimizer::ParallelForTask ParallelForTask;
+  typedef AnimationOptimizer::ParallelFor ParallelFor;
+
+  // Optional task scheduler hook. If nullptr (default), clips are validated
+  // serially by the calling thread.
+  ParallelFor parallel_for;
+
+  // User data provided to parallel_for.
+  void* parallel_for_user_data;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_VALIDATOR_H_
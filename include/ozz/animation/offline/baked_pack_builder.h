@@ -0,0 +1,90 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_BAKED_PACK_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_BAKED_PACK_BUILDER_H_
+
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace io {
+class Stream;
+}  // namespace io
+namespace animation {
+
+// Forward declares runtime types.
+class Skeleton;
+class Animation;
+class FloatTrack;
+class Float2Track;
+class Float3Track;
+class Float4Track;
+class QuaternionTrack;
+
+namespace offline {
+
+// Defines the class responsible of baking a skeleton, its animations and
+// tracks to a single BakedPack image. Objects images are laid out one after
+// the other, aligned so that the whole pack can be read at once and used in
+// place at runtime, see BakedPack.
+// As images use the native endianness, packs must be baked on a platform with
+// the same endianness as the target one.
+class OZZ_ANIMOFFLINE_DLL BakedPackBuilder {
+ public:
+  // Initializes the builder with no object to bake.
+  BakedPackBuilder();
+
+  // Objects to bake, which aren't owned by the builder. Skeleton is optional,
+  // and all pointers must be valid when baking.
+  const Skeleton* skeleton;
+  ozz::vector<const Animation*> animations;
+  ozz::vector<const FloatTrack*> float_tracks;
+  ozz::vector<const Float2Track*> float2_tracks;
+  ozz::vector<const Float3Track*> float3_tracks;
+  ozz::vector<const Float4Track*> float4_tracks;
+  ozz::vector<const QuaternionTrack*> quaternion_tracks;
+
+  // Gets the size of the baked pack image, in bytes.
+  size_t image_size() const;
+
+  // Bakes objects to _image, which must be image_size() bytes big at least,
+  // and aligned to BakedPack::kImageAlignment.
+  // Returns false if _image is too small or misaligned, or if an object
+  // pointer is nullptr.
+  bool operator()(span<byte> _image) const;
+
+  // Bakes objects to _stream, which must be opened for writing. Note that
+  // image alignment is relative to the stream position.
+  // Returns false if baking or writing failed.
+  bool operator()(io::Stream* _stream) const;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_BAKED_PACK_BUILDER_H_
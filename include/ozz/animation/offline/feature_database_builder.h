@@ -0,0 +1,111 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_FEATURE_DATABASE_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_FEATURE_DATABASE_BUILDER_H_
+
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/memory/unique_ptr.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime types.
+class Skeleton;
+class Animation;
+class FeatureDatabase;
+
+namespace offline {
+
+// Defines the class responsible of building motion matching FeatureDatabase
+// instances from a set of animation clips. Clips are sampled at a fixed frame
+// rate (both first and last frames are sampled, like PoseAtlasBuilder) with a
+// SamplingJob and a LocalToModelJob, and features are extracted from
+// model-space poses.
+// Features are expressed in the character frame: the root joint position
+// projected on the ground (y = 0), and its heading (forward z axis projected
+// on the ground). Each frame features are laid out as follows:
+// -for each joint feature, in order: its position (x, y, z) if position
+// weight is greater than 0, then its velocity (x, y, z) if velocity weight is
+// greater than 0.
+// -the ground position (x, z) of the character frame at each trajectory time,
+// if trajectory position weight is greater than 0.
+// -the ground direction (x, z) of the character frame at each trajectory
+// time, if trajectory direction weight is greater than 0.
+// Every joint position, joint velocity, trajectory positions and trajectory
+// directions group is normalized with its own mean and standard deviation,
+// then scaled by its weight.
+class OZZ_ANIMOFFLINE_DLL FeatureDatabaseBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  FeatureDatabaseBuilder();
+
+  // Creates a FeatureDatabase from _animations, whose tracks must match
+  // _skeleton joints. A clip is created per animation, in order.
+  // Returns a valid FeatureDatabase on success, an empty unique_ptr on failure,
+  // which happens if parameters are invalid, if no feature is enabled, or if
+  // an animation doesn't match _skeleton.
+  // The database is returned as an unique_ptr as ownership is given back to
+  // the caller.
+  unique_ptr<FeatureDatabase> operator()(
+      const Skeleton& _skeleton,
+      span<const Animation* const> _animations) const;
+
+  // Sampling frequency, in frames per second. Must be greater than 0. Default
+  // is 30.
+  float sample_rate;
+
+  // Joint that defines the character frame. Default is 0.
+  int root_joint;
+
+  // Defines a joint feature.
+  struct JointFeature {
+    // Joint index in the skeleton.
+    int joint;
+    // Weights of the joint position and velocity. Features with a weight
+    // lower or equal to 0 are disabled.
+    float position_weight;
+    float velocity_weight;
+  };
+
+  // Joint features. Default is empty.
+  ozz::vector<JointFeature> joints;
+
+  // Future times, in seconds, where the trajectory is sampled. Times beyond
+  // clip end are clamped to the last frame. Default is empty.
+  ozz::vector<float> trajectory_times;
+
+  // Weights of trajectory positions and directions. Default is 1.
+  float trajectory_position_weight;
+  float trajectory_direction_weight;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_FEATURE_DATABASE_BUILDER_H_
@@ -0,0 +1,77 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_LOCAL_TO_MODEL_CODEGEN_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_LOCAL_TO_MODEL_CODEGEN_H_
+
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime skeleton type.
+class Skeleton;
+
+namespace offline {
+
+// Generates C++ source code of a local-to-model function specialized for a
+// skeleton hierarchy, see LocalToModelFn. Parent indices are baked as
+// constants, and the loop over joints is fully unrolled, so the generated
+// function has no branch. The function can be registered to the runtime,
+// which finds it from the skeleton hierarchy hash, see FindLocalToModel().
+// Optionally, a skinning matrices palette function is also generated, with
+// mesh joint remaps baked as constants. It computes output[i] =
+// models[joint_remaps[i]] * inverse_bind_poses[i].
+// Generated sources only depend on ozz_animation runtime headers.
+class OZZ_ANIMOFFLINE_DLL LocalToModelCodegen {
+ public:
+  // Initializes the generator with default parameters.
+  LocalToModelCodegen();
+
+  // Generates _skeleton specialized functions source code to _source.
+  // Returns false if _skeleton is empty, if name isn't a valid C++
+  // identifier, or if any joint remap is out of _skeleton range.
+  bool operator()(const Skeleton& _skeleton, ozz::string* _source) const;
+
+  // Name of the generated local-to-model function. Palette function is named
+  // name + "Palette". Default is "LocalToModel".
+  ozz::string name;
+
+  // Registers the generated local-to-model function to the runtime, using a
+  // static LocalToModelRegistrar. Default is true.
+  bool register_function;
+
+  // Mesh joint remaps. The palette function is only generated if it isn't
+  // empty. Default is empty.
+  span<const uint16_t> joint_remaps;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_LOCAL_TO_MODEL_CODEGEN_H_
@@ -0,0 +1,85 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_LOD_ANIMATION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_LOD_ANIMATION_BUILDER_H_
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/animation_optimizer.h"
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime types.
+class LODAnimation;
+class Skeleton;
+
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building runtime LOD animation instances
+// from offline raw animations.
+// The raw animation is optimized once per level of detail tolerance, in a
+// single AnimationOptimizer pass that shares hierarchical analysis among
+// levels. Each level is then built as an independent Animation.
+class OZZ_ANIMOFFLINE_DLL LODAnimationBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  LODAnimationBuilder();
+
+  // Creates a LODAnimation based on _raw_animation, _skeleton and *this
+  // builder parameters.
+  // Returns a valid LODAnimation on success, or nullptr if optimization or
+  // building failed (see AnimationOptimizer and AnimationBuilder), or if
+  // tolerances is empty or not strictly increasing.
+  // The animation is returned as an unique_ptr as ownership is given back to
+  // the caller.
+  unique_ptr<LODAnimation> operator()(const RawAnimation& _raw_animation,
+                                      const Skeleton& _skeleton) const;
+
+  // Tolerance of every level of detail, strictly increasing, see
+  // AnimationOptimizer::Setting::tolerance. Default value is 1mm, 5mm and
+  // 2cm.
+  ozz::vector<float> tolerances;
+
+  // Optimizer used for every level. Its setting tolerance is the reference
+  // that levels tolerances replace, joints override tolerances being scaled in
+  // the same proportion.
+  AnimationOptimizer optimizer;
+
+  // Builder used for every level, which defines keys formats.
+  AnimationBuilder builder;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_LOD_ANIMATION_BUILDER_H_
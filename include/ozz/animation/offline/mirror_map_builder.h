@@ -0,0 +1,83 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_MIRROR_MAP_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_MIRROR_MAP_BUILDER_H_
+
+#include "ozz/animation/offline/export.h"
+#include "ozz/animation/runtime/mirror_map.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime skeleton type.
+class Skeleton;
+
+namespace offline {
+
+// Defines the class responsible of building MirrorMap instances, pairing
+// joints of a skeleton from their names. A joint is paired with the joint
+// whose name is obtained by replacing a left pattern by its right counterpart
+// (ie: "hand_l" and "hand_r"), or the opposite. Patterns are tried in order,
+// the first one that leads to an existing joint is used. Joints without
+// counterpart are mirrored onto themselves.
+class OZZ_ANIMOFFLINE_DLL MirrorMapBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  MirrorMapBuilder();
+
+  // Creates a MirrorMap for _skeleton, based on *this builder parameters.
+  // Returns a valid MirrorMap on success, an empty unique_ptr on failure,
+  // which happens if _skeleton doesn't store names strings, or if a joint
+  // would be paired with a joint that's already paired with another one.
+  // The map is returned as an unique_ptr as ownership is given back to the
+  // caller.
+  unique_ptr<MirrorMap> operator()(const Skeleton& _skeleton) const;
+
+  // Axis normal to the mirror plane.
+  // Default value is MirrorMap::kX.
+  MirrorMap::Axis axis;
+
+  // Defines a left/right names pattern. Patterns are replaced wherever they
+  // appear in the name, first occurrence first.
+  struct Pattern {
+    ozz::string left;
+    ozz::string right;
+  };
+
+  // Patterns, tried in order.
+  // Default patterns are "Left"/"Right", "left"/"right", "_L"/"_R" and
+  // "_l"/"_r".
+  ozz::vector<Pattern> patterns;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_MIRROR_MAP_BUILDER_H_
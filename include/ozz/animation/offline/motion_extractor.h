@@ -0,0 +1,88 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_MOTION_EXTRACTOR_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_MOTION_EXTRACTOR_H_
+
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+// Forward declare offline types.
+struct RawAnimation;
+struct RawFloat3Track;
+struct RawQuaternionTrack;
+
+// Extracts root motion from a raw animation, as dedicated position and
+// rotation (heading) tracks. Once built with TrackBuilder, these tracks are
+// used by MotionDeltaJob to compute root motion between two ratios, without
+// sampling the whole animation.
+// Motion is extracted from root_joint local-space transform, so root_joint is
+// expected to be a skeleton root, or the child of a static root. Motion
+// position is made of the selected root_joint translation components, and
+// motion heading is the twist of root_joint rotation around y (up) axis.
+// Motion tracks store the absolute motion frame, keyed at every root_joint
+// translation and rotation key time.
+class OZZ_ANIMOFFLINE_DLL MotionExtractor {
+ public:
+  // Initializes the extractor with default parameters.
+  MotionExtractor();
+
+  // Extracts _input motion to _position and _rotation tracks, and outputs
+  // _input animation to _output, with motion removed from root_joint track if
+  // bake option is true.
+  // _output can be the same object as _input.
+  // Returns false if _input animation is invalid, if root_joint isn't one of
+  // its tracks, or if any output is nullptr.
+  bool operator()(const RawAnimation& _input, RawFloat3Track* _position,
+                  RawQuaternionTrack* _rotation, RawAnimation* _output) const;
+
+  // Index of the joint (track) whose motion is extracted, usually the root or
+  // hips joint. Default is 0.
+  int root_joint;
+
+  // Translation components extracted to motion position. Default extracts
+  // horizontal (x and z) motion, leaving vertical motion in the animation.
+  bool position_x;
+  bool position_y;
+  bool position_z;
+
+  // Extracts root_joint rotation around y axis to motion rotation. Default is
+  // true. Motion rotation is identity otherwise.
+  bool heading;
+
+  // Removes extracted motion from root_joint track, so that the animation
+  // plays in place, relative to the motion frame. Default is true.
+  bool bake;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_MOTION_EXTRACTOR_H_
@@ -0,0 +1,79 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_PARTITIONED_ANIMATION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_PARTITIONED_ANIMATION_BUILDER_H_
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime partitioned animation type.
+class PartitionedAnimation;
+
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building runtime partitioned animation
+// instances from offline raw animations.
+// Raw animation tracks are split into partitions of partition_tracks
+// consecutive tracks, each one built as an independent Animation. Sampling
+// every partition hence gives the same result as sampling an Animation built
+// from the whole raw animation.
+class OZZ_ANIMOFFLINE_DLL PartitionedAnimationBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  PartitionedAnimationBuilder();
+
+  // Creates a PartitionedAnimation based on _raw_animation and *this builder
+  // parameters.
+  // Returns a valid PartitionedAnimation on success.
+  // See RawAnimation::Validate() for more details about failure reasons.
+  // partition_tracks must also be strictly positive.
+  // The animation is returned as an unique_ptr as ownership is given back to
+  // the caller.
+  unique_ptr<PartitionedAnimation> operator()(
+      const RawAnimation& _raw_animation) const;
+
+  // Maximum number of tracks per partition. It's rounded up to a multiple of
+  // 4, so that partitions outputs are SoA aligned. Smaller partitions expose
+  // more parallelism, but each of them has a sampling overhead.
+  // Default value is 64.
+  int partition_tracks;
+
+  // Builder used for each partition, which defines partitions keys formats.
+  AnimationBuilder builder;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_PARTITIONED_ANIMATION_BUILDER_H_
@@ -0,0 +1,126 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_POSE_ATLAS_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_POSE_ATLAS_BUILDER_H_
+
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+class Stream;
+}  // namespace io
+namespace animation {
+
+// Forward declares runtime types.
+class Skeleton;
+class Animation;
+
+namespace offline {
+
+// Defines a GPU ready atlas of an animation model-space poses, sampled at a
+// fixed frame rate. Far level of detail characters can be skinned in a
+// shader by fetching joint matrices from the atlas, skipping CPU animation
+// entirely.
+// The atlas is laid out as a 2D texture of RGBA texels: each row is a frame,
+// made of 3 texels per joint, which are the 3 rows of the joint affine 3x4
+// matrix. A vertex is thus transformed by a joint with 3 dot products.
+struct OZZ_ANIMOFFLINE_DLL PoseAtlas {
+  // Texel channels format.
+  enum Format {
+    kHalf,   // 16 bits half floats (RGBA16F).
+    kFloat,  // 32 bits floats (RGBA32F).
+  };
+
+  PoseAtlas();
+
+  // Number of frames, aka texture height.
+  int num_frames;
+
+  // Number of joints. Texture width is 3 * num_joints texels.
+  int num_joints;
+
+  // Frames per second.
+  float frame_rate;
+
+  // Texels format.
+  Format format;
+
+  // Texels, num_frames rows of row_pitch() bytes, in little endian.
+  ozz::vector<byte> texels;
+
+  // Gets the size in bytes of a texel.
+  size_t texel_size() const;
+
+  // Gets the size in bytes of a texture row (aka a frame).
+  size_t row_pitch() const { return texel_size() * 3 * num_joints; }
+
+  // Atlas file constants.
+  enum {
+    kFileMagic = 0x617a7a6f,  // "ozza", read as a little endian uint32_t.
+    kFileVersion = 1,
+  };
+
+  // Writes the atlas to _stream, as a 24 bytes header followed by texels. All
+  // header values are little endian 32 bits: magic, version, num_frames,
+  // num_joints, format and frame_rate (float). Returns false on write failure.
+  bool Write(io::Stream* _stream) const;
+};
+
+// Defines the class responsible of baking an animation to a PoseAtlas. The
+// animation is sampled at a fixed frame rate with a SamplingJob, converted to
+// model-space with a LocalToModelJob. Both the first and the last (clamped to
+// animation duration) frames are sampled.
+class OZZ_ANIMOFFLINE_DLL PoseAtlasBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  PoseAtlasBuilder();
+
+  // Sampling frequency, in frames per second. Must be greater than 0. Default
+  // is 30.
+  float frame_rate;
+
+  // Atlas texels format. Default is kHalf.
+  PoseAtlas::Format format;
+
+  // Multiplies model-space matrices with the inverse of skeleton rest pose
+  // model-space matrices, so that the atlas stores skinning matrices for a mesh
+  // bound in skeleton rest pose. Default is false.
+  bool skinning;
+
+  // Bakes _animation, whose tracks must match _skeleton joints, to _atlas.
+  // Returns false if parameters are invalid or if sampling failed, _atlas is
+  // then left empty.
+  bool operator()(const Skeleton& _skeleton, const Animation& _animation,
+                  PoseAtlas* _atlas) const;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_POSE_ATLAS_BUILDER_H_
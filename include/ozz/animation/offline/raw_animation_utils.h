@@ -31,10 +31,14 @@
 #include "ozz/animation/offline/export.h"
 #include "ozz/animation/offline/raw_animation.h"
 
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/maths/transform.h"
 #include "ozz/base/span.h"
 
 namespace ozz {
+namespace math {
+struct SoaTransform;
+}
 namespace animation {
 namespace offline {
 
@@ -90,6 +94,37 @@ class OZZ_ANIMOFFLINE_DLL FixedRateSamplingTime {
   float period_;
   size_t num_keys_;
 };
+
+// Samples all tracks of a RawAnimation at once, to SoA transforms. This is the
+// offline counterpart of SamplingJob, for tools that sample a RawAnimation
+// many times (optimization error validation, comparing raw and runtime
+// animations...).
+// Interpolation of 4 tracks is done at once using SoA maths, and each track
+// component keeps a cursor to the last sampled keys, so that sampling at
+// sequential times (typically FixedRateSamplingTime) only walks forward a few
+// keys instead of binary searching all of them. Any time order is supported
+// though, it's just slower.
+// Bound animation must stay unchanged and alive while sampling.
+class OZZ_ANIMOFFLINE_DLL RawAnimationSampler {
+ public:
+  RawAnimationSampler();
+
+  // Binds _animation and resets cursors.
+  // Returns false if _animation is invalid, in which case sampler is unbound.
+  bool Bind(const RawAnimation& _animation);
+
+  // Samples bound animation at time _time, to _output. Extra SoA lanes of the
+  // last output transform are set to identity.
+  // Returns false if no valid animation is bound, or if _output can't store
+  // all tracks.
+  bool Sample(float _time, const span<math::SoaTransform>& _output);
+
+ private:
+  const RawAnimation* animation_;
+
+  // Translation, rotation and scale cursors of each track.
+  ozz::vector<uint32_t> cursors_;
+};
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
@@ -117,6 +117,60 @@ struct OZZ_ANIMOFFLINE_DLL RawFloat4Track
     : public internal::RawTrack<math::Float4> {};
 struct OZZ_ANIMOFFLINE_DLL RawQuaternionTrack
     : public internal::RawTrack<math::Quaternion> {};
+
+// Offline user-channel track of many float channels sharing the same
+// keyframes, ie: facial animation blend shapes weights. It's converted to a
+// runtime MultiFloatTrack using TrackBuilder.
+struct OZZ_ANIMOFFLINE_DLL RawMultiFloatTrack {
+  // Keyframe data structure, with a value per channel.
+  struct Keyframe {
+    RawTrackInterpolation::Value interpolation;
+    float ratio;
+    ozz::vector<float> values;
+  };
+
+  RawMultiFloatTrack();
+
+  // Validates that all the following rules are respected:
+  //  1. Keyframes' ratios are sorted in a strict ascending order.
+  //  2. Keyframes' ratios are all within [0,1] range.
+  //  3. Number of channels is positive, and every keyframe has a value per
+  //  channel.
+  bool Validate() const;
+
+  // Number of channels of the track.
+  int num_channels;
+
+  // Sequence of keyframes, expected to be sorted.
+  typedef ozz::vector<Keyframe> Keyframes;
+  Keyframes keyframes;
+
+  // Name of the track.
+  string name;
+};
+
+// Offline boolean track, for gameplay events windows. Each keyframe sets the
+// track state from its ratio on, the state being off before the first
+// keyframe. It's converted to a runtime EventTrack using TrackBuilder.
+struct OZZ_ANIMOFFLINE_DLL RawEventTrack {
+  // Keyframe data structure.
+  struct Keyframe {
+    float ratio;
+    bool value;
+  };
+
+  // Validates that all the following rules are respected:
+  //  1. Keyframes' ratios are sorted in a strict ascending order.
+  //  2. Keyframes' ratios are all within [0,1] range.
+  bool Validate() const;
+
+  // Sequence of keyframes, expected to be sorted.
+  typedef ozz::vector<Keyframe> Keyframes;
+  Keyframes keyframes;
+
+  // Name of the track.
+  string name;
+};
 }  // namespace offline
 }  // namespace animation
 
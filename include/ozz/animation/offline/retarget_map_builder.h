@@ -0,0 +1,97 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_RETARGET_MAP_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_RETARGET_MAP_BUILDER_H_
+
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime skeleton types.
+class Skeleton;
+class RetargetMap;
+
+namespace offline {
+
+// Defines the class responsible of building RetargetMap instances, mapping
+// joints of a target skeleton to joints of a source skeleton. Joints are
+// first matched automatically, by name or by hierarchy. Explicit mappings are
+// then applied, in order.
+class OZZ_ANIMOFFLINE_DLL RetargetMapBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  RetargetMapBuilder();
+
+  // Creates a RetargetMap from _source to _target skeleton, based on *this
+  // builder parameters.
+  // Returns a valid RetargetMap on success, an empty unique_ptr on failure,
+  // which happens if an explicit mapping source joint isn't found.
+  // The map is returned as an unique_ptr as ownership is given back to the
+  // caller.
+  unique_ptr<RetargetMap> operator()(const Skeleton& _source,
+                                     const Skeleton& _target) const;
+
+  // Defines automatic joints matching modes.
+  enum Matching {
+    // No automatic matching, only explicit mappings are used.
+    kNone,
+    // Target joints are mapped to the source joint with the same name.
+    kName,
+    // Target joints are mapped to the source joint at the same place in the
+    // hierarchy, aka the n-th child of the source joint their parent is
+    // mapped to (or the n-th root). Names are ignored.
+    kHierarchy,
+  };
+
+  // Automatic joints matching mode.
+  // Default value is kName.
+  Matching matching;
+
+  // Defines an explicit mapping.
+  struct Mapping {
+    // Target joint name, which can contain '*' and '?' wildcards (see
+    // strmatch()), to map many joints at once. Wildcards aren't supported if
+    // target skeleton doesn't store names strings.
+    ozz::string target;
+
+    // Source joint name. An empty name unmaps matching target joints, so
+    // they keep their rest pose.
+    ozz::string source;
+  };
+
+  // Explicit mappings, applied in order after automatic matching.
+  ozz::vector<Mapping> mappings;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_RETARGET_MAP_BUILDER_H_
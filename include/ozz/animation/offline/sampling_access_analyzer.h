@@ -0,0 +1,130 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_SAMPLING_ACCESS_ANALYZER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_SAMPLING_ACCESS_ANALYZER_H_
+
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares runtime animation type.
+class Animation;
+
+namespace offline {
+
+// Defines the memory accesses of sampling an animation along a playback
+// pattern, as simulated by SamplingAccessAnalyzer.
+struct OZZ_ANIMOFFLINE_DLL SamplingAccessAnalysis {
+  SamplingAccessAnalysis();
+
+  // Accesses of a single playback frame, for all transformation types.
+  struct Frame {
+    // Sampled ratio.
+    float ratio;
+
+    // Number of keys the cursors advanced over.
+    int keys_advanced;
+
+    // Number of distinct keys read, to advance cursors and to decompress
+    // outdated interpolation entries.
+    int keys_read;
+
+    // Size of the keys read (including tangents of cubic animations).
+    size_t bytes;
+
+    // Number of distinct cache lines touched.
+    int lines;
+
+    // Number of touched cache lines that weren't in the simulated cache.
+    int misses;
+  };
+
+  // Per frame accesses, one per playback ratio.
+  ozz::vector<Frame> frames;
+
+  // Sums of all frames accesses.
+  size_t bytes;
+  int lines;
+  int misses;
+
+  // Size of the distinct cache lines touched by the whole playback.
+  size_t footprint;
+};
+
+// Replays a playback pattern (a sequence of ratios) over a runtime animation,
+// simulating SamplingJob cursor to record the keys it reads. Keys accesses are
+// then mapped to memory according to a keys layout, which allows to measure
+// the runtime layout (keys sorted by the time they are needed), and compare it
+// with alternatives before implementing them.
+// Playing backward restarts cursors from the beginning of the animation, as
+// SamplingJob does for animations without seek points nor bidirectional data.
+// Seek tables, previous keys offsets and random access indices aren't
+// simulated.
+class OZZ_ANIMOFFLINE_DLL SamplingAccessAnalyzer {
+ public:
+  // Initializes the analyzer with default parameters.
+  SamplingAccessAnalyzer();
+
+  // Defines keys layouts. Each transformation type keys buffer is laid out
+  // independently.
+  enum Layout {
+    kSorted,    // Runtime layout, keys sorted by the time they are needed.
+    kPerTrack,  // Keys grouped by track, sorted by time.
+    kChunked,   // Keys split in chunks of chunk_duration, grouped by track
+                // within each chunk.
+  };
+
+  // Keys layout to simulate. Default is kSorted.
+  Layout layout;
+
+  // Duration of kChunked layout chunks, in seconds. Must be greater than 0.
+  // Default is 1.
+  float chunk_duration;
+
+  // Size of a cache line, in bytes. Must be greater than 0. Default is 64.
+  int cache_line_size;
+
+  // Capacity of the simulated least recently used cache, in bytes. 0 means no
+  // reuse across frames, every line touched by a frame being a miss. Default
+  // is 32KB.
+  size_t cache_size;
+
+  // Replays _ratios over _animation, and outputs accesses to _analysis.
+  // Ratios are clamped to range [0,1]. Returns false if analyzer parameters
+  // are invalid, _analysis is then left empty.
+  bool operator()(const Animation& _animation, span<const float> _ratios,
+                  SamplingAccessAnalysis* _analysis) const;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_SAMPLING_ACCESS_ANALYZER_H_
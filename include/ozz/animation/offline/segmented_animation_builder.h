@@ -0,0 +1,134 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_SEGMENTED_ANIMATION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_SEGMENTED_ANIMATION_BUILDER_H_
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares runtime types.
+class SegmentedAnimation;
+class Skeleton;
+
+namespace offline {
+
+// Forward declares offline types.
+struct RawAnimation;
+class AnimationOptimizer;
+
+// Provides a raw animation by time windows, so that a long animation (ie:
+// minutes of high frequency motion capture) never needs to be fully loaded in
+// memory. This is implemented by importers that can evaluate source data at
+// any time, and used by SegmentedAnimationBuilder streaming build.
+class OZZ_ANIMOFFLINE_DLL RawAnimationSource {
+ public:
+  virtual ~RawAnimationSource();
+
+  // Gets the whole animation duration, in seconds.
+  virtual float duration() const = 0;
+
+  // Gets the number of tracks, the same for all windows.
+  virtual int num_tracks() const = 0;
+
+  // Gets animation name.
+  virtual const char* name() const = 0;
+
+  // Fills _window with the keys of time range [_begin,_end]. Keys times are
+  // relative to _begin, and _window duration must be _end - _begin. Keys at (or
+  // beyond) range boundaries should be provided, as window boundaries values
+  // are sampled from the keys of the window only. Returns false on failure.
+  virtual bool Read(float _begin, float _end, RawAnimation* _window) = 0;
+};
+
+// Defines the class responsible of building runtime segmented animation
+// instances from offline raw animations.
+// The raw animation is split into evenly spaced time segments. Each segment
+// is built as an independent Animation, whose tracks hold the keys of the
+// segment, plus keys sampled at segment boundaries. Sampling a segment hence
+// gives the same result as sampling the whole raw animation.
+class OZZ_ANIMOFFLINE_DLL SegmentedAnimationBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  SegmentedAnimationBuilder();
+
+  // Creates a SegmentedAnimation based on _raw_animation and *this builder
+  // parameters.
+  // Returns a valid SegmentedAnimation on success.
+  // See RawAnimation::Validate() for more details about failure reasons.
+  // segment_duration must also be strictly positive.
+  // The animation is returned as an unique_ptr as ownership is given back to
+  // the caller.
+  unique_ptr<SegmentedAnimation> operator()(
+      const RawAnimation& _raw_animation) const;
+
+  // Creates a SegmentedAnimation by streaming _source, one segment at a time,
+  // so that peak memory is bounded by a window (a segment plus overlaps)
+  // rather than by the whole raw animation. Each window is read from _source,
+  // optimized if an optimizer is set, and built to a segment.
+  // _skeleton is required by the optimizer only.
+  // Returns nullptr if source duration or number of tracks is invalid, if a
+  // window can't be read or is invalid, or if optimization fails.
+  unique_ptr<SegmentedAnimation> operator()(
+      RawAnimationSource& _source, const Skeleton* _skeleton = nullptr) const;
+
+  // Maximum duration (in seconds) of a segment. The animation is split into
+  // the smallest number of segments of equal duration that respects this
+  // limit.
+  // Default value is 10s.
+  float segment_duration;
+
+  // Builder used for each segment, which defines segments keys formats. Note
+  // that with cubic_interpolation, tangents are one-sided at segment
+  // boundaries.
+  AnimationBuilder builder;
+
+  // Streaming build settings.
+
+  // Duration (in seconds) read before and after each segment. Overlapping
+  // windows give the optimizer the context of neighbor segments, so that keys
+  // kept close to segment boundaries don't depend on the window cut.
+  // Default value is 1s.
+  float overlap;
+
+  // Optional optimizer, applied to every window. Default is nullptr, which
+  // doesn't optimize.
+  const AnimationOptimizer* optimizer;
+
+ private:
+  // Allocates an animation with its segments ratios, but no segment built.
+  unique_ptr<SegmentedAnimation> Allocate(float _duration, int _num_tracks,
+                                          const char* _name) const;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_SEGMENTED_ANIMATION_BUILDER_H_
@@ -46,6 +46,9 @@ struct RawSkeleton;
 // Defines the class responsible of building Skeleton instances.
 class OZZ_ANIMOFFLINE_DLL SkeletonBuilder {
  public:
+  // Initializes the builder with default parameters.
+  SkeletonBuilder();
+
   // Creates a Skeleton based on _raw_skeleton and *this builder parameters.
   // Returns a Skeleton instance on success, an empty unique_ptr on failure. See
   // RawSkeleton::Validate() for more details about failure reasons.
@@ -53,6 +56,35 @@ class OZZ_ANIMOFFLINE_DLL SkeletonBuilder {
   // caller.
   ozz::unique_ptr<ozz::animation::Skeleton> operator()(
       const RawSkeleton& _raw_skeleton) const;
+
+  // Builds _skeleton in place, based on _raw_skeleton and *this builder
+  // parameters. Previous _skeleton data are released, and new ones are
+  // allocated with _skeleton allocator, see Skeleton constructor.
+  // Returns false if _skeleton is nullptr, or if _raw_skeleton isn't valid, in
+  // which case _skeleton is left unchanged.
+  bool operator()(const RawSkeleton& _raw_skeleton, Skeleton* _skeleton) const;
+
+  // Defines runtime skeleton joints orderings. Parents are always ordered
+  // before their children, which is all most runtime jobs rely on.
+  enum Ordering {
+    // Joints are ordered depth-first, so every sub-hierarchy is a contiguous
+    // range of joints. This is required by LocalToModelJob "from" option,
+    // LocalToSkinningJob and IterateJointsDF() "_from" argument.
+    kDepthFirst,
+
+    // Children of a joint are ordered contiguously, before any of their own
+    // children, which packs siblings (fingers, twist joints...) in the same
+    // SoA groups. Masked SoA groups (SkeletonLOD, SamplingJob and BlendingJob
+    // masks) are then fuller, and parents are closer to their children.
+    // See IsDepthFirst() from skeleton_utils.h to test a skeleton ordering.
+    kSiblingsGrouped,
+  };
+
+  // Runtime skeleton joints ordering. Note that animation tracks are ordered
+  // like skeleton joints, so animations must be built for the skeleton
+  // ordering.
+  // Default value is kDepthFirst.
+  Ordering ordering;
 };
 }  // namespace offline
 }  // namespace animation
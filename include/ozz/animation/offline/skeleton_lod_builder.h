@@ -0,0 +1,84 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_SKELETON_LOD_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_SKELETON_LOD_BUILDER_H_
+
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime skeleton types.
+class Skeleton;
+class SkeletonLOD;
+
+namespace offline {
+
+// Defines the class responsible of building SkeletonLOD instances, aka the
+// subset of a skeleton's joints that are evaluated for a level of detail.
+// Joints are first activated according to their depth in the hierarchy. Per
+// joint overrides are then applied, in order. Finally, ancestors of every
+// active joint are activated, so the active set is always a valid hierarchy.
+class OZZ_ANIMOFFLINE_DLL SkeletonLODBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  SkeletonLODBuilder();
+
+  // Creates a SkeletonLOD for _skeleton, based on *this builder parameters.
+  // Returns a valid SkeletonLOD on success, an empty unique_ptr on failure,
+  // which happens if max_depth is negative.
+  // The level of detail is returned as an unique_ptr as ownership is given
+  // back to the caller.
+  unique_ptr<SkeletonLOD> operator()(const Skeleton& _skeleton) const;
+
+  // Maximum depth of active joints, root joints having a depth of 0. Deeper
+  // joints are inactive, unless overridden.
+  // Default value is Skeleton::kMaxJoints, which activates all joints.
+  int max_depth;
+
+  // Defines a per joint override.
+  struct Override {
+    // Joint name, which can contain '*' and '?' wildcards (see strmatch()), to
+    // override many joints at once (ie: "*Finger*").
+    ozz::string name;
+
+    // Activates matching joints if true, deactivates them otherwise. Note
+    // that a joint can't be deactivated if one of its descendants is active.
+    bool active;
+  };
+
+  // Per joint overrides, applied in order after depth.
+  ozz::vector<Override> overrides;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_SKELETON_LOD_BUILDER_H_
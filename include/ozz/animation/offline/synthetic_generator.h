@@ -0,0 +1,119 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_SYNTHETIC_GENERATOR_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_SYNTHETIC_GENERATOR_H_
+
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+// Forward declare offline types.
+struct RawAnimation;
+struct RawSkeleton;
+
+// Generates synthetic skeletons, aimed at benchmarking and testing at
+// production scale, up to Skeleton::kMaxJoints. Skeleton is a tree of joints,
+// each of them having fan_out children, down to a maximum depth. Joints are
+// added breadth-first, so the tree stays balanced when num_joints stops it
+// before it's complete. Joints are named "joint<i>", i being their creation
+// index.
+class OZZ_ANIMOFFLINE_DLL SyntheticSkeletonGenerator {
+ public:
+  // Initializes the generator with default parameters.
+  SyntheticSkeletonGenerator();
+
+  // Generates _skeleton, replacing its content. Use SkeletonBuilder to get a
+  // runtime skeleton from it.
+  // Returns false, leaving _skeleton empty, if num_joints is negative or
+  // greater than Skeleton::kMaxJoints, if fan_out is less than 1 or if depth
+  // is negative.
+  bool operator()(RawSkeleton* _skeleton) const;
+
+  // Number of joints to generate. Skeleton has less joints if the tree is
+  // complete at depth before. Default value is 64.
+  int num_joints;
+
+  // Number of children of each joint. 1 generates a single chain. Default
+  // value is 3.
+  int fan_out;
+
+  // Maximum depth of the tree, the root being at depth 1. 0 means unlimited.
+  // Default value is 0.
+  int depth;
+
+  // Distance from each joint to its parent, in rest pose. Default value is
+  // .1f.
+  float bone_length;
+};
+
+// Generates synthetic animations for a skeleton, with a controllable keyframe
+// density and noise. Every joint has translation, rotation and scale keys at
+// key_frequency, sampled from a smooth periodic motion around its rest pose
+// (each joint with its own phase), to which pseudo random noise is added.
+// Noise is deterministic for a given seed. It keeps keyframes distinct, like
+// motion capture data, so they can't be optimized out.
+class OZZ_ANIMOFFLINE_DLL SyntheticAnimationGenerator {
+ public:
+  // Initializes the generator with default parameters.
+  SyntheticAnimationGenerator();
+
+  // Generates _animation for _skeleton, replacing its content. Tracks follow
+  // runtime skeleton joints order (depth-first), so use AnimationBuilder to
+  // get a runtime animation for the skeleton built from _skeleton.
+  // Returns false, leaving _animation empty, if duration or key_frequency
+  // aren't greater than 0, or if amplitude or noise are negative.
+  bool operator()(const RawSkeleton& _skeleton,
+                  RawAnimation* _animation) const;
+
+  // Animation duration, in seconds. Default value is 2.f.
+  float duration;
+
+  // Number of keys per second, for every track and transformation type.
+  // Motion capture clips typically use 30 to 120. First and last keys are
+  // always located at the beginning and the end of the animation. Default
+  // value is 30.f.
+  float key_frequency;
+
+  // Amplitude of joints rotations, in radian. Default value is .5f.
+  float amplitude;
+
+  // Amplitude of the noise added to every key, relative to joint rest
+  // translation length for translations, in radian for rotations and absolute
+  // for scales. Default value is .01f.
+  float noise;
+
+  // Noise generator seed. Default value is 0.
+  uint32_t seed;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_SYNTHETIC_GENERATOR_H_
@@ -61,6 +61,11 @@ class OZZ_ANIMTOOLS_DLL OzzImporter {
 
   // Function operator that must be called with main() arguments to start import
   // process.
+  // With "--file=-", the process stays alive and runs jobs read from standard
+  // input, one per line, until the end of the stream. The importer and the
+  // configuration (as long as it's unchanged) are thus initialized once for
+  // all jobs. A "Job n succeeded." or "Job n failed." line is output to
+  // standard output after each job, whatever the log level.
   int operator()(int _argc, const char** _argv);
 
   // Loads source data file.
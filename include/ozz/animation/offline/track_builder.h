@@ -40,6 +40,8 @@ class Float2Track;
 class Float3Track;
 class Float4Track;
 class QuaternionTrack;
+class MultiFloatTrack;
+class EventTrack;
 
 namespace offline {
 
@@ -49,6 +51,8 @@ struct RawFloat2Track;
 struct RawFloat3Track;
 struct RawFloat4Track;
 struct RawQuaternionTrack;
+struct RawMultiFloatTrack;
+struct RawEventTrack;
 
 // Defines the class responsible of building runtime track instances from
 // offline tracks.The input raw track is first validated. Runtime conversion of
@@ -56,6 +60,9 @@ struct RawQuaternionTrack;
 // the data at all.
 class OZZ_ANIMOFFLINE_DLL TrackBuilder {
  public:
+  // Initializes the builder with default parameters.
+  TrackBuilder();
+
   // Creates a Track based on _raw_track and *this builder parameters.
   // Returns a track instance on success, an empty unique_ptr on failure. See
   // Raw*Track::Validate() for more details about failure reasons.
@@ -67,10 +74,55 @@ class OZZ_ANIMOFFLINE_DLL TrackBuilder {
   ozz::unique_ptr<Float4Track> operator()(const RawFloat4Track& _input) const;
   ozz::unique_ptr<QuaternionTrack> operator()(
       const RawQuaternionTrack& _input) const;
+  ozz::unique_ptr<MultiFloatTrack> operator()(
+      const RawMultiFloatTrack& _input) const;
+  ozz::unique_ptr<EventTrack> operator()(const RawEventTrack& _input) const;
+
+  // Builds _track in place, based on _raw_track and *this builder parameters.
+  // _track buffer is reused if it's big enough, so rebuilding a track of the
+  // same size (or smaller) doesn't allocate any runtime memory. Otherwise it's
+  // allocated with _track allocator, see Track constructor.
+  // Returns false if _track is nullptr, or if _input isn't valid, in which
+  // case _track is left unchanged. See Raw*Track::Validate() for more details
+  // about failure reasons.
+  bool operator()(const RawFloatTrack& _input, FloatTrack* _track) const;
+  bool operator()(const RawFloat2Track& _input, Float2Track* _track) const;
+  bool operator()(const RawFloat3Track& _input, Float3Track* _track) const;
+  bool operator()(const RawFloat4Track& _input, Float4Track* _track) const;
+  bool operator()(const RawQuaternionTrack& _input,
+                  QuaternionTrack* _track) const;
+
+  // Builds _track in place, based on _raw_track. Previous _track data are
+  // released, and new ones are allocated with _track allocator, see
+  // MultiFloatTrack constructor.
+  // Returns false if _track is nullptr, or if _input isn't valid, in which
+  // case _track is left unchanged.
+  bool operator()(const RawMultiFloatTrack& _input,
+                  MultiFloatTrack* _track) const;
+
+  // Builds _track in place, based on _raw_track. Keyframes that don't change
+  // the state are skipped, and the ratios of the others are quantized to 16
+  // bits. Toggles that fall on the same quantized ratio cancel each other, as
+  // the window between them is empty. Previous _track data are released, and
+  // new ones are allocated with _track allocator, see EventTrack constructor.
+  // Returns false if _track is nullptr, or if _input isn't valid, in which
+  // case _track is left unchanged.
+  bool operator()(const RawEventTrack& _input, EventTrack* _track) const;
+
+  // Quantizes keyframes ratios and values to 16 bits (MultiFloatTrack
+  // excepted). Values are quantized per component within the track range, so
+  // precision is the range of the track values divided by 65535. Quantized
+  // FloatTrack can't be used by TrackTriggeringJob. Builder falls back to float
+  // keyframes if consecutive keys ratios can't be distinguished once
+  // quantized.
+  // Default value is false.
+  bool quantize;
 
  private:
   template <typename _RawTrack, typename _Track>
   ozz::unique_ptr<_Track> Build(const _RawTrack& _input) const;
+  template <typename _RawTrack, typename _Track>
+  bool Build(const _RawTrack& _input, _Track* _track) const;
 };
 }  // namespace offline
 }  // namespace animation
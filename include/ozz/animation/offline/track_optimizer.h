@@ -29,7 +29,9 @@
 #define OZZ_OZZ_ANIMATION_OFFLINE_TRACK_OPTIMIZER_H_
 
 #include "ozz/animation/offline/export.h"
+#include "ozz/base/parallel_for.h"
 #include "ozz/base/platform.h"
+#include "ozz/base/span.h"
 
 namespace ozz {
 namespace animation {
@@ -65,8 +67,36 @@ class OZZ_ANIMOFFLINE_DLL TrackOptimizer {
   bool operator()(const RawQuaternionTrack& _input,
                   RawQuaternionTrack* _output) const;
 
+  // Optimizes every track of _inputs, to the track of _outputs at the same
+  // index. Every track is a task, dispatched through parallel_for if set.
+  // Returns true if all tracks were optimized. Returns false if _outputs is
+  // smaller than _inputs, or if any track fails (see single track version), in
+  // which case its output is reset to an empty track.
+  bool operator()(span<const RawFloatTrack> _inputs,
+                  span<RawFloatTrack> _outputs) const;
+  bool operator()(span<const RawFloat2Track> _inputs,
+                  span<RawFloat2Track> _outputs) const;
+  bool operator()(span<const RawFloat3Track> _inputs,
+                  span<RawFloat3Track> _outputs) const;
+  bool operator()(span<const RawFloat4Track> _inputs,
+                  span<RawFloat4Track> _outputs) const;
+  bool operator()(span<const RawQuaternionTrack> _inputs,
+                  span<RawQuaternionTrack> _outputs) const;
+
   // Optimization tolerance.
   float tolerance;
+
+  // Task function and task scheduler hook, see ozz/base/parallel_for.h.
+  typedef ozz::ParallelForTask ParallelForTask;
+  typedef ozz::ParallelForHook ParallelFor;
+
+  // Optional task scheduler hook, used when optimizing many tracks in one
+  // call. If nullptr (default), tracks are optimized serially by the calling
+  // thread.
+  ParallelFor parallel_for;
+
+  // User data provided to parallel_for.
+  void* parallel_for_user_data;
 };
 }  // namespace offline
 }  // namespace animation
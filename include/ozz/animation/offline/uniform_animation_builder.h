@@ -0,0 +1,90 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_UNIFORM_ANIMATION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_UNIFORM_ANIMATION_BUILDER_H_
+
+#include "ozz/animation/offline/export.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime uniform animation type.
+class UniformAnimation;
+
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building runtime uniform animation
+// instances from offline raw animations.
+// The raw animation is sampled at frame_rate (rounded so that frames are
+// uniformly spread over the whole duration), and each track component is
+// quantized to 16 bits over its range. Unlike Animation, the uniform
+// animation cost doesn't depend on the number of keys, but on the duration
+// and frame rate. It hence suits dense animations (see IsDense()), typically
+// motion capture clips whose keys mostly survive optimization.
+class OZZ_ANIMOFFLINE_DLL UniformAnimationBuilder {
+ public:
+  // Initializes the builder with default values.
+  UniformAnimationBuilder();
+
+  // Creates a UniformAnimation based on _raw_animation.
+  // Returns a valid UniformAnimation on success.
+  // See RawAnimation::Validate() for more details about failure reasons.
+  // Also fails if frame_rate isn't strictly positive.
+  // The animation is returned as an unique_ptr as ownership is given back to
+  // the caller.
+  unique_ptr<UniformAnimation> operator()(
+      const RawAnimation& _raw_animation) const;
+
+  // Returns _raw_animation keys density: the number of keys divided by the
+  // number of values the uniform animation would store for the 3 channels of
+  // every track at frame_rate. Returns 0 if _raw_animation is invalid.
+  float KeyDensity(const RawAnimation& _raw_animation) const;
+
+  // Returns true if _raw_animation KeyDensity() is at least min_density,
+  // meaning that a UniformAnimation is more suited than an Animation.
+  // Pipelines are expected to use it to select the format of each animation
+  // (after optimization, as it reduces the number of keys).
+  bool IsDense(const RawAnimation& _raw_animation) const;
+
+  // Sampling frame rate, in hertz.
+  // Default value is 30.
+  float frame_rate;
+
+  // Minimum keys density for IsDense() to select a uniform animation.
+  // Default value is .5, which considers that 16 bits per component uniform
+  // frames are worth it when half of them would be keyed anyway.
+  float min_density;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_UNIFORM_ANIMATION_BUILDER_H_
@@ -0,0 +1,89 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ADDITIVE_DELTA_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ADDITIVE_DELTA_JOB_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+
+// Forward declaration math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Computes an additive (delta) pose from two local-space poses, for example
+// two poses sampled at runtime. The result can be used directly as a
+// BlendingJob additive layer, without building an additive Animation with
+// AdditiveAnimationBuilder and AnimationBuilder. Adding the delta (with a
+// weight of 1) to the reference pose restores the input pose.
+// Deltas are computed the same way AdditiveAnimationBuilder does:
+// -translation delta is input translation - reference translation.
+// -rotation delta is input rotation * conjugate(reference rotation).
+// -scale delta is input scale / reference scale, so reference scales mustn't
+// be 0.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL AdditiveDeltaJob {
+  // Default constructor, initializes default values.
+  AdditiveDeltaJob() {}
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if reference range is smaller than input range.
+  // -if output range is smaller than input range.
+  bool Validate() const;
+
+  // Runs job's delta computation task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // Job input.
+
+  // The reference (aka base) pose, in local-space. It's usually the pose the
+  // additive layer is going to be applied to, or a rest pose.
+  span<const ozz::math::SoaTransform> reference;
+
+  // The pose to compute the delta of, in local-space. Its size defines the
+  // number of SoA joints processed.
+  span<const ozz::math::SoaTransform> input;
+
+  // Job output.
+
+  // The output delta pose, to be used as a BlendingJob additive layer. It can
+  // be the same buffer as input or reference, to compute delta in-place.
+  span<ozz::math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ADDITIVE_DELTA_JOB_H_
@@ -38,6 +38,9 @@ namespace io {
 class IArchive;
 class OArchive;
 }  // namespace io
+namespace memory {
+class Allocator;
+}  // namespace memory
 namespace animation {
 
 // Forward declares the AnimationBuilder, used to instantiate an Animation.
@@ -47,7 +50,10 @@ class AnimationBuilder;
 
 // Forward declaration of key frame's type.
 struct Float3Key;
+struct CompactFloat3Key;
 struct QuaternionKey;
+struct CompactQuaternionKey;
+struct PackedQuaternionKey;
 
 // Defines a runtime skeletal animation clip.
 // The runtime animation data structure stores animation keyframes, for all the
@@ -61,8 +67,10 @@ struct QuaternionKey;
 // time, then by track number.
 class OZZ_ANIMATION_DLL Animation {
  public:
-  // Builds a default animation.
-  Animation();
+  // Builds a default animation. Animation buffers are allocated with
+  // _allocator when the animation is built or loaded, which allows to target a
+  // specific heap or arena. nullptr means the default allocator.
+  explicit Animation(memory::Allocator* _allocator = nullptr);
 
   // Allow moves.
   Animation(Animation&&);
@@ -88,18 +96,166 @@ class OZZ_ANIMATION_DLL Animation {
   // Gets animation name.
   const char* name() const { return name_ ? name_ : ""; }
 
-  // Gets the buffer of translations keys.
+  // Gets the buffers of translations keys. Translation keys are stored in one
+  // of the 2 buffers, depending on AnimationBuilder::compact_ratios option. The
+  // other one is empty.
   span<const Float3Key> translations() const { return translations_; }
+  span<const CompactFloat3Key> compact_translations() const {
+    return compact_translations_;
+  }
 
-  // Gets the buffer of rotation keys.
+  // Gets the buffers of rotation keys. Rotation keys are stored in one of the
+  // 3 buffers, depending on the format selected at build time (see
+  // AnimationBuilder::rotation_format). The 2 others are empty.
   span<const QuaternionKey> rotations() const { return rotations_; }
+  span<const CompactQuaternionKey> compact_rotations() const {
+    return compact_rotations_;
+  }
+  span<const PackedQuaternionKey> packed_rotations() const {
+    return packed_rotations_;
+  }
 
-  // Gets the buffer of scale keys.
+  // Gets the buffers of scale keys. As for translations, only one of the 2
+  // buffers is used.
   span<const Float3Key> scales() const { return scales_; }
+  span<const CompactFloat3Key> compact_scales() const {
+    return compact_scales_;
+  }
 
-  // Get the estimated animation's size in bytes.
+  // Gets the number of seek points. Seek points are snapshots of the sampling
+  // state taken at regular ratio intervals, see
+  // AnimationBuilder::seek_interval. They allow to restart sampling from the
+  // nearest point when seeking backward or far forward, instead of replaying
+  // all the keys from the beginning of the animation.
+  int num_seek_points() const;
+
+  // Gets the buffer of seek points data. Buffer is empty if animation has no
+  // seek point.
+  span<const int> seek_table() const { return seek_table_; }
+
+  // Tells if the animation stores previous keys offsets, which allow
+  // SamplingJob to step backward as efficiently as forward. See
+  // AnimationBuilder::bidirectional.
+  bool bidirectional() const { return !translation_previouses_.empty(); }
+
+  // Gets the buffers of previous keys offsets. Each entry is the offset from
+  // a key to the previous key of the same track, 0 if unknown (or too far to
+  // be stored on 16 bits). Buffers are empty if animation isn't bidirectional.
+  span<const uint16_t> translation_previouses() const {
+    return translation_previouses_;
+  }
+  span<const uint16_t> rotation_previouses() const {
+    return rotation_previouses_;
+  }
+  span<const uint16_t> scale_previouses() const { return scale_previouses_; }
+
+  // Gets constant SoA tracks flags. Bit i%8 of byte i/8 is set if the 4 tracks
+  // of SoA entry i have a constant value, allowing SamplingJob to skip their
+  // interpolation. Buffers are empty for animations built before version 11.
+  span<const uint8_t> constant_translations() const {
+    return constant_translations_;
+  }
+  span<const uint8_t> constant_rotations() const { return constant_rotations_; }
+  span<const uint8_t> constant_scales() const { return constant_scales_; }
+
+  // Tells if the animation stores per track keys indices, which allow
+  // StatelessSamplingJob to sample any ratio without a context. See
+  // AnimationBuilder::random_access.
+  bool random_access() const { return !translation_track_index_.empty(); }
+
+  // Gets the buffers of per track keys indices. Each buffer starts with
+  // num_soa_tracks() * 4 + 1 offsets, followed by the indices of all the keys
+  // (in translations, rotations or scales buffers), grouped by track and
+  // sorted by ratio. Keys of track t are located in range [offsets[t],
+  // offsets[t + 1]) of the indices. Buffers are empty if animation isn't
+  // random access.
+  span<const int> translation_track_index() const {
+    return translation_track_index_;
+  }
+  span<const int> rotation_track_index() const { return rotation_track_index_; }
+  span<const int> scale_track_index() const { return scale_track_index_; }
+
+  // Tells if translations and scales are interpolated with cubic Hermite
+  // curves, using keys tangents. Rotations are always linearly interpolated.
+  // See AnimationBuilder::cubic_interpolation.
+  bool cubic() const { return !translation_tangents_.empty(); }
+
+  // Gets the buffers of translation and scale keys tangents, 3 half floats per
+  // key, in the same order as keys buffers. Tangents are expressed per unit of
+  // ratio. Buffers are empty if animation isn't cubic.
+  span<const uint16_t> translation_tangents() const {
+    return translation_tangents_;
+  }
+  span<const uint16_t> scale_tangents() const { return scale_tangents_; }
+
+  // Returns the allocator used for animation buffers, nullptr for the default
+  // allocator.
+  memory::Allocator* allocator() const { return allocator_; }
+
+  // Gets animation data generation, which is unique to every animation object
+  // and changes whenever its data are replaced (built, loaded, reloaded or
+  // moved). Sampling contexts compare it, along with animation address, to
+  // detect that cached keys are outdated.
+  uint32_t generation() const { return generation_; }
+
+  // Hot reloads animation data from _archive, for example when a clip is
+  // exported again while an editor is running. The new animation is fully
+  // loaded before replacing current data, which are left unchanged if loading
+  // fails. Animation address remains valid, and sampling contexts using it are
+  // lazily reset the next time they sample it, as generation() changes. Note
+  // that contexts that are too small for reloaded tracks count make sampling
+  // fail until they're resized.
+  // Reload must not run while the animation is being sampled.
+  // Returns false if _archive doesn't contain a valid animation.
+  bool Reload(ozz::io::IArchive& _archive);
+
+  // Get the estimated animation's size in bytes. Rotation keys shared with
+  // another animation (see ShareRotations()) aren't accounted.
   size_t size() const;
 
+  // Makes *this animation use _shared animation rotation keys, instead of
+  // its own copy. This allows variants of the same clip (ie: for rigs that
+  // only differ by their rest pose and proportions) to store their
+  // translation and scale keys only, while all referencing a single rotation
+  // keys buffer. Variants are built from the same raw rotation tracks, with
+  // the same AnimationBuilder options, so that their rotation keys are
+  // identical.
+  // Own rotation keys are released, so *this animation buffer is reallocated
+  // with the remaining data (even if it was using an image). _shared must
+  // remain valid and unchanged as long as *this animation uses its rotations.
+  // Sharing is reset when *this animation is rebuilt, loaded or set from an
+  // image. Saved archives and images remain self-contained.
+  // Returns false, leaving *this animation unchanged, if rotation keys of both
+  // animations aren't identical.
+  bool ShareRotations(const Animation& _shared);
+
+  // Returns the animation whose rotation keys are used by *this animation, or
+  // nullptr if it uses its own.
+  const Animation* shared_rotations() const { return shared_rotations_; }
+
+  // Defines the alignment required for animation images.
+  enum { kImageAlignment = 16 };
+
+  // Animation images are a relocatable binary layout of the animation, which
+  // can be used in place without any copy or allocation, see FromImage().
+  // Images use platform native endianness, and are specific to an animation
+  // layout version.
+  // Gets the size of *this animation image, in bytes.
+  size_t image_size() const;
+
+  // Writes *this animation image to _image, which must be image_size() bytes
+  // big at least, and aligned to kImageAlignment.
+  // Returns false if _image is too small or misaligned.
+  bool ToImage(span<byte> _image) const;
+
+  // Sets *this animation to use _image data in place. Animation keeps
+  // pointers to _image (typically a memory mapped file, or a buffer loaded at
+  // once), which must be aligned to kImageAlignment and must remain valid and
+  // unchanged for the lifetime of *this animation.
+  // Returns false if _image isn't a valid animation image for this platform
+  // and version, leaving *this animation empty.
+  bool FromImage(span<const byte> _image);
+
   // Serialization functions.
   // Should not be called directly but through io::Archive << and >> operators.
   void Save(ozz::io::OArchive& _archive) const;
@@ -109,11 +265,43 @@ class OZZ_ANIMATION_DLL Animation {
   // AnimationBuilder class is allowed to instantiate an Animation.
   friend class offline::AnimationBuilder;
 
-  // Internal destruction function.
-  void Allocate(size_t _name_len, size_t _translation_count,
-                size_t _rotation_count, size_t _scale_count);
+  // Internal allocation and destruction functions.
+  struct AllocateParams {
+    size_t name_len;
+    size_t translation_count;
+    size_t compact_translation_count;
+    size_t rotation_count;
+    size_t compact_rotation_count;
+    size_t packed_rotation_count;
+    size_t scale_count;
+    size_t compact_scale_count;
+    size_t seek_table_size;
+    bool bidirectional;
+    size_t num_constant_flags;  // Per transformation type.
+    bool random_access;
+    bool cubic;
+  };
+  void Allocate(const AllocateParams& _params);
   void Deallocate();
 
+  // Computes the size of the buffer required by _params, and distributes
+  // _buffer to data members according to _params.
+  size_t BufferSize(const AllocateParams& _params) const;
+  void Bind(const AllocateParams& _params, span<byte> _buffer);
+
+  // Gets *this animation allocation parameters.
+  AllocateParams GetAllocateParams() const;
+
+  // Copies *this animation data to _dest ones, which must be bound with the
+  // same allocation parameters. Rotation keys and their derived data are
+  // copied only if _rotations is true.
+  void CopyData(Animation* _dest, bool _rotations) const;
+
+  // Fills per track keys indices from keys buffers, see
+  // translation_track_index(). Indices aren't serialized, they are rebuilt
+  // when animation is loaded.
+  void FillTrackIndices();
+
   // Duration of the animation clip.
   float duration_;
 
@@ -126,13 +314,57 @@ class OZZ_ANIMATION_DLL Animation {
 
   // Stores all translation/rotation/scale keys begin and end of buffers.
   span<Float3Key> translations_;
+  span<CompactFloat3Key> compact_translations_;
   span<QuaternionKey> rotations_;
+  span<CompactQuaternionKey> compact_rotations_;
+  span<PackedQuaternionKey> packed_rotations_;
   span<Float3Key> scales_;
+  span<CompactFloat3Key> compact_scales_;
+
+  // Stores seek points data, see num_seek_points().
+  span<int> seek_table_;
+
+  // Stores previous keys offsets, see bidirectional().
+  span<uint16_t> translation_previouses_;
+  span<uint16_t> rotation_previouses_;
+  span<uint16_t> scale_previouses_;
+
+  // Stores constant SoA tracks flags, see constant_translations().
+  span<uint8_t> constant_translations_;
+  span<uint8_t> constant_rotations_;
+  span<uint8_t> constant_scales_;
+
+  // Stores per track keys indices, see translation_track_index().
+  span<int> translation_track_index_;
+  span<int> rotation_track_index_;
+  span<int> scale_track_index_;
+
+  // Stores translation and scale keys tangents, see cubic().
+  span<uint16_t> translation_tangents_;
+  span<uint16_t> scale_tangents_;
+
+  // Allocator used for allocation_, nullptr for the default allocator.
+  memory::Allocator* allocator_;
+
+  // Animation data generation, see generation().
+  uint32_t generation_;
+
+  // Buffer allocated for animation data, nullptr if animation data are
+  // stored in an image.
+  void* allocation_;
+
+  // Size of allocation_ buffer, which can be bigger than the size required by
+  // current data when the animation was rebuilt in place.
+  size_t allocation_size_;
+
+  // Animation owning the rotation keys used by *this animation, nullptr if
+  // they are in allocation_ (or the image).
+  const Animation* shared_rotations_;
 };
 }  // namespace animation
 
 namespace io {
-OZZ_IO_TYPE_VERSION(6, animation::Animation)
+OZZ_IO_TYPE_VERSION(13, animation::Animation)
 OZZ_IO_TYPE_TAG("ozz-animation", animation::Animation)
 }  // namespace io
 }  // namespace ozz
@@ -0,0 +1,174 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_CACHE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_CACHE_H_
+
+#include <cstddef>
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+class AsyncReader;
+}  // namespace io
+namespace animation {
+
+// Forward declares runtime animation.
+class Animation;
+
+// Keeps a working set of animations resident within a memory budget, out of a
+// set of clips too large to be loaded all at once.
+// Clips are registered once with their file path, and then referenced by
+// identifier. Acquire() returns resident clips, and requests missing ones to be
+// loaded asynchronously with an io::AsyncReader. Update(), called once per
+// frame, integrates completed loads and evicts least recently acquired clips
+// until resident memory (see Animation::size()) fits the budget.
+// Animations returned by Acquire() remain valid until the next Update(). Clips
+// acquired since the last Update() are never evicted, so the budget is
+// exceeded if the working set doesn't fit in.
+// The cache isn't thread safe, though loads can complete from any thread. It
+// must not be destroyed while loads are pending, see num_pending_loads().
+class OZZ_ANIMATION_DLL AnimationCache {
+ public:
+  // Clip residency states.
+  enum ClipState {
+    kUnloaded,  // Never loaded, or evicted.
+    kLoading,   // Being loaded.
+    kResident,  // Loaded and available.
+    kFailed,    // Load failed, clip isn't loaded again.
+  };
+
+  // Cache statistics, accumulated since construction or last ResetStats().
+  struct Stats {
+    int hits;       // Acquire() calls served with a resident clip.
+    int misses;     // Acquire() calls of a clip that wasn't resident.
+    int loads;      // Completed loads, including failed ones.
+    int failures;   // Failed loads, including requests that couldn't start.
+    int evictions;  // Clips evicted to fit the budget.
+
+    // Accumulated and maximum completed loads latency, in seconds, from load
+    // request to completion.
+    float total_load_latency;
+    float max_load_latency;
+
+    // Gets the average latency of completed loads, in seconds.
+    float average_load_latency() const {
+      return loads ? total_load_latency / loads : 0.f;
+    }
+  };
+
+  // Constructs a cache loading clips with _reader, which must outlive the
+  // cache. _budget is the resident memory budget, in bytes.
+  AnimationCache(io::AsyncReader* _reader, size_t _budget);
+
+  // Disables copy and assignation.
+  AnimationCache(AnimationCache const&) = delete;
+  AnimationCache& operator=(AnimationCache const&) = delete;
+
+  // Asserts that no load is pending, and releases all clips.
+  ~AnimationCache();
+
+  // Registers the clip stored in file _filename, which isn't loaded until
+  // it's acquired. Returns clip identifier, or -1 if _filename is nullptr.
+  int Register(const char* _filename);
+
+  // Gets the number of registered clips.
+  int num_clips() const { return static_cast<int>(clips_.size()); }
+
+  // Gets the animation of clip _clip if it's resident, marking it as recently
+  // used. Otherwise requests the clip to be loaded, and returns nullptr.
+  // Also returns nullptr if _clip is invalid, or if its load failed.
+  const Animation* Acquire(int _clip);
+
+  // Requests clip _clip to be loaded, without affecting hit and miss stats,
+  // so it's likely to be resident once needed. Returns false if _clip is
+  // invalid or if its load failed.
+  bool Prefetch(int _clip);
+
+  // Integrates completed loads, and evicts least recently used clips until
+  // resident memory fits the budget. To be called once per frame.
+  void Update();
+
+  // Gets the residency state of clip _clip, kUnloaded if _clip is invalid.
+  ClipState state(int _clip) const;
+
+  // Gets and sets resident memory budget, in bytes. A lower budget takes
+  // effect at the next Update().
+  size_t budget() const { return budget_; }
+  void set_budget(size_t _budget) { budget_ = _budget; }
+
+  // Gets the memory used by resident clips, in bytes.
+  size_t resident_size() const { return resident_size_; }
+
+  // Gets the number of resident clips.
+  int num_resident() const { return num_resident_; }
+
+  // Gets the number of loads not yet integrated by Update().
+  int num_pending_loads() const { return static_cast<int>(pending_.size()); }
+
+  // Gets cache statistics.
+  const Stats& stats() const { return stats_; }
+
+  // Resets cache statistics.
+  void ResetStats();
+
+ private:
+  // Clip description, defined in the implementation.
+  struct Clip;
+
+  // Starts loading clip _clip if it's unloaded. Returns false if it failed.
+  bool Load(int _clip);
+
+  // Least recently used list management.
+  void Unlink(int _clip);
+  void LinkBack(int _clip);
+
+  io::AsyncReader* reader_;
+  size_t budget_;
+  size_t resident_size_;
+  int num_resident_;
+
+  // Incremented by every Update(), to know clips used since the last one.
+  unsigned int frame_;
+
+  ozz::vector<Clip*> clips_;
+
+  // Clips being loaded.
+  ozz::vector<int> pending_;
+
+  // Resident clips list, from least to most recently used.
+  int lru_head_;
+  int lru_tail_;
+
+  Stats stats_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_CACHE_H_
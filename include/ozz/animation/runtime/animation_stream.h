@@ -0,0 +1,181 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_STREAM_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_STREAM_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/animation/runtime/segmented_animation.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace io {
+class Stream;
+class AsyncReader;
+}  // namespace io
+namespace animation {
+
+// Plays a SegmentedAnimation from an io::Stream or a file, keeping only a
+// window of segments resident in memory. Segments are loaded (and unloaded) by
+// Update(), according to the playback ratio and lookahead.
+// Resident segments are sampled with a SamplingJob, see FindSegment().
+// When opened from an io::Stream, segments are loaded by Update() with blocking
+// stream reads. When opened from a file with an io::AsyncReader, Update() only
+// issues segments read requests, which are decoded by the thread the reader
+// completes them on. Each segment residency is then published atomically, so
+// that FindSegment() and sampling never wait for IO nor lock against the
+// loader: a segment that's still loading is simply not resident yet.
+// Update(), FindSegment() and sampling are expected to be called from the same
+// thread, or synchronized by the user, as Update() unloads segments.
+class OZZ_ANIMATION_DLL AnimationStream {
+ public:
+  // Builds an AnimationStream with no stream.
+  AnimationStream();
+
+  // Delete copies.
+  AnimationStream(AnimationStream const&) = delete;
+  AnimationStream& operator=(AnimationStream const&) = delete;
+
+  // Declares the public non-virtual destructor.
+  ~AnimationStream();
+
+  // Opens a SegmentedAnimation from _stream current position. The animation
+  // is expected to be the first object of an archive, as written with
+  // "OArchive(&stream) << segmented_animation".
+  // Only the animation header is read, no segment is loaded. _stream must be
+  // opened, seekable, and must remain valid until Close() or another Open().
+  // Returns false if _stream doesn't contain a valid SegmentedAnimation, or if
+  // the archive is compressed.
+  bool Open(io::Stream* _stream);
+
+  // Opens the SegmentedAnimation archive file _filename, whose segments are
+  // then loaded asynchronously with _reader. Only the animation header is read
+  // by Open(), synchronously. _reader must remain valid until Close() or
+  // another Open().
+  // Returns false if the file can't be opened or doesn't contain a valid
+  // SegmentedAnimation, or if the archive is compressed.
+  bool Open(io::AsyncReader* _reader, const char* _filename);
+
+  // Unloads all segments and releases the stream. Waits for pending
+  // asynchronous loads to complete first.
+  void Close();
+
+  // Tests if a stream or a file is opened.
+  bool opened() const { return stream_ != nullptr || reader_ != nullptr; }
+
+  // Ensures segments from the one containing _ratio to the next lookahead
+  // ones are resident, loading them from the stream, or issuing asynchronous
+  // loads. Other segments are unloaded, unless they're still loading. With
+  // _loop, lookahead continues from the first segment once the last one is
+  // reached.
+  // Returns false if nothing is opened or if a segment failed to load. Failed
+  // asynchronous loads are reported by the next Update(), and issued again.
+  bool Update(float _ratio, bool _loop = false);
+
+  // Number of segments to keep resident after the one containing the playback
+  // ratio.
+  // Default value is 1.
+  int lookahead;
+
+  // Gets the whole animation clip duration.
+  float duration() const { return animation_.duration(); }
+
+  // Gets the number of animated tracks.
+  int num_tracks() const { return animation_.num_tracks(); }
+
+  // Returns the number of SoA elements matching the number of tracks.
+  int num_soa_tracks() const { return animation_.num_soa_tracks(); }
+
+  // Gets animation name.
+  const char* name() const { return animation_.name(); }
+
+  // Gets the number of segments.
+  int num_segments() const { return animation_.num_segments(); }
+
+  // Gets segments boundaries, see SegmentedAnimation::segment_ratios().
+  span<const float> segment_ratios() const {
+    return animation_.segment_ratios();
+  }
+
+  // Tests if segment _index is resident.
+  bool resident(int _index) const;
+
+  // Tests if segment _index asynchronous load is pending.
+  bool loading(int _index) const;
+
+  // Finds the segment containing _ratio, and outputs to _segment_ratio the
+  // ratio to use to sample this segment. Returns the segment animation, or
+  // nullptr if segment isn't resident (possibly still loading).
+  const Animation* FindSegment(float _ratio, float* _segment_ratio) const;
+
+  // Gets the estimated size in bytes of the resident data.
+  size_t size() const;
+
+ private:
+  // Segment loading state, published atomically.
+  struct Segment;
+
+  // Reads animation header from _stream, and allocates segments. Returns false
+  // on failure.
+  bool OpenHeader(io::Stream* _stream);
+
+  // Unloads segment _index.
+  void Unload(int _index);
+
+  // Loads segment _index, from stream_ or issuing an asynchronous load.
+  // Returns false on failure.
+  bool Load(int _index);
+
+  // Decodes segment _index from _stream. Returns false on failure, leaving an
+  // empty segment animation.
+  bool Decode(io::Stream* _stream, int _index);
+
+  // AsyncReader completion, which decodes the segment _user_data.
+  static void Complete(io::Stream* _stream, void* _user_data);
+
+  // The input stream, nullptr if segments are loaded asynchronously.
+  io::Stream* stream_;
+
+  // The asynchronous reader, and the file it reads segments from.
+  io::AsyncReader* reader_;
+  ozz::string filename_;
+
+  // Animation header, with resident segments only.
+  SegmentedAnimation animation_;
+
+  // Stream offset of each segment, plus the end of the last one.
+  ozz::vector<int64_t> offsets_;
+
+  // Loading state of each segment.
+  Segment* segments_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_STREAM_H_
@@ -0,0 +1,161 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_BAKED_PACK_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_BAKED_PACK_H_
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/export.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/track.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace io {
+class Stream;
+}  // namespace io
+namespace animation {
+
+// Defines a baked pack, which bundles a skeleton with its animations and
+// tracks in a single relocatable image, see offline::BakedPackBuilder.
+// Unlike archives, a baked pack isn't parsed at runtime: it's read at once,
+// and every object is then set up in place from its image (see
+// Skeleton::FromImage(), Animation::FromImage() and Track::FromImage()), which
+// only consists in fixing up pointers. Images use platform native endianness,
+// so packs are baked for a specific platform.
+class OZZ_ANIMATION_DLL BakedPack {
+ public:
+  // Defines the alignment required for baked pack images.
+  enum { kImageAlignment = 16 };
+
+  // Defines the types of objects a baked pack can store.
+  enum Type {
+    kSkeleton,
+    kAnimation,
+    kFloatTrack,
+    kFloat2Track,
+    kFloat3Track,
+    kFloat4Track,
+    kQuaternionTrack,
+    kTypeCount,
+  };
+
+  // Baked pack image header, followed by num_entries Entry, and then by each
+  // entry image. Every image offset is aligned to kImageAlignment.
+  struct Header {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+    uint32_t num_entries;
+  };
+  struct Entry {
+    uint32_t type;
+    uint32_t offset;
+    uint32_t size;
+    uint32_t reserved;
+  };
+
+  // "ozzk" characters, in native endianness, and current image version.
+  enum : uint32_t { kImageMagic = 0x6b7a7a6f, kImageVersion = 1 };
+
+  // Constructs an empty pack. Objects (and the image buffer when using Load())
+  // are allocated with _allocator, nullptr meaning the default allocator.
+  explicit BakedPack(memory::Allocator* _allocator = nullptr);
+
+  // Delete copies.
+  BakedPack(BakedPack const&) = delete;
+  BakedPack& operator=(BakedPack const&) = delete;
+
+  ~BakedPack();
+
+  // Loads the baked pack image from _stream, reading it at once from its
+  // current position to its end, to a buffer owned by the pack.
+  // Returns false if _stream can't be read or isn't a valid baked pack image
+  // for this platform, in which case pack is left empty.
+  bool Load(io::Stream* _stream);
+
+  // Sets up the pack objects in place from _image, which must be aligned to
+  // kImageAlignment and must remain valid and unchanged for the pack lifetime
+  // (or until it's loaded again).
+  // Returns false if _image isn't a valid baked pack image for this platform,
+  // in which case pack is left empty.
+  bool FromImage(span<const byte> _image);
+
+  // Releases all objects, and the image buffer if it's owned by the pack.
+  void Reset();
+
+  // Gets the pack skeleton, nullptr if pack has none.
+  const Skeleton* skeleton() const {
+    return skeletons_.empty() ? nullptr : &skeletons_[0];
+  }
+
+  // Gets pack objects of each type, in the order they were baked.
+  span<const Animation> animations() const { return make_span(animations_); }
+  span<const FloatTrack> float_tracks() const {
+    return make_span(float_tracks_);
+  }
+  span<const Float2Track> float2_tracks() const {
+    return make_span(float2_tracks_);
+  }
+  span<const Float3Track> float3_tracks() const {
+    return make_span(float3_tracks_);
+  }
+  span<const Float4Track> float4_tracks() const {
+    return make_span(float4_tracks_);
+  }
+  span<const QuaternionTrack> quaternion_tracks() const {
+    return make_span(quaternion_tracks_);
+  }
+
+  // Finds the animation named _name. Returns nullptr if there's none.
+  const Animation* FindAnimation(const char* _name) const;
+
+ private:
+  // Sets up objects from _image, without resetting the pack.
+  bool Bind(span<const byte> _image);
+
+  // Allocator used for objects and allocation_, nullptr for the default
+  // allocator.
+  memory::Allocator* allocator_;
+
+  // Image buffer allocated by Load(), nullptr if image is provided by the
+  // user.
+  void* allocation_;
+
+  // Pack objects, set up in place from the image.
+  ozz::vector<Skeleton> skeletons_;
+  ozz::vector<Animation> animations_;
+  ozz::vector<FloatTrack> float_tracks_;
+  ozz::vector<Float2Track> float2_tracks_;
+  ozz::vector<Float3Track> float3_tracks_;
+  ozz::vector<Float4Track> float4_tracks_;
+  ozz::vector<QuaternionTrack> quaternion_tracks_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_BAKED_PACK_H_
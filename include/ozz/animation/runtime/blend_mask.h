@@ -0,0 +1,126 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_BLEND_MASK_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_BLEND_MASK_H_
+
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime skeleton.
+class Skeleton;
+
+// Per joint weights of a partial blending layer (see BlendingJob::Layer),
+// built from skeleton sub-hierarchies (ie: upper body from the spine) or joint
+// name patterns (ie: "*Finger*"), rather than by hand. A mask is meant to be
+// built once per skeleton and layer, and then reused every time the layer is
+// blended.
+// Alongside SoA joint weights, it maintains the BlendingJob::Layer::mask bits
+// of the SoA joints that have at least one positive weight, and their range,
+// so that blending skips SoA joints that are null.
+class OZZ_ANIMATION_DLL BlendMask {
+ public:
+  // Builds an empty mask, that must be Reset to be used.
+  BlendMask();
+
+  // Allow moves.
+  BlendMask(BlendMask&&);
+  BlendMask& operator=(BlendMask&&);
+
+  // Delete copies.
+  BlendMask(BlendMask const&) = delete;
+  BlendMask& operator=(BlendMask const&) = delete;
+
+  // Declares the public non-virtual destructor.
+  ~BlendMask();
+
+  // Setups the mask for _skeleton, which must outlive the mask, with all joint
+  // weights set to _weight.
+  void Reset(const Skeleton& _skeleton, float _weight = 0.f);
+
+  // Sets the weight of _root joint and all its descendants to _weight.
+  // Returns false if _root isn't a valid joint index, in which case the mask
+  // is unchanged.
+  bool SetSubtree(int _root, float _weight);
+
+  // Sets the weight of joints whose name matches _pattern, which supports '*'
+  // and '?' wildcard characters, to _weight. Descendants of matching joints
+  // are set too if _subtree is true.
+  // Returns the number of matching joints.
+  int SetPattern(const char* _pattern, float _weight, bool _subtree = true);
+
+  // Returns the number of joints of the skeleton, 0 before the mask is Reset.
+  int num_joints() const { return num_joints_; }
+
+  // Returns SoA joint weights, to be used as BlendingJob::Layer::joint_weights.
+  span<const math::SimdFloat4> joint_weights() const {
+    return make_span(joint_weights_);
+  }
+
+  // Returns SoA joints mask, to be used as BlendingJob::Layer::mask. Bit i%8 of
+  // byte i/8 is set if any joint weight of SoA joint i is positive.
+  span<const uint8_t> mask() const { return make_span(mask_); }
+
+  // Returns the range [soa_begin(),soa_end()[ of SoA joints enabled in the
+  // mask. Range is empty if all weights are null.
+  int soa_begin() const { return soa_begin_; }
+  int soa_end() const { return soa_end_; }
+
+  // Sets up _layer joint_weights and mask with this blend mask.
+  void Apply(BlendingJob::Layer* _layer) const;
+
+ private:
+  // Sets joint _joint weight.
+  void SetWeight(int _joint, float _weight);
+
+  // Updates mask and SoA range from joint weights.
+  void UpdateMask();
+
+  // Skeleton the mask is built for.
+  const Skeleton* skeleton_;
+  int num_joints_;
+
+  // SoA joint weights. Lanes beyond the last joint are null.
+  ozz::vector<math::SimdFloat4> joint_weights_;
+
+  // SoA joints mask.
+  ozz::vector<uint8_t> mask_;
+
+  // Range of enabled SoA joints.
+  int soa_begin_;
+  int soa_end_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_BLEND_MASK_H_
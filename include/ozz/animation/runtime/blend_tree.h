@@ -0,0 +1,219 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_BLEND_TREE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_BLEND_TREE_H_
+
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/export.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace math {
+struct SoaTransform;
+}
+namespace animation {
+
+// Forward declares the animation type to sample.
+class Animation;
+
+// Evaluates a tree (or any acyclic graph) of clip and blend nodes, using
+// SamplingJob and BlendingJob. Clip nodes sample an animation, blend nodes
+// blend (or add) the output of their input nodes.
+// Evaluation is incremental: every node keeps its output from one evaluation
+// to the next, and a node is only updated if its parameters (ratio, weights...)
+// changed, or if the output of one of its active inputs was updated. Inputs
+// with a null weight aren't evaluated at all. Evaluation cost thus scales with
+// the number of active and changing nodes, rather than with the total number
+// of nodes.
+// Nodes outputs are allocated in a single buffer, and clip nodes sampling
+// contexts in a single SamplingJob::ContextBank, both sized on the first
+// evaluation that follows a change of the tree layout (adding nodes, changing
+// rest pose).
+// Nodes are identified by the index returned when they're added. An input
+// node must be added before the blend node it's connected to, which forbids
+// cycles.
+class OZZ_ANIMATION_DLL BlendTree {
+ public:
+  // Constructs an empty tree.
+  BlendTree();
+
+  // Disables copy and assignation.
+  BlendTree(BlendTree const&) = delete;
+  BlendTree& operator=(BlendTree const&) = delete;
+
+  // Deallocates tree buffers.
+  ~BlendTree();
+
+  // Adds a clip node that samples _animation, which must remain valid as long
+  // as the node is used. Returns the index of the new node.
+  int AddClip(const Animation& _animation);
+
+  // Adds a blend node, with no input. The node outputs the rest pose until
+  // inputs are added. Blending threshold defaults to BlendingJob one.
+  // Returns the index of the new node.
+  int AddBlend();
+
+  // Adds node _input as an input layer of blend node _blend, as a normal or an
+  // additive layer. Input weight defaults to 0, see SetWeight().
+  // Returns the index of the input in _blend inputs, or -1 if _blend isn't a
+  // blend node, or if _input isn't a node added before _blend.
+  int AddInput(int _blend, int _input, bool _additive = false);
+
+  // Sets clip node _clip sampling ratio, see SamplingJob::ratio.
+  // Returns false if _clip isn't a clip node.
+  bool SetRatio(int _clip, float _ratio);
+
+  // Sets the blending weight of input _input of blend node _blend, see
+  // BlendingJob::Layer::weight. Input nodes with a null weight (or negative
+  // for normal layers) aren't evaluated.
+  // Returns false if _blend or _input are invalid.
+  bool SetWeight(int _blend, int _input, float _weight);
+
+  // Sets optional joint weights of input _input of blend node _blend, see
+  // BlendingJob::Layer::joint_weights. _joint_weights must remain valid as
+  // long as it's used by the tree, and must be as big as the rest pose. If
+  // its content changes, Invalidate(_blend) must be called.
+  // Returns false if _blend or _input are invalid.
+  bool SetJointWeights(int _blend, int _input,
+                       const span<const math::SimdFloat4>& _joint_weights);
+
+  // Sets optional SoA joints mask of input _input of blend node _blend, see
+  // BlendingJob::Layer::mask. Same lifetime and invalidation rules as
+  // SetJointWeights() apply.
+  // Returns false if _blend or _input are invalid.
+  bool SetMask(int _blend, int _input, const span<const uint8_t>& _mask);
+
+  // Sets the blending threshold of blend node _blend, see
+  // BlendingJob::threshold.
+  // Returns false if _blend isn't a blend node, or _threshold isn't valid.
+  bool SetThreshold(int _blend, float _threshold);
+
+  // Forces node _node to be updated on next evaluation.
+  void Invalidate(int _node);
+
+  // Forces all nodes to be updated on next evaluation.
+  void Invalidate();
+
+  // Evaluates node _root (and the active part of the tree it depends on) for
+  // _rest_pose skeleton rest pose, see BlendingJob::rest_pose. Node output is
+  // then available through output(_root).
+  // Animations must not have more tracks than the rest pose. Clip nodes
+  // sampling an animation with less tracks output rest pose for the missing
+  // ones.
+  // _rest_pose must remain valid until next evaluation. Tree is invalidated if
+  // _rest_pose range changes. If its content changes, Invalidate() must be
+  // called.
+  // Returns false if _root or _rest_pose is invalid, or if any job failed.
+  bool Evaluate(int _root, const span<const math::SoaTransform>& _rest_pose);
+
+  // Gets node _node output of the last evaluation. Returns an empty range if
+  // _node is invalid, or if the tree wasn't evaluated since its layout
+  // changed.
+  span<const math::SoaTransform> output(int _node) const;
+
+  // Number of nodes.
+  int num_nodes() const { return static_cast<int>(nodes_.size()); }
+
+  // Number of nodes that were updated (sampled or blended) during last
+  // evaluation.
+  int num_updated_nodes() const { return num_updated_nodes_; }
+
+ private:
+  // Defines a blend node input.
+  struct Input {
+    int node;
+    bool additive;
+    float weight;
+    span<const math::SimdFloat4> joint_weights;
+    span<const uint8_t> mask;
+    // Input node version the blend node output was computed with.
+    uint32_t version;
+  };
+
+  // Defines a node.
+  struct Node {
+    // Clip node animation, nullptr for a blend node.
+    const Animation* animation;
+    float ratio;
+
+    // Clip node sampling context index in contexts_.
+    int context;
+
+    // Blend node parameters.
+    float threshold;
+    ozz::vector<Input> inputs;
+
+    // Incremented every time node output is updated.
+    uint32_t version;
+
+    // Node parameters changed since last update.
+    bool dirty;
+  };
+
+  // Finds blend node _blend input _input, or nullptr if invalid.
+  Input* FindInput(int _blend, int _input);
+
+  // Allocates nodes outputs and contexts for _rest_pose if tree layout
+  // changed. Returns false if an animation has more tracks than the rest
+  // pose.
+  bool Allocate(const span<const math::SoaTransform>& _rest_pose);
+
+  // Releases nodes outputs allocation.
+  void Release();
+
+  // Updates node _node if needed.
+  bool EvaluateNode(int _node);
+
+  // Tree nodes.
+  ozz::vector<Node> nodes_;
+
+  // Rest pose used for the last evaluation.
+  span<const math::SoaTransform> rest_pose_;
+
+  // Nodes outputs, num_soa_joints_ per node, in nodes order.
+  span<math::SoaTransform> outputs_;
+  int num_soa_joints_;
+
+  // Clip nodes sampling contexts, in clip nodes order.
+  SamplingJob::ContextBank contexts_;
+
+  // Scratch blending layers, reused across evaluations.
+  ozz::vector<BlendingJob::Layer> layers_;
+
+  // Tree layout changed since last allocation.
+  bool layout_changed_;
+
+  int num_updated_nodes_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_BLEND_TREE_H_
@@ -29,6 +29,8 @@
 #define OZZ_OZZ_ANIMATION_RUNTIME_BLENDING_JOB_H_
 
 #include "ozz/animation/runtime/export.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/job_plan.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/span.h"
 
@@ -37,6 +39,7 @@ namespace ozz {
 // Forward declaration of math structures.
 namespace math {
 struct SoaTransform;
+struct SoaHalfTransform;
 }
 
 namespace animation {
@@ -51,6 +54,10 @@ namespace animation {
 // can be specified with layers joint_weights buffer. Unspecified joint weights
 // are considered as a unit weight of 1.f, allowing to mix full and partial
 // blend operations in a single pass.
+// Output is processed by small chunks of SoA joints, each chunk going through
+// all blending stages (layers blending, rest pose, normalization and additive
+// layers) while it's still in cache, rather than sweeping the whole output
+// for each stage.
 // The job does not owned any buffers (input/output) and will thus not delete
 // them during job's destruction.
 struct OZZ_ANIMATION_DLL BlendingJob {
@@ -65,6 +72,12 @@ struct OZZ_ANIMATION_DLL BlendingJob {
   // -if output range is not valid.
   // -if any buffer (including layers' content : transform, joint weights...) is
   // smaller than the rest pose buffer.
+  // -if any layer sets both or none of transform and half_transform.
+  // -if any layer mask isn't empty, and too small for the rest pose.
+  // -if any sparse layer (soa_joints isn't empty) also has a mask, has SoA
+  // joint indices that aren't strictly increasing or out of the rest pose
+  // range, or has transform or joint weights buffers smaller than its number
+  // of SoA joints.
   // -if the threshold value is less than or equal to 0.f.
   bool Validate() const;
 
@@ -92,6 +105,13 @@ struct OZZ_ANIMATION_DLL BlendingJob {
     // processed.
     span<const math::SoaTransform> transform;
 
+    // Optional half precision input layer posture, used instead of transform
+    // (which must then be empty), with the same range rules. Half precision
+    // layers use half the memory and bandwidth, at the cost of a conversion
+    // when blended. They're usually outputted by a sampling job, see
+    // SamplingJob::half_output.
+    span<const math::SoaHalfTransform> half_transform;
+
     // Optional range [begin,end[ of blending weight for each joint in this
     // layer.
     // If both pointers are nullptr (default case) then per joint weight
@@ -105,6 +125,31 @@ struct OZZ_ANIMATION_DLL BlendingJob {
     // aren't clamped because they could exceed 1.f if all layers contains valid
     // joint weights.
     span<const math::SimdFloat4> joint_weights;
+
+    // Optional SoA joints mask, restricting the layer to the joints it
+    // affects (ie: face or hand layers). Bit i%8 of byte i/8 enables SoA joint
+    // i (joints 4*i to 4*i+3), using the same format as SamplingJob::mask.
+    // Disabled SoA joints are considered as having a null weight, and are
+    // skipped by blending loops, neither transform nor joint weights are read
+    // for them. The cost of a masked layer is thus proportional to the number
+    // of enabled SoA joints, with the exception of the first blended (non
+    // additive) layer, which also needs to initialize disabled joints. A
+    // masked layer is implicitly a partial blending layer.
+    // If not empty, mask must contain at least (rest_pose.size() + 7) / 8
+    // bytes. Default is empty, which enables all joints.
+    span<const uint8_t> mask;
+
+    // Optional sorted indices of the SoA joints (joints 4*i to 4*i+3) stored
+    // by a sparse layer, typically a delta from the rest pose that only
+    // affects a few joints (additive or partial layers). When not empty,
+    // transform (and joint_weights if any) are compact: transform[k] is the
+    // value of SoA joint soa_joints[k], so they only need to be as big as
+    // soa_joints. Indices must be strictly increasing and in the rest pose
+    // range. Like masked layers, SoA joints that aren't listed are considered
+    // as having a null weight, and only listed ones are visited by blending
+    // loops. A sparse layer can't have a mask.
+    // Default is empty, which means that the layer is dense.
+    span<const uint16_t> soa_joints;
   };
 
   // The job blends the rest pose to the output when the accumulated weight of
@@ -127,6 +172,106 @@ struct OZZ_ANIMATION_DLL BlendingJob {
   // less than the threshold value, in order to fall back on valid transforms.
   span<const ozz::math::SoaTransform> rest_pose;
 
+  // Job output.
+  // The range of output transforms to be filled with blended layer
+  // transforms during job execution.
+  // Must be at least as big as the rest pose buffer, but only the number of
+  // transforms defined by the rest pose buffer size will be processed.
+  span<ozz::math::SoaTransform> output;
+
+ private:
+  friend class ozz::JobPlan<BlendingJob>;
+
+  // Runs the valid job, without validating it. See JobPlan.
+  void RunUnchecked() const;
+};
+
+// Samples and blends multiple animations in a single pass, without
+// materializing each layer local-space pose. The result is the same as
+// running a SamplingJob per layer, followed by a BlendingJob with the same
+// threshold, weights and rest pose (including rest pose fallback and additive
+// layers).
+// Every layer context is first updated (keyframes decompression) for the
+// layer animation and ratio. Output is then processed by chunks of SoA joints:
+// each layer chunk is interpolated to a small stack buffer, and immediately
+// blended to the output chunk. This way intermediate transforms never leave
+// the cache, as opposed to the per-layer output buffers BlendingJob needs.
+// Layers with a null weight are neither sampled nor blended.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct OZZ_ANIMATION_DLL SampleBlendingJob {
+  // Default constructor, initializes default values.
+  SampleBlendingJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if any layer animation or context is nullptr.
+  // -if any layer animation has less SoA tracks than the rest pose, or if its
+  // context is too small for it (or without tangents for a cubic animation).
+  // -if any layer joint weights range isn't empty and smaller than the rest
+  // pose buffer.
+  // -if output range is smaller than the rest pose buffer.
+  // -if the threshold value is less than or equal to 0.f.
+  bool Validate() const;
+
+  // Runs job's sampling and blending task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Defines a layer of sampling input data (animation, ratio and context) and
+  // blending parameters (weights).
+  struct OZZ_ANIMATION_DLL Layer {
+    // Default constructor, initializes default values.
+    Layer();
+
+    // Blending weight of this layer, see BlendingJob::Layer::weight.
+    float weight;
+
+    // The animation to sample.
+    const Animation* animation;
+
+    // Time ratio in the unit interval [0,1] used to sample animation, see
+    // SamplingJob::ratio. Ignored if the job is synchronized.
+    float ratio;
+
+    // A context object that must be big enough to sample *this animation. A
+    // context shouldn't be used by two layers of the same job.
+    SamplingJob::Context* context;
+
+    // Optional range [begin,end[ of blending weight for each joint in this
+    // layer, see BlendingJob::Layer::joint_weights.
+    span<const math::SimdFloat4> joint_weights;
+  };
+
+  // The job blends the rest pose to the output when the accumulated weight of
+  // all layers is less than this threshold value.
+  // Must be greater than 0.f.
+  float threshold;
+
+  // Job input layers, can be empty or nullptr.
+  // The range of layers that must be sampled and blended.
+  span<const Layer> layers;
+
+  // Job input additive layers, can be empty or nullptr.
+  // The range of layers that must be sampled and added to the output.
+  span<const Layer> additive_layers;
+
+  // Samples all layers (including additive ones) in lockstep at the job ratio
+  // instead of their own Layer::ratio. This is the common case of blend
+  // spaces (ie: directional locomotion), whose animations are authored to be
+  // synchronized, so they only need a single normalized time to be advanced.
+  // Default is false.
+  bool synchronized;
+
+  // Time ratio in the unit interval [0,1] shared by all layers when the job is
+  // synchronized, see SamplingJob::ratio. Default is 0.
+  float ratio;
+
+  // The skeleton rest pose, see BlendingJob::rest_pose.
+  span<const ozz::math::SoaTransform> rest_pose;
+
   // Job output.
   // The range of output transforms to be filled with blended layer
   // transforms during job execution.
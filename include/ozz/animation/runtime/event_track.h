@@ -0,0 +1,142 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_EVENT_TRACK_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_EVENT_TRACK_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace memory {
+class Allocator;
+}  // namespace memory
+namespace animation {
+
+// Forward declares the TrackBuilder, used to instantiate an EventTrack.
+namespace offline {
+class TrackBuilder;
+}
+
+// Runtime boolean track, for gameplay events windows (foot contacts, hit or
+// cancel windows...). Compared to a FloatTrack of step keys used with
+// TrackTriggeringJob, it only stores the ratios where the state toggles,
+// quantized to 16 bits. The state is off at the beginning of the track, and
+// toggled at every toggle ratio, included. State and windows queries are
+// binary searches. EventTrack is built from a RawEventTrack with a
+// TrackBuilder.
+class OZZ_ANIMATION_DLL EventTrack {
+ public:
+  // Builds a default track. Track buffer is allocated with _allocator when the
+  // track is built or loaded, nullptr meaning the default allocator.
+  explicit EventTrack(memory::Allocator* _allocator = nullptr);
+
+  // Allow move.
+  EventTrack(EventTrack&& _other);
+  EventTrack& operator=(EventTrack&& _other);
+
+  // Disables copy and assignation.
+  EventTrack(EventTrack const&) = delete;
+  void operator=(EventTrack const&) = delete;
+
+  ~EventTrack();
+
+  // Quantized toggles ratios accessor, sorted in strict ascending order. 0 is
+  // the beginning of the track, kMaxToggle the end.
+  enum { kMaxToggle = 65535 };
+  span<const uint16_t> toggles() const { return toggles_; }
+
+  // Gets the number of toggles.
+  int num_toggles() const { return static_cast<int>(toggles_.size()); }
+
+  // Gets toggle _index ratio.
+  float toggle_ratio(int _index) const;
+
+  // Gets the state at _ratio, clamped to [0,1].
+  bool State(float _ratio) const;
+
+  // Defines an "on" state window, from begin (included) to end (excluded). The
+  // last window ends at 1 (included) if the state is still on at the end of
+  // the track.
+  struct Window {
+    float begin;
+    float end;
+  };
+
+  // Enumerates windows intersecting [_from,_to] ratio range, in ascending
+  // order. _from must be smaller or equal to _to, and the range isn't looped.
+  // A window intersects the range if the state is on at any ratio of the
+  // range, hence a [_ratio,_ratio] range finds the window of State(_ratio).
+  // Windows aren't clipped to the range. The first _windows.size() windows are
+  // written to _windows, and the total number of intersecting windows is
+  // returned, which can be bigger than _windows.size().
+  size_t Windows(float _from, float _to, span<Window> _windows) const;
+
+  // Returns the allocator used for track buffer, nullptr for the default
+  // allocator.
+  memory::Allocator* allocator() const { return allocator_; }
+
+  // Get the estimated track's size in bytes.
+  size_t size() const;
+
+  // Get track name.
+  const char* name() const { return name_ ? name_ : ""; }
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // TrackBuilder class is allowed to allocate an EventTrack.
+  friend class offline::TrackBuilder;
+
+  // Internal allocation and destruction functions.
+  void Allocate(size_t _toggles_count, size_t _name_len);
+  void Deallocate();
+
+  // Returns the number of toggles whose ratio is smaller or equal to _ratio.
+  size_t CountToggles(float _ratio) const;
+
+  // Quantized toggles ratios.
+  span<uint16_t> toggles_;
+
+  // Track name.
+  char* name_;
+
+  // Allocator used for track buffer, nullptr for the default allocator.
+  memory::Allocator* allocator_;
+};
+}  // namespace animation
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::EventTrack)
+OZZ_IO_TYPE_TAG("ozz-event_track", animation::EventTrack)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_EVENT_TRACK_H_
@@ -0,0 +1,193 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_FEATURE_DATABASE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_FEATURE_DATABASE_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace io {
+class IArchive;
+class OArchive;
+}  // namespace io
+namespace animation {
+
+// Forward declares the FeatureDatabaseBuilder, used to instantiate a
+// FeatureDatabase.
+namespace offline {
+class FeatureDatabaseBuilder;
+}
+
+// Defines a motion matching features database: a matrix of features (joints
+// positions and velocities, future trajectory...), one row per frame sampled
+// from a set of animation clips. See offline::FeatureDatabaseBuilder for
+// features layout. MotionMatchingJob searches the frame whose features are
+// the nearest to a query.
+// Features are normalized (centered and scaled by their standard deviation
+// and weight), so that the squared euclidean distance between normalized
+// features is the matching cost. They are stored in SoA, 4 frames per block,
+// so that 4 frames costs are computed at once.
+// Frames are also grouped in bounding boxes (of kSmallBoxFrames and
+// kLargeBoxFrames frames), so that the search skips all frames of a box whose
+// nearest point is further than the best match found so far. As frames of a
+// clip are contiguous and animations continuous, boxes are small compared to
+// the whole features space.
+class OZZ_ANIMATION_DLL FeatureDatabase {
+ public:
+  // Defines an animation clip, as a range of frames.
+  struct Clip {
+    // Index of the first frame of the clip.
+    int first_frame;
+    // Number of frames of the clip.
+    int num_frames;
+    // Clip animation duration, in seconds.
+    float duration;
+  };
+
+  // Number of frames per bounding boxes.
+  enum {
+    kSmallBoxFrames = 16,
+    kLargeBoxFrames = 64,
+  };
+
+  // Builds a default empty database.
+  FeatureDatabase();
+
+  // Allow moves.
+  FeatureDatabase(FeatureDatabase&&);
+  FeatureDatabase& operator=(FeatureDatabase&&);
+
+  // Delete copies.
+  FeatureDatabase(FeatureDatabase const&) = delete;
+  FeatureDatabase& operator=(FeatureDatabase const&) = delete;
+
+  // Declares the public non-virtual destructor.
+  ~FeatureDatabase();
+
+  // Returns the number of features per frame.
+  int num_features() const { return num_features_; }
+
+  // Returns the number of frames, of all clips.
+  int num_frames() const { return num_frames_; }
+
+  // Returns the number of clips.
+  int num_clips() const { return static_cast<int>(clips_.size()); }
+
+  // Returns clips frames ranges, in the order they were built.
+  span<const Clip> clips() const { return make_span(clips_); }
+
+  // Returns the frequency clips were sampled at, in frames per second.
+  float sample_rate() const { return sample_rate_; }
+
+  // Returns the clip _frame belongs to, or -1 if _frame is out of range.
+  int clip(int _frame) const;
+
+  // Returns the ratio of _frame in its clip animation, or 0 if _frame is out
+  // of range.
+  float ratio(int _frame) const;
+
+  // Returns the frame of _clip the nearest to _ratio, or -1 if _clip is out of
+  // range.
+  int frame(int _clip, float _ratio) const;
+
+  // Normalizes _raw features to _normalized, which must both be at least
+  // num_features() long. _raw and _normalized can alias. Returns false if a
+  // buffer is too small.
+  bool Normalize(span<const float> _raw, span<float> _normalized) const;
+
+  // Gets _frame raw (not normalized) features to _raw, which must be at least
+  // num_features() long. This is typically used to build a query from the
+  // current playback frame, replacing its trajectory by the desired one.
+  // Returns false if _frame is out of range or _raw is too small.
+  bool GetFeatures(int _frame, span<float> _raw) const;
+
+  // Returns normalized features of the block of 4 frames _block, as
+  // num_features() SoA values (a lane per frame). Lanes of the last block
+  // beyond num_frames() are zeroed.
+  span<const math::SimdFloat4> block(int _block) const;
+
+  // Returns the number of 4 frames blocks.
+  int num_blocks() const { return (num_frames_ + 3) / 4; }
+
+  // Returns bounding boxes, as num_features() minimum values followed by
+  // num_features() maximum values per box, of normalized features.
+  span<const float> small_boxes() const { return make_span(small_boxes_); }
+  span<const float> large_boxes() const { return make_span(large_boxes_); }
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // FeatureDatabaseBuilder class is allowed to instantiate a FeatureDatabase.
+  friend class offline::FeatureDatabaseBuilder;
+
+  // Computes bounding boxes from features_.
+  void BuildBoxes();
+
+  // Resets database to its default empty state.
+  void Reset();
+
+  // Number of features per frame.
+  int num_features_;
+
+  // Number of frames of all clips.
+  int num_frames_;
+
+  // Clips sampling frequency.
+  float sample_rate_;
+
+  // Clips frames ranges.
+  ozz::vector<Clip> clips_;
+
+  // Per feature normalization offset (mean) and scale (weight divided by
+  // standard deviation): normalized = (raw - offset) * scale.
+  ozz::vector<float> offsets_;
+  ozz::vector<float> scales_;
+
+  // Normalized features, num_features_ SoA values per block of 4 frames.
+  ozz::vector<math::SimdFloat4> features_;
+
+  // Bounding boxes, derived from features_, see small_boxes().
+  ozz::vector<float> small_boxes_;
+  ozz::vector<float> large_boxes_;
+};
+}  // namespace animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::FeatureDatabase)
+OZZ_IO_TYPE_TAG("ozz-feature_database", animation::FeatureDatabase)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_FEATURE_DATABASE_H_
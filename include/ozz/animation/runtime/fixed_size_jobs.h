@@ -0,0 +1,398 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_FIXED_SIZE_JOBS_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_FIXED_SIZE_JOBS_H_
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+#include "ozz/base/span.h"
+
+// Defines variants of SamplingJob, BlendingJob and LocalToModelJob for rigs
+// whose size is known at compile time. The number of SoA joints is a template
+// argument, so that loops have a constant trip count that the compiler can
+// unroll, keeping intermediate values in registers.
+// These are header only templates, instantiated for the sizes the user needs.
+// They support the common full pose subset of their runtime counterparts
+// features, and output the same results.
+
+namespace ozz {
+namespace animation {
+
+// Compile-time skeleton size descriptor, to be used as the template argument
+// of fixed size jobs: ie FixedBlendingJob<HeroRig::kNumSoaJoints>, with
+// typedef FixedSkeletonSize<67> HeroRig.
+template <int _NumJoints>
+struct FixedSkeletonSize {
+  static const int kNumJoints = _NumJoints;
+  static const int kNumSoaJoints = (_NumJoints + 3) / 4;
+};
+
+template <int _NumJoints>
+const int FixedSkeletonSize<_NumJoints>::kNumJoints;
+template <int _NumJoints>
+const int FixedSkeletonSize<_NumJoints>::kNumSoaJoints;
+
+// Samples an animation with _NumSoaTracks SoA tracks, see SamplingJob.
+// Keyframes decompression is driven by the animation data rather than by the
+// number of tracks, so sampling is delegated to SamplingJob. This variant
+// only checks that the animation matches the fixed size, so that a fixed size
+// pipeline can be built from sampling to local-to-model.
+template <int _NumSoaTracks>
+struct FixedSamplingJob {
+  static const int kNumSoaTracks = _NumSoaTracks;
+
+  FixedSamplingJob() : animation(nullptr), context(nullptr), ratio(0.f) {}
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if animation isn't exactly _NumSoaTracks SoA tracks.
+  // -if output range is smaller than _NumSoaTracks.
+  // -if SamplingJob with the same parameters isn't valid.
+  bool Validate() const {
+    return animation && animation->num_soa_tracks() == _NumSoaTracks &&
+           output.size() >= _NumSoaTracks && Job().Validate();
+  }
+
+  // Runs job's sampling task.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const {
+    if (!Validate()) {
+      return false;
+    }
+    return Job().Run();
+  }
+
+  // The animation to sample, see SamplingJob::animation.
+  const Animation* animation;
+
+  // Sampling context, see SamplingJob::context.
+  SamplingJob::Context* context;
+
+  // Time ratio in the unit interval [0,1], see SamplingJob::ratio.
+  float ratio;
+
+  // Job output, at least _NumSoaTracks SoA transforms.
+  span<math::SoaTransform> output;
+
+ private:
+  SamplingJob Job() const {
+    SamplingJob job;
+    job.animation = animation;
+    job.context = context;
+    job.ratio = ratio;
+    job.output = output.first(_NumSoaTracks);
+    return job;
+  }
+};
+
+namespace internal {
+
+// Blends the first pass, see BlendingJob.
+OZZ_INLINE void FixedBlend1stPass(const math::SoaTransform& _in,
+                                  math::SimdFloat4 _weight,
+                                  math::SoaTransform* _out) {
+  _out->translation = _in.translation * _weight;
+  _out->rotation = _in.rotation * _weight;
+  _out->scale = _in.scale * _weight;
+}
+
+// Blends any pass but the first, negating opposed quaternions to take the
+// shortest path.
+OZZ_INLINE void FixedBlendNPass(const math::SoaTransform& _in,
+                                math::SimdFloat4 _weight,
+                                math::SoaTransform* _out) {
+  _out->translation = _out->translation + _in.translation * _weight;
+  const math::SimdInt4 sign = math::Sign(Dot(_out->rotation, _in.rotation));
+  const math::SoaQuaternion rotation = {
+      math::Xor(_in.rotation.x, sign), math::Xor(_in.rotation.y, sign),
+      math::Xor(_in.rotation.z, sign), math::Xor(_in.rotation.w, sign)};
+  _out->rotation = _out->rotation + rotation * _weight;
+  _out->scale = _out->scale + _in.scale * _weight;
+}
+
+// Interpolates quaternion between identity and _in, fixing up its sign so
+// that lerp takes the shortest path.
+OZZ_INLINE math::SoaQuaternion FixedAdditiveRotation(
+    const math::SoaQuaternion& _in, math::SimdFloat4 _weight) {
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdInt4 sign = math::Sign(_in.w);
+  const math::SoaQuaternion rotation = {
+      math::Xor(_in.x, sign), math::Xor(_in.y, sign), math::Xor(_in.z, sign),
+      math::Xor(_in.w, sign)};
+  const math::SoaQuaternion interp_quat = {
+      rotation.x * _weight, rotation.y * _weight, rotation.z * _weight,
+      (rotation.w - one) * _weight + one};
+  return NormalizeEst(interp_quat);
+}
+
+// Adds a pass, see BlendingJob::additive_layers.
+OZZ_INLINE void FixedAddPass(const math::SoaTransform& _in,
+                             math::SimdFloat4 _weight,
+                             math::SimdFloat4 _one_minus_weight,
+                             math::SoaTransform* _out) {
+  const math::SoaFloat3 one_minus_weight_f3 = {
+      _one_minus_weight, _one_minus_weight, _one_minus_weight};
+  _out->translation = _out->translation + _in.translation * _weight;
+  _out->rotation =
+      FixedAdditiveRotation(_in.rotation, _weight) * _out->rotation;
+  _out->scale = _out->scale * (one_minus_weight_f3 + (_in.scale * _weight));
+}
+
+// Subtracts a pass, see BlendingJob::additive_layers.
+OZZ_INLINE void FixedSubPass(const math::SoaTransform& _in,
+                             math::SimdFloat4 _weight,
+                             math::SimdFloat4 _one_minus_weight,
+                             math::SoaTransform* _out) {
+  _out->translation = _out->translation - _in.translation * _weight;
+  _out->rotation =
+      Conjugate(FixedAdditiveRotation(_in.rotation, _weight)) * _out->rotation;
+  const math::SoaFloat3 rcp_scale = {
+      math::RcpEst(math::MAdd(_in.scale.x, _weight, _one_minus_weight)),
+      math::RcpEst(math::MAdd(_in.scale.y, _weight, _one_minus_weight)),
+      math::RcpEst(math::MAdd(_in.scale.z, _weight, _one_minus_weight))};
+  _out->scale = _out->scale * rcp_scale;
+}
+}  // namespace internal
+
+// Blends _NumSoaJoints SoA joints, see BlendingJob.
+// Layers are full layers: per-joint weights, masks and sparse layers aren't
+// supported, BlendingJob must be used for partial blending.
+template <int _NumSoaJoints>
+struct FixedBlendingJob {
+  static const int kNumSoaJoints = _NumSoaJoints;
+
+  FixedBlendingJob() : threshold(.1f) {}
+
+  // Defines a layer of blending input data, see BlendingJob::Layer.
+  struct Layer {
+    Layer() : weight(0.f) {}
+
+    // Blending weight of this layer, see BlendingJob::Layer::weight.
+    float weight;
+
+    // Layer local space transforms, at least _NumSoaJoints SoA transforms.
+    span<const math::SoaTransform> transform;
+  };
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if rest pose, output or any layer transform range is smaller than
+  // _NumSoaJoints.
+  // -if the threshold value is less than or equal to 0.f.
+  bool Validate() const {
+    bool valid = threshold > 0.f;
+    valid &= rest_pose.size() >= _NumSoaJoints;
+    valid &= output.size() >= _NumSoaJoints;
+    for (const Layer& layer : layers) {
+      valid &= layer.transform.size() >= _NumSoaJoints;
+    }
+    for (const Layer& layer : additive_layers) {
+      valid &= layer.transform.size() >= _NumSoaJoints;
+    }
+    return valid;
+  }
+
+  // Runs job's blending task.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const {
+    OZZ_PROFILE_ZONE("FixedBlendingJob::Run");
+
+    if (!Validate()) {
+      return false;
+    }
+
+    math::SoaTransform* out = output.data();
+
+    // Blends layers. All layers are full, so accumulated weight is the same
+    // for all joints.
+    float accumulated_weight = 0.f;
+    bool first_pass = true;
+    for (const Layer& layer : layers) {
+      if (layer.weight <= 0.f) {
+        continue;
+      }
+      accumulated_weight += layer.weight;
+      const math::SimdFloat4 weight = math::simd_float4::Load1(layer.weight);
+      const math::SoaTransform* in = layer.transform.data();
+      if (first_pass) {
+        for (int i = 0; i < _NumSoaJoints; ++i) {
+          internal::FixedBlend1stPass(in[i], weight, out + i);
+        }
+        first_pass = false;
+      } else {
+        for (int i = 0; i < _NumSoaJoints; ++i) {
+          internal::FixedBlendNPass(in[i], weight, out + i);
+        }
+      }
+    }
+
+    // Blends rest pose if accumulated weight is less than the threshold.
+    const float bp_weight = threshold - accumulated_weight;
+    if (bp_weight > 0.f) {
+      if (first_pass) {
+        accumulated_weight = 1.f;
+        for (int i = 0; i < _NumSoaJoints; ++i) {
+          out[i] = rest_pose[i];
+        }
+      } else {
+        accumulated_weight = threshold;
+        const math::SimdFloat4 weight = math::simd_float4::Load1(bp_weight);
+        for (int i = 0; i < _NumSoaJoints; ++i) {
+          internal::FixedBlendNPass(rest_pose[i], weight, out + i);
+        }
+      }
+    }
+
+    // Normalizes output.
+    const math::SimdFloat4 ratio =
+        math::simd_float4::Load1(1.f / accumulated_weight);
+    for (int i = 0; i < _NumSoaJoints; ++i) {
+      out[i].rotation = NormalizeEst(out[i].rotation);
+      out[i].translation = out[i].translation * ratio;
+      out[i].scale = out[i].scale * ratio;
+    }
+
+    // Adds (or subtracts) additive layers.
+    const math::SimdFloat4 one = math::simd_float4::one();
+    for (const Layer& layer : additive_layers) {
+      if (layer.weight == 0.f) {
+        continue;
+      }
+      const math::SoaTransform* in = layer.transform.data();
+      const math::SimdFloat4 weight = math::simd_float4::Load1(
+          layer.weight > 0.f ? layer.weight : -layer.weight);
+      const math::SimdFloat4 one_minus_weight = one - weight;
+      if (layer.weight > 0.f) {
+        for (int i = 0; i < _NumSoaJoints; ++i) {
+          internal::FixedAddPass(in[i], weight, one_minus_weight, out + i);
+        }
+      } else {
+        for (int i = 0; i < _NumSoaJoints; ++i) {
+          internal::FixedSubPass(in[i], weight, one_minus_weight, out + i);
+        }
+      }
+    }
+
+    return true;
+  }
+
+  // The job blends the rest pose to the output when the accumulated weight of
+  // all layers is less than this threshold value. Must be greater than 0.f.
+  float threshold;
+
+  // Job input layers, can be empty.
+  span<const Layer> layers;
+
+  // Job input additive layers, can be empty.
+  span<const Layer> additive_layers;
+
+  // The skeleton rest pose, at least _NumSoaJoints SoA transforms.
+  span<const math::SoaTransform> rest_pose;
+
+  // Job output, at least _NumSoaJoints SoA transforms.
+  span<math::SoaTransform> output;
+};
+
+// Computes model-space matrices of a skeleton with _NumSoaJoints SoA joints,
+// see LocalToModelJob. The whole hierarchy is always updated: root matrix is
+// supported, but from/to ranges, dirty and mask aren't.
+template <int _NumSoaJoints>
+struct FixedLocalToModelJob {
+  static const int kNumSoaJoints = _NumSoaJoints;
+
+  FixedLocalToModelJob() : skeleton(nullptr), root(nullptr) {}
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if skeleton pointer is nullptr, or if skeleton hasn't exactly
+  // _NumSoaJoints SoA joints.
+  // -if input range is smaller than _NumSoaJoints.
+  // -if output range is smaller than the skeleton's number of joints.
+  bool Validate() const {
+    return skeleton && skeleton->num_soa_joints() == _NumSoaJoints &&
+           input.size() >= _NumSoaJoints &&
+           output.size() >= static_cast<size_t>(skeleton->num_joints());
+  }
+
+  // Runs job's local-to-model task.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const {
+    OZZ_PROFILE_ZONE("FixedLocalToModelJob::Run");
+
+    if (!Validate()) {
+      return false;
+    }
+
+    const math::Float4x4 root_matrix =
+        root ? *root : math::Float4x4::identity();
+    const int16_t* parents = skeleton->joint_parents().data();
+    const int num_joints = skeleton->num_joints();
+    math::Float4x4* out = output.data();
+
+    for (int i = 0; i < _NumSoaJoints; ++i) {
+      // Converts SoA local transforms to 4 aos local matrices.
+      const math::SoaTransform& transform = input[i];
+      const math::SoaFloat4x4 local_soa_matrices =
+          math::SoaFloat4x4::FromAffine(transform.translation,
+                                        transform.rotation, transform.scale);
+      math::Float4x4 local_aos_matrices[4];
+      math::Transpose16x16(&local_soa_matrices.cols[0].x,
+                           local_aos_matrices->cols);
+
+      // Only the last SoA joint can have less than 4 joints.
+      const int soa_count = i < _NumSoaJoints - 1 ? 4 : num_joints - i * 4;
+      for (int j = 0; j < soa_count; ++j) {
+        const int joint = i * 4 + j;
+        const int parent = parents[joint];
+        const math::Float4x4& parent_matrix =
+            parent == Skeleton::kNoParent ? root_matrix : out[parent];
+        out[joint] = parent_matrix * local_aos_matrices[j];
+      }
+    }
+
+    return true;
+  }
+
+  // The Skeleton object describing the joint hierarchy.
+  const Skeleton* skeleton;
+
+  // The root matrix will multiply to every model space matrices, default
+  // nullptr means an identity matrix.
+  const math::Float4x4* root;
+
+  // Local space transforms, at least _NumSoaJoints SoA transforms.
+  span<const math::SoaTransform> input;
+
+  // Job output, at least as big as the skeleton's number of joints.
+  span<math::Float4x4> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_FIXED_SIZE_JOBS_H_
@@ -0,0 +1,209 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_FRAME_BUDGET_GOVERNOR_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_FRAME_BUDGET_GOVERNOR_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/profile.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace animation {
+
+// Keeps animation CPU cost within a per-frame budget whatever the number of
+// animated instances, by adapting each instance level of detail: its update
+// period (see UpdateRateScheduler), skeleton level (see SkeletonLOD) and
+// animation tier (see LODAnimation). The governor doesn't run any job, it
+// only decides levels that the application applies.
+// Levels are ordered as a ladder of steps, from full quality (step 0) to the
+// cheapest one. Each step is the move (coarser animation tier, coarser
+// skeleton level or doubled period) that saves the most, according to the
+// relative cost of each level.
+// Every frame, Update() is given the measured cost of the frame animation,
+// either measured with profiling hooks (see hooks()) or by the application.
+// The governor estimates the cost of a unit of work from it, and computes the
+// amount of work that fits the budget. It then selects the level of every
+// instance, degrading least important instances first: the least important
+// instance is stepped down to the cheapest level before the next one is
+// degraded. Levels are kept as long as the cost is in the tolerance band
+// below the budget, so that they don't oscillate from a frame to another.
+// The governor isn't thread safe, but hooks can be invoked from any thread.
+class OZZ_ANIMATION_DLL FrameBudgetGovernor {
+ public:
+  // Governor settings.
+  struct OZZ_ANIMATION_DLL Settings {
+    // Initializes default settings.
+    Settings();
+
+    // Per-frame animation budget, in seconds. Default is 2ms.
+    float budget;
+
+    // Levels aren't changed while the frame cost is in range
+    // [budget * (1 - tolerance), budget]. Default is .1.
+    float tolerance;
+
+    // Smoothing factor of the estimated cost of a unit of work, in range
+    // ]0,1]. 1 only uses the last frame measure. Default is .25.
+    float smoothing;
+
+    // Maximum update period, in frames, clamped to
+    // UpdateRateScheduler::kMaxPeriod. Default is 8.
+    int max_period;
+
+    // Relative cost of each skeleton level, level 0 (all joints) being the
+    // reference, ie: the ratio of active joints of each SkeletonLOD. Costs
+    // must be decreasing, in range ]0,1]. Default is empty, which means that
+    // there's a single skeleton level.
+    span<const float> skeleton_costs;
+
+    // Relative cost of each animation tier (see LODAnimation), in the same
+    // format as skeleton_costs. Default is empty, meaning a single tier.
+    span<const float> animation_costs;
+  };
+
+  // An instance level of detail.
+  struct Level {
+    int period;          // Update period, in frames.
+    int skeleton_level;  // Skeleton level index.
+    int animation_tier;  // Animation tier, aka LODAnimation level index.
+    float cost;          // Relative cost per frame, 1 for full quality.
+  };
+
+  // Cost of an instrumented zone over the last frame, see hooks().
+  struct Stage {
+    const char* name;  // Zone name, like "SamplingJob::Run".
+    float cost;        // Accumulated duration, in seconds.
+  };
+
+  // Maximum number of distinct stages measured by hooks.
+  enum { kMaxStages = 32 };
+
+  FrameBudgetGovernor();
+
+  // Disables copy and assignation.
+  FrameBudgetGovernor(FrameBudgetGovernor const&) = delete;
+  FrameBudgetGovernor& operator=(FrameBudgetGovernor const&) = delete;
+
+  ~FrameBudgetGovernor();
+
+  // Allocates the governor for _num_instances instances, all at full quality
+  // and with an importance of 1. Returns false if a parameter is invalid,
+  // leaving the governor empty.
+  bool Allocate(int _num_instances, const Settings& _settings);
+
+  // Releases all buffers.
+  void Deallocate();
+
+  // Sets _instance importance, ie: its screen size. Less important instances
+  // are degraded first. Instances with a null or negative importance are
+  // considered as disabled: they always get the cheapest level, and aren't
+  // accounted for. Levels are updated on next Update(). Returns false if
+  // _instance is invalid.
+  bool set_importance(int _instance, float _importance);
+
+  // Gets _instance importance, or 0 if _instance is invalid.
+  float importance(int _instance) const;
+
+  // Advances one frame, given _cost the measured cost of the frame animation,
+  // in seconds. Returns false if the governor isn't allocated or _cost is
+  // negative.
+  bool Update(float _cost);
+
+  // Advances one frame, using the cost of the zones measured by hooks() since
+  // the previous Update(). It must be called while no instrumented job is
+  // running.
+  bool Update();
+
+  // Gets _instance level, selected by the last Update(). Instances are at full
+  // quality until the first Update().
+  const Level& level(int _instance) const;
+
+  // Gets the ladder of levels, from full quality to the cheapest level.
+  span<const Level> levels() const { return make_span(ladder_); }
+
+  // Gets profiling hooks that measure the cost of outermost zones, aka jobs
+  // (see ozz/base/profile.h), to be registered with profile::SetHooks().
+  // Instrumentation must be enabled (see OZZ_BUILD_PROFILE), otherwise the
+  // application must measure frame cost itself and use Update(float).
+  profile::Hooks hooks();
+
+  // Gets the cost of every zone measured by hooks over the last Update().
+  span<const Stage> stages() const { return make_span(stages_); }
+
+  // Gets the frame cost given to the last Update(), in seconds.
+  float cost() const { return cost_; }
+
+  // Gets the estimated cost of the levels selected by the last Update(), in
+  // seconds. 0 until the first Update() with a non-null cost.
+  float estimated_cost() const { return unit_cost_ * work_; }
+
+  // Gets the number of instances.
+  int num_instances() const { return static_cast<int>(instances_.size()); }
+
+  const Settings& settings() const { return settings_; }
+
+ private:
+  // Instance state.
+  struct Instance {
+    float importance;
+    int step;  // Index in the ladder.
+  };
+
+  // Accumulated zones durations, defined in the implementation.
+  struct Timing;
+
+  // Builds the ladder of levels from settings.
+  void BuildLadder();
+
+  // Selects instances levels so that their work fits _target.
+  void Select(float _target);
+
+  Settings settings_;
+  ozz::vector<float> skeleton_costs_;
+  ozz::vector<float> animation_costs_;
+  ozz::vector<Level> ladder_;
+  ozz::vector<Instance> instances_;
+
+  // Instance indices, from least to most important.
+  ozz::vector<int> order_;
+  bool dirty_;
+
+  // Cost of the last frame, estimated cost of a unit of work and work of the
+  // selected levels.
+  float cost_;
+  float unit_cost_;
+  float work_;
+
+  Timing* timing_;
+  ozz::vector<Stage> stages_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_FRAME_BUDGET_GOVERNOR_H_
@@ -0,0 +1,157 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_GPU_CROWD_BUFFER_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_GPU_CROWD_BUFFER_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declarations.
+class Animation;
+class Skeleton;
+
+// Packs a skeleton and a set of animations to a single buffer of 32 bits
+// words, meant to be uploaded as is to a GPU storage buffer, so that crowds can
+// be sampled and converted to skinning matrices by a compute kernel (see
+// compute_shader()). Animation keys aren't decompressed: they are copied in
+// their runtime format (see animation_keyframe.h), along with animation per
+// track keys indices, which allow each track to binary search its keys
+// independently of the others.
+// Each instance samples an animation, optionally blended with a second one.
+// Evaluate() is a CPU implementation of the compute kernel, which uses the same
+// buffer and algorithm. It's a reference for validating a GPU port, and a
+// fallback when no compute device is available.
+class OZZ_ANIMATION_DLL GpuCrowdBuffer {
+ public:
+  // Buffer header words, followed by skeleton joints parents (one int32 per
+  // joint), inverse bind poses (16 floats per joint, column major), and
+  // per animation descriptors. Offsets are in words from the buffer start.
+  enum Header {
+    kHeaderNumJoints,
+    kHeaderNumAnimations,
+    kHeaderParents,           // Offset of joints parents.
+    kHeaderInverseBindPoses,  // Offset of inverse bind poses.
+    kHeaderAnimations,        // Offset of animation descriptors.
+    kHeaderSize
+  };
+
+  // Animation descriptor words. Each keys index (see
+  // Animation::translation_track_index()) is copied as is, and keys buffers
+  // are copied bytewise, starting at a word boundary.
+  enum Descriptor {
+    kDescFormats,  // Keys formats, see Format.
+    kDescTranslationIndex,
+    kDescTranslationKeys,
+    kDescRotationIndex,
+    kDescRotationKeys,
+    kDescScaleIndex,
+    kDescScaleKeys,
+    kDescSize
+  };
+
+  // Keys formats, packed in kDescFormats word: translation format in bits 0-1,
+  // rotation format in bits 2-3, scale format in bits 4-5.
+  enum Format {
+    kFloat3Key = 0,
+    kCompactFloat3Key = 1,
+    kQuaternionKey = 0,
+    kCompactQuaternionKey = 1,
+    kPackedQuaternionKey = 2,
+  };
+
+  // Defines an instance to evaluate, matching the layout of the compute kernel
+  // instances buffer (20 bytes stride).
+  // Animations are blended the same way BlendingJob blends 2 layers of
+  // weights 1 - blend_weight and blend_weight.
+  struct Instance {
+    // Index of the animation to sample, in the order given to Build().
+    uint32_t animation;
+    // Time ratio in the unit interval [0,1] used to sample animation.
+    float ratio;
+    // Index of the animation blended with animation, ignored if blend_weight
+    // is 0.
+    uint32_t blend_animation;
+    // Time ratio in the unit interval [0,1] used to sample blend_animation.
+    float blend_ratio;
+    // Weight of blend_animation, in the unit interval [0,1]. 0 (default for
+    // aggregate initialization) samples animation only.
+    float blend_weight;
+  };
+
+  GpuCrowdBuffer();
+
+  // Delete copies.
+  GpuCrowdBuffer(GpuCrowdBuffer const&) = delete;
+  GpuCrowdBuffer& operator=(GpuCrowdBuffer const&) = delete;
+
+  // Packs _skeleton and _animations. Skinning matrices are model space
+  // matrices multiplied by _inverse_bind_poses, which can be empty (model
+  // space matrices are output then) or must have a matrix per joint.
+  // Returns false, leaving the buffer empty, if an animation is nullptr,
+  // doesn't animate every skeleton joint, wasn't built with
+  // AnimationBuilder::random_access option or uses cubic interpolation.
+  bool Build(const Skeleton& _skeleton,
+             span<const Animation* const> _animations,
+             span<const math::Float4x4> _inverse_bind_poses);
+
+  // Gets the buffer to upload, empty if not built.
+  span<const uint32_t> buffer() const { return make_span(buffer_); }
+
+  // Gets the number of skeleton joints, 0 if not built.
+  int num_joints() const;
+
+  // Gets the number of animations, 0 if not built.
+  int num_animations() const;
+
+  // Evaluates the skinning matrices of _instances to _palettes, whose size
+  // must be at least _instances.size() * num_joints(). Instance i matrices are
+  // output from _palettes[i * num_joints()].
+  // Returns false if the buffer isn't built, if _palettes is too small or if
+  // an instance animation index (or blend animation index, when it's blended)
+  // is out of range.
+  bool Evaluate(span<const Instance> _instances,
+                span<math::Float4x4> _palettes) const;
+
+  // Gets the GLSL (4.30) source of the compute kernel, which evaluates an
+  // instance per invocation exactly as Evaluate() does, blending included. It
+  // expects the buffer bound to storage binding 0, instances to binding 1 and
+  // palettes to binding 2, with the number of instances set to uniform
+  // "num_instances".
+  static const char* compute_shader();
+
+ private:
+  ozz::vector<uint32_t> buffer_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_GPU_CROWD_BUFFER_H_
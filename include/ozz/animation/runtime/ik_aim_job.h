@@ -30,6 +30,7 @@
 
 #include "ozz/animation/runtime/export.h"
 #include "ozz/base/platform.h"
+#include "ozz/base/span.h"
 
 #include "ozz/base/maths/simd_math.h"
 
@@ -110,6 +111,85 @@ struct OZZ_ANIMATION_DLL IKAimJob {
   // joint and offset position.
   bool* reached;
 };
+
+// ozz::animation::BatchIKAimJob performs the same aim IK as IKAimJob, for many
+// instances (aka characters) at once. Instances are solved by groups of 4,
+// each SIMD lane solving one instance (SoA).
+// Each instance can solve a whole chain of joints (ie: head, neck, spine...)
+// in a single call, ordered from child to parent. The first joint of the chain
+// aims with the job forward and offset vectors, then every next joint aims
+// with the previous joint forward and offset, corrected and brought to its
+// local-space. This is the algorithm used by the look at sample. As joints are
+// ordered from child to parent, model-space matrices don't need to be updated
+// between joints. Corrections must finally be applied to the local-space
+// transforms of each joint, and model-space matrices updated.
+// Results are the same as running IKAimJob per joint, within floating point
+// precision.
+struct OZZ_ANIMATION_DLL BatchIKAimJob {
+  // Default constructor, initializes default values.
+  BatchIKAimJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if chain_length is less than 1, or if ups or weights are smaller than
+  // chain_length.
+  // -if any of pole_vectors is smaller than targets, which defines the number
+  // of instances.
+  // -if joints or joint_corrections are smaller than the number of instances
+  // times chain_length.
+  // -if reached isn't empty and smaller than the number of instances times
+  // chain_length.
+  // -if any joint pointer is nullptr.
+  // -if forward isn't normalized.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // Per instance target position to aim at, in model-space. The number of
+  // targets defines the number of instances.
+  span<const math::SimdFloat4> targets;
+
+  // Per instance pole vectors, in model-space. See IKAimJob::pole_vector.
+  span<const math::SimdFloat4> pole_vectors;
+
+  // Forward axis and offset of the first joint of the chain, in its
+  // local-space, shared by all instances. See IKAimJob::forward and offset.
+  math::SimdFloat4 forward;
+  math::SimdFloat4 offset;
+
+  // Number of joints of each chain. Default is 1.
+  int chain_length;
+
+  // Up axis of each joint of the chain, in joint local-space, shared by all
+  // instances. See IKAimJob::up.
+  span<const math::SimdFloat4> ups;
+
+  // Weight of each joint of the chain, shared by all instances. See
+  // IKAimJob::weight. The last joint usually needs a weight of 1 to ensure
+  // target is reached.
+  span<const float> weights;
+
+  // See IKAimJob::twist_angle. Default is 0.
+  float twist_angle;
+
+  // Model-space matrices of the joints of each chain, ordered from child to
+  // parent. Joint i of instance n is joints[n * chain_length + i].
+  span<const math::Float4x4* const> joints;
+
+  // Job output.
+
+  // Local-space correction of each joint, ordered like joints.
+  span<math::SimdQuaternion> joint_corrections;
+
+  // Optional reached flag of each joint, ordered like joints. See
+  // IKAimJob::reached.
+  span<bool> reached;
+};
 }  // namespace animation
 }  // namespace ozz
 #endif  // OZZ_OZZ_ANIMATION_RUNTIME_IK_AIM_JOB_H_
@@ -0,0 +1,124 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_IK_CHAIN_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_IK_CHAIN_JOB_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+// Forward declaration of math structures.
+namespace math {
+struct Float4x4;
+struct SoaTransform;
+}  // namespace math
+
+namespace animation {
+
+// Forward declares the Skeleton object used to describe joint hierarchy.
+class Skeleton;
+
+// ozz::animation::IKChainJob performs inverse kinematic on a chain of any
+// number of joints (tails, tentacles, spines...), using Cyclic Coordinate
+// Descent (CCD) algorithm.
+// Each iteration goes through the chain from the joint before the end down to
+// the start, and rotates every joint such that the end joint gets closer to the
+// target. Unlike IKTwoBoneJob and IKAimJob, this job doesn't output
+// corrections, as every rotation depends on the previous ones. Corrections are
+// instead applied directly to local-space transforms, and model-space matrices
+// are updated with LocalToModelJob "from" / "to" mechanism, limiting update
+// to the part of the hierarchy between the rotated joint and the end of the
+// chain.
+// Chain joints must be ancestors of each other, but don't need to be direct
+// ancestors (joints in-between will simply remain fixed).
+struct OZZ_ANIMATION_DLL IKChainJob {
+  // Default constructor, initializes default values.
+  IKChainJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if skeleton is nullptr.
+  // -if joints has less than 2 elements, or if a joint index is out of range,
+  // or isn't a descendant of the previous one.
+  // -if locals or models are too small for the skeleton.
+  // -if iterations is less than 1.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // The Skeleton object describing the joint hierarchy.
+  const Skeleton* skeleton;
+
+  // Indices of the chain joints, ordered from the start (parent) to the end of
+  // the chain. The end joint is the one that tries to reach the target.
+  span<const int> joints;
+
+  // Target IK position, in model-space.
+  math::SimdFloat4 target;
+
+  // Maximum number of iterations through the chain. Default is 8.
+  int iterations;
+
+  // Distance from end joint to target below which target is considered
+  // reached, stopping iterations. Default is 1e-3.
+  float tolerance;
+
+  // Weight given to each joint correction, clamped in range [0,1]. A weight
+  // lower than 1 damps each iteration, which distributes rotations more evenly
+  // along the chain, at the cost of more iterations. Default is 1.
+  float weight;
+
+  // Job input and output.
+
+  // Local-space transforms of the skeleton, chain joints rotations are
+  // corrected in place.
+  span<math::SoaTransform> locals;
+
+  // Model-space matrices of the skeleton, which must be up to date with locals
+  // when the job starts. Matrices of the chain joints and their descendants
+  // are updated by the job, so they're still up to date with locals when the
+  // job ends.
+  span<math::Float4x4> models;
+
+  // Job output.
+
+  // Optional boolean output value, set to true if target was reached within
+  // tolerance.
+  bool* reached;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_IK_CHAIN_JOB_H_
@@ -30,6 +30,7 @@
 
 #include "ozz/animation/runtime/export.h"
 #include "ozz/base/platform.h"
+#include "ozz/base/span.h"
 
 #include "ozz/base/maths/simd_math.h"
 
@@ -124,6 +125,70 @@ struct OZZ_ANIMATION_DLL IKTwoBoneJob {
   // target distance. Target is considered unreached if weight is less than 1.
   bool* reached;
 };
+
+// ozz::animation::BatchIKTwoBoneJob performs the same inverse kinematic as
+// IKTwoBoneJob, but for many three joints chains at once. Chains are solved by
+// groups of 4, each SIMD lane solving one chain (SoA), which amortizes the
+// per chain setup cost (matrices inversions, space changes...) when many
+// characters run IK (ie: two foot IK chains per character).
+// mid_axis, twist_angle, soften and weight are shared by all chains.
+// Results are the same as IKTwoBoneJob's, within floating point precision.
+struct OZZ_ANIMATION_DLL BatchIKTwoBoneJob {
+  // Constructor, initializes default values.
+  BatchIKTwoBoneJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any of mid_joints, end_joints, targets, pole_vectors,
+  // start_joint_corrections or mid_joint_corrections is smaller than
+  // start_joints, which defines the number of chains.
+  // -if reached isn't empty and smaller than start_joints.
+  // -if any joint pointer is nullptr.
+  // -if mid_axis isn't normalized.
+  bool Validate() const;
+
+  // Runs job's execution task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Job input.
+
+  // Per chain target IK positions, in model-space. See IKTwoBoneJob::target.
+  span<const math::SimdFloat4> targets;
+
+  // Per chain pole vectors, in model-space. See IKTwoBoneJob::pole_vector.
+  span<const math::SimdFloat4> pole_vectors;
+
+  // Normalized middle joint rotation axis, in middle joint local-space, shared
+  // by all chains. See IKTwoBoneJob::mid_axis.
+  math::SimdFloat4 mid_axis;
+
+  // See IKTwoBoneJob::twist_angle. Default is 0.
+  float twist_angle;
+
+  // See IKTwoBoneJob::soften. Default is 1.
+  float soften;
+
+  // See IKTwoBoneJob::weight. Default is 1.
+  float weight;
+
+  // Per chain model-space matrices of the start, middle and end joints. The
+  // number of chains is the size of start_joints.
+  span<const math::Float4x4* const> start_joints;
+  span<const math::Float4x4* const> mid_joints;
+  span<const math::Float4x4* const> end_joints;
+
+  // Job output.
+
+  // Per chain local-space corrections to apply to start and middle joints. See
+  // IKTwoBoneJob::start_joint_correction and mid_joint_correction.
+  span<math::SimdQuaternion> start_joint_corrections;
+  span<math::SimdQuaternion> mid_joint_corrections;
+
+  // Optional per chain reached flags. See IKTwoBoneJob::reached.
+  span<bool> reached;
+};
 }  // namespace animation
 }  // namespace ozz
 #endif  // OZZ_OZZ_ANIMATION_RUNTIME_IK_TWO_BONE_JOB_H_
@@ -0,0 +1,111 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_LAZY_MODEL_POSE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_LAZY_MODEL_POSE_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace math {
+struct Float4x4;
+struct SoaTransform;
+}  // namespace math
+namespace animation {
+
+// Forward declares the runtime skeleton.
+class Skeleton;
+
+// Computes model-space matrices on demand, for the joints that are actually
+// queried. Gameplay often needs a few model-space transforms only (hand for an
+// attachment, head for aiming...), where LocalToModelJob converts the whole
+// hierarchy (or a subtree). Evaluating a joint walks its ancestor chain up to
+// the first joint already evaluated, so a query costs O(depth) at most, and
+// intermediate matrices are memoized for later queries of the same frame.
+// Typical usage is, every frame:
+// - Bind() local-space transforms, which invalidates all joints.
+// - Evaluate() any number of joints.
+// Bound local-space transforms are referenced, not copied. Invalidate() must be
+// called if they are modified after the bind (by IK for example).
+// The object owns its buffers, allocated once by Allocate(), so that no
+// allocation happens during a frame. It isn't thread safe.
+class OZZ_ANIMATION_DLL LazyModelPose {
+ public:
+  LazyModelPose();
+
+  // Disables copy and assignation.
+  LazyModelPose(LazyModelPose const&) = delete;
+  LazyModelPose& operator=(LazyModelPose const&) = delete;
+
+  ~LazyModelPose();
+
+  // Allocates buffers for _skeleton, which must outlive this object. Returns
+  // false if _skeleton is empty, leaving the object unallocated.
+  bool Allocate(const Skeleton& _skeleton);
+
+  // Releases all buffers.
+  void Deallocate();
+
+  // Binds local-space transforms of the new frame, and invalidates all joints.
+  // _root matrix multiplies every model-space matrix, nullptr meaning
+  // identity, see LocalToModelJob::root. It's copied. Returns false if the
+  // object isn't allocated or if _locals is too small for the skeleton.
+  bool Bind(span<const math::SoaTransform> _locals,
+            const math::Float4x4* _root = nullptr);
+
+  // Marks all joints as not evaluated, keeping bound transforms.
+  void Invalidate();
+
+  // Gets model-space matrix of joint _joint, evaluating it and its ancestors if
+  // needed. The returned matrix remains valid until next Bind(), Invalidate()
+  // or Deallocate() call. Returns nullptr if no transform is bound or if
+  // _joint is out of range.
+  const math::Float4x4* Evaluate(int _joint);
+
+  // Tells if _joint model-space matrix is already evaluated.
+  bool evaluated(int _joint) const;
+
+  // Gets the number of joints evaluated since last invalidation.
+  int num_evaluated() const { return num_evaluated_; }
+
+ private:
+  const Skeleton* skeleton_;
+  span<const math::SoaTransform> locals_;
+  int num_evaluated_;
+
+  // Single allocation, that all buffers below point to.
+  void* buffer_;
+  math::Float4x4* root_;
+  math::Float4x4* models_;  // num_joints matrices.
+  int16_t* chain_;          // Joints pending evaluation, num_joints at most.
+  uint32_t* dirty_;         // One bit per joint, set if not evaluated.
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_LAZY_MODEL_POSE_H_
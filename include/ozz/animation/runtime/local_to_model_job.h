@@ -29,6 +29,8 @@
 #define OZZ_OZZ_ANIMATION_RUNTIME_LOCAL_TO_MODEL_JOB_H_
 
 #include "ozz/animation/runtime/export.h"
+#include "ozz/base/job_plan.h"
+#include "ozz/base/parallel_for.h"
 #include "ozz/base/platform.h"
 #include "ozz/base/span.h"
 
@@ -39,7 +41,9 @@ namespace math {
 struct SoaTransform;
 }
 namespace math {
+struct Float3x4;
 struct Float4x4;
+struct SoaFloat4x4;
 }
 
 namespace animation {
@@ -66,6 +70,12 @@ struct OZZ_ANIMATION_DLL LocalToModelJob {
   // Note that this input has a SoA format.
   // -if the size of of the output is smaller than the skeleton's number of
   // joints.
+  // -if both output and affine_output are set.
+  // -if dirty mask isn't empty, and too small for the skeleton's number of
+  // joints.
+  // -if joints mask isn't empty, and too small for the skeleton's number of
+  // joints.
+  // -if parallel_for is set and parallel_grain isn't greater than 0.
   bool Validate() const;
 
   // Runs job's local-to-model task.
@@ -90,7 +100,8 @@ struct OZZ_ANIMATION_DLL LocalToModelJob {
   // updated. This parameter can be used to optimize update by limiting
   // conversion to part of the joint hierarchy. Note that "from" parent should
   // be a valid matrix, as it is going to be used as part of "from" joint
-  // hierarchy update.
+  // hierarchy update. The skeleton must be ordered depth-first (see
+  // SkeletonBuilder::ordering) to use another value than kNoParent.
   int from;
 
   // Defines "to" which joint the local-to-model conversion should go, "to"
@@ -108,6 +119,29 @@ struct OZZ_ANIMATION_DLL LocalToModelJob {
   // Default value is false.
   bool from_excluded;
 
+  // Optional dirty joints mask. Bit i%8 of byte i/8 flags joint i as dirty
+  // (note that this is a per joint mask, not a SoA one). If not empty, only
+  // dirty joints and their descendants are updated, in a single pass over the
+  // hierarchy, which allows to update many disjoint chains at once (ie: after
+  // IK or procedural edits on feet, hands and head). Other joints output
+  // matrices are left unchanged, so they must be valid, as they can be used as
+  // parents. "from", "to" and "from_excluded" are ignored in this case.
+  // If not empty, mask must contain at least (num_joints + 7) / 8 bytes.
+  // Default is empty, which uses "from" and "to" range.
+  span<const uint8_t> dirty;
+
+  // Optional joints mask, restricting the update to a subset of the skeleton
+  // joints (ie: SkeletonLOD::joints_mask()). It uses the same per joint format
+  // as dirty. Disabled joints aren't updated, their output matrices are left
+  // unchanged, and SoA joints without any enabled joint are skipped. Enabled
+  // joints ancestors should be enabled too, as they're used as parents. If
+  // dirty is empty, all enabled joints are updated, "from", "to" and
+  // "from_excluded" being ignored. Otherwise, only enabled joints that are
+  // dirty or descendants of a dirty joint are updated.
+  // If not empty, mask must contain at least (num_joints + 7) / 8 bytes.
+  // Default is empty, which enables all joints.
+  span<const uint8_t> mask;
+
   // The input range that store local transforms.
   span<const ozz::math::SoaTransform> input;
 
@@ -115,6 +149,182 @@ struct OZZ_ANIMATION_DLL LocalToModelJob {
 
   // The output range to be filled with model-space matrices.
   span<ozz::math::Float4x4> output;
+
+  // Alternative output range, to be filled with affine 3x4 model-space
+  // matrices, which saves the always (0, 0, 0, 1) last row of Float4x4. These
+  // can be uploaded as is to a GPU, or used directly as SkinningJob palette.
+  // output and affine_output can't be both set. Root matrix must be affine
+  // when using this output.
+  span<ozz::math::Float3x4> affine_output;
+
+  // Parallel execution.
+
+  // Task function and task scheduler hook, see ozz/base/parallel_for.h.
+  typedef ozz::ParallelForTask ParallelForTask;
+  typedef ozz::ParallelForHook ParallelFor;
+
+  // Optional task scheduler hook, which lowers the latency of very large
+  // skeletons. Joints whose sub-hierarchy is bigger than parallel_grain are
+  // converted first by the calling thread. The remaining sub-hierarchies,
+  // which are independent, are then grouped into tasks of about
+  // parallel_grain joints, each task running a "from"/"to" update per
+  // sub-hierarchy. It's only used to update the whole hierarchy of a skeleton
+  // ordered depth-first (see IsDepthFirst()), bigger than parallel_grain, and
+  // without dirty nor joints mask. Otherwise, or if nullptr (default), joints
+  // are converted serially by the calling thread.
+  ParallelFor parallel_for;
+
+  // User data provided to parallel_for.
+  void* parallel_for_user_data;
+
+  // Approximate number of joints per task when converting with parallel_for.
+  // Tasks should be big enough to amortize task scheduling. Default is 256.
+  int parallel_grain;
+
+ private:
+  friend class ozz::JobPlan<LocalToModelJob>;
+
+  // Runs the valid job, without validating it. See JobPlan.
+  void RunUnchecked() const;
+};
+
+// Computes model-space joint matrices for a batch of instances (aka
+// characters) sharing the same skeleton. The result is the same as running a
+// LocalToModelJob (on the whole hierarchy) per instance, but instances are
+// processed by groups of 4, each SIMD lane computing one instance: local
+// transforms of the same joint are transposed across the 4 instances, so that
+// matrix building and parent multiplications are vectorized across instances
+// rather than performed one matrix at a time. Model-space matrices are kept in
+// SoA format (in scratch buffer) while the hierarchy is traversed, and only
+// converted once to AoS for the output.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL BatchLocalToModelJob {
+  // Default constructor, initializes default values.
+  BatchLocalToModelJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if skeleton pointer is nullptr.
+  // -if scratch buffer is smaller than the skeleton's number of joints.
+  // -if any instance input is smaller than the skeleton's number of SoA joints.
+  // -if any instance output is smaller than the skeleton's number of joints.
+  bool Validate() const;
+
+  // Runs job's local-to-model task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // The Skeleton object describing the joint hierarchy, shared by all
+  // instances.
+  const Skeleton* skeleton;
+
+  // Defines per instance local-to-model data.
+  struct Instance {
+    // The root matrix of this instance, see LocalToModelJob::root. nullptr
+    // means an identity matrix.
+    const ozz::math::Float4x4* root;
+
+    // The input range that store local transforms.
+    span<const ozz::math::SoaTransform> input;
+
+    // The output range to be filled with model-space matrices.
+    span<ozz::math::Float4x4> output;
+  };
+
+  // The range of instances to process, can be empty.
+  span<const Instance> instances;
+
+  // Scratch buffer used to store model-space matrices of a group of 4
+  // instances in SoA format. It must be at least as big as the skeleton's
+  // number of joints. Its content is undefined after job execution.
+  span<ozz::math::SoaFloat4x4> scratch;
+};
+
+// Computes skinning matrices from local-space SoaTransform, fusing
+// local-to-model conversion with the inverse bind pose multiplication. Output
+// matrix i is the model-space matrix of joint joint_remaps[i], multiplied by
+// inverse_bind_poses[i], which is the palette expected by SkinningJob.
+// Only joints used by joint_remaps, and their ancestors, are converted to
+// model-space. Model-space matrices aren't output, but kept in a stack along
+// the current depth-first path of the hierarchy, so no skeleton sized buffer
+// is required.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL LocalToSkinningJob {
+  // Default constructor, initializes default values.
+  LocalToSkinningJob();
+
+  // Maximum depth of the skeleton hierarchy supported by the job, which is the
+  // capacity of the model-space matrices stack.
+  static const int kMaxDepth = 64;
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if skeleton pointer is nullptr.
+  // -if the size of the input is smaller than the skeleton's number of SoA
+  // joints.
+  // -if inverse_bind_poses or output are smaller than joint_remaps.
+  // -if inverse_transpose_output isn't empty and is smaller than joint_remaps.
+  // -if any joint_remaps index is out of the skeleton's range of joints.
+  // -if the skeleton hierarchy is deeper than kMaxDepth.
+  // -if the skeleton isn't ordered depth-first, see IsDepthFirst().
+  bool Validate() const;
+
+  // Runs job's local-to-skinning task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // Job input.
+
+  // The Skeleton object describing the joint hierarchy.
+  const Skeleton* skeleton;
+
+  // The root matrix will multiply to every model space matrices, default nullptr
+  // means an identity matrix.
+  const ozz::math::Float4x4* root;
+
+  // The input range that store local transforms.
+  span<const ozz::math::SoaTransform> input;
+
+  // Skeleton joint index of each output matrix, aka mesh joint remapping
+  // table.
+  span<const uint16_t> joint_remaps;
+
+  // Inverse bind pose matrix of each output matrix, ordered like
+  // joint_remaps.
+  span<const ozz::math::Float4x4> inverse_bind_poses;
+
+  // Writes output and inverse_transpose_output with non-temporal (streaming)
+  // stores, which bypass the caches. This suits buffers that are written once
+  // and never read back by the cpu, like mapped gpu-visible (write-combined)
+  // memory. Output matrices are naturally 16 bytes aligned, as required. The
+  // job ends with a store fence, so output is complete before any store that
+  // follows the job, like signaling the gpu. Defaults to false, as cached
+  // stores are faster when output is read back soon after.
+  bool streaming_output;
+
+  // Job output.
+
+  // The output range to be filled with skinning matrices, ordered like
+  // joint_remaps.
+  span<ozz::math::Float4x4> output;
+
+  // Optional output range to be filled with skinning matrices inverse
+  // transpose, ordered like joint_remaps, as expected by SkinningJob
+  // joint_inverse_transpose_matrices. Uniformly scaled matrices (orthogonal
+  // axes of the same length) aren't inverted, as their inverse transpose is
+  // the matrix divided by its squared scale. Only the 3x3 part of these
+  // matrices is meaningful, which is all normals and tangents require.
+  span<ozz::math::Float4x4> inverse_transpose_output;
+
+  // Optional output flag, set to true if all output matrices are uniformly
+  // scaled. SkinningJob can then transform normals with joint_matrices,
+  // without inverse transpose matrices, as they only differ by a scale factor
+  // (normals aren't renormalized).
+  bool* uniform_scale;
 };
 }  // namespace animation
 }  // namespace ozz
@@ -0,0 +1,102 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_LOCAL_TO_MODEL_REGISTRY_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_LOCAL_TO_MODEL_REGISTRY_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the Skeleton object.
+class Skeleton;
+
+// Local-to-model function specialized for a skeleton hierarchy, as generated
+// by the offline LocalToModelCodegen (ozz2cpp tool). It computes model-space
+// matrices of all skeleton joints, like LocalToModelJob without from/to
+// range, dirty or mask. _input must be at least the skeleton's number of SoA
+// joints, and _output the skeleton's number of joints.
+typedef void (*LocalToModelFn)(span<const math::SoaTransform> _input,
+                               const math::Float4x4& _root,
+                               span<math::Float4x4> _output);
+
+// Computes a hash of _skeleton hierarchy, 32 bits FNV-1a of its number of
+// joints and parent indices. It only depends on the hierarchy, so skeletons
+// with different names or rest poses share the same specialized function.
+OZZ_ANIMATION_DLL uint32_t HashSkeletonHierarchy(const Skeleton& _skeleton);
+
+// Finds the specialized local-to-model function registered for _skeleton
+// hierarchy. Lookup computes the hierarchy hash, so it's meant to be done
+// once, when the skeleton is loaded.
+// Returns nullptr if no function is registered for this hierarchy, in which
+// case LocalToModelJob must be used.
+OZZ_ANIMATION_DLL LocalToModelFn FindLocalToModel(const Skeleton& _skeleton);
+
+// Registers a specialized local-to-model function for the skeletons whose
+// hierarchy hash and number of joints are _hash and _num_joints. Generated
+// sources define a static registrar, so their function is registered during
+// static initialization of the program they are compiled into. Registrars
+// are chained in an intrusive list, so registration doesn't allocate.
+// Registration isn't thread safe, and must not happen while FindLocalToModel
+// is used.
+class OZZ_ANIMATION_DLL LocalToModelRegistrar {
+ public:
+  LocalToModelRegistrar(uint32_t _hash, int _num_joints, LocalToModelFn _fn);
+
+  // Unregisters the function.
+  ~LocalToModelRegistrar();
+
+  // Disables copy and assignation.
+  LocalToModelRegistrar(const LocalToModelRegistrar&) = delete;
+  LocalToModelRegistrar& operator=(const LocalToModelRegistrar&) = delete;
+
+ private:
+  friend LocalToModelFn FindLocalToModel(const Skeleton& _skeleton);
+
+  uint32_t hash_;
+  int num_joints_;
+  LocalToModelFn fn_;
+  LocalToModelRegistrar* next_;
+};
+
+// Converts the 4 local transforms of a SoA joint to matrices. This is the
+// conversion LocalToModelJob applies, used by generated functions.
+OZZ_INLINE void SoaTransformToMatrices(const math::SoaTransform& _input,
+                                       math::Float4x4 _output[4]) {
+  const math::SoaFloat4x4 soa_matrices = math::SoaFloat4x4::FromAffine(
+      _input.translation, _input.rotation, _input.scale);
+  math::Transpose16x16(&soa_matrices.cols[0].x, _output->cols);
+}
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_LOCAL_TO_MODEL_REGISTRY_H_
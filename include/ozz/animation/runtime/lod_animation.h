@@ -0,0 +1,115 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_LOD_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_LOD_ANIMATION_H_
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace io {
+class IArchive;
+class OArchive;
+}  // namespace io
+namespace animation {
+
+// Forward declares the LODAnimationBuilder, used to instantiate a
+// LODAnimation.
+namespace offline {
+class LODAnimationBuilder;
+}
+
+// Defines a runtime animation clip optimized for many levels of detail. Each
+// level is an independent Animation, optimized with a different tolerance
+// from the same source, so runtime can switch level per character (ie:
+// according to its screen size). Levels are ordered from the most precise
+// (level 0) to the coarsest one.
+// All levels have the same duration and number of tracks. Switching from a
+// level to another resets the sampling context, as for any animation change.
+class OZZ_ANIMATION_DLL LODAnimation {
+ public:
+  // Builds a default LOD animation, without any level.
+  LODAnimation();
+
+  // Allow moves.
+  LODAnimation(LODAnimation&&);
+  LODAnimation& operator=(LODAnimation&&);
+
+  // Delete copies.
+  LODAnimation(LODAnimation const&) = delete;
+  LODAnimation& operator=(LODAnimation const&) = delete;
+
+  // Declares the public non-virtual destructor.
+  ~LODAnimation();
+
+  // Gets the number of levels.
+  int num_levels() const { return static_cast<int>(levels_.size()); }
+
+  // Gets level _index animation.
+  const Animation& level(int _index) const;
+
+  // Gets the optimization tolerance of every level, aka the maximum error
+  // (in model-space units) it was built with. Tolerances are increasing.
+  span<const float> tolerances() const { return make_span(tolerances_); }
+
+  // Selects the coarsest level whose tolerance doesn't exceed _max_error.
+  // _max_error is the error that can't be noticed for a character, ie: the
+  // size of a pixel at character's distance. Returns 0 if no level matches,
+  // or -1 if animation has no level.
+  int SelectLevel(float _max_error) const;
+
+  // Get the estimated animation's size in bytes.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // LODAnimationBuilder class is allowed to instantiate a LODAnimation.
+  friend class offline::LODAnimationBuilder;
+
+  // Levels tolerances, see tolerances().
+  ozz::vector<float> tolerances_;
+
+  // Levels animations.
+  ozz::vector<Animation> levels_;
+};
+}  // namespace animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::LODAnimation)
+OZZ_IO_TYPE_TAG("ozz-lod_animation", animation::LODAnimation)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_LOD_ANIMATION_H_
@@ -0,0 +1,89 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MIRROR_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MIRROR_JOB_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+
+// Forward declaration math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Forward declares the MirrorMap used to pair joints.
+class MirrorMap;
+
+// Mirrors a local-space pose according to a MirrorMap: paired joints swap
+// their transforms, and every transform is reflected through the mirror
+// plane. With plane YZ (MirrorMap::kX), translation x is negated, as well as
+// rotation y and z components (rotation axis is reflected, and rotation angle
+// reversed). Scale is unchanged.
+// This assumes that the skeleton rest pose is itself symmetric through this
+// plane, aka paired joints local frames are each other's reflection, and
+// unpaired joints lie on the plane.
+// SoA joints paired with a whole SoA joint are swapped at once, others are
+// gathered lane by lane. Reflection is then applied to 4 joints at a time.
+// The job does not own the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL MirrorJob {
+  // Default constructor, initializes default values.
+  MirrorJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if map pointer is nullptr.
+  // -if input or output is smaller than the skeleton's number of SoA joints.
+  bool Validate() const;
+
+  // Runs job's mirroring task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // Job input.
+
+  // The map that defines joints pairs and mirror plane.
+  const MirrorMap* map;
+
+  // Local-space pose to mirror, ie: SamplingJob or BlendingJob output.
+  span<const ozz::math::SoaTransform> input;
+
+  // Job output.
+
+  // Mirrored local-space pose. It mustn't overlap input.
+  span<ozz::math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MIRROR_JOB_H_
@@ -0,0 +1,123 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MIRROR_MAP_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MIRROR_MAP_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace io {
+class IArchive;
+class OArchive;
+}  // namespace io
+namespace animation {
+
+// Forward declares the MirrorMapBuilder, used to instantiate a MirrorMap.
+namespace offline {
+class MirrorMapBuilder;
+}
+
+// Defines how a skeleton is mirrored (see MirrorJob): the plane poses are
+// reflected through, and the joint pairs (ie: left and right arms) that swap
+// their transforms. Joints that aren't paired (ie: spine) are mirrored onto
+// themselves. This allows to play an animation mirrored, rather than
+// authoring both left and right handed versions.
+// Mirroring is precomputed per SoA joint too, so that SoA joints whose 4
+// joints are paired with a whole SoA joint (in the same order) are swapped at
+// once.
+class OZZ_ANIMATION_DLL MirrorMap {
+ public:
+  // Defines the axis normal to the mirror plane.
+  enum Axis {
+    kX,  // Mirrors through plane YZ.
+    kY,  // Mirrors through plane XZ.
+    kZ,  // Mirrors through plane XY.
+  };
+
+  // Builds a default map, for empty skeletons.
+  MirrorMap();
+
+  // Allow moves.
+  MirrorMap(MirrorMap&&);
+  MirrorMap& operator=(MirrorMap&&);
+
+  // Delete copies.
+  MirrorMap(MirrorMap const&) = delete;
+  MirrorMap& operator=(MirrorMap const&) = delete;
+
+  // Declares the public non-virtual destructor.
+  ~MirrorMap();
+
+  // Returns the number of joints of the skeleton.
+  int num_joints() const { return static_cast<int>(joint_remaps_.size()); }
+
+  // Returns the axis normal to the mirror plane.
+  Axis axis() const { return axis_; }
+
+  // Returns, for every joint, the joint it's paired with, which is itself for
+  // joints that aren't paired.
+  span<const int16_t> joint_remaps() const { return make_span(joint_remaps_); }
+
+  // Returns, for every SoA joint, the SoA joint that can be copied as a whole,
+  // or -1 if SoA joint lanes must be gathered one by one.
+  span<const int16_t> soa_remaps() const { return make_span(soa_remaps_); }
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // MirrorMapBuilder class is allowed to instantiate a MirrorMap.
+  friend class offline::MirrorMapBuilder;
+
+  // Computes soa_remaps_ from joint_remaps_.
+  void BuildSoaRemaps();
+
+  // Axis normal to the mirror plane.
+  Axis axis_;
+
+  // Paired joint of every joint, see joint_remaps(). This is the only
+  // serialized data, with axis_. SoA remaps are derived from it.
+  ozz::vector<int16_t> joint_remaps_;
+
+  // Paired SoA joint of every SoA joint, see soa_remaps().
+  ozz::vector<int16_t> soa_remaps_;
+};
+}  // namespace animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::MirrorMap)
+OZZ_IO_TYPE_TAG("ozz-mirror_map", animation::MirrorMap)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MIRROR_MAP_H_
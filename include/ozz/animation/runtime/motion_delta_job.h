@@ -0,0 +1,101 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MOTION_DELTA_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MOTION_DELTA_JOB_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration math structures.
+namespace math {
+struct Transform;
+}
+
+namespace animation {
+
+// Forward declares motion tracks types.
+class Float3Track;
+class QuaternionTrack;
+
+// Computes root motion delta between two ratios of an animation, from its
+// motion tracks (see offline::MotionExtractor). Only motion tracks are
+// sampled, so movement can be simulated or predicted (ie: on a server)
+// without sampling the animation skeleton.
+// Motion tracks store the absolute motion frame (position and heading) of
+// the animation. The delta is the motion from "from" ratio to "to" ratio,
+// expressed in the motion frame at "from" ratio. Applying it to a character
+// transform moves the character as the animation does:
+// -position += character rotation * delta translation.
+// -rotation = character rotation * delta rotation.
+// The job does not owned the tracks and output, and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL MotionDeltaJob {
+  // Default constructor, initializes default values.
+  MotionDeltaJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if position track is nullptr.
+  // -if output is nullptr.
+  bool Validate() const;
+
+  // Runs job's motion delta computation.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // Job input.
+
+  // Ratios where the motion starts and ends, clamped in range [0,1] before job
+  // execution. "to" can be lower than "from" for backward playback.
+  float from;
+  float to;
+
+  // Number of times playback looped from the end (1) to the beginning (0) of
+  // the animation while going from "from" to "to". It's negative when
+  // playback looped backward (from 0 to 1). Each loop adds the motion of a
+  // whole animation cycle.
+  int loops;
+
+  // Motion position track, required.
+  const Float3Track* position;
+
+  // Motion rotation (heading) track, optional. Motion has no rotation if it's
+  // nullptr.
+  const QuaternionTrack* rotation;
+
+  // Job output.
+
+  // Motion delta. Scale is always one.
+  math::Transform* delta;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MOTION_DELTA_JOB_H_
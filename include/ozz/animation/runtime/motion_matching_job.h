@@ -0,0 +1,95 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MOTION_MATCHING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MOTION_MATCHING_JOB_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the features database.
+class FeatureDatabase;
+
+// Searches a FeatureDatabase for the frame whose features are the nearest to
+// a query, aka the best (clip, ratio) to continue playback from. The matching
+// cost is the squared euclidean distance between normalized features.
+// The search is brute force, but computes 4 frames costs at once with SIMD
+// instructions. When "accelerate" is set, database bounding boxes are tested
+// first, so that frames that can't improve on the best match found so far
+// are skipped. Both return the same match.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL MotionMatchingJob {
+  // Default constructor, initializes default values.
+  MotionMatchingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if database is nullptr or has no frame.
+  // -if query is smaller than database number of features.
+  // -if output is nullptr.
+  bool Validate() const;
+
+  // Runs job's search.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // Job input.
+
+  // Database to search.
+  const FeatureDatabase* database;
+
+  // Raw (not normalized) query features, laid out as database features (see
+  // offline::FeatureDatabaseBuilder). Query is normalized by the job.
+  span<const float> query;
+
+  // Skips frames using database bounding boxes. Default is true.
+  bool accelerate;
+
+  // Job output.
+
+  // Defines the best match.
+  struct Match {
+    // Frame index in the database.
+    int frame;
+    // Clip index and ratio of the frame, see FeatureDatabase::clip() and
+    // FeatureDatabase::ratio().
+    int clip;
+    float ratio;
+    // Matching cost.
+    float cost;
+  };
+  Match* output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MOTION_MATCHING_JOB_H_
@@ -0,0 +1,129 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_MULTI_FLOAT_TRACK_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_MULTI_FLOAT_TRACK_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace memory {
+class Allocator;
+}  // namespace memory
+namespace animation {
+
+// Forward declares the TrackBuilder, used to instantiate a MultiFloatTrack.
+namespace offline {
+class TrackBuilder;
+}
+
+// Runtime user-channel track of many float channels sharing the same keyframes
+// ratios, ie: facial animation blend shapes weights. Compared to a FloatTrack
+// per channel, sampling requires a single keyframes lookup, and channels are
+// interpolated 4 at a time. Channels values of a keyframe are stored
+// contiguously, padded to a multiple of 4 channels (SoA channels) and 16 bytes
+// aligned. MultiFloatTrack is built from a RawMultiFloatTrack with a
+// TrackBuilder, and sampled with a MultiFloatTrackSamplingJob.
+class OZZ_ANIMATION_DLL MultiFloatTrack {
+ public:
+  // Builds a default track. Track buffers are allocated with _allocator when
+  // the track is built or loaded, nullptr meaning the default allocator.
+  explicit MultiFloatTrack(memory::Allocator* _allocator = nullptr);
+
+  // Allow move.
+  MultiFloatTrack(MultiFloatTrack&& _other);
+  MultiFloatTrack& operator=(MultiFloatTrack&& _other);
+
+  // Disables copy and assignation.
+  MultiFloatTrack(MultiFloatTrack const&) = delete;
+  void operator=(MultiFloatTrack const&) = delete;
+
+  ~MultiFloatTrack();
+
+  // Gets the number of channels.
+  int num_channels() const { return num_channels_; }
+
+  // Gets the number of SoA channels, aka the number of 4 channels groups.
+  int num_soa_channels() const { return (num_channels_ + 3) / 4; }
+
+  // Keyframe accessors. values() stores num_soa_channels() * 4 values per
+  // keyframe.
+  span<const float> ratios() const { return ratios_; }
+  span<const float> values() const { return values_; }
+  span<const uint8_t> steps() const { return steps_; }
+
+  // Returns the allocator used for track buffers, nullptr for the default
+  // allocator.
+  memory::Allocator* allocator() const { return allocator_; }
+
+  // Get the estimated track's size in bytes.
+  size_t size() const;
+
+  // Get track name.
+  const char* name() const { return name_ ? name_ : ""; }
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // TrackBuilder class is allowed to allocate a MultiFloatTrack.
+  friend class offline::TrackBuilder;
+
+  // Internal allocation and destruction functions.
+  void Allocate(size_t _keys_count, int _num_channels, size_t _name_len);
+  void Deallocate();
+
+  // Number of channels.
+  int num_channels_;
+
+  // Keyframe values, num_soa_channels() * 4 per keyframe.
+  span<float> values_;
+
+  // Keyframe ratios (0 is the beginning of the track, 1 is the end).
+  span<float> ratios_;
+
+  // Keyframe modes (1 bit per key): 1 for step, 0 for linear.
+  span<uint8_t> steps_;
+
+  // Track name.
+  char* name_;
+
+  // Allocator used for track buffer, nullptr for the default allocator.
+  memory::Allocator* allocator_;
+};
+}  // namespace animation
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::MultiFloatTrack)
+OZZ_IO_TYPE_TAG("ozz-multi_float_track", animation::MultiFloatTrack)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_MULTI_FLOAT_TRACK_H_
@@ -0,0 +1,134 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_PARTITIONED_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_PARTITIONED_ANIMATION_H_
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+class IArchive;
+class OArchive;
+}  // namespace io
+namespace animation {
+
+// Forward declares the PartitionedAnimationBuilder, used to instantiate a
+// PartitionedAnimation.
+namespace offline {
+class PartitionedAnimationBuilder;
+}
+
+// Defines a runtime skeletal animation clip whose tracks are split into
+// partitions of consecutive tracks. Each partition is an independent
+// Animation, with its own keys stream, so it's sampled with its own
+// SamplingJob context. Partitions can thus be sampled concurrently, each one
+// to a disjoint range of the output, which lowers the latency of sampling
+// animations of very large skeletons. See PartitionedSamplingJob.
+// Partition i animates tracks [i * partition_soa_tracks() * 4,
+// (i + 1) * partition_soa_tracks() * 4[, only the last partition can be
+// smaller.
+class OZZ_ANIMATION_DLL PartitionedAnimation {
+ public:
+  // Builds a default partitioned animation, without any partition.
+  PartitionedAnimation();
+
+  // Allow moves.
+  PartitionedAnimation(PartitionedAnimation&&);
+  PartitionedAnimation& operator=(PartitionedAnimation&&);
+
+  // Delete copies.
+  PartitionedAnimation(PartitionedAnimation const&) = delete;
+  PartitionedAnimation& operator=(PartitionedAnimation const&) = delete;
+
+  // Declares the public non-virtual destructor.
+  ~PartitionedAnimation();
+
+  // Gets the animation clip duration, the same for all partitions.
+  float duration() const { return duration_; }
+
+  // Gets the number of animated tracks, of all partitions.
+  int num_tracks() const { return num_tracks_; }
+
+  // Returns the number of SoA elements matching the number of tracks of *this
+  // animation.
+  int num_soa_tracks() const { return (num_tracks_ + 3) / 4; }
+
+  // Gets animation name.
+  const char* name() const { return name_.c_str(); }
+
+  // Gets the number of SoA tracks of every partition but the last one.
+  int partition_soa_tracks() const { return partition_soa_tracks_; }
+
+  // Gets the number of partitions.
+  int num_partitions() const { return static_cast<int>(partitions_.size()); }
+
+  // Gets partition _index animation. Its track 0 is track
+  // _index * partition_soa_tracks() * 4 of the whole animation.
+  const Animation& partition(int _index) const;
+
+  // Get the estimated animation's size in bytes.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // PartitionedAnimationBuilder class is allowed to instantiate a
+  // PartitionedAnimation.
+  friend class offline::PartitionedAnimationBuilder;
+
+  // Duration of the animation clip.
+  float duration_;
+
+  // The number of joint tracks.
+  int num_tracks_;
+
+  // Number of SoA tracks per partition.
+  int partition_soa_tracks_;
+
+  // Animation name.
+  ozz::string name_;
+
+  // Partitions animations.
+  ozz::vector<Animation> partitions_;
+};
+}  // namespace animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::PartitionedAnimation)
+OZZ_IO_TYPE_TAG("ozz-partitioned_animation", animation::PartitionedAnimation)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_PARTITIONED_ANIMATION_H_
@@ -0,0 +1,109 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_PARTITIONED_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_PARTITIONED_SAMPLING_JOB_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/parallel_for.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Forward declares the partitioned animation type to sample.
+class PartitionedAnimation;
+
+// Samples a PartitionedAnimation at a given time ratio. Every partition is
+// sampled by a SamplingJob, using its own context, to its range of the output
+// buffer. As partitions share no state, they can be sampled concurrently
+// through the parallel_for hook. The result is strictly the same as sampling
+// every partition serially.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL PartitionedSamplingJob {
+  // Default constructor, initializes default values.
+  PartitionedSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if animation pointer is nullptr.
+  // -if contexts range is smaller than the number of partitions, or if any of
+  // the contexts is too small for its partition (or without tangents for a
+  // cubic partition).
+  // -if output range is smaller than the number of SoA tracks of the
+  // animation.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time ratio in the unit interval [0,1] used to sample animation (where 0 is
+  // the beginning of the animation, 1 is the end), clamped to [0,1].
+  float ratio;
+
+  // The partitioned animation to sample.
+  const PartitionedAnimation* animation;
+
+  // Sampling contexts, one per partition. Context i is used to sample
+  // partition i, so it must be able to sample partition i tracks. A
+  // SamplingJob::ContextBank provides such a range. As for SamplingJob,
+  // contexts should be kept from an update to the next one.
+  span<SamplingJob::Context> contexts;
+
+  // Job output.
+  // The output range to be filled with sampled joints during job execution.
+  span<ozz::math::SoaTransform> output;
+
+  // Parallel execution.
+
+  // Task function and task scheduler hook, see ozz/base/parallel_for.h. Each
+  // task samples a partition.
+  typedef ozz::ParallelForTask ParallelForTask;
+  typedef ozz::ParallelForHook ParallelFor;
+
+  // Optional task scheduler hook, called with a task per partition. If
+  // nullptr (default), or if the animation has a single partition, partitions
+  // are sampled serially by the calling thread.
+  ParallelFor parallel_for;
+
+  // User data provided to parallel_for.
+  void* parallel_for_user_data;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_PARTITIONED_SAMPLING_JOB_H_
@@ -0,0 +1,125 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_POSE_BUFFER_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_POSE_BUFFER_H_
+
+#include <atomic>
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace math {
+struct Float4x4;
+}  // namespace math
+namespace animation {
+
+// Forward declares runtime objects.
+class Skeleton;
+
+// Triple buffered model-space pose, exchanged without locks between a single
+// writer thread (ie: animation update) and a single reader thread (ie:
+// rendering).
+// The writer fills back() directly, typically as LocalToModelJob output, then
+// Publish()es it. The reader Acquire()s the latest published pose and reads it
+// from front(). Neither side ever blocks, waits or copies matrices: the three
+// buffers rotate between the writer (back), the reader (front) and a shared
+// slot holding the latest published pose. A published pose that's replaced
+// before being acquired is skipped, so the reader always gets the newest one.
+// Buffers are aligned to a cache line, so that both threads never share one.
+// Allocate() and Deallocate() aren't thread safe, they must be called while
+// neither the writer nor the reader uses the buffer.
+class OZZ_ANIMATION_DLL PoseBuffer {
+ public:
+  PoseBuffer();
+
+  // Disables copy and assignation.
+  PoseBuffer(PoseBuffer const&) = delete;
+  PoseBuffer& operator=(PoseBuffer const&) = delete;
+
+  ~PoseBuffer();
+
+  // Allocates buffers for _skeleton joints. Returns false if the skeleton is
+  // empty, leaving the buffer empty.
+  bool Allocate(const Skeleton& _skeleton);
+
+  // Releases all buffers.
+  void Deallocate();
+
+  // Gets the number of joints of each pose.
+  int num_joints() const { return num_joints_; }
+
+  // Writer side.
+
+  // Gets the pose being written. The buffer changes after each Publish(), so
+  // its content must be fully written again before the next Publish().
+  span<math::Float4x4> back() const;
+
+  // Publishes the back pose, which becomes the latest pose the reader can
+  // acquire, and gives the writer a new back buffer.
+  void Publish();
+
+  // Reader side.
+
+  // Acquires the latest published pose if one was published since the last
+  // acquisition. Returns true if front() changed.
+  bool Acquire();
+
+  // Gets the latest acquired pose, which stays unchanged until next
+  // Acquire(). Empty if no pose was acquired yet.
+  span<const math::Float4x4> front() const;
+
+ private:
+  // Gets buffer _index pose.
+  math::Float4x4* buffer(int _index) const;
+
+  // Shared slot bit flagging a pose published but not yet acquired. Lower
+  // bits are the buffer index.
+  enum { kFresh = 4, kIndexMask = 3 };
+
+  int num_joints_;
+
+  // Single allocation, 3 poses of num_joints_ matrices.
+  math::Float4x4* buffers_;
+
+  // Buffer index owned by the writer.
+  int back_;
+
+  // Buffer index holding the latest published pose, and kFresh flag.
+  std::atomic<int> shared_;
+
+  // Buffer index owned by the reader.
+  int front_;
+
+  // True once the reader acquired a pose.
+  bool acquired_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_POSE_BUFFER_H_
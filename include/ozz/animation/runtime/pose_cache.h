@@ -0,0 +1,159 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_POSE_CACHE_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_POSE_CACHE_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace math {
+struct Float4x4;
+struct SoaTransform;
+}  // namespace math
+namespace animation {
+
+// Forward declares runtime objects.
+class Animation;
+class Skeleton;
+
+// Caches poses evaluated during a frame, so that instances playing the same
+// animation at the same ratio share a single evaluation (sampling and
+// optionally local-to-model conversion). This suits background crowds playing
+// looping clips in lockstep or with a few phase offsets.
+// Poses are keyed by animation and quantized ratio. With a ratio step of 0
+// (default), only instances with exactly the same ratio share a pose. A
+// positive step rounds ratios to the nearest multiple of the step, and the
+// pose is sampled at this rounded ratio, so that near-identical instances
+// share one evaluation, at the cost of a time error up to half a step.
+// Typical usage is, every frame:
+// - Clear() the cache.
+// - Request() the pose of every instance, keeping the returned entry index.
+// - Evaluate() all requested poses.
+// - Read each instance pose with locals() and models().
+// The cache owns all its buffers, allocated once by Allocate(), so that no
+// allocation happens during a frame. It isn't thread safe, but read accessors
+// are once Evaluate() returned.
+class OZZ_ANIMATION_DLL PoseCache {
+ public:
+  PoseCache();
+
+  // Disables copy and assignation.
+  PoseCache(PoseCache const&) = delete;
+  PoseCache& operator=(PoseCache const&) = delete;
+
+  ~PoseCache();
+
+  // Allocates a cache of _capacity poses of _skeleton. If _model_space is
+  // true, poses model-space matrices are also computed. Cubic animations can
+  // only be evaluated if _cubic is true (see SamplingJob::Context::cubic()).
+  // Returns false if a parameter is invalid, leaving the cache empty.
+  bool Allocate(const Skeleton& _skeleton, int _capacity, bool _model_space,
+                bool _cubic = false);
+
+  // Releases all buffers.
+  void Deallocate();
+
+  // Sets ratio quantization step, in the unit interval. 0 disables
+  // quantization, negative values are considered as 0. Changing the step
+  // clears the cache.
+  void set_ratio_step(float _step);
+  float ratio_step() const { return ratio_step_; }
+
+  // Removes all cached poses. Sampling contexts are kept, so that poses
+  // requested in the same order every frame benefit from frame coherency.
+  void Clear();
+
+  // Gets the cache entry of _animation pose at _ratio, adding it to the cache
+  // if it isn't already. Added poses are evaluated by the next Evaluate() call.
+  // Returns -1 if the cache isn't allocated, is full, or if _animation tracks
+  // don't match skeleton joints. The caller is then expected to evaluate the
+  // pose on its own.
+  int Request(const Animation& _animation, float _ratio);
+
+  // Evaluates all poses requested since last evaluation. Returns false if any
+  // evaluation failed.
+  bool Evaluate();
+
+  // Gets local-space transforms of entry _entry. Empty if _entry is invalid.
+  span<const math::SoaTransform> locals(int _entry) const;
+
+  // Gets model-space matrices of entry _entry. Empty if _entry is invalid, or
+  // if cache wasn't allocated for model space.
+  span<const math::Float4x4> models(int _entry) const;
+
+  // Gets the ratio entry _entry pose was sampled at, which is quantized.
+  float ratio(int _entry) const;
+
+  // Gets the number of cached poses.
+  int num_entries() const { return num_entries_; }
+
+  // Gets cache capacity.
+  int capacity() const { return capacity_; }
+
+  // Gets the number of requests served by an already cached pose, since the
+  // last Clear().
+  int hits() const { return hits_; }
+
+ private:
+  // Cached pose description.
+  struct Entry {
+    const Animation* animation;
+    int32_t key;  // Quantized ratio, or ratio bits when not quantized.
+    float ratio;
+  };
+
+  // Computes the hash table slot of a key.
+  size_t Slot(const Animation* _animation, int32_t _key) const;
+
+  const Skeleton* skeleton_;
+  int capacity_;
+  int num_entries_;
+  int num_evaluated_;
+  int hits_;
+  float ratio_step_;
+
+  // Single allocation, that all buffers below point to.
+  void* buffer_;
+  Entry* entries_;
+  math::SoaTransform* locals_;  // capacity_ * num_soa_joints poses.
+  math::Float4x4* models_;      // capacity_ * num_joints poses, or nullptr.
+
+  // Open addressing hash table of entry indices, -1 for empty slots. Its size
+  // is a power of 2, at least twice the capacity.
+  int* table_;
+  size_t table_mask_;
+
+  // One sampling context per entry.
+  SamplingJob::ContextBank contexts_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_POSE_CACHE_H_
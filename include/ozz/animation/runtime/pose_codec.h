@@ -0,0 +1,135 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_POSE_CODEC_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_POSE_CODEC_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+
+// Forward declaration math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Forward declares runtime objects.
+class Skeleton;
+
+// Encodes a local-space pose to a compact byte stream, for example to
+// replicate character poses over network. Joints are encoded relatively to
+// the skeleton rest pose (Skeleton::joint_rest_poses()), which the decoder
+// needs as well:
+// -rotation is the delta from the rest rotation, encoded as smallest three
+// components, 15 bits each, plus the index of the largest one (6 bytes).
+// -translation is the delta from the rest translation, encoded as 3 half
+// floats (6 bytes). It's omitted if equal to rest translation, within
+// translation_tolerance.
+// -scale is encoded as 3 half floats (6 bytes), omitted if equal to rest
+// scale, within scale_tolerance.
+// The stream starts with translation and scale presence bits (one bit per
+// joint for each), followed by each joint data. Multi bytes values are stored
+// little endian, whatever the platform.
+// Joints are processed 4 at a time in SoA.
+// The job does not own the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL PoseEncodeJob {
+  // Default constructor, initializes default values.
+  PoseEncodeJob();
+
+  // Gets the maximum size of an encoded pose of _num_joints joints, aka when
+  // no translation nor scale is omitted.
+  static size_t MaxEncodedSize(int _num_joints);
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if skeleton or size pointers are nullptr.
+  // -if input is smaller than the skeleton's number of SoA joints.
+  // -if output is smaller than MaxEncodedSize(skeleton->num_joints()).
+  // -if tolerances are negative.
+  bool Validate() const;
+
+  // Runs job's encoding task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // The skeleton whose rest pose the input is encoded against.
+  const Skeleton* skeleton;
+
+  // Local-space pose to encode.
+  span<const math::SoaTransform> input;
+
+  // Translations closer than this distance (on each axis) to the rest pose
+  // are omitted. Default is 1e-5.
+  float translation_tolerance;
+
+  // Scales closer than this value (on each axis) to the rest pose are
+  // omitted. Default is 1e-4.
+  float scale_tolerance;
+
+  // Output byte stream.
+  span<byte> output;
+
+  // Output number of bytes written to output.
+  size_t* size;
+};
+
+// Decodes a local-space pose encoded by PoseEncodeJob. The same skeleton must
+// be used for encoding and decoding.
+struct OZZ_ANIMATION_DLL PoseDecodeJob {
+  // Default constructor, initializes default values.
+  PoseDecodeJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if skeleton pointer is nullptr.
+  // -if output is smaller than the skeleton's number of SoA joints.
+  bool Validate() const;
+
+  // Runs job's decoding task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid, or if input is too small to contain
+  // the encoded pose, in which case output content is undefined.
+  bool Run() const;
+
+  // The skeleton whose rest pose the input was encoded against.
+  const Skeleton* skeleton;
+
+  // Encoded byte stream.
+  span<const byte> input;
+
+  // Output local-space pose.
+  span<math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_POSE_CODEC_H_
@@ -0,0 +1,115 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_REPLICATED_ASSETS_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_REPLICATED_ASSETS_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares runtime objects.
+class Animation;
+class Skeleton;
+
+// Replicates hot read-only assets (a skeleton and animations) once per memory
+// node of a NUMA host, so that threads of each node sample and convert poses
+// from local memory rather than fetching keys and rest poses across sockets.
+// Each replica is written by a thread pinned to its node, so that its memory
+// is allocated on that node by the operating system first touch policy.
+// Replicas are built from assets images (see Animation::ToImage()), which
+// are copied in place without any conversion.
+// Workers pinned to a node (see WorkStealingScheduler) get their node assets
+// with local_skeleton() and local_animation(). On a single node host, no copy
+// is made and source assets are returned.
+class OZZ_ANIMATION_DLL ReplicatedAssets {
+ public:
+  ReplicatedAssets();
+
+  // Disables copy and assignation.
+  ReplicatedAssets(ReplicatedAssets const&) = delete;
+  ReplicatedAssets& operator=(ReplicatedAssets const&) = delete;
+
+  ~ReplicatedAssets();
+
+  // Replicates _skeleton (optional, can be nullptr) and _animations to
+  // _num_nodes nodes. A negative _num_nodes uses the number of nodes of the
+  // host. Source assets must outlive *this object if _num_nodes is 1, as
+  // they're returned without copy. Returns false if an asset is nullptr or
+  // couldn't be replicated, leaving *this object empty.
+  bool Replicate(const Skeleton* _skeleton,
+                 span<const Animation* const> _animations,
+                 int _num_nodes = -1);
+
+  // Releases all replicas.
+  void Release();
+
+  // Gets the number of nodes assets are replicated to.
+  int num_nodes() const { return num_nodes_; }
+
+  // Gets the number of replicated animations.
+  int num_animations() const { return num_animations_; }
+
+  // Gets node _node skeleton replica, nullptr if _node is invalid or if no
+  // skeleton was replicated.
+  const Skeleton* skeleton(int _node) const;
+
+  // Gets node _node replica of animation _index, nullptr if _node or _index
+  // is invalid.
+  const Animation* animation(int _node, int _index) const;
+
+  // Gets the skeleton replica of the node the calling thread runs on.
+  const Skeleton* local_skeleton() const;
+
+  // Gets the replica of animation _index of the node the calling thread runs
+  // on.
+  const Animation* local_animation(int _index) const;
+
+ private:
+  // Gets the node of the calling thread, clamped to replicated nodes.
+  int local_node() const;
+
+  int num_nodes_;
+  int num_animations_;
+
+  // Per node skeletons, and per node animations (node major).
+  ozz::vector<const Skeleton*> skeletons_;
+  ozz::vector<const Animation*> animations_;
+
+  // Per node objects and images allocations, owned by *this object when
+  // assets are copied.
+  ozz::vector<Skeleton*> owned_skeletons_;
+  ozz::vector<Animation*> owned_animations_;
+  ozz::vector<void*> images_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_REPLICATED_ASSETS_H_
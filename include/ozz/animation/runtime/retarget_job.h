@@ -0,0 +1,91 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_RETARGET_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_RETARGET_JOB_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+
+// Forward declaration math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Forward declares the RetargetMap used to remap joints.
+class RetargetMap;
+
+// Remaps a local-space pose of a source skeleton to a target skeleton,
+// according to a RetargetMap. Mapped target joints receive their source joint
+// local transform, unmapped ones receive target rest pose. A pose sampled
+// from an animation of the source skeleton can thus drive the target skeleton.
+// Target SoA joints mapped to a whole source SoA joint are copied at once,
+// others are gathered lane by lane.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL RetargetJob {
+  // Default constructor, initializes default values.
+  RetargetJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if map pointer is nullptr.
+  // -if input is smaller than the source skeleton's number of SoA joints.
+  // -if rest pose or output is smaller than the target skeleton's number of
+  // SoA joints.
+  bool Validate() const;
+
+  // Runs job's retargeting task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // Job input.
+
+  // The map from source to target skeleton joints.
+  const RetargetMap* map;
+
+  // Source skeleton local-space pose, ie: SamplingJob or BlendingJob output.
+  span<const ozz::math::SoaTransform> input;
+
+  // Target skeleton rest pose (see Skeleton::joint_rest_poses()), used for
+  // unmapped joints.
+  span<const ozz::math::SoaTransform> rest_pose;
+
+  // Job output.
+
+  // Target skeleton local-space pose. It mustn't overlap input.
+  span<ozz::math::SoaTransform> output;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_RETARGET_JOB_H_
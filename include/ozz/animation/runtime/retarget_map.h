@@ -0,0 +1,120 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_RETARGET_MAP_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_RETARGET_MAP_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace io {
+class IArchive;
+class OArchive;
+}  // namespace io
+namespace animation {
+
+// Forward declares the RetargetMapBuilder, used to instantiate a RetargetMap.
+namespace offline {
+class RetargetMapBuilder;
+}
+
+// Defines the joint mapping from a source skeleton to a target skeleton, so
+// that poses sampled for the source skeleton can drive the target one (see
+// RetargetJob). This allows to share animations across rigs that differ
+// slightly (extra twist joints, different names...), without duplicating
+// clips. Every target joint is mapped to a source joint, whose local-space
+// transform is copied, or is unmapped, in which case it keeps target rest
+// pose.
+// Mapping is precomputed per SoA joint too, so that target SoA joints that
+// map to a whole source SoA joint (in the same order) are copied at once.
+class OZZ_ANIMATION_DLL RetargetMap {
+ public:
+  // Builds a default map, for empty skeletons.
+  RetargetMap();
+
+  // Allow moves.
+  RetargetMap(RetargetMap&&);
+  RetargetMap& operator=(RetargetMap&&);
+
+  // Delete copies.
+  RetargetMap(RetargetMap const&) = delete;
+  RetargetMap& operator=(RetargetMap const&) = delete;
+
+  // Declares the public non-virtual destructor.
+  ~RetargetMap();
+
+  // Returns the number of joints of the source skeleton.
+  int num_source_joints() const { return num_source_joints_; }
+
+  // Returns the number of joints of the target skeleton.
+  int num_target_joints() const {
+    return static_cast<int>(joint_remaps_.size());
+  }
+
+  // Returns, for every target joint, the source joint it's mapped to, or
+  // Skeleton::kNoParent if it's unmapped.
+  span<const int16_t> joint_remaps() const { return make_span(joint_remaps_); }
+
+  // Returns, for every target SoA joint, the source SoA joint that can be
+  // copied as a whole, or -1 if target SoA joint lanes must be gathered one
+  // by one.
+  span<const int16_t> soa_remaps() const { return make_span(soa_remaps_); }
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // RetargetMapBuilder class is allowed to instantiate a RetargetMap.
+  friend class offline::RetargetMapBuilder;
+
+  // Computes soa_remaps_ from joint_remaps_.
+  void BuildSoaRemaps();
+
+  // Number of joints of the source skeleton.
+  int num_source_joints_;
+
+  // Source joint of every target joint, see joint_remaps(). This is the only
+  // serialized data, with num_source_joints_. SoA remaps are derived from it.
+  ozz::vector<int16_t> joint_remaps_;
+
+  // Source SoA joint of every target SoA joint, see soa_remaps().
+  ozz::vector<int16_t> soa_remaps_;
+};
+}  // namespace animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::RetargetMap)
+OZZ_IO_TYPE_TAG("ozz-retarget_map", animation::RetargetMap)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_RETARGET_MAP_H_
@@ -29,6 +29,8 @@
 #define OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_JOB_H_
 
 #include "ozz/animation/runtime/export.h"
+#include "ozz/base/job_plan.h"
+#include "ozz/base/parallel_for.h"
 #include "ozz/base/platform.h"
 #include "ozz/base/span.h"
 
@@ -37,6 +39,8 @@ namespace ozz {
 // Forward declaration of math structures.
 namespace math {
 struct SoaTransform;
+struct SoaHalfTransform;
+struct SoaFloat3;
 }
 
 namespace animation {
@@ -50,16 +54,22 @@ class Animation;
 // SamplingJob uses a context (aka SamplingJob::Context) to store intermediate
 // values (decompressed animation keyframes...) while sampling. This context
 // also stores pre-computed values that allows drastic optimization while
-// playing/sampling the animation forward. Backward sampling works, but isn't
-// optimized through the context. The job does not owned the buffers (in/output)
-// and will thus not delete them during job's destruction.
+// playing/sampling the animation forward. Backward sampling works, but is only
+// optimized through the context for bidirectional animations (see
+// AnimationBuilder::bidirectional), or through animation seek points. The job
+// does not owned the buffers (in/output) and will thus not delete them during
+// job's destruction.
 struct OZZ_ANIMATION_DLL SamplingJob {
   // Default constructor, initializes default values.
   SamplingJob();
 
   // Validates job parameters. Returns true for a valid job, or false otherwise:
   // -if any input pointer is nullptr
-  // -if output range is invalid.
+  // -if context is too small for *this animation, or can't sample it because
+  // it's cubic (see Context::cubic()).
+  // -if output range is invalid, or if both output and half_output are set.
+  // -if mask isn't empty, and too small for animation SoA tracks.
+  // -if prefetch_distance is negative.
   bool Validate() const;
 
   // Runs job's sampling task.
@@ -81,6 +91,9 @@ struct OZZ_ANIMATION_DLL SamplingJob {
   // Forward declares the context object used by the SamplingJob.
   class Context;
 
+  // Forward declares the type used to store many contexts contiguously.
+  class ContextBank;
+
   // A context object that must be big enough to sample *this animation.
   Context* context;
 
@@ -91,12 +104,100 @@ struct OZZ_ANIMATION_DLL SamplingJob {
   // If there are more joints in the animation, then the last joints are not
   // sampled.
   span<ozz::math::SoaTransform> output;
+
+  // Optional half precision output, used instead of output (which must then be
+  // empty). Sampled transforms are converted to half floats, halving the size
+  // of intermediate poses, like BlendingJob layers (see
+  // BlendingJob::Layer::half_transform). Range and mask rules are the same as
+  // output ones.
+  span<ozz::math::SoaHalfTransform> half_output;
+
+  // Optional SoA tracks mask, used to sample only the tracks that contribute
+  // (ie: partial blending). Bit i%8 of byte i/8 enables SoA track i (joints 4*i
+  // to 4*i+3). Keyframes of disabled SoA tracks aren't decompressed nor
+  // interpolated, and the matching output SoaTransform are left unchanged.
+  // Note that BlendingJob still reads masked out joints (weighted by 0), so
+  // output should be initialized with valid transforms at least once.
+  // If not empty, mask must contain at least (num_soa_tracks + 7) / 8 bytes.
+  // Default is empty, which samples all tracks.
+  span<const uint8_t> mask;
+
+  // Optional velocities outputs, in joints local-space (aka parent space) and
+  // per second. linear_velocities receives translations derivatives, and
+  // angular_velocities rotations angular velocities (rotation axis scaled by
+  // radians per second). Velocities are computed analytically from the keys
+  // the context already holds to interpolate the output, so they're exact
+  // derivatives of the sampled pose, without sampling the animation twice.
+  // Like the output, SoA tracks beyond a range size aren't written, and
+  // masked out SoA tracks are left unchanged. Constant tracks have null
+  // velocities.
+  // Default is empty, which doesn't compute velocities.
+  span<math::SoaFloat3> linear_velocities;
+  span<math::SoaFloat3> angular_velocities;
+
+  // Sampling work statistics, used to tune compression and LOD settings, or
+  // to find animations and instances that thrash their context. The job adds
+  // to the counters (it never resets them), so they can be aggregated over
+  // many jobs, like all the jobs of a frame.
+  struct OZZ_ANIMATION_DLL Stats {
+    // Constructs zeroed statistics.
+    Stats();
+
+    // Zeroes all counters.
+    void Reset();
+
+    // Number of keys iterated by the context cursors, forward and backward.
+    // Keys skipped thanks to seek points or keys searches aren't counted.
+    int keys_advanced;
+
+    // Number of SoA entries whose keyframes were decompressed because they
+    // were outdated. Translations, rotations and scales are counted
+    // separately.
+    int refreshed_entries;
+
+    // Number of SoA entries interpolated to the output.
+    int interpolated_entries;
+
+    // Number of times the context discarded its state when stepped to a new
+    // animation or ratio: animation change, rewind, restoration from a seek
+    // point, or keys search.
+    int invalidations;
+  };
+
+  // Optional statistics, accumulated during job execution. Default is
+  // nullptr, meaning no statistics are collected.
+  Stats* stats;
+
+  // Default prefetch distance, see prefetch_distance.
+  enum { kDefaultPrefetchDistance = 0 };
+
+  // Software prefetch distance. Keys read through context indices are
+  // scattered across the animation keys buffer, so reading them can stall on
+  // animations that aren't in cache (ie: large crowds). While the context
+  // cursor iterates keys, the keys it will compare to prefetch_distance keys
+  // later are prefetched. While outdated SoA entries are decompressed, the
+  // keys of the prefetch_distance-th next outdated entry are prefetched.
+  // 0 disables prefetching, which is the default as keys are sorted by time,
+  // so hardware prefetchers usually cover them already. The distance should
+  // be tuned per platform with SamplingJobColdCrowd benchmark.
+  int prefetch_distance;
+
+ private:
+  friend class ozz::JobPlan<SamplingJob>;
+
+  // Runs the valid job, without validating it. See JobPlan.
+  void RunUnchecked() const;
 };
 
+// Gets the generation of the job animation (see Animation::generation()), so
+// that JobPlan<SamplingJob> detects reloaded animations.
+OZZ_ANIMATION_DLL uint32_t JobGeneration(const SamplingJob& _job);
+
 namespace internal {
 // Soa hot data to interpolate.
 struct InterpSoaFloat3;
 struct InterpSoaQuaternion;
+struct InterpSoaTangents;
 }  // namespace internal
 
 // Declares the context object used by the workload to take advantage of the
@@ -110,8 +211,13 @@ class OZZ_ANIMATION_DLL SamplingJob::Context {
   // Constructs a context that can be used to sample any animation with at most
   // _max_tracks tracks. _num_tracks is internally aligned to a multiple of
   // soa size, which means max_tracks() can return a different (but bigger)
-  // value than _max_tracks.
-  explicit Context(int _max_tracks);
+  // value than _max_tracks. Cubic animations can only be sampled if _cubic is
+  // true, see cubic().
+  explicit Context(int _max_tracks, bool _cubic = false);
+
+  // Constructs a context that uses _buffer memory instead of allocating its
+  // own, see Resize(int, span<byte>, bool).
+  Context(int _max_tracks, span<byte> _buffer, bool _cubic = false);
 
   // Disables copy and assignation.
   Context(Context const&) = delete;
@@ -120,55 +226,158 @@ class OZZ_ANIMATION_DLL SamplingJob::Context {
   // Deallocates context.
   ~Context();
 
-  // Resize the number of joints that the context can support.
+  // Resize the number of joints that the context can support, and whether it
+  // can sample cubic animations (see cubic()).
+  // This also implicitly invalidate the context.
+  void Resize(int _max_tracks, bool _cubic = false);
+
+  // Resizes the context so that it uses _buffer memory (ie: from a caller
+  // arena or pool) instead of allocating its own. The context doesn't take
+  // ownership of _buffer, which must outlive the context (or the next call to
+  // Resize).
+  // _buffer must be at least BufferSize(_max_tracks, _cubic) bytes, and
+  // aligned to kBufferAlignment. Otherwise the context is left empty
+  // (max_tracks() is 0), so that sampling jobs using it fail validation.
   // This also implicitly invalidate the context.
-  void Resize(int _max_tracks);
+  void Resize(int _max_tracks, span<byte> _buffer, bool _cubic = false);
+
+  // Defines context buffer constants.
+  enum Constants {
+    // Required alignment of a buffer provided to Resize(int, span<byte>).
+    kBufferAlignment = 16,
+  };
+
+  // Gets the size in bytes of the buffer required by a context supporting
+  // _max_tracks tracks, including translations and scales tangents if _cubic
+  // is true. Size is a multiple of kBufferAlignment, so that buffers can be
+  // laid out contiguously.
+  static size_t BufferSize(int _max_tracks, bool _cubic = false);
 
   // Invalidate the context.
   // The SamplingJob automatically invalidates a context when required
   // during sampling. This automatic mechanism is based on the animation
-  // address and sampling time ratio. The weak point is that it can result in a
-  // crash if ever the address of an animation is used again with another
-  // animation (could be the result of successive call to delete / new).
-  // Therefore it is recommended to manually invalidate a context when it is
-  // known that this context will not be used for with an animation again.
+  // address, its data generation (see Animation::generation()) and sampling
+  // time ratio. Animations that are reloaded in place, or whose address is
+  // used again by another animation, are hence detected. It's still
+  // recommended to manually invalidate a context when it is known that this
+  // context will not be used with an animation again.
   void Invalidate();
 
+  // Gets the size in bytes of the buffer required to snapshot a context used
+  // with an animation of _num_tracks tracks (see Snapshot()).
+  static size_t SnapshotSize(int _num_tracks);
+
+  // Copies context state (animation, ratio, cursors, keys and interpolation
+  // caches) to _buffer, so it can be restored later with Restore(), ie: to
+  // rewind and resimulate frames without resetting the context and seeking
+  // keys again. Only the tracks of the animation the context refers to are
+  // saved, so _buffer must be at least SnapshotSize(animation.num_tracks())
+  // bytes. It doesn't need any specific alignment. A snapshot refers to the
+  // animation address, so it's only valid as long as the animation is alive
+  // and can't be serialized.
+  // Returns the number of bytes written, or 0 if _buffer is too small.
+  size_t Snapshot(span<byte> _buffer) const;
+
+  // Restores context state from a snapshot written by Snapshot(), possibly
+  // from another context. Tangents of cubic animations aren't part of
+  // snapshots, so translations and scales are decompressed again by the next
+  // sampling. Returns false if _buffer is too small or the context can't
+  // handle snapshot tracks, in which case the context is invalidated.
+  bool Restore(span<const byte> _buffer);
+
   // The maximum number of tracks that the context can handle.
   int max_tracks() const { return max_soa_tracks_ * 4; }
   int max_soa_tracks() const { return max_soa_tracks_; }
 
+  // Tells if the context stores translations and scales tangents, which are
+  // required to sample cubic animations (see Animation::cubic()). Sampling
+  // jobs fail validation otherwise, as the context never allocates memory
+  // once resized.
+  bool cubic() const { return soa_translation_tangents_ != nullptr; }
+
  private:
   friend struct SamplingJob;
+  friend struct BatchSamplingJob;
+  friend struct SampleBlendingJob;
 
   // Steps the context in order to use it for a potentially new animation and
   // ratio. If the _animation is different from the animation currently cached,
   // or if the _ratio shows that the animation is played backward, then the
   // context is invalidated and reset for the new _animation and _ratio.
-  void Step(const Animation& _animation, float _ratio);
+  // Bidirectional animations aren't invalidated when played backward. If
+  // _animation has seek points, then the context is restored from the nearest
+  // seek point instead of being reset. This also applies when jumping forward
+  // or backward over more than a seek interval. For random access animations,
+  // keys are directly searched for when ratio changes by more than a few keys
+  // per track, instead of iterating all the keys in between.
+  // Returns true if context state was discarded (reset, restored from a seek
+  // point or flagged for keys search).
+  bool Step(const Animation& _animation, float _ratio);
+
+  // Steps the context to _animation and _ratio (see Step()), and updates
+  // interpolation keys of all the SoA tracks enabled by _mask (all of them if
+  // _mask is empty). _ratio must already be clamped to the unit interval.
+  // Work statistics are added to _stats, unless it's nullptr. Keys are
+  // prefetched _prefetch_distance ahead, see SamplingJob::prefetch_distance.
+  void Update(const Animation& _animation, float _ratio,
+              const span<const uint8_t>& _mask,
+              SamplingJob::Stats* _stats = nullptr,
+              int _prefetch_distance = kDefaultPrefetchDistance);
+
+  // Interpolates SoA tracks [_begin,_end[ of the last updated animation and
+  // ratio, writing track _begin to _output[0]. Tracks disabled by _mask are
+  // left unchanged.
+  void Interpolate(int _begin, int _end, const span<const uint8_t>& _mask,
+                   math::SoaTransform* _output) const;
+
+  // Computes linear and angular velocities of SoA tracks [_begin,_end[ of the
+  // last updated animation and ratio, see SamplingJob::linear_velocities.
+  // _linear or _angular can be nullptr to skip them.
+  void Differentiate(int _begin, int _end, const span<const uint8_t>& _mask,
+                     math::SoaFloat3* _linear, math::SoaFloat3* _angular) const;
+
+  // Restores context state from _animation seek point _point.
+  void RestoreSeekPoint(const Animation& _animation, int _point);
+
+  // Copies _other context state, limited to the _num_soa_tracks first soa
+  // tracks. Both contexts must be big enough to store _num_soa_tracks.
+  void CopyState(const Context& _other, int _num_soa_tracks);
 
   // The animation this context refers to. nullptr means that the context is
   // invalid.
   const Animation* animation_;
 
+  // Generation of animation_ data the context state refers to.
+  uint32_t generation_;
+
   // The current time ratio in the animation.
   float ratio_;
 
   // The number of soa tracks that can store this context.
   int max_soa_tracks_;
 
+  // Tells if context buffer (soa_translations_) was allocated by the context,
+  // or provided by the user.
+  bool owns_buffer_;
+
   // Soa hot data to interpolate.
   internal::InterpSoaFloat3* soa_translations_;
   internal::InterpSoaQuaternion* soa_rotations_;
   internal::InterpSoaFloat3* soa_scales_;
 
+  // Soa tangents of translations and scales, only used by cubic animations.
+  // nullptr unless the context was resized for cubic animations.
+  internal::InterpSoaTangents* soa_translation_tangents_;
+  internal::InterpSoaTangents* soa_scale_tangents_;
+
   // Points to the keys in the animation that are valid for the current time
   // ratio.
   int* translation_keys_;
   int* rotation_keys_;
   int* scale_keys_;
 
-  // Current cursors in the animation. 0 means that the context is invalid.
+  // Current cursors in the animation. 0 means that the context is invalid, a
+  // negative value that keys must be searched for.
   int translation_cursor_;
   int rotation_cursor_;
   int scale_cursor_;
@@ -178,6 +387,255 @@ class OZZ_ANIMATION_DLL SamplingJob::Context {
   uint8_t* outdated_rotations_;
   uint8_t* outdated_scales_;
 };
+
+// Stores many contexts, laid out contiguously in a single allocation. Context
+// objects are followed by their buffers, stored in the same order. This avoids
+// many small allocations and improves memory locality when processing many
+// instances (see BatchSamplingJob).
+class OZZ_ANIMATION_DLL SamplingJob::ContextBank {
+ public:
+  // Constructs an empty bank.
+  ContextBank();
+
+  // Constructs a bank of _num_contexts contexts, each one supporting at most
+  // _max_tracks tracks, and cubic animations if _cubic is true.
+  ContextBank(int _num_contexts, int _max_tracks, bool _cubic = false);
+
+  // Disables copy and assignation.
+  ContextBank(ContextBank const&) = delete;
+  ContextBank& operator=(ContextBank const&) = delete;
+
+  // Deallocates all contexts.
+  ~ContextBank();
+
+  // Resizes the bank to _num_contexts contexts, each one supporting at most
+  // _max_tracks tracks, and cubic animations if _cubic is true. All previous
+  // contexts are destroyed.
+  void Resize(int _num_contexts, int _max_tracks, bool _cubic = false);
+
+  // Gets the number of contexts.
+  int num_contexts() const { return static_cast<int>(contexts_.size()); }
+
+  // Gets the range of contexts.
+  span<Context> contexts() const { return contexts_; }
+
+ private:
+  // Releases all contexts and the allocation.
+  void Release();
+
+  // Contexts range, which is also the allocation pointer.
+  span<Context> contexts_;
+};
+
+// Samples a single animation for a batch of instances (aka characters), each
+// one using its own ratio, context and output. The result is strictly the
+// same as running a SamplingJob per instance, but the batch job amortizes key
+// frames decompression across instances: when an instance context would need
+// to be reset (first use, animation change, backward or looping playback), or
+// lags behind, it is seeded from the previous instance of the batch, provided
+// this previous instance was sampled at a lower or equal ratio. Seeding copies
+// O(tracks) cached data instead of replaying all the keys from the beginning
+// of the animation. Instances sampled at exactly the same ratio as the previous
+// one also reuse its output instead of interpolating again.
+// As only the previous instance is considered, sorting instances by ratio
+// maximizes sharing.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL BatchSamplingJob {
+  // Default constructor, initializes default values.
+  BatchSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if animation pointer is nullptr.
+  // -if ratios and instances ranges don't have the same size.
+  // -if any instance context is nullptr or can't sample *this animation (too
+  // small, or without tangents for a cubic animation).
+  // -if any instance output range is empty.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // The animation to sample, shared by all instances.
+  const Animation* animation;
+
+  // Time ratios in the unit interval [0,1] used to sample the animation, one
+  // per instance. Ratios are clamped before job execution, like SamplingJob
+  // does.
+  span<const float> ratios;
+
+  // Defines per instance sampling data.
+  struct Instance {
+    // A context object that must be big enough to sample *this animation. A
+    // context shouldn't be used twice in the same batch.
+    SamplingJob::Context* context;
+
+    // The output range to be filled with sampled joints, see SamplingJob
+    // output for more details.
+    span<ozz::math::SoaTransform> output;
+  };
+
+  // The range of instances to sample, must be as big as ratios range.
+  span<const Instance> instances;
+};
+
+// Samples a single animation at many sorted ratios, outputting a pose per
+// ratio. This suits trajectory prediction or motion matching queries, that
+// need the same animation at a few future ratios. All ratios are sampled with
+// the same context, whose cursors only move forward through the keys as
+// ratios are sorted: the total cost is a single pass over the keys, instead of
+// a context reset (or a context) per ratio. Consecutive equal ratios reuse
+// the previous output instead of interpolating again.
+// The context is left at the last ratio. If the first ratio is lower than the
+// ratio the context was last used with, the context restarts once from the
+// beginning of the animation (or from the nearest seek point).
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL MultiRatioSamplingJob {
+  // Default constructor, initializes default values.
+  MultiRatioSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if animation or context pointer is nullptr.
+  // -if context isn't big enough to sample *this animation, or without
+  // tangents for a cubic animation.
+  // -if ratios aren't sorted in ascending order.
+  // -if ratios and outputs ranges don't have the same size.
+  // -if any output range is empty.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // The animation to sample.
+  const Animation* animation;
+
+  // A context object that must be big enough to sample *this animation.
+  SamplingJob::Context* context;
+
+  // Time ratios in the unit interval [0,1] used to sample the animation,
+  // sorted in ascending order. Ratios are clamped before job execution, like
+  // SamplingJob does.
+  span<const float> ratios;
+
+  // The output ranges to be filled with sampled joints, one per ratio. See
+  // SamplingJob output for more details.
+  span<const span<ozz::math::SoaTransform>> outputs;
+
+  // Optional statistics, accumulated over all ratios. Default is nullptr.
+  SamplingJob::Stats* stats;
+};
+
+// Samples a crowd of instances (aka characters), each one playing its own
+// animation at its own ratio. Instances are sorted by animation, then by
+// ratio, and each run of instances sharing the same animation is sampled
+// contiguously with a BatchSamplingJob. This maximizes reuse of an animation
+// keys in cache across instances, and lets the batch job seed contexts from
+// each other, whatever the order instances are provided in.
+// Sorted instances are processed in chunks of kChunkSize, which can be
+// distributed to threads with the optional parallel_for hook.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL CrowdSamplingJob {
+  // Default constructor, initializes default values.
+  CrowdSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any instance animation or context is nullptr, or if a context is too
+  // small for its instance animation (or without tangents for a cubic one).
+  // -if any instance output range is empty.
+  // -if order range is smaller than instances range.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Number of sorted instances per chunk (or parallel_for task).
+  enum { kChunkSize = 64 };
+
+  // Defines per instance sampling data.
+  struct Instance {
+    // The animation to sample.
+    const Animation* animation;
+
+    // Time ratio in the unit interval [0,1] used to sample the animation.
+    float ratio;
+
+    // A context object that must be big enough to sample animation. A context
+    // shouldn't be used twice in the same crowd.
+    SamplingJob::Context* context;
+
+    // The output range to be filled with sampled joints, see SamplingJob
+    // output for more details.
+    span<ozz::math::SoaTransform> output;
+  };
+
+  // The range of instances to sample.
+  span<const Instance> instances;
+
+  // Scratch buffer, that must be at least as big as instances range. It
+  // outputs instances indices in sampling order.
+  span<int> order;
+
+  // Task function and task scheduler hook, see ozz/base/parallel_for.h. Each
+  // task samples a chunk of characters.
+  typedef ozz::ParallelForTask ParallelForTask;
+  typedef ozz::ParallelForHook ParallelFor;
+
+  // Optional task scheduler hook. If nullptr (default), chunks are sampled
+  // serially by the calling thread.
+  ParallelFor parallel_for;
+
+  // User data provided to parallel_for.
+  void* parallel_for_user_data;
+};
+
+// Samples an animation at a given time ratio without any context, which suits
+// random access sampling (one-off or unordered ratios). Keys are searched for
+// using animation per track keys indices, which costs O(tracks * log(keys))
+// per run, instead of the O(keys) a context needs to replay from the
+// beginning of the animation. SamplingJob remains faster on the other hand
+// when playing an animation forward, as it doesn't decompress keys again. The
+// result is the same as the one of a SamplingJob sampling the same ratio.
+// The animation must be built with AnimationBuilder::random_access option.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL StatelessSamplingJob {
+  // Default constructor, initializes default values.
+  StatelessSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if animation pointer is nullptr.
+  // -if animation wasn't built with per track keys indices.
+  // -if output range is invalid.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time ratio in the unit interval [0,1] used to sample animation, see
+  // SamplingJob::ratio.
+  float ratio;
+
+  // The animation to sample. It must be random access, see
+  // Animation::random_access().
+  const Animation* animation;
+
+  // Job output, see SamplingJob::output.
+  span<ozz::math::SoaTransform> output;
+};
 }  // namespace animation
 }  // namespace ozz
 #endif  // OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_JOB_H_
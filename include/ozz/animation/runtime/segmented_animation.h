@@ -0,0 +1,156 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_ANIMATION_H_
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace io {
+class IArchive;
+class OArchive;
+}  // namespace io
+namespace animation {
+
+// Forward declares the AnimationStream, which loads SegmentedAnimation segments
+// on demand.
+class AnimationStream;
+
+// Forward declares the SegmentedAnimationBuilder, used to instantiate a
+// SegmentedAnimation.
+namespace offline {
+class SegmentedAnimationBuilder;
+}
+
+// Defines a runtime skeletal animation clip split into time segments. Each
+// segment is an independent Animation, covering a slice of the clip with its
+// own first and last keys, so it can be sampled (and loaded) on its own.
+// This suits long clips (cinematics, minutes of motion capture): seeking only
+// requires to locate the segment, and only the segments around playback time
+// need to be resident.
+// A segment is sampled with a SamplingJob, using the segment local ratio
+// returned by FindSegment(). Moving from a segment to the next one resets the
+// sampling context, as for any animation change.
+class OZZ_ANIMATION_DLL SegmentedAnimation {
+ public:
+  // Builds a default segmented animation, without any segment.
+  SegmentedAnimation();
+
+  // Allow moves.
+  SegmentedAnimation(SegmentedAnimation&&);
+  SegmentedAnimation& operator=(SegmentedAnimation&&);
+
+  // Delete copies.
+  SegmentedAnimation(SegmentedAnimation const&) = delete;
+  SegmentedAnimation& operator=(SegmentedAnimation const&) = delete;
+
+  // Declares the public non-virtual destructor.
+  ~SegmentedAnimation();
+
+  // Gets the whole animation clip duration.
+  float duration() const { return duration_; }
+
+  // Gets the number of animated tracks, the same for all segments.
+  int num_tracks() const { return num_tracks_; }
+
+  // Returns the number of SoA elements matching the number of tracks of *this
+  // animation.
+  int num_soa_tracks() const { return (num_tracks_ + 3) / 4; }
+
+  // Gets animation name.
+  const char* name() const { return name_.c_str(); }
+
+  // Gets the number of segments.
+  int num_segments() const { return static_cast<int>(segments_.size()); }
+
+  // Gets segments boundaries, as ratios of the whole animation. Segment i
+  // spans ratios [segment_ratios()[i], segment_ratios()[i + 1]], hence the
+  // buffer contains num_segments() + 1 ratios, from 0 to 1.
+  span<const float> segment_ratios() const { return make_span(ratios_); }
+
+  // Gets segment _index animation. Its duration is the segment one.
+  const Animation& segment(int _index) const;
+
+  // Finds the segment containing _ratio (of the whole animation, clamped to
+  // [0,1]), and outputs to _segment_ratio the ratio to use to sample this
+  // segment. Returns the segment index, or -1 if animation has no segment.
+  int FindSegment(float _ratio, float* _segment_ratio) const;
+
+  // Get the estimated animation's size in bytes.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  // Every segment is serialized as an independent archive, whose size is
+  // written ahead in the segments table. This allows to locate and load a
+  // single segment from a stream, without loading the others.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // SegmentedAnimationBuilder class is allowed to instantiate a
+  // SegmentedAnimation.
+  friend class offline::SegmentedAnimationBuilder;
+
+  // AnimationStream loads segments individually.
+  friend class AnimationStream;
+
+  // Loads everything but the segments, which are left empty. Outputs segments
+  // serialized sizes to _sizes. Returns false if loading failed.
+  bool LoadHeader(ozz::io::IArchive& _archive, uint32_t _version,
+                  ozz::vector<uint32_t>* _sizes);
+
+  // Duration of the whole animation clip.
+  float duration_;
+
+  // The number of joint tracks.
+  int num_tracks_;
+
+  // Animation name.
+  ozz::string name_;
+
+  // Segments boundaries ratios, see segment_ratios().
+  ozz::vector<float> ratios_;
+
+  // Segments animations.
+  ozz::vector<Animation> segments_;
+};
+}  // namespace animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::SegmentedAnimation)
+OZZ_IO_TYPE_TAG("ozz-segmented_animation", animation::SegmentedAnimation)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_ANIMATION_H_
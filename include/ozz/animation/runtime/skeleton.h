@@ -38,6 +38,9 @@ namespace io {
 class IArchive;
 class OArchive;
 }  // namespace io
+namespace memory {
+class Allocator;
+}  // namespace memory
 namespace math {
 struct SoaTransform;
 }
@@ -49,38 +52,60 @@ class SkeletonBuilder;
 }
 
 // This runtime skeleton data structure provides a const-only access to joint
-// hierarchy, joint names and rest-pose. This structure is filled by the
-// SkeletonBuilder and can be serialize/deserialized.
+// hierarchy, joint names (or name hashes) and rest-pose. This structure is
+// filled by the SkeletonBuilder and can be serialize/deserialized.
 // Joint names, rest-poses and hierarchy information are all stored in separate
 // arrays of data (as opposed to joint structures for the RawSkeleton), in order
 // to closely match with the way runtime algorithms use them. Joint hierarchy is
 // packed as an array of parent jont indices (16 bits), stored in depth-first
-// order. This is enough to traverse the whole joint hierarchy. See
-// IterateJointsDF() from skeleton_utils.h that implements a depth-first
-// traversal utility.
+// order by default (see SkeletonBuilder::ordering), parents being always
+// stored before their children. This is enough to traverse the whole joint
+// hierarchy. See IterateJointsDF() from skeleton_utils.h that implements a
+// depth-first traversal utility. Topology tables (children, sub-hierarchy
+// ends and depths) are derived from parents when the skeleton is built or
+// loaded, so that hierarchy queries run in constant time.
 class OZZ_ANIMATION_DLL Skeleton {
  public:
   // Defines Skeleton constant values.
   enum Constants {
 
     // Defines the maximum number of joints.
-    // This is limited in order to control the number of bits required to store
-    // a joint index. Limiting the number of joints also helps handling worst
-    // size cases, like when it is required to allocate an array of joints on
-    // the stack.
-    kMaxJoints = 1024,
+    // This is limited by the number of bits used to store a joint index, in
+    // skeleton parents (16 bits) and animation tracks (13 bits).
+    kMaxJoints = 8192,
 
     // Defines the maximum number of SoA elements required to store the maximum
     // number of joints.
     kMaxSoAJoints = (kMaxJoints + 3) / 4,
 
+    // Defines the number of joints up to which runtime jobs use stack memory
+    // for their per joint scratch arrays. Bigger skeletons are supported, but
+    // jobs then allocate their scratch memory from the default allocator.
+    kMaxInlineJoints = 1024,
+
+    // Defines the number of SoA elements matching kMaxInlineJoints.
+    kMaxInlineSoAJoints = (kMaxInlineJoints + 3) / 4,
+
     // Defines the index of the parent of the root joint (which has no parent in
     // fact).
     kNoParent = -1,
   };
 
-  // Builds a default skeleton.
-  Skeleton();
+  // Defines how joint names are stored when the skeleton is built or loaded.
+  enum NameStorage {
+    // Joint name strings are stored, along with their hashes.
+    kNameStrings,
+
+    // Only joint name hashes are stored, joint_names() is empty. This saves
+    // names memory when they're only used to find joints.
+    kNameHashes,
+  };
+
+  // Builds a default skeleton. Skeleton buffers are allocated with _allocator
+  // when the skeleton is built or loaded, nullptr meaning the default
+  // allocator. _name_storage defines how joint names are then stored.
+  explicit Skeleton(memory::Allocator* _allocator = nullptr,
+                    NameStorage _name_storage = kNameStrings);
 
   // Allow move.
   Skeleton(Skeleton&&);
@@ -108,22 +133,101 @@ class OZZ_ANIMATION_DLL Skeleton {
   // Returns joint's parent indices range.
   span<const int16_t> joint_parents() const { return joint_parents_; }
 
-  // Returns joint's name collection.
+  // Returns _joint children indices, in increasing order. _joint can be
+  // kNoParent, in which case skeleton root joints are returned.
+  span<const int16_t> joint_children(int _joint) const {
+    assert(_joint >= kNoParent && _joint < num_joints() &&
+           "_joint index out of range");
+    if (joint_children_offsets_.empty()) {
+      return {};
+    }
+    return {joint_children_.begin() + joint_children_offsets_[_joint + 1],
+            joint_children_.begin() + joint_children_offsets_[_joint + 2]};
+  }
+
+  // Returns joint's sub-hierarchy ends, aka the index of each joint plus the
+  // number of joints of its sub-hierarchy (itself included). When the
+  // skeleton is depth-first ordered, the sub-hierarchy of joint j is the
+  // contiguous range [j, joint_subtree_ends()[j][.
+  span<const int16_t> joint_subtree_ends() const {
+    return joint_subtree_ends_;
+  }
+
+  // Returns joint's depth in the hierarchy, 0 for root joints.
+  span<const int16_t> joint_depths() const { return joint_depths_; }
+
+  // Returns joint's name collection. It's empty if names storage is
+  // kNameHashes.
   span<const char* const> joint_names() const {
     return span<const char* const>(joint_names_.begin(), joint_names_.end());
   }
 
+  // Returns joint's name hashes, see HashName().
+  span<const uint32_t> joint_name_hashes() const { return joint_name_hashes_; }
+
+  // Returns how joint names are stored.
+  NameStorage name_storage() const { return name_storage_; }
+
+  // Computes the hash of joint name _name, 32 bits FNV-1a.
+  static uint32_t HashName(const char* _name);
+
+  // Finds the first joint whose name hash is _hash, in constant time. If _name
+  // isn't nullptr and names strings are stored, joint names are also compared
+  // to _name, which resolves hash collisions. See FindJoint() from
+  // skeleton_utils.h.
+  // Returns -1 if no joint matches.
+  int FindJointByHash(uint32_t _hash, const char* _name = nullptr) const;
+
+  // Returns the allocator used for skeleton buffers, nullptr for the default
+  // allocator.
+  memory::Allocator* allocator() const { return allocator_; }
+
+  // Defines the alignment required for skeleton images.
+  enum { kImageAlignment = 16 };
+
+  // Skeleton images are a relocatable binary layout of the skeleton, which
+  // can be used in place, see FromImage(). Images use platform native
+  // endianness, and are specific to a skeleton version.
+  // Gets the size of *this skeleton image, in bytes.
+  size_t image_size() const;
+
+  // Writes *this skeleton image to _image, which must be image_size() bytes
+  // big at least, and aligned to kImageAlignment.
+  // Returns false if _image is too small or misaligned.
+  bool ToImage(span<byte> _image) const;
+
+  // Sets *this skeleton to use _image data in place. Only joint names
+  // pointers and hashes are allocated, other data point to _image, which must
+  // be aligned to kImageAlignment and must remain valid and unchanged for the
+  // lifetime of *this skeleton.
+  // Returns false if _image isn't a valid skeleton image for this platform
+  // and version, leaving *this skeleton empty.
+  bool FromImage(span<const byte> _image);
+
   // Serialization functions.
   // Should not be called directly but through io::Archive << and >> operators.
+  // Skeletons storing kNameHashes have no name to save, so they're saved (and
+  // imaged) with empty names.
   void Save(ozz::io::OArchive& _archive) const;
   void Load(ozz::io::IArchive& _archive, uint32_t _version);
 
  private:
   // Internal allocation/deallocation function.
-  // Allocate returns the beginning of the contiguous buffer of names.
+  // Allocate returns the beginning of the contiguous buffer of names, nullptr
+  // if names strings aren't stored.
   char* Allocate(size_t _char_count, size_t _num_joints);
   void Deallocate();
 
+  // Fills names lookup table from joint name hashes.
+  void BuildNameTable();
+
+  // Distributes topology tables from _buffer, for _num_joints joints.
+  void FillTopology(span<byte>* _buffer, size_t _num_joints);
+
+  // Fills topology tables (children, sub-hierarchy ends and depths) from
+  // joint parents. Returns false if a joint parent isn't stored before it.
+  bool BuildTopology();
+
   // SkeletonBuilder class is allowed to instantiate an Skeleton.
   friend class offline::SkeletonBuilder;
 
@@ -136,8 +240,38 @@ class OZZ_ANIMATION_DLL Skeleton {
   // Array of joint parent indexes.
   span<int16_t> joint_parents_;
 
-  // Stores the name of every joint in an array of c-strings.
+  // Children of every joint, grouped by parent, roots first. Children of
+  // joint j are in range [joint_children_offsets_[j + 1],
+  // joint_children_offsets_[j + 2][, hence num_joints + 2 offsets.
+  span<int16_t> joint_children_;
+  span<int16_t> joint_children_offsets_;
+
+  // Sub-hierarchy end of every joint, see joint_subtree_ends().
+  span<int16_t> joint_subtree_ends_;
+
+  // Depth of every joint.
+  span<int16_t> joint_depths_;
+
+  // Stores the name of every joint in an array of c-strings. Empty if names
+  // strings aren't stored.
   span<char*> joint_names_;
+
+  // Hash of every joint name.
+  span<uint32_t> joint_name_hashes_;
+
+  // Open addressing hash table of joint indices, -1 for empty slots. Its size
+  // is a power of 2, at least twice the number of joints.
+  span<int16_t> joint_name_table_;
+
+  // Names storage mode.
+  NameStorage name_storage_;
+
+  // Allocator used for allocation_, nullptr for the default allocator.
+  memory::Allocator* allocator_;
+
+  // Buffer allocated for skeleton data, or only for joint names pointers if
+  // skeleton data are stored in an image.
+  void* allocation_;
 };
 }  // namespace animation
 
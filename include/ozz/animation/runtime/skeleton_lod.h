@@ -0,0 +1,147 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SKELETON_LOD_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SKELETON_LOD_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace io {
+class IArchive;
+class OArchive;
+}  // namespace io
+namespace animation {
+
+// Forward declares the Skeleton object this level of detail applies to.
+class Skeleton;
+
+// Forward declares the SkeletonLODBuilder, used to instantiate a SkeletonLOD.
+namespace offline {
+class SkeletonLODBuilder;
+}
+
+// Defines a skeleton level of detail, aka the subset of a skeleton's joints
+// that are evaluated for distant characters (ie: root, spine and a few limbs).
+// The set of active joints always contains the ancestors of every active
+// joint, so active joints model-space matrices only depend on active joints.
+// The SkeletonLOD provides masks and remapping tables in the formats expected
+// by runtime jobs:
+// - soa_mask() for SamplingJob::mask and BlendingJob::Layer::mask.
+// - joints_mask() for LocalToModelJob::mask.
+// - RemapPalette() for SkinningJob::joint_remaps, so that vertices influenced
+// by inactive joints follow their nearest active ancestor.
+class OZZ_ANIMATION_DLL SkeletonLOD {
+ public:
+  // Builds a default level of detail, for an empty skeleton.
+  SkeletonLOD();
+
+  // Allow moves.
+  SkeletonLOD(SkeletonLOD&&);
+  SkeletonLOD& operator=(SkeletonLOD&&);
+
+  // Delete copies.
+  SkeletonLOD(SkeletonLOD const&) = delete;
+  SkeletonLOD& operator=(SkeletonLOD const&) = delete;
+
+  // Declares the public non-virtual destructor.
+  ~SkeletonLOD();
+
+  // Returns the number of joints of the skeleton *this level of detail was
+  // built for.
+  int num_joints() const { return static_cast<int>(joint_remaps_.size()); }
+
+  // Returns the number of active joints.
+  int num_active_joints() const { return num_active_joints_; }
+
+  // Tests if joint _joint is active. _joint must be in range [0, num joints[.
+  bool IsActive(int _joint) const;
+
+  // Returns per joint mask, where bit i%8 of byte i/8 enables joint i. This is
+  // the format of LocalToModelJob::mask.
+  span<const uint8_t> joints_mask() const { return make_span(joints_mask_); }
+
+  // Returns per SoA joint mask, where bit i%8 of byte i/8 enables SoA joint i
+  // (joints 4*i to 4*i+3). A SoA joint is enabled if any of its joints is
+  // active. This is the format of SamplingJob::mask and
+  // BlendingJob::Layer::mask.
+  span<const uint8_t> soa_mask() const { return make_span(soa_mask_); }
+
+  // Returns, for every joint, its own index if it's active, or the index of
+  // its nearest active ancestor otherwise. Joints without any active ancestor
+  // are remapped to Skeleton::kNoParent.
+  span<const int16_t> joint_remaps() const { return make_span(joint_remaps_); }
+
+  // Computes skinning palette remapping table for a mesh. _palette_joints
+  // gives the skeleton joint of every palette entry (ie: Mesh::joint_remaps).
+  // Output _palette_remaps is indexed by palette entries, and gives the
+  // palette entry of the nearest active ancestor of entry's joint, that's part
+  // of the palette. Entries of active joints, and entries without any active
+  // ancestor in the palette, are remapped to themselves. Output can be used as
+  // SkinningJob::joint_remaps, skinning matrices of remapped entries don't
+  // need to be computed anymore.
+  // Returns false if _skeleton doesn't match *this level of detail, if a
+  // palette joint is out of range or if _palette_remaps is too small.
+  bool RemapPalette(const Skeleton& _skeleton,
+                    span<const uint16_t> _palette_joints,
+                    span<uint16_t> _palette_remaps) const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // SkeletonLODBuilder class is allowed to instantiate a SkeletonLOD.
+  friend class offline::SkeletonLODBuilder;
+
+  // Computes masks and active joints count from joint_remaps_.
+  void BuildMasks();
+
+  // Number of active joints.
+  int num_active_joints_;
+
+  // Masks of active joints, see joints_mask() and soa_mask().
+  ozz::vector<uint8_t> joints_mask_;
+  ozz::vector<uint8_t> soa_mask_;
+
+  // Nearest active joint of every joint, see joint_remaps(). This is the only
+  // serialized data, masks are derived from it.
+  ozz::vector<int16_t> joint_remaps_;
+};
+}  // namespace animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::SkeletonLOD)
+OZZ_IO_TYPE_TAG("ozz-skeleton_lod", animation::SkeletonLOD)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SKELETON_LOD_H_
@@ -41,37 +41,47 @@ namespace animation {
 OZZ_ANIMATION_DLL ozz::math::Transform GetJointLocalRestPose(
     const Skeleton& _skeleton, int _joint);
 
-// Test if a joint is a leaf. _joint number must be in range [0, num joints].
-// "_joint" is a leaf if it's the last joint, or next joint's parent isn't
-// "_joint".
+// Test if a joint is a leaf, aka it has no child. _joint number must be in
+// range [0, num joints[. Works whatever the skeleton ordering.
 inline bool IsLeaf(const Skeleton& _skeleton, int _joint) {
-  const int num_joints = _skeleton.num_joints();
-  assert(_joint >= 0 && _joint < num_joints && "_joint index out of range");
-  const span<const int16_t>& parents = _skeleton.joint_parents();
-  const int next = _joint + 1;
-  return next == num_joints || parents[next] != _joint;
+  assert(_joint >= 0 && _joint < _skeleton.num_joints() &&
+         "_joint index out of range");
+  return _skeleton.joint_children(_joint).empty();
 }
 
-// Finds joint index by name. Uses a case sensitive comparison.
+// Finds joint index by name. Uses a case sensitive comparison. Lookup uses
+// skeleton name hashes, so it also works for skeletons that don't store names
+// strings, in which case name hash collisions can't be resolved.
 OZZ_ANIMATION_DLL int FindJoint(const Skeleton& _skeleton, const char* _name);
 
+// Tests if _skeleton joints are ordered depth-first, aka every sub-hierarchy
+// is a contiguous range of joints. This is the default SkeletonBuilder
+// ordering, see SkeletonBuilder::ordering.
+OZZ_ANIMATION_DLL bool IsDepthFirst(const Skeleton& _skeleton);
+
 // Applies a specified functor to each joint in a depth-first order.
 // _Fct is of type void(int _current, int _parent) where the first argument
 // is the child of the second argument. _parent is kNoParent if the _current
 // joint is a root. _from indicates the joint from which the joint hierarchy
 // traversal begins. Use Skeleton::kNoParent to traverse the whole
-// hierarchy, in case there are multiple roots.
+// hierarchy, in case there are multiple roots. Skeleton must be ordered
+// depth-first (see IsDepthFirst()) to traverse from another joint, otherwise
+// joints are only guaranteed to be visited after their parent.
 template <typename _Fct>
 inline _Fct IterateJointsDF(const Skeleton& _skeleton, _Fct _fct,
                             int _from = Skeleton::kNoParent) {
   const span<const int16_t>& parents = _skeleton.joint_parents();
   const int num_joints = _skeleton.num_joints();
-  //
-  // parents[i] >= _from is true as long as "i" is a child of "_from".
-  static_assert(Skeleton::kNoParent < 0,
-                "Algorithm relies on kNoParent being negative");
-  for (int i = _from < 0 ? 0 : _from, process = i < num_joints; process;
-       ++i, process = i < num_joints && parents[i] >= _from) {
+
+  // _from sub-hierarchy is the contiguous range of joints ending at its
+  // sub-hierarchy end.
+  int begin = 0;
+  int end = num_joints;
+  if (_from >= 0) {
+    begin = _from;
+    end = _from < num_joints ? _skeleton.joint_subtree_ends()[_from] : _from;
+  }
+  for (int i = begin; i < end; ++i) {
     _fct(i, parents[i]);
   }
   return _fct;
@@ -0,0 +1,167 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SPRING_BONE_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SPRING_BONE_JOB_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/vec_float.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+
+// Forward declaration math structures.
+namespace math {
+struct Float4x4;
+struct SoaTransform;
+}  // namespace math
+
+namespace animation {
+
+// Forward declares the runtime skeleton.
+class Skeleton;
+
+// Adds secondary motion (hair, tails, accessories) to joint chains, on top of
+// the animated pose. Each joint of a chain (but its root) is a verlet
+// particle, pulled toward its animated position by a stiffness factor, and
+// slowed down by a damping factor. Particles are then constrained to the
+// animated bone lengths, and the resulting directions are written back to the
+// chain joints local-space rotations.
+// Chains are integrated 4 at a time, in SoA: SoA lanes hold 4 chains, and the
+// job walks them down from their roots, one depth level at a time. Chains of a
+// SoA group can have different lengths, shorter ones being masked out.
+// The job reads animated model-space matrices (LocalToModelJob output) for
+// chains roots parent frames, and modifies local-space transforms of chains
+// joints. Model-space matrices must then be updated for the chains only, with
+// a LocalToModelJob whose dirty mask is Context::dirty().
+// Chain roots position is animated, but their rotation is corrected to aim
+// the next joint of the chain. Chains must not overlap, nor be a descendant of
+// another chain, as chain roots parent frames are read from animated
+// matrices. Joints scale is expected to be uniform.
+struct OZZ_ANIMATION_DLL SpringBoneJob {
+  // Describes a chain, from its root to its tip, which must be a descendant of
+  // root.
+  struct Chain {
+    int root;
+    int tip;
+  };
+
+  // Simulation context, storing chains SoA layout, per joint settings and
+  // particles state. A context is setup for a skeleton and a set of chains,
+  // and must be used for a single character instance.
+  class OZZ_ANIMATION_DLL Context {
+   public:
+    Context();
+
+    // Disables copy and assignation.
+    Context(Context const&) = delete;
+    Context& operator=(Context const&) = delete;
+
+    ~Context();
+
+    // Setups chains of _skeleton. _stiffness and _damping are per skeleton
+    // joint settings (only chains joints but roots are read), clamped to the
+    // unit interval. A stiffness of 1 fully follows animation, where 0 only
+    // reacts to inertia and gravity. A damping of 1 kills particles velocity.
+    // Returns false if a chain is invalid (tip isn't a strict descendant of
+    // root) or if settings ranges are too small, leaving the context empty.
+    bool Setup(const Skeleton& _skeleton, span<const Chain> _chains,
+               span<const float> _stiffness, span<const float> _damping);
+
+    // Resets particles to the animated pose on next job run. This must be
+    // called when the character is teleported.
+    void Reset() { reset_ = true; }
+
+    // Gets the number of chains.
+    int num_chains() const { return num_chains_; }
+
+    // Gets the number of joints of the skeleton context was setup for.
+    int num_joints() const { return num_joints_; }
+
+    // Gets per joint dirty mask, flagging chains roots, to be used as
+    // LocalToModelJob::dirty after the job run.
+    span<const uint8_t> dirty() const { return make_span(dirty_); }
+
+   private:
+    friend struct SpringBoneJob;
+
+    // Simulates a depth level of a SoA group of chains. Lanes joint index is
+    // -1 for chains that are shorter than this depth.
+    struct Slot;
+
+    // Releases all data.
+    void Clear();
+
+    // Slots, ordered by group, and by depth within groups.
+    Slot* slots_;
+    int num_slots_;
+
+    // Group begin slot, num_groups + 1 entries.
+    ozz::vector<int> groups_;
+
+    ozz::vector<uint8_t> dirty_;
+    int num_chains_;
+    int num_joints_;
+    bool reset_;
+  };
+
+  // Default constructor, initializes default values.
+  SpringBoneJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if context is nullptr or empty.
+  // -if models range is smaller than context skeleton number of joints.
+  // -if locals range is smaller than context skeleton number of SoA joints.
+  // -if dt is negative.
+  bool Validate() const;
+
+  // Runs job's simulation task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if job is not valid. See Validate() function.
+  bool Run() const;
+
+  // Simulation context, updated by the job.
+  Context* context;
+
+  // Time step, in seconds.
+  float dt;
+
+  // Gravity acceleration, in models space. Default is zero.
+  math::Float3 gravity;
+
+  // Animated model-space matrices, input.
+  span<const math::Float4x4> models;
+
+  // Local-space transforms, whose chains joints rotations are corrected.
+  span<math::SoaTransform> locals;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SPRING_BONE_JOB_H_
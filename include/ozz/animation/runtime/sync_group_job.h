@@ -0,0 +1,138 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SYNC_GROUP_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SYNC_GROUP_JOB_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares runtime objects.
+class FloatTrack;
+
+// Extracts sync markers of a clip from _track: the ratios in [0,1[ at which
+// _track value rises through _threshold (ie: foot plants authored as a float
+// track), in increasing order. See TrackTriggeringJob for edges detection.
+// Up to _markers.size() markers are written to _markers. Returns the total
+// number of markers found, which can thus be bigger than _markers size, or -1
+// if _track is quantized (edges can't be detected without an index).
+OZZ_ANIMATION_DLL int ExtractSyncMarkers(const FloatTrack& _track,
+                                         float _threshold,
+                                         span<float> _markers);
+
+// Defines a clip of a synchronization group.
+struct OZZ_ANIMATION_DLL SyncClip {
+  // Default constructor, initializes default values.
+  SyncClip();
+
+  // Sync markers ratios in the unit interval [0,1[, strictly increasing. All
+  // the clips of a group must have the same number of markers, so that marker
+  // i of a clip matches marker i of the others (ie: left foot plant, right
+  // foot plant).
+  span<const float> markers;
+
+  // Clip (animation) duration, in seconds. Must be greater than 0.
+  float duration;
+
+  // Blending weight of the clip. The clip with the highest weight leads the
+  // group.
+  float weight;
+};
+
+// Defines a synchronization group, whose clips are played in phase.
+struct OZZ_ANIMATION_DLL SyncGroup {
+  // Default constructor, initializes default values.
+  SyncGroup();
+
+  // Range of the group clips in SyncGroupJob::clips.
+  int clips_begin;
+  int num_clips;
+
+  // Playback speed coefficient, applied to the leader. Negative values play
+  // the group backward.
+  float playback_speed;
+
+  // Group phase, in range [0,n[ where n is the number of markers per clip.
+  // Integer part is the index of the marker the group has last passed,
+  // fractional part the progress toward the next marker. It's the group state,
+  // updated by SyncGroupJob.
+  float phase;
+
+  // Index (in SyncGroupJob::clips) of the clip that led the group during the
+  // last update. Output of SyncGroupJob.
+  int leader;
+};
+
+// Advances synchronization groups, aka clips of different durations (or
+// cadences) that must be played in phase for locomotion blending. In each
+// group, the clip with the highest weight is the leader: it plays at its own
+// speed, advancing the group phase from marker to marker. Other clips
+// (followers) are matched to the leader phase: each one is at the same
+// relative position between its own markers. The job outputs the resulting
+// sampling ratio of every clip, that can be used by SampleBlendingJob,
+// CrowdSamplingJob...
+// The job doesn't allocate and processes all groups in a single pass, so it can
+// update thousands of groups per frame.
+// The job does not own the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL SyncGroupJob {
+  // Default constructor, initializes default values.
+  SyncGroupJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any group clips range is empty or outside of clips range.
+  // -if any clip duration isn't greater than 0, or if its markers are empty,
+  // not strictly increasing or outside of the unit interval [0,1[.
+  // -if clips of a group don't have the same number of markers.
+  // -if ratios range is smaller than clips range.
+  bool Validate() const;
+
+  // Runs job's update task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time elapsed since last update, in seconds.
+  float delta_time;
+
+  // Clips of all the groups.
+  span<const SyncClip> clips;
+
+  // Groups to update, input and output.
+  span<SyncGroup> groups;
+
+  // Output sampling ratios, one per clip.
+  span<float> ratios;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SYNC_GROUP_JOB_H_
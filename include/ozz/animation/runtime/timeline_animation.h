@@ -0,0 +1,193 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_TIMELINE_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_TIMELINE_ANIMATION_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace memory {
+class Allocator;
+}  // namespace memory
+namespace animation {
+
+// Forward declares the TimelineAnimationBuilder, used to instantiate a
+// TimelineAnimation.
+namespace offline {
+class TimelineAnimationBuilder;
+}
+
+// Forward declaration of key frame's type.
+struct TimelineFloat3Key;
+struct TimelineQuaternionKey;
+
+// Runtime skeletal animation clip whose tracks are keyed on a shared timeline,
+// ie: sampled or baked clips where most tracks are keyed at the same frames.
+// Instead of storing a ratio and a track index with every key like Animation
+// does, frames ratios are stored once in a shared row, and each track stores a
+// presence bit per frame and channel (translation, rotation, scale). Key values
+// are packed per track, in frame order, so a track key index is the rank of its
+// presence bit. This reduces key metadata to a bit per frame and track, and
+// allows TimelineSamplingJob to advance all tracks at once, only when the
+// sampling ratio crosses a frame. Key values are compressed the same way as
+// Animation ones.
+// TimelineAnimation is built from a RawAnimation with a
+// TimelineAnimationBuilder, and sampled with a TimelineSamplingJob.
+class OZZ_ANIMATION_DLL TimelineAnimation {
+ public:
+  // Builds a default animation. Animation buffers are allocated with
+  // _allocator when the animation is built or loaded, nullptr meaning the
+  // default allocator.
+  explicit TimelineAnimation(memory::Allocator* _allocator = nullptr);
+
+  // Allow move.
+  TimelineAnimation(TimelineAnimation&& _other);
+  TimelineAnimation& operator=(TimelineAnimation&& _other);
+
+  // Disables copy and assignation.
+  TimelineAnimation(TimelineAnimation const&) = delete;
+  void operator=(TimelineAnimation const&) = delete;
+
+  ~TimelineAnimation();
+
+  // Gets the animation clip duration.
+  float duration() const { return duration_; }
+
+  // Gets the number of animated tracks.
+  int num_tracks() const { return num_tracks_; }
+
+  // Gets the number of animated tracks (aligned to 4 * SoA tracks).
+  int num_soa_tracks() const { return (num_tracks_ + 3) / 4; }
+
+  // Gets the number of frames of the shared timeline.
+  int num_frames() const { return static_cast<int>(ratios_.size()); }
+
+  // Gets the number of 32 bits presence words per track.
+  int num_presence_words() const { return (num_frames() + 31) / 32; }
+
+  // Frames ratios (0 is the beginning of the animation, 1 is the end), sorted
+  // in increasing order.
+  span<const float> ratios() const { return ratios_; }
+
+  // Per channel presence bits, num_presence_words() words per track (aligned
+  // to 4 * SoA tracks), track major. Bit _f of a track is set if the track has
+  // a key at frame _f. First and last frames are always keyed.
+  span<const uint32_t> translation_presence() const {
+    return translation_presence_;
+  }
+  span<const uint32_t> rotation_presence() const { return rotation_presence_; }
+  span<const uint32_t> scale_presence() const { return scale_presence_; }
+
+  // Per channel index of the first key value of each track, plus the total
+  // number of keys.
+  span<const uint32_t> translation_offsets() const {
+    return translation_offsets_;
+  }
+  span<const uint32_t> rotation_offsets() const { return rotation_offsets_; }
+  span<const uint32_t> scale_offsets() const { return scale_offsets_; }
+
+  // Per channel key values, track major and sorted by frame.
+  span<const TimelineFloat3Key> translations() const { return translations_; }
+  span<const TimelineQuaternionKey> rotations() const { return rotations_; }
+  span<const TimelineFloat3Key> scales() const { return scales_; }
+
+  // Returns the allocator used for animation buffers, nullptr for the default
+  // allocator.
+  memory::Allocator* allocator() const { return allocator_; }
+
+  // Get the estimated animation's size in bytes.
+  size_t size() const;
+
+  // Get animation name.
+  const char* name() const { return name_ ? name_ : ""; }
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // TimelineAnimationBuilder class is allowed to allocate an animation.
+  friend class offline::TimelineAnimationBuilder;
+
+  // Internal allocation and destruction functions.
+  struct AllocatorParams {
+    size_t name_len;
+    int num_tracks;
+    size_t num_frames;
+    size_t translation_count;
+    size_t rotation_count;
+    size_t scale_count;
+  };
+  void Allocate(const AllocatorParams& _params);
+  void Deallocate();
+
+  // Checks presence bits, offsets and ratios consistency.
+  bool Validate() const;
+
+  // Duration of the animation clip.
+  float duration_;
+
+  // The number of joint tracks. Can differ from the data stored in presence
+  // and offsets buffers, as they're SoA aligned.
+  int num_tracks_;
+
+  // Shared frames ratios.
+  span<float> ratios_;
+
+  // Presence bits, per channel.
+  span<uint32_t> translation_presence_;
+  span<uint32_t> rotation_presence_;
+  span<uint32_t> scale_presence_;
+
+  // First key value index of each track, per channel.
+  span<uint32_t> translation_offsets_;
+  span<uint32_t> rotation_offsets_;
+  span<uint32_t> scale_offsets_;
+
+  // Key values, per channel.
+  span<TimelineFloat3Key> translations_;
+  span<TimelineQuaternionKey> rotations_;
+  span<TimelineFloat3Key> scales_;
+
+  // Animation name.
+  char* name_;
+
+  // Allocator used for animation buffers, nullptr for the default allocator.
+  memory::Allocator* allocator_;
+};
+}  // namespace animation
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::TimelineAnimation)
+OZZ_IO_TYPE_TAG("ozz-timeline_animation", animation::TimelineAnimation)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_TIMELINE_ANIMATION_H_
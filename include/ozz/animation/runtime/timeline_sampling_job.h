@@ -0,0 +1,181 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_TIMELINE_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_TIMELINE_SAMPLING_JOB_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math {
+struct SoaTransform;
+}
+
+namespace animation {
+
+// Forward declares the animation type to sample.
+class TimelineAnimation;
+
+namespace internal {
+// Forward declares context internal structures.
+struct TimelineInterpSoaFloat3;
+struct TimelineInterpSoaQuaternion;
+}  // namespace internal
+
+// Samples a TimelineAnimation at a given time ratio in the unit interval [0,1]
+// (where 0 is the beginning of the animation, 1 is the end), to output the
+// corresponding posture in local-space. The result is the same as sampling the
+// matching Animation with a SamplingJob.
+// TimelineSamplingJob uses a context (aka TimelineSamplingJob::Context) that
+// stores a single frame cursor shared by all tracks, and each track keys
+// cursor. As long as the ratio remains in the same frame interval, sampling
+// only interpolates cached keys. When the ratio crosses frames, tracks whose
+// right key is passed are advanced all at once, searching their next key in
+// the presence bits. Playing backward resets the context.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_ANIMATION_DLL TimelineSamplingJob {
+  // Default constructor, initializes default values.
+  TimelineSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false
+  // otherwise:
+  // -if any input pointer is nullptr
+  // -if output range is invalid.
+  // -if context is too small for animation tracks.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time ratio in the unit interval [0,1] used to sample animation (where 0 is
+  // the beginning of the animation, 1 is the end). This ratio is clamped before
+  // job execution in order to resolves any approximation issue on range
+  // bounds.
+  float ratio;
+
+  // The animation to sample.
+  const TimelineAnimation* animation;
+
+  // Forward declares the context object used by the TimelineSamplingJob.
+  class Context;
+
+  // A context object that must be big enough to sample *this animation.
+  Context* context;
+
+  // Job output.
+  // The output range to be filled with sampled joints during job execution.
+  // If there are less joints in the animation compared to the output range,
+  // then remaining SoaTransform are left unchanged.
+  // If there are more joints in the animation, then the last joints are not
+  // sampled.
+  span<ozz::math::SoaTransform> output;
+};
+
+// Declares the context object used by the workload to take advantage of the
+// frame coherency of animation sampling.
+class OZZ_ANIMATION_DLL TimelineSamplingJob::Context {
+ public:
+  // Constructs an empty context. The context needs to be resized with the
+  // appropriate number of tracks before it can be used with a
+  // TimelineSamplingJob.
+  Context();
+
+  // Constructs a context that can be used to sample any animation with at most
+  // _max_tracks tracks. _num_tracks is internally aligned to a multiple of
+  // soa size, which means max_tracks() can return a different (but bigger)
+  // value than _max_tracks.
+  explicit Context(int _max_tracks);
+
+  // Disables copy and assignation.
+  Context(Context const&) = delete;
+  Context& operator=(Context const&) = delete;
+
+  // Deallocates context.
+  ~Context();
+
+  // Resize the number of joints that the context can support.
+  // This also implicitly invalidate the context.
+  void Resize(int _max_tracks);
+
+  // Invalidate the context.
+  // The TimelineSamplingJob automatically invalidates a context when required
+  // during sampling, based on the animation address and sampling time ratio.
+  // It is recommended to manually invalidate a context when it is known that
+  // this context will not be used for with an animation again.
+  void Invalidate();
+
+  // The maximum number of tracks that the context can handle.
+  int max_tracks() const { return max_soa_tracks_ * 4; }
+  int max_soa_tracks() const { return max_soa_tracks_; }
+
+ private:
+  friend struct TimelineSamplingJob;
+
+  // Steps the context to _ratio frame, resetting it if _animation differs from
+  // the cached one or if _ratio is before the current frame. Tracks whose
+  // right key is before or at the new frame are advanced, and their SoA entry
+  // flagged as outdated.
+  void Step(const TimelineAnimation& _animation, float _ratio);
+
+  // Deallocate everything.
+  void Deallocate();
+
+  // The animation this context refers to. nullptr means that the context is
+  // invalid.
+  const TimelineAnimation* animation_;
+
+  // Current frame of the shared timeline, the last one before or at the
+  // sampling ratio (excluding the last frame). -1 when the context is invalid.
+  int frame_;
+
+  // Max number of SoA tracks that the context can handle.
+  int max_soa_tracks_;
+
+  // Soa interpolation keys.
+  internal::TimelineInterpSoaFloat3* soa_translations_;
+  internal::TimelineInterpSoaQuaternion* soa_rotations_;
+  internal::TimelineInterpSoaFloat3* soa_scales_;
+
+  // Per channel (translation, rotation, scale) and per track cursors: left
+  // key frame, right key frame and left key value index.
+  int* cursors_;
+
+  // Per channel and per SoA track flags, set when SoA interpolation keys must
+  // be decompressed again.
+  uint8_t* outdated_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_TIMELINE_SAMPLING_JOB_H_
@@ -36,6 +36,9 @@
 #include "ozz/base/span.h"
 
 namespace ozz {
+namespace memory {
+class Allocator;
+}  // namespace memory
 namespace animation {
 
 // Forward declares the TrackBuilder, used to instantiate a Track.
@@ -58,7 +61,9 @@ class OZZ_ANIMATION_DLL Track {
  public:
   typedef _ValueType ValueType;
 
-  Track();
+  // Builds a default track. Track buffers are allocated with _allocator when
+  // the track is built or loaded, nullptr meaning the default allocator.
+  explicit Track(memory::Allocator* _allocator = nullptr);
 
   // Allow move.
   Track(Track&& _other);
@@ -71,10 +76,38 @@ class OZZ_ANIMATION_DLL Track {
   ~Track();
 
   // Keyframe accessors.
+  // Keyframes ratios and values are either stored as floats (ratios() and
+  // values()), or quantized to 16 bits (compact_ratios() and
+  // compact_values()), according to TrackBuilder::quantize option. Only one of
+  // the two storages is used, the other one is empty.
   span<const float> ratios() const { return ratios_; }
   span<const _ValueType> values() const { return values_; }
   span<const uint8_t> steps() const { return steps_; }
 
+  // Quantized keyframes accessors. compact_ratios() stores ratios * 65535.
+  // compact_values() stores kComponents values per keyframe, each one being
+  // dequantized as quantization_offset() + value * quantization_scale(), per
+  // component.
+  enum { kComponents = sizeof(_ValueType) / sizeof(float) };
+  bool quantized() const { return !compact_ratios_.empty(); }
+  span<const uint16_t> compact_ratios() const { return compact_ratios_; }
+  span<const uint16_t> compact_values() const { return compact_values_; }
+  const math::Float4& quantization_offset() const {
+    return quantization_offset_;
+  }
+  const math::Float4& quantization_scale() const {
+    return quantization_scale_;
+  }
+
+  // Gets the number of keyframes, whatever the storage.
+  size_t num_keys() const {
+    return quantized() ? compact_ratios_.size() : ratios_.size();
+  }
+
+  // Returns the allocator used for track buffers, nullptr for the default
+  // allocator.
+  memory::Allocator* allocator() const { return allocator_; }
+
   // Get the estimated track's size in bytes.
   size_t size() const;
 
@@ -86,25 +119,72 @@ class OZZ_ANIMATION_DLL Track {
   void Save(ozz::io::OArchive& _archive) const;
   void Load(ozz::io::IArchive& _archive, uint32_t _version);
 
+  // Defines the alignment required for track images.
+  enum { kImageAlignment = 16 };
+
+  // Track images are a relocatable binary layout of the track, which can be
+  // used in place without any copy or allocation, see FromImage(). Like
+  // animation images, they use platform native endianness.
+  // Gets the size of *this track image, in bytes.
+  size_t image_size() const;
+
+  // Writes *this track image to _image, which must be image_size() bytes big
+  // at least, and aligned to kImageAlignment.
+  // Returns false if _image is too small or misaligned.
+  bool ToImage(span<byte> _image) const;
+
+  // Sets *this track to use _image data in place. Track keeps pointers to
+  // _image, which must be aligned to kImageAlignment and must remain valid and
+  // unchanged for the track lifetime (or until it's loaded or rebuilt).
+  // Returns false if _image isn't a valid image of this track type for this
+  // platform (endianness, version), in which case track is left empty.
+  bool FromImage(span<const byte> _image);
+
  private:
   // TrackBuilder class is allowed to allocate a Track.
   friend class offline::TrackBuilder;
 
-  // Internal destruction function.
-  void Allocate(size_t _keys_count, size_t _name_len);
+  // Internal allocation and destruction functions. Allocate reuses current
+  // buffer if it's big enough, so that a track can be rebuilt in place without
+  // any allocation.
+  void Allocate(size_t _keys_count, size_t _name_len, bool _quantized);
   void Deallocate();
 
+  // Computes the size of the buffer required to store track data, and
+  // distributes _buffer to track data spans.
+  static size_t BufferSize(size_t _keys_count, size_t _name_len,
+                           bool _quantized);
+  void Bind(size_t _keys_count, size_t _name_len, bool _quantized,
+            span<byte> _buffer);
+
   // Keyframe ratios (0 is the beginning of the track, 1 is the end).
   span<float> ratios_;
 
   // Keyframe values.
   span<_ValueType> values_;
 
+  // Quantized keyframe ratios and values, used instead of ratios_ and values_
+  // for quantized tracks.
+  span<uint16_t> compact_ratios_;
+  span<uint16_t> compact_values_;
+
+  // Quantized values dequantization range, per component.
+  math::Float4 quantization_offset_;
+  math::Float4 quantization_scale_;
+
   // Keyframe modes (1 bit per key): 1 for step, 0 for linear.
   span<uint8_t> steps_;
 
   // Track name.
   char* name_ = nullptr;
+
+  // Allocator used for allocation_, nullptr for the default allocator.
+  memory::Allocator* allocator_;
+
+  // Buffer allocated for track data, and its size. nullptr if track data are
+  // stored in an image.
+  void* allocation_;
+  size_t allocation_size_;
 };
 
 // Definition of operations policies per track value type.
@@ -151,24 +231,39 @@ inline math::Quaternion TrackPolicy<math::Quaternion>::identity() {
 }  // namespace internal
 
 // Runtime track data structure instantiation.
-class OZZ_ANIMATION_DLL FloatTrack : public internal::Track<float> {};
-class OZZ_ANIMATION_DLL Float2Track : public internal::Track<math::Float2> {};
-class OZZ_ANIMATION_DLL Float3Track : public internal::Track<math::Float3> {};
-class OZZ_ANIMATION_DLL Float4Track : public internal::Track<math::Float4> {};
+class OZZ_ANIMATION_DLL FloatTrack : public internal::Track<float> {
+ public:
+  using internal::Track<float>::Track;
+};
+class OZZ_ANIMATION_DLL Float2Track : public internal::Track<math::Float2> {
+ public:
+  using internal::Track<math::Float2>::Track;
+};
+class OZZ_ANIMATION_DLL Float3Track : public internal::Track<math::Float3> {
+ public:
+  using internal::Track<math::Float3>::Track;
+};
+class OZZ_ANIMATION_DLL Float4Track : public internal::Track<math::Float4> {
+ public:
+  using internal::Track<math::Float4>::Track;
+};
 class OZZ_ANIMATION_DLL QuaternionTrack
-    : public internal::Track<math::Quaternion> {};
+    : public internal::Track<math::Quaternion> {
+ public:
+  using internal::Track<math::Quaternion>::Track;
+};
 
 }  // namespace animation
 namespace io {
-OZZ_IO_TYPE_VERSION(1, animation::FloatTrack)
+OZZ_IO_TYPE_VERSION(2, animation::FloatTrack)
 OZZ_IO_TYPE_TAG("ozz-float_track", animation::FloatTrack)
-OZZ_IO_TYPE_VERSION(1, animation::Float2Track)
+OZZ_IO_TYPE_VERSION(2, animation::Float2Track)
 OZZ_IO_TYPE_TAG("ozz-float2_track", animation::Float2Track)
-OZZ_IO_TYPE_VERSION(1, animation::Float3Track)
+OZZ_IO_TYPE_VERSION(2, animation::Float3Track)
 OZZ_IO_TYPE_TAG("ozz-float3_track", animation::Float3Track)
-OZZ_IO_TYPE_VERSION(1, animation::Float4Track)
+OZZ_IO_TYPE_VERSION(2, animation::Float4Track)
 OZZ_IO_TYPE_TAG("ozz-float4_track", animation::Float4Track)
-OZZ_IO_TYPE_VERSION(1, animation::QuaternionTrack)
+OZZ_IO_TYPE_VERSION(2, animation::QuaternionTrack)
 OZZ_IO_TYPE_TAG("ozz-quat_track", animation::QuaternionTrack)
 }  // namespace io
 }  // namespace ozz
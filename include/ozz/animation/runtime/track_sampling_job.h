@@ -29,9 +29,14 @@
 #define OZZ_OZZ_ANIMATION_RUNTIME_TRACK_SAMPLING_JOB_H_
 
 #include "ozz/animation/runtime/export.h"
+#include "ozz/animation/runtime/multi_float_track.h"
 #include "ozz/animation/runtime/track.h"
+#include "ozz/base/span.h"
 
 namespace ozz {
+namespace math {
+struct SoaQuaternion;
+}
 namespace animation {
 
 namespace internal {
@@ -61,6 +66,42 @@ struct TrackSamplingJob {
   // Job output.
   typename _Track::ValueType* result;
 };
+
+// BatchTrackSamplingJob internal implementation. See *BatchTrackSamplingJob
+// for more details.
+template <typename _Track>
+struct BatchTrackSamplingJob {
+  typedef typename _Track::ValueType ValueType;
+
+  BatchTrackSamplingJob();
+
+  // Validates all parameters:
+  // - tracks can't be null.
+  // - results must be at least as big as tracks.
+  // - cursors must be empty or at least as big as tracks.
+  bool Validate() const;
+
+  // Validates and executes sampling.
+  bool Run() const;
+
+  // Ratio used to sample all tracks, clamped in range [0,1] before job
+  // execution.
+  float ratio;
+
+  // Tracks to sample.
+  span<const _Track* const> tracks;
+
+  // Optional per track cursors, used to speed up keyframes lookup.
+  // Cursors store the index of the last keyframe used for each track, so that
+  // the next lookup only needs to step forward from there when ratio
+  // increases. They must be zero initialized when a track is first sampled,
+  // and can then be reused across updates, whatever the ratio. Without
+  // cursors, keyframes are binary searched.
+  span<uint32_t> cursors;
+
+  // Job output, one value per track.
+  span<ValueType> results;
+};
 }  // namespace internal
 
 // Track sampling job implementation. Track sampling allows to query a track
@@ -77,6 +118,81 @@ struct OZZ_ANIMATION_DLL Float4TrackSamplingJob
 struct OZZ_ANIMATION_DLL QuaternionTrackSamplingJob
     : public internal::TrackSamplingJob<QuaternionTrack> {};
 
+// Batched track sampling job implementation. Samples many tracks of the same
+// type at the same ratio in a single call, ie: all user-channel tracks of a
+// character. Optional per track cursors make monotonic playback lookups
+// constant time, instead of a binary search per track and update.
+struct OZZ_ANIMATION_DLL BatchFloatTrackSamplingJob
+    : public internal::BatchTrackSamplingJob<FloatTrack> {};
+struct OZZ_ANIMATION_DLL BatchFloat2TrackSamplingJob
+    : public internal::BatchTrackSamplingJob<Float2Track> {};
+struct OZZ_ANIMATION_DLL BatchFloat3TrackSamplingJob
+    : public internal::BatchTrackSamplingJob<Float3Track> {};
+struct OZZ_ANIMATION_DLL BatchFloat4TrackSamplingJob
+    : public internal::BatchTrackSamplingJob<Float4Track> {};
+struct OZZ_ANIMATION_DLL BatchQuaternionTrackSamplingJob
+    : public internal::BatchTrackSamplingJob<QuaternionTrack> {};
+
+// Samples all channels of a MultiFloatTrack at the same ratio, with a single
+// keyframes lookup. Channels are interpolated 4 at a time.
+struct OZZ_ANIMATION_DLL MultiFloatTrackSamplingJob {
+  MultiFloatTrackSamplingJob();
+
+  // Validates job parameters:
+  // - track can't be null.
+  // - results must be at least as big as track number of channels.
+  bool Validate() const;
+
+  // Validates and executes sampling.
+  bool Run() const;
+
+  // Ratio used to sample track, clamped in range [0,1] before job execution.
+  float ratio;
+
+  // Track to sample.
+  const MultiFloatTrack* track;
+
+  // Optional cursor, used to speed up keyframes lookup. See
+  // BatchTrackSamplingJob::cursors.
+  uint32_t* cursor;
+
+  // Job output, one value per channel.
+  span<float> results;
+};
+
+// Samples many quaternion tracks at the same ratio, writing results directly
+// in SoA format, ie: ready to feed a SoaTransform or a blending job. Tracks are
+// processed by groups of 4 (one per lane): keyframes are still looked up per
+// track, but interpolation and normalization run once per group with SIMD
+// instructions.
+struct OZZ_ANIMATION_DLL SoaQuaternionTrackSamplingJob {
+  SoaQuaternionTrackSamplingJob();
+
+  // Validates job parameters:
+  // - tracks can't be null.
+  // - results must be at least as big as tracks SoA count, ie: (tracks + 3)/4.
+  // - cursors must be empty or at least as big as tracks.
+  bool Validate() const;
+
+  // Validates and executes sampling.
+  bool Run() const;
+
+  // Ratio used to sample all tracks, clamped in range [0,1] before job
+  // execution.
+  float ratio;
+
+  // Tracks to sample.
+  span<const QuaternionTrack* const> tracks;
+
+  // Optional per track cursors, used to speed up keyframes lookup. See
+  // BatchTrackSamplingJob::cursors.
+  span<uint32_t> cursors;
+
+  // Job output. Track i is written to lane i%4 of results[i/4]. Lanes beyond
+  // tracks count are set to identity.
+  span<math::SoaQuaternion> results;
+};
+
 }  // namespace animation
 }  // namespace ozz
 #endif  // OZZ_OZZ_ANIMATION_RUNTIME_TRACK_SAMPLING_JOB_H_
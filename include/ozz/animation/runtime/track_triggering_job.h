@@ -29,12 +29,15 @@
 #define OZZ_OZZ_ANIMATION_RUNTIME_TRACK_TRIGGERING_JOB_H_
 
 #include "ozz/animation/runtime/export.h"
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/platform.h"
+#include "ozz/base/span.h"
 
 namespace ozz {
 namespace animation {
 
 class FloatTrack;
+class TrackEdgeIndex;
 
 // Track edge triggering job implementation. Edge triggering wording refers to
 // signal processing, where a signal edge is a transition from low to high or
@@ -47,6 +50,10 @@ class FloatTrack;
 // track types isn't possible.
 // The job execution actually performs a lazy evaluation of edges. It builds an
 // iterator that will process the next edge on each call to ++ operator.
+// Edges can alternatively be read from a TrackEdgeIndex, precomputed for a
+// track and a threshold. The job then binary searches the first edge of the
+// range instead of testing every keyframe, which is faster for long tracks or
+// short ranges.
 struct OZZ_ANIMATION_DLL TrackTriggeringJob {
   TrackTriggeringJob();
 
@@ -74,9 +81,13 @@ struct OZZ_ANIMATION_DLL TrackTriggeringJob {
   // equal than the threshold.
   float threshold;
 
-  // Track to sample.
+  // Track to sample. Quantized tracks aren't supported.
   const FloatTrack* track;
 
+  // Optional edges index. If set, edges are read from the index, and track and
+  // threshold members are ignored (they can be left unset).
+  const TrackEdgeIndex* index;
+
   // Job output iterator.
   class Iterator;
   Iterator* iterator;
@@ -153,6 +164,78 @@ class OZZ_ANIMATION_DLL TrackTriggeringJob::Iterator {
   Edge edge_;
 };
 
+// Detects edges of many tracks and ranges at once, typically all the event
+// tracks of a crowd of characters for a frame. Every query is processed with
+// the same rules as TrackTriggeringJob, but edges are written to a single
+// output buffer instead of being lazily evaluated by an iterator. Threshold
+// crossings are tested 4 keyframes at a time with SIMD instructions.
+struct OZZ_ANIMATION_DLL BatchTrackTriggeringJob {
+  BatchTrackTriggeringJob();
+
+  // Validates job parameters:
+  // - every query track must be non-null and not quantized.
+  // - counts must be at least as big as queries.
+  bool Validate() const;
+
+  // Validates and executes job. Returns false if validation failed, or if
+  // edges buffer is too small to store all detected edges. In the latter case,
+  // edges that fit in the buffer are written and counted, and the count of the
+  // remaining queries is 0.
+  bool Run() const;
+
+  // Defines a track and a range to detect edges for. from, to and threshold
+  // have the same meaning as TrackTriggeringJob members.
+  struct Query {
+    const FloatTrack* track;
+    float from;
+    float to;
+    float threshold;
+  };
+
+  // Queries to process.
+  span<const Query> queries;
+
+  // Job output edges. Edges of each query are written contiguously, after the
+  // edges of the previous query, and in the order a TrackTriggeringJob
+  // iterator would yield them.
+  span<TrackTriggeringJob::Edge> edges;
+
+  // Job output, number of edges written for each query.
+  span<uint32_t> counts;
+};
+
+// Precomputes the edges of a FloatTrack for a given threshold, so that
+// TrackTriggeringJob doesn't need to detect them when it's run. Edges are
+// stored in forward order, in the track [0,1] ratio range, exactly as
+// TrackTriggeringJob would detect them from the track.
+// The index doesn't reference the track, it can be built once at loading time
+// and shared by all instances playing the track.
+class OZZ_ANIMATION_DLL TrackEdgeIndex {
+ public:
+  TrackEdgeIndex();
+
+  // Builds the index for _track and _threshold, with the same edge detection
+  // rules as TrackTriggeringJob.
+  // Returns false if _track is quantized, in which case the index is left
+  // empty.
+  bool Build(const FloatTrack& _track, float _threshold);
+
+  // Returns the threshold used to build the index.
+  float threshold() const { return threshold_; }
+
+  // Returns edges, sorted by ratio, for a forward traversal of the track.
+  span<const TrackTriggeringJob::Edge> edges() const {
+    return make_span(edges_);
+  }
+
+ private:
+  // Threshold used to build the index.
+  float threshold_;
+
+  // Edges sorted by ratio.
+  ozz::vector<TrackTriggeringJob::Edge> edges_;
+};
+
 // end() job function inline implementation.
 inline TrackTriggeringJob::Iterator TrackTriggeringJob::end() const {
   return Iterator(this, Iterator::End());
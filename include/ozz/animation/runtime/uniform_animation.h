@@ -0,0 +1,153 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_UNIFORM_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_UNIFORM_ANIMATION_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/base/io/archive_traits.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace memory {
+class Allocator;
+}  // namespace memory
+namespace animation {
+
+// Forward declares the UniformAnimationBuilder, used to instantiate a
+// UniformAnimation.
+namespace offline {
+class UniformAnimationBuilder;
+}
+
+// Runtime skeletal animation clip whose tracks are uniformly sampled, ie:
+// dense motion capture clips that barely decimate, or clips queried at random
+// ratios (motion matching, scrubbing...). Every track stores a value for every
+// frame, so frames are found by direct indexing, and sampling is a lerp
+// between two frames without any context nor cursor replay.
+// Frames are stored in SoA, frame major: each SoA track of a frame stores
+// kComponents * 4 (10 components of 4 tracks: translation xyz, rotation xyzw
+// and scale xyz) 16 bits values. They're quantized over their range for the
+// whole clip, which is stored per SoA track and component as a minimum and a
+// step. Consecutive rotation frames are in the same hemisphere, so they can
+// be interpolated directly.
+// UniformAnimation is built from a RawAnimation with a
+// UniformAnimationBuilder, and sampled with a UniformSamplingJob.
+class OZZ_ANIMATION_DLL UniformAnimation {
+ public:
+  // Number of quantized components per track and frame.
+  enum { kComponents = 10 };
+
+  // Builds a default animation. Animation buffers are allocated with
+  // _allocator when the animation is built or loaded, nullptr meaning the
+  // default allocator.
+  explicit UniformAnimation(memory::Allocator* _allocator = nullptr);
+
+  // Allow move.
+  UniformAnimation(UniformAnimation&& _other);
+  UniformAnimation& operator=(UniformAnimation&& _other);
+
+  // Disables copy and assignation.
+  UniformAnimation(UniformAnimation const&) = delete;
+  void operator=(UniformAnimation const&) = delete;
+
+  ~UniformAnimation();
+
+  // Gets the animation clip duration.
+  float duration() const { return duration_; }
+
+  // Gets the number of animated tracks.
+  int num_tracks() const { return num_tracks_; }
+
+  // Gets the number of animated tracks (aligned to 4 * SoA tracks).
+  int num_soa_tracks() const { return (num_tracks_ + 3) / 4; }
+
+  // Gets the number of frames, uniformly spread over the unit ratio interval.
+  // Frame _f ratio is _f / (num_frames() - 1).
+  int num_frames() const { return num_frames_; }
+
+  // Per SoA track and component, the minimum value (4 floats) and the
+  // quantization step (4 floats), so a component value is min + step * q.
+  span<const float> ranges() const { return ranges_; }
+
+  // Quantized values, frame major, then SoA track major, then component
+  // major.
+  span<const uint16_t> frames() const { return frames_; }
+
+  // Returns the allocator used for animation buffers, nullptr for the default
+  // allocator.
+  memory::Allocator* allocator() const { return allocator_; }
+
+  // Get the estimated animation's size in bytes.
+  size_t size() const;
+
+  // Get animation name.
+  const char* name() const { return name_ ? name_ : ""; }
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // UniformAnimationBuilder class is allowed to allocate an animation.
+  friend class offline::UniformAnimationBuilder;
+
+  // Internal allocation and destruction functions.
+  void Allocate(size_t _name_len, int _num_tracks, int _num_frames);
+  void Deallocate();
+
+  // Duration of the animation clip.
+  float duration_;
+
+  // The number of joint tracks. Can differ from the data stored in ranges and
+  // frames buffers, as they're SoA aligned.
+  int num_tracks_;
+
+  // The number of frames.
+  int num_frames_;
+
+  // Quantization ranges, see ranges().
+  span<float> ranges_;
+
+  // Quantized values, see frames().
+  span<uint16_t> frames_;
+
+  // Animation name.
+  char* name_;
+
+  // Allocator used for animation buffers, nullptr for the default allocator.
+  memory::Allocator* allocator_;
+};
+}  // namespace animation
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::UniformAnimation)
+OZZ_IO_TYPE_TAG("ozz-uniform_animation", animation::UniformAnimation)
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_UNIFORM_ANIMATION_H_
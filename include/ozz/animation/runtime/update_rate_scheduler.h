@@ -0,0 +1,165 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_UPDATE_RATE_SCHEDULER_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_UPDATE_RATE_SCHEDULER_H_
+
+#include "ozz/animation/runtime/export.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace math {
+struct Float4x4;
+struct SoaTransform;
+}  // namespace math
+namespace animation {
+
+// Forward declares runtime objects.
+class Animation;
+class Skeleton;
+
+// Amortizes animation of big crowds by updating each instance at its own
+// rate, aka update period in frames: 1 updates every frame, 2 every other
+// frame... Far or unimportant characters are thus sampled (and converted to
+// model-space) only once every few frames, while still being displayed every
+// frame with a model-space pose interpolated between their two last updates.
+// Instances sharing the same period are spread over the period frames (they
+// are given different phases), so that the cost of a frame is flat: about
+// num_instances / period updates per frame for a given period.
+// Interpolation is a cheap component-wise lerp of model-space matrices, which
+// slightly scales joints rotating fast between updates. It delays poses by up
+// to period - 1 frames, the pose of the last update being reached right
+// before the next one. Both are unnoticeable at the distances such periods
+// are meant for. A period of 1 outputs exactly the sampled pose.
+// Typical usage is, every frame:
+// - Update instances animation and period (see PeriodFromDistance()) when
+//   they change.
+// - Update() with every instance ratio.
+// - Read each instance pose with models().
+// The scheduler owns all its buffers, allocated once by Allocate(), so that
+// no allocation happens during a frame.
+class OZZ_ANIMATION_DLL UpdateRateScheduler {
+ public:
+  // Maximum supported update period, in frames.
+  enum { kMaxPeriod = 16 };
+
+  UpdateRateScheduler();
+
+  // Disables copy and assignation.
+  UpdateRateScheduler(UpdateRateScheduler const&) = delete;
+  UpdateRateScheduler& operator=(UpdateRateScheduler const&) = delete;
+
+  ~UpdateRateScheduler();
+
+  // Allocates the scheduler for _num_instances instances of _skeleton. All
+  // instances have no animation and a period of 1. Cubic animations can only
+  // be updated if _cubic is true (see SamplingJob::Context::cubic()). Returns
+  // false if a parameter is invalid, leaving the scheduler empty.
+  bool Allocate(const Skeleton& _skeleton, int _num_instances,
+                bool _cubic = false);
+
+  // Releases all buffers.
+  void Deallocate();
+
+  // Computes an update period from a distance to the camera: 1 up to
+  // _full_rate_distance, then doubling every time distance doubles, up to
+  // _max_period (clamped to kMaxPeriod).
+  static int PeriodFromDistance(float _distance, float _full_rate_distance,
+                                int _max_period);
+
+  // Sets _instance animation, nullptr disabling the instance. Animation
+  // tracks must match skeleton joints. The instance is updated (without
+  // interpolation) on next Update(). Returns false if a parameter is invalid.
+  bool set_animation(int _instance, const Animation* _animation);
+
+  // Sets _instance update period, clamped to [1,kMaxPeriod]. The instance is
+  // given a new phase, balancing instances of the same period, and is updated
+  // (without interpolation) on next Update(). Setting the same period again
+  // has no effect. Returns false if _instance is invalid.
+  bool set_period(int _instance, int _period);
+
+  // Gets _instance period, or 0 if _instance is invalid.
+  int period(int _instance) const;
+
+  // Advances one frame: samples instances that are due for an update at their
+  // entry of _ratios, and interpolates every enabled instance pose. _ratios
+  // must contain a ratio per instance, ratios of instances not updated this
+  // frame are ignored. Returns false if scheduler isn't allocated, if _ratios
+  // is too small, or if any sampling failed.
+  bool Update(span<const float> _ratios);
+
+  // Gets _instance model-space pose for the current frame. Empty if _instance
+  // is invalid, or if the instance hasn't been updated since it was given an
+  // animation.
+  span<const math::Float4x4> models(int _instance) const;
+
+  // Gets the number of instances.
+  int num_instances() const { return num_instances_; }
+
+  // Gets the number of instances sampled by the last Update().
+  int num_updates() const { return num_updates_; }
+
+  // Gets the number of Update() calls since allocation.
+  int frame() const { return frame_; }
+
+ private:
+  // Instance scheduling state.
+  struct Instance {
+    const Animation* animation;
+    int period;
+    int phase;
+    int latest;  // Index of the latest sampled key pose, 0 or 1.
+    bool snap;   // Next update replaces both key poses.
+    bool valid;  // Instance has been updated since animation was set.
+  };
+
+  // Gets key pose _key of _instance.
+  math::Float4x4* key(int _instance, int _key) const;
+
+  const Skeleton* skeleton_;
+  int num_instances_;
+  int num_updates_;
+  int frame_;
+
+  // Number of phases assigned per period, used to balance phases.
+  int phase_counters_[kMaxPeriod + 1];
+
+  // Single allocation, that all buffers below point to.
+  void* buffer_;
+  math::SoaTransform* locals_;  // num_soa_joints sampling scratch.
+  math::Float4x4* keys_;        // 2 * num_instances * num_joints key poses.
+  math::Float4x4* models_;      // num_instances * num_joints output poses.
+  Instance* instances_;
+
+  // One sampling context per instance.
+  SamplingJob::ContextBank contexts_;
+};
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_UPDATE_RATE_SCHEDULER_H_
@@ -0,0 +1,131 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_CONTAINERS_POSE_BLOCK_H_
+#define OZZ_OZZ_BASE_CONTAINERS_POSE_BLOCK_H_
+
+#include <cstddef>
+
+#include "ozz/base/export.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+namespace ozz {
+namespace math {
+struct Float4x4;
+struct SoaTransform;
+}  // namespace math
+
+// Stores the pose buffers of a character in a single allocation: local-space
+// SoA poses (ie: sampled layers and blending output), model-space matrices
+// and skinning matrices (aka palette). This replaces a vector per buffer and
+// per character.
+// Every buffer starts on a cache line, and the block is padded to a whole
+// number of cache lines, so that characters updated concurrently never share
+// a cache line (false sharing), and buffers of a character are contiguous in
+// memory.
+// Buffers are initialized to identity transforms and matrices, so jobs that
+// read buffers they don't fully write (ie: BlendingJob with a mask) are
+// valid.
+class OZZ_BASE_DLL PoseBlock {
+ public:
+  // Alignment and padding of buffers.
+  enum { kCacheLineSize = 64 };
+
+  // Constructs an empty block.
+  PoseBlock();
+
+  // Constructs a block for _num_joints joints, see Resize().
+  explicit PoseBlock(int _num_joints, int _num_local_poses = 1);
+
+  // Constructs a block sized from _skeleton, any type that exposes
+  // num_joints(), like animation::Skeleton.
+  template <typename _Skeleton>
+  explicit PoseBlock(const _Skeleton& _skeleton, int _num_local_poses = 1)
+      : PoseBlock() {
+    Resize(_skeleton.num_joints(), _num_local_poses);
+  }
+
+  // Allow moves.
+  PoseBlock(PoseBlock&& _other);
+  PoseBlock& operator=(PoseBlock&& _other);
+
+  // Disables copy and assignation.
+  PoseBlock(PoseBlock const&) = delete;
+  PoseBlock& operator=(PoseBlock const&) = delete;
+
+  // Releases the block.
+  ~PoseBlock();
+
+  // Reallocates buffers for _num_joints joints, with _num_local_poses
+  // local-space poses. Previous content is lost.
+  // Returns false if a parameter is negative, leaving the block empty.
+  bool Resize(int _num_joints, int _num_local_poses = 1);
+
+  // Gets the number of joints.
+  int num_joints() const { return num_joints_; }
+
+  // Gets the number of SoA joints of local-space poses.
+  int num_soa_joints() const { return (num_joints_ + 3) / 4; }
+
+  // Gets the number of local-space poses.
+  int num_local_poses() const { return num_local_poses_; }
+
+  // Gets local-space pose _pose, empty if _pose is out of range.
+  span<math::SoaTransform> locals(int _pose = 0);
+  span<const math::SoaTransform> locals(int _pose = 0) const;
+
+  // Gets model-space matrices.
+  span<math::Float4x4> models();
+  span<const math::Float4x4> models() const;
+
+  // Gets skinning matrices.
+  span<math::Float4x4> palette();
+  span<const math::Float4x4> palette() const;
+
+  // Gets the size in bytes of the allocation, a multiple of kCacheLineSize.
+  size_t size() const { return size_; }
+
+ private:
+  // Releases the allocation.
+  void Release();
+
+  // Number of joints and local poses.
+  int num_joints_;
+  int num_local_poses_;
+
+  // Size in bytes of each local-space pose and matrices buffer, padded to
+  // cache lines.
+  size_t locals_stride_;
+  size_t matrices_stride_;
+
+  // Allocation, local poses followed by model-space and skinning matrices.
+  byte* block_;
+  size_t size_;
+};
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_CONTAINERS_POSE_BLOCK_H_
@@ -0,0 +1,211 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_CONTAINERS_SMALL_VECTOR_H_
+#define OZZ_OZZ_BASE_CONTAINERS_SMALL_VECTOR_H_
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+
+// Implements a vector that stores up to _Inline elements inside the object
+// itself (usually on the stack). Bigger sizes are allocated from the allocator
+// given at construction, which defaults to the default allocator. This removes
+// heap allocations from loops whose containers are usually small, like
+// per-track temporaries of offline algorithms.
+// The allocator can be a scratch arena (see memory::ScratchScope), in which
+// case memory isn't returned to it until the arena is rewound. So the vector
+// must not outlive the arena scope.
+// SmallVector implements the subset of std::vector interface needed by ozz
+// algorithms. Iterators are pointers, and are invalidated by any growth.
+template <typename _Ty, size_t _Inline>
+class SmallVector {
+ public:
+  typedef _Ty value_type;
+  typedef _Ty& reference;
+  typedef const _Ty& const_reference;
+  typedef _Ty* pointer;
+  typedef const _Ty* const_pointer;
+  typedef _Ty* iterator;
+  typedef const _Ty* const_iterator;
+  typedef size_t size_type;
+
+  // Constructs an empty vector, whose external storage will be allocated from
+  // _allocator, or the default allocator if nullptr.
+  explicit SmallVector(memory::Allocator* _allocator = nullptr)
+      : allocator_(_allocator ? _allocator : memory::default_allocator()),
+        data_(reinterpret_cast<_Ty*>(inline_)),
+        size_(0),
+        capacity_(_Inline) {}
+
+  // Constructs a vector of _size value initialized elements.
+  explicit SmallVector(size_t _size, memory::Allocator* _allocator = nullptr)
+      : SmallVector(_allocator) {
+    resize(_size);
+  }
+
+  // Constructs a vector of _size copies of _value.
+  SmallVector(size_t _size, const _Ty& _value,
+              memory::Allocator* _allocator = nullptr)
+      : SmallVector(_allocator) {
+    resize(_size, _value);
+  }
+
+  // Destroys elements and releases external storage.
+  ~SmallVector() {
+    clear();
+    Release();
+  }
+
+  // Elements access, without range check.
+  reference operator[](size_t _index) {
+    assert(_index < size_ && "Index out of range.");
+    return data_[_index];
+  }
+  const_reference operator[](size_t _index) const {
+    assert(_index < size_ && "Index out of range.");
+    return data_[_index];
+  }
+  reference front() { return (*this)[0]; }
+  const_reference front() const { return (*this)[0]; }
+  reference back() { return (*this)[size_ - 1]; }
+  const_reference back() const { return (*this)[size_ - 1]; }
+
+  pointer data() { return data_; }
+  const_pointer data() const { return data_; }
+
+  iterator begin() { return data_; }
+  const_iterator begin() const { return data_; }
+  iterator end() { return data_ + size_; }
+  const_iterator end() const { return data_ + size_; }
+
+  size_t size() const { return size_; }
+  size_t capacity() const { return capacity_; }
+  bool empty() const { return size_ == 0; }
+
+  // Tells whether elements are stored in the object itself.
+  bool is_inline() const {
+    return data_ == reinterpret_cast<const _Ty*>(inline_);
+  }
+
+  // Ensures storage for _capacity elements.
+  void reserve(size_t _capacity) {
+    if (_capacity > capacity_) {
+      Grow(_capacity);
+    }
+  }
+
+  void push_back(const _Ty& _value) {
+    if (size_ == capacity_) {
+      // _value could be an element of this vector, so it's copied first.
+      _Ty value(_value);
+      Grow(capacity_ * 2 + 1);
+      new (data_ + size_) _Ty(std::move(value));
+    } else {
+      new (data_ + size_) _Ty(_value);
+    }
+    ++size_;
+  }
+
+  void pop_back() {
+    assert(size_ > 0 && "Vector is empty.");
+    data_[--size_].~_Ty();
+  }
+
+  // Destroys all elements. Storage isn't released.
+  void clear() {
+    while (size_ > 0) {
+      data_[--size_].~_Ty();
+    }
+  }
+
+  // Resizes to _size elements, new ones being value initialized.
+  void resize(size_t _size) {
+    reserve(_size);
+    while (size_ > _size) {
+      pop_back();
+    }
+    for (; size_ < _size; ++size_) {
+      new (data_ + size_) _Ty();
+    }
+  }
+
+  // Resizes to _size elements, new ones being copies of _value.
+  void resize(size_t _size, const _Ty& _value) {
+    reserve(_size);
+    while (size_ > _size) {
+      pop_back();
+    }
+    for (; size_ < _size; ++size_) {
+      new (data_ + size_) _Ty(_value);
+    }
+  }
+
+ private:
+  SmallVector(const SmallVector&) = delete;
+  void operator=(const SmallVector&) = delete;
+
+  // Moves elements to a new external storage of _capacity elements.
+  void Grow(size_t _capacity) {
+    assert(_capacity > capacity_);
+    _Ty* data = reinterpret_cast<_Ty*>(
+        allocator_->Allocate(sizeof(_Ty) * _capacity, alignof(_Ty)));
+    assert(data && "Allocation failed.");
+    for (size_t i = 0; i < size_; ++i) {
+      new (data + i) _Ty(std::move(data_[i]));
+      data_[i].~_Ty();
+    }
+    Release();
+    data_ = data;
+    capacity_ = _capacity;
+  }
+
+  // Releases external storage, if any.
+  void Release() {
+    if (!is_inline()) {
+      allocator_->Deallocate(data_);
+    }
+  }
+
+  // Allocator of external storage.
+  memory::Allocator* allocator_;
+
+  // Elements, pointing either to inline_ or to external storage.
+  _Ty* data_;
+  size_t size_;
+  size_t capacity_;
+
+  // Inline storage, used for up to _Inline elements.
+  alignas(_Ty) char inline_[sizeof(_Ty) * (_Inline > 0 ? _Inline : 1)];
+};
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_CONTAINERS_SMALL_VECTOR_H_
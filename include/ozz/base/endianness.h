@@ -32,6 +32,7 @@
 
 #include <cstddef>
 
+#include "ozz/base/export.h"
 #include "ozz/base/platform.h"
 
 namespace ozz {
@@ -53,6 +54,15 @@ inline Endianness GetNativeEndianness() {
   return Endianness(u.c[0]);
 }
 
+// Swaps in-place the bytes of the _count 2 bytes elements of _data, which
+// doesn't need to be aligned. Uses SIMD byte shuffles when available, so bulk
+// swapping runs close to memory bandwidth.
+OZZ_BASE_DLL void EndianSwap16(void* _data, size_t _count);
+
+// Swaps in-place the bytes of the _count 4 bytes elements of _data, which
+// doesn't need to be aligned. See EndianSwap16.
+OZZ_BASE_DLL void EndianSwap32(void* _data, size_t _count);
+
 // Declare the endian swapper struct that is aimed to be specialized (template
 // meaning) for every type sizes.
 // The swapper provides two functions:
@@ -83,10 +93,7 @@ struct EndianSwapper<_Ty, 1> {
 template <typename _Ty>
 struct EndianSwapper<_Ty, 2> {
   OZZ_INLINE static void Swap(_Ty* _ty, size_t _count) {
-    byte* alias = reinterpret_cast<byte*>(_ty);
-    for (size_t i = 0; i < _count * 2; i += 2) {
-      _in_place_byte_swap(alias[i + 0], alias[i + 1]);
-    }
+    EndianSwap16(_ty, _count);
   }
   OZZ_INLINE static _Ty Swap(_Ty _ty) {  // Pass by copy to swap _ty in-place.
     byte* alias = reinterpret_cast<byte*>(&_ty);
@@ -99,11 +106,7 @@ struct EndianSwapper<_Ty, 2> {
 template <typename _Ty>
 struct EndianSwapper<_Ty, 4> {
   OZZ_INLINE static void Swap(_Ty* _ty, size_t _count) {
-    byte* alias = reinterpret_cast<byte*>(_ty);
-    for (size_t i = 0; i < _count * 4; i += 4) {
-      _in_place_byte_swap(alias[i + 0], alias[i + 3]);
-      _in_place_byte_swap(alias[i + 1], alias[i + 2]);
-    }
+    EndianSwap32(_ty, _count);
   }
   OZZ_INLINE static _Ty Swap(_Ty _ty) {  // Pass by copy to swap _ty in-place.
     byte* alias = reinterpret_cast<byte*>(&_ty);
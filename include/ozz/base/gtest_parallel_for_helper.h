@@ -0,0 +1,44 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_GTEST_PARALLEL_FOR_HELPER_H_
+#define OZZ_OZZ_BASE_GTEST_PARALLEL_FOR_HELPER_H_
+
+#include "ozz/base/parallel_for.h"
+
+// Fake task scheduler matching ozz::ParallelForHook, for jobs parallel_for
+// hooks tests. It runs tasks in reverse order, so that tests can check results
+// don't depend on tasks order, and adds the number of tasks to the int pointed
+// by _user_data, which must outlive every run using this hook.
+inline void ReverseParallelFor(int _count, ozz::ParallelForTask _task,
+                               void* _task_data, void* _user_data) {
+  for (int i = _count - 1; i >= 0; --i) {
+    _task(i, _task_data);
+  }
+  *static_cast<int*>(_user_data) += _count;
+}
+#endif  // OZZ_OZZ_BASE_GTEST_PARALLEL_FOR_HELPER_H_
@@ -50,6 +50,10 @@
 // helper function ozz::io::MakeArray() that is then streamed in or out using
 // << and >> archive operators: archive << ozz::io::MakeArray(my_array, count);
 //
+// Arrays of types whose archive layout matches their memory layout can be
+// declared with OZZ_IO_TYPE_BULK macro. They are then saved/loaded with a
+// single stream write/read, unless an endian swap is required.
+//
 // Versioning can be done using OZZ_IO_TYPE_VERSION macros. Type version
 // is saved in the OArchive, and is given back to Load functions to allow to
 // manually handle version modifications. Versioning can be disabled using
@@ -80,13 +84,21 @@
 #include <stdint.h>
 
 #include <cassert>
+#include <cstring>
 
 #include "ozz/base/endianness.h"
 #include "ozz/base/io/archive_traits.h"
 #include "ozz/base/io/stream.h"
+#include "ozz/base/parallel_for.h"
 #include "ozz/base/platform.h"
 #include "ozz/base/span.h"
 
+namespace ozz {
+namespace io {
+class CompressedStream;
+}  // namespace io
+}  // namespace ozz
+
 namespace ozz {
 namespace io {
 namespace internal {
@@ -106,8 +118,15 @@ class OZZ_BASE_DLL OArchive {
  public:
   // Constructs an output archive from the Stream _stream that must be valid
   // and opened for writing.
+  // If _compressed is true, archive content is written through a
+  // CompressedStream, which IArchive detects and decompresses transparently.
   explicit OArchive(Stream* _stream,
-                    Endianness _endianness = GetNativeEndianness());
+                    Endianness _endianness = GetNativeEndianness(),
+                    bool _compressed = false);
+
+  // Finalizes compressed stream if any, so that _stream is positioned at the
+  // end of the archive.
+  ~OArchive();
 
   // Returns true if an endian swap is required while writing.
   bool endian_swap() const { return endian_swap_; }
@@ -146,10 +165,14 @@ class OZZ_BASE_DLL OArchive {
   OZZ_IO_PRIMITIVE_TYPE(float)
 #undef OZZ_IO_PRIMITIVE_TYPE
 
-  // Returns output stream.
+  // Returns output stream. This is the compressed stream for a compressed
+  // archive.
   Stream* stream() const { return stream_; }
 
  private:
+  OArchive(const OArchive&);
+  void operator=(const OArchive&);
+
   template <typename _Ty>
   void SaveVersion() {
     // Compilation could fail here if the version is not defined for _Ty, or if
@@ -164,6 +187,9 @@ class OZZ_BASE_DLL OArchive {
   // The output stream.
   Stream* stream_;
 
+  // Compressed stream allocated for a compressed archive, nullptr otherwise.
+  CompressedStream* compressed_;
+
   // Endian swap state, true if a conversion is required while writing.
   bool endian_swap_;
 };
@@ -176,11 +202,38 @@ class OZZ_BASE_DLL IArchive {
   // Constructs an input archive from the Stream _stream that must be opened for
   // reading, at the same tell (position in the stream) as when it was passed to
   // the OArchive.
+  // Compressed archives are detected and decompressed transparently.
   explicit IArchive(Stream* _stream);
 
+  // Releases compressed stream if any.
+  ~IArchive();
+
   // Returns true if an endian swap is required while reading.
   bool endian_swap() const { return endian_swap_; }
 
+  // Sets whether objects saved with a version older than the current one are
+  // loaded, which is the default. When legacy versions are rejected, such
+  // objects are loaded as an unsupported version 0, which their Load function
+  // refuses. This ensures assets were upgraded offline (see upgrade2ozz), so
+  // that loading only follows the current version path.
+  void set_legacy_versions(bool _accept) { legacy_versions_ = _accept; }
+  bool legacy_versions() const { return legacy_versions_; }
+
+  // Task function and task scheduler hook, see ozz/base/parallel_for.h.
+  typedef ozz::ParallelForTask ParallelForTask;
+  typedef ozz::ParallelForHook ParallelFor;
+
+  // Sets an optional task scheduler hook. Objects use it to decode and
+  // validate independent data in parallel once read (see Animation), and
+  // compressed archives to decompress blocks in parallel. If nullptr
+  // (default), everything is done serially by the calling thread.
+  void set_parallel_for(ParallelFor _parallel_for, void* _user_data);
+  ParallelFor parallel_for() const { return parallel_for_; }
+
+  // Runs _count tasks through parallel_for hook if set, or serially by the
+  // calling thread otherwise.
+  void RunTasks(int _count, ParallelForTask _task, void* _task_data) const;
+
   // Loads _size bytes of binary data to _data.
   size_t LoadBinary(void* _data, size_t _size) {
     return stream_->Read(_data, _size);
@@ -227,30 +280,50 @@ class OZZ_BASE_DLL IArchive {
     static_assert(internal::Tag<const _Ty>::kTagLength != 0,
                   "Tag unknown for type.");
 
-    const int tell = stream_->Tell();
+    const int64_t tell = stream_->Tell();
     bool valid = internal::Tagger<const _Ty>::Validate(*this);
     stream_->Seek(tell, Stream::kSet);  // Rewinds before the tag test.
     return valid;
   }
 
-  // Returns input stream.
+  // Returns input stream. This is the decompressing stream for a compressed
+  // archive, so that positions remain consistent with the ones while saving.
   Stream* stream() const { return stream_; }
 
  private:
+  IArchive(const IArchive&);
+  void operator=(const IArchive&);
+
   template <typename _Ty>
   uint32_t LoadVersion() {
     uint32_t version = 0;
     if (void(0), internal::Version<const _Ty>::kValue != 0) {
       *this >> version;
+      if (!legacy_versions_ && version < internal::Version<const _Ty>::kValue) {
+        version = RejectVersion(version);
+      }
     }
     return version;
   }
 
+  // Logs legacy _version rejection, and returns the unsupported version 0.
+  uint32_t RejectVersion(uint32_t _version);
+
   // The input stream.
   Stream* stream_;
 
+  // Compressed stream allocated for a compressed archive, nullptr otherwise.
+  CompressedStream* compressed_;
+
   // Endian swap state, true if a conversion is required while reading.
   bool endian_swap_;
+
+  // Accepts objects saved with legacy versions.
+  bool legacy_versions_;
+
+  // Optional task scheduler hook, and its user data.
+  ParallelFor parallel_for_;
+  void* parallel_for_user_data_;
 };
 
 // Primitive type are not versionable.
@@ -285,13 +358,27 @@ struct Extern {
 // Wrapper for dynamic array serialization.
 // Must be used through ozz::io::MakeArray.
 namespace internal {
+// Bulk types (see OZZ_IO_TYPE_BULK) are saved/loaded with a single stream
+// write/read if no endian swap is required.
 template <typename _Ty>
 struct Array {
   OZZ_INLINE void Save(OArchive& _archive) const {
-    ozz::io::Extern<_Ty>::Save(_archive, array, count);
+    if (Bulk<const _Ty>::kValue && !_archive.endian_swap()) {
+      OZZ_IF_DEBUG(size_t size =)
+      _archive.SaveBinary(array, count * sizeof(_Ty));
+      assert(size == count * sizeof(_Ty));
+    } else {
+      ozz::io::Extern<_Ty>::Save(_archive, array, count);
+    }
   }
   OZZ_INLINE void Load(IArchive& _archive, uint32_t _version) const {
-    ozz::io::Extern<_Ty>::Load(_archive, array, count, _version);
+    if (Bulk<const _Ty>::kValue && !_archive.endian_swap()) {
+      OZZ_IF_DEBUG(size_t size =)
+      _archive.LoadBinary(array, count * sizeof(_Ty));
+      assert(size == count * sizeof(_Ty));
+    } else {
+      ozz::io::Extern<_Ty>::Load(_archive, array, count, _version);
+    }
   }
   _Ty* array;
   size_t count;
@@ -300,7 +387,13 @@ struct Array {
 template <typename _Ty>
 struct Array<const _Ty> {
   OZZ_INLINE void Save(OArchive& _archive) const {
-    ozz::io::Extern<_Ty>::Save(_archive, array, count);
+    if (Bulk<const _Ty>::kValue && !_archive.endian_swap()) {
+      OZZ_IF_DEBUG(size_t size =)
+      _archive.SaveBinary(array, count * sizeof(_Ty));
+      assert(size == count * sizeof(_Ty));
+    } else {
+      ozz::io::Extern<_Ty>::Save(_archive, array, count);
+    }
   }
   const _Ty* array;
   size_t count;
@@ -313,16 +406,29 @@ struct Version<const Array<_Ty>> {
   enum { kValue = Version<const _Ty>::kValue };
 };
 
+// Saves _count elements of _array endian swapped. As _array can't be swapped
+// in-place, elements are copied and bulk swapped by chunks.
+template <typename _Ty>
+inline void SaveEndianSwapped(OArchive& _archive, const _Ty* _array,
+                              size_t _count) {
+  const size_t kChunk = 256;
+  _Ty chunk[kChunk];
+  for (size_t i = 0; i < _count; i += kChunk) {
+    const size_t n = _count - i < kChunk ? _count - i : kChunk;
+    std::memcpy(chunk, _array + i, n * sizeof(_Ty));
+    EndianSwapper<_Ty>::Swap(chunk, n);
+    OZZ_IF_DEBUG(size_t size =)
+    _archive.SaveBinary(chunk, n * sizeof(_Ty));
+    assert(size == n * sizeof(_Ty));
+  }
+}
+
 // Specializes Array Save/Load for primitive types.
 #define OZZ_IO_PRIMITIVE_TYPE(_type)                                        \
   template <>                                                               \
   inline void Array<const _type>::Save(OArchive& _archive) const {          \
     if (_archive.endian_swap()) {                                           \
-      /* Save element by element as swapping in place the whole buffer is*/ \
-      /* not possible.*/                                                    \
-      for (size_t i = 0; i < count; ++i) {                                  \
-        _archive << array[i];                                               \
-      }                                                                     \
+      SaveEndianSwapped(_archive, array, count);                            \
     } else {                                                                \
       OZZ_IF_DEBUG(size_t size =)                                           \
       _archive.SaveBinary(array, count * sizeof(_type));                    \
@@ -333,11 +439,7 @@ struct Version<const Array<_Ty>> {
   template <>                                                               \
   inline void Array<_type>::Save(OArchive& _archive) const {                \
     if (_archive.endian_swap()) {                                           \
-      /* Save element by element as swapping in place the whole buffer is*/ \
-      /* not possible.*/                                                    \
-      for (size_t i = 0; i < count; ++i) {                                  \
-        _archive << array[i];                                               \
-      }                                                                     \
+      SaveEndianSwapped(_archive, array, count);                            \
     } else {                                                                \
       OZZ_IF_DEBUG(size_t size =)                                           \
       _archive.SaveBinary(array, count * sizeof(_type));                    \
@@ -33,6 +33,7 @@
 
 #include <stdint.h>
 #include <cstddef>
+#include <type_traits>
 
 namespace ozz {
 namespace io {
@@ -201,6 +202,22 @@ struct Extern;
   };                                                                  \
   }  // internal
 
+// Declares that _type archive layout is the same as its memory layout, without
+// padding. Arrays of _type are then saved/loaded with a single stream write or
+// read when archive endianness matches the native one. Extern<_type> is still
+// used when an endian swap is required.
+// This macro must be used inside namespace ozz::io.
+// Syntax is: OZZ_IO_TYPE_BULK(Foo).
+#define OZZ_IO_TYPE_BULK(_type)                                          \
+  static_assert(std::is_trivially_copyable<_type>::value,                \
+                "Bulk serialization requires trivially copyable types"); \
+  namespace internal {                                                   \
+  template <>                                                            \
+  struct Bulk<const _type> {                                             \
+    enum { kValue = 1 };                                                 \
+  };                                                                     \
+  }  // internal
+
 namespace internal {
 // Definition of version specializable template struct.
 // There's no default implementation in order to force user to define it, which
@@ -214,6 +231,12 @@ template <typename _Ty>
 struct Tag {
   enum { kTagLength = 0 };
 };
+
+// Defines default bulk serialization state, which is disabled.
+template <typename _Ty>
+struct Bulk {
+  enum { kValue = 0 };
+};
 }  // namespace internal
 }  // namespace io
 }  // namespace ozz
@@ -0,0 +1,201 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_IO_ASSET_REGISTRY_H_
+#define OZZ_OZZ_BASE_IO_ASSET_REGISTRY_H_
+
+// Provides a registry that shares archived objects (skeletons, animations,
+// tracks...) loaded many times, like when many entities load the same file.
+// Assets are identified by the hash of their archive content, so identical
+// data are decoded once and shared whatever the path they're loaded from.
+
+#include <stdint.h>
+
+#include <atomic>
+#include <cassert>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/async_load.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+namespace internal {
+
+// Type agnostic part of registered assets.
+class OZZ_BASE_DLL AssetEntry {
+ public:
+  // Entries are destroyed by the table, as the last reference is released.
+  virtual ~AssetEntry() {}
+
+  // Gets asset archive content hash.
+  uint64_t hash() const { return hash_; }
+
+  // Gets asset load status, which is pending while the asset is being decoded
+  // by the thread that registered it. Object can be accessed once status isn't
+  // pending.
+  AsyncStatus status() const {
+    return static_cast<AsyncStatus>(status_.load(std::memory_order_acquire));
+  }
+
+ protected:
+  AssetEntry() : hash_(0), status_(kAsyncPending), references_(0) {}
+
+ private:
+  friend class AssetTable;
+
+  // Disables copy and assignment.
+  AssetEntry(const AssetEntry&);
+  void operator=(const AssetEntry&);
+
+  uint64_t hash_;
+  std::atomic<int> status_;
+
+  // Number of references, guarded by the table lock.
+  int references_;
+};
+
+// Type agnostic part of AssetRegistry: a thread safe table of reference
+// counted entries, keyed by content hash.
+class OZZ_BASE_DLL AssetTable {
+ public:
+  // Gets the number of registered assets.
+  size_t size() const;
+
+  // Reads _stream content, from its current position to its end, to _content
+  // and computes its 64 bits FNV-1a hash.
+  // Returns false if _stream isn't opened or is empty.
+  static bool ReadContent(Stream* _stream, MemoryStream* _content,
+                          uint64_t* _hash);
+
+ protected:
+  // Function creating an entry of the registry asset type.
+  typedef AssetEntry* (*Create)();
+
+  AssetTable();
+
+  // Destroys remaining entries. Asserts that all of them were released.
+  ~AssetTable();
+
+  // Finds the entry of _hash, or creates it with _create if there's none, in
+  // which case *_created is set to true. The caller is then responsible for
+  // decoding the asset and publishing its status. Adds a reference to the
+  // returned entry.
+  AssetEntry* Acquire(uint64_t _hash, Create _create, bool* _created);
+
+  // Finds the entry of _hash and adds a reference, or returns nullptr.
+  AssetEntry* Find(uint64_t _hash);
+
+  // Publishes _entry load _status, which can't be pending.
+  static void Publish(AssetEntry* _entry, AsyncStatus _status);
+
+  // Removes a reference to _entry, destroying it if it was the last one.
+  void Release(const AssetEntry* _entry);
+
+ private:
+  // Disables copy and assignment.
+  AssetTable(const AssetTable&);
+  void operator=(const AssetTable&);
+
+  struct Internal;
+  Internal* internal_;
+};
+}  // namespace internal
+
+// Shares objects of type _Ty loaded from archives. _Ty must be tagged (see
+// OZZ_IO_TYPE_TAG), like Animation, Skeleton or tracks.
+// Registry is thread safe: assets can be acquired and released from any thread,
+// including from AsyncReader completion functions. If an asset is acquired
+// while another thread is decoding the same content, it's returned immediately
+// with a pending status, which can be polled like AsyncLoad status.
+// Registry must outlive all the assets it returns.
+template <typename _Ty>
+class AssetRegistry : public internal::AssetTable {
+ public:
+  // Shared asset, owned by the registry.
+  class Asset : public internal::AssetEntry {
+   public:
+    // Gets the shared object, which shall not be accessed while pending.
+    const _Ty& object() const {
+      assert(status() != kAsyncPending);
+      return object_;
+    }
+
+   private:
+    friend class AssetRegistry;
+    _Ty object_;
+  };
+
+  AssetRegistry() {}
+
+  // Acquires the asset of the archive read from _stream, from its current
+  // position to its end. If an asset with the same content is registered, it's
+  // shared whatever its status. Otherwise the object is decoded from the
+  // calling thread, and asset status is failed if the archive doesn't contain
+  // an object of type _Ty.
+  // Returns nullptr if _stream can't be read. Every returned asset must be
+  // released with Release().
+  const Asset* Acquire(Stream* _stream) {
+    MemoryStream content;
+    uint64_t hash;
+    if (!ReadContent(_stream, &content, &hash)) {
+      return nullptr;
+    }
+    bool created = false;
+    Asset* asset = static_cast<Asset*>(
+        internal::AssetTable::Acquire(hash, &AssetRegistry::CreateAsset,
+                                       &created));
+    if (created) {
+      AsyncStatus status = kAsyncFailed;
+      content.Seek(0, Stream::kSet);
+      IArchive archive(&content);
+      if (archive.TestTag<_Ty>()) {
+        archive >> asset->object_;
+        status = kAsyncSucceeded;
+      }
+      Publish(asset, status);
+    }
+    return asset;
+  }
+
+  // Acquires the registered asset whose content hash is _hash, see
+  // AssetEntry::hash(). Returns nullptr if there's none.
+  const Asset* Find(uint64_t _hash) {
+    return static_cast<const Asset*>(internal::AssetTable::Find(_hash));
+  }
+
+  // Releases _asset, which is destroyed when its last reference is released.
+  void Release(const Asset* _asset) { internal::AssetTable::Release(_asset); }
+
+ private:
+  static internal::AssetEntry* CreateAsset() { return ozz::New<Asset>(); }
+};
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_IO_ASSET_REGISTRY_H_
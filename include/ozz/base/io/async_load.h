@@ -0,0 +1,194 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_IO_ASYNC_LOAD_H_
+#define OZZ_OZZ_BASE_IO_ASYNC_LOAD_H_
+
+// Provides asynchronous loading of archived objects (animations, skeletons,
+// tracks...), so that loading never blocks the calling thread.
+// File reading is delegated to a pluggable AsyncReader backend, which can rely
+// on io_uring, overlapped I/O or any platform asynchronous file API. Objects
+// are decoded from the thread the backend completes reads on, and completion
+// is signaled with an optional callback and a status that can be polled.
+
+#include <atomic>
+#include <cstddef>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+
+// Declares asynchronous file reading backend interface.
+class OZZ_BASE_DLL AsyncReader {
+ public:
+  // Completion function, called by the backend once a read request completes,
+  // from any thread. _stream is opened for reading at the beginning of file
+  // content, and is only valid during the call. It's nullptr if the file
+  // couldn't be read.
+  typedef void (*Completion)(Stream* _stream, void* _user_data);
+
+  // Issues an asynchronous read request of the file at path _filename. If true
+  // is returned, _completion will be called exactly once, whatever the read
+  // result. Returns false if the request couldn't be issued, in which case
+  // _completion is never called.
+  virtual bool Read(const char* _filename, Completion _completion,
+                    void* _user_data) = 0;
+
+ protected:
+  AsyncReader() {}
+
+  // Required virtual destructor.
+  virtual ~AsyncReader() {}
+
+ private:
+  AsyncReader(const AsyncReader&);
+  void operator=(const AsyncReader&);
+};
+
+// Implements an AsyncReader that reads files with io::File, buffered with a
+// BufferedStream, from tasks run by a user provided dispatcher. The dispatcher
+// typically pushes tasks to a job system or worker threads. Without
+// dispatcher, tasks are run immediately, so reading is synchronous.
+class OZZ_BASE_DLL FileAsyncReader : public AsyncReader {
+ public:
+  // Task to run, with its _data argument.
+  typedef void (*Task)(void* _data);
+
+  // Dispatches _task, that must be run once with _task_data. _user_data is
+  // FileAsyncReader user data.
+  typedef void (*Dispatch)(Task _task, void* _task_data, void* _user_data);
+
+  // Constructs a reader dispatching read tasks with _dispatch. _buffer_size
+  // is the size of read-ahead buffer, see BufferedStream.
+  explicit FileAsyncReader(
+      Dispatch _dispatch = nullptr, void* _user_data = nullptr,
+      size_t _buffer_size = BufferedStream::kDefaultBufferSize);
+
+  // See AsyncReader::Read for details.
+  virtual bool Read(const char* _filename, Completion _completion,
+                    void* _user_data);
+
+ private:
+  // Reads the file of request _data.
+  static void ReadTask(void* _data);
+
+  Dispatch dispatch_;
+  void* user_data_;
+  size_t buffer_size_;
+};
+
+// Defines asynchronous load status.
+enum AsyncStatus {
+  kAsyncIdle,       // No load was started.
+  kAsyncPending,    // Object is being loaded.
+  kAsyncSucceeded,  // Object was loaded.
+  kAsyncFailed,     // File couldn't be read or doesn't contain an object of
+                    // the expected type.
+};
+
+// Asynchronously loads an object of type _Ty from an archive file. _Ty must be
+// tagged (see OZZ_IO_TYPE_TAG), like Animation, Skeleton or tracks.
+// AsyncLoad must outlive the load, so it shall not be destroyed while pending.
+template <typename _Ty>
+class AsyncLoad {
+ public:
+  // Completion callback, called from the thread the object was loaded on,
+  // before status() reports _status.
+  typedef void (*Callback)(AsyncLoad* _load, AsyncStatus _status,
+                           void* _user_data);
+
+  AsyncLoad() : status_(kAsyncIdle), callback_(nullptr), user_data_(nullptr) {}
+
+  // Starts loading the file at path _filename, read with _reader. _callback,
+  // if not nullptr, is called with _user_data once loading completes.
+  // Returns false if a load is already pending or if the read request couldn't
+  // be issued.
+  bool Start(AsyncReader* _reader, const char* _filename,
+             Callback _callback = nullptr, void* _user_data = nullptr) {
+    if (status() == kAsyncPending) {
+      return false;
+    }
+    callback_ = _callback;
+    user_data_ = _user_data;
+    status_.store(kAsyncPending, std::memory_order_relaxed);
+    if (!_reader->Read(_filename, &AsyncLoad::Complete, this)) {
+      status_.store(kAsyncIdle, std::memory_order_relaxed);
+      return false;
+    }
+    return true;
+  }
+
+  // Gets load status. Object can be accessed once status isn't pending.
+  AsyncStatus status() const {
+    return static_cast<AsyncStatus>(status_.load(std::memory_order_acquire));
+  }
+
+  // Gets the loaded object, which shall not be accessed while pending.
+  _Ty& object() {
+    assert(status() != kAsyncPending);
+    return object_;
+  }
+  const _Ty& object() const {
+    assert(status() != kAsyncPending);
+    return object_;
+  }
+
+ private:
+  // Decodes the object from the read _stream.
+  static void Complete(Stream* _stream, void* _user_data) {
+    AsyncLoad* load = static_cast<AsyncLoad*>(_user_data);
+    AsyncStatus status = kAsyncFailed;
+    if (_stream) {
+      IArchive archive(_stream);
+      if (archive.TestTag<_Ty>()) {
+        archive >> load->object_;
+        status = kAsyncSucceeded;
+      }
+    }
+    if (load->callback_) {
+      load->callback_(load, status, load->user_data_);
+    }
+    // Publishing status is the last access to load, which can then be
+    // destroyed.
+    load->status_.store(status, std::memory_order_release);
+  }
+
+  _Ty object_;
+  std::atomic<int> status_;
+  Callback callback_;
+  void* user_data_;
+
+  // Disables copy and assignment.
+  AsyncLoad(const AsyncLoad&);
+  void operator=(const AsyncLoad&);
+};
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_IO_ASYNC_LOAD_H_
@@ -0,0 +1,170 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_IO_COMPRESSED_STREAM_H_
+#define OZZ_OZZ_BASE_IO_COMPRESSED_STREAM_H_
+
+// Provides a Stream decorator that compresses data by independent blocks.
+// Compressed stream layout is a header, followed by compressed blocks and a
+// block table, mapping each block to its offset and compressed size. The table
+// allows random access: seeking only selects the block to decompress.
+// Blocks are compressed with a byte oriented LZ77 codec, using LZ4 like
+// sequences (literals run and back-reference), which favors decoding speed
+// over compression ratio. Blocks that don't compress are stored raw.
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/parallel_for.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+
+class OZZ_BASE_DLL CompressedStream : public Stream {
+ public:
+  // Compressed stream access mode. A compressed stream is either written
+  // sequentially, or read with random access.
+  enum Mode {
+    kRead,
+    kWrite,
+  };
+
+  // Default size of uncompressed blocks.
+  static const size_t kDefaultBlockSize;
+
+  // Tests if _stream contains a compressed stream at its current position.
+  // _stream position is restored.
+  static bool Test(Stream* _stream);
+
+  // Constructs a compressed stream decorating _stream, which must be opened and
+  // positioned where the compressed stream begins. In kRead mode, compressed
+  // stream header and block table are read, and opened() is false if they're
+  // invalid. In kWrite mode, header is written and data are compressed by
+  // blocks of _block_size bytes. _block_size is ignored in kRead mode.
+  CompressedStream(Stream* _stream, Mode _mode,
+                   size_t _block_size = kDefaultBlockSize);
+
+  // Closes the stream, see Close().
+  virtual ~CompressedStream();
+
+  // In kWrite mode, compresses pending data, writes the block table and
+  // updates the header. Wrapped stream is then positioned at the end of the
+  // compressed stream. Stream can't be used anymore once closed.
+  // Returns false if writing failed.
+  bool Close();
+
+  // See Stream::opened for details.
+  virtual bool opened() const;
+
+  // See Stream::Read for details. Reading fails in kWrite mode.
+  virtual size_t Read(void* _buffer, size_t _size);
+
+  // See Stream::Write for details. Writing fails in kRead mode.
+  virtual size_t Write(const void* _buffer, size_t _size);
+
+  // See Stream::Seek for details. In kWrite mode, data are written
+  // sequentially, so seeking only succeeds if it doesn't move the position.
+  virtual int Seek(int64_t _offset, Origin _origin);
+
+  // See Stream::Tell for details. Positions are uncompressed ones.
+  virtual int64_t Tell() const;
+
+  // See Stream::Tell for details. Size is the uncompressed one.
+  virtual uint64_t Size() const;
+
+  // Task function and task scheduler hook, see ozz/base/parallel_for.h.
+  typedef ozz::ParallelForTask ParallelForTask;
+  typedef ozz::ParallelForHook ParallelFor;
+
+  // Sets an optional task scheduler hook, used in kRead mode when a single
+  // read covers many blocks: their compressed data are read at once, and
+  // blocks are then decompressed in parallel directly to the read buffer. If
+  // nullptr (default), blocks are decompressed serially.
+  void set_parallel_for(ParallelFor _parallel_for, void* _user_data);
+
+ private:
+  // Loads block _block to block_ buffer.
+  bool LoadBlock(size_t _block);
+
+  // Compresses and writes block_ buffer content.
+  bool FlushBlock();
+
+  // Gets the number of consecutive whole blocks, starting from block _first,
+  // that can be read in parallel to a buffer of _size bytes.
+  size_t ParallelBlocks(size_t _first, size_t _size) const;
+
+  // Reads and decompresses _count blocks from block _first to _buffer, in
+  // parallel.
+  bool ReadBlocks(size_t _first, size_t _count, byte* _buffer);
+
+  // Block table entry.
+  struct Block {
+    uint64_t offset;  // Offset of compressed data from stream beginning.
+    uint32_t size;    // Compressed size, raw size if block is stored raw.
+  };
+
+  // The wrapped stream.
+  Stream* stream_;
+
+  // Access mode.
+  Mode mode_;
+
+  // Tells if stream is opened, aka valid and not closed.
+  bool opened_;
+
+  // Position of the compressed stream beginning in the wrapped stream.
+  int64_t origin_;
+
+  // Size of uncompressed blocks.
+  size_t block_size_;
+
+  // Uncompressed size.
+  uint64_t size_;
+
+  // Uncompressed position.
+  int64_t tell_;
+
+  // Block table.
+  ozz::vector<Block> blocks_;
+
+  // Uncompressed data of block loaded_ (kRead), or data pending compression
+  // (kWrite).
+  ozz::vector<byte> block_;
+
+  // Compressed data buffer.
+  ozz::vector<byte> compressed_;
+
+  // Optional task scheduler hook, and its user data.
+  ParallelFor parallel_for_;
+  void* parallel_for_user_data_;
+
+  // Index of the block loaded in block_, or -1.
+  int64_t loaded_;
+};
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_IO_COMPRESSED_STREAM_H_
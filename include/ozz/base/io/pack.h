@@ -0,0 +1,212 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_IO_PACK_H_
+#define OZZ_OZZ_BASE_IO_PACK_H_
+
+// Provides a pack file format, which bundles many serializable objects
+// (animations, skeletons, tracks...) in a single stream, along with a table
+// of contents.
+// Every object is stored as an independent archive. The table of contents
+// maps objects names hash to their type, offset and size in the stream, so
+// that any object can be found in O(1) and loaded with a single seek.
+
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/unordered_map.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/endianness.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+
+// Computes the 64 bits FNV-1a hash of string _str. This is the hash used to
+// identify pack entries names and types.
+OZZ_BASE_DLL uint64_t PackHash(const char* _str);
+
+// Gets the type identifier of _Ty pack entries, which is the hash of _Ty
+// archive tag. Only tagged types can be packed.
+template <typename _Ty>
+inline uint64_t PackType() {
+  static_assert(internal::Tag<const _Ty>::kTagLength != 0,
+                "Only tagged types can be packed.");
+  return PackHash(internal::Tag<const _Ty>::Get());
+}
+
+// Writes objects to a pack stream. Objects are written to the stream as
+// they're added, and the table of contents is written by Finalize().
+class OZZ_BASE_DLL PackWriter {
+ public:
+  // Constructs a pack writer to _stream, which must be valid, opened for
+  // writing and seekable. Like OArchive, endianness can be specified.
+  explicit PackWriter(Stream* _stream,
+                      Endianness _endianness = GetNativeEndianness());
+
+  // Finalizes the pack if it wasn't done yet.
+  ~PackWriter();
+
+  // Delete copies.
+  PackWriter(PackWriter const&) = delete;
+  PackWriter& operator=(PackWriter const&) = delete;
+
+  // Adds _object to the pack, with name _name.
+  // Returns false if the pack is already finalized, or if an entry with the
+  // same name (or name hash) already exists.
+  template <typename _Ty>
+  bool Add(const char* _name, const _Ty& _object) {
+    if (!BeginEntry(_name, PackType<_Ty>())) {
+      return false;
+    }
+    {  // Objects are independent archives.
+      OArchive archive(archive_.stream(), endianness_);
+      archive << _object;
+    }
+    EndEntry();
+    return true;
+  }
+
+  // Writes the table of contents. Nothing can be added afterwards.
+  // Returns false if pack was already finalized or if writing failed.
+  bool Finalize();
+
+ private:
+  // Starts and ends writing an entry.
+  bool BeginEntry(const char* _name, uint64_t _type);
+  void EndEntry();
+
+  // Pack endianness.
+  Endianness endianness_;
+
+  // Pack header archive.
+  OArchive archive_;
+
+  // Position of the table of contents offset in the header.
+  int64_t toc_offset_position_;
+
+  // Entries added so far.
+  struct Entry {
+    ozz::string name;
+    uint64_t hash;
+    uint64_t type;
+    int64_t offset;
+    uint64_t size;
+  };
+  ozz::vector<Entry> entries_;
+
+  // Names hash of the entries added so far, to detect duplicates.
+  ozz::unordered_map<uint64_t, int> index_;
+
+  // Tells if the pack was finalized.
+  bool finalized_;
+};
+
+// Reads objects from a pack stream.
+class OZZ_BASE_DLL Pack {
+ public:
+  // Describes a pack entry.
+  struct Entry {
+    // Entry name and its hash.
+    ozz::string name;
+    uint64_t hash;
+
+    // Entry type, see PackType().
+    uint64_t type;
+
+    // Entry archive offset and size in the pack stream. Entries are sorted by
+    // offset, so loading them in order reads the stream sequentially.
+    int64_t offset;
+    uint64_t size;
+  };
+
+  // Constructs an empty pack, see Open().
+  Pack();
+
+  // Delete copies.
+  Pack(Pack const&) = delete;
+  Pack& operator=(Pack const&) = delete;
+
+  // Opens a pack from _stream, reading its table of contents. _stream must be
+  // seekable, and must remain valid until Close() or another Open().
+  // Returns false if _stream isn't a valid pack.
+  bool Open(Stream* _stream);
+
+  // Releases the stream and clears the table of contents.
+  void Close();
+
+  // Tests if a pack is opened.
+  bool opened() const { return stream_ != nullptr; }
+
+  // Gets the number of entries.
+  int num_entries() const { return static_cast<int>(entries_.size()); }
+
+  // Gets entry _index.
+  const Entry& entry(int _index) const;
+
+  // Finds the entry named _name, in O(1). Returns its index, or -1 if there's
+  // no such entry.
+  int Find(const char* _name) const;
+
+  // Loads entry _index to _object. The object can be loaded from another
+  // stream opened on the same pack (_stream), to load entries in parallel.
+  // Returns false if entry type doesn't match _Ty or loading failed.
+  template <typename _Ty>
+  bool Load(int _index, _Ty* _object, Stream* _stream = nullptr) const {
+    Stream* stream = _stream ? _stream : stream_;
+    if (!Seek(_index, PackType<_Ty>(), stream)) {
+      return false;
+    }
+    IArchive archive(stream);
+    if (!archive.TestTag<_Ty>()) {
+      return false;
+    }
+    archive >> *_object;
+    return true;
+  }
+
+  // Loads entry named _name to _object, see Load(int, ...).
+  template <typename _Ty>
+  bool Load(const char* _name, _Ty* _object, Stream* _stream = nullptr) const {
+    return Load(Find(_name), _object, _stream);
+  }
+
+ private:
+  // Seeks _stream to entry _index, checking its type.
+  bool Seek(int _index, uint64_t _type, Stream* _stream) const;
+
+  // The pack stream.
+  Stream* stream_;
+
+  // Table of contents.
+  ozz::vector<Entry> entries_;
+
+  // Entries indices, by name hash.
+  ozz::unordered_map<uint64_t, int> index_;
+};
+}  // namespace io
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_IO_PACK_H_
@@ -64,15 +64,17 @@ class OZZ_BASE_DLL Stream {
   };
   // Sets the position indicator associated with the stream to a new position
   // defined by adding _offset to a reference position specified by _origin.
+  // Offsets are 64 bits, so streams larger than 2GB (packed archives...) can
+  // be seeked.
   // Returns a zero value if successful, otherwise returns a non-zero value.
-  virtual int Seek(int _offset, Origin _origin) = 0;
+  virtual int Seek(int64_t _offset, Origin _origin) = 0;
 
   // Returns the current value of the position indicator of the stream.
   // Returns -1 if an error occurs.
-  virtual int Tell() const = 0;
+  virtual int64_t Tell() const = 0;
 
   // Returns the current size of the stream.
-  virtual size_t Size() const = 0;
+  virtual uint64_t Size() const = 0;
 
  protected:
   Stream() {}
@@ -118,19 +120,73 @@ class OZZ_BASE_DLL File : public Stream {
   virtual size_t Write(const void* _buffer, size_t _size);
 
   // See Stream::Seek for details.
-  virtual int Seek(int _offset, Origin _origin);
+  virtual int Seek(int64_t _offset, Origin _origin);
 
   // See Stream::Tell for details.
-  virtual int Tell() const;
+  virtual int64_t Tell() const;
 
   // See Stream::Tell for details.
-  virtual size_t Size() const;
+  virtual uint64_t Size() const;
 
  private:
   // The CRT file pointer.
   void* file_;
 };
 
+// Implements a read-only Stream of a memory mapped file. The whole file is
+// mapped when MappedFile is constructed, so reading is a bounded memcpy from
+// the mapping, and data() gives direct access to file content.
+class OZZ_BASE_DLL MappedFile : public Stream {
+ public:
+  // Maps the file at path _filename for reading.
+  // Use opened() function to test opening result.
+  explicit MappedFile(const char* _filename);
+
+  // Unmaps the file if it is opened.
+  virtual ~MappedFile();
+
+  // Unmaps the file if it is opened.
+  void Close();
+
+  // See Stream::opened for details.
+  virtual bool opened() const;
+
+  // See Stream::Read for details.
+  virtual size_t Read(void* _buffer, size_t _size);
+
+  // Mapped files are read-only, so writing always fails and returns 0.
+  virtual size_t Write(const void* _buffer, size_t _size);
+
+  // See Stream::Seek for details.
+  virtual int Seek(int64_t _offset, Origin _origin);
+
+  // See Stream::Tell for details.
+  virtual int64_t Tell() const;
+
+  // See Stream::Tell for details.
+  virtual uint64_t Size() const;
+
+  // Gets file mapped content, Size() bytes long. Returns nullptr if file
+  // isn't opened or is empty. Mapping is at least aligned to 16 bytes.
+  const byte* data() const { return data_; }
+
+ private:
+  // Mapped file content.
+  const byte* data_;
+
+  // Size of the file.
+  size_t size_;
+
+  // The cursor position.
+  int64_t tell_;
+
+  // Tells if the file was successfully opened, empty files aren't mapped.
+  bool opened_;
+
+  // Platform specific mapping handle.
+  void* handle_;
+};
+
 // Implements an in-memory Stream. Allows to use a memory buffer as a Stream.
 // The opening mode is equivalent to fopen w+b (binary read/write).
 class OZZ_BASE_DLL MemoryStream : public Stream {
@@ -151,13 +207,13 @@ class OZZ_BASE_DLL MemoryStream : public Stream {
   virtual size_t Write(const void* _buffer, size_t _size);
 
   // See Stream::Seek for details.
-  virtual int Seek(int _offset, Origin _origin);
+  virtual int Seek(int64_t _offset, Origin _origin);
 
   // See Stream::Tell for details.
-  virtual int Tell() const;
+  virtual int64_t Tell() const;
 
   // See Stream::Tell for details.
-  virtual size_t Size() const;
+  virtual uint64_t Size() const;
 
  private:
   // Resizes buffers size to _size bytes. If _size is less than the actual
@@ -179,10 +235,72 @@ class OZZ_BASE_DLL MemoryStream : public Stream {
   size_t alloc_size_;
 
   // The effective size of the data in the buffer.
-  int end_;
+  int64_t end_;
 
   // The cursor position in the buffer of data.
-  int tell_;
+  int64_t tell_;
+};
+
+// Implements a Stream decorator that buffers reads of another Stream. Data are
+// read ahead by blocks of buffer size, so that the many small reads issued by
+// archives (tags, versions, counts...) don't all reach the wrapped stream.
+// Reads bigger than the buffer, writes and seeks outside of buffered data are
+// forwarded to the wrapped stream.
+// The wrapped stream must outlive the BufferedStream, and shall not be used
+// directly meanwhile. Its position is restored to BufferedStream one when
+// BufferedStream is destroyed.
+class OZZ_BASE_DLL BufferedStream : public Stream {
+ public:
+  // Default size of the read-ahead buffer.
+  static const size_t kDefaultBufferSize;
+
+  // Wraps _stream, which must be a valid stream. _buffer_size is the size of
+  // the read-ahead buffer. A 0 size disables buffering.
+  explicit BufferedStream(Stream* _stream,
+                          size_t _buffer_size = kDefaultBufferSize);
+
+  // Restores wrapped stream position and deallocates the buffer.
+  virtual ~BufferedStream();
+
+  // See Stream::opened for details.
+  virtual bool opened() const;
+
+  // See Stream::Read for details.
+  virtual size_t Read(void* _buffer, size_t _size);
+
+  // See Stream::Write for details.
+  virtual size_t Write(const void* _buffer, size_t _size);
+
+  // See Stream::Seek for details.
+  virtual int Seek(int64_t _offset, Origin _origin);
+
+  // See Stream::Tell for details.
+  virtual int64_t Tell() const;
+
+  // See Stream::Tell for details.
+  virtual uint64_t Size() const;
+
+ private:
+  // Moves wrapped stream position back to the current position, and discards
+  // buffered data.
+  void Sync();
+
+  // The wrapped stream.
+  Stream* stream_;
+
+  // Read-ahead buffer, and its size.
+  byte* buffer_;
+  size_t capacity_;
+
+  // Position in the wrapped stream of the first byte of the buffer. Wrapped
+  // stream position is always begin_ + size_.
+  int64_t begin_;
+
+  // Number of bytes buffered.
+  size_t size_;
+
+  // Current position in the buffer, less or equal to size_.
+  size_t cursor_;
 };
 }  // namespace io
 }  // namespace ozz
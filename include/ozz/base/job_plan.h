@@ -0,0 +1,111 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_JOB_PLAN_H_
+#define OZZ_OZZ_BASE_JOB_PLAN_H_
+
+#include <cassert>
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Gets the generation of the data _job refers to, which changes when these data
+// are replaced in place (ie: Animation::Reload()), so that JobPlan detects its
+// job must be validated again. Jobs referring to such data overload this
+// function in their own namespace, others use this default that never changes.
+template <typename _Job>
+inline uint32_t JobGeneration(const _Job&) {
+  return 0;
+}
+
+// Stores a job (ie: SamplingJob, BlendingJob, LocalToModelJob, SkinningJob)
+// that is validated once, when the plan is built, and can then be executed
+// many times without the per-call validation done by the job Run() function.
+// This suits stable setups (same animation, context, buffers...) that are run
+// every frame.
+// Fields that aren't checked by job Validate() function (ie: sampling ratio,
+// buffers content, blending layer weights) can be changed between executions
+// through mutable_job(). Others must keep the job valid, which is asserted by
+// Execute() in debug builds only. Replacing job data in place (ie:
+// Animation::Reload()) is detected in all builds though, see JobGeneration().
+// _Job must declare JobPlan<_Job> as a friend and implement a RunUnchecked()
+// const function, which runs the valid job.
+template <typename _Job>
+class JobPlan {
+ public:
+  // Constructs an invalid plan.
+  JobPlan() : generation_(0), valid_(false) {}
+
+  // Constructs a plan from job _job, see Reset().
+  explicit JobPlan(const _Job& _job) { Reset(_job); }
+
+  // Copies and validates job _job.
+  // Returns true if _job is valid, false otherwise, in which case the plan
+  // can't be executed.
+  bool Reset(const _Job& _job) {
+    job_ = _job;
+    generation_ = JobGeneration(job_);
+    valid_ = job_.Validate();
+    return valid_;
+  }
+
+  // Tells if plan job was valid when the plan was built.
+  bool valid() const { return valid_; }
+
+  // Gets plan job.
+  const _Job& job() const { return job_; }
+
+  // Gets plan job, to change fields that don't affect its validity.
+  _Job* mutable_job() { return &job_; }
+
+  // Executes plan job, without validating it. Plan must be valid.
+  // Returns false, without running the job, if job data were replaced since
+  // the plan was built (ie: Animation::Reload()), in which case the plan must
+  // be Reset().
+  bool Execute() const {
+    assert(valid_ && "Plan job isn't valid.");
+    if (JobGeneration(job_) != generation_) {
+      return false;
+    }
+    assert(job_.Validate() && "Plan job was invalidated.");
+    job_.RunUnchecked();
+    return true;
+  }
+
+ private:
+  // The job, copied from the job description.
+  _Job job_;
+
+  // Generation of job data when the plan was built, see JobGeneration().
+  uint32_t generation_;
+
+  // Result of the job validation.
+  bool valid_;
+};
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_JOB_PLAN_H_
@@ -41,6 +41,16 @@
 // kStandard, kVerbose) to the std API, which can be set using
 // ozz::log::GetLevel function.
 // Usage conforms to std stream usage: ozz::log::Log() << "something to log."...
+// Logs can optionally be written asynchronously (see EnableAsync()), so that
+// logging threads never wait for i/o.
+
+// Maximum logging level built in, as a Level enum value. Logs of a higher
+// level are stripped: whatever the level set at runtime, they are directed to
+// a null stream that discards them without formatting. It's set by
+// ozz_build_log_level CMake option.
+#ifndef OZZ_LOG_MAX_LEVEL
+#define OZZ_LOG_MAX_LEVEL 2  // kVerbose
+#endif  // OZZ_LOG_MAX_LEVEL
 
 namespace ozz {
 namespace log {
@@ -54,14 +64,44 @@ enum Level {
 // Sets the global logging level.
 OZZ_BASE_DLL Level SetLevel(Level _level);
 
-// Gets the global logging level.
+// Gets the global logging level, which can't exceed OZZ_LOG_MAX_LEVEL.
 OZZ_BASE_DLL Level GetLevel();
 
+// Enables asynchronous logging. Enabled logs are formatted by the logging
+// thread into a thread local buffer, which is pushed to a lock-free ring
+// buffer of _capacity messages (rounded up to a power of 2, 2 at least) when
+// the logger is destroyed. A background thread writes them to their output
+// stream.
+// Logging never blocks: messages are dropped (see Dropped()) if the ring
+// buffer is full, and messages longer than a ring buffer slot are split in
+// chunks, which can be interleaved with concurrent logs.
+// Returns false if asynchronous logging is already enabled or _capacity is 0.
+// Enabling and disabling aren't thread safe, they must not be called while
+// other threads are logging.
+OZZ_BASE_DLL bool EnableAsync(size_t _capacity = 4096);
+
+// Writes pending messages and disables asynchronous logging. It's called
+// automatically on exit if asynchronous logging is still enabled.
+OZZ_BASE_DLL void DisableAsync();
+
+// Returns true if asynchronous logging is enabled.
+OZZ_BASE_DLL bool IsAsync();
+
+// Writes pending messages and flushes their output streams, before returning.
+// Should be called before writing directly to standard streams, to preserve
+// ordering. Does nothing if asynchronous logging is disabled.
+OZZ_BASE_DLL void Flush();
+
+// Returns the number of messages dropped because the ring buffer was full,
+// since asynchronous logging was enabled.
+OZZ_BASE_DLL size_t Dropped();
+
 // Implements logging base class.
 // This class is not intended to be used publicly, it is derived by user
 // classes LogV, Log, Out, Err...
-// Forwards ostream::operator << to a standard ostream or a silent
-// ostringstream according to the logging level at construction time.
+// Forwards ostream::operator << to a standard ostream, a thread local buffer
+// (asynchronous logging) or a null stream according to the logging level at
+// construction time.
 class OZZ_BASE_DLL Logger {
  public:
   // Forwards ostream::operator << for any type.
@@ -85,7 +125,7 @@ class OZZ_BASE_DLL Logger {
   // the current global logging level.
   Logger(std::ostream& _stream, Level _level);
 
-  // Destructor, deletes the internal "silent" stream.
+  // Destructor, pushes buffered output to asynchronous logging.
   ~Logger();
 
  private:
@@ -96,9 +136,9 @@ class OZZ_BASE_DLL Logger {
   // Selected output stream.
   std::ostream& stream_;
 
-  // Stores whether the stream is local one, in which case it must be deleted
-  // in the destructor.
-  bool local_stream_;
+  // Output stream of buffered logs, which are written when the logger is
+  // destroyed. nullptr if stream_ isn't a buffer.
+  std::ostream* target_;
 };
 
 // Logs verbose output to the standard error stream (std::clog).
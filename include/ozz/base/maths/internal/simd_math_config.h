@@ -34,6 +34,22 @@
 // forced.
 #if !defined(OZZ_BUILD_SIMD_REF)
 
+// Try to match an AArch64 NEON version. Msvc ARM64 isn't supported, as it
+// doesn't define NEON vectors as distinct types. ARMv7 NEON lacks some of the
+// required instructions (division, square root, lane copy), so it falls back to
+// the reference implementation.
+#if (defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))) || \
+    defined(OZZ_SIMD_NEON)
+#include <arm_neon.h>
+#define OZZ_SIMD_NEON
+
+// Try to match a WebAssembly SIMD128 version, enabled with emscripten
+// -msimd128 option.
+#elif defined(__wasm_simd128__) || defined(OZZ_SIMD_WASM)
+#include <wasm_simd128.h>
+#define OZZ_SIMD_WASM
+#else  // Not NEON nor WASM
+
 // Try to match a SSE2+ version.
 #if defined(__AVX2__) || defined(OZZ_SIMD_AVX2)
 #include <immintrin.h>
@@ -41,6 +57,14 @@
 #define OZZ_SIMD_AVX  // avx is available if avx2 is.
 #endif
 
+// F16C (half <-> float conversion) is a separate extension, but it's supported
+// by all AVX2 processors. Msvc doesn't define a specific macro for it.
+#if defined(__F16C__) || defined(OZZ_SIMD_F16C) || \
+    (defined(_MSC_VER) && defined(__AVX2__))
+#include <immintrin.h>
+#define OZZ_SIMD_F16C
+#endif
+
 #if defined(__FMA__) || defined(OZZ_SIMD_FMA)
 #include <immintrin.h>
 #define OZZ_SIMD_FMA
@@ -84,6 +108,7 @@
 #define OZZ_SIMD_SSE2
 #define OZZ_SIMD_SSEx  // OZZ_SIMD_SSEx is the generic flag for SSE support
 #endif
+#endif  // OZZ_SIMD_NEON || OZZ_SIMD_WASM
 
 // End of SIMD instruction detection
 #endif  // !OZZ_BUILD_SIMD_REF
@@ -108,6 +133,48 @@ typedef const __m128i _SimdInt4;
 }  // namespace math
 }  // namespace ozz
 
+// NEON intrinsics available
+#elif defined(OZZ_SIMD_NEON)
+
+namespace ozz {
+namespace math {
+
+// Vector of four floating point values.
+typedef float32x4_t SimdFloat4;
+
+// Argument type for Float4.
+typedef const float32x4_t _SimdFloat4;
+
+// Vector of four integer values.
+typedef int32x4_t SimdInt4;
+
+// Argument type for Int4.
+typedef const int32x4_t _SimdInt4;
+}  // namespace math
+}  // namespace ozz
+
+// WebAssembly SIMD128 intrinsics available
+#elif defined(OZZ_SIMD_WASM)
+
+namespace ozz {
+namespace math {
+
+// Vector of four floating point values. wasm_simd128.h defines a single v128_t
+// type for all vectors, so a float vector type is declared in order to
+// distinguish SimdFloat4 from SimdInt4 overloads.
+typedef float SimdFloat4 __attribute__((__vector_size__(16), __aligned__(16)));
+
+// Argument type for Float4.
+typedef const SimdFloat4 _SimdFloat4;
+
+// Vector of four integer values.
+typedef v128_t SimdInt4;
+
+// Argument type for Int4.
+typedef const v128_t _SimdInt4;
+}  // namespace math
+}  // namespace ozz
+
 #else  // No builtin simd available
 
 // No simd instruction set detected, switch back to reference implementation.
@@ -0,0 +1,1701 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_NEON_INL_H_
+#define OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_NEON_INL_H_
+
+// SIMD ARM NEON (AArch64) implementation.
+
+#include <stdint.h>
+
+#include <cassert>
+
+// Temporarly needed while trigonometric functions aren't implemented.
+#include <cmath>
+
+#include "ozz/base/maths/math_constant.h"
+
+namespace ozz {
+namespace math {
+
+namespace internal {
+// Returns (_a[_X], _a[_Y], _b[_Z], _b[_W]), the equivalent of SSE
+// _mm_shuffle_ps(_a, _b, _MM_SHUFFLE(_W, _Z, _Y, _X)).
+template <int _X, int _Y, int _Z, int _W>
+OZZ_INLINE float32x4_t NeonShuffle(float32x4_t _a, float32x4_t _b) {
+  const float32x4_t x = vdupq_laneq_f32(_a, _X);
+  const float32x4_t xy = vcopyq_laneq_f32(x, 1, _a, _Y);
+  const float32x4_t xyz = vcopyq_laneq_f32(xy, 2, _b, _Z);
+  return vcopyq_laneq_f32(xyz, 3, _b, _W);
+}
+
+// Integer version of NeonShuffle.
+template <int _X, int _Y, int _Z, int _W>
+OZZ_INLINE int32x4_t NeonShuffleI(int32x4_t _a, int32x4_t _b) {
+  const int32x4_t x = vdupq_laneq_s32(_a, _X);
+  const int32x4_t xy = vcopyq_laneq_s32(x, 1, _a, _Y);
+  const int32x4_t xyz = vcopyq_laneq_s32(xy, 2, _b, _Z);
+  return vcopyq_laneq_s32(xyz, 3, _b, _W);
+}
+}  // namespace internal
+
+// Internal macros.
+// Unused components of the result vector are replicated from the first input
+// argument.
+
+#define OZZ_NEON_SPLAT_F(_v, _i) vdupq_laneq_f32(_v, _i)
+
+#define OZZ_NEON_SPLAT_I(_v, _i) vdupq_laneq_s32(_v, _i)
+
+// Shuffles components of _v, with the same argument order as Swizzle.
+#define OZZ_NEON_SWIZZLE_F(_v, _x, _y, _z, _w) \
+  internal::NeonShuffle<_x, _y, _z, _w>(_v, _v)
+
+// Sets x component of _v to x component of _f.
+#define OZZ_NEON_MOVE_X_F(_v, _f) vcopyq_laneq_f32(_v, 0, _f, 0)
+
+#define OZZ_NEON_CAST_F(_i) vreinterpretq_f32_s32(_i)
+#define OZZ_NEON_CAST_I(_f) vreinterpretq_s32_f32(_f)
+#define OZZ_NEON_MASK_I(_u) vreinterpretq_s32_u32(_u)
+#define OZZ_NEON_MASK_U(_i) vreinterpretq_u32_s32(_i)
+
+// _v.x + _v.y, ?, ?, ?
+#define OZZ_NEON_HADD2_F(_v) vpaddq_f32(_v, _v)
+
+// _v.x + _v.y + _v.z, ?, ?, ?
+#define OZZ_NEON_HADD3_F(_v) \
+  vaddq_f32(vpaddq_f32(_v, _v), OZZ_NEON_SPLAT_F(_v, 2))
+
+// _v.x + _v.y + _v.z + _v.w, ?, ?, ?
+#define OZZ_NEON_HADD4_F(_v) vdupq_n_f32(vaddvq_f32(_v))
+
+// FMA operations, natively supported by AArch64.
+#define OZZ_MADD(_a, _b, _c) vfmaq_f32(_c, _a, _b)
+#define OZZ_MSUB(_a, _b, _c) vnegq_f32(vfmsq_f32(_c, _a, _b))
+#define OZZ_NMADD(_a, _b, _c) vfmsq_f32(_c, _a, _b)
+#define OZZ_NMSUB(_a, _b, _c) vnegq_f32(vfmaq_f32(_c, _a, _b))
+
+// Selects bits from _true where _b bits are set, from _false otherwise.
+#define OZZ_NEON_SELECT_F(_b, _true, _false) \
+  vbslq_f32(OZZ_NEON_MASK_U(_b), _true, _false)
+
+#define OZZ_NEON_SELECT_I(_b, _true, _false) \
+  vbslq_s32(OZZ_NEON_MASK_U(_b), _true, _false)
+
+// NEON reciprocal and reciprocal square root estimations are only 8 bits
+// accurate, which is less than SSE ones (12 bits). A Newton-Raphson step is
+// thus always added to estimations, to reach an equivalent precision.
+#define OZZ_NEON_RCP_NR(_v, _e) vmulq_f32(vrecpsq_f32(_v, _e), _e)
+#define OZZ_NEON_RSQRT_NR(_v, _e) \
+  vmulq_f32(vrsqrtsq_f32(vmulq_f32(_v, _e), _e), _e)
+
+namespace simd_float4 {
+
+OZZ_INLINE SimdFloat4 zero() { return vdupq_n_f32(0.f); }
+
+OZZ_INLINE SimdFloat4 one() { return vdupq_n_f32(1.f); }
+
+OZZ_INLINE SimdFloat4 x_axis() { return vsetq_lane_f32(1.f, zero(), 0); }
+
+OZZ_INLINE SimdFloat4 y_axis() { return vsetq_lane_f32(1.f, zero(), 1); }
+
+OZZ_INLINE SimdFloat4 z_axis() { return vsetq_lane_f32(1.f, zero(), 2); }
+
+OZZ_INLINE SimdFloat4 w_axis() { return vsetq_lane_f32(1.f, zero(), 3); }
+
+OZZ_INLINE SimdFloat4 Load(float _x, float _y, float _z, float _w) {
+  const float f[4] = {_x, _y, _z, _w};
+  return vld1q_f32(f);
+}
+
+OZZ_INLINE SimdFloat4 LoadX(float _x) { return vsetq_lane_f32(_x, zero(), 0); }
+
+OZZ_INLINE SimdFloat4 Load1(float _x) { return vdupq_n_f32(_x); }
+
+OZZ_INLINE SimdFloat4 LoadPtr(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  return vld1q_f32(_f);
+}
+
+OZZ_INLINE SimdFloat4 LoadPtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vld1q_f32(_f);
+}
+
+OZZ_INLINE SimdFloat4 LoadXPtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vld1q_lane_f32(_f, zero(), 0);
+}
+
+OZZ_INLINE SimdFloat4 Load1PtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vld1q_dup_f32(_f);
+}
+
+OZZ_INLINE SimdFloat4 Load2PtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vcombine_f32(vld1_f32(_f), vdup_n_f32(0.f));
+}
+
+OZZ_INLINE SimdFloat4 Load3PtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return vcombine_f32(vld1_f32(_f), vld1_lane_f32(_f + 2, vdup_n_f32(0.f), 0));
+}
+
+OZZ_INLINE SimdFloat4 FromInt(_SimdInt4 _i) { return vcvtq_f32_s32(_i); }
+}  // namespace simd_float4
+
+OZZ_INLINE float GetX(_SimdFloat4 _v) { return vgetq_lane_f32(_v, 0); }
+
+OZZ_INLINE float GetY(_SimdFloat4 _v) { return vgetq_lane_f32(_v, 1); }
+
+OZZ_INLINE float GetZ(_SimdFloat4 _v) { return vgetq_lane_f32(_v, 2); }
+
+OZZ_INLINE float GetW(_SimdFloat4 _v) { return vgetq_lane_f32(_v, 3); }
+
+OZZ_INLINE SimdFloat4 SetX(_SimdFloat4 _v, _SimdFloat4 _f) {
+  return vcopyq_laneq_f32(_v, 0, _f, 0);
+}
+
+OZZ_INLINE SimdFloat4 SetY(_SimdFloat4 _v, _SimdFloat4 _f) {
+  return vcopyq_laneq_f32(_v, 1, _f, 0);
+}
+
+OZZ_INLINE SimdFloat4 SetZ(_SimdFloat4 _v, _SimdFloat4 _f) {
+  return vcopyq_laneq_f32(_v, 2, _f, 0);
+}
+
+OZZ_INLINE SimdFloat4 SetW(_SimdFloat4 _v, _SimdFloat4 _f) {
+  return vcopyq_laneq_f32(_v, 3, _f, 0);
+}
+
+OZZ_INLINE SimdFloat4 SetI(_SimdFloat4 _v, _SimdFloat4 _f, int _ith) {
+  assert(_ith >= 0 && _ith <= 3 && "Invalid index, out of range.");
+  union {
+    SimdFloat4 ret;
+    float af[4];
+  } u = {_v};
+  u.af[_ith] = GetX(_f);
+  return u.ret;
+}
+
+OZZ_INLINE void StorePtr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  vst1q_f32(_f, _v);
+}
+
+OZZ_INLINE void Store1Ptr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  vst1q_lane_f32(_f, _v, 0);
+}
+
+OZZ_INLINE void Store2Ptr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  vst1_f32(_f, vget_low_f32(_v));
+}
+
+OZZ_INLINE void Store3Ptr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  vst1_f32(_f, vget_low_f32(_v));
+  vst1q_lane_f32(_f + 2, _v, 2);
+}
+
+OZZ_INLINE void StorePtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  vst1q_f32(_f, _v);
+}
+
+OZZ_INLINE void Store1PtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  vst1q_lane_f32(_f, _v, 0);
+}
+
+OZZ_INLINE void Store2PtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  vst1_f32(_f, vget_low_f32(_v));
+}
+
+OZZ_INLINE void Store3PtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  vst1_f32(_f, vget_low_f32(_v));
+  vst1q_lane_f32(_f + 2, _v, 2);
+}
+
+// Non-temporal stores aren't exposed, they fall back to regular stores.
+OZZ_INLINE void StreamPtr(_SimdFloat4 _v, float* _f) { StorePtr(_v, _f); }
+
+OZZ_INLINE void Stream3PtrU(_SimdFloat4 _v, float* _f) { Store3PtrU(_v, _f); }
+
+OZZ_INLINE void StreamFence() {}
+
+OZZ_INLINE SimdFloat4 SplatX(_SimdFloat4 _v) { return OZZ_NEON_SPLAT_F(_v, 0); }
+
+OZZ_INLINE SimdFloat4 SplatY(_SimdFloat4 _v) { return OZZ_NEON_SPLAT_F(_v, 1); }
+
+OZZ_INLINE SimdFloat4 SplatZ(_SimdFloat4 _v) { return OZZ_NEON_SPLAT_F(_v, 2); }
+
+OZZ_INLINE SimdFloat4 SplatW(_SimdFloat4 _v) { return OZZ_NEON_SPLAT_F(_v, 3); }
+
+template <size_t _X, size_t _Y, size_t _Z, size_t _W>
+OZZ_INLINE SimdFloat4 Swizzle(_SimdFloat4 _v) {
+  static_assert(_X <= 3 && _Y <= 3 && _Z <= 3 && _W <= 3,
+                "Indices must be between 0 and 3");
+  return internal::NeonShuffle<_X, _Y, _Z, _W>(_v, _v);
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<0, 1, 2, 3>(_SimdFloat4 _v) {
+  return _v;
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<0, 1, 0, 1>(_SimdFloat4 _v) {
+  return vcombine_f32(vget_low_f32(_v), vget_low_f32(_v));
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<2, 3, 2, 3>(_SimdFloat4 _v) {
+  return vcombine_f32(vget_high_f32(_v), vget_high_f32(_v));
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<0, 0, 1, 1>(_SimdFloat4 _v) {
+  return vzip1q_f32(_v, _v);
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<2, 2, 3, 3>(_SimdFloat4 _v) {
+  return vzip2q_f32(_v, _v);
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<1, 0, 3, 2>(_SimdFloat4 _v) {
+  return vrev64q_f32(_v);
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<2, 3, 0, 1>(_SimdFloat4 _v) {
+  return vextq_f32(_v, _v, 2);
+}
+
+OZZ_INLINE void Transpose4x1(const SimdFloat4 _in[4], SimdFloat4 _out[1]) {
+  const float32x4_t xz = vzip1q_f32(_in[0], _in[2]);
+  const float32x4_t yw = vzip1q_f32(_in[1], _in[3]);
+  _out[0] = vzip1q_f32(xz, yw);
+}
+
+OZZ_INLINE void Transpose1x4(const SimdFloat4 _in[1], SimdFloat4 _out[4]) {
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  _out[0] = vcopyq_laneq_f32(zero, 0, _in[0], 0);
+  _out[1] = vcopyq_laneq_f32(zero, 0, _in[0], 1);
+  _out[2] = vcopyq_laneq_f32(zero, 0, _in[0], 2);
+  _out[3] = vcopyq_laneq_f32(zero, 0, _in[0], 3);
+}
+
+OZZ_INLINE void Transpose4x2(const SimdFloat4 _in[4], SimdFloat4 _out[2]) {
+  const float32x4_t tmp0 = vzip1q_f32(_in[0], _in[2]);
+  const float32x4_t tmp1 = vzip1q_f32(_in[1], _in[3]);
+  _out[0] = vzip1q_f32(tmp0, tmp1);
+  _out[1] = vzip2q_f32(tmp0, tmp1);
+}
+
+OZZ_INLINE void Transpose2x4(const SimdFloat4 _in[2], SimdFloat4 _out[4]) {
+  const float32x4_t tmp0 = vzip1q_f32(_in[0], _in[1]);
+  const float32x4_t tmp1 = vzip2q_f32(_in[0], _in[1]);
+  const float32x2_t zero = vdup_n_f32(0.f);
+  _out[0] = vcombine_f32(vget_low_f32(tmp0), zero);
+  _out[1] = vcombine_f32(vget_high_f32(tmp0), zero);
+  _out[2] = vcombine_f32(vget_low_f32(tmp1), zero);
+  _out[3] = vcombine_f32(vget_high_f32(tmp1), zero);
+}
+
+OZZ_INLINE void Transpose4x3(const SimdFloat4 _in[4], SimdFloat4 _out[3]) {
+  const float32x4_t tmp0 = vzip1q_f32(_in[0], _in[2]);
+  const float32x4_t tmp1 = vzip1q_f32(_in[1], _in[3]);
+  const float32x4_t tmp2 = vzip2q_f32(_in[0], _in[2]);
+  const float32x4_t tmp3 = vzip2q_f32(_in[1], _in[3]);
+  _out[0] = vzip1q_f32(tmp0, tmp1);
+  _out[1] = vzip2q_f32(tmp0, tmp1);
+  _out[2] = vzip1q_f32(tmp2, tmp3);
+}
+
+OZZ_INLINE void Transpose3x4(const SimdFloat4 _in[3], SimdFloat4 _out[4]) {
+  const float32x4_t zero = vdupq_n_f32(0.f);
+  const float32x4_t temp0 = vzip1q_f32(_in[0], _in[1]);
+  const float32x4_t temp1 = vzip1q_f32(_in[2], zero);
+  const float32x4_t temp2 = vzip2q_f32(_in[0], _in[1]);
+  const float32x4_t temp3 = vzip2q_f32(_in[2], zero);
+  _out[0] = vcombine_f32(vget_low_f32(temp0), vget_low_f32(temp1));
+  _out[1] = vcombine_f32(vget_high_f32(temp0), vget_high_f32(temp1));
+  _out[2] = vcombine_f32(vget_low_f32(temp2), vget_low_f32(temp3));
+  _out[3] = vcombine_f32(vget_high_f32(temp2), vget_high_f32(temp3));
+}
+
+OZZ_INLINE void Transpose4x4(const SimdFloat4 _in[4], SimdFloat4 _out[4]) {
+  const float32x4_t tmp0 = vzip1q_f32(_in[0], _in[2]);
+  const float32x4_t tmp1 = vzip1q_f32(_in[1], _in[3]);
+  const float32x4_t tmp2 = vzip2q_f32(_in[0], _in[2]);
+  const float32x4_t tmp3 = vzip2q_f32(_in[1], _in[3]);
+  _out[0] = vzip1q_f32(tmp0, tmp1);
+  _out[1] = vzip2q_f32(tmp0, tmp1);
+  _out[2] = vzip1q_f32(tmp2, tmp3);
+  _out[3] = vzip2q_f32(tmp2, tmp3);
+}
+
+OZZ_INLINE void Transpose16x16(const SimdFloat4 _in[16], SimdFloat4 _out[16]) {
+  const float32x4_t tmp0 = vzip1q_f32(_in[0], _in[2]);
+  const float32x4_t tmp1 = vzip1q_f32(_in[1], _in[3]);
+  _out[0] = vzip1q_f32(tmp0, tmp1);
+  _out[4] = vzip2q_f32(tmp0, tmp1);
+  const float32x4_t tmp2 = vzip2q_f32(_in[0], _in[2]);
+  const float32x4_t tmp3 = vzip2q_f32(_in[1], _in[3]);
+  _out[8] = vzip1q_f32(tmp2, tmp3);
+  _out[12] = vzip2q_f32(tmp2, tmp3);
+  const float32x4_t tmp4 = vzip1q_f32(_in[4], _in[6]);
+  const float32x4_t tmp5 = vzip1q_f32(_in[5], _in[7]);
+  _out[1] = vzip1q_f32(tmp4, tmp5);
+  _out[5] = vzip2q_f32(tmp4, tmp5);
+  const float32x4_t tmp6 = vzip2q_f32(_in[4], _in[6]);
+  const float32x4_t tmp7 = vzip2q_f32(_in[5], _in[7]);
+  _out[9] = vzip1q_f32(tmp6, tmp7);
+  _out[13] = vzip2q_f32(tmp6, tmp7);
+  const float32x4_t tmp8 = vzip1q_f32(_in[8], _in[10]);
+  const float32x4_t tmp9 = vzip1q_f32(_in[9], _in[11]);
+  _out[2] = vzip1q_f32(tmp8, tmp9);
+  _out[6] = vzip2q_f32(tmp8, tmp9);
+  const float32x4_t tmp10 = vzip2q_f32(_in[8], _in[10]);
+  const float32x4_t tmp11 = vzip2q_f32(_in[9], _in[11]);
+  _out[10] = vzip1q_f32(tmp10, tmp11);
+  _out[14] = vzip2q_f32(tmp10, tmp11);
+  const float32x4_t tmp12 = vzip1q_f32(_in[12], _in[14]);
+  const float32x4_t tmp13 = vzip1q_f32(_in[13], _in[15]);
+  _out[3] = vzip1q_f32(tmp12, tmp13);
+  _out[7] = vzip2q_f32(tmp12, tmp13);
+  const float32x4_t tmp14 = vzip2q_f32(_in[12], _in[14]);
+  const float32x4_t tmp15 = vzip2q_f32(_in[13], _in[15]);
+  _out[11] = vzip1q_f32(tmp14, tmp15);
+  _out[15] = vzip2q_f32(tmp14, tmp15);
+}
+
+OZZ_INLINE SimdFloat4 MAdd(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _c) {
+  return OZZ_MADD(_a, _b, _c);
+}
+
+OZZ_INLINE SimdFloat4 MSub(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _c) {
+  return OZZ_MSUB(_a, _b, _c);
+}
+
+OZZ_INLINE SimdFloat4 NMAdd(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _c) {
+  return OZZ_NMADD(_a, _b, _c);
+}
+
+OZZ_INLINE SimdFloat4 NMSub(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _c) {
+  return OZZ_NMSUB(_a, _b, _c);
+}
+
+OZZ_INLINE SimdFloat4 DivX(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_MOVE_X_F(_a, vdivq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdFloat4 HAdd2(_SimdFloat4 _v) {
+  return OZZ_NEON_MOVE_X_F(_v, OZZ_NEON_HADD2_F(_v));
+}
+
+OZZ_INLINE SimdFloat4 HAdd3(_SimdFloat4 _v) {
+  return OZZ_NEON_MOVE_X_F(_v, OZZ_NEON_HADD3_F(_v));
+}
+
+OZZ_INLINE SimdFloat4 HAdd4(_SimdFloat4 _v) {
+  return vsetq_lane_f32(vaddvq_f32(_v), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 Dot2(_SimdFloat4 _a, _SimdFloat4 _b) {
+  const float32x4_t ab = vmulq_f32(_a, _b);
+  return OZZ_NEON_HADD2_F(ab);
+}
+
+OZZ_INLINE SimdFloat4 Dot3(_SimdFloat4 _a, _SimdFloat4 _b) {
+  const float32x4_t ab = vmulq_f32(_a, _b);
+  return OZZ_NEON_HADD3_F(ab);
+}
+
+OZZ_INLINE SimdFloat4 Dot4(_SimdFloat4 _a, _SimdFloat4 _b) {
+  const float32x4_t ab = vmulq_f32(_a, _b);
+  return OZZ_NEON_HADD4_F(ab);
+}
+
+OZZ_INLINE SimdFloat4 Cross3(_SimdFloat4 _a, _SimdFloat4 _b) {
+  // Implementation with 3 shuffles only is based on:
+  // https://geometrian.com/programming/tutorials/cross-product
+  const float32x4_t shufa = OZZ_NEON_SWIZZLE_F(_a, 1, 2, 0, 3);
+  const float32x4_t shufb = OZZ_NEON_SWIZZLE_F(_b, 1, 2, 0, 3);
+  // Products aren't fused, so that w components cancel out exactly.
+  const float32x4_t shufc =
+      vsubq_f32(vmulq_f32(_a, shufb), vmulq_f32(_b, shufa));
+  return OZZ_NEON_SWIZZLE_F(shufc, 1, 2, 0, 3);
+}
+
+OZZ_INLINE SimdFloat4 RcpEst(_SimdFloat4 _v) {
+  const float32x4_t est = vrecpeq_f32(_v);
+  return OZZ_NEON_RCP_NR(_v, est);
+}
+
+OZZ_INLINE SimdFloat4 RcpEstNR(_SimdFloat4 _v) {
+  const float32x4_t est = RcpEst(_v);
+  // Do one more Newton-Raphson step to improve precision.
+  return OZZ_NEON_RCP_NR(_v, est);
+}
+
+OZZ_INLINE SimdFloat4 RcpEstX(_SimdFloat4 _v) {
+  return OZZ_NEON_MOVE_X_F(_v, RcpEst(_v));
+}
+
+OZZ_INLINE SimdFloat4 RcpEstXNR(_SimdFloat4 _v) {
+  return OZZ_NEON_MOVE_X_F(_v, RcpEstNR(_v));
+}
+
+OZZ_INLINE SimdFloat4 Sqrt(_SimdFloat4 _v) { return vsqrtq_f32(_v); }
+
+OZZ_INLINE SimdFloat4 SqrtX(_SimdFloat4 _v) {
+  return OZZ_NEON_MOVE_X_F(_v, vsqrtq_f32(_v));
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEst(_SimdFloat4 _v) {
+  const float32x4_t est = vrsqrteq_f32(_v);
+  return OZZ_NEON_RSQRT_NR(_v, est);
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEstNR(_SimdFloat4 _v) {
+  const float32x4_t est = RSqrtEst(_v);
+  // Do one more Newton-Raphson step to improve precision.
+  return OZZ_NEON_RSQRT_NR(_v, est);
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEstX(_SimdFloat4 _v) {
+  return OZZ_NEON_MOVE_X_F(_v, RSqrtEst(_v));
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEstXNR(_SimdFloat4 _v) {
+  return OZZ_NEON_MOVE_X_F(_v, RSqrtEstNR(_v));
+}
+
+OZZ_INLINE SimdFloat4 Abs(_SimdFloat4 _v) { return vabsq_f32(_v); }
+
+OZZ_INLINE SimdInt4 Sign(_SimdFloat4 _v) {
+  return OZZ_NEON_MASK_I(
+      vandq_u32(vreinterpretq_u32_f32(_v), vdupq_n_u32(0x80000000u)));
+}
+
+OZZ_INLINE SimdFloat4 Length2(_SimdFloat4 _v) {
+  return vsqrtq_f32(Dot2(_v, _v));
+}
+
+OZZ_INLINE SimdFloat4 Length3(_SimdFloat4 _v) {
+  return vsqrtq_f32(Dot3(_v, _v));
+}
+
+OZZ_INLINE SimdFloat4 Length4(_SimdFloat4 _v) {
+  return vsqrtq_f32(Dot4(_v, _v));
+}
+
+OZZ_INLINE SimdFloat4 Length2Sqr(_SimdFloat4 _v) { return Dot2(_v, _v); }
+
+OZZ_INLINE SimdFloat4 Length3Sqr(_SimdFloat4 _v) { return Dot3(_v, _v); }
+
+OZZ_INLINE SimdFloat4 Length4Sqr(_SimdFloat4 _v) { return Dot4(_v, _v); }
+
+OZZ_INLINE SimdFloat4 Normalize2(_SimdFloat4 _v) {
+  const float32x4_t sq_len = OZZ_NEON_SPLAT_F(Dot2(_v, _v), 0);
+  assert(GetX(sq_len) != 0.f && "_v is not normalizable");
+  const float32x4_t inv_len = vdivq_f32(simd_float4::one(), vsqrtq_f32(sq_len));
+  const float32x4_t norm = vmulq_f32(_v, inv_len);
+  return vcombine_f32(vget_low_f32(norm), vget_high_f32(_v));
+}
+
+OZZ_INLINE SimdFloat4 Normalize3(_SimdFloat4 _v) {
+  const float32x4_t sq_len = OZZ_NEON_SPLAT_F(Dot3(_v, _v), 0);
+  assert(GetX(sq_len) != 0.f && "_v is not normalizable");
+  const float32x4_t inv_len = vdivq_f32(simd_float4::one(), vsqrtq_f32(sq_len));
+  return vcopyq_laneq_f32(vmulq_f32(_v, inv_len), 3, _v, 3);
+}
+
+OZZ_INLINE SimdFloat4 Normalize4(_SimdFloat4 _v) {
+  const float32x4_t sq_len = OZZ_NEON_SPLAT_F(Dot4(_v, _v), 0);
+  assert(GetX(sq_len) != 0.f && "_v is not normalizable");
+  const float32x4_t inv_len = vdivq_f32(simd_float4::one(), vsqrtq_f32(sq_len));
+  return vmulq_f32(_v, inv_len);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeEst2(_SimdFloat4 _v) {
+  const float32x4_t sq_len = OZZ_NEON_SPLAT_F(Dot2(_v, _v), 0);
+  assert(GetX(sq_len) != 0.f && "_v is not normalizable");
+  const float32x4_t norm = vmulq_f32(_v, RSqrtEst(sq_len));
+  return vcombine_f32(vget_low_f32(norm), vget_high_f32(_v));
+}
+
+OZZ_INLINE SimdFloat4 NormalizeEst3(_SimdFloat4 _v) {
+  const float32x4_t sq_len = OZZ_NEON_SPLAT_F(Dot3(_v, _v), 0);
+  assert(GetX(sq_len) != 0.f && "_v is not normalizable");
+  return vcopyq_laneq_f32(vmulq_f32(_v, RSqrtEst(sq_len)), 3, _v, 3);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeEst4(_SimdFloat4 _v) {
+  const float32x4_t sq_len = OZZ_NEON_SPLAT_F(Dot4(_v, _v), 0);
+  assert(GetX(sq_len) != 0.f && "_v is not normalizable");
+  return vmulq_f32(_v, RSqrtEst(sq_len));
+}
+
+namespace internal {
+// Tests if x component of _sq_len is within ]_min,_max[. Other components of
+// the returned mask are false.
+OZZ_INLINE SimdInt4 NeonIsNormalizedX(_SimdFloat4 _sq_len, float _tolerance) {
+  const float32x4_t max = vdupq_n_f32(1.f + _tolerance);
+  const float32x4_t min = vdupq_n_f32(1.f - _tolerance);
+  const uint32x4_t normalized =
+      vandq_u32(vcltq_f32(_sq_len, max), vcgtq_f32(_sq_len, min));
+  return OZZ_NEON_MASK_I(vcopyq_laneq_u32(vdupq_n_u32(0), 0, normalized, 0));
+}
+}  // namespace internal
+
+OZZ_INLINE SimdInt4 IsNormalized2(_SimdFloat4 _v) {
+  return internal::NeonIsNormalizedX(Dot2(_v, _v), kNormalizationToleranceSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalized3(_SimdFloat4 _v) {
+  return internal::NeonIsNormalizedX(Dot3(_v, _v), kNormalizationToleranceSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalized4(_SimdFloat4 _v) {
+  return internal::NeonIsNormalizedX(Dot4(_v, _v), kNormalizationToleranceSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalizedEst2(_SimdFloat4 _v) {
+  return internal::NeonIsNormalizedX(Dot2(_v, _v),
+                                     kNormalizationToleranceEstSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalizedEst3(_SimdFloat4 _v) {
+  return internal::NeonIsNormalizedX(Dot3(_v, _v),
+                                     kNormalizationToleranceEstSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalizedEst4(_SimdFloat4 _v) {
+  return internal::NeonIsNormalizedX(Dot4(_v, _v),
+                                     kNormalizationToleranceEstSq);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafe2(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalized2(_safe)) && "_safe is not normalized");
+  const float32x4_t sq_len = OZZ_NEON_SPLAT_F(Dot2(_v, _v), 0);
+  const float32x4_t inv_len = vdivq_f32(simd_float4::one(), vsqrtq_f32(sq_len));
+  const float32x4_t norm = vmulq_f32(_v, inv_len);
+  const uint32x4_t cond = vcleq_f32(sq_len, simd_float4::zero());
+  const float32x4_t cfalse =
+      vcombine_f32(vget_low_f32(norm), vget_high_f32(_v));
+  return vbslq_f32(cond, _safe, cfalse);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafe3(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalized3(_safe)) && "_safe is not normalized");
+  const float32x4_t sq_len = OZZ_NEON_SPLAT_F(Dot3(_v, _v), 0);
+  const float32x4_t inv_len = vdivq_f32(simd_float4::one(), vsqrtq_f32(sq_len));
+  const uint32x4_t cond = vcleq_f32(sq_len, simd_float4::zero());
+  const float32x4_t cfalse =
+      vcopyq_laneq_f32(vmulq_f32(_v, inv_len), 3, _v, 3);
+  return vbslq_f32(cond, _safe, cfalse);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafe4(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalized4(_safe)) && "_safe is not normalized");
+  const float32x4_t sq_len = OZZ_NEON_SPLAT_F(Dot4(_v, _v), 0);
+  const float32x4_t inv_len = vdivq_f32(simd_float4::one(), vsqrtq_f32(sq_len));
+  const uint32x4_t cond = vcleq_f32(sq_len, simd_float4::zero());
+  const float32x4_t cfalse = vmulq_f32(_v, inv_len);
+  return vbslq_f32(cond, _safe, cfalse);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafeEst2(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalizedEst2(_safe)) && "_safe is not normalized");
+  const float32x4_t sq_len = OZZ_NEON_SPLAT_F(Dot2(_v, _v), 0);
+  const float32x4_t norm = vmulq_f32(_v, RSqrtEst(sq_len));
+  const uint32x4_t cond = vcleq_f32(sq_len, simd_float4::zero());
+  const float32x4_t cfalse =
+      vcombine_f32(vget_low_f32(norm), vget_high_f32(_v));
+  return vbslq_f32(cond, _safe, cfalse);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafeEst3(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalizedEst3(_safe)) && "_safe is not normalized");
+  const float32x4_t sq_len = OZZ_NEON_SPLAT_F(Dot3(_v, _v), 0);
+  const uint32x4_t cond = vcleq_f32(sq_len, simd_float4::zero());
+  const float32x4_t cfalse =
+      vcopyq_laneq_f32(vmulq_f32(_v, RSqrtEst(sq_len)), 3, _v, 3);
+  return vbslq_f32(cond, _safe, cfalse);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafeEst4(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalizedEst4(_safe)) && "_safe is not normalized");
+  const float32x4_t sq_len = OZZ_NEON_SPLAT_F(Dot4(_v, _v), 0);
+  const uint32x4_t cond = vcleq_f32(sq_len, simd_float4::zero());
+  const float32x4_t cfalse = vmulq_f32(_v, RSqrtEst(sq_len));
+  return vbslq_f32(cond, _safe, cfalse);
+}
+
+OZZ_INLINE SimdFloat4 Lerp(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _alpha) {
+  return OZZ_MADD(_alpha, vsubq_f32(_b, _a), _a);
+}
+
+// Min and Max use "number" variants, so that a NaN input doesn't propagate to
+// the result, similarly to SSE and reference implementations. Clamp relies on
+// it.
+OZZ_INLINE SimdFloat4 Min(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vminnmq_f32(_a, _b);
+}
+
+OZZ_INLINE SimdFloat4 Max(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return vmaxnmq_f32(_a, _b);
+}
+
+OZZ_INLINE SimdFloat4 Min0(_SimdFloat4 _v) {
+  return vminnmq_f32(simd_float4::zero(), _v);
+}
+
+OZZ_INLINE SimdFloat4 Max0(_SimdFloat4 _v) {
+  return vmaxnmq_f32(simd_float4::zero(), _v);
+}
+
+OZZ_INLINE SimdFloat4 Clamp(_SimdFloat4 _a, _SimdFloat4 _v, _SimdFloat4 _b) {
+  return vmaxnmq_f32(_a, vminnmq_f32(_v, _b));
+}
+
+OZZ_INLINE SimdFloat4 Select(_SimdInt4 _b, _SimdFloat4 _true,
+                             _SimdFloat4 _false) {
+  return OZZ_NEON_SELECT_F(_b, _true, _false);
+}
+
+OZZ_INLINE SimdInt4 CmpEq(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_MASK_I(vceqq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpNe(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_MASK_I(vmvnq_u32(vceqq_f32(_a, _b)));
+}
+
+OZZ_INLINE SimdInt4 CmpLt(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_MASK_I(vcltq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpLe(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_MASK_I(vcleq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpGt(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_MASK_I(vcgtq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpGe(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_MASK_I(vcgeq_f32(_a, _b));
+}
+
+OZZ_INLINE SimdFloat4 And(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_CAST_F(vandq_s32(OZZ_NEON_CAST_I(_a), OZZ_NEON_CAST_I(_b)));
+}
+
+OZZ_INLINE SimdFloat4 Or(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_CAST_F(vorrq_s32(OZZ_NEON_CAST_I(_a), OZZ_NEON_CAST_I(_b)));
+}
+
+OZZ_INLINE SimdFloat4 Xor(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_NEON_CAST_F(veorq_s32(OZZ_NEON_CAST_I(_a), OZZ_NEON_CAST_I(_b)));
+}
+
+OZZ_INLINE SimdFloat4 And(_SimdFloat4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_CAST_F(vandq_s32(OZZ_NEON_CAST_I(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 AndNot(_SimdFloat4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_CAST_F(vbicq_s32(OZZ_NEON_CAST_I(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 Or(_SimdFloat4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_CAST_F(vorrq_s32(OZZ_NEON_CAST_I(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 Xor(_SimdFloat4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_CAST_F(veorq_s32(OZZ_NEON_CAST_I(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 Cos(_SimdFloat4 _v) {
+  return simd_float4::Load(std::cos(GetX(_v)), std::cos(GetY(_v)),
+                           std::cos(GetZ(_v)), std::cos(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 CosX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::cos(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 ACos(_SimdFloat4 _v) {
+  return simd_float4::Load(std::acos(GetX(_v)), std::acos(GetY(_v)),
+                           std::acos(GetZ(_v)), std::acos(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 ACosX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::acos(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 Sin(_SimdFloat4 _v) {
+  return simd_float4::Load(std::sin(GetX(_v)), std::sin(GetY(_v)),
+                           std::sin(GetZ(_v)), std::sin(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 SinX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::sin(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 ASin(_SimdFloat4 _v) {
+  return simd_float4::Load(std::asin(GetX(_v)), std::asin(GetY(_v)),
+                           std::asin(GetZ(_v)), std::asin(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 ASinX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::asin(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 Tan(_SimdFloat4 _v) {
+  return simd_float4::Load(std::tan(GetX(_v)), std::tan(GetY(_v)),
+                           std::tan(GetZ(_v)), std::tan(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 TanX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::tan(GetX(_v)), _v, 0);
+}
+
+OZZ_INLINE SimdFloat4 ATan(_SimdFloat4 _v) {
+  return simd_float4::Load(std::atan(GetX(_v)), std::atan(GetY(_v)),
+                           std::atan(GetZ(_v)), std::atan(GetW(_v)));
+}
+
+OZZ_INLINE SimdFloat4 ATanX(_SimdFloat4 _v) {
+  return vsetq_lane_f32(std::atan(GetX(_v)), _v, 0);
+}
+
+namespace simd_int4 {
+
+OZZ_INLINE SimdInt4 Load(int _x, int _y, int _z, int _w) {
+  const int32_t i[4] = {_x, _y, _z, _w};
+  return vld1q_s32(i);
+}
+
+OZZ_INLINE SimdInt4 zero() { return vdupq_n_s32(0); }
+
+OZZ_INLINE SimdInt4 one() { return vdupq_n_s32(1); }
+
+OZZ_INLINE SimdInt4 x_axis() { return vsetq_lane_s32(1, zero(), 0); }
+
+OZZ_INLINE SimdInt4 y_axis() { return vsetq_lane_s32(1, zero(), 1); }
+
+OZZ_INLINE SimdInt4 z_axis() { return vsetq_lane_s32(1, zero(), 2); }
+
+OZZ_INLINE SimdInt4 w_axis() { return vsetq_lane_s32(1, zero(), 3); }
+
+OZZ_INLINE SimdInt4 all_true() { return vdupq_n_s32(-1); }
+
+OZZ_INLINE SimdInt4 all_false() { return vdupq_n_s32(0); }
+
+OZZ_INLINE SimdInt4 mask_sign() {
+  return OZZ_NEON_MASK_I(vdupq_n_u32(0x80000000u));
+}
+
+OZZ_INLINE SimdInt4 mask_sign_xyz() {
+  return vsetq_lane_s32(0, mask_sign(), 3);
+}
+
+OZZ_INLINE SimdInt4 mask_sign_w() {
+  return vcopyq_laneq_s32(zero(), 3, mask_sign(), 3);
+}
+
+OZZ_INLINE SimdInt4 mask_not_sign() {
+  return OZZ_NEON_MASK_I(vdupq_n_u32(0x7fffffffu));
+}
+
+OZZ_INLINE SimdInt4 mask_ffff() { return vdupq_n_s32(-1); }
+
+OZZ_INLINE SimdInt4 mask_0000() { return vdupq_n_s32(0); }
+
+OZZ_INLINE SimdInt4 mask_fff0() { return vsetq_lane_s32(0, mask_ffff(), 3); }
+
+OZZ_INLINE SimdInt4 mask_f000() { return vsetq_lane_s32(-1, zero(), 0); }
+
+OZZ_INLINE SimdInt4 mask_0f00() { return vsetq_lane_s32(-1, zero(), 1); }
+
+OZZ_INLINE SimdInt4 mask_00f0() { return vsetq_lane_s32(-1, zero(), 2); }
+
+OZZ_INLINE SimdInt4 mask_000f() { return vsetq_lane_s32(-1, zero(), 3); }
+
+OZZ_INLINE SimdInt4 LoadX(int _x) { return vsetq_lane_s32(_x, zero(), 0); }
+
+OZZ_INLINE SimdInt4 Load1(int _x) { return vdupq_n_s32(_x); }
+
+OZZ_INLINE SimdInt4 Load(bool _x, bool _y, bool _z, bool _w) {
+  return Load(-static_cast<int>(_x), -static_cast<int>(_y),
+              -static_cast<int>(_z), -static_cast<int>(_w));
+}
+
+OZZ_INLINE SimdInt4 LoadX(bool _x) {
+  return vsetq_lane_s32(-static_cast<int>(_x), zero(), 0);
+}
+
+OZZ_INLINE SimdInt4 Load1(bool _x) {
+  return vdupq_n_s32(-static_cast<int>(_x));
+}
+
+OZZ_INLINE SimdInt4 LoadPtr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vld1q_s32(_i);
+}
+
+OZZ_INLINE SimdInt4 LoadXPtr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vld1q_lane_s32(_i, zero(), 0);
+}
+
+OZZ_INLINE SimdInt4 Load1Ptr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vld1q_dup_s32(_i);
+}
+
+OZZ_INLINE SimdInt4 Load2Ptr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vcombine_s32(vld1_s32(_i), vdup_n_s32(0));
+}
+
+OZZ_INLINE SimdInt4 Load3Ptr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return vcombine_s32(vld1_s32(_i), vld1_lane_s32(_i + 2, vdup_n_s32(0), 0));
+}
+
+OZZ_INLINE SimdInt4 LoadPtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vld1q_s32(_i);
+}
+
+OZZ_INLINE SimdInt4 LoadXPtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vld1q_lane_s32(_i, zero(), 0);
+}
+
+OZZ_INLINE SimdInt4 Load1PtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vld1q_dup_s32(_i);
+}
+
+OZZ_INLINE SimdInt4 Load2PtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vcombine_s32(vld1_s32(_i), vdup_n_s32(0));
+}
+
+OZZ_INLINE SimdInt4 Load3PtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return vcombine_s32(vld1_s32(_i), vld1_lane_s32(_i + 2, vdup_n_s32(0), 0));
+}
+
+OZZ_INLINE SimdInt4 FromFloatRound(_SimdFloat4 _f) {
+  return vcvtnq_s32_f32(_f);
+}
+
+OZZ_INLINE SimdInt4 FromFloatTrunc(_SimdFloat4 _f) {
+  return vcvtq_s32_f32(_f);
+}
+}  // namespace simd_int4
+
+OZZ_INLINE int GetX(_SimdInt4 _v) { return vgetq_lane_s32(_v, 0); }
+
+OZZ_INLINE int GetY(_SimdInt4 _v) { return vgetq_lane_s32(_v, 1); }
+
+OZZ_INLINE int GetZ(_SimdInt4 _v) { return vgetq_lane_s32(_v, 2); }
+
+OZZ_INLINE int GetW(_SimdInt4 _v) { return vgetq_lane_s32(_v, 3); }
+
+OZZ_INLINE SimdInt4 SetX(_SimdInt4 _v, _SimdInt4 _i) {
+  return vcopyq_laneq_s32(_v, 0, _i, 0);
+}
+
+OZZ_INLINE SimdInt4 SetY(_SimdInt4 _v, _SimdInt4 _i) {
+  return vcopyq_laneq_s32(_v, 1, _i, 0);
+}
+
+OZZ_INLINE SimdInt4 SetZ(_SimdInt4 _v, _SimdInt4 _i) {
+  return vcopyq_laneq_s32(_v, 2, _i, 0);
+}
+
+OZZ_INLINE SimdInt4 SetW(_SimdInt4 _v, _SimdInt4 _i) {
+  return vcopyq_laneq_s32(_v, 3, _i, 0);
+}
+
+OZZ_INLINE SimdInt4 SetI(_SimdInt4 _v, _SimdInt4 _i, int _ith) {
+  assert(_ith >= 0 && _ith <= 3 && "Invalid index, out of range.");
+  union {
+    SimdInt4 ret;
+    int af[4];
+  } u = {_v};
+  u.af[_ith] = GetX(_i);
+  return u.ret;
+}
+
+OZZ_INLINE void StorePtr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  vst1q_s32(_i, _v);
+}
+
+OZZ_INLINE void Store1Ptr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  vst1q_lane_s32(_i, _v, 0);
+}
+
+OZZ_INLINE void Store2Ptr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  vst1_s32(_i, vget_low_s32(_v));
+}
+
+OZZ_INLINE void Store3Ptr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  vst1_s32(_i, vget_low_s32(_v));
+  vst1q_lane_s32(_i + 2, _v, 2);
+}
+
+OZZ_INLINE void StorePtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  vst1q_s32(_i, _v);
+}
+
+OZZ_INLINE void Store1PtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  vst1q_lane_s32(_i, _v, 0);
+}
+
+OZZ_INLINE void Store2PtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  vst1_s32(_i, vget_low_s32(_v));
+}
+
+OZZ_INLINE void Store3PtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  vst1_s32(_i, vget_low_s32(_v));
+  vst1q_lane_s32(_i + 2, _v, 2);
+}
+
+OZZ_INLINE SimdInt4 SplatX(_SimdInt4 _a) { return OZZ_NEON_SPLAT_I(_a, 0); }
+
+OZZ_INLINE SimdInt4 SplatY(_SimdInt4 _a) { return OZZ_NEON_SPLAT_I(_a, 1); }
+
+OZZ_INLINE SimdInt4 SplatZ(_SimdInt4 _a) { return OZZ_NEON_SPLAT_I(_a, 2); }
+
+OZZ_INLINE SimdInt4 SplatW(_SimdInt4 _a) { return OZZ_NEON_SPLAT_I(_a, 3); }
+
+template <size_t _X, size_t _Y, size_t _Z, size_t _W>
+OZZ_INLINE SimdInt4 Swizzle(_SimdInt4 _v) {
+  static_assert(_X <= 3 && _Y <= 3 && _Z <= 3 && _W <= 3,
+                "Indices must be between 0 and 3");
+  return internal::NeonShuffleI<_X, _Y, _Z, _W>(_v, _v);
+}
+
+template <>
+OZZ_INLINE SimdInt4 Swizzle<0, 1, 2, 3>(_SimdInt4 _v) {
+  return _v;
+}
+
+OZZ_INLINE int MoveMask(_SimdInt4 _v) {
+  // Moves sign bits to bit 0, then shifts them to their lane index.
+  const uint32x4_t sign = vshrq_n_u32(OZZ_NEON_MASK_U(_v), 31);
+  const int32_t shifts[4] = {0, 1, 2, 3};
+  return static_cast<int>(vaddvq_u32(vshlq_u32(sign, vld1q_s32(shifts))));
+}
+
+OZZ_INLINE bool AreAllTrue(_SimdInt4 _v) { return MoveMask(_v) == 0xf; }
+
+OZZ_INLINE bool AreAllTrue3(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x7) == 0x7;
+}
+
+OZZ_INLINE bool AreAllTrue2(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x3) == 0x3;
+}
+
+OZZ_INLINE bool AreAllTrue1(_SimdInt4 _v) { return GetX(_v) < 0; }
+
+OZZ_INLINE bool AreAllFalse(_SimdInt4 _v) { return MoveMask(_v) == 0; }
+
+OZZ_INLINE bool AreAllFalse3(_SimdInt4 _v) { return (MoveMask(_v) & 0x7) == 0; }
+
+OZZ_INLINE bool AreAllFalse2(_SimdInt4 _v) { return (MoveMask(_v) & 0x3) == 0; }
+
+OZZ_INLINE bool AreAllFalse1(_SimdInt4 _v) { return GetX(_v) >= 0; }
+
+OZZ_INLINE SimdInt4 HAdd2(_SimdInt4 _v) {
+  return vcopyq_laneq_s32(_v, 0, vpaddq_s32(_v, _v), 0);
+}
+
+OZZ_INLINE SimdInt4 HAdd3(_SimdInt4 _v) {
+  const int32x4_t hadd =
+      vaddq_s32(vpaddq_s32(_v, _v), OZZ_NEON_SPLAT_I(_v, 2));
+  return vcopyq_laneq_s32(_v, 0, hadd, 0);
+}
+
+OZZ_INLINE SimdInt4 HAdd4(_SimdInt4 _v) {
+  return vsetq_lane_s32(vaddvq_s32(_v), _v, 0);
+}
+
+OZZ_INLINE SimdInt4 Abs(_SimdInt4 _v) { return vabsq_s32(_v); }
+
+OZZ_INLINE SimdInt4 Sign(_SimdInt4 _v) {
+  return vandq_s32(_v, simd_int4::mask_sign());
+}
+
+OZZ_INLINE SimdInt4 Min(_SimdInt4 _a, _SimdInt4 _b) {
+  return vminq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Max(_SimdInt4 _a, _SimdInt4 _b) {
+  return vmaxq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Min0(_SimdInt4 _v) {
+  return vminq_s32(simd_int4::zero(), _v);
+}
+
+OZZ_INLINE SimdInt4 Max0(_SimdInt4 _v) {
+  return vmaxq_s32(simd_int4::zero(), _v);
+}
+
+OZZ_INLINE SimdInt4 Clamp(_SimdInt4 _a, _SimdInt4 _v, _SimdInt4 _b) {
+  return vminq_s32(vmaxq_s32(_a, _v), _b);
+}
+
+OZZ_INLINE SimdInt4 Select(_SimdInt4 _b, _SimdInt4 _true, _SimdInt4 _false) {
+  return OZZ_NEON_SELECT_I(_b, _true, _false);
+}
+
+OZZ_INLINE SimdInt4 And(_SimdInt4 _a, _SimdInt4 _b) {
+  return vandq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 AndNot(_SimdInt4 _a, _SimdInt4 _b) {
+  return vbicq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Or(_SimdInt4 _a, _SimdInt4 _b) { return vorrq_s32(_a, _b); }
+
+OZZ_INLINE SimdInt4 Xor(_SimdInt4 _a, _SimdInt4 _b) {
+  return veorq_s32(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Not(_SimdInt4 _v) { return vmvnq_s32(_v); }
+
+OZZ_INLINE SimdInt4 ShiftL(_SimdInt4 _v, int _bits) {
+  return vshlq_s32(_v, vdupq_n_s32(_bits));
+}
+
+OZZ_INLINE SimdInt4 ShiftR(_SimdInt4 _v, int _bits) {
+  return vshlq_s32(_v, vdupq_n_s32(-_bits));
+}
+
+OZZ_INLINE SimdInt4 ShiftRu(_SimdInt4 _v, int _bits) {
+  return OZZ_NEON_MASK_I(
+      vshlq_u32(OZZ_NEON_MASK_U(_v), vdupq_n_s32(-_bits)));
+}
+
+OZZ_INLINE SimdInt4 CmpEq(_SimdInt4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_MASK_I(vceqq_s32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpNe(_SimdInt4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_MASK_I(vmvnq_u32(vceqq_s32(_a, _b)));
+}
+
+OZZ_INLINE SimdInt4 CmpLt(_SimdInt4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_MASK_I(vcltq_s32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpLe(_SimdInt4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_MASK_I(vcleq_s32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpGt(_SimdInt4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_MASK_I(vcgtq_s32(_a, _b));
+}
+
+OZZ_INLINE SimdInt4 CmpGe(_SimdInt4 _a, _SimdInt4 _b) {
+  return OZZ_NEON_MASK_I(vcgeq_s32(_a, _b));
+}
+
+OZZ_INLINE Float4x4 Float4x4::identity() {
+  const Float4x4 ret = {{simd_float4::x_axis(), simd_float4::y_axis(),
+                         simd_float4::z_axis(), simd_float4::w_axis()}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Transpose(const Float4x4& _m) {
+  Float4x4 ret;
+  Transpose4x4(_m.cols, ret.cols);
+  return ret;
+}
+
+inline Float4x4 Invert(const Float4x4& _m, SimdInt4* _invertible) {
+  const float32x4_t _t0 =
+      internal::NeonShuffle<0, 1, 0, 1>(_m.cols[0], _m.cols[1]);
+  const float32x4_t _t1 =
+      internal::NeonShuffle<0, 1, 0, 1>(_m.cols[2], _m.cols[3]);
+  const float32x4_t _t2 =
+      internal::NeonShuffle<2, 3, 2, 3>(_m.cols[0], _m.cols[1]);
+  const float32x4_t _t3 =
+      internal::NeonShuffle<2, 3, 2, 3>(_m.cols[2], _m.cols[3]);
+  const float32x4_t c0 = internal::NeonShuffle<0, 2, 0, 2>(_t0, _t1);
+  const float32x4_t c1 = internal::NeonShuffle<1, 3, 1, 3>(_t1, _t0);
+  const float32x4_t c2 = internal::NeonShuffle<0, 2, 0, 2>(_t2, _t3);
+  const float32x4_t c3 = internal::NeonShuffle<1, 3, 1, 3>(_t3, _t2);
+
+  float32x4_t minor0, minor1, minor2, minor3, tmp1, tmp2;
+  tmp1 = vmulq_f32(c2, c3);
+  tmp1 = vrev64q_f32(tmp1);
+  minor0 = vmulq_f32(c1, tmp1);
+  minor1 = vmulq_f32(c0, tmp1);
+  tmp1 = vextq_f32(tmp1, tmp1, 2);
+  minor0 = OZZ_MSUB(c1, tmp1, minor0);
+  minor1 = OZZ_MSUB(c0, tmp1, minor1);
+  minor1 = vextq_f32(minor1, minor1, 2);
+
+  tmp1 = vmulq_f32(c1, c2);
+  tmp1 = vrev64q_f32(tmp1);
+  minor0 = OZZ_MADD(c3, tmp1, minor0);
+  minor3 = vmulq_f32(c0, tmp1);
+  tmp1 = vextq_f32(tmp1, tmp1, 2);
+  minor0 = OZZ_NMADD(c3, tmp1, minor0);
+  minor3 = OZZ_MSUB(c0, tmp1, minor3);
+  minor3 = vextq_f32(minor3, minor3, 2);
+
+  tmp1 = vmulq_f32(vextq_f32(c1, c1, 2), c3);
+  tmp1 = vrev64q_f32(tmp1);
+  tmp2 = vextq_f32(c2, c2, 2);
+  minor0 = OZZ_MADD(tmp2, tmp1, minor0);
+  minor2 = vmulq_f32(c0, tmp1);
+  tmp1 = vextq_f32(tmp1, tmp1, 2);
+  minor0 = OZZ_NMADD(tmp2, tmp1, minor0);
+  minor2 = OZZ_MSUB(c0, tmp1, minor2);
+  minor2 = vextq_f32(minor2, minor2, 2);
+
+  tmp1 = vmulq_f32(c0, c1);
+  tmp1 = vrev64q_f32(tmp1);
+  minor2 = OZZ_MADD(c3, tmp1, minor2);
+  minor3 = OZZ_MSUB(tmp2, tmp1, minor3);
+  tmp1 = vextq_f32(tmp1, tmp1, 2);
+  minor2 = OZZ_MSUB(c3, tmp1, minor2);
+  minor3 = OZZ_NMADD(tmp2, tmp1, minor3);
+
+  tmp1 = vmulq_f32(c0, c3);
+  tmp1 = vrev64q_f32(tmp1);
+  minor1 = OZZ_NMADD(tmp2, tmp1, minor1);
+  minor2 = OZZ_MADD(c1, tmp1, minor2);
+  tmp1 = vextq_f32(tmp1, tmp1, 2);
+  minor1 = OZZ_MADD(tmp2, tmp1, minor1);
+  minor2 = OZZ_NMADD(c1, tmp1, minor2);
+
+  tmp1 = vmulq_f32(c0, tmp2);
+  tmp1 = vrev64q_f32(tmp1);
+  minor1 = OZZ_MADD(c3, tmp1, minor1);
+  minor3 = OZZ_NMADD(c1, tmp1, minor3);
+  tmp1 = vextq_f32(tmp1, tmp1, 2);
+  minor1 = OZZ_NMADD(c3, tmp1, minor1);
+  minor3 = OZZ_MADD(c1, tmp1, minor3);
+
+  const float32x4_t det = OZZ_NEON_HADD4_F(vmulq_f32(c0, minor0));
+  const SimdInt4 invertible = CmpNe(det, simd_float4::zero());
+  assert((_invertible || AreAllTrue1(invertible)) &&
+         "Matrix is not invertible");
+  if (_invertible != nullptr) {
+    *_invertible = invertible;
+  }
+  tmp1 = OZZ_NEON_SELECT_F(invertible, RcpEstNR(det), simd_float4::zero());
+  const float32x4_t inv_det =
+      OZZ_NMADD(det, vmulq_f32(tmp1, tmp1), vaddq_f32(tmp1, tmp1));
+
+  // Copy the final columns
+  const Float4x4 ret = {{vmulq_f32(inv_det, minor0), vmulq_f32(inv_det, minor1),
+                         vmulq_f32(inv_det, minor2),
+                         vmulq_f32(inv_det, minor3)}};
+  return ret;
+}
+
+Float4x4 Float4x4::Translation(_SimdFloat4 _v) {
+  const Float4x4 ret = {{simd_float4::x_axis(), simd_float4::y_axis(),
+                         simd_float4::z_axis(), vsetq_lane_f32(1.f, _v, 3)}};
+  return ret;
+}
+
+Float4x4 Float4x4::Scaling(_SimdFloat4 _v) {
+  const float32x4_t zero = simd_float4::zero();
+  const Float4x4 ret = {{vcopyq_laneq_f32(zero, 0, _v, 0),
+                         vcopyq_laneq_f32(zero, 1, _v, 1),
+                         vcopyq_laneq_f32(zero, 2, _v, 2),
+                         simd_float4::w_axis()}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Translate(const Float4x4& _m, _SimdFloat4 _v) {
+  const float32x4_t a01 = vfmaq_laneq_f32(vmulq_laneq_f32(_m.cols[1], _v, 1),
+                                          _m.cols[0], _v, 0);
+  const float32x4_t m3 = vfmaq_laneq_f32(_m.cols[3], _m.cols[2], _v, 2);
+  const Float4x4 ret = {
+      {_m.cols[0], _m.cols[1], _m.cols[2], vaddq_f32(a01, m3)}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Scale(const Float4x4& _m, _SimdFloat4 _v) {
+  const Float4x4 ret = {{vmulq_laneq_f32(_m.cols[0], _v, 0),
+                         vmulq_laneq_f32(_m.cols[1], _v, 1),
+                         vmulq_laneq_f32(_m.cols[2], _v, 2), _m.cols[3]}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 ColumnMultiply(const Float4x4& _m, _SimdFloat4 _v) {
+  const Float4x4 ret = {{vmulq_f32(_m.cols[0], _v), vmulq_f32(_m.cols[1], _v),
+                         vmulq_f32(_m.cols[2], _v),
+                         vmulq_f32(_m.cols[3], _v)}};
+  return ret;
+}
+
+namespace internal {
+// Tests if the 3 first columns of _m have a unit length, within _tolerance.
+OZZ_INLINE SimdInt4 NeonIsNormalized(const Float4x4& _m, float _tolerance) {
+  const float32x4_t max = vdupq_n_f32(1.f + _tolerance);
+  const float32x4_t min = vdupq_n_f32(1.f - _tolerance);
+
+  float32x4_t rows[4];
+  Transpose4x4(_m.cols, rows);
+  const float32x4_t dot =
+      OZZ_MADD(rows[0], rows[0],
+               OZZ_MADD(rows[1], rows[1], vmulq_f32(rows[2], rows[2])));
+  const uint32x4_t normalized =
+      vandq_u32(vcltq_f32(dot, max), vcgtq_f32(dot, min));
+  return vandq_s32(OZZ_NEON_MASK_I(normalized), simd_int4::mask_fff0());
+}
+}  // namespace internal
+
+inline SimdInt4 IsNormalized(const Float4x4& _m) {
+  return internal::NeonIsNormalized(_m, kNormalizationToleranceSq);
+}
+
+inline SimdInt4 IsNormalizedEst(const Float4x4& _m) {
+  return internal::NeonIsNormalized(_m, kNormalizationToleranceEstSq);
+}
+
+OZZ_INLINE SimdInt4 IsOrthogonal(const Float4x4& _m) {
+  const float32x4_t zero = simd_float4::zero();
+
+  // Use simd_float4::zero() if one of the normalization fails. _m will then be
+  // considered not orthogonal.
+  const SimdFloat4 cross = NormalizeSafe3(Cross3(_m.cols[0], _m.cols[1]), zero);
+  const SimdFloat4 at = NormalizeSafe3(_m.cols[2], zero);
+
+  return internal::NeonIsNormalizedX(Dot3(cross, at),
+                                     kNormalizationToleranceSq);
+}
+
+inline SimdFloat4 ToQuaternion(const Float4x4& _m) {
+  assert(AreAllTrue3(IsNormalizedEst(_m)));
+  assert(AreAllTrue1(IsOrthogonal(_m)));
+
+  // Prepares constants.
+  const float32x4_t zero = simd_float4::zero();
+  const float32x4_t one = simd_float4::one();
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  const SimdInt4 mask_f000 = simd_int4::mask_f000();
+  const SimdInt4 mask_0f00 = simd_int4::mask_0f00();
+  const SimdInt4 mask_00f0 = simd_int4::mask_00f0();
+  const SimdInt4 mask_000f = simd_int4::mask_000f();
+
+  const float32x4_t xx_yy =
+      OZZ_NEON_SELECT_F(mask_0f00, _m.cols[1], _m.cols[0]);
+  const float32x4_t xx_yy_0010 = OZZ_NEON_SWIZZLE_F(xx_yy, 0, 1, 0, 0);
+  const float32x4_t xx_yy_zz_xx =
+      OZZ_NEON_SELECT_F(mask_00f0, _m.cols[2], xx_yy_0010);
+  const float32x4_t yy_zz_xx_yy = OZZ_NEON_SWIZZLE_F(xx_yy_zz_xx, 1, 2, 0, 1);
+  const float32x4_t zz_xx_yy_zz = OZZ_NEON_SWIZZLE_F(xx_yy_zz_xx, 2, 0, 1, 2);
+
+  const float32x4_t diag_sum =
+      vaddq_f32(vaddq_f32(xx_yy_zz_xx, yy_zz_xx_yy), zz_xx_yy_zz);
+  const float32x4_t diag_diff =
+      vsubq_f32(vsubq_f32(xx_yy_zz_xx, yy_zz_xx_yy), zz_xx_yy_zz);
+  const float32x4_t radicand =
+      vaddq_f32(OZZ_NEON_SELECT_F(mask_000f, diag_sum, diag_diff), one);
+  const float32x4_t invSqrt = vdivq_f32(one, vsqrtq_f32(radicand));
+
+  float32x4_t zy_xz_yx = OZZ_NEON_SELECT_F(mask_00f0, _m.cols[1], _m.cols[0]);
+  zy_xz_yx = OZZ_NEON_SWIZZLE_F(zy_xz_yx, 2, 2, 1, 0);
+  zy_xz_yx =
+      OZZ_NEON_SELECT_F(mask_0f00, OZZ_NEON_SPLAT_F(_m.cols[2], 0), zy_xz_yx);
+  float32x4_t yz_zx_xy = OZZ_NEON_SELECT_F(mask_f000, _m.cols[1], _m.cols[0]);
+  yz_zx_xy = OZZ_NEON_SWIZZLE_F(yz_zx_xy, 0, 2, 0, 0);
+  yz_zx_xy =
+      OZZ_NEON_SELECT_F(mask_f000, OZZ_NEON_SPLAT_F(_m.cols[2], 1), yz_zx_xy);
+  const float32x4_t sum = vaddq_f32(zy_xz_yx, yz_zx_xy);
+  const float32x4_t diff = vsubq_f32(zy_xz_yx, yz_zx_xy);
+  const float32x4_t scale = vmulq_f32(invSqrt, half);
+
+  const float32x4_t sum0 = OZZ_NEON_SWIZZLE_F(sum, 0, 2, 1, 0);
+  const float32x4_t sum1 = OZZ_NEON_SWIZZLE_F(sum, 2, 0, 0, 0);
+  const float32x4_t sum2 = OZZ_NEON_SWIZZLE_F(sum, 1, 0, 0, 0);
+  float32x4_t res0 =
+      OZZ_NEON_SELECT_F(mask_000f, OZZ_NEON_SPLAT_F(diff, 0), sum0);
+  float32x4_t res1 =
+      OZZ_NEON_SELECT_F(mask_000f, OZZ_NEON_SPLAT_F(diff, 1), sum1);
+  float32x4_t res2 =
+      OZZ_NEON_SELECT_F(mask_000f, OZZ_NEON_SPLAT_F(diff, 2), sum2);
+  res0 = vmulq_laneq_f32(OZZ_NEON_SELECT_F(mask_f000, radicand, res0), scale,
+                         0);
+  res1 = vmulq_laneq_f32(OZZ_NEON_SELECT_F(mask_0f00, radicand, res1), scale,
+                         1);
+  res2 = vmulq_laneq_f32(OZZ_NEON_SELECT_F(mask_00f0, radicand, res2), scale,
+                         2);
+  const float32x4_t res3 = vmulq_laneq_f32(
+      OZZ_NEON_SELECT_F(mask_000f, radicand, diff), scale, 3);
+
+  const float32x4_t xx = OZZ_NEON_SPLAT_F(_m.cols[0], 0);
+  const float32x4_t yy = OZZ_NEON_SPLAT_F(_m.cols[1], 1);
+  const float32x4_t zz = OZZ_NEON_SPLAT_F(_m.cols[2], 2);
+  const SimdInt4 cond0 = OZZ_NEON_MASK_I(vcgtq_f32(yy, xx));
+  const SimdInt4 cond1 =
+      OZZ_NEON_MASK_I(vandq_u32(vcgtq_f32(zz, xx), vcgtq_f32(zz, yy)));
+  const SimdInt4 cond2 =
+      OZZ_NEON_MASK_I(vcgtq_f32(OZZ_NEON_SPLAT_F(diag_sum, 0), zero));
+  float32x4_t res = OZZ_NEON_SELECT_F(cond0, res1, res0);
+  res = OZZ_NEON_SELECT_F(cond1, res2, res);
+  res = OZZ_NEON_SELECT_F(cond2, res3, res);
+
+  assert(AreAllTrue1(IsNormalizedEst4(res)));
+  return res;
+}
+
+inline bool ToAffine(const Float4x4& _m, SimdFloat4* _translation,
+                     SimdFloat4* _quaternion, SimdFloat4* _scale) {
+  const float32x4_t zero = simd_float4::zero();
+  const float32x4_t one = simd_float4::one();
+  const SimdInt4 fff0 = simd_int4::mask_fff0();
+  const float32x4_t max = vdupq_n_f32(kOrthogonalisationToleranceSq);
+  const float32x4_t min = vdupq_n_f32(-kOrthogonalisationToleranceSq);
+
+  // Extracts translation.
+  *_translation = OZZ_NEON_SELECT_F(fff0, _m.cols[3], one);
+
+  // Extracts scale.
+  float32x4_t m_rows[4];
+  Transpose4x4(_m.cols, m_rows);
+
+  const float32x4_t dot = OZZ_MADD(
+      m_rows[0], m_rows[0],
+      OZZ_MADD(m_rows[1], m_rows[1], vmulq_f32(m_rows[2], m_rows[2])));
+  const float32x4_t abs_scale = vsqrtq_f32(dot);
+
+  const SimdInt4 zero_axis =
+      OZZ_NEON_MASK_I(vandq_u32(vcltq_f32(dot, max), vcgtq_f32(dot, min)));
+
+  // Builds an orthonormal matrix in order to support quaternion extraction.
+  Float4x4 orthonormal;
+  const int mask = MoveMask(zero_axis);
+  if (mask & 1) {
+    if (mask & 6) {
+      return false;
+    }
+    orthonormal.cols[1] =
+        vdivq_f32(_m.cols[1], OZZ_NEON_SPLAT_F(abs_scale, 1));
+    orthonormal.cols[0] = Normalize3(Cross3(orthonormal.cols[1], _m.cols[2]));
+    orthonormal.cols[2] =
+        Normalize3(Cross3(orthonormal.cols[0], orthonormal.cols[1]));
+  } else if (mask & 4) {
+    if (mask & 3) {
+      return false;
+    }
+    orthonormal.cols[0] =
+        vdivq_f32(_m.cols[0], OZZ_NEON_SPLAT_F(abs_scale, 0));
+    orthonormal.cols[2] = Normalize3(Cross3(orthonormal.cols[0], _m.cols[1]));
+    orthonormal.cols[1] =
+        Normalize3(Cross3(orthonormal.cols[2], orthonormal.cols[0]));
+  } else {  // Favor z axis in the default case
+    if (mask & 5) {
+      return false;
+    }
+    orthonormal.cols[2] =
+        vdivq_f32(_m.cols[2], OZZ_NEON_SPLAT_F(abs_scale, 2));
+    orthonormal.cols[1] = Normalize3(Cross3(orthonormal.cols[2], _m.cols[0]));
+    orthonormal.cols[0] =
+        Normalize3(Cross3(orthonormal.cols[1], orthonormal.cols[2]));
+  }
+  orthonormal.cols[3] = simd_float4::w_axis();
+
+  // Get back scale signs in case of reflexions
+  float32x4_t o_rows[4];
+  Transpose4x4(orthonormal.cols, o_rows);
+
+  const float32x4_t scale_dot = OZZ_MADD(
+      o_rows[0], m_rows[0],
+      OZZ_MADD(o_rows[1], m_rows[1], vmulq_f32(o_rows[2], m_rows[2])));
+
+  const SimdInt4 cond = OZZ_NEON_MASK_I(vcgtq_f32(scale_dot, zero));
+  const float32x4_t cfalse = vnegq_f32(abs_scale);
+  const float32x4_t scale = OZZ_NEON_SELECT_F(cond, abs_scale, cfalse);
+  *_scale = OZZ_NEON_SELECT_F(fff0, scale, one);
+
+  // Extracts quaternion.
+  *_quaternion = ToQuaternion(orthonormal);
+  return true;
+}
+
+inline Float4x4 Float4x4::FromEuler(_SimdFloat4 _v) {
+  return Float4x4::FromAxisAngle(simd_float4::y_axis(), SplatX(_v)) *
+         Float4x4::FromAxisAngle(simd_float4::x_axis(), SplatY(_v)) *
+         Float4x4::FromAxisAngle(simd_float4::z_axis(), SplatZ(_v));
+}
+
+inline Float4x4 Float4x4::FromAxisAngle(_SimdFloat4 _axis, _SimdFloat4 _angle) {
+  assert(AreAllTrue1(IsNormalizedEst3(_axis)));
+
+  const SimdInt4 fff0 = simd_int4::mask_fff0();
+  const float32x4_t one = simd_float4::one();
+
+  const float32x4_t sin = SplatX(SinX(_angle));
+  const float32x4_t cos = SplatX(CosX(_angle));
+  const float32x4_t one_minus_cos = vsubq_f32(one, cos);
+
+  const float32x4_t v0 = vmulq_f32(
+      vmulq_f32(one_minus_cos, OZZ_NEON_SWIZZLE_F(_axis, 1, 2, 0, 3)),
+      OZZ_NEON_SWIZZLE_F(_axis, 2, 0, 1, 3));
+  const float32x4_t r0 =
+      vaddq_f32(vmulq_f32(vmulq_f32(one_minus_cos, _axis), _axis), cos);
+  const float32x4_t r1 = vaddq_f32(vmulq_f32(sin, _axis), v0);
+  const float32x4_t r2 = vsubq_f32(v0, vmulq_f32(sin, _axis));
+  const float32x4_t r0fff0 = And(r0, fff0);
+  const float32x4_t r1r22120 = internal::NeonShuffle<0, 2, 1, 2>(r1, r2);
+  const float32x4_t v1 = OZZ_NEON_SWIZZLE_F(r1r22120, 1, 2, 3, 0);
+  const float32x4_t r1r20011 = internal::NeonShuffle<1, 1, 0, 0>(r1, r2);
+  const float32x4_t v2 = OZZ_NEON_SWIZZLE_F(r1r20011, 0, 2, 0, 2);
+
+  const float32x4_t t0 = internal::NeonShuffle<0, 3, 0, 1>(r0fff0, v1);
+  const float32x4_t t1 = internal::NeonShuffle<1, 3, 2, 3>(r0fff0, v1);
+  const Float4x4 ret = {{OZZ_NEON_SWIZZLE_F(t0, 0, 2, 3, 1),
+                         OZZ_NEON_SWIZZLE_F(t1, 2, 0, 3, 1),
+                         internal::NeonShuffle<0, 1, 2, 3>(v2, r0fff0),
+                         simd_float4::w_axis()}};
+  return ret;
+}
+
+namespace internal {
+// Computes the 3 first columns of the rotation matrix of _quaternion, shared
+// by FromQuaternion and FromAffine.
+OZZ_INLINE void NeonQuaternionToColumns(_SimdFloat4 _quaternion,
+                                        float32x4_t _cols[3]) {
+  const SimdInt4 fff0 = simd_int4::mask_fff0();
+  const float32x4_t c1110 = vsetq_lane_f32(0.f, simd_float4::one(), 3);
+
+  const float32x4_t vsum = vaddq_f32(_quaternion, _quaternion);
+  const float32x4_t vms = vmulq_f32(_quaternion, vsum);
+
+  const float32x4_t r0 = vsubq_f32(
+      vsubq_f32(c1110, And(OZZ_NEON_SWIZZLE_F(vms, 1, 0, 0, 3), fff0)),
+      And(OZZ_NEON_SWIZZLE_F(vms, 2, 2, 1, 3), fff0));
+  const float32x4_t v0 =
+      vmulq_f32(OZZ_NEON_SWIZZLE_F(_quaternion, 0, 0, 1, 3),
+                OZZ_NEON_SWIZZLE_F(vsum, 2, 1, 2, 3));
+  const float32x4_t v1 = vmulq_f32(OZZ_NEON_SPLAT_F(_quaternion, 3),
+                                   OZZ_NEON_SWIZZLE_F(vsum, 1, 2, 0, 3));
+
+  const float32x4_t r1 = vaddq_f32(v0, v1);
+  const float32x4_t r2 = vsubq_f32(v0, v1);
+
+  const float32x4_t r1r21021 = NeonShuffle<1, 2, 0, 1>(r1, r2);
+  const float32x4_t v2 = OZZ_NEON_SWIZZLE_F(r1r21021, 0, 2, 3, 1);
+  const float32x4_t r1r22200 = NeonShuffle<0, 0, 2, 2>(r1, r2);
+  const float32x4_t v3 = OZZ_NEON_SWIZZLE_F(r1r22200, 0, 2, 0, 2);
+
+  const float32x4_t q0 = NeonShuffle<0, 3, 0, 1>(r0, v2);
+  const float32x4_t q1 = NeonShuffle<1, 3, 2, 3>(r0, v2);
+  _cols[0] = OZZ_NEON_SWIZZLE_F(q0, 0, 2, 3, 1);
+  _cols[1] = OZZ_NEON_SWIZZLE_F(q1, 2, 0, 3, 1);
+  _cols[2] = NeonShuffle<0, 1, 2, 3>(v3, r0);
+}
+}  // namespace internal
+
+inline Float4x4 Float4x4::FromQuaternion(_SimdFloat4 _quaternion) {
+  assert(AreAllTrue1(IsNormalizedEst4(_quaternion)));
+
+  Float4x4 ret;
+  internal::NeonQuaternionToColumns(_quaternion, ret.cols);
+  ret.cols[3] = simd_float4::w_axis();
+  return ret;
+}
+
+inline Float4x4 Float4x4::FromAffine(_SimdFloat4 _translation,
+                                     _SimdFloat4 _quaternion,
+                                     _SimdFloat4 _scale) {
+  assert(AreAllTrue1(IsNormalizedEst4(_quaternion)));
+
+  float32x4_t cols[3];
+  internal::NeonQuaternionToColumns(_quaternion, cols);
+  const Float4x4 ret = {{vmulq_laneq_f32(cols[0], _scale, 0),
+                         vmulq_laneq_f32(cols[1], _scale, 1),
+                         vmulq_laneq_f32(cols[2], _scale, 2),
+                         vsetq_lane_f32(1.f, _translation, 3)}};
+  return ret;
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 TransformPoint(const ozz::math::Float4x4& _m,
+                                                ozz::math::_SimdFloat4 _v) {
+  const float32x4_t xxxx = vmulq_laneq_f32(_m.cols[0], _v, 0);
+  const float32x4_t a23 = vfmaq_laneq_f32(_m.cols[3], _m.cols[2], _v, 2);
+  const float32x4_t a01 = vfmaq_laneq_f32(xxxx, _m.cols[1], _v, 1);
+  return vaddq_f32(a01, a23);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 TransformVector(const ozz::math::Float4x4& _m,
+                                                 ozz::math::_SimdFloat4 _v) {
+  const float32x4_t xxxx = vmulq_laneq_f32(_m.cols[0], _v, 0);
+  const float32x4_t zzzz = vmulq_laneq_f32(_m.cols[1], _v, 1);
+  const float32x4_t a21 = vfmaq_laneq_f32(xxxx, _m.cols[2], _v, 2);
+  return vaddq_f32(zzzz, a21);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator*(const ozz::math::Float4x4& _m,
+                                           ozz::math::_SimdFloat4 _v) {
+  const float32x4_t xxxx = vmulq_laneq_f32(_m.cols[0], _v, 0);
+  const float32x4_t zzzz = vmulq_laneq_f32(_m.cols[2], _v, 2);
+  const float32x4_t a01 = vfmaq_laneq_f32(xxxx, _m.cols[1], _v, 1);
+  const float32x4_t a23 = vfmaq_laneq_f32(zzzz, _m.cols[3], _v, 3);
+  return vaddq_f32(a01, a23);
+}
+
+inline ozz::math::Float4x4 operator*(const ozz::math::Float4x4& _a,
+                                     const ozz::math::Float4x4& _b) {
+  const ozz::math::Float4x4 ret = {{_a * _b.cols[0], _a * _b.cols[1],
+                                    _a * _b.cols[2], _a * _b.cols[3]}};
+  return ret;
+}
+
+OZZ_INLINE ozz::math::Float4x4 operator+(const ozz::math::Float4x4& _a,
+                                         const ozz::math::Float4x4& _b) {
+  const ozz::math::Float4x4 ret = {
+      {vaddq_f32(_a.cols[0], _b.cols[0]), vaddq_f32(_a.cols[1], _b.cols[1]),
+       vaddq_f32(_a.cols[2], _b.cols[2]), vaddq_f32(_a.cols[3], _b.cols[3])}};
+  return ret;
+}
+
+OZZ_INLINE ozz::math::Float4x4 operator-(const ozz::math::Float4x4& _a,
+                                         const ozz::math::Float4x4& _b) {
+  const ozz::math::Float4x4 ret = {
+      {vsubq_f32(_a.cols[0], _b.cols[0]), vsubq_f32(_a.cols[1], _b.cols[1]),
+       vsubq_f32(_a.cols[2], _b.cols[2]), vsubq_f32(_a.cols[3], _b.cols[3])}};
+  return ret;
+}
+}  // namespace math
+}  // namespace ozz
+
+#if !defined(OZZ_DISABLE_SSE_NATIVE_OPERATORS)
+OZZ_INLINE ozz::math::SimdFloat4 operator+(ozz::math::_SimdFloat4 _a,
+                                           ozz::math::_SimdFloat4 _b) {
+  return vaddq_f32(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator-(ozz::math::_SimdFloat4 _a,
+                                           ozz::math::_SimdFloat4 _b) {
+  return vsubq_f32(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator-(ozz::math::_SimdFloat4 _v) {
+  return vnegq_f32(_v);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator*(ozz::math::_SimdFloat4 _a,
+                                           ozz::math::_SimdFloat4 _b) {
+  return vmulq_f32(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator/(ozz::math::_SimdFloat4 _a,
+                                           ozz::math::_SimdFloat4 _b) {
+  return vdivq_f32(_a, _b);
+}
+#endif  // !defined(OZZ_DISABLE_SSE_NATIVE_OPERATORS)
+
+namespace ozz {
+namespace math {
+OZZ_INLINE uint16_t FloatToHalf(float _f) {
+  const int h = GetX(FloatToHalf(simd_float4::Load1(_f)));
+  return static_cast<uint16_t>(h);
+}
+
+OZZ_INLINE float HalfToFloat(uint16_t _h) {
+  return GetX(HalfToFloat(simd_int4::Load1(static_cast<int>(_h))));
+}
+
+// Half <-> Float implementation uses AArch64 hardware conversion instructions.
+inline SimdInt4 FloatToHalf(_SimdFloat4 _f) {
+  const uint32x4_t half =
+      vmovl_u16(vreinterpret_u16_f16(vcvt_f16_f32(_f)));
+
+  // NaN are converted to the same canonical value as the software
+  // implementation, instead of propagating their payload.
+  const uint32x4_t b_isnan = vmvnq_u32(vceqq_f32(_f, _f));
+  const uint32x4_t sign_shift = vshrq_n_u32(vreinterpretq_u32_f32(_f), 31);
+  const uint32x4_t nan =
+      vorrq_u32(vdupq_n_u32(0x7e00), vshlq_n_u32(sign_shift, 15));
+  return OZZ_NEON_MASK_I(vbslq_u32(b_isnan, nan, half));
+}
+
+OZZ_INLINE SimdFloat4 HalfToFloat(_SimdInt4 _h) {
+  // Narrows to the lower 16 bits of each component, upper ones are ignored.
+  const uint16x4_t half = vmovn_u32(OZZ_NEON_MASK_U(_h));
+  return vcvt_f32_f16(vreinterpret_f16_u16(half));
+}
+}  // namespace math
+}  // namespace ozz
+
+#undef OZZ_NEON_SPLAT_F
+#undef OZZ_NEON_SPLAT_I
+#undef OZZ_NEON_SWIZZLE_F
+#undef OZZ_NEON_MOVE_X_F
+#undef OZZ_NEON_CAST_F
+#undef OZZ_NEON_CAST_I
+#undef OZZ_NEON_MASK_I
+#undef OZZ_NEON_MASK_U
+#undef OZZ_NEON_HADD2_F
+#undef OZZ_NEON_HADD3_F
+#undef OZZ_NEON_HADD4_F
+#undef OZZ_MADD
+#undef OZZ_MSUB
+#undef OZZ_NMADD
+#undef OZZ_NMSUB
+#undef OZZ_NEON_SELECT_F
+#undef OZZ_NEON_SELECT_I
+#undef OZZ_NEON_RCP_NR
+#undef OZZ_NEON_RSQRT_NR
+#endif  // OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_NEON_INL_H_
@@ -274,6 +274,13 @@ OZZ_INLINE void Store3PtrU(_SimdFloat4 _v, float* _f) {
   _f[2] = _v.z;
 }
 
+// Non-temporal stores aren't exposed, they fall back to regular stores.
+OZZ_INLINE void StreamPtr(_SimdFloat4 _v, float* _f) { StorePtr(_v, _f); }
+
+OZZ_INLINE void Stream3PtrU(_SimdFloat4 _v, float* _f) { Store3PtrU(_v, _f); }
+
+OZZ_INLINE void StreamFence() {}
+
 OZZ_INLINE SimdFloat4 SplatX(_SimdFloat4 _v) {
   const SimdFloat4 ret = {_v.x, _v.x, _v.x, _v.x};
   return ret;
@@ -319,6 +319,22 @@ OZZ_INLINE void Store3PtrU(_SimdFloat4 _v, float* _f) {
   _mm_store_ss(_f + 2, _mm_movehl_ps(_v, _v));
 }
 
+OZZ_INLINE void StreamPtr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  _mm_stream_ps(_f, _v);
+}
+
+OZZ_INLINE void Stream3PtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  int* i = reinterpret_cast<int*>(_f);
+  const __m128i v = _mm_castps_si128(_v);
+  _mm_stream_si32(i + 0, _mm_cvtsi128_si32(v));
+  _mm_stream_si32(i + 1, _mm_cvtsi128_si32(OZZ_SSE_SPLAT_I(v, 1)));
+  _mm_stream_si32(i + 2, _mm_cvtsi128_si32(OZZ_SSE_SPLAT_I(v, 2)));
+}
+
+OZZ_INLINE void StreamFence() { _mm_sfence(); }
+
 OZZ_INLINE SimdFloat4 SplatX(_SimdFloat4 _v) { return OZZ_SSE_SPLAT_F(_v, 0); }
 
 OZZ_INLINE SimdFloat4 SplatY(_SimdFloat4 _v) { return OZZ_SSE_SPLAT_F(_v, 1); }
@@ -2030,6 +2046,29 @@ OZZ_INLINE float HalfToFloat(uint16_t _h) {
   return _mm_cvtss_f32(HalfToFloat(_mm_set1_epi32(_h)));
 }
 
+#if defined(OZZ_SIMD_F16C)
+// Half <-> Float implementation uses F16C hardware conversion instructions.
+inline SimdInt4 FloatToHalf(_SimdFloat4 _f) {
+  const __m128i half = _mm_cvtps_ph(_f, _MM_FROUND_TO_NEAREST_INT);
+  const __m128i joined = _mm_unpacklo_epi16(half, _mm_setzero_si128());
+
+  // NaN are converted to the same canonical value as the software
+  // implementation, instead of propagating their payload.
+  const __m128i b_isnan = _mm_castps_si128(_mm_cmpunord_ps(_f, _f));
+  const __m128i sign_shift = _mm_srli_epi32(_mm_castps_si128(_f), 31);
+  const __m128i nan = _mm_or_si128(_mm_set1_epi32(0x7e00),
+                                   _mm_slli_epi32(sign_shift, 15));
+  return _mm_or_si128(_mm_andnot_si128(b_isnan, joined),
+                      _mm_and_si128(b_isnan, nan));
+}
+
+OZZ_INLINE SimdFloat4 HalfToFloat(_SimdInt4 _h) {
+  // Gathers the lower 16 bits of each component, upper ones are ignored.
+  const __m128i mask_low16 =
+      _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+  return _mm_cvtph_ps(_mm_shuffle_epi8(_h, mask_low16));
+}
+#else  // OZZ_SIMD_F16C
 // Half <-> Float implementation is based on:
 // http://fgiesen.wordpress.com/2012/03/28/half-to-float-done-quic/.
 inline SimdInt4 FloatToHalf(_SimdFloat4 _f) {
@@ -2081,6 +2120,7 @@ OZZ_INLINE SimdFloat4 HalfToFloat(_SimdInt4 _h) {
   const __m128 sign_inf = _mm_or_ps(_mm_castsi128_ps(sign), infnanexp);
   return _mm_or_ps(scaled, sign_inf);
 }
+#endif  // OZZ_SIMD_F16C
 }  // namespace math
 }  // namespace ozz
 
@@ -0,0 +1,1618 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_WASM_INL_H_
+#define OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_WASM_INL_H_
+
+// SIMD WebAssembly SIMD128 implementation, based on wasm_simd128.h intrinsics.
+
+#include <stdint.h>
+
+#include <cassert>
+
+// Temporarly needed while trigonometric functions aren't implemented.
+#include <cmath>
+
+#include "ozz/base/maths/math_constant.h"
+
+namespace ozz {
+namespace math {
+
+// Internal macros.
+
+// Reinterprets a float vector as a v128_t, which is the argument type of all
+// wasm_simd128.h intrinsics. SimdInt4 is already a v128_t.
+#define OZZ_WASM_I(_f) ((v128_t)(_f))
+
+// Reinterprets a v128_t as a float vector.
+#define OZZ_WASM_F(_i) ((SimdFloat4)(_i))
+
+namespace internal {
+// Returns (_a[_X], _a[_Y], _b[_Z], _b[_W]), the equivalent of SSE
+// _mm_shuffle_ps(_a, _b, _MM_SHUFFLE(_W, _Z, _Y, _X)).
+template <int _X, int _Y, int _Z, int _W>
+OZZ_INLINE SimdFloat4 WasmShuffle(SimdFloat4 _a, SimdFloat4 _b) {
+  return OZZ_WASM_F(wasm_i32x4_shuffle(OZZ_WASM_I(_a), OZZ_WASM_I(_b), _X, _Y,
+                                       _Z + 4, _W + 4));
+}
+}  // namespace internal
+
+// Unused components of the result vector are replicated from the first input
+// argument.
+
+#define OZZ_WASM_SPLAT_F(_v, _i) internal::WasmShuffle<_i, _i, _i, _i>(_v, _v)
+
+#define OZZ_WASM_SPLAT_I(_v, _i) wasm_i32x4_shuffle(_v, _v, _i, _i, _i, _i)
+
+// Shuffles components of _v, with the same argument order as Swizzle.
+#define OZZ_WASM_SWIZZLE_F(_v, _x, _y, _z, _w) \
+  internal::WasmShuffle<_x, _y, _z, _w>(_v, _v)
+
+// Sets x component of _v to x component of _f.
+#define OZZ_WASM_MOVE_X_F(_v, _f) \
+  OZZ_WASM_F(wasm_i32x4_shuffle(OZZ_WASM_I(_v), OZZ_WASM_I(_f), 4, 1, 2, 3))
+
+#define OZZ_WASM_MOVE_X_I(_v, _i) wasm_i32x4_shuffle(_v, _i, 4, 1, 2, 3)
+
+// Interleaves lower (zip1) and higher (zip2) halves of _a and _b.
+#define OZZ_WASM_ZIP1_F(_a, _b) \
+  OZZ_WASM_F(wasm_i32x4_shuffle(OZZ_WASM_I(_a), OZZ_WASM_I(_b), 0, 4, 1, 5))
+
+#define OZZ_WASM_ZIP2_F(_a, _b) \
+  OZZ_WASM_F(wasm_i32x4_shuffle(OZZ_WASM_I(_a), OZZ_WASM_I(_b), 2, 6, 3, 7))
+
+// Concatenates lower (low) or higher (high) halves of _a and _b.
+#define OZZ_WASM_LOW_F(_a, _b) \
+  OZZ_WASM_F(wasm_i64x2_shuffle(OZZ_WASM_I(_a), OZZ_WASM_I(_b), 0, 2))
+
+#define OZZ_WASM_HIGH_F(_a, _b) \
+  OZZ_WASM_F(wasm_i64x2_shuffle(OZZ_WASM_I(_a), OZZ_WASM_I(_b), 1, 3))
+
+// _v.x + _v.y, ?, ?, ?
+#define OZZ_WASM_HADD2_F(_v) ((_v) + OZZ_WASM_SPLAT_F(_v, 1))
+
+// _v.x + _v.y + _v.z, ?, ?, ?
+#define OZZ_WASM_HADD3_F(_v) \
+  ((_v) + OZZ_WASM_SPLAT_F(_v, 1) + OZZ_WASM_SPLAT_F(_v, 2))
+
+// _v.x + _v.y + _v.z + _v.w, ?, ?, ?
+#define OZZ_WASM_HADD4_F(_v, _r)                                            \
+  do {                                                                      \
+    const SimdFloat4 haddxyzw = (_v) + OZZ_WASM_SWIZZLE_F(_v, 2, 3, 2, 3); \
+    _r = haddxyzw + OZZ_WASM_SPLAT_F(haddxyzw, 1);                         \
+  } while (void(0), 0)
+
+// Baseline SIMD128 has no FMA instruction. Float arithmetic uses vector
+// extension operators, which compile to f32x4 instructions.
+#define OZZ_MADD(_a, _b, _c) ((_a) * (_b) + (_c))
+#define OZZ_MSUB(_a, _b, _c) ((_a) * (_b) - (_c))
+#define OZZ_NMADD(_a, _b, _c) ((_c) - (_a) * (_b))
+#define OZZ_NMSUB(_a, _b, _c) (-((_a) * (_b) + (_c)))
+
+// Selects bits from _true where _b bits are set, from _false otherwise.
+#define OZZ_WASM_SELECT_F(_b, _true, _false) \
+  OZZ_WASM_F(wasm_v128_bitselect(OZZ_WASM_I(_true), OZZ_WASM_I(_false), _b))
+
+namespace simd_float4 {
+
+OZZ_INLINE SimdFloat4 zero() { return OZZ_WASM_F(wasm_f32x4_splat(0.f)); }
+
+OZZ_INLINE SimdFloat4 one() { return OZZ_WASM_F(wasm_f32x4_splat(1.f)); }
+
+OZZ_INLINE SimdFloat4 x_axis() {
+  return OZZ_WASM_F(wasm_f32x4_make(1.f, 0.f, 0.f, 0.f));
+}
+
+OZZ_INLINE SimdFloat4 y_axis() {
+  return OZZ_WASM_F(wasm_f32x4_make(0.f, 1.f, 0.f, 0.f));
+}
+
+OZZ_INLINE SimdFloat4 z_axis() {
+  return OZZ_WASM_F(wasm_f32x4_make(0.f, 0.f, 1.f, 0.f));
+}
+
+OZZ_INLINE SimdFloat4 w_axis() {
+  return OZZ_WASM_F(wasm_f32x4_make(0.f, 0.f, 0.f, 1.f));
+}
+
+OZZ_INLINE SimdFloat4 Load(float _x, float _y, float _z, float _w) {
+  return OZZ_WASM_F(wasm_f32x4_make(_x, _y, _z, _w));
+}
+
+OZZ_INLINE SimdFloat4 LoadX(float _x) {
+  return OZZ_WASM_F(wasm_f32x4_make(_x, 0.f, 0.f, 0.f));
+}
+
+OZZ_INLINE SimdFloat4 Load1(float _x) {
+  return OZZ_WASM_F(wasm_f32x4_splat(_x));
+}
+
+OZZ_INLINE SimdFloat4 LoadPtr(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  return OZZ_WASM_F(wasm_v128_load(_f));
+}
+
+OZZ_INLINE SimdFloat4 LoadPtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return OZZ_WASM_F(wasm_v128_load(_f));
+}
+
+OZZ_INLINE SimdFloat4 LoadXPtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return OZZ_WASM_F(wasm_v128_load32_zero(_f));
+}
+
+OZZ_INLINE SimdFloat4 Load1PtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return OZZ_WASM_F(wasm_v128_load32_splat(_f));
+}
+
+OZZ_INLINE SimdFloat4 Load2PtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return OZZ_WASM_F(wasm_v128_load64_zero(_f));
+}
+
+OZZ_INLINE SimdFloat4 Load3PtrU(const float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  return OZZ_WASM_F(
+      wasm_v128_load32_lane(_f + 2, wasm_v128_load64_zero(_f), 2));
+}
+
+OZZ_INLINE SimdFloat4 FromInt(_SimdInt4 _i) {
+  return OZZ_WASM_F(wasm_f32x4_convert_i32x4(_i));
+}
+}  // namespace simd_float4
+
+OZZ_INLINE float GetX(_SimdFloat4 _v) { return _v[0]; }
+
+OZZ_INLINE float GetY(_SimdFloat4 _v) { return _v[1]; }
+
+OZZ_INLINE float GetZ(_SimdFloat4 _v) { return _v[2]; }
+
+OZZ_INLINE float GetW(_SimdFloat4 _v) { return _v[3]; }
+
+OZZ_INLINE SimdFloat4 SetX(_SimdFloat4 _v, _SimdFloat4 _f) {
+  return OZZ_WASM_MOVE_X_F(_v, _f);
+}
+
+OZZ_INLINE SimdFloat4 SetY(_SimdFloat4 _v, _SimdFloat4 _f) {
+  return OZZ_WASM_F(
+      wasm_i32x4_shuffle(OZZ_WASM_I(_v), OZZ_WASM_I(_f), 0, 4, 2, 3));
+}
+
+OZZ_INLINE SimdFloat4 SetZ(_SimdFloat4 _v, _SimdFloat4 _f) {
+  return OZZ_WASM_F(
+      wasm_i32x4_shuffle(OZZ_WASM_I(_v), OZZ_WASM_I(_f), 0, 1, 4, 3));
+}
+
+OZZ_INLINE SimdFloat4 SetW(_SimdFloat4 _v, _SimdFloat4 _f) {
+  return OZZ_WASM_F(
+      wasm_i32x4_shuffle(OZZ_WASM_I(_v), OZZ_WASM_I(_f), 0, 1, 2, 4));
+}
+
+OZZ_INLINE SimdFloat4 SetI(_SimdFloat4 _v, _SimdFloat4 _f, int _ith) {
+  assert(_ith >= 0 && _ith <= 3 && "Invalid index, out of range.");
+  SimdFloat4 ret = _v;
+  ret[_ith] = _f[0];
+  return ret;
+}
+
+OZZ_INLINE void StorePtr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  wasm_v128_store(_f, OZZ_WASM_I(_v));
+}
+
+OZZ_INLINE void Store1Ptr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  wasm_v128_store32_lane(_f, OZZ_WASM_I(_v), 0);
+}
+
+OZZ_INLINE void Store2Ptr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  wasm_v128_store64_lane(_f, OZZ_WASM_I(_v), 0);
+}
+
+OZZ_INLINE void Store3Ptr(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0xf) && "Invalid alignment");
+  wasm_v128_store64_lane(_f, OZZ_WASM_I(_v), 0);
+  wasm_v128_store32_lane(_f + 2, OZZ_WASM_I(_v), 2);
+}
+
+OZZ_INLINE void StorePtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  wasm_v128_store(_f, OZZ_WASM_I(_v));
+}
+
+OZZ_INLINE void Store1PtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  wasm_v128_store32_lane(_f, OZZ_WASM_I(_v), 0);
+}
+
+OZZ_INLINE void Store2PtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  wasm_v128_store64_lane(_f, OZZ_WASM_I(_v), 0);
+}
+
+OZZ_INLINE void Store3PtrU(_SimdFloat4 _v, float* _f) {
+  assert(!(reinterpret_cast<uintptr_t>(_f) & 0x3) && "Invalid alignment");
+  wasm_v128_store64_lane(_f, OZZ_WASM_I(_v), 0);
+  wasm_v128_store32_lane(_f + 2, OZZ_WASM_I(_v), 2);
+}
+
+// Non-temporal stores aren't exposed, they fall back to regular stores.
+OZZ_INLINE void StreamPtr(_SimdFloat4 _v, float* _f) { StorePtr(_v, _f); }
+
+OZZ_INLINE void Stream3PtrU(_SimdFloat4 _v, float* _f) { Store3PtrU(_v, _f); }
+
+OZZ_INLINE void StreamFence() {}
+
+OZZ_INLINE SimdFloat4 SplatX(_SimdFloat4 _v) { return OZZ_WASM_SPLAT_F(_v, 0); }
+
+OZZ_INLINE SimdFloat4 SplatY(_SimdFloat4 _v) { return OZZ_WASM_SPLAT_F(_v, 1); }
+
+OZZ_INLINE SimdFloat4 SplatZ(_SimdFloat4 _v) { return OZZ_WASM_SPLAT_F(_v, 2); }
+
+OZZ_INLINE SimdFloat4 SplatW(_SimdFloat4 _v) { return OZZ_WASM_SPLAT_F(_v, 3); }
+
+template <size_t _X, size_t _Y, size_t _Z, size_t _W>
+OZZ_INLINE SimdFloat4 Swizzle(_SimdFloat4 _v) {
+  static_assert(_X <= 3 && _Y <= 3 && _Z <= 3 && _W <= 3,
+                "Indices must be between 0 and 3");
+  return internal::WasmShuffle<_X, _Y, _Z, _W>(_v, _v);
+}
+
+template <>
+OZZ_INLINE SimdFloat4 Swizzle<0, 1, 2, 3>(_SimdFloat4 _v) {
+  return _v;
+}
+
+OZZ_INLINE void Transpose4x1(const SimdFloat4 _in[4], SimdFloat4 _out[1]) {
+  const SimdFloat4 xz = OZZ_WASM_ZIP1_F(_in[0], _in[2]);
+  const SimdFloat4 yw = OZZ_WASM_ZIP1_F(_in[1], _in[3]);
+  _out[0] = OZZ_WASM_ZIP1_F(xz, yw);
+}
+
+OZZ_INLINE void Transpose1x4(const SimdFloat4 _in[1], SimdFloat4 _out[4]) {
+  const v128_t in = OZZ_WASM_I(_in[0]);
+  const v128_t zero = wasm_i32x4_splat(0);
+  _out[0] = OZZ_WASM_F(wasm_i32x4_shuffle(in, zero, 0, 4, 4, 4));
+  _out[1] = OZZ_WASM_F(wasm_i32x4_shuffle(in, zero, 1, 4, 4, 4));
+  _out[2] = OZZ_WASM_F(wasm_i32x4_shuffle(in, zero, 2, 4, 4, 4));
+  _out[3] = OZZ_WASM_F(wasm_i32x4_shuffle(in, zero, 3, 4, 4, 4));
+}
+
+OZZ_INLINE void Transpose4x2(const SimdFloat4 _in[4], SimdFloat4 _out[2]) {
+  const SimdFloat4 tmp0 = OZZ_WASM_ZIP1_F(_in[0], _in[2]);
+  const SimdFloat4 tmp1 = OZZ_WASM_ZIP1_F(_in[1], _in[3]);
+  _out[0] = OZZ_WASM_ZIP1_F(tmp0, tmp1);
+  _out[1] = OZZ_WASM_ZIP2_F(tmp0, tmp1);
+}
+
+OZZ_INLINE void Transpose2x4(const SimdFloat4 _in[2], SimdFloat4 _out[4]) {
+  const SimdFloat4 tmp0 = OZZ_WASM_ZIP1_F(_in[0], _in[1]);
+  const SimdFloat4 tmp1 = OZZ_WASM_ZIP2_F(_in[0], _in[1]);
+  const SimdFloat4 zero = simd_float4::zero();
+  _out[0] = OZZ_WASM_LOW_F(tmp0, zero);
+  _out[1] = OZZ_WASM_HIGH_F(tmp0, zero);
+  _out[2] = OZZ_WASM_LOW_F(tmp1, zero);
+  _out[3] = OZZ_WASM_HIGH_F(tmp1, zero);
+}
+
+OZZ_INLINE void Transpose4x3(const SimdFloat4 _in[4], SimdFloat4 _out[3]) {
+  const SimdFloat4 tmp0 = OZZ_WASM_ZIP1_F(_in[0], _in[2]);
+  const SimdFloat4 tmp1 = OZZ_WASM_ZIP1_F(_in[1], _in[3]);
+  const SimdFloat4 tmp2 = OZZ_WASM_ZIP2_F(_in[0], _in[2]);
+  const SimdFloat4 tmp3 = OZZ_WASM_ZIP2_F(_in[1], _in[3]);
+  _out[0] = OZZ_WASM_ZIP1_F(tmp0, tmp1);
+  _out[1] = OZZ_WASM_ZIP2_F(tmp0, tmp1);
+  _out[2] = OZZ_WASM_ZIP1_F(tmp2, tmp3);
+}
+
+OZZ_INLINE void Transpose3x4(const SimdFloat4 _in[3], SimdFloat4 _out[4]) {
+  const SimdFloat4 zero = simd_float4::zero();
+  const SimdFloat4 temp0 = OZZ_WASM_ZIP1_F(_in[0], _in[1]);
+  const SimdFloat4 temp1 = OZZ_WASM_ZIP1_F(_in[2], zero);
+  const SimdFloat4 temp2 = OZZ_WASM_ZIP2_F(_in[0], _in[1]);
+  const SimdFloat4 temp3 = OZZ_WASM_ZIP2_F(_in[2], zero);
+  _out[0] = OZZ_WASM_LOW_F(temp0, temp1);
+  _out[1] = OZZ_WASM_HIGH_F(temp0, temp1);
+  _out[2] = OZZ_WASM_LOW_F(temp2, temp3);
+  _out[3] = OZZ_WASM_HIGH_F(temp2, temp3);
+}
+
+OZZ_INLINE void Transpose4x4(const SimdFloat4 _in[4], SimdFloat4 _out[4]) {
+  const SimdFloat4 tmp0 = OZZ_WASM_ZIP1_F(_in[0], _in[2]);
+  const SimdFloat4 tmp1 = OZZ_WASM_ZIP1_F(_in[1], _in[3]);
+  const SimdFloat4 tmp2 = OZZ_WASM_ZIP2_F(_in[0], _in[2]);
+  const SimdFloat4 tmp3 = OZZ_WASM_ZIP2_F(_in[1], _in[3]);
+  _out[0] = OZZ_WASM_ZIP1_F(tmp0, tmp1);
+  _out[1] = OZZ_WASM_ZIP2_F(tmp0, tmp1);
+  _out[2] = OZZ_WASM_ZIP1_F(tmp2, tmp3);
+  _out[3] = OZZ_WASM_ZIP2_F(tmp2, tmp3);
+}
+
+OZZ_INLINE void Transpose16x16(const SimdFloat4 _in[16], SimdFloat4 _out[16]) {
+  for (int i = 0; i < 4; ++i) {
+    const SimdFloat4* in = _in + i * 4;
+    const SimdFloat4 tmp0 = OZZ_WASM_ZIP1_F(in[0], in[2]);
+    const SimdFloat4 tmp1 = OZZ_WASM_ZIP1_F(in[1], in[3]);
+    const SimdFloat4 tmp2 = OZZ_WASM_ZIP2_F(in[0], in[2]);
+    const SimdFloat4 tmp3 = OZZ_WASM_ZIP2_F(in[1], in[3]);
+    _out[i + 0] = OZZ_WASM_ZIP1_F(tmp0, tmp1);
+    _out[i + 4] = OZZ_WASM_ZIP2_F(tmp0, tmp1);
+    _out[i + 8] = OZZ_WASM_ZIP1_F(tmp2, tmp3);
+    _out[i + 12] = OZZ_WASM_ZIP2_F(tmp2, tmp3);
+  }
+}
+
+OZZ_INLINE SimdFloat4 MAdd(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _c) {
+  return OZZ_MADD(_a, _b, _c);
+}
+
+OZZ_INLINE SimdFloat4 MSub(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _c) {
+  return OZZ_MSUB(_a, _b, _c);
+}
+
+OZZ_INLINE SimdFloat4 NMAdd(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _c) {
+  return OZZ_NMADD(_a, _b, _c);
+}
+
+OZZ_INLINE SimdFloat4 NMSub(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _c) {
+  return OZZ_NMSUB(_a, _b, _c);
+}
+
+OZZ_INLINE SimdFloat4 DivX(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_WASM_MOVE_X_F(_a, _a / _b);
+}
+
+OZZ_INLINE SimdFloat4 HAdd2(_SimdFloat4 _v) {
+  return OZZ_WASM_MOVE_X_F(_v, OZZ_WASM_HADD2_F(_v));
+}
+
+OZZ_INLINE SimdFloat4 HAdd3(_SimdFloat4 _v) {
+  return OZZ_WASM_MOVE_X_F(_v, OZZ_WASM_HADD3_F(_v));
+}
+
+OZZ_INLINE SimdFloat4 HAdd4(_SimdFloat4 _v) {
+  SimdFloat4 hadd4;
+  OZZ_WASM_HADD4_F(_v, hadd4);
+  return hadd4;
+}
+
+OZZ_INLINE SimdFloat4 Dot2(_SimdFloat4 _a, _SimdFloat4 _b) {
+  const SimdFloat4 ab = _a * _b;
+  return OZZ_WASM_HADD2_F(ab);
+}
+
+OZZ_INLINE SimdFloat4 Dot3(_SimdFloat4 _a, _SimdFloat4 _b) {
+  const SimdFloat4 ab = _a * _b;
+  return OZZ_WASM_HADD3_F(ab);
+}
+
+OZZ_INLINE SimdFloat4 Dot4(_SimdFloat4 _a, _SimdFloat4 _b) {
+  const SimdFloat4 ab = _a * _b;
+  SimdFloat4 dot4;
+  OZZ_WASM_HADD4_F(ab, dot4);
+  return dot4;
+}
+
+OZZ_INLINE SimdFloat4 Cross3(_SimdFloat4 _a, _SimdFloat4 _b) {
+  // Implementation with 3 shuffles only is based on:
+  // https://geometrian.com/programming/tutorials/cross-product
+  const SimdFloat4 shufa = OZZ_WASM_SWIZZLE_F(_a, 1, 2, 0, 3);
+  const SimdFloat4 shufb = OZZ_WASM_SWIZZLE_F(_b, 1, 2, 0, 3);
+  const SimdFloat4 shufc =
+      OZZ_MSUB(_a, shufb, (_b * shufa));
+  return OZZ_WASM_SWIZZLE_F(shufc, 1, 2, 0, 3);
+}
+
+// SIMD128 has no reciprocal estimation instruction, so estimations are
+// computed with full precision divisions and square roots.
+OZZ_INLINE SimdFloat4 RcpEst(_SimdFloat4 _v) {
+  return simd_float4::one() / _v;
+}
+
+OZZ_INLINE SimdFloat4 RcpEstNR(_SimdFloat4 _v) { return RcpEst(_v); }
+
+OZZ_INLINE SimdFloat4 RcpEstX(_SimdFloat4 _v) {
+  return OZZ_WASM_MOVE_X_F(_v, RcpEst(_v));
+}
+
+OZZ_INLINE SimdFloat4 RcpEstXNR(_SimdFloat4 _v) { return RcpEstX(_v); }
+
+OZZ_INLINE SimdFloat4 Sqrt(_SimdFloat4 _v) {
+  return OZZ_WASM_F(wasm_f32x4_sqrt(OZZ_WASM_I(_v)));
+}
+
+OZZ_INLINE SimdFloat4 SqrtX(_SimdFloat4 _v) {
+  return OZZ_WASM_MOVE_X_F(_v, Sqrt(_v));
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEst(_SimdFloat4 _v) {
+  return simd_float4::one() / Sqrt(_v);
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEstNR(_SimdFloat4 _v) { return RSqrtEst(_v); }
+
+OZZ_INLINE SimdFloat4 RSqrtEstX(_SimdFloat4 _v) {
+  return OZZ_WASM_MOVE_X_F(_v, RSqrtEst(_v));
+}
+
+OZZ_INLINE SimdFloat4 RSqrtEstXNR(_SimdFloat4 _v) { return RSqrtEstX(_v); }
+
+OZZ_INLINE SimdFloat4 Abs(_SimdFloat4 _v) {
+  return OZZ_WASM_F(wasm_f32x4_abs(OZZ_WASM_I(_v)));
+}
+
+OZZ_INLINE SimdInt4 Sign(_SimdFloat4 _v) {
+  return wasm_v128_and(OZZ_WASM_I(_v), wasm_i32x4_splat(0x80000000));
+}
+
+OZZ_INLINE SimdFloat4 Length2(_SimdFloat4 _v) { return Sqrt(Dot2(_v, _v)); }
+
+OZZ_INLINE SimdFloat4 Length3(_SimdFloat4 _v) { return Sqrt(Dot3(_v, _v)); }
+
+OZZ_INLINE SimdFloat4 Length4(_SimdFloat4 _v) { return Sqrt(Dot4(_v, _v)); }
+
+OZZ_INLINE SimdFloat4 Length2Sqr(_SimdFloat4 _v) { return Dot2(_v, _v); }
+
+OZZ_INLINE SimdFloat4 Length3Sqr(_SimdFloat4 _v) { return Dot3(_v, _v); }
+
+OZZ_INLINE SimdFloat4 Length4Sqr(_SimdFloat4 _v) { return Dot4(_v, _v); }
+
+namespace internal {
+// Returns the inverse length of a vector which squared length is stored in the
+// x component of _sq_len, splatted to all components.
+OZZ_INLINE SimdFloat4 WasmInvLength(_SimdFloat4 _sq_len) {
+  assert(_sq_len[0] != 0.f && "_v is not normalizable");
+  return RSqrtEst(OZZ_WASM_SPLAT_F(_sq_len, 0));
+}
+}  // namespace internal
+
+OZZ_INLINE SimdFloat4 Normalize2(_SimdFloat4 _v) {
+  const SimdFloat4 inv_len = internal::WasmInvLength(Dot2(_v, _v));
+  return OZZ_WASM_LOW_F(_v * inv_len, OZZ_WASM_HIGH_F(_v, _v));
+}
+
+OZZ_INLINE SimdFloat4 Normalize3(_SimdFloat4 _v) {
+  const SimdFloat4 inv_len = internal::WasmInvLength(Dot3(_v, _v));
+  return SetW(_v * inv_len, SplatW(_v));
+}
+
+OZZ_INLINE SimdFloat4 Normalize4(_SimdFloat4 _v) {
+  const SimdFloat4 inv_len = internal::WasmInvLength(Dot4(_v, _v));
+  return _v * inv_len;
+}
+
+OZZ_INLINE SimdFloat4 NormalizeEst2(_SimdFloat4 _v) { return Normalize2(_v); }
+
+OZZ_INLINE SimdFloat4 NormalizeEst3(_SimdFloat4 _v) { return Normalize3(_v); }
+
+OZZ_INLINE SimdFloat4 NormalizeEst4(_SimdFloat4 _v) { return Normalize4(_v); }
+
+namespace internal {
+// Tests if x component of _sq_len is within ]_min,_max[. Other components of
+// the returned mask are false.
+OZZ_INLINE SimdInt4 WasmIsNormalizedX(_SimdFloat4 _sq_len, float _tolerance) {
+  const v128_t max = wasm_f32x4_splat(1.f + _tolerance);
+  const v128_t min = wasm_f32x4_splat(1.f - _tolerance);
+  const v128_t normalized =
+      wasm_v128_and(wasm_f32x4_lt(OZZ_WASM_I(_sq_len), max),
+                    wasm_f32x4_gt(OZZ_WASM_I(_sq_len), min));
+  return wasm_i32x4_shuffle(normalized, wasm_i32x4_splat(0), 0, 4, 4, 4);
+}
+}  // namespace internal
+
+OZZ_INLINE SimdInt4 IsNormalized2(_SimdFloat4 _v) {
+  return internal::WasmIsNormalizedX(Dot2(_v, _v), kNormalizationToleranceSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalized3(_SimdFloat4 _v) {
+  return internal::WasmIsNormalizedX(Dot3(_v, _v), kNormalizationToleranceSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalized4(_SimdFloat4 _v) {
+  return internal::WasmIsNormalizedX(Dot4(_v, _v), kNormalizationToleranceSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalizedEst2(_SimdFloat4 _v) {
+  return internal::WasmIsNormalizedX(Dot2(_v, _v),
+                                     kNormalizationToleranceEstSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalizedEst3(_SimdFloat4 _v) {
+  return internal::WasmIsNormalizedX(Dot3(_v, _v),
+                                     kNormalizationToleranceEstSq);
+}
+
+OZZ_INLINE SimdInt4 IsNormalizedEst4(_SimdFloat4 _v) {
+  return internal::WasmIsNormalizedX(Dot4(_v, _v),
+                                     kNormalizationToleranceEstSq);
+}
+
+namespace internal {
+// Selects _safe if x component of _sq_len is 0, _norm otherwise.
+OZZ_INLINE SimdFloat4 WasmSelectSafe(_SimdFloat4 _sq_len, _SimdFloat4 _safe,
+                                     _SimdFloat4 _norm) {
+  const v128_t cond =
+      wasm_f32x4_le(OZZ_WASM_I(OZZ_WASM_SPLAT_F(_sq_len, 0)),
+                    wasm_f32x4_splat(0.f));
+  return OZZ_WASM_SELECT_F(cond, _safe, _norm);
+}
+}  // namespace internal
+
+OZZ_INLINE SimdFloat4 NormalizeSafe2(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalized2(_safe)) && "_safe is not normalized");
+  const SimdFloat4 sq_len = Dot2(_v, _v);
+  const SimdFloat4 inv_len = RSqrtEst(OZZ_WASM_SPLAT_F(sq_len, 0));
+  const SimdFloat4 norm =
+      OZZ_WASM_LOW_F(_v * inv_len, OZZ_WASM_HIGH_F(_v, _v));
+  return internal::WasmSelectSafe(sq_len, _safe, norm);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafe3(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalized3(_safe)) && "_safe is not normalized");
+  const SimdFloat4 sq_len = Dot3(_v, _v);
+  const SimdFloat4 inv_len = RSqrtEst(OZZ_WASM_SPLAT_F(sq_len, 0));
+  const SimdFloat4 norm =
+      SetW(_v * inv_len, SplatW(_v));
+  return internal::WasmSelectSafe(sq_len, _safe, norm);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafe4(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  // assert(AreAllTrue1(IsNormalized4(_safe)) && "_safe is not normalized");
+  const SimdFloat4 sq_len = Dot4(_v, _v);
+  const SimdFloat4 inv_len = RSqrtEst(OZZ_WASM_SPLAT_F(sq_len, 0));
+  const SimdFloat4 norm = _v * inv_len;
+  return internal::WasmSelectSafe(sq_len, _safe, norm);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafeEst2(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  return NormalizeSafe2(_v, _safe);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafeEst3(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  return NormalizeSafe3(_v, _safe);
+}
+
+OZZ_INLINE SimdFloat4 NormalizeSafeEst4(_SimdFloat4 _v, _SimdFloat4 _safe) {
+  return NormalizeSafe4(_v, _safe);
+}
+
+OZZ_INLINE SimdFloat4 Lerp(_SimdFloat4 _a, _SimdFloat4 _b, _SimdFloat4 _alpha) {
+  return OZZ_MADD(_alpha, (_b - _a), _a);
+}
+
+// Min and Max use pseudo-minimum and pseudo-maximum instructions, with
+// arguments swapped to match SSE semantic: the second argument is returned if
+// one of them is NaN. Clamp relies on it.
+OZZ_INLINE SimdFloat4 Min(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_WASM_F(wasm_f32x4_pmin(OZZ_WASM_I(_b), OZZ_WASM_I(_a)));
+}
+
+OZZ_INLINE SimdFloat4 Max(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_WASM_F(wasm_f32x4_pmax(OZZ_WASM_I(_b), OZZ_WASM_I(_a)));
+}
+
+OZZ_INLINE SimdFloat4 Min0(_SimdFloat4 _v) {
+  return Min(simd_float4::zero(), _v);
+}
+
+OZZ_INLINE SimdFloat4 Max0(_SimdFloat4 _v) {
+  return Max(simd_float4::zero(), _v);
+}
+
+OZZ_INLINE SimdFloat4 Clamp(_SimdFloat4 _a, _SimdFloat4 _v, _SimdFloat4 _b) {
+  return Max(_a, Min(_v, _b));
+}
+
+OZZ_INLINE SimdFloat4 Select(_SimdInt4 _b, _SimdFloat4 _true,
+                             _SimdFloat4 _false) {
+  return OZZ_WASM_SELECT_F(_b, _true, _false);
+}
+
+OZZ_INLINE SimdInt4 CmpEq(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return wasm_f32x4_eq(OZZ_WASM_I(_a), OZZ_WASM_I(_b));
+}
+
+OZZ_INLINE SimdInt4 CmpNe(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return wasm_f32x4_ne(OZZ_WASM_I(_a), OZZ_WASM_I(_b));
+}
+
+OZZ_INLINE SimdInt4 CmpLt(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return wasm_f32x4_lt(OZZ_WASM_I(_a), OZZ_WASM_I(_b));
+}
+
+OZZ_INLINE SimdInt4 CmpLe(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return wasm_f32x4_le(OZZ_WASM_I(_a), OZZ_WASM_I(_b));
+}
+
+OZZ_INLINE SimdInt4 CmpGt(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return wasm_f32x4_gt(OZZ_WASM_I(_a), OZZ_WASM_I(_b));
+}
+
+OZZ_INLINE SimdInt4 CmpGe(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return wasm_f32x4_ge(OZZ_WASM_I(_a), OZZ_WASM_I(_b));
+}
+
+OZZ_INLINE SimdFloat4 And(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_WASM_F(wasm_v128_and(OZZ_WASM_I(_a), OZZ_WASM_I(_b)));
+}
+
+OZZ_INLINE SimdFloat4 Or(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_WASM_F(wasm_v128_or(OZZ_WASM_I(_a), OZZ_WASM_I(_b)));
+}
+
+OZZ_INLINE SimdFloat4 Xor(_SimdFloat4 _a, _SimdFloat4 _b) {
+  return OZZ_WASM_F(wasm_v128_xor(OZZ_WASM_I(_a), OZZ_WASM_I(_b)));
+}
+
+OZZ_INLINE SimdFloat4 And(_SimdFloat4 _a, _SimdInt4 _b) {
+  return OZZ_WASM_F(wasm_v128_and(OZZ_WASM_I(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 AndNot(_SimdFloat4 _a, _SimdInt4 _b) {
+  return OZZ_WASM_F(wasm_v128_andnot(OZZ_WASM_I(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 Or(_SimdFloat4 _a, _SimdInt4 _b) {
+  return OZZ_WASM_F(wasm_v128_or(OZZ_WASM_I(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 Xor(_SimdFloat4 _a, _SimdInt4 _b) {
+  return OZZ_WASM_F(wasm_v128_xor(OZZ_WASM_I(_a), _b));
+}
+
+OZZ_INLINE SimdFloat4 Cos(_SimdFloat4 _v) {
+  return simd_float4::Load(std::cos(_v[0]), std::cos(_v[1]), std::cos(_v[2]),
+                           std::cos(_v[3]));
+}
+
+OZZ_INLINE SimdFloat4 CosX(_SimdFloat4 _v) {
+  SimdFloat4 ret = _v;
+  ret[0] = std::cos(_v[0]);
+  return ret;
+}
+
+OZZ_INLINE SimdFloat4 ACos(_SimdFloat4 _v) {
+  return simd_float4::Load(std::acos(_v[0]), std::acos(_v[1]),
+                           std::acos(_v[2]), std::acos(_v[3]));
+}
+
+OZZ_INLINE SimdFloat4 ACosX(_SimdFloat4 _v) {
+  SimdFloat4 ret = _v;
+  ret[0] = std::acos(_v[0]);
+  return ret;
+}
+
+OZZ_INLINE SimdFloat4 Sin(_SimdFloat4 _v) {
+  return simd_float4::Load(std::sin(_v[0]), std::sin(_v[1]), std::sin(_v[2]),
+                           std::sin(_v[3]));
+}
+
+OZZ_INLINE SimdFloat4 SinX(_SimdFloat4 _v) {
+  SimdFloat4 ret = _v;
+  ret[0] = std::sin(_v[0]);
+  return ret;
+}
+
+OZZ_INLINE SimdFloat4 ASin(_SimdFloat4 _v) {
+  return simd_float4::Load(std::asin(_v[0]), std::asin(_v[1]),
+                           std::asin(_v[2]), std::asin(_v[3]));
+}
+
+OZZ_INLINE SimdFloat4 ASinX(_SimdFloat4 _v) {
+  SimdFloat4 ret = _v;
+  ret[0] = std::asin(_v[0]);
+  return ret;
+}
+
+OZZ_INLINE SimdFloat4 Tan(_SimdFloat4 _v) {
+  return simd_float4::Load(std::tan(_v[0]), std::tan(_v[1]), std::tan(_v[2]),
+                           std::tan(_v[3]));
+}
+
+OZZ_INLINE SimdFloat4 TanX(_SimdFloat4 _v) {
+  SimdFloat4 ret = _v;
+  ret[0] = std::tan(_v[0]);
+  return ret;
+}
+
+OZZ_INLINE SimdFloat4 ATan(_SimdFloat4 _v) {
+  return simd_float4::Load(std::atan(_v[0]), std::atan(_v[1]),
+                           std::atan(_v[2]), std::atan(_v[3]));
+}
+
+OZZ_INLINE SimdFloat4 ATanX(_SimdFloat4 _v) {
+  SimdFloat4 ret = _v;
+  ret[0] = std::atan(_v[0]);
+  return ret;
+}
+
+namespace simd_int4 {
+
+OZZ_INLINE SimdInt4 zero() { return wasm_i32x4_splat(0); }
+
+OZZ_INLINE SimdInt4 one() { return wasm_i32x4_splat(1); }
+
+OZZ_INLINE SimdInt4 x_axis() { return wasm_i32x4_make(1, 0, 0, 0); }
+
+OZZ_INLINE SimdInt4 y_axis() { return wasm_i32x4_make(0, 1, 0, 0); }
+
+OZZ_INLINE SimdInt4 z_axis() { return wasm_i32x4_make(0, 0, 1, 0); }
+
+OZZ_INLINE SimdInt4 w_axis() { return wasm_i32x4_make(0, 0, 0, 1); }
+
+OZZ_INLINE SimdInt4 all_true() { return wasm_i32x4_splat(-1); }
+
+OZZ_INLINE SimdInt4 all_false() { return wasm_i32x4_splat(0); }
+
+OZZ_INLINE SimdInt4 mask_sign() { return wasm_i32x4_splat(0x80000000); }
+
+OZZ_INLINE SimdInt4 mask_sign_xyz() {
+  return wasm_i32x4_make(0x80000000, 0x80000000, 0x80000000, 0);
+}
+
+OZZ_INLINE SimdInt4 mask_sign_w() {
+  return wasm_i32x4_make(0, 0, 0, 0x80000000);
+}
+
+OZZ_INLINE SimdInt4 mask_not_sign() { return wasm_i32x4_splat(0x7fffffff); }
+
+OZZ_INLINE SimdInt4 mask_ffff() { return wasm_i32x4_splat(-1); }
+
+OZZ_INLINE SimdInt4 mask_0000() { return wasm_i32x4_splat(0); }
+
+OZZ_INLINE SimdInt4 mask_fff0() { return wasm_i32x4_make(-1, -1, -1, 0); }
+
+OZZ_INLINE SimdInt4 mask_f000() { return wasm_i32x4_make(-1, 0, 0, 0); }
+
+OZZ_INLINE SimdInt4 mask_0f00() { return wasm_i32x4_make(0, -1, 0, 0); }
+
+OZZ_INLINE SimdInt4 mask_00f0() { return wasm_i32x4_make(0, 0, -1, 0); }
+
+OZZ_INLINE SimdInt4 mask_000f() { return wasm_i32x4_make(0, 0, 0, -1); }
+
+OZZ_INLINE SimdInt4 Load(int _x, int _y, int _z, int _w) {
+  return wasm_i32x4_make(_x, _y, _z, _w);
+}
+
+OZZ_INLINE SimdInt4 LoadX(int _x) { return wasm_i32x4_make(_x, 0, 0, 0); }
+
+OZZ_INLINE SimdInt4 Load1(int _x) { return wasm_i32x4_splat(_x); }
+
+OZZ_INLINE SimdInt4 Load(bool _x, bool _y, bool _z, bool _w) {
+  return wasm_i32x4_make(-static_cast<int>(_x), -static_cast<int>(_y),
+                         -static_cast<int>(_z), -static_cast<int>(_w));
+}
+
+OZZ_INLINE SimdInt4 LoadX(bool _x) {
+  return wasm_i32x4_make(-static_cast<int>(_x), 0, 0, 0);
+}
+
+OZZ_INLINE SimdInt4 Load1(bool _x) {
+  return wasm_i32x4_splat(-static_cast<int>(_x));
+}
+
+OZZ_INLINE SimdInt4 LoadPtr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return wasm_v128_load(_i);
+}
+
+OZZ_INLINE SimdInt4 LoadXPtr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return wasm_v128_load32_zero(_i);
+}
+
+OZZ_INLINE SimdInt4 Load1Ptr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return wasm_v128_load32_splat(_i);
+}
+
+OZZ_INLINE SimdInt4 Load2Ptr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return wasm_v128_load64_zero(_i);
+}
+
+OZZ_INLINE SimdInt4 Load3Ptr(const int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  return wasm_v128_load32_lane(_i + 2, wasm_v128_load64_zero(_i), 2);
+}
+
+OZZ_INLINE SimdInt4 LoadPtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return wasm_v128_load(_i);
+}
+
+OZZ_INLINE SimdInt4 LoadXPtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return wasm_v128_load32_zero(_i);
+}
+
+OZZ_INLINE SimdInt4 Load1PtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return wasm_v128_load32_splat(_i);
+}
+
+OZZ_INLINE SimdInt4 Load2PtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return wasm_v128_load64_zero(_i);
+}
+
+OZZ_INLINE SimdInt4 Load3PtrU(const int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  return wasm_v128_load32_lane(_i + 2, wasm_v128_load64_zero(_i), 2);
+}
+
+OZZ_INLINE SimdInt4 FromFloatRound(_SimdFloat4 _f) {
+  return wasm_i32x4_trunc_sat_f32x4(wasm_f32x4_nearest(OZZ_WASM_I(_f)));
+}
+
+OZZ_INLINE SimdInt4 FromFloatTrunc(_SimdFloat4 _f) {
+  return wasm_i32x4_trunc_sat_f32x4(OZZ_WASM_I(_f));
+}
+}  // namespace simd_int4
+
+OZZ_INLINE int GetX(_SimdInt4 _v) { return wasm_i32x4_extract_lane(_v, 0); }
+
+OZZ_INLINE int GetY(_SimdInt4 _v) { return wasm_i32x4_extract_lane(_v, 1); }
+
+OZZ_INLINE int GetZ(_SimdInt4 _v) { return wasm_i32x4_extract_lane(_v, 2); }
+
+OZZ_INLINE int GetW(_SimdInt4 _v) { return wasm_i32x4_extract_lane(_v, 3); }
+
+OZZ_INLINE SimdInt4 SetX(_SimdInt4 _v, _SimdInt4 _i) {
+  return OZZ_WASM_MOVE_X_I(_v, _i);
+}
+
+OZZ_INLINE SimdInt4 SetY(_SimdInt4 _v, _SimdInt4 _i) {
+  return wasm_i32x4_shuffle(_v, _i, 0, 4, 2, 3);
+}
+
+OZZ_INLINE SimdInt4 SetZ(_SimdInt4 _v, _SimdInt4 _i) {
+  return wasm_i32x4_shuffle(_v, _i, 0, 1, 4, 3);
+}
+
+OZZ_INLINE SimdInt4 SetW(_SimdInt4 _v, _SimdInt4 _i) {
+  return wasm_i32x4_shuffle(_v, _i, 0, 1, 2, 4);
+}
+
+OZZ_INLINE SimdInt4 SetI(_SimdInt4 _v, _SimdInt4 _i, int _ith) {
+  assert(_ith >= 0 && _ith <= 3 && "Invalid index, out of range.");
+  SimdInt4 ret = _v;
+  ret[_ith] = GetX(_i);
+  return ret;
+}
+
+OZZ_INLINE void StorePtr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  wasm_v128_store(_i, _v);
+}
+
+OZZ_INLINE void Store1Ptr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  wasm_v128_store32_lane(_i, _v, 0);
+}
+
+OZZ_INLINE void Store2Ptr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  wasm_v128_store64_lane(_i, _v, 0);
+}
+
+OZZ_INLINE void Store3Ptr(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0xf) && "Invalid alignment");
+  wasm_v128_store64_lane(_i, _v, 0);
+  wasm_v128_store32_lane(_i + 2, _v, 2);
+}
+
+OZZ_INLINE void StorePtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  wasm_v128_store(_i, _v);
+}
+
+OZZ_INLINE void Store1PtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  wasm_v128_store32_lane(_i, _v, 0);
+}
+
+OZZ_INLINE void Store2PtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  wasm_v128_store64_lane(_i, _v, 0);
+}
+
+OZZ_INLINE void Store3PtrU(_SimdInt4 _v, int* _i) {
+  assert(!(uintptr_t(_i) & 0x3) && "Invalid alignment");
+  wasm_v128_store64_lane(_i, _v, 0);
+  wasm_v128_store32_lane(_i + 2, _v, 2);
+}
+
+OZZ_INLINE SimdInt4 SplatX(_SimdInt4 _a) { return OZZ_WASM_SPLAT_I(_a, 0); }
+
+OZZ_INLINE SimdInt4 SplatY(_SimdInt4 _a) { return OZZ_WASM_SPLAT_I(_a, 1); }
+
+OZZ_INLINE SimdInt4 SplatZ(_SimdInt4 _a) { return OZZ_WASM_SPLAT_I(_a, 2); }
+
+OZZ_INLINE SimdInt4 SplatW(_SimdInt4 _a) { return OZZ_WASM_SPLAT_I(_a, 3); }
+
+template <size_t _X, size_t _Y, size_t _Z, size_t _W>
+OZZ_INLINE SimdInt4 Swizzle(_SimdInt4 _v) {
+  static_assert(_X <= 3 && _Y <= 3 && _Z <= 3 && _W <= 3,
+                "Indices must be between 0 and 3");
+  return wasm_i32x4_shuffle(_v, _v, _X, _Y, _Z, _W);
+}
+
+template <>
+OZZ_INLINE SimdInt4 Swizzle<0, 1, 2, 3>(_SimdInt4 _v) {
+  return _v;
+}
+
+OZZ_INLINE int MoveMask(_SimdInt4 _v) {
+  return static_cast<int>(wasm_i32x4_bitmask(_v));
+}
+
+OZZ_INLINE bool AreAllTrue(_SimdInt4 _v) { return MoveMask(_v) == 0xf; }
+
+OZZ_INLINE bool AreAllTrue3(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x7) == 0x7;
+}
+
+OZZ_INLINE bool AreAllTrue2(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x3) == 0x3;
+}
+
+OZZ_INLINE bool AreAllTrue1(_SimdInt4 _v) {
+  return (MoveMask(_v) & 0x1) == 0x1;
+}
+
+OZZ_INLINE bool AreAllFalse(_SimdInt4 _v) { return MoveMask(_v) == 0; }
+
+OZZ_INLINE bool AreAllFalse3(_SimdInt4 _v) { return (MoveMask(_v) & 0x7) == 0; }
+
+OZZ_INLINE bool AreAllFalse2(_SimdInt4 _v) { return (MoveMask(_v) & 0x3) == 0; }
+
+OZZ_INLINE bool AreAllFalse1(_SimdInt4 _v) { return (MoveMask(_v) & 0x1) == 0; }
+
+OZZ_INLINE SimdInt4 HAdd2(_SimdInt4 _v) {
+  const v128_t hadd = wasm_i32x4_add(_v, OZZ_WASM_SPLAT_I(_v, 1));
+  return OZZ_WASM_MOVE_X_I(_v, hadd);
+}
+
+OZZ_INLINE SimdInt4 HAdd3(_SimdInt4 _v) {
+  const v128_t hadd = wasm_i32x4_add(
+      wasm_i32x4_add(_v, OZZ_WASM_SPLAT_I(_v, 1)), OZZ_WASM_SPLAT_I(_v, 2));
+  return OZZ_WASM_MOVE_X_I(_v, hadd);
+}
+
+OZZ_INLINE SimdInt4 HAdd4(_SimdInt4 _v) {
+  const v128_t hadd =
+      wasm_i32x4_add(_v, wasm_i32x4_shuffle(_v, _v, 2, 3, 2, 3));
+  return OZZ_WASM_MOVE_X_I(
+      _v, wasm_i32x4_add(hadd, OZZ_WASM_SPLAT_I(hadd, 1)));
+}
+
+OZZ_INLINE SimdInt4 Abs(_SimdInt4 _v) { return wasm_i32x4_abs(_v); }
+
+OZZ_INLINE SimdInt4 Sign(_SimdInt4 _v) {
+  return wasm_v128_and(_v, simd_int4::mask_sign());
+}
+
+OZZ_INLINE SimdInt4 Min(_SimdInt4 _a, _SimdInt4 _b) {
+  return wasm_i32x4_min(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Max(_SimdInt4 _a, _SimdInt4 _b) {
+  return wasm_i32x4_max(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Min0(_SimdInt4 _v) {
+  return wasm_i32x4_min(simd_int4::zero(), _v);
+}
+
+OZZ_INLINE SimdInt4 Max0(_SimdInt4 _v) {
+  return wasm_i32x4_max(simd_int4::zero(), _v);
+}
+
+OZZ_INLINE SimdInt4 Clamp(_SimdInt4 _a, _SimdInt4 _v, _SimdInt4 _b) {
+  return wasm_i32x4_min(wasm_i32x4_max(_a, _v), _b);
+}
+
+OZZ_INLINE SimdInt4 Select(_SimdInt4 _b, _SimdInt4 _true, _SimdInt4 _false) {
+  return wasm_v128_bitselect(_true, _false, _b);
+}
+
+OZZ_INLINE SimdInt4 And(_SimdInt4 _a, _SimdInt4 _b) {
+  return wasm_v128_and(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 AndNot(_SimdInt4 _a, _SimdInt4 _b) {
+  return wasm_v128_andnot(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Or(_SimdInt4 _a, _SimdInt4 _b) {
+  return wasm_v128_or(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Xor(_SimdInt4 _a, _SimdInt4 _b) {
+  return wasm_v128_xor(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 Not(_SimdInt4 _v) { return wasm_v128_not(_v); }
+
+OZZ_INLINE SimdInt4 ShiftL(_SimdInt4 _v, int _bits) {
+  return wasm_i32x4_shl(_v, static_cast<uint32_t>(_bits));
+}
+
+OZZ_INLINE SimdInt4 ShiftR(_SimdInt4 _v, int _bits) {
+  return wasm_i32x4_shr(_v, static_cast<uint32_t>(_bits));
+}
+
+OZZ_INLINE SimdInt4 ShiftRu(_SimdInt4 _v, int _bits) {
+  return wasm_u32x4_shr(_v, static_cast<uint32_t>(_bits));
+}
+
+OZZ_INLINE SimdInt4 CmpEq(_SimdInt4 _a, _SimdInt4 _b) {
+  return wasm_i32x4_eq(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 CmpNe(_SimdInt4 _a, _SimdInt4 _b) {
+  return wasm_i32x4_ne(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 CmpLt(_SimdInt4 _a, _SimdInt4 _b) {
+  return wasm_i32x4_lt(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 CmpLe(_SimdInt4 _a, _SimdInt4 _b) {
+  return wasm_i32x4_le(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 CmpGt(_SimdInt4 _a, _SimdInt4 _b) {
+  return wasm_i32x4_gt(_a, _b);
+}
+
+OZZ_INLINE SimdInt4 CmpGe(_SimdInt4 _a, _SimdInt4 _b) {
+  return wasm_i32x4_ge(_a, _b);
+}
+
+OZZ_INLINE Float4x4 Float4x4::identity() {
+  const Float4x4 ret = {{simd_float4::x_axis(), simd_float4::y_axis(),
+                         simd_float4::z_axis(), simd_float4::w_axis()}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Transpose(const Float4x4& _m) {
+  Float4x4 ret;
+  Transpose4x4(_m.cols, ret.cols);
+  return ret;
+}
+
+inline Float4x4 Invert(const Float4x4& _m, SimdInt4* _invertible) {
+  const SimdFloat4 _t0 =
+      internal::WasmShuffle<0, 1, 0, 1>(_m.cols[0], _m.cols[1]);
+  const SimdFloat4 _t1 =
+      internal::WasmShuffle<0, 1, 0, 1>(_m.cols[2], _m.cols[3]);
+  const SimdFloat4 _t2 =
+      internal::WasmShuffle<2, 3, 2, 3>(_m.cols[0], _m.cols[1]);
+  const SimdFloat4 _t3 =
+      internal::WasmShuffle<2, 3, 2, 3>(_m.cols[2], _m.cols[3]);
+  const SimdFloat4 c0 = internal::WasmShuffle<0, 2, 0, 2>(_t0, _t1);
+  const SimdFloat4 c1 = internal::WasmShuffle<1, 3, 1, 3>(_t1, _t0);
+  const SimdFloat4 c2 = internal::WasmShuffle<0, 2, 0, 2>(_t2, _t3);
+  const SimdFloat4 c3 = internal::WasmShuffle<1, 3, 1, 3>(_t3, _t2);
+
+  SimdFloat4 minor0, minor1, minor2, minor3, tmp1, tmp2;
+  tmp1 = c2 * c3;
+  tmp1 = OZZ_WASM_SWIZZLE_F(tmp1, 1, 0, 3, 2);
+  minor0 = c1 * tmp1;
+  minor1 = c0 * tmp1;
+  tmp1 = OZZ_WASM_SWIZZLE_F(tmp1, 2, 3, 0, 1);
+  minor0 = OZZ_MSUB(c1, tmp1, minor0);
+  minor1 = OZZ_MSUB(c0, tmp1, minor1);
+  minor1 = OZZ_WASM_SWIZZLE_F(minor1, 2, 3, 0, 1);
+
+  tmp1 = c1 * c2;
+  tmp1 = OZZ_WASM_SWIZZLE_F(tmp1, 1, 0, 3, 2);
+  minor0 = OZZ_MADD(c3, tmp1, minor0);
+  minor3 = c0 * tmp1;
+  tmp1 = OZZ_WASM_SWIZZLE_F(tmp1, 2, 3, 0, 1);
+  minor0 = OZZ_NMADD(c3, tmp1, minor0);
+  minor3 = OZZ_MSUB(c0, tmp1, minor3);
+  minor3 = OZZ_WASM_SWIZZLE_F(minor3, 2, 3, 0, 1);
+
+  tmp1 = OZZ_WASM_SWIZZLE_F(c1, 2, 3, 0, 1) * c3;
+  tmp1 = OZZ_WASM_SWIZZLE_F(tmp1, 1, 0, 3, 2);
+  tmp2 = OZZ_WASM_SWIZZLE_F(c2, 2, 3, 0, 1);
+  minor0 = OZZ_MADD(tmp2, tmp1, minor0);
+  minor2 = c0 * tmp1;
+  tmp1 = OZZ_WASM_SWIZZLE_F(tmp1, 2, 3, 0, 1);
+  minor0 = OZZ_NMADD(tmp2, tmp1, minor0);
+  minor2 = OZZ_MSUB(c0, tmp1, minor2);
+  minor2 = OZZ_WASM_SWIZZLE_F(minor2, 2, 3, 0, 1);
+
+  tmp1 = c0 * c1;
+  tmp1 = OZZ_WASM_SWIZZLE_F(tmp1, 1, 0, 3, 2);
+  minor2 = OZZ_MADD(c3, tmp1, minor2);
+  minor3 = OZZ_MSUB(tmp2, tmp1, minor3);
+  tmp1 = OZZ_WASM_SWIZZLE_F(tmp1, 2, 3, 0, 1);
+  minor2 = OZZ_MSUB(c3, tmp1, minor2);
+  minor3 = OZZ_NMADD(tmp2, tmp1, minor3);
+
+  tmp1 = c0 * c3;
+  tmp1 = OZZ_WASM_SWIZZLE_F(tmp1, 1, 0, 3, 2);
+  minor1 = OZZ_NMADD(tmp2, tmp1, minor1);
+  minor2 = OZZ_MADD(c1, tmp1, minor2);
+  tmp1 = OZZ_WASM_SWIZZLE_F(tmp1, 2, 3, 0, 1);
+  minor1 = OZZ_MADD(tmp2, tmp1, minor1);
+  minor2 = OZZ_NMADD(c1, tmp1, minor2);
+
+  tmp1 = c0 * tmp2;
+  tmp1 = OZZ_WASM_SWIZZLE_F(tmp1, 1, 0, 3, 2);
+  minor1 = OZZ_MADD(c3, tmp1, minor1);
+  minor3 = OZZ_NMADD(c1, tmp1, minor3);
+  tmp1 = OZZ_WASM_SWIZZLE_F(tmp1, 2, 3, 0, 1);
+  minor1 = OZZ_NMADD(c3, tmp1, minor1);
+  minor3 = OZZ_MADD(c1, tmp1, minor3);
+
+  const SimdFloat4 det = SplatX(HAdd4(c0 * minor0));
+  const SimdInt4 invertible = CmpNe(det, simd_float4::zero());
+  assert((_invertible || AreAllTrue1(invertible)) &&
+         "Matrix is not invertible");
+  if (_invertible != nullptr) {
+    *_invertible = invertible;
+  }
+  const SimdFloat4 inv_det =
+      OZZ_WASM_SELECT_F(invertible, RcpEst(det), simd_float4::zero());
+
+  // Copy the final columns
+  const Float4x4 ret = {{inv_det * minor0, inv_det * minor1, inv_det * minor2,
+                         inv_det * minor3}};
+  return ret;
+}
+
+Float4x4 Float4x4::Translation(_SimdFloat4 _v) {
+  const Float4x4 ret = {{simd_float4::x_axis(), simd_float4::y_axis(),
+                         simd_float4::z_axis(),
+                         SetW(_v, simd_float4::one())}};
+  return ret;
+}
+
+Float4x4 Float4x4::Scaling(_SimdFloat4 _v) {
+  const SimdInt4 zero = simd_int4::zero();
+  const v128_t v = OZZ_WASM_I(_v);
+  const Float4x4 ret = {{OZZ_WASM_F(wasm_i32x4_shuffle(v, zero, 0, 4, 4, 4)),
+                         OZZ_WASM_F(wasm_i32x4_shuffle(v, zero, 4, 1, 4, 4)),
+                         OZZ_WASM_F(wasm_i32x4_shuffle(v, zero, 4, 4, 2, 4)),
+                         simd_float4::w_axis()}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Translate(const Float4x4& _m, _SimdFloat4 _v) {
+  const SimdFloat4 a01 =
+      OZZ_MADD(_m.cols[0], SplatX(_v), _m.cols[1] * SplatY(_v));
+  const SimdFloat4 m3 = OZZ_MADD(_m.cols[2], SplatZ(_v), _m.cols[3]);
+  const Float4x4 ret = {{_m.cols[0], _m.cols[1], _m.cols[2], a01 + m3}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 Scale(const Float4x4& _m, _SimdFloat4 _v) {
+  const Float4x4 ret = {{_m.cols[0] * SplatX(_v), _m.cols[1] * SplatY(_v),
+                         _m.cols[2] * SplatZ(_v), _m.cols[3]}};
+  return ret;
+}
+
+OZZ_INLINE Float4x4 ColumnMultiply(const Float4x4& _m, _SimdFloat4 _v) {
+  const Float4x4 ret = {
+      {_m.cols[0] * _v, _m.cols[1] * _v, _m.cols[2] * _v, _m.cols[3] * _v}};
+  return ret;
+}
+
+namespace internal {
+// Tests if the 3 first columns of _m have a unit length, within _tolerance.
+OZZ_INLINE SimdInt4 WasmIsNormalized(const Float4x4& _m, float _tolerance) {
+  const v128_t max = wasm_f32x4_splat(1.f + _tolerance);
+  const v128_t min = wasm_f32x4_splat(1.f - _tolerance);
+
+  SimdFloat4 rows[4];
+  Transpose4x4(_m.cols, rows);
+  const SimdFloat4 dot =
+      OZZ_MADD(rows[0], rows[0],
+               OZZ_MADD(rows[1], rows[1], rows[2] * rows[2]));
+  const v128_t normalized =
+      wasm_v128_and(wasm_f32x4_lt(OZZ_WASM_I(dot), OZZ_WASM_I(max)),
+                    wasm_f32x4_gt(OZZ_WASM_I(dot), OZZ_WASM_I(min)));
+  return wasm_v128_and(normalized, simd_int4::mask_fff0());
+}
+}  // namespace internal
+
+inline SimdInt4 IsNormalized(const Float4x4& _m) {
+  return internal::WasmIsNormalized(_m, kNormalizationToleranceSq);
+}
+
+inline SimdInt4 IsNormalizedEst(const Float4x4& _m) {
+  return internal::WasmIsNormalized(_m, kNormalizationToleranceEstSq);
+}
+
+OZZ_INLINE SimdInt4 IsOrthogonal(const Float4x4& _m) {
+  const SimdFloat4 zero = simd_float4::zero();
+
+  // Use simd_float4::zero() if one of the normalization fails. _m will then be
+  // considered not orthogonal.
+  const SimdFloat4 cross = NormalizeSafe3(Cross3(_m.cols[0], _m.cols[1]), zero);
+  const SimdFloat4 at = NormalizeSafe3(_m.cols[2], zero);
+
+  return internal::WasmIsNormalizedX(Dot3(cross, at),
+                                     kNormalizationToleranceSq);
+}
+
+inline SimdFloat4 ToQuaternion(const Float4x4& _m) {
+  assert(AreAllTrue3(IsNormalizedEst(_m)));
+  assert(AreAllTrue1(IsOrthogonal(_m)));
+
+  // Prepares constants.
+  const SimdFloat4 zero = simd_float4::zero();
+  const SimdFloat4 one = simd_float4::one();
+  const SimdFloat4 half = simd_float4::Load1(0.5f);
+  const SimdInt4 mask_f000 = simd_int4::mask_f000();
+  const SimdInt4 mask_0f00 = simd_int4::mask_0f00();
+  const SimdInt4 mask_00f0 = simd_int4::mask_00f0();
+  const SimdInt4 mask_000f = simd_int4::mask_000f();
+
+  const SimdFloat4 xx_yy = Select(mask_0f00, _m.cols[1], _m.cols[0]);
+  const SimdFloat4 xx_yy_0010 = OZZ_WASM_SWIZZLE_F(xx_yy, 0, 1, 0, 0);
+  const SimdFloat4 xx_yy_zz_xx = Select(mask_00f0, _m.cols[2], xx_yy_0010);
+  const SimdFloat4 yy_zz_xx_yy = OZZ_WASM_SWIZZLE_F(xx_yy_zz_xx, 1, 2, 0, 1);
+  const SimdFloat4 zz_xx_yy_zz = OZZ_WASM_SWIZZLE_F(xx_yy_zz_xx, 2, 0, 1, 2);
+
+  const SimdFloat4 diag_sum = xx_yy_zz_xx + yy_zz_xx_yy + zz_xx_yy_zz;
+  const SimdFloat4 diag_diff = xx_yy_zz_xx - yy_zz_xx_yy - zz_xx_yy_zz;
+  const SimdFloat4 radicand = Select(mask_000f, diag_sum, diag_diff) + one;
+  const SimdFloat4 invSqrt = RSqrtEst(radicand);
+
+  SimdFloat4 zy_xz_yx = Select(mask_00f0, _m.cols[1], _m.cols[0]);
+  zy_xz_yx = OZZ_WASM_SWIZZLE_F(zy_xz_yx, 2, 2, 1, 0);
+  zy_xz_yx = Select(mask_0f00, SplatX(_m.cols[2]), zy_xz_yx);
+  SimdFloat4 yz_zx_xy = Select(mask_f000, _m.cols[1], _m.cols[0]);
+  yz_zx_xy = OZZ_WASM_SWIZZLE_F(yz_zx_xy, 0, 2, 0, 0);
+  yz_zx_xy = Select(mask_f000, SplatY(_m.cols[2]), yz_zx_xy);
+  const SimdFloat4 sum = zy_xz_yx + yz_zx_xy;
+  const SimdFloat4 diff = zy_xz_yx - yz_zx_xy;
+  const SimdFloat4 scale = invSqrt * half;
+
+  const SimdFloat4 sum0 = OZZ_WASM_SWIZZLE_F(sum, 0, 2, 1, 0);
+  const SimdFloat4 sum1 = OZZ_WASM_SWIZZLE_F(sum, 2, 0, 0, 0);
+  const SimdFloat4 sum2 = OZZ_WASM_SWIZZLE_F(sum, 1, 0, 0, 0);
+  SimdFloat4 res0 = Select(mask_000f, SplatX(diff), sum0);
+  SimdFloat4 res1 = Select(mask_000f, SplatY(diff), sum1);
+  SimdFloat4 res2 = Select(mask_000f, SplatZ(diff), sum2);
+  res0 = Select(mask_f000, radicand, res0) * SplatX(scale);
+  res1 = Select(mask_0f00, radicand, res1) * SplatY(scale);
+  res2 = Select(mask_00f0, radicand, res2) * SplatZ(scale);
+  const SimdFloat4 res3 = Select(mask_000f, radicand, diff) * SplatW(scale);
+
+  const SimdFloat4 xx = SplatX(_m.cols[0]);
+  const SimdFloat4 yy = SplatY(_m.cols[1]);
+  const SimdFloat4 zz = SplatZ(_m.cols[2]);
+  const SimdInt4 cond0 = CmpGt(yy, xx);
+  const SimdInt4 cond1 = And(CmpGt(zz, xx), CmpGt(zz, yy));
+  const SimdInt4 cond2 = CmpGt(SplatX(diag_sum), zero);
+  SimdFloat4 res = Select(cond0, res1, res0);
+  res = Select(cond1, res2, res);
+  res = Select(cond2, res3, res);
+
+  assert(AreAllTrue1(IsNormalizedEst4(res)));
+  return res;
+}
+
+inline bool ToAffine(const Float4x4& _m, SimdFloat4* _translation,
+                     SimdFloat4* _quaternion, SimdFloat4* _scale) {
+  const SimdFloat4 zero = simd_float4::zero();
+  const SimdFloat4 one = simd_float4::one();
+  const SimdInt4 fff0 = simd_int4::mask_fff0();
+  const SimdFloat4 max = simd_float4::Load1(kOrthogonalisationToleranceSq);
+  const SimdFloat4 min = simd_float4::Load1(-kOrthogonalisationToleranceSq);
+
+  // Extracts translation.
+  *_translation = Select(fff0, _m.cols[3], one);
+
+  // Extracts scale.
+  SimdFloat4 m_rows[4];
+  Transpose4x4(_m.cols, m_rows);
+
+  const SimdFloat4 dot =
+      OZZ_MADD(m_rows[0], m_rows[0],
+               OZZ_MADD(m_rows[1], m_rows[1], m_rows[2] * m_rows[2]));
+  const SimdFloat4 abs_scale = Sqrt(dot);
+
+  const SimdInt4 zero_axis = And(CmpLt(dot, max), CmpGt(dot, min));
+
+  // Builds an orthonormal matrix in order to support quaternion extraction.
+  Float4x4 orthonormal;
+  const int mask = MoveMask(zero_axis);
+  if (mask & 1) {
+    if (mask & 6) {
+      return false;
+    }
+    orthonormal.cols[1] = _m.cols[1] / SplatY(abs_scale);
+    orthonormal.cols[0] = Normalize3(Cross3(orthonormal.cols[1], _m.cols[2]));
+    orthonormal.cols[2] =
+        Normalize3(Cross3(orthonormal.cols[0], orthonormal.cols[1]));
+  } else if (mask & 4) {
+    if (mask & 3) {
+      return false;
+    }
+    orthonormal.cols[0] = _m.cols[0] / SplatX(abs_scale);
+    orthonormal.cols[2] = Normalize3(Cross3(orthonormal.cols[0], _m.cols[1]));
+    orthonormal.cols[1] =
+        Normalize3(Cross3(orthonormal.cols[2], orthonormal.cols[0]));
+  } else {  // Favor z axis in the default case
+    if (mask & 5) {
+      return false;
+    }
+    orthonormal.cols[2] = _m.cols[2] / SplatZ(abs_scale);
+    orthonormal.cols[1] = Normalize3(Cross3(orthonormal.cols[2], _m.cols[0]));
+    orthonormal.cols[0] =
+        Normalize3(Cross3(orthonormal.cols[1], orthonormal.cols[2]));
+  }
+  orthonormal.cols[3] = simd_float4::w_axis();
+
+  // Get back scale signs in case of reflexions
+  SimdFloat4 o_rows[4];
+  Transpose4x4(orthonormal.cols, o_rows);
+
+  const SimdFloat4 scale_dot =
+      OZZ_MADD(o_rows[0], m_rows[0],
+               OZZ_MADD(o_rows[1], m_rows[1], o_rows[2] * m_rows[2]));
+
+  const SimdInt4 cond = CmpGt(scale_dot, zero);
+  const SimdFloat4 scale = Select(cond, abs_scale, -abs_scale);
+  *_scale = Select(fff0, scale, one);
+
+  // Extracts quaternion.
+  *_quaternion = ToQuaternion(orthonormal);
+  return true;
+}
+
+inline Float4x4 Float4x4::FromEuler(_SimdFloat4 _v) {
+  return Float4x4::FromAxisAngle(simd_float4::y_axis(), SplatX(_v)) *
+         Float4x4::FromAxisAngle(simd_float4::x_axis(), SplatY(_v)) *
+         Float4x4::FromAxisAngle(simd_float4::z_axis(), SplatZ(_v));
+}
+
+inline Float4x4 Float4x4::FromAxisAngle(_SimdFloat4 _axis, _SimdFloat4 _angle) {
+  assert(AreAllTrue1(IsNormalizedEst3(_axis)));
+
+  const SimdInt4 fff0 = simd_int4::mask_fff0();
+  const SimdFloat4 one = simd_float4::one();
+
+  const SimdFloat4 sin = SplatX(SinX(_angle));
+  const SimdFloat4 cos = SplatX(CosX(_angle));
+  const SimdFloat4 one_minus_cos = one - cos;
+
+  const SimdFloat4 v0 = one_minus_cos * OZZ_WASM_SWIZZLE_F(_axis, 1, 2, 0, 3) *
+                        OZZ_WASM_SWIZZLE_F(_axis, 2, 0, 1, 3);
+  const SimdFloat4 r0 = one_minus_cos * _axis * _axis + cos;
+  const SimdFloat4 r1 = sin * _axis + v0;
+  const SimdFloat4 r2 = v0 - sin * _axis;
+  const SimdFloat4 r0fff0 = And(r0, fff0);
+  const SimdFloat4 r1r22120 = internal::WasmShuffle<0, 2, 1, 2>(r1, r2);
+  const SimdFloat4 v1 = OZZ_WASM_SWIZZLE_F(r1r22120, 1, 2, 3, 0);
+  const SimdFloat4 r1r20011 = internal::WasmShuffle<1, 1, 0, 0>(r1, r2);
+  const SimdFloat4 v2 = OZZ_WASM_SWIZZLE_F(r1r20011, 0, 2, 0, 2);
+
+  const SimdFloat4 t0 = internal::WasmShuffle<0, 3, 0, 1>(r0fff0, v1);
+  const SimdFloat4 t1 = internal::WasmShuffle<1, 3, 2, 3>(r0fff0, v1);
+  const Float4x4 ret = {{OZZ_WASM_SWIZZLE_F(t0, 0, 2, 3, 1),
+                         OZZ_WASM_SWIZZLE_F(t1, 2, 0, 3, 1),
+                         internal::WasmShuffle<0, 1, 2, 3>(v2, r0fff0),
+                         simd_float4::w_axis()}};
+  return ret;
+}
+
+namespace internal {
+// Computes the 3 first columns of the rotation matrix of _quaternion, shared
+// by FromQuaternion and FromAffine.
+OZZ_INLINE void WasmQuaternionToColumns(_SimdFloat4 _quaternion,
+                                        SimdFloat4 _cols[3]) {
+  const SimdInt4 fff0 = simd_int4::mask_fff0();
+  const SimdFloat4 c1110 = simd_float4::Load(1.f, 1.f, 1.f, 0.f);
+
+  const SimdFloat4 vsum = _quaternion + _quaternion;
+  const SimdFloat4 vms = _quaternion * vsum;
+
+  const SimdFloat4 r0 = c1110 - And(OZZ_WASM_SWIZZLE_F(vms, 1, 0, 0, 3), fff0) -
+                        And(OZZ_WASM_SWIZZLE_F(vms, 2, 2, 1, 3), fff0);
+  const SimdFloat4 v0 = OZZ_WASM_SWIZZLE_F(_quaternion, 0, 0, 1, 3) *
+                        OZZ_WASM_SWIZZLE_F(vsum, 2, 1, 2, 3);
+  const SimdFloat4 v1 =
+      SplatW(_quaternion) * OZZ_WASM_SWIZZLE_F(vsum, 1, 2, 0, 3);
+
+  const SimdFloat4 r1 = v0 + v1;
+  const SimdFloat4 r2 = v0 - v1;
+
+  const SimdFloat4 r1r21021 = WasmShuffle<1, 2, 0, 1>(r1, r2);
+  const SimdFloat4 v2 = OZZ_WASM_SWIZZLE_F(r1r21021, 0, 2, 3, 1);
+  const SimdFloat4 r1r22200 = WasmShuffle<0, 0, 2, 2>(r1, r2);
+  const SimdFloat4 v3 = OZZ_WASM_SWIZZLE_F(r1r22200, 0, 2, 0, 2);
+
+  const SimdFloat4 q0 = WasmShuffle<0, 3, 0, 1>(r0, v2);
+  const SimdFloat4 q1 = WasmShuffle<1, 3, 2, 3>(r0, v2);
+  _cols[0] = OZZ_WASM_SWIZZLE_F(q0, 0, 2, 3, 1);
+  _cols[1] = OZZ_WASM_SWIZZLE_F(q1, 2, 0, 3, 1);
+  _cols[2] = WasmShuffle<0, 1, 2, 3>(v3, r0);
+}
+}  // namespace internal
+
+inline Float4x4 Float4x4::FromQuaternion(_SimdFloat4 _quaternion) {
+  assert(AreAllTrue1(IsNormalizedEst4(_quaternion)));
+
+  Float4x4 ret;
+  internal::WasmQuaternionToColumns(_quaternion, ret.cols);
+  ret.cols[3] = simd_float4::w_axis();
+  return ret;
+}
+
+inline Float4x4 Float4x4::FromAffine(_SimdFloat4 _translation,
+                                     _SimdFloat4 _quaternion,
+                                     _SimdFloat4 _scale) {
+  assert(AreAllTrue1(IsNormalizedEst4(_quaternion)));
+
+  SimdFloat4 cols[3];
+  internal::WasmQuaternionToColumns(_quaternion, cols);
+  const Float4x4 ret = {{cols[0] * SplatX(_scale), cols[1] * SplatY(_scale),
+                         cols[2] * SplatZ(_scale),
+                         SetW(_translation, simd_float4::one())}};
+  return ret;
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 TransformPoint(const ozz::math::Float4x4& _m,
+                                                ozz::math::_SimdFloat4 _v) {
+  const SimdFloat4 xxxx = SplatX(_v) * _m.cols[0];
+  const SimdFloat4 a23 = OZZ_MADD(SplatZ(_v), _m.cols[2], _m.cols[3]);
+  const SimdFloat4 a01 = OZZ_MADD(SplatY(_v), _m.cols[1], xxxx);
+  return a01 + a23;
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 TransformVector(const ozz::math::Float4x4& _m,
+                                                 ozz::math::_SimdFloat4 _v) {
+  const SimdFloat4 xxxx = SplatX(_v) * _m.cols[0];
+  const SimdFloat4 zzzz = SplatY(_v) * _m.cols[1];
+  const SimdFloat4 a21 = OZZ_MADD(SplatZ(_v), _m.cols[2], xxxx);
+  return zzzz + a21;
+}
+
+OZZ_INLINE ozz::math::SimdFloat4 operator*(const ozz::math::Float4x4& _m,
+                                           ozz::math::_SimdFloat4 _v) {
+  const SimdFloat4 xxxx = SplatX(_v) * _m.cols[0];
+  const SimdFloat4 zzzz = SplatZ(_v) * _m.cols[2];
+  const SimdFloat4 a01 = OZZ_MADD(SplatY(_v), _m.cols[1], xxxx);
+  const SimdFloat4 a23 = OZZ_MADD(SplatW(_v), _m.cols[3], zzzz);
+  return a01 + a23;
+}
+
+inline ozz::math::Float4x4 operator*(const ozz::math::Float4x4& _a,
+                                     const ozz::math::Float4x4& _b) {
+  const ozz::math::Float4x4 ret = {{_a * _b.cols[0], _a * _b.cols[1],
+                                    _a * _b.cols[2], _a * _b.cols[3]}};
+  return ret;
+}
+
+OZZ_INLINE ozz::math::Float4x4 operator+(const ozz::math::Float4x4& _a,
+                                         const ozz::math::Float4x4& _b) {
+  const ozz::math::Float4x4 ret = {
+      {_a.cols[0] + _b.cols[0], _a.cols[1] + _b.cols[1],
+       _a.cols[2] + _b.cols[2], _a.cols[3] + _b.cols[3]}};
+  return ret;
+}
+
+OZZ_INLINE ozz::math::Float4x4 operator-(const ozz::math::Float4x4& _a,
+                                         const ozz::math::Float4x4& _b) {
+  const ozz::math::Float4x4 ret = {
+      {_a.cols[0] - _b.cols[0], _a.cols[1] - _b.cols[1],
+       _a.cols[2] - _b.cols[2], _a.cols[3] - _b.cols[3]}};
+  return ret;
+}
+
+OZZ_INLINE uint16_t FloatToHalf(float _f) {
+  const int h = GetX(FloatToHalf(simd_float4::Load1(_f)));
+  return static_cast<uint16_t>(h);
+}
+
+OZZ_INLINE float HalfToFloat(uint16_t _h) {
+  return GetX(HalfToFloat(simd_int4::Load1(static_cast<int>(_h))));
+}
+
+// Half <-> Float implementation is based on:
+// http://fgiesen.wordpress.com/2012/03/28/half-to-float-done-quic/.
+inline SimdInt4 FloatToHalf(_SimdFloat4 _f) {
+  const v128_t mask_sign = wasm_i32x4_splat(0x80000000);
+  const v128_t mask_round = wasm_i32x4_splat(~0xfff);
+  const v128_t f32infty = wasm_i32x4_splat(255 << 23);
+  const v128_t magic = wasm_i32x4_splat(15 << 23);
+  const v128_t nanbit = wasm_i32x4_splat(0x200);
+  const v128_t infty_as_fp16 = wasm_i32x4_splat(0x7c00);
+  const v128_t clamp = wasm_i32x4_splat((31 << 23) - 0x1000);
+
+  const v128_t f = OZZ_WASM_I(_f);
+  const v128_t justsign = wasm_v128_and(mask_sign, f);
+  const v128_t absf = wasm_v128_xor(f, justsign);
+  const v128_t b_isnan = wasm_i32x4_gt(absf, f32infty);
+  const v128_t b_isnormal = wasm_i32x4_gt(f32infty, absf);
+  const v128_t inf_or_nan =
+      wasm_v128_or(wasm_v128_and(b_isnan, nanbit), infty_as_fp16);
+  const v128_t fnosticky = wasm_v128_and(absf, mask_round);
+  const v128_t scaled = wasm_f32x4_mul(fnosticky, magic);
+  // Logically, we want a signed integer min on "biased", but this should gen
+  // better code.
+  const v128_t clamped = wasm_f32x4_pmin(scaled, clamp);
+  const v128_t biased = wasm_i32x4_sub(clamped, mask_round);
+  const v128_t shifted = wasm_u32x4_shr(biased, 13);
+  const v128_t normal = wasm_v128_and(shifted, b_isnormal);
+  const v128_t not_normal = wasm_v128_andnot(inf_or_nan, b_isnormal);
+  const v128_t joined = wasm_v128_or(normal, not_normal);
+
+  const v128_t sign_shift = wasm_u32x4_shr(justsign, 16);
+  return wasm_v128_or(joined, sign_shift);
+}
+
+OZZ_INLINE SimdFloat4 HalfToFloat(_SimdInt4 _h) {
+  const v128_t mask_nosign = wasm_i32x4_splat(0x7fff);
+  const v128_t magic = wasm_i32x4_splat((254 - 15) << 23);
+  const v128_t was_infnan = wasm_i32x4_splat(0x7bff);
+  const v128_t exp_infnan = wasm_i32x4_splat(255 << 23);
+
+  const v128_t expmant = wasm_v128_and(mask_nosign, _h);
+  const v128_t shifted = wasm_i32x4_shl(expmant, 13);
+  const v128_t scaled = wasm_f32x4_mul(shifted, magic);
+  const v128_t b_wasinfnan = wasm_i32x4_gt(expmant, was_infnan);
+  const v128_t sign = wasm_i32x4_shl(wasm_v128_xor(_h, expmant), 16);
+  const v128_t infnanexp = wasm_v128_and(b_wasinfnan, exp_infnan);
+  const v128_t sign_inf = wasm_v128_or(sign, infnanexp);
+  return OZZ_WASM_F(wasm_v128_or(scaled, sign_inf));
+}
+}  // namespace math
+}  // namespace ozz
+
+#undef OZZ_WASM_I
+#undef OZZ_WASM_F
+#undef OZZ_WASM_SPLAT_F
+#undef OZZ_WASM_SPLAT_I
+#undef OZZ_WASM_SWIZZLE_F
+#undef OZZ_WASM_MOVE_X_F
+#undef OZZ_WASM_MOVE_X_I
+#undef OZZ_WASM_ZIP1_F
+#undef OZZ_WASM_ZIP2_F
+#undef OZZ_WASM_LOW_F
+#undef OZZ_WASM_HIGH_F
+#undef OZZ_WASM_HADD2_F
+#undef OZZ_WASM_HADD3_F
+#undef OZZ_WASM_HADD4_F
+#undef OZZ_MADD
+#undef OZZ_MSUB
+#undef OZZ_NMADD
+#undef OZZ_NMSUB
+#undef OZZ_WASM_SELECT_F
+#endif  // OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH_WASM_INL_H_
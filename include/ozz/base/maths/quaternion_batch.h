@@ -0,0 +1,96 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MATHS_QUATERNION_BATCH_H_
+#define OZZ_OZZ_BASE_MATHS_QUATERNION_BATCH_H_
+
+#include "ozz/base/maths/simd_quaternion.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+
+// Batch quaternion functions, processing whole spans of quaternions at once.
+// They're meant for systems that process many rotations (spring bones, aim
+// offsets, retargeting...), which would otherwise loop over per-value
+// functions.
+// SoA variants process 4 quaternions per SoaQuaternion element. SimdQuaternion
+// (AoS) variants are transposed to SoA by groups of 4, so they don't suffer
+// from AoS horizontal operations (dot products...).
+// All functions return false if an output span is smaller than the input
+// ones, in which case output isn't modified. Outputs can alias inputs.
+// Binary functions process as many elements as the smallest input span.
+namespace ozz {
+namespace math {
+
+// Normalizes all quaternions of _input to _output.
+OZZ_BASE_DLL bool Normalize(span<const SoaQuaternion> _input,
+                            span<SoaQuaternion> _output);
+OZZ_BASE_DLL bool Normalize(span<const SimdQuaternion> _input,
+                            span<SimdQuaternion> _output);
+
+// Computes normalized linear interpolations of _a and _b quaternions, with
+// coefficient _f. As for the per-value NLerp, _a and _b quaternions must be
+// in the same hemisphere.
+OZZ_BASE_DLL bool NLerp(span<const SoaQuaternion> _a,
+                        span<const SoaQuaternion> _b, float _f,
+                        span<SoaQuaternion> _output);
+OZZ_BASE_DLL bool NLerp(span<const SimdQuaternion> _a,
+                        span<const SimdQuaternion> _b, float _f,
+                        span<SimdQuaternion> _output);
+
+// Computes spherical linear interpolations of normalized _a and _b
+// quaternions, with coefficient _f. Interpolation takes the shortest path.
+// Sines and arc cosines are replaced by a polynomial approximation (David
+// Eberly, "A fast and accurate algorithm for computing SLERP"), which is
+// branchless and precise to 1e-5.
+OZZ_BASE_DLL bool SLerp(span<const SoaQuaternion> _a,
+                        span<const SoaQuaternion> _b, float _f,
+                        span<SoaQuaternion> _output);
+OZZ_BASE_DLL bool SLerp(span<const SimdQuaternion> _a,
+                        span<const SimdQuaternion> _b, float _f,
+                        span<SimdQuaternion> _output);
+
+// Multiplies _a quaternions by _b quaternions.
+OZZ_BASE_DLL bool Multiply(span<const SoaQuaternion> _a,
+                           span<const SoaQuaternion> _b,
+                           span<SoaQuaternion> _output);
+OZZ_BASE_DLL bool Multiply(span<const SimdQuaternion> _a,
+                           span<const SimdQuaternion> _b,
+                           span<SimdQuaternion> _output);
+
+// Transforms _v vectors by _q quaternions. w component of SimdFloat4 outputs
+// is undefined.
+OZZ_BASE_DLL bool TransformVector(span<const SoaQuaternion> _q,
+                                  span<const SoaFloat3> _v,
+                                  span<SoaFloat3> _output);
+OZZ_BASE_DLL bool TransformVector(span<const SimdQuaternion> _q,
+                                  span<const SimdFloat4> _v,
+                                  span<SimdFloat4> _output);
+}  // namespace math
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MATHS_QUATERNION_BATCH_H_
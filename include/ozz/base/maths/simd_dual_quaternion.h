@@ -0,0 +1,129 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SIMD_DUAL_QUATERNION_H_
+#define OZZ_OZZ_BASE_MATHS_SIMD_DUAL_QUATERNION_H_
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/simd_quaternion.h"
+
+namespace ozz {
+namespace math {
+
+// Declares the dual quaternion type, which represents a rigid transformation
+// (rotation and translation, no scale) with 8 floats, half of a Float4x4.
+// real is the rotation quaternion, dual is .5 * translation * real, translation
+// being considered as a pure quaternion (x, y, z, 0).
+// Dual quaternions can be linearly blended (and normalized) without the
+// volume loss artifacts of matrices linear blending, which makes them a good
+// fit for skinning.
+struct DualQuaternion {
+  SimdQuaternion real;
+  SimdQuaternion dual;
+
+  // Returns the identity dual quaternion.
+  static OZZ_INLINE DualQuaternion identity() {
+    const DualQuaternion ret = {SimdQuaternion::identity(),
+                                {simd_float4::zero()}};
+    return ret;
+  }
+
+  // Returns the dual quaternion built from a translation and a normalized
+  // rotation quaternion. w component of _translation is ignored.
+  static OZZ_INLINE DualQuaternion FromAffine(_SimdFloat4 _translation,
+                                              const SimdQuaternion& _rotation);
+
+  // Returns the dual quaternion built from matrix _m. The upper 3x3 part of _m
+  // must be normalized and orthogonal, as scale isn't supported.
+  static OZZ_INLINE DualQuaternion FromFloat4x4(const Float4x4& _m);
+};
+
+OZZ_INLINE DualQuaternion
+DualQuaternion::FromAffine(_SimdFloat4 _translation,
+                           const SimdQuaternion& _rotation) {
+  const SimdQuaternion t = {And(_translation, simd_int4::mask_fff0())};
+  const SimdQuaternion dual = t * _rotation;
+  const DualQuaternion ret = {
+      _rotation, {dual.xyzw * simd_float4::Load1(.5f)}};
+  return ret;
+}
+
+OZZ_INLINE DualQuaternion DualQuaternion::FromFloat4x4(const Float4x4& _m) {
+  const SimdQuaternion rotation = {ToQuaternion(_m)};
+  return FromAffine(_m.cols[3], rotation);
+}
+
+// Returns the translation part of normalized dual quaternion _dq, computed as
+// 2 * dual * conjugate(real). w component of the result is undefined.
+OZZ_INLINE SimdFloat4 GetTranslation(const DualQuaternion& _dq) {
+  const SimdQuaternion t = _dq.dual * Conjugate(_dq.real);
+  return t.xyzw + t.xyzw;
+}
+
+// Returns the normalized dual quaternion _dq. Both parts are scaled by the
+// inverse norm of the real part, which is the normalization needed after
+// linearly blending unit dual quaternions.
+OZZ_INLINE DualQuaternion Normalize(const DualQuaternion& _dq) {
+  const SimdFloat4 inv_len =
+      simd_float4::one() / SplatX(Length4(_dq.real.xyzw));
+  const DualQuaternion ret = {{_dq.real.xyzw * inv_len},
+                              {_dq.dual.xyzw * inv_len}};
+  return ret;
+}
+
+// Computes the per element addition of two dual quaternions _a and _b.
+OZZ_INLINE DualQuaternion operator+(const DualQuaternion& _a,
+                                    const DualQuaternion& _b) {
+  const DualQuaternion ret = {{_a.real.xyzw + _b.real.xyzw},
+                              {_a.dual.xyzw + _b.dual.xyzw}};
+  return ret;
+}
+
+// Multiplies every element of _dq with the corresponding component of _v. With
+// a splatted _v, this scales the whole dual quaternion, as required to weight
+// dual quaternions before blending them.
+OZZ_INLINE DualQuaternion operator*(const DualQuaternion& _dq, _SimdFloat4 _v) {
+  const DualQuaternion ret = {{_dq.real.xyzw * _v}, {_dq.dual.xyzw * _v}};
+  return ret;
+}
+
+// Computes the transformation of normalized dual quaternion _dq and a point
+// _p. w component of the result is undefined.
+OZZ_INLINE SimdFloat4 TransformPoint(const DualQuaternion& _dq,
+                                     _SimdFloat4 _p) {
+  return TransformVector(_dq.real, _p) + GetTranslation(_dq);
+}
+
+// Computes the transformation of normalized dual quaternion _dq and a vector
+// _v. Only the rotation applies. w component of the result is undefined.
+OZZ_INLINE SimdFloat4 TransformVector(const DualQuaternion& _dq,
+                                      _SimdFloat4 _v) {
+  return TransformVector(_dq.real, _v);
+}
+}  // namespace math
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MATHS_SIMD_DUAL_QUATERNION_H_
@@ -0,0 +1,125 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SIMD_FLOAT3X4_H_
+#define OZZ_OZZ_BASE_MATHS_SIMD_FLOAT3X4_H_
+
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+namespace math {
+
+// Declares the affine 3x4 matrix type. As opposed to Float4x4, matrix is
+// stored by rows, the last row being implicitly (0, 0, 0, 1):
+// [ m.rows[0].x m.rows[0].y m.rows[0].z m.rows[0].w ]   {v.x}
+// | m.rows[1].x m.rows[1].y m.rows[1].z m.rows[1].w | * {v.y}
+// | m.rows[2].x m.rows[2].y m.rows[2].z m.rows[2].w |   {v.z}
+// [ 0           0           0           1           ]   {v.1}
+// This saves 25% of the memory (and bandwidth) used by a Float4x4 to store an
+// affine transformation, and matches the row major float3x4 layout commonly
+// used by GPU constant buffers.
+struct Float3x4 {
+  // Matrix rows.
+  SimdFloat4 rows[3];
+
+  // Returns the identity matrix.
+  static OZZ_INLINE Float3x4 identity() {
+    const Float3x4 ret = {
+        {simd_float4::x_axis(), simd_float4::y_axis(), simd_float4::z_axis()}};
+    return ret;
+  }
+
+  // Returns the affine matrix built from the 3 first rows of _m. The last row
+  // of _m is ignored, _m is expected to be affine.
+  static OZZ_INLINE Float3x4 FromFloat4x4(const Float4x4& _m) {
+    SimdFloat4 rows[4];
+    Transpose4x4(_m.cols, rows);
+    const Float3x4 ret = {{rows[0], rows[1], rows[2]}};
+    return ret;
+  }
+};
+
+// Returns the Float4x4 matrix equivalent to _m, with (0, 0, 0, 1) last row.
+OZZ_INLINE Float4x4 ToFloat4x4(const Float3x4& _m) {
+  Float4x4 ret;
+  Transpose3x4(_m.rows, ret.cols);
+  ret.cols[3] = SetW(ret.cols[3], simd_float4::one());
+  return ret;
+}
+
+// Computes the transformation of a Float3x4 matrix and a point _p.
+// This is equivalent to multiplying a matrix by a SimdFloat4 with a w component
+// of 1. w component of the result is undefined.
+OZZ_INLINE SimdFloat4 TransformPoint(const Float3x4& _m, _SimdFloat4 _v) {
+  SimdFloat4 cols[4];
+  Transpose3x4(_m.rows, cols);
+  const SimdFloat4 a01 = MAdd(SplatY(_v), cols[1], SplatX(_v) * cols[0]);
+  const SimdFloat4 a23 = MAdd(SplatZ(_v), cols[2], cols[3]);
+  return a01 + a23;
+}
+
+// Computes the transformation of a Float3x4 matrix and a vector _v.
+// This is equivalent to multiplying a matrix by a SimdFloat4 with a w component
+// of 0. w component of the result is undefined.
+OZZ_INLINE SimdFloat4 TransformVector(const Float3x4& _m, _SimdFloat4 _v) {
+  SimdFloat4 cols[4];
+  Transpose3x4(_m.rows, cols);
+  const SimdFloat4 a01 = MAdd(SplatY(_v), cols[1], SplatX(_v) * cols[0]);
+  return MAdd(SplatZ(_v), cols[2], a01);
+}
+
+// Computes the multiplication of two affine matrices _a and _b.
+OZZ_INLINE Float3x4 operator*(const Float3x4& _a, const Float3x4& _b) {
+  const SimdInt4 mask_w = simd_int4::mask_000f();
+  Float3x4 ret;
+  for (int r = 0; r < 3; ++r) {
+    const SimdFloat4 row = _a.rows[r];
+    const SimdFloat4 a01 =
+        MAdd(SplatY(row), _b.rows[1], SplatX(row) * _b.rows[0]);
+    const SimdFloat4 a23 = MAdd(SplatZ(row), _b.rows[2], And(row, mask_w));
+    ret.rows[r] = a01 + a23;
+  }
+  return ret;
+}
+
+// Computes the per element addition of two matrices _a and _b.
+OZZ_INLINE Float3x4 operator+(const Float3x4& _a, const Float3x4& _b) {
+  const Float3x4 ret = {{_a.rows[0] + _b.rows[0], _a.rows[1] + _b.rows[1],
+                         _a.rows[2] + _b.rows[2]}};
+  return ret;
+}
+
+// Multiplies every element of _m with the corresponding component of _v, rows
+// being considered as vectors. With a splatted _v, this scales the whole
+// matrix, as required to weight matrices before blending them.
+OZZ_INLINE Float3x4 RowMultiply(const Float3x4& _m, _SimdFloat4 _v) {
+  const Float3x4 ret = {{_m.rows[0] * _v, _m.rows[1] * _v, _m.rows[2] * _v}};
+  return ret;
+}
+}  // namespace math
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MATHS_SIMD_FLOAT3X4_H_
@@ -37,6 +37,20 @@ namespace math {
 // Returns SIMDimplementation name has decided at library build time.
 OZZ_BASE_DLL const char* SimdImplementationName();
 
+// Host cpu SIMD instruction sets that can be detected at runtime.
+enum SimdHostFeature {
+  kSimdHostAvx,
+  kSimdHostAvx2,
+  kSimdHostFma,
+  kSimdHostFeatureCount,
+};
+
+// Tells if host cpu supports _feature instruction set. Detection is done once,
+// on first call. Runtime jobs use it to select code paths wider than the SIMD
+// implementation chosen at library build time (see SimdImplementationName()),
+// so that a single binary benefits from host capabilities.
+OZZ_BASE_DLL bool SimdHostSupports(SimdHostFeature _feature);
+
 namespace simd_float4 {
 // Returns a SimdFloat4 vector with all components set to 0.
 OZZ_INLINE SimdFloat4 zero();
@@ -216,6 +230,24 @@ OZZ_INLINE void Store2PtrU(_SimdFloat4 _v, float* _f);
 // _f[2] = _v.z
 OZZ_INLINE void Store3PtrU(_SimdFloat4 _v, float* _f);
 
+// Stores the 4 components of _v to the four first floats of _f, with a
+// non-temporal hint: the write bypasses caches, which suits write-combined
+// memory (ie: GPU upload buffers) written once and never read back.
+// _f must be aligned to 16 bytes. See StreamFence() for ordering.
+OZZ_INLINE void StreamPtr(_SimdFloat4 _v, float* _f);
+
+// Stores x, y and z components of _v to the three first floats of _f, with a
+// non-temporal hint, see StreamPtr().
+// _f must be aligned to 4 bytes.
+OZZ_INLINE void Stream3PtrU(_SimdFloat4 _v, float* _f);
+
+// Non-temporal stores are weakly ordered. This fence orders all the
+// non-temporal stores issued by the calling thread before any later store,
+// so it must be called once streaming is done, before signaling another
+// thread or the GPU that data are ready. Does nothing on platforms without
+// non-temporal stores, where Stream* functions are regular stores.
+OZZ_INLINE void StreamFence();
+
 // Replicates x of _a to all the components of the returned vector.
 OZZ_INLINE SimdFloat4 SplatX(_SimdFloat4 _v);
 
@@ -1218,6 +1250,10 @@ OZZ_INLINE SimdFloat4 HalfToFloat(_SimdInt4 _h);
 
 #if defined(OZZ_SIMD_SSEx)
 #include "ozz/base/maths/internal/simd_math_sse-inl.h"
+#elif defined(OZZ_SIMD_NEON)
+#include "ozz/base/maths/internal/simd_math_neon-inl.h"
+#elif defined(OZZ_SIMD_WASM)
+#include "ozz/base/maths/internal/simd_math_wasm-inl.h"
 #elif defined(OZZ_SIMD_REF)
 #include "ozz/base/maths/internal/simd_math_ref-inl.h"
 #else
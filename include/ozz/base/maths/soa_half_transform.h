@@ -0,0 +1,97 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SOA_HALF_TRANSFORM_H_
+#define OZZ_OZZ_BASE_MATHS_SOA_HALF_TRANSFORM_H_
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+
+// Stores a SoaTransform with half precision floats, using half the memory of
+// a SoaTransform (80 bytes instead of 160). It's meant for intermediate poses,
+// like blending layers, that are written and read once per frame. Each array
+// stores the 4 SoA values of a component, ie: translation[0] is x of the 4
+// joints.
+// Half floats have a 11 bits mantissa, so the relative error is about 5e-4.
+struct SoaHalfTransform {
+  uint16_t translation[3][4];
+  uint16_t rotation[4][4];
+  uint16_t scale[3][4];
+};
+
+namespace internal {
+OZZ_INLINE void PackHalf4(_SimdFloat4 _f, uint16_t _h[4]) {
+  int h[4];
+  StorePtrU(FloatToHalf(_f), h);
+  _h[0] = static_cast<uint16_t>(h[0]);
+  _h[1] = static_cast<uint16_t>(h[1]);
+  _h[2] = static_cast<uint16_t>(h[2]);
+  _h[3] = static_cast<uint16_t>(h[3]);
+}
+
+OZZ_INLINE SimdFloat4 UnpackHalf4(const uint16_t _h[4]) {
+  return HalfToFloat(simd_int4::Load(_h[0], _h[1], _h[2], _h[3]));
+}
+}  // namespace internal
+
+// Converts _transform to half precision _half. Conversions use F16C
+// instructions when available (see OZZ_SIMD_F16C).
+OZZ_INLINE void PackHalf(const SoaTransform& _transform,
+                         SoaHalfTransform* _half) {
+  internal::PackHalf4(_transform.translation.x, _half->translation[0]);
+  internal::PackHalf4(_transform.translation.y, _half->translation[1]);
+  internal::PackHalf4(_transform.translation.z, _half->translation[2]);
+  internal::PackHalf4(_transform.rotation.x, _half->rotation[0]);
+  internal::PackHalf4(_transform.rotation.y, _half->rotation[1]);
+  internal::PackHalf4(_transform.rotation.z, _half->rotation[2]);
+  internal::PackHalf4(_transform.rotation.w, _half->rotation[3]);
+  internal::PackHalf4(_transform.scale.x, _half->scale[0]);
+  internal::PackHalf4(_transform.scale.y, _half->scale[1]);
+  internal::PackHalf4(_transform.scale.z, _half->scale[2]);
+}
+
+// Converts half precision _half back to _transform.
+OZZ_INLINE void UnpackHalf(const SoaHalfTransform& _half,
+                           SoaTransform* _transform) {
+  _transform->translation.x = internal::UnpackHalf4(_half.translation[0]);
+  _transform->translation.y = internal::UnpackHalf4(_half.translation[1]);
+  _transform->translation.z = internal::UnpackHalf4(_half.translation[2]);
+  _transform->rotation.x = internal::UnpackHalf4(_half.rotation[0]);
+  _transform->rotation.y = internal::UnpackHalf4(_half.rotation[1]);
+  _transform->rotation.z = internal::UnpackHalf4(_half.rotation[2]);
+  _transform->rotation.w = internal::UnpackHalf4(_half.rotation[3]);
+  _transform->scale.x = internal::UnpackHalf4(_half.scale[0]);
+  _transform->scale.y = internal::UnpackHalf4(_half.scale[1]);
+  _transform->scale.z = internal::UnpackHalf4(_half.scale[2]);
+}
+}  // namespace math
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MATHS_SOA_HALF_TRANSFORM_H_
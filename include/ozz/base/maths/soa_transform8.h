@@ -0,0 +1,370 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SOA_TRANSFORM8_H_
+#define OZZ_OZZ_BASE_MATHS_SOA_TRANSFORM8_H_
+
+// 8 wide SoA math types, processing 8 joints per instruction stream. They're
+// backed by native AVX vectors when AVX is enabled for the whole build (see
+// OZZ_SIMD_AVX), and by pairs of 4 wide SIMD vectors otherwise, so that they
+// can be used on any target.
+// Both implementations share the same memory layout (8 contiguous floats per
+// component), and the same operations order as 4 wide SoA types. Converting a
+// pair of 4 wide SoA values to an 8 wide one, processing it and converting it
+// back gives the same results as processing each 4 wide value.
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math {
+
+// 8 wide float vector.
+struct SimdFloat8 {
+#if defined(OZZ_SIMD_AVX)
+  __m256 v;
+#else   // OZZ_SIMD_AVX
+  SimdFloat4 lo, hi;
+#endif  // OZZ_SIMD_AVX
+
+  // Packs 4 wide vectors _lo and _hi, _lo being the 4 first floats.
+  static OZZ_INLINE SimdFloat8 Load(_SimdFloat4 _lo, _SimdFloat4 _hi) {
+#if defined(OZZ_SIMD_AVX)
+    const SimdFloat8 r = {
+        _mm256_insertf128_ps(_mm256_castps128_ps256(_lo), _hi, 1)};
+#else   // OZZ_SIMD_AVX
+    const SimdFloat8 r = {_lo, _hi};
+#endif  // OZZ_SIMD_AVX
+    return r;
+  }
+
+  static OZZ_INLINE SimdFloat8 Load1(float _f) {
+#if defined(OZZ_SIMD_AVX)
+    const SimdFloat8 r = {_mm256_set1_ps(_f)};
+#else   // OZZ_SIMD_AVX
+    const SimdFloat4 f = simd_float4::Load1(_f);
+    const SimdFloat8 r = {f, f};
+#endif  // OZZ_SIMD_AVX
+    return r;
+  }
+
+  static OZZ_INLINE SimdFloat8 zero() { return Load1(0.f); }
+
+  static OZZ_INLINE SimdFloat8 one() { return Load1(1.f); }
+
+  // Returns the 4 first floats.
+  OZZ_INLINE SimdFloat4 low() const {
+#if defined(OZZ_SIMD_AVX)
+    return _mm256_castps256_ps128(v);
+#else   // OZZ_SIMD_AVX
+    return lo;
+#endif  // OZZ_SIMD_AVX
+  }
+
+  // Returns the 4 last floats.
+  OZZ_INLINE SimdFloat4 high() const {
+#if defined(OZZ_SIMD_AVX)
+    return _mm256_extractf128_ps(v, 1);
+#else   // OZZ_SIMD_AVX
+    return hi;
+#endif  // OZZ_SIMD_AVX
+  }
+};
+
+struct SoaFloat3x8 {
+  SimdFloat8 x, y, z;
+
+  // Packs 4 wide SoA values _lo and _hi.
+  static OZZ_INLINE SoaFloat3x8 Load(const SoaFloat3& _lo,
+                                     const SoaFloat3& _hi) {
+    const SoaFloat3x8 r = {SimdFloat8::Load(_lo.x, _hi.x),
+                           SimdFloat8::Load(_lo.y, _hi.y),
+                           SimdFloat8::Load(_lo.z, _hi.z)};
+    return r;
+  }
+
+  static OZZ_INLINE SoaFloat3x8 zero() {
+    const SimdFloat8 zero = SimdFloat8::zero();
+    const SoaFloat3x8 r = {zero, zero, zero};
+    return r;
+  }
+
+  static OZZ_INLINE SoaFloat3x8 one() {
+    const SimdFloat8 one = SimdFloat8::one();
+    const SoaFloat3x8 r = {one, one, one};
+    return r;
+  }
+
+  // Returns the 4 first SoA values.
+  OZZ_INLINE SoaFloat3 low() const {
+    const SoaFloat3 r = {x.low(), y.low(), z.low()};
+    return r;
+  }
+
+  // Returns the 4 last SoA values.
+  OZZ_INLINE SoaFloat3 high() const {
+    const SoaFloat3 r = {x.high(), y.high(), z.high()};
+    return r;
+  }
+};
+
+struct SoaQuaternion8 {
+  SimdFloat8 x, y, z, w;
+
+  // Packs 4 wide SoA values _lo and _hi.
+  static OZZ_INLINE SoaQuaternion8 Load(const SoaQuaternion& _lo,
+                                        const SoaQuaternion& _hi) {
+    const SoaQuaternion8 r = {
+        SimdFloat8::Load(_lo.x, _hi.x), SimdFloat8::Load(_lo.y, _hi.y),
+        SimdFloat8::Load(_lo.z, _hi.z), SimdFloat8::Load(_lo.w, _hi.w)};
+    return r;
+  }
+
+  static OZZ_INLINE SoaQuaternion8 identity() {
+    const SimdFloat8 zero = SimdFloat8::zero();
+    const SoaQuaternion8 r = {zero, zero, zero, SimdFloat8::one()};
+    return r;
+  }
+
+  // Returns the 4 first SoA values.
+  OZZ_INLINE SoaQuaternion low() const {
+    const SoaQuaternion r = {x.low(), y.low(), z.low(), w.low()};
+    return r;
+  }
+
+  // Returns the 4 last SoA values.
+  OZZ_INLINE SoaQuaternion high() const {
+    const SoaQuaternion r = {x.high(), y.high(), z.high(), w.high()};
+    return r;
+  }
+};
+
+// Stores 8 affine transformations with separate translation, rotation and
+// scale attributes.
+struct SoaTransform8 {
+  SoaFloat3x8 translation;
+  SoaQuaternion8 rotation;
+  SoaFloat3x8 scale;
+
+  // Packs 4 wide SoA transforms _lo and _hi, for example 2 consecutive SoA
+  // joints of a pose.
+  static OZZ_INLINE SoaTransform8 Load(const SoaTransform& _lo,
+                                       const SoaTransform& _hi) {
+    const SoaTransform8 r = {
+        SoaFloat3x8::Load(_lo.translation, _hi.translation),
+        SoaQuaternion8::Load(_lo.rotation, _hi.rotation),
+        SoaFloat3x8::Load(_lo.scale, _hi.scale)};
+    return r;
+  }
+
+  static OZZ_INLINE SoaTransform8 identity() {
+    const SoaTransform8 r = {SoaFloat3x8::zero(), SoaQuaternion8::identity(),
+                             SoaFloat3x8::one()};
+    return r;
+  }
+
+  // Returns the 4 first SoA transforms.
+  OZZ_INLINE SoaTransform low() const {
+    const SoaTransform r = {translation.low(), rotation.low(), scale.low()};
+    return r;
+  }
+
+  // Returns the 4 last SoA transforms.
+  OZZ_INLINE SoaTransform high() const {
+    const SoaTransform r = {translation.high(), rotation.high(), scale.high()};
+    return r;
+  }
+};
+
+// Implements SimdFloat8 binary operator _op, using AVX intrinsic _avx or 4 wide
+// operator otherwise.
+#if defined(OZZ_SIMD_AVX)
+#define OZZ_SIMD_FLOAT8_OPERATOR(_op, _avx)                                    \
+  OZZ_INLINE SimdFloat8 operator _op(const SimdFloat8& _a,                     \
+                                     const SimdFloat8& _b) {                   \
+    const SimdFloat8 r = {_avx(_a.v, _b.v)};                                   \
+    return r;                                                                  \
+  }
+#else  // OZZ_SIMD_AVX
+#define OZZ_SIMD_FLOAT8_OPERATOR(_op, _avx)                                    \
+  OZZ_INLINE SimdFloat8 operator _op(const SimdFloat8& _a,                     \
+                                     const SimdFloat8& _b) {                   \
+    const SimdFloat8 r = {_a.lo _op _b.lo, _a.hi _op _b.hi};                   \
+    return r;                                                                  \
+  }
+#endif  // OZZ_SIMD_AVX
+OZZ_SIMD_FLOAT8_OPERATOR(+, _mm256_add_ps)
+OZZ_SIMD_FLOAT8_OPERATOR(-, _mm256_sub_ps)
+OZZ_SIMD_FLOAT8_OPERATOR(*, _mm256_mul_ps)
+OZZ_SIMD_FLOAT8_OPERATOR(/, _mm256_div_ps)
+#undef OZZ_SIMD_FLOAT8_OPERATOR
+
+// Returns the per element negation of _v.
+OZZ_INLINE SimdFloat8 operator-(const SimdFloat8& _v) {
+#if defined(OZZ_SIMD_AVX)
+  const SimdFloat8 r = {_mm256_sub_ps(_mm256_setzero_ps(), _v.v)};
+#else   // OZZ_SIMD_AVX
+  const SimdFloat8 r = {-_v.lo, -_v.hi};
+#endif  // OZZ_SIMD_AVX
+  return r;
+}
+
+// Returns the addition of _a and _b.
+OZZ_INLINE SoaFloat3x8 operator+(const SoaFloat3x8& _a, const SoaFloat3x8& _b) {
+  const SoaFloat3x8 r = {_a.x + _b.x, _a.y + _b.y, _a.z + _b.z};
+  return r;
+}
+
+// Returns the subtraction of _b from _a.
+OZZ_INLINE SoaFloat3x8 operator-(const SoaFloat3x8& _a, const SoaFloat3x8& _b) {
+  const SoaFloat3x8 r = {_a.x - _b.x, _a.y - _b.y, _a.z - _b.z};
+  return r;
+}
+
+// Returns the per element multiplication of _a and _b.
+OZZ_INLINE SoaFloat3x8 operator*(const SoaFloat3x8& _a, const SoaFloat3x8& _b) {
+  const SoaFloat3x8 r = {_a.x * _b.x, _a.y * _b.y, _a.z * _b.z};
+  return r;
+}
+
+// Returns the multiplication of _a and scalar value _f.
+OZZ_INLINE SoaFloat3x8 operator*(const SoaFloat3x8& _a, const SimdFloat8& _f) {
+  const SoaFloat3x8 r = {_a.x * _f, _a.y * _f, _a.z * _f};
+  return r;
+}
+
+// Returns the addition of _a and _b.
+OZZ_INLINE SoaQuaternion8 operator+(const SoaQuaternion8& _a,
+                                    const SoaQuaternion8& _b) {
+  const SoaQuaternion8 r = {_a.x + _b.x, _a.y + _b.y, _a.z + _b.z,
+                            _a.w + _b.w};
+  return r;
+}
+
+// Returns the multiplication of _q and scalar value _f.
+OZZ_INLINE SoaQuaternion8 operator*(const SoaQuaternion8& _q,
+                                    const SimdFloat8& _f) {
+  const SoaQuaternion8 r = {_q.x * _f, _q.y * _f, _q.z * _f, _q.w * _f};
+  return r;
+}
+
+// Returns the multiplication of _a and _b. If both _a and _b are normalized,
+// then the result is normalized.
+OZZ_INLINE SoaQuaternion8 operator*(const SoaQuaternion8& _a,
+                                    const SoaQuaternion8& _b) {
+  const SoaQuaternion8 r = {
+      _a.w * _b.x + _a.x * _b.w + _a.y * _b.z - _a.z * _b.y,
+      _a.w * _b.y + _a.y * _b.w + _a.z * _b.x - _a.x * _b.z,
+      _a.w * _b.z + _a.z * _b.w + _a.x * _b.y - _a.y * _b.x,
+      _a.w * _b.w - _a.x * _b.x - _a.y * _b.y - _a.z * _b.z};
+  return r;
+}
+
+// Returns the per element square root of _v.
+OZZ_INLINE SimdFloat8 Sqrt(const SimdFloat8& _v) {
+#if defined(OZZ_SIMD_AVX)
+  const SimdFloat8 r = {_mm256_sqrt_ps(_v.v)};
+#else   // OZZ_SIMD_AVX
+  const SimdFloat8 r = {Sqrt(_v.lo), Sqrt(_v.hi)};
+#endif  // OZZ_SIMD_AVX
+  return r;
+}
+
+// Returns the per element estimated reciprocal square root of _v, with one more
+// Newton-Raphson step, see RSqrtEstNR(_SimdFloat4).
+OZZ_INLINE SimdFloat8 RSqrtEstNR(const SimdFloat8& _v) {
+#if defined(OZZ_SIMD_AVX)
+  const __m256 nr = _mm256_rsqrt_ps(_v.v);
+#if defined(OZZ_SIMD_FMA)
+  const __m256 step =
+      _mm256_fnmadd_ps(_mm256_mul_ps(_v.v, nr), nr, _mm256_set1_ps(3.f));
+#else   // OZZ_SIMD_FMA
+  const __m256 step = _mm256_sub_ps(
+      _mm256_set1_ps(3.f), _mm256_mul_ps(_mm256_mul_ps(_v.v, nr), nr));
+#endif  // OZZ_SIMD_FMA
+  const SimdFloat8 r = {
+      _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(.5f), nr), step)};
+#else   // OZZ_SIMD_AVX
+  const SimdFloat8 r = {RSqrtEstNR(_v.lo), RSqrtEstNR(_v.hi)};
+#endif  // OZZ_SIMD_AVX
+  return r;
+}
+
+// Returns _v with its sign flipped for each element whose _s element is
+// negative.
+OZZ_INLINE SimdFloat8 FlipSign(const SimdFloat8& _v, const SimdFloat8& _s) {
+#if defined(OZZ_SIMD_AVX)
+  const SimdFloat8 r = {_mm256_xor_ps(
+      _v.v, _mm256_and_ps(_s.v, _mm256_set1_ps(-0.f)))};
+#else   // OZZ_SIMD_AVX
+  const SimdFloat8 r = {Xor(_v.lo, Sign(_s.lo)), Xor(_v.hi, Sign(_s.hi))};
+#endif  // OZZ_SIMD_AVX
+  return r;
+}
+
+// Returns the linear interpolation of _a and _b with coefficient _f.
+OZZ_INLINE SoaFloat3x8 Lerp(const SoaFloat3x8& _a, const SoaFloat3x8& _b,
+                            const SimdFloat8& _f) {
+  const SoaFloat3x8 r = {(_b.x - _a.x) * _f + _a.x, (_b.y - _a.y) * _f + _a.y,
+                         (_b.z - _a.z) * _f + _a.z};
+  return r;
+}
+
+// Returns the conjugate of _q. This is the same as the inverse if _q is
+// normalized. Otherwise the magnitude of the inverse is 1.f/|_q|.
+OZZ_INLINE SoaQuaternion8 Conjugate(const SoaQuaternion8& _q) {
+  const SoaQuaternion8 r = {-_q.x, -_q.y, -_q.z, _q.w};
+  return r;
+}
+
+// Returns the 4D dot product of quaternion _a and _b.
+OZZ_INLINE SimdFloat8 Dot(const SoaQuaternion8& _a, const SoaQuaternion8& _b) {
+  return _a.x * _b.x + _a.y * _b.y + _a.z * _b.z + _a.w * _b.w;
+}
+
+// Returns the estimated normalized quaternion _q.
+OZZ_INLINE SoaQuaternion8 NormalizeEst(const SoaQuaternion8& _q) {
+  const SimdFloat8 len2 = _q.x * _q.x + _q.y * _q.y + _q.z * _q.z + _q.w * _q.w;
+  const SimdFloat8 inv_len = RSqrtEstNR(len2);
+  const SoaQuaternion8 r = {_q.x * inv_len, _q.y * inv_len, _q.z * inv_len,
+                            _q.w * inv_len};
+  return r;
+}
+
+// Returns the estimated linear interpolation of quaternions _a and _b with
+// coefficient _f.
+OZZ_INLINE SoaQuaternion8 NLerpEst(const SoaQuaternion8& _a,
+                                   const SoaQuaternion8& _b,
+                                   const SimdFloat8& _f) {
+  const SoaQuaternion8 lerp = {
+      (_b.x - _a.x) * _f + _a.x, (_b.y - _a.y) * _f + _a.y,
+      (_b.z - _a.z) * _f + _a.z, (_b.w - _a.w) * _f + _a.w};
+  return NormalizeEst(lerp);
+}
+}  // namespace math
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MATHS_SOA_TRANSFORM8_H_
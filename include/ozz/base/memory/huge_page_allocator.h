@@ -0,0 +1,113 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MEMORY_HUGE_PAGE_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_HUGE_PAGE_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Implements an allocator backed by huge pages, suited to big and long lived
+// asset data (Animation, Skeleton or Track buffers) that are read randomly by
+// many characters. Huge pages reduce TLB misses for such access patterns.
+// The allocator is selected when assets are loaded, by constructing them with
+// it, like Animation(&huge_page_allocator).
+// Memory is mapped from the system by regions of whole huge pages, and
+// allocations are carved from regions linearly. A region is unmapped once all
+// its allocations are released. Allocations bigger than a region get a
+// dedicated one. Regions are mapped, by order of preference, with:
+// - explicit huge pages (MAP_HUGETLB on Linux, MEM_LARGE_PAGES on Windows),
+// which requires huge pages to be reserved, or the lock memory privilege on
+// Windows.
+// - regular pages, aligned to the huge page size and advised to be backed by
+// transparent huge pages (madvise MADV_HUGEPAGE on Linux).
+// - the parent allocator, if the system can't map memory or isn't supported.
+// The allocator is thread safe.
+class OZZ_BASE_DLL HugePageAllocator : public Allocator {
+ public:
+  // Supported huge page sizes.
+  enum PageSize {
+    k2MB,  // 2MB pages.
+    k1GB,  // 1GB pages, Linux only. Also used as region size.
+  };
+
+  // Regions are mapped by multiples of _page_size pages. Allocations are
+  // forwarded to the _parent allocator if pages can't be mapped. _parent
+  // defaults to the default allocator at construction time.
+  explicit HugePageAllocator(PageSize _page_size = k2MB,
+                             Allocator* _parent = nullptr);
+
+  // Unmaps all regions. Asserts that all blocks were deallocated.
+  virtual ~HugePageAllocator();
+
+  // Allocates _size bytes on the specified _alignment boundaries, which can't
+  // exceed page size.
+  virtual void* Allocate(size_t _size, size_t _alignment);
+
+  // Deallocates _block, unmapping its region once empty. _block can be
+  // nullptr.
+  virtual void Deallocate(void* _block);
+
+  // Gets huge page size, in bytes.
+  size_t page_size() const { return page_size_; }
+
+  // Allocation statistics, for telemetry.
+  struct Stats {
+    // Number of regions currently mapped, and their total size in bytes, per
+    // backing.
+    size_t huge_regions;
+    size_t huge_bytes;
+    size_t transparent_regions;
+    size_t transparent_bytes;
+
+    // Number of allocations currently served by the parent allocator.
+    size_t forwarded;
+
+    // Number of blocks currently allocated from regions, and their total size
+    // in bytes, including alignment padding.
+    size_t used_blocks;
+    size_t used_bytes;
+  };
+
+  // Returns current statistics.
+  Stats stats() const;
+
+ private:
+  // Disables copy and assignment.
+  HugePageAllocator(const HugePageAllocator&);
+  void operator=(const HugePageAllocator&);
+
+  size_t page_size_;
+
+  struct Internal;
+  Internal* internal_;
+};
+}  // namespace memory
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_HUGE_PAGE_ALLOCATOR_H_
@@ -0,0 +1,207 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MEMORY_LINEAR_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_LINEAR_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Implements a linear (aka bump) allocator, suited to scratch memory that has
+// a frame lifetime, like sampling outputs, blending layers or model matrices.
+// Allocating only moves a pointer forward, and deallocating a single block
+// does nothing: memory is released all at once by Reset().
+// Memory is allocated from a parent allocator by blocks. If a frame requires
+// more than one block, Reset() merges them in a single bigger one, so that
+// the allocator stops requesting memory from its parent once it has grown to
+// its frame requirements.
+// LinearAllocator isn't thread safe, see thread_frame_allocator() for a per
+// thread instance.
+class OZZ_BASE_DLL LinearAllocator : public Allocator {
+ public:
+  // Memory is allocated from _parent allocator, by blocks of at least
+  // _block_size bytes. _parent defaults to the default allocator at
+  // construction time.
+  explicit LinearAllocator(size_t _block_size = 64 * 1024,
+                           Allocator* _parent = nullptr);
+
+  // Releases all blocks to the parent allocator.
+  virtual ~LinearAllocator();
+
+  // Allocates _size bytes on the specified _alignment boundaries, from current
+  // block. Allocates a new block from the parent allocator if current one is
+  // exhausted. Returns nullptr if parent allocation fails.
+  virtual void* Allocate(size_t _size, size_t _alignment);
+
+  // Does nothing, memory is released by Reset().
+  virtual void Deallocate(void* _block);
+
+  // Releases all allocations at once. Any memory previously returned by
+  // Allocate() must not be used after this call.
+  void Reset();
+
+  // Allocation state, used to rewind the allocator.
+  struct Marker {
+    const void* block;
+    char* current;
+    size_t used;
+  };
+
+  // Returns current allocation state.
+  Marker marker() const;
+
+  // Releases all allocations made since _marker was returned, which allows
+  // nested scratch scopes to reuse the same memory. Reset() must not be called
+  // in between.
+  void Rewind(const Marker& _marker);
+
+  // Number of bytes allocated since last Reset(), including alignment
+  // padding.
+  size_t used() const { return used_; }
+
+  // Number of bytes allocated from the parent allocator.
+  size_t capacity() const { return capacity_; }
+
+ private:
+  // Disables copy and assignment.
+  LinearAllocator(const LinearAllocator&);
+  void operator=(const LinearAllocator&);
+
+  // Allocates a new block of at least _size bytes from the parent allocator,
+  // and makes it current.
+  bool Grow(size_t _size);
+
+  // Releases all blocks to the parent allocator.
+  void Release();
+
+  struct Block;
+
+  // Parent allocator, used to allocate blocks.
+  Allocator* parent_;
+
+  // Linked list of blocks, current block first.
+  Block* blocks_;
+
+  // Current block free range.
+  char* current_;
+  char* end_;
+
+  // Minimum size of a block.
+  size_t block_size_;
+
+  size_t used_;
+  size_t capacity_;
+};
+
+// Returns calling thread frame allocator. It's a LinearAllocator allocating
+// from the default allocator, created on first use and destroyed when the
+// thread exits. The owner of the frame loop calls Reset() once per frame.
+OZZ_BASE_DLL LinearAllocator* thread_frame_allocator();
+
+// Scoped scratch arena: allocations made from allocator() during the scope are
+// all released when the scope ends, while allocations made before are
+// preserved. Scopes can be nested, and default to calling thread frame
+// allocator, so that algorithms can use scratch memory without requiring the
+// frame to be reset. Memory stays owned by the LinearAllocator, so the arena
+// stops requesting memory from its parent once it has grown to the biggest
+// scope requirements.
+class ScratchScope {
+ public:
+  explicit ScratchScope(LinearAllocator* _allocator = thread_frame_allocator())
+      : allocator_(_allocator), marker_(_allocator->marker()) {}
+
+  ~ScratchScope() { allocator_->Rewind(marker_); }
+
+  LinearAllocator* allocator() const { return allocator_; }
+
+ private:
+  ScratchScope(const ScratchScope&) = delete;
+  void operator=(const ScratchScope&) = delete;
+
+  LinearAllocator* allocator_;
+  LinearAllocator::Marker marker_;
+};
+}  // namespace memory
+
+// Defines a STL compliant allocator, allocating from calling thread frame
+// allocator. It allows to use std containers for per frame scratch, for
+// example std::vector<float, FrameStdAllocator<float>>. Such containers must
+// be used (and destroyed) by their owner thread, before the frame allocator is
+// reset.
+template <typename _Ty>
+class FrameStdAllocator {
+ public:
+  typedef _Ty value_type;                     // Element type.
+  typedef value_type* pointer;                // Pointer to element.
+  typedef value_type& reference;              // Reference to element.
+  typedef const value_type* const_pointer;    // Constant pointer to element.
+  typedef const value_type& const_reference;  // Constant reference to element.
+  typedef size_t size_type;                   // Quantities of elements.
+  typedef ptrdiff_t difference_type;  // Difference between two pointers.
+
+  FrameStdAllocator() noexcept {}
+  FrameStdAllocator(const FrameStdAllocator&) noexcept {}
+
+  template <class _Other>
+  FrameStdAllocator(const FrameStdAllocator<_Other>&) noexcept {}
+
+  template <class _Other>
+  struct rebind {
+    typedef FrameStdAllocator<_Other> other;
+  };
+
+  // Allocates array of _Count elements.
+  pointer allocate(size_t _count) noexcept {
+    return reinterpret_cast<pointer>(memory::thread_frame_allocator()->Allocate(
+        sizeof(value_type) * _count, alignof(value_type)));
+  }
+
+  // Memory is released by the frame allocator reset.
+  void deallocate(pointer, size_type) noexcept {}
+
+  size_type max_size() const noexcept {
+    return (~size_type(0)) / sizeof(value_type);
+  }
+};
+
+// Tests for allocator equality (always true).
+template <class _Ty, class _Other>
+inline bool operator==(const FrameStdAllocator<_Ty>&,
+                       const FrameStdAllocator<_Other>&) noexcept {
+  return true;
+}
+
+// Tests for allocator inequality (always false).
+template <class _Ty, class _Other>
+inline bool operator!=(const FrameStdAllocator<_Ty>&,
+                       const FrameStdAllocator<_Other>&) noexcept {
+  return false;
+}
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_LINEAR_ALLOCATOR_H_
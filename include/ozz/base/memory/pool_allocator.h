@@ -0,0 +1,114 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MEMORY_POOL_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_POOL_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Implements a size class pool allocator, recycling blocks of similar sizes,
+// like SamplingJob::Context caches or SoaTransform and Float4x4 buffers of
+// characters that are constantly spawned and despawned.
+// Requests are rounded up to the next power of 2 size class (from 16 bytes to
+// max_block_size). Each class owns a free list of blocks, carved from chunks
+// allocated from a parent allocator. Allocating and deallocating a recycled
+// block is O(1) and lock-free, only the allocation of a new chunk takes a
+// lock. Chunks are never released to the parent before the pool destruction.
+// Blocks are aligned to kAlignment bytes, which matches SIMD and SoA types
+// alignment. Requests that are bigger than max_block_size, require a bigger
+// alignment, or exceed the pool capacity are forwarded to the parent
+// allocator.
+class OZZ_BASE_DLL PoolAllocator : public Allocator {
+ public:
+  // Alignment of pooled blocks.
+  static const size_t kAlignment = 16;
+
+  // Maximum number of size classes.
+  static const int kMaxClasses = 24;
+
+  // Memory is allocated from _parent allocator, by chunks of at least
+  // _chunk_size bytes. Requests up to _max_block_size bytes are pooled.
+  // _parent defaults to the default allocator at construction time.
+  explicit PoolAllocator(size_t _max_block_size = 32 * 1024,
+                         size_t _chunk_size = 64 * 1024,
+                         Allocator* _parent = nullptr);
+
+  // Releases all chunks to the parent allocator. Asserts that all blocks
+  // were deallocated.
+  virtual ~PoolAllocator();
+
+  // Allocates _size bytes on the specified _alignment boundaries.
+  virtual void* Allocate(size_t _size, size_t _alignment);
+
+  // Returns _block to its class free list, or to the parent allocator if it
+  // was forwarded. _block can be nullptr.
+  virtual void Deallocate(void* _block);
+
+  // Allocation statistics, for telemetry.
+  struct Stats {
+    // Number of Allocate and Deallocate calls that succeeded.
+    size_t allocations;
+    size_t deallocations;
+
+    // Number of allocations served by recycling a block from a free list.
+    size_t recycled;
+
+    // Number of allocations forwarded to the parent allocator.
+    size_t forwarded;
+
+    // Number of chunks, and their total size in bytes.
+    size_t chunks;
+    size_t chunk_bytes;
+
+    // Number of blocks currently allocated, and their total size (rounded up
+    // to their size class). Forwarded allocations aren't included.
+    size_t used_blocks;
+    size_t used_bytes;
+  };
+
+  // Returns current statistics. Counters are updated atomically but
+  // independently, so they can be slightly inconsistent while other threads
+  // are allocating.
+  Stats stats() const;
+
+  // Returns the size class of a _size bytes request, or -1 if it isn't pooled.
+  int SizeClass(size_t _size) const;
+
+ private:
+  // Disables copy and assignment.
+  PoolAllocator(const PoolAllocator&);
+  void operator=(const PoolAllocator&);
+
+  struct Internal;
+  Internal* internal_;
+};
+}  // namespace memory
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_POOL_ALLOCATOR_H_
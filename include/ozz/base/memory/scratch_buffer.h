@@ -0,0 +1,88 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MEMORY_SCRATCH_BUFFER_H_
+#define OZZ_OZZ_BASE_MEMORY_SCRATCH_BUFFER_H_
+
+#include <cstddef>
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Implements a temporary array of _Ty, suited to function scratch memory whose
+// size depends on input data, like per joint arrays. Up to _Inline elements
+// are stored inside the object itself (usually on the stack), bigger sizes
+// are allocated from the default allocator and released on destruction. This
+// keeps common sizes free of any allocation, while larger ones are still
+// supported.
+// Elements aren't initialized, so _Ty is expected to be a trivial type.
+template <typename _Ty, size_t _Inline>
+class ScratchBuffer {
+ public:
+  // Makes _size elements available.
+  explicit ScratchBuffer(size_t _size)
+      : data_(reinterpret_cast<_Ty*>(inline_)), size_(_size) {
+    if (_size > _Inline) {
+      data_ = reinterpret_cast<_Ty*>(
+          default_allocator()->Allocate(sizeof(_Ty) * _size, alignof(_Ty)));
+    }
+  }
+
+  // Releases allocated memory, if any.
+  ~ScratchBuffer() {
+    if (size_ > _Inline) {
+      default_allocator()->Deallocate(data_);
+    }
+  }
+
+  // Accesses element at _index, no range check.
+  _Ty& operator[](size_t _index) { return data_[_index]; }
+  const _Ty& operator[](size_t _index) const { return data_[_index]; }
+
+  _Ty* data() { return data_; }
+  const _Ty* data() const { return data_; }
+
+  size_t size() const { return size_; }
+
+  // Tells whether elements are stored in the object itself.
+  bool is_inline() const { return size_ <= _Inline; }
+
+ private:
+  ScratchBuffer(const ScratchBuffer&) = delete;
+  void operator=(const ScratchBuffer&) = delete;
+
+  // Inline storage, used for up to _Inline elements.
+  alignas(_Ty) char inline_[sizeof(_Ty) * _Inline];
+
+  _Ty* data_;
+  size_t size_;
+};
+}  // namespace memory
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_SCRATCH_BUFFER_H_
@@ -0,0 +1,130 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_MEMORY_TRACKING_ALLOCATOR_H_
+#define OZZ_OZZ_BASE_MEMORY_TRACKING_ALLOCATOR_H_
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace memory {
+
+// Defines subsystems allocations can be attributed to.
+enum MemoryTag {
+  kTagUntagged,   // Anything allocated outside of a TagScope.
+  kTagSkeleton,   // animation::Skeleton buffers.
+  kTagAnimation,  // animation::Animation buffers.
+  kTagTrack,      // Float*Track, Quaternion and MultiFloatTrack buffers.
+  kTagContext,    // animation::SamplingJob::Context caches.
+  kTagOffline,    // Temporary allocations of offline builders and optimizers.
+  kTagCount,
+};
+
+// Returns tag _tag name, for displaying purpose.
+OZZ_BASE_DLL const char* TagName(MemoryTag _tag);
+
+// Returns the tag of the calling thread, kTagUntagged if no TagScope is alive.
+OZZ_BASE_DLL MemoryTag current_tag();
+
+// Sets the tag of the calling thread for the lifetime of the scope object, and
+// restores the previous one on destruction. Scopes can be nested.
+class OZZ_BASE_DLL TagScope {
+ public:
+  explicit TagScope(MemoryTag _tag);
+  ~TagScope();
+
+ private:
+  // Disables copy and assignment.
+  TagScope(const TagScope&);
+  void operator=(const TagScope&);
+
+  MemoryTag previous_;
+};
+
+// Implements an instrumenting allocator, forwarding to a parent allocator
+// while attributing each allocation to the calling thread current tag.
+// Counters are kept per tag: live bytes, peak bytes and cumulative counts. The
+// latter can be sampled at regular intervals (every frame for example) to
+// compute allocation rates.
+// A TrackingAllocator is typically installed with SetDefaulAllocator, so that
+// all ozz allocations go through it. It must then outlive all the objects it
+// allocated.
+class OZZ_BASE_DLL TrackingAllocator : public Allocator {
+ public:
+  // _parent defaults to the default allocator at construction time.
+  explicit TrackingAllocator(Allocator* _parent = nullptr);
+  virtual ~TrackingAllocator();
+
+  // Allocates _size bytes on the specified _alignment boundaries, attributed
+  // to current_tag().
+  virtual void* Allocate(size_t _size, size_t _alignment);
+
+  // Deallocates _block, attributed to the tag it was allocated with. _block
+  // can be nullptr.
+  virtual void Deallocate(void* _block);
+
+  // Allocation statistics of a tag, or of all tags.
+  struct Stats {
+    // Currently allocated bytes and number of allocations.
+    size_t live_bytes;
+    size_t live_allocations;
+
+    // Highest live_bytes value since construction or last ResetPeaks call.
+    size_t peak_bytes;
+
+    // Cumulative number of allocations, deallocations and allocated bytes
+    // since construction.
+    size_t allocations;
+    size_t deallocations;
+    size_t allocated_bytes;
+  };
+
+  // Returns statistics of _tag. Counters are updated atomically but
+  // independently, so they can be slightly inconsistent while other threads
+  // are allocating.
+  Stats stats(MemoryTag _tag) const;
+
+  // Returns statistics of all tags merged together. Peak is the peak of the
+  // sum, not the sum of the peaks.
+  Stats total() const;
+
+  // Resets peaks to current live bytes.
+  void ResetPeaks();
+
+ private:
+  // Disables copy and assignment.
+  TrackingAllocator(const TrackingAllocator&);
+  void operator=(const TrackingAllocator&);
+
+  Allocator* parent_;
+
+  struct Counters;
+  Counters* counters_;
+};
+}  // namespace memory
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_MEMORY_TRACKING_ALLOCATOR_H_
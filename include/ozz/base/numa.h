@@ -0,0 +1,71 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_NUMA_H_
+#define OZZ_OZZ_BASE_NUMA_H_
+
+// Provides host memory nodes (NUMA) topology and thread affinity utilities,
+// used to keep worker threads and the data they read on the same node of
+// multi-socket hosts. Topology is only queried on Linux, other platforms are
+// considered as a single node host, where thread pinning isn't supported.
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace numa {
+
+// Gets the number of memory nodes of the host, 1 if it isn't NUMA or if
+// topology is unknown.
+OZZ_BASE_DLL int NumNodes();
+
+// Gets the number of hardware threads (cpus) of the host.
+OZZ_BASE_DLL int NumCpus();
+
+// Gets the node of hardware thread _cpu, 0 if unknown.
+OZZ_BASE_DLL int CpuNode(int _cpu);
+
+// Gets the node the calling thread currently runs on, 0 if unknown. The
+// result is only stable for threads pinned to a node.
+OZZ_BASE_DLL int CurrentNode();
+
+// Pins the calling thread to hardware thread _cpu. Returns false if pinning
+// isn't supported or failed.
+OZZ_BASE_DLL bool PinThread(int _cpu);
+
+// Pins the calling thread to all hardware threads of node _node. Returns
+// false if pinning isn't supported, if _node has no hardware thread, or if
+// pinning failed.
+OZZ_BASE_DLL bool PinThreadToNode(int _node);
+
+// Runs _fn(_data) from a thread pinned to node _node, and returns once it's
+// completed. Memory pages first written by _fn are thus allocated on _node
+// (first touch policy). _fn is run by an unpinned thread if _node can't be
+// targeted.
+OZZ_BASE_DLL void RunOnNode(int _node, void (*_fn)(void*), void* _data);
+}  // namespace numa
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_NUMA_H_
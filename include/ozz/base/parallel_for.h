@@ -0,0 +1,47 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_PARALLEL_FOR_H_
+#define OZZ_OZZ_BASE_PARALLEL_FOR_H_
+
+namespace ozz {
+
+// Task function provided to parallel_for hooks, which runs task _task. _data
+// is the opaque task data provided with it.
+typedef void (*ParallelForTask)(int _task, void* _data);
+
+// Task scheduler hook signature, shared by every ozz job and tool that can
+// distribute its work (SamplingJob, LocalToModelJob, SkinningJob, optimizers,
+// archives...). It must call _task(i, _task_data) once for every task i in
+// [0, _count[, from any thread and in any order, and return only once all of
+// them are completed. _user_data is the user data provided along with the
+// hook, typically the job parallel_for_user_data.
+// TaskScheduler::ParallelForHook implements it on top of a TaskScheduler.
+typedef void (*ParallelForHook)(int _count, ParallelForTask _task,
+                                void* _task_data, void* _user_data);
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_PARALLEL_FOR_H_
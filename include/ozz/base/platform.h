@@ -73,6 +73,20 @@ typedef uint8_t byte;
 // Syntax is: void function(int* OZZ_RESTRICT _p);"
 #define OZZ_RESTRICT __restrict
 
+// Hints the processor to fetch the cache line containing _address, ahead of
+// an upcoming read. Prefetching never faults, so _address can be invalid.
+// Expands to nothing if the compiler has no prefetch intrinsic.
+// Syntax is: "OZZ_PREFETCH(&keys[next]);"
+#if defined(__GNUC__) || defined(__clang__)
+#define OZZ_PREFETCH(_address) __builtin_prefetch(_address)
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <xmmintrin.h>
+#define OZZ_PREFETCH(_address) \
+  _mm_prefetch(reinterpret_cast<const char*>(_address), _MM_HINT_T0)
+#else
+#define OZZ_PREFETCH(_address) ((void)(_address))
+#endif
+
 // Defines macro to help with DEBUG/NDEBUG syntax.
 #if defined(NDEBUG)
 #define OZZ_IF_DEBUG(...)
@@ -0,0 +1,114 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_PROFILE_H_
+#define OZZ_OZZ_BASE_PROFILE_H_
+
+// Provides compile time optional instrumentation of runtime jobs hot paths,
+// so that sub-job breakdowns (keys cursor update, decompression,
+// interpolation...) can be visualized by an external profiler (Tracy,
+// Superluminal, PIX...).
+// Instrumentation is enabled by defining OZZ_BUILD_PROFILE (see
+// ozz_build_profile CMake option) when building ozz libraries. Otherwise
+// OZZ_PROFILE_ZONE macro compiles to nothing and jobs have no overhead at
+// all.
+// Profiler integration is done by registering zone begin/end callbacks with
+// ozz::profile::SetHooks.
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace profile {
+
+// Static description of an instrumented zone. Every zone is described by a
+// unique static instance, so that its address can be used by profilers as a
+// persistent zone identifier (source location).
+struct ZoneDesc {
+  const char* name;      // Zone name, like "SamplingJob::Interpolate".
+  const char* function;  // Function name, as __FUNCTION__.
+  const char* file;      // Source file name, as __FILE__.
+  int line;              // Source file line, as __LINE__.
+};
+
+// Zone begin/end callbacks, invoked from the thread running the job. Calls
+// are always balanced and nested: a zone ends before its parent zone.
+typedef void (*ZoneBeginFn)(const ZoneDesc& _zone, void* _user_data);
+typedef void (*ZoneEndFn)(const ZoneDesc& _zone, void* _user_data);
+
+// Set of callbacks forwarded instrumented zones. Nullptr callbacks are
+// ignored.
+struct Hooks {
+  ZoneBeginFn begin;
+  ZoneEndFn end;
+  void* user_data;  // Forwarded to begin and end callbacks.
+};
+
+// Sets zone callbacks, and returns previous ones. Hooks aren't synchronized,
+// they must be set while no job is running, typically during initialization.
+OZZ_BASE_DLL Hooks SetHooks(const Hooks& _hooks);
+
+// Gets current zone callbacks.
+OZZ_BASE_DLL Hooks GetHooks();
+
+// Forwards _zone begin/end to current hooks.
+OZZ_BASE_DLL void ZoneBegin(const ZoneDesc& _zone);
+OZZ_BASE_DLL void ZoneEnd(const ZoneDesc& _zone);
+
+// RAII helper that begins a zone at construction and ends it at destruction.
+class Zone {
+ public:
+  explicit Zone(const ZoneDesc& _zone) : zone_(_zone) { ZoneBegin(zone_); }
+  ~Zone() { ZoneEnd(zone_); }
+
+ private:
+  Zone(const Zone&) = delete;
+  void operator=(const Zone&) = delete;
+
+  const ZoneDesc& zone_;
+};
+}  // namespace profile
+}  // namespace ozz
+
+// Instruments the remaining of the enclosing scope as a zone named _name,
+// which must be a string literal. Compiles to nothing unless
+// OZZ_BUILD_PROFILE is defined.
+#if defined(OZZ_BUILD_PROFILE)
+#define OZZ_PROFILE_CONCAT_IMPL(_a, _b) _a##_b
+#define OZZ_PROFILE_CONCAT(_a, _b) OZZ_PROFILE_CONCAT_IMPL(_a, _b)
+#define OZZ_PROFILE_ZONE(_name)                                               \
+  static const ozz::profile::ZoneDesc OZZ_PROFILE_CONCAT(ozz_zone_desc_,      \
+                                                         __LINE__) = {        \
+      _name, __FUNCTION__, __FILE__, __LINE__};                               \
+  const ozz::profile::Zone OZZ_PROFILE_CONCAT(ozz_zone_, __LINE__)(           \
+      OZZ_PROFILE_CONCAT(ozz_zone_desc_, __LINE__))
+#else  // OZZ_BUILD_PROFILE
+#define OZZ_PROFILE_ZONE(_name) \
+  do {                          \
+  } while (void(0), 0)
+#endif  // OZZ_BUILD_PROFILE
+
+#endif  // OZZ_OZZ_BASE_PROFILE_H_
@@ -0,0 +1,157 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_BASE_TASK_SCHEDULER_H_
+#define OZZ_OZZ_BASE_TASK_SCHEDULER_H_
+
+// Provides a pluggable task scheduler interface, used to distribute batched
+// jobs (sampling, blending, skinning, optimizers...) across threads. An
+// engine can implement it on top of its own job system, or use the default
+// WorkStealingScheduler.
+// TaskScheduler::ParallelForHook adapts any scheduler to ozz jobs
+// parallel_for hooks (see ozz/base/parallel_for.h), passing the scheduler as
+// hook user data.
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/parallel_for.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Declares task scheduler interface.
+class OZZ_BASE_DLL TaskScheduler {
+ public:
+  // Task function, called with the index _task of the task to run and the
+  // opaque task data _data.
+  typedef ParallelForTask Task;
+
+  // Required virtual destructor.
+  virtual ~TaskScheduler() {}
+
+  // Calls _task(i, _data) once for every task i in [0, _count[, from any
+  // thread and in any order, and returns only once all of them are completed.
+  // ParallelFor can be called concurrently from any thread, including from a
+  // running task.
+  virtual void ParallelFor(int _count, Task _task, void* _data) = 0;
+
+  // ozz::ParallelForHook implementation, to be assigned to ozz jobs
+  // parallel_for hooks. _user_data must be the TaskScheduler to run tasks
+  // with.
+  static void ParallelForHook(int _count, Task _task, void* _task_data,
+                              void* _user_data);
+
+ protected:
+  TaskScheduler() {}
+
+ private:
+  TaskScheduler(const TaskScheduler&);
+  void operator=(const TaskScheduler&);
+};
+
+// Implements a TaskScheduler with a pool of worker threads. Each worker owns a
+// queue of task ranges, and steals ranges from other queues once its own is
+// empty. The thread calling ParallelFor also runs tasks until all its tasks are
+// completed, so nested ParallelFor calls don't dead lock.
+// ParallelFor splits tasks in contiguous ranges, consecutive ranges being
+// pushed to the same queue. When workers are pinned, they are assigned
+// hardware threads node by node (see ozz/base/numa.h), and steal from
+// workers of their own node first. Consecutive tasks, which typically read
+// the same assets, thus tend to be run by the same node, avoiding cross node
+// memory traffic on multi-socket hosts.
+class OZZ_BASE_DLL WorkStealingScheduler : public TaskScheduler {
+ public:
+  // Starts _num_workers worker threads. A negative value starts as many workers
+  // as hardware threads, minus one for the calling thread. With 0 worker,
+  // tasks are all run by the thread calling ParallelFor.
+  // If _pin_workers is true, each worker is pinned to a hardware thread,
+  // hardware threads being sorted by memory node. The first one is left to
+  // the calling thread.
+  explicit WorkStealingScheduler(int _num_workers = -1,
+                                 bool _pin_workers = false);
+
+  // Stops and joins worker threads. No ParallelFor must be pending.
+  virtual ~WorkStealingScheduler();
+
+  // Gets the number of worker threads.
+  int num_workers() const;
+
+  // Gets the memory node worker _worker is pinned to, 0 if workers aren't
+  // pinned or if _worker is invalid.
+  int worker_node(int _worker) const;
+
+  // See TaskScheduler::ParallelFor for details.
+  virtual void ParallelFor(int _count, Task _task, void* _data);
+
+ private:
+  // Internal worker threads and queues.
+  struct Impl;
+  Impl* impl_;
+};
+
+// Implements a graph of parallel-for tasks. Each node is run as a parallel-for
+// once all the nodes it depends on are completed. Independent nodes are run
+// concurrently.
+class OZZ_BASE_DLL TaskGraph {
+ public:
+  TaskGraph();
+
+  // Adds a node running _task(i, _data) for every i in [0, _count[. Returns
+  // node index, used to declare dependencies.
+  int AddNode(int _count, TaskScheduler::Task _task, void* _data);
+
+  // Declares that node _after can only start once node _before is completed.
+  // Returns false if one of the indices is invalid.
+  bool AddDependency(int _before, int _after);
+
+  // Runs all nodes, with _scheduler, or from the calling thread if _scheduler
+  // is nullptr. Returns false, without running any node, if dependencies
+  // contain a cycle.
+  bool Run(TaskScheduler* _scheduler) const;
+
+  // Removes all nodes and dependencies.
+  void Clear();
+
+  // Gets the number of nodes.
+  int num_nodes() const { return static_cast<int>(nodes_.size()); }
+
+ private:
+  struct Node {
+    int count;
+    TaskScheduler::Task task;
+    void* data;
+  };
+  ozz::vector<Node> nodes_;
+
+  // Dependencies, as pairs of before and after node indices.
+  struct Dependency {
+    int before;
+    int after;
+  };
+  ozz::vector<Dependency> dependencies_;
+};
+}  // namespace ozz
+#endif  // OZZ_OZZ_BASE_TASK_SCHEDULER_H_
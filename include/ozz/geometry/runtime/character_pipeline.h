@@ -0,0 +1,245 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_CHARACTER_PIPELINE_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_CHARACTER_PIPELINE_H_
+
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+#include "ozz/geometry/runtime/export.h"
+#include "ozz/geometry/runtime/skinning_job.h"
+
+namespace ozz {
+class TaskGraph;
+namespace math {
+struct Float4x4;
+struct SoaTransform;
+}  // namespace math
+namespace animation {
+class Animation;
+class Skeleton;
+}  // namespace animation
+namespace geometry {
+
+// Chains the runtime update stages of a character: animation layers sampling,
+// blending, local-to-model conversion, inverse kinematics and skinning.
+// The pipeline owns all intermediate buffers (layers local transforms, sampling
+// contexts, blended locals, model-space and skinning matrices) in a single
+// allocation, aligned and padded to cache lines, so that concurrent updates of
+// different characters never share a cache line.
+// Stages can be run sequentially with Run(), or added as dependent nodes of a
+// TaskGraph, so that a scheduler can overlap the stages of many characters.
+// The pipeline doesn't own its inputs (skeleton, animations, joint weights,
+// skinning jobs buffers), which must outlive it.
+class OZZ_GEOMETRY_DLL CharacterPipeline {
+ public:
+  // Enumerates pipeline stages, in execution order.
+  enum Stage {
+    kSampleStage,        // Samples each layer animation, one task per layer.
+    kBlendStage,         // Blends layers local transforms.
+    kLocalToModelStage,  // Computes model-space matrices.
+    kIKStage,            // Runs IK callback, updates model-space matrices it
+                         // modifies, and computes skinning matrices.
+    kSkinStage,          // Runs skinning jobs, one task per job.
+    kStageCount
+  };
+
+  // Describes an animation layer.
+  struct OZZ_GEOMETRY_DLL Layer {
+    // Default constructor, initializes default values.
+    Layer();
+
+    // Animation to sample. Layer is skipped if nullptr.
+    const animation::Animation* animation;
+
+    // Time ratio to sample the animation at, in range [0,1].
+    float ratio;
+
+    // Blending weight of the layer, see BlendingJob::Layer::weight.
+    float weight;
+
+    // Optional per SoA joint blending weights, see
+    // BlendingJob::Layer::joint_weights.
+    span<const math::SimdFloat4> joint_weights;
+
+    // Blends the layer as an additive layer if true.
+    bool additive;
+  };
+
+  // IK stage callback, run after model-space matrices are computed. It can
+  // modify locals() (ie: applying IK jobs corrections), in which case it
+  // sets *_update_from to the joint from which model-space matrices must be
+  // updated (Skeleton::kNoParent to update them all). *_update_from is
+  // kNoUpdate when called. Returns false on failure.
+  typedef bool (*IKCallback)(CharacterPipeline* _pipeline, int* _update_from,
+                             void* _user_data);
+
+  // IK callback *_update_from value meaning that no joint was modified.
+  enum { kNoUpdate = -2 };
+
+  CharacterPipeline();
+
+  // Disables copy and assignation.
+  CharacterPipeline(CharacterPipeline const&) = delete;
+  CharacterPipeline& operator=(CharacterPipeline const&) = delete;
+
+  ~CharacterPipeline();
+
+  // Allocates pipeline buffers for _skeleton, with up to _max_layers layers of
+  // animations with up to _max_tracks tracks. Layers can only play cubic
+  // animations if _cubic is true (see SamplingJob::Context::cubic()). Layers
+  // and callbacks are reset. Returns false if a parameter is invalid, leaving
+  // the pipeline empty.
+  bool Allocate(const animation::Skeleton& _skeleton, int _max_layers,
+                int _max_tracks, bool _cubic = false);
+
+  // Releases all buffers.
+  void Deallocate();
+
+  // Gets the skeleton the pipeline was allocated for, nullptr if not
+  // allocated.
+  const animation::Skeleton* skeleton() const { return skeleton_; }
+
+  // Animation layers, max_layers() of them, to setup before running the
+  // pipeline.
+  span<Layer> layers() { return span<Layer>(layers_, max_layers_); }
+  span<const Layer> layers() const {
+    return span<const Layer>(layers_, max_layers_);
+  }
+  int max_layers() const { return max_layers_; }
+
+  // Sets IK stage callback, nullptr to disable IK.
+  void set_ik_callback(IKCallback _callback, void* _user_data) {
+    ik_callback_ = _callback;
+    ik_user_data_ = _user_data;
+  }
+
+  // Sets skeleton inverse bind poses, one per joint. Skinning matrices are
+  // model-space matrices multiplied by inverse bind poses, or model-space
+  // matrices if empty.
+  void set_inverse_bind_poses(span<const math::Float4x4> _inverse_bind_poses) {
+    inverse_bind_poses_ = _inverse_bind_poses;
+  }
+
+  // Sets skinning jobs run by skin stage. Jobs without joint matrices are
+  // provided skinning_matrices(). Jobs are copied, but not their buffers.
+  void set_skinning_jobs(span<const SkinningJob> _jobs);
+
+  // Local transforms sampled for layer _layer.
+  span<const math::SoaTransform> layer_locals(int _layer) const;
+
+  // Blended local transforms, which IK callback can modify.
+  span<math::SoaTransform> locals() {
+    return span<math::SoaTransform>(locals_, num_soa_);
+  }
+
+  // Model-space matrices.
+  span<const math::Float4x4> models() const {
+    return span<const math::Float4x4>(models_, num_joints_);
+  }
+
+  // Skinning matrices.
+  span<const math::Float4x4> skinning_matrices() const {
+    return span<const math::Float4x4>(skinning_matrices_, num_joints_);
+  }
+
+  // Runs all stages sequentially. Returns false if any stage failed.
+  bool Run();
+
+  // Runs a single stage. Stages must be run in order. Returns false on
+  // failure. Layers that failed sampling are excluded from blending, and
+  // stages following a failing single task stage (blend, local-to-model, IK)
+  // are skipped.
+  bool RunStage(Stage _stage);
+
+  // Adds pipeline stages as nodes of _graph, each depending on the previous
+  // one. Returns index of the first node (sample stage), stages nodes being
+  // consecutive, so that other nodes can be made dependent on them. Returns -1
+  // if the pipeline isn't allocated.
+  // Graph must be rebuilt when skinning jobs change. Once graph is run,
+  // succeeded() reports stages failures.
+  int AddTasks(TaskGraph* _graph);
+
+  // Returns true if all stages of the last run succeeded.
+  bool succeeded() const;
+
+ private:
+  // Stage tasks.
+  void Sample(int _layer);
+  bool Blend();
+  bool LocalToModel();
+  bool IK();
+  void Skin(int _job);
+
+  // TaskGraph tasks, _data is the pipeline.
+  static void SampleTask(int _task, void* _data);
+  static void BlendTask(int _task, void* _data);
+  static void LocalToModelTask(int _task, void* _data);
+  static void IKTask(int _task, void* _data);
+  static void SkinTask(int _task, void* _data);
+
+  const animation::Skeleton* skeleton_;
+  int max_layers_;
+  int num_soa_;
+  int num_joints_;
+
+  // Single allocation, that all buffers below point to.
+  void* buffer_;
+
+  Layer* layers_;
+
+  // Per layer sampling state (context, status), each on its own cache lines.
+  struct LayerState;
+  LayerState* layers_states_;
+  LayerState* layer_state(int _layer) const;
+
+  // Per layer sampled local transforms, each on its own cache lines.
+  byte* layers_locals_;
+  size_t layers_locals_stride_;
+
+  // Blending job layers, normal ones first, then additive ones.
+  animation::BlendingJob::Layer* blend_layers_;
+
+  math::SoaTransform* locals_;
+  math::Float4x4* models_;
+  math::Float4x4* skinning_matrices_;
+
+  IKCallback ik_callback_;
+  void* ik_user_data_;
+  span<const math::Float4x4> inverse_bind_poses_;
+
+  ozz::vector<SkinningJob> skinning_jobs_;
+  ozz::vector<uint8_t> skinning_failed_;  // One per skinning job.
+
+  // Status of single task stages (blend, local-to-model, IK).
+  bool succeeded_;
+};
+}  // namespace geometry
+}  // namespace ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_CHARACTER_PIPELINE_H_
@@ -0,0 +1,81 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_INVERSE_TRANSPOSE_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_INVERSE_TRANSPOSE_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+#include "ozz/geometry/runtime/export.h"
+
+namespace ozz {
+namespace math {
+struct Float4x4;
+}  // namespace math
+namespace geometry {
+
+// Computes the inverse transpose of a palette of matrices, as required by
+// SkinningJob joint_inverse_transpose_matrices to transform normals and
+// tangents by matrices with non-uniform scale.
+// Matrices are processed 4 at a time in SoA, computing the 3x3 cofactor matrix
+// from the cross products of their axes. Only the 3x3 part is output, the last
+// row and column being set to identity, which is all SkinningJob needs to
+// transform vectors.
+// Output can be the same buffer as input.
+// The job does not own the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_GEOMETRY_DLL InverseTransposeJob {
+  // Default constructor, initializes default values.
+  InverseTransposeJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if output is smaller than input.
+  bool Validate() const;
+
+  // Runs job's task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Input matrices.
+  span<const math::Float4x4> input;
+
+  // Outputs the cofactor matrix only, aka the inverse transpose multiplied by
+  // the matrix determinant, which saves the division. Transformed normals then
+  // have the right direction but aren't normalized, and are flipped by
+  // matrices with a negative determinant (mirroring). Default is false.
+  bool cofactor;
+
+  // Output inverse transpose (or cofactor) matrices, at least as big as input.
+  // Output is undefined for singular input matrices.
+  span<math::Float4x4> output;
+};
+}  // namespace geometry
+}  // namespace ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_INVERSE_TRANSPOSE_JOB_H_
@@ -0,0 +1,125 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_MORPH_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_MORPH_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+#include "ozz/geometry/runtime/export.h"
+
+namespace ozz {
+namespace geometry {
+
+// Defines a sparse morph target (aka blend shape): the vertices it displaces
+// and their position (and optionally normal) deltas. Vertices that aren't
+// displaced by the target aren't stored, which matters for facial rigs where
+// each target only moves a small area of the mesh.
+// The morph target doesn't own its buffers.
+struct OZZ_GEOMETRY_DLL MorphTarget {
+  // Indices of the displaced vertices, sorted in strictly increasing order.
+  span<const uint32_t> indices;
+
+  // Position deltas, 3 floats per index.
+  span<const float> position_deltas;
+
+  // Optional normal deltas, 3 floats per index. Can be empty, in which case
+  // the target doesn't modify normals.
+  span<const float> normal_deltas;
+};
+
+// Applies weighted sparse morph targets to vertex positions and normals:
+// out = in + sum(weight[t] * delta[t]). Targets are typically weighted by
+// FloatTrack or MultiFloatTrack sampling results. Targets whose weight is 0 are
+// skipped, so only active targets cost anything.
+// Input and output buffers must be provided with a stride value (aka the
+// number of bytes from a vertex to the next), like SkinningJob. Output can
+// alias input (same buffer and stride) to morph vertices in place.
+// The job processes vertices [first_vertex, first_vertex + vertex_count[ of
+// morph targets, input and output buffers pointing to first_vertex. This
+// allows to split big meshes into vertex ranges, processed concurrently.
+// Note that morphing can also be fused to skinning, see
+// SkinningJob::morph_targets, so that morphed vertices are skinned in the same
+// pass without an intermediate buffer.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_GEOMETRY_DLL MorphJob {
+  // Default constructor, initializes default values.
+  MorphJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if vertex_count or first_vertex is negative.
+  // - if weights is smaller than targets.
+  // - if a target deltas are smaller than its indices.
+  // - if any input or output range is too small for vertex_count.
+  // - if normals are provided as input but not as output (or the opposite).
+  bool Validate() const;
+
+  // Runs job's morphing task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Number of vertices to morph. All input and output arrays must store at
+  // least this number of vertices.
+  int vertex_count;
+
+  // Index of the first vertex to morph, as indexed by targets indices.
+  // Target vertices outside of [first_vertex, first_vertex + vertex_count[
+  // are ignored.
+  int first_vertex;
+
+  // Morph targets.
+  span<const MorphTarget> targets;
+
+  // Weight of each morph target. Must contain at least one weight per target.
+  span<const float> weights;
+
+  // Input vertex positions array (3 float values per vertex) and stride
+  // (number of bytes between each position).
+  span<const float> in_positions;
+  size_t in_positions_stride;
+
+  // Optional input vertex normals array (3 float values per vertex) and
+  // stride. Output normals aren't normalized.
+  span<const float> in_normals;
+  size_t in_normals_stride;
+
+  // Output vertex positions array and stride.
+  span<float> out_positions;
+  size_t out_positions_stride;
+
+  // Output vertex normals array and stride, required if in_normals is
+  // provided.
+  span<float> out_normals;
+  size_t out_normals_stride;
+};
+}  // namespace geometry
+}  // namespace ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_MORPH_JOB_H_
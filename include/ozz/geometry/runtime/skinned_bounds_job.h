@@ -0,0 +1,119 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_OZZ_GEOMETRY_RUNTIME_SKINNED_BOUNDS_JOB_H_
+#define OZZ_OZZ_GEOMETRY_RUNTIME_SKINNED_BOUNDS_JOB_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/span.h"
+#include "ozz/geometry/runtime/export.h"
+
+namespace ozz {
+namespace math {
+struct Box;
+struct Float4x4;
+}  // namespace math
+namespace geometry {
+
+// Computes the model-space bounding box of a skinned mesh from a pose, without
+// skinning its vertices.
+// Each joint is associated with the box of the vertices it influences,
+// expressed in joint local space (aka vertices transformed by the joint
+// inverse bind pose matrix), see ComputeJointBoxes(). At runtime, every joint
+// box is transformed by its joint model-space matrix (as output by
+// LocalToModelJob), and the union of all transformed boxes is a conservative
+// bound of the skinned mesh. Indeed a linearly skinned vertex is a weighted
+// average of its positions transformed by each influencing joint, which all
+// lie in the influencing joints boxes.
+// Joint boxes are transformed as center and extents, which costs a few SIMD
+// operations per joint, so bounds can be updated for every animated instance
+// each frame, for culling.
+// The job does not own the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct OZZ_GEOMETRY_DLL SkinnedBoundsJob {
+  // Default constructor, initializes default values.
+  SkinnedBoundsJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // - if bound output is nullptr.
+  // - if joint_remaps isn't empty and is smaller than joint_boxes.
+  // - if joint_matrices is smaller than joint_boxes (without joint_remaps).
+  // - if joint_bounds isn't empty and is smaller than joint_boxes.
+  // Remapped joint indices are not validated, they must be in joint_matrices
+  // range.
+  bool Validate() const;
+
+  // Runs job's bounding task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Per joint boxes of the vertices they influence, in joint local space.
+  // Invalid boxes (see math::Box::is_valid()) are skipped, as for joints that
+  // don't influence any vertex.
+  span<const math::Box> joint_boxes;
+
+  // Joints model-space matrices, usually LocalToModelJob output.
+  span<const math::Float4x4> joint_matrices;
+
+  // Optional joint remapping table, giving for each joint box the index of
+  // its matrix in joint_matrices. This allows meshes that are influenced by a
+  // subset of the skeleton joints to store boxes for their joints only, like
+  // samples meshes joint_remaps.
+  span<const uint16_t> joint_remaps;
+
+  // Optional output of each joint box transformed to model-space. Boxes of
+  // skipped joints are set invalid.
+  span<math::Box> joint_bounds;
+
+  // Output model-space box of the skinned mesh. It is invalid if all joint
+  // boxes are.
+  math::Box* bound;
+};
+
+// Computes joint_boxes for SkinnedBoundsJob: for each joint, the box of the
+// vertices it influences, transformed by the joint inverse bind pose matrix.
+// _positions contains _vertex_count positions (3 floats) separated by
+// _positions_stride bytes. _joint_indices contains _influences_count joint
+// indices per vertex, separated by _joint_indices_stride bytes. Joint indices
+// index _inverse_bind_poses and _boxes, which must have the same size.
+// _joint_weights is optional. If provided, it contains _influences_count - 1
+// weights per vertex separated by _joint_weights_stride bytes, like
+// SkinningJob, and influences with a null weight are ignored.
+// Boxes of joints that don't influence any vertex are invalid.
+// Returns false if any buffer is too small or a joint index is out of range.
+OZZ_GEOMETRY_DLL bool ComputeJointBoxes(
+    int _vertex_count, int _influences_count, span<const float> _positions,
+    size_t _positions_stride, span<const uint16_t> _joint_indices,
+    size_t _joint_indices_stride, span<const float> _joint_weights,
+    size_t _joint_weights_stride,
+    span<const math::Float4x4> _inverse_bind_poses, span<math::Box> _boxes);
+}  // namespace geometry
+}  // namespace ozz
+#endif  // OZZ_OZZ_GEOMETRY_RUNTIME_SKINNED_BOUNDS_JOB_H_
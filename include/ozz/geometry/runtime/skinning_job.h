@@ -28,16 +28,23 @@
 #ifndef OZZ_OZZ_GEOMETRY_RUNTIME_SKINNING_JOB_H_
 #define OZZ_OZZ_GEOMETRY_RUNTIME_SKINNING_JOB_H_
 
+#include "ozz/base/job_plan.h"
+#include "ozz/base/parallel_for.h"
 #include "ozz/base/platform.h"
 #include "ozz/base/span.h"
 #include "ozz/geometry/runtime/export.h"
 
 namespace ozz {
 namespace math {
+struct DualQuaternion;
+struct Float3x4;
 struct Float4x4;
 }
 namespace geometry {
 
+// Forward declares morph target type.
+struct MorphTarget;
+
 // Provides per-vertex matrix palette skinning job implementation.
 // Skinning is the process of creating the association of skeleton joints with
 // some vertices of a mesh. Portions of the mesh's skin can normally be
@@ -72,6 +79,15 @@ namespace geometry {
 // joints matrices (see http://www.glprogramming.com/red/appendixf.html). This
 // code path is less efficient than the one without this matrices set, and
 // should only be used when input matrices have non uniform scaling or shearing.
+// Inputs can also be provided in compressed formats (half float positions,
+// octahedral encoded normals and tangents, 8 bits joint indices and weights),
+// which are decoded by the job on the fly, by small chunks of vertices. This
+// cuts input memory bandwidth, and saves decompressing meshes at load time.
+// Sparse morph targets can be applied to input positions and normals before
+// skinning, in the same pass (see morph_targets).
+// Big meshes can be skinned in parallel, either by splitting the job into
+// vertex ranges (see Range()), or by providing a parallel_for task scheduler
+// hook that Run() uses to dispatch vertices chunks.
 // The job does not owned the buffers (in/output) and will thus not delete them
 // during job's destruction.
 struct OZZ_GEOMETRY_DLL SkinningJob {
@@ -83,16 +99,41 @@ struct OZZ_GEOMETRY_DLL SkinningJob {
   // - if any range is invalid. See each range description.
   // - if normals are provided but positions aren't.
   // - if tangents are provided but normals aren't.
+  // - if not exactly one of joint_matrices, joint_affine_matrices and
+  // joint_dual_quaternions is provided, or if inverse transpose matrices don't
+  // match the type of joint matrices.
   // - if no output is provided while an input is. For example, if input normals
   // are provided, then output normals must also.
+  // - if both float and compressed formats of an input are provided.
+  // - if compressed joint indices or weights are used with more than
+  // kMaxCompressedInfluences influences.
+  // - if morph_weights is smaller than morph_targets, or if a morph target
+  // deltas are smaller than its indices.
+  // - if parallel_for is set and parallel_grain isn't greater than 0.
   bool Validate() const;
 
   // Runs job's skinning task.
   // The job is validated before any operation is performed, see Validate() for
   // more details.
+  // If parallel_for is set, vertices are skinned by chunks of parallel_grain
+  // vertices, dispatched through parallel_for.
   // Returns false if *this job is not valid.
   bool Run() const;
 
+  // Returns a copy of *this job restricted to vertices [_begin, _begin +
+  // _count[. Joint indices, weights, input and output vertex ranges are offset
+  // to _begin vertex according to their stride, as well as
+  // morph_first_vertex. All other parameters are copied. Jobs of disjoint
+  // ranges write to disjoint output vertices, so they can be run
+  // concurrently.
+  // _begin and _count are clamped to the vertices of *this job.
+  SkinningJob Range(int _begin, int _count) const;
+
+  // Task function and task scheduler hook, see ozz/base/parallel_for.h. Each
+  // task skins a chunk of vertices.
+  typedef ozz::ParallelForTask ParallelForTask;
+  typedef ozz::ParallelForHook ParallelFor;
+
   // Number of vertices to transform. All input and output arrays must store at
   // least this number of vertices.
   int vertex_count;
@@ -121,13 +162,48 @@ struct OZZ_GEOMETRY_DLL SkinningJob {
   // fall into a more costly code path in the skinning algorithm.
   span<const math::Float4x4> joint_inverse_transpose_matrices;
 
+  // Alternative array of affine 3x4 matrices for each joint, as output by
+  // LocalToModelJob::affine_output. They save 25% of the memory read while
+  // preparing each vertex transformation. Exactly one of joint_matrices and
+  // joint_affine_matrices must be provided.
+  span<const math::Float3x4> joint_affine_matrices;
+
+  // Optional array of affine inverse transposed matrices for each joint, see
+  // joint_inverse_transpose_matrices. Can only be used with
+  // joint_affine_matrices.
+  span<const math::Float3x4> joint_affine_inverse_transpose_matrices;
+
+  // Alternative array of dual quaternions for each joint, used for dual
+  // quaternion skinning. Blending dual quaternions avoids the candy wrapper
+  // and volume loss artifacts of linear blend skinning, and halves palette
+  // bandwidth compared to Float4x4. Dual quaternions only represent rigid
+  // transformations: joint scale isn't supported, and inverse transpose
+  // matrices can't be used (normals are rotated as positions).
+  span<const math::DualQuaternion> joint_dual_quaternions;
+
+  // Maximum number of influences per vertex supported by compressed joint
+  // indices and weights.
+  static const int kMaxCompressedInfluences = 64;
+
   // Array of joints indices. This array is used to indexes matrices in joints
   // array.
   // Each vertex has influences_max number of indices, meaning that the size of
   // this array must be at least influences_max * vertex_count.
   span<const uint16_t> joint_indices;
+
+  // Alternative 8 bits joint indices array, for palettes of up to 256 joints.
+  // It uses joint_indices_stride.
+  span<const uint8_t> joint_indices8;
   size_t joint_indices_stride;
 
+  // Optional joint indices remapping table, indexed by joint indices, giving
+  // the index of the joint matrix to use instead. This redirects influences of
+  // some joints to others without modifying mesh data, like for skeleton
+  // levels of detail (see SkeletonLOD::RemapPalette()). Indices are remapped
+  // by small chunks of vertices, like compressed inputs are decoded.
+  // If not empty, it must contain an entry for every joint index.
+  span<const uint16_t> joint_remaps;
+
   // Array of joints weights. This array is used to associate a weight to every
   // joint that influences a vertex. The number of weights required per vertex
   // is "influences_max - 1". The weight for the last joint (for each vertex) is
@@ -136,24 +212,41 @@ struct OZZ_GEOMETRY_DLL SkinningJob {
   // Each vertex has (influences_max - 1) number of weights, meaning that the
   // size of this array must be at least (influences_max - 1)* vertex_count.
   span<const float> joint_weights;
+
+  // Alternative 8 bits unsigned normalized joint weights array, weight being
+  // value / 255. It uses joint_weights_stride.
+  span<const uint8_t> joint_weights8;
   size_t joint_weights_stride;
 
   // Input vertex positions array (3 float values per vertex) and stride (number
   // of bytes between each position).
   // Array length must be at least vertex_count * in_positions_stride.
   span<const float> in_positions;
+
+  // Alternative input vertex positions array, with 3 half float values per
+  // vertex. It uses in_positions_stride.
+  span<const uint16_t> in_half_positions;
   size_t in_positions_stride;
 
   // Input vertex normals (3 float values per vertex) array and stride (number
   // of bytes between each normal).
   // Array length must be at least vertex_count * in_normals_stride.
   span<const float> in_normals;
+
+  // Alternative input vertex normals array, octahedral encoded as 2 signed
+  // normalized 16 bits values per vertex (value / 32767). Decoded normals are
+  // normalized. It uses in_normals_stride.
+  span<const int16_t> in_oct_normals;
   size_t in_normals_stride;
 
   // Input vertex tangents (3 float values per vertex) array and stride (number
   // of bytes between each tangent).
   // Array length must be at least vertex_count * in_tangents_stride.
   span<const float> in_tangents;
+
+  // Alternative input vertex tangents array, octahedral encoded like
+  // in_oct_normals. It uses in_tangents_stride.
+  span<const int16_t> in_oct_tangents;
   size_t in_tangents_stride;
 
   // Output vertex positions (3 float values per vertex) array and stride
@@ -179,6 +272,48 @@ struct OZZ_GEOMETRY_DLL SkinningJob {
   // Array length must be at least vertex_count * out_tangents_stride.
   span<float> out_tangents;
   size_t out_tangents_stride;
+
+  // Writes output vertices with non-temporal (streaming) stores, which bypass
+  // the caches. This suits vertex buffers that are written once and never
+  // read back by the cpu, like mapped gpu-visible (write-combined) memory.
+  // Output only requires its natural 4 bytes float alignment, but contiguous
+  // (packed or interleaved) outputs let the cpu combine writes to full cache
+  // lines. Every chunk ends with a store fence, so output is complete once
+  // Run() returns. Defaults to false, as cached stores are faster when output
+  // is read back soon after.
+  bool streaming_output;
+
+  // Optional morph targets, applied to input positions and normals before
+  // skinning, see MorphJob. Morphing is fused to the skinning loop: vertices
+  // are morphed by small chunks to stack buffers, which are then skinned, so
+  // morphed vertices are never written back to memory. Morph targets whose
+  // weight is 0 are skipped, and the job falls back to the unmorphed path if
+  // they're all 0. Tangents aren't morphed.
+  span<const MorphTarget> morph_targets;
+
+  // Weight of each morph target, required if morph_targets isn't empty.
+  span<const float> morph_weights;
+
+  // Index of the job first vertex, as indexed by morph targets indices.
+  // Range() offsets it. Default is 0.
+  int morph_first_vertex;
+
+  // Optional task scheduler hook. If nullptr (default), vertices are skinned
+  // serially by the calling thread.
+  ParallelFor parallel_for;
+
+  // User data provided to parallel_for.
+  void* parallel_for_user_data;
+
+  // Number of vertices per chunk when skinning with parallel_for. Chunks should
+  // be big enough to amortize task scheduling. Default is 4096.
+  int parallel_grain;
+
+ private:
+  friend class ozz::JobPlan<SkinningJob>;
+
+  // Runs the valid job, without validating it. See JobPlan.
+  void RunUnchecked() const;
 };
 }  // namespace geometry
 }  // namespace ozz
@@ -131,7 +131,7 @@ class AttachSampleApplication : public ozz::sample::Application {
     models_.resize(num_joints);
 
     // Allocates a context that matches animation requirements.
-    context_.Resize(num_joints);
+    context_.Resize(num_joints, animation_.cubic());
 
     // Finds the joint where the object should be attached.
     attachment_ = FindJoint(skeleton_, "LeftHandMiddle1");
@@ -100,7 +100,7 @@ class BakedSampleApplication : public ozz::sample::Application {
     models_.resize(num_joints);
 
     // Allocates a context that matches animation requirements.
-    context_.Resize(num_joints);
+    context_.Resize(num_joints, animation_.cubic());
 
     // Look for a "camera" joint.
     for (int i = 0; i < num_joints; i++) {
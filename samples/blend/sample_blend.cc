@@ -213,7 +213,7 @@ class BlendSampleApplication : public ozz::sample::Application {
       sampler.locals.resize(num_soa_joints);
 
       // Allocates a context that matches animation requirements.
-      sampler.context.Resize(num_joints);
+      sampler.context.Resize(num_joints, sampler.animation.cubic());
     }
 
     // Allocates local space runtime buffers of blended data.
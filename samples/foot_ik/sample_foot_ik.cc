@@ -552,7 +552,7 @@ class FootIKSampleApplication : public ozz::sample::Application {
     models_.resize(num_joints);
 
     // Allocates a context that matches animation requirements.
-    context_.Resize(num_joints);
+    context_.Resize(num_joints, animation_.cubic());
 
     // Finds left and right joints.
     if (!SetupLeg(skeleton_, kLeftJointNames, &legs_setup_[kLeft]) ||
@@ -64,6 +64,13 @@ OZZ_OPTIONS_DECLARE_INT(
 
 OZZ_OPTIONS_DECLARE_BOOL(render, "Enables sample redering.", true, false);
 
+OZZ_OPTIONS_DECLARE_STRING(
+    profile,
+    "Exports timing statistics (frame, update, render and named records) to "
+    "this file when the sample exits, as json if file extension is \".json\", "
+    "as csv otherwise. Statistics cover the most recent frames.",
+    "", false);
+
 namespace {
 // Screen resolution presets.
 const ozz::sample::Resolution resolution_presets[] = {
@@ -104,9 +111,9 @@ Application::Application()
       show_axes_(true),
       capture_video_(false),
       capture_screenshot_(false),
-      fps_(New<Record>(128)),
-      update_time_(New<Record>(128)),
-      render_time_(New<Record>(128)),
+      fps_(New<Record>(128, "frame")),
+      update_time_(New<Record>(128, "update")),
+      render_time_(New<Record>(128, "render")),
       resolution_(resolution_presets[0]) {
 #ifndef NDEBUG
   // Assert presets are correctly sorted.
@@ -232,6 +239,23 @@ int Application::Run(int _argc, const char** _argv, const char* _version,
     success = Loop();
   }
 
+  // Exports timing statistics.
+  if (success && *OPTIONS_profile.value() != 0) {
+    ozz::vector<const Record*> records = {fps_.get(), update_time_.get(),
+                                          render_time_.get()};
+    for (const auto& record : profile_records_) {
+      records.push_back(record.get());
+    }
+    if (ExportStatistics(make_span(records), OPTIONS_profile)) {
+      log::Out() << "Timing statistics exported to \"" << OPTIONS_profile
+                 << "\"." << std::endl;
+    } else {
+      log::Err() << "Failed to export timing statistics to \""
+                 << OPTIONS_profile << "\"." << std::endl;
+      success = false;
+    }
+  }
+
   // Notifies that an error occurred.
   if (!success) {
     log::Err() << "An error occurred during sample execution." << std::endl;
@@ -571,6 +595,15 @@ bool Application::FrameworkGui() {
                           render_time_->record_end());
         }
       }
+      // Named records.
+      for (const auto& record : profile_records_) {
+        Record::Statistics statistics = record->GetStatistics();
+        std::snprintf(label, sizeof(label), "%s: %.3f ms", record->name(),
+                      statistics.mean);
+        im_gui->DoGraph(label, 0.f, statistics.max, statistics.latest,
+                        record->cursor(), record->record_begin(),
+                        record->record_end());
+      }
     }
   }
 
@@ -724,6 +757,16 @@ math::Float2 Application::WorldToScreen(const math::Float3& _world) const {
   return ret;
 }
 
+Record* Application::ProfileRecord(const char* _name) {
+  for (const auto& record : profile_records_) {
+    if (std::strcmp(record->name(), _name) == 0) {
+      return record.get();
+    }
+  }
+  profile_records_.push_back(make_unique<Record>(128, _name));
+  return profile_records_.back().get();
+}
+
 void Application::ResizeCbk(int _width, int _height) {
   // Stores new resolution settings.
   application_->resolution_.width = _width;
@@ -31,6 +31,7 @@
 #include <cstddef>
 
 #include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/memory/unique_ptr.h"
 
 namespace ozz {
@@ -83,6 +84,11 @@ class Application {
   // Allows application to convert from world space to screen coordinates.
   math::Float2 WorldToScreen(const math::Float3& _world) const;
 
+  // Gets the timing record named _name, creating it if it doesn't exist yet.
+  // Named records allow to profile specific jobs (using a Profiler). They are
+  // displayed with framework statistics, and exported with --profile option.
+  Record* ProfileRecord(const char* _name);
+
  private:
   // Provides initialization event to the inheriting application. Called while
   // the help screen is being displayed.
@@ -238,6 +244,9 @@ class Application {
   unique_ptr<Record> update_time_;
   unique_ptr<Record> render_time_;
 
+  // Named timing records, see ProfileRecord().
+  ozz::vector<unique_ptr<Record>> profile_records_;
+
   // Current screen resolution.
   Resolution resolution_;
 
@@ -132,6 +132,29 @@ bool RendererImpl::Initialize() {
     }
   }
 
+  // Instantiate skinned ambient rendering shader, used for GPU skinning. It's
+  // optional, as skinning matrices might not fit in uniform storage. Some
+  // uniform vectors are kept for model and view-projection matrices.
+  GLint max_uniform_vectors = 0;
+#if defined(GL_MAX_VERTEX_UNIFORM_COMPONENTS)
+  GL(GetIntegerv(GL_MAX_VERTEX_UNIFORM_COMPONENTS, &max_uniform_vectors));
+  max_uniform_vectors /= 4;
+#elif defined(GL_MAX_VERTEX_UNIFORM_VECTORS)
+  GL(GetIntegerv(GL_MAX_VERTEX_UNIFORM_VECTORS, &max_uniform_vectors));
+#endif
+  const int max_skinning_joints =
+      math::Min((max_uniform_vectors - 16) / 3, 1024);
+  if (max_skinning_joints > 0) {
+    skinned_ambient_shader = SkinnedAmbientShader::Build(max_skinning_joints);
+
+    // Instanced version shares the same uniform storage between all the
+    // palettes of a draw call.
+    if (GL_ARB_instanced_arrays_supported) {
+      skinned_ambient_shader_instanced =
+          SkinnedAmbientShaderInstanced::Build(max_skinning_joints);
+    }
+  }
+
   // Instantiate instanced ambient rendering shader.
   points_shader = PointsShader::Build();
   if (!points_shader) {
@@ -601,7 +624,7 @@ bool RendererImpl::DrawPosture(const ozz::animation::Skeleton& _skeleton,
   }
 
   // Convert matrices to uniforms.
-  const int max_skeleton_pieces = animation::Skeleton::kMaxJoints * 2;
+  const int max_skeleton_pieces = _skeleton.num_joints() * 2;
   const size_t max_uniforms_size = max_skeleton_pieces * 2 * 16 * sizeof(float);
   float* uniforms =
       static_cast<float*>(scratch_buffer_.Resize(max_uniforms_size));
@@ -1415,6 +1438,13 @@ bool RendererImpl::DrawSkinnedMesh(
     return DrawMesh(_mesh, _transform, _options);
   }
 
+  // Skins on the GPU if requested and supported.
+  if (_options.gpu_skinning &&
+      CanSkinOnGpu(_mesh, _skinning_matrices, _options)) {
+    return DrawSkinnedMesh_Gpu(_mesh, _skinning_matrices, _transform,
+                               _options);
+  }
+
   if (_options.wireframe) {
 #ifndef EMSCRIPTEN
     GL(PolygonMode(GL_FRONT_AND_BACK, GL_LINE));
@@ -1475,12 +1505,45 @@ bool RendererImpl::DrawSkinnedMesh(
 
     // Setup skinning matrices, that came from the animation stage before being
     // multiplied by inverse model-space bind-pose.
-    skinning_job.joint_matrices = _skinning_matrices;
+    // If the part has a compact palette, the matrices it uses are gathered to
+    // a contiguous array indexed by 8 bits joint indices. This reduces both
+    // palette and indices memory reads.
+    // Rigid parts are transformed by their single joint matrix. Skinning job
+    // reads the same joint index for every vertex (null stride), and neither
+    // per-vertex indices nor weights are read from the mesh.
+    if (part.rigid()) {
+      if (part.rigid_joint >= static_cast<int>(_skinning_matrices.size())) {
+        return false;
+      }
+      static const uint8_t kRigidJointIndex = 0;
+      part_skinning_matrices_.assign(1, _skinning_matrices[part.rigid_joint]);
+      skinning_job.joint_matrices = make_span(part_skinning_matrices_);
+      skinning_job.influences_count = 1;
+      skinning_job.joint_indices8 = span<const uint8_t>(kRigidJointIndex);
+      skinning_job.joint_indices_stride = 0;
+    } else if (!part.joint_palette.empty()) {
+      part_skinning_matrices_.resize(part.joint_palette.size());
+      for (size_t j = 0; j < part.joint_palette.size(); ++j) {
+        const uint16_t joint = part.joint_palette[j];
+        if (joint >= _skinning_matrices.size()) {
+          return false;
+        }
+        part_skinning_matrices_[j] = _skinning_matrices[joint];
+      }
+      skinning_job.joint_matrices = make_span(part_skinning_matrices_);
 
-    // Setup joint's indices.
-    skinning_job.joint_indices = make_span(part.joint_indices);
-    skinning_job.joint_indices_stride =
-        sizeof(uint16_t) * part_influences_count;
+      // Setup joint's local indices.
+      skinning_job.joint_indices8 = make_span(part.joint_indices8);
+      skinning_job.joint_indices_stride =
+          sizeof(uint8_t) * part_influences_count;
+    } else {
+      skinning_job.joint_matrices = _skinning_matrices;
+
+      // Setup joint's indices.
+      skinning_job.joint_indices = make_span(part.joint_indices);
+      skinning_job.joint_indices_stride =
+          sizeof(uint16_t) * part_influences_count;
+    }
 
     // Setup joint's weights.
     if (part_influences_count > 1) {
@@ -1716,6 +1779,288 @@ bool RendererImpl::DrawSkinnedMesh(
   return true;
 }
 
+bool RendererImpl::CanSkinOnGpu(const Mesh& _mesh,
+                                const span<math::Float4x4> _skinning_matrices,
+                                const Options& _options) const {
+  // Debug rendering and texturing rely on CPU skinning outputs and shaders.
+  if (!skinned_ambient_shader || _options.texture || _options.vertices ||
+      _options.normals || _options.tangents || _options.binormals) {
+    return false;
+  }
+
+  // Skinning matrices must fit in the shader uniforms.
+  if (_skinning_matrices.size() < static_cast<size_t>(_mesh.num_joints()) ||
+      _mesh.num_joints() > skinned_ambient_shader->max_joints()) {
+    return false;
+  }
+
+  return _mesh.max_influences_count() <= SkinnedAmbientShader::kMaxInfluences;
+}
+
+namespace {
+// Vertex buffer layout of a mesh skinned on the GPU. Vertices aren't
+// transformed, so mesh data are directly copied to the vbo. Joint indices and
+// weights are expanded to 4 influences per vertex, including the last weight
+// that SkinningJob restores.
+struct GpuSkinnedLayout {
+  explicit GpuSkinnedLayout(int _vertex_count) {
+    const int kInfluences = SkinnedAmbientShader::kMaxInfluences;
+    positions_offset = 0;
+    positions_stride = sizeof(float) * 3;
+    normals_offset = _vertex_count * positions_stride;
+    normals_stride = sizeof(float) * 3;
+    colors_offset = normals_offset + _vertex_count * normals_stride;
+    colors_stride = sizeof(uint8_t) * 4;
+    joints_offset = colors_offset + _vertex_count * colors_stride;
+    joints_stride = sizeof(uint16_t) * kInfluences;
+    weights_offset = joints_offset + _vertex_count * joints_stride;
+    weights_stride = sizeof(float) * kInfluences;
+    size = weights_offset + _vertex_count * weights_stride;
+  }
+  GLsizei positions_offset;
+  GLsizei positions_stride;
+  GLsizei normals_offset;
+  GLsizei normals_stride;
+  GLsizei colors_offset;
+  GLsizei colors_stride;
+  GLsizei joints_offset;
+  GLsizei joints_stride;
+  GLsizei weights_offset;
+  GLsizei weights_stride;
+  GLsizei size;
+};
+
+// Fills _vbo_map with _mesh vertices, according to _layout.
+void FillGpuSkinnedVertices(const Mesh& _mesh,
+                            const Renderer::Options& _options,
+                            const GpuSkinnedLayout& _layout, void* _vbo_map) {
+  const int kInfluences = SkinnedAmbientShader::kMaxInfluences;
+  size_t processed_vertex_count = 0;
+  for (size_t i = 0; i < _mesh.parts.size(); ++i) {
+    const ozz::sample::Mesh::Part& part = _mesh.parts[i];
+    const size_t part_vertex_count = part.vertex_count();
+    const int part_influences_count = part.influences_count();
+
+    // Positions.
+    memcpy(ozz::PointerStride(_vbo_map, _layout.positions_offset +
+                                            processed_vertex_count *
+                                                _layout.positions_stride),
+           array_begin(part.positions),
+           part_vertex_count * _layout.positions_stride);
+
+    // Normals, or default ones.
+    float* normals = reinterpret_cast<float*>(ozz::PointerStride(
+        _vbo_map, _layout.normals_offset +
+                      processed_vertex_count * _layout.normals_stride));
+    if (part.normals.size() / ozz::sample::Mesh::Part::kNormalsCpnts ==
+        part_vertex_count) {
+      memcpy(normals, array_begin(part.normals),
+             part_vertex_count * _layout.normals_stride);
+    } else {
+      for (size_t j = 0; j < part_vertex_count; ++j) {
+        normals[j * 3 + 0] = 0.f;
+        normals[j * 3 + 1] = 1.f;
+        normals[j * 3 + 2] = 0.f;
+      }
+    }
+
+    // Colors, or default ones.
+    uint8_t* colors = reinterpret_cast<uint8_t*>(ozz::PointerStride(
+        _vbo_map, _layout.colors_offset +
+                      processed_vertex_count * _layout.colors_stride));
+    if (_options.colors &&
+        part_vertex_count ==
+            part.colors.size() / ozz::sample::Mesh::Part::kColorsCpnts) {
+      memcpy(colors, array_begin(part.colors),
+             part_vertex_count * _layout.colors_stride);
+    } else {
+      memset(colors, 255, part_vertex_count * _layout.colors_stride);
+    }
+
+    // Joint indices and weights.
+    uint16_t* joints = reinterpret_cast<uint16_t*>(ozz::PointerStride(
+        _vbo_map, _layout.joints_offset +
+                      processed_vertex_count * _layout.joints_stride));
+    float* weights = reinterpret_cast<float*>(ozz::PointerStride(
+        _vbo_map, _layout.weights_offset +
+                      processed_vertex_count * _layout.weights_stride));
+    for (size_t j = 0; j < part_vertex_count; ++j) {
+      float weight_sum = 0.f;
+      for (int k = 0; k < kInfluences; ++k) {
+        float weight = 0.f;
+        uint16_t joint = 0;
+        if (k < part_influences_count) {
+          joint = part.joint_indices[j * part_influences_count + k];
+          weight =
+              k < part_influences_count - 1
+                  ? part.joint_weights[j * (part_influences_count - 1) + k]
+                  : 1.f - weight_sum;
+          weight_sum += weight;
+        }
+        joints[j * kInfluences + k] = joint;
+        weights[j * kInfluences + k] = weight;
+      }
+    }
+
+    processed_vertex_count += part_vertex_count;
+  }
+}
+}  // namespace
+
+bool RendererImpl::DrawSkinnedMesh_Gpu(
+    const Mesh& _mesh, const span<math::Float4x4> _skinning_matrices,
+    const ozz::math::Float4x4& _transform, const Options& _options) {
+  if (!_options.triangles) {
+    return true;
+  }
+
+  const GpuSkinnedLayout layout(_mesh.vertex_count());
+  void* vbo_map = scratch_buffer_.Resize(layout.size);
+  FillGpuSkinnedVertices(_mesh, _options, layout, vbo_map);
+
+  if (_options.wireframe) {
+#ifndef EMSCRIPTEN
+    GL(PolygonMode(GL_FRONT_AND_BACK, GL_LINE));
+#endif  // EMSCRIPTEN
+  }
+
+  GL(BindBuffer(GL_ARRAY_BUFFER, dynamic_array_bo_));
+  GL(BufferData(GL_ARRAY_BUFFER, layout.size, nullptr, GL_STREAM_DRAW));
+  GL(BufferSubData(GL_ARRAY_BUFFER, 0, layout.size, vbo_map));
+
+  skinned_ambient_shader->Bind(
+      _transform, camera()->view_proj(), layout.positions_stride,
+      layout.positions_offset, layout.normals_stride, layout.normals_offset,
+      layout.colors_stride, layout.colors_offset, layout.joints_stride,
+      layout.joints_offset, layout.weights_stride, layout.weights_offset,
+      {_skinning_matrices.begin(), static_cast<size_t>(_mesh.num_joints())});
+
+  GL(BindBuffer(GL_ELEMENT_ARRAY_BUFFER, dynamic_index_bo_));
+  const Mesh::TriangleIndices& indices = _mesh.triangle_indices;
+  GL(BufferData(GL_ELEMENT_ARRAY_BUFFER,
+                indices.size() * sizeof(Mesh::TriangleIndices::value_type),
+                array_begin(indices), GL_STREAM_DRAW));
+  GL(DrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices.size()),
+                  GL_UNSIGNED_SHORT, 0));
+
+  GL(BindBuffer(GL_ARRAY_BUFFER, 0));
+  GL(BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+  skinned_ambient_shader->Unbind();
+
+  if (_options.wireframe) {
+#ifndef EMSCRIPTEN
+    GL(PolygonMode(GL_FRONT_AND_BACK, GL_FILL));
+#endif  // EMSCRIPTEN
+  }
+
+  return true;
+}
+
+bool RendererImpl::DrawSkinnedMeshes(
+    const Mesh& _mesh, const span<math::Float4x4> _skinning_matrices,
+    const span<const math::Float4x4> _transforms, const Options& _options) {
+  const size_t num_joints = static_cast<size_t>(_mesh.num_joints());
+  const size_t num_instances = _transforms.size();
+  if (_skinning_matrices.size() < num_instances * num_joints) {
+    return false;
+  }
+  if (num_instances == 0) {
+    return true;
+  }
+
+  // Falls back to drawing instances one by one if instanced skinning isn't
+  // supported.
+  if (_options.skip_skinning || !_mesh.skinned() ||
+      !skinned_ambient_shader_instanced ||
+      !CanSkinOnGpu(_mesh, _skinning_matrices, _options)) {
+    bool success = true;
+    for (size_t i = 0; success && i < num_instances; ++i) {
+      success &= DrawSkinnedMesh(
+          _mesh, _skinning_matrices.subspan(i * num_joints, num_joints),
+          _transforms[i], _options);
+    }
+    return success;
+  }
+
+  if (!_options.triangles) {
+    return true;
+  }
+
+  // Number of instances whose palettes fit in the shader uniforms.
+  const size_t batch_size = math::Min(
+      num_instances,
+      static_cast<size_t>(skinned_ambient_shader_instanced->max_joints()) /
+          num_joints);
+
+  // Vbo stores mesh vertices, followed by all instances model matrices, and
+  // palette offsets of a batch, which are the same for all batches.
+  const GpuSkinnedLayout layout(_mesh.vertex_count());
+  const GLsizei models_offset = layout.size;
+  const GLsizei models_size =
+      static_cast<GLsizei>(num_instances * sizeof(math::Float4x4));
+  const GLsizei palettes_offset = models_offset + models_size;
+  const GLsizei palettes_size =
+      static_cast<GLsizei>(batch_size * sizeof(float));
+  const GLsizei vbo_size = palettes_offset + palettes_size;
+  void* vbo_map = scratch_buffer_.Resize(vbo_size);
+  FillGpuSkinnedVertices(_mesh, _options, layout, vbo_map);
+  float* palettes =
+      reinterpret_cast<float*>(ozz::PointerStride(vbo_map, palettes_offset));
+  for (size_t i = 0; i < batch_size; ++i) {
+    palettes[i] = static_cast<float>(i * num_joints);
+  }
+
+  if (_options.wireframe) {
+#ifndef EMSCRIPTEN
+    GL(PolygonMode(GL_FRONT_AND_BACK, GL_LINE));
+#endif  // EMSCRIPTEN
+  }
+
+  GL(BindBuffer(GL_ARRAY_BUFFER, dynamic_array_bo_));
+  GL(BufferData(GL_ARRAY_BUFFER, vbo_size, nullptr, GL_STREAM_DRAW));
+  GL(BufferSubData(GL_ARRAY_BUFFER, 0, layout.size, vbo_map));
+  GL(BufferSubData(GL_ARRAY_BUFFER, models_offset, models_size,
+                   _transforms.data()));
+  GL(BufferSubData(GL_ARRAY_BUFFER, palettes_offset, palettes_size,
+                   palettes));
+
+  GL(BindBuffer(GL_ELEMENT_ARRAY_BUFFER, dynamic_index_bo_));
+  const Mesh::TriangleIndices& indices = _mesh.triangle_indices;
+  GL(BufferData(GL_ELEMENT_ARRAY_BUFFER,
+                indices.size() * sizeof(Mesh::TriangleIndices::value_type),
+                array_begin(indices), GL_STREAM_DRAW));
+
+  // Draws all instances of a batch at once, with their palettes uploaded to
+  // the shader uniforms.
+  for (size_t begin = 0; begin < num_instances; begin += batch_size) {
+    const size_t count = math::Min(batch_size, num_instances - begin);
+    skinned_ambient_shader_instanced->Bind(
+        static_cast<GLsizei>(models_offset + begin * sizeof(math::Float4x4)),
+        palettes_offset, camera()->view_proj(), layout.positions_stride,
+        layout.positions_offset, layout.normals_stride, layout.normals_offset,
+        layout.colors_stride, layout.colors_offset, layout.joints_stride,
+        layout.joints_offset, layout.weights_stride, layout.weights_offset);
+    skinned_ambient_shader_instanced->UploadPalettes(
+        _skinning_matrices.subspan(begin * num_joints, count * num_joints));
+    GL(DrawElementsInstanced_(GL_TRIANGLES,
+                              static_cast<GLsizei>(indices.size()),
+                              GL_UNSIGNED_SHORT, 0,
+                              static_cast<GLsizei>(count)));
+  }
+
+  GL(BindBuffer(GL_ARRAY_BUFFER, 0));
+  GL(BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+  skinned_ambient_shader_instanced->Unbind();
+
+  if (_options.wireframe) {
+#ifndef EMSCRIPTEN
+    GL(PolygonMode(GL_FRONT_AND_BACK, GL_FILL));
+#endif  // EMSCRIPTEN
+  }
+
+  return true;
+}
+
 // Helper macro used to initialize extension function pointer.
 #define OZZ_INIT_GL_EXT_N(_fct, _fct_name, _fct_type, _success)               \
   do {                                                                        \
@@ -95,6 +95,8 @@ class SkeletonShader;
 class AmbientShader;
 class AmbientTexturedShader;
 class AmbientShaderInstanced;
+class SkinnedAmbientShader;
+class SkinnedAmbientShaderInstanced;
 class GlImmediateRenderer;
 
 // Implements Renderer interface.
@@ -146,6 +148,11 @@ class RendererImpl : public Renderer {
                                const ozz::math::Float4x4& _transform,
                                const Options& _options = Options());
 
+  virtual bool DrawSkinnedMeshes(
+      const Mesh& _mesh, const span<math::Float4x4> _skinning_matrices,
+      const span<const math::Float4x4> _transforms,
+      const Options& _options = Options());
+
   virtual bool DrawMesh(const Mesh& _mesh,
                         const ozz::math::Float4x4& _transform,
                         const Options& _options = Options());
@@ -198,6 +205,17 @@ class RendererImpl : public Renderer {
   // Return true if initialization succeeded.
   bool InitCheckeredTexture();
 
+  // Tests if _mesh can be skinned on the GPU with _options.
+  bool CanSkinOnGpu(const Mesh& _mesh,
+                    const span<math::Float4x4> _skinning_matrices,
+                    const Options& _options) const;
+
+  // Draw skinned mesh GPU skinning implementation.
+  bool DrawSkinnedMesh_Gpu(const Mesh& _mesh,
+                           const span<math::Float4x4> _skinning_matrices,
+                           const ozz::math::Float4x4& _transform,
+                           const Options& _options);
+
   // Draw posture internal non-instanced rendering fall back implementation.
   void DrawPosture_Impl(const ozz::math::Float4x4& _transform,
                         const float* _uniforms, int _instance_count,
@@ -212,6 +230,10 @@ class RendererImpl : public Renderer {
   // execution.
   ozz::vector<ozz::math::Float4x4> prealloc_models_;
 
+  // Compact skinning matrices of the mesh part being skinned, gathered
+  // according to part joint_palette during DrawSkinnedMesh execution.
+  ozz::vector<ozz::math::Float4x4> part_skinning_matrices_;
+
   // Application camera that provides rendering matrices.
   Camera* camera_;
 
@@ -247,6 +269,9 @@ class RendererImpl : public Renderer {
   ozz::unique_ptr<AmbientShader> ambient_shader;
   ozz::unique_ptr<AmbientTexturedShader> ambient_textured_shader;
   ozz::unique_ptr<AmbientShaderInstanced> ambient_shader_instanced;
+  ozz::unique_ptr<SkinnedAmbientShader> skinned_ambient_shader;
+  ozz::unique_ptr<SkinnedAmbientShaderInstanced>
+      skinned_ambient_shader_instanced;
   ozz::unique_ptr<PointsShader> points_shader;
 
   // Checkered texture
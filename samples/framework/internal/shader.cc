@@ -702,6 +702,247 @@ void AmbientShader::Bind(const math::Float4x4& _model,
   GL(UniformMatrix4fv(mvp_uniform, 1, false, values));
 }
 
+namespace {
+// Uploads skinning matrices to _uniform vec4 array, as 3 rows of their affine
+// part.
+void UploadSkinningRows(GLint _uniform,
+                        span<const math::Float4x4> _skinning_matrices,
+                        ozz::vector<float>* _rows) {
+  _rows->resize(_skinning_matrices.size() * 12);
+  for (size_t i = 0; i < _skinning_matrices.size(); ++i) {
+    math::SimdFloat4 rows[4];
+    math::Transpose4x4(_skinning_matrices[i].cols, rows);
+    math::StorePtrU(rows[0], &(*_rows)[i * 12 + 0]);
+    math::StorePtrU(rows[1], &(*_rows)[i * 12 + 4]);
+    math::StorePtrU(rows[2], &(*_rows)[i * 12 + 8]);
+  }
+  GL(Uniform4fv(_uniform, static_cast<GLsizei>(_skinning_matrices.size() * 3),
+                array_begin(*_rows)));
+}
+}  // namespace
+
+ozz::unique_ptr<SkinnedAmbientShader> SkinnedAmbientShader::Build(
+    int _max_joints) {
+  char max_joints[64];
+  std::snprintf(max_joints, sizeof(max_joints), "#define MAX_JOINTS %d\n",
+                _max_joints);
+
+  // Skinning matrices are stored as 3 rows of their affine part. World matrix
+  // is the blend of influencing joints matrices, so normal matrix is computed
+  // from it by the uber shader.
+  const char* vs_skinning_world_matrix =
+      "uniform mat4 u_mw;\n"
+      "uniform vec4 u_joints[MAX_JOINTS * 3];\n"
+      "attribute vec4 a_joints;\n"
+      "attribute vec4 a_weights;\n"
+      "vec4 BlendRow(ivec4 _joints, int _row) {\n"
+      "  return u_joints[_joints.x + _row] * a_weights.x +\n"
+      "         u_joints[_joints.y + _row] * a_weights.y +\n"
+      "         u_joints[_joints.z + _row] * a_weights.z +\n"
+      "         u_joints[_joints.w + _row] * a_weights.w;\n"
+      "}\n"
+      "mat4 GetWorldMatrix() {\n"
+      "  ivec4 joints = ivec4(a_joints) * 3;\n"
+      "  vec4 r0 = BlendRow(joints, 0);\n"
+      "  vec4 r1 = BlendRow(joints, 1);\n"
+      "  vec4 r2 = BlendRow(joints, 2);\n"
+      "  mat4 skinning_matrix = mat4(\n"
+      "    r0.x, r1.x, r2.x, 0.,\n"
+      "    r0.y, r1.y, r2.y, 0.,\n"
+      "    r0.z, r1.z, r2.z, 0.,\n"
+      "    r0.w, r1.w, r2.w, 1.);\n"
+      "  return u_mw * skinning_matrix;\n"
+      "}\n";
+  const char* vs[] = {kPlatformSpecivicVSHeader, max_joints, kPassNoUv,
+                      vs_skinning_world_matrix, kShaderUberVS};
+  const char* fs[] = {kPlatformSpecivicFSHeader, kShaderAmbientFct,
+                      kShaderAmbientFS};
+
+  ozz::unique_ptr<SkinnedAmbientShader> shader =
+      make_unique<SkinnedAmbientShader>();
+  bool success =
+      shader->InternalBuild(OZZ_ARRAY_SIZE(vs), vs, OZZ_ARRAY_SIZE(fs), fs);
+
+  success &= shader->FindAttrib("a_joints");
+  success &= shader->FindAttrib("a_weights");
+  success &= shader->BindUniform("u_joints");
+
+  if (!success) {
+    shader.reset();
+  } else {
+    shader->max_joints_ = _max_joints;
+  }
+
+  return shader;
+}
+
+void SkinnedAmbientShader::Bind(
+    const math::Float4x4& _model, const math::Float4x4& _view_proj,
+    GLsizei _pos_stride, GLsizei _pos_offset, GLsizei _normal_stride,
+    GLsizei _normal_offset, GLsizei _color_stride, GLsizei _color_offset,
+    GLsizei _joints_stride, GLsizei _joints_offset, GLsizei _weights_stride,
+    GLsizei _weights_offset, span<const math::Float4x4> _skinning_matrices) {
+  assert(_skinning_matrices.size() <= static_cast<size_t>(max_joints_));
+
+  AmbientShader::Bind(_model, _view_proj, _pos_stride, _pos_offset,
+                      _normal_stride, _normal_offset, _color_stride,
+                      _color_offset);
+
+  const GLint joints_attrib = attrib(3);
+  GL(EnableVertexAttribArray(joints_attrib));
+  GL(VertexAttribPointer(joints_attrib, 4, GL_UNSIGNED_SHORT, GL_FALSE,
+                         _joints_stride, GL_PTR_OFFSET(_joints_offset)));
+
+  const GLint weights_attrib = attrib(4);
+  GL(EnableVertexAttribArray(weights_attrib));
+  GL(VertexAttribPointer(weights_attrib, 4, GL_FLOAT, GL_FALSE,
+                         _weights_stride, GL_PTR_OFFSET(_weights_offset)));
+
+  // Binds skinning matrices rows.
+  UploadSkinningRows(uniform(2), _skinning_matrices, &joint_rows_);
+}
+
+ozz::unique_ptr<SkinnedAmbientShaderInstanced>
+SkinnedAmbientShaderInstanced::Build(int _max_joints) {
+  char max_joints[64];
+  std::snprintf(max_joints, sizeof(max_joints), "#define MAX_JOINTS %d\n",
+                _max_joints);
+
+  // Same as SkinnedAmbientShader, but joint indices are offset by the
+  // instance palette, and model matrix is an instance attribute.
+  const char* vs_skinning_world_matrix =
+      "uniform vec4 u_joints[MAX_JOINTS * 3];\n"
+      "attribute vec4 a_joints;\n"
+      "attribute vec4 a_weights;\n"
+      "attribute mat4 a_mw;\n"
+      "attribute float a_palette;\n"
+      "vec4 BlendRow(ivec4 _joints, int _row) {\n"
+      "  return u_joints[_joints.x + _row] * a_weights.x +\n"
+      "         u_joints[_joints.y + _row] * a_weights.y +\n"
+      "         u_joints[_joints.z + _row] * a_weights.z +\n"
+      "         u_joints[_joints.w + _row] * a_weights.w;\n"
+      "}\n"
+      "mat4 GetWorldMatrix() {\n"
+      "  ivec4 joints = (ivec4(a_joints) + int(a_palette)) * 3;\n"
+      "  vec4 r0 = BlendRow(joints, 0);\n"
+      "  vec4 r1 = BlendRow(joints, 1);\n"
+      "  vec4 r2 = BlendRow(joints, 2);\n"
+      "  mat4 skinning_matrix = mat4(\n"
+      "    r0.x, r1.x, r2.x, 0.,\n"
+      "    r0.y, r1.y, r2.y, 0.,\n"
+      "    r0.z, r1.z, r2.z, 0.,\n"
+      "    r0.w, r1.w, r2.w, 1.);\n"
+      "  return a_mw * skinning_matrix;\n"
+      "}\n";
+  const char* vs[] = {kPlatformSpecivicVSHeader, max_joints, kPassNoUv,
+                      vs_skinning_world_matrix, kShaderUberVS};
+  const char* fs[] = {kPlatformSpecivicFSHeader, kShaderAmbientFct,
+                      kShaderAmbientFS};
+
+  ozz::unique_ptr<SkinnedAmbientShaderInstanced> shader =
+      make_unique<SkinnedAmbientShaderInstanced>();
+  bool success =
+      shader->BuildFromSource(OZZ_ARRAY_SIZE(vs), vs, OZZ_ARRAY_SIZE(fs), fs);
+
+  // Binds default attributes
+  success &= shader->FindAttrib("a_position");
+  success &= shader->FindAttrib("a_normal");
+  success &= shader->FindAttrib("a_color");
+  success &= shader->FindAttrib("a_joints");
+  success &= shader->FindAttrib("a_weights");
+  success &= shader->FindAttrib("a_mw");
+  success &= shader->FindAttrib("a_palette");
+
+  // Binds default uniforms
+  success &= shader->BindUniform("u_mvp");
+  success &= shader->BindUniform("u_joints");
+
+  if (!success) {
+    shader.reset();
+  } else {
+    shader->max_joints_ = _max_joints;
+  }
+
+  return shader;
+}
+
+void SkinnedAmbientShaderInstanced::Bind(
+    GLsizei _models_offset, GLsizei _palettes_offset,
+    const math::Float4x4& _view_proj, GLsizei _pos_stride, GLsizei _pos_offset,
+    GLsizei _normal_stride, GLsizei _normal_offset, GLsizei _color_stride,
+    GLsizei _color_offset, GLsizei _joints_stride, GLsizei _joints_offset,
+    GLsizei _weights_stride, GLsizei _weights_offset) {
+  GL(UseProgram(program()));
+
+  const GLint position_attrib = attrib(0);
+  GL(EnableVertexAttribArray(position_attrib));
+  GL(VertexAttribPointer(position_attrib, 3, GL_FLOAT, GL_FALSE, _pos_stride,
+                         GL_PTR_OFFSET(_pos_offset)));
+
+  const GLint normal_attrib = attrib(1);
+  GL(EnableVertexAttribArray(normal_attrib));
+  GL(VertexAttribPointer(normal_attrib, 3, GL_FLOAT, GL_TRUE, _normal_stride,
+                         GL_PTR_OFFSET(_normal_offset)));
+
+  const GLint color_attrib = attrib(2);
+  GL(EnableVertexAttribArray(color_attrib));
+  GL(VertexAttribPointer(color_attrib, 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                         _color_stride, GL_PTR_OFFSET(_color_offset)));
+
+  const GLint joints_attrib = attrib(3);
+  GL(EnableVertexAttribArray(joints_attrib));
+  GL(VertexAttribPointer(joints_attrib, 4, GL_UNSIGNED_SHORT, GL_FALSE,
+                         _joints_stride, GL_PTR_OFFSET(_joints_offset)));
+
+  const GLint weights_attrib = attrib(4);
+  GL(EnableVertexAttribArray(weights_attrib));
+  GL(VertexAttribPointer(weights_attrib, 4, GL_FLOAT, GL_FALSE,
+                         _weights_stride, GL_PTR_OFFSET(_weights_offset)));
+
+  // Binds per-instance model matrices.
+  const GLint models_attrib = attrib(5);
+  for (int i = 0; i < 4; ++i) {
+    GL(EnableVertexAttribArray(models_attrib + i));
+    GL(VertexAttribDivisor_(models_attrib + i, 1));
+    GL(VertexAttribPointer(models_attrib + i, 4, GL_FLOAT, GL_FALSE,
+                           sizeof(math::Float4x4),
+                           GL_PTR_OFFSET(i * 16 + _models_offset)));
+  }
+
+  // Binds per-instance palette offsets.
+  const GLint palettes_attrib = attrib(6);
+  GL(EnableVertexAttribArray(palettes_attrib));
+  GL(VertexAttribDivisor_(palettes_attrib, 1));
+  GL(VertexAttribPointer(palettes_attrib, 1, GL_FLOAT, GL_FALSE,
+                         sizeof(float), GL_PTR_OFFSET(_palettes_offset)));
+
+  // Binds mvp uniform
+  const GLint mvp_uniform = uniform(0);
+  float values[16];
+  math::StorePtrU(_view_proj.cols[0], values + 0);
+  math::StorePtrU(_view_proj.cols[1], values + 4);
+  math::StorePtrU(_view_proj.cols[2], values + 8);
+  math::StorePtrU(_view_proj.cols[3], values + 12);
+  GL(UniformMatrix4fv(mvp_uniform, 1, false, values));
+}
+
+void SkinnedAmbientShaderInstanced::UploadPalettes(
+    span<const math::Float4x4> _skinning_matrices) {
+  assert(_skinning_matrices.size() <= static_cast<size_t>(max_joints_));
+  UploadSkinningRows(uniform(1), _skinning_matrices, &joint_rows_);
+}
+
+void SkinnedAmbientShaderInstanced::Unbind() {
+  const GLint models_attrib = attrib(5);
+  for (int i = 0; i < 4; ++i) {
+    GL(DisableVertexAttribArray(models_attrib + i));
+    GL(VertexAttribDivisor_(models_attrib + i, 0));
+  }
+  const GLint palettes_attrib = attrib(6);
+  GL(VertexAttribDivisor_(palettes_attrib, 0));
+  Shader::Unbind();
+}
+
 ozz::unique_ptr<AmbientShaderInstanced> AmbientShaderInstanced::Build() {
   bool success = true;
 
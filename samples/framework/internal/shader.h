@@ -213,6 +213,87 @@ class AmbientShader : public Shader {
                      int _fragment_count, const char** _fragment);
 };
 
+// Ambient shader that skins vertices on the GPU. Vertices are transformed by
+// the weighted sum of up to 4 skinning matrices, which is the same linear
+// blend skinning as SkinningJob with joint_matrices. Skinning matrices are
+// uploaded as uniforms, so their number is limited by the uniform storage.
+class SkinnedAmbientShader : public AmbientShader {
+ public:
+  SkinnedAmbientShader() : max_joints_(0) {}
+  virtual ~SkinnedAmbientShader() {}
+
+  // Constructs the shader, supporting up to _max_joints skinning matrices.
+  // Returns nullptr if shader compilation failed or a valid Shader pointer on
+  // success. The shader must then be deleted using default allocator Delete
+  // function.
+  static ozz::unique_ptr<SkinnedAmbientShader> Build(int _max_joints);
+
+  // Binds the shader. Each vertex has 4 joint indices (unsigned short) and 4
+  // joint weights (float). Unused influences must have a null weight.
+  void Bind(const math::Float4x4& _model, const math::Float4x4& _view_proj,
+            GLsizei _pos_stride, GLsizei _pos_offset, GLsizei _normal_stride,
+            GLsizei _normal_offset, GLsizei _color_stride,
+            GLsizei _color_offset, GLsizei _joints_stride,
+            GLsizei _joints_offset, GLsizei _weights_stride,
+            GLsizei _weights_offset,
+            span<const math::Float4x4> _skinning_matrices);
+
+  // Maximum number of skinning matrices supported by the shader.
+  int max_joints() const { return max_joints_; }
+
+  // Maximum number of joints influencing a vertex.
+  static const int kMaxInfluences = 4;
+
+ private:
+  int max_joints_;
+
+  // Skinning matrices rows, uploaded as vec4 uniforms.
+  ozz::vector<float> joint_rows_;
+};
+
+// Instanced version of SkinnedAmbientShader. Skinning matrices of all the
+// instances of a draw call (their palettes) are uploaded to the same uniform
+// array. Each instance provides its model matrix and the index of its first
+// skinning matrix as per-instance attributes.
+class SkinnedAmbientShaderInstanced : public Shader {
+ public:
+  SkinnedAmbientShaderInstanced() : max_joints_(0) {}
+  virtual ~SkinnedAmbientShaderInstanced() {}
+
+  // Constructs the shader, supporting up to _max_joints skinning matrices for
+  // all the instances of a draw call.
+  // Returns nullptr if shader compilation failed or a valid Shader pointer on
+  // success. The shader must then be deleted using default allocator Delete
+  // function.
+  static ozz::unique_ptr<SkinnedAmbientShaderInstanced> Build(int _max_joints);
+
+  // Binds the shader. Vertex attributes are the same as SkinnedAmbientShader
+  // ones. Per-instance model matrices and palette offsets (float index of the
+  // first skinning matrix of each instance) are read from the array buffer at
+  // _models_offset and _palettes_offset.
+  void Bind(GLsizei _models_offset, GLsizei _palettes_offset,
+            const math::Float4x4& _view_proj, GLsizei _pos_stride,
+            GLsizei _pos_offset, GLsizei _normal_stride,
+            GLsizei _normal_offset, GLsizei _color_stride,
+            GLsizei _color_offset, GLsizei _joints_stride,
+            GLsizei _joints_offset, GLsizei _weights_stride,
+            GLsizei _weights_offset);
+
+  // Uploads skinning matrices of all the instances, which must be bound.
+  void UploadPalettes(span<const math::Float4x4> _skinning_matrices);
+
+  virtual void Unbind();
+
+  // Maximum number of skinning matrices supported by the shader.
+  int max_joints() const { return max_joints_; }
+
+ private:
+  int max_joints_;
+
+  // Skinning matrices rows, uploaded as vec4 uniforms.
+  ozz::vector<float> joint_rows_;
+};
+
 class AmbientShaderInstanced : public Shader {
  public:
   AmbientShaderInstanced() {}
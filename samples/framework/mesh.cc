@@ -27,6 +27,8 @@
 
 #include "mesh.h"
 
+#include <algorithm>
+
 #include "ozz/base/containers/vector_archive.h"
 #include "ozz/base/memory/allocator.h"
 
@@ -36,6 +38,34 @@
 #include "ozz/base/maths/simd_math_archive.h"
 
 namespace ozz {
+namespace sample {
+
+void BuildPartPalettes(Mesh* _mesh) {
+  for (Mesh::Part& part : _mesh->parts) {
+    part.joint_palette.clear();
+    part.joint_indices8.clear();
+
+    // Collects sorted unique joints used by this part.
+    Mesh::Part::JointPalette palette(part.joint_indices.begin(),
+                                     part.joint_indices.end());
+    std::sort(palette.begin(), palette.end());
+    palette.erase(std::unique(palette.begin(), palette.end()), palette.end());
+    if (palette.size() > 256) {
+      continue;
+    }
+
+    // Remaps joint indices to their palette index.
+    part.joint_indices8.resize(part.joint_indices.size());
+    for (size_t i = 0; i < part.joint_indices.size(); ++i) {
+      const auto it = std::lower_bound(palette.begin(), palette.end(),
+                                       part.joint_indices[i]);
+      part.joint_indices8[i] = static_cast<uint8_t>(it - palette.begin());
+    }
+    part.joint_palette.swap(palette);
+  }
+}
+}  // namespace sample
+
 namespace io {
 
 void Extern<sample::Mesh::Part>::Save(OArchive& _archive,
@@ -50,13 +80,15 @@ void Extern<sample::Mesh::Part>::Save(OArchive& _archive,
     _archive << part.colors;
     _archive << part.joint_indices;
     _archive << part.joint_weights;
+    _archive << part.joint_palette;
+    _archive << part.joint_indices8;
+    _archive << static_cast<int32_t>(part.rigid_joint);
   }
 }
 
 void Extern<sample::Mesh::Part>::Load(IArchive& _archive,
                                       sample::Mesh::Part* _parts, size_t _count,
                                       uint32_t _version) {
-  (void)_version;
   for (size_t i = 0; i < _count; ++i) {
     sample::Mesh::Part& part = _parts[i];
     _archive >> part.positions;
@@ -66,6 +98,15 @@ void Extern<sample::Mesh::Part>::Load(IArchive& _archive,
     _archive >> part.colors;
     _archive >> part.joint_indices;
     _archive >> part.joint_weights;
+    if (_version >= 2) {
+      _archive >> part.joint_palette;
+      _archive >> part.joint_indices8;
+    }
+    if (_version >= 3) {
+      int32_t rigid_joint;
+      _archive >> rigid_joint;
+      part.rigid_joint = rigid_joint;
+    }
   }
 }
 
@@ -82,13 +123,17 @@ void Extern<sample::Mesh>::Save(OArchive& _archive, const sample::Mesh* _meshes,
 
 void Extern<sample::Mesh>::Load(IArchive& _archive, sample::Mesh* _meshes,
                                 size_t _count, uint32_t _version) {
-  (void)_version;
   for (size_t i = 0; i < _count; ++i) {
     sample::Mesh& mesh = _meshes[i];
     _archive >> mesh.parts;
     _archive >> mesh.triangle_indices;
     _archive >> mesh.joint_remaps;
     _archive >> mesh.inverse_bind_poses;
+
+    // Part palettes weren't serialized before version 2.
+    if (_version < 2) {
+      sample::BuildPartPalettes(&mesh);
+    }
   }
 }
 }  // namespace io
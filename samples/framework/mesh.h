@@ -117,8 +117,29 @@ struct Mesh {
     typedef ozz::vector<uint16_t> JointIndices;
     JointIndices joint_indices;  // Stride equals influences_count
 
+    // Optional compact joint palette, see BuildPartPalettes(). Lists the mesh
+    // joints (indices in inverse_bind_poses) that influence this part, sorted.
+    // Skinning matrices can be gathered to a small per part palette, indexed
+    // with joint_indices8.
+    typedef ozz::vector<uint16_t> JointPalette;
+    JointPalette joint_palette;
+
+    // Joint indices local to joint_palette, stride equals influences_count.
+    // Only available if joint_palette is.
+    typedef ozz::vector<uint8_t> JointIndices8;
+    JointIndices8 joint_indices8;
+
     typedef ozz::vector<float> JointWeights;
     JointWeights joint_weights;  // Stride equals influences_count - 1
+
+    // Tests if all part vertices are bound to a single joint, rigid_joint.
+    bool rigid() const { return rigid_joint >= 0; }
+
+    // Mesh joint (index in inverse_bind_poses) all part vertices are fully
+    // bound to, or -1 if the part isn't rigid. Rigid parts can be transformed
+    // with this single skinning matrix, without reading per-vertex joint
+    // indices nor weights.
+    int rigid_joint = -1;
   };
   typedef ozz::vector<Part> Parts;
   Parts parts;
@@ -137,12 +158,17 @@ struct Mesh {
   typedef ozz::vector<ozz::math::Float4x4> InversBindPoses;
   InversBindPoses inverse_bind_poses;
 };
+
+// Builds every _mesh part joint_palette and joint_indices8 from joint_indices.
+// Parts influenced by more than 256 joints, which can't be indexed with 8 bits,
+// are left without palette.
+void BuildPartPalettes(Mesh* _mesh);
 }  // namespace sample
 
 namespace io {
 
 OZZ_IO_TYPE_TAG("ozz-sample-Mesh-Part", sample::Mesh::Part)
-OZZ_IO_TYPE_VERSION(1, sample::Mesh::Part)
+OZZ_IO_TYPE_VERSION(3, sample::Mesh::Part)
 
 template <>
 struct Extern<sample::Mesh::Part> {
@@ -153,7 +179,7 @@ struct Extern<sample::Mesh::Part> {
 };
 
 OZZ_IO_TYPE_TAG("ozz-sample-Mesh", sample::Mesh)
-OZZ_IO_TYPE_VERSION(1, sample::Mesh)
+OZZ_IO_TYPE_VERSION(2, sample::Mesh)
 
 template <>
 struct Extern<sample::Mesh> {
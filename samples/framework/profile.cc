@@ -25,37 +25,48 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
-#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
-
 #include "framework/profile.h"
-#include "framework/internal/renderer_impl.h"
 
+#include <algorithm>
 #include <cfloat>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstring>
 
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/stream.h"
 #include "ozz/base/memory/allocator.h"
 
 namespace ozz {
 namespace sample {
 
-Profiler::Profiler(Record* _record)
-    : begin_(static_cast<float>(glfwGetTime())), record_(_record) {}
+namespace {
+// Gets current time in seconds, from a monotonic clock.
+double Now() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+}  // namespace
+
+Profiler::Profiler(Record* _record) : begin_(Now()), record_(_record) {}
 
 Profiler::~Profiler() {
   if (record_) {
-    float end = static_cast<float>(glfwGetTime());
-    record_->Push((end - begin_) * 1000.f);
+    record_->Push(static_cast<float>((Now() - begin_) * 1000.));
   }
 }
 
-Record::Record(int _max_records)
+Record::Record(int _max_records, const char* _name)
     : max_records_(_max_records < 1 ? 1 : _max_records),
       records_end_(
           reinterpret_cast<float*>(memory::default_allocator()->Allocate(
               _max_records * sizeof(float), alignof(float))) +
           max_records_),
       records_begin_(records_end_),
-      cursor_(records_end_) {}
+      cursor_(records_end_),
+      name_(_name) {}
 
 Record::~Record() {
   memory::default_allocator()->Deallocate(records_end_ - max_records_);
@@ -74,8 +85,8 @@ void Record::Push(float _value) {
   *cursor_ = _value;
 }
 
-Record::Statistics Record::GetStatistics() {
-  Statistics statistics = {FLT_MAX, -FLT_MAX, 0.f, 0.f};
+Record::Statistics Record::GetStatistics() const {
+  Statistics statistics = {FLT_MAX, -FLT_MAX, 0.f, 0.f, 0.f, 0.f, 0.f};
   if (records_begin_ == records_end_) {  // No record.
     return statistics;
   }
@@ -111,7 +122,54 @@ Record::Statistics Record::GetStatistics() {
   statistics.latest = *cursor_;
   statistics.mean = sum / (records_end_ - records_begin_);
 
+  // Percentiles are computed on a sorted copy of the records.
+  ozz::vector<float> sorted(records_begin_, records_end_);
+  std::sort(sorted.begin(), sorted.end());
+  const auto percentile = [&sorted](float _rank) {
+    const int index =
+        static_cast<int>(std::ceil(_rank * sorted.size())) - 1;
+    return sorted[std::max(index, 0)];
+  };
+  statistics.p50 = percentile(.5f);
+  statistics.p95 = percentile(.95f);
+  statistics.p99 = percentile(.99f);
+
   return statistics;
 }
+
+bool ExportStatistics(span<const Record* const> _records,
+                      const char* _filename) {
+  const size_t length = std::strlen(_filename);
+  const bool json =
+      length >= 5 && std::strcmp(_filename + length - 5, ".json") == 0;
+
+  ozz::string content(json ? "[\n"
+                           : "name,count,min,max,mean,p50,p95,p99,latest\n");
+  char line[512];
+  for (size_t i = 0; i < _records.size(); ++i) {
+    const Record& record = *_records[i];
+    Record::Statistics stats = record.GetStatistics();
+    if (record.count() == 0) {
+      stats.min = stats.max = 0.f;
+    }
+    const char* format =
+        json ? "  {\"name\": \"%s\", \"count\": %d, \"min\": %g, \"max\": %g, "
+               "\"mean\": %g, \"p50\": %g, \"p95\": %g, \"p99\": %g, "
+               "\"latest\": %g}%s\n"
+             : "\"%s\",%d,%g,%g,%g,%g,%g,%g,%g%s\n";
+    std::snprintf(line, sizeof(line), format, record.name(), record.count(),
+                  stats.min, stats.max, stats.mean, stats.p50, stats.p95,
+                  stats.p99, stats.latest,
+                  json && i + 1 < _records.size() ? "," : "");
+    content += line;
+  }
+  if (json) {
+    content += "]\n";
+  }
+
+  ozz::io::File file(_filename, "wb");
+  return file.opened() &&
+         file.Write(content.c_str(), content.size()) == content.size();
+}
 }  // namespace sample
 }  // namespace ozz
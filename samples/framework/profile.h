@@ -28,6 +28,9 @@
 #ifndef OZZ_SAMPLES_FRAMEWORK_PROFILE_H_
 #define OZZ_SAMPLES_FRAMEWORK_PROFILE_H_
 
+#include "ozz/base/containers/string.h"
+#include "ozz/base/span.h"
+
 namespace ozz {
 namespace sample {
 // Records up to a maximum number of float values. Once the maximum number is
@@ -35,8 +38,9 @@ namespace sample {
 class Record {
  public:
   // Constructs and sets the maximum number of record-able values.
-  // The minimum record-able number of values is 1.
-  explicit Record(int _max_records);
+  // The minimum record-able number of values is 1. _name identifies the
+  // record in statistics exports.
+  explicit Record(int _max_records, const char* _name = "");
 
   // Deallocate records.
   ~Record();
@@ -57,6 +61,12 @@ class Record {
   // Returns the end of the recorded values.
   const float* record_end() const { return records_end_; }
 
+  // Returns the number of recorded values.
+  int count() const { return static_cast<int>(records_end_ - records_begin_); }
+
+  // Returns record name.
+  const char* name() const { return name_.c_str(); }
+
   // Statistics returned by GetStatistics function.
   struct Statistics {
     // Minimum value of the recorded range.
@@ -67,10 +77,14 @@ class Record {
     float mean;
     // Latest value of the recorded range.
     float latest;
+    // Percentiles of the recorded range (nearest rank).
+    float p50;
+    float p95;
+    float p99;
   };
 
   // Builds statistics of the current record state.
-  Statistics GetStatistics();
+  Statistics GetStatistics() const;
 
  private:
   // Disables assignment and copy.
@@ -89,8 +103,19 @@ class Record {
 
   // Cursor in the circular buffer. Points to the latest pushed value.
   float* cursor_;
+
+  // Record name.
+  ozz::string name_;
 };
 
+// Exports statistics of _records to _filename, one entry per record with its
+// name, number of values, min, max, mean, percentiles and latest value. File
+// is written as json if _filename extension is ".json", as csv otherwise.
+// Statistics of empty records are all 0.
+// Returns false if file can't be written.
+bool ExportStatistics(span<const Record* const> _records,
+                      const char* _filename);
+
 // Measures the time spent between the constructor and  the destructor (as a
 // RAII object) and pushes the result to a Record.
 class Profiler {
@@ -106,8 +131,9 @@ class Profiler {
   Profiler(const Profiler& _profiler);
   void operator=(const Profiler& _profiler);
 
-  // The time at which profiling began.
-  float begin_;
+  // The time at which profiling began, in seconds. It doesn't rely on the
+  // window system timer, so profiling also works for headless runs.
+  double begin_;
 
   // Profiling result is pushed in the record_ object.
   Record* record_;
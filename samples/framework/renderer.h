@@ -136,6 +136,7 @@ class Renderer {
     bool colors;     // Show vertex colors.
     bool wireframe;  // Show vertex colors.
     bool skip_skinning;  // Show texture (default checkered texture).
+    bool gpu_skinning;   // Skins on the GPU when supported.
 
     Options()
         : triangles(true),
@@ -146,11 +147,12 @@ class Renderer {
           binormals(false),
           colors(false),
           wireframe(false),
-          skip_skinning(false) {}
+          skip_skinning(false),
+          gpu_skinning(false) {}
 
     Options(bool _triangles, bool _texture, bool _vertices, bool _normals,
             bool _tangents, bool _binormals, bool _colors, bool _wireframe,
-            bool _skip_skinning)
+            bool _skip_skinning, bool _gpu_skinning = false)
         : triangles(_triangles),
           texture(_texture),
           vertices(_vertices),
@@ -159,15 +161,31 @@ class Renderer {
           binormals(_binormals),
           colors(_colors),
           wireframe(_wireframe),
-          skip_skinning(_skip_skinning) {}
+          skip_skinning(_skip_skinning),
+          gpu_skinning(_gpu_skinning) {}
   };
 
   // Renders a skinned mesh at a specified location.
+  // If _options.gpu_skinning is set, the mesh is skinned on the GPU, with the
+  // same skinning matrices, unless it isn't supported for this mesh (too many
+  // joints or influences) or options (texture and debug rendering require CPU
+  // skinning). SkinningJob is used otherwise.
   virtual bool DrawSkinnedMesh(const Mesh& _mesh,
                                const span<math::Float4x4> _skinning_matrices,
                                const ozz::math::Float4x4& _transform,
                                const Options& _options = Options()) = 0;
 
+  // Renders _transforms.size() instances of a skinned mesh. Instance i is
+  // skinned by its own palette of _mesh.num_joints() skinning matrices, which
+  // start at _skinning_matrices[i * _mesh.num_joints()]. Palettes of many
+  // instances are uploaded in one buffer and skinned on the GPU with
+  // instanced draw calls. Falls back to one DrawSkinnedMesh call per instance
+  // if instancing isn't supported, or for the same reasons as GPU skinning.
+  virtual bool DrawSkinnedMeshes(
+      const Mesh& _mesh, const span<math::Float4x4> _skinning_matrices,
+      const span<const math::Float4x4> _transforms,
+      const Options& _options = Options()) = 0;
+
   // Renders a mesh at a specified location.
   virtual bool DrawMesh(const Mesh& _mesh,
                         const ozz::math::Float4x4& _transform,
@@ -51,6 +51,15 @@ OZZ_OPTIONS_DECLARE_BOOL(split,
                          "Split the skinned mesh into parts (number of joint "
                          "influences per vertex).",
                          true, false)
+OZZ_OPTIONS_DECLARE_BOOL(sort_vertices,
+                         "Sort vertices of each part by influencing joints, to "
+                         "improve skinning cache locality.",
+                         true, false)
+OZZ_OPTIONS_DECLARE_BOOL(rigid_parts,
+                         "Split fully rigid sections (vertices bound to a "
+                         "single joint) to their own parts, so they can be "
+                         "transformed with a single matrix.",
+                         true, false)
 OZZ_OPTIONS_DECLARE_INT(
     max_influences,
     "Maximum number of joint influences per vertex (0 means no limitation).", 0,
@@ -862,6 +871,161 @@ bool SplitParts(const ozz::sample::Mesh& _skinned_mesh,
   return true;
 }
 
+// Reorders _values, made of _vertex_count vertices, according to _order.
+template <typename _T>
+void PermuteVertices(const ozz::vector<size_t>& _order, size_t _vertex_count,
+                     ozz::vector<_T>* _values) {
+  if (_values->empty()) {
+    return;
+  }
+  const size_t stride = _values->size() / _vertex_count;
+  const ozz::vector<_T> copy = *_values;
+  for (size_t i = 0; i < _vertex_count; ++i) {
+    for (size_t j = 0; j < stride; ++j) {
+      (*_values)[i * stride + j] = copy[_order[i] * stride + j];
+    }
+  }
+}
+
+// Sorts vertices of each part by the set of joints that influence them. Doing
+// so, consecutive vertices mostly use the same skinning matrices, which
+// remain in cache while SkinningJob transforms them. Source order is kept for
+// vertices with the same joints. Triangle indices are remapped accordingly.
+bool SortVertices(ozz::sample::Mesh* _mesh) {
+  ozz::vector<uint16_t> vertices_remap;
+  vertices_remap.resize(_mesh->vertex_count());
+
+  size_t processed_vertices = 0;
+  for (size_t i = 0; i < _mesh->parts.size(); ++i) {
+    ozz::sample::Mesh::Part& part = _mesh->parts[i];
+    const size_t vertex_count = part.vertex_count();
+    const size_t influences = part.influences_count();
+
+    // Builds sorting keys, aka sorted joint indices of each vertex.
+    ozz::vector<uint16_t> keys = part.joint_indices;
+    for (size_t j = 0; j < vertex_count; ++j) {
+      std::sort(keys.begin() + j * influences,
+                keys.begin() + (j + 1) * influences);
+    }
+
+    ozz::vector<size_t> order;
+    order.resize(vertex_count);
+    for (size_t j = 0; j < vertex_count; ++j) {
+      order[j] = j;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&keys, influences](size_t _a, size_t _b) {
+                       return std::lexicographical_compare(
+                           keys.begin() + _a * influences,
+                           keys.begin() + (_a + 1) * influences,
+                           keys.begin() + _b * influences,
+                           keys.begin() + (_b + 1) * influences);
+                     });
+
+    PermuteVertices(order, vertex_count, &part.positions);
+    PermuteVertices(order, vertex_count, &part.normals);
+    PermuteVertices(order, vertex_count, &part.tangents);
+    PermuteVertices(order, vertex_count, &part.uvs);
+    PermuteVertices(order, vertex_count, &part.colors);
+    PermuteVertices(order, vertex_count, &part.joint_indices);
+    PermuteVertices(order, vertex_count, &part.joint_weights);
+    PermuteVertices(order, vertex_count, &part.joint_indices8);
+
+    // Triangle indices are shared across parts.
+    for (size_t j = 0; j < vertex_count; ++j) {
+      vertices_remap[processed_vertices + order[j]] =
+          static_cast<uint16_t>(processed_vertices + j);
+    }
+    processed_vertices += vertex_count;
+  }
+
+  for (size_t i = 0; i < _mesh->triangle_indices.size(); ++i) {
+    _mesh->triangle_indices[i] = vertices_remap[_mesh->triangle_indices[i]];
+  }
+
+  return true;
+}
+
+// Appends _part vertices in range [_begin, _end[ to _values.
+template <typename _T>
+void AppendVertices(const ozz::vector<_T>& _part_values, size_t _vertex_count,
+                    size_t _begin, size_t _end, ozz::vector<_T>* _values) {
+  if (_part_values.empty()) {
+    return;
+  }
+  const size_t stride = _part_values.size() / _vertex_count;
+  _values->insert(_values->end(), _part_values.begin() + _begin * stride,
+                  _part_values.begin() + _end * stride);
+}
+
+void AppendVertices(const ozz::sample::Mesh::Part& _part, size_t _begin,
+                    size_t _end, ozz::sample::Mesh::Part* _out) {
+  const size_t vertex_count = _part.vertex_count();
+  AppendVertices(_part.positions, vertex_count, _begin, _end,
+                 &_out->positions);
+  AppendVertices(_part.normals, vertex_count, _begin, _end, &_out->normals);
+  AppendVertices(_part.tangents, vertex_count, _begin, _end, &_out->tangents);
+  AppendVertices(_part.uvs, vertex_count, _begin, _end, &_out->uvs);
+  AppendVertices(_part.colors, vertex_count, _begin, _end, &_out->colors);
+  AppendVertices(_part.joint_indices, vertex_count, _begin, _end,
+                 &_out->joint_indices);
+  AppendVertices(_part.joint_weights, vertex_count, _begin, _end,
+                 &_out->joint_weights);
+}
+
+// Splits runs of consecutive single influence vertices bound to the same joint
+// to their own rigid parts. Such parts are transformed at runtime with a
+// single matrix, bypassing per-vertex skinning. Runs shorter than
+// kMinRigidVertices remain in skinned parts, as the per part overhead would
+// exceed the gain. Vertex order is kept, so triangle indices remain valid.
+// Benefits from SortVertices, which groups vertices by joint.
+bool BuildRigidParts(ozz::sample::Mesh* _mesh) {
+  const size_t kMinRigidVertices = 32;
+
+  ozz::sample::Mesh::Parts parts;
+  for (size_t i = 0; i < _mesh->parts.size(); ++i) {
+    const ozz::sample::Mesh::Part& part = _mesh->parts[i];
+    if (part.influences_count() != 1 || part.rigid()) {
+      parts.push_back(part);
+      continue;
+    }
+
+    // Pushes a new part, or extends the last one if it's a compatible
+    // skinned part.
+    auto append = [&parts, &part](size_t _begin, size_t _end, int _joint) {
+      if (_joint >= 0 || parts.empty() || parts.back().rigid() ||
+          parts.back().influences_count() != 1) {
+        parts.resize(parts.size() + 1);
+        parts.back().rigid_joint = _joint;
+      }
+      AppendVertices(part, _begin, _end, &parts.back());
+    };
+
+    const size_t vertex_count = part.vertex_count();
+    size_t skinned_begin = 0;
+    for (size_t begin = 0, end = 0; begin < vertex_count; begin = end) {
+      const uint16_t joint = part.joint_indices[begin];
+      end = begin + 1;
+      while (end < vertex_count && part.joint_indices[end] == joint) {
+        ++end;
+      }
+      if (end - begin >= kMinRigidVertices) {
+        if (skinned_begin != begin) {
+          append(skinned_begin, begin, -1);
+        }
+        append(begin, end, joint);
+        skinned_begin = end;
+      }
+    }
+    if (skinned_begin != vertex_count) {
+      append(skinned_begin, vertex_count, -1);
+    }
+  }
+  _mesh->parts.swap(parts);
+
+  return true;
+}
+
 // Removes the less significant weight, which is recomputed at runtime (sum of
 // weights equals 1).
 bool StripWeights(ozz::sample::Mesh* _mesh) {
@@ -1009,6 +1173,26 @@ int main(int _argc, const char** _argv) {
         output_mesh = partitioned_meshes;
       }
 
+      // Sorts vertices by influencing joints.
+      if (OPTIONS_sort_vertices) {
+        if (!SortVertices(&output_mesh)) {
+          ozz::log::Err() << "Failed to sort vertices." << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+
+      // Splits rigid sections to their own parts.
+      if (OPTIONS_rigid_parts) {
+        if (!BuildRigidParts(&output_mesh)) {
+          ozz::log::Err() << "Failed to build rigid parts." << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+
+      // Builds compact per part joint palettes, so parts can be skinned with
+      // 8 bits joint indices and only the skinning matrices they use.
+      ozz::sample::BuildPartPalettes(&output_mesh);
+
       if (!StripWeights(&output_mesh)) {
         ozz::log::Err() << "Failed to strip weights." << std::endl;
         return EXIT_FAILURE;
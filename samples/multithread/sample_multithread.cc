@@ -28,10 +28,11 @@
 #include <algorithm>
 #include <atomic>
 #include <cstdlib>
-#include <future>
+#include <thread>
 
 #include "framework/application.h"
 #include "framework/imgui.h"
+#include "framework/mesh.h"
 #include "framework/renderer.h"
 #include "framework/utils.h"
 #include "ozz/animation/runtime/animation.h"
@@ -45,6 +46,7 @@
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/maths/vec_float.h"
+#include "ozz/base/task_scheduler.h"
 #include "ozz/options/options.h"
 
 #if EMSCRIPTEN
@@ -62,6 +64,11 @@ OZZ_OPTIONS_DECLARE_STRING(animation,
                            "Path to the first animation (ozz archive format).",
                            "media/animation.ozz", false)
 
+// Mesh archive can be specified as an option.
+OZZ_OPTIONS_DECLARE_STRING(mesh,
+                           "Path to the skinned mesh (ozz archive format).",
+                           "media/mesh.ozz", false)
+
 // Interval between each character.
 const float kInterval = 2.f;
 
@@ -89,9 +96,11 @@ class MultithreadSampleApplication : public ozz::sample::Application {
   MultithreadSampleApplication()
       : characters_(kMaxCharacters),
         num_characters_(kMaxCharacters / 4),
+        draw_mesh_(true),
         has_threading_support_(HasThreadingSupport()),
         enable_theading_(has_threading_support_),
-        grain_size_(128) {
+        grain_size_(128),
+        scheduler_(has_threading_support_ ? -1 : 0) {
     if (has_threading_support_) {
       ozz::log::Out() << "Platform has threading support." << std::endl;
     } else {
@@ -133,13 +142,40 @@ class MultithreadSampleApplication : public ozz::sample::Application {
     return true;
   }
 
-  // Data structure used to pass const arguments to parallel tasks.
+  // Builds character _index skinning matrices for all meshes. They are written
+  // to the _index palette of each mesh skinning matrices buffer, so all
+  // characters can be rendered at once.
+  static void SkinCharacter(const ozz::vector<ozz::sample::Mesh>& _meshes,
+                            const Character& _character, int _index,
+                            ozz::vector<ozz::math::Float4x4>* _palettes) {
+    for (size_t m = 0; m < _meshes.size(); ++m) {
+      const ozz::sample::Mesh& mesh = _meshes[m];
+      const size_t num_joints = mesh.joint_remaps.size();
+      ozz::math::Float4x4* palette =
+          array_begin(_palettes[m]) + _index * num_joints;
+      for (size_t i = 0; i < num_joints; ++i) {
+        palette[i] = _character.models[mesh.joint_remaps[i]] *
+                     mesh.inverse_bind_poses[i];
+      }
+    }
+  }
+
+  // Forward declaration, as monitor is defined below.
+  class ParallelMonitor;
+
+  // Data structure used to pass arguments to parallel tasks.
   struct ParallelArgs {
     const ozz::animation::Animation* animation;
     const ozz::animation::Skeleton* skeleton;
     float dt;
     int grain_size;  // Maximum number of characters that can be processed by a
                      // task.
+    int num_characters;
+    Character* characters;
+    const ozz::vector<ozz::sample::Mesh>* meshes;  // Empty if not skinned.
+    ozz::vector<ozz::math::Float4x4>* palettes;
+    ParallelMonitor* monitor;
+    std::atomic<bool>* success;
   };
 
   // Data used to monitor and analyze threading.
@@ -150,11 +186,7 @@ class MultithreadSampleApplication : public ozz::sample::Application {
     ParallelMonitor() {
       // Finds the maximum possible number of tasks considering kMinGrain grain
       // size for kMaxCharacters characters.
-      int max_tasks = 1;
-      for (int processed = kMinGrainSize; processed < kMaxCharacters;
-           processed *= 2, max_tasks *= 2) {
-      }
-      thread_ids_.resize(max_tasks);
+      thread_ids_.resize((kMaxCharacters + kMinGrainSize - 1) / kMinGrainSize);
       num_async_tasks_.store(0);
     }
 
@@ -183,29 +215,24 @@ class MultithreadSampleApplication : public ozz::sample::Application {
     std::atomic_uint num_async_tasks_;
   };
 
-  static bool ParallelUpdate(const ParallelArgs& _args, Character* _characters,
-                             int _num, ParallelMonitor* _monitor) {
-    bool success = true;
-    if (_num <= _args.grain_size) {
-      _monitor->PushTask();
+  // Parallel-for task, which updates the _task range of grain size
+  // characters.
+  static void ParallelUpdate(int _task, void* _data) {
+    const ParallelArgs& args = *static_cast<const ParallelArgs*>(_data);
+    args.monitor->PushTask();
 
-      for (int i = 0; i < _num; ++i) {
-        success &= UpdateCharacter(*_args.animation, *_args.skeleton, _args.dt,
-                                   &_characters[i]);
-      }
-    } else {
-      // Run half the job on an async task, possibly another thread.
-      const int half = _num / 2;
-      auto handle = std::async(std::launch::async, ParallelUpdate, _args,
-                               _characters + half, _num - half, _monitor);
-
-      // The other half is processed by this thread.
-      success &= ParallelUpdate(_args, _characters, half, _monitor);
-
-      // Get result of the async task or process it if it's not started yet.
-      success &= handle.get();
+    const int begin = _task * args.grain_size;
+    const int end =
+        ozz::math::Min(begin + args.grain_size, args.num_characters);
+    bool success = true;
+    for (int i = begin; i < end; ++i) {
+      success &= UpdateCharacter(*args.animation, *args.skeleton, args.dt,
+                                 &args.characters[i]);
+      SkinCharacter(*args.meshes, args.characters[i], i, args.palettes);
+    }
+    if (!success) {
+      args.success->store(false);
     }
-    return success;
   }
 
   // Updates current animation time.
@@ -215,33 +242,65 @@ class MultithreadSampleApplication : public ozz::sample::Application {
       // Initialize task counter. It's only used to monitor threading behavior.
       monitor_.Reset();
 
-      const ParallelArgs args = {&animation_, &skeleton_, _dt, grain_size_};
-      success = ParallelUpdate(args, array_begin(characters_), num_characters_,
-                               &monitor_);
+      // Splits characters in tasks of grain size characters, distributed to
+      // scheduler worker threads.
+      std::atomic<bool> parallel_success(true);
+      ParallelArgs args = {&animation_,
+                           &skeleton_,
+                           _dt,
+                           grain_size_,
+                           num_characters_,
+                           array_begin(characters_),
+                           draw_mesh_ ? &meshes_ : &no_meshes_,
+                           array_begin(palettes_),
+                           &monitor_,
+                           &parallel_success};
+      const int num_tasks = (num_characters_ + grain_size_ - 1) / grain_size_;
+      scheduler_.ParallelFor(num_tasks, &ParallelUpdate, &args);
+      success = parallel_success.load();
     } else {
       for (int i = 0; i < num_characters_; ++i) {
         success &= UpdateCharacter(animation_, skeleton_, _dt,
                                    array_begin(characters_) + i);
+        SkinCharacter(draw_mesh_ ? meshes_ : no_meshes_, characters_[i], i,
+                      array_begin(palettes_));
       }
     }
     return success;
   }
 
-  // Renders all skeletons.
+  // Renders all skinned meshes, or all skeletons.
   virtual bool OnDisplay(ozz::sample::Renderer* _renderer) {
-    bool success = true;
-    for (int c = 0; success && c < num_characters_; ++c) {
+    for (int c = 0; c < num_characters_; ++c) {
       const ozz::math::Float4 position(
           ((c % kWidth) - kWidth / 2) * kInterval,
           ((c / kWidth) / kDepth) * kInterval,
           (((c / kWidth) % kDepth) - kDepth / 2) * kInterval, 1.f);
-      const ozz::math::Float4x4 transform = ozz::math::Float4x4::Translation(
+      transforms_[c] = ozz::math::Float4x4::Translation(
           ozz::math::simd_float4::LoadPtrU(&position.x));
-      success &= _renderer->DrawPosture(
-          skeleton_, make_span(characters_[c].models), transform, false);
     }
 
-    return true;
+    bool success = true;
+    if (draw_mesh_) {
+      // All characters palettes are rendered at once for each mesh, using
+      // GPU skinning.
+      ozz::sample::Renderer::Options options;
+      options.gpu_skinning = true;
+      const ozz::span<const ozz::math::Float4x4> transforms(
+          array_begin(transforms_), num_characters_);
+      for (size_t m = 0; m < meshes_.size(); ++m) {
+        success &= _renderer->DrawSkinnedMeshes(
+            meshes_[m], make_span(palettes_[m]), transforms, options);
+      }
+    } else {
+      for (int c = 0; success && c < num_characters_; ++c) {
+        success &= _renderer->DrawPosture(
+            skeleton_, make_span(characters_[c].models), transforms_[c],
+            false);
+      }
+    }
+
+    return success;
   }
 
   virtual bool OnInitialize() {
@@ -255,6 +314,29 @@ class MultithreadSampleApplication : public ozz::sample::Application {
       return false;
     }
 
+    // Reading skinned meshes.
+    if (!ozz::sample::LoadMeshes(OPTIONS_mesh, &meshes_)) {
+      return false;
+    }
+
+    // Check the skeleton matches with the meshes, especially that the meshes
+    // don't expect more joints than the skeleton has.
+    for (const ozz::sample::Mesh& mesh : meshes_) {
+      if (skeleton_.num_joints() < mesh.highest_joint_index()) {
+        ozz::log::Err() << "The provided mesh doesn't match skeleton "
+                           "(joint count mismatch)."
+                        << std::endl;
+        return false;
+      }
+    }
+
+    // Allocates a palette per character for each mesh.
+    palettes_.resize(meshes_.size());
+    for (size_t m = 0; m < meshes_.size(); ++m) {
+      palettes_[m].resize(kMaxCharacters * meshes_[m].joint_remaps.size());
+    }
+    transforms_.resize(kMaxCharacters);
+
     // Allocate a default number of characters.
     AllocateCharaters();
 
@@ -272,7 +354,7 @@ class MultithreadSampleApplication : public ozz::sample::Application {
 
       character.locals.resize(skeleton_.num_soa_joints());
       character.models.resize(skeleton_.num_joints());
-      character.context.Resize(animation_.num_tracks());
+      character.context.Resize(animation_.num_tracks(), animation_.cubic());
     }
 
     return true;
@@ -292,6 +374,7 @@ class MultithreadSampleApplication : public ozz::sample::Application {
         const int num_joints = num_characters_ * skeleton_.num_joints();
         std::snprintf(label, sizeof(label), "Number of joints: %d", num_joints);
         _im_gui->DoLabel(label);
+        _im_gui->DoCheckBox("Draw meshes", &draw_mesh_);
       }
     }
     // Exposes multi-threading parameters.
@@ -358,6 +441,22 @@ class MultithreadSampleApplication : public ozz::sample::Application {
   // Number of used characters.
   int num_characters_;
 
+  // The meshes used by the sample.
+  ozz::vector<ozz::sample::Mesh> meshes_;
+
+  // Empty meshes, used when skinning is disabled.
+  const ozz::vector<ozz::sample::Mesh> no_meshes_;
+
+  // Buffers of skinning matrices, one for each mesh. Each buffer stores a
+  // palette per character.
+  ozz::vector<ozz::vector<ozz::math::Float4x4>> palettes_;
+
+  // Characters world transforms.
+  ozz::vector<ozz::math::Float4x4> transforms_;
+
+  // Renders skinned meshes, or skeletons.
+  bool draw_mesh_;
+
   // Does the current plateform actually has threading support.
   bool has_threading_support_;
 
@@ -369,6 +468,10 @@ class MultithreadSampleApplication : public ozz::sample::Application {
 
   // Data used to monitor and analyze threading.
   ParallelMonitor monitor_;
+
+  // Work stealing task scheduler, whose worker threads are created once for
+  // the whole sample lifetime.
+  ozz::WorkStealingScheduler scheduler_;
 };
 
 int main(int _argc, const char** _argv) {
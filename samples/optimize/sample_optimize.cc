@@ -87,9 +87,8 @@ class OptimizeSampleApplication : public ozz::sample::Application {
     }
 
     // Also samples non-optimized animation, from the raw animation.
-    if (!SampleRawAnimation(raw_animation_,
-                            controller_.time_ratio() * raw_animation_.duration,
-                            make_span(locals_raw_))) {
+    if (!raw_sampler_.Sample(controller_.time_ratio() * raw_animation_.duration,
+                             make_span(locals_raw_))) {
       return false;
     }
 
@@ -150,14 +149,14 @@ class OptimizeSampleApplication : public ozz::sample::Application {
     // Computes the absolute error, aka the difference between the raw and
     // runtime model space transformation.
     const size_t num_joints = models_rt_.size();
-    float errors_sq[ozz::animation::Skeleton::kMaxJoints];
+    ozz::vector<float> errors_sq(num_joints);
     for (size_t i = 0; i < num_joints; ++i) {
       // Computes error based on the translation difference.
       errors_sq[i] = ozz::math::GetX(ozz::math::Length3Sqr(
           models_rt_[i].cols[3] - models_raw_[i].cols[3]));
     }
 
-    std::sort(errors_sq, errors_sq + models_rt_.size());
+    std::sort(errors_sq.begin(), errors_sq.end());
     error_record_med_.Push(std::sqrt(errors_sq[num_joints / 2]) * 1000.f);
     error_record_max_.Push(std::sqrt(errors_sq[num_joints - 1]) * 1000.f);
     joint_error_record_.Push(std::sqrt(errors_sq[joint_]) * 1000.f);
@@ -165,53 +164,6 @@ class OptimizeSampleApplication : public ozz::sample::Application {
     return true;
   }
 
-  bool SampleRawAnimation(
-      const ozz::animation::offline::RawAnimation& _animation, float _time,
-      ozz::span<ozz::math::SoaTransform> _locals) {
-    // Ensure output is big enough.
-    if (_locals.size() * 4 < _animation.tracks.size() &&
-        locals_raw_aos_.size() * 4 < _animation.tracks.size()) {
-      return false;
-    }
-
-    // Sample raw animation and converts AoS transforms to SoA transform array.
-    assert(_animation.Validate() && "Animation should be valid.");
-    bool success = true;
-    for (int i = 0; success && i < _animation.num_tracks(); i += 4) {
-      ozz::math::SimdFloat4 translations[4];
-      ozz::math::SimdFloat4 rotations[4];
-      ozz::math::SimdFloat4 scales[4];
-
-      // Works on 4 consecutive tracks, or what remains to be processed if it's
-      // lower than 4.
-      const int jmax = ozz::math::Min(_animation.num_tracks() - i, 4);
-      for (int j = 0; success && j < jmax; ++j) {
-        // Samples raw animation.
-        ozz::math::Transform transform;
-        success &= SampleTrack(_animation.tracks[i + j], _time, &transform);
-
-        // Convert transform to AoS SimdFloat4 values.
-        translations[j] =
-            ozz::math::simd_float4::Load3PtrU(&transform.translation.x);
-        rotations[j] = ozz::math::simd_float4::LoadPtrU(&transform.rotation.x);
-        scales[j] = ozz::math::simd_float4::Load3PtrU(&transform.scale.x);
-      }
-      // Fills remaining transforms.
-      for (int j = jmax; j < 4; ++j) {
-        translations[j] = ozz::math::simd_float4::zero();
-        rotations[j] = ozz::math::simd_float4::w_axis();
-        scales[j] = ozz::math::simd_float4::one();
-      }
-      // Stores AoS keyframes to the SoA output.
-      ozz::math::SoaTransform& output = _locals[i / 4];
-      ozz::math::Transpose4x3(translations, &output.translation.x);
-      ozz::math::Transpose4x4(rotations, &output.rotation.x);
-      ozz::math::Transpose4x3(scales, &output.scale.x);
-    }
-
-    return success;
-  }
-
   // Selects model space matrices according to the display mode.
   ozz::span<const ozz::math::Float4x4> models() const {
     switch (selected_display_) {
@@ -256,7 +208,8 @@ class OptimizeSampleApplication : public ozz::sample::Application {
 
     // Imports offline animation from a binary file.
     // Invalid animations are rejected by the load function.
-    if (!ozz::sample::LoadRawAnimation(OPTIONS_animation, &raw_animation_)) {
+    if (!ozz::sample::LoadRawAnimation(OPTIONS_animation, &raw_animation_) ||
+        !raw_sampler_.Bind(raw_animation_)) {
       return false;
     }
 
@@ -489,6 +442,9 @@ class OptimizeSampleApplication : public ozz::sample::Application {
   // Imported non-optimized animation.
   ozz::animation::offline::RawAnimation raw_animation_;
 
+  // Samples non-optimized animation.
+  ozz::animation::offline::RawAnimationSampler raw_sampler_;
+
   // Optimized raw animation.
   ozz::animation::offline::RawAnimation raw_optimized_animation_;
 
@@ -32,6 +32,7 @@
 #include "framework/renderer.h"
 #include "framework/utils.h"
 #include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blend_mask.h"
 #include "ozz/animation/runtime/blending_job.h"
 #include "ozz/animation/runtime/local_to_model_job.h"
 #include "ozz/animation/runtime/sampling_job.h"
@@ -103,7 +104,7 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
       layers[i].weight = samplers_[i].weight_setting;
 
       // Set per-joint weights for the partially blended layer.
-      layers[i].joint_weights = make_span(samplers_[i].joint_weights);
+      samplers_[i].mask.Apply(&layers[i]);
     }
 
     // Setups blending job.
@@ -162,12 +163,8 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
       // Allocates sampler runtime buffers.
       sampler.locals.resize(num_soa_joints);
 
-      // Allocates per-joint weights used for the partial animation. Note that
-      // this is a Soa structure.
-      sampler.joint_weights.resize(num_soa_joints);
-
       // Allocates a context that matches animation requirements.
-      sampler.context.Resize(num_joints);
+      sampler.context.Resize(num_joints, sampler.animation.cubic());
     }
 
     // Default weight settings.
@@ -195,21 +192,6 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
     return true;
   }
 
-  // Helper functor used to set weights while traversing joints hierarchy.
-  struct WeightSetupIterator {
-    WeightSetupIterator(ozz::vector<ozz::math::SimdFloat4>* _weights,
-                        float _weight_setting)
-        : weights(_weights), weight_setting(_weight_setting) {}
-    void operator()(int _joint, int) {
-      ozz::math::SimdFloat4& soa_weight = weights->at(_joint / 4);
-      soa_weight = ozz::math::SetI(
-          soa_weight, ozz::math::simd_float4::Load1(weight_setting),
-          _joint % 4);
-    }
-    ozz::vector<ozz::math::SimdFloat4>* weights;
-    float weight_setting;
-  };
-
   void SetupPerJointWeights() {
     // Setup partial animation mask. This mask is defined by a weight_setting
     // assigned to each joint of the hierarchy. Joint to disable are set to a
@@ -217,24 +199,16 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
     // Per-joint weights of lower and upper body layers have opposed values
     // (weight_setting and 1 - weight_setting) in order for a layer to select
     // joints that are rejected by the other layer.
+    // Masks also skip SoA joints whose weights are all 0 while blending.
     Sampler& lower_body_sampler = samplers_[kLowerBody];
-    Sampler& upper_body_sampler = samplers_[kUpperBody];
-
-    // Disables all joints: set all weights to 0.
-    for (int i = 0; i < skeleton_.num_soa_joints(); ++i) {
-      lower_body_sampler.joint_weights[i] = ozz::math::simd_float4::one();
-      upper_body_sampler.joint_weights[i] = ozz::math::simd_float4::zero();
-    }
+    lower_body_sampler.mask.Reset(skeleton_, 1.f);
+    lower_body_sampler.mask.SetSubtree(upper_body_root_,
+                                       lower_body_sampler.joint_weight_setting);
 
-    // Sets the weight_setting of all the joints children of the lower and upper
-    // body weights. Note that they are stored in SoA format.
-    WeightSetupIterator lower_it(&lower_body_sampler.joint_weights,
-                                 lower_body_sampler.joint_weight_setting);
-    ozz::animation::IterateJointsDF(skeleton_, lower_it, upper_body_root_);
-
-    WeightSetupIterator upper_it(&upper_body_sampler.joint_weights,
-                                 upper_body_sampler.joint_weight_setting);
-    ozz::animation::IterateJointsDF(skeleton_, upper_it, upper_body_root_);
+    Sampler& upper_body_sampler = samplers_[kUpperBody];
+    upper_body_sampler.mask.Reset(skeleton_, 0.f);
+    upper_body_sampler.mask.SetSubtree(upper_body_root_,
+                                       upper_body_sampler.joint_weight_setting);
   }
 
   virtual void OnDestroy() {}
@@ -375,7 +349,7 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
     // Per-joint weights used to define the partial animation mask. Allows to
     // select which joints are considered during blending, and their individual
     // weight_setting.
-    ozz::vector<ozz::math::SimdFloat4> joint_weights;
+    ozz::animation::BlendMask mask;
   } samplers_[kNumLayers];  // kNumLayers animations to blend.
 
   // Index of the joint at the base of the upper body hierarchy.
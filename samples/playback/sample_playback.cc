@@ -27,6 +27,7 @@
 
 #include "framework/application.h"
 #include "framework/imgui.h"
+#include "framework/profile.h"
 #include "framework/renderer.h"
 #include "framework/utils.h"
 #include "ozz/animation/runtime/animation.h"
@@ -51,7 +52,8 @@ OZZ_OPTIONS_DECLARE_STRING(animation,
 
 class PlaybackSampleApplication : public ozz::sample::Application {
  public:
-  PlaybackSampleApplication() {}
+  PlaybackSampleApplication()
+      : sampling_record_(nullptr), ltm_record_(nullptr) {}
 
  protected:
   // Updates current animation time and skeleton pose.
@@ -65,8 +67,11 @@ class PlaybackSampleApplication : public ozz::sample::Application {
     sampling_job.context = &context_;
     sampling_job.ratio = controller_.time_ratio();
     sampling_job.output = make_span(locals_);
-    if (!sampling_job.Run()) {
-      return false;
+    {
+      ozz::sample::Profiler profile(sampling_record_);
+      if (!sampling_job.Run()) {
+        return false;
+      }
     }
 
     // Converts from local space to model space matrices.
@@ -74,8 +79,11 @@ class PlaybackSampleApplication : public ozz::sample::Application {
     ltm_job.skeleton = &skeleton_;
     ltm_job.input = make_span(locals_);
     ltm_job.output = make_span(models_);
-    if (!ltm_job.Run()) {
-      return false;
+    {
+      ozz::sample::Profiler profile(ltm_record_);
+      if (!ltm_job.Run()) {
+        return false;
+      }
     }
 
     return true;
@@ -110,7 +118,11 @@ class PlaybackSampleApplication : public ozz::sample::Application {
     models_.resize(num_joints);
 
     // Allocates a context that matches animation requirements.
-    context_.Resize(num_joints);
+    context_.Resize(num_joints, animation_.cubic());
+
+    // Jobs timing records.
+    sampling_record_ = ProfileRecord("SamplingJob");
+    ltm_record_ = ProfileRecord("LocalToModelJob");
 
     return true;
   }
@@ -147,6 +159,10 @@ class PlaybackSampleApplication : public ozz::sample::Application {
   // Sampling context.
   ozz::animation::SamplingJob::Context context_;
 
+  // Jobs timing records, owned by the application.
+  ozz::sample::Record* sampling_record_;
+  ozz::sample::Record* ltm_record_;
+
   // Buffer of local transforms as sampled from animation_.
   ozz::vector<ozz::math::SoaTransform> locals_;
 
@@ -75,15 +75,6 @@ class SkinningSampleApplication : public ozz::sample::Application {
       return false;
     }
 
-    // Converts from local space to model space matrices.
-    ozz::animation::LocalToModelJob ltm_job;
-    ltm_job.skeleton = &skeleton_;
-    ltm_job.input = make_span(locals_);
-    ltm_job.output = make_span(models_);
-    if (!ltm_job.Run()) {
-      return false;
-    }
-
     return true;
   }
 
@@ -93,19 +84,34 @@ class SkinningSampleApplication : public ozz::sample::Application {
     const ozz::math::Float4x4 transform = ozz::math::Float4x4::identity();
 
     if (draw_skeleton_) {
+      // Converts from local space to model space matrices.
+      ozz::animation::LocalToModelJob ltm_job;
+      ltm_job.skeleton = &skeleton_;
+      ltm_job.input = make_span(locals_);
+      ltm_job.output = make_span(models_);
+      if (!ltm_job.Run()) {
+        return false;
+      }
+
       success &=
           _renderer->DrawPosture(skeleton_, make_span(models_), transform);
     }
 
     if (draw_mesh_) {
       // Builds skinning matrices, based on the output of the animation stage.
-      // The mesh might not use (aka be skinned by) all skeleton joints. We
-      // use the joint remapping table (available from the mesh object) to
-      // reorder model-space matrices and build skinning ones.
+      // The mesh might not use (aka be skinned by) all skeleton joints. The
+      // joint remapping table (available from the mesh object) is used to
+      // compute only the skinning matrices of the joints the mesh uses,
+      // directly from local-space transforms.
       for (const ozz::sample::Mesh& mesh : meshes_) {
-        for (size_t i = 0; i < mesh.joint_remaps.size(); ++i) {
-          skinning_matrices_[i] =
-              models_[mesh.joint_remaps[i]] * mesh.inverse_bind_poses[i];
+        ozz::animation::LocalToSkinningJob skinning_job;
+        skinning_job.skeleton = &skeleton_;
+        skinning_job.input = make_span(locals_);
+        skinning_job.joint_remaps = make_span(mesh.joint_remaps);
+        skinning_job.inverse_bind_poses = make_span(mesh.inverse_bind_poses);
+        skinning_job.output = make_span(skinning_matrices_);
+        if (!skinning_job.Run()) {
+          return false;
         }
 
         // Renders skin.
@@ -142,7 +148,7 @@ class SkinningSampleApplication : public ozz::sample::Application {
     models_.resize(num_joints);
 
     // Allocates a context that matches animation requirements.
-    context_.Resize(num_joints);
+    context_.Resize(num_joints, animation_.cubic());
 
     // Reading skinned meshes.
     if (!ozz::sample::LoadMeshes(OPTIONS_mesh, &meshes_)) {
@@ -243,6 +249,7 @@ class SkinningSampleApplication : public ozz::sample::Application {
           _im_gui->DoCheckBox("Show colors", &render_options_.colors);
           _im_gui->DoCheckBox("Wireframe", &render_options_.wireframe);
           _im_gui->DoCheckBox("Skip skinning", &render_options_.skip_skinning);
+          _im_gui->DoCheckBox("GPU skinning", &render_options_.gpu_skinning);
         }
       }
     }
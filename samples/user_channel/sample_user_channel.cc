@@ -278,7 +278,7 @@ class UserChannelSampleApplication : public ozz::sample::Application {
     models_.resize(num_joints);
 
     // Allocates a context that matches animation requirements.
-    context_.Resize(num_joints);
+    context_.Resize(num_joints, animation_.cubic());
 
     // Reading track.
     if (!ozz::sample::LoadTrack(OPTIONS_track, &track_)) {
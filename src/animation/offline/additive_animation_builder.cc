@@ -31,6 +31,10 @@
 #include <cstddef>
 
 #include "ozz/animation/offline/raw_animation.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
 #include "ozz/base/maths/transform.h"
 
 namespace ozz {
@@ -70,10 +74,137 @@ math::Float3 MakeDeltaScale(const math::Float3& _reference,
                             const math::Float3& _value) {
   return _value / _reference;
 }
+
+// Reference pose of a joint, splat to all SoA lanes so that deltas are
+// computed for 4 keys at a time. Rotation is stored conjugated.
+struct SoaReference {
+  math::SoaFloat3 translation;
+  math::SoaQuaternion rotation;
+  math::SoaFloat3 scale;
+};
+
+struct SoaDeltaTranslation {
+  math::SoaFloat3 operator()(const math::SoaFloat3& _reference,
+                             const math::SoaFloat3& _value) const {
+    return _value - _reference;
+  }
+};
+
+struct SoaDeltaScale {
+  math::SoaFloat3 operator()(const math::SoaFloat3& _reference,
+                             const math::SoaFloat3& _value) const {
+    return _value / _reference;
+  }
+};
+
+// Computes the deltas of Float3 keys _src, 4 keys at a time. The last group
+// of keys is completed by repeating the last key.
+template <typename _RawTrack, typename _MakeDelta>
+void MakeSoaDelta(const _RawTrack& _src, const math::SoaFloat3& _reference,
+                  const _MakeDelta& _make_delta, _RawTrack* _dest) {
+  const size_t count = _src.size();
+  _dest->resize(count);
+  for (size_t i = 0; i < count; i += 4) {
+    const size_t last = count - 1;
+    const math::Float3& a = _src[i].value;
+    const math::Float3& b = _src[i + 1 < count ? i + 1 : last].value;
+    const math::Float3& c = _src[i + 2 < count ? i + 2 : last].value;
+    const math::Float3& d = _src[i + 3 < count ? i + 3 : last].value;
+    const math::SoaFloat3 value = {math::simd_float4::Load(a.x, b.x, c.x, d.x),
+                                   math::simd_float4::Load(a.y, b.y, c.y, d.y),
+                                   math::simd_float4::Load(a.z, b.z, c.z, d.z)};
+    const math::SoaFloat3 delta = _make_delta(_reference, value);
+
+    float x[4], y[4], z[4];
+    math::StorePtrU(delta.x, x);
+    math::StorePtrU(delta.y, y);
+    math::StorePtrU(delta.z, z);
+    for (size_t j = 0; j < 4 && i + j < count; ++j) {
+      typename _RawTrack::reference key = (*_dest)[i + j];
+      key.time = _src[i + j].time;
+      key.value = math::Float3(x[j], y[j], z[j]);
+    }
+  }
+}
+
+// Computes rotations deltas, 4 keys at a time. See Float3 version.
+void MakeSoaDelta(const RawAnimation::JointTrack::Rotations& _src,
+                  const math::SoaQuaternion& _conjugate_reference,
+                  RawAnimation::JointTrack::Rotations* _dest) {
+  const size_t count = _src.size();
+  _dest->resize(count);
+  for (size_t i = 0; i < count; i += 4) {
+    const size_t last = count - 1;
+    const math::Quaternion& a = _src[i].value;
+    const math::Quaternion& b = _src[i + 1 < count ? i + 1 : last].value;
+    const math::Quaternion& c = _src[i + 2 < count ? i + 2 : last].value;
+    const math::Quaternion& d = _src[i + 3 < count ? i + 3 : last].value;
+    const math::SoaQuaternion value = {
+        math::simd_float4::Load(a.x, b.x, c.x, d.x),
+        math::simd_float4::Load(a.y, b.y, c.y, d.y),
+        math::simd_float4::Load(a.z, b.z, c.z, d.z),
+        math::simd_float4::Load(a.w, b.w, c.w, d.w)};
+    const math::SoaQuaternion delta = value * _conjugate_reference;
+
+    float x[4], y[4], z[4], w[4];
+    math::StorePtrU(delta.x, x);
+    math::StorePtrU(delta.y, y);
+    math::StorePtrU(delta.z, z);
+    math::StorePtrU(delta.w, w);
+    for (size_t j = 0; j < 4 && i + j < count; ++j) {
+      RawAnimation::RotationKey& key = (*_dest)[i + j];
+      key.time = _src[i + j].time;
+      key.value = math::Quaternion(x[j], y[j], z[j], w[j]);
+    }
+  }
+}
+
+struct BuildClipTasks {
+  span<const RawAnimation> inputs;
+  span<const SoaReference> references;
+  span<RawAnimation> outputs;
+  span<uint8_t> results;
+};
+
+void BuildClipTask(int _task, void* _data) {
+  const BuildClipTasks& tasks = *static_cast<const BuildClipTasks*>(_data);
+  const RawAnimation& input = tasks.inputs[_task];
+  RawAnimation& output = tasks.outputs[_task];
+
+  // Reset output animation to default.
+  output = RawAnimation();
+  tasks.results[_task] = false;
+
+  // Validates animation, which must not have more tracks than the reference.
+  if (!input.Validate() ||
+      input.num_tracks() > static_cast<int>(tasks.references.size())) {
+    return;
+  }
+
+  // Rebuilds output animation.
+  output.name = input.name;
+  output.duration = input.duration;
+  output.tracks.resize(input.tracks.size());
+
+  for (size_t i = 0; i < input.tracks.size(); ++i) {
+    const RawAnimation::JointTrack& track_in = input.tracks[i];
+    RawAnimation::JointTrack& track_out = output.tracks[i];
+    const SoaReference& reference = tasks.references[i];
+    MakeSoaDelta(track_in.translations, reference.translation,
+                 SoaDeltaTranslation(), &track_out.translations);
+    MakeSoaDelta(track_in.rotations, reference.rotation, &track_out.rotations);
+    MakeSoaDelta(track_in.scales, reference.scale, SoaDeltaScale(),
+                 &track_out.scales);
+  }
+
+  // Output animation is always valid though.
+  tasks.results[_task] = output.Validate();
+}
 }  // namespace
 
 // Setup default values (favoring quality).
-AdditiveAnimationBuilder::AdditiveAnimationBuilder() {}
+AdditiveAnimationBuilder::AdditiveAnimationBuilder()
+    : parallel_for(nullptr), parallel_for_user_data(nullptr) {}
 
 bool AdditiveAnimationBuilder::operator()(const RawAnimation& _input,
                                           RawAnimation* _output) const {
@@ -161,6 +292,54 @@ bool AdditiveAnimationBuilder::operator()(
   return _output->Validate();
 }
 
+bool AdditiveAnimationBuilder::operator()(
+    span<const RawAnimation> _inputs,
+    const span<const math::Transform>& _reference_pose,
+    span<RawAnimation> _outputs) const {
+  if (_outputs.size() < _inputs.size()) {
+    return false;
+  }
+
+  // Prepares reference pose once for all clips.
+  ozz::vector<SoaReference> references(_reference_pose.size());
+  for (size_t i = 0; i < _reference_pose.size(); ++i) {
+    const math::Transform& transform = _reference_pose[i];
+    const math::Quaternion rotation = Conjugate(transform.rotation);
+    SoaReference& reference = references[i];
+    reference.translation = math::SoaFloat3::Load(
+        math::simd_float4::Load1(transform.translation.x),
+        math::simd_float4::Load1(transform.translation.y),
+        math::simd_float4::Load1(transform.translation.z));
+    reference.rotation = math::SoaQuaternion::Load(
+        math::simd_float4::Load1(rotation.x),
+        math::simd_float4::Load1(rotation.y),
+        math::simd_float4::Load1(rotation.z),
+        math::simd_float4::Load1(rotation.w));
+    reference.scale =
+        math::SoaFloat3::Load(math::simd_float4::Load1(transform.scale.x),
+                              math::simd_float4::Load1(transform.scale.y),
+                              math::simd_float4::Load1(transform.scale.z));
+  }
+
+  const int count = static_cast<int>(_inputs.size());
+  ozz::vector<uint8_t> results(count, 0);
+  const BuildClipTasks tasks = {_inputs, make_span(references), _outputs,
+                                make_span(results)};
+  void* data = const_cast<void*>(static_cast<const void*>(&tasks));
+  if (parallel_for != nullptr && count > 1) {
+    parallel_for(count, &BuildClipTask, data, parallel_for_user_data);
+  } else {
+    for (int i = 0; i < count; ++i) {
+      BuildClipTask(i, data);
+    }
+  }
+
+  bool success = true;
+  for (int i = 0; i < count; ++i) {
+    success &= results[i] != 0;
+  }
+  return success;
+}
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
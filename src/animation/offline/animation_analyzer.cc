@@ -0,0 +1,339 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/animation_analyzer.h"
+
+#include <cmath>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/vec_float.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+typedef int AnimationAnalysis::Track::*KeysCount;
+
+// Counts _keys per track, to _member of _tracks. Keys of SoA padding tracks
+// are ignored.
+template <typename _Key>
+void CountKeys(const span<const _Key>& _keys, KeysCount _member,
+               ozz::vector<AnimationAnalysis::Track>* _tracks) {
+  const int num_tracks = static_cast<int>(_tracks->size());
+  for (const _Key& key : _keys) {
+    const int track = key.track;
+    if (track < num_tracks) {
+      ++((*_tracks)[track].*_member);
+    }
+  }
+}
+
+// Per key size of a transformation type.
+struct KeySizes {
+  size_t current;  // Runtime format.
+  size_t compact;  // Most compact format.
+};
+
+// Gets the size of additional data stored per key, whatever the
+// transformation type.
+size_t KeyExtraSize(const Animation& _animation) {
+  return (_animation.bidirectional() ? sizeof(uint16_t) : 0) +
+         (_animation.random_access() ? sizeof(int) : 0);
+}
+
+// Projects the number of keys of a track limited to _frequency.
+int ProjectKeys(int _keys, float _duration, float _frequency) {
+  const int max_keys =
+      math::Max(2, static_cast<int>(std::ceil(_duration * _frequency)) + 1);
+  return math::Min(_keys, max_keys);
+}
+
+// Accumulates sampled values variation of a track.
+struct TrackRange {
+  math::Float3 translation_min, translation_max;
+  math::Float3 scale_min, scale_max;
+  math::Quaternion first_rotation;
+  float max_rotation_distance;  // Maximum distance to the first rotation.
+};
+
+// Samples _animation at _frame_rate to compute tracks values ranges.
+bool ComputeRanges(const Animation& _animation, float _frame_rate,
+                   ozz::vector<TrackRange>* _ranges) {
+  const int num_tracks = _animation.num_tracks();
+  _ranges->resize(num_tracks);
+
+  SamplingJob::Context context(num_tracks, _animation.cubic());
+  ozz::vector<math::SoaTransform> locals(_animation.num_soa_tracks());
+
+  SamplingJob job;
+  job.animation = &_animation;
+  job.context = &context;
+  job.output = make_span(locals);
+
+  const int num_frames =
+      math::Max(2, static_cast<int>(
+                       std::ceil(_animation.duration() * _frame_rate)) +
+                       1);
+  for (int f = 0; f < num_frames; ++f) {
+    job.ratio = static_cast<float>(f) / static_cast<float>(num_frames - 1);
+    if (!job.Run()) {
+      return false;
+    }
+    float values[10][4];
+    for (int i = 0; i < num_tracks; ++i) {
+      // Extracts track i values from its SoA entry, once per entry.
+      const int lane = i & 3;
+      if (lane == 0) {
+        const math::SoaTransform& soa = locals[i / 4];
+        math::StorePtrU(soa.translation.x, values[0]);
+        math::StorePtrU(soa.translation.y, values[1]);
+        math::StorePtrU(soa.translation.z, values[2]);
+        math::StorePtrU(soa.rotation.x, values[3]);
+        math::StorePtrU(soa.rotation.y, values[4]);
+        math::StorePtrU(soa.rotation.z, values[5]);
+        math::StorePtrU(soa.rotation.w, values[6]);
+        math::StorePtrU(soa.scale.x, values[7]);
+        math::StorePtrU(soa.scale.y, values[8]);
+        math::StorePtrU(soa.scale.z, values[9]);
+      }
+      const math::Float3 translation(values[0][lane], values[1][lane],
+                                     values[2][lane]);
+      // Sampled rotations are only approximately normalized.
+      const math::Quaternion rotation =
+          Normalize(math::Quaternion(values[3][lane], values[4][lane],
+                                     values[5][lane], values[6][lane]));
+      const math::Float3 scale(values[7][lane], values[8][lane],
+                               values[9][lane]);
+
+      TrackRange& range = (*_ranges)[i];
+      if (f == 0) {
+        range.translation_min = range.translation_max = translation;
+        range.scale_min = range.scale_max = scale;
+        range.first_rotation = rotation;
+        range.max_rotation_distance = 0.f;
+      } else {
+        range.translation_min = Min(range.translation_min, translation);
+        range.translation_max = Max(range.translation_max, translation);
+        range.scale_min = Min(range.scale_min, scale);
+        range.scale_max = Max(range.scale_max, scale);
+        // Distance is computed in the first rotation hemisphere, as q and -q
+        // are the same rotation.
+        const math::Quaternion& first = range.first_rotation;
+        const math::Quaternion diff = Dot(first, rotation) < 0.f
+                                          ? first + rotation
+                                          : first + -rotation;
+        range.max_rotation_distance =
+            math::Max(range.max_rotation_distance, std::sqrt(Dot(diff, diff)));
+      }
+    }
+  }
+  return true;
+}
+
+// Tells if all components of _max - _min are within _tolerance.
+bool WithinTolerance(const math::Float3& _min, const math::Float3& _max,
+                     float _tolerance) {
+  const math::Float3 diff = _max - _min;
+  return diff.x <= _tolerance && diff.y <= _tolerance && diff.z <= _tolerance;
+}
+}  // namespace
+
+AnimationAnalysis::AnimationAnalysis()
+    : duration(0.f),
+      size(0),
+      keys_size(0),
+      bytes_per_second(0.f),
+      num_constant_candidates(0),
+      constant_savings(0),
+      compact_size(0) {}
+
+AnimationAnalyzer::AnimationAnalyzer()
+    : translation_tolerance(1e-3f),
+      scale_tolerance(1e-3f),
+      rotation_tolerance(1e-3f),
+      frame_rate(30.f) {
+  tiers.push_back(30.f);
+  tiers.push_back(15.f);
+  tiers.push_back(7.5f);
+}
+
+bool AnimationAnalyzer::operator()(const Animation& _animation,
+                                   AnimationAnalysis* _analysis) const {
+  if (!_analysis) {
+    return false;
+  }
+  *_analysis = AnimationAnalysis();
+
+  // Validates analyzer parameters.
+  if (!(frame_rate > 0.f) || translation_tolerance < 0.f ||
+      scale_tolerance < 0.f || rotation_tolerance < 0.f) {
+    return false;
+  }
+  for (const float tier : tiers) {
+    if (!(tier > 0.f)) {
+      return false;
+    }
+  }
+
+  // Samples animation to find constant candidates.
+  ozz::vector<TrackRange> ranges;
+  if (_animation.num_tracks() != 0 &&
+      !ComputeRanges(_animation, frame_rate, &ranges)) {
+    return false;
+  }
+
+  // Counts keys per track, whatever their format.
+  const int num_tracks = _animation.num_tracks();
+  const AnimationAnalysis::Track zero = {};
+  ozz::vector<AnimationAnalysis::Track> tracks(num_tracks, zero);
+  KeySizes translation, rotation, scale;
+  const size_t extra = KeyExtraSize(_animation);
+  const size_t tangent = _animation.cubic() ? 3 * sizeof(uint16_t) : 0;
+  translation.compact = scale.compact = sizeof(CompactFloat3Key) + extra;
+  rotation.compact = sizeof(PackedQuaternionKey) + extra;
+
+  if (!_animation.compact_translations().empty()) {
+    CountKeys(_animation.compact_translations(),
+              &AnimationAnalysis::Track::translation_keys, &tracks);
+    translation.current = sizeof(CompactFloat3Key);
+  } else {
+    CountKeys(_animation.translations(),
+              &AnimationAnalysis::Track::translation_keys, &tracks);
+    translation.current = sizeof(Float3Key);
+  }
+  if (!_animation.compact_rotations().empty()) {
+    CountKeys(_animation.compact_rotations(),
+              &AnimationAnalysis::Track::rotation_keys, &tracks);
+    rotation.current = sizeof(CompactQuaternionKey);
+  } else if (!_animation.packed_rotations().empty()) {
+    CountKeys(_animation.packed_rotations(),
+              &AnimationAnalysis::Track::rotation_keys, &tracks);
+    rotation.current = sizeof(PackedQuaternionKey);
+  } else {
+    CountKeys(_animation.rotations(), &AnimationAnalysis::Track::rotation_keys,
+              &tracks);
+    rotation.current = sizeof(QuaternionKey);
+  }
+  if (!_animation.compact_scales().empty()) {
+    CountKeys(_animation.compact_scales(),
+              &AnimationAnalysis::Track::scale_keys, &tracks);
+    scale.current = sizeof(CompactFloat3Key);
+  } else {
+    CountKeys(_animation.scales(), &AnimationAnalysis::Track::scale_keys,
+              &tracks);
+    scale.current = sizeof(Float3Key);
+  }
+  translation.current += extra + tangent;
+  translation.compact += tangent;
+  rotation.current += extra;
+  scale.current += extra + tangent;
+  scale.compact += tangent;
+
+  // Fills tracks analysis.
+  const float duration = _animation.duration();
+  // Angle between 2 unit quaternions at distance d is 4 * asin(d / 2).
+  const float max_distance =
+      2.f * std::sin(math::Min(rotation_tolerance, math::kPi) * .25f);
+  AnimationAnalysis& analysis = *_analysis;
+  analysis.tiers.resize(tiers.size());
+  for (size_t t = 0; t < tiers.size(); ++t) {
+    analysis.tiers[t].frequency = tiers[t];
+    analysis.tiers[t].size = 0;
+  }
+  for (int i = 0; i < num_tracks; ++i) {
+    AnimationAnalysis::Track& track = tracks[i];
+    const TrackRange& range = ranges[i];
+    track.keys_per_second =
+        duration > 0.f
+            ? static_cast<float>(track.translation_keys + track.rotation_keys +
+                                 track.scale_keys) /
+                  duration
+            : 0.f;
+    track.size = track.translation_keys * translation.current +
+                 track.rotation_keys * rotation.current +
+                 track.scale_keys * scale.current;
+
+    track.constant_translation =
+        track.translation_keys > 2 &&
+        WithinTolerance(range.translation_min, range.translation_max,
+                        translation_tolerance);
+    track.constant_rotation = track.rotation_keys > 2 &&
+                              range.max_rotation_distance <= max_distance;
+    track.constant_scale =
+        track.scale_keys > 2 &&
+        WithinTolerance(range.scale_min, range.scale_max, scale_tolerance);
+
+    if (track.constant_translation) {
+      ++analysis.num_constant_candidates;
+      analysis.constant_savings +=
+          (track.translation_keys - 2) * translation.current;
+    }
+    if (track.constant_rotation) {
+      ++analysis.num_constant_candidates;
+      analysis.constant_savings += (track.rotation_keys - 2) * rotation.current;
+    }
+    if (track.constant_scale) {
+      ++analysis.num_constant_candidates;
+      analysis.constant_savings += (track.scale_keys - 2) * scale.current;
+    }
+
+    analysis.keys_size += track.size;
+    analysis.compact_size += track.translation_keys * translation.compact +
+                             track.rotation_keys * rotation.compact +
+                             track.scale_keys * scale.compact;
+    for (AnimationAnalysis::Tier& tier : analysis.tiers) {
+      tier.size +=
+          ProjectKeys(track.translation_keys, duration, tier.frequency) *
+              translation.current +
+          ProjectKeys(track.rotation_keys, duration, tier.frequency) *
+              rotation.current +
+          ProjectKeys(track.scale_keys, duration, tier.frequency) *
+              scale.current;
+    }
+  }
+
+  analysis.duration = duration;
+  analysis.size = _animation.size();
+  analysis.bytes_per_second =
+      duration > 0.f ? static_cast<float>(analysis.size) / duration : 0.f;
+  analysis.tracks.swap(tracks);
+  return true;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
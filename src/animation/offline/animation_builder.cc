@@ -29,18 +29,23 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <cstddef>
 #include <cstring>
 #include <limits>
 
 #include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/runtime/animation.h"
+#include "ozz/base/containers/small_vector.h"
 #include "ozz/base/containers/vector.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/linear_allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
 
 // Internal include file
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/offline/cubic.h"
 #include "animation/runtime/animation_keyframe.h"
 
 namespace ozz {
@@ -48,10 +53,14 @@ namespace animation {
 namespace offline {
 namespace {
 
+// Upper bound of the number of seek points an animation can have.
+const int kMaxSeekPoints = 1024;
+
 struct SortingTranslationKey {
   uint16_t track;
   float prev_key_time;
   RawAnimation::TranslationKey key;
+  math::Float3 tangent;  // Only used by cubic animations.
 };
 
 struct SortingRotationKey {
@@ -64,6 +73,7 @@ struct SortingScaleKey {
   uint16_t track;
   float prev_key_time;
   RawAnimation::ScaleKey key;
+  math::Float3 tangent;  // Only used by cubic animations.
 };
 
 // Keyframe sorting. Stores first by time and then track number.
@@ -73,6 +83,81 @@ bool SortingKeyLess(const _Key& _left, const _Key& _right) {
   return time_diff < 0.f || (time_diff == 0.f && _left.track < _right.track);
 }
 
+// Sorts keys according to SortingKeyLess, using a least significant digit radix
+// sort of keys previous time. Keys are pushed sorted by track, and radix passes
+// are stable, so keys sharing the same previous time remain sorted by track.
+// Buffers are reused from one sort to the next.
+class KeySorter {
+ public:
+  template <typename _SortingKey>
+  void operator()(ozz::vector<_SortingKey>* _keys) {
+    const size_t count = _keys->size();
+    if (count == 0) {
+      return;
+    }
+    assert(count <= std::numeric_limits<uint32_t>::max());
+    entries_.resize(count);
+    swap_.resize(count);
+
+    // Builds radix entries, and all passes histograms at once.
+    uint32_t histograms[4][256] = {};
+    for (size_t i = 0; i < count; ++i) {
+      const uint32_t radix = Radix((*_keys)[i].prev_key_time);
+      const Entry entry = {radix, static_cast<uint32_t>(i)};
+      entries_[i] = entry;
+      for (int b = 0; b < 4; ++b) {
+        ++histograms[b][(radix >> (b * 8)) & 0xff];
+      }
+    }
+
+    // Sorts entries, one byte per pass. Passes where all keys share the same
+    // byte are skipped.
+    for (int b = 0; b < 4; ++b) {
+      uint32_t* histogram = histograms[b];
+      if (histogram[(entries_[0].radix >> (b * 8)) & 0xff] == count) {
+        continue;
+      }
+      uint32_t offset = 0;
+      for (int d = 0; d < 256; ++d) {
+        const uint32_t digits = histogram[d];
+        histogram[d] = offset;
+        offset += digits;
+      }
+      for (size_t i = 0; i < count; ++i) {
+        const Entry& entry = entries_[i];
+        swap_[histogram[(entry.radix >> (b * 8)) & 0xff]++] = entry;
+      }
+      entries_.swap(swap_);
+    }
+
+    // Reorders keys.
+    ozz::vector<_SortingKey> sorted(count);
+    for (size_t i = 0; i < count; ++i) {
+      sorted[i] = (*_keys)[entries_[i].index];
+    }
+    _keys->swap(sorted);
+
+    assert(std::is_sorted(_keys->begin(), _keys->end(),
+                          &SortingKeyLess<_SortingKey>));
+  }
+
+ private:
+  // Maps a float to an unsigned integer of the same order.
+  static uint32_t Radix(float _time) {
+    const float time = _time + 0.f;  // Maps -0 to +0, as they're equal.
+    uint32_t bits;
+    std::memcpy(&bits, &time, sizeof(bits));
+    return bits ^ ((bits >> 31) ? 0xffffffffu : 0x80000000u);
+  }
+
+  struct Entry {
+    uint32_t radix;
+    uint32_t index;
+  };
+  ozz::vector<Entry> entries_;
+  ozz::vector<Entry> swap_;
+};
+
 template <typename _SrcKey, typename _DestTrack>
 void PushBackIdentityKey(uint16_t _track, float _time, _DestTrack* _dest) {
   typedef typename _DestTrack::value_type DestKey;
@@ -125,22 +210,74 @@ void CopyRaw(const _SrcTrack& _src, uint16_t _track, float _duration,
          _dest->back().key.time - _duration == 0.f);
 }
 
+// Computes keys tangents, per unit of ratio. Keys must still be sorted
+// per-track, so that neighbors of a key are the adjacent ones of the same
+// track.
 template <typename _SortingKey>
-void CopyToAnimation(ozz::vector<_SortingKey>* _src,
-                     ozz::span<Float3Key>* _dest, float _inv_duration) {
-  const size_t src_count = _src->size();
-  if (!src_count) {
-    return;
+void ComputeTangents(ozz::vector<_SortingKey>* _keys, float _duration) {
+  const size_t count = _keys->size();
+  for (size_t i = 0; i < count; ++i) {
+    _SortingKey& key = (*_keys)[i];
+    const bool has_prev = i > 0 && (*_keys)[i - 1].track == key.track;
+    const bool has_next = i + 1 < count && (*_keys)[i + 1].track == key.track;
+    key.tangent = CubicTangent(has_prev ? &(*_keys)[i - 1].key : nullptr,
+                               key.key,
+                               has_next ? &(*_keys)[i + 1].key : nullptr) *
+                  _duration;
   }
+}
 
-  // Sort animation keys to favor cache coherency.
-  std::sort(&_src->front(), (&_src->back()) + 1, &SortingKeyLess<_SortingKey>);
+// Converts key time to key ratio, quantized according to the key format.
+template <typename _Key>
+void SetKeyRatio(float _time, float _inv_duration, _Key* _dest) {
+  _dest->ratio = _time * _inv_duration;
+}
+uint16_t QuantizeRatio(float _time, float _inv_duration) {
+  const float ratio = math::Clamp(0.f, _time * _inv_duration, 1.f);
+  return static_cast<uint16_t>(
+      floor(ratio * internal::kRatioQuantization + .5f));
+}
+void SetKeyRatio(float _time, float _inv_duration, CompactFloat3Key* _dest) {
+  _dest->ratio = QuantizeRatio(_time, _inv_duration);
+}
+void SetKeyRatio(float _time, float _inv_duration,
+                 CompactQuaternionKey* _dest) {
+  _dest->ratio = QuantizeRatio(_time, _inv_duration);
+}
+void SetKeyRatio(float _time, float _inv_duration,
+                 PackedQuaternionKey* _dest) {
+  _dest->ratio = QuantizeRatio(_time, _inv_duration);
+}
+
+// Tells whether consecutive keys of every track remain distinct once their
+// ratio is quantized to 16 bits. Keys must still be sorted per-track.
+template <typename _SortingKey>
+bool CanQuantizeRatios(const ozz::vector<_SortingKey>& _src,
+                       float _inv_duration) {
+  for (size_t i = 1; i < _src.size(); ++i) {
+    if (_src[i].track == _src[i - 1].track &&
+        QuantizeRatio(_src[i].key.time, _inv_duration) ==
+            QuantizeRatio(_src[i - 1].key.time, _inv_duration)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copies sorted keys to _dest.
+template <typename _SortingKey, typename _Key>
+void CopyToAnimation(const ozz::vector<_SortingKey>& _src,
+                     ozz::span<_Key>* _dest, float _inv_duration) {
+  const size_t src_count = _src.size();
+  if (!src_count || _dest->empty()) {  // _dest is empty if _Key isn't the
+    return;                            // selected keys format.
+  }
 
   // Fills output.
-  const _SortingKey* src = &_src->front();
+  const _SortingKey* src = &_src.front();
   for (size_t i = 0; i < src_count; ++i) {
-    Float3Key& key = (*_dest)[i];
-    key.ratio = src[i].key.time * _inv_duration;
+    _Key& key = (*_dest)[i];
+    SetKeyRatio(src[i].key.time, _inv_duration, &key);
     key.track = src[i].track;
     key.value[0] = ozz::math::FloatToHalf(src[i].key.value.x);
     key.value[1] = ozz::math::FloatToHalf(src[i].key.value.y);
@@ -148,6 +285,21 @@ void CopyToAnimation(ozz::vector<_SortingKey>* _src,
   }
 }
 
+// Copies sorted keys tangents to _dest, as half floats. _dest is empty if
+// animation isn't cubic.
+template <typename _SortingKey>
+void CopyTangents(const ozz::vector<_SortingKey>& _src, span<uint16_t> _dest) {
+  if (_dest.empty()) {
+    return;
+  }
+  assert(_dest.size() == _src.size() * 3);
+  for (size_t i = 0; i < _src.size(); ++i) {
+    _dest[i * 3 + 0] = ozz::math::FloatToHalf(_src[i].tangent.x);
+    _dest[i * 3 + 1] = ozz::math::FloatToHalf(_src[i].tangent.y);
+    _dest[i * 3 + 2] = ozz::math::FloatToHalf(_src[i].tangent.z);
+  }
+}
+
 // Compares float absolute values.
 bool LessAbs(float _left, float _right) {
   return std::abs(_left) < std::abs(_right);
@@ -159,8 +311,12 @@ bool LessAbs(float _left, float _right) {
 // property (x^2+y^2+z^2+w^2 = 1). Because the 3 components are the 3 smallest,
 // their value cannot be greater than sqrt(2)/2. Thus quantization quality is
 // improved by pre-multiplying each componenent by sqrt(2).
-void CompressQuat(const ozz::math::Quaternion& _src,
-                  ozz::animation::QuaternionKey* _dest) {
+//
+// SelectSmallest stores largest component index and sign to _dest, and outputs
+// the 3 smallest components to _smallest.
+template <typename _Key>
+void SelectSmallest(const ozz::math::Quaternion& _src, _Key* _dest,
+                    float _smallest[3]) {
   // Finds the largest quaternion component.
   const float quat[4] = {_src.x, _src.y, _src.z, _src.w};
   const ptrdiff_t largest = std::max_element(quat, quat + 4, LessAbs) - quat;
@@ -170,37 +326,58 @@ void CompressQuat(const ozz::math::Quaternion& _src,
   // Stores the sign of the largest component.
   _dest->sign = quat[largest] < 0.f;
 
-  // Quantize the 3 smallest components on 16 bits signed integers.
-  const float kFloat2Int = 32767.f * math::kSqrt2;
   const int kMapping[4][3] = {{1, 2, 3}, {0, 2, 3}, {0, 1, 3}, {0, 1, 2}};
   const int* map = kMapping[largest];
-  const int a = static_cast<int>(floor(quat[map[0]] * kFloat2Int + .5f));
-  const int b = static_cast<int>(floor(quat[map[1]] * kFloat2Int + .5f));
-  const int c = static_cast<int>(floor(quat[map[2]] * kFloat2Int + .5f));
-  _dest->value[0] = math::Clamp(-32767, a, 32767) & 0xffff;
-  _dest->value[1] = math::Clamp(-32767, b, 32767) & 0xffff;
-  _dest->value[2] = math::Clamp(-32767, c, 32767) & 0xffff;
+  _smallest[0] = quat[map[0]];
+  _smallest[1] = quat[map[1]];
+  _smallest[2] = quat[map[2]];
+}
+
+// Quantizes a smallest component _value, in range [-sqrt(2)/2,sqrt(2)/2], to a
+// signed integer in range [-_scale,_scale].
+int QuantizeSmallest(float _value, int _scale) {
+  const float kFloat2Int = static_cast<float>(_scale) * math::kSqrt2;
+  const int quantized = static_cast<int>(floor(_value * kFloat2Int + .5f));
+  return math::Clamp(-_scale, quantized, _scale);
 }
 
-// Specialize for rotations in order to normalize quaternions.
+// Quantize the 3 smallest components on 16 bits signed integers.
+template <typename _Key>
+void CompressQuat(const ozz::math::Quaternion& _src, _Key* _dest) {
+  const int kScale = internal::QuaternionKeyQuantization<_Key>::kScale;
+  float smallest[3];
+  SelectSmallest(_src, _dest, smallest);
+  _dest->value[0] = QuantizeSmallest(smallest[0], kScale) & 0xffff;
+  _dest->value[1] = QuantizeSmallest(smallest[1], kScale) & 0xffff;
+  _dest->value[2] = QuantizeSmallest(smallest[2], kScale) & 0xffff;
+}
+
+// Quantize the 3 smallest components on 11-11-10 bits signed integers, packed
+// to 32 bits.
+void CompressQuat(const ozz::math::Quaternion& _src,
+                  ozz::animation::PackedQuaternionKey* _dest) {
+  typedef internal::QuaternionKeyQuantization<PackedQuaternionKey> Quantization;
+  float smallest[3];
+  SelectSmallest(_src, _dest, smallest);
+  const uint32_t a = static_cast<uint32_t>(
+      QuantizeSmallest(smallest[0], Quantization::kScale11));
+  const uint32_t b = static_cast<uint32_t>(
+      QuantizeSmallest(smallest[1], Quantization::kScale11));
+  const uint32_t c = static_cast<uint32_t>(
+      QuantizeSmallest(smallest[2], Quantization::kScale10));
+  _dest->value = ((a & 0x7ff) << 21) | ((b & 0x7ff) << 10) | (c & 0x3ff);
+}
+
+// Normalizes rotation keys quaternions.
 // Consecutive opposite quaternions are also fixed up in order to avoid checking
 // for the smallest path during the NLerp runtime algorithm.
-void CopyToAnimation(ozz::vector<SortingRotationKey>* _src,
-                     ozz::span<QuaternionKey>* _dest, float _inv_duration) {
-  const size_t src_count = _src->size();
-  if (!src_count) {
-    return;
-  }
-
-  // Normalize quaternions.
-  // Also fixes-up successive opposite quaternions that would fail to take the
-  // shortest path during the normalized-lerp.
-  // Note that keys are still sorted per-track at that point, which allows this
-  // algorithm to process all consecutive keys.
+// Keys must still be sorted per-track, which allows this algorithm to process
+// all consecutive keys.
+void NormalizeRotations(ozz::vector<SortingRotationKey>* _src) {
   size_t track = std::numeric_limits<size_t>::max();
   const math::Quaternion identity = math::Quaternion::identity();
-  SortingRotationKey* src = &_src->front();
-  for (size_t i = 0; i < src_count; ++i) {
+  SortingRotationKey* src = array_begin(*_src);
+  for (size_t i = 0; i < _src->size(); ++i) {
     math::Quaternion normalized = NormalizeSafe(src[i].key.value, identity);
     if (track != src[i].track) {   // First key of the track.
       if (normalized.w < 0.f) {    // .w eq to a dot with identity quaternion.
@@ -219,38 +396,210 @@ void CopyToAnimation(ozz::vector<SortingRotationKey>* _src,
     src[i].key.value = normalized;
     track = src[i].track;
   }
+}
 
-  // Sort.
-  std::sort(array_begin(*_src), array_end(*_src),
-            &SortingKeyLess<SortingRotationKey>);
+// Specialize for rotations in order to compress quaternions.
+template <typename _Key>
+void CopyToAnimation(const ozz::vector<SortingRotationKey>& _src,
+                     ozz::span<_Key>* _dest, float _inv_duration) {
+  const size_t src_count = _src.size();
+  if (!src_count || _dest->empty()) {  // _dest is empty if _Key isn't the
+    return;                            // selected rotation format.
+  }
 
   // Fills rotation keys output.
   for (size_t i = 0; i < src_count; ++i) {
-    const SortingRotationKey& skey = src[i];
-    QuaternionKey& dkey = (*_dest)[i];
-    dkey.ratio = skey.key.time * _inv_duration;
+    const SortingRotationKey& skey = _src[i];
+    _Key& dkey = (*_dest)[i];
+    SetKeyRatio(skey.key.time, _inv_duration, &dkey);
     dkey.track = skey.track;
 
     // Compress quaternion to destination container.
     CompressQuat(skey.key.value, &dkey);
   }
 }
+
+// Replays SamplingJob cursor algorithm over _keys, up to every seek point
+// ratio. Cursor and cached keys are stored to the seek points of _seek_table,
+// at _type offset (0 for translations, 1 for rotations, 2 for scales).
+template <typename _Key>
+void FillSeekTable(const span<const _Key>& _keys, int _num_soa_tracks,
+                   int _type, span<int> _seek_table) {
+  const int stride = internal::SeekPointStride(_num_soa_tracks);
+  const int num_points = static_cast<int>(_seek_table.size()) / stride;
+  const int num_tracks = _num_soa_tracks * 4;
+  if (_keys.empty()) {  // Unused key format.
+    return;
+  }
+
+  // Initializes cached keys with the first 2 sets of key frames.
+  const memory::ScratchScope scratch;
+  SmallVector<int, 256> cache(num_tracks * 2, scratch.allocator());
+  for (int i = 0; i < num_tracks; ++i) {
+    cache[i * 2] = i;
+    cache[i * 2 + 1] = i + num_tracks;
+  }
+  size_t cursor = num_tracks * 2;
+
+  for (int i = 0; i < num_points; ++i) {
+    const float ratio = internal::SeekPointRatio(i, num_points);
+    while (cursor < _keys.size() &&
+           internal::KeyRatio(_keys[cache[_keys[cursor].track * 2 + 1]]) <=
+               ratio) {
+      const int base = _keys[cursor].track * 2;
+      cache[base] = cache[base + 1];
+      cache[base + 1] = static_cast<int>(cursor);
+      ++cursor;
+    }
+
+    int* point = _seek_table.begin() + i * stride;
+    point[_type] = static_cast<int>(cursor);
+    std::copy(cache.begin(), cache.end(), point + 3 + _type * num_tracks * 2);
+  }
+}
+
+// Tells whether all keys of _track have the same value. Tracks with less than
+// 2 keys are constant too.
+template <typename _Track>
+bool IsConstant(const _Track& _track) {
+  for (size_t i = 1; i < _track.size(); ++i) {
+    if (!(_track[i].value == _track[0].value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Flags all the _num_soa_tracks SoA entries as constant, then unflags the ones
+// containing a non-constant track (of the channel returned by _get_track).
+template <typename _GetTrack>
+void FillConstantFlags(const RawAnimation& _input, int _num_soa_tracks,
+                       const _GetTrack& _get_track, span<uint8_t> _flags) {
+  std::fill(_flags.begin(), _flags.end(), 0);
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    _flags[i / 8] |= 1 << (i & 7);
+  }
+  for (int i = 0; i < _input.num_tracks(); ++i) {
+    if (!IsConstant(_get_track(_input.tracks[i]))) {
+      _flags[i / 32] &= ~(1 << ((i & 0x1f) / 4));
+    }
+  }
+}
+
+// Accessors to RawAnimation joint tracks channels.
+const RawAnimation::JointTrack::Translations& GetTranslations(
+    const RawAnimation::JointTrack& _track) {
+  return _track.translations;
+}
+const RawAnimation::JointTrack::Rotations& GetRotations(
+    const RawAnimation::JointTrack& _track) {
+  return _track.rotations;
+}
+const RawAnimation::JointTrack::Scales& GetScales(
+    const RawAnimation::JointTrack& _track) {
+  return _track.scales;
+}
+
+// Computes, for every key, the offset to the previous key of the same track.
+// Offsets that can't be stored on 16 bits are set to 0, meaning that sampling
+// job will need to search for it.
+template <typename _Key>
+void FillPreviouses(const span<const _Key>& _keys, int _num_tracks,
+                    span<uint16_t> _previouses) {
+  const memory::ScratchScope scratch;
+  SmallVector<size_t, 128> lasts(_num_tracks, 0, scratch.allocator());
+  for (size_t i = 0; i < _keys.size(); ++i) {
+    const int track = _keys[i].track;
+    const size_t offset = i - lasts[track];
+    _previouses[i] = i < static_cast<size_t>(_num_tracks) ||
+                             offset > std::numeric_limits<uint16_t>::max()
+                         ? 0
+                         : static_cast<uint16_t>(offset);
+    lasts[track] = i;
+  }
+}
 }  // namespace
 
+// Keys copied from raw tracks, before being sorted.
+struct AnimationBuilder::SortingKeys {
+  ozz::vector<SortingTranslationKey> translations;
+  ozz::vector<SortingRotationKey> rotations;
+  ozz::vector<SortingScaleKey> scales;
+};
+
+AnimationBuilder::AnimationBuilder()
+    : seek_interval(0.f),
+      bidirectional(false),
+      rotation_format(kRotationDefault),
+      compact_ratios(false),
+      random_access(false),
+      cubic_interpolation(false) {}
+
 // Ensures _input's validity and allocates _animation.
 // An animation needs to have at least two key frames per joint, the first at
 // t = 0 and the last at t = duration. If at least one of those keys are not
 // in the RawAnimation then the builder creates it.
 unique_ptr<Animation> AnimationBuilder::operator()(
     const RawAnimation& _input) const {
-  // Tests _raw_animation validity.
-  if (!_input.Validate()) {
+  unique_ptr<Animation> animation = make_unique<Animation>();
+  if (!(*this)(_input, animation.get())) {
     return nullptr;
   }
+  return animation;
+}
 
-  // Everything is fine, allocates and fills the animation.
+bool AnimationBuilder::operator()(const RawAnimation& _input,
+                                  Animation* _animation) const {
+  const memory::TagScope memory_tag(memory::kTagOffline);
+  // Tests _raw_animation validity.
+  if (!_animation || !_input.Validate()) {
+    return false;
+  }
+
+  // Everything is fine, fills the animation, reusing its buffer if possible.
   // Nothing can fail now.
-  unique_ptr<Animation> animation = make_unique<Animation>();
+  SortingKeys keys;
+  ReserveKeys(_input, &keys);
+  CopyKeys(_input, 0, _input.num_tracks(), &keys);
+  Build(_input, &keys, _animation);
+
+  return true;  // Success.
+}
+
+void AnimationBuilder::ReserveKeys(const RawAnimation& _input,
+                                   SortingKeys* _keys) {
+  // Declares and preallocates tracks to sort.
+  size_t translations = 0, rotations = 0, scales = 0;
+  for (const RawAnimation::JointTrack& raw_track : _input.tracks) {
+    translations += raw_track.translations.size() + 2;  // +2 because worst case
+    rotations += raw_track.rotations.size() + 2;        // needs to add the
+    scales += raw_track.scales.size() + 2;              // first and last keys.
+  }
+  _keys->translations.reserve(translations);
+  _keys->rotations.reserve(rotations);
+  _keys->scales.reserve(scales);
+}
+
+void AnimationBuilder::CopyKeys(const RawAnimation& _input, int _begin,
+                                int _end, SortingKeys* _keys) {
+  // Filters RawAnimation keys and copies them to the output sorting structure.
+  const float duration = _input.duration;
+  for (int t = _begin; t < _end; ++t) {
+    const uint16_t i = static_cast<uint16_t>(t);
+    const RawAnimation::JointTrack& raw_track = _input.tracks[i];
+    CopyRaw(raw_track.translations, i, duration, &_keys->translations);
+    CopyRaw(raw_track.rotations, i, duration, &_keys->rotations);
+    CopyRaw(raw_track.scales, i, duration, &_keys->scales);
+  }
+}
+
+void AnimationBuilder::Build(const RawAnimation& _input, SortingKeys* _keys,
+                             Animation* _animation) const {
+  Animation* animation = _animation;
+  ozz::vector<SortingTranslationKey>& sorting_translations =
+      _keys->translations;
+  ozz::vector<SortingRotationKey>& sorting_rotations = _keys->rotations;
+  ozz::vector<SortingScaleKey>& sorting_scales = _keys->scales;
 
   // Sets duration.
   const float duration = _input.duration;
@@ -267,32 +616,8 @@ unique_ptr<Animation> AnimationBuilder::operator()(
   animation->num_tracks_ = num_tracks;
   const uint16_t num_soa_tracks = Align(num_tracks, 4);
 
-  // Declares and preallocates tracks to sort.
-  size_t translations = 0, rotations = 0, scales = 0;
-  for (uint16_t i = 0; i < num_tracks; ++i) {
-    const RawAnimation::JointTrack& raw_track = _input.tracks[i];
-    translations += raw_track.translations.size() + 2;  // +2 because worst case
-    rotations += raw_track.rotations.size() + 2;        // needs to add the
-    scales += raw_track.scales.size() + 2;              // first and last keys.
-  }
-  ozz::vector<SortingTranslationKey> sorting_translations;
-  sorting_translations.reserve(translations);
-  ozz::vector<SortingRotationKey> sorting_rotations;
-  sorting_rotations.reserve(rotations);
-  ozz::vector<SortingScaleKey> sorting_scales;
-  sorting_scales.reserve(scales);
-
-  // Filters RawAnimation keys and copies them to the output sorting structure.
-  uint16_t i = 0;
-  for (; i < num_tracks; ++i) {
-    const RawAnimation::JointTrack& raw_track = _input.tracks[i];
-    CopyRaw(raw_track.translations, i, duration, &sorting_translations);
-    CopyRaw(raw_track.rotations, i, duration, &sorting_rotations);
-    CopyRaw(raw_track.scales, i, duration, &sorting_scales);
-  }
-
   // Add enough identity keys to match soa requirements.
-  for (; i < num_soa_tracks; ++i) {
+  for (uint16_t i = num_tracks; i < num_soa_tracks; ++i) {
     typedef RawAnimation::TranslationKey SrcTKey;
     PushBackIdentityKey<SrcTKey>(i, 0.f, &sorting_translations);
     PushBackIdentityKey<SrcTKey>(i, duration, &sorting_translations);
@@ -306,22 +631,200 @@ unique_ptr<Animation> AnimationBuilder::operator()(
     PushBackIdentityKey<SrcSKey>(i, duration, &sorting_scales);
   }
 
+  // Computes tangents while keys are still sorted per-track.
+  if (cubic_interpolation) {
+    ComputeTangents(&sorting_translations, duration);
+    ComputeTangents(&sorting_scales, duration);
+  }
+
+  // Computes the number of seek points, evenly distributed along the
+  // animation.
+  int num_seek_points = 0;
+  if (seek_interval > 0.f && num_soa_tracks > 0) {
+    num_seek_points = static_cast<int>(
+        std::ceil(duration / seek_interval) - 1.f);
+    num_seek_points = math::Clamp(0, num_seek_points, kMaxSeekPoints);
+  }
+  const size_t seek_table_size =
+      num_seek_points * internal::SeekPointStride(num_soa_tracks / 4);
+
+  // Selects rotation keys format, falling back to the default one if ratios
+  // can't be quantized.
+  RotationFormat rotations_format = rotation_format;
+  if (rotations_format != kRotationDefault &&
+      !CanQuantizeRatios(sorting_rotations, inv_duration)) {
+    rotations_format = kRotationDefault;
+  }
+  const size_t rotation_count = sorting_rotations.size();
+
+  // Translations and scales ratios are quantized independently, if possible.
+  const bool compact_translations =
+      compact_ratios && CanQuantizeRatios(sorting_translations, inv_duration);
+  const size_t translation_count = sorting_translations.size();
+  const bool compact_scales =
+      compact_ratios && CanQuantizeRatios(sorting_scales, inv_duration);
+  const size_t scale_count = sorting_scales.size();
+
   // Allocate animation members.
-  animation->Allocate(_input.name.length(), sorting_translations.size(),
-                      sorting_rotations.size(), sorting_scales.size());
+  const Animation::AllocateParams params = {
+      _input.name.length(),
+      compact_translations ? 0 : translation_count,
+      compact_translations ? translation_count : 0,
+      rotations_format == kRotationDefault ? rotation_count : 0,
+      rotations_format == kRotationCompact48 ? rotation_count : 0,
+      rotations_format == kRotationCompact32 ? rotation_count : 0,
+      compact_scales ? 0 : scale_count,
+      compact_scales ? scale_count : 0,
+      seek_table_size,
+      bidirectional,
+      static_cast<size_t>((num_soa_tracks / 4 + 7) / 8),
+      random_access,
+      cubic_interpolation};
+  animation->Allocate(params);
+
+  // Normalizes rotations while keys are still sorted per-track.
+  NormalizeRotations(&sorting_rotations);
+
+  // Sort animation keys to favor cache coherency.
+  KeySorter sorter;
+  sorter(&sorting_translations);
+  sorter(&sorting_rotations);
+  sorter(&sorting_scales);
 
   // Copy sorted keys to final animation.
-  CopyToAnimation(&sorting_translations, &animation->translations_,
+  CopyToAnimation(sorting_translations, &animation->translations_,
+                  inv_duration);
+  CopyToAnimation(sorting_translations, &animation->compact_translations_,
                   inv_duration);
-  CopyToAnimation(&sorting_rotations, &animation->rotations_, inv_duration);
-  CopyToAnimation(&sorting_scales, &animation->scales_, inv_duration);
+  CopyToAnimation(sorting_rotations, &animation->rotations_, inv_duration);
+  CopyToAnimation(sorting_rotations, &animation->compact_rotations_,
+                  inv_duration);
+  CopyToAnimation(sorting_rotations, &animation->packed_rotations_,
+                  inv_duration);
+  CopyToAnimation(sorting_scales, &animation->scales_, inv_duration);
+  CopyToAnimation(sorting_scales, &animation->compact_scales_, inv_duration);
+
+  // Copy tangents, now sorted as keys.
+  CopyTangents(sorting_translations, animation->translation_tangents_);
+  CopyTangents(sorting_scales, animation->scale_tangents_);
+
+  // Fills previous keys offsets from sorted keys.
+  if (bidirectional) {
+    FillPreviouses(animation->translations(), num_soa_tracks,
+                   animation->translation_previouses_);
+    FillPreviouses(animation->compact_translations(), num_soa_tracks,
+                   animation->translation_previouses_);
+    FillPreviouses(animation->rotations(), num_soa_tracks,
+                   animation->rotation_previouses_);
+    FillPreviouses(animation->compact_rotations(), num_soa_tracks,
+                   animation->rotation_previouses_);
+    FillPreviouses(animation->packed_rotations(), num_soa_tracks,
+                   animation->rotation_previouses_);
+    FillPreviouses(animation->scales(), num_soa_tracks,
+                   animation->scale_previouses_);
+    FillPreviouses(animation->compact_scales(), num_soa_tracks,
+                   animation->scale_previouses_);
+  }
+
+  // Fills seek points from sorted keys.
+  if (num_seek_points) {
+    const int soa_tracks = num_soa_tracks / 4;
+    FillSeekTable(animation->translations(), soa_tracks, 0,
+                  animation->seek_table_);
+    FillSeekTable(animation->compact_translations(), soa_tracks, 0,
+                  animation->seek_table_);
+    FillSeekTable(animation->rotations(), soa_tracks, 1,
+                  animation->seek_table_);
+    FillSeekTable(animation->compact_rotations(), soa_tracks, 1,
+                  animation->seek_table_);
+    FillSeekTable(animation->packed_rotations(), soa_tracks, 1,
+                  animation->seek_table_);
+    FillSeekTable(animation->scales(), soa_tracks, 2, animation->seek_table_);
+    FillSeekTable(animation->compact_scales(), soa_tracks, 2,
+                  animation->seek_table_);
+  }
+
+  // Flags constant SoA entries, whose interpolation can be skipped.
+  FillConstantFlags(_input, num_soa_tracks / 4, &GetTranslations,
+                    animation->constant_translations_);
+  FillConstantFlags(_input, num_soa_tracks / 4, &GetRotations,
+                    animation->constant_rotations_);
+  FillConstantFlags(_input, num_soa_tracks / 4, &GetScales,
+                    animation->constant_scales_);
+
+  // Fills per track keys indices from sorted keys.
+  if (random_access) {
+    animation->FillTrackIndices();
+  }
 
   // Copy animation's name.
   if (animation->name_) {
     strcpy(animation->name_, _input.name.c_str());
   }
+}
+
+IncrementalAnimationBuilder::IncrementalAnimationBuilder()
+    : input_(nullptr),
+      animation_(nullptr),
+      keys_(nullptr),
+      copied_(0),
+      succeeded_(false) {}
+
+IncrementalAnimationBuilder::~IncrementalAnimationBuilder() { Cancel(); }
+
+bool IncrementalAnimationBuilder::Begin(const AnimationBuilder& _builder,
+                                        const RawAnimation& _input,
+                                        Animation* _animation) {
+  const memory::TagScope memory_tag(memory::kTagOffline);
+  Cancel();
+  succeeded_ = false;
+  if (!_animation || !_input.Validate()) {
+    return false;
+  }
+  builder_ = _builder;
+  input_ = &_input;
+  animation_ = _animation;
+  copied_ = 0;
+  keys_ = New<AnimationBuilder::SortingKeys>();
+  AnimationBuilder::ReserveKeys(_input, keys_);
+  return true;
+}
 
-  return animation;  // Success.
+bool IncrementalAnimationBuilder::Step(int _max_tracks) {
+  if (!keys_) {
+    return true;
+  }
+  const memory::TagScope memory_tag(memory::kTagOffline);
+
+  // Copies tracks keys, then builds the animation once all are copied.
+  const int num_tracks = input_->num_tracks();
+  if (copied_ < num_tracks) {
+    const int end = copied_ + math::Min(math::Max(_max_tracks, 1),
+                                        num_tracks - copied_);
+    AnimationBuilder::CopyKeys(*input_, copied_, end, keys_);
+    copied_ = end;
+    return false;
+  }
+  builder_.Build(*input_, keys_, animation_);
+  succeeded_ = true;
+  Cancel();
+  return true;
+}
+
+void IncrementalAnimationBuilder::Cancel() {
+  Delete(keys_);
+  keys_ = nullptr;
+  input_ = nullptr;
+  animation_ = nullptr;
+}
+
+float IncrementalAnimationBuilder::progress() const {
+  if (!keys_) {
+    return succeeded_ ? 1.f : 0.f;
+  }
+  // Last step, building the animation, counts as much as copying all tracks.
+  const int num_tracks = input_->num_tracks();
+  return num_tracks ? copied_ / (2.f * num_tracks) : 0.f;
 }
 }  // namespace offline
 }  // namespace animation
@@ -33,7 +33,9 @@
 
 // Internal include file
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/offline/cubic.h"
 #include "animation/offline/decimate.h"
+#include "animation/offline/fit.h"
 #include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/offline/raw_animation_utils.h"
 #include "ozz/animation/runtime/skeleton.h"
@@ -42,13 +44,21 @@
 #include "ozz/base/containers/vector.h"
 #include "ozz/base/maths/math_constant.h"
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
 
 namespace ozz {
 namespace animation {
 namespace offline {
 
 // Setup default values (favoring quality).
-AnimationOptimizer::AnimationOptimizer() {}
+AnimationOptimizer::AnimationOptimizer()
+    : reduction(kDecimation),
+      cubic_interpolation(false),
+      error_budget(0.f),
+      parallel_for(nullptr),
+      parallel_for_user_data(nullptr) {}
 
 namespace {
 
@@ -164,6 +174,149 @@ struct HierarchyBuilder {
   const AnimationOptimizer* optimizer;
 };
 
+// Vectorized implementation of Decimate FindFurthest function. Distances of 4
+// consecutive keys are computed at once by _Distances, then only blocks
+// containing a distance above current maximum are scanned, in order, so that
+// the result is the same as the scalar search.
+// Last block is completed by repeating its last key, which can't be selected
+// as its distance isn't strictly greater.
+template <typename _Key, typename _Distances>
+size_t FindFurthestSimd(const _Key* _keys, size_t _first, size_t _last,
+                    float _tolerance, const _Distances& _distances) {
+  size_t candidate = _first;
+  float max = _tolerance;
+  for (size_t i = _first + 1; i < _last; i += 4) {
+    const size_t last = math::Min(i + 3, _last - 1);
+    const _Key* keys[4] = {&_keys[i], &_keys[math::Min(i + 1, last)],
+                           &_keys[math::Min(i + 2, last)], &_keys[last]};
+    const math::SimdFloat4 distances = _distances(keys);
+    const math::SimdInt4 above =
+        math::CmpGt(distances, math::simd_float4::Load1(max));
+    if (!math::MoveMask(above)) {
+      continue;
+    }
+    float values[4];
+    math::StorePtrU(distances, values);
+    for (size_t j = i; j <= last; ++j) {
+      if (values[j - i] > max) {
+        max = values[j - i];
+        candidate = j;
+      }
+    }
+  }
+  return candidate;
+}
+
+// Computes distances of 4 translation or scale keys to their linear
+// interpolation between _left and _right keys, multiplied by _scale. Computes
+// the same operations as PositionAdapter and ScaleAdapter.
+template <typename _Key>
+class Float3Distances {
+ public:
+  Float3Distances(const _Key& _left, const _Key& _right, float _scale)
+      : left_time_(math::simd_float4::Load1(_left.time)),
+        duration_(math::simd_float4::Load1(_right.time - _left.time)),
+        left_{math::simd_float4::Load1(_left.value.x),
+              math::simd_float4::Load1(_left.value.y),
+              math::simd_float4::Load1(_left.value.z)},
+        delta_{math::simd_float4::Load1(_right.value.x - _left.value.x),
+               math::simd_float4::Load1(_right.value.y - _left.value.y),
+               math::simd_float4::Load1(_right.value.z - _left.value.z)},
+        scale_(math::simd_float4::Load1(_scale)) {}
+
+  math::SimdFloat4 operator()(const _Key* const _keys[4]) const {
+    // Time and value of a key are loaded at once, then transposed to SoA.
+    static_assert(sizeof(_Key) == 4 * sizeof(float), "Unexpected key layout");
+    const math::SimdFloat4 aos[4] = {
+        math::simd_float4::LoadPtrU(&_keys[0]->time),
+        math::simd_float4::LoadPtrU(&_keys[1]->time),
+        math::simd_float4::LoadPtrU(&_keys[2]->time),
+        math::simd_float4::LoadPtrU(&_keys[3]->time)};
+    math::SimdFloat4 soa[4];
+    math::Transpose4x4(aos, soa);
+
+    const math::SimdFloat4 alpha = (soa[0] - left_time_) / duration_;
+    const math::SimdFloat4 x = delta_[0] * alpha + left_[0] - soa[1];
+    const math::SimdFloat4 y = delta_[1] * alpha + left_[1] - soa[2];
+    const math::SimdFloat4 z = delta_[2] * alpha + left_[2] - soa[3];
+    return math::Sqrt(x * x + y * y + z * z) * scale_;
+  }
+
+ private:
+  math::SimdFloat4 left_time_;
+  math::SimdFloat4 duration_;
+  math::SimdFloat4 left_[3];
+  math::SimdFloat4 delta_[3];
+  math::SimdFloat4 scale_;
+};
+
+// Computes distances of 4 rotation keys to their normalized linear
+// interpolation between _left and _right keys, as the length of the chord of
+// a circle of _radius. Computes the same operations as RotationAdapter.
+class RotationDistances {
+ public:
+  RotationDistances(const RawAnimation::RotationKey& _left,
+                    const RawAnimation::RotationKey& _right, float _radius)
+      : left_time_(math::simd_float4::Load1(_left.time)),
+        duration_(math::simd_float4::Load1(_right.time - _left.time)),
+        radius_(math::simd_float4::Load1(_radius)) {
+    // Interpolates along the shortest path, like LerpRotation.
+    const math::Quaternion& left = _left.value;
+    const math::Quaternion right =
+        Dot(left, _right.value) < 0.f ? -_right.value : _right.value;
+    left_[0] = math::simd_float4::Load1(left.x);
+    left_[1] = math::simd_float4::Load1(left.y);
+    left_[2] = math::simd_float4::Load1(left.z);
+    left_[3] = math::simd_float4::Load1(left.w);
+    delta_[0] = math::simd_float4::Load1(right.x - left.x);
+    delta_[1] = math::simd_float4::Load1(right.y - left.y);
+    delta_[2] = math::simd_float4::Load1(right.z - left.z);
+    delta_[3] = math::simd_float4::Load1(right.w - left.w);
+  }
+
+  math::SimdFloat4 operator()(
+      const RawAnimation::RotationKey* const _keys[4]) const {
+    // Time and x, y, z are loaded at once, then transposed to SoA.
+    const math::SimdFloat4 aos[4] = {
+        math::simd_float4::LoadPtrU(&_keys[0]->time),
+        math::simd_float4::LoadPtrU(&_keys[1]->time),
+        math::simd_float4::LoadPtrU(&_keys[2]->time),
+        math::simd_float4::LoadPtrU(&_keys[3]->time)};
+    math::SimdFloat4 soa[4];
+    math::Transpose4x4(aos, soa);
+    const math::SimdFloat4 w = math::simd_float4::Load(
+        _keys[0]->value.w, _keys[1]->value.w, _keys[2]->value.w,
+        _keys[3]->value.w);
+
+    // Normalized lerp.
+    const math::SimdFloat4 alpha = (soa[0] - left_time_) / duration_;
+    const math::SimdFloat4 lx = delta_[0] * alpha + left_[0];
+    const math::SimdFloat4 ly = delta_[1] * alpha + left_[1];
+    const math::SimdFloat4 lz = delta_[2] * alpha + left_[2];
+    const math::SimdFloat4 lw = delta_[3] * alpha + left_[3];
+    const math::SimdFloat4 inv_len =
+        math::simd_float4::one() /
+        math::Sqrt(lx * lx + ly * ly + lz * lz + lw * lw);
+
+    // Chord length, from the cosine of the half angle between quaternions.
+    const math::SimdFloat4 cos_half_angle =
+        lx * inv_len * soa[1] + ly * inv_len * soa[2] +
+        lz * inv_len * soa[3] + lw * inv_len * w;
+    const math::SimdFloat4 sine_half_angle =
+        math::Sqrt(math::simd_float4::one() -
+                   math::Min(math::simd_float4::one(),
+                             cos_half_angle * cos_half_angle));
+    return math::simd_float4::Load1(2.f) * sine_half_angle * radius_;
+  }
+
+ private:
+  math::SimdFloat4 left_time_;
+  math::SimdFloat4 duration_;
+  math::SimdFloat4 left_[4];
+  math::SimdFloat4 delta_[4];
+  math::SimdFloat4 radius_;
+};
+
 class PositionAdapter {
  public:
   PositionAdapter(float _scale) : scale_(_scale) {}
@@ -182,6 +335,12 @@ class PositionAdapter {
                  const RawAnimation::TranslationKey& _b) const {
     return Length(_a.value - _b.value) * scale_;
   }
+  size_t Furthest(const RawAnimation::TranslationKey* _keys, size_t _first,
+                  size_t _last, float _tolerance) const {
+    const Float3Distances<RawAnimation::TranslationKey> distances(
+        _keys[_first], _keys[_last], scale_);
+    return FindFurthestSimd(_keys, _first, _last, _tolerance, distances);
+  }
 
  private:
   float scale_;
@@ -213,6 +372,11 @@ class RotationAdapter {
     const float distance = 2.f * sine_half_angle * radius_;
     return distance;
   }
+  size_t Furthest(const RawAnimation::RotationKey* _keys, size_t _first,
+                  size_t _last, float _tolerance) const {
+    const RotationDistances distances(_keys[_first], _keys[_last], radius_);
+    return FindFurthestSimd(_keys, _first, _last, _tolerance, distances);
+  }
 
  private:
   float radius_;
@@ -235,15 +399,271 @@ class ScaleAdapter {
                  const RawAnimation::ScaleKey& _right) const {
     return Length(_left.value - _right.value) * length_;
   }
+  size_t Furthest(const RawAnimation::ScaleKey* _keys, size_t _first,
+                  size_t _last, float _tolerance) const {
+    const Float3Distances<RawAnimation::ScaleKey> distances(
+        _keys[_first], _keys[_last], length_);
+    return FindFurthestSimd(_keys, _first, _last, _tolerance, distances);
+  }
 
  private:
   float length_;
 };
+
+// Replaces _dest decimated keys by _src fitted ones if _reduction algorithm is
+// fitting, and fitting produces less keys.
+template <typename _Track, typename _Adapter>
+void FitIfSmaller(const _Track& _src, const _Adapter& _adapter,
+                  float _tolerance, bool _cubic,
+                  AnimationOptimizer::Reduction _reduction, _Track* _dest) {
+  _Track fitted;
+  if (_reduction == AnimationOptimizer::kFitting &&
+      Fit(_src, _adapter, _tolerance, _cubic, &fitted) &&
+      fitted.size() < _dest->size()) {
+    _dest->swap(fitted);
+  }
+}
+
+// Reduces _src translations or scales track keys, according to interpolation
+// mode and _reduction algorithm. Cubic tracks are first completed with the
+// first (t = 0) and last (t = _duration) keys that AnimationBuilder would add,
+// as they affect neighbors tangents.
+template <typename _Track, typename _Adapter>
+void ReduceFloat3s(const _Track& _src, const _Adapter& _adapter,
+                   float _tolerance, float _duration, bool _cubic,
+                   AnimationOptimizer::Reduction _reduction, _Track* _dest) {
+  if (!_cubic || _src.size() < 2) {
+    Decimate(_src, _adapter, _tolerance, _dest);
+    FitIfSmaller(_src, _adapter, _tolerance, false, _reduction, _dest);
+    return;
+  }
+  _Track track;
+  if (_src.front().time != 0.f) {
+    const typename _Track::value_type first = {0.f, _src.front().value};
+    track.push_back(first);
+  }
+  track.insert(track.end(), _src.begin(), _src.end());
+  if (_src.back().time != _duration) {
+    const typename _Track::value_type last = {_duration, _src.back().value};
+    track.push_back(last);
+  }
+  DecimateCubic(track, _adapter, _tolerance, _dest);
+  FitIfSmaller(track, _adapter, _tolerance, true, _reduction, _dest);
+}
+// Shared data of optimization tasks. Every level of detail and track are
+// independent once hierarchy is computed, so each can be a task.
+struct OptimizeTasks {
+  const AnimationOptimizer* optimizer;
+  const RawAnimation* input;
+  const Skeleton* skeleton;
+  const HierarchyBuilder* hierarchy;
+
+  // Tolerance scale of each level.
+  span<const float> scales;
+
+  // Output animation of each level.
+  span<RawAnimation> outputs;
+};
+
+// Optimizes track _joint of _tasks input to _output, with _tolerance.
+void OptimizeJoint(const OptimizeTasks& _tasks, int _joint, float _tolerance,
+                   RawAnimation::JointTrack* _output) {
+  const RawAnimation::JointTrack& input = _tasks.input->tracks[_joint];
+
+  // Gets joint specs back.
+  const HierarchyBuilder& hierarchy = *_tasks.hierarchy;
+  const float joint_length = hierarchy.specs[_joint].length;
+  const int parent = _tasks.skeleton->joint_parents()[_joint];
+  const float parent_scale =
+      (parent != Skeleton::kNoParent) ? hierarchy.specs[parent].scale : 1.f;
+
+  const float duration = _tasks.input->duration;
+  const bool cubic = _tasks.optimizer->cubic_interpolation;
+  const AnimationOptimizer::Reduction reduction = _tasks.optimizer->reduction;
+
+  // Filters independently T, R and S tracks.
+  // This joint translation is affected by parent scale.
+  const PositionAdapter tadap(parent_scale);
+  ReduceFloat3s(input.translations, tadap, _tolerance, duration, cubic,
+                reduction, &_output->translations);
+  // This joint rotation affects children translations/length.
+  const RotationAdapter radap(joint_length);
+  Decimate(input.rotations, radap, _tolerance, &_output->rotations);
+  FitIfSmaller(input.rotations, radap, _tolerance, false, reduction,
+               &_output->rotations);
+  // This joint scale affects children translations/length.
+  const ScaleAdapter sadap(joint_length);
+  ReduceFloat3s(input.scales, sadap, _tolerance, duration, cubic, reduction,
+                &_output->scales);
+}
+
+// Optimizes track _task % num_tracks of level _task / num_tracks.
+void OptimizeTrack(int _task, void* _data) {
+  const OptimizeTasks& tasks = *static_cast<const OptimizeTasks*>(_data);
+  const int num_tracks = tasks.input->num_tracks();
+  const int i = _task % num_tracks;
+  const int level = _task / num_tracks;
+  const float tolerance =
+      tasks.hierarchy->specs[i].tolerance * tasks.scales[level];
+  OptimizeJoint(tasks, i, tolerance, &tasks.outputs[level].tracks[i]);
+}
+
+// Rebuilds output animations of all levels of _tasks, before tracks are
+// optimized.
+void PrepareOutputs(const OptimizeTasks& _tasks) {
+  for (size_t i = 0; i < _tasks.scales.size(); ++i) {
+    RawAnimation& output = _tasks.outputs[i];
+    output.name = _tasks.input->name;
+    output.duration = _tasks.input->duration;
+    output.tracks.resize(_tasks.input->num_tracks());
+  }
+}
+
+// Runs _count tasks, using _optimizer parallel_for if provided.
+void RunTasks(const AnimationOptimizer& _optimizer, int _count,
+              AnimationOptimizer::ParallelForTask _task, const void* _data) {
+  void* data = const_cast<void*>(_data);
+  if (_optimizer.parallel_for != nullptr && _count > 1) {
+    _optimizer.parallel_for(_count, _task, data,
+                            _optimizer.parallel_for_user_data);
+  } else {
+    for (int i = 0; i < _count; ++i) {
+      _task(i, data);
+    }
+  }
+}
+
+// Optimizes all tracks of all levels of _tasks, using optimizer parallel_for
+// if provided.
+void Optimize(const OptimizeTasks& _tasks) {
+  PrepareOutputs(_tasks);
+
+  const int num_tracks = _tasks.input->num_tracks();
+  const int count = static_cast<int>(_tasks.scales.size()) * num_tracks;
+  RunTasks(*_tasks.optimizer, count, &OptimizeTrack, &_tasks);
+}
+
+// Number of tolerances used to measure joints sensitivity: 0, then error
+// budget divided by decreasing powers of 2, up to the whole budget.
+const int kBudgetLevels = 8;
+
+// Shared data of sensitivity measurement tasks, one task per joint and ladder
+// tolerance.
+struct SensitivityTasks {
+  const OptimizeTasks* tasks;
+
+  // Ladder of tolerances, kBudgetLevels increasing values.
+  span<const float> ladder;
+
+  // Number of keys of each joint, for each ladder tolerance.
+  span<int> keys;
+};
+
+// Counts keys of track _task / kBudgetLevels, optimized with ladder tolerance
+// _task % kBudgetLevels.
+void MeasureSensitivity(int _task, void* _data) {
+  const SensitivityTasks& tasks = *static_cast<const SensitivityTasks*>(_data);
+  RawAnimation::JointTrack track;
+  OptimizeJoint(*tasks.tasks, _task / kBudgetLevels,
+                tasks.ladder[_task % kBudgetLevels], &track);
+  tasks.keys[_task] = static_cast<int>(
+      track.translations.size() + track.rotations.size() + track.scales.size());
+}
+
+// Distributes _optimizer error budget to joints tolerances, so that the sum of
+// the tolerances along every chain from a root to a leaf doesn't exceed the
+// budget. Tolerances are raised greedily from 0, along the ladder, choosing
+// each time the joint that saves the more keys per unit of budget consumed.
+// Raising a joint tolerance consumes budget on every chain it belongs to,
+// hence for all its leaves. This naturally gives more slack to leaves than to
+// joints close to the root.
+void AllocateErrorBudget(const AnimationOptimizer& _optimizer,
+                         const RawAnimation& _input, const Skeleton& _skeleton,
+                         HierarchyBuilder* _hierarchy) {
+  const int num_joints = _skeleton.num_joints();
+  const float budget = _optimizer.error_budget;
+  float ladder[kBudgetLevels] = {0.f};
+  for (int i = 1; i < kBudgetLevels; ++i) {
+    ladder[i] = budget / static_cast<float>(1 << (kBudgetLevels - 1 - i));
+  }
+
+  // Measures number of keys of every joint, for every ladder tolerance.
+  ozz::vector<int> keys(static_cast<size_t>(num_joints) * kBudgetLevels);
+  const OptimizeTasks tasks = {&_optimizer, &_input, &_skeleton,
+                               _hierarchy,  {},      {}};
+  const SensitivityTasks sensitivity = {&tasks, ladder, make_span(keys)};
+  RunTasks(_optimizer, num_joints * kBudgetLevels, &MeasureSensitivity,
+           &sensitivity);
+
+  // Number of leaves of each joint hierarchy. Skeleton joints are sorted
+  // parents first, so children are processed before their parent.
+  const span<const int16_t> parents = _skeleton.joint_parents();
+  ozz::vector<int> leaves(num_joints, 0);
+  for (int i = num_joints - 1; i >= 0; --i) {
+    leaves[i] = math::Max(leaves[i], 1);
+    if (parents[i] != Skeleton::kNoParent) {
+      leaves[parents[i]] += leaves[i];
+    }
+  }
+
+  ozz::vector<int> levels(num_joints, 0);
+  ozz::vector<float> tolerances(num_joints, 0.f);
+  ozz::vector<float> above(num_joints), below(num_joints);
+  for (;;) {
+    // Accumulated tolerances of each joint and its parents (above), and
+    // maximum accumulated tolerance of its children chains (below).
+    for (int i = 0; i < num_joints; ++i) {
+      above[i] = tolerances[i];
+      if (parents[i] != Skeleton::kNoParent) {
+        above[i] += above[parents[i]];
+      }
+      below[i] = 0.f;
+    }
+    for (int i = num_joints - 1; i >= 0; --i) {
+      if (parents[i] != Skeleton::kNoParent) {
+        below[parents[i]] =
+            math::Max(below[parents[i]], tolerances[i] + below[i]);
+      }
+    }
+
+    // Finds the most efficient tolerance raise that fits in the budget.
+    int best_joint = -1;
+    int best_level = 0;
+    float best_ratio = 0.f;
+    for (int i = 0; i < num_joints; ++i) {
+      const float others = above[i] + below[i] - tolerances[i];
+      const int* joint_keys = &keys[static_cast<size_t>(i) * kBudgetLevels];
+      for (int l = levels[i] + 1; l < kBudgetLevels; ++l) {
+        if (others + ladder[l] > budget) {
+          break;
+        }
+        const int saved = joint_keys[levels[i]] - joint_keys[l];
+        const float ratio =
+            saved / ((ladder[l] - tolerances[i]) * leaves[i]);
+        if (saved > 0 && ratio > best_ratio) {
+          best_joint = i;
+          best_level = l;
+          best_ratio = ratio;
+        }
+      }
+    }
+    if (best_joint < 0) {
+      break;
+    }
+    levels[best_joint] = best_level;
+    tolerances[best_joint] = ladder[best_level];
+  }
+
+  for (int i = 0; i < num_joints; ++i) {
+    _hierarchy->specs[i].tolerance = tolerances[i];
+  }
+}
 }  // namespace
 
 bool AnimationOptimizer::operator()(const RawAnimation& _input,
                                     const Skeleton& _skeleton,
                                     RawAnimation* _output) const {
+  const memory::TagScope memory_tag(memory::kTagOffline);
   if (!_output) {
     return false;
   }
@@ -255,47 +675,171 @@ bool AnimationOptimizer::operator()(const RawAnimation& _input,
     return false;
   }
 
-  const int num_tracks = _input.num_tracks();
-
   // Validates the skeleton matches the animation.
-  if (num_tracks != _skeleton.num_joints()) {
+  if (_input.num_tracks() != _skeleton.num_joints()) {
     return false;
   }
 
   // First computes bone lengths, that will be used when filtering.
-  const HierarchyBuilder hierarchy(&_input, &_skeleton, this);
-
-  // Rebuilds output animation.
-  _output->name = _input.name;
-  _output->duration = _input.duration;
-  _output->tracks.resize(num_tracks);
-
-  for (int i = 0; i < num_tracks; ++i) {
-    const RawAnimation::JointTrack& input = _input.tracks[i];
-    RawAnimation::JointTrack& output = _output->tracks[i];
-
-    // Gets joint specs back.
-    const float joint_length = hierarchy.specs[i].length;
-    const int parent = _skeleton.joint_parents()[i];
-    const float parent_scale =
-        (parent != Skeleton::kNoParent) ? hierarchy.specs[parent].scale : 1.f;
-    const float tolerance = hierarchy.specs[i].tolerance;
-
-    // Filters independently T, R and S tracks.
-    // This joint translation is affected by parent scale.
-    const PositionAdapter tadap(parent_scale);
-    Decimate(input.translations, tadap, tolerance, &output.translations);
-    // This joint rotation affects children translations/length.
-    const RotationAdapter radap(joint_length);
-    Decimate(input.rotations, radap, tolerance, &output.rotations);
-    // This joint scale affects children translations/length.
-    const ScaleAdapter sadap(joint_length);
-    Decimate(input.scales, sadap, tolerance, &output.scales);
+  HierarchyBuilder hierarchy(&_input, &_skeleton, this);
+  if (error_budget > 0.f) {
+    AllocateErrorBudget(*this, _input, _skeleton, &hierarchy);
   }
 
+  const float scale = 1.f;
+  const OptimizeTasks tasks = {this,      &_input,     &_skeleton,
+                               &hierarchy, {&scale, 1}, {_output, 1}};
+  Optimize(tasks);
+
   // Output animation is always valid though.
   return _output->Validate();
 }
+
+bool AnimationOptimizer::operator()(const RawAnimation& _input,
+                                    const Skeleton& _skeleton,
+                                    span<const float> _tolerances,
+                                    span<RawAnimation> _outputs) const {
+  const memory::TagScope memory_tag(memory::kTagOffline);
+  if (_outputs.size() < _tolerances.size()) {
+    return false;
+  }
+  // Reset output animations to default.
+  for (RawAnimation& output : _outputs) {
+    output = RawAnimation();
+  }
+
+  // Validate animation.
+  if (!_input.Validate()) {
+    return false;
+  }
+
+  // Validates the skeleton matches the animation.
+  if (_input.num_tracks() != _skeleton.num_joints()) {
+    return false;
+  }
+
+  // Validates tolerances, which are relative to the global setting one, or to
+  // the error budget.
+  const float reference = error_budget > 0.f ? error_budget : setting.tolerance;
+  for (float tolerance : _tolerances) {
+    if (!(tolerance >= 0.f) || (tolerance > 0.f && !(reference > 0.f))) {
+      return false;
+    }
+  }
+
+  // First computes bone lengths, that will be used when filtering. They're
+  // computed once for all levels, as well as error budget allocation.
+  HierarchyBuilder hierarchy(&_input, &_skeleton, this);
+  if (error_budget > 0.f) {
+    AllocateErrorBudget(*this, _input, _skeleton, &hierarchy);
+  }
+
+  ozz::vector<float> scales(_tolerances.size());
+  for (size_t i = 0; i < _tolerances.size(); ++i) {
+    scales[i] = _tolerances[i] > 0.f ? _tolerances[i] / reference : 0.f;
+  }
+  const OptimizeTasks tasks = {this,
+                               &_input,
+                               &_skeleton,
+                               &hierarchy,
+                               make_span(scales),
+                               _outputs.first(_tolerances.size())};
+  Optimize(tasks);
+
+  // Output animations are always valid though.
+  bool valid = true;
+  for (size_t i = 0; i < _tolerances.size(); ++i) {
+    valid &= _outputs[i].Validate();
+  }
+  return valid;
+}
+
+// Optimization state, whose optimizer settings and hierarchy outlive Begin().
+struct IncrementalAnimationOptimizer::Impl {
+  Impl(const AnimationOptimizer& _optimizer, const RawAnimation& _input,
+       const Skeleton& _skeleton, RawAnimation* _output)
+      : optimizer(_optimizer),
+        hierarchy(&_input, &_skeleton, &optimizer),
+        scale(1.f),
+        next(0) {
+    optimizer.parallel_for = nullptr;  // Ignored by incremental optimization.
+    if (optimizer.error_budget > 0.f) {
+      AllocateErrorBudget(optimizer, _input, _skeleton, &hierarchy);
+    }
+    const OptimizeTasks init = {&optimizer, &_input,     &_skeleton,
+                                &hierarchy, {&scale, 1}, {_output, 1}};
+    tasks = init;
+  }
+
+  AnimationOptimizer optimizer;
+  HierarchyBuilder hierarchy;
+  float scale;
+  OptimizeTasks tasks;
+
+  // Next track to optimize.
+  int next;
+};
+
+IncrementalAnimationOptimizer::IncrementalAnimationOptimizer()
+    : impl_(nullptr), succeeded_(false) {}
+
+IncrementalAnimationOptimizer::~IncrementalAnimationOptimizer() { Cancel(); }
+
+bool IncrementalAnimationOptimizer::Begin(const AnimationOptimizer& _optimizer,
+                                          const RawAnimation& _input,
+                                          const Skeleton& _skeleton,
+                                          RawAnimation* _output) {
+  const memory::TagScope memory_tag(memory::kTagOffline);
+  Cancel();
+  succeeded_ = false;
+  if (!_output) {
+    return false;
+  }
+  *_output = RawAnimation();
+  if (!_input.Validate() || _input.num_tracks() != _skeleton.num_joints()) {
+    return false;
+  }
+
+  // Computes bone lengths once, then prepares output for tracks optimization.
+  impl_ = New<Impl>(_optimizer, _input, _skeleton, _output);
+  PrepareOutputs(impl_->tasks);
+  return true;
+}
+
+bool IncrementalAnimationOptimizer::Step(int _max_tracks) {
+  if (!impl_) {
+    return true;
+  }
+  const memory::TagScope memory_tag(memory::kTagOffline);
+  const int num_tracks = impl_->tasks.input->num_tracks();
+  const int end = impl_->next + math::Min(math::Max(_max_tracks, 1),
+                                          num_tracks - impl_->next);
+  void* data = &impl_->tasks;
+  for (; impl_->next < end; ++impl_->next) {
+    OptimizeTrack(impl_->next, data);
+  }
+  if (impl_->next < num_tracks) {
+    return false;
+  }
+
+  // Output animation is always valid though.
+  succeeded_ = impl_->tasks.outputs[0].Validate();
+  Cancel();
+  return true;
+}
+
+void IncrementalAnimationOptimizer::Cancel() {
+  Delete(impl_);
+  impl_ = nullptr;
+}
+
+float IncrementalAnimationOptimizer::progress() const {
+  if (!impl_) {
+    return succeeded_ ? 1.f : 0.f;
+  }
+  const int num_tracks = impl_->tasks.input->num_tracks();
+  return num_tracks ? static_cast<float>(impl_->next) / num_tracks : 0.f;
+}
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
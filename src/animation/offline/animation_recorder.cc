@@ -0,0 +1,234 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/animation_recorder.h"
+
+#include <cassert>
+#include <cmath>
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/offline/decimate.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+
+// Decimation adapters, see decimate.h. Distances are expressed in the unit of
+// each transformation tolerance.
+template <typename _Key, math::Float3 (*_Lerp)(const math::Float3&,
+                                               const math::Float3&, float)>
+struct RecordFloat3Adapter {
+  bool Decimable(const _Key&) const { return true; }
+  _Key Lerp(const _Key& _left, const _Key& _right, const _Key& _ref) const {
+    const float alpha = (_ref.time - _left.time) / (_right.time - _left.time);
+    assert(alpha >= 0.f && alpha <= 1.f);
+    const _Key key = {_ref.time, _Lerp(_left.value, _right.value, alpha)};
+    return key;
+  }
+  float Distance(const _Key& _a, const _Key& _b) const {
+    return Length(_a.value - _b.value);
+  }
+};
+typedef RecordFloat3Adapter<RawAnimation::TranslationKey, LerpTranslation>
+    RecordTranslationAdapter;
+typedef RecordFloat3Adapter<RawAnimation::ScaleKey, LerpScale>
+    RecordScaleAdapter;
+
+struct RecordRotationAdapter {
+  bool Decimable(const RawAnimation::RotationKey&) const { return true; }
+  RawAnimation::RotationKey Lerp(const RawAnimation::RotationKey& _left,
+                                 const RawAnimation::RotationKey& _right,
+                                 const RawAnimation::RotationKey& _ref) const {
+    const float alpha = (_ref.time - _left.time) / (_right.time - _left.time);
+    assert(alpha >= 0.f && alpha <= 1.f);
+    const RawAnimation::RotationKey key = {
+        _ref.time, LerpRotation(_left.value, _right.value, alpha)};
+    return key;
+  }
+  float Distance(const RawAnimation::RotationKey& _a,
+                 const RawAnimation::RotationKey& _b) const {
+    // Shortest unsigned angle between the 2 quaternions.
+    const float cos_half_angle =
+        math::Min(1.f, std::abs(Dot(_a.value, _b.value)));
+    return 2.f * std::acos(cos_half_angle);
+  }
+};
+}  // namespace
+
+struct AnimationRecorder::Recording {
+  typedef StreamDecimator<RawAnimation::JointTrack::Translations,
+                          RecordTranslationAdapter>
+      TranslationDecimator;
+  typedef StreamDecimator<RawAnimation::JointTrack::Rotations,
+                          RecordRotationAdapter>
+      RotationDecimator;
+  typedef StreamDecimator<RawAnimation::JointTrack::Scales, RecordScaleAdapter>
+      ScaleDecimator;
+
+  Recording(int _num_tracks, const char* _name,
+            const AnimationRecorder& _recorder) {
+    raw_animation.name = _name;
+    raw_animation.tracks.resize(_num_tracks);
+
+    // Decimators output to raw animation tracks, which won't be resized
+    // anymore.
+    const size_t max_pending =
+        static_cast<size_t>(math::Max(_recorder.max_latency, 1));
+    translations.reserve(_num_tracks);
+    rotations.reserve(_num_tracks);
+    scales.reserve(_num_tracks);
+    for (int i = 0; i < _num_tracks; ++i) {
+      RawAnimation::JointTrack& track = raw_animation.tracks[i];
+      translations.emplace_back(RecordTranslationAdapter(),
+                                _recorder.translation_tolerance, max_pending,
+                                &track.translations);
+      rotations.emplace_back(RecordRotationAdapter(),
+                             _recorder.rotation_tolerance, max_pending,
+                             &track.rotations);
+      scales.emplace_back(RecordScaleAdapter(), _recorder.scale_tolerance,
+                          max_pending, &track.scales);
+    }
+  }
+
+  RawAnimation raw_animation;
+  ozz::vector<TranslationDecimator> translations;
+  ozz::vector<RotationDecimator> rotations;
+  ozz::vector<ScaleDecimator> scales;
+};
+
+AnimationRecorder::AnimationRecorder()
+    : translation_tolerance(1e-3f),  // 1 mm.
+      rotation_tolerance(1e-3f),
+      scale_tolerance(1e-3f),
+      max_latency(16),
+      recording_(nullptr),
+      first_time_(0.f),
+      last_time_(0.f),
+      num_frames_(0) {}
+
+AnimationRecorder::~AnimationRecorder() { ozz::Delete(recording_); }
+
+void AnimationRecorder::Start(int _num_tracks, const char* _name) {
+  ozz::Delete(recording_);
+  recording_ = ozz::New<Recording>(_num_tracks, _name, *this);
+  first_time_ = 0.f;
+  last_time_ = 0.f;
+  num_frames_ = 0;
+}
+
+bool AnimationRecorder::Record(float _time,
+                               span<const math::SoaTransform> _pose) {
+  if (!recording_) {
+    return false;
+  }
+  const int num_tracks = recording_->raw_animation.num_tracks();
+  if (_pose.size() * 4 < static_cast<size_t>(num_tracks)) {
+    return false;
+  }
+  if (num_frames_ == 0) {
+    first_time_ = _time;
+  } else if (!(_time > last_time_)) {
+    return false;
+  }
+  last_time_ = _time;
+  ++num_frames_;
+
+  const float time = _time - first_time_;
+  for (int i = 0; i < num_tracks; i += 4) {
+    // Transposes SoA data to AoS.
+    const math::SoaTransform& soa_transform = _pose[i / 4];
+    math::SimdFloat4 translations[4];
+    math::Transpose3x4(&soa_transform.translation.x, translations);
+    math::SimdFloat4 rotations[4];
+    math::Transpose4x4(&soa_transform.rotation.x, rotations);
+    math::SimdFloat4 scales[4];
+    math::Transpose3x4(&soa_transform.scale.x, scales);
+
+    for (int j = 0; j < 4 && i + j < num_tracks; ++j) {
+      RawAnimation::TranslationKey tkey;
+      tkey.time = time;
+      math::Store3PtrU(translations[j], &tkey.value.x);
+      recording_->translations[i + j].Push(tkey);
+
+      RawAnimation::RotationKey rkey;
+      rkey.time = time;
+      math::StorePtrU(rotations[j], &rkey.value.x);
+      recording_->rotations[i + j].Push(rkey);
+
+      RawAnimation::ScaleKey skey;
+      skey.time = time;
+      math::Store3PtrU(scales[j], &skey.value.x);
+      recording_->scales[i + j].Push(skey);
+    }
+  }
+  return true;
+}
+
+bool AnimationRecorder::Build(Animation* _animation) {
+  if (!recording_ || num_frames_ < 2) {
+    return false;
+  }
+
+  // Outputs pending keys, so that all tracks end with the last recorded pose.
+  const int num_tracks = recording_->raw_animation.num_tracks();
+  for (int i = 0; i < num_tracks; ++i) {
+    recording_->translations[i].Flush();
+    recording_->rotations[i].Flush();
+    recording_->scales[i].Flush();
+  }
+
+  recording_->raw_animation.duration = last_time_ - first_time_;
+  return builder(recording_->raw_animation, _animation);
+}
+
+size_t AnimationRecorder::num_keys() const {
+  if (!recording_) {
+    return 0;
+  }
+  size_t keys = 0;
+  for (const RawAnimation::JointTrack& track :
+       recording_->raw_animation.tracks) {
+    keys += track.translations.size() + track.rotations.size() +
+            track.scales.size();
+  }
+  return keys;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,250 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/animation_validator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+// Setup default values, the same as AnimationOptimizer ones.
+AnimationValidator::AnimationValidator()
+    : frequency(30.f),
+      percentile(.95f),
+      parallel_for(nullptr),
+      parallel_for_user_data(nullptr) {}
+
+namespace {
+
+AnimationOptimizer::Setting GetValidatorJointSetting(
+    const AnimationValidator& _validator, int _joint) {
+  AnimationOptimizer::Setting setting = _validator.setting;
+  const AnimationOptimizer::JointsSetting::const_iterator it =
+      _validator.joints_setting_override.find(_joint);
+  if (it != _validator.joints_setting_override.end()) {
+    setting = it->second;
+  }
+  return setting;
+}
+
+// Computes the error between the 2 model-space matrices of a joint, measured
+// at _distance from the joint along each of its axes.
+float JointDistanceError(const math::Float4x4& _a, const math::Float4x4& _b,
+                         math::SimdFloat4 _distance) {
+  const math::SimdFloat4 origin = _a.cols[3] - _b.cols[3];
+  math::SimdFloat4 error = math::Length3(origin);
+  for (int i = 0; i < 3; ++i) {
+    const math::SimdFloat4 diff =
+        (_a.cols[i] - _b.cols[i]) * _distance + origin;
+    error = math::Max(error, math::Length3(diff));
+  }
+  return math::GetX(error);
+}
+
+bool ValidateClip(const AnimationValidator& _validator,
+                  const RawAnimation& _raw_animation,
+                  const Animation& _animation, const Skeleton& _skeleton,
+                  AnimationValidator::Report* _report) {
+  _report->joints.clear();
+  _report->num_frames = 0;
+  _report->worst_joint = -1;
+  _report->num_joints_over_tolerance = 0;
+
+  // Validates inputs.
+  const int num_joints = _skeleton.num_joints();
+  if (!_raw_animation.Validate() || _raw_animation.num_tracks() != num_joints ||
+      _animation.num_tracks() != num_joints || !(_validator.frequency > 0.f)) {
+    return false;
+  }
+
+  // Per joint settings.
+  ozz::vector<float> distances(num_joints);
+  _report->joints.resize(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    const AnimationOptimizer::Setting setting =
+        GetValidatorJointSetting(_validator, i);
+    distances[i] = setting.distance;
+    AnimationValidator::JointError& joint = _report->joints[i];
+    joint.max = 0.f;
+    joint.percentile = 0.f;
+    joint.max_time = 0.f;
+    joint.tolerance = setting.tolerance;
+  }
+
+  // Sampling buffers.
+  RawAnimationSampler raw_sampler;
+  if (!raw_sampler.Bind(_raw_animation)) {
+    return false;
+  }
+  const int num_soa_joints = _skeleton.num_soa_joints();
+  ozz::vector<math::SoaTransform> raw_locals(num_soa_joints);
+  ozz::vector<math::SoaTransform> locals(num_soa_joints);
+  ozz::vector<math::Float4x4> raw_models(num_joints);
+  ozz::vector<math::Float4x4> models(num_joints);
+  SamplingJob::Context context(num_joints, _animation.cubic());
+
+  SamplingJob sampling_job;
+  sampling_job.animation = &_animation;
+  sampling_job.context = &context;
+  sampling_job.output = make_span(locals);
+
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = &_skeleton;
+  LocalToModelJob raw_ltm_job;
+  raw_ltm_job.skeleton = &_skeleton;
+  raw_ltm_job.input = make_span(raw_locals);
+  raw_ltm_job.output = make_span(raw_models);
+  ltm_job.input = make_span(locals);
+  ltm_job.output = make_span(models);
+
+  // Errors of all frames, stored per joint.
+  const float duration = _raw_animation.duration;
+  const FixedRateSamplingTime sampling(duration, _validator.frequency);
+  const int num_frames = static_cast<int>(sampling.num_keys());
+  ozz::vector<float> errors(static_cast<size_t>(num_frames) * num_joints);
+
+  for (int f = 0; f < num_frames; ++f) {
+    const float time = sampling.time(f);
+    sampling_job.ratio = time / duration;
+    if (!raw_sampler.Sample(time, make_span(raw_locals)) ||
+        !sampling_job.Run() || !raw_ltm_job.Run() || !ltm_job.Run()) {
+      return false;
+    }
+    for (int i = 0; i < num_joints; ++i) {
+      const float error =
+          JointDistanceError(raw_models[i], models[i],
+                             math::simd_float4::Load1(distances[i]));
+      errors[static_cast<size_t>(i) * num_frames + f] = error;
+      AnimationValidator::JointError& joint = _report->joints[i];
+      if (error > joint.max) {
+        joint.max = error;
+        joint.max_time = time;
+      }
+    }
+  }
+
+  // Percentiles, worst joint and budget.
+  const float ratio = math::Clamp(0.f, _validator.percentile, 1.f);
+  const int nth = math::Max(
+      0, static_cast<int>(std::ceil(ratio * num_frames)) - 1);
+  float worst = -1.f;
+  for (int i = 0; i < num_joints; ++i) {
+    AnimationValidator::JointError& joint = _report->joints[i];
+    float* joint_errors = errors.data() + static_cast<size_t>(i) * num_frames;
+    std::nth_element(joint_errors, joint_errors + nth,
+                     joint_errors + num_frames);
+    joint.percentile = joint_errors[nth];
+
+    if (joint.max > worst) {
+      worst = joint.max;
+      _report->worst_joint = i;
+    }
+    if (joint.max > joint.tolerance) {
+      ++_report->num_joints_over_tolerance;
+    }
+  }
+  _report->num_frames = num_frames;
+  return true;
+}
+
+struct ValidateClipTasks {
+  const AnimationValidator* validator;
+  const Skeleton* skeleton;
+  span<const AnimationValidator::Clip> clips;
+  span<AnimationValidator::Report> reports;
+  span<uint8_t> results;
+};
+
+void ValidateClipTask(int _task, void* _data) {
+  const ValidateClipTasks& tasks =
+      *static_cast<const ValidateClipTasks*>(_data);
+  const AnimationValidator::Clip& clip = tasks.clips[_task];
+  bool success = false;
+  if (clip.raw_animation != nullptr && clip.animation != nullptr) {
+    success = ValidateClip(*tasks.validator, *clip.raw_animation,
+                           *clip.animation, *tasks.skeleton,
+                           &tasks.reports[_task]);
+  } else {
+    tasks.reports[_task] = AnimationValidator::Report();
+  }
+  tasks.results[_task] = success;
+}
+}  // namespace
+
+bool AnimationValidator::operator()(const RawAnimation& _raw_animation,
+                                    const Animation& _animation,
+                                    const Skeleton& _skeleton,
+                                    Report* _report) const {
+  if (!_report) {
+    return false;
+  }
+  return ValidateClip(*this, _raw_animation, _animation, _skeleton, _report);
+}
+
+bool AnimationValidator::operator()(span<const Clip> _clips,
+                                    const Skeleton& _skeleton,
+                                    span<Report> _reports) const {
+  if (_reports.size() < _clips.size()) {
+    return false;
+  }
+
+  const int count = static_cast<int>(_clips.size());
+  ozz::vector<uint8_t> results(count, 0);
+  const ValidateClipTasks tasks = {this, &_skeleton, _clips, _reports,
+                                   make_span(results)};
+  void* data = const_cast<void*>(static_cast<const void*>(&tasks));
+  if (parallel_for != nullptr && count > 1) {
+    parallel_for(count, &ValidateClipTask, data, parallel_for_user_data);
+  } else {
+    for (int i = 0; i < count; ++i) {
+      ValidateClipTask(i, data);
+    }
+  }
+
+  bool success = true;
+  for (int i = 0; i < count; ++i) {
+    success &= results[i] != 0;
+  }
+  return success;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,170 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/baked_pack_builder.h"
+
+#include <cstring>
+#include <limits>
+
+#include "ozz/animation/runtime/baked_pack.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+// Computes pack layout, accumulating entries offsets and sizes.
+struct BakedLayout {
+  template <typename _Ty>
+  bool operator()(BakedPack::Type _type, const _Ty* _object) {
+    if (!_object) {
+      return false;
+    }
+    BakedPack::Entry entry = {};
+    entry.type = _type;
+    entry.offset = static_cast<uint32_t>(size);
+    entry.size = static_cast<uint32_t>(_object->image_size());
+    entries.push_back(entry);
+    size = Align(size + entry.size, BakedPack::kImageAlignment);
+    return size <= std::numeric_limits<uint32_t>::max();
+  }
+  size_t size;
+  ozz::vector<BakedPack::Entry> entries;
+};
+
+// Writes objects images to a pack image.
+struct BakedWriter {
+  template <typename _Ty>
+  bool operator()(BakedPack::Type, const _Ty* _object) {
+    const BakedPack::Entry& entry = entries[index++];
+    return _object->ToImage({image.data() + entry.offset, entry.size});
+  }
+  span<byte> image;
+  span<const BakedPack::Entry> entries;
+  size_t index;
+};
+
+template <typename _Ty, typename _Fn>
+bool VisitObjects(const ozz::vector<const _Ty*>& _objects,
+                  BakedPack::Type _type, _Fn* _fn) {
+  for (const _Ty* object : _objects) {
+    if (!(*_fn)(_type, object)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Visits all objects of _builder, in the order they're baked.
+template <typename _Fn>
+bool Visit(const BakedPackBuilder& _builder, _Fn* _fn) {
+  return (!_builder.skeleton ||
+          (*_fn)(BakedPack::kSkeleton, _builder.skeleton)) &&
+         VisitObjects(_builder.animations, BakedPack::kAnimation, _fn) &&
+         VisitObjects(_builder.float_tracks, BakedPack::kFloatTrack, _fn) &&
+         VisitObjects(_builder.float2_tracks, BakedPack::kFloat2Track, _fn) &&
+         VisitObjects(_builder.float3_tracks, BakedPack::kFloat3Track, _fn) &&
+         VisitObjects(_builder.float4_tracks, BakedPack::kFloat4Track, _fn) &&
+         VisitObjects(_builder.quaternion_tracks, BakedPack::kQuaternionTrack,
+                      _fn);
+}
+
+// Computes _builder pack layout. Returns false if an object is nullptr or
+// pack is too big.
+bool ComputeLayout(const BakedPackBuilder& _builder, BakedLayout* _layout) {
+  const size_t num_entries = (_builder.skeleton ? 1 : 0) +
+                             _builder.animations.size() +
+                             _builder.float_tracks.size() +
+                             _builder.float2_tracks.size() +
+                             _builder.float3_tracks.size() +
+                             _builder.float4_tracks.size() +
+                             _builder.quaternion_tracks.size();
+  _layout->size = sizeof(BakedPack::Header) +
+                  num_entries * sizeof(BakedPack::Entry);
+  _layout->entries.reserve(num_entries);
+  return Visit(_builder, _layout);
+}
+}  // namespace
+
+BakedPackBuilder::BakedPackBuilder() : skeleton(nullptr) {}
+
+size_t BakedPackBuilder::image_size() const {
+  BakedLayout layout;
+  if (!ComputeLayout(*this, &layout)) {
+    return 0;
+  }
+  return layout.size;
+}
+
+bool BakedPackBuilder::operator()(span<byte> _image) const {
+  BakedLayout layout;
+  if (!ComputeLayout(*this, &layout) ||
+      !IsAligned(_image.data(), BakedPack::kImageAlignment) ||
+      _image.size_bytes() < layout.size) {
+    return false;
+  }
+
+  // Padding bytes are cleared, so that baking is deterministic.
+  std::memset(_image.data(), 0, layout.size);
+
+  BakedPack::Header header;
+  header.magic = BakedPack::kImageMagic;
+  header.version = BakedPack::kImageVersion;
+  header.size = static_cast<uint32_t>(layout.size);
+  header.num_entries = static_cast<uint32_t>(layout.entries.size());
+  std::memcpy(_image.data(), &header, sizeof(header));
+  if (!layout.entries.empty()) {
+    std::memcpy(_image.data() + sizeof(header), layout.entries.data(),
+                layout.entries.size() * sizeof(BakedPack::Entry));
+  }
+
+  BakedWriter writer = {_image, make_span(layout.entries), 0};
+  return Visit(*this, &writer);
+}
+
+bool BakedPackBuilder::operator()(io::Stream* _stream) const {
+  if (!_stream || !_stream->opened()) {
+    return false;
+  }
+  const size_t size = image_size();
+  if (size == 0) {
+    return false;
+  }
+
+  memory::Allocator* allocator = memory::default_allocator();
+  byte* buffer = static_cast<byte*>(
+      allocator->Allocate(size, BakedPack::kImageAlignment));
+  const bool success = (*this)(span<byte>(buffer, size)) &&
+                       _stream->Write(buffer, size) == size;
+  allocator->Deallocate(buffer);
+  return success;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,171 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_ANIMATION_OFFLINE_CUBIC_H_
+#define OZZ_ANIMATION_OFFLINE_CUBIC_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+#include "ozz/base/containers/small_vector.h"
+#include "ozz/base/maths/vec_float.h"
+#include "ozz/base/memory/linear_allocator.h"
+
+#include <cassert>
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+// Computes _key tangent, per unit of time, as the finite difference of its
+// neighbors _prev and _next (Catmull-Rom like). Missing neighbors (nullptr)
+// are replaced by _key itself, which gives one sided differences for first and
+// last keys. _Key must have float time and math::Float3 value members.
+// AnimationBuilder and AnimationOptimizer share this function, so that
+// optimizer evaluates the curves built by the builder.
+template <typename _Key>
+math::Float3 CubicTangent(const _Key* _prev, const _Key& _key,
+                          const _Key* _next) {
+  const _Key& left = _prev ? *_prev : _key;
+  const _Key& right = _next ? *_next : _key;
+  const float dt = right.time - left.time;
+  return dt > 0.f ? (right.value - left.value) / dt : math::Float3::zero();
+}
+
+// Evaluates cubic Hermite curve between _left and _right keys, whose tangents
+// (per unit of time) are _left_tangent and _right_tangent, at _time. This is
+// the same polynomial as the one evaluated by SamplingJob.
+template <typename _Key>
+math::Float3 CubicInterpolate(const _Key& _left,
+                              const math::Float3& _left_tangent,
+                              const _Key& _right,
+                              const math::Float3& _right_tangent,
+                              float _time) {
+  const float dt = _right.time - _left.time;
+  assert(dt > 0.f);
+  const float u = (_time - _left.time) / dt;
+  const math::Float3 d = _right.value - _left.value;
+  const math::Float3 m0 = _left_tangent * dt;
+  const math::Float3 m1 = _right_tangent * dt;
+  const math::Float3 c2 = d * 3.f - m0 * 2.f - m1;
+  const math::Float3 c3 = m0 + m1 - d * 2.f;
+  return _left.value + (m0 + (c2 + c3 * u) * u) * u;
+}
+
+// Computes the tangent of key _i of _keys, whose neighbors are given by the
+// linked list _prevs and _nexts.
+template <typename _Track, typename _Links>
+math::Float3 LinkedTangent(const _Track& _keys, const _Links& _prevs,
+                           const _Links& _nexts, size_t _i) {
+  const typename _Track::value_type* prev =
+      _i > 0 ? &_keys[_prevs[_i]] : nullptr;
+  const typename _Track::value_type* next =
+      _i < _keys.size() - 1 ? &_keys[_nexts[_i]] : nullptr;
+  return CubicTangent(prev, _keys[_i], next);
+}
+
+// Decimation algorithm for tracks interpolated with cubic Hermite curves.
+// Ramer-Douglas-Peucker can't be used because keys tangents depend on their
+// neighbors, which change as keys are removed. Instead, keys are greedily
+// removed in order, as long as the curve rebuilt from remaining keys stays
+// within _tolerance of all _src keys. Removing a key only modifies the tangents
+// of its 2 remaining neighbors, hence only the 3 segments surrounding them need
+// to be tested.
+// First and last keys are always kept. _Track must have std::vector interface,
+// and Adapter the same interface as for Decimate function.
+template <typename _Track, typename _Adapter>
+void DecimateCubic(const _Track& _src, const _Adapter& _adapter,
+                   float _tolerance, _Track* _dest) {
+  typedef typename _Track::value_type Key;
+  const size_t size = _src.size();
+
+  // Early out if not enough data.
+  if (size < 3) {
+    *_dest = _src;
+    return;
+  }
+
+  // Remaining keys, as a doubly linked list of _src indices. Lists are
+  // allocated inline, or from calling thread scratch arena.
+  const memory::ScratchScope scratch;
+  SmallVector<size_t, 128> prevs(size, scratch.allocator());
+  SmallVector<size_t, 128> nexts(size, scratch.allocator());
+  for (size_t i = 0; i < size; ++i) {
+    prevs[i] = i - 1;  // Wraps for the first key, which is never accessed.
+    nexts[i] = i + 1;
+  }
+
+  for (size_t i = 1; i < size - 1; ++i) {
+    if (!_adapter.Decimable(_src[i])) {
+      continue;
+    }
+
+    // Unlinks key i, and tests segments from the remaining key preceding its
+    // previous one, to the key following its next one.
+    const size_t prev = prevs[i];
+    const size_t next = nexts[i];
+    nexts[prev] = next;
+    prevs[next] = prev;
+    const size_t first = prev > 0 ? prevs[prev] : prev;
+    const size_t last = next < size - 1 ? nexts[next] : next;
+
+    bool removable = true;
+    for (size_t left = first; removable && left != last; left = nexts[left]) {
+      const size_t right = nexts[left];
+      const math::Float3 left_tangent =
+          LinkedTangent(_src, prevs, nexts, left);
+      const math::Float3 right_tangent =
+          LinkedTangent(_src, prevs, nexts, right);
+      for (size_t j = left + 1; j < right; ++j) {
+        Key key = _src[j];
+        key.value = CubicInterpolate(_src[left], left_tangent, _src[right],
+                                     right_tangent, key.time);
+        if (_adapter.Distance(key, _src[j]) > _tolerance) {
+          removable = false;
+          break;
+        }
+      }
+    }
+
+    // Links back key i if it can't be removed.
+    if (!removable) {
+      nexts[prev] = i;
+      prevs[next] = i;
+    }
+  }
+
+  // Copy all remaining keys.
+  _dest->clear();
+  for (size_t i = 0; i < size; i = nexts[i]) {
+    _dest->push_back(_src[i]);
+  }
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_ANIMATION_OFFLINE_CUBIC_H_
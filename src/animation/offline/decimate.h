@@ -32,8 +32,8 @@
 #error "This header is private, it cannot be included from public headers."
 #endif  // OZZ_INCLUDE_PRIVATE_HEADER
 
-#include "ozz/base/containers/stack.h"
-#include "ozz/base/containers/vector.h"
+#include "ozz/base/containers/small_vector.h"
+#include "ozz/base/memory/linear_allocator.h"
 
 #include <cassert>
 
@@ -41,6 +41,42 @@ namespace ozz {
 namespace animation {
 namespace offline {
 
+// Finds the point of ]_first,_last[ range that's the furthest (above
+// _tolerance) from the segment [_first,_last], or the first point that can't be
+// decimated. Returns _first if no point is found.
+// Default implementation, using _adapter Lerp and Distance functions for each
+// point.
+template <typename _Track, typename _Adapter>
+size_t FindFurthest(const _Track& _src, const _Adapter& _adapter,
+                    size_t _first, size_t _last, float _tolerance, long) {
+  float max = -1.f;
+  size_t candidate = _first;
+  typename _Track::const_reference left = _src[_first];
+  typename _Track::const_reference right = _src[_last];
+  for (size_t i = _first + 1; i < _last; ++i) {
+    typename _Track::const_reference test = _src[i];
+    if (!_adapter.Decimable(test)) {
+      return i;
+    }
+    const float distance =
+        _adapter.Distance(_adapter.Lerp(left, right, test), test);
+    if (distance > _tolerance && distance > max) {
+      max = distance;
+      candidate = i;
+    }
+  }
+  return candidate;
+}
+
+// Overload selected when _Adapter implements Furthest function, which allows
+// adapters to provide a vectorized implementation for their key type.
+template <typename _Track, typename _Adapter>
+auto FindFurthest(const _Track& _src, const _Adapter& _adapter, size_t _first,
+                  size_t _last, float _tolerance, int)
+    -> decltype(_adapter.Furthest(_src.data(), _first, _last, _tolerance)) {
+  return _adapter.Furthest(_src.data(), _first, _last, _tolerance);
+}
+
 // Decimation algorithm based on Ramer-Douglas-Peucker.
 // https://en.wikipedia.org/wiki/Ramer%E2%80%93Douglas%E2%80%93Peucker_algorithm
 // _Track must have std::vector interface.
@@ -50,6 +86,14 @@ namespace offline {
 //  Key Lerp(const Key& _left, const Key& _right, const Key& _ref) const;
 //  float Distance(const Key& _a, const Key& _b) const;
 // };
+// Adapter can optionally implement the search of the furthest point of a
+// segment, typically to vectorize it. It must return the same point as
+// FindFurthest default implementation:
+//  size_t Furthest(const Key* _keys, size_t _first, size_t _last,
+//                  float _tolerance) const;
+// Temporary buffers are allocated inline, or from calling thread scratch
+// arena for big tracks, so the function doesn't allocate from the heap when
+// called repeatedly.
 template <typename _Track, typename _Adapter>
 void Decimate(const _Track& _src, const _Adapter& _adapter, float _tolerance,
               _Track* _dest) {
@@ -59,54 +103,41 @@ void Decimate(const _Track& _src, const _Adapter& _adapter, float _tolerance,
     return;
   }
 
+  const memory::ScratchScope scratch;
+
   // Stack of segments to process.
   typedef std::pair<size_t, size_t> Segment;
-  ozz::stack<Segment> segments;
+  SmallVector<Segment, 32> segments(scratch.allocator());
 
-  // Bit vector of all points to included.
-  ozz::vector<bool> included(_src.size(), false);
+  // Flags of the points to include.
+  SmallVector<bool, 256> included(_src.size(), false, scratch.allocator());
 
   // Pushes segment made from first and last points.
-  segments.push(Segment(0, _src.size() - 1));
+  segments.push_back(Segment(0, _src.size() - 1));
   included[0] = true;
   included[_src.size() - 1] = true;
 
   // Empties segments stack.
   while (!segments.empty()) {
     // Pops next segment to process.
-    const Segment segment = segments.top();
-    segments.pop();
+    const Segment segment = segments.back();
+    segments.pop_back();
 
     // Looks for the furthest point from the segment.
-    float max = -1.f;
-    size_t candidate = segment.first;
-    typename _Track::const_reference left = _src[segment.first];
-    typename _Track::const_reference right = _src[segment.second];
-    for (size_t i = segment.first + 1; i < segment.second; ++i) {
-      assert(!included[i] && "Included points should be processed once only.");
-      typename _Track::const_reference test = _src[i];
-      if (!_adapter.Decimable(test)) {
-        candidate = i;
-        break;
-      } else {
-        const float distance =
-            _adapter.Distance(_adapter.Lerp(left, right, test), test);
-        if (distance > _tolerance && distance > max) {
-          max = distance;
-          candidate = i;
-        }
-      }
-    }
+    const size_t candidate = FindFurthest(
+        _src, _adapter, segment.first, segment.second, _tolerance, 0);
+    assert((candidate == segment.first || !included[candidate]) &&
+           "Included points should be processed once only.");
 
     // If found, include the point and pushes the 2 new segments (before and
     // after the new point).
     if (candidate != segment.first) {
       included[candidate] = true;
       if (candidate - segment.first > 1) {
-        segments.push(Segment(segment.first, candidate));
+        segments.push_back(Segment(segment.first, candidate));
       }
       if (segment.second - candidate > 1) {
-        segments.push(Segment(candidate, segment.second));
+        segments.push_back(Segment(candidate, segment.second));
       }
     }
   }
@@ -130,6 +161,73 @@ void Decimate(const _Track& _src, const _Adapter& _adapter, float _tolerance,
     }
   }
 }
+
+// Online decimation algorithm, for keys pushed one at a time (recording).
+// Pushed keys are buffered until one of them can't be interpolated (within
+// _tolerance) anymore between the last output key and the newly pushed key,
+// in which case the previously pushed key is output. Latency is bounded, as
+// the previously pushed key is also output once _max_pending keys are
+// buffered. This also bounds the cost of pushing a key to _max_pending
+// distance evaluations.
+// _Track and _Adapter have the same requirements as Decimate ones.
+template <typename _Track, typename _Adapter>
+class StreamDecimator {
+ public:
+  typedef typename _Track::value_type Key;
+
+  StreamDecimator(const _Adapter& _adapter, float _tolerance,
+                  size_t _max_pending, _Track* _dest)
+      : adapter_(_adapter),
+        tolerance_(_tolerance),
+        max_pending_(_max_pending > 0 ? _max_pending : 1),
+        dest_(_dest) {}
+
+  // Pushes a new key, which must be after any previously pushed one.
+  void Push(const Key& _key) {
+    if (dest_->empty()) {
+      dest_->push_back(_key);  // First key is always output.
+      return;
+    }
+    if (!pending_.empty() &&
+        (pending_.size() >= max_pending_ || !Interpolable(_key))) {
+      dest_->push_back(pending_.back());
+      pending_.clear();
+    }
+    pending_.push_back(_key);
+  }
+
+  // Outputs last pushed key, so that output track ends with it. Keys can still
+  // be pushed afterwards.
+  void Flush() {
+    if (!pending_.empty()) {
+      dest_->push_back(pending_.back());
+      pending_.clear();
+    }
+  }
+
+ private:
+  // Tests if all pending keys can be interpolated between last output key and
+  // _key.
+  bool Interpolable(const Key& _key) const {
+    const Key& left = dest_->back();
+    for (size_t i = 0; i < pending_.size(); ++i) {
+      const Key& test = pending_[i];
+      if (!adapter_.Decimable(test) ||
+          adapter_.Distance(adapter_.Lerp(left, _key, test), test) >
+              tolerance_) {
+        return false;
+      }
+    }
+    return true;
+  }
+  _Adapter adapter_;
+  float tolerance_;
+  size_t max_pending_;
+  _Track* dest_;
+
+  // Keys pushed since last output key.
+  _Track pending_;
+};
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
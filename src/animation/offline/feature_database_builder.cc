@@ -0,0 +1,295 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/feature_database_builder.h"
+
+#include <cmath>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/feature_database.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/vec_float.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+// Defines a group of features, normalized together.
+struct Group {
+  int first;
+  int count;
+  float weight;
+};
+
+// Defines the character frame of a pose: root joint position projected on
+// the ground, and its ground heading.
+struct CharacterFrame {
+  math::Float3 origin;
+  math::Float2 forward;  // (x, z)
+
+  // Transforms model-space _vector to the character frame.
+  math::Float3 ToLocalVector(const math::Float3& _vector) const {
+    return math::Float3(_vector.x * forward.y - _vector.z * forward.x,
+                        _vector.y,
+                        _vector.x * forward.x + _vector.z * forward.y);
+  }
+
+  // Transforms model-space _point to the character frame.
+  math::Float3 ToLocalPoint(const math::Float3& _point) const {
+    return ToLocalVector(_point - origin);
+  }
+};
+
+// Gets the translation of a model-space matrix.
+math::Float3 GetTranslation(const math::Float4x4& _matrix) {
+  math::Float3 translation;
+  math::Store3PtrU(_matrix.cols[3], &translation.x);
+  return translation;
+}
+
+// Extracts the character frame of a model-space root joint matrix.
+CharacterFrame GetCharacterFrame(const math::Float4x4& _root) {
+  CharacterFrame frame;
+  frame.origin = GetTranslation(_root);
+  frame.origin.y = 0.f;
+  const math::Float2 forward(math::GetX(_root.cols[2]),
+                             math::GetZ(_root.cols[2]));
+  const float len2 = LengthSqr(forward);
+  frame.forward = len2 > 1e-8f ? forward / std::sqrt(len2)
+                               : math::Float2(0.f, 1.f);
+  return frame;
+}
+}  // namespace
+
+FeatureDatabaseBuilder::FeatureDatabaseBuilder()
+    : sample_rate(30.f),
+      root_joint(0),
+      trajectory_position_weight(1.f),
+      trajectory_direction_weight(1.f) {}
+
+unique_ptr<FeatureDatabase> FeatureDatabaseBuilder::operator()(
+    const Skeleton& _skeleton,
+    span<const Animation* const> _animations) const {
+  // Validates parameters.
+  const int num_joints = _skeleton.num_joints();
+  if (!(sample_rate > 0.f) || root_joint < 0 || root_joint >= num_joints) {
+    return nullptr;
+  }
+  for (const JointFeature& feature : joints) {
+    if (feature.joint < 0 || feature.joint >= num_joints) {
+      return nullptr;
+    }
+  }
+  for (const float time : trajectory_times) {
+    if (!(time >= 0.f)) {
+      return nullptr;
+    }
+  }
+  bool cubic = false;  // Context must sample cubic animations, if any.
+  for (const Animation* animation : _animations) {
+    if (!animation || animation->num_tracks() != num_joints) {
+      return nullptr;
+    }
+    cubic |= animation->cubic();
+  }
+
+  // Lays out features groups.
+  ozz::vector<Group> groups;
+  int num_features = 0;
+  const auto add_group = [&groups, &num_features](int _count, float _weight) {
+    if (_count > 0 && _weight > 0.f) {
+      const Group group = {num_features, _count, _weight};
+      groups.push_back(group);
+      num_features += _count;
+    }
+  };
+  for (const JointFeature& feature : joints) {
+    add_group(3, feature.position_weight);
+    add_group(3, feature.velocity_weight);
+  }
+  const int num_times = static_cast<int>(trajectory_times.size());
+  add_group(num_times * 2, trajectory_position_weight);
+  add_group(num_times * 2, trajectory_direction_weight);
+  if (num_features == 0) {
+    return nullptr;
+  }
+
+  // Samples clips and extracts raw features, a row per frame.
+  ozz::vector<FeatureDatabase::Clip> clips;
+  ozz::vector<float> raw;
+  ozz::vector<math::SoaTransform> locals(_skeleton.num_soa_joints());
+  ozz::vector<math::Float4x4> models(num_joints);
+  SamplingJob::Context context(num_joints, cubic);
+  for (const Animation* animation : _animations) {
+    const float duration = animation->duration();
+    const int num_frames =
+        static_cast<int>(std::ceil(duration * sample_rate - 1e-4f)) + 1;
+
+    // Samples character frames and joints positions of all frames first, as
+    // velocities and trajectory depend on following frames.
+    ozz::vector<CharacterFrame> frames(num_frames);
+    ozz::vector<math::Float3> positions(num_frames * joints.size());
+    SamplingJob sampling_job;
+    sampling_job.animation = animation;
+    sampling_job.context = &context;
+    sampling_job.output = make_span(locals);
+    LocalToModelJob ltm_job;
+    ltm_job.skeleton = &_skeleton;
+    ltm_job.input = make_span(locals);
+    ltm_job.output = make_span(models);
+    for (int i = 0; i < num_frames; ++i) {
+      const float time = i / sample_rate;
+      sampling_job.ratio =
+          duration > 0.f ? math::Min(time / duration, 1.f) : 0.f;
+      if (!sampling_job.Run() || !ltm_job.Run()) {
+        return nullptr;
+      }
+      frames[i] = GetCharacterFrame(models[root_joint]);
+      for (size_t j = 0; j < joints.size(); ++j) {
+        positions[i * joints.size() + j] =
+            GetTranslation(models[joints[j].joint]);
+      }
+    }
+
+    const FeatureDatabase::Clip clip = {
+        clips.empty() ? 0 : clips.back().first_frame + clips.back().num_frames,
+        num_frames, duration};
+    clips.push_back(clip);
+
+    for (int i = 0; i < num_frames; ++i) {
+      const CharacterFrame& frame = frames[i];
+      // Velocities are computed from the next frame, or the previous one for
+      // the last frame.
+      const int next = math::Min(i + 1, num_frames - 1);
+      const int prev = math::Max(next - 1, 0);
+      for (size_t j = 0; j < joints.size(); ++j) {
+        if (joints[j].position_weight > 0.f) {
+          const math::Float3 position =
+              frame.ToLocalPoint(positions[i * joints.size() + j]);
+          raw.insert(raw.end(), {position.x, position.y, position.z});
+        }
+        if (joints[j].velocity_weight > 0.f) {
+          const math::Float3 velocity = frame.ToLocalVector(
+              (positions[next * joints.size() + j] -
+               positions[prev * joints.size() + j]) *
+              sample_rate);
+          raw.insert(raw.end(), {velocity.x, velocity.y, velocity.z});
+        }
+      }
+      // Trajectory frames.
+      ozz::vector<int> futures(num_times);
+      for (int t = 0; t < num_times; ++t) {
+        const int offset = static_cast<int>(
+            std::floor(trajectory_times[t] * sample_rate + .5f));
+        futures[t] = math::Min(i + offset, num_frames - 1);
+      }
+      if (num_times > 0 && trajectory_position_weight > 0.f) {
+        for (const int future : futures) {
+          const math::Float3 position =
+              frame.ToLocalPoint(frames[future].origin);
+          raw.insert(raw.end(), {position.x, position.z});
+        }
+      }
+      if (num_times > 0 && trajectory_direction_weight > 0.f) {
+        for (const int future : futures) {
+          const math::Float2& forward = frames[future].forward;
+          const math::Float3 direction = frame.ToLocalVector(
+              math::Float3(forward.x, 0.f, forward.y));
+          raw.insert(raw.end(), {direction.x, direction.z});
+        }
+      }
+    }
+  }
+  const int num_frames = static_cast<int>(raw.size() / num_features);
+
+  // Computes normalization offsets (per feature mean) and scales (weight
+  // divided by group standard deviation).
+  ozz::vector<float> offsets(num_features, 0.f);
+  ozz::vector<float> scales(num_features, 1.f);
+  if (num_frames > 0) {
+    for (int i = 0; i < num_frames; ++i) {
+      for (int f = 0; f < num_features; ++f) {
+        offsets[f] += raw[i * num_features + f];
+      }
+    }
+    for (float& offset : offsets) {
+      offset /= num_frames;
+    }
+    for (const Group& group : groups) {
+      double variance = 0.;
+      for (int i = 0; i < num_frames; ++i) {
+        for (int f = group.first; f < group.first + group.count; ++f) {
+          const double d = raw[i * num_features + f] - offsets[f];
+          variance += d * d;
+        }
+      }
+      variance /= static_cast<double>(num_frames) * group.count;
+      const float deviation = static_cast<float>(std::sqrt(variance));
+      const float scale =
+          deviation > 1e-6f ? group.weight / deviation : group.weight;
+      for (int f = group.first; f < group.first + group.count; ++f) {
+        scales[f] = scale;
+      }
+    }
+  }
+
+  // Stores normalized features in SoA blocks of 4 frames.
+  const int num_blocks = (num_frames + 3) / 4;
+  ozz::vector<math::SimdFloat4> features(static_cast<size_t>(num_blocks) *
+                                         num_features);
+  for (int b = 0; b < num_blocks; ++b) {
+    for (int f = 0; f < num_features; ++f) {
+      float lanes[4] = {0.f, 0.f, 0.f, 0.f};
+      for (int l = 0; l < 4 && b * 4 + l < num_frames; ++l) {
+        lanes[l] =
+            (raw[(b * 4 + l) * num_features + f] - offsets[f]) * scales[f];
+      }
+      features[b * num_features + f] = math::simd_float4::LoadPtrU(lanes);
+    }
+  }
+
+  unique_ptr<FeatureDatabase> database = make_unique<FeatureDatabase>();
+  database->num_features_ = num_features;
+  database->num_frames_ = num_frames;
+  database->sample_rate_ = sample_rate;
+  database->clips_ = std::move(clips);
+  database->offsets_ = std::move(offsets);
+  database->scales_ = std::move(scales);
+  database->features_ = std::move(features);
+  database->BuildBoxes();
+  return database;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
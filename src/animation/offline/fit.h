@@ -0,0 +1,381 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_ANIMATION_OFFLINE_FIT_H_
+#define OZZ_ANIMATION_OFFLINE_FIT_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/vec_float.h"
+
+#include <cmath>
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+// Fitting algorithm values traits. Values are fitted component-wise.
+template <typename _Value>
+struct FitTraits;
+
+template <>
+struct FitTraits<math::Float3> {
+  enum { kCount = 3 };
+  static void Align(const math::Float3&, math::Float3*) {}
+  static void ToFloats(const math::Float3& _value, float* _floats) {
+    _floats[0] = _value.x;
+    _floats[1] = _value.y;
+    _floats[2] = _value.z;
+  }
+  static math::Float3 FromFloats(const float* _floats) {
+    return math::Float3(_floats[0], _floats[1], _floats[2]);
+  }
+};
+
+template <>
+struct FitTraits<math::Quaternion> {
+  enum { kCount = 4 };
+  // Negates _value if it's not on the shortest path from _prev, as
+  // AnimationBuilder does, so that consecutive components can be fitted.
+  static void Align(const math::Quaternion& _prev, math::Quaternion* _value) {
+    if (Dot(_prev, *_value) < 0.f) {
+      *_value = -*_value;
+    }
+  }
+  static void ToFloats(const math::Quaternion& _value, float* _floats) {
+    _floats[0] = _value.x;
+    _floats[1] = _value.y;
+    _floats[2] = _value.z;
+    _floats[3] = _value.w;
+  }
+  // Fitted quaternions are normalized, as runtime normalized-lerp does.
+  static math::Quaternion FromFloats(const float* _floats) {
+    return NormalizeSafe(
+        math::Quaternion(_floats[0], _floats[1], _floats[2], _floats[3]),
+        math::Quaternion::identity());
+  }
+};
+
+// Computes the weights of knots values contributing to the curve at _time,
+// which belongs to [_times[_k], _times[_k + 1]] segment. Weights apply to
+// knots _k - 1 to _k + 2. Cubic weights match cubic Hermite curve with
+// tangents computed by CubicTangent, see cubic.h.
+inline void FitWeights(const ozz::vector<float>& _times, int _k, float _time,
+                       bool _cubic, double _weights[4]) {
+  const int last = static_cast<int>(_times.size()) - 1;
+  const double dt = _times[_k + 1] - _times[_k];
+  const double u = (_time - _times[_k]) / dt;
+  _weights[0] = _weights[1] = _weights[2] = _weights[3] = 0.;
+  if (!_cubic) {
+    _weights[1] = 1. - u;
+    _weights[2] = u;
+    return;
+  }
+
+  // Hermite basis.
+  const double u2 = u * u, u3 = u2 * u;
+  _weights[1] = 2. * u3 - 3. * u2 + 1.;
+  _weights[2] = -2. * u3 + 3. * u2;
+  const double tangent_weights[2] = {dt * (u3 - 2. * u2 + u), dt * (u3 - u2)};
+
+  // Distributes tangents weights to their left and right knots.
+  for (int i = 0; i < 2; ++i) {
+    const int knot = _k + i;
+    const int left = knot > 0 ? knot - 1 : knot;
+    const int right = knot < last ? knot + 1 : knot;
+    const double weight = tangent_weights[i] / (_times[right] - _times[left]);
+    _weights[right - _k + 1] += weight;
+    _weights[left - _k + 1] -= weight;
+  }
+}
+
+// Solves banded symmetric positive definite system _matrix * x = _rhs, in
+// place (x is returned in _rhs). _matrix stores, for each row i, columns i to
+// i + _bandwidth. _rhs stores _num_rhs right hand sides per row. Returns false
+// if the system isn't positive definite.
+inline bool SolveBanded(int _size, int _bandwidth, int _num_rhs,
+                        ozz::vector<double>* _matrix,
+                        ozz::vector<double>* _rhs) {
+  const int stride = _bandwidth + 1;
+  double* u = _matrix->data();
+  double* x = _rhs->data();
+
+  // Cholesky decomposition, matrix = Ut * U.
+  for (int i = 0; i < _size; ++i) {
+    const int end = math::Min(_size - 1, i + _bandwidth);
+    for (int j = i; j <= end; ++j) {
+      double sum = u[i * stride + j - i];
+      for (int k = math::Max(0, j - _bandwidth); k < i; ++k) {
+        sum -= u[k * stride + i - k] * u[k * stride + j - k];
+      }
+      if (i == j) {
+        if (sum <= 0.) {
+          return false;
+        }
+        u[i * stride] = std::sqrt(sum);
+      } else {
+        u[i * stride + j - i] = sum / u[i * stride];
+      }
+    }
+  }
+
+  // Forward substitution, Ut * y = rhs, then backward substitution U * x = y.
+  for (int i = 0; i < _size; ++i) {
+    for (int k = math::Max(0, i - _bandwidth); k < i; ++k) {
+      for (int c = 0; c < _num_rhs; ++c) {
+        x[i * _num_rhs + c] -= u[k * stride + i - k] * x[k * _num_rhs + c];
+      }
+    }
+    for (int c = 0; c < _num_rhs; ++c) {
+      x[i * _num_rhs + c] /= u[i * stride];
+    }
+  }
+  for (int i = _size - 1; i >= 0; --i) {
+    const int end = math::Min(_size - 1, i + _bandwidth);
+    for (int k = i + 1; k <= end; ++k) {
+      for (int c = 0; c < _num_rhs; ++c) {
+        x[i * _num_rhs + c] -= u[i * stride + k - i] * x[k * _num_rhs + c];
+      }
+    }
+    for (int c = 0; c < _num_rhs; ++c) {
+      x[i * _num_rhs + c] /= u[i * stride];
+    }
+  }
+  return true;
+}
+
+// Fits _knots values to _samples in the least-squares sense, and outputs the
+// resulting keys to _fitted. _Traits are the FitTraits of _track values.
+// Returns false if the system can't be solved.
+template <typename _Traits, typename _Track>
+bool FitKnots(const _Track& _track, const ozz::vector<float>& _samples,
+              const ozz::vector<int>& _knots, bool _cubic, _Track* _fitted) {
+  const int kCount = _Traits::kCount;
+  const int size = static_cast<int>(_track.size());
+  const int num_knots = static_cast<int>(_knots.size());
+  const int bandwidth = _cubic ? 3 : 1;
+  ozz::vector<float> times(num_knots);
+  for (int k = 0; k < num_knots; ++k) {
+    times[k] = _track[_knots[k]].time;
+  }
+
+  // Builds normal equations from all samples. Sample s belongs to segment k if
+  // _knots[k] <= s < _knots[k + 1], last segment includes last sample.
+  ozz::vector<double> matrix(num_knots * (bandwidth + 1), 0.);
+  ozz::vector<double> rhs(num_knots * kCount, 0.);
+  for (int k = 0, s = 0; k < num_knots - 1; ++k) {
+    const int end = k == num_knots - 2 ? size : _knots[k + 1];
+    for (; s < end; ++s) {
+      double weights[4];
+      FitWeights(times, k, _track[s].time, _cubic, weights);
+      for (int i = 0; i < 4; ++i) {
+        const int row = k - 1 + i;
+        if (weights[i] == 0. || row < 0 || row >= num_knots) {
+          continue;
+        }
+        for (int j = i; j < 4; ++j) {
+          const int col = k - 1 + j;
+          if (col < num_knots) {
+            matrix[row * (bandwidth + 1) + col - row] +=
+                weights[i] * weights[j];
+          }
+        }
+        for (int c = 0; c < kCount; ++c) {
+          rhs[row * kCount + c] += weights[i] * _samples[s * kCount + c];
+        }
+      }
+    }
+  }
+  if (!SolveBanded(num_knots, bandwidth, kCount, &matrix, &rhs)) {
+    return false;
+  }
+
+  // Rebuilds fitted keys.
+  _fitted->resize(num_knots);
+  for (int k = 0; k < num_knots; ++k) {
+    float values[4];
+    for (int c = 0; c < kCount; ++c) {
+      values[c] = static_cast<float>(rhs[k * kCount + c]);
+    }
+    (*_fitted)[k] = _track[_knots[k]];
+    (*_fitted)[k].value = _Traits::FromFloats(values);
+  }
+  return true;
+}
+
+// Computes the distance between every _track key and _fitted curve, whose
+// keys times are the ones of _knots. Returns the maximum distance.
+template <typename _Traits, typename _Track, typename _Adapter>
+float FitDistances(const _Track& _track, const ozz::vector<int>& _knots,
+                   const _Track& _fitted, const _Adapter& _adapter,
+                   bool _cubic, ozz::vector<float>* _distances) {
+  const int kCount = _Traits::kCount;
+  const int size = static_cast<int>(_track.size());
+  const int num_knots = static_cast<int>(_knots.size());
+  ozz::vector<float> times(num_knots);
+  ozz::vector<float> knot_values(num_knots * kCount);
+  for (int k = 0; k < num_knots; ++k) {
+    times[k] = _fitted[k].time;
+    _Traits::ToFloats(_fitted[k].value, &knot_values[k * kCount]);
+  }
+
+  float max = 0.f;
+  _distances->resize(size);
+  for (int k = 0, s = 0; k < num_knots - 1; ++k) {
+    const int end = k == num_knots - 2 ? size : _knots[k + 1];
+    for (; s < end; ++s) {
+      double weights[4];
+      FitWeights(times, k, _track[s].time, _cubic, weights);
+      float values[4] = {0.f, 0.f, 0.f, 0.f};
+      for (int i = 0; i < 4; ++i) {
+        const int knot = k - 1 + i;
+        if (weights[i] == 0. || knot < 0 || knot >= num_knots) {
+          continue;
+        }
+        for (int c = 0; c < kCount; ++c) {
+          values[c] += static_cast<float>(weights[i]) *
+                       knot_values[knot * kCount + c];
+        }
+      }
+      typename _Track::value_type key = _track[s];
+      key.value = _Traits::FromFloats(values);
+      const float distance = _adapter.Distance(key, _track[s]);
+      (*_distances)[s] = distance;
+      max = math::Max(max, distance);
+    }
+  }
+  return max;
+}
+
+// Least-squares curve fitting algorithm. Unlike Decimate, which only selects
+// keys among _src ones, fitting also moves keys values so that the curve
+// interpolating them (linearly, or with cubic Hermite curves if _cubic is
+// true) passes as close as possible to all _src keys. This averages out
+// noise, where decimation would need to keep noisy keys.
+// Keys times are selected among _src keys times. Fitting starts with first and
+// last keys, then iteratively inserts the worst key of every segment whose
+// error exceeds _tolerance, until all _src keys are within _tolerance. Keys
+// are finally removed one by one, as long as the refitted curve remains
+// within _tolerance.
+// Returns false if fitting failed, in which case _dest is left unchanged.
+// _Track must have std::vector interface, and Adapter the same interface as
+// for Decimate function (only Distance is used).
+template <typename _Track, typename _Adapter>
+bool Fit(const _Track& _src, const _Adapter& _adapter, float _tolerance,
+         bool _cubic, _Track* _dest) {
+  typedef FitTraits<typename _Track::value_type::Value> Traits;
+  const int kCount = Traits::kCount;
+  const int size = static_cast<int>(_src.size());
+
+  // Early out if not enough data.
+  if (size < 3) {
+    *_dest = _src;
+    return true;
+  }
+
+  // Samples to fit, as floats.
+  _Track track = _src;
+  for (int s = 1; s < size; ++s) {
+    Traits::Align(track[s - 1].value, &track[s].value);
+  }
+  ozz::vector<float> samples(size * kCount);
+  for (int s = 0; s < size; ++s) {
+    Traits::ToFloats(track[s].value, &samples[s * kCount]);
+  }
+
+  // Knots are indices of the keys whose times are selected.
+  ozz::vector<int> knots;
+  knots.push_back(0);
+  knots.push_back(size - 1);
+
+  // Refines knots until all samples are within tolerance.
+  _Track fitted;
+  ozz::vector<float> distances;
+  ozz::vector<int> refined;
+  for (;;) {
+    if (!FitKnots<Traits>(track, samples, knots, _cubic, &fitted)) {
+      return false;
+    }
+    if (FitDistances<Traits>(track, knots, fitted, _adapter, _cubic,
+                             &distances) <= _tolerance) {
+      break;
+    }
+
+    // Segments with a sample (knots included) out of tolerance are split at
+    // their worst interior sample. All samples end up being knots in the
+    // worst case, which interpolates them.
+    refined.clear();
+    const int num_knots = static_cast<int>(knots.size());
+    for (int k = 0; k < num_knots - 1; ++k) {
+      refined.push_back(knots[k]);
+      bool exceeds = false;
+      int candidate = -1;
+      for (int s = knots[k]; s <= knots[k + 1]; ++s) {
+        exceeds |= distances[s] > _tolerance;
+        if (s != knots[k] && s != knots[k + 1] &&
+            (candidate < 0 || distances[s] > distances[candidate])) {
+          candidate = s;
+        }
+      }
+      if (exceeds && candidate >= 0) {
+        refined.push_back(candidate);
+      }
+    }
+    refined.push_back(knots.back());
+    if (refined.size() == knots.size()) {
+      return false;  // No segment can be refined anymore.
+    }
+    knots.swap(refined);
+  }
+
+  // Removes knots that aren't needed anymore.
+  _Track candidate;
+  for (size_t k = 1; k + 1 < knots.size();) {
+    refined = knots;
+    refined.erase(refined.begin() + k);
+    if (FitKnots<Traits>(track, samples, refined, _cubic, &candidate) &&
+        FitDistances<Traits>(track, refined, candidate, _adapter, _cubic,
+                             &distances) <= _tolerance) {
+      knots.swap(refined);
+      fitted.swap(candidate);
+    } else {
+      ++k;
+    }
+  }
+
+  _dest->swap(fitted);
+  return true;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_ANIMATION_OFFLINE_FIT_H_
@@ -31,17 +31,20 @@
 //----------------------------------------------------------------------------//
 
 #include <cassert>
+#include <cmath>
 #include <cstring>
 
-#include "ozz/animation/offline/raw_animation_utils.h"
 #include "ozz/animation/offline/tools/import2ozz.h"
 #include "ozz/animation/runtime/skeleton.h"
 #include "ozz/base/containers/map.h"
 #include "ozz/base/containers/set.h"
 #include "ozz/base/containers/vector.h"
+#include "ozz/base/endianness.h"
+#include "ozz/base/io/stream.h"
 #include "ozz/base/log.h"
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/unique_ptr.h"
 
 #define TINYGLTF_IMPLEMENTATION
 
@@ -106,10 +109,19 @@ bool FixupNames(_VectorType& _data, const char* _pretty_name,
   return true;
 }
 
+// A gltf model and its buffers data. Buffers data are owned by the model, or
+// point to the memory mapped binary chunk of a glb file. The latter avoids
+// copying the chunk, and reading the parts of it that aren't accessed, like
+// meshes for an animation import.
+struct Document {
+  tinygltf::Model model;
+  ozz::vector<ozz::span<const unsigned char>> buffers;  // Per model buffer.
+};
+
 // Returns the address of a gltf buffer given an accessor.
 // Performs basic checks to ensure the data is in the correct format
 template <typename T>
-ozz::span<const T> BufferView(const tinygltf::Model& _model,
+ozz::span<const T> BufferView(const Document& _document,
                               const tinygltf::Accessor& _accessor) {
   const int32_t component_size =
       tinygltf::GetComponentSizeInBytes(_accessor.componentType);
@@ -123,10 +135,17 @@ ozz::span<const T> BufferView(const tinygltf::Model& _model,
   }
 
   const tinygltf::BufferView& bufferView =
-      _model.bufferViews[_accessor.bufferView];
-  const tinygltf::Buffer& buffer = _model.buffers[bufferView.buffer];
-  const T* begin = reinterpret_cast<const T*>(
-      buffer.data.data() + bufferView.byteOffset + _accessor.byteOffset);
+      _document.model.bufferViews[_accessor.bufferView];
+  const ozz::span<const unsigned char>& buffer =
+      _document.buffers[bufferView.buffer];
+  const size_t offset = bufferView.byteOffset + _accessor.byteOffset;
+  if (offset > buffer.size() ||
+      (buffer.size() - offset) / sizeof(T) < _accessor.count) {
+    ozz::log::Err() << "Invalid buffer view access, out of buffer range."
+                    << std::endl;
+    return ozz::span<const T>();
+  }
+  const T* begin = reinterpret_cast<const T*>(buffer.data() + offset);
   return ozz::span<const T>(begin, _accessor.count);
 }
 
@@ -134,7 +153,7 @@ ozz::span<const T> BufferView(const tinygltf::Model& _model,
 // There is an exact mapping between gltf and ozz keyframes so we just copy
 // everything over.
 template <typename _KeyframesType>
-bool SampleLinearChannel(const tinygltf::Model& _model,
+bool SampleLinearChannel(const Document& _document,
                          const tinygltf::Accessor& _output,
                          const ozz::span<const float>& _timestamps,
                          _KeyframesType* _keyframes) {
@@ -147,7 +166,7 @@ bool SampleLinearChannel(const tinygltf::Model& _model,
 
   typedef typename _KeyframesType::value_type::Value ValueType;
   const ozz::span<const ValueType> values =
-      BufferView<ValueType>(_model, _output);
+      BufferView<ValueType>(_document, _output);
   if (values.size_bytes() / sizeof(ValueType) != gltf_keys_count ||
       _timestamps.size() != gltf_keys_count) {
     ozz::log::Err() << "gltf format error, inconsistent number of keys."
@@ -165,9 +184,10 @@ bool SampleLinearChannel(const tinygltf::Model& _model,
 }
 
 // Samples a step animation channel
-// There are twice-1 as many ozz keyframes as gltf keyframes
+// Up to twice-1 as many ozz keyframes as gltf keyframes, as a step is created
+// with 2 keys. Steps that don't change the value only need 1 key.
 template <typename _KeyframesType>
-bool SampleStepChannel(const tinygltf::Model& _model,
+bool SampleStepChannel(const Document& _document,
                        const tinygltf::Accessor& _output,
                        const ozz::span<const float>& _timestamps,
                        _KeyframesType* _keyframes) {
@@ -180,7 +200,7 @@ bool SampleStepChannel(const tinygltf::Model& _model,
 
   typedef typename _KeyframesType::value_type::Value ValueType;
   const ozz::span<const ValueType> values =
-      BufferView<ValueType>(_model, _output);
+      BufferView<ValueType>(_document, _output);
   if (values.size_bytes() / sizeof(ValueType) != gltf_keys_count ||
       _timestamps.size() != gltf_keys_count) {
     ozz::log::Err() << "gltf format error, inconsistent number of keys."
@@ -188,19 +208,17 @@ bool SampleStepChannel(const tinygltf::Model& _model,
     return false;
   }
 
-  // A step is created with 2 consecutive keys. Last step is a single key.
-  size_t numKeyframes = gltf_keys_count * 2 - 1;
-  _keyframes->resize(numKeyframes);
-
+  // A step is created with 2 consecutive keys, the second holding the value
+  // until next step. Last step is a single key.
+  _keyframes->reserve(gltf_keys_count * 2 - 1);
   for (size_t i = 0; i < _output.count; i++) {
-    typename _KeyframesType::reference key = _keyframes->at(i * 2);
-    key.time = _timestamps[i];
-    key.value = values[i];
+    const typename _KeyframesType::value_type key{_timestamps[i], values[i]};
+    _keyframes->push_back(key);
 
-    if (i < _output.count - 1) {
-      typename _KeyframesType::reference next_key = _keyframes->at(i * 2 + 1);
-      next_key.time = nexttowardf(_timestamps[i + 1], 0.f);
-      next_key.value = values[i];
+    if (i < _output.count - 1 && !(values[i] == values[i + 1])) {
+      const typename _KeyframesType::value_type hold_key{
+          nexttowardf(_timestamps[i + 1], 0.f), values[i]};
+      _keyframes->push_back(hold_key);
     }
   }
 
@@ -237,11 +255,78 @@ T SampleHermiteSpline(float _alpha, const T& p0, const T& m0, const T& p1,
   return pt;
 }
 
+// Tolerance below which a cubic-spline segment is considered linear, as a
+// distance for translations and scales, and as an angle (radian) for
+// rotations.
+const float kCubicSplineTolerance = 1e-4f;
+
+// Tests if _value matches linear interpolation of _a and _b at _alpha, within
+// kCubicSplineTolerance.
+bool IsLinear(const ozz::math::Float3& _a, const ozz::math::Float3& _b,
+              float _alpha, const ozz::math::Float3& _value) {
+  return ozz::math::Length(ozz::math::Lerp(_a, _b, _alpha) - _value) <=
+         kCubicSplineTolerance;
+}
+
+bool IsLinear(const ozz::math::Quaternion& _a, const ozz::math::Quaternion& _b,
+              float _alpha, const ozz::math::Quaternion& _value) {
+  // Interpolates along the shortest path, as runtime does.
+  const ozz::math::Quaternion a = ozz::math::Normalize(_a);
+  const ozz::math::Quaternion b = ozz::math::Dot(_a, _b) < 0.f
+                                      ? -ozz::math::Normalize(_b)
+                                      : ozz::math::Normalize(_b);
+  const ozz::math::Quaternion lerp = ozz::math::NLerp(a, b, _alpha);
+  // Dot product is cos(angle / 2) ~ 1 - angle^2 / 8.
+  return 1.f - std::abs(ozz::math::Dot(lerp, ozz::math::Normalize(_value))) <=
+         kCubicSplineTolerance * kCubicSplineTolerance / 8.f;
+}
+
+// A cubic-spline segment, between 2 gltf keyframes.
+template <typename _ValueType>
+struct CubicSegment {
+  _ValueType Evaluate(float _time) const {
+    return SampleHermiteSpline((_time - t0) / (t1 - t0), p0, m0, p1, m1);
+  }
+  float t0, t1;
+  _ValueType p0, m0, p1, m1;
+};
+
+// Pushes the keys required to linearly interpolate ]_begin, _end[ part of
+// _segment within tolerance, splitting it in halves that aren't shorter than
+// _min_period. Curve is tested at quarters and middle, so that symmetric
+// curves (ease in-out) aren't mistaken for linear ones.
+template <typename _KeyframesType, typename _ValueType>
+void SubdivideCubicSegment(const CubicSegment<_ValueType>& _segment,
+                           const typename _KeyframesType::value_type& _begin,
+                           const typename _KeyframesType::value_type& _end,
+                           float _min_period, _KeyframesType* _keyframes) {
+  const float duration = _end.time - _begin.time;
+  if (duration < 2.f * _min_period) {
+    return;
+  }
+  const float middle_time = _begin.time + duration * .5f;
+  const typename _KeyframesType::value_type middle{
+      middle_time, _segment.Evaluate(middle_time)};
+  bool linear = IsLinear(_begin.value, _end.value, .5f, middle.value);
+  for (const float alpha : {.25f, .75f}) {
+    linear = linear &&
+             IsLinear(_begin.value, _end.value, alpha,
+                      _segment.Evaluate(_begin.time + duration * alpha));
+  }
+  if (linear) {
+    return;
+  }
+  SubdivideCubicSegment(_segment, _begin, middle, _min_period, _keyframes);
+  _keyframes->push_back(middle);
+  SubdivideCubicSegment(_segment, middle, _end, _min_period, _keyframes);
+}
+
 // Samples a cubic-spline channel
-// the number of keyframes is determined from the animation duration and given
-// sample rate
+// gltf keyframes are kept, and each spline segment is subdivided until it can
+// be linearly interpolated within tolerance. Subdivisions are never shorter
+// than _sampling_rate period.
 template <typename _KeyframesType>
-bool SampleCubicSplineChannel(const tinygltf::Model& _model,
+bool SampleCubicSplineChannel(const Document& _document,
                               const tinygltf::Accessor& _output,
                               const ozz::span<const float>& _timestamps,
                               float _sampling_rate, float _duration,
@@ -258,7 +343,7 @@ bool SampleCubicSplineChannel(const tinygltf::Model& _model,
 
   typedef typename _KeyframesType::value_type::Value ValueType;
   const ozz::span<const ValueType> values =
-      BufferView<ValueType>(_model, _output);
+      BufferView<ValueType>(_document, _output);
   if (values.size_bytes() / (sizeof(ValueType) * 3) != gltf_keys_count ||
       _timestamps.size() != gltf_keys_count) {
     ozz::log::Err() << "gltf format error, inconsistent number of keys."
@@ -266,45 +351,35 @@ bool SampleCubicSplineChannel(const tinygltf::Model& _model,
     return false;
   }
 
-  // Iterate keyframes at _sampling_rate steps, between first and last time
-  // stamps.
-  ozz::animation::offline::FixedRateSamplingTime fixed_it(
-      _timestamps[gltf_keys_count - 1] - _timestamps[0], _sampling_rate);
-  _keyframes->resize(fixed_it.num_keys());
-  size_t cubic_key0 = 0;
-  for (size_t k = 0; k < fixed_it.num_keys(); ++k) {
-    const float time = fixed_it.time(k) + _timestamps[0];
-
-    // Creates output key.
-    typename _KeyframesType::value_type key;
-    key.time = time;
-
-    // Makes sure time is in between the correct cubic keyframes.
-    while (_timestamps[cubic_key0 + 1] < time) {
-      cubic_key0++;
+  const float min_period = 1.f / _sampling_rate;
+  for (size_t i = 0; i < gltf_keys_count; ++i) {
+    // Pushes gltf key, aka spline point.
+    const typename _KeyframesType::value_type key{_timestamps[i],
+                                                  values[i * 3 + 1]};
+    _keyframes->push_back(key);
+    if (i + 1 == gltf_keys_count) {
+      break;
     }
-    assert(_timestamps[cubic_key0] <= time &&
-           time <= _timestamps[cubic_key0 + 1]);
 
-    // Interpolate cubic key
-    const float t0 = _timestamps[cubic_key0];      // keyframe before time
-    const float t1 = _timestamps[cubic_key0 + 1];  // keyframe after time
-    const float alpha = (time - t0) / (t1 - t0);
-    const ValueType& p0 = values[cubic_key0 * 3 + 1];
-    const ValueType m0 = values[cubic_key0 * 3 + 2] * (t1 - t0);
-    const ValueType& p1 = values[(cubic_key0 + 1) * 3 + 1];
-    const ValueType m1 = values[(cubic_key0 + 1) * 3] * (t1 - t0);
-    key.value = SampleHermiteSpline(alpha, p0, m0, p1, m1);
-
-    // Pushes interpolated key.
-    _keyframes->at(k) = key;
+    // Subdivides segment up to next key.
+    CubicSegment<ValueType> segment;
+    segment.t0 = _timestamps[i];
+    segment.t1 = _timestamps[i + 1];
+    segment.p0 = values[i * 3 + 1];
+    segment.m0 = values[i * 3 + 2] * (segment.t1 - segment.t0);
+    segment.p1 = values[(i + 1) * 3 + 1];
+    segment.m1 = values[(i + 1) * 3] * (segment.t1 - segment.t0);
+    if (segment.t1 > segment.t0) {
+      const typename _KeyframesType::value_type next{segment.t1, segment.p1};
+      SubdivideCubicSegment(segment, key, next, min_period, _keyframes);
+    }
   }
 
   return true;
 }
 
 template <typename _KeyframesType>
-bool SampleChannel(const tinygltf::Model& _model,
+bool SampleChannel(const Document& _document,
                    const std::string& _interpolation,
                    const tinygltf::Accessor& _output,
                    const ozz::span<const float>& _timestamps,
@@ -312,11 +387,11 @@ bool SampleChannel(const tinygltf::Model& _model,
                    _KeyframesType* _keyframes) {
   bool valid = false;
   if (_interpolation == "LINEAR") {
-    valid = SampleLinearChannel(_model, _output, _timestamps, _keyframes);
+    valid = SampleLinearChannel(_document, _output, _timestamps, _keyframes);
   } else if (_interpolation == "STEP") {
-    valid = SampleStepChannel(_model, _output, _timestamps, _keyframes);
+    valid = SampleStepChannel(_document, _output, _timestamps, _keyframes);
   } else if (_interpolation == "CUBICSPLINE") {
-    valid = SampleCubicSplineChannel(_model, _output, _timestamps,
+    valid = SampleCubicSplineChannel(_document, _output, _timestamps,
                                      _sampling_rate, _duration, _keyframes);
   } else {
     ozz::log::Err() << "Invalid or unknown interpolation type '"
@@ -486,17 +561,28 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
 
     // Tries to guess whether the input is a gltf json or a glb binary based on
     // the file extension
+    m_mapped.reset();
+    m_document = Document();
     if (std::strcmp(ext, "glb") == 0) {
-      success =
-          m_loader.LoadBinaryFromFile(&m_model, &errors, &warnings, _filename);
+      // Memory maps glb files, falling back to tinygltf loader (which also
+      // reports errors) if the file can't be mapped.
+      success = LoadMappedBinary(_filename, &errors, &warnings);
+      if (!success) {
+        m_mapped.reset();
+        m_document = Document();
+        errors.clear();
+        warnings.clear();
+        success = m_loader.LoadBinaryFromFile(&m_document.model, &errors,
+                                              &warnings, _filename);
+      }
     } else {
       if (std::strcmp(ext, "gltf") != 0) {
         ozz::log::Log() << "Unknown file extension '" << ext
                         << "', assuming a JSON-formatted gltf." << std::endl;
       }
 
-      success =
-          m_loader.LoadASCIIFromFile(&m_model, &errors, &warnings, _filename);
+      success = m_loader.LoadASCIIFromFile(&m_document.model, &errors,
+                                           &warnings, _filename);
     }
 
     // Prints any errors or warnings emitted by the loader
@@ -513,23 +599,134 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
     }
 
     if (success) {
-      success &= FixupNames(m_model.scenes, "Scene", "scene_");
-      success &= FixupNames(m_model.nodes, "Node", "node_");
-      success &= FixupNames(m_model.animations, "Animation", "animation_");
+      // Buffers that aren't mapped are owned by the model.
+      const std::vector<tinygltf::Buffer>& buffers = m_document.model.buffers;
+      m_document.buffers.resize(buffers.size());
+      for (size_t i = 0; i < buffers.size(); ++i) {
+        if (m_document.buffers[i].data() == nullptr) {
+          m_document.buffers[i] = ozz::make_span(buffers[i].data);
+        }
+      }
+
+      success &= FixupNames(m_document.model.scenes, "Scene", "scene_");
+      success &= FixupNames(m_document.model.nodes, "Node", "node_");
+      success &=
+          FixupNames(m_document.model.animations, "Animation", "animation_");
     }
 
     return success;
   }
 
+  // Loads a glb file from a memory mapping of it. Json chunk is parsed by
+  // tinygltf, after binary chunk buffer was replaced with a 1 byte embedded
+  // one, so that tinygltf doesn't copy it. Document buffer then points to the
+  // mapped binary chunk instead.
+  bool LoadMappedBinary(const char* _filename, std::string* _errors,
+                        std::string* _warnings) {
+    m_mapped = ozz::make_unique<ozz::io::MappedFile>(_filename);
+    const unsigned char* data = m_mapped->data();
+    const size_t size = static_cast<size_t>(m_mapped->Size());
+    if (data == nullptr) {
+      return false;
+    }
+
+    // Reads glb header and chunks, as defined by glTF 2.0 specification "GLB
+    // File Format Specification" section.
+    const uint32_t kMagic = 0x46546C67;      // "glTF"
+    const uint32_t kJsonChunk = 0x4E4F534A;  // "JSON"
+    const uint32_t kBinChunk = 0x004E4942;   // "BIN\0"
+    if (size < 20 || ReadUInt32(data) != kMagic || ReadUInt32(data + 4) != 2 ||
+        ReadUInt32(data + 8) > size || ReadUInt32(data + 16) != kJsonChunk) {
+      return false;
+    }
+    const size_t length = ReadUInt32(data + 8);
+    const size_t json_size = ReadUInt32(data + 12);
+    if (json_size > length - 20) {
+      return false;
+    }
+    const unsigned char* json_begin = data + 20;
+    ozz::span<const unsigned char> bin_chunk;
+    const size_t bin_offset = 20 + ((json_size + 3) & ~size_t(3));
+    if (bin_offset + 8 <= length &&
+        ReadUInt32(data + bin_offset + 4) == kBinChunk) {
+      const size_t bin_size = ReadUInt32(data + bin_offset);
+      if (bin_size > length - bin_offset - 8) {
+        return false;
+      }
+      bin_chunk = {data + bin_offset + 8, bin_size};
+    }
+
+    // Replaces buffers without uri, aka referring to the binary chunk.
+    nlohmann::json json = nlohmann::json::parse(
+        json_begin, json_begin + json_size, nullptr, false);
+    if (!json.is_object()) {
+      return false;
+    }
+    ozz::vector<bool> mapped;
+    auto buffers = json.find("buffers");
+    if (buffers != json.end() && buffers->is_array()) {
+      for (nlohmann::json& buffer : *buffers) {
+        const bool bin =
+            buffer.is_object() && buffer.find("uri") == buffer.end();
+        mapped.push_back(bin);
+        if (bin) {
+          buffer["uri"] = "data:application/octet-stream;base64,AA==";
+          buffer["byteLength"] = 1;
+        }
+      }
+    }
+
+    // Parses json, external resources are relative to the glb file.
+    const std::string content = json.dump();
+    const char* separator = std::strrchr(_filename, '/');
+    const char* backslash = std::strrchr(_filename, '\\');
+    separator = backslash > separator ? backslash : separator;
+    const std::string base_dir =
+        separator ? std::string(_filename, separator) : std::string();
+    if (!m_loader.LoadASCIIFromString(
+            &m_document.model, _errors, _warnings, content.c_str(),
+            static_cast<unsigned int>(content.size()), base_dir)) {
+      return false;
+    }
+
+    // Document buffers point to the binary chunk.
+    const std::vector<tinygltf::Buffer>& model_buffers =
+        m_document.model.buffers;
+    m_document.buffers.resize(model_buffers.size());
+    for (size_t i = 0; i < mapped.size() && i < model_buffers.size(); ++i) {
+      if (!mapped[i]) {
+        continue;
+      }
+      if (bin_chunk.data() == nullptr) {
+        *_errors += "Invalid binary data in `Buffer'.\n";
+        return false;
+      }
+      m_document.buffers[i] = bin_chunk;
+    }
+    ozz::log::LogV() << "Memory mapped glb file binary chunk ("
+                     << bin_chunk.size() << " bytes)." << std::endl;
+    return true;
+  }
+
+  // Reads a little endian uint32_t.
+  static uint32_t ReadUInt32(const unsigned char* _data) {
+    uint32_t value;
+    std::memcpy(&value, _data, sizeof(value));
+    return ozz::GetNativeEndianness() == ozz::kLittleEndian
+               ? value
+               : ozz::EndianSwap(value);
+  }
+
   // Find all unique root joints of skeletons used by given skins and add them
   // to `roots`
   void FindSkinRootJointIndices(const ozz::vector<tinygltf::Skin>& skins,
                                 ozz::vector<int>& roots) {
     static constexpr int no_parent = -1;
     static constexpr int visited = -2;
-    ozz::vector<int> parents(m_model.nodes.size(), no_parent);
-    for (int node = 0; node < static_cast<int>(m_model.nodes.size()); node++) {
-      for (int child : m_model.nodes[node].children) {
+    ozz::vector<int> parents(m_document.model.nodes.size(), no_parent);
+    const int num_nodes = static_cast<int>(m_document.model.nodes.size());
+    for (int node = 0; node < num_nodes; node++) {
+      for (int child : m_document.model.nodes[node].children) {
         parents[child] = node;
       }
     }
@@ -559,7 +756,7 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
               const NodeType& _types) override {
     (void)_types;
 
-    if (m_model.scenes.empty()) {
+    if (m_document.model.scenes.empty()) {
       ozz::log::Err() << "No scenes found." << std::endl;
       return false;
     }
@@ -567,12 +764,12 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
     // If no default scene has been set then take the first one spec does not
     // disallow gltfs without a default scene but it makes more sense to keep
     // going instead of throwing an error here
-    int defaultScene = m_model.defaultScene;
+    int defaultScene = m_document.model.defaultScene;
     if (defaultScene == -1) {
       defaultScene = 0;
     }
 
-    tinygltf::Scene& scene = m_model.scenes[defaultScene];
+    tinygltf::Scene& scene = m_document.model.scenes[defaultScene];
     ozz::log::LogV() << "Importing from default scene #" << defaultScene
                      << " with name \"" << scene.name << "\"." << std::endl;
 
@@ -610,7 +807,7 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
     // Traverses the scene graph and record all joints starting from the roots.
     _skeleton->roots.resize(roots.size());
     for (size_t i = 0; i < roots.size(); ++i) {
-      const tinygltf::Node& root_node = m_model.nodes[roots[i]];
+      const tinygltf::Node& root_node = m_document.model.nodes[roots[i]];
       ozz::animation::offline::RawSkeleton::Joint& root_joint =
           _skeleton->roots[i];
       if (!ImportNode(root_node, &root_joint)) {
@@ -644,7 +841,8 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
 
     // Fills each child information.
     for (size_t i = 0; i < _node.children.size(); ++i) {
-      const tinygltf::Node& child_node = m_model.nodes[_node.children[i]];
+      const tinygltf::Node& child_node =
+          m_document.model.nodes[_node.children[i]];
       ozz::animation::offline::RawSkeleton::Joint& child_joint =
           _joint->children[i];
 
@@ -659,8 +857,8 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
   // Returns all animations in the gltf document.
   AnimationNames GetAnimationNames() override {
     AnimationNames animNames;
-    for (size_t i = 0; i < m_model.animations.size(); ++i) {
-      tinygltf::Animation& animation = m_model.animations[i];
+    for (size_t i = 0; i < m_document.model.animations.size(); ++i) {
+      tinygltf::Animation& animation = m_document.model.animations[i];
       assert(animation.name.length() != 0);
       animNames.push_back(animation.name.c_str());
     }
@@ -687,11 +885,12 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
 
     // Find the corresponding gltf animation
     std::vector<tinygltf::Animation>::const_iterator gltf_animation =
-        std::find_if(begin(m_model.animations), end(m_model.animations),
+        std::find_if(begin(m_document.model.animations),
+                     end(m_document.model.animations),
                      [_animation_name](const tinygltf::Animation& _animation) {
                        return _animation.name == _animation_name;
                      });
-    assert(gltf_animation != end(m_model.animations));
+    assert(gltf_animation != end(m_document.model.animations));
 
     _animation->name = gltf_animation->name.c_str();
 
@@ -724,7 +923,8 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
         continue;
       }
 
-      const tinygltf::Node& target_node = m_model.nodes[channel.target_node];
+      const tinygltf::Node& target_node =
+          m_document.model.nodes[channel.target_node];
       channels_per_joint[target_node.name.c_str()].push_back(&channel);
     }
 
@@ -737,7 +937,7 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
 
       for (auto& channel : channels) {
         auto& sampler = gltf_animation->samplers[channel->sampler];
-        if (!SampleAnimationChannel(m_model, sampler, channel->target_path,
+        if (!SampleAnimationChannel(m_document, sampler, channel->target_path,
                                     _sampling_rate, &_animation->duration,
                                     &track)) {
           return false;
@@ -775,7 +975,7 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
   }
 
   bool SampleAnimationChannel(
-      const tinygltf::Model& _model, const tinygltf::AnimationSampler& _sampler,
+      const Document& _document, const tinygltf::AnimationSampler& _sampler,
       const std::string& _target_path, float _sampling_rate, float* _duration,
       ozz::animation::offline::RawAnimation::JointTrack* _track) {
     // Validate interpolation type.
@@ -784,7 +984,7 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
       return false;
     }
 
-    auto& input = m_model.accessors[_sampler.input];
+    auto& input = m_document.model.accessors[_sampler.input];
     assert(input.maxValues.size() == 1);
 
     // The max[0] property of the input accessor is the animation duration
@@ -800,11 +1000,12 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
     }
 
     assert(input.type == TINYGLTF_TYPE_SCALAR);
-    auto& _output = m_model.accessors[_sampler.output];
+    auto& _output = m_document.model.accessors[_sampler.output];
     assert(_output.type == TINYGLTF_TYPE_VEC3 ||
            _output.type == TINYGLTF_TYPE_VEC4);
 
-    const ozz::span<const float> timestamps = BufferView<float>(_model, input);
+    const ozz::span<const float> timestamps =
+        BufferView<float>(_document, input);
     if (timestamps.empty()) {
       return true;
     }
@@ -813,11 +1014,11 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
     bool valid = false;
     if (_target_path == "translation") {
       valid =
-          SampleChannel(m_model, _sampler.interpolation, _output, timestamps,
+          SampleChannel(_document, _sampler.interpolation, _output, timestamps,
                         _sampling_rate, duration, &_track->translations);
     } else if (_target_path == "rotation") {
       valid =
-          SampleChannel(m_model, _sampler.interpolation, _output, timestamps,
+          SampleChannel(_document, _sampler.interpolation, _output, timestamps,
                         _sampling_rate, duration, &_track->rotations);
       if (valid) {
         // Normalize quaternions.
@@ -827,7 +1028,7 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
       }
     } else if (_target_path == "scale") {
       valid =
-          SampleChannel(m_model, _sampler.interpolation, _output, timestamps,
+          SampleChannel(_document, _sampler.interpolation, _output, timestamps,
                         _sampling_rate, duration, &_track->scales);
     } else {
       assert(false && "Invalid target path");
@@ -851,14 +1052,14 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
       found.insert(nodeIndex);
       open.erase(nodeIndex);
 
-      auto& node = m_model.nodes[nodeIndex];
+      auto& node = m_document.model.nodes[nodeIndex];
       for (int childIndex : node.children) {
         open.insert(childIndex);
       }
     }
 
     ozz::vector<tinygltf::Skin> skins;
-    for (const tinygltf::Skin& skin : m_model.skins) {
+    for (const tinygltf::Skin& skin : m_document.model.skins) {
       if (!skin.joints.empty() && found.find(skin.joints[0]) != found.end()) {
         skins.push_back(skin);
       }
@@ -868,7 +1069,7 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
   }
 
   const tinygltf::Node* FindNodeByName(const std::string& _name) const {
-    for (const tinygltf::Node& node : m_model.nodes) {
+    for (const tinygltf::Node& node : m_document.model.nodes) {
       if (node.name == _name) {
         return &node;
       }
@@ -899,7 +1100,10 @@ class GltfImporter : public ozz::animation::offline::OzzImporter {
   }
 
   tinygltf::TinyGLTF m_loader;
-  tinygltf::Model m_model;
+  Document m_document;
+
+  // Mapping of the loaded glb file, if any.
+  ozz::unique_ptr<ozz::io::MappedFile> m_mapped;
 };
 
 int main(int _argc, const char** _argv) {
@@ -0,0 +1,159 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/local_to_model_codegen.h"
+
+#include <cstdarg>
+#include <cstdio>
+
+#include "ozz/animation/runtime/local_to_model_registry.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+// Appends formatted text to _source.
+void Append(ozz::string* _source, const char* _format, ...) {
+  char buffer[512];
+  va_list args;
+  va_start(args, _format);
+  std::vsnprintf(buffer, sizeof(buffer), _format, args);
+  va_end(args);
+  _source->append(buffer);
+}
+
+bool IsIdentifier(const ozz::string& _name) {
+  if (_name.empty() || (_name[0] >= '0' && _name[0] <= '9')) {
+    return false;
+  }
+  for (const char c : _name) {
+    const bool valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                       (c >= '0' && c <= '9') || c == '_';
+    if (!valid) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+LocalToModelCodegen::LocalToModelCodegen()
+    : name("LocalToModel"), register_function(true) {}
+
+bool LocalToModelCodegen::operator()(const Skeleton& _skeleton,
+                                     ozz::string* _source) const {
+  const int num_joints = _skeleton.num_joints();
+  if (!_source || num_joints == 0 || !IsIdentifier(name) ||
+      name.size() > 128) {
+    return false;
+  }
+  for (const uint16_t remap : joint_remaps) {
+    if (remap >= num_joints) {
+      return false;
+    }
+  }
+
+  const int num_soa_joints = _skeleton.num_soa_joints();
+  const uint32_t hash = HashSkeletonHierarchy(_skeleton);
+  const char* fn = name.c_str();
+
+  _source->clear();
+  Append(_source,
+         "// Generated by ozz LocalToModelCodegen for a skeleton of %d "
+         "joints,\n// whose hierarchy hash is 0x%08x. Do not edit.\n\n",
+         num_joints, hash);
+  _source->append(
+      "#include <cassert>\n\n"
+      "#include \"ozz/animation/runtime/local_to_model_registry.h\"\n\n");
+
+  // Local-to-model function. Parents are always before their children, so
+  // every parent matrix is computed when it's needed.
+  Append(_source,
+         "void %s(ozz::span<const ozz::math::SoaTransform> _input,\n"
+         "    const ozz::math::Float4x4& _root,\n"
+         "    ozz::span<ozz::math::Float4x4> _output) {\n",
+         fn);
+  Append(_source, "  assert(_input.size() >= %d && _output.size() >= %d);\n",
+         num_soa_joints, num_joints);
+  _source->append(
+      "  const ozz::math::SoaTransform* in = _input.data();\n"
+      "  ozz::math::Float4x4* out = _output.data();\n"
+      "  ozz::math::Float4x4 l[4];\n");
+  const span<const int16_t>& parents = _skeleton.joint_parents();
+  for (int i = 0; i < num_joints; ++i) {
+    if ((i & 3) == 0) {
+      Append(_source, "  ozz::animation::SoaTransformToMatrices(in[%d], l);\n",
+             i / 4);
+    }
+    const int parent = parents[i];
+    if (parent == Skeleton::kNoParent) {
+      Append(_source, "  out[%d] = _root * l[%d];\n", i, i & 3);
+    } else {
+      Append(_source, "  out[%d] = out[%d] * l[%d];\n", i, parent, i & 3);
+    }
+  }
+  _source->append("}\n");
+
+  // Palette function.
+  if (!joint_remaps.empty()) {
+    const int num_remaps = static_cast<int>(joint_remaps.size());
+    Append(_source,
+           "\nvoid %sPalette(ozz::span<const ozz::math::Float4x4> _models,\n"
+           "    ozz::span<const ozz::math::Float4x4> _inverse_bind_poses,\n"
+           "    ozz::span<ozz::math::Float4x4> _output) {\n",
+           fn);
+    Append(_source,
+           "  assert(_models.size() >= %d && "
+           "_inverse_bind_poses.size() >= %d &&\n"
+           "         _output.size() >= %d);\n",
+           num_joints, num_remaps, num_remaps);
+    _source->append(
+        "  const ozz::math::Float4x4* models = _models.data();\n"
+        "  const ozz::math::Float4x4* ibp = _inverse_bind_poses.data();\n"
+        "  ozz::math::Float4x4* out = _output.data();\n");
+    for (int i = 0; i < num_remaps; ++i) {
+      Append(_source, "  out[%d] = models[%d] * ibp[%d];\n", i,
+             joint_remaps[i], i);
+    }
+    _source->append("}\n");
+  }
+
+  // Registration.
+  if (register_function) {
+    Append(_source,
+           "\nstatic const ozz::animation::LocalToModelRegistrar "
+           "%s_registrar(\n    0x%08xu, %d, &%s);\n",
+           fn, hash, num_joints, fn);
+  }
+
+  return true;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
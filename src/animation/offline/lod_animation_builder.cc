@@ -0,0 +1,77 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/lod_animation_builder.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/lod_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+LODAnimationBuilder::LODAnimationBuilder() {
+  tolerances.push_back(1e-3f);  // 1mm
+  tolerances.push_back(5e-3f);  // 5mm
+  tolerances.push_back(2e-2f);  // 2cm
+}
+
+unique_ptr<LODAnimation> LODAnimationBuilder::operator()(
+    const RawAnimation& _raw_animation, const Skeleton& _skeleton) const {
+  if (tolerances.empty()) {
+    return nullptr;
+  }
+  for (size_t i = 1; i < tolerances.size(); ++i) {
+    if (!(tolerances[i] > tolerances[i - 1])) {
+      return nullptr;
+    }
+  }
+
+  // Optimizes all levels at once.
+  ozz::vector<RawAnimation> raw_levels(tolerances.size());
+  if (!optimizer(_raw_animation, _skeleton, make_span(tolerances),
+                 make_span(raw_levels))) {
+    return nullptr;
+  }
+
+  unique_ptr<LODAnimation> animation = make_unique<LODAnimation>();
+  animation->tolerances_ = tolerances;
+  animation->levels_.resize(tolerances.size());
+  for (size_t i = 0; i < raw_levels.size(); ++i) {
+    unique_ptr<Animation> built = builder(raw_levels[i]);
+    if (!built) {
+      return nullptr;
+    }
+    animation->levels_[i] = std::move(*built);
+  }
+  return animation;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
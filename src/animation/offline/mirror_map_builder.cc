@@ -0,0 +1,108 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/mirror_map_builder.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+// Finds the joint whose name is _name with an occurrence of _from replaced by
+// _to. Every occurrence is tried, first one first. Returns
+// Skeleton::kNoParent if there's none.
+int FindCounterpart(const Skeleton& _skeleton, const ozz::string& _name,
+                    const ozz::string& _from, const ozz::string& _to) {
+  if (_from.empty()) {
+    return Skeleton::kNoParent;
+  }
+  for (size_t pos = _name.find(_from); pos != ozz::string::npos;
+       pos = _name.find(_from, pos + 1)) {
+    ozz::string name = _name;
+    name.replace(pos, _from.size(), _to);
+    const int joint = FindJoint(_skeleton, name.c_str());
+    if (joint != Skeleton::kNoParent) {
+      return joint;
+    }
+  }
+  return Skeleton::kNoParent;
+}
+}  // namespace
+
+MirrorMapBuilder::MirrorMapBuilder() : axis(MirrorMap::kX) {
+  const Pattern defaults[] = {
+      {"Left", "Right"}, {"left", "right"}, {"_L", "_R"}, {"_l", "_r"}};
+  patterns.assign(defaults, defaults + OZZ_ARRAY_SIZE(defaults));
+}
+
+unique_ptr<MirrorMap> MirrorMapBuilder::operator()(
+    const Skeleton& _skeleton) const {
+  const int num_joints = _skeleton.num_joints();
+  const span<const char* const> names = _skeleton.joint_names();
+  if (num_joints != 0 && names.empty()) {
+    return nullptr;  // Patterns can't be applied to names hashes.
+  }
+
+  unique_ptr<MirrorMap> map = make_unique<MirrorMap>();
+  map->axis_ = axis;
+  map->joint_remaps_.assign(num_joints, Skeleton::kNoParent);
+
+  for (int i = 0; i < num_joints; ++i) {
+    const ozz::string name = names[i];
+    int pair = Skeleton::kNoParent;
+    for (const Pattern& pattern : patterns) {
+      pair = FindCounterpart(_skeleton, name, pattern.left, pattern.right);
+      if (pair == Skeleton::kNoParent) {
+        pair = FindCounterpart(_skeleton, name, pattern.right, pattern.left);
+      }
+      if (pair != Skeleton::kNoParent) {
+        break;
+      }
+    }
+    if (pair == Skeleton::kNoParent || pair == i) {
+      pair = i;  // Mirrored onto itself.
+    } else if (map->joint_remaps_[pair] != Skeleton::kNoParent &&
+               map->joint_remaps_[pair] != i) {
+      return nullptr;  // Counterpart is already paired with another joint.
+    }
+    if (map->joint_remaps_[i] != Skeleton::kNoParent &&
+        map->joint_remaps_[i] != pair) {
+      return nullptr;  // Already paired with another joint.
+    }
+    map->joint_remaps_[i] = static_cast<int16_t>(pair);
+    map->joint_remaps_[pair] = static_cast<int16_t>(i);
+  }
+
+  map->BuildSoaRemaps();
+  return map;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
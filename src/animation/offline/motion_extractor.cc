@@ -0,0 +1,147 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/motion_extractor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+#include "ozz/animation/offline/raw_track.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/transform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+// Returns the twist of _rotation around y axis.
+math::Quaternion Heading(const math::Quaternion& _rotation) {
+  const float len2 = _rotation.y * _rotation.y + _rotation.w * _rotation.w;
+  if (len2 < 1e-12f) {
+    return math::Quaternion::identity();  // Half turn swing, no twist.
+  }
+  const float inv_len = 1.f / std::sqrt(len2);
+  return math::Quaternion(0.f, _rotation.y * inv_len, 0.f,
+                          _rotation.w * inv_len);
+}
+}  // namespace
+
+MotionExtractor::MotionExtractor()
+    : root_joint(0),
+      position_x(true),
+      position_y(false),
+      position_z(true),
+      heading(true),
+      bake(true) {}
+
+bool MotionExtractor::operator()(const RawAnimation& _input,
+                                 RawFloat3Track* _position,
+                                 RawQuaternionTrack* _rotation,
+                                 RawAnimation* _output) const {
+  if (!_position || !_rotation || !_output) {
+    return false;
+  }
+  if (!_input.Validate() || root_joint < 0 ||
+      root_joint >= _input.num_tracks()) {
+    return false;
+  }
+  const RawAnimation::JointTrack& track = _input.tracks[root_joint];
+
+  // Motion is keyed at every root translation and rotation key time.
+  ozz::vector<float> times;
+  for (const RawAnimation::TranslationKey& key : track.translations) {
+    times.push_back(key.time);
+  }
+  for (const RawAnimation::RotationKey& key : track.rotations) {
+    times.push_back(key.time);
+  }
+  if (times.empty()) {
+    times.push_back(0.f);
+  }
+  std::sort(times.begin(), times.end());
+  times.erase(std::unique(times.begin(), times.end()), times.end());
+
+  RawFloat3Track position;
+  RawQuaternionTrack rotation;
+  RawAnimation::JointTrack baked = track;
+  baked.translations.clear();
+  baked.rotations.clear();
+  for (const float time : times) {
+    math::Transform transform;
+    SampleTrack(track, time, &transform);
+
+    // Motion frame.
+    const math::Float3 motion_position(
+        position_x ? transform.translation.x : 0.f,
+        position_y ? transform.translation.y : 0.f,
+        position_z ? transform.translation.z : 0.f);
+    math::Quaternion motion_rotation =
+        heading ? Heading(transform.rotation) : math::Quaternion::identity();
+
+    // Keeps consecutive rotations in the same hemisphere, so they interpolate
+    // along the shortest path.
+    if (!rotation.keyframes.empty() &&
+        Dot(rotation.keyframes.back().value, motion_rotation) < 0.f) {
+      motion_rotation = -motion_rotation;
+    }
+
+    const float ratio = std::min(time / _input.duration, 1.f);
+    const RawFloat3Track::Keyframe position_key = {
+        RawTrackInterpolation::kLinear, ratio, motion_position};
+    position.keyframes.push_back(position_key);
+    const RawQuaternionTrack::Keyframe rotation_key = {
+        RawTrackInterpolation::kLinear, ratio, motion_rotation};
+    rotation.keyframes.push_back(rotation_key);
+
+    // Root transform relative to the motion frame.
+    const math::Quaternion inv_motion_rotation = Conjugate(motion_rotation);
+    const RawAnimation::TranslationKey translation_key = {
+        time, TransformVector(inv_motion_rotation,
+                              transform.translation - motion_position)};
+    baked.translations.push_back(translation_key);
+    const RawAnimation::RotationKey rotation_key_baked = {
+        time, inv_motion_rotation * transform.rotation};
+    baked.rotations.push_back(rotation_key_baked);
+  }
+
+  // Outputs. _output can alias _input, so it's written last.
+  *_position = std::move(position);
+  *_rotation = std::move(rotation);
+  if (_output != &_input) {
+    *_output = _input;
+  }
+  if (bake) {
+    _output->tracks[root_joint] = std::move(baked);
+  }
+  return true;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
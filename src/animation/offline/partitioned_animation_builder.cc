@@ -0,0 +1,83 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/partitioned_animation_builder.h"
+
+#include <algorithm>
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/partitioned_animation.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+PartitionedAnimationBuilder::PartitionedAnimationBuilder()
+    : partition_tracks(64) {}
+
+unique_ptr<PartitionedAnimation> PartitionedAnimationBuilder::operator()(
+    const RawAnimation& _input) const {
+  // Tests _raw_animation validity.
+  if (!_input.Validate() || partition_tracks <= 0) {
+    return nullptr;
+  }
+
+  const int num_tracks = _input.num_tracks();
+  const int partition_soa_tracks = (partition_tracks + 3) / 4;
+  const int partition_size = partition_soa_tracks * 4;
+  const int num_partitions =
+      (num_tracks + partition_size - 1) / partition_size;
+
+  unique_ptr<PartitionedAnimation> animation =
+      make_unique<PartitionedAnimation>();
+  animation->duration_ = _input.duration;
+  animation->num_tracks_ = num_tracks;
+  animation->partition_soa_tracks_ = partition_soa_tracks;
+  animation->name_ = _input.name.c_str();
+  animation->partitions_.resize(num_partitions);
+
+  RawAnimation partition;
+  partition.duration = _input.duration;
+  partition.name = _input.name;
+  for (int i = 0; i < num_partitions; ++i) {
+    const int begin = i * partition_size;
+    const int end = std::min(begin + partition_size, num_tracks);
+    partition.tracks.assign(_input.tracks.begin() + begin,
+                            _input.tracks.begin() + end);
+
+    unique_ptr<Animation> built = builder(partition);
+    if (!built) {
+      return nullptr;
+    }
+    animation->partitions_[i] = std::move(*built);
+  }
+  return animation;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,187 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/pose_atlas_builder.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/endianness.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+// Stores a 32 bits value in little endian.
+template <typename _Ty>
+void StoreLittleEndian(_Ty _value, byte* _dest) {
+  if (GetNativeEndianness() != kLittleEndian) {
+    _value = EndianSwap(_value);
+  }
+  std::memcpy(_dest, &_value, sizeof(_Ty));
+}
+
+// Writes the 3 rows of the affine part of _matrix to _dest texels.
+void StoreAtlasTexels(const math::Float4x4& _matrix, PoseAtlas::Format _format,
+                      byte* _dest) {
+  math::SimdFloat4 rows[4];
+  math::Transpose4x4(_matrix.cols, rows);
+  for (int r = 0; r < 3; ++r) {
+    float values[4];
+    math::StorePtrU(rows[r], values);
+    for (int c = 0; c < 4; ++c) {
+      if (_format == PoseAtlas::kHalf) {
+        StoreLittleEndian(math::FloatToHalf(values[c]), _dest);
+        _dest += sizeof(uint16_t);
+      } else {
+        StoreLittleEndian(values[c], _dest);
+        _dest += sizeof(float);
+      }
+    }
+  }
+}
+
+// Computes model-space matrices of _locals.
+bool ComputeModels(const Skeleton& _skeleton,
+                   span<const math::SoaTransform> _locals,
+                   span<math::Float4x4> _models) {
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = &_skeleton;
+  ltm_job.input = _locals;
+  ltm_job.output = _models;
+  return ltm_job.Run();
+}
+}  // namespace
+
+PoseAtlas::PoseAtlas()
+    : num_frames(0), num_joints(0), frame_rate(0.f), format(kHalf) {}
+
+size_t PoseAtlas::texel_size() const {
+  return 4 * (format == kHalf ? sizeof(uint16_t) : sizeof(float));
+}
+
+bool PoseAtlas::Write(io::Stream* _stream) const {
+  if (!_stream || !_stream->opened()) {
+    return false;
+  }
+  byte header[24];
+  StoreLittleEndian(static_cast<uint32_t>(kFileMagic), header + 0);
+  StoreLittleEndian(static_cast<uint32_t>(kFileVersion), header + 4);
+  StoreLittleEndian(static_cast<uint32_t>(num_frames), header + 8);
+  StoreLittleEndian(static_cast<uint32_t>(num_joints), header + 12);
+  StoreLittleEndian(static_cast<uint32_t>(format), header + 16);
+  StoreLittleEndian(frame_rate, header + 20);
+  if (_stream->Write(header, sizeof(header)) != sizeof(header)) {
+    return false;
+  }
+  return texels.empty() ||
+         _stream->Write(texels.data(), texels.size()) == texels.size();
+}
+
+PoseAtlasBuilder::PoseAtlasBuilder()
+    : frame_rate(30.f), format(PoseAtlas::kHalf), skinning(false) {}
+
+bool PoseAtlasBuilder::operator()(const Skeleton& _skeleton,
+                                  const Animation& _animation,
+                                  PoseAtlas* _atlas) const {
+  if (!_atlas) {
+    return false;
+  }
+  *_atlas = PoseAtlas();
+
+  const int num_joints = _skeleton.num_joints();
+  if (!(frame_rate > 0.f) || num_joints == 0 ||
+      _animation.num_tracks() != num_joints) {
+    return false;
+  }
+
+  // Both first and last frames are sampled, last one being clamped to
+  // animation duration.
+  const float duration = _animation.duration();
+  const int num_frames =
+      static_cast<int>(std::ceil(duration * frame_rate - 1e-4f)) + 1;
+
+  ozz::vector<math::SoaTransform> locals(_skeleton.num_soa_joints());
+  ozz::vector<math::Float4x4> models(num_joints);
+
+  // Computes inverse rest pose matrices, used for skinning.
+  ozz::vector<math::Float4x4> inv_rest(skinning ? num_joints : 0);
+  if (skinning) {
+    if (!ComputeModels(_skeleton, _skeleton.joint_rest_poses(),
+                       make_span(inv_rest))) {
+      return false;
+    }
+    for (math::Float4x4& matrix : inv_rest) {
+      matrix = math::Invert(matrix);
+    }
+  }
+
+  PoseAtlas atlas;
+  atlas.num_frames = num_frames;
+  atlas.num_joints = num_joints;
+  atlas.frame_rate = frame_rate;
+  atlas.format = format;
+  const size_t row_pitch = atlas.row_pitch();
+  const size_t texel_size = atlas.texel_size();
+  atlas.texels.resize(row_pitch * num_frames);
+
+  SamplingJob::Context context(num_joints, _animation.cubic());
+  SamplingJob sampling_job;
+  sampling_job.animation = &_animation;
+  sampling_job.context = &context;
+  sampling_job.output = make_span(locals);
+
+  for (int i = 0; i < num_frames; ++i) {
+    const float time = i / frame_rate;
+    sampling_job.ratio = duration > 0.f ? math::Min(time / duration, 1.f) : 0.f;
+    if (!sampling_job.Run() ||
+        !ComputeModels(_skeleton, make_span(locals), make_span(models))) {
+      return false;
+    }
+    byte* row = atlas.texels.data() + row_pitch * i;
+    for (int j = 0; j < num_joints; ++j) {
+      const math::Float4x4 matrix =
+          skinning ? models[j] * inv_rest[j] : models[j];
+      StoreAtlasTexels(matrix, format, row + texel_size * 3 * j);
+    }
+  }
+
+  *_atlas = std::move(atlas);
+  return true;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -30,6 +30,9 @@
 #include <algorithm>
 #include <limits>
 
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
 namespace ozz {
 namespace animation {
 namespace offline {
@@ -147,6 +150,144 @@ FixedRateSamplingTime::FixedRateSamplingTime(float _duration, float _frequency)
       period_(1.f / _frequency),
       num_keys_(static_cast<size_t>(std::ceil(1.f + _duration * _frequency))) {}
 
+namespace {
+
+OZZ_INLINE math::SimdFloat4 LoadValue(const math::Float3& _value) {
+  return math::simd_float4::Load3PtrU(&_value.x);
+}
+
+OZZ_INLINE math::SimdFloat4 LoadValue(const math::Quaternion& _value) {
+  return math::simd_float4::LoadPtrU(&_value.x);
+}
+
+// Finds the 2 keys of _track framing _time, and returns their values and
+// interpolation coefficient. Search starts from *_cursor, the left key of the
+// previous search, so that sequential times only walk forward a few keys. Keys
+// are the same as SampleComponent ones.
+template <typename _Track>
+float FrameKeys(const _Track& _track, float _time, uint32_t* _cursor,
+                math::SimdFloat4* _left, math::SimdFloat4* _right) {
+  typedef typename _Track::value_type Key;
+  if (_track.size() == 0) {
+    *_left = *_right = LoadValue(Key::identity());
+    return 0.f;
+  } else if (_time <= _track.front().time) {
+    *_left = *_right = LoadValue(_track.front().value);
+    return 0.f;
+  } else if (_time >= _track.back().time) {
+    *_left = *_right = LoadValue(_track.back().value);
+    return 0.f;
+  }
+
+  // front().time < _time < back().time, so there are at least 2 keys.
+  size_t cursor = *_cursor;
+  if (cursor >= _track.size() - 1 || !(_track[cursor].time < _time)) {
+    // Time went backward, cursor is reset.
+    const Key cmp = {_time, Key::identity()};
+    typename _Track::const_pointer it = std::lower_bound(
+        array_begin(_track), array_end(_track), cmp, Less<Key>);
+    assert(it > array_begin(_track) && it < array_end(_track));
+    cursor = static_cast<size_t>(it - array_begin(_track)) - 1;
+  } else {
+    while (_track[cursor + 1].time < _time) {
+      ++cursor;
+    }
+  }
+  *_cursor = static_cast<uint32_t>(cursor);
+
+  const Key& left = _track[cursor];
+  const Key& right = _track[cursor + 1];
+  *_left = LoadValue(left.value);
+  *_right = LoadValue(right.value);
+  return (_time - left.time) / (right.time - left.time);
+}
+}  // namespace
+
+RawAnimationSampler::RawAnimationSampler() : animation_(nullptr) {}
+
+bool RawAnimationSampler::Bind(const RawAnimation& _animation) {
+  if (!_animation.Validate()) {
+    animation_ = nullptr;
+    cursors_.clear();
+    return false;
+  }
+  animation_ = &_animation;
+  cursors_.assign(_animation.tracks.size() * 3, 0);
+  return true;
+}
+
+bool RawAnimationSampler::Sample(float _time,
+                                 const span<math::SoaTransform>& _output) {
+  if (!animation_) {
+    return false;
+  }
+  const int num_tracks = animation_->num_tracks();
+  const int num_soa_tracks = (num_tracks + 3) / 4;
+  if (_output.size() < static_cast<size_t>(num_soa_tracks)) {
+    return false;
+  }
+
+  for (int i = 0; i < num_soa_tracks; ++i) {
+    math::SimdFloat4 translations[2][4];
+    math::SimdFloat4 rotations[2][4];
+    math::SimdFloat4 scales[2][4];
+    float alphas[3][4];
+
+    // Gathers framing keys of 4 consecutive tracks, or what remains to be
+    // processed.
+    const int jmax = math::Min(num_tracks - i * 4, 4);
+    for (int j = 0; j < jmax; ++j) {
+      const int track = i * 4 + j;
+      const RawAnimation::JointTrack& src = animation_->tracks[track];
+      uint32_t* cursors = &cursors_[track * 3];
+      alphas[0][j] = FrameKeys(src.translations, _time, cursors + 0,
+                               &translations[0][j], &translations[1][j]);
+      alphas[1][j] = FrameKeys(src.rotations, _time, cursors + 1,
+                               &rotations[0][j], &rotations[1][j]);
+      alphas[2][j] = FrameKeys(src.scales, _time, cursors + 2, &scales[0][j],
+                               &scales[1][j]);
+    }
+    // Fills remaining lanes with identity.
+    for (int j = jmax; j < 4; ++j) {
+      translations[0][j] = translations[1][j] = math::simd_float4::zero();
+      rotations[0][j] = rotations[1][j] = math::simd_float4::w_axis();
+      scales[0][j] = scales[1][j] = math::simd_float4::one();
+      alphas[0][j] = alphas[1][j] = alphas[2][j] = 0.f;
+    }
+
+    // Transposes to SoA and interpolates 4 tracks at once.
+    math::SoaTransform left, right;
+    math::Transpose4x3(translations[0], &left.translation.x);
+    math::Transpose4x3(translations[1], &right.translation.x);
+    math::Transpose4x4(rotations[0], &left.rotation.x);
+    math::Transpose4x4(rotations[1], &right.rotation.x);
+    math::Transpose4x3(scales[0], &left.scale.x);
+    math::Transpose4x3(scales[1], &right.scale.x);
+
+    // Takes the shortest path between rotations, like LerpRotation.
+    const math::SoaQuaternion& lq = left.rotation;
+    const math::SoaQuaternion& rq = right.rotation;
+    const math::SimdFloat4 dot =
+        lq.x * rq.x + lq.y * rq.y + lq.z * rq.z + lq.w * rq.w;
+    const math::SimdInt4 sign =
+        math::And(math::CmpLt(dot, math::simd_float4::zero()),
+                  math::simd_int4::mask_sign());
+    const math::SoaQuaternion shortest = {
+        math::Xor(rq.x, sign), math::Xor(rq.y, sign), math::Xor(rq.z, sign),
+        math::Xor(rq.w, sign)};
+
+    math::SoaTransform& output = _output[i];
+    output.translation =
+        Lerp(left.translation, right.translation,
+             math::simd_float4::LoadPtrU(alphas[0]));
+    output.rotation = NLerp(lq, shortest,
+                            math::simd_float4::LoadPtrU(alphas[1]));
+    output.scale =
+        Lerp(left.scale, right.scale, math::simd_float4::LoadPtrU(alphas[2]));
+  }
+  return true;
+}
+
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
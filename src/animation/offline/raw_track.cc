@@ -117,6 +117,50 @@ template struct RawTrack<math::Float3>;
 template struct RawTrack<math::Float4>;
 template struct RawTrack<math::Quaternion>;
 }  // namespace internal
+
+RawMultiFloatTrack::RawMultiFloatTrack() : num_channels(0) {}
+
+bool RawMultiFloatTrack::Validate() const {
+  if (num_channels < 0) {
+    return false;
+  }
+  float previous_ratio = -1.f;
+  for (size_t k = 0; k < keyframes.size(); ++k) {
+    const Keyframe& keyframe = keyframes[k];
+    // Tests frame's ratio is in range [0:1].
+    if (keyframe.ratio < 0.f || keyframe.ratio > 1.f) {
+      return false;
+    }
+    // Tests that frames are sorted.
+    if (keyframe.ratio <= previous_ratio) {
+      return false;
+    }
+    previous_ratio = keyframe.ratio;
+
+    // Tests that all channels have a value.
+    if (keyframe.values.size() != static_cast<size_t>(num_channels)) {
+      return false;
+    }
+  }
+  return true;  // Validated.
+}
+
+bool RawEventTrack::Validate() const {
+  float previous_ratio = -1.f;
+  for (size_t k = 0; k < keyframes.size(); ++k) {
+    const float frame_ratio = keyframes[k].ratio;
+    // Tests frame's ratio is in range [0:1].
+    if (frame_ratio < 0.f || frame_ratio > 1.f) {
+      return false;
+    }
+    // Tests that frames are sorted.
+    if (frame_ratio <= previous_ratio) {
+      return false;
+    }
+    previous_ratio = frame_ratio;
+  }
+  return true;  // Validated.
+}
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
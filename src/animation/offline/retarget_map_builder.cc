@@ -0,0 +1,129 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/retarget_map_builder.h"
+
+#include "ozz/animation/runtime/retarget_map.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+// Finds the _rank-th child of _parent (or root if _parent is kNoParent),
+// returns Skeleton::kNoParent if there's none.
+int FindChild(const Skeleton& _skeleton, int _parent, int _rank) {
+  const span<const int16_t> parents = _skeleton.joint_parents();
+  for (int i = _parent + 1; i < _skeleton.num_joints(); ++i) {
+    if (parents[i] == _parent && _rank-- == 0) {
+      return i;
+    }
+  }
+  return Skeleton::kNoParent;
+}
+}  // namespace
+
+RetargetMapBuilder::RetargetMapBuilder() : matching(kName) {}
+
+unique_ptr<RetargetMap> RetargetMapBuilder::operator()(
+    const Skeleton& _source, const Skeleton& _target) const {
+  const int num_joints = _target.num_joints();
+  const span<const int16_t> parents = _target.joint_parents();
+  const span<const char* const> names = _target.joint_names();
+
+  unique_ptr<RetargetMap> map = make_unique<RetargetMap>();
+  map->num_source_joints_ = _source.num_joints();
+  map->joint_remaps_.assign(num_joints, Skeleton::kNoParent);
+
+  switch (matching) {
+    case kNone:
+      break;
+    case kName: {
+      // Uses name hashes, so that skeletons that don't store names strings
+      // can be matched too.
+      const span<const uint32_t> hashes = _target.joint_name_hashes();
+      for (int i = 0; i < num_joints; ++i) {
+        const char* name = names.empty() ? nullptr : names[i];
+        map->joint_remaps_[i] =
+            static_cast<int16_t>(_source.FindJointByHash(hashes[i], name));
+      }
+      break;
+    }
+    case kHierarchy: {
+      // Matches every joint by its rank among its siblings. Parents are
+      // always stored before their children.
+      for (int i = 0; i < num_joints; ++i) {
+        const int parent = parents[i];
+        int rank = 0;
+        for (int j = parent + 1; j < i; ++j) {
+          rank += parents[j] == parent;
+        }
+        const int source_parent =
+            parent == Skeleton::kNoParent ? parent : map->joint_remaps_[parent];
+        if (parent != Skeleton::kNoParent &&
+            source_parent == Skeleton::kNoParent) {
+          continue;  // Parent isn't mapped, so children aren't either.
+        }
+        map->joint_remaps_[i] =
+            static_cast<int16_t>(FindChild(_source, source_parent, rank));
+      }
+      break;
+    }
+  }
+
+  // Applies explicit mappings, in order.
+  for (const Mapping& mapping : mappings) {
+    int source = Skeleton::kNoParent;
+    if (!mapping.source.empty()) {
+      source = FindJoint(_source, mapping.source.c_str());
+      if (source == Skeleton::kNoParent) {
+        return nullptr;
+      }
+    }
+    if (names.empty()) {
+      // Without names strings, target can only be found from its hash.
+      const int target = FindJoint(_target, mapping.target.c_str());
+      if (target != Skeleton::kNoParent) {
+        map->joint_remaps_[target] = static_cast<int16_t>(source);
+      }
+      continue;
+    }
+    for (int i = 0; i < num_joints; ++i) {
+      if (strmatch(names[i], mapping.target.c_str())) {
+        map->joint_remaps_[i] = static_cast<int16_t>(source);
+      }
+    }
+  }
+
+  map->BuildSoaRemaps();
+  return map;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,318 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/sampling_access_analyzer.h"
+
+#include <algorithm>
+
+#include "ozz/animation/runtime/animation.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+
+// Simulation of a keys buffer, independent of the keys format.
+struct Buffer {
+  // Keys ratio and track, in runtime order.
+  ozz::vector<float> ratios;
+  ozz::vector<int> tracks;
+
+  // Size of a key, and of its tangent (0 if none).
+  size_t key_size;
+  size_t tangent_size;
+
+  // Key position in the simulated layout, and keys and tangents addresses.
+  ozz::vector<size_t> positions;
+  size_t key_base;
+  size_t tangent_base;
+
+  // SamplingJob cursor state: cursor position, left and right keys indices
+  // of every track, and outdated SoA entries.
+  int cursor;
+  ozz::vector<int> cache;
+  ozz::vector<bool> outdated;
+};
+
+// Extracts _keys to a new buffer of _buffers, unless _keys is empty.
+template <typename _Key>
+void Extract(const span<const _Key>& _keys, size_t _tangent_size,
+             ozz::vector<Buffer>* _buffers) {
+  if (_keys.empty()) {
+    return;
+  }
+  Buffer buffer;
+  buffer.key_size = sizeof(_Key);
+  buffer.tangent_size = _tangent_size;
+  for (const _Key& key : _keys) {
+    buffer.ratios.push_back(internal::KeyRatio(key));
+    buffer.tracks.push_back(key.track);
+  }
+  _buffers->push_back(std::move(buffer));
+}
+
+// Computes _buffer keys positions according to _layout.
+void LayOut(SamplingAccessAnalyzer::Layout _layout, float _chunk_ratio,
+            Buffer* _buffer) {
+  const size_t num_keys = _buffer->ratios.size();
+  ozz::vector<int> chunks(num_keys, 0);
+  if (_layout == SamplingAccessAnalyzer::kChunked) {
+    for (size_t i = 0; i < num_keys; ++i) {
+      chunks[i] = static_cast<int>(_buffer->ratios[i] / _chunk_ratio);
+    }
+  }
+
+  // Stable sorting keeps runtime order of keys within the same group.
+  ozz::vector<size_t> order(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    order[i] = i;
+  }
+  if (_layout != SamplingAccessAnalyzer::kSorted) {
+    std::stable_sort(order.begin(), order.end(),
+                     [&chunks, _buffer](size_t _a, size_t _b) {
+                       if (chunks[_a] != chunks[_b]) {
+                         return chunks[_a] < chunks[_b];
+                       }
+                       return _buffer->tracks[_a] < _buffer->tracks[_b];
+                     });
+  }
+  _buffer->positions.resize(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    _buffer->positions[order[i]] = i;
+  }
+}
+
+// Steps _buffer cursor to _ratio, restarting from the beginning if
+// _restart is true, as SamplingJob UpdateCacheCursor and
+// UpdateInterpKeyframes would. Indices of keys read are appended to _keys,
+// the ones that are decompressed to _decompressed. Returns the number of keys
+// the cursor advanced over.
+int Step(float _ratio, bool _restart, Buffer* _buffer,
+         ozz::vector<int>* _keys, ozz::vector<int>* _decompressed) {
+  const int num_tracks = static_cast<int>(_buffer->cache.size() / 2);
+  const int num_keys = static_cast<int>(_buffer->ratios.size());
+  ozz::vector<int>& cache = _buffer->cache;
+  if (_restart) {
+    // First 2 keys of every track are the 2 first rows of the buffer.
+    for (int i = 0; i < num_tracks; ++i) {
+      cache[i * 2] = i;
+      cache[i * 2 + 1] = i + num_tracks;
+    }
+    _buffer->cursor = num_tracks * 2;
+    std::fill(_buffer->outdated.begin(), _buffer->outdated.end(), true);
+  }
+
+  // Advances while the right key of cursor track is before _ratio.
+  const int forward = _buffer->cursor;
+  int& cursor = _buffer->cursor;
+  while (cursor < num_keys) {
+    const int track = _buffer->tracks[cursor];
+    const int right = cache[track * 2 + 1];
+    _keys->push_back(cursor);
+    _keys->push_back(right);
+    if (_buffer->ratios[right] > _ratio) {
+      break;
+    }
+    _buffer->outdated[track / 4] = true;
+    cache[track * 2] = right;
+    cache[track * 2 + 1] = cursor++;
+  }
+
+  // Outdated SoA entries decompress left and right keys of their 4 tracks.
+  for (size_t i = 0; i < _buffer->outdated.size(); ++i) {
+    if (!_buffer->outdated[i]) {
+      continue;
+    }
+    _buffer->outdated[i] = false;
+    for (size_t j = i * 8; j < i * 8 + 8; ++j) {
+      _keys->push_back(cache[j]);
+      _decompressed->push_back(cache[j]);
+    }
+  }
+  return cursor - forward;
+}
+
+// Appends the cache lines of memory range [_address, _address + _size[ to
+// _lines.
+void TouchLines(size_t _address, size_t _size, size_t _line_size,
+                ozz::vector<size_t>* _lines) {
+  for (size_t line = _address / _line_size;
+       line <= (_address + _size - 1) / _line_size; ++line) {
+    _lines->push_back(line);
+  }
+}
+
+// Sorts _values and removes duplicates.
+template <typename _Type>
+void SortUnique(ozz::vector<_Type>* _values) {
+  std::sort(_values->begin(), _values->end());
+  _values->erase(std::unique(_values->begin(), _values->end()),
+                 _values->end());
+}
+
+// Least recently used cache of _capacity lines.
+class LruCache {
+ public:
+  explicit LruCache(size_t _capacity) : capacity_(_capacity) {}
+
+  // Accesses _line, returns true if it was a miss.
+  bool Access(size_t _line) {
+    const auto it = std::find(lines_.begin(), lines_.end(), _line);
+    const bool miss = it == lines_.end();
+    if (!miss) {
+      lines_.erase(it);
+    }
+    lines_.push_back(_line);  // Most recently used last.
+    if (lines_.size() > capacity_) {
+      lines_.erase(lines_.begin());
+    }
+    return miss;
+  }
+
+ private:
+  size_t capacity_;
+  ozz::vector<size_t> lines_;
+};
+}  // namespace
+
+SamplingAccessAnalysis::SamplingAccessAnalysis()
+    : bytes(0), lines(0), misses(0), footprint(0) {}
+
+SamplingAccessAnalyzer::SamplingAccessAnalyzer()
+    : layout(kSorted),
+      chunk_duration(1.f),
+      cache_line_size(64),
+      cache_size(32 * 1024) {}
+
+bool SamplingAccessAnalyzer::operator()(
+    const Animation& _animation, span<const float> _ratios,
+    SamplingAccessAnalysis* _analysis) const {
+  if (!_analysis) {
+    return false;
+  }
+  *_analysis = SamplingAccessAnalysis();
+
+  // Validates analyzer.
+  if (layout < kSorted || layout > kChunked || !(chunk_duration > 0.f) ||
+      cache_line_size <= 0) {
+    return false;
+  }
+  const size_t line_size = static_cast<size_t>(cache_line_size);
+
+  // Extracts keys buffers, whatever their format.
+  ozz::vector<Buffer> buffers;
+  const size_t tangent_size =
+      _animation.cubic() ? 3 * sizeof(uint16_t) : size_t(0);
+  Extract(_animation.translations(), tangent_size, &buffers);
+  Extract(_animation.compact_translations(), tangent_size, &buffers);
+  Extract(_animation.rotations(), 0, &buffers);
+  Extract(_animation.compact_rotations(), 0, &buffers);
+  Extract(_animation.packed_rotations(), 0, &buffers);
+  Extract(_animation.scales(), tangent_size, &buffers);
+  Extract(_animation.compact_scales(), tangent_size, &buffers);
+  if (_animation.num_tracks() == 0) {
+    buffers.clear();  // Nothing is sampled.
+  }
+
+  // Lays out buffers consecutively, each one aligned to a cache line.
+  const float duration = _animation.duration();
+  const float chunk_ratio = duration > 0.f ? chunk_duration / duration : 1.f;
+  size_t address = 0;
+  for (Buffer& buffer : buffers) {
+    LayOut(layout, chunk_ratio, &buffer);
+    const size_t num_keys = buffer.ratios.size();
+    buffer.key_base = address;
+    address += (num_keys * buffer.key_size + line_size - 1) / line_size *
+               line_size;
+    buffer.tangent_base = address;
+    address += (num_keys * buffer.tangent_size + line_size - 1) /
+               line_size * line_size;
+    buffer.cursor = 0;
+    buffer.cache.resize(_animation.num_soa_tracks() * 4 * 2);
+    buffer.outdated.resize(_animation.num_soa_tracks());
+  }
+
+  // Replays ratios.
+  LruCache cache(cache_size / line_size);
+  ozz::vector<size_t> footprint;
+  ozz::vector<int> keys, decompressed;
+  ozz::vector<size_t> lines;
+  float previous = 0.f;
+  for (size_t i = 0; i < _ratios.size(); ++i) {
+    const float ratio = std::min(std::max(_ratios[i], 0.f), 1.f);
+    const bool restart = i == 0 || ratio < previous;
+    previous = ratio;
+
+    SamplingAccessAnalysis::Frame frame = {ratio, 0, 0, 0, 0, 0};
+    lines.clear();
+    for (Buffer& buffer : buffers) {
+      keys.clear();
+      decompressed.clear();
+      frame.keys_advanced +=
+          Step(ratio, restart, &buffer, &keys, &decompressed);
+      SortUnique(&keys);
+      SortUnique(&decompressed);
+      frame.keys_read += static_cast<int>(keys.size());
+      for (const int key : keys) {
+        TouchLines(buffer.key_base + buffer.positions[key] * buffer.key_size,
+                   buffer.key_size, line_size, &lines);
+      }
+      frame.bytes += keys.size() * buffer.key_size;
+      if (buffer.tangent_size) {
+        for (const int key : decompressed) {
+          TouchLines(
+              buffer.tangent_base + buffer.positions[key] * buffer.tangent_size,
+              buffer.tangent_size, line_size, &lines);
+        }
+        frame.bytes += decompressed.size() * buffer.tangent_size;
+      }
+    }
+    SortUnique(&lines);
+    frame.lines = static_cast<int>(lines.size());
+    for (const size_t line : lines) {
+      frame.misses += cache.Access(line);
+    }
+    footprint.insert(footprint.end(), lines.begin(), lines.end());
+
+    _analysis->bytes += frame.bytes;
+    _analysis->lines += frame.lines;
+    _analysis->misses += frame.misses;
+    _analysis->frames.push_back(frame);
+  }
+  SortUnique(&footprint);
+  _analysis->footprint = footprint.size() * line_size;
+
+  return true;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
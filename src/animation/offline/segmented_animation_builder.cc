@@ -0,0 +1,204 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/segmented_animation_builder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "ozz/animation/offline/animation_optimizer.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/segmented_animation.h"
+#include "ozz/base/maths/transform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+
+// Copies _src keys that are strictly inside ]_t0,_t1[ to _dest, shifting
+// their time by -_t0. Keys sampled with _value at _t0 and _t1 are added as
+// first and last keys. Empty and constant tracks are copied as is.
+template <typename _Keys, typename _Value>
+void CopySegmentKeys(const _Keys& _src, float _t0, float _t1,
+                     const _Value& _v0, const _Value& _v1, _Keys* _dest) {
+  typedef typename _Keys::value_type Key;
+  if (_src.size() <= 1) {
+    for (const Key& key : _src) {
+      const Key constant = {0.f, key.value};
+      _dest->push_back(constant);
+    }
+    return;
+  }
+  const float duration = _t1 - _t0;
+  const Key first = {0.f, _v0};
+  _dest->push_back(first);
+  for (const Key& key : _src) {
+    const float time = key.time - _t0;
+    if (time > 0.f && time < duration) {
+      const Key inner = {time, key.value};
+      _dest->push_back(inner);
+    }
+  }
+  const Key last = {duration, _v1};
+  _dest->push_back(last);
+}
+
+// Fills _segment with _input keys of time range [_t0,_t1], shifted by -_t0.
+// _input must be valid.
+void ExtractSegment(const RawAnimation& _input, float _t0, float _t1,
+                    RawAnimation* _segment) {
+  _segment->duration = _t1 - _t0;
+  _segment->tracks.resize(_input.tracks.size());
+  for (size_t j = 0; j < _input.tracks.size(); ++j) {
+    const RawAnimation::JointTrack& src = _input.tracks[j];
+    RawAnimation::JointTrack& dest = _segment->tracks[j];
+    dest.translations.clear();
+    dest.rotations.clear();
+    dest.scales.clear();
+
+    // Boundary keys are sampled from the raw track. Track was validated, so
+    // sampling can't fail.
+    math::Transform v0, v1;
+    SampleTrack(src, _t0, &v0);
+    SampleTrack(src, _t1, &v1);
+    CopySegmentKeys(src.translations, _t0, _t1, v0.translation,
+                    v1.translation, &dest.translations);
+    CopySegmentKeys(src.rotations, _t0, _t1, v0.rotation, v1.rotation,
+                    &dest.rotations);
+    CopySegmentKeys(src.scales, _t0, _t1, v0.scale, v1.scale, &dest.scales);
+  }
+}
+}  // namespace
+
+SegmentedAnimationBuilder::SegmentedAnimationBuilder()
+    : segment_duration(10.f), overlap(1.f), optimizer(nullptr) {}
+
+RawAnimationSource::~RawAnimationSource() {}
+
+unique_ptr<SegmentedAnimation> SegmentedAnimationBuilder::operator()(
+    const RawAnimation& _input) const {
+  // Tests _raw_animation validity.
+  if (!_input.Validate() || !(segment_duration > 0.f)) {
+    return nullptr;
+  }
+
+  unique_ptr<SegmentedAnimation> animation =
+      Allocate(_input.duration, _input.num_tracks(), _input.name.c_str());
+
+  RawAnimation segment;
+  for (int i = 0; i < animation->num_segments(); ++i) {
+    const float t0 = animation->ratios_[i] * _input.duration;
+    const float t1 = animation->ratios_[i + 1] * _input.duration;
+    ExtractSegment(_input, t0, t1, &segment);
+
+    unique_ptr<Animation> built = builder(segment);
+    if (!built) {
+      return nullptr;
+    }
+    animation->segments_[i] = std::move(*built);
+  }
+  return animation;
+}
+
+unique_ptr<SegmentedAnimation> SegmentedAnimationBuilder::operator()(
+    RawAnimationSource& _source, const Skeleton* _skeleton) const {
+  const float duration = _source.duration();
+  const int num_tracks = _source.num_tracks();
+  if (!(duration > 0.f) || num_tracks < 0 || !(segment_duration > 0.f) ||
+      !(overlap >= 0.f) || (optimizer && !_skeleton)) {
+    return nullptr;
+  }
+
+  const char* name = _source.name();
+  unique_ptr<SegmentedAnimation> animation =
+      Allocate(duration, num_tracks, name ? name : "");
+
+  // Buffers are reused from a window to the next, so memory is bounded by the
+  // biggest window.
+  RawAnimation window;
+  RawAnimation optimized;
+  RawAnimation segment;
+  for (int i = 0; i < animation->num_segments(); ++i) {
+    const float t0 = animation->ratios_[i] * duration;
+    const float t1 = animation->ratios_[i + 1] * duration;
+    const float w0 = std::max(t0 - overlap, 0.f);
+    const float w1 = std::min(t1 + overlap, duration);
+
+    window.tracks.clear();
+    window.duration = w1 - w0;
+    if (!_source.Read(w0, w1, &window) || window.num_tracks() != num_tracks ||
+        !window.Validate()) {
+      return nullptr;
+    }
+
+    const RawAnimation* input = &window;
+    if (optimizer) {
+      if (!(*optimizer)(window, *_skeleton, &optimized)) {
+        return nullptr;
+      }
+      input = &optimized;
+    }
+
+    // Segment is extracted from the window, whose keys times are relative to
+    // w0.
+    ExtractSegment(*input, t0 - w0, t1 - w0, &segment);
+    segment.duration = t1 - t0;
+
+    unique_ptr<Animation> built = builder(segment);
+    if (!built) {
+      return nullptr;
+    }
+    animation->segments_[i] = std::move(*built);
+  }
+  return animation;
+}
+
+unique_ptr<SegmentedAnimation> SegmentedAnimationBuilder::Allocate(
+    float _duration, int _num_tracks, const char* _name) const {
+  const int num_segments =
+      std::max(static_cast<int>(std::ceil(_duration / segment_duration)), 1);
+
+  unique_ptr<SegmentedAnimation> animation = make_unique<SegmentedAnimation>();
+  animation->duration_ = _duration;
+  animation->num_tracks_ = _num_tracks;
+  animation->name_ = _name;
+  animation->ratios_.resize(num_segments + 1);
+  animation->segments_.resize(num_segments);
+  for (int i = 0; i < num_segments; ++i) {
+    // Last boundary is set explicitly to avoid any floating point error.
+    animation->ratios_[i] = static_cast<float>(i) / num_segments;
+  }
+  animation->ratios_[num_segments] = 1.f;
+  return animation;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -34,6 +34,7 @@
 #include "ozz/base/containers/vector.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
 
 namespace ozz {
 namespace animation {
@@ -68,29 +69,59 @@ struct JointLister {
   // Array of joints in the traversed DAG order.
   ozz::vector<Joint> linear_joints;
 };
+
+// Lists _children contiguously, then recurses to each child's children, see
+// SkeletonBuilder::kSiblingsGrouped.
+void ListSiblingsGrouped(const RawSkeleton::Joint::Children& _children,
+                         const RawSkeleton::Joint* _parent,
+                         JointLister* _lister) {
+  for (const RawSkeleton::Joint& child : _children) {
+    (*_lister)(child, _parent);
+  }
+  for (const RawSkeleton::Joint& child : _children) {
+    ListSiblingsGrouped(child.children, &child, _lister);
+  }
+}
 }  // namespace
 
+SkeletonBuilder::SkeletonBuilder() : ordering(kDepthFirst) {}
+
 // Validates the RawSkeleton and fills a Skeleton.
-// Uses RawSkeleton::IterateJointsDF to traverse in DAG depth-first order.
-// Building skeleton hierarchy in depth first order make it easier to iterate a
-// skeleton sub-hierarchy.
+// Uses RawSkeleton::IterateJointsDF to traverse in DAG depth-first order by
+// default. Building skeleton hierarchy in depth first order make it easier to
+// iterate a skeleton sub-hierarchy.
 unique_ptr<ozz::animation::Skeleton> SkeletonBuilder::operator()(
     const RawSkeleton& _raw_skeleton) const {
-  // Tests _raw_skeleton validity.
-  if (!_raw_skeleton.Validate()) {
+  unique_ptr<ozz::animation::Skeleton> skeleton = make_unique<Skeleton>();
+  if (!(*this)(_raw_skeleton, skeleton.get())) {
     return nullptr;
   }
+  return skeleton;
+}
 
-  // Everything is fine, allocates and fills the skeleton.
-  // Will not fail.
-  unique_ptr<ozz::animation::Skeleton> skeleton = make_unique<Skeleton>();
+bool SkeletonBuilder::operator()(const RawSkeleton& _raw_skeleton,
+                                 Skeleton* _skeleton) const {
+  const memory::TagScope memory_tag(memory::kTagOffline);
+  // Tests _raw_skeleton validity.
+  if (!_skeleton || !_raw_skeleton.Validate()) {
+    return false;
+  }
+
+  // Everything is fine, releases previous skeleton data, then allocates and
+  // fills the skeleton. Will not fail.
+  Skeleton* skeleton = _skeleton;
+  skeleton->Deallocate();
   const int num_joints = _raw_skeleton.num_joints();
 
   // Iterates through all the joint of the raw skeleton and fills a sorted joint
   // list.
   // Iteration order defines runtime skeleton joint ordering.
   JointLister lister(num_joints);
-  IterateJointsDF<JointLister&>(_raw_skeleton, lister);
+  if (ordering == kSiblingsGrouped) {
+    ListSiblingsGrouped(_raw_skeleton.roots, nullptr, &lister);
+  } else {
+    IterateJointsDF<JointLister&>(_raw_skeleton, lister);
+  }
   assert(static_cast<int>(lister.linear_joints.size()) == num_joints);
 
   // Computes name's buffer size.
@@ -103,19 +134,27 @@ unique_ptr<ozz::animation::Skeleton> SkeletonBuilder::operator()(
   // Allocates all skeleton members.
   char* cursor = skeleton->Allocate(chars_size, num_joints);
 
-  // Copy names. All names are allocated in a single buffer. Only the first name
-  // is set, all other names array entries must be initialized.
+  // Copy names, if skeleton stores them. All names are allocated in a single
+  // buffer. Only the first name is set, all other names array entries must be
+  // initialized.
   for (int i = 0; i < num_joints; ++i) {
     const RawSkeleton::Joint& current = *lister.linear_joints[i].joint;
-    skeleton->joint_names_[i] = cursor;
-    strcpy(cursor, current.name.c_str());
-    cursor += (current.name.size() + 1) * sizeof(char);
+    skeleton->joint_name_hashes_[i] = Skeleton::HashName(current.name.c_str());
+    if (cursor) {
+      skeleton->joint_names_[i] = cursor;
+      strcpy(cursor, current.name.c_str());
+      cursor += (current.name.size() + 1) * sizeof(char);
+    }
   }
+  skeleton->BuildNameTable();
 
   // Transfers sorted joints hierarchy to the new skeleton.
   for (int i = 0; i < num_joints; ++i) {
     skeleton->joint_parents_[i] = lister.linear_joints[i].parent;
   }
+  const bool topology = skeleton->BuildTopology();
+  (void)topology;
+  assert(topology && "Parents are listed before their children");
 
   // Transfers t-poses.
   const math::SimdFloat4 w_axis = math::simd_float4::w_axis();
@@ -149,7 +188,7 @@ unique_ptr<ozz::animation::Skeleton> SkeletonBuilder::operator()(
     math::Transpose4x3(scales, &skeleton->joint_rest_poses_[i].scale.x);
   }
 
-  return skeleton;  // Success.
+  return true;  // Success.
 }
 }  // namespace offline
 }  // namespace animation
@@ -0,0 +1,95 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/skeleton_lod_builder.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_lod.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+SkeletonLODBuilder::SkeletonLODBuilder() : max_depth(Skeleton::kMaxJoints) {}
+
+unique_ptr<SkeletonLOD> SkeletonLODBuilder::operator()(
+    const Skeleton& _skeleton) const {
+  if (max_depth < 0) {
+    return nullptr;
+  }
+
+  const int num_joints = _skeleton.num_joints();
+  const span<const int16_t> parents = _skeleton.joint_parents();
+  const span<const char* const> names = _skeleton.joint_names();
+
+  // Activates joints according to their depth. Parents are always stored
+  // before their children.
+  ozz::vector<int> depths(num_joints);
+  ozz::vector<bool> active(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = parents[i];
+    depths[i] = parent == Skeleton::kNoParent ? 0 : depths[parent] + 1;
+    active[i] = depths[i] <= max_depth;
+  }
+
+  // Applies overrides, in order.
+  for (const Override& entry : overrides) {
+    for (int i = 0; i < num_joints; ++i) {
+      if (strmatch(names[i], entry.name.c_str())) {
+        active[i] = entry.active;
+      }
+    }
+  }
+
+  // Activates ancestors of active joints, iterating from the leaves so the
+  // whole chain is activated in a single pass.
+  for (int i = num_joints - 1; i >= 0; --i) {
+    const int parent = parents[i];
+    if (active[i] && parent != Skeleton::kNoParent) {
+      active[parent] = true;
+    }
+  }
+
+  // Remaps every joint to itself if it's active, or to its parent remap.
+  unique_ptr<SkeletonLOD> lod = make_unique<SkeletonLOD>();
+  lod->joint_remaps_.resize(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = parents[i];
+    if (active[i]) {
+      lod->joint_remaps_[i] = static_cast<int16_t>(i);
+    } else if (parent == Skeleton::kNoParent) {
+      lod->joint_remaps_[i] = Skeleton::kNoParent;
+    } else {
+      lod->joint_remaps_[i] = lod->joint_remaps_[parent];
+    }
+  }
+  lod->BuildMasks();
+  return lod;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,188 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/synthetic_generator.h"
+
+#include <cmath>
+#include <cstdio>
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+// Generates joint _index and its children, whose indices in breadth-first
+// order are [_index * _fan_out + 1, _index * _fan_out + _fan_out].
+void GenerateJoint(int64_t _index, int _rank, int _count, int _fan_out,
+                   float _bone_length, RawSkeleton::Joint* _joint) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "joint%d", static_cast<int>(_index));
+  _joint->name = name;
+
+  // Children spread around their parent y axis.
+  _joint->transform = math::Transform::identity();
+  if (_index != 0) {
+    const float angle = (_rank - (_fan_out - 1) * .5f) * .5f;
+    _joint->transform.translation = math::Float3(
+        std::sin(angle) * _bone_length, std::cos(angle) * _bone_length, 0.f);
+    _joint->transform.rotation =
+        math::Quaternion::FromAxisAngle(math::Float3::y_axis(), _rank * .2f);
+  }
+
+  const int64_t first = _index * _fan_out + 1;
+  const int num_children =
+      static_cast<int>(math::Clamp<int64_t>(0, _count - first, _fan_out));
+  _joint->children.resize(num_children);
+  for (int i = 0; i < num_children; ++i) {
+    GenerateJoint(first + i, i, _count, _fan_out, _bone_length,
+                  &_joint->children[i]);
+  }
+}
+
+// Linear congruential generator, providing deterministic noise.
+class Noise {
+ public:
+  explicit Noise(uint32_t _seed) : state_(_seed) {}
+
+  // Returns a pseudo random value in range [-1,1].
+  float Next() {
+    state_ = state_ * 1664525u + 1013904223u;
+    return static_cast<float>(state_ >> 8) / static_cast<float>(1 << 23) - 1.f;
+  }
+
+  math::Float3 Next3() {
+    const float x = Next();
+    const float y = Next();
+    return math::Float3(x, y, Next());
+  }
+
+ private:
+  uint32_t state_;
+};
+}  // namespace
+
+SyntheticSkeletonGenerator::SyntheticSkeletonGenerator()
+    : num_joints(64), fan_out(3), depth(0), bone_length(.1f) {}
+
+bool SyntheticSkeletonGenerator::operator()(RawSkeleton* _skeleton) const {
+  _skeleton->roots.clear();
+  if (num_joints < 0 || num_joints > Skeleton::kMaxJoints || fan_out < 1 ||
+      depth < 0) {
+    return false;
+  }
+
+  // Stops at the number of joints of the complete tree.
+  int count = num_joints;
+  if (depth != 0) {
+    int64_t total = 0;
+    int64_t level = 1;
+    for (int d = 0; d < depth && total < count; ++d) {
+      total += level;
+      level *= fan_out;
+    }
+    count = static_cast<int>(math::Min<int64_t>(count, total));
+  }
+
+  if (count != 0) {
+    _skeleton->roots.resize(1);
+    GenerateJoint(0, 0, count, fan_out, bone_length, &_skeleton->roots[0]);
+  }
+  return true;
+}
+
+SyntheticAnimationGenerator::SyntheticAnimationGenerator()
+    : duration(2.f),
+      key_frequency(30.f),
+      amplitude(.5f),
+      noise(.01f),
+      seed(0) {}
+
+bool SyntheticAnimationGenerator::operator()(const RawSkeleton& _skeleton,
+                                             RawAnimation* _animation) const {
+  _animation->tracks.clear();
+  _animation->name.clear();
+  if (!(duration > 0.f) || !(key_frequency > 0.f) || !(amplitude >= 0.f) ||
+      !(noise >= 0.f)) {
+    return false;
+  }
+
+  // Lists joints in runtime skeleton order.
+  ozz::vector<const RawSkeleton::Joint*> joints;
+  IterateJointsDF(_skeleton,
+                  [&joints](const RawSkeleton::Joint& _joint,
+                            const RawSkeleton::Joint*) {
+                    joints.push_back(&_joint);
+                  });
+
+  _animation->duration = duration;
+  _animation->tracks.resize(joints.size());
+  const int num_keys =
+      math::Max(2, static_cast<int>(std::ceil(duration * key_frequency)) + 1);
+  Noise rand(seed);
+  for (size_t i = 0; i < joints.size(); ++i) {
+    const math::Transform& rest = joints[i]->transform;
+    RawAnimation::JointTrack& track = _animation->tracks[i];
+    track.translations.resize(num_keys);
+    track.rotations.resize(num_keys);
+    track.scales.resize(num_keys);
+
+    // Every joint rotates around its own axis, with its own phase. Motion
+    // loops over the animation duration.
+    const float fi = static_cast<float>(i);
+    const math::Float3 axis =
+        Normalize(math::Float3(std::sin(fi), 1.f, std::cos(fi)));
+    const float phase = fi * .7f;
+    const float translation_noise = Length(rest.translation) * noise;
+
+    for (int k = 0; k < num_keys; ++k) {
+      const float ratio = static_cast<float>(k) / (num_keys - 1);
+      const float time = ratio * duration;
+      const float angle = amplitude * std::sin(phase + ratio * math::k2Pi) +
+                          noise * rand.Next();
+      const RawAnimation::TranslationKey tkey = {
+          time, rest.translation + rand.Next3() * translation_noise};
+      track.translations[k] = tkey;
+      const RawAnimation::RotationKey rkey = {
+          time, rest.rotation * math::Quaternion::FromAxisAngle(axis, angle)};
+      track.rotations[k] = rkey;
+      const RawAnimation::ScaleKey skey = {time,
+                                           rest.scale + rand.Next3() * noise};
+      track.scales[k] = skey;
+    }
+  }
+  return true;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,158 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/timeline_animation_builder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/timeline_animation.h"
+#include "ozz/base/containers/vector.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+
+// Appends keys ratios to _ratios.
+template <typename _Key>
+void PushRatios(span<const _Key> _keys, ozz::vector<float>* _ratios) {
+  for (const _Key& key : _keys) {
+    _ratios->push_back(key.ratio);
+  }
+}
+
+void CopyValue(const Float3Key& _src, TimelineFloat3Key* _dest) {
+  std::memcpy(_dest->value, _src.value, sizeof(_dest->value));
+}
+
+void CopyValue(const QuaternionKey& _src, TimelineQuaternionKey* _dest) {
+  _dest->largest = _src.largest;
+  _dest->sign = _src.sign;
+  std::memcpy(_dest->value, _src.value, sizeof(_dest->value));
+}
+
+// Dispatches _keys values to their track, setting presence bit of the frame
+// they belong to. Keys of a track are sorted by ratio in the Animation, so
+// values of each track end up sorted by frame.
+template <typename _Key, typename _Value>
+void FillChannel(span<const _Key> _keys, span<const float> _ratios,
+                 int _num_words, span<uint32_t> _presence,
+                 span<uint32_t> _offsets, span<_Value> _values) {
+  if (_offsets.empty()) {
+    return;  // No track.
+  }
+  const size_t num_tracks = _offsets.size() - 1;
+
+  // Counts keys of each track, shifted by one track.
+  std::fill(_offsets.begin(), _offsets.end(), 0u);
+  for (const _Key& key : _keys) {
+    ++_offsets[key.track + 1];
+  }
+  for (size_t i = 0; i < num_tracks; ++i) {
+    _offsets[i + 1] += _offsets[i];
+  }
+
+  // Dispatches keys, using a copy of offsets as track cursors.
+  ozz::vector<uint32_t> cursors(_offsets.begin(), _offsets.end() - 1);
+  std::fill(_presence.begin(), _presence.end(), 0u);
+  for (const _Key& key : _keys) {
+    const int frame = static_cast<int>(
+        std::lower_bound(_ratios.begin(), _ratios.end(), key.ratio) -
+        _ratios.begin());
+    assert(_ratios[frame] == key.ratio);
+    _presence[key.track * _num_words + frame / 32] |= 1u << (frame % 32);
+    CopyValue(key, &_values[cursors[key.track]++]);
+  }
+}
+}  // namespace
+
+unique_ptr<TimelineAnimation> TimelineAnimationBuilder::operator()(
+    const RawAnimation& _input) const {
+  // Builds an Animation with default settings first, reusing its keys
+  // filling, normalization and compression.
+  const AnimationBuilder builder;
+  const unique_ptr<Animation> animation = builder(_input);
+  if (!animation) {
+    return nullptr;
+  }
+  assert(animation->compact_translations().empty() &&
+         animation->compact_rotations().empty() &&
+         animation->packed_rotations().empty() &&
+         animation->compact_scales().empty());
+
+  // Builds the shared frames row, from all keys ratios.
+  ozz::vector<float> ratios;
+  PushRatios(animation->translations(), &ratios);
+  PushRatios(animation->rotations(), &ratios);
+  PushRatios(animation->scales(), &ratios);
+  std::sort(ratios.begin(), ratios.end());
+  ratios.erase(std::unique(ratios.begin(), ratios.end()), ratios.end());
+
+  // Allocates timeline animation.
+  unique_ptr<TimelineAnimation> timeline = make_unique<TimelineAnimation>();
+  const TimelineAnimation::AllocatorParams params{
+      _input.name.size(),
+      animation->num_tracks(),
+      ratios.size(),
+      animation->translations().size(),
+      animation->rotations().size(),
+      animation->scales().size()};
+  timeline->Allocate(params);
+  timeline->duration_ = animation->duration();
+  if (timeline->name_) {
+    std::strcpy(timeline->name_, _input.name.c_str());
+  }
+  std::copy(ratios.begin(), ratios.end(), timeline->ratios_.begin());
+
+  // Fills channels.
+  const int num_words = timeline->num_presence_words();
+  FillChannel(animation->translations(), timeline->ratios_, num_words,
+              timeline->translation_presence_, timeline->translation_offsets_,
+              timeline->translations_);
+  FillChannel(animation->rotations(), timeline->ratios_, num_words,
+              timeline->rotation_presence_, timeline->rotation_offsets_,
+              timeline->rotations_);
+  FillChannel(animation->scales(), timeline->ratios_, num_words,
+              timeline->scale_presence_, timeline->scale_offsets_,
+              timeline->scales_);
+
+  assert(timeline->Validate());
+
+  return timeline;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -30,18 +30,29 @@
 #include <json/json.h>
 
 #include <algorithm>
+#include <cctype>
 #include <cstdlib>
 #include <cstring>
+#include <iostream>
 
 #include "animation/offline/tools/import2ozz_anim.h"
 #include "animation/offline/tools/import2ozz_config.h"
+#include "animation/offline/tools/import2ozz_profile.h"
 #include "animation/offline/tools/import2ozz_skel.h"
 #include "ozz/base/io/stream.h"
 #include "ozz/base/log.h"
 #include "ozz/options/options.h"
 
 // Declares command line options.
-OZZ_OPTIONS_DECLARE_STRING(file, "Specifies input file", "", true)
+OZZ_OPTIONS_DECLARE_STRING(
+    file,
+    "Specifies input file. Prefixing it with '@' specifies a manifest file "
+    "instead, listing input files one per line, which are all imported by "
+    "this single process with the same configuration. \"-\" reads jobs from "
+    "standard input instead, one per line, keeping this process alive until "
+    "the end of the input stream. A job line is either an input file name or "
+    "command line arguments overriding this process ones.",
+    "", true)
 
 static bool ValidateEndianness(const ozz::options::Option& _option,
                                int /*_argc*/) {
@@ -95,6 +106,12 @@ OZZ_OPTIONS_DECLARE_STRING_FN(
     "Selects log level. Can be \"silent\", \"standard\" or \"verbose\".",
     "standard", false, &ValidateLogLevel)
 
+OZZ_OPTIONS_DECLARE_BOOL(
+    log_async,
+    "Writes logs asynchronously from a background thread, so that verbose "
+    "logging doesn't stall import.",
+    false, false)
+
 void InitializeLogLevel() {
   ozz::log::Level log_level = ozz::log::GetLevel();
   if (std::strcmp(OPTIONS_log_level, "silent") == 0) {
@@ -112,53 +129,351 @@ namespace ozz {
 namespace animation {
 namespace offline {
 
-int OzzImporter::operator()(int _argc, const char** _argv) {
-  // Parses arguments.
-  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+namespace {
+// Reads input files listed in manifest _filename, one per line. Empty lines
+// and lines starting with '#' are ignored.
+bool ReadManifest(const char* _filename, ozz::vector<ozz::string>* _files) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open manifest file: \"" << _filename
+                    << "\"." << std::endl;
+    return false;
+  }
+  ozz::string content(file.Size(), '\0');
+  if (file.Read(&content[0], content.size()) != content.size()) {
+    ozz::log::Err() << "Failed to read manifest file: \"" << _filename
+                    << "\"." << std::endl;
+    return false;
+  }
+
+  for (size_t begin = 0; begin < content.size();) {
+    size_t end = content.find('\n', begin);
+    if (end == ozz::string::npos) {
+      end = content.size();
+    }
+    // Trims surrounding whitespaces, including windows '\r' line endings.
+    size_t first = begin;
+    size_t last = end;
+    while (first < last &&
+           std::isspace(static_cast<unsigned char>(content[first]))) {
+      ++first;
+    }
+    while (last > first &&
+           std::isspace(static_cast<unsigned char>(content[last - 1]))) {
+      --last;
+    }
+    if (first < last && content[first] != '#') {
+      _files->push_back(content.substr(first, last - first));
+    }
+    begin = end + 1;
+  }
+  if (_files->empty()) {
+    ozz::log::Err() << "Manifest file \"" << _filename
+                    << "\" doesn't list any input file." << std::endl;
+    return false;
+  }
+  return true;
+}
+
+// Imports skeleton and animations from file _filename, according to _config.
+bool ImportFile(OzzImporter* _importer, const Json::Value& _config,
+                ozz::Endianness _endianness, const char* _filename) {
+  // Ensures file to import actually exist.
+  if (!ozz::io::File::Exist(_filename)) {
+    ozz::log::Err() << "File \"" << _filename << "\" doesn't exist."
+                    << std::endl;
+    return false;
+  }
+
+  // Imports animations from the document.
+  ozz::log::Log() << "Importing file \"" << _filename << "\"" << std::endl;
+  if (!_importer->Load(_filename)) {
+    ozz::log::Err() << "Failed to import file \"" << _filename << "\"."
+                    << std::endl;
+    return false;
+  }
+
+  // Handles skeleton import processing
+  if (!ImportSkeleton(_config, _importer, _endianness)) {
+    return false;
+  }
+
+  // Handles animations import processing
+  return ImportAnimations(_config, _importer, _endianness, _filename);
+}
+
+// Imports OPTIONS_file, which is either a single file or a '@' manifest.
+bool ImportInput(OzzImporter* _importer, const Json::Value& _config,
+                 ozz::Endianness _endianness) {
+  // A single input file.
+  if (OPTIONS_file.value()[0] != '@') {
+    return ImportFile(_importer, _config, _endianness, OPTIONS_file);
+  }
+
+  // Batch imports manifest files, sharing the configuration processed once.
+  // Failing files don't prevent others from being imported.
+  ozz::vector<ozz::string> files;
+  if (!ReadManifest(OPTIONS_file.value() + 1, &files)) {
+    return false;
+  }
+  size_t failures = 0;
+  for (const ozz::string& file : files) {
+    failures += !ImportFile(_importer, _config, _endianness, file.c_str());
+  }
+  ozz::log::Log() << "Imported " << files.size() - failures << " of "
+                  << files.size() << " manifest files." << std::endl;
+  if (failures != 0) {
+    ozz::log::Err() << failures << " manifest file(s) failed to import."
+                    << std::endl;
+    return false;
+  }
+  return true;
+}
+
+ozz::options::ParseResult ParseArguments(int _argc, const char* const* _argv) {
+  return ozz::options::ParseCommandLine(
       _argc, _argv, "2.0",
       "Imports skeleton and animations from a file and converts it to ozz "
       "binary raw or runtime data format.");
+}
+
+// Returns the name of the option specified by argument _arg, stripped of its
+// leading dashes and of its value.
+ozz::string OptionName(const ozz::string& _arg) {
+  const size_t begin = _arg.find_first_not_of('-');
+  if (begin == ozz::string::npos) {
+    return ozz::string();
+  }
+  return _arg.substr(begin, _arg.find('=', begin) - begin);
+}
+
+// Returns true if job argument _arg overrides base argument _base. Boolean
+// --option and --nooption forms override each other, and so do config and
+// config_file, as they are exclusive.
+bool Overrides(const ozz::string& _arg, const ozz::string& _base) {
+  const ozz::string arg = OptionName(_arg);
+  const ozz::string base = OptionName(_base);
+  return arg == base || "no" + arg == base || arg == "no" + base ||
+         ((arg == "config" || arg == "config_file") &&
+          (base == "config" || base == "config_file"));
+}
+
+// Splits job _line into arguments, separated by whitespaces. Arguments can be
+// surrounded by single quotes, which are kept verbatim (convenient for json
+// configurations), or by double quotes, where '\' escapes the next character
+// as it does outside of quotes. Returns false if a quote isn't terminated.
+bool SplitJob(const ozz::string& _line, ozz::vector<ozz::string>* _args) {
+  ozz::string arg;
+  bool pending = false;
+  for (size_t i = 0; i < _line.size(); ++i) {
+    const char c = _line[i];
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      if (pending) {
+        _args->push_back(arg);
+        arg.clear();
+        pending = false;
+      }
+    } else if (c == '\'') {
+      const size_t end = _line.find('\'', i + 1);
+      if (end == ozz::string::npos) {
+        return false;
+      }
+      arg.append(_line, i + 1, end - i - 1);
+      pending = true;
+      i = end;
+    } else if (c == '"') {
+      for (++i; i < _line.size() && _line[i] != '"'; ++i) {
+        if (_line[i] == '\\' && i + 1 < _line.size()) {
+          ++i;
+        }
+        arg += _line[i];
+      }
+      if (i == _line.size()) {
+        return false;
+      }
+      pending = true;
+    } else {
+      if (c == '\\' && i + 1 < _line.size()) {
+        ++i;
+      }
+      arg += _line[i];
+      pending = true;
+    }
+  }
+  if (pending) {
+    _args->push_back(arg);
+  }
+  return true;
+}
+
+// Builds job arguments from _line. A line that doesn't start with '-' is an
+// input file (or '@' manifest) name, other lines list command line
+// arguments. Job arguments override _base ones with the same option name,
+// other _base arguments are kept.
+bool BuildJob(const ozz::string& _line, const ozz::vector<ozz::string>& _base,
+              ozz::vector<ozz::string>* _args) {
+  ozz::vector<ozz::string> job;
+  if (_line[0] != '-') {
+    job.push_back("--file=" + _line);
+  } else if (!SplitJob(_line, &job)) {
+    ozz::log::Err() << "Unterminated quote in job: " << _line << std::endl;
+    return false;
+  }
+
+  _args->assign(1, _base[0]);  // Program path.
+  for (size_t i = 1; i < _base.size(); ++i) {
+    bool overridden = false;
+    for (const ozz::string& arg : job) {
+      overridden |= Overrides(arg, _base[i]);
+    }
+    if (!overridden) {
+      _args->push_back(_base[i]);
+    }
+  }
+  _args->insert(_args->end(), job.begin(), job.end());
+  return true;
+}
+
+// Configuration shared by consecutive jobs.
+struct JobConfig {
+  bool valid = false;
+  // Concatenation of the configuration arguments config was processed from.
+  ozz::string key;
+  Json::Value config;
+};
+
+// Runs a single job, whose arguments are _args. Configuration is processed
+// again only if configuration arguments differ from the previous job ones.
+bool RunJob(OzzImporter* _importer, const ozz::vector<ozz::string>& _args,
+            JobConfig* _config) {
+  ozz::vector<const char*> argv;
+  for (const ozz::string& arg : _args) {
+    argv.push_back(arg.c_str());
+  }
+  const ozz::options::ParseResult parse_result =
+      ParseArguments(static_cast<int>(argv.size()), argv.data());
   if (parse_result != ozz::options::kSuccess) {
-    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
-                                                      : EXIT_FAILURE;
+    return parse_result == ozz::options::kExitSuccess;
+  }
+  if (std::strcmp(OPTIONS_file, "-") == 0) {
+    ozz::log::Err() << "A job can't read jobs from standard input."
+                    << std::endl;
+    return false;
   }
 
-  // Initialize general executable options.
   InitializeLogLevel();
   const ozz::Endianness endianness = InitializeEndianness();
 
-  Json::Value config;
-  if (!ProcessConfiguration(&config)) {
-    // Specific error message are reported during configuration processing.
-    return EXIT_FAILURE;
+  ozz::string config_key;
+  for (const ozz::string& arg : _args) {
+    if (OptionName(arg).compare(0, 6, "config") == 0) {
+      config_key += arg;
+      config_key += '\n';
+    }
+  }
+  if (!_config->valid || config_key != _config->key) {
+    _config->config = Json::Value();
+    _config->valid = ProcessConfiguration(&_config->config);
+    _config->key = config_key;
+    if (!_config->valid) {
+      return false;
+    }
   }
 
-  // Ensures file to import actually exist.
-  if (!ozz::io::File::Exist(OPTIONS_file)) {
-    ozz::log::Err() << "File \"" << OPTIONS_file << "\" doesn't exist."
-                    << std::endl;
-    return EXIT_FAILURE;
+  // Profiles are reported per job.
+  const bool imported = ImportInput(_importer, _config->config, endianness);
+  const bool profiled = WriteProfile();
+  ClearProfiles();
+  return imported && profiled;
+}
+
+// Enables asynchronous logging for the scope of the import if required by
+// --log_async option.
+class AsyncLogScope {
+ public:
+  AsyncLogScope() : enabled_(OPTIONS_log_async && ozz::log::EnableAsync()) {}
+  ~AsyncLogScope() {
+    if (enabled_) {
+      ozz::log::DisableAsync();
+    }
   }
 
-  // Imports animations from the document.
-  ozz::log::Log() << "Importing file \"" << OPTIONS_file << "\"" << std::endl;
-  if (!Load(OPTIONS_file)) {
-    ozz::log::Err() << "Failed to import file \"" << OPTIONS_file << "\"."
-                    << std::endl;
-    return EXIT_FAILURE;
+ private:
+  const bool enabled_;
+};
+
+// Runs jobs read from standard input, one per line, until the end of the
+// stream. Empty lines and lines starting with '#' are ignored. Outputs a
+// status line on standard output after each job, whatever the log level, so
+// a driving process knows when a job is completed. The final summary is output
+// to the same stream, so it's ordered after all status lines.
+int RunJobs(OzzImporter* _importer, int _argc, const char** _argv) {
+  ozz::vector<ozz::string> base;
+  for (int i = 0; i < _argc; ++i) {
+    if (i == 0 || OptionName(_argv[i]) != "file") {
+      base.push_back(_argv[i]);
+    }
   }
 
-  // Handles skeleton import processing
-  if (!ImportSkeleton(config, this, endianness)) {
+  size_t jobs = 0;
+  size_t failures = 0;
+  JobConfig config;
+  ozz::vector<ozz::string> args;
+  for (std::string line; std::getline(std::cin, line);) {
+    const size_t first = line.find_first_not_of(" \t\r\n");
+    const size_t last = line.find_last_not_of(" \t\r\n");
+    if (first == std::string::npos || line[first] == '#') {
+      continue;
+    }
+    const ozz::string job(line.c_str() + first, last - first + 1);
+
+    const bool succeeded = BuildJob(job, base, &args) &&
+                           RunJob(_importer, args, &config);
+    failures += !succeeded;
+    ++jobs;
+    ozz::log::Flush();  // Job logs are output before its status.
+    std::cout << "Job " << jobs << (succeeded ? " succeeded." : " failed.")
+              << std::endl;
+  }
+
+  std::cout << "Completed " << jobs - failures << " of " << jobs << " jobs."
+            << std::endl;
+  if (failures != 0) {
+    std::cout << failures << " job(s) failed." << std::endl;
     return EXIT_FAILURE;
   }
+  return EXIT_SUCCESS;
+}
+}  // namespace
 
-  // Handles animations import processing
-  if (!ImportAnimations(config, this, endianness)) {
+int OzzImporter::operator()(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ParseArguments(_argc, _argv);
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  const AsyncLogScope async_log;
+
+  // Keeps the process alive to run jobs from standard input, so importer
+  // initialization and configuration processing are shared by all jobs.
+  if (std::strcmp(OPTIONS_file, "-") == 0) {
+    return RunJobs(this, _argc, _argv);
+  }
+
+  // Initialize general executable options.
+  InitializeLogLevel();
+  const ozz::Endianness endianness = InitializeEndianness();
+
+  Json::Value config;
+  if (!ProcessConfiguration(&config)) {
+    // Specific error message are reported during configuration processing.
     return EXIT_FAILURE;
   }
 
-  return EXIT_SUCCESS;
+  const bool imported = ImportInput(this, config, endianness);
+  return WriteProfile() && imported ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
 ozz::string OzzImporter::BuildFilename(const char* _filename,
@@ -29,32 +29,131 @@
 
 #include <json/json.h>
 
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <thread>
 
 #include "animation/offline/tools/import2ozz_config.h"
+#include "animation/offline/tools/import2ozz_profile.h"
 #include "animation/offline/tools/import2ozz_track.h"
+#include "animation/offline/tools/import2ozz_writer.h"
 #include "ozz/animation/offline/additive_animation_builder.h"
 #include "ozz/animation/offline/animation_builder.h"
 #include "ozz/animation/offline/animation_optimizer.h"
+#include "ozz/animation/offline/motion_extractor.h"
 #include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/raw_track.h"
 #include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/offline/track_builder.h"
+#include "ozz/animation/offline/track_optimizer.h"
 #include "ozz/animation/offline/tools/import2ozz.h"
 #include "ozz/animation/runtime/animation.h"
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/track.h"
 #include "ozz/base/io/archive.h"
+#include "ozz/base/containers/deque.h"
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/io/stream.h"
 #include "ozz/base/log.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/unique_ptr.h"
 #include "ozz/options/options.h"
 
+static bool ValidateJobs(const ozz::options::Option& _option,
+                         int /*_argc*/) {
+  const ozz::options::IntOption& option =
+      static_cast<const ozz::options::IntOption&>(_option);
+  const bool valid = option.value() >= 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid jobs option \"" << option << "\""
+                    << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_INT_FN(
+    jobs,
+    "Number of animations, or tracks, optimized, built and written "
+    "concurrently. Animations and tracks are still extracted one at a time "
+    "from the source file. 0 uses the number of hardware threads.",
+    1, false, &ValidateJobs)
+
+OZZ_OPTIONS_DECLARE_BOOL(
+    incremental,
+    "Skips animations whose source file, skeleton, configuration and tool "
+    "version didn't change since they were outputted. Source file external "
+    "resources aren't considered. A build stamp is written next to each "
+    "output file, with a \".stamp\" extension.",
+    false, false)
+
 namespace ozz {
 namespace animation {
 namespace offline {
 namespace {
 
+// Incremental builds stamps are 64 bits FNV-1a hashes of everything an
+// output file depends on.
+const uint64_t kFnvOffsetBasis = 0xcbf29ce484222325ull;
+const uint64_t kFnvPrime = 0x100000001b3ull;
+
+uint64_t Hash(const void* _data, size_t _size, uint64_t _hash) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(_data);
+  for (size_t i = 0; i < _size; ++i) {
+    _hash = (_hash ^ bytes[i]) * kFnvPrime;
+  }
+  return _hash;
+}
+
+bool HashFile(const char* _filename, uint64_t* _hash) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    return false;
+  }
+  char buffer[64 << 10];
+  for (size_t read = 0; (read = file.Read(buffer, sizeof(buffer))) != 0;) {
+    *_hash = Hash(buffer, read, *_hash);
+  }
+  return true;
+}
+
+// Computes the stamp of the animation _name output, according to its
+// configuration and the hash of the files it's built from.
+uint64_t AnimationStamp(uint64_t _files_hash, const char* _name,
+                        const Json::Value& _config,
+                        ozz::Endianness _endianness) {
+  // Output format versions are part of the stamp, so that updating the tool
+  // invalidates all outputs.
+  const int versions[] = {
+      ozz::io::internal::Version<const Animation>::kValue,
+      ozz::io::internal::Version<const RawAnimation>::kValue,
+      static_cast<int>(_endianness)};
+  uint64_t hash = Hash(versions, sizeof(versions), _files_hash);
+  hash = Hash(_name, std::strlen(_name) + 1, hash);
+
+  Json::StreamWriterBuilder builder;
+  builder["indentation"] = "";
+  const std::string config = Json::writeString(builder, _config);
+  return Hash(config.c_str(), config.size(), hash);
+}
+
+ozz::string StampFilename(const ozz::string& _output) {
+  return _output + ".stamp";
+}
+
+// An output is up to date if it exists and its stamp file matches _stamp.
+bool IsUpToDate(const ozz::string& _output, uint64_t _stamp) {
+  if (!ozz::io::File::Exist(_output.c_str())) {
+    return false;
+  }
+  ozz::io::File file(StampFilename(_output).c_str(), "rb");
+  uint64_t stamp;
+  return file.opened() && file.Read(&stamp, sizeof(stamp)) == sizeof(stamp) &&
+         stamp == _stamp;
+}
+
 void DisplaysOptimizationstatistics(const RawAnimation& _non_optimized,
                                     const RawAnimation& _optimized) {
   size_t opt_translations = 0, opt_rotations = 0, opt_scales = 0;
@@ -158,12 +257,98 @@ vector<math::Transform> SkeletonRestPoseSoAToAoS(const Skeleton& _skeleton) {
   return transforms;
 }
 
+// Extracts _animation root motion according to _config, and queues motion
+// tracks to _writer. _animation is baked in place if requested.
+bool ExportMotion(OzzImporter& _importer, const Skeleton& _skeleton,
+                  const Json::Value& _config, const ozz::Endianness _endianness,
+                  ArchiveWriter& _writer, RawAnimation* _animation) {
+  MotionExtractor extractor;
+  const char* joint_name = _config["joint_name"].asCString();
+  if (*joint_name != 0) {
+    extractor.root_joint = -1;
+    for (int i = 0; i < _skeleton.num_joints(); ++i) {
+      if (std::strcmp(_skeleton.joint_names()[i], joint_name) == 0) {
+        extractor.root_joint = i;
+        break;
+      }
+    }
+    if (extractor.root_joint == -1) {
+      ozz::log::Err() << "No joint found for motion extraction joint \""
+                      << joint_name << "\"." << std::endl;
+      return false;
+    }
+  }
+  const char* position = _config["position"].asCString();
+  extractor.position_x = std::strchr(position, 'x') != nullptr;
+  extractor.position_y = std::strchr(position, 'y') != nullptr;
+  extractor.position_z = std::strchr(position, 'z') != nullptr;
+  extractor.heading = _config["heading"].asBool();
+  extractor.bake = _config["bake"].asBool();
+
+  ozz::log::Log() << "Extracts root motion." << std::endl;
+  RawFloat3Track raw_position;
+  RawQuaternionTrack raw_rotation;
+  if (!extractor(*_animation, &raw_position, &raw_rotation, _animation)) {
+    ozz::log::Err() << "Failed to extract root motion." << std::endl;
+    return false;
+  }
+
+  if (_config["optimize"].asBool()) {
+    TrackOptimizer optimizer;
+    optimizer.tolerance = _config["optimization_tolerance"].asFloat();
+    RawFloat3Track optimized_position;
+    RawQuaternionTrack optimized_rotation;
+    if (!optimizer(raw_position, &optimized_position) ||
+        !optimizer(raw_rotation, &optimized_rotation)) {
+      ozz::log::Err() << "Failed to optimize motion tracks." << std::endl;
+      return false;
+    }
+    raw_position = std::move(optimized_position);
+    raw_rotation = std::move(optimized_rotation);
+  }
+
+  TrackBuilder builder;
+  const unique_ptr<Float3Track> position_track = builder(raw_position);
+  const unique_ptr<QuaternionTrack> rotation_track = builder(raw_rotation);
+  if (!position_track || !rotation_track) {
+    ozz::log::Err() << "Failed to build motion tracks." << std::endl;
+    return false;
+  }
+
+  unique_ptr<ozz::io::MemoryStream> stream =
+      make_unique<ozz::io::MemoryStream>();
+  {
+    ozz::io::OArchive archive(stream.get(), _endianness);
+    archive << *position_track;
+    archive << *rotation_track;
+  }
+  _writer.Push(_importer.BuildFilename(_config["filename"].asCString(),
+                                       _animation->name.c_str()),
+               std::move(stream));
+  return true;
+}
+
+// Optimizes, builds and serializes _input_animation, then queues it to
+// _writer. Once written, *_succeeded is incremented, and _stamp is written
+// to _stamped_output stamp file if _stamped_output isn't empty. Stages are
+// timed to _profile, unless it's nullptr.
 bool Export(OzzImporter& _importer, const RawAnimation& _input_animation,
             const Skeleton& _skeleton, const Json::Value& _config,
-            const ozz::Endianness _endianness) {
+            const ozz::Endianness _endianness, ArchiveWriter& _writer,
+            const ozz::string& _stamped_output, uint64_t _stamp,
+            size_t* _succeeded, ClipProfile* _profile) {
   // Raw animation to build and output. Initial setup is just a copy.
   RawAnimation raw_animation = _input_animation;
 
+  // Extracts root motion first, so that optimization applies to the baked
+  // animation.
+  const Json::Value& motion_config = _config["motion"];
+  if (motion_config["enable"].asBool() &&
+      !ExportMotion(_importer, _skeleton, motion_config, _endianness, _writer,
+                    &raw_animation)) {
+    return false;
+  }
+
   // Optimizes animation if option is enabled.
   // Must be done before converting to additive, to be sure hierarchy length is
   // valid when optimizing.
@@ -175,6 +360,15 @@ bool Export(OzzImporter& _importer, const RawAnimation& _input_animation,
     const Json::Value& tolerances = _config["optimization_settings"];
     optimizer.setting.tolerance = tolerances["tolerance"].asFloat();
     optimizer.setting.distance = tolerances["distance"].asFloat();
+    optimizer.cubic_interpolation = _config["cubic_interpolation"].asBool();
+    ReductionEnum::Value reduction;
+    const bool reduction_found =
+        Reduction::GetEnumFromName(_config["reduction"].asCString(), &reduction);
+    assert(reduction_found);  // Already checked on config side.
+    if (reduction_found) {
+      optimizer.reduction =
+          static_cast<AnimationOptimizer::Reduction>(reduction);
+    }
 
     // Builds per joint settings.
     const Json::Value& joints_config = tolerances["override"];
@@ -218,7 +412,12 @@ bool Export(OzzImporter& _importer, const RawAnimation& _input_animation,
     }
 
     RawAnimation raw_optimized_animation;
-    if (!optimizer(raw_animation, _skeleton, &raw_optimized_animation)) {
+    bool optimized;
+    {
+      ProfileScope profile(_profile, kProfileOptimization);
+      optimized = optimizer(raw_animation, _skeleton, &raw_optimized_animation);
+    }
+    if (!optimized) {
       ozz::log::Err() << "Failed to optimize animation." << std::endl;
       return false;
     }
@@ -236,6 +435,7 @@ bool Export(OzzImporter& _importer, const RawAnimation& _input_animation,
   // Make delta animation if requested.
   if (_config["additive"].asBool()) {
     ozz::log::Log() << "Makes additive animation." << std::endl;
+    ProfileScope profile(_profile, kProfileAdditive);
 
     AdditiveAnimationBuilder additive_builder;
     RawAnimation raw_additive;
@@ -264,11 +464,29 @@ bool Export(OzzImporter& _importer, const RawAnimation& _input_animation,
     raw_animation = raw_additive;
   }
 
+  if (_profile) {
+    _profile->keys_out = CountKeys(raw_animation);
+  }
+
   // Builds runtime animation.
   unique_ptr<Animation> animation;
   if (!_config["raw"].asBool()) {
     ozz::log::Log() << "Builds runtime animation." << std::endl;
+    ProfileScope profile(_profile, kProfileBuilding);
     AnimationBuilder builder;
+    builder.seek_interval = _config["seek_interval"].asFloat();
+    builder.bidirectional = _config["bidirectional"].asBool();
+    builder.random_access = _config["random_access"].asBool();
+    builder.cubic_interpolation = _config["cubic_interpolation"].asBool();
+    builder.compact_ratios = _config["compact_ratios"].asBool();
+    RotationFormatEnum::Value rotation_format;
+    bool enum_found = RotationFormat::GetEnumFromName(
+        _config["rotation_format"].asCString(), &rotation_format);
+    assert(enum_found);  // Already checked on config side.
+    if (enum_found) {
+      builder.rotation_format =
+          static_cast<AnimationBuilder::RotationFormat>(rotation_format);
+    }
     animation = builder(raw_animation);
     if (!animation) {
       ozz::log::Err() << "Failed to build runtime animation." << std::endl;
@@ -277,62 +495,213 @@ bool Export(OzzImporter& _importer, const RawAnimation& _input_animation,
   }
 
   {
-    // Prepares output stream. File is a RAII so it will close automatically
-    // at the end of this scope. Once the file is opened, nothing should fail
-    // as it would leave an invalid file on the disk.
+    // Serializes to memory, so that the file is written by the writer thread
+    // while the next animation is processed. Profile serialization stage
+    // hence doesn't include disk write.
+    ProfileScope profile(_profile, kProfileSerialization);
 
     // Builds output filename.
-    ozz::string filename = _importer.BuildFilename(
+    const ozz::string filename = _importer.BuildFilename(
         _config["filename"].asCString(), raw_animation.name.c_str());
 
-    ozz::log::LogV() << "Opens output file: \"" << filename << "\""
-                     << std::endl;
-    ozz::io::File file(filename.c_str(), "wb");
-    if (!file.opened()) {
-      ozz::log::Err() << "Failed to open output file: \"" << filename << "\""
-                      << std::endl;
-      return false;
+    // Initializes output archive, and fills it with the animation.
+    unique_ptr<ozz::io::MemoryStream> stream =
+        make_unique<ozz::io::MemoryStream>();
+    {
+      ozz::io::OArchive archive(stream.get(), _endianness);
+      if (_config["raw"].asBool()) {
+        ozz::log::Log() << "Outputs RawAnimation to binary archive."
+                        << std::endl;
+        archive << raw_animation;
+      } else {
+        ozz::log::Log() << "Outputs Animation to binary archive." << std::endl;
+        archive << *animation;
+      }
     }
 
-    // Initializes output archive.
-    ozz::io::OArchive archive(&file, _endianness);
-
-    // Fills output archive with the animation.
-    if (_config["raw"].asBool()) {
-      ozz::log::Log() << "Outputs RawAnimation to binary archive." << std::endl;
-      archive << raw_animation;
-    } else {
-      ozz::log::Log() << "Outputs Animation to binary archive." << std::endl;
-      archive << *animation;
+    if (_profile) {
+      _profile->bytes = static_cast<size_t>(stream->Size());
     }
+
+    _writer.Push(filename, std::move(stream), _succeeded,
+                 _stamped_output.empty() ? ozz::string()
+                                         : StampFilename(_stamped_output),
+                 _stamp);
   }
 
-  ozz::log::LogV() << "Animation binary archive successfully outputted."
+  ozz::log::LogV() << "Animation binary archive successfully serialized."
                    << std::endl;
 
   return true;
 }  // namespace
 
-bool ProcessAnimation(OzzImporter& _importer, const char* _animation_name,
+bool ExtractAnimation(OzzImporter& _importer, const char* _animation_name,
                       const Skeleton& _skeleton, const Json::Value& _config,
-                      const ozz::Endianness _endianness) {
-  RawAnimation animation;
-
+                      RawAnimation* _animation, ClipProfile* _profile) {
   ozz::log::Log() << "Extracting animation \"" << _animation_name << "\""
                   << std::endl;
 
-  if (!_importer.Import(_animation_name, _skeleton,
-                        _config["sampling_rate"].asFloat(), &animation)) {
+  bool imported;
+  {
+    ProfileScope profile(_profile, kProfileExtraction);
+    imported = _importer.Import(_animation_name, _skeleton,
+                                _config["sampling_rate"].asFloat(), _animation);
+  }
+  if (!imported) {
     ozz::log::Err() << "Failed to import animation \"" << _animation_name
                     << "\"" << std::endl;
     return false;
-  } else {
-    // Give animation a name
-    animation.name = _animation_name;
+  }
 
-    return Export(_importer, animation, _skeleton, _config, _endianness);
+  if (_profile) {
+    _profile->keys_in = CountKeys(*_animation);
   }
+
+  // Give animation a name
+  _animation->name = _animation_name;
+  return true;
 }
+
+// Optimizes, builds and serializes extracted animations, which are then
+// written by _writer thread. Extraction relies on the importer SDK, so it
+// remains serial and is done by the caller thread, which pushes extracted
+// animations to a queue consumed by _jobs worker threads.
+// Queue is bounded to the number of workers, so that no more than twice as
+// many raw animations as workers are kept in memory.
+// With a single job, animations are exported immediately by the caller
+// thread.
+class ExportPipeline {
+ public:
+  ExportPipeline(OzzImporter& _importer, const Skeleton& _skeleton,
+                 ozz::Endianness _endianness, ArchiveWriter& _writer,
+                 int _jobs)
+      : importer_(_importer),
+        skeleton_(_skeleton),
+        endianness_(_endianness),
+        writer_(_writer),
+        capacity_(static_cast<size_t>(_jobs)),
+        closed_(false) {
+    if (_jobs > 1) {
+      ozz::log::LogV() << "Exports animations with " << _jobs << " jobs."
+                       << std::endl;
+      workers_.reserve(_jobs);
+      for (int i = 0; i < _jobs; ++i) {
+        workers_.emplace_back(&ExportPipeline::Work, this);
+      }
+    }
+  }
+
+  ~ExportPipeline() { Finish(); }
+
+  // Exports _animation, or queues it if pipeline has workers. _succeeded
+  // counter is incremented once the animation is written, and can only be
+  // read once Finish() and the writer Flush() returned. If _stamped_output
+  // isn't empty, _stamp is written to its stamp file once written. If
+  // _profile isn't nullptr, export stages are profiled to a copy of it, which
+  // is then added to the report.
+  void Push(RawAnimation&& _animation, const Json::Value& _config,
+            const ozz::string& _stamped_output, uint64_t _stamp,
+            size_t* _succeeded, const ClipProfile* _profile) {
+    if (workers_.empty()) {
+      ClipProfile profile;
+      if (_profile) {
+        profile = *_profile;
+      }
+      const bool exported = Export(importer_, _animation, skeleton_, _config,
+                                   endianness_, writer_, _stamped_output,
+                                   _stamp, _succeeded,
+                                   _profile ? &profile : nullptr);
+      if (_profile) {
+        profile.succeeded = exported;
+        AddClipProfile(profile);
+      }
+      return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    not_full_.wait(lock, [this] { return queue_.size() < capacity_; });
+    queue_.emplace_back();
+    Task& task = queue_.back();
+    task.animation = std::move(_animation);
+    task.config = &_config;
+    task.stamped_output = _stamped_output;
+    task.stamp = _stamp;
+    task.succeeded = _succeeded;
+    task.profiled = _profile != nullptr;
+    if (_profile) {
+      task.profile = *_profile;
+    }
+    not_empty_.notify_one();
+  }
+
+  // Waits for all queued animations to be exported.
+  void Finish() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+    }
+    not_empty_.notify_all();
+    for (size_t i = 0; i < workers_.size(); ++i) {
+      workers_[i].join();
+    }
+    workers_.clear();
+  }
+
+ private:
+  struct Task {
+    RawAnimation animation;
+    const Json::Value* config;
+    ozz::string stamped_output;
+    uint64_t stamp;
+    size_t* succeeded;
+    bool profiled;
+    ClipProfile profile;
+  };
+
+  void Work() {
+    for (;;) {
+      Task task;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+        if (queue_.empty()) {
+          return;  // Closed and nothing left to export.
+        }
+        task.animation = std::move(queue_.front().animation);
+        task.config = queue_.front().config;
+        task.stamped_output = queue_.front().stamped_output;
+        task.stamp = queue_.front().stamp;
+        task.succeeded = queue_.front().succeeded;
+        task.profiled = queue_.front().profiled;
+        task.profile = queue_.front().profile;
+        queue_.pop_front();
+      }
+      not_full_.notify_one();
+
+      const bool exported =
+          Export(importer_, task.animation, skeleton_, *task.config,
+                 endianness_, writer_, task.stamped_output, task.stamp,
+                 task.succeeded, task.profiled ? &task.profile : nullptr);
+      if (task.profiled) {
+        task.profile.succeeded = exported;
+        AddClipProfile(task.profile);
+      }
+    }
+  }
+
+  OzzImporter& importer_;
+  const Skeleton& skeleton_;
+  const ozz::Endianness endianness_;
+  ArchiveWriter& writer_;
+  const size_t capacity_;
+
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  ozz::deque<Task> queue_;
+  bool closed_;
+
+  ozz::vector<std::thread> workers_;
+};
 }  // namespace
 
 AdditiveReference::EnumNames AdditiveReference::GetNames() {
@@ -341,8 +710,20 @@ AdditiveReference::EnumNames AdditiveReference::GetNames() {
   return enum_names;
 }
 
+RotationFormat::EnumNames RotationFormat::GetNames() {
+  static const char* kNames[] = {"default", "compact48", "compact32"};
+  const EnumNames enum_names = {OZZ_ARRAY_SIZE(kNames), kNames};
+  return enum_names;
+}
+
+Reduction::EnumNames Reduction::GetNames() {
+  static const char* kNames[] = {"decimation", "fitting"};
+  const EnumNames enum_names = {OZZ_ARRAY_SIZE(kNames), kNames};
+  return enum_names;
+}
+
 bool ImportAnimations(const Json::Value& _config, OzzImporter* _importer,
-                      const ozz::Endianness _endianness) {
+                      const ozz::Endianness _endianness, const char* _source) {
   const Json::Value& skeleton_config = _config["skeleton"];
   const Json::Value& animations_config = _config["animations"];
 
@@ -374,6 +755,37 @@ bool ImportAnimations(const Json::Value& _config, OzzImporter* _importer,
   if (!success)
     return false;
 
+  // Incremental builds hash source and skeleton files once, all animations
+  // stamps derive from it.
+  bool incremental = OPTIONS_incremental;
+  uint64_t files_hash = kFnvOffsetBasis;
+  if (incremental &&
+      (!HashFile(_source, &files_hash) ||
+       !HashFile(skeleton_config["filename"].asCString(), &files_hash))) {
+    ozz::log::Log() << "Failed to hash source files, incremental build is "
+                       "disabled."
+                    << std::endl;
+    incremental = false;
+  }
+
+  // Number of concurrent export jobs.
+  int jobs = OPTIONS_jobs;
+  if (jobs == 0) {
+    jobs = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  jobs = jobs < 1 ? 1 : jobs;
+
+  // Number of successfully exported animations, per animation configuration.
+  // Counters are updated by the writer, and only valid once it's flushed.
+  ozz::vector<size_t> num_valid_animations(animations_config.size(), 0);
+  ozz::vector<size_t> num_clip_animations(animations_config.size(), 0);
+
+  // Files are written by a background thread, overlapping disk writes with
+  // the next animations processing. Each job can have a serialized archive
+  // being written and another one pending.
+  ArchiveWriter writer(static_cast<size_t>(jobs) * 2);
+  ExportPipeline pipeline(*_importer, *skeleton, _endianness, writer, jobs);
+
   // Loop though all existing animations, and export those who match
   // configuration.
   for (Json::ArrayIndex i = 0; i < animations_config.size(); ++i) {
@@ -387,24 +799,53 @@ bool ImportAnimations(const Json::Value& _config, OzzImporter* _importer,
       continue;
     }
 
-    size_t num_not_clip_animation = 0, num_valid_animation = 0;
     for (size_t j = 0; j < import_animation_names.size(); ++j) {
       const char* animation_name = import_animation_names[j].c_str();
       if (!strmatch(animation_name, clip_match)) {
         continue;
       }
-      ++num_not_clip_animation;
-      const bool anisuccess = ProcessAnimation(*_importer, animation_name, *skeleton,
-                                animation_config, _endianness);
-      if(anisuccess){
-        ++num_valid_animation;
+      ++num_clip_animations[i];
+
+      // Skips extraction and export of up to date animations.
+      ozz::string stamped_output;
+      uint64_t stamp = 0;
+      if (incremental) {
+        stamped_output = _importer->BuildFilename(
+            animation_config["filename"].asCString(), animation_name);
+        stamp = AnimationStamp(files_hash, animation_name, animation_config,
+                               _endianness);
+      }
+      if (incremental && IsUpToDate(stamped_output, stamp)) {
+        ozz::log::Log() << "Animation \"" << animation_name
+                        << "\" is up to date." << std::endl;
+        ++num_valid_animations[i];
+      } else {
+        // Profile is completed by the pipeline, or reported here if
+        // extraction fails.
+        ClipProfile profile;
+        ClipProfile* clip_profile = IsProfiling() ? &profile : nullptr;
+        if (clip_profile) {
+          profile.source = _source;
+          profile.name = animation_name;
+        }
+        RawAnimation animation;
+        if (ExtractAnimation(*_importer, animation_name, *skeleton,
+                             animation_config, &animation, clip_profile)) {
+          pipeline.Push(std::move(animation), animation_config,
+                        stamped_output, stamp, &num_valid_animations[i],
+                        clip_profile);
+        } else if (clip_profile) {
+          AddClipProfile(profile);
+        }
       }
 
+      // Tracks are imported from the SDK too, so they're extracted serially
+      // and then exported concurrently.
       size_t num_valid_track = 0;
       const Json::Value& tracks_config = animation_config["tracks"];
       for (Json::ArrayIndex t = 0; t < tracks_config.size(); ++t) {
         if (ProcessTracks(*_importer, animation_name, *skeleton,
-                                tracks_config[t], _endianness)){
+                                tracks_config[t], _endianness, writer, jobs)){
           ++num_valid_track;
         }
       }
@@ -416,12 +857,19 @@ bool ImportAnimations(const Json::Value& _config, OzzImporter* _importer,
       }
     }
     // Don't display any message if no animation is supposed to be imported.
-    if (0 == num_not_clip_animation && *clip_match != 0) {
+    if (0 == num_clip_animations[i] && *clip_match != 0) {
       ozz::log::Log() << "No matching animation found for \"" << clip_match
                       << "\"." << std::endl;
     }
+  }
+
+  // Waits for all animations to be exported and written before checking
+  // results.
+  pipeline.Finish();
+  success &= writer.Flush();
 
-    if (num_valid_animation != num_not_clip_animation){
+  for (Json::ArrayIndex i = 0; i < animations_config.size(); ++i) {
+    if (num_valid_animations[i] != num_clip_animations[i]){
       ozz::log::Log() << "One of animation failed when import, animation index: \"" << i
                       << "\"" << std::endl;
       success = false;
@@ -44,9 +44,14 @@ namespace animation {
 namespace offline {
 
 class OzzImporter;
+
+// Imports, optimizes, builds and outputs animations matching _config.
+// _source is the file animations are imported from, which is hashed by
+// incremental builds.
 OZZ_ANIMTOOLS_DLL bool ImportAnimations(const Json::Value& _config,
                                         OzzImporter* _importer,
-                      const ozz::Endianness _endianness);
+                                        const ozz::Endianness _endianness,
+                                        const char* _source);
 
 // Additive reference enum to config string conversions.
 struct AdditiveReferenceEnum {
@@ -56,6 +61,25 @@ struct OZZ_ANIMTOOLS_DLL AdditiveReference
     : JsonEnum<AdditiveReference, AdditiveReferenceEnum::Value> {
   static EnumNames GetNames();
 };
+
+// Rotation keys format enum to config string conversions. Values match
+// AnimationBuilder::RotationFormat.
+struct RotationFormatEnum {
+  enum Value { kDefault, kCompact48, kCompact32 };
+};
+struct OZZ_ANIMTOOLS_DLL RotationFormat
+    : JsonEnum<RotationFormat, RotationFormatEnum::Value> {
+  static EnumNames GetNames();
+};
+
+// Keyframes reduction algorithm enum to config string conversions. Values
+// match AnimationOptimizer::Reduction.
+struct ReductionEnum {
+  enum Value { kDecimation, kFitting };
+};
+struct OZZ_ANIMTOOLS_DLL Reduction : JsonEnum<Reduction, ReductionEnum::Value> {
+  static EnumNames GetNames();
+};
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
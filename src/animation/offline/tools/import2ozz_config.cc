@@ -36,6 +36,7 @@
 #include "animation/offline/tools/import2ozz_anim.h"
 #include "animation/offline/tools/import2ozz_track.h"
 #include "ozz/animation/offline/animation_optimizer.h"
+#include "ozz/animation/offline/motion_extractor.h"
 #include "ozz/animation/offline/tools/import2ozz.h"
 #include "ozz/animation/offline/track_optimizer.h"
 #include "ozz/base/containers/string.h"
@@ -344,6 +345,42 @@ bool SanitizeTrack(Json::Value& _root, bool _all_options) {
   return true;
 }
 
+bool SanitizeMotion(Json::Value& _root) {
+  const MotionExtractor default_extractor;
+  MakeDefault(_root, "enable", false,
+              "Extracts root motion to dedicated position and rotation "
+              "tracks, which can be sampled without the animation.");
+  MakeDefault(_root, "joint_name", "",
+              "Name of the joint whose motion is extracted, usually the root "
+              "or hips. Empty uses the first joint.");
+  MakeDefault(_root, "filename", "*_motion.ozz",
+              "Specifies motion tracks output filename. Use a \'*\' character "
+              "to specify part(s) of the filename that should be replaced by "
+              "the clip name. The file contains position and then rotation "
+              "track.");
+  MakeDefault(_root, "position", "xz",
+              "Translation components extracted to motion position, among "
+              "\"x\", \"y\" and \"z\".");
+  MakeDefault(_root, "heading", default_extractor.heading,
+              "Extracts rotation around up (y) axis to motion rotation.");
+  MakeDefault(_root, "bake", default_extractor.bake,
+              "Removes extracted motion from the animation, which then plays "
+              "in place.");
+  MakeDefault(_root, "optimize", true,
+              "Activates motion keyframes optimization.");
+  MakeDefault(_root, "optimization_tolerance", TrackOptimizer().tolerance,
+              "Motion tracks optimization tolerance");
+
+  const char* position = _root["position"].asCString();
+  if (position[std::strspn(position, "xyz")] != 0) {
+    ozz::log::Err() << "Invalid motion position components \"" << position
+                    << "\". Can only contain \"x\", \"y\" and \"z\"."
+                    << std::endl;
+    return false;
+  }
+  return true;
+}
+
 bool SanitizeAnimation(Json::Value& _root, bool _all_options) {
   MakeDefault(_root, "clip", "*",
               "Specifies clip name (take) of the animation to import from the "
@@ -382,8 +419,61 @@ bool SanitizeAnimation(Json::Value& _root, bool _all_options) {
   MakeDefault(_root, "optimize", true,
               "Activates keyframes reduction optimization.");
 
+  MakeDefault(_root, "reduction", "decimation",
+              "Selects keyframes reduction algorithm. Can be \"decimation\" "
+              "(selects keys among imported ones) or \"fitting\" "
+              "(least-squares fitting, which also moves keys values and keeps "
+              "less keys for noisy data such as motion capture).");
+
+  if (!Reduction::IsValidEnumName(_root["reduction"].asCString())) {
+    ozz::log::Err() << "Invalid keyframes reduction algorithm \""
+                    << _root["reduction"].asCString() << "\". \""
+                    << "Can be \"decimation\" or \"fitting\"." << std::endl;
+    return false;
+  }
+
+  MakeDefault(_root, "seek_interval", 0.f,
+              "Interval (in seconds) between runtime animation seek points, "
+              "which speed up backward and far forward sampling. Set a value "
+              "<= 0 to disable seek points.");
+
+  MakeDefault(_root, "bidirectional", false,
+              "Builds runtime animation previous keys offsets, which make "
+              "backward sampling as efficient as forward.");
+
+  MakeDefault(_root, "random_access", false,
+              "Builds runtime animation per track keys indices, which allow "
+              "sampling any time without a sampling context.");
+
+  MakeDefault(_root, "cubic_interpolation", false,
+              "Interpolates runtime animation translations and scales with "
+              "cubic curves, which allows optimization to remove more keys.");
+
+  MakeDefault(_root, "compact_ratios", false,
+              "Quantizes runtime animation translation and scale keys times "
+              "to 16 bits, shrinking keys from 12 to 8 bytes.");
+
+  MakeDefault(_root, "rotation_format", "default",
+              "Selects runtime animation rotation keys format. Can be "
+              "\"default\" (12 bytes per key), \"compact48\" (10 bytes per "
+              "key) or \"compact32\" (8 bytes per key, lower precision). "
+              "Compact formats quantize key times to 16 bits.");
+
+  if (!RotationFormat::IsValidEnumName(_root["rotation_format"].asCString())) {
+    ozz::log::Err() << "Invalid rotation format \""
+                    << _root["rotation_format"].asCString() << "\". \""
+                    << "Can be \"default\", \"compact48\" or \"compact32\"."
+                    << std::endl;
+    return false;
+  }
+
   SanitizeOptimizationSettings(_root["optimization_settings"], _all_options);
 
+  MakeDefaultObject(_root, "motion", "Root motion extraction settings.");
+  if (!SanitizeMotion(_root["motion"])) {
+    return false;
+  }
+
   MakeDefaultArray(_root, "tracks", "Tracks to build.", !_all_options);
   Json::Value& tracks = _root["tracks"];
   for (Json::ArrayIndex i = 0; i < tracks.size(); ++i) {
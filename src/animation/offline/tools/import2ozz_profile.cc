@@ -0,0 +1,242 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "animation/offline/tools/import2ozz_profile.h"
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif  // WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif  // NOMINMAX
+#include <windows.h>
+#endif  // _WIN32
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <mutex>
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/options/options.h"
+
+OZZ_OPTIONS_DECLARE_STRING(
+    profile,
+    "Outputs animations build profile to the specified file: per stage wall "
+    "and cpu times, keyframes count and output size of each clip. File is "
+    "written as json if its extension is \".json\", csv otherwise.",
+    "", false)
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+
+const char* kStageNames[kNumProfileStages] = {
+    "extraction", "optimization", "additive", "building", "serialization"};
+
+double WallTime() {
+  return std::chrono::duration<double>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+// Cpu time of the calling thread, as stages of different clips run
+// concurrently with --jobs option.
+double ThreadCpuTime() {
+#if defined(_WIN32)
+  FILETIME creation, exit, kernel, user;
+  if (!GetThreadTimes(GetCurrentThread(), &creation, &exit, &kernel, &user)) {
+    return 0.;
+  }
+  const ULONGLONG ticks =
+      ((static_cast<ULONGLONG>(kernel.dwHighDateTime) << 32) |
+       kernel.dwLowDateTime) +
+      ((static_cast<ULONGLONG>(user.dwHighDateTime) << 32) |
+       user.dwLowDateTime);
+  return ticks * 1e-7;  // 100 nanoseconds ticks.
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+  timespec time;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time) != 0) {
+    return 0.;
+  }
+  return time.tv_sec + time.tv_nsec * 1e-9;
+#else
+  // Falls back to process time.
+  return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+// Clip profiles are pushed by export threads.
+std::mutex& ProfilesMutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+ozz::vector<ClipProfile>& Profiles() {
+  static ozz::vector<ClipProfile> profiles;
+  return profiles;
+}
+
+// Escapes a string for the json or csv report.
+ozz::string Escape(const ozz::string& _string, bool _json) {
+  ozz::string escaped;
+  for (const char c : _string) {
+    if (c == '"') {
+      escaped += _json ? "\\\"" : "\"\"";
+    } else if (_json && c == '\\') {
+      escaped += "\\\\";
+    } else if (static_cast<unsigned char>(c) >= 0x20) {
+      escaped += c;
+    }
+  }
+  return escaped;
+}
+}  // namespace
+
+ClipProfile::ClipProfile()
+    : succeeded(false), keys_in(0), keys_out(0), bytes(0) {
+  for (int i = 0; i < kNumProfileStages; ++i) {
+    wall[i] = cpu[i] = 0.;
+  }
+}
+
+ProfileScope::ProfileScope(ClipProfile* _profile, ProfileStage _stage)
+    : profile_(_profile), stage_(_stage), wall_begin_(0.), cpu_begin_(0.) {
+  if (profile_) {
+    wall_begin_ = WallTime();
+    cpu_begin_ = ThreadCpuTime();
+  }
+}
+
+ProfileScope::~ProfileScope() {
+  if (profile_) {
+    profile_->wall[stage_] += WallTime() - wall_begin_;
+    profile_->cpu[stage_] += ThreadCpuTime() - cpu_begin_;
+  }
+}
+
+bool IsProfiling() { return OPTIONS_profile.value()[0] != 0; }
+
+size_t CountKeys(const RawAnimation& _animation) {
+  size_t keys = 0;
+  for (const RawAnimation::JointTrack& track : _animation.tracks) {
+    keys += track.translations.size() + track.rotations.size() +
+            track.scales.size();
+  }
+  return keys;
+}
+
+void AddClipProfile(const ClipProfile& _profile) {
+  std::lock_guard<std::mutex> lock(ProfilesMutex());
+  Profiles().push_back(_profile);
+}
+
+void ClearProfiles() {
+  std::lock_guard<std::mutex> lock(ProfilesMutex());
+  Profiles().clear();
+}
+
+bool WriteProfile() {
+  if (!IsProfiling()) {
+    return true;
+  }
+  const char* filename = OPTIONS_profile;
+  const size_t length = std::strlen(filename);
+  const bool json =
+      length >= 5 && std::strcmp(filename + length - 5, ".json") == 0;
+
+  std::lock_guard<std::mutex> lock(ProfilesMutex());
+  const ozz::vector<ClipProfile>& profiles = Profiles();
+
+  ozz::string content;
+  if (json) {
+    content = "[\n";
+  } else {
+    content = "source,name,succeeded,keys_in,keys_out,bytes";
+    for (const char* stage : kStageNames) {
+      content += ',';
+      content += stage;
+      content += "_wall,";
+      content += stage;
+      content += "_cpu";
+    }
+    content += '\n';
+  }
+
+  char buffer[256];
+  for (size_t i = 0; i < profiles.size(); ++i) {
+    const ClipProfile& profile = profiles[i];
+    std::snprintf(
+        buffer, sizeof(buffer),
+        json ? "\", \"succeeded\": %s, \"keys_in\": %zu, \"keys_out\": %zu, "
+               "\"bytes\": %zu"
+             : "\",%s,%zu,%zu,%zu",
+        profile.succeeded ? "true" : "false", profile.keys_in,
+        profile.keys_out, profile.bytes);
+    content += json ? "  {\"source\": \"" : "\"";
+    content += Escape(profile.source, json);
+    content += json ? "\", \"name\": \"" : "\",\"";
+    content += Escape(profile.name, json);
+    content += buffer;
+    for (int s = 0; s < kNumProfileStages; ++s) {
+      if (json) {
+        std::snprintf(buffer, sizeof(buffer),
+                      ", \"%s_wall\": %g, \"%s_cpu\": %g", kStageNames[s],
+                      profile.wall[s], kStageNames[s], profile.cpu[s]);
+      } else {
+        std::snprintf(buffer, sizeof(buffer), ",%g,%g", profile.wall[s],
+                      profile.cpu[s]);
+      }
+      content += buffer;
+    }
+    content += json ? (i + 1 < profiles.size() ? "},\n" : "}\n") : "\n";
+  }
+  if (json) {
+    content += "]\n";
+  }
+
+  ozz::io::File file(filename, "wb");
+  if (!file.opened() ||
+      file.Write(content.c_str(), content.size()) != content.size()) {
+    ozz::log::Err() << "Failed to write profile file \"" << filename << "\"."
+                    << std::endl;
+    return false;
+  }
+  ozz::log::Log() << "Profile of " << profiles.size()
+                  << " animation(s) written to \"" << filename << "\"."
+                  << std::endl;
+  return true;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
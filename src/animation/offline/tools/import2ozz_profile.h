@@ -0,0 +1,104 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_ANIMATION_OFFLINE_TOOLS_IMPORT2OZZ_PROFILE_H_
+#define OZZ_ANIMATION_OFFLINE_TOOLS_IMPORT2OZZ_PROFILE_H_
+
+#include <cstddef>
+
+#include "ozz/animation/offline/tools/export.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+struct RawAnimation;
+
+// Animation build stages reported by the --profile option. Resampling is
+// done by importers while extracting, so it's part of extraction stage.
+enum ProfileStage {
+  kProfileExtraction,
+  kProfileOptimization,
+  kProfileAdditive,
+  kProfileBuilding,
+  kProfileSerialization,
+  kNumProfileStages
+};
+
+// Build profile of a single animation clip. Times are in seconds, cpu time
+// being the time spent by the thread that processed the stage.
+struct ClipProfile {
+  ClipProfile();
+
+  ozz::string source;  // File the clip is imported from.
+  ozz::string name;    // Clip name.
+  bool succeeded;
+  double wall[kNumProfileStages];
+  double cpu[kNumProfileStages];
+  size_t keys_in;   // Keyframes count once extracted.
+  size_t keys_out;  // Keyframes count once optimized.
+  size_t bytes;     // Size of the output file.
+};
+
+// Times a stage of a clip profile, from construction to destruction. Nothing
+// is done if the profile is nullptr, aka profiling is disabled.
+class ProfileScope {
+ public:
+  ProfileScope(ClipProfile* _profile, ProfileStage _stage);
+  ~ProfileScope();
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+ private:
+  ClipProfile* profile_;
+  ProfileStage stage_;
+  double wall_begin_;
+  double cpu_begin_;
+};
+
+// Returns true if --profile option is set.
+OZZ_ANIMTOOLS_DLL bool IsProfiling();
+
+// Counts the keyframes of all _animation tracks.
+OZZ_ANIMTOOLS_DLL size_t CountKeys(const RawAnimation& _animation);
+
+// Adds _profile to the report. Can be called concurrently.
+OZZ_ANIMTOOLS_DLL void AddClipProfile(const ClipProfile& _profile);
+
+// Writes all clip profiles to --profile file, as json if its extension is
+// ".json", or csv otherwise. Returns true if profiling is disabled.
+OZZ_ANIMTOOLS_DLL bool WriteProfile();
+
+// Clears all clip profiles, so the next report starts from scratch.
+OZZ_ANIMTOOLS_DLL void ClearProfiles();
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_ANIMATION_OFFLINE_TOOLS_IMPORT2OZZ_PROFILE_H_
@@ -29,10 +29,14 @@
 
 #include <json/json.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
+#include <thread>
 
 #include "animation/offline/tools/import2ozz_config.h"
+#include "animation/offline/tools/import2ozz_writer.h"
 #include "ozz/animation/offline/raw_track.h"
 #include "ozz/animation/offline/tools/import2ozz.h"
 #include "ozz/animation/offline/track_builder.h"
@@ -41,6 +45,7 @@
 #include "ozz/animation/runtime/track.h"
 #include "ozz/base/io/archive.h"
 #include "ozz/base/io/stream.h"
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/log.h"
 #include "ozz/base/memory/unique_ptr.h"
 #include "ozz/options/options.h"
@@ -61,7 +66,29 @@ void DisplaysOptimizationstatistics(const _Track& _non_optimized,
 
   ozz::log::LogV log;
   ozz::log::FloatPrecision precision_scope(log, 1);
-  log << "Optimization stage results: " << ratio << ":1" << std::endl;
+  log << "Optimization stage results for track \"" << _optimized.name
+      << "\": " << ratio << ":1" << std::endl;
+}
+
+// TrackOptimizer::ParallelFor implementation, which runs tasks on as many
+// threads as *_user_data int, the calling thread included.
+void ThreadParallelFor(int _count, TrackOptimizer::ParallelForTask _task,
+                       void* _task_data, void* _user_data) {
+  const int jobs = std::min(*static_cast<const int*>(_user_data), _count);
+  std::atomic<int> next(0);
+  const auto work = [&next, _count, _task, _task_data]() {
+    for (int i = next++; i < _count; i = next++) {
+      _task(i, _task_data);
+    }
+  };
+  ozz::vector<std::thread> threads;
+  for (int i = 1; i < jobs; ++i) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i].join();
+  }
 }
 
 bool IsCompatiblePropertyType(OzzImporter::NodeProperty::Type _src,
@@ -101,86 +128,134 @@ struct RawTrackToTrack<RawFloat4Track> {
   typedef Float4Track Track;
 };
 
+// Builds and serializes an (already optimized) track, which is then queued to
+// _writer.
 template <typename _RawTrack>
-bool Export(OzzImporter& _importer, const _RawTrack& _raw_track,
-            const Json::Value& _config, const ozz::Endianness _endianness) {
-  // Raw track to build and output.
-  _RawTrack raw_track;
-
-  // Optimizes track if option is enabled.
-  if (_config["optimize"].asBool()) {
-    ozz::log::LogV() << "Optimizing track." << std::endl;
-    TrackOptimizer optimizer;
-    optimizer.tolerance = _config["optimization_tolerance"].asFloat();
-    _RawTrack raw_optimized_track;
-    if (!optimizer(_raw_track, &raw_optimized_track)) {
-      ozz::log::Err() << "Failed to optimize track." << std::endl;
-      return false;
-    }
-
-    // Displays optimization statistics.
-    DisplaysOptimizationstatistics(_raw_track, raw_optimized_track);
-
-    // Brings data back to the raw track.
-    raw_track = raw_optimized_track;
-  } else {
-    ozz::log::LogV() << "Optimization for track \"" << _raw_track.name
-                     << "\" is disabled." << std::endl;
-  }
-
+bool Export(const OzzImporter& _importer, const _RawTrack& _raw_track,
+            const Json::Value& _config, const ozz::Endianness _endianness,
+            ArchiveWriter& _writer) {
   // Builds runtime track.
   unique_ptr<typename RawTrackToTrack<_RawTrack>::Track> track;
   if (!_config["raw"].asBool()) {
     ozz::log::LogV() << "Builds runtime track." << std::endl;
     TrackBuilder builder;
-    track = builder(raw_track);
+    track = builder(_raw_track);
     if (!track) {
       ozz::log::Err() << "Failed to build runtime track." << std::endl;
       return false;
     }
   }
 
+  // Serializes to memory, file is written by the writer thread.
+  unique_ptr<ozz::io::MemoryStream> stream =
+      make_unique<ozz::io::MemoryStream>();
   {
-    // Prepares output stream. Once the file is opened, nothing should fail as
-    // it would leave an invalid file on the disk.
-
-    // Builds output filename.
-    const ozz::string filename = _importer.BuildFilename(
-        _config["filename"].asCString(), _raw_track.name.c_str());
-
-    ozz::log::LogV() << "Opens output file: " << filename << std::endl;
-    ozz::io::File file(filename.c_str(), "wb");
-    if (!file.opened()) {
-      ozz::log::Err() << "Failed to open output file: " << filename
-                      << std::endl;
-      return false;
-    }
-
-    // Initializes output archive.
-    ozz::io::OArchive archive(&file, _endianness);
-
-    // Fills output archive with the track.
+    // Initializes output archive, and fills it with the track.
+    ozz::io::OArchive archive(stream.get(), _endianness);
     if (_config["raw"].asBool()) {
       ozz::log::LogV() << "Outputs RawTrack to binary archive." << std::endl;
-      archive << raw_track;
+      archive << _raw_track;
     } else {
       ozz::log::LogV() << "Outputs Track to binary archive." << std::endl;
       archive << *track;
     }
   }
+  _writer.Push(_importer.BuildFilename(_config["filename"].asCString(),
+                                       _raw_track.name.c_str()),
+               std::move(stream));
 
-  ozz::log::LogV() << "Track binary archive successfully outputted."
+  ozz::log::LogV() << "Track binary archive successfully serialized."
                    << std::endl;
 
   return true;
 }
 
+// Shared data of export tasks, one task per track.
+template <typename _RawTrack>
+struct ExportTrackTasks {
+  const OzzImporter* importer;
+  const Json::Value* config;
+  ozz::Endianness endianness;
+  ArchiveWriter* writer;
+  span<const _RawTrack> tracks;
+
+  // Success of each task. Every task writes its own element.
+  span<uint8_t> results;
+};
+
+template <typename _RawTrack>
+void ExportTrackTask(int _task, void* _data) {
+  const ExportTrackTasks<_RawTrack>& tasks =
+      *static_cast<const ExportTrackTasks<_RawTrack>*>(_data);
+  tasks.results[_task] =
+      Export(*tasks.importer, tasks.tracks[_task], *tasks.config,
+             tasks.endianness, *tasks.writer);
+}
+
+// Optimizes (if option is enabled), builds and serializes _tracks, using _jobs
+// threads. Tracks are then written by _writer.
+template <typename _RawTrack>
+bool ExportTracks(const OzzImporter& _importer,
+                  const ozz::vector<_RawTrack>& _tracks,
+                  const Json::Value& _config, const ozz::Endianness _endianness,
+                  ArchiveWriter& _writer, int _jobs) {
+  if (_tracks.empty()) {
+    return true;
+  }
+
+  // Optimizes tracks if option is enabled.
+  ozz::vector<_RawTrack> optimized;
+  if (_config["optimize"].asBool()) {
+    ozz::log::LogV() << "Optimizing " << _tracks.size() << " track(s)."
+                     << std::endl;
+    TrackOptimizer optimizer;
+    optimizer.tolerance = _config["optimization_tolerance"].asFloat();
+    optimizer.parallel_for = &ThreadParallelFor;
+    optimizer.parallel_for_user_data = &_jobs;
+    optimized.resize(_tracks.size());
+    if (!optimizer(make_span(_tracks), make_span(optimized))) {
+      ozz::log::Err() << "Failed to optimize track." << std::endl;
+      return false;
+    }
+
+    // Displays optimization statistics.
+    for (size_t i = 0; i < _tracks.size(); ++i) {
+      DisplaysOptimizationstatistics(_tracks[i], optimized[i]);
+    }
+  } else {
+    for (size_t i = 0; i < _tracks.size(); ++i) {
+      ozz::log::LogV() << "Optimization for track \"" << _tracks[i].name
+                       << "\" is disabled." << std::endl;
+    }
+  }
+
+  // Builds and writes tracks.
+  ozz::vector<uint8_t> results(_tracks.size());
+  const ExportTrackTasks<_RawTrack> tasks = {
+      &_importer, &_config, _endianness, &_writer,
+      make_span(optimized.empty() ? _tracks : optimized), make_span(results)};
+  ThreadParallelFor(static_cast<int>(_tracks.size()),
+                    &ExportTrackTask<_RawTrack>,
+                    const_cast<void*>(static_cast<const void*>(&tasks)),
+                    &_jobs);
+
+  return std::find(results.begin(), results.end(), 0) == results.end();
+}
+
+// Tracks imported for a property import definition, per track type.
+struct ImportedTracks {
+  ozz::vector<RawFloatTrack> float1;
+  ozz::vector<RawFloat2Track> float2;
+  ozz::vector<RawFloat3Track> float3;
+  ozz::vector<RawFloat4Track> float4;
+};
+
 template <typename _TrackType>
-bool ProcessImportTrackType(
-    OzzImporter& _importer, const char* _animation_name,
-    const char* _joint_name, const OzzImporter::NodeProperty& _property,
-    const OzzImporter::NodeProperty::Type _expected_type,
-    const Json::Value& _import_config, const ozz::Endianness _endianness) {
+bool ImportTrackType(OzzImporter& _importer, const char* _animation_name,
+                     const char* _joint_name,
+                     const OzzImporter::NodeProperty& _property,
+                     const OzzImporter::NodeProperty::Type _expected_type,
+                     ozz::vector<_TrackType>* _tracks) {
   bool success = true;
 
   ozz::log::Log() << "Extracting animation track \"" << _joint_name << ":"
@@ -198,7 +273,7 @@ bool ProcessImportTrackType(
     track.name += '-';
     track.name += _property.name.c_str();
 
-    success &= Export(_importer, track, _import_config, _endianness);
+    _tracks->push_back(std::move(track));
   } else {
     ozz::log::Err() << "Failed to import track \"" << _joint_name << ":"
                     << _property.name << "\"" << std::endl;
@@ -207,15 +282,19 @@ bool ProcessImportTrackType(
   return success;
 }
 
+// Tracks are imported from the SDK one at a time, then optimized, built and
+// serialized concurrently by _jobs threads, and written by _writer.
 bool ProcessImportTrack(OzzImporter& _importer, const char* _animation_name,
                         const Skeleton& _skeleton,
                         const Json::Value& _import_config,
-                        const ozz::Endianness _endianness) {
+                        const ozz::Endianness _endianness,
+                        ArchiveWriter& _writer, int _jobs) {
   // Early out if no name is specified
   const char* joint_name_match = _import_config["joint_name"].asCString();
   const char* ppt_name_match = _import_config["property_name"].asCString();
 
   // Process every joint that matches.
+  ImportedTracks tracks;
   bool success = true;
   bool joint_found = false;
   for (int s = 0; success && s < _skeleton.num_joints(); ++s) {
@@ -270,29 +349,25 @@ bool ProcessImportTrack(OzzImporter& _importer, const char* _animation_name,
       // Import property depending on its type.
       switch (property.type) {
         case OzzImporter::NodeProperty::kFloat1: {
-          success &= ProcessImportTrackType<RawFloatTrack>(
-              _importer, _animation_name, joint_name, property, expected_type,
-              _import_config, _endianness);
+          success &= ImportTrackType(_importer, _animation_name, joint_name,
+                                     property, expected_type, &tracks.float1);
           break;
         }
         case OzzImporter::NodeProperty::kFloat2: {
-          success &= ProcessImportTrackType<RawFloat2Track>(
-              _importer, _animation_name, joint_name, property, expected_type,
-              _import_config, _endianness);
+          success &= ImportTrackType(_importer, _animation_name, joint_name,
+                                     property, expected_type, &tracks.float2);
           break;
         }
         case OzzImporter::NodeProperty::kFloat3:
         case OzzImporter::NodeProperty::kPoint:
         case OzzImporter::NodeProperty::kVector: {
-          success &= ProcessImportTrackType<RawFloat3Track>(
-              _importer, _animation_name, joint_name, property, expected_type,
-              _import_config, _endianness);
+          success &= ImportTrackType(_importer, _animation_name, joint_name,
+                                     property, expected_type, &tracks.float3);
           break;
         }
         case OzzImporter::NodeProperty::kFloat4: {
-          success &= ProcessImportTrackType<RawFloat4Track>(
-              _importer, _animation_name, joint_name, property, expected_type,
-              _import_config, _endianness);
+          success &= ImportTrackType(_importer, _animation_name, joint_name,
+                                     property, expected_type, &tracks.float4);
           break;
         }
         default: {
@@ -315,6 +390,17 @@ bool ProcessImportTrack(OzzImporter& _importer, const char* _animation_name,
                     << joint_name_match << "\"." << std::endl;
   }
 
+  if (success) {
+    success &= ExportTracks(_importer, tracks.float1, _import_config,
+                            _endianness, _writer, _jobs);
+    success &= ExportTracks(_importer, tracks.float2, _import_config,
+                            _endianness, _writer, _jobs);
+    success &= ExportTracks(_importer, tracks.float3, _import_config,
+                            _endianness, _writer, _jobs);
+    success &= ExportTracks(_importer, tracks.float4, _import_config,
+                            _endianness, _writer, _jobs);
+  }
+
   return success;
 }
 
@@ -327,13 +413,14 @@ _skeleton, const Json::Value& _motion) { return true;
 
 bool ProcessTracks(OzzImporter& _importer, const char* _animation_name,
                    const Skeleton& _skeleton, const Json::Value& _config,
-                   const ozz::Endianness _endianness) {
+                   const ozz::Endianness _endianness, ArchiveWriter& _writer,
+                   int _jobs) {
   bool success = true;
 
   const Json::Value& imports = _config["properties"];
   for (Json::ArrayIndex i = 0; success && i < imports.size(); ++i) {
     success &= ProcessImportTrack(_importer, _animation_name, _skeleton,
-                                  imports[i], _endianness);
+                                  imports[i], _endianness, _writer, _jobs);
   }
 
   /*
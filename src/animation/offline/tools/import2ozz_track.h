@@ -44,11 +44,18 @@ class Skeleton;
 namespace offline {
 
 class OzzImporter;
+class ArchiveWriter;
+
+// Imports tracks of _animation_name matching _config. Tracks are extracted
+// serially from _importer, then optimized, built and serialized by _jobs
+// concurrent threads. Files are written by _writer, so write failures are
+// only reported by _writer Flush().
 OZZ_ANIMTOOLS_DLL bool ProcessTracks(OzzImporter& _importer,
                                      const char* _animation_name,
                                      const Skeleton& _skeleton,
                                      const Json::Value& _config,
-                                     const ozz::Endianness _endianness);
+                                     const ozz::Endianness _endianness,
+                                     ArchiveWriter& _writer, int _jobs);
 
 // Property type enum to config string conversions.
 struct OZZ_ANIMTOOLS_DLL PropertyTypeConfig
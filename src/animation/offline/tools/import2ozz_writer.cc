@@ -0,0 +1,146 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "animation/offline/tools/import2ozz_writer.h"
+
+#include <cassert>
+
+#include "ozz/base/log.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+ArchiveWriter::ArchiveWriter(size_t _capacity)
+    : capacity_(_capacity),
+      writing_(false),
+      failed_(false),
+      closed_(false),
+      thread_(&ArchiveWriter::Work, this) {
+  assert(_capacity > 0 && "Writer capacity must be at least 1.");
+}
+
+ArchiveWriter::~ArchiveWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+  }
+  not_empty_.notify_all();
+  thread_.join();
+}
+
+void ArchiveWriter::Push(const ozz::string& _filename,
+                         unique_ptr<ozz::io::MemoryStream> _stream,
+                         size_t* _succeeded,
+                         const ozz::string& _stamp_filename,
+                         uint64_t _stamp) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  progress_.wait(lock, [this] { return queue_.size() < capacity_; });
+  queue_.emplace_back();
+  Task& task = queue_.back();
+  task.filename = _filename;
+  task.stream = std::move(_stream);
+  task.succeeded = _succeeded;
+  task.stamp_filename = _stamp_filename;
+  task.stamp = _stamp;
+  not_empty_.notify_one();
+}
+
+bool ArchiveWriter::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  progress_.wait(lock, [this] { return queue_.empty() && !writing_; });
+  const bool succeeded = !failed_;
+  failed_ = false;
+  return succeeded;
+}
+
+void ArchiveWriter::Work() {
+  for (;;) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_empty_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;  // Closed and nothing left to write.
+      }
+      task = std::move(queue_.front());
+      queue_.pop_front();
+      writing_ = true;
+    }
+    progress_.notify_all();
+
+    const bool written = Write(task);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      writing_ = false;
+      failed_ |= !written;
+      if (written && task.succeeded) {
+        ++*task.succeeded;
+      }
+    }
+    progress_.notify_all();
+  }
+}
+
+bool ArchiveWriter::Write(const Task& _task) {
+  ozz::log::LogV() << "Writes output file: \"" << _task.filename << "\""
+                   << std::endl;
+  {
+    ozz::io::File file(_task.filename.c_str(), "wb");
+    if (!file.opened()) {
+      ozz::log::Err() << "Failed to open output file: \"" << _task.filename
+                      << "\"" << std::endl;
+      return false;
+    }
+
+    // Copies stream content by chunks.
+    ozz::io::MemoryStream& stream = *_task.stream;
+    stream.Seek(0, ozz::io::Stream::kSet);
+    char buffer[16 << 10];
+    for (size_t read = stream.Read(buffer, sizeof(buffer)); read != 0;
+         read = stream.Read(buffer, sizeof(buffer))) {
+      if (file.Write(buffer, read) != read) {
+        ozz::log::Err() << "Failed to write output file: \"" << _task.filename
+                        << "\"" << std::endl;
+        return false;
+      }
+    }
+  }
+
+  if (!_task.stamp_filename.empty()) {
+    ozz::io::File file(_task.stamp_filename.c_str(), "wb");
+    if (!file.opened() ||
+        file.Write(&_task.stamp, sizeof(_task.stamp)) != sizeof(_task.stamp)) {
+      ozz::log::Err() << "Failed to write build stamp \""
+                      << _task.stamp_filename << "\"" << std::endl;
+    }
+  }
+  return true;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,109 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_ANIMATION_OFFLINE_TOOLS_IMPORT2OZZ_WRITER_H_
+#define OZZ_ANIMATION_OFFLINE_TOOLS_IMPORT2OZZ_WRITER_H_
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "ozz/base/containers/deque.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/unique_ptr.h"
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+// Writes output files from a background thread, so that disk writes overlap
+// with the extraction, optimization and building of the next animations and
+// tracks. Archives are serialized to memory streams by the caller and then
+// queued. The queue is bounded to capacity streams, Push() blocking when it's
+// full, so that memory usage remains bounded when disk is the bottleneck.
+class ArchiveWriter {
+ public:
+  // Starts the writer thread. _capacity must be at least 1.
+  explicit ArchiveWriter(size_t _capacity);
+
+  // Writes all queued streams, and stops the writer thread.
+  ~ArchiveWriter();
+
+  ArchiveWriter(const ArchiveWriter&) = delete;
+  ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+  // Queues _stream content to be written to file _filename. Can be called
+  // concurrently. Once the file is written, *_succeeded is incremented if
+  // _succeeded isn't nullptr, and _stamp is written to file _stamp_filename
+  // if it isn't empty, so that a stamp never outlives a failed write.
+  // *_succeeded can only be read once Flush() returned.
+  void Push(const ozz::string& _filename,
+            unique_ptr<ozz::io::MemoryStream> _stream,
+            size_t* _succeeded = nullptr,
+            const ozz::string& _stamp_filename = ozz::string(),
+            uint64_t _stamp = 0);
+
+  // Waits for all queued streams to be written. Returns false if any write
+  // failed since the previous flush.
+  bool Flush();
+
+ private:
+  struct Task {
+    ozz::string filename;
+    unique_ptr<ozz::io::MemoryStream> stream;
+    size_t* succeeded;
+    ozz::string stamp_filename;
+    uint64_t stamp;
+  };
+
+  // Writer thread loop.
+  void Work();
+
+  // Writes _task stream, then its stamp. Returns false if stream write
+  // failed.
+  static bool Write(const Task& _task);
+
+  const size_t capacity_;
+
+  std::mutex mutex_;
+  std::condition_variable not_empty_;
+  // Signaled when a task is popped or written.
+  std::condition_variable progress_;
+  ozz::deque<Task> queue_;
+  bool writing_;
+  bool failed_;
+  bool closed_;
+
+  // Declared last, so that it starts once other members are initialized.
+  std::thread thread_;
+};
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_ANIMATION_OFFLINE_TOOLS_IMPORT2OZZ_WRITER_H_
@@ -0,0 +1,154 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+// Bakes an animation to a pose atlas file: a GPU ready texture of model-space
+// (or skinning) joint matrices sampled at a fixed frame rate, aimed at far
+// level of detail crowds skinned in a vertex shader. See
+// ozz::animation::offline::PoseAtlas for the file layout.
+
+#include <cstdlib>
+#include <cstring>
+
+#include "ozz/animation/offline/pose_atlas_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/options/options.h"
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(skeleton, "Specifies input skeleton archive file",
+                           "", true)
+OZZ_OPTIONS_DECLARE_STRING(animation, "Specifies input animation archive file",
+                           "", true)
+OZZ_OPTIONS_DECLARE_STRING(output, "Specifies output atlas file", "", true)
+
+static bool ValidateFrequency(const ozz::options::Option& _option,
+                              int /*_argc*/) {
+  const ozz::options::FloatOption& option =
+      static_cast<const ozz::options::FloatOption&>(_option);
+  const bool valid = option.value() > 0.f;
+  if (!valid) {
+    ozz::log::Err() << "Invalid frequency option \"" << option.value()
+                    << "\", must be greater than 0." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_FLOAT_FN(frequency,
+                             "Specifies sampling frequency, in frames per "
+                             "second.",
+                             30.f, false, &ValidateFrequency)
+
+static bool ValidateFormat(const ozz::options::Option& _option,
+                           int /*_argc*/) {
+  const ozz::options::StringOption& option =
+      static_cast<const ozz::options::StringOption&>(_option);
+  const bool valid = std::strcmp(option.value(), "half") == 0 ||
+                     std::strcmp(option.value(), "float") == 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid format option \"" << option << "\""
+                    << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_STRING_FN(
+    format, "Selects texels format. Can be \"half\" or \"float\".", "half",
+    false, &ValidateFormat)
+
+OZZ_OPTIONS_DECLARE_BOOL(skinning,
+                         "Stores skinning matrices (model-space matrices "
+                         "multiplied by inverse rest pose) instead of "
+                         "model-space matrices.",
+                         false, false)
+
+namespace {
+// Loads an object of type _Ty from archive _filename.
+template <typename _Ty>
+bool LoadObject(const char* _filename, _Ty* _object) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open file \"" << _filename << "\"."
+                    << std::endl;
+    return false;
+  }
+  ozz::io::IArchive archive(&file);
+  if (!archive.TestTag<_Ty>()) {
+    ozz::log::Err() << "Failed to load object from file \"" << _filename
+                    << "\"." << std::endl;
+    return false;
+  }
+  archive >> *_object;
+  return true;
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0",
+      "Bakes an animation to a GPU ready pose atlas file.");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  ozz::animation::Skeleton skeleton;
+  ozz::animation::Animation animation;
+  if (!LoadObject(OPTIONS_skeleton, &skeleton) ||
+      !LoadObject(OPTIONS_animation, &animation)) {
+    return EXIT_FAILURE;
+  }
+
+  ozz::animation::offline::PoseAtlasBuilder builder;
+  builder.frame_rate = OPTIONS_frequency;
+  builder.format = std::strcmp(OPTIONS_format, "float") == 0
+                       ? ozz::animation::offline::PoseAtlas::kFloat
+                       : ozz::animation::offline::PoseAtlas::kHalf;
+  builder.skinning = OPTIONS_skinning;
+
+  ozz::animation::offline::PoseAtlas atlas;
+  if (!builder(skeleton, animation, &atlas)) {
+    ozz::log::Err() << "Failed to bake animation \"" << OPTIONS_animation
+                    << "\", animation tracks might not match skeleton joints."
+                    << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ozz::io::File file(OPTIONS_output, "wb");
+  if (!atlas.Write(&file)) {
+    ozz::log::Err() << "Failed to write output file \"" << OPTIONS_output
+                    << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+  ozz::log::Log() << "Pose atlas \"" << OPTIONS_output << "\" written, "
+                  << atlas.num_frames << " frames of " << atlas.num_joints
+                  << " joints." << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,649 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+// Compares animation compression codecs, to select keys formats and
+// optimization settings with hard data. Every raw animation is built with
+// every codec (16 bits keys, compact keys, cubic curves and uniform frames)
+// and optimizer setting (none, decimation and curve fitting). Each build is
+// measured for runtime size, max and average skinned error compared to the
+// raw animation, and decoding speed (SamplingJob time per joint). Errors are
+// measured in model-space (SamplingJob + LocalToModelJob), at joints and at a
+// distance from joints, which approximates skinned vertices displacement.
+// Input can be a raw animation file, or a directory that's recursively
+// scanned for raw animation files. Files that don't contain a raw animation
+// are skipped.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else  // _WIN32
+#include <dirent.h>
+#endif  // _WIN32
+
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/animation_optimizer.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+#include "ozz/animation/offline/uniform_animation_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/uniform_animation.h"
+#include "ozz/animation/runtime/uniform_sampling_job.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/options/options.h"
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(
+    path,
+    "Specifies input raw animation file, or directory to scan recursively", "",
+    true)
+OZZ_OPTIONS_DECLARE_STRING(skeleton,
+                           "Specifies the skeleton archive file animations "
+                           "are built for",
+                           "", true)
+OZZ_OPTIONS_DECLARE_STRING(
+    output, "Specifies report output file, standard output if empty", "",
+    false)
+
+static bool ValidateFormat(const ozz::options::Option& _option,
+                           int /*_argc*/) {
+  const ozz::options::StringOption& option =
+      static_cast<const ozz::options::StringOption&>(_option);
+  const bool valid = std::strcmp(option.value(), "console") == 0 ||
+                     std::strcmp(option.value(), "csv") == 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid format option \"" << option << "\""
+                    << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_STRING_FN(
+    format, "Selects report format. Can be \"console\" or \"csv\".",
+    "console", false, &ValidateFormat)
+
+static bool ValidateFrequency(const ozz::options::Option& _option,
+                              int /*_argc*/) {
+  const ozz::options::FloatOption& option =
+      static_cast<const ozz::options::FloatOption&>(_option);
+  const bool valid = option.value() > 0.f;
+  if (!valid) {
+    ozz::log::Err() << "Invalid " << option.name() << " option \""
+                    << option.value() << "\", must be greater than 0."
+                    << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_FLOAT_FN(frequency,
+                             "Specifies the frequency used to measure errors "
+                             "and decoding speed, in frames per second. It "
+                             "should differ from frame_rate, otherwise "
+                             "uniform codec error is only measured at its "
+                             "frames.",
+                             60.f, false, &ValidateFrequency)
+
+OZZ_OPTIONS_DECLARE_FLOAT_FN(frame_rate,
+                             "Specifies uniform codec frame rate, in frames "
+                             "per second.",
+                             30.f, false, &ValidateFrequency)
+
+OZZ_OPTIONS_DECLARE_FLOAT(tolerance,
+                          "Specifies optimizer tolerance, in meters.", 1e-3f,
+                          false)
+
+OZZ_OPTIONS_DECLARE_FLOAT(distance,
+                          "Specifies the distance (from joints) at which "
+                          "optimizer tolerance and skinned error are "
+                          "measured, in meters.",
+                          1e-1f, false)
+
+static bool ValidateIterations(const ozz::options::Option& _option,
+                               int /*_argc*/) {
+  const ozz::options::IntOption& option =
+      static_cast<const ozz::options::IntOption&>(_option);
+  const bool valid = option.value() > 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid iterations option \"" << option.value()
+                    << "\", must be greater than 0." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_INT_FN(iterations,
+                           "Number of times every animation is played to "
+                           "measure decoding speed.",
+                           10, false, &ValidateIterations)
+
+namespace {
+
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::AnimationOptimizer;
+
+// Compared codecs.
+const struct {
+  const char* name;
+  AnimationBuilder::RotationFormat rotation_format;
+  bool compact_ratios;
+  bool cubic_interpolation;
+  bool uniform;
+} kCodecs[] = {
+    {"keys16", AnimationBuilder::kRotationDefault, false, false, false},
+    {"compact48", AnimationBuilder::kRotationCompact48, true, false, false},
+    {"compact32", AnimationBuilder::kRotationCompact32, true, false, false},
+    {"cubic", AnimationBuilder::kRotationDefault, false, true, false},
+    {"uniform", AnimationBuilder::kRotationDefault, false, false, true}};
+
+// Compared optimizer settings. Uniform codec resamples animations at a fixed
+// rate, so it's only measured without optimization.
+const struct {
+  const char* name;
+  bool optimize;
+  AnimationOptimizer::Reduction reduction;
+} kOptimizations[] = {{"none", false, AnimationOptimizer::kDecimation},
+                      {"decimation", true, AnimationOptimizer::kDecimation},
+                      {"fitting", true, AnimationOptimizer::kFitting}};
+
+// Measures of a codec and optimizer setting.
+struct Measure {
+  const char* codec;
+  const char* optimization;
+  size_t size;
+  float max_error;
+  double total_error;  // Sum of all joints errors.
+  double decode_time;  // Total decoding time, in seconds.
+  size_t num_samples;  // Number of measured joints (frames * joints).
+  size_t num_decodes;  // Number of decoded joints.
+};
+
+// Measures of an animation file.
+struct Entry {
+  ozz::string file;
+  ozz::string name;
+  float duration;
+  ozz::vector<Measure> measures;  // Reference (keys16 + none) first.
+};
+
+// Tells if _path is a directory.
+bool IsDirectory(const char* _path) {
+#ifdef _WIN32
+  struct _stat info;
+  return _stat(_path, &info) == 0 && (info.st_mode & _S_IFDIR) != 0;
+#else   // _WIN32
+  struct stat info;
+  return stat(_path, &info) == 0 && S_ISDIR(info.st_mode);
+#endif  // _WIN32
+}
+
+// Lists files of _directory and its sub-directories to _files, sorted so that
+// reports are stable.
+void ListFiles(const ozz::string& _directory,
+               ozz::vector<ozz::string>* _files) {
+  ozz::vector<ozz::string> entries;
+#ifdef _WIN32
+  struct _finddata_t data;
+  const intptr_t handle = _findfirst((_directory + "/*").c_str(), &data);
+  if (handle != -1) {
+    do {
+      entries.push_back(data.name);
+    } while (_findnext(handle, &data) == 0);
+    _findclose(handle);
+  }
+#else   // _WIN32
+  DIR* dir = opendir(_directory.c_str());
+  if (dir) {
+    while (const dirent* entry = readdir(dir)) {
+      entries.push_back(entry->d_name);
+    }
+    closedir(dir);
+  }
+#endif  // _WIN32
+  std::sort(entries.begin(), entries.end());
+  for (const ozz::string& entry : entries) {
+    if (entry == "." || entry == "..") {
+      continue;
+    }
+    const ozz::string path = _directory + "/" + entry;
+    if (IsDirectory(path.c_str())) {
+      ListFiles(path, _files);
+    } else {
+      _files->push_back(path);
+    }
+  }
+}
+
+// Loads a raw animation from _filename. Returns false if file doesn't contain
+// a raw animation.
+bool LoadRawAnimation(const char* _filename,
+                      ozz::animation::offline::RawAnimation* _animation) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open file \"" << _filename << "\"."
+                    << std::endl;
+    return false;
+  }
+  ozz::io::IArchive archive(&file);
+  if (!archive.TestTag<ozz::animation::offline::RawAnimation>()) {
+    ozz::log::LogV() << "Skipping file \"" << _filename
+                     << "\", which doesn't contain a raw animation."
+                     << std::endl;
+    return false;
+  }
+  archive >> *_animation;
+  return true;
+}
+
+// Samples and measures animations against the raw animation reference, at
+// frequency option rate.
+class Evaluator {
+ public:
+  Evaluator(const ozz::animation::Skeleton& _skeleton)
+      : skeleton_(_skeleton),
+        locals_(_skeleton.num_soa_joints()),
+        models_(_skeleton.num_joints()) {}
+
+  // Computes _raw model-space reference poses.
+  bool Reference(const ozz::animation::offline::RawAnimation& _raw) {
+    const ozz::animation::offline::FixedRateSamplingTime times(
+        _raw.duration, OPTIONS_frequency);
+    ozz::animation::offline::RawAnimationSampler sampler;
+    if (!sampler.Bind(_raw)) {
+      return false;
+    }
+    num_frames_ = times.num_keys();
+    references_.resize(num_frames_ * skeleton_.num_joints());
+    ratios_.resize(num_frames_);
+    for (size_t i = 0; i < num_frames_; ++i) {
+      ratios_[i] = _raw.duration > 0.f ? times.time(i) / _raw.duration : 0.f;
+      if (!sampler.Sample(times.time(i), make_span(locals_)) ||
+          !ToModel(references_.data() + i * skeleton_.num_joints())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Measures errors and decoding speed of the animation sampled by _sample,
+  // a function that samples a ratio to local-space transforms.
+  template <typename _Sample>
+  bool Evaluate(_Sample _sample, Measure* _measure) {
+    const int num_joints = skeleton_.num_joints();
+    const ozz::math::SimdFloat4 distance =
+        ozz::math::simd_float4::Load1(OPTIONS_distance);
+    const ozz::math::SimdFloat4 points[] = {
+        ozz::math::simd_float4::zero(),
+        ozz::math::simd_float4::x_axis() * distance,
+        ozz::math::simd_float4::y_axis() * distance,
+        ozz::math::simd_float4::z_axis() * distance};
+
+    // Errors, at joints and distance points.
+    _measure->max_error = 0.f;
+    _measure->total_error = 0.;
+    for (size_t i = 0; i < num_frames_; ++i) {
+      if (!_sample(ratios_[i], make_span(locals_)) ||
+          !ToModel(models_.data())) {
+        return false;
+      }
+      const ozz::math::Float4x4* references =
+          references_.data() + i * num_joints;
+      for (int j = 0; j < num_joints; ++j) {
+        ozz::math::SimdFloat4 error = ozz::math::simd_float4::zero();
+        for (const ozz::math::SimdFloat4& point : points) {
+          const ozz::math::SimdFloat4 diff =
+              ozz::math::TransformPoint(models_[j], point) -
+              ozz::math::TransformPoint(references[j], point);
+          error = ozz::math::Max(error, ozz::math::Length3(diff));
+        }
+        const float joint_error = ozz::math::GetX(error);
+        _measure->max_error = std::max(_measure->max_error, joint_error);
+        _measure->total_error += joint_error;
+      }
+    }
+    _measure->num_samples = num_frames_ * num_joints;
+
+    // Decoding speed, playing the whole animation iterations times.
+    const auto begin = std::chrono::steady_clock::now();
+    for (int it = 0; it < OPTIONS_iterations; ++it) {
+      for (size_t i = 0; i < num_frames_; ++i) {
+        _sample(ratios_[i], make_span(locals_));
+      }
+    }
+    const std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - begin;
+    _measure->decode_time = elapsed.count();
+    _measure->num_decodes = OPTIONS_iterations * num_frames_ * num_joints;
+    return true;
+  }
+
+ private:
+  bool ToModel(ozz::math::Float4x4* _models) {
+    ozz::animation::LocalToModelJob job;
+    job.skeleton = &skeleton_;
+    job.input = make_span(locals_);
+    job.output = {_models, static_cast<size_t>(skeleton_.num_joints())};
+    return job.Run();
+  }
+
+  const ozz::animation::Skeleton& skeleton_;
+  size_t num_frames_;
+  ozz::vector<float> ratios_;
+  ozz::vector<ozz::math::SoaTransform> locals_;
+  ozz::vector<ozz::math::Float4x4> models_;
+  ozz::vector<ozz::math::Float4x4> references_;
+};
+
+// Builds _raw with every codec and optimizer setting, and measures them.
+bool Compare(const ozz::animation::offline::RawAnimation& _raw,
+             const ozz::animation::Skeleton& _skeleton, Evaluator* _evaluator,
+             ozz::vector<Measure>* _measures) {
+  if (!_evaluator->Reference(_raw)) {
+    return false;
+  }
+  for (const auto& codec : kCodecs) {
+    for (const auto& optimization : kOptimizations) {
+      if (codec.uniform && optimization.optimize) {
+        continue;
+      }
+      Measure measure;
+      measure.codec = codec.name;
+      measure.optimization = optimization.name;
+
+      // Optimizes.
+      ozz::animation::offline::RawAnimation optimized;
+      if (optimization.optimize) {
+        AnimationOptimizer optimizer;
+        optimizer.setting.tolerance = OPTIONS_tolerance;
+        optimizer.setting.distance = OPTIONS_distance;
+        optimizer.reduction = optimization.reduction;
+        optimizer.cubic_interpolation = codec.cubic_interpolation;
+        if (!optimizer(_raw, _skeleton, &optimized)) {
+          return false;
+        }
+      }
+      const ozz::animation::offline::RawAnimation& raw =
+          optimization.optimize ? optimized : _raw;
+
+      // Builds and measures.
+      bool success = false;
+      if (codec.uniform) {
+        ozz::animation::offline::UniformAnimationBuilder builder;
+        builder.frame_rate = OPTIONS_frame_rate;
+        const ozz::unique_ptr<ozz::animation::UniformAnimation> animation =
+            builder(raw);
+        if (!animation) {
+          return false;
+        }
+        measure.size = animation->size();
+        success = _evaluator->Evaluate(
+            [&animation](float _ratio,
+                         const ozz::span<ozz::math::SoaTransform>& _output) {
+              ozz::animation::UniformSamplingJob job;
+              job.animation = animation.get();
+              job.ratio = _ratio;
+              job.output = _output;
+              return job.Run();
+            },
+            &measure);
+      } else {
+        AnimationBuilder builder;
+        builder.rotation_format = codec.rotation_format;
+        builder.compact_ratios = codec.compact_ratios;
+        builder.cubic_interpolation = codec.cubic_interpolation;
+        const ozz::unique_ptr<ozz::animation::Animation> animation =
+            builder(raw);
+        if (!animation) {
+          return false;
+        }
+        measure.size = animation->size();
+        ozz::animation::SamplingJob::Context context(animation->num_tracks(),
+                                                     animation->cubic());
+        success = _evaluator->Evaluate(
+            [&animation, &context](
+                float _ratio,
+                const ozz::span<ozz::math::SoaTransform>& _output) {
+              ozz::animation::SamplingJob job;
+              job.animation = animation.get();
+              job.context = &context;
+              job.ratio = _ratio;
+              job.output = _output;
+              return job.Run();
+            },
+            &measure);
+      }
+      if (!success) {
+        return false;
+      }
+      _measures->push_back(measure);
+    }
+  }
+  return true;
+}
+
+// Accumulates _measure to _total.
+void Accumulate(const Measure& _measure, Measure* _total) {
+  _total->size += _measure.size;
+  _total->max_error = std::max(_total->max_error, _measure.max_error);
+  _total->total_error += _measure.total_error;
+  _total->decode_time += _measure.decode_time;
+  _total->num_samples += _measure.num_samples;
+  _total->num_decodes += _measure.num_decodes;
+}
+
+// Sums measures of all entries, per codec and optimizer setting.
+ozz::vector<Measure> Totals(const ozz::vector<Entry>& _entries) {
+  ozz::vector<Measure> totals;
+  for (const Entry& entry : _entries) {
+    if (totals.empty()) {
+      totals = entry.measures;
+      continue;
+    }
+    for (size_t i = 0; i < totals.size(); ++i) {
+      Accumulate(entry.measures[i], &totals[i]);
+    }
+  }
+  return totals;
+}
+
+float AverageError(const Measure& _measure) {
+  return _measure.num_samples
+             ? static_cast<float>(_measure.total_error / _measure.num_samples)
+             : 0.f;
+}
+
+float DecodeNsPerJoint(const Measure& _measure) {
+  return _measure.num_decodes
+             ? static_cast<float>(_measure.decode_time * 1e9 /
+                                  _measure.num_decodes)
+             : 0.f;
+}
+
+// Gets _size ratio compared to _reference.
+float Ratio(size_t _reference, size_t _size) {
+  return _reference > 0
+             ? static_cast<float>(_size) / static_cast<float>(_reference)
+             : 0.f;
+}
+
+void ReportTable(const ozz::vector<Measure>& _measures, std::ostream& _os) {
+  _os << "  " << std::left << std::setw(12) << "codec" << std::setw(12)
+      << "optimizer" << std::right << std::setw(12) << "bytes"
+      << std::setw(8) << "ratio" << std::setw(12) << "max_error"
+      << std::setw(12) << "avg_error" << std::setw(12) << "ns/joint"
+      << std::endl;
+  for (const Measure& measure : _measures) {
+    _os << "  " << std::left << std::setw(12) << measure.codec
+        << std::setw(12) << measure.optimization << std::right
+        << std::setw(12) << measure.size << std::setw(8)
+        << std::setprecision(3) << Ratio(_measures[0].size, measure.size)
+        << std::setw(12) << measure.max_error << std::setw(12)
+        << AverageError(measure) << std::setw(12) << DecodeNsPerJoint(measure)
+        << std::endl;
+  }
+}
+
+void ReportConsole(const ozz::vector<Entry>& _entries, std::ostream& _os) {
+  float total_duration = 0.f;
+  for (const Entry& entry : _entries) {
+    _os << entry.file << " \"" << entry.name << "\": " << entry.duration
+        << "s" << std::endl;
+    ReportTable(entry.measures, _os);
+    total_duration += entry.duration;
+  }
+  _os << "Total: " << _entries.size() << " animations, " << total_duration
+      << "s" << std::endl;
+  ReportTable(Totals(_entries), _os);
+}
+
+void ReportCsvRow(const char* _file, const char* _name,
+                  const Measure& _measure, const Measure& _reference,
+                  std::ostream& _os) {
+  _os << '"' << _file << "\",\"" << _name << "\"," << _measure.codec << ','
+      << _measure.optimization << ',' << _measure.size << ','
+      << Ratio(_reference.size, _measure.size) << ',' << _measure.max_error
+      << ',' << AverageError(_measure) << ',' << DecodeNsPerJoint(_measure)
+      << std::endl;
+}
+
+void ReportCsv(const ozz::vector<Entry>& _entries, std::ostream& _os) {
+  _os << "file,name,codec,optimizer,size,ratio,max_error,avg_error,"
+         "decode_ns_per_joint"
+      << std::endl;
+  for (const Entry& entry : _entries) {
+    for (const Measure& measure : entry.measures) {
+      ReportCsvRow(entry.file.c_str(), entry.name.c_str(), measure,
+                   entry.measures[0], _os);
+    }
+  }
+  const ozz::vector<Measure> totals = Totals(_entries);
+  for (const Measure& measure : totals) {
+    ReportCsvRow("total", "", measure, totals[0], _os);
+  }
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0",
+      "Compares animations size, error and decoding speed across compression "
+      "codecs and optimizer settings.");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  // Loads skeleton.
+  ozz::animation::Skeleton skeleton;
+  {
+    ozz::io::File file(OPTIONS_skeleton, "rb");
+    if (!file.opened()) {
+      ozz::log::Err() << "Failed to open file \"" << OPTIONS_skeleton
+                      << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    ozz::io::IArchive archive(&file);
+    if (!archive.TestTag<ozz::animation::Skeleton>()) {
+      ozz::log::Err() << "Failed to load skeleton from file \""
+                      << OPTIONS_skeleton << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    archive >> skeleton;
+  }
+
+  // Lists input files.
+  ozz::vector<ozz::string> files;
+  if (IsDirectory(OPTIONS_path)) {
+    ListFiles(OPTIONS_path.value(), &files);
+  } else {
+    files.push_back(OPTIONS_path.value());
+  }
+
+  // Compares codecs for all animations.
+  Evaluator evaluator(skeleton);
+  ozz::vector<Entry> entries;
+  for (const ozz::string& file : files) {
+    ozz::animation::offline::RawAnimation raw;
+    if (!LoadRawAnimation(file.c_str(), &raw)) {
+      continue;
+    }
+    if (raw.num_tracks() != skeleton.num_joints()) {
+      ozz::log::Err() << "Skipping file \"" << file
+                      << "\", whose number of tracks doesn't match skeleton."
+                      << std::endl;
+      continue;
+    }
+    Entry entry;
+    entry.file = file;
+    entry.name = raw.name;
+    entry.duration = raw.duration;
+    if (!Compare(raw, skeleton, &evaluator, &entry.measures)) {
+      ozz::log::Err() << "Failed to compare codecs for animation \"" << file
+                      << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    entries.push_back(std::move(entry));
+  }
+  if (entries.empty()) {
+    ozz::log::Err() << "No raw animation found in \"" << OPTIONS_path.value()
+                    << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Outputs report.
+  std::ofstream file;
+  if (OPTIONS_output.value()[0] != 0) {
+    file.open(OPTIONS_output.value());
+    if (!file) {
+      ozz::log::Err() << "Failed to open output file \""
+                      << OPTIONS_output.value() << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream& os = file.is_open() ? file : std::cout;
+  if (std::strcmp(OPTIONS_format, "csv") == 0) {
+    ReportCsv(entries, os);
+  } else {
+    ReportConsole(entries, os);
+  }
+  return EXIT_SUCCESS;
+}
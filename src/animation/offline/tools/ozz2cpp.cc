@@ -0,0 +1,137 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+// Generates C++ source of a local-to-model function specialized for a
+// skeleton hierarchy, with parent indices baked as constants, and optionally
+// of a skinning matrices palette function. The generated file is meant to be
+// compiled into the application, which registers the function so the runtime
+// can find it from the skeleton hierarchy hash. See
+// ozz::animation::offline::LocalToModelCodegen.
+
+#include <cstdlib>
+#include <cstring>
+
+#include "ozz/animation/offline/local_to_model_codegen.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/options/options.h"
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(skeleton, "Specifies input skeleton archive file",
+                           "", true)
+OZZ_OPTIONS_DECLARE_STRING(output, "Specifies output C++ source file", "",
+                           true)
+OZZ_OPTIONS_DECLARE_STRING(name, "Specifies generated function name",
+                           "LocalToModel", false)
+OZZ_OPTIONS_DECLARE_STRING(joint_remaps,
+                           "Specifies a comma separated list of mesh joint "
+                           "remaps, used to generate a palette function",
+                           "", false)
+OZZ_OPTIONS_DECLARE_BOOL(registration,
+                         "Registers the generated function to the runtime",
+                         true, false)
+
+namespace {
+// Parses comma separated joint indices.
+bool ParseRemaps(const char* _text, ozz::vector<uint16_t>* _remaps) {
+  for (const char* it = _text; *it;) {
+    char* end = nullptr;
+    const long value = std::strtol(it, &end, 10);
+    if (end == it || value < 0 ||
+        value >= ozz::animation::Skeleton::kMaxJoints ||
+        (*end != ',' && *end != 0)) {
+      return false;
+    }
+    _remaps->push_back(static_cast<uint16_t>(value));
+    it = *end == ',' ? end + 1 : end;
+  }
+  return true;
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0",
+      "Generates a local-to-model C++ function specialized for a skeleton.");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  ozz::vector<uint16_t> remaps;
+  if (!ParseRemaps(OPTIONS_joint_remaps, &remaps)) {
+    ozz::log::Err() << "Invalid joint remaps option \""
+                    << OPTIONS_joint_remaps << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ozz::animation::Skeleton skeleton;
+  {
+    ozz::io::File file(OPTIONS_skeleton, "rb");
+    if (!file.opened()) {
+      ozz::log::Err() << "Failed to open file \"" << OPTIONS_skeleton
+                      << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    ozz::io::IArchive archive(&file);
+    if (!archive.TestTag<ozz::animation::Skeleton>()) {
+      ozz::log::Err() << "Failed to load skeleton from file \""
+                      << OPTIONS_skeleton << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    archive >> skeleton;
+  }
+
+  ozz::animation::offline::LocalToModelCodegen codegen;
+  codegen.name = OPTIONS_name;
+  codegen.register_function = OPTIONS_registration;
+  codegen.joint_remaps = make_span(remaps);
+
+  ozz::string source;
+  if (!codegen(skeleton, &source)) {
+    ozz::log::Err() << "Failed to generate source code, function name or "
+                       "joint remaps might not be valid."
+                    << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  ozz::io::File file(OPTIONS_output, "wb");
+  if (!file.opened() ||
+      file.Write(source.c_str(), source.size()) != source.size()) {
+    ozz::log::Err() << "Failed to write output file \""
+                    << OPTIONS_output << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+  ozz::log::Log() << "Local-to-model function \"" << OPTIONS_name
+                  << "\" written to \"" << OPTIONS_output << "\"."
+                  << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,483 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+// Analyzes runtime animations memory footprint and keys density, to
+// prioritize compression work on animation libraries. Reports per animation
+// size, bytes per second, constant track candidates, tracks that dominate
+// size, and projected savings from compact keys formats and levels of detail.
+// Input can be an animation file, or a directory that's recursively scanned
+// for animation files. Files that don't contain an animation are skipped.
+// Sampling memory accesses of a forward playback can also be simulated, for
+// the runtime keys layout and alternative ones.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <io.h>
+#else  // _WIN32
+#include <dirent.h>
+#endif  // _WIN32
+
+#include "ozz/animation/offline/animation_analyzer.h"
+#include "ozz/animation/offline/sampling_access_analyzer.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/options/options.h"
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(
+    path, "Specifies input animation file, or directory to scan recursively",
+    "", true)
+OZZ_OPTIONS_DECLARE_STRING(
+    output, "Specifies report output file, standard output if empty", "",
+    false)
+
+static bool ValidateFormat(const ozz::options::Option& _option,
+                           int /*_argc*/) {
+  const ozz::options::StringOption& option =
+      static_cast<const ozz::options::StringOption&>(_option);
+  const bool valid = std::strcmp(option.value(), "console") == 0 ||
+                     std::strcmp(option.value(), "csv") == 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid format option \"" << option << "\""
+                    << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_STRING_FN(
+    format, "Selects report format. Can be \"console\" or \"csv\".",
+    "console", false, &ValidateFormat)
+
+static bool ValidateTop(const ozz::options::Option& _option, int /*_argc*/) {
+  const ozz::options::IntOption& option =
+      static_cast<const ozz::options::IntOption&>(_option);
+  const bool valid = option.value() >= 0;
+  if (!valid) {
+    ozz::log::Err() << "Invalid top option \"" << option.value()
+                    << "\", must be positive." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_INT_FN(top,
+                           "Number of largest tracks (per animation) and "
+                           "animations to report.",
+                           3, false, &ValidateTop)
+
+static bool ValidateFrequency(const ozz::options::Option& _option,
+                              int /*_argc*/) {
+  const ozz::options::FloatOption& option =
+      static_cast<const ozz::options::FloatOption&>(_option);
+  const bool valid = option.value() > 0.f;
+  if (!valid) {
+    ozz::log::Err() << "Invalid frequency option \"" << option.value()
+                    << "\", must be greater than 0." << std::endl;
+  }
+  return valid;
+}
+
+OZZ_OPTIONS_DECLARE_FLOAT_FN(frequency,
+                             "Specifies the frequency used to sample "
+                             "animations, in frames per second.",
+                             30.f, false, &ValidateFrequency)
+
+OZZ_OPTIONS_DECLARE_FLOAT(tolerance,
+                          "Specifies constant tracks translation and scale "
+                          "tolerance, and rotation tolerance (radian).",
+                          1e-3f, false)
+
+OZZ_OPTIONS_DECLARE_BOOL(access,
+                         "Simulates sampling memory accesses of a forward "
+                         "playback at frequency, for every keys layout.",
+                         false, false)
+
+namespace {
+
+// Keys layouts simulated by access option, and their report names.
+const struct {
+  ozz::animation::offline::SamplingAccessAnalyzer::Layout layout;
+  const char* name;
+} kLayouts[] = {
+    {ozz::animation::offline::SamplingAccessAnalyzer::kSorted, "sorted"},
+    {ozz::animation::offline::SamplingAccessAnalyzer::kPerTrack, "per_track"},
+    {ozz::animation::offline::SamplingAccessAnalyzer::kChunked, "chunked"}};
+
+// Tells if _path is a directory.
+bool IsDirectory(const char* _path) {
+#ifdef _WIN32
+  struct _stat info;
+  return _stat(_path, &info) == 0 && (info.st_mode & _S_IFDIR) != 0;
+#else   // _WIN32
+  struct stat info;
+  return stat(_path, &info) == 0 && S_ISDIR(info.st_mode);
+#endif  // _WIN32
+}
+
+// Lists files of _directory and its sub-directories to _files, sorted so that
+// reports are stable.
+void ListFiles(const ozz::string& _directory,
+               ozz::vector<ozz::string>* _files) {
+  ozz::vector<ozz::string> entries;
+#ifdef _WIN32
+  struct _finddata_t data;
+  const intptr_t handle = _findfirst((_directory + "/*").c_str(), &data);
+  if (handle != -1) {
+    do {
+      entries.push_back(data.name);
+    } while (_findnext(handle, &data) == 0);
+    _findclose(handle);
+  }
+#else   // _WIN32
+  DIR* dir = opendir(_directory.c_str());
+  if (dir) {
+    while (const dirent* entry = readdir(dir)) {
+      entries.push_back(entry->d_name);
+    }
+    closedir(dir);
+  }
+#endif  // _WIN32
+  std::sort(entries.begin(), entries.end());
+  for (const ozz::string& entry : entries) {
+    if (entry == "." || entry == "..") {
+      continue;
+    }
+    const ozz::string path = _directory + "/" + entry;
+    if (IsDirectory(path.c_str())) {
+      ListFiles(path, _files);
+    } else {
+      _files->push_back(path);
+    }
+  }
+}
+
+// Loads an animation from _filename. Returns false if file doesn't contain an
+// animation.
+bool LoadAnimation(const char* _filename,
+                   ozz::animation::Animation* _animation) {
+  ozz::io::File file(_filename, "rb");
+  if (!file.opened()) {
+    ozz::log::Err() << "Failed to open file \"" << _filename << "\"."
+                    << std::endl;
+    return false;
+  }
+  ozz::io::IArchive archive(&file);
+  if (!archive.TestTag<ozz::animation::Animation>()) {
+    ozz::log::LogV() << "Skipping file \"" << _filename
+                     << "\", which doesn't contain an animation."
+                     << std::endl;
+    return false;
+  }
+  archive >> *_animation;
+  return true;
+}
+
+// Analysis of an animation file.
+struct Entry {
+  ozz::string file;
+  ozz::string name;
+  int num_tracks;
+  ozz::animation::offline::AnimationAnalysis analysis;
+  // One per kLayouts, if access option is set.
+  ozz::vector<ozz::animation::offline::SamplingAccessAnalysis> accesses;
+};
+
+// Simulates sampling accesses of a forward playback of _animation, for every
+// keys layout.
+bool AnalyzeAccesses(
+    const ozz::animation::Animation& _animation,
+    ozz::vector<ozz::animation::offline::SamplingAccessAnalysis>* _accesses) {
+  const int num_frames =
+      static_cast<int>(_animation.duration() * OPTIONS_frequency) + 1;
+  ozz::vector<float> ratios;
+  for (int i = 0; i < num_frames; ++i) {
+    ratios.push_back(num_frames > 1 ? static_cast<float>(i) / (num_frames - 1)
+                                    : 0.f);
+  }
+  ozz::animation::offline::SamplingAccessAnalyzer analyzer;
+  _accesses->resize(OZZ_ARRAY_SIZE(kLayouts));
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(kLayouts); ++i) {
+    analyzer.layout = kLayouts[i].layout;
+    if (!analyzer(_animation, make_span(ratios), &(*_accesses)[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Gets per frame average of _value.
+float PerFrame(const ozz::animation::offline::SamplingAccessAnalysis& _access,
+               float _value) {
+  return _access.frames.empty()
+             ? 0.f
+             : _value / static_cast<float>(_access.frames.size());
+}
+
+// Gets the percentage of _size saved compared to _reference.
+float Savings(size_t _reference, size_t _size) {
+  return _reference > 0 ? 100.f * (1.f - static_cast<float>(_size) /
+                                             static_cast<float>(_reference))
+                        : 0.f;
+}
+
+// Gets the indices of the _count largest tracks of _analysis.
+ozz::vector<int> LargestTracks(
+    const ozz::animation::offline::AnimationAnalysis& _analysis, int _count) {
+  ozz::vector<int> indices(_analysis.tracks.size());
+  for (size_t i = 0; i < indices.size(); ++i) {
+    indices[i] = static_cast<int>(i);
+  }
+  const size_t count = std::min(indices.size(), static_cast<size_t>(_count));
+  std::partial_sort(indices.begin(), indices.begin() + count, indices.end(),
+                    [&_analysis](int _a, int _b) {
+                      return _analysis.tracks[_a].size >
+                             _analysis.tracks[_b].size;
+                    });
+  indices.resize(count);
+  return indices;
+}
+
+void ReportConsole(const ozz::vector<Entry>& _entries, std::ostream& _os) {
+  size_t total_size = 0, total_keys = 0, total_constant_savings = 0,
+         total_compact = 0;
+  float total_duration = 0.f;
+  int total_candidates = 0;
+  ozz::vector<size_t> total_tiers;
+
+  for (const Entry& entry : _entries) {
+    const ozz::animation::offline::AnimationAnalysis& analysis =
+        entry.analysis;
+    _os << entry.file << " \"" << entry.name << "\": " << analysis.duration
+        << "s, " << entry.num_tracks << " tracks, " << analysis.size
+        << " bytes, " << analysis.bytes_per_second << " bytes/s"
+        << std::endl;
+    _os << "  keys: " << analysis.keys_size << " bytes" << std::endl;
+    _os << "  constant candidates: " << analysis.num_constant_candidates
+        << ", saves " << analysis.constant_savings << " bytes" << std::endl;
+    _os << "  compact formats: " << analysis.compact_size << " bytes, saves "
+        << Savings(analysis.keys_size, analysis.compact_size) << "%"
+        << std::endl;
+    for (const auto& tier : analysis.tiers) {
+      _os << "  tier " << tier.frequency << "Hz: " << tier.size
+          << " bytes, saves " << Savings(analysis.keys_size, tier.size) << "%"
+          << std::endl;
+    }
+    for (const int track : LargestTracks(analysis, OPTIONS_top)) {
+      const auto& info = analysis.tracks[track];
+      _os << "  track " << track << ": " << info.size << " bytes, "
+          << info.keys_per_second << " keys/s (" << info.translation_keys
+          << " translations, " << info.rotation_keys << " rotations, "
+          << info.scale_keys << " scales)"
+          << (info.constant_translation ? ", constant translation" : "")
+          << (info.constant_rotation ? ", constant rotation" : "")
+          << (info.constant_scale ? ", constant scale" : "") << std::endl;
+    }
+    for (size_t i = 0; i < entry.accesses.size(); ++i) {
+      const auto& access = entry.accesses[i];
+      _os << "  access " << kLayouts[i].name << ": "
+          << PerFrame(access, static_cast<float>(access.bytes))
+          << " bytes/frame, "
+          << PerFrame(access, static_cast<float>(access.lines))
+          << " lines/frame, "
+          << PerFrame(access, static_cast<float>(access.misses))
+          << " misses/frame, " << access.footprint << " bytes footprint"
+          << std::endl;
+    }
+
+    total_size += analysis.size;
+    total_keys += analysis.keys_size;
+    total_duration += analysis.duration;
+    total_candidates += analysis.num_constant_candidates;
+    total_constant_savings += analysis.constant_savings;
+    total_compact += analysis.compact_size;
+    total_tiers.resize(analysis.tiers.size(), 0);
+    for (size_t t = 0; t < analysis.tiers.size(); ++t) {
+      total_tiers[t] += analysis.tiers[t].size;
+    }
+  }
+
+  _os << "Total: " << _entries.size() << " animations, " << total_duration
+      << "s, " << total_size << " bytes, "
+      << (total_duration > 0.f ? total_size / total_duration : 0.f)
+      << " bytes/s" << std::endl;
+  _os << "  keys: " << total_keys << " bytes" << std::endl;
+  _os << "  constant candidates: " << total_candidates << ", saves "
+      << total_constant_savings << " bytes" << std::endl;
+  _os << "  compact formats: " << total_compact << " bytes, saves "
+      << Savings(total_keys, total_compact) << "%" << std::endl;
+  if (!_entries.empty()) {
+    const auto& tiers = _entries.front().analysis.tiers;
+    for (size_t t = 0; t < tiers.size(); ++t) {
+      _os << "  tier " << tiers[t].frequency << "Hz: " << total_tiers[t]
+          << " bytes, saves " << Savings(total_keys, total_tiers[t]) << "%"
+          << std::endl;
+    }
+  }
+
+  // Largest animations.
+  ozz::vector<const Entry*> sorted;
+  for (const Entry& entry : _entries) {
+    sorted.push_back(&entry);
+  }
+  const size_t count =
+      std::min(sorted.size(), static_cast<size_t>(OPTIONS_top));
+  std::partial_sort(sorted.begin(), sorted.begin() + count, sorted.end(),
+                    [](const Entry* _a, const Entry* _b) {
+                      return _a->analysis.size > _b->analysis.size;
+                    });
+  for (size_t i = 0; i < count; ++i) {
+    _os << "  largest " << i << ": " << sorted[i]->file << ", "
+        << sorted[i]->analysis.size << " bytes" << std::endl;
+  }
+}
+
+void ReportCsv(const ozz::vector<Entry>& _entries, std::ostream& _os) {
+  _os << "file,name,duration,tracks,size,bytes_per_second,keys_size,"
+         "constant_candidates,constant_savings,compact_size";
+  if (!_entries.empty()) {
+    for (const auto& tier : _entries.front().analysis.tiers) {
+      _os << ",tier_" << tier.frequency << "hz_size";
+    }
+  }
+  _os << ",largest_track,largest_track_size,largest_track_keys_per_second";
+  if (OPTIONS_access) {
+    for (const auto& layout : kLayouts) {
+      _os << ',' << layout.name << "_bytes_per_frame," << layout.name
+          << "_lines_per_frame," << layout.name << "_misses_per_frame";
+    }
+  }
+  _os << std::endl;
+
+  for (const Entry& entry : _entries) {
+    const ozz::animation::offline::AnimationAnalysis& analysis =
+        entry.analysis;
+    _os << '"' << entry.file << "\",\"" << entry.name << "\","
+        << analysis.duration << ',' << entry.num_tracks << ','
+        << analysis.size << ',' << analysis.bytes_per_second << ','
+        << analysis.keys_size << ',' << analysis.num_constant_candidates
+        << ',' << analysis.constant_savings << ',' << analysis.compact_size;
+    for (const auto& tier : analysis.tiers) {
+      _os << ',' << tier.size;
+    }
+    const ozz::vector<int> largest = LargestTracks(analysis, 1);
+    if (largest.empty()) {
+      _os << ",,,";
+    } else {
+      const auto& info = analysis.tracks[largest[0]];
+      _os << ',' << largest[0] << ',' << info.size << ','
+          << info.keys_per_second;
+    }
+    for (const auto& access : entry.accesses) {
+      _os << ',' << PerFrame(access, static_cast<float>(access.bytes)) << ','
+          << PerFrame(access, static_cast<float>(access.lines)) << ','
+          << PerFrame(access, static_cast<float>(access.misses));
+    }
+    _os << std::endl;
+  }
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0",
+      "Analyzes animations memory footprint and keys density.");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  // Lists input files.
+  ozz::vector<ozz::string> files;
+  if (IsDirectory(OPTIONS_path)) {
+    ListFiles(OPTIONS_path.value(), &files);
+  } else {
+    files.push_back(OPTIONS_path.value());
+  }
+
+  ozz::animation::offline::AnimationAnalyzer analyzer;
+  analyzer.frame_rate = OPTIONS_frequency;
+  analyzer.translation_tolerance = OPTIONS_tolerance;
+  analyzer.rotation_tolerance = OPTIONS_tolerance;
+  analyzer.scale_tolerance = OPTIONS_tolerance;
+
+  // Analyzes all animations.
+  ozz::vector<Entry> entries;
+  for (const ozz::string& file : files) {
+    ozz::animation::Animation animation;
+    if (!LoadAnimation(file.c_str(), &animation)) {
+      continue;
+    }
+    Entry entry;
+    entry.file = file;
+    entry.name = animation.name();
+    entry.num_tracks = animation.num_tracks();
+    if (!analyzer(animation, &entry.analysis)) {
+      ozz::log::Err() << "Failed to analyze animation \"" << file << "\"."
+                      << std::endl;
+      return EXIT_FAILURE;
+    }
+    if (OPTIONS_access && !AnalyzeAccesses(animation, &entry.accesses)) {
+      ozz::log::Err() << "Failed to simulate animation \"" << file
+                      << "\" accesses." << std::endl;
+      return EXIT_FAILURE;
+    }
+    entries.push_back(std::move(entry));
+  }
+  if (entries.empty()) {
+    ozz::log::Err() << "No animation found in \"" << OPTIONS_path.value()
+                    << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // Outputs report.
+  std::ofstream file;
+  if (OPTIONS_output.value()[0] != 0) {
+    file.open(OPTIONS_output.value());
+    if (!file) {
+      ozz::log::Err() << "Failed to open output file \""
+                      << OPTIONS_output.value() << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  std::ostream& os = file.is_open() ? file : std::cout;
+  if (std::strcmp(OPTIONS_format, "csv") == 0) {
+    ReportCsv(entries, os);
+  } else {
+    ReportConsole(entries, os);
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,201 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+// Upgrades ozz archives to the latest version of the objects they contain, so
+// that legacy versions conversion cost isn't paid at load time. Objects are
+// loaded (converted by their Load function) and saved back with the same
+// endianness and compression as the input archive.
+
+#include <cstdlib>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/lod_animation.h"
+#include "ozz/animation/runtime/multi_float_track.h"
+#include "ozz/animation/runtime/segmented_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_lod.h"
+#include "ozz/animation/runtime/track.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/compressed_stream.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/options/options.h"
+
+// Declares command line options.
+OZZ_OPTIONS_DECLARE_STRING(file, "Specifies input archive file", "", true)
+OZZ_OPTIONS_DECLARE_STRING(
+    output, "Specifies output file, input file is upgraded in place if empty",
+    "", false)
+
+namespace {
+
+// Upgrades the next object of _input archive to _output, if it's of type _Ty.
+// Returns false if next object isn't of type _Ty, or if it couldn't be loaded,
+// in which case *_error is set.
+template <typename _Ty>
+bool Upgrade(ozz::io::IArchive& _input, ozz::io::OArchive& _output,
+             bool* _error) {
+  typedef ozz::io::internal::Tag<const _Ty> Tag;
+  const uint32_t current = ozz::io::internal::Version<const _Ty>::kValue;
+
+  // Reads object version, and rewinds.
+  ozz::io::Stream* stream = _input.stream();
+  const int64_t tell = stream->Tell();
+  if (!ozz::io::internal::Tagger<const _Ty>::Validate(_input)) {
+    stream->Seek(tell, ozz::io::Stream::kSet);
+    return false;
+  }
+  uint32_t version = 0;
+  _input >> version;
+  const int64_t content = stream->Tell();
+  stream->Seek(tell, ozz::io::Stream::kSet);
+
+  if (version == 0 || version > current) {
+    ozz::log::Err() << "Unsupported " << Tag::Get() << " version " << version
+                    << "." << std::endl;
+    *_error = true;
+    return false;
+  }
+  if (version == current) {
+    ozz::log::Log() << "Object " << Tag::Get() << " is already at version "
+                    << current << "." << std::endl;
+  } else {
+    ozz::log::Log() << "Upgrading " << Tag::Get() << " from version "
+                    << version << " to " << current << "." << std::endl;
+  }
+
+  // Load functions don't read anything beyond the version when it's not
+  // supported, while a loaded object reads at least one member.
+  _Ty object;
+  _input >> object;
+  if (stream->Tell() == content) {
+    ozz::log::Err() << "Failed to load " << Tag::Get() << " version "
+                    << version << "." << std::endl;
+    *_error = true;
+    return false;
+  }
+  _output << object;
+  return true;
+}
+
+// Upgrades the next object of _input archive, whatever its type.
+bool UpgradeObject(ozz::io::IArchive& _input, ozz::io::OArchive& _output) {
+  using namespace ozz::animation;
+  bool error = false;
+  if (Upgrade<Skeleton>(_input, _output, &error) ||
+      Upgrade<SkeletonLOD>(_input, _output, &error) ||
+      Upgrade<Animation>(_input, _output, &error) ||
+      Upgrade<LODAnimation>(_input, _output, &error) ||
+      Upgrade<SegmentedAnimation>(_input, _output, &error) ||
+      Upgrade<FloatTrack>(_input, _output, &error) ||
+      Upgrade<Float2Track>(_input, _output, &error) ||
+      Upgrade<Float3Track>(_input, _output, &error) ||
+      Upgrade<Float4Track>(_input, _output, &error) ||
+      Upgrade<QuaternionTrack>(_input, _output, &error) ||
+      Upgrade<MultiFloatTrack>(_input, _output, &error)) {
+    return true;
+  }
+  if (!error) {
+    ozz::log::Err() << "Unknown archive object." << std::endl;
+  }
+  return false;
+}
+}  // namespace
+
+int main(int _argc, const char** _argv) {
+  // Parses arguments.
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0",
+      "Upgrades ozz archive objects to their latest version.");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+  const char* output_file = *OPTIONS_output.value() != 0
+                                ? OPTIONS_output.value()
+                                : OPTIONS_file.value();
+
+  // Reads the whole input file, so that it can be upgraded in place.
+  ozz::io::MemoryStream input;
+  {
+    ozz::io::File file(OPTIONS_file, "rb");
+    if (!file.opened()) {
+      ozz::log::Err() << "Failed to open input file \"" << OPTIONS_file
+                      << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    ozz::vector<char> buffer(static_cast<size_t>(file.Size()));
+    if (file.Read(buffer.data(), buffer.size()) != buffer.size() ||
+        input.Write(buffer.data(), buffer.size()) != buffer.size() ||
+        buffer.empty()) {
+      ozz::log::Err() << "Failed to read input file \"" << OPTIONS_file
+                      << "\"." << std::endl;
+      return EXIT_FAILURE;
+    }
+    input.Seek(0, ozz::io::Stream::kSet);
+  }
+
+  // Output keeps input archive endianness and compression.
+  const bool compressed = ozz::io::CompressedStream::Test(&input);
+  ozz::io::MemoryStream output;
+  {
+    ozz::io::IArchive input_archive(&input);
+    const ozz::Endianness native = ozz::GetNativeEndianness();
+    const ozz::Endianness endianness =
+        input_archive.endian_swap()
+            ? (native == ozz::kBigEndian ? ozz::kLittleEndian
+                                         : ozz::kBigEndian)
+            : native;
+    ozz::io::OArchive output_archive(&output, endianness, compressed);
+
+    // Upgrades all objects of the archive.
+    ozz::io::Stream* stream = input_archive.stream();
+    while (static_cast<uint64_t>(stream->Tell()) < stream->Size()) {
+      if (!UpgradeObject(input_archive, output_archive)) {
+        ozz::log::Err() << "Failed to upgrade archive \"" << OPTIONS_file
+                        << "\"." << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  // Writes output file.
+  ozz::vector<char> buffer(static_cast<size_t>(output.Size()));
+  output.Seek(0, ozz::io::Stream::kSet);
+  output.Read(buffer.data(), buffer.size());
+  ozz::io::File file(output_file, "wb");
+  if (!file.opened() ||
+      file.Write(buffer.data(), buffer.size()) != buffer.size()) {
+    ozz::log::Err() << "Failed to write output file \"" << output_file
+                    << "\"." << std::endl;
+    return EXIT_FAILURE;
+  }
+  ozz::log::Log() << "Archive \"" << output_file << "\" upgraded."
+                  << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -32,10 +32,14 @@
 #include <cstring>
 #include <limits>
 
+#include "ozz/base/maths/math_ex.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
 
 #include "ozz/animation/offline/raw_track.h"
 
+#include "ozz/animation/runtime/event_track.h"
+#include "ozz/animation/runtime/multi_float_track.h"
 #include "ozz/animation/runtime/track.h"
 
 namespace ozz {
@@ -92,22 +96,51 @@ void Fixup(_Keyframes* _keyframes) {
   // Nothing to do by default.
   (void)_keyframes;
 }
+
+uint16_t QuantizeTrackRatio(float _ratio) {
+  return static_cast<uint16_t>(std::floor(_ratio * 65535.f + .5f));
+}
+
+// Tells whether consecutive keys remain distinct once their ratio is quantized
+// to 16 bits.
+template <typename _Keyframes>
+bool CanQuantizeTrackRatios(const _Keyframes& _keyframes) {
+  for (size_t i = 1; i < _keyframes.size(); ++i) {
+    if (QuantizeTrackRatio(_keyframes[i].ratio) ==
+        QuantizeTrackRatio(_keyframes[i - 1].ratio)) {
+      return false;
+    }
+  }
+  return true;
+}
 }  // namespace
 
+TrackBuilder::TrackBuilder() : quantize(false) {}
+
 // Ensures _input's validity and allocates _animation.
 // An animation needs to have at least two key frames per joint, the first at
 // t = 0 and the last at t = 1. If at least one of those keys are not
 // in the RawAnimation then the builder creates it.
 template <typename _RawTrack, typename _Track>
 unique_ptr<_Track> TrackBuilder::Build(const _RawTrack& _input) const {
-  // Tests _raw_animation validity.
-  if (!_input.Validate()) {
+  unique_ptr<_Track> track = make_unique<_Track>();
+  if (!Build(_input, track.get())) {
     return unique_ptr<_Track>();
   }
+  return track;
+}
+
+template <typename _RawTrack, typename _Track>
+bool TrackBuilder::Build(const _RawTrack& _input, _Track* _track) const {
+  const memory::TagScope memory_tag(memory::kTagOffline);
+  // Tests _raw_animation validity.
+  if (!_track || !_input.Validate()) {
+    return false;
+  }
 
-  // Everything is fine, allocates and fills the animation.
+  // Everything is fine, fills the track, reusing its buffer if possible.
   // Nothing can fail now.
-  unique_ptr<_Track> track = make_unique<_Track>();
+  _Track* track = _track;
 
   // Copy data to temporary prepared data structure
   typename _RawTrack::Keyframes keyframes;
@@ -126,28 +159,66 @@ unique_ptr<_Track> TrackBuilder::Build(const _RawTrack& _input) const {
   Fixup(&keyframes);
 
   // Allocates output track.
+  const bool quantized = quantize && CanQuantizeTrackRatios(keyframes);
   const size_t name_len = _input.name.size();
-  track->Allocate(keyframes.size(), _input.name.size());
+  track->Allocate(keyframes.size(), _input.name.size(), quantized);
 
   // Copy all keys to output.
-  assert(keyframes.size() == track->ratios_.size() &&
-         keyframes.size() == track->values_.size() &&
+  assert(keyframes.size() == track->num_keys() &&
          keyframes.size() <= track->steps_.size() * 8);
   memset(track->steps_.data(), 0, track->steps_.size_bytes());
   for (size_t i = 0; i < keyframes.size(); ++i) {
     const typename _RawTrack::Keyframe& src_key = keyframes[i];
-    track->ratios_[i] = src_key.ratio;
-    track->values_[i] = src_key.value;
     track->steps_[i / 8] |=
         (src_key.interpolation == RawTrackInterpolation::kStep) << (i & 7);
   }
+  if (!quantized) {
+    for (size_t i = 0; i < keyframes.size(); ++i) {
+      track->ratios_[i] = keyframes[i].ratio;
+      track->values_[i] = keyframes[i].value;
+    }
+  } else {
+    // Values are accessed as an array of components.
+    const int kComponents = _Track::kComponents;
+    static_assert(sizeof(typename _RawTrack::ValueType) ==
+                      kComponents * sizeof(float),
+                  "Values must be made of floats");
+    float min[4] = {0.f, 0.f, 0.f, 0.f}, max[4] = {0.f, 0.f, 0.f, 0.f};
+    for (size_t i = 0; i < keyframes.size(); ++i) {
+      float value[4];
+      std::memcpy(value, &keyframes[i].value, sizeof(keyframes[i].value));
+      for (int c = 0; c < kComponents; ++c) {
+        min[c] = i == 0 ? value[c] : math::Min(min[c], value[c]);
+        max[c] = i == 0 ? value[c] : math::Max(max[c], value[c]);
+      }
+    }
+    float scale[4] = {0.f, 0.f, 0.f, 0.f};
+    for (int c = 0; c < kComponents; ++c) {
+      scale[c] = (max[c] - min[c]) / 65535.f;
+    }
+    track->quantization_offset_ = math::Float4(min[0], min[1], min[2], min[3]);
+    track->quantization_scale_ =
+        math::Float4(scale[0], scale[1], scale[2], scale[3]);
+
+    for (size_t i = 0; i < keyframes.size(); ++i) {
+      track->compact_ratios_[i] = QuantizeTrackRatio(keyframes[i].ratio);
+      float value[4];
+      std::memcpy(value, &keyframes[i].value, sizeof(keyframes[i].value));
+      for (int c = 0; c < kComponents; ++c) {
+        const float normalized =
+            scale[c] > 0.f ? (value[c] - min[c]) / scale[c] : 0.f;
+        track->compact_values_[i * kComponents + c] = static_cast<uint16_t>(
+            math::Clamp(0.f, std::floor(normalized + .5f), 65535.f));
+      }
+    }
+  }
 
   // Copy track's name.
   if (name_len) {
     strcpy(track->name_, _input.name.c_str());
   }
 
-  return track;  // Success.
+  return true;  // Success.
 }
 
 unique_ptr<FloatTrack> TrackBuilder::operator()(
@@ -166,6 +237,22 @@ unique_ptr<Float4Track> TrackBuilder::operator()(
     const RawFloat4Track& _input) const {
   return Build<RawFloat4Track, Float4Track>(_input);
 }
+bool TrackBuilder::operator()(const RawFloatTrack& _input,
+                              FloatTrack* _track) const {
+  return Build(_input, _track);
+}
+bool TrackBuilder::operator()(const RawFloat2Track& _input,
+                              Float2Track* _track) const {
+  return Build(_input, _track);
+}
+bool TrackBuilder::operator()(const RawFloat3Track& _input,
+                              Float3Track* _track) const {
+  return Build(_input, _track);
+}
+bool TrackBuilder::operator()(const RawFloat4Track& _input,
+                              Float4Track* _track) const {
+  return Build(_input, _track);
+}
 
 namespace {
 // Fixes-up successive opposite quaternions that would fail to take the shortest
@@ -203,6 +290,147 @@ unique_ptr<QuaternionTrack> TrackBuilder::operator()(
     const RawQuaternionTrack& _input) const {
   return Build<RawQuaternionTrack, QuaternionTrack>(_input);
 }
+bool TrackBuilder::operator()(const RawQuaternionTrack& _input,
+                              QuaternionTrack* _track) const {
+  return Build(_input, _track);
+}
+
+unique_ptr<MultiFloatTrack> TrackBuilder::operator()(
+    const RawMultiFloatTrack& _input) const {
+  unique_ptr<MultiFloatTrack> track = make_unique<MultiFloatTrack>();
+  if (!(*this)(_input, track.get())) {
+    return unique_ptr<MultiFloatTrack>();
+  }
+  return track;
+}
+
+bool TrackBuilder::operator()(const RawMultiFloatTrack& _input,
+                              MultiFloatTrack* _track) const {
+  const memory::TagScope memory_tag(memory::kTagOffline);
+  // Tests _input validity.
+  if (!_track || !_input.Validate()) {
+    return false;
+  }
+
+  // Lists keyframes, ensuring there's a key frame at the start and end of the
+  // track (required for sampling). Keyframes values aren't copied.
+  struct Key {
+    float ratio;
+    bool step;
+    const float* values;
+  };
+  const ozz::vector<float> identity(_input.num_channels, 0.f);
+  const RawMultiFloatTrack::Keyframes& src = _input.keyframes;
+  ozz::vector<Key> keys;
+  keys.reserve(src.size() + 2);
+  if (src.empty()) {
+    const Key begin = {0.f, false, identity.data()};
+    keys.push_back(begin);
+    const Key end = {1.f, false, identity.data()};
+    keys.push_back(end);
+  } else if (src.size() == 1) {
+    const Key begin = {0.f, false, src.front().values.data()};
+    keys.push_back(begin);
+    const Key end = {1.f, false, src.front().values.data()};
+    keys.push_back(end);
+  } else {
+    if (src.front().ratio != 0.f) {
+      const Key begin = {0.f, false, src.front().values.data()};
+      keys.push_back(begin);
+    }
+    for (size_t i = 0; i < src.size(); ++i) {
+      const Key key = {src[i].ratio,
+                       src[i].interpolation == RawTrackInterpolation::kStep,
+                       src[i].values.data()};
+      keys.push_back(key);
+    }
+    if (src.back().ratio != 1.f) {
+      const Key end = {1.f, false, src.back().values.data()};
+      keys.push_back(end);
+    }
+  }
+
+  // Everything is fine, releases previous track data, then allocates and fills
+  // the track.
+  MultiFloatTrack* track = _track;
+  track->Deallocate();
+  const size_t name_len = _input.name.size();
+  track->Allocate(keys.size(), _input.num_channels, name_len);
+
+  // Copy all keys to output, padding SoA channels values with 0.
+  const size_t stride = track->num_soa_channels() * 4;
+  memset(track->values_.data(), 0, track->values_.size_bytes());
+  memset(track->steps_.data(), 0, track->steps_.size_bytes());
+  for (size_t i = 0; i < keys.size(); ++i) {
+    const Key& key = keys[i];
+    track->ratios_[i] = key.ratio;
+    if (_input.num_channels) {
+      memcpy(&track->values_[i * stride], key.values,
+             _input.num_channels * sizeof(float));
+    }
+    track->steps_[i / 8] |= key.step << (i & 7);
+  }
+
+  // Copy track's name.
+  if (name_len) {
+    strcpy(track->name_, _input.name.c_str());
+  }
+
+  return true;  // Success.
+}
+
+unique_ptr<EventTrack> TrackBuilder::operator()(
+    const RawEventTrack& _input) const {
+  unique_ptr<EventTrack> track = make_unique<EventTrack>();
+  if (!(*this)(_input, track.get())) {
+    return unique_ptr<EventTrack>();
+  }
+  return track;
+}
+
+bool TrackBuilder::operator()(const RawEventTrack& _input,
+                              EventTrack* _track) const {
+  const memory::TagScope memory_tag(memory::kTagOffline);
+  // Tests _input validity.
+  if (!_track || !_input.Validate()) {
+    return false;
+  }
+
+  // Lists quantized toggles.
+  ozz::vector<uint16_t> toggles;
+  bool state = false;
+  for (const RawEventTrack::Keyframe& key : _input.keyframes) {
+    if (key.value == state) {
+      continue;
+    }
+    state = key.value;
+    const uint16_t toggle = static_cast<uint16_t>(
+        std::floor(key.ratio * EventTrack::kMaxToggle + .5f));
+    if (!toggles.empty() && toggles.back() == toggle) {
+      toggles.pop_back();  // Empty window.
+    } else {
+      toggles.push_back(toggle);
+    }
+  }
+
+  // Everything is fine, releases previous track data, then allocates and fills
+  // the track.
+  EventTrack* track = _track;
+  track->Deallocate();
+  const size_t name_len = _input.name.size();
+  track->Allocate(toggles.size(), name_len);
+  if (!toggles.empty()) {
+    memcpy(track->toggles_.data(), toggles.data(),
+           toggles.size() * sizeof(uint16_t));
+  }
+
+  // Copy track's name.
+  if (name_len) {
+    strcpy(track->name_, _input.name.c_str());
+  }
+
+  return true;  // Success.
+}
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
@@ -34,7 +34,9 @@
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
 #include "animation/offline/decimate.h"
 
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/tracking_allocator.h"
 
 #include "ozz/animation/offline/raw_track.h"
 
@@ -46,8 +48,10 @@ namespace animation {
 namespace offline {
 
 // Setup default values (favoring quality).
-TrackOptimizer::TrackOptimizer() : tolerance(1e-3f) {  // 1 mm.
-}
+TrackOptimizer::TrackOptimizer()
+    : tolerance(1e-3f),  // 1 mm.
+      parallel_for(nullptr),
+      parallel_for_user_data(nullptr) {}
 
 namespace {
 
@@ -82,6 +86,7 @@ struct Adapter {
 
 template <typename _Track>
 inline bool Optimize(float _tolerance, const _Track& _input, _Track* _output) {
+  const memory::TagScope memory_tag(memory::kTagOffline);
   if (!_output) {
     return false;
   }
@@ -103,6 +108,54 @@ inline bool Optimize(float _tolerance, const _Track& _input, _Track* _output) {
   // Output animation is always valid though.
   return _output->Validate();
 }
+
+// Shared data of batch optimization tasks, one task per track.
+template <typename _Track>
+struct OptimizeTrackTasks {
+  float tolerance;
+  span<const _Track> inputs;
+  span<_Track> outputs;
+
+  // Success of each task. Every task writes its own element.
+  span<uint8_t> results;
+};
+
+template <typename _Track>
+void OptimizeTrackTask(int _task, void* _data) {
+  const OptimizeTrackTasks<_Track>& tasks =
+      *static_cast<const OptimizeTrackTasks<_Track>*>(_data);
+  tasks.results[_task] =
+      Optimize(tasks.tolerance, tasks.inputs[_task], &tasks.outputs[_task]);
+}
+
+template <typename _Track>
+bool OptimizeTracks(const TrackOptimizer& _optimizer, float _tolerance,
+                   span<const _Track> _inputs, span<_Track> _outputs) {
+  const memory::TagScope memory_tag(memory::kTagOffline);
+  if (_outputs.size() < _inputs.size()) {
+    return false;
+  }
+
+  const int count = static_cast<int>(_inputs.size());
+  ozz::vector<uint8_t> results(_inputs.size());
+  const OptimizeTrackTasks<_Track> tasks = {_tolerance, _inputs, _outputs,
+                                       make_span(results)};
+  void* data = const_cast<void*>(static_cast<const void*>(&tasks));
+  if (_optimizer.parallel_for != nullptr && count > 1) {
+    _optimizer.parallel_for(count, &OptimizeTrackTask<_Track>, data,
+                            _optimizer.parallel_for_user_data);
+  } else {
+    for (int i = 0; i < count; ++i) {
+      OptimizeTrackTask<_Track>(i, data);
+    }
+  }
+
+  bool success = true;
+  for (int i = 0; i < count; ++i) {
+    success &= results[i] != 0;
+  }
+  return success;
+}
 }  // namespace
 
 bool TrackOptimizer::operator()(const RawFloatTrack& _input,
@@ -125,6 +178,27 @@ bool TrackOptimizer::operator()(const RawQuaternionTrack& _input,
                                 RawQuaternionTrack* _output) const {
   return Optimize(1.f - std::cos(.5f * tolerance), _input, _output);
 }
+bool TrackOptimizer::operator()(span<const RawFloatTrack> _inputs,
+                                span<RawFloatTrack> _outputs) const {
+  return OptimizeTracks(*this, tolerance, _inputs, _outputs);
+}
+bool TrackOptimizer::operator()(span<const RawFloat2Track> _inputs,
+                                span<RawFloat2Track> _outputs) const {
+  return OptimizeTracks(*this, tolerance, _inputs, _outputs);
+}
+bool TrackOptimizer::operator()(span<const RawFloat3Track> _inputs,
+                                span<RawFloat3Track> _outputs) const {
+  return OptimizeTracks(*this, tolerance, _inputs, _outputs);
+}
+bool TrackOptimizer::operator()(span<const RawFloat4Track> _inputs,
+                                span<RawFloat4Track> _outputs) const {
+  return OptimizeTracks(*this, tolerance, _inputs, _outputs);
+}
+bool TrackOptimizer::operator()(span<const RawQuaternionTrack> _inputs,
+                                span<RawQuaternionTrack> _outputs) const {
+  return OptimizeTracks(*this, 1.f - std::cos(.5f * tolerance), _inputs,
+                       _outputs);
+}
 }  // namespace offline
 }  // namespace animation
 }  // namespace ozz
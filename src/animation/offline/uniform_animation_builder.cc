@@ -0,0 +1,173 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/uniform_animation_builder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+#include "ozz/animation/runtime/uniform_animation.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+
+const int kComponents = UniformAnimation::kComponents;
+
+// Returns the number of frames that samples _duration at _frame_rate or
+// faster, so that frames are uniformly spread, first and last included.
+int NumFrames(float _duration, float _frame_rate) {
+  return static_cast<int>(std::ceil(_duration * _frame_rate)) + 1;
+}
+
+// Stores _transform components, 4 SoA tracks at a time, to _values.
+void StoreComponents(const math::SoaTransform& _transform, float* _values) {
+  const math::SimdFloat4 components[kComponents] = {
+      _transform.translation.x, _transform.translation.y,
+      _transform.translation.z, _transform.rotation.x,
+      _transform.rotation.y,    _transform.rotation.z,
+      _transform.rotation.w,    _transform.scale.x,
+      _transform.scale.y,       _transform.scale.z};
+  for (int c = 0; c < kComponents; ++c) {
+    math::StorePtrU(components[c], _values + c * 4);
+  }
+}
+}  // namespace
+
+UniformAnimationBuilder::UniformAnimationBuilder()
+    : frame_rate(30.f), min_density(.5f) {}
+
+unique_ptr<UniformAnimation> UniformAnimationBuilder::operator()(
+    const RawAnimation& _input) const {
+  if (!_input.Validate() || !(frame_rate > 0.f)) {
+    return nullptr;
+  }
+
+  const int num_tracks = _input.num_tracks();
+  const int num_frames = NumFrames(_input.duration, frame_rate);
+  const int num_soa_tracks = (num_tracks + 3) / 4;
+  const size_t stride = static_cast<size_t>(num_soa_tracks) * kComponents * 4;
+
+  // Samples all frames first, as quantization needs the range of the whole
+  // clip.
+  ozz::vector<float> values(stride * num_frames);
+  ozz::vector<math::SoaTransform> locals(num_soa_tracks);
+  RawAnimationSampler sampler;
+  if (!sampler.Bind(_input)) {
+    return nullptr;
+  }
+  for (int f = 0; f < num_frames; ++f) {
+    const float time = _input.duration * f / (num_frames - 1);
+    sampler.Sample(time, make_span(locals));
+    for (int i = 0; i < num_soa_tracks; ++i) {
+      StoreComponents(locals[i],
+                      values.data() + f * stride + i * kComponents * 4);
+    }
+  }
+
+  // Keeps each rotation in the hemisphere of the previous frame, so that
+  // frames are interpolated along the shortest path.
+  for (int f = 1; f < num_frames; ++f) {
+    for (int i = 0; i < num_soa_tracks; ++i) {
+      const float* previous = values.data() + (f - 1) * stride +
+                              i * kComponents * 4 + 3 * 4;
+      float* current = values.data() + f * stride + i * kComponents * 4 + 3 * 4;
+      for (int lane = 0; lane < 4; ++lane) {
+        float dot = 0.f;
+        for (int c = 0; c < 4; ++c) {
+          dot += previous[c * 4 + lane] * current[c * 4 + lane];
+        }
+        if (dot < 0.f) {
+          for (int c = 0; c < 4; ++c) {
+            current[c * 4 + lane] = -current[c * 4 + lane];
+          }
+        }
+      }
+    }
+  }
+
+  // Allocates uniform animation.
+  unique_ptr<UniformAnimation> animation = make_unique<UniformAnimation>();
+  animation->Allocate(_input.name.size(), num_tracks, num_frames);
+  animation->duration_ = _input.duration;
+  if (animation->name_) {
+    std::strcpy(animation->name_, _input.name.c_str());
+  }
+
+  // Quantizes every component over its range.
+  for (size_t v = 0; v < stride; ++v) {
+    float min = values[v];
+    float max = values[v];
+    for (int f = 1; f < num_frames; ++f) {
+      min = std::min(min, values[f * stride + v]);
+      max = std::max(max, values[f * stride + v]);
+    }
+    const float step = (max - min) / 65535.f;
+    const float inv_step = step > 0.f ? 1.f / step : 0.f;
+
+    // Ranges are stored as 4 min then 4 steps per component.
+    const size_t component = v / 4;
+    const size_t lane = v % 4;
+    animation->ranges_[component * 8 + lane] = min;
+    animation->ranges_[component * 8 + 4 + lane] = step;
+    for (int f = 0; f < num_frames; ++f) {
+      const float q = (values[f * stride + v] - min) * inv_step + .5f;
+      animation->frames_[f * stride + v] =
+          static_cast<uint16_t>(std::min(q, 65535.f));
+    }
+  }
+
+  return animation;
+}
+
+float UniformAnimationBuilder::KeyDensity(const RawAnimation& _input) const {
+  if (!_input.Validate() || !(frame_rate > 0.f) || _input.tracks.empty()) {
+    return 0.f;
+  }
+  size_t keys = 0;
+  for (const RawAnimation::JointTrack& track : _input.tracks) {
+    keys += track.translations.size() + track.rotations.size() +
+            track.scales.size();
+  }
+  const float values = 3.f * _input.num_tracks() *
+                       NumFrames(_input.duration, frame_rate);
+  return keys / values;
+}
+
+bool UniformAnimationBuilder::IsDense(const RawAnimation& _input) const {
+  return _input.num_tracks() > 0 && KeyDensity(_input) >= min_density;
+}
+}  // namespace offline
+}  // namespace animation
+}  // namespace ozz
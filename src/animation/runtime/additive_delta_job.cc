@@ -0,0 +1,60 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/additive_delta_job.h"
+
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+
+bool AdditiveDeltaJob::Validate() const {
+  bool valid = true;
+  valid &= reference.size() >= input.size();
+  valid &= output.size() >= input.size();
+  return valid;
+}
+
+bool AdditiveDeltaJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  for (size_t i = 0; i < input.size(); ++i) {
+    // Copies inputs locally, so that output can alias any of them.
+    const math::SoaTransform ref = reference[i];
+    const math::SoaTransform in = input[i];
+    math::SoaTransform& delta = output[i];
+    delta.translation = in.translation - ref.translation;
+    delta.rotation = in.rotation * Conjugate(ref.rotation);
+    delta.scale = in.scale / ref.scale;
+  }
+
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -27,6 +27,8 @@
 
 #include "ozz/animation/runtime/animation.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 
@@ -35,82 +37,817 @@
 #include "ozz/base/maths/math_archive.h"
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
 
 // Internal include file
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
 #include "animation/runtime/animation_keyframe.h"
 
 namespace ozz {
+namespace io {
+// Float3 keys archive layout is the same as their memory one: ratio, track and
+// 3 half float values, without padding. So arrays of keys are saved/loaded at
+// once when no endian swap is required.
+static_assert(sizeof(animation::Float3Key) == 12 &&
+                  sizeof(animation::CompactFloat3Key) == 10,
+              "Float3 keys must not be padded to be saved as bulk");
+OZZ_IO_TYPE_NOT_VERSIONABLE(animation::Float3Key)
+OZZ_IO_TYPE_BULK(animation::Float3Key)
+OZZ_IO_TYPE_NOT_VERSIONABLE(animation::CompactFloat3Key)
+OZZ_IO_TYPE_BULK(animation::CompactFloat3Key)
+
+// Saves/loads float3 keys member by member, used when endian swap is required.
+template <typename _Key>
+struct Float3KeyExtern {
+  static void Save(OArchive& _archive, const _Key* _keys, size_t _count) {
+    for (size_t i = 0; i < _count; ++i) {
+      const _Key& key = _keys[i];
+      _archive << key.ratio;
+      _archive << key.track;
+      _archive << MakeArray(key.value);
+    }
+  }
+  static void Load(IArchive& _archive, _Key* _keys, size_t _count,
+                   uint32_t _version) {
+    (void)_version;
+    for (size_t i = 0; i < _count; ++i) {
+      _Key& key = _keys[i];
+      _archive >> key.ratio;
+      _archive >> key.track;
+      _archive >> MakeArray(key.value);
+    }
+  }
+};
+
+template <>
+struct Extern<animation::Float3Key>
+    : Float3KeyExtern<animation::Float3Key> {};
+template <>
+struct Extern<animation::CompactFloat3Key>
+    : Float3KeyExtern<animation::CompactFloat3Key> {};
+}  // namespace io
 
 namespace animation {
 
-Animation::Animation() : duration_(0.f), num_tracks_(0), name_(nullptr) {}
+namespace {
+// Returns a new animation data generation, unique across all animations.
+uint32_t NextGeneration() {
+  static std::atomic<uint32_t> generation(0);
+  return generation.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+}  // namespace
 
-Animation::Animation(Animation&& _other) { *this = std::move(_other); }
+Animation::Animation(memory::Allocator* _allocator)
+    : duration_(0.f),
+      num_tracks_(0),
+      name_(nullptr),
+      allocator_(_allocator),
+      generation_(NextGeneration()),
+      allocation_(nullptr),
+      allocation_size_(0),
+      shared_rotations_(nullptr) {}
+
+Animation::Animation(Animation&& _other) : Animation() {
+  *this = std::move(_other);
+}
 
 Animation& Animation::operator=(Animation&& _other) {
   std::swap(duration_, _other.duration_);
   std::swap(num_tracks_, _other.num_tracks_);
   std::swap(name_, _other.name_);
   std::swap(translations_, _other.translations_);
+  std::swap(compact_translations_, _other.compact_translations_);
   std::swap(rotations_, _other.rotations_);
+  std::swap(compact_rotations_, _other.compact_rotations_);
+  std::swap(packed_rotations_, _other.packed_rotations_);
   std::swap(scales_, _other.scales_);
+  std::swap(compact_scales_, _other.compact_scales_);
+  std::swap(seek_table_, _other.seek_table_);
+  std::swap(translation_previouses_, _other.translation_previouses_);
+  std::swap(rotation_previouses_, _other.rotation_previouses_);
+  std::swap(scale_previouses_, _other.scale_previouses_);
+  std::swap(constant_translations_, _other.constant_translations_);
+  std::swap(constant_rotations_, _other.constant_rotations_);
+  std::swap(constant_scales_, _other.constant_scales_);
+  std::swap(translation_track_index_, _other.translation_track_index_);
+  std::swap(rotation_track_index_, _other.rotation_track_index_);
+  std::swap(scale_track_index_, _other.scale_track_index_);
+  std::swap(translation_tangents_, _other.translation_tangents_);
+  std::swap(scale_tangents_, _other.scale_tangents_);
+  std::swap(allocator_, _other.allocator_);
+  std::swap(allocation_, _other.allocation_);
+  std::swap(allocation_size_, _other.allocation_size_);
+  std::swap(shared_rotations_, _other.shared_rotations_);
+
+  // Data changed for both animations.
+  generation_ = NextGeneration();
+  _other.generation_ = NextGeneration();
 
   return *this;
 }
 
 Animation::~Animation() { Deallocate(); }
 
-void Animation::Allocate(size_t _name_len, size_t _translation_count,
-                         size_t _rotation_count, size_t _scale_count) {
+size_t Animation::BufferSize(const AllocateParams& _params) const {
   // Distributes buffer memory while ensuring proper alignment (serves larger
   // alignment values first).
   static_assert(alignof(Float3Key) >= alignof(QuaternionKey) &&
-                    alignof(QuaternionKey) >= alignof(Float3Key) &&
-                    alignof(Float3Key) >= alignof(char),
+                    alignof(QuaternionKey) >= alignof(PackedQuaternionKey) &&
+                    alignof(PackedQuaternionKey) >= alignof(Float3Key) &&
+                    alignof(Float3Key) >= alignof(int) &&
+                    alignof(int) >= alignof(CompactFloat3Key) &&
+                    alignof(CompactFloat3Key) >=
+                        alignof(CompactQuaternionKey) &&
+                    alignof(CompactQuaternionKey) >= alignof(uint16_t) &&
+                    alignof(uint16_t) >= alignof(uint8_t) &&
+                    alignof(uint8_t) >= alignof(char),
                 "Must serve larger alignment values first)");
 
-  assert(name_ == nullptr && translations_.size() == 0 &&
-         rotations_.size() == 0 && scales_.size() == 0);
+  // Computes overall size of the single buffer for all the data.
+  const size_t translation_count =
+      _params.translation_count + _params.compact_translation_count;
+  const size_t rotation_count = _params.rotation_count +
+                                _params.compact_rotation_count +
+                                _params.packed_rotation_count;
+  const size_t scale_count = _params.scale_count + _params.compact_scale_count;
+  const size_t previous_count =
+      _params.bidirectional ? translation_count + rotation_count + scale_count
+                            : 0;
+  // Track indices store an offset per track (plus one), and an index per key.
+  const size_t num_index_offsets = num_soa_tracks() * 4 + 1;
+  const size_t track_index_size =
+      _params.random_access
+          ? num_index_offsets * 3 + translation_count + rotation_count +
+                scale_count
+          : 0;
+  // Tangents store 3 half floats per translation and scale key.
+  const size_t tangent_count =
+      _params.cubic ? (translation_count + scale_count) * 3 : 0;
+  const size_t buffer_size =
+      (_params.name_len > 0 ? _params.name_len + 1 : 0) +
+      _params.translation_count * sizeof(Float3Key) +
+      _params.rotation_count * sizeof(QuaternionKey) +
+      _params.packed_rotation_count * sizeof(PackedQuaternionKey) +
+      _params.scale_count * sizeof(Float3Key) +
+      _params.seek_table_size * sizeof(int) +
+      track_index_size * sizeof(int) +
+      _params.compact_translation_count * sizeof(CompactFloat3Key) +
+      _params.compact_rotation_count * sizeof(CompactQuaternionKey) +
+      _params.compact_scale_count * sizeof(CompactFloat3Key) +
+      previous_count * sizeof(uint16_t) + tangent_count * sizeof(uint16_t) +
+      _params.num_constant_flags * 3 * sizeof(uint8_t);
+  return buffer_size;
+}
 
-  // Compute overall size and allocate a single buffer for all the data.
-  const size_t buffer_size = (_name_len > 0 ? _name_len + 1 : 0) +
-                             _translation_count * sizeof(Float3Key) +
-                             _rotation_count * sizeof(QuaternionKey) +
-                             _scale_count * sizeof(Float3Key);
-  span<byte> buffer = {static_cast<byte*>(memory::default_allocator()->Allocate(
-                           buffer_size, alignof(Float3Key))),
-                       buffer_size};
+void Animation::Allocate(const AllocateParams& _params) {
+  // Reuses current buffer if it's big enough, so that an animation can be
+  // rebuilt in place without any allocation. Bind() resets all members.
+  const size_t buffer_size = BufferSize(_params);
+  if (allocation_ == nullptr || allocation_size_ < buffer_size) {
+    Deallocate();
+    const memory::TagScope memory_tag(memory::kTagAnimation);
+    memory::Allocator* allocator =
+        allocator_ ? allocator_ : memory::default_allocator();
+    allocation_ = allocator->Allocate(buffer_size, alignof(Float3Key));
+    allocation_size_ = buffer_size;
+  }
+  Bind(_params, {static_cast<byte*>(allocation_), buffer_size});
+}
+
+void Animation::Bind(const AllocateParams& _params, span<byte> _buffer) {
+  generation_ = NextGeneration();
+  span<byte> buffer = _buffer;
+  assert(buffer.size_bytes() == BufferSize(_params));
+  shared_rotations_ = nullptr;
 
   // Fix up pointers. Serves larger alignment values first.
-  translations_ = fill_span<Float3Key>(buffer, _translation_count);
-  rotations_ = fill_span<QuaternionKey>(buffer, _rotation_count);
-  scales_ = fill_span<Float3Key>(buffer, _scale_count);
+  const size_t translation_count =
+      _params.translation_count + _params.compact_translation_count;
+  const size_t rotation_count = _params.rotation_count +
+                                _params.compact_rotation_count +
+                                _params.packed_rotation_count;
+  const size_t scale_count = _params.scale_count + _params.compact_scale_count;
+  const size_t num_index_offsets = num_soa_tracks() * 4 + 1;
+  translations_ = fill_span<Float3Key>(buffer, _params.translation_count);
+  rotations_ = fill_span<QuaternionKey>(buffer, _params.rotation_count);
+  packed_rotations_ =
+      fill_span<PackedQuaternionKey>(buffer, _params.packed_rotation_count);
+  scales_ = fill_span<Float3Key>(buffer, _params.scale_count);
+  seek_table_ = fill_span<int>(buffer, _params.seek_table_size);
+  if (_params.random_access) {
+    translation_track_index_ =
+        fill_span<int>(buffer, num_index_offsets + translation_count);
+    rotation_track_index_ =
+        fill_span<int>(buffer, num_index_offsets + rotation_count);
+    scale_track_index_ = fill_span<int>(buffer, num_index_offsets + scale_count);
+  } else {
+    translation_track_index_ = {};
+    rotation_track_index_ = {};
+    scale_track_index_ = {};
+  }
+  compact_translations_ =
+      fill_span<CompactFloat3Key>(buffer, _params.compact_translation_count);
+  compact_rotations_ =
+      fill_span<CompactQuaternionKey>(buffer, _params.compact_rotation_count);
+  compact_scales_ =
+      fill_span<CompactFloat3Key>(buffer, _params.compact_scale_count);
+  if (_params.bidirectional) {
+    translation_previouses_ = fill_span<uint16_t>(buffer, translation_count);
+    rotation_previouses_ = fill_span<uint16_t>(buffer, rotation_count);
+    scale_previouses_ = fill_span<uint16_t>(buffer, scale_count);
+  } else {
+    translation_previouses_ = {};
+    rotation_previouses_ = {};
+    scale_previouses_ = {};
+  }
+  if (_params.cubic) {
+    translation_tangents_ = fill_span<uint16_t>(buffer, translation_count * 3);
+    scale_tangents_ = fill_span<uint16_t>(buffer, scale_count * 3);
+  } else {
+    translation_tangents_ = {};
+    scale_tangents_ = {};
+  }
+  constant_translations_ =
+      fill_span<uint8_t>(buffer, _params.num_constant_flags);
+  constant_rotations_ = fill_span<uint8_t>(buffer, _params.num_constant_flags);
+  constant_scales_ = fill_span<uint8_t>(buffer, _params.num_constant_flags);
 
   // Let name be nullptr if animation has no name. Allows to avoid allocating
   // this buffer in the constructor of empty animations.
-  name_ =
-      _name_len > 0 ? fill_span<char>(buffer, _name_len + 1).data() : nullptr;
+  name_ = _params.name_len > 0
+              ? fill_span<char>(buffer, _params.name_len + 1).data()
+              : nullptr;
 
   assert(buffer.empty() && "Whole buffer should be consumned");
 }
 
 void Animation::Deallocate() {
-  memory::default_allocator()->Deallocate(
-      as_writable_bytes(translations_).data());
+  generation_ = NextGeneration();
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  allocator->Deallocate(allocation_);
+  allocation_ = nullptr;
+  allocation_size_ = 0;
+  shared_rotations_ = nullptr;
 
   name_ = nullptr;
   translations_ = {};
+  compact_translations_ = {};
   rotations_ = {};
+  compact_rotations_ = {};
+  packed_rotations_ = {};
   scales_ = {};
+  compact_scales_ = {};
+  seek_table_ = {};
+  translation_previouses_ = {};
+  rotation_previouses_ = {};
+  scale_previouses_ = {};
+  constant_translations_ = {};
+  constant_rotations_ = {};
+  constant_scales_ = {};
+  translation_track_index_ = {};
+  rotation_track_index_ = {};
+  scale_track_index_ = {};
+  translation_tangents_ = {};
+  scale_tangents_ = {};
+}
+
+namespace {
+// Fills _index with _keys indices, grouped by track. Keys of a track are
+// already sorted by ratio in _keys, so this is a counting sort.
+template <typename _Key>
+void FillTrackIndex(const span<const _Key>& _keys, int _num_tracks,
+                    span<int> _index) {
+  if (_keys.empty()) {
+    return;  // Index is filled by another keys format.
+  }
+  int* offsets = _index.begin();
+  int* indices = offsets + _num_tracks + 1;
+  assert(_index.end() == indices + _keys.size());
+
+  // Counts keys of each track, shifted by one track.
+  for (const _Key& key : _keys) {
+    ++offsets[key.track + 1];
+  }
+  for (int i = 0; i < _num_tracks; ++i) {
+    offsets[i + 1] += offsets[i];
+  }
+
+  // Dispatches keys, using offsets as track cursors. Once done, offsets[i]
+  // contains the end (aka the begin of the next track) of track i.
+  for (size_t i = 0; i < _keys.size(); ++i) {
+    indices[offsets[_keys[i].track]++] = static_cast<int>(i);
+  }
+  for (int i = _num_tracks; i > 0; --i) {
+    offsets[i] = offsets[i - 1];
+  }
+  offsets[0] = 0;
+}
+}  // namespace
+
+void Animation::FillTrackIndices() {
+  // Offsets are zeroed first, as empty keys buffers are skipped.
+  std::fill(translation_track_index_.begin(), translation_track_index_.end(),
+            0);
+  std::fill(rotation_track_index_.begin(), rotation_track_index_.end(), 0);
+  std::fill(scale_track_index_.begin(), scale_track_index_.end(), 0);
+
+  const int num_tracks = num_soa_tracks() * 4;
+  FillTrackIndex(translations(), num_tracks, translation_track_index_);
+  FillTrackIndex(compact_translations(), num_tracks, translation_track_index_);
+  FillTrackIndex(rotations(), num_tracks, rotation_track_index_);
+  FillTrackIndex(compact_rotations(), num_tracks, rotation_track_index_);
+  FillTrackIndex(packed_rotations(), num_tracks, rotation_track_index_);
+  FillTrackIndex(scales(), num_tracks, scale_track_index_);
+  FillTrackIndex(compact_scales(), num_tracks, scale_track_index_);
+}
+
+int Animation::num_seek_points() const {
+  return static_cast<int>(seek_table_.size()) /
+         internal::SeekPointStride(num_soa_tracks());
 }
 
 size_t Animation::size() const {
+  // Shared rotation keys (and their derived data) are owned by another
+  // animation.
+  const size_t rotations_size =
+      shared_rotations_ ? 0
+                        : rotations_.size_bytes() +
+                              compact_rotations_.size_bytes() +
+                              packed_rotations_.size_bytes() +
+                              rotation_previouses_.size_bytes() +
+                              rotation_track_index_.size_bytes();
   const size_t size = sizeof(*this) + translations_.size_bytes() +
-                      rotations_.size_bytes() + scales_.size_bytes();
+                      compact_translations_.size_bytes() + rotations_size +
+                      scales_.size_bytes() + compact_scales_.size_bytes() +
+                      seek_table_.size_bytes() +
+                      translation_previouses_.size_bytes() +
+                      scale_previouses_.size_bytes() +
+                      constant_translations_.size_bytes() +
+                      constant_rotations_.size_bytes() +
+                      constant_scales_.size_bytes() +
+                      translation_track_index_.size_bytes() +
+                      scale_track_index_.size_bytes() +
+                      translation_tangents_.size_bytes() +
+                      scale_tangents_.size_bytes();
   return size;
 }
 
+namespace {
+template <typename _Ty>
+void CopySpan(const span<_Ty>& _src, const span<_Ty>& _dest) {
+  assert(_src.size() == _dest.size());
+  std::copy(_src.begin(), _src.end(), _dest.begin());
+}
+
+template <typename _Ty>
+bool EqualSpans(const span<_Ty>& _a, const span<_Ty>& _b) {
+  return _a.size() == _b.size() &&
+         (_a.empty() ||
+          std::memcmp(_a.data(), _b.data(), _a.size_bytes()) == 0);
+}
+}  // namespace
+
+void Animation::CopyData(Animation* _dest, bool _rotations) const {
+  if (name_) {
+    std::strcpy(_dest->name_, name_);
+  }
+  CopySpan(translations_, _dest->translations_);
+  CopySpan(compact_translations_, _dest->compact_translations_);
+  CopySpan(scales_, _dest->scales_);
+  CopySpan(compact_scales_, _dest->compact_scales_);
+  CopySpan(seek_table_, _dest->seek_table_);
+  CopySpan(translation_previouses_, _dest->translation_previouses_);
+  CopySpan(scale_previouses_, _dest->scale_previouses_);
+  CopySpan(constant_translations_, _dest->constant_translations_);
+  CopySpan(constant_rotations_, _dest->constant_rotations_);
+  CopySpan(constant_scales_, _dest->constant_scales_);
+  CopySpan(translation_track_index_, _dest->translation_track_index_);
+  CopySpan(scale_track_index_, _dest->scale_track_index_);
+  CopySpan(translation_tangents_, _dest->translation_tangents_);
+  CopySpan(scale_tangents_, _dest->scale_tangents_);
+  if (_rotations) {
+    CopySpan(rotations_, _dest->rotations_);
+    CopySpan(compact_rotations_, _dest->compact_rotations_);
+    CopySpan(packed_rotations_, _dest->packed_rotations_);
+    CopySpan(rotation_previouses_, _dest->rotation_previouses_);
+    CopySpan(rotation_track_index_, _dest->rotation_track_index_);
+  }
+}
+
+bool Animation::ShareRotations(const Animation& _shared) {
+  // Refers to the animation that actually owns the rotation keys.
+  const Animation& owner =
+      _shared.shared_rotations_ ? *_shared.shared_rotations_ : _shared;
+  if (&owner == this || &owner == shared_rotations_) {
+    return true;
+  }
+  if (owner.num_tracks_ != num_tracks_ ||
+      owner.bidirectional() != bidirectional() ||
+      owner.random_access() != random_access() ||
+      !EqualSpans(owner.rotations_, rotations_) ||
+      !EqualSpans(owner.compact_rotations_, compact_rotations_) ||
+      !EqualSpans(owner.packed_rotations_, packed_rotations_) ||
+      !EqualSpans(owner.constant_rotations_, constant_rotations_)) {
+    return false;
+  }
+
+  // Builds an animation with all but rotation keys, which then points to
+  // owner ones. Rotation previouses and track indices are derived from
+  // rotation keys, so they are shared as well.
+  AllocateParams params = GetAllocateParams();
+  params.rotation_count = 0;
+  params.compact_rotation_count = 0;
+  params.packed_rotation_count = 0;
+  Animation variant(allocator_);
+  variant.duration_ = duration_;
+  variant.num_tracks_ = num_tracks_;
+  variant.Allocate(params);
+  CopyData(&variant, false);
+  variant.rotations_ = owner.rotations_;
+  variant.compact_rotations_ = owner.compact_rotations_;
+  variant.packed_rotations_ = owner.packed_rotations_;
+  variant.rotation_previouses_ = owner.rotation_previouses_;
+  variant.rotation_track_index_ = owner.rotation_track_index_;
+  variant.shared_rotations_ = &owner;
+
+  // Previous buffer is released with variant.
+  *this = std::move(variant);
+  return true;
+}
+
+namespace {
+// Header of animation images, followed by animation buffer. Counts are those
+// of Animation::AllocateParams.
+struct alignas(Animation::kImageAlignment) AnimationImageHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size;
+  float duration;
+  int32_t num_tracks;
+  uint32_t name_len;
+  uint32_t translation_count;
+  uint32_t compact_translation_count;
+  uint32_t rotation_count;
+  uint32_t compact_rotation_count;
+  uint32_t packed_rotation_count;
+  uint32_t scale_count;
+  uint32_t compact_scale_count;
+  uint32_t seek_table_size;
+  uint32_t num_constant_flags;
+  uint8_t bidirectional;
+  uint8_t random_access;
+  uint8_t cubic;
+};
+
+// "ozza" characters, in native endianness.
+const uint32_t kAnimationImageMagic = 0x617a7a6f;
+}  // namespace
+
+Animation::AllocateParams Animation::GetAllocateParams() const {
+  AllocateParams params;
+  params.name_len = name_ ? std::strlen(name_) : 0;
+  params.translation_count = translations_.size();
+  params.compact_translation_count = compact_translations_.size();
+  params.rotation_count = rotations_.size();
+  params.compact_rotation_count = compact_rotations_.size();
+  params.packed_rotation_count = packed_rotations_.size();
+  params.scale_count = scales_.size();
+  params.compact_scale_count = compact_scales_.size();
+  params.seek_table_size = seek_table_.size();
+  params.bidirectional = bidirectional();
+  params.num_constant_flags = constant_translations_.size();
+  params.random_access = random_access();
+  params.cubic = cubic();
+  return params;
+}
+
+size_t Animation::image_size() const {
+  return sizeof(AnimationImageHeader) + BufferSize(GetAllocateParams());
+}
+
+bool Animation::ToImage(span<byte> _image) const {
+  if (!IsAligned(_image.data(), kImageAlignment) ||
+      _image.size_bytes() < image_size()) {
+    return false;
+  }
+
+  const AllocateParams params = GetAllocateParams();
+  const size_t buffer_size = BufferSize(params);
+  AnimationImageHeader header = {};
+  header.magic = kAnimationImageMagic;
+  header.version = io::internal::Version<const Animation>::kValue;
+  header.size = static_cast<uint32_t>(sizeof(header) + buffer_size);
+  header.duration = duration_;
+  header.num_tracks = num_tracks_;
+  header.name_len = static_cast<uint32_t>(params.name_len);
+  header.translation_count = static_cast<uint32_t>(params.translation_count);
+  header.compact_translation_count =
+      static_cast<uint32_t>(params.compact_translation_count);
+  header.rotation_count = static_cast<uint32_t>(params.rotation_count);
+  header.compact_rotation_count =
+      static_cast<uint32_t>(params.compact_rotation_count);
+  header.packed_rotation_count =
+      static_cast<uint32_t>(params.packed_rotation_count);
+  header.scale_count = static_cast<uint32_t>(params.scale_count);
+  header.compact_scale_count = static_cast<uint32_t>(params.compact_scale_count);
+  header.seek_table_size = static_cast<uint32_t>(params.seek_table_size);
+  header.num_constant_flags = static_cast<uint32_t>(params.num_constant_flags);
+  header.bidirectional = params.bidirectional;
+  header.random_access = params.random_access;
+  header.cubic = params.cubic;
+  std::memcpy(_image.data(), &header, sizeof(header));
+
+  // The whole buffer is contiguous, starting with translations, unless
+  // rotation keys are shared. In this case data are copied to an animation
+  // bound to the image.
+  if (shared_rotations_) {
+    Animation image;
+    image.num_tracks_ = num_tracks_;
+    image.Bind(params, {_image.data() + sizeof(header), buffer_size});
+    CopyData(&image, true);
+  } else if (buffer_size != 0) {
+    std::memcpy(_image.data() + sizeof(header), translations_.data(),
+                buffer_size);
+  }
+  return true;
+}
+
+bool Animation::FromImage(span<const byte> _image) {
+  // Destroy animation in case it was already used before.
+  Deallocate();
+  duration_ = 0.f;
+  num_tracks_ = 0;
+
+  AnimationImageHeader header;
+  if (!IsAligned(_image.data(), kImageAlignment) ||
+      _image.size_bytes() < sizeof(header)) {
+    log::Err() << "Invalid Animation image buffer." << std::endl;
+    return false;
+  }
+  std::memcpy(&header, _image.data(), sizeof(header));
+  if (header.magic != kAnimationImageMagic) {
+    log::Err() << "Invalid Animation image, or image endianness doesn't match "
+                  "platform."
+               << std::endl;
+    return false;
+  }
+  if (header.version != io::internal::Version<const Animation>::kValue) {
+    log::Err() << "Unsupported Animation image version " << header.version
+               << "." << std::endl;
+    return false;
+  }
+
+  AllocateParams params;
+  params.name_len = header.name_len;
+  params.translation_count = header.translation_count;
+  params.compact_translation_count = header.compact_translation_count;
+  params.rotation_count = header.rotation_count;
+  params.compact_rotation_count = header.compact_rotation_count;
+  params.packed_rotation_count = header.packed_rotation_count;
+  params.scale_count = header.scale_count;
+  params.compact_scale_count = header.compact_scale_count;
+  params.seek_table_size = header.seek_table_size;
+  params.bidirectional = header.bidirectional != 0;
+  params.num_constant_flags = header.num_constant_flags;
+  params.random_access = header.random_access != 0;
+  params.cubic = header.cubic != 0;
+
+  num_tracks_ = header.num_tracks;
+  const size_t buffer_size = BufferSize(params);
+  if (header.num_tracks < 0 ||
+      header.size != sizeof(header) + buffer_size ||
+      _image.size_bytes() < header.size) {
+    log::Err() << "Invalid Animation image size." << std::endl;
+    num_tracks_ = 0;
+    return false;
+  }
+  duration_ = header.duration;
+
+  // Animation data are never written once built, so they can point to the
+  // read-only image.
+  byte* buffer = const_cast<byte*>(_image.data()) + sizeof(header);
+  Bind(params, {buffer, buffer_size});
+  return true;
+}
+
+namespace {
+// Rotation keys archive layout differs from their memory one, as track, largest
+// and sign bit fields are saved as separate members. Keys are thus saved and
+// loaded by chunks, each chunk being written/read at once and encoded/decoded
+// in memory, rather than writing/reading each member through the archive.
+const size_t kRotationKeysChunkSize = 4096;
+
+// Archive size of a rotation key: ratio, track, largest, sign and value.
+template <typename _Key>
+constexpr size_t RotationKeyArchiveSize() {
+  return sizeof(_Key::ratio) + sizeof(uint16_t) + sizeof(uint8_t) +
+         sizeof(uint8_t) + sizeof(_Key::value);
+}
+
+// Writes _count members _src to _dst, advancing it.
+template <typename _Ty>
+inline void WriteMembers(const _Ty* _src, size_t _count, bool _swap,
+                         byte** _dst) {
+  for (size_t i = 0; i < _count; ++i) {
+    const _Ty value = _swap ? EndianSwapper<_Ty>::Swap(_src[i]) : _src[i];
+    std::memcpy(*_dst, &value, sizeof(value));
+    *_dst += sizeof(value);
+  }
+}
+
+// Reads _count members from _src to _dst, advancing _src.
+template <typename _Ty>
+inline void ReadMembers(const byte** _src, size_t _count, bool _swap,
+                        _Ty* _dst) {
+  std::memcpy(_dst, *_src, sizeof(_Ty) * _count);
+  *_src += sizeof(_Ty) * _count;
+  if (_swap) {
+    EndianSwapper<_Ty>::Swap(_dst, _count);
+  }
+}
+
+inline void WriteValue(const int16_t (&_value)[3], bool _swap, byte** _dst) {
+  WriteMembers(_value, 3, _swap, _dst);
+}
+inline void WriteValue(const uint32_t& _value, bool _swap, byte** _dst) {
+  WriteMembers(&_value, 1, _swap, _dst);
+}
+inline void ReadValue(const byte** _src, bool _swap, int16_t (&_value)[3]) {
+  ReadMembers(_src, 3, _swap, _value);
+}
+inline void ReadValue(const byte** _src, bool _swap, uint32_t& _value) {
+  ReadMembers(_src, 1, _swap, &_value);
+}
+
+template <typename _Key>
+void SaveRotationKeys(io::OArchive& _archive, span<_Key> _keys) {
+  const size_t key_size = RotationKeyArchiveSize<_Key>();
+  const size_t chunk_keys = kRotationKeysChunkSize / key_size;
+  const bool swap = _archive.endian_swap();
+  byte chunk[kRotationKeysChunkSize];
+  for (size_t i = 0; i < _keys.size(); i += chunk_keys) {
+    const size_t count = math::Min(chunk_keys, _keys.size() - i);
+    byte* dst = chunk;
+    for (const _Key& key : _keys.subspan(i, count)) {
+      WriteMembers(&key.ratio, 1, swap, &dst);
+      const uint16_t track = key.track;
+      WriteMembers(&track, 1, swap, &dst);
+      const uint8_t largest = key.largest;
+      WriteMembers(&largest, 1, swap, &dst);
+      const uint8_t sign = key.sign;
+      WriteMembers(&sign, 1, swap, &dst);
+      WriteValue(key.value, swap, &dst);
+    }
+    OZZ_IF_DEBUG(size_t size =) _archive.SaveBinary(chunk, count * key_size);
+    assert(size == count * key_size);
+  }
+}
+
+// Decodes _keys from their archive layout at *_src, advancing it.
+template <typename _Key>
+void DecodeRotationKeys(const byte** _src, bool _swap, span<_Key> _keys) {
+  for (_Key& key : _keys) {
+    ReadMembers(_src, 1, _swap, &key.ratio);
+    uint16_t track;
+    ReadMembers(_src, 1, _swap, &track);
+    key.track = track;
+    uint8_t largest;
+    ReadMembers(_src, 1, _swap, &largest);
+    key.largest = largest & 3;
+    uint8_t sign;
+    ReadMembers(_src, 1, _swap, &sign);
+    key.sign = sign & 1;
+    ReadValue(_src, _swap, key.value);
+  }
+}
+
+template <typename _Key>
+void LoadRotationKeys(io::IArchive& _archive, span<_Key> _keys) {
+  const size_t key_size = RotationKeyArchiveSize<_Key>();
+  const size_t chunk_keys = kRotationKeysChunkSize / key_size;
+  const bool swap = _archive.endian_swap();
+  byte chunk[kRotationKeysChunkSize];
+  for (size_t i = 0; i < _keys.size(); i += chunk_keys) {
+    const size_t count = math::Min(chunk_keys, _keys.size() - i);
+    OZZ_IF_DEBUG(size_t size =) _archive.LoadBinary(chunk, count * key_size);
+    assert(size == count * key_size);
+    const byte* src = chunk;
+    DecodeRotationKeys(&src, swap, _keys.subspan(i, count));
+  }
+}
+
+// Float3 keys archive layout matches memory one, so they're loaded at once and
+// their members are swapped in place if required.
+template <typename _Key>
+void LoadFloat3Keys(io::IArchive& _archive, span<_Key> _keys) {
+  OZZ_IF_DEBUG(size_t size =)
+  _archive.LoadBinary(_keys.data(), _keys.size_bytes());
+  assert(size == _keys.size_bytes());
+}
+
+template <typename _Key>
+void SwapFloat3Keys(span<_Key> _keys) {
+  for (_Key& key : _keys) {
+    key.ratio = EndianSwapper<decltype(key.ratio)>::Swap(key.ratio);
+    key.track = EndianSwapper<uint16_t>::Swap(key.track);
+    EndianSwapper<uint16_t>::Swap(key.value, 3);
+  }
+}
+
+// Validates that _keys track indices are in the range of the _num_tracks
+// animation tracks, padded to SoA.
+template <typename _Key>
+bool ValidateKeys(span<_Key> _keys, int _num_tracks) {
+  const int num_tracks = Align(_num_tracks, 4);
+  bool valid = true;
+  for (const _Key& key : _keys) {
+    valid &= key.track < num_tracks;
+  }
+  return valid;
+}
+
+// Validates that _seek_table cursors and cached key indices are in the range
+// of their translation, rotation and scale _counts.
+bool ValidateSeekTable(span<const int> _seek_table, int _num_soa_tracks,
+                       const int32_t (&_counts)[3]) {
+  const int stride = internal::SeekPointStride(_num_soa_tracks);
+  const int num_keys = _num_soa_tracks * 4 * 2;
+  bool valid = true;
+  for (const int* point = _seek_table.begin(); point < _seek_table.end();
+       point += stride) {
+    for (int type = 0; type < 3; ++type) {
+      valid &= point[type] >= 0 && point[type] <= _counts[type];
+      const int* keys = point + 3 + type * num_keys;
+      for (int i = 0; i < num_keys; ++i) {
+        valid &= keys[i] >= 0 && keys[i] < _counts[type];
+      }
+    }
+  }
+  return valid;
+}
+
+// Keys decoding task data. Once read, translations, rotations and scales keys
+// are decoded and validated by 3 independent tasks.
+struct DecodeKeysTask {
+  enum { kTranslations, kRotations, kScales, kCount };
+  span<Float3Key> translations;
+  span<CompactFloat3Key> compact_translations;
+  span<QuaternionKey> rotations;
+  span<CompactQuaternionKey> compact_rotations;
+  span<PackedQuaternionKey> packed_rotations;
+  span<Float3Key> scales;
+  span<CompactFloat3Key> compact_scales;
+
+  // Rotation keys archive data, nullptr if rotation keys were decoded while
+  // reading.
+  const byte* archived_rotations;
+
+  bool swap;
+  int num_tracks;
+  bool valid[kCount];
+};
+
+void DecodeKeys(int _task, void* _data) {
+  DecodeKeysTask& task = *static_cast<DecodeKeysTask*>(_data);
+  switch (_task) {
+    case DecodeKeysTask::kTranslations: {
+      if (task.swap) {
+        SwapFloat3Keys(task.translations);
+        SwapFloat3Keys(task.compact_translations);
+      }
+      task.valid[_task] =
+          ValidateKeys(task.translations, task.num_tracks) &&
+          ValidateKeys(task.compact_translations, task.num_tracks);
+      break;
+    }
+    case DecodeKeysTask::kRotations: {
+      if (task.archived_rotations) {
+        const byte* src = task.archived_rotations;
+        DecodeRotationKeys(&src, task.swap, task.rotations);
+        DecodeRotationKeys(&src, task.swap, task.compact_rotations);
+        DecodeRotationKeys(&src, task.swap, task.packed_rotations);
+      }
+      task.valid[_task] =
+          ValidateKeys(task.rotations, task.num_tracks) &&
+          ValidateKeys(task.compact_rotations, task.num_tracks) &&
+          ValidateKeys(task.packed_rotations, task.num_tracks);
+      break;
+    }
+    case DecodeKeysTask::kScales: {
+      if (task.swap) {
+        SwapFloat3Keys(task.scales);
+        SwapFloat3Keys(task.compact_scales);
+      }
+      task.valid[_task] =
+          ValidateKeys(task.scales, task.num_tracks) &&
+          ValidateKeys(task.compact_scales, task.num_tracks);
+      break;
+    }
+  }
+}
+}  // namespace
+
 void Animation::Save(ozz::io::OArchive& _archive) const {
   _archive << duration_;
   _archive << static_cast<int32_t>(num_tracks_);
@@ -118,37 +855,61 @@ void Animation::Save(ozz::io::OArchive& _archive) const {
   const size_t name_len = name_ ? std::strlen(name_) : 0;
   _archive << static_cast<int32_t>(name_len);
 
-  const ptrdiff_t translation_count = translations_.size();
+  const ptrdiff_t translation_count =
+      translations_.size() + compact_translations_.size();
   _archive << static_cast<int32_t>(translation_count);
-  const ptrdiff_t rotation_count = rotations_.size();
+  const ptrdiff_t rotation_count = rotations_.size() +
+                                   compact_rotations_.size() +
+                                   packed_rotations_.size();
   _archive << static_cast<int32_t>(rotation_count);
-  const ptrdiff_t scale_count = scales_.size();
+  const ptrdiff_t scale_count = scales_.size() + compact_scales_.size();
   _archive << static_cast<int32_t>(scale_count);
+  const ptrdiff_t seek_table_size = seek_table_.size();
+  _archive << static_cast<int32_t>(seek_table_size);
+  _archive << bidirectional();
+
+  // Rotation keys format: 0 for QuaternionKey, 1 for CompactQuaternionKey and
+  // 2 for PackedQuaternionKey.
+  const uint8_t rotation_format = !compact_rotations_.empty()  ? 1
+                                  : !packed_rotations_.empty() ? 2
+                                                               : 0;
+  _archive << rotation_format;
+
+  // Translation and scale keys formats: 0 for Float3Key, 1 for
+  // CompactFloat3Key.
+  const uint8_t translation_format = !compact_translations_.empty();
+  _archive << translation_format;
+  const uint8_t scale_format = !compact_scales_.empty();
+  _archive << scale_format;
+  const ptrdiff_t num_constant_flags = constant_translations_.size();
+  _archive << static_cast<int32_t>(num_constant_flags);
+  _archive << random_access();
+  _archive << cubic();
 
   _archive << ozz::io::MakeArray(name_, name_len);
 
-  for (const Float3Key& key : translations_) {
-    _archive << key.ratio;
-    _archive << key.track;
-    _archive << ozz::io::MakeArray(key.value);
-  }
+  _archive << ozz::io::MakeArray(translations_);
+  _archive << ozz::io::MakeArray(compact_translations_);
 
-  for (const QuaternionKey& key : rotations_) {
-    _archive << key.ratio;
-    uint16_t track = key.track;
-    _archive << track;
-    uint8_t largest = key.largest;
-    _archive << largest;
-    bool sign = key.sign;
-    _archive << sign;
-    _archive << ozz::io::MakeArray(key.value);
-  }
+  SaveRotationKeys(_archive, rotations_);
+  SaveRotationKeys(_archive, compact_rotations_);
+  SaveRotationKeys(_archive, packed_rotations_);
 
-  for (const Float3Key& key : scales_) {
-    _archive << key.ratio;
-    _archive << key.track;
-    _archive << ozz::io::MakeArray(key.value);
-  }
+  _archive << ozz::io::MakeArray(scales_);
+  _archive << ozz::io::MakeArray(compact_scales_);
+
+  _archive << ozz::io::MakeArray(seek_table_);
+
+  _archive << ozz::io::MakeArray(translation_previouses_);
+  _archive << ozz::io::MakeArray(rotation_previouses_);
+  _archive << ozz::io::MakeArray(scale_previouses_);
+
+  _archive << ozz::io::MakeArray(constant_translations_);
+  _archive << ozz::io::MakeArray(constant_rotations_);
+  _archive << ozz::io::MakeArray(constant_scales_);
+
+  _archive << ozz::io::MakeArray(translation_tangents_);
+  _archive << ozz::io::MakeArray(scale_tangents_);
 }
 
 void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
@@ -157,8 +918,13 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   duration_ = 0.f;
   num_tracks_ = 0;
 
-  // No retro-compatibility with anterior versions.
-  if (_version != 6) {
+  // No retro-compatibility with versions anterior to 6. Version 6 is loaded
+  // without seek table, versions 6 and 7 without previous keys offsets,
+  // versions 6 to 8 with default rotation keys format, versions 6 to 9 with
+  // default translation and scale keys format, versions 6 to 10 without
+  // constant tracks flags, versions 6 to 11 without track indices, versions 6
+  // to 12 without keys tangents.
+  if (_version < 6 || _version > 13) {
     log::Err() << "Unsupported Animation version " << _version << "."
                << std::endl;
     return;
@@ -178,39 +944,196 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   _archive >> rotation_count;
   int32_t scale_count;
   _archive >> scale_count;
+  int32_t seek_table_size = 0;
+  if (_version >= 7) {
+    _archive >> seek_table_size;
+  }
+  bool bidirectional = false;
+  if (_version >= 8) {
+    _archive >> bidirectional;
+  }
+
+  uint8_t rotation_format = 0;
+  if (_version >= 9) {
+    _archive >> rotation_format;
+    if (rotation_format > 2) {
+      log::Err() << "Unsupported Animation rotation format "
+                 << static_cast<int>(rotation_format) << "." << std::endl;
+      return;
+    }
+  }
+
+  uint8_t translation_format = 0;
+  uint8_t scale_format = 0;
+  if (_version >= 10) {
+    _archive >> translation_format;
+    _archive >> scale_format;
+    if (translation_format > 1 || scale_format > 1) {
+      log::Err() << "Unsupported Animation translation or scale format."
+                 << std::endl;
+      return;
+    }
+  }
+  int32_t num_constant_flags = 0;
+  if (_version >= 11) {
+    _archive >> num_constant_flags;
+  }
+  bool random_access = false;
+  if (_version >= 12) {
+    _archive >> random_access;
+  }
+  bool cubic = false;
+  if (_version >= 13) {
+    _archive >> cubic;
+  }
+
+  // Counts are used to size allocations, so negative ones are rejected.
+  if (num_tracks < 0 || name_len < 0 || translation_count < 0 ||
+      rotation_count < 0 || scale_count < 0 || num_constant_flags < 0) {
+    log::Err() << "Invalid Animation negative count." << std::endl;
+    duration_ = 0.f;
+    num_tracks_ = 0;
+    return;
+  }
+
+  // Seek table must be made of complete seek points, as sampling indexes it
+  // by seek point stride.
+  const int num_soa_tracks = (num_tracks + 3) / 4;
+  if (seek_table_size < 0 ||
+      seek_table_size % internal::SeekPointStride(num_soa_tracks) != 0) {
+    log::Err() << "Invalid Animation seek table size " << seek_table_size
+               << "." << std::endl;
+    duration_ = 0.f;
+    num_tracks_ = 0;
+    return;
+  }
+
+  // Constant flags, when present, are read by sampling for every SoA track.
+  if (num_constant_flags != 0 &&
+      num_constant_flags != (num_soa_tracks + 7) / 8) {
+    log::Err() << "Invalid Animation constant flags count "
+               << num_constant_flags << "." << std::endl;
+    duration_ = 0.f;
+    num_tracks_ = 0;
+    return;
+  }
 
-  Allocate(name_len, translation_count, rotation_count, scale_count);
+  const AllocateParams params = {
+      static_cast<size_t>(name_len),
+      static_cast<size_t>(translation_format == 0 ? translation_count : 0),
+      static_cast<size_t>(translation_format == 1 ? translation_count : 0),
+      static_cast<size_t>(rotation_format == 0 ? rotation_count : 0),
+      static_cast<size_t>(rotation_format == 1 ? rotation_count : 0),
+      static_cast<size_t>(rotation_format == 2 ? rotation_count : 0),
+      static_cast<size_t>(scale_format == 0 ? scale_count : 0),
+      static_cast<size_t>(scale_format == 1 ? scale_count : 0),
+      static_cast<size_t>(seek_table_size),
+      bidirectional,
+      static_cast<size_t>(num_constant_flags),
+      random_access,
+      cubic};
+  Allocate(params);
 
   if (name_) {  // nullptr name_ is supported.
     _archive >> ozz::io::MakeArray(name_, name_len);
     name_[name_len] = 0;
   }
 
-  for (Float3Key& key : translations_) {
-    _archive >> key.ratio;
-    _archive >> key.track;
-    _archive >> ozz::io::MakeArray(key.value);
+  // Keys are read serially, and then decoded and validated by independent
+  // tasks, dispatched through archive parallel_for hook. When the hook is
+  // set, rotation keys are read at once, to be decoded by their task.
+  DecodeKeysTask task;
+  task.translations = translations_;
+  task.compact_translations = compact_translations_;
+  task.rotations = rotations_;
+  task.compact_rotations = compact_rotations_;
+  task.packed_rotations = packed_rotations_;
+  task.scales = scales_;
+  task.compact_scales = compact_scales_;
+  task.archived_rotations = nullptr;
+  task.swap = _archive.endian_swap();
+  task.num_tracks = num_tracks_;
+
+  LoadFloat3Keys(_archive, translations_);
+  LoadFloat3Keys(_archive, compact_translations_);
+
+  memory::Allocator* allocator = memory::default_allocator();
+  byte* archived_rotations = nullptr;
+  if (_archive.parallel_for()) {
+    const size_t size =
+        rotations_.size() * RotationKeyArchiveSize<QuaternionKey>() +
+        compact_rotations_.size() *
+            RotationKeyArchiveSize<CompactQuaternionKey>() +
+        packed_rotations_.size() *
+            RotationKeyArchiveSize<PackedQuaternionKey>();
+    archived_rotations = static_cast<byte*>(allocator->Allocate(size, 1));
+    OZZ_IF_DEBUG(size_t read =) _archive.LoadBinary(archived_rotations, size);
+    assert(read == size);
+    task.archived_rotations = archived_rotations;
+  } else {
+    LoadRotationKeys(_archive, rotations_);
+    LoadRotationKeys(_archive, compact_rotations_);
+    LoadRotationKeys(_archive, packed_rotations_);
   }
 
-  for (QuaternionKey& key : rotations_) {
-    _archive >> key.ratio;
-    uint16_t track;
-    _archive >> track;
-    key.track = track;
-    uint8_t largest;
-    _archive >> largest;
-    key.largest = largest & 3;
-    bool sign;
-    _archive >> sign;
-    key.sign = sign & 1;
-    _archive >> ozz::io::MakeArray(key.value);
+  LoadFloat3Keys(_archive, scales_);
+  LoadFloat3Keys(_archive, compact_scales_);
+
+  _archive >> ozz::io::MakeArray(seek_table_);
+
+  _archive >> ozz::io::MakeArray(translation_previouses_);
+  _archive >> ozz::io::MakeArray(rotation_previouses_);
+  _archive >> ozz::io::MakeArray(scale_previouses_);
+
+  _archive >> ozz::io::MakeArray(constant_translations_);
+  _archive >> ozz::io::MakeArray(constant_rotations_);
+  _archive >> ozz::io::MakeArray(constant_scales_);
+
+  _archive >> ozz::io::MakeArray(translation_tangents_);
+  _archive >> ozz::io::MakeArray(scale_tangents_);
+
+  _archive.RunTasks(DecodeKeysTask::kCount, &DecodeKeys, &task);
+  allocator->Deallocate(archived_rotations);
+  for (bool valid : task.valid) {
+    if (!valid) {
+      log::Err() << "Invalid Animation keys track index." << std::endl;
+      Deallocate();
+      duration_ = 0.f;
+      num_tracks_ = 0;
+      return;
+    }
+  }
+  const int32_t counts[] = {translation_count, rotation_count, scale_count};
+  if (!ValidateSeekTable(seek_table_, num_soa_tracks, counts)) {
+    log::Err() << "Invalid Animation seek table key index." << std::endl;
+    Deallocate();
+    duration_ = 0.f;
+    num_tracks_ = 0;
+    return;
+  }
+
+  // Track indices are rebuilt rather than serialized.
+  if (random_access) {
+    FillTrackIndices();
   }
+}
 
-  for (Float3Key& key : scales_) {
-    _archive >> key.ratio;
-    _archive >> key.track;
-    _archive >> ozz::io::MakeArray(key.value);
+bool Animation::Reload(ozz::io::IArchive& _archive) {
+  if (!_archive.TestTag<Animation>()) {
+    return false;
   }
+
+  // Loads to a temporary animation, so current data are kept if loading
+  // fails. Failed loads leave the animation unallocated.
+  Animation reloaded(allocator_);
+  _archive >> reloaded;
+  if (!reloaded.allocation_) {
+    return false;
+  }
+
+  // Previous data are released with reloaded.
+  *this = std::move(reloaded);
+  return true;
 }
 }  // namespace animation
 }  // namespace ozz
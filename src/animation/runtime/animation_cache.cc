@@ -0,0 +1,243 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/animation_cache.h"
+
+#include <cassert>
+#include <chrono>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/io/async_load.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+struct AnimationCache::Clip {
+  typedef std::chrono::steady_clock Clock;
+
+  // Records load completion time, from the thread the load completed on.
+  static void OnLoaded(io::AsyncLoad<Animation>*, io::AsyncStatus,
+                       void* _user_data) {
+    static_cast<Clip*>(_user_data)->completed = Clock::now();
+  }
+
+  ozz::string filename;
+  io::AsyncLoad<Animation> load;
+  ClipState state = kUnloaded;
+
+  // Animation size, accounted in resident size.
+  size_t size = 0;
+
+  // Last frame the clip was used.
+  unsigned int last_used = 0;
+
+  // Least recently used list links, -1 at list ends.
+  int prev = -1;
+  int next = -1;
+
+  Clock::time_point requested;
+  Clock::time_point completed;
+};
+
+AnimationCache::AnimationCache(io::AsyncReader* _reader, size_t _budget)
+    : reader_(_reader),
+      budget_(_budget),
+      resident_size_(0),
+      num_resident_(0),
+      frame_(0),
+      lru_head_(-1),
+      lru_tail_(-1) {
+  ResetStats();
+}
+
+AnimationCache::~AnimationCache() {
+  assert(pending_.empty() && "Cache destroyed while loads are pending.");
+  for (Clip* clip : clips_) {
+    ozz::Delete(clip);
+  }
+}
+
+int AnimationCache::Register(const char* _filename) {
+  if (!_filename) {
+    return -1;
+  }
+  Clip* clip = ozz::New<Clip>();
+  clip->filename = _filename;
+  clips_.push_back(clip);
+  return static_cast<int>(clips_.size()) - 1;
+}
+
+const Animation* AnimationCache::Acquire(int _clip) {
+  if (_clip < 0 || _clip >= num_clips()) {
+    return nullptr;
+  }
+  Clip& clip = *clips_[_clip];
+  clip.last_used = frame_;
+  if (clip.state == kResident) {
+    ++stats_.hits;
+    // Moves the clip to the most recently used end.
+    Unlink(_clip);
+    LinkBack(_clip);
+    return &clip.load.object();
+  }
+  ++stats_.misses;
+  Load(_clip);
+  return nullptr;
+}
+
+bool AnimationCache::Prefetch(int _clip) {
+  if (_clip < 0 || _clip >= num_clips()) {
+    return false;
+  }
+  Clip& clip = *clips_[_clip];
+  clip.last_used = frame_;
+  if (clip.state == kResident) {
+    Unlink(_clip);
+    LinkBack(_clip);
+    return true;
+  }
+  return Load(_clip);
+}
+
+bool AnimationCache::Load(int _clip) {
+  Clip& clip = *clips_[_clip];
+  if (clip.state != kUnloaded) {
+    return clip.state != kFailed;
+  }
+  clip.requested = Clip::Clock::now();
+  if (!clip.load.Start(reader_, clip.filename.c_str(), &Clip::OnLoaded,
+                       &clip)) {
+    clip.state = kFailed;
+    ++stats_.failures;
+    return false;
+  }
+  clip.state = kLoading;
+  pending_.push_back(_clip);
+  return true;
+}
+
+void AnimationCache::Update() {
+  // Integrates completed loads.
+  size_t remaining = 0;
+  for (size_t i = 0; i < pending_.size(); ++i) {
+    const int index = pending_[i];
+    Clip& clip = *clips_[index];
+    const io::AsyncStatus status = clip.load.status();
+    if (status == io::kAsyncPending) {
+      pending_[remaining++] = index;
+      continue;
+    }
+
+    const float latency =
+        std::chrono::duration<float>(clip.completed - clip.requested).count();
+    ++stats_.loads;
+    stats_.total_load_latency += latency;
+    if (latency > stats_.max_load_latency) {
+      stats_.max_load_latency = latency;
+    }
+
+    if (status == io::kAsyncSucceeded) {
+      clip.state = kResident;
+      clip.size = clip.load.object().size();
+      resident_size_ += clip.size;
+      ++num_resident_;
+      LinkBack(index);
+    } else {
+      clip.state = kFailed;
+      ++stats_.failures;
+    }
+  }
+  pending_.resize(remaining);
+
+  // Evicts least recently used clips, sparing the ones used since the last
+  // update.
+  while (resident_size_ > budget_ && lru_head_ != -1) {
+    const int index = lru_head_;
+    Clip& clip = *clips_[index];
+    if (clip.last_used == frame_) {
+      break;
+    }
+    Unlink(index);
+    clip.load.object() = Animation();
+    clip.state = kUnloaded;
+    resident_size_ -= clip.size;
+    clip.size = 0;
+    --num_resident_;
+    ++stats_.evictions;
+  }
+
+  ++frame_;
+}
+
+AnimationCache::ClipState AnimationCache::state(int _clip) const {
+  if (_clip < 0 || _clip >= num_clips()) {
+    return kUnloaded;
+  }
+  return clips_[_clip]->state;
+}
+
+void AnimationCache::ResetStats() {
+  stats_.hits = 0;
+  stats_.misses = 0;
+  stats_.loads = 0;
+  stats_.failures = 0;
+  stats_.evictions = 0;
+  stats_.total_load_latency = 0.f;
+  stats_.max_load_latency = 0.f;
+}
+
+void AnimationCache::Unlink(int _clip) {
+  Clip& clip = *clips_[_clip];
+  if (clip.prev != -1) {
+    clips_[clip.prev]->next = clip.next;
+  } else {
+    lru_head_ = clip.next;
+  }
+  if (clip.next != -1) {
+    clips_[clip.next]->prev = clip.prev;
+  } else {
+    lru_tail_ = clip.prev;
+  }
+  clip.prev = -1;
+  clip.next = -1;
+}
+
+void AnimationCache::LinkBack(int _clip) {
+  Clip& clip = *clips_[_clip];
+  clip.prev = lru_tail_;
+  clip.next = -1;
+  if (lru_tail_ != -1) {
+    clips_[lru_tail_]->next = _clip;
+  } else {
+    lru_head_ = _clip;
+  }
+  lru_tail_ = _clip;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -54,6 +54,15 @@ struct OZZ_ANIMATION_DLL Float3Key {
   uint16_t value[3];
 };
 
+// Defines the compact float3 key frame type, where the ratio is quantized to 16
+// bits (unsigned normalized, see KeyRatio()) instead of a 32 bits float. Values
+// are stored as Float3Key ones, for a total of 8 bytes per key.
+struct OZZ_ANIMATION_DLL CompactFloat3Key {
+  uint16_t ratio;
+  uint16_t track;
+  uint16_t value[3];
+};
+
 // Defines the rotation key frame type.
 // Rotation value is a quaternion. Quaternion are normalized, which means each
 // component is in range [0:1]. This property allows to quantize the 3
@@ -77,6 +86,127 @@ struct OZZ_ANIMATION_DLL QuaternionKey {
   int16_t value[3];      // The quantized value of the 3 smallest components.
 };
 
+// Defines compact rotation key frame types, where the ratio is quantized to 16
+// bits (unsigned normalized), instead of a 32 bits float. Quaternion
+// compression scheme is the same as QuaternionKey.
+// CompactQuaternionKey uses 48 bits for the 3 smallest components (16 bits
+// each), for a total of 10 bytes per key.
+struct OZZ_ANIMATION_DLL CompactQuaternionKey {
+  uint16_t ratio;        // Quantized ratio, see KeyRatio().
+  uint16_t track : 13;   // The track this key frame belongs to.
+  uint16_t largest : 2;  // The largest component of the quaternion.
+  uint16_t sign : 1;     // The sign of the largest component. 1 for negative.
+  int16_t value[3];      // The quantized value of the 3 smallest components.
+};
+
+// PackedQuaternionKey quantizes the 3 smallest components to 11-11-10 bits,
+// packed in 32 bits, for a total of 8 bytes per key.
+struct OZZ_ANIMATION_DLL PackedQuaternionKey {
+  uint16_t ratio;        // Quantized ratio, see KeyRatio().
+  uint16_t track : 13;   // The track this key frame belongs to.
+  uint16_t largest : 2;  // The largest component of the quaternion.
+  uint16_t sign : 1;     // The sign of the largest component. 1 for negative.
+  uint32_t value;        // The 3 smallest components packed as 11-11-10 bits.
+};
+
+// Defines TimelineAnimation key value types. Timeline keys don't store ratio
+// nor track index, as they're shared by all tracks through the timeline frames
+// row and per track presence bits. Values are compressed with the same scheme
+// as Float3Key and QuaternionKey.
+struct OZZ_ANIMATION_DLL TimelineFloat3Key {
+  uint16_t value[3];
+};
+
+struct OZZ_ANIMATION_DLL TimelineQuaternionKey {
+  uint16_t largest : 2;  // The largest component of the quaternion.
+  uint16_t sign : 1;     // The sign of the largest component. 1 for negative.
+  int16_t value[3];      // The quantized value of the 3 smallest components.
+};
+
+namespace internal {
+// Quantization factor of 16 bits ratios.
+constexpr float kRatioQuantization = 65535.f;
+
+// Gets key ratio as a float, whatever is the key storage format.
+template <typename _Key>
+inline float KeyRatio(const _Key& _key) {
+  return _key.ratio;
+}
+inline float KeyRatio(const CompactFloat3Key& _key) {
+  return _key.ratio / kRatioQuantization;
+}
+inline float KeyRatio(const CompactQuaternionKey& _key) {
+  return _key.ratio / kRatioQuantization;
+}
+inline float KeyRatio(const PackedQuaternionKey& _key) {
+  return _key.ratio / kRatioQuantization;
+}
+
+// Quaternion keys store the 3 smallest components of the quaternion as signed
+// integers. The 3 smallest are pre-multiplied by sqrt(2) and quantized using
+// QuaternionKeyQuantization<Key>::kScale, so they can be restored uniformly.
+template <typename _Key>
+struct QuaternionKeyQuantization {
+  static constexpr int kScale = 32767;
+};
+// 11-11-10 packing uses different quantization factors per components. The
+// common scale allows to restore them (exactly) as if they were quantized with
+// the same factor.
+template <>
+struct QuaternionKeyQuantization<PackedQuaternionKey> {
+  static constexpr int kScale11 = 1023;
+  static constexpr int kScale10 = 511;
+  static constexpr int kScale = kScale11 * kScale10;
+};
+
+// Unpacks quaternion key values, quantized according to
+// QuaternionKeyQuantization<Key>::kScale.
+template <typename _Key>
+inline void UnpackQuaternionKey(const _Key& _key, int _values[3]) {
+  _values[0] = _key.value[0];
+  _values[1] = _key.value[1];
+  _values[2] = _key.value[2];
+}
+inline void UnpackQuaternionKey(const PackedQuaternionKey& _key,
+                                int _values[3]) {
+  typedef QuaternionKeyQuantization<PackedQuaternionKey> Quantization;
+  // Sign extends each component by shifting it to the most significant bits.
+  const uint32_t value = _key.value;
+  _values[0] = (static_cast<int32_t>(value) >> 21) * Quantization::kScale10;
+  _values[1] =
+      (static_cast<int32_t>(value << 11) >> 21) * Quantization::kScale10;
+  _values[2] =
+      (static_cast<int32_t>(value << 22) >> 22) * Quantization::kScale11;
+}
+}  // namespace internal
+
+// Defines the layout of animation seek table. Each seek point stores the state
+// of a SamplingJob::Context at seek point ratio: translation, rotation and
+// scale cursors first, followed by translation, rotation and scale cached key
+// indices (2 per track). Seek point _i is located at ratio
+// (_i + 1) / (num_points + 1).
+namespace internal {
+inline int SeekPointStride(int _num_soa_tracks) {
+  return 3 + 3 * _num_soa_tracks * 4 * 2;
+}
+inline float SeekPointRatio(int _point, int _num_points) {
+  return static_cast<float>(_point + 1) / static_cast<float>(_num_points + 1);
+}
+// Returns the index of the last seek point located before or at _ratio, or -1
+// if there's none.
+inline int SeekPointIndex(float _ratio, int _num_points) {
+  const int index =
+      static_cast<int>(_ratio * static_cast<float>(_num_points + 1)) - 1;
+  if (index >= _num_points) {
+    return _num_points - 1;
+  }
+  // Guards against float imprecision of the multiplication.
+  if (index >= 0 && SeekPointRatio(index, _num_points) > _ratio) {
+    return index - 1;
+  }
+  return index;
+}
+}  // namespace internal
 }  // namespace animation
 }  // namespace ozz
 #endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_KEYFRAME_H_
@@ -0,0 +1,322 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/animation_stream.h"
+
+#include <atomic>
+#include <cassert>
+#include <new>
+#include <thread>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/async_load.h"
+#include "ozz/base/io/compressed_stream.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Defines segments loading states.
+enum SegmentState {
+  kUnloaded,
+  kLoading,   // Asynchronous load is pending.
+  kResident,  // Segment animation can be sampled.
+  kFailed,    // Asynchronous load failed, to be reported by Update().
+};
+}  // namespace
+
+// A segment state is written with release semantic once its animation is
+// decoded, and read with acquire semantic before accessing the animation.
+struct AnimationStream::Segment {
+  AnimationStream* stream;
+  int index;
+  std::atomic<int> state;
+};
+
+AnimationStream::AnimationStream()
+    : lookahead(1), stream_(nullptr), reader_(nullptr), segments_(nullptr) {}
+
+AnimationStream::~AnimationStream() { Close(); }
+
+bool AnimationStream::Open(io::Stream* _stream) {
+  Close();
+
+  if (!_stream || !_stream->opened()) {
+    log::Err() << "Invalid stream." << std::endl;
+    return false;
+  }
+  if (!OpenHeader(_stream)) {
+    return false;
+  }
+  stream_ = _stream;
+  return true;
+}
+
+bool AnimationStream::Open(io::AsyncReader* _reader, const char* _filename) {
+  Close();
+
+  if (!_reader || !_filename) {
+    log::Err() << "Invalid reader or file name." << std::endl;
+    return false;
+  }
+  io::File file(_filename, "rb");
+  if (!file.opened()) {
+    log::Err() << "Failed to open file " << _filename << "." << std::endl;
+    return false;
+  }
+  if (!OpenHeader(&file)) {
+    return false;
+  }
+  reader_ = _reader;
+  filename_ = _filename;
+  return true;
+}
+
+bool AnimationStream::OpenHeader(io::Stream* _stream) {
+  // Segments are loaded from raw stream offsets, which a compressed archive
+  // doesn't provide.
+  if (io::CompressedStream::Test(_stream)) {
+    log::Err() << "Compressed archives can't be streamed." << std::endl;
+    return false;
+  }
+
+  // Reads the archive header, the same way IArchive >> SegmentedAnimation
+  // does.
+  io::IArchive archive(_stream);
+  if (!io::internal::Tagger<const SegmentedAnimation>::Validate(archive)) {
+    log::Err() << "Stream doesn't contain a SegmentedAnimation." << std::endl;
+    return false;
+  }
+  uint32_t version;
+  archive >> version;
+
+  ozz::vector<uint32_t> sizes;
+  if (!animation_.LoadHeader(archive, version, &sizes)) {
+    return false;
+  }
+
+  // Segments are serialized contiguously after the header.
+  offsets_.resize(sizes.size() + 1);
+  offsets_[0] = _stream->Tell();
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    offsets_[i + 1] = offsets_[i] + sizes[i];
+  }
+  if (static_cast<uint64_t>(offsets_.back()) > _stream->Size()) {
+    log::Err() << "Stream is too small for SegmentedAnimation segments."
+               << std::endl;
+    Close();
+    return false;
+  }
+
+  const int num_segments = animation_.num_segments();
+  segments_ = static_cast<Segment*>(memory::default_allocator()->Allocate(
+      sizeof(Segment) * num_segments, alignof(Segment)));
+  for (int i = 0; i < num_segments; ++i) {
+    Segment* segment = new (segments_ + i) Segment;
+    segment->stream = this;
+    segment->index = i;
+    segment->state.store(kUnloaded, std::memory_order_relaxed);
+  }
+  return true;
+}
+
+void AnimationStream::Close() {
+  // Pending loads access segments, so they must complete first.
+  const int num_segments = segments_ ? animation_.num_segments() : 0;
+  for (int i = 0; i < num_segments; ++i) {
+    while (segments_[i].state.load(std::memory_order_acquire) == kLoading) {
+      std::this_thread::yield();
+    }
+    segments_[i].~Segment();
+  }
+  memory::default_allocator()->Deallocate(segments_);
+  segments_ = nullptr;
+
+  stream_ = nullptr;
+  reader_ = nullptr;
+  filename_.clear();
+  animation_ = SegmentedAnimation();
+  offsets_.clear();
+}
+
+bool AnimationStream::Update(float _ratio, bool _loop) {
+  if (!opened()) {
+    return false;
+  }
+
+  const int num_segments = animation_.num_segments();
+  float segment_ratio;
+  const int current = animation_.FindSegment(_ratio, &segment_ratio);
+  if (current < 0) {
+    return true;  // Nothing to load.
+  }
+
+  // Reports failed asynchronous loads, which are issued again if needed.
+  bool success = true;
+  for (int i = 0; i < num_segments; ++i) {
+    if (segments_[i].state.load(std::memory_order_acquire) == kFailed) {
+      segments_[i].state.store(kUnloaded, std::memory_order_relaxed);
+      success = false;
+    }
+  }
+
+  // Unloads segments out of the [current, current + lookahead] window first,
+  // so that memory peak doesn't exceed the window. Loading segments are left
+  // to their loader.
+  const int window = lookahead < 0 ? 0 : lookahead;
+  for (int i = 0; i < num_segments; ++i) {
+    int distance = i - current;
+    if (distance < 0 && _loop) {
+      distance += num_segments;
+    }
+    if (resident(i) && (distance < 0 || distance > window)) {
+      Unload(i);
+    }
+  }
+
+  // Loads window segments, starting with the current one.
+  for (int i = 0; i <= window; ++i) {
+    int index = current + i;
+    if (index >= num_segments) {
+      if (!_loop) {
+        break;
+      }
+      index %= num_segments;
+    }
+    if (segments_[index].state.load(std::memory_order_acquire) == kUnloaded) {
+      success &= Load(index);
+    }
+  }
+  return success;
+}
+
+bool AnimationStream::resident(int _index) const {
+  assert(_index >= 0 && _index < num_segments() && "Invalid segment index.");
+  return segments_[_index].state.load(std::memory_order_acquire) == kResident;
+}
+
+bool AnimationStream::loading(int _index) const {
+  assert(_index >= 0 && _index < num_segments() && "Invalid segment index.");
+  return segments_[_index].state.load(std::memory_order_acquire) == kLoading;
+}
+
+const Animation* AnimationStream::FindSegment(float _ratio,
+                                              float* _segment_ratio) const {
+  const int index = animation_.FindSegment(_ratio, _segment_ratio);
+  if (index < 0 || !resident(index)) {
+    return nullptr;
+  }
+  return &animation_.segment(index);
+}
+
+size_t AnimationStream::size() const {
+  // Only resident segments are accessed, as others can be being loaded.
+  const int num_segments = animation_.num_segments();
+  size_t size = sizeof(*this) + filename_.size() + animation_.name_.size() +
+                animation_.ratios_.size() * sizeof(float) +
+                num_segments * (sizeof(Animation) + sizeof(Segment)) +
+                offsets_.size() * sizeof(int64_t);
+  for (int i = 0; i < num_segments; ++i) {
+    if (resident(i)) {
+      size += animation_.segment(i).size() - sizeof(Animation);
+    }
+  }
+  return size;
+}
+
+void AnimationStream::Unload(int _index) {
+  assert(resident(_index));
+  animation_.segments_[_index] = Animation();
+  segments_[_index].state.store(kUnloaded, std::memory_order_relaxed);
+}
+
+bool AnimationStream::Load(int _index) {
+  Segment& segment = segments_[_index];
+  assert(segment.state.load(std::memory_order_relaxed) == kUnloaded);
+
+  if (stream_) {
+    if (!Decode(stream_, _index)) {
+      return false;
+    }
+    segment.state.store(kResident, std::memory_order_release);
+    return true;
+  }
+
+  // Segment is flagged loading before issuing the request, as it can complete
+  // immediately.
+  segment.state.store(kLoading, std::memory_order_relaxed);
+  if (!reader_->Read(filename_.c_str(), &AnimationStream::Complete,
+                     &segment)) {
+    log::Err() << "Failed to issue SegmentedAnimation segment " << _index
+               << " load." << std::endl;
+    segment.state.store(kUnloaded, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+bool AnimationStream::Decode(io::Stream* _stream, int _index) {
+  if (_stream->Seek(offsets_[_index], io::Stream::kSet) != 0) {
+    log::Err() << "Failed to seek to SegmentedAnimation segment " << _index
+               << "." << std::endl;
+    return false;
+  }
+  Animation& animation = animation_.segments_[_index];
+  io::IArchive archive(_stream);
+  archive >> animation;
+
+  // Loading failure leaves an empty animation.
+  if (_stream->Tell() != offsets_[_index + 1] ||
+      animation.num_tracks() != animation_.num_tracks()) {
+    log::Err() << "Failed to load SegmentedAnimation segment " << _index
+               << "." << std::endl;
+    animation = Animation();
+    return false;
+  }
+  return true;
+}
+
+void AnimationStream::Complete(io::Stream* _stream, void* _user_data) {
+  Segment* segment = static_cast<Segment*>(_user_data);
+  bool decoded = false;
+  if (_stream) {
+    decoded = segment->stream->Decode(_stream, segment->index);
+  } else {
+    log::Err() << "Failed to read SegmentedAnimation segment "
+               << segment->index << "." << std::endl;
+  }
+
+  // Publishing state is the last access to the segment, which can then be
+  // sampled, or destroyed by Close().
+  segment->state.store(decoded ? kResident : kFailed,
+                       std::memory_order_release);
+}
+}  // namespace animation
+}  // namespace ozz
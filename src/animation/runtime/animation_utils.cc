@@ -50,13 +50,20 @@ inline int CountKeyframesImpl(const span<const _Key>& _keys, int _track) {
 }
 
 int CountTranslationKeyframes(const Animation& _animation, int _track) {
-  return CountKeyframesImpl(_animation.translations(), _track);
+  // Only one of the translation keys buffers is used, depending on the format.
+  return CountKeyframesImpl(_animation.translations(), _track) +
+         CountKeyframesImpl(_animation.compact_translations(), _track);
 }
 int CountRotationKeyframes(const Animation& _animation, int _track) {
-  return CountKeyframesImpl(_animation.rotations(), _track);
+  // Only one of the rotation keys buffers is used, depending on the format.
+  return CountKeyframesImpl(_animation.rotations(), _track) +
+         CountKeyframesImpl(_animation.compact_rotations(), _track) +
+         CountKeyframesImpl(_animation.packed_rotations(), _track);
 }
 int CountScaleKeyframes(const Animation& _animation, int _track) {
-  return CountKeyframesImpl(_animation.scales(), _track);
+  // Only one of the scale keys buffers is used, depending on the format.
+  return CountKeyframesImpl(_animation.scales(), _track) +
+         CountKeyframesImpl(_animation.compact_scales(), _track);
 }
 }  // namespace animation
 }  // namespace ozz
@@ -0,0 +1,211 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/baked_pack.h"
+
+#include <cstring>
+
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Sets up a new object of _objects from its image.
+template <typename _Ty>
+bool BindObject(ozz::vector<_Ty>* _objects, memory::Allocator* _allocator,
+                span<const byte> _image) {
+  _objects->emplace_back(_allocator);
+  return _objects->back().FromImage(_image);
+}
+}  // namespace
+
+BakedPack::BakedPack(memory::Allocator* _allocator)
+    : allocator_(_allocator), allocation_(nullptr) {}
+
+BakedPack::~BakedPack() { Reset(); }
+
+void BakedPack::Reset() {
+  // Objects point to the image, so they're released first.
+  skeletons_.clear();
+  animations_.clear();
+  float_tracks_.clear();
+  float2_tracks_.clear();
+  float3_tracks_.clear();
+  float4_tracks_.clear();
+  quaternion_tracks_.clear();
+
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  allocator->Deallocate(allocation_);
+  allocation_ = nullptr;
+}
+
+bool BakedPack::Load(io::Stream* _stream) {
+  Reset();
+
+  if (!_stream || !_stream->opened()) {
+    log::Err() << "Invalid stream." << std::endl;
+    return false;
+  }
+  const int64_t tell = _stream->Tell();
+  const uint64_t stream_size = _stream->Size();
+  if (tell < 0 || stream_size <= static_cast<uint64_t>(tell)) {
+    log::Err() << "Empty baked pack stream." << std::endl;
+    return false;
+  }
+
+  // Reads the whole image at once.
+  const size_t size = static_cast<size_t>(stream_size - tell);
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  allocation_ = allocator->Allocate(size, kImageAlignment);
+  if (_stream->Read(allocation_, size) != size) {
+    log::Err() << "Failed to read baked pack image." << std::endl;
+    Reset();
+    return false;
+  }
+
+  if (!Bind({static_cast<const byte*>(allocation_), size})) {
+    Reset();
+    return false;
+  }
+  return true;
+}
+
+bool BakedPack::FromImage(span<const byte> _image) {
+  Reset();
+  if (!Bind(_image)) {
+    Reset();
+    return false;
+  }
+  return true;
+}
+
+bool BakedPack::Bind(span<const byte> _image) {
+  Header header;
+  if (!IsAligned(_image.data(), kImageAlignment) ||
+      _image.size_bytes() < sizeof(header)) {
+    log::Err() << "Invalid baked pack image buffer." << std::endl;
+    return false;
+  }
+  std::memcpy(&header, _image.data(), sizeof(header));
+  if (header.magic != kImageMagic) {
+    log::Err() << "Invalid baked pack image, or image endianness doesn't "
+                  "match platform."
+               << std::endl;
+    return false;
+  }
+  if (header.version != kImageVersion) {
+    log::Err() << "Unsupported baked pack image version " << header.version
+               << "." << std::endl;
+    return false;
+  }
+  if (header.size < sizeof(header) || _image.size_bytes() < header.size ||
+      (header.size - sizeof(header)) / sizeof(Entry) < header.num_entries) {
+    log::Err() << "Invalid baked pack image size." << std::endl;
+    return false;
+  }
+
+  // Counts objects per type first, so that objects are never moved once set
+  // up.
+  const byte* entries = _image.data() + sizeof(header);
+  size_t counts[kTypeCount] = {};
+  for (uint32_t i = 0; i < header.num_entries; ++i) {
+    Entry entry;
+    std::memcpy(&entry, entries + i * sizeof(entry), sizeof(entry));
+    if (entry.type >= kTypeCount || entry.offset > header.size ||
+        entry.size > header.size - entry.offset ||
+        !IsAligned(entry.offset, kImageAlignment)) {
+      log::Err() << "Invalid baked pack entry " << i << "." << std::endl;
+      return false;
+    }
+    ++counts[entry.type];
+  }
+  if (counts[kSkeleton] > 1) {
+    log::Err() << "Baked pack can't store more than one skeleton."
+               << std::endl;
+    return false;
+  }
+  skeletons_.reserve(counts[kSkeleton]);
+  animations_.reserve(counts[kAnimation]);
+  float_tracks_.reserve(counts[kFloatTrack]);
+  float2_tracks_.reserve(counts[kFloat2Track]);
+  float3_tracks_.reserve(counts[kFloat3Track]);
+  float4_tracks_.reserve(counts[kFloat4Track]);
+  quaternion_tracks_.reserve(counts[kQuaternionTrack]);
+
+  // Sets up each object in place, which only fixes up pointers.
+  for (uint32_t i = 0; i < header.num_entries; ++i) {
+    Entry entry;
+    std::memcpy(&entry, entries + i * sizeof(entry), sizeof(entry));
+    const span<const byte> image = {_image.data() + entry.offset, entry.size};
+    bool success = false;
+    switch (entry.type) {
+      case kSkeleton:
+        success = BindObject(&skeletons_, allocator_, image);
+        break;
+      case kAnimation:
+        success = BindObject(&animations_, allocator_, image);
+        break;
+      case kFloatTrack:
+        success = BindObject(&float_tracks_, allocator_, image);
+        break;
+      case kFloat2Track:
+        success = BindObject(&float2_tracks_, allocator_, image);
+        break;
+      case kFloat3Track:
+        success = BindObject(&float3_tracks_, allocator_, image);
+        break;
+      case kFloat4Track:
+        success = BindObject(&float4_tracks_, allocator_, image);
+        break;
+      case kQuaternionTrack:
+        success = BindObject(&quaternion_tracks_, allocator_, image);
+        break;
+    }
+    if (!success) {
+      log::Err() << "Failed to set up baked pack entry " << i << "."
+                 << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+const Animation* BakedPack::FindAnimation(const char* _name) const {
+  for (const Animation& animation : animations_) {
+    if (std::strcmp(animation.name(), _name) == 0) {
+      return &animation;
+    }
+  }
+  return nullptr;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,146 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/blend_mask.h"
+
+#include <cassert>
+#include <utility>
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+
+namespace ozz {
+namespace animation {
+
+BlendMask::BlendMask()
+    : skeleton_(nullptr), num_joints_(0), soa_begin_(0), soa_end_(0) {}
+
+BlendMask::BlendMask(BlendMask&& _other) : BlendMask() {
+  *this = std::move(_other);
+}
+
+BlendMask& BlendMask::operator=(BlendMask&& _other) {
+  std::swap(skeleton_, _other.skeleton_);
+  std::swap(num_joints_, _other.num_joints_);
+  std::swap(joint_weights_, _other.joint_weights_);
+  std::swap(mask_, _other.mask_);
+  std::swap(soa_begin_, _other.soa_begin_);
+  std::swap(soa_end_, _other.soa_end_);
+  return *this;
+}
+
+BlendMask::~BlendMask() {}
+
+void BlendMask::Reset(const Skeleton& _skeleton, float _weight) {
+  skeleton_ = &_skeleton;
+  num_joints_ = _skeleton.num_joints();
+  joint_weights_.assign(_skeleton.num_soa_joints(), math::simd_float4::zero());
+  mask_.assign((_skeleton.num_soa_joints() + 7) / 8, 0);
+  for (int i = 0; i < num_joints_; ++i) {
+    SetWeight(i, _weight);
+  }
+  UpdateMask();
+}
+
+void BlendMask::SetWeight(int _joint, float _weight) {
+  math::SimdFloat4& weights = joint_weights_[_joint / 4];
+  weights = math::SetI(weights, math::simd_float4::Load1(_weight), _joint & 3);
+}
+
+bool BlendMask::SetSubtree(int _root, float _weight) {
+  if (_root < 0 || _root >= num_joints_) {
+    return false;
+  }
+  // Depth-first skeletons store sub-hierarchies contiguously, which allows to
+  // iterate from the root only. Otherwise all joints are visited, knowing
+  // that parents are always visited before their children.
+  assert(skeleton_);
+  const bool depth_first = IsDepthFirst(*skeleton_);
+  ozz::vector<bool> in_subtree(num_joints_, false);
+  IterateJointsDF(
+      *skeleton_,
+      [this, _root, _weight, &in_subtree](int _joint, int _parent) {
+        if (_joint == _root || (_parent >= 0 && in_subtree[_parent])) {
+          in_subtree[_joint] = true;
+          SetWeight(_joint, _weight);
+        }
+      },
+      depth_first ? _root : Skeleton::kNoParent);
+  UpdateMask();
+  return true;
+}
+
+int BlendMask::SetPattern(const char* _pattern, float _weight, bool _subtree) {
+  assert(_pattern);
+  if (!skeleton_) {
+    return 0;
+  }
+  const span<const char* const> names = skeleton_->joint_names();
+  const span<const int16_t> parents = skeleton_->joint_parents();
+
+  // Parents are visited before their children, so a joint is in a matching
+  // subtree if its parent is.
+  ozz::vector<bool> set(num_joints_, false);
+  int matches = 0;
+  for (int i = 0; i < num_joints_; ++i) {
+    const bool match = strmatch(names[i], _pattern);
+    matches += match;
+    set[i] = match || (_subtree && parents[i] >= 0 && set[parents[i]]);
+    if (set[i]) {
+      SetWeight(i, _weight);
+    }
+  }
+  UpdateMask();
+  return matches;
+}
+
+void BlendMask::UpdateMask() {
+  const int num_soa_joints = static_cast<int>(joint_weights_.size());
+  soa_begin_ = num_soa_joints;
+  soa_end_ = 0;
+  for (int i = 0; i < num_soa_joints; ++i) {
+    if (!math::AreAllFalse(
+            math::CmpGt(joint_weights_[i], math::simd_float4::zero()))) {
+      mask_[i / 8] |= static_cast<uint8_t>(1 << (i & 7));
+      soa_begin_ = soa_begin_ < i ? soa_begin_ : i;
+      soa_end_ = i + 1;
+    } else {
+      mask_[i / 8] &= static_cast<uint8_t>(~(1 << (i & 7)));
+    }
+  }
+  if (soa_begin_ > soa_end_) {
+    soa_begin_ = soa_end_ = 0;
+  }
+}
+
+void BlendMask::Apply(BlendingJob::Layer* _layer) const {
+  assert(_layer);
+  _layer->joint_weights = joint_weights();
+  _layer->mask = mask();
+}
+}  // namespace animation
+}  // namespace ozz
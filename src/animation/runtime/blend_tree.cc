@@ -0,0 +1,331 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/blend_tree.h"
+
+#include <cassert>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Tells if an input contributes to the blend, and thus needs to be evaluated.
+template <typename _Input>
+inline bool IsActive(const _Input& _input) {
+  return _input.additive ? _input.weight != 0.f : _input.weight > 0.f;
+}
+}  // namespace
+
+BlendTree::BlendTree()
+    : num_soa_joints_(0), layout_changed_(true), num_updated_nodes_(0) {}
+
+BlendTree::~BlendTree() { Release(); }
+
+int BlendTree::AddClip(const Animation& _animation) {
+  Node node;
+  node.animation = &_animation;
+  node.ratio = 0.f;
+  node.context = -1;
+  node.threshold = 0.f;
+  node.version = 0;
+  node.dirty = true;
+  nodes_.push_back(node);
+  layout_changed_ = true;
+  return num_nodes() - 1;
+}
+
+int BlendTree::AddBlend() {
+  Node node;
+  node.animation = nullptr;
+  node.ratio = 0.f;
+  node.context = -1;
+  node.threshold = BlendingJob().threshold;
+  node.version = 0;
+  node.dirty = true;
+  nodes_.push_back(node);
+  layout_changed_ = true;
+  return num_nodes() - 1;
+}
+
+int BlendTree::AddInput(int _blend, int _input, bool _additive) {
+  if (_blend < 0 || _blend >= num_nodes() || nodes_[_blend].animation ||
+      _input < 0 || _input >= _blend) {
+    return -1;
+  }
+  Node& node = nodes_[_blend];
+  const Input input = {_input, _additive, 0.f, {}, {}, 0};
+  node.inputs.push_back(input);
+  node.dirty = true;
+  return static_cast<int>(node.inputs.size()) - 1;
+}
+
+bool BlendTree::SetRatio(int _clip, float _ratio) {
+  if (_clip < 0 || _clip >= num_nodes() || !nodes_[_clip].animation) {
+    return false;
+  }
+  Node& node = nodes_[_clip];
+  if (node.ratio != _ratio) {
+    node.ratio = _ratio;
+    node.dirty = true;
+  }
+  return true;
+}
+
+BlendTree::Input* BlendTree::FindInput(int _blend, int _input) {
+  if (_blend < 0 || _blend >= num_nodes()) {
+    return nullptr;
+  }
+  Node& node = nodes_[_blend];
+  if (_input < 0 || _input >= static_cast<int>(node.inputs.size())) {
+    return nullptr;
+  }
+  return &node.inputs[_input];
+}
+
+bool BlendTree::SetWeight(int _blend, int _input, float _weight) {
+  Input* input = FindInput(_blend, _input);
+  if (!input) {
+    return false;
+  }
+  if (input->weight != _weight) {
+    input->weight = _weight;
+    nodes_[_blend].dirty = true;
+  }
+  return true;
+}
+
+bool BlendTree::SetJointWeights(
+    int _blend, int _input,
+    const span<const math::SimdFloat4>& _joint_weights) {
+  Input* input = FindInput(_blend, _input);
+  if (!input) {
+    return false;
+  }
+  input->joint_weights = _joint_weights;
+  nodes_[_blend].dirty = true;
+  return true;
+}
+
+bool BlendTree::SetMask(int _blend, int _input,
+                        const span<const uint8_t>& _mask) {
+  Input* input = FindInput(_blend, _input);
+  if (!input) {
+    return false;
+  }
+  input->mask = _mask;
+  nodes_[_blend].dirty = true;
+  return true;
+}
+
+bool BlendTree::SetThreshold(int _blend, float _threshold) {
+  if (_blend < 0 || _blend >= num_nodes() || nodes_[_blend].animation ||
+      _threshold <= 0.f) {
+    return false;
+  }
+  Node& node = nodes_[_blend];
+  if (node.threshold != _threshold) {
+    node.threshold = _threshold;
+    node.dirty = true;
+  }
+  return true;
+}
+
+void BlendTree::Invalidate(int _node) {
+  if (_node >= 0 && _node < num_nodes()) {
+    nodes_[_node].dirty = true;
+  }
+}
+
+void BlendTree::Invalidate() {
+  for (Node& node : nodes_) {
+    node.dirty = true;
+  }
+}
+
+bool BlendTree::Allocate(const span<const math::SoaTransform>& _rest_pose) {
+  if (!layout_changed_ && _rest_pose.data() == rest_pose_.data() &&
+      _rest_pose.size() == rest_pose_.size()) {
+    return true;
+  }
+
+  // Animations must fit in the rest pose.
+  const int num_soa_joints = static_cast<int>(_rest_pose.size());
+  int num_clips = 0;
+  int max_tracks = 0;
+  bool cubic = false;
+  for (const Node& node : nodes_) {
+    if (node.animation) {
+      if (node.animation->num_soa_tracks() > num_soa_joints) {
+        return false;
+      }
+      max_tracks = math::Max(max_tracks, node.animation->num_tracks());
+      cubic |= node.animation->cubic();
+      ++num_clips;
+    }
+  }
+
+  // Allocates all nodes outputs at once, initialized with the rest pose, so
+  // that tracks that aren't animated output a valid transform.
+  Release();
+  const size_t num_transforms = nodes_.size() * _rest_pose.size();
+  math::SoaTransform* alloc = reinterpret_cast<math::SoaTransform*>(
+      memory::default_allocator()->Allocate(
+          sizeof(math::SoaTransform) * num_transforms,
+          alignof(math::SoaTransform)));
+  outputs_ = {alloc, num_transforms};
+  for (size_t i = 0; i < num_transforms; ++i) {
+    outputs_[i] = _rest_pose[i % _rest_pose.size()];
+  }
+
+  // Allocates all clips contexts at once.
+  contexts_.Resize(num_clips, max_tracks, cubic);
+  int context = 0;
+  for (Node& node : nodes_) {
+    node.context = node.animation ? context++ : -1;
+    node.dirty = true;
+  }
+
+  num_soa_joints_ = num_soa_joints;
+  rest_pose_ = _rest_pose;
+  layout_changed_ = false;
+  return true;
+}
+
+void BlendTree::Release() {
+  memory::default_allocator()->Deallocate(outputs_.data());
+  outputs_ = {};
+  num_soa_joints_ = 0;
+  rest_pose_ = {};
+  layout_changed_ = true;
+}
+
+bool BlendTree::Evaluate(int _root,
+                         const span<const math::SoaTransform>& _rest_pose) {
+  num_updated_nodes_ = 0;
+  if (_root < 0 || _root >= num_nodes() || _rest_pose.empty()) {
+    return false;
+  }
+  if (!Allocate(_rest_pose)) {
+    return false;
+  }
+  return EvaluateNode(_root);
+}
+
+bool BlendTree::EvaluateNode(int _node) {
+  Node& node = nodes_[_node];
+  const size_t num_soa_joints = static_cast<size_t>(num_soa_joints_);
+  const span<math::SoaTransform> output =
+      outputs_.subspan(_node * num_soa_joints, num_soa_joints);
+
+  if (node.animation) {
+    // Clip node is sampled if its parameters changed.
+    if (!node.dirty) {
+      return true;
+    }
+    SamplingJob job;
+    job.animation = node.animation;
+    job.context = &contexts_.contexts()[node.context];
+    job.ratio = node.ratio;
+    job.output = output;
+    if (!job.Run()) {
+      return false;
+    }
+  } else {
+    // Blend node is updated if its parameters changed, or if any of its active
+    // inputs was updated since its last update.
+    bool update = node.dirty;
+    for (const Input& input : node.inputs) {
+      if (!IsActive(input)) {
+        continue;  // Inactive branches aren't evaluated.
+      }
+      if (!EvaluateNode(input.node)) {
+        return false;
+      }
+      update |= nodes_[input.node].version != input.version;
+    }
+    if (!update) {
+      return true;
+    }
+
+    // Pushes normal, then additive layers, to the shared scratch layers.
+    // Inputs evaluation is over, so this node is the only one using layers_
+    // back.
+    const size_t base = layers_.size();
+    size_t num_layers = 0;
+    for (int additive = 0; additive < 2; ++additive) {
+      for (Input& input : node.inputs) {
+        if (input.additive != (additive != 0) || !IsActive(input)) {
+          continue;
+        }
+        input.version = nodes_[input.node].version;
+        BlendingJob::Layer layer;
+        layer.weight = input.weight;
+        layer.transform =
+            outputs_.subspan(input.node * num_soa_joints, num_soa_joints);
+        layer.joint_weights = input.joint_weights;
+        layer.mask = input.mask;
+        layers_.push_back(layer);
+      }
+      if (!additive) {
+        num_layers = layers_.size() - base;
+      }
+    }
+
+    BlendingJob job;
+    job.threshold = node.threshold;
+    job.layers = make_span(layers_).subspan(base, num_layers);
+    job.additive_layers = make_span(layers_).subspan(
+        base + num_layers, layers_.size() - base - num_layers);
+    job.rest_pose = rest_pose_;
+    job.output = output;
+    const bool success = job.Run();
+    layers_.resize(base);
+    if (!success) {
+      return false;
+    }
+  }
+
+  node.dirty = false;
+  ++node.version;
+  ++num_updated_nodes_;
+  return true;
+}
+
+span<const math::SoaTransform> BlendTree::output(int _node) const {
+  if (_node < 0 || _node >= num_nodes() || layout_changed_) {
+    return {};
+  }
+  const size_t num_soa_joints = static_cast<size_t>(num_soa_joints_);
+  return outputs_.subspan(_node * num_soa_joints, num_soa_joints);
+}
+}  // namespace animation
+}  // namespace ozz
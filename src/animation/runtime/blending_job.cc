@@ -27,12 +27,30 @@
 
 #include "ozz/animation/runtime/blending_job.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 
-#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/animation.h"
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_half_transform.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+
+// Selects AVX blending path, which processes a whole SoA transform as 5 AVX
+// vectors. It's always used if AVX is enabled for the whole build. Otherwise,
+// for x86 SSE builds, it's compiled with a function target attribute (GCC and
+// Clang) and selected at runtime according to host capabilities.
+#if defined(OZZ_SIMD_AVX)
+#define OZZ_BLENDING_AVX
+#define OZZ_BLENDING_AVX_TARGET
+#elif defined(OZZ_SIMD_SSEx) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define OZZ_BLENDING_AVX
+#define OZZ_BLENDING_AVX_DISPATCH
+#define OZZ_BLENDING_AVX_TARGET __attribute__((target("avx")))
+#endif
 
 namespace ozz {
 namespace animation {
@@ -45,15 +63,29 @@ namespace {
 bool ValidateLayer(const BlendingJob::Layer& _layer, size_t _min_range) {
   bool valid = true;
 
-  // Tests transforms validity.
-  valid &= _layer.transform.size() >= _min_range;
+  // Sparse layers buffers are compact, as big as the number of SoA joints
+  // they store.
+  const span<const uint16_t>& soa_joints = _layer.soa_joints;
+  const size_t range = soa_joints.empty() ? _min_range : soa_joints.size();
+  for (size_t i = 0; i < soa_joints.size(); ++i) {
+    valid &= soa_joints[i] < _min_range;
+    valid &= i == 0 || soa_joints[i - 1] < soa_joints[i];
+  }
+  valid &= soa_joints.empty() || _layer.mask.empty();
+
+  // Tests transforms validity, either full or half precision.
+  valid &= _layer.transform.empty() != _layer.half_transform.empty();
+  valid &= _layer.transform.size() + _layer.half_transform.size() >= range;
 
   // Joint weights are optional.
   if (!_layer.joint_weights.empty()) {
-    valid &= _layer.joint_weights.size() >= _min_range;
+    valid &= _layer.joint_weights.size() >= range;
   } else {
     valid &= _layer.joint_weights.empty();
   }
+
+  // Mask is optional.
+  valid &= _layer.mask.empty() || _layer.mask.size() >= (_min_range + 7) / 8;
   return valid;
 }
 }  // namespace
@@ -156,28 +188,49 @@ namespace {
     _out.scale = _out.scale * rcp_scale;                                       \
   } while (void(0), 0)
 
-// Defines parameters that are passed through blending stages.
+// Number of SoA joints processed at once by BlendingJob and
+// SampleBlendingJob. All blending stages are applied to a chunk before moving
+// to the next one, so that output transforms (and intermediate transforms
+// for SampleBlendingJob) stay in cache.
+const int kBlendChunkSize = 8;
+
+// Defines parameters that are passed through blending stages. Stages process
+// the chunk of SoA joints [begin,end[.
 struct ProcessArgs {
   ProcessArgs(const BlendingJob& _job)
       : job(_job),
         num_soa_joints(_job.rest_pose.size()),
+        begin(0),
+        end(0),
         num_passes(0),
         num_partial_passes(0),
         accumulated_weight(0.f) {
     // The range of all buffers has already been validated.
     assert(job.output.size() >= num_soa_joints);
-    assert(OZZ_ARRAY_SIZE(accumulated_weights) >= num_soa_joints);
   }
 
-  // Allocates enough space to store a accumulated weights per-joint.
-  // It will be initialized by the first pass processed, if any.
-  // This is quite big for a stack allocation (4 byte * maximum number of
-  // joints). This is one of the reasons why the number of joints is limited
-  // by the API.
-  // Note that this array is used with SoA data.
+  // Sets up the chunk [_begin,_end[ to process, and resets blending
+  // parameters.
+  void Reset(size_t _begin, size_t _end) {
+    assert(_end - _begin <= static_cast<size_t>(kBlendChunkSize));
+    begin = _begin;
+    end = _end;
+    num_passes = 0;
+    num_partial_passes = 0;
+    accumulated_weight = 0.f;
+  }
+
+  // Gets accumulated weight of SoA joint _i, which must be in the chunk.
+  math::SimdFloat4& joint_weight(size_t _i) {
+    assert(_i >= begin && _i < end);
+    return accumulated_weights[_i - begin];
+  }
+
+  // Accumulated weights of the chunk SoA joints, see joint_weight(). It's
+  // initialized by the first pass processed, if any.
   // This is the first argument in order to avoid wasting too much space with
   // alignment padding.
-  math::SimdFloat4 accumulated_weights[Skeleton::kMaxSoAJoints];
+  math::SimdFloat4 accumulated_weights[kBlendChunkSize];
 
   // The job to process.
   const BlendingJob& job;
@@ -186,6 +239,10 @@ struct ProcessArgs {
   // pose.
   size_t num_soa_joints;
 
+  // The chunk of SoA joints being processed.
+  size_t begin;
+  size_t end;
+
   // Number of processed blended passes (excluding passes with a weight <= 0.f),
   // including partial passes.
   int num_passes;
@@ -202,6 +259,230 @@ struct ProcessArgs {
   void operator=(const ProcessArgs&);
 };
 
+// Returns the index of the first SoA joint enabled by _mask in range
+// [_i,_end[, or _end if there's none. Disabled groups of 8 SoA joints are
+// skipped at once.
+inline size_t NextEnabled(const span<const uint8_t>& _mask, size_t _i,
+                          size_t _end) {
+  while (_i < _end) {
+    unsigned int bits = _mask[_i / 8] >> (_i & 7);
+    if (!bits) {
+      _i = (_i & ~size_t(7)) + 8;
+      continue;
+    }
+    for (; !(bits & 1); bits >>= 1) {
+      ++_i;
+    }
+    return math::Min(_i, _end);
+  }
+  return _end;
+}
+
+// Calls _fct(joint, index) for every SoA joint of a masked or sparse layer
+// in _args chunk, where joint is the SoA joint index, and index the one of its
+// transform and joint weight in layer buffers.
+template <typename _Fct>
+inline void ForEachLayerJoint(const BlendingJob::Layer& _layer,
+                              const ProcessArgs& _args, _Fct _fct) {
+  const size_t end = _args.end;
+  if (!_layer.soa_joints.empty()) {
+    const span<const uint16_t>& soa_joints = _layer.soa_joints;
+    const uint16_t* first =
+        std::lower_bound(soa_joints.begin(), soa_joints.end(), _args.begin);
+    for (size_t k = first - soa_joints.begin();
+         k < soa_joints.size() && soa_joints[k] < end; ++k) {
+      _fct(static_cast<size_t>(soa_joints[k]), k);
+    }
+  } else {
+    for (size_t i = NextEnabled(_layer.mask, _args.begin, end); i < end;
+         i = NextEnabled(_layer.mask, i + 1, end)) {
+      _fct(i, i);
+    }
+  }
+}
+
+// Returns transform _k of _layer. Half precision layers are converted to
+// _temp, which is returned.
+inline const math::SoaTransform& LayerTransform(
+    const BlendingJob::Layer& _layer, size_t _k, math::SoaTransform* _temp) {
+  if (_layer.half_transform.empty()) {
+    return _layer.transform[_k];
+  }
+  math::UnpackHalf(_layer.half_transform[_k], _temp);
+  return *_temp;
+}
+
+// Blends a masked or sparse layer to the output, see BlendingJob::Layer::mask
+// and BlendingJob::Layer::soa_joints.
+void BlendMaskedLayer(const BlendingJob::Layer& _layer,
+                      math::SimdFloat4 _layer_weight, ProcessArgs* _args) {
+  if (_args->num_passes == 0) {
+    // The first pass initializes all joints, as if disabled ones were blended
+    // with a null weight.
+    const math::SimdFloat4 zero = math::simd_float4::zero();
+    const math::SoaTransform null = {{zero, zero, zero},
+                                     {zero, zero, zero, zero},
+                                     {zero, zero, zero}};
+    for (size_t i = _args->begin; i < _args->end; ++i) {
+      _args->joint_weight(i) = zero;
+      _args->job.output[i] = null;
+    }
+  }
+
+  ForEachLayerJoint(_layer, *_args, [&](size_t _i, size_t _k) {
+    math::SoaTransform temp;
+    const math::SoaTransform& src = LayerTransform(_layer, _k, &temp);
+    math::SoaTransform* dest = _args->job.output.begin() + _i;
+    const math::SimdFloat4 weight =
+        _layer.joint_weights.empty()
+            ? _layer_weight
+            : _layer_weight * math::Max0(_layer.joint_weights[_k]);
+    _args->joint_weight(_i) = _args->joint_weight(_i) + weight;
+    OZZ_BLEND_N_PASS(src, weight, dest);
+  });
+}
+
+#if defined(OZZ_BLENDING_AVX)
+// AVX path sees a SoaTransform as 5 vectors of 8 floats: (tx, ty), (tz, rx),
+// (ry, rz), (rw, sx), (sy, sz). Operations match OZZ_BLEND_*_PASS ones, so
+// that both paths give the same result.
+static_assert(sizeof(math::SoaTransform) == 5 * sizeof(__m256),
+              "Unexpected SoaTransform layout");
+
+// Broadcasts SSE vector _v to both 128 bits lanes of an AVX vector.
+OZZ_BLENDING_AVX_TARGET inline __m256 BlendingBroadcast8(__m128 _v) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_v), _v, 1);
+}
+
+// Same as OZZ_BLEND_1ST_PASS.
+OZZ_BLENDING_AVX_TARGET inline void Blend1stPassAvx(
+    const math::SoaTransform& _in, __m256 _weight, math::SoaTransform* _out) {
+  const float* in = reinterpret_cast<const float*>(&_in);
+  float* out = reinterpret_cast<float*>(_out);
+  for (int i = 0; i < 5; ++i) {
+    _mm256_storeu_ps(out + i * 8,
+                     _mm256_mul_ps(_mm256_loadu_ps(in + i * 8), _weight));
+  }
+}
+
+// Same as OZZ_BLEND_N_PASS, sign fix-up being applied to rotation lanes only.
+OZZ_BLENDING_AVX_TARGET inline void BlendNPassAvx(
+    const math::SoaTransform& _in, __m256 _weight, math::SoaTransform* _out) {
+  const math::SimdInt4 sign = math::Sign(Dot(_out->rotation, _in.rotation));
+  const __m256 sign8 = BlendingBroadcast8(_mm_castsi128_ps(sign));
+  const __m256 zero8 = _mm256_setzero_ps();
+  const __m256 signs[5] = {zero8, _mm256_blend_ps(zero8, sign8, 0xf0), sign8,
+                           _mm256_blend_ps(sign8, zero8, 0xf0), zero8};
+  const float* in = reinterpret_cast<const float*>(&_in);
+  float* out = reinterpret_cast<float*>(_out);
+  for (int i = 0; i < 5; ++i) {
+    const __m256 src = _mm256_xor_ps(_mm256_loadu_ps(in + i * 8), signs[i]);
+    _mm256_storeu_ps(out + i * 8,
+                     _mm256_add_ps(_mm256_loadu_ps(out + i * 8),
+                                   _mm256_mul_ps(src, _weight)));
+  }
+}
+
+// AVX version of BlendLayer.
+OZZ_BLENDING_AVX_TARGET void BlendLayerAvx(const BlendingJob::Layer& _layer,
+                                           math::SimdFloat4 _layer_weight,
+                                           ProcessArgs* _args) {
+  const bool first = _args->num_passes == 0;
+  if (!_layer.joint_weights.empty()) {
+    for (size_t i = _args->begin; i < _args->end; ++i) {
+      const math::SimdFloat4 weight =
+          _layer_weight * math::Max0(_layer.joint_weights[i]);
+      const __m256 weight8 = BlendingBroadcast8(weight);
+      if (first) {
+        _args->joint_weight(i) = weight;
+        Blend1stPassAvx(_layer.transform[i], weight8,
+                        _args->job.output.begin() + i);
+      } else {
+        _args->joint_weight(i) = _args->joint_weight(i) + weight;
+        BlendNPassAvx(_layer.transform[i], weight8,
+                      _args->job.output.begin() + i);
+      }
+    }
+  } else {
+    const __m256 weight8 = BlendingBroadcast8(_layer_weight);
+    for (size_t i = _args->begin; i < _args->end; ++i) {
+      if (first) {
+        _args->joint_weight(i) = _layer_weight;
+        Blend1stPassAvx(_layer.transform[i], weight8,
+                        _args->job.output.begin() + i);
+      } else {
+        _args->joint_weight(i) = _args->joint_weight(i) + _layer_weight;
+        BlendNPassAvx(_layer.transform[i], weight8,
+                      _args->job.output.begin() + i);
+      }
+    }
+  }
+}
+
+// Tells if AVX path can be used on this host.
+bool HasBlendingAvx() {
+#if defined(OZZ_BLENDING_AVX_DISPATCH)
+  return math::SimdHostSupports(math::kSimdHostAvx);
+#else   // OZZ_BLENDING_AVX_DISPATCH
+  return true;
+#endif  // OZZ_BLENDING_AVX_DISPATCH
+}
+#endif  // OZZ_BLENDING_AVX
+
+// Blends a layer without mask to the output, using per-joint weights if any.
+void BlendLayer(const BlendingJob::Layer& _layer,
+                math::SimdFloat4 _layer_weight, ProcessArgs* _args) {
+#if defined(OZZ_BLENDING_AVX)
+  // Half precision layers are converted by the generic path.
+  if (HasBlendingAvx() && _layer.half_transform.empty()) {
+    BlendLayerAvx(_layer, _layer_weight, _args);
+    return;
+  }
+#endif  // OZZ_BLENDING_AVX
+
+  if (!_layer.joint_weights.empty()) {
+    if (_args->num_passes == 0) {
+      for (size_t i = _args->begin; i < _args->end; ++i) {
+        math::SoaTransform temp;
+        const math::SoaTransform& src = LayerTransform(_layer, i, &temp);
+        math::SoaTransform* dest = _args->job.output.begin() + i;
+        const math::SimdFloat4 weight =
+            _layer_weight * math::Max0(_layer.joint_weights[i]);
+        _args->joint_weight(i) = weight;
+        OZZ_BLEND_1ST_PASS(src, weight, dest);
+      }
+    } else {
+      for (size_t i = _args->begin; i < _args->end; ++i) {
+        math::SoaTransform temp;
+        const math::SoaTransform& src = LayerTransform(_layer, i, &temp);
+        math::SoaTransform* dest = _args->job.output.begin() + i;
+        const math::SimdFloat4 weight =
+            _layer_weight * math::Max0(_layer.joint_weights[i]);
+        _args->joint_weight(i) = _args->joint_weight(i) + weight;
+        OZZ_BLEND_N_PASS(src, weight, dest);
+      }
+    }
+  } else {
+    if (_args->num_passes == 0) {
+      for (size_t i = _args->begin; i < _args->end; ++i) {
+        math::SoaTransform temp;
+        const math::SoaTransform& src = LayerTransform(_layer, i, &temp);
+        math::SoaTransform* dest = _args->job.output.begin() + i;
+        _args->joint_weight(i) = _layer_weight;
+        OZZ_BLEND_1ST_PASS(src, _layer_weight, dest);
+      }
+    } else {
+      for (size_t i = _args->begin; i < _args->end; ++i) {
+        math::SoaTransform temp;
+        const math::SoaTransform& src = LayerTransform(_layer, i, &temp);
+        math::SoaTransform* dest = _args->job.output.begin() + i;
+        _args->joint_weight(i) = _args->joint_weight(i) + _layer_weight;
+        OZZ_BLEND_N_PASS(src, _layer_weight, dest);
+      }
+    }
+  }
+}
+
 // Blends all layers of the job to its output.
 void BlendLayers(ProcessArgs* _args) {
   assert(_args);
@@ -209,8 +490,10 @@ void BlendLayers(ProcessArgs* _args) {
   // Iterates through all layers and blend them to the output.
   for (const BlendingJob::Layer& layer : _args->job.layers) {
     // Asserts buffer sizes, which must never fail as it has been validated.
-    assert(layer.transform.size() >= _args->num_soa_joints);
-    assert(layer.joint_weights.empty() ||
+    assert(!layer.soa_joints.empty() ||
+           layer.transform.size() + layer.half_transform.size() >=
+               _args->num_soa_joints);
+    assert(!layer.soa_joints.empty() || layer.joint_weights.empty() ||
            (layer.joint_weights.size() >= _args->num_soa_joints));
 
     // Skip irrelevant layers.
@@ -223,48 +506,16 @@ void BlendLayers(ProcessArgs* _args) {
     const math::SimdFloat4 layer_weight =
         math::simd_float4::Load1(layer.weight);
 
-    if (!layer.joint_weights.empty()) {
-      // This layer has per-joint weights.
+    if (!layer.mask.empty() || !layer.soa_joints.empty()) {
+      // This layer is restricted to a subset of the joints.
       ++_args->num_partial_passes;
-
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer.transform[i];
-          math::SoaTransform* dest = _args->job.output.begin() + i;
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer.joint_weights[i]);
-          _args->accumulated_weights[i] = weight;
-          OZZ_BLEND_1ST_PASS(src, weight, dest);
-        }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer.transform[i];
-          math::SoaTransform* dest = _args->job.output.begin() + i;
-          const math::SimdFloat4 weight =
-              layer_weight * math::Max0(layer.joint_weights[i]);
-          _args->accumulated_weights[i] =
-              _args->accumulated_weights[i] + weight;
-          OZZ_BLEND_N_PASS(src, weight, dest);
-        }
-      }
+      BlendMaskedLayer(layer, layer_weight, _args);
     } else {
-      // This is a full layer.
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer.transform[i];
-          math::SoaTransform* dest = _args->job.output.begin() + i;
-          _args->accumulated_weights[i] = layer_weight;
-          OZZ_BLEND_1ST_PASS(src, layer_weight, dest);
-        }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer.transform[i];
-          math::SoaTransform* dest = _args->job.output.begin() + i;
-          _args->accumulated_weights[i] =
-              _args->accumulated_weights[i] + layer_weight;
-          OZZ_BLEND_N_PASS(src, layer_weight, dest);
-        }
+      // This layer has per-joint weights, or is a full layer.
+      if (!layer.joint_weights.empty()) {
+        ++_args->num_partial_passes;
       }
+      BlendLayer(layer, layer_weight, _args);
     }
     // One more pass blended.
     ++_args->num_passes;
@@ -287,7 +538,7 @@ void BlendRestPose(ProcessArgs* _args) {
       if (_args->num_passes == 0) {
         // Strictly copying rest-pose.
         _args->accumulated_weight = 1.f;
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        for (size_t i = _args->begin; i < _args->end; ++i) {
           _args->job.output[i] = _args->job.rest_pose[i];
         }
       } else {
@@ -298,7 +549,7 @@ void BlendRestPose(ProcessArgs* _args) {
         const math::SimdFloat4 simd_bp_weight =
             math::simd_float4::Load1(bp_weight);
 
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+        for (size_t i = _args->begin; i < _args->end; ++i) {
           const math::SoaTransform& src = _args->job.rest_pose[i];
           math::SoaTransform* dest = _args->job.output.begin() + i;
           OZZ_BLEND_N_PASS(src, simd_bp_weight, dest);
@@ -314,13 +565,12 @@ void BlendRestPose(ProcessArgs* _args) {
     // There's been at least 1 pass as num_partial_passes != 0.
     assert(_args->num_passes != 0);
 
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+    for (size_t i = _args->begin; i < _args->end; ++i) {
       const math::SoaTransform& src = _args->job.rest_pose[i];
       math::SoaTransform* dest = _args->job.output.begin() + i;
       const math::SimdFloat4 bp_weight =
-          math::Max0(threshold - _args->accumulated_weights[i]);
-      _args->accumulated_weights[i] =
-          math::Max(threshold, _args->accumulated_weights[i]);
+          math::Max0(threshold - _args->joint_weight(i));
+      _args->joint_weight(i) = math::Max(threshold, _args->joint_weight(i));
       OZZ_BLEND_N_PASS(src, bp_weight, dest);
     }
   }
@@ -338,7 +588,7 @@ void Normalize(ProcessArgs* _args) {
     // division to all joints.
     const math::SimdFloat4 ratio =
         math::simd_float4::Load1(1.f / _args->accumulated_weight);
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
+    for (size_t i = _args->begin; i < _args->end; ++i) {
       math::SoaTransform& dest = _args->job.output[i];
       dest.rotation = NormalizeEst(dest.rotation);
       dest.translation = dest.translation * ratio;
@@ -347,8 +597,8 @@ void Normalize(ProcessArgs* _args) {
   } else {
     // Partial blending normalization requires to compute the divider per-joint.
     const math::SimdFloat4 one = math::simd_float4::one();
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      const math::SimdFloat4 ratio = one / _args->accumulated_weights[i];
+    for (size_t i = _args->begin; i < _args->end; ++i) {
+      const math::SimdFloat4 ratio = one / _args->joint_weight(i);
       math::SoaTransform& dest = _args->job.output[i];
       dest.rotation = NormalizeEst(dest.rotation);
       dest.translation = dest.translation * ratio;
@@ -357,6 +607,33 @@ void Normalize(ProcessArgs* _args) {
   }
 }
 
+// Adds (or subtracts if _weight is negative) a masked or sparse layer to the
+// output, see BlendingJob::Layer::mask and BlendingJob::Layer::soa_joints.
+// Disabled joints are left unchanged.
+void AddMaskedLayer(const BlendingJob::Layer& _layer, ProcessArgs* _args) {
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 layer_weight = math::simd_float4::Load1(
+      _layer.weight > 0.f ? _layer.weight : -_layer.weight);
+
+  ForEachLayerJoint(_layer, *_args, [&](size_t _i, size_t _k) {
+    math::SoaTransform temp;
+    const math::SoaTransform& src = LayerTransform(_layer, _k, &temp);
+    math::SoaTransform& dest = _args->job.output[_i];
+    const math::SimdFloat4 weight =
+        _layer.joint_weights.empty()
+            ? layer_weight
+            : layer_weight * math::Max0(_layer.joint_weights[_k]);
+    const math::SimdFloat4 one_minus_weight = one - weight;
+    if (_layer.weight > 0.f) {
+      const math::SoaFloat3 one_minus_weight_f3 = {
+          one_minus_weight, one_minus_weight, one_minus_weight};
+      OZZ_ADD_PASS(src, weight, dest);
+    } else {
+      OZZ_SUB_PASS(src, weight, dest);
+    }
+  });
+}
+
 // Process additive blending pass.
 void AddLayers(ProcessArgs* _args) {
   assert(_args);
@@ -364,22 +641,30 @@ void AddLayers(ProcessArgs* _args) {
   // Iterates through all layers and blend them to the output.
   for (const BlendingJob::Layer& layer : _args->job.additive_layers) {
     // Asserts buffer sizes, which must never fail as it has been validated.
-    assert(layer.transform.size() >= _args->num_soa_joints);
-    assert(layer.joint_weights.empty() ||
+    assert(!layer.soa_joints.empty() ||
+           layer.transform.size() + layer.half_transform.size() >=
+               _args->num_soa_joints);
+    assert(!layer.soa_joints.empty() || layer.joint_weights.empty() ||
            (layer.joint_weights.size() >= _args->num_soa_joints));
 
     // Prepares constants.
     const math::SimdFloat4 one = math::simd_float4::one();
 
-    if (layer.weight > 0.f) {
+    if (!layer.mask.empty() || !layer.soa_joints.empty()) {
+      // This layer is restricted to a subset of the joints.
+      if (layer.weight != 0.f) {
+        AddMaskedLayer(layer, _args);
+      }
+    } else if (layer.weight > 0.f) {
       // Weight is positive, need to perform additive blending.
       const math::SimdFloat4 layer_weight =
           math::simd_float4::Load1(layer.weight);
 
       if (!layer.joint_weights.empty()) {
         // This layer has per-joint weights.
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer.transform[i];
+        for (size_t i = _args->begin; i < _args->end; ++i) {
+          math::SoaTransform temp;
+          const math::SoaTransform& src = LayerTransform(layer, i, &temp);
           math::SoaTransform& dest = _args->job.output[i];
           const math::SimdFloat4 weight =
               layer_weight * math::Max0(layer.joint_weights[i]);
@@ -394,8 +679,9 @@ void AddLayers(ProcessArgs* _args) {
         const math::SoaFloat3 one_minus_weight_f3 = {
             one_minus_weight, one_minus_weight, one_minus_weight};
 
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer.transform[i];
+        for (size_t i = _args->begin; i < _args->end; ++i) {
+          math::SoaTransform temp;
+          const math::SoaTransform& src = LayerTransform(layer, i, &temp);
           math::SoaTransform& dest = _args->job.output[i];
           OZZ_ADD_PASS(src, layer_weight, dest);
         }
@@ -407,8 +693,9 @@ void AddLayers(ProcessArgs* _args) {
 
       if (!layer.joint_weights.empty()) {
         // This layer has per-joint weights.
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer.transform[i];
+        for (size_t i = _args->begin; i < _args->end; ++i) {
+          math::SoaTransform temp;
+          const math::SoaTransform& src = LayerTransform(layer, i, &temp);
           math::SoaTransform& dest = _args->job.output[i];
           const math::SimdFloat4 weight =
               layer_weight * math::Max0(layer.joint_weights[i]);
@@ -418,8 +705,9 @@ void AddLayers(ProcessArgs* _args) {
       } else {
         // This is a full layer.
         const math::SimdFloat4 one_minus_weight = one - layer_weight;
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer.transform[i];
+        for (size_t i = _args->begin; i < _args->end; ++i) {
+          math::SoaTransform temp;
+          const math::SoaTransform& src = LayerTransform(layer, i, &temp);
           math::SoaTransform& dest = _args->job.output[i];
           OZZ_SUB_PASS(src, layer_weight, dest);
         }
@@ -435,21 +723,318 @@ bool BlendingJob::Run() const {
   if (!Validate()) {
     return false;
   }
+  RunUnchecked();
+  return true;
+}
+
+void BlendingJob::RunUnchecked() const {
+  OZZ_PROFILE_ZONE("BlendingJob::Run");
 
   // Initializes blended parameters that are exchanged across blend stages.
   ProcessArgs process_args(*this);
 
-  // Blends all layers to the job output buffers.
-  BlendLayers(&process_args);
+  // Output is processed by chunks of SoA joints, applying all stages to a
+  // chunk while it's still in cache.
+  const size_t num_soa_joints = rest_pose.size();
+  for (size_t begin = 0; begin < num_soa_joints; begin += kBlendChunkSize) {
+    process_args.Reset(begin,
+                       math::Min(begin + kBlendChunkSize, num_soa_joints));
 
-  // Applies rest pose.
-  BlendRestPose(&process_args);
+    // Blends all layers to the job output buffers.
+    BlendLayers(&process_args);
 
-  // Normalizes output.
-  Normalize(&process_args);
+    // Applies rest pose.
+    BlendRestPose(&process_args);
 
-  // Process additive blending.
-  AddLayers(&process_args);
+    // Normalizes output.
+    Normalize(&process_args);
+
+    // Process additive blending.
+    AddLayers(&process_args);
+  }
+}
+
+SampleBlendingJob::Layer::Layer()
+    : weight(0.f), animation(nullptr), ratio(0.f), context(nullptr) {}
+
+SampleBlendingJob::SampleBlendingJob()
+    : threshold(.1f), synchronized(false), ratio(0.f) {}
+
+namespace {
+bool ValidateLayer(const SampleBlendingJob::Layer& _layer,
+                   size_t _min_range) {
+  if (!_layer.animation || !_layer.context) {
+    return false;
+  }
+  bool valid = true;
+
+  // Animation must provide all the transforms to blend.
+  const int num_soa_tracks = _layer.animation->num_soa_tracks();
+  valid &= static_cast<size_t>(num_soa_tracks) >= _min_range;
+  valid &= _layer.context->max_soa_tracks() >= num_soa_tracks;
+  valid &= !_layer.animation->cubic() || _layer.context->cubic();
+
+  // Joint weights are optional.
+  valid &= _layer.joint_weights.empty() ||
+           _layer.joint_weights.size() >= _min_range;
+  return valid;
+}
+}  // namespace
+
+bool SampleBlendingJob::Validate() const {
+  bool valid = true;
+
+  // Test for valid threshold).
+  valid &= threshold > 0.f;
+
+  // The rest pose size defines the ranges of transforms to blend, so all
+  // other buffers should be bigger.
+  valid &= !rest_pose.empty();
+  const size_t min_range = rest_pose.size();
+  valid &= output.size() >= min_range;
+
+  // Validates layers.
+  for (const Layer& layer : layers) {
+    valid &= ValidateLayer(layer, min_range);
+  }
+
+  // Validates additive layers.
+  for (const Layer& layer : additive_layers) {
+    valid &= ValidateLayer(layer, min_range);
+  }
+
+  return valid;
+}
+
+namespace {
+
+// Blends a chunk of _size _samples to _output. _joint_weights can be nullptr
+// for a full layer. _first tells if this is the first blending pass, which
+// initializes _output and _accumulated_weights.
+void BlendChunk(const math::SoaTransform* _samples,
+                math::SimdFloat4 _layer_weight,
+                const math::SimdFloat4* _joint_weights, bool _first,
+                int _size, math::SimdFloat4* _accumulated_weights,
+                math::SoaTransform* _output) {
+  if (_joint_weights) {
+    // This layer has per-joint weights.
+    if (_first) {
+      for (int i = 0; i < _size; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform* dest = _output + i;
+        const math::SimdFloat4 weight =
+            _layer_weight * math::Max0(_joint_weights[i]);
+        _accumulated_weights[i] = weight;
+        OZZ_BLEND_1ST_PASS(src, weight, dest);
+      }
+    } else {
+      for (int i = 0; i < _size; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform* dest = _output + i;
+        const math::SimdFloat4 weight =
+            _layer_weight * math::Max0(_joint_weights[i]);
+        _accumulated_weights[i] = _accumulated_weights[i] + weight;
+        OZZ_BLEND_N_PASS(src, weight, dest);
+      }
+    }
+  } else {
+    // This is a full layer.
+    if (_first) {
+      for (int i = 0; i < _size; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform* dest = _output + i;
+        _accumulated_weights[i] = _layer_weight;
+        OZZ_BLEND_1ST_PASS(src, _layer_weight, dest);
+      }
+    } else {
+      for (int i = 0; i < _size; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform* dest = _output + i;
+        _accumulated_weights[i] = _accumulated_weights[i] + _layer_weight;
+        OZZ_BLEND_N_PASS(src, _layer_weight, dest);
+      }
+    }
+  }
+}
+
+// Adds (or subtracts if _weight is negative) a chunk of _size _samples to
+// _output. _joint_weights can be nullptr for a full layer.
+void AddChunk(const math::SoaTransform* _samples, float _weight,
+              const math::SimdFloat4* _joint_weights, int _size,
+              math::SoaTransform* _output) {
+  const math::SimdFloat4 one = math::simd_float4::one();
+
+  if (_weight > 0.f) {
+    // Weight is positive, need to perform additive blending.
+    const math::SimdFloat4 layer_weight = math::simd_float4::Load1(_weight);
+    if (_joint_weights) {
+      // This layer has per-joint weights.
+      for (int i = 0; i < _size; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform& dest = _output[i];
+        const math::SimdFloat4 weight =
+            layer_weight * math::Max0(_joint_weights[i]);
+        const math::SimdFloat4 one_minus_weight = one - weight;
+        const math::SoaFloat3 one_minus_weight_f3 = {
+            one_minus_weight, one_minus_weight, one_minus_weight};
+        OZZ_ADD_PASS(src, weight, dest);
+      }
+    } else {
+      // This is a full layer.
+      const math::SimdFloat4 one_minus_weight = one - layer_weight;
+      const math::SoaFloat3 one_minus_weight_f3 = {
+          one_minus_weight, one_minus_weight, one_minus_weight};
+      for (int i = 0; i < _size; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform& dest = _output[i];
+        OZZ_ADD_PASS(src, layer_weight, dest);
+      }
+    }
+  } else if (_weight < 0.f) {
+    // Weight is negative, need to perform subtractive blending.
+    const math::SimdFloat4 layer_weight = math::simd_float4::Load1(-_weight);
+    if (_joint_weights) {
+      // This layer has per-joint weights.
+      for (int i = 0; i < _size; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform& dest = _output[i];
+        const math::SimdFloat4 weight =
+            layer_weight * math::Max0(_joint_weights[i]);
+        const math::SimdFloat4 one_minus_weight = one - weight;
+        OZZ_SUB_PASS(src, weight, dest);
+      }
+    } else {
+      // This is a full layer.
+      const math::SimdFloat4 one_minus_weight = one - layer_weight;
+      for (int i = 0; i < _size; ++i) {
+        const math::SoaTransform& src = _samples[i];
+        math::SoaTransform& dest = _output[i];
+        OZZ_SUB_PASS(src, layer_weight, dest);
+      }
+    }
+  }
+}
+}  // namespace
+
+bool SampleBlendingJob::Run() const {
+  OZZ_PROFILE_ZONE("SampleBlendingJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  // Updates contexts of all the layers that contribute, so that only
+  // interpolation remains to be done per chunk. Global blending parameters are
+  // also computed, as BlendLayers() does.
+  const span<const uint8_t> no_mask;
+  const float sync_ratio = math::Clamp(0.f, ratio, 1.f);
+  float accumulated_weight = 0.f;
+  int num_passes = 0;
+  int num_partial_passes = 0;
+  for (const Layer& layer : layers) {
+    if (layer.weight <= 0.f) {
+      continue;  // Skip irrelevant layers.
+    }
+    layer.context->Update(
+        *layer.animation,
+        synchronized ? sync_ratio : math::Clamp(0.f, layer.ratio, 1.f),
+        no_mask);
+    accumulated_weight += layer.weight;
+    num_partial_passes += !layer.joint_weights.empty();
+    ++num_passes;
+  }
+  for (const Layer& layer : additive_layers) {
+    if (layer.weight == 0.f) {
+      continue;  // Skip irrelevant layers.
+    }
+    layer.context->Update(
+        *layer.animation,
+        synchronized ? sync_ratio : math::Clamp(0.f, layer.ratio, 1.f),
+        no_mask);
+  }
+
+  // Computes global rest pose weight and normalization ratio, used if no
+  // partial blending pass exists, see BlendRestPose().
+  const float rest_pose_weight = threshold - accumulated_weight;
+  if (num_partial_passes == 0 && rest_pose_weight > 0.f) {
+    accumulated_weight = num_passes == 0 ? 1.f : threshold;
+  }
+  const math::SimdFloat4 simd_rest_pose_weight =
+      math::simd_float4::Load1(rest_pose_weight);
+  const math::SimdFloat4 simd_threshold = math::simd_float4::Load1(threshold);
+  const math::SimdFloat4 ratio =
+      math::simd_float4::Load1(1.f / accumulated_weight);
+  const math::SimdFloat4 one = math::simd_float4::one();
+
+  // Processes output by chunks.
+  math::SoaTransform samples[kBlendChunkSize];
+  math::SimdFloat4 accumulated_weights[kBlendChunkSize];
+  const int num_soa_joints = static_cast<int>(rest_pose.size());
+  for (int begin = 0; begin < num_soa_joints;
+       begin += kBlendChunkSize) {
+    const int end = math::Min(begin + kBlendChunkSize, num_soa_joints);
+    const int size = end - begin;
+    math::SoaTransform* dest = output.begin() + begin;
+    const math::SoaTransform* rest = rest_pose.begin() + begin;
+
+    // Samples and blends all layers.
+    bool first = true;
+    for (const Layer& layer : layers) {
+      if (layer.weight <= 0.f) {
+        continue;
+      }
+      layer.context->Interpolate(begin, end, no_mask, samples);
+      BlendChunk(samples, math::simd_float4::Load1(layer.weight),
+                 layer.joint_weights.empty() ? nullptr
+                                             : &layer.joint_weights[begin],
+                 first, size, accumulated_weights, dest);
+      first = false;
+    }
+
+    // Applies rest pose and normalizes.
+    if (num_partial_passes == 0) {
+      if (rest_pose_weight > 0.f) {
+        if (num_passes == 0) {
+          for (int i = 0; i < size; ++i) {
+            dest[i] = rest[i];
+          }
+        } else {
+          for (int i = 0; i < size; ++i) {
+            OZZ_BLEND_N_PASS(rest[i], simd_rest_pose_weight, (dest + i));
+          }
+        }
+      }
+      for (int i = 0; i < size; ++i) {
+        dest[i].rotation = NormalizeEst(dest[i].rotation);
+        dest[i].translation = dest[i].translation * ratio;
+        dest[i].scale = dest[i].scale * ratio;
+      }
+    } else {
+      for (int i = 0; i < size; ++i) {
+        const math::SimdFloat4 bp_weight =
+            math::Max0(simd_threshold - accumulated_weights[i]);
+        const math::SimdFloat4 weight =
+            math::Max(simd_threshold, accumulated_weights[i]);
+        OZZ_BLEND_N_PASS(rest[i], bp_weight, (dest + i));
+        const math::SimdFloat4 joint_ratio = one / weight;
+        dest[i].rotation = NormalizeEst(dest[i].rotation);
+        dest[i].translation = dest[i].translation * joint_ratio;
+        dest[i].scale = dest[i].scale * joint_ratio;
+      }
+    }
+
+    // Samples and adds additive layers.
+    for (const Layer& layer : additive_layers) {
+      if (layer.weight == 0.f) {
+        continue;
+      }
+      layer.context->Interpolate(begin, end, no_mask, samples);
+      AddChunk(samples, layer.weight,
+               layer.joint_weights.empty() ? nullptr
+                                           : &layer.joint_weights[begin],
+               size, dest);
+    }
+  }
 
   return true;
 }
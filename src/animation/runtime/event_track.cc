@@ -0,0 +1,186 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/event_track.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+namespace ozz {
+namespace animation {
+
+EventTrack::EventTrack(memory::Allocator* _allocator)
+    : name_(nullptr), allocator_(_allocator) {}
+
+EventTrack::EventTrack(EventTrack&& _other)
+    : name_(nullptr), allocator_(nullptr) {
+  *this = std::move(_other);
+}
+
+EventTrack& EventTrack::operator=(EventTrack&& _other) {
+  std::swap(toggles_, _other.toggles_);
+  std::swap(name_, _other.name_);
+  std::swap(allocator_, _other.allocator_);
+  return *this;
+}
+
+EventTrack::~EventTrack() { Deallocate(); }
+
+void EventTrack::Allocate(size_t _toggles_count, size_t _name_len) {
+  assert(toggles_.size() == 0);
+
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t buffer_size = _toggles_count * sizeof(uint16_t) +  // toggles
+                             (_name_len > 0 ? _name_len + 1 : 0);
+  if (buffer_size == 0) {
+    return;
+  }
+  const memory::TagScope memory_tag(memory::kTagTrack);
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  span<byte> buffer = {
+      static_cast<byte*>(allocator->Allocate(buffer_size, alignof(uint16_t))),
+      buffer_size};
+
+  // Fix up pointers. Toggles are served first, as they own the allocation even
+  // if empty.
+  toggles_ = fill_span<uint16_t>(buffer, _toggles_count);
+
+  // Let name be nullptr if track has no name.
+  name_ =
+      _name_len > 0 ? fill_span<char>(buffer, _name_len + 1).data() : nullptr;
+
+  assert(buffer.empty() && "Whole buffer should be consumned");
+}
+
+void EventTrack::Deallocate() {
+  // Deallocate everything at once.
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  allocator->Deallocate(as_writable_bytes(toggles_).data());
+
+  toggles_ = {};
+  name_ = nullptr;
+}
+
+float EventTrack::toggle_ratio(int _index) const {
+  assert(_index >= 0 && _index < num_toggles() && "Invalid toggle index.");
+  return toggles_[_index] * (1.f / kMaxToggle);
+}
+
+size_t EventTrack::CountToggles(float _ratio) const {
+  // Compares ratios in float, exactly as toggle_ratio() computes them.
+  const uint16_t* it = std::upper_bound(
+      toggles_.begin(), toggles_.end(), _ratio,
+      [](float _value, uint16_t _toggle) {
+        return _value < _toggle * (1.f / kMaxToggle);
+      });
+  return it - toggles_.begin();
+}
+
+bool EventTrack::State(float _ratio) const {
+  // State is toggled by every toggle up to _ratio.
+  return (CountToggles(math::Clamp(0.f, _ratio, 1.f)) & 1) != 0;
+}
+
+size_t EventTrack::Windows(float _from, float _to,
+                           span<Window> _windows) const {
+  assert(_from <= _to && "Windows range must be ascending.");
+
+  // Window k starts at toggle 2k and ends at toggle 2k + 1, if any. It
+  // intersects the range if it ends after _from and starts before _to.
+  const size_t num_toggles = toggles_.size();
+  const size_t first = CountToggles(math::Clamp(0.f, _from, 1.f)) / 2;
+  const size_t last = (CountToggles(math::Clamp(0.f, _to, 1.f)) + 1) / 2;
+  if (last <= first) {
+    return 0;
+  }
+
+  const size_t count = last - first;
+  const size_t written = std::min(count, _windows.size());
+  for (size_t i = 0; i < written; ++i) {
+    const size_t begin = (first + i) * 2;
+    const Window window = {
+        toggles_[begin] * (1.f / kMaxToggle),
+        begin + 1 < num_toggles ? toggles_[begin + 1] * (1.f / kMaxToggle)
+                                : 1.f};
+    _windows[i] = window;
+  }
+  return count;
+}
+
+size_t EventTrack::size() const {
+  const size_t size = sizeof(*this) + toggles_.size_bytes();
+  return size;
+}
+
+void EventTrack::Save(ozz::io::OArchive& _archive) const {
+  const uint32_t num_toggles = static_cast<uint32_t>(toggles_.size());
+  _archive << num_toggles;
+
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  _archive << static_cast<int32_t>(name_len);
+
+  _archive << ozz::io::MakeArray(toggles_);
+
+  _archive << ozz::io::MakeArray(name_, name_len);
+}
+
+void EventTrack::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Destroy track in case it was already used before.
+  Deallocate();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported EventTrack version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  uint32_t num_toggles;
+  _archive >> num_toggles;
+
+  int32_t name_len;
+  _archive >> name_len;
+
+  Allocate(num_toggles, name_len);
+
+  _archive >> ozz::io::MakeArray(toggles_);
+
+  if (name_) {  // nullptr name_ is supported.
+    _archive >> ozz::io::MakeArray(name_, name_len);
+    name_[name_len] = 0;
+  }
+}
+}  // namespace animation
+}  // namespace ozz
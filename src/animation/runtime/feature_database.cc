@@ -0,0 +1,252 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/feature_database.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "ozz/base/containers/vector_archive.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math_archive.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Gets feature _feature of frame _frame, from SoA _features of _num_features
+// features per block.
+float GetFeature(const ozz::vector<math::SimdFloat4>& _features,
+                 int _num_features, int _frame, int _feature) {
+  const float* values = reinterpret_cast<const float*>(_features.data());
+  return values[((_frame / 4) * _num_features + _feature) * 4 + (_frame & 3)];
+}
+
+// Computes _boxes of _box_frames frames, see FeatureDatabase::small_boxes().
+void ComputeBoxes(const ozz::vector<math::SimdFloat4>& _features,
+                  int _num_features, int _num_frames, int _box_frames,
+                  ozz::vector<float>* _boxes) {
+  const int num_boxes = (_num_frames + _box_frames - 1) / _box_frames;
+  _boxes->resize(static_cast<size_t>(num_boxes) * _num_features * 2);
+  for (int b = 0; b < num_boxes; ++b) {
+    float* mins = _boxes->data() + static_cast<size_t>(b) * _num_features * 2;
+    float* maxs = mins + _num_features;
+    std::fill(mins, mins + _num_features, std::numeric_limits<float>::max());
+    std::fill(maxs, maxs + _num_features, -std::numeric_limits<float>::max());
+    const int end = std::min((b + 1) * _box_frames, _num_frames);
+    for (int i = b * _box_frames; i < end; ++i) {
+      for (int f = 0; f < _num_features; ++f) {
+        const float value = GetFeature(_features, _num_features, i, f);
+        mins[f] = math::Min(mins[f], value);
+        maxs[f] = math::Max(maxs[f], value);
+      }
+    }
+  }
+}
+}  // namespace
+
+FeatureDatabase::FeatureDatabase()
+    : num_features_(0), num_frames_(0), sample_rate_(0.f) {}
+
+FeatureDatabase::FeatureDatabase(FeatureDatabase&& _other)
+    : num_features_(0), num_frames_(0), sample_rate_(0.f) {
+  *this = std::move(_other);
+}
+
+FeatureDatabase& FeatureDatabase::operator=(FeatureDatabase&& _other) {
+  std::swap(num_features_, _other.num_features_);
+  std::swap(num_frames_, _other.num_frames_);
+  std::swap(sample_rate_, _other.sample_rate_);
+  std::swap(clips_, _other.clips_);
+  std::swap(offsets_, _other.offsets_);
+  std::swap(scales_, _other.scales_);
+  std::swap(features_, _other.features_);
+  std::swap(small_boxes_, _other.small_boxes_);
+  std::swap(large_boxes_, _other.large_boxes_);
+  return *this;
+}
+
+FeatureDatabase::~FeatureDatabase() {}
+
+void FeatureDatabase::Reset() {
+  num_features_ = 0;
+  num_frames_ = 0;
+  sample_rate_ = 0.f;
+  clips_.clear();
+  offsets_.clear();
+  scales_.clear();
+  features_.clear();
+  small_boxes_.clear();
+  large_boxes_.clear();
+}
+
+void FeatureDatabase::BuildBoxes() {
+  ComputeBoxes(features_, num_features_, num_frames_, kSmallBoxFrames,
+               &small_boxes_);
+  ComputeBoxes(features_, num_features_, num_frames_, kLargeBoxFrames,
+               &large_boxes_);
+}
+
+int FeatureDatabase::clip(int _frame) const {
+  if (_frame < 0 || _frame >= num_frames_) {
+    return -1;
+  }
+  // Finds the first clip starting after _frame, which follows _frame clip.
+  const auto it = std::upper_bound(
+      clips_.begin(), clips_.end(), _frame,
+      [](int _value, const Clip& _clip) { return _value < _clip.first_frame; });
+  return static_cast<int>(it - clips_.begin()) - 1;
+}
+
+float FeatureDatabase::ratio(int _frame) const {
+  const int index = clip(_frame);
+  if (index < 0) {
+    return 0.f;
+  }
+  const Clip& c = clips_[index];
+  if (!(c.duration > 0.f)) {
+    return 0.f;
+  }
+  const float time = (_frame - c.first_frame) / sample_rate_;
+  return math::Min(time / c.duration, 1.f);
+}
+
+int FeatureDatabase::frame(int _clip, float _ratio) const {
+  if (_clip < 0 || _clip >= num_clips()) {
+    return -1;
+  }
+  const Clip& c = clips_[_clip];
+  const float time = math::Clamp(0.f, _ratio, 1.f) * c.duration;
+  const int local = static_cast<int>(std::floor(time * sample_rate_ + .5f));
+  return c.first_frame + math::Min(local, c.num_frames - 1);
+}
+
+bool FeatureDatabase::Normalize(span<const float> _raw,
+                                span<float> _normalized) const {
+  if (_raw.size() < offsets_.size() || _normalized.size() < offsets_.size()) {
+    return false;
+  }
+  for (int f = 0; f < num_features_; ++f) {
+    _normalized[f] = (_raw[f] - offsets_[f]) * scales_[f];
+  }
+  return true;
+}
+
+bool FeatureDatabase::GetFeatures(int _frame, span<float> _raw) const {
+  if (_frame < 0 || _frame >= num_frames_ || _raw.size() < offsets_.size()) {
+    return false;
+  }
+  for (int f = 0; f < num_features_; ++f) {
+    _raw[f] = GetFeature(features_, num_features_, _frame, f) / scales_[f] +
+              offsets_[f];
+  }
+  return true;
+}
+
+span<const math::SimdFloat4> FeatureDatabase::block(int _block) const {
+  if (_block < 0 || _block >= num_blocks()) {
+    return span<const math::SimdFloat4>();
+  }
+  return span<const math::SimdFloat4>(
+      features_.data() + static_cast<size_t>(_block) * num_features_,
+      num_features_);
+}
+
+void FeatureDatabase::Save(ozz::io::OArchive& _archive) const {
+  _archive << static_cast<int32_t>(num_features_);
+  _archive << static_cast<int32_t>(num_frames_);
+  _archive << sample_rate_;
+  _archive << static_cast<uint32_t>(clips_.size());
+  for (const Clip& c : clips_) {
+    _archive << static_cast<int32_t>(c.first_frame);
+    _archive << static_cast<int32_t>(c.num_frames);
+    _archive << c.duration;
+  }
+  _archive << offsets_;
+  _archive << scales_;
+  _archive << features_;
+}
+
+void FeatureDatabase::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Resets database in case it was already used before.
+  Reset();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported FeatureDatabase version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  int32_t num_features, num_frames;
+  float sample_rate;
+  uint32_t num_clips;
+  _archive >> num_features;
+  _archive >> num_frames;
+  _archive >> sample_rate;
+  _archive >> num_clips;
+  ozz::vector<Clip> clips(num_clips);
+  for (Clip& c : clips) {
+    int32_t first_frame, clip_frames;
+    _archive >> first_frame;
+    _archive >> clip_frames;
+    _archive >> c.duration;
+    c.first_frame = first_frame;
+    c.num_frames = clip_frames;
+  }
+  _archive >> offsets_;
+  _archive >> scales_;
+  _archive >> features_;
+
+  // Rejects inconsistent data: clips must be contiguous and cover all frames.
+  bool valid = num_features >= 0 && num_frames >= 0 && sample_rate > 0.f &&
+               offsets_.size() == static_cast<size_t>(num_features) &&
+               scales_.size() == static_cast<size_t>(num_features) &&
+               features_.size() == static_cast<size_t>((num_frames + 3) / 4) *
+                                       static_cast<size_t>(num_features);
+  int next_frame = 0;
+  for (size_t i = 0; valid && i < clips.size(); ++i) {
+    valid = clips[i].first_frame == next_frame && clips[i].num_frames > 0;
+    next_frame += clips[i].num_frames;
+  }
+  if (!valid || next_frame != num_frames) {
+    log::Err() << "Invalid FeatureDatabase." << std::endl;
+    Reset();
+    return;
+  }
+
+  num_features_ = num_features;
+  num_frames_ = num_frames;
+  sample_rate_ = sample_rate;
+  clips_ = std::move(clips);
+  BuildBoxes();
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,333 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/frame_budget_governor.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+#include "ozz/animation/runtime/update_rate_scheduler.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+struct FrameBudgetGovernor::Timing {
+  // Zones measured so far, slots are claimed by the first thread ending each
+  // zone.
+  std::atomic<const profile::ZoneDesc*> zones[kMaxStages];
+  std::atomic<int64_t> nanoseconds[kMaxStages];
+};
+
+namespace {
+typedef std::chrono::steady_clock GovernorClock;
+
+// Nesting depth and beginning of the outermost zone of the calling thread.
+// Only outermost zones are accumulated, so that nested zones aren't counted
+// twice.
+thread_local int g_zone_depth = 0;
+thread_local GovernorClock::time_point g_zone_begin;
+
+void GovernorZoneBegin(const profile::ZoneDesc&, void*) {
+  if (g_zone_depth++ == 0) {
+    g_zone_begin = GovernorClock::now();
+  }
+}
+
+template <typename _Timing>
+void GovernorZoneEnd(const profile::ZoneDesc& _zone, void* _user_data) {
+  if (--g_zone_depth != 0) {
+    return;
+  }
+  const int64_t duration =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          GovernorClock::now() - g_zone_begin)
+          .count();
+  _Timing* timing = static_cast<_Timing*>(_user_data);
+  for (auto& zone : timing->zones) {
+    const profile::ZoneDesc* expected = nullptr;
+    if (zone.load(std::memory_order_acquire) == &_zone ||
+        zone.compare_exchange_strong(expected, &_zone) ||
+        expected == &_zone) {
+      const size_t index = &zone - timing->zones;
+      timing->nanoseconds[index].fetch_add(duration,
+                                           std::memory_order_relaxed);
+      return;
+    }
+  }
+  // Zone is dropped if all slots are used.
+}
+
+// Validates that level costs are in range ]0,1] and decreasing.
+bool ValidateCosts(span<const float> _costs) {
+  bool valid = true;
+  for (size_t i = 0; i < _costs.size(); ++i) {
+    valid &= _costs[i] > 0.f && _costs[i] <= 1.f;
+    valid &= i == 0 || _costs[i] <= _costs[i - 1];
+  }
+  return valid;
+}
+}  // namespace
+
+FrameBudgetGovernor::Settings::Settings()
+    : budget(2e-3f), tolerance(.1f), smoothing(.25f), max_period(8) {}
+
+FrameBudgetGovernor::FrameBudgetGovernor()
+    : dirty_(false),
+      cost_(0.f),
+      unit_cost_(0.f),
+      work_(0.f),
+      timing_(nullptr) {}
+
+FrameBudgetGovernor::~FrameBudgetGovernor() { Deallocate(); }
+
+bool FrameBudgetGovernor::Allocate(int _num_instances,
+                                   const Settings& _settings) {
+  Deallocate();
+  if (_num_instances <= 0 || !(_settings.budget > 0.f) ||
+      !(_settings.tolerance >= 0.f && _settings.tolerance < 1.f) ||
+      !(_settings.smoothing > 0.f && _settings.smoothing <= 1.f) ||
+      _settings.max_period < 1 || !ValidateCosts(_settings.skeleton_costs) ||
+      !ValidateCosts(_settings.animation_costs)) {
+    return false;
+  }
+
+  // Copies level costs, settings then refer to the copies.
+  settings_ = _settings;
+  settings_.max_period =
+      math::Min(_settings.max_period,
+                static_cast<int>(UpdateRateScheduler::kMaxPeriod));
+  skeleton_costs_.assign(_settings.skeleton_costs.begin(),
+                         _settings.skeleton_costs.end());
+  animation_costs_.assign(_settings.animation_costs.begin(),
+                          _settings.animation_costs.end());
+  if (skeleton_costs_.empty()) {
+    skeleton_costs_.push_back(1.f);
+  }
+  if (animation_costs_.empty()) {
+    animation_costs_.push_back(1.f);
+  }
+  settings_.skeleton_costs = make_span(skeleton_costs_);
+  settings_.animation_costs = make_span(animation_costs_);
+  BuildLadder();
+
+  const Instance instance = {1.f, 0};
+  instances_.assign(_num_instances, instance);
+  order_.resize(_num_instances);
+  dirty_ = true;
+  work_ = ladder_[0].cost * _num_instances;
+
+  timing_ = ozz::New<Timing>();
+  for (int i = 0; i < kMaxStages; ++i) {
+    timing_->zones[i].store(nullptr);
+    timing_->nanoseconds[i].store(0);
+  }
+  return true;
+}
+
+void FrameBudgetGovernor::Deallocate() {
+  ozz::Delete(timing_);
+  timing_ = nullptr;
+  settings_ = Settings();
+  skeleton_costs_.clear();
+  animation_costs_.clear();
+  ladder_.clear();
+  instances_.clear();
+  order_.clear();
+  stages_.clear();
+  dirty_ = false;
+  cost_ = 0.f;
+  unit_cost_ = 0.f;
+  work_ = 0.f;
+}
+
+void FrameBudgetGovernor::BuildLadder() {
+  Level level = {1, 0, 0, skeleton_costs_[0] * animation_costs_[0]};
+  ladder_.push_back(level);
+  const int num_skeleton_levels = static_cast<int>(skeleton_costs_.size());
+  const int num_animation_tiers = static_cast<int>(animation_costs_.size());
+  for (;;) {
+    // Selects the cheapest of the next possible levels. Ties favor animation
+    // tiers, then skeleton levels.
+    Level next = level;
+    next.cost = std::numeric_limits<float>::max();
+    if (level.animation_tier + 1 < num_animation_tiers) {
+      const float cost = skeleton_costs_[level.skeleton_level] *
+                         animation_costs_[level.animation_tier + 1] /
+                         level.period;
+      if (cost < next.cost) {
+        next = level;
+        next.animation_tier++;
+        next.cost = cost;
+      }
+    }
+    if (level.skeleton_level + 1 < num_skeleton_levels) {
+      const float cost = skeleton_costs_[level.skeleton_level + 1] *
+                         animation_costs_[level.animation_tier] / level.period;
+      if (cost < next.cost) {
+        next = level;
+        next.skeleton_level++;
+        next.cost = cost;
+      }
+    }
+    if (level.period * 2 <= settings_.max_period) {
+      const float cost = level.cost * .5f;
+      if (cost < next.cost) {
+        next = level;
+        next.period *= 2;
+        next.cost = cost;
+      }
+    }
+    if (next.cost == std::numeric_limits<float>::max()) {
+      break;
+    }
+    level = next;
+    ladder_.push_back(level);
+  }
+}
+
+bool FrameBudgetGovernor::set_importance(int _instance, float _importance) {
+  if (_instance < 0 || _instance >= num_instances()) {
+    return false;
+  }
+  if (instances_[_instance].importance != _importance) {
+    instances_[_instance].importance = _importance;
+    dirty_ = true;
+  }
+  return true;
+}
+
+float FrameBudgetGovernor::importance(int _instance) const {
+  if (_instance < 0 || _instance >= num_instances()) {
+    return 0.f;
+  }
+  return instances_[_instance].importance;
+}
+
+const FrameBudgetGovernor::Level& FrameBudgetGovernor::level(
+    int _instance) const {
+  assert(_instance >= 0 && _instance < num_instances() && "Invalid instance");
+  return ladder_[instances_[_instance].step];
+}
+
+bool FrameBudgetGovernor::Update(float _cost) {
+  if (instances_.empty() || !(_cost >= 0.f)) {
+    return false;
+  }
+  cost_ = _cost;
+
+  // Estimates the cost of a unit of work from the levels that produced this
+  // frame cost.
+  if (work_ > 0.f && _cost > 0.f) {
+    const float unit_cost = _cost / work_;
+    const float smoothing = unit_cost_ > 0.f ? settings_.smoothing : 1.f;
+    unit_cost_ += (unit_cost - unit_cost_) * smoothing;
+  }
+
+  // Selects new levels if cost is out of the tolerance band, or if
+  // importances changed.
+  const float budget = settings_.budget;
+  const bool in_band =
+      _cost <= budget && _cost >= budget * (1.f - settings_.tolerance);
+  if (dirty_ || (!in_band && unit_cost_ > 0.f)) {
+    // Targets the middle of the tolerance band.
+    const float target =
+        unit_cost_ > 0.f
+            ? budget * (1.f - settings_.tolerance * .5f) / unit_cost_
+            : std::numeric_limits<float>::max();
+    Select(target);
+  }
+  return true;
+}
+
+bool FrameBudgetGovernor::Update() {
+  if (instances_.empty()) {
+    return false;
+  }
+
+  // Collects and resets zones accumulated durations.
+  stages_.clear();
+  int64_t total = 0;
+  for (int i = 0; i < kMaxStages; ++i) {
+    const profile::ZoneDesc* zone = timing_->zones[i].load();
+    if (!zone) {
+      break;
+    }
+    const int64_t nanoseconds = timing_->nanoseconds[i].exchange(0);
+    const Stage stage = {zone->name, nanoseconds * 1e-9f};
+    stages_.push_back(stage);
+    total += nanoseconds;
+  }
+  return Update(total * 1e-9f);
+}
+
+void FrameBudgetGovernor::Select(float _target) {
+  const int num = num_instances();
+  const int last = static_cast<int>(ladder_.size()) - 1;
+  if (dirty_) {
+    for (int i = 0; i < num; ++i) {
+      order_[i] = i;
+    }
+    std::stable_sort(order_.begin(), order_.end(), [this](int _a, int _b) {
+      return instances_[_a].importance < instances_[_b].importance;
+    });
+    dirty_ = false;
+  }
+
+  // Starts from full quality, disabled instances excepted.
+  float work = 0.f;
+  for (Instance& instance : instances_) {
+    const bool enabled = instance.importance > 0.f;
+    instance.step = enabled ? 0 : last;
+    work += enabled ? ladder_[0].cost : 0.f;
+  }
+
+  // Degrades least important instances first, until work fits the target.
+  for (int i = 0; i < num && work > _target; ++i) {
+    Instance& instance = instances_[order_[i]];
+    if (instance.importance <= 0.f) {
+      continue;
+    }
+    for (; instance.step < last && work > _target; ++instance.step) {
+      work -= ladder_[instance.step].cost - ladder_[instance.step + 1].cost;
+    }
+  }
+  work_ = work;
+}
+
+profile::Hooks FrameBudgetGovernor::hooks() {
+  const profile::Hooks hooks = {&GovernorZoneBegin, &GovernorZoneEnd<Timing>,
+                                timing_};
+  return hooks;
+}
+}  // namespace animation
+}  // namespace ozz
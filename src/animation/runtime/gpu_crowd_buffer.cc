@@ -0,0 +1,615 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/gpu_crowd_buffer.h"
+
+#include <cmath>
+#include <cstring>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/endianness.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/math_ex.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+
+// Keys are read bytewise from the buffer, by the compute kernel as well as by
+// Evaluate(), which relies on these layouts.
+static_assert(sizeof(Float3Key) == 12 && sizeof(CompactFloat3Key) == 10 &&
+                  sizeof(QuaternionKey) == 12 &&
+                  sizeof(CompactQuaternionKey) == 10 &&
+                  sizeof(PackedQuaternionKey) == 8,
+              "Unexpected keyframe layout.");
+
+// Instances are uploaded as is to the compute kernel instances buffer.
+static_assert(sizeof(GpuCrowdBuffer::Instance) == 20,
+              "Unexpected instance layout.");
+
+namespace {
+// Appends _size bytes of _data to _buffer, starting at a word boundary.
+// Returns the offset of the first word.
+uint32_t AppendBytes(ozz::vector<uint32_t>* _buffer, const void* _data,
+                     size_t _size) {
+  const size_t offset = _buffer->size();
+  _buffer->resize(offset + (_size + 3) / 4, 0);
+  if (_size != 0) {
+    std::memcpy(_buffer->data() + offset, _data, _size);
+  }
+  return static_cast<uint32_t>(offset);
+}
+
+template <typename _Ty>
+uint32_t AppendSpan(ozz::vector<uint32_t>* _buffer, span<const _Ty> _span) {
+  return AppendBytes(_buffer, _span.data(), _span.size_bytes());
+}
+
+// Reads buffer data at byte offset _byte, as the compute kernel does.
+inline uint32_t ReadU16(const uint32_t* _buffer, uint32_t _byte) {
+  return (_buffer[_byte >> 2] >> ((_byte & 2) * 8)) & 0xffff;
+}
+
+inline int ReadI16(const uint32_t* _buffer, uint32_t _byte) {
+  return static_cast<int16_t>(ReadU16(_buffer, _byte));
+}
+
+inline float ReadFloat(const uint32_t* _buffer, uint32_t _word) {
+  float value;
+  std::memcpy(&value, _buffer + _word, sizeof(value));
+  return value;
+}
+
+// Gets the ratio of the key located at byte offset _byte.
+inline float ReadRatio(const uint32_t* _buffer, uint32_t _byte,
+                       bool _compact) {
+  return _compact ? ReadU16(_buffer, _byte) / internal::kRatioQuantization
+                  : ReadFloat(_buffer, _byte >> 2);
+}
+
+// Finds the keys surrounding _ratio in track _track, with the same rules as
+// StatelessSamplingJob: right key is the first key whose ratio is greater than
+// _ratio (or the last one). Outputs keys byte offsets.
+void FindKeys(const uint32_t* _buffer, uint32_t _index, uint32_t _keys,
+              uint32_t _stride, bool _compact, uint32_t _num_tracks,
+              uint32_t _track, float _ratio, uint32_t _found[2]) {
+  const uint32_t indices = _index + _num_tracks + 1;
+  // Every track has at least 2 keys, the first one being at ratio 0.
+  int first = static_cast<int>(_buffer[_index + _track]) + 1;
+  int count = static_cast<int>(_buffer[_index + _track + 1]) - 1 - first;
+  while (count > 0) {
+    const int step = count / 2;
+    const int it = first + step;
+    const uint32_t key = _keys * 4 + _buffer[indices + it] * _stride;
+    if (_ratio >= ReadRatio(_buffer, key, _compact)) {
+      first = it + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  _found[0] = _keys * 4 + _buffer[indices + first - 1] * _stride;
+  _found[1] = _keys * 4 + _buffer[indices + first] * _stride;
+}
+
+// Samples translation or scale of track _track.
+void SampleFloat3(const uint32_t* _buffer, uint32_t _index, uint32_t _keys,
+                  uint32_t _format, uint32_t _num_tracks, uint32_t _track,
+                  float _ratio, float _value[3]) {
+  const bool compact = _format == GpuCrowdBuffer::kCompactFloat3Key;
+  const uint32_t stride = compact ? 10 : 12;
+  const uint32_t values = compact ? 4 : 6;
+  uint32_t keys[2];
+  FindKeys(_buffer, _index, _keys, stride, compact, _num_tracks, _track,
+           _ratio, keys);
+  const float r0 = ReadRatio(_buffer, keys[0], compact);
+  const float r1 = ReadRatio(_buffer, keys[1], compact);
+  const float alpha = (_ratio - r0) / (r1 - r0);
+  for (uint32_t c = 0; c < 3; ++c) {
+    const float v0 = math::HalfToFloat(
+        static_cast<uint16_t>(ReadU16(_buffer, keys[0] + values + c * 2)));
+    const float v1 = math::HalfToFloat(
+        static_cast<uint16_t>(ReadU16(_buffer, keys[1] + values + c * 2)));
+    _value[c] = v0 + (v1 - v0) * alpha;
+  }
+}
+
+// Decodes the quaternion key located at byte offset _byte.
+void DecodeQuaternion(const uint32_t* _buffer, uint32_t _byte,
+                      uint32_t _format, float _quaternion[4]) {
+  const uint32_t bits =
+      ReadU16(_buffer, _byte + (_format == GpuCrowdBuffer::kQuaternionKey ? 4
+                                                                          : 2));
+  const uint32_t largest = (bits >> 13) & 3;
+  int values[3];
+  float scale;
+  if (_format == GpuCrowdBuffer::kPackedQuaternionKey) {
+    typedef internal::QuaternionKeyQuantization<PackedQuaternionKey>
+        Quantization;
+    const uint32_t value = _buffer[(_byte + 4) >> 2];
+    values[0] = (static_cast<int32_t>(value) >> 21) * Quantization::kScale10;
+    values[1] =
+        (static_cast<int32_t>(value << 11) >> 21) * Quantization::kScale10;
+    values[2] =
+        (static_cast<int32_t>(value << 22) >> 22) * Quantization::kScale11;
+    scale = static_cast<float>(Quantization::kScale);
+  } else {
+    const uint32_t offset =
+        _byte + (_format == GpuCrowdBuffer::kQuaternionKey ? 6 : 4);
+    for (uint32_t c = 0; c < 3; ++c) {
+      values[c] = ReadI16(_buffer, offset + c * 2);
+    }
+    scale = static_cast<float>(
+        internal::QuaternionKeyQuantization<QuaternionKey>::kScale);
+  }
+
+  // Restores the largest component from the 3 smallest ones.
+  const float int2float = 1.f / (scale * math::kSqrt2);
+  float dot = 0.f;
+  for (uint32_t c = 0, v = 0; c < 4; ++c) {
+    if (c != largest) {
+      _quaternion[c] = values[v++] * int2float;
+      dot += _quaternion[c] * _quaternion[c];
+    }
+  }
+  const float w = std::sqrt(math::Max(1e-16f, 1.f - dot));
+  _quaternion[largest] = (bits >> 15) ? -w : w;
+}
+
+// Samples rotation of track _track. Keys are linearly interpolated, then
+// normalized.
+void SampleQuaternion(const uint32_t* _buffer, uint32_t _index, uint32_t _keys,
+                      uint32_t _format, uint32_t _num_tracks, uint32_t _track,
+                      float _ratio, float _quaternion[4]) {
+  const bool compact = _format != GpuCrowdBuffer::kQuaternionKey;
+  const uint32_t stride =
+      _format == GpuCrowdBuffer::kPackedQuaternionKey ? 8 : compact ? 10 : 12;
+  uint32_t keys[2];
+  FindKeys(_buffer, _index, _keys, stride, compact, _num_tracks, _track,
+           _ratio, keys);
+  const float r0 = ReadRatio(_buffer, keys[0], compact);
+  const float r1 = ReadRatio(_buffer, keys[1], compact);
+  const float alpha = (_ratio - r0) / (r1 - r0);
+  float q0[4], q1[4];
+  DecodeQuaternion(_buffer, keys[0], _format, q0);
+  DecodeQuaternion(_buffer, keys[1], _format, q1);
+  float len2 = 0.f;
+  for (int c = 0; c < 4; ++c) {
+    _quaternion[c] = q0[c] + (q1[c] - q0[c]) * alpha;
+    len2 += _quaternion[c] * _quaternion[c];
+  }
+  const float inv_len = 1.f / std::sqrt(len2);
+  for (int c = 0; c < 4; ++c) {
+    _quaternion[c] *= inv_len;
+  }
+}
+
+// Samples joint _track local transform of the animation described by _desc.
+void SampleJoint(const uint32_t* _buffer, const uint32_t* _desc,
+                 uint32_t _num_tracks, uint32_t _track, float _ratio,
+                 float _t[3], float _q[4], float _s[3]) {
+  const uint32_t formats = _desc[GpuCrowdBuffer::kDescFormats];
+  SampleFloat3(_buffer, _desc[GpuCrowdBuffer::kDescTranslationIndex],
+               _desc[GpuCrowdBuffer::kDescTranslationKeys], formats & 3,
+               _num_tracks, _track, _ratio, _t);
+  SampleQuaternion(_buffer, _desc[GpuCrowdBuffer::kDescRotationIndex],
+                   _desc[GpuCrowdBuffer::kDescRotationKeys],
+                   (formats >> 2) & 3, _num_tracks, _track, _ratio, _q);
+  SampleFloat3(_buffer, _desc[GpuCrowdBuffer::kDescScaleIndex],
+               _desc[GpuCrowdBuffer::kDescScaleKeys], (formats >> 4) & 3,
+               _num_tracks, _track, _ratio, _s);
+}
+
+// Blends _t, _q, _s with _bt, _bq, _bs of weight _weight, as BlendingJob does:
+// weighted sum, opposed quaternions being negated, then normalized.
+void BlendJoint(float _weight, const float _bt[3], const float _bq[4],
+                const float _bs[3], float _t[3], float _q[4], float _s[3]) {
+  const float weight = 1.f - _weight;
+  float dot = 0.f;
+  for (int c = 0; c < 4; ++c) {
+    dot += _q[c] * _bq[c];
+  }
+  const float bweight = dot < 0.f ? -_weight : _weight;
+  float len2 = 0.f;
+  for (int c = 0; c < 4; ++c) {
+    _q[c] = _q[c] * weight + _bq[c] * bweight;
+    len2 += _q[c] * _q[c];
+  }
+  const float inv_len = 1.f / std::sqrt(len2);
+  for (int c = 0; c < 4; ++c) {
+    _q[c] *= inv_len;
+  }
+  for (int c = 0; c < 3; ++c) {
+    _t[c] = _t[c] * weight + _bt[c] * _weight;
+    _s[c] = _s[c] * weight + _bs[c] * _weight;
+  }
+}
+
+// Reads the column major matrix starting at word _word.
+math::Float4x4 ReadMatrix(const uint32_t* _buffer, uint32_t _word) {
+  math::Float4x4 matrix;
+  for (int c = 0; c < 4; ++c) {
+    const uint32_t col = _word + c * 4;
+    matrix.cols[c] = math::simd_float4::Load(
+        ReadFloat(_buffer, col), ReadFloat(_buffer, col + 1),
+        ReadFloat(_buffer, col + 2), ReadFloat(_buffer, col + 3));
+  }
+  return matrix;
+}
+}  // namespace
+
+GpuCrowdBuffer::GpuCrowdBuffer() {}
+
+bool GpuCrowdBuffer::Build(const Skeleton& _skeleton,
+                           span<const Animation* const> _animations,
+                           span<const math::Float4x4> _inverse_bind_poses) {
+  buffer_.clear();
+
+  // Keys are read as little endian words by the compute kernel.
+  if (GetNativeEndianness() != kLittleEndian) {
+    return false;
+  }
+
+  const int num_joints = _skeleton.num_joints();
+  if (!_inverse_bind_poses.empty() &&
+      _inverse_bind_poses.size() != static_cast<size_t>(num_joints)) {
+    return false;
+  }
+  for (const Animation* animation : _animations) {
+    if (!animation || animation->num_tracks() != num_joints ||
+        !animation->random_access() || animation->cubic()) {
+      return false;
+    }
+  }
+
+  buffer_.resize(kHeaderSize);
+  buffer_[kHeaderNumJoints] = static_cast<uint32_t>(num_joints);
+  buffer_[kHeaderNumAnimations] = static_cast<uint32_t>(_animations.size());
+
+  // Skeleton.
+  buffer_[kHeaderParents] = static_cast<uint32_t>(buffer_.size());
+  for (const int16_t parent : _skeleton.joint_parents()) {
+    buffer_.push_back(static_cast<uint32_t>(static_cast<int32_t>(parent)));
+  }
+  buffer_[kHeaderInverseBindPoses] = static_cast<uint32_t>(buffer_.size());
+  for (int i = 0; i < num_joints; ++i) {
+    const math::Float4x4 matrix = _inverse_bind_poses.empty()
+                                      ? math::Float4x4::identity()
+                                      : _inverse_bind_poses[i];
+    float values[16];
+    for (int c = 0; c < 4; ++c) {
+      math::StorePtrU(matrix.cols[c], values + c * 4);
+    }
+    AppendBytes(&buffer_, values, sizeof(values));
+  }
+
+  // Animations descriptors, followed by their data.
+  const uint32_t descriptors = static_cast<uint32_t>(buffer_.size());
+  buffer_[kHeaderAnimations] = descriptors;
+  buffer_.resize(descriptors + _animations.size() * kDescSize, 0);
+  for (size_t i = 0; i < _animations.size(); ++i) {
+    const Animation& animation = *_animations[i];
+    uint32_t desc[kDescSize];
+
+    uint32_t translation_format, rotation_format, scale_format;
+    desc[kDescTranslationIndex] =
+        AppendSpan(&buffer_, animation.translation_track_index());
+    if (!animation.compact_translations().empty()) {
+      translation_format = kCompactFloat3Key;
+      desc[kDescTranslationKeys] =
+          AppendSpan(&buffer_, animation.compact_translations());
+    } else {
+      translation_format = kFloat3Key;
+      desc[kDescTranslationKeys] =
+          AppendSpan(&buffer_, animation.translations());
+    }
+
+    desc[kDescRotationIndex] =
+        AppendSpan(&buffer_, animation.rotation_track_index());
+    if (!animation.compact_rotations().empty()) {
+      rotation_format = kCompactQuaternionKey;
+      desc[kDescRotationKeys] =
+          AppendSpan(&buffer_, animation.compact_rotations());
+    } else if (!animation.packed_rotations().empty()) {
+      rotation_format = kPackedQuaternionKey;
+      desc[kDescRotationKeys] =
+          AppendSpan(&buffer_, animation.packed_rotations());
+    } else {
+      rotation_format = kQuaternionKey;
+      desc[kDescRotationKeys] = AppendSpan(&buffer_, animation.rotations());
+    }
+
+    desc[kDescScaleIndex] = AppendSpan(&buffer_, animation.scale_track_index());
+    if (!animation.compact_scales().empty()) {
+      scale_format = kCompactFloat3Key;
+      desc[kDescScaleKeys] = AppendSpan(&buffer_, animation.compact_scales());
+    } else {
+      scale_format = kFloat3Key;
+      desc[kDescScaleKeys] = AppendSpan(&buffer_, animation.scales());
+    }
+
+    desc[kDescFormats] =
+        translation_format | (rotation_format << 2) | (scale_format << 4);
+    std::memcpy(buffer_.data() + descriptors + i * kDescSize, desc,
+                sizeof(desc));
+  }
+
+  return true;
+}
+
+int GpuCrowdBuffer::num_joints() const {
+  return buffer_.empty() ? 0 : static_cast<int>(buffer_[kHeaderNumJoints]);
+}
+
+int GpuCrowdBuffer::num_animations() const {
+  return buffer_.empty() ? 0
+                         : static_cast<int>(buffer_[kHeaderNumAnimations]);
+}
+
+bool GpuCrowdBuffer::Evaluate(span<const Instance> _instances,
+                              span<math::Float4x4> _palettes) const {
+  if (buffer_.empty()) {
+    return false;
+  }
+  const uint32_t num_joints = buffer_[kHeaderNumJoints];
+  if (_palettes.size() < _instances.size() * num_joints) {
+    return false;
+  }
+  for (const Instance& instance : _instances) {
+    if (instance.animation >= buffer_[kHeaderNumAnimations] ||
+        (instance.blend_weight > 0.f &&
+         instance.blend_animation >= buffer_[kHeaderNumAnimations])) {
+      return false;
+    }
+  }
+
+  const uint32_t* buffer = buffer_.data();
+  const uint32_t num_tracks = (num_joints + 3) & ~3u;
+  const uint32_t parents = buffer[kHeaderParents];
+  const uint32_t inverse_bind_poses = buffer[kHeaderInverseBindPoses];
+  for (size_t i = 0; i < _instances.size(); ++i) {
+    const Instance& instance = _instances[i];
+    const uint32_t* descs = buffer + buffer[kHeaderAnimations];
+    const uint32_t* desc = descs + instance.animation * kDescSize;
+    const float ratio = math::Clamp(0.f, instance.ratio, 1.f);
+    const float blend_weight = math::Clamp(0.f, instance.blend_weight, 1.f);
+    const uint32_t* blend_desc = descs + instance.blend_animation * kDescSize;
+    const float blend_ratio = math::Clamp(0.f, instance.blend_ratio, 1.f);
+    math::Float4x4* models = _palettes.begin() + i * num_joints;
+
+    // Samples joints local transforms and concatenates them to their parent,
+    // which precedes them in the skeleton.
+    for (uint32_t j = 0; j < num_joints; ++j) {
+      float t[3], q[4], s[3];
+      SampleJoint(buffer, desc, num_tracks, j, ratio, t, q, s);
+      if (blend_weight > 0.f) {
+        float bt[3], bq[4], bs[3];
+        SampleJoint(buffer, blend_desc, num_tracks, j, blend_ratio, bt, bq, bs);
+        BlendJoint(blend_weight, bt, bq, bs, t, q, s);
+      }
+      const math::Float4x4 local = math::Float4x4::FromAffine(
+          math::simd_float4::Load(t[0], t[1], t[2], 1.f),
+          math::simd_float4::Load(q[0], q[1], q[2], q[3]),
+          math::simd_float4::Load(s[0], s[1], s[2], 0.f));
+      const int32_t parent = static_cast<int32_t>(buffer[parents + j]);
+      models[j] = parent < 0 ? local : models[parent] * local;
+    }
+
+    // Once the hierarchy is done, model matrices are turned to skinning
+    // matrices.
+    for (uint32_t j = 0; j < num_joints; ++j) {
+      models[j] = models[j] * ReadMatrix(buffer, inverse_bind_poses + j * 16);
+    }
+  }
+  return true;
+}
+
+const char* GpuCrowdBuffer::compute_shader() {
+  return R"glsl(#version 430
+layout(local_size_x = 64) in;
+
+struct Instance {
+  uint animation;
+  float ratio;
+  uint blend_animation;
+  float blend_ratio;
+  float blend_weight;
+};
+layout(std430, binding = 0) readonly buffer CrowdBuffer { uint crowd[]; };
+layout(std430, binding = 1) readonly buffer Instances {
+  Instance instances[];
+};
+layout(std430, binding = 2) buffer Palettes { mat4 palettes[]; };
+uniform uint num_instances;
+
+uint ReadU16(uint _byte) {
+  return (crowd[_byte >> 2] >> ((_byte & 2u) * 8u)) & 0xffffu;
+}
+
+int ReadI16(uint _byte) { return bitfieldExtract(int(ReadU16(_byte)), 0, 16); }
+
+float ReadHalf(uint _byte) { return unpackHalf2x16(ReadU16(_byte)).x; }
+
+float ReadRatio(uint _byte, bool _compact) {
+  return _compact ? float(ReadU16(_byte)) / 65535.0
+                  : uintBitsToFloat(crowd[_byte >> 2]);
+}
+
+uvec2 FindKeys(uint _index, uint _keys, uint _stride, bool _compact,
+               uint _num_tracks, uint _track, float _ratio) {
+  uint indices = _index + _num_tracks + 1u;
+  int first = int(crowd[_index + _track]) + 1;
+  int count = int(crowd[_index + _track + 1u]) - 1 - first;
+  while (count > 0) {
+    int step = count / 2;
+    int it = first + step;
+    uint key = _keys * 4u + crowd[indices + uint(it)] * _stride;
+    if (_ratio >= ReadRatio(key, _compact)) {
+      first = it + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  return uvec2(_keys * 4u + crowd[indices + uint(first - 1)] * _stride,
+               _keys * 4u + crowd[indices + uint(first)] * _stride);
+}
+
+vec3 SampleFloat3(uint _index, uint _keys, uint _format, uint _num_tracks,
+                  uint _track, float _ratio) {
+  bool compact = _format == 1u;
+  uint stride = compact ? 10u : 12u;
+  uint values = compact ? 4u : 6u;
+  uvec2 keys = FindKeys(_index, _keys, stride, compact, _num_tracks, _track,
+                        _ratio);
+  float r0 = ReadRatio(keys.x, compact);
+  float r1 = ReadRatio(keys.y, compact);
+  vec3 v0 = vec3(ReadHalf(keys.x + values), ReadHalf(keys.x + values + 2u),
+                 ReadHalf(keys.x + values + 4u));
+  vec3 v1 = vec3(ReadHalf(keys.y + values), ReadHalf(keys.y + values + 2u),
+                 ReadHalf(keys.y + values + 4u));
+  return mix(v0, v1, (_ratio - r0) / (r1 - r0));
+}
+
+vec4 DecodeQuaternion(uint _byte, uint _format) {
+  uint bits = ReadU16(_byte + (_format == 0u ? 4u : 2u));
+  uint largest = (bits >> 13) & 3u;
+  ivec3 v;
+  float scale;
+  if (_format == 2u) {
+    int value = int(crowd[(_byte + 4u) >> 2]);
+    v = ivec3((value >> 21) * 511, ((value << 11) >> 21) * 511,
+              ((value << 22) >> 22) * 1023);
+    scale = 1023.0 * 511.0;
+  } else {
+    uint values = _byte + (_format == 0u ? 6u : 4u);
+    v = ivec3(ReadI16(values), ReadI16(values + 2u), ReadI16(values + 4u));
+    scale = 32767.0;
+  }
+  vec3 c = vec3(v) / (scale * 1.41421356);
+  float w = sqrt(max(1e-16, 1.0 - dot(c, c)));
+  w = (bits >> 15) != 0u ? -w : w;
+  if (largest == 0u) return vec4(w, c);
+  if (largest == 1u) return vec4(c.x, w, c.yz);
+  if (largest == 2u) return vec4(c.xy, w, c.z);
+  return vec4(c, w);
+}
+
+vec4 SampleQuaternion(uint _index, uint _keys, uint _format, uint _num_tracks,
+                      uint _track, float _ratio) {
+  bool compact = _format != 0u;
+  uint stride = _format == 2u ? 8u : (compact ? 10u : 12u);
+  uvec2 keys = FindKeys(_index, _keys, stride, compact, _num_tracks, _track,
+                        _ratio);
+  float r0 = ReadRatio(keys.x, compact);
+  float r1 = ReadRatio(keys.y, compact);
+  return normalize(mix(DecodeQuaternion(keys.x, _format),
+                       DecodeQuaternion(keys.y, _format),
+                       (_ratio - r0) / (r1 - r0)));
+}
+
+void SampleJoint(uint _desc, uint _num_tracks, uint _track, float _ratio,
+                 out vec3 _t, out vec4 _q, out vec3 _s) {
+  uint formats = crowd[_desc];
+  _t = SampleFloat3(crowd[_desc + 1u], crowd[_desc + 2u], formats & 3u,
+                    _num_tracks, _track, _ratio);
+  _q = SampleQuaternion(crowd[_desc + 3u], crowd[_desc + 4u],
+                        (formats >> 2) & 3u, _num_tracks, _track, _ratio);
+  _s = SampleFloat3(crowd[_desc + 5u], crowd[_desc + 6u], (formats >> 4) & 3u,
+                    _num_tracks, _track, _ratio);
+}
+
+mat4 Affine(vec3 _t, vec4 _q, vec3 _s) {
+  vec3 q2 = _q.xyz * 2.0;
+  float xx = _q.x * q2.x, yy = _q.y * q2.y, zz = _q.z * q2.z;
+  float xy = _q.x * q2.y, xz = _q.x * q2.z, yz = _q.y * q2.z;
+  float wx = _q.w * q2.x, wy = _q.w * q2.y, wz = _q.w * q2.z;
+  return mat4(vec4(1.0 - yy - zz, xy + wz, xz - wy, 0.0) * _s.x,
+              vec4(xy - wz, 1.0 - xx - zz, yz + wx, 0.0) * _s.y,
+              vec4(xz + wy, yz - wx, 1.0 - xx - yy, 0.0) * _s.z,
+              vec4(_t, 1.0));
+}
+
+mat4 ReadMatrix(uint _word) {
+  return mat4(uintBitsToFloat(uvec4(crowd[_word], crowd[_word + 1u],
+                                    crowd[_word + 2u], crowd[_word + 3u])),
+              uintBitsToFloat(uvec4(crowd[_word + 4u], crowd[_word + 5u],
+                                    crowd[_word + 6u], crowd[_word + 7u])),
+              uintBitsToFloat(uvec4(crowd[_word + 8u], crowd[_word + 9u],
+                                    crowd[_word + 10u], crowd[_word + 11u])),
+              uintBitsToFloat(uvec4(crowd[_word + 12u], crowd[_word + 13u],
+                                    crowd[_word + 14u], crowd[_word + 15u])));
+}
+
+void main() {
+  uint instance = gl_GlobalInvocationID.x;
+  if (instance >= num_instances) {
+    return;
+  }
+  uint num_joints = crowd[0];
+  uint num_tracks = (num_joints + 3u) & ~3u;
+  uint parents = crowd[2];
+  uint inverse_bind_poses = crowd[3];
+  uint desc = crowd[4] + instances[instance].animation * 7u;
+  float ratio = clamp(instances[instance].ratio, 0.0, 1.0);
+  uint blend_desc = crowd[4] + instances[instance].blend_animation * 7u;
+  float blend_ratio = clamp(instances[instance].blend_ratio, 0.0, 1.0);
+  float blend_weight = clamp(instances[instance].blend_weight, 0.0, 1.0);
+  uint base = instance * num_joints;
+
+  for (uint j = 0u; j < num_joints; ++j) {
+    vec3 t, s;
+    vec4 q;
+    SampleJoint(desc, num_tracks, j, ratio, t, q, s);
+    if (blend_weight > 0.0) {
+      vec3 bt, bs;
+      vec4 bq;
+      SampleJoint(blend_desc, num_tracks, j, blend_ratio, bt, bq, bs);
+      float bweight = dot(q, bq) < 0.0 ? -blend_weight : blend_weight;
+      q = normalize(q * (1.0 - blend_weight) + bq * bweight);
+      t = mix(t, bt, blend_weight);
+      s = mix(s, bs, blend_weight);
+    }
+    mat4 local = Affine(t, q, s);
+    int parent = int(crowd[parents + j]);
+    palettes[base + j] =
+        parent < 0 ? local : palettes[base + uint(parent)] * local;
+  }
+
+  for (uint j = 0u; j < num_joints; ++j) {
+    palettes[base + j] =
+        palettes[base + j] * ReadMatrix(inverse_bind_poses + j * 16u);
+  }
+}
+)glsl";
+}
+}  // namespace animation
+}  // namespace ozz
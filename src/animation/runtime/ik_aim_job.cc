@@ -31,6 +31,14 @@
 
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/simd_quaternion.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/profile.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/ik_soa.h"
 
 using namespace ozz::math;
 
@@ -95,6 +103,8 @@ bool ComputeOffsettedForward(_SimdFloat4 _forward, _SimdFloat4 _offset,
 }  // namespace
 
 bool IKAimJob::Run() const {
+  OZZ_PROFILE_ZONE("IKAimJob::Run");
+
   if (!Validate()) {
     return false;
   }
@@ -218,5 +228,201 @@ bool IKAimJob::Run() const {
 
   return true;
 }
+
+BatchIKAimJob::BatchIKAimJob()
+    : forward(simd_float4::x_axis()),
+      offset(simd_float4::zero()),
+      chain_length(1),
+      twist_angle(0.f) {}
+
+bool BatchIKAimJob::Validate() const {
+  bool valid = true;
+  valid &= chain_length > 0;
+  if (!valid) {
+    return false;
+  }
+  const size_t length = static_cast<size_t>(chain_length);
+  const size_t num_instances = targets.size();
+  valid &= ups.size() >= length;
+  valid &= weights.size() >= length;
+  valid &= pole_vectors.size() >= num_instances;
+  valid &= joints.size() >= num_instances * length;
+  valid &= joint_corrections.size() >= num_instances * length;
+  valid &= reached.empty() || reached.size() >= num_instances * length;
+  if (!valid) {
+    return false;
+  }
+  for (size_t i = 0; i < num_instances * length; ++i) {
+    valid &= joints[i] != nullptr;
+  }
+  valid &= ozz::math::AreAllTrue1(ozz::math::IsNormalizedEst3(forward));
+  return valid;
+}
+
+namespace {
+
+// Solves aim IK for 4 joints, following IKAimJob::Run stages. Returns reached
+// mask.
+SimdInt4 SolveSoa(const SoaFloat4x4& _inv_joint, const SoaFloat3& _target,
+                  const SoaFloat3& _pole_vector, const SoaFloat3& _forward,
+                  const SoaFloat3& _offset, _SimdFloat4 _up,
+                  float _twist_angle, float _weight,
+                  SoaQuaternion* _correction) {
+  const SimdFloat4 zero = simd_float4::zero();
+  const SimdFloat4 one = simd_float4::one();
+  const SoaQuaternion identity = SoaQuaternion::identity();
+
+  // Computes joint to target vector, in joint local-space (_js).
+  const SoaFloat3 joint_to_target_js =
+      internal::TransformPoint(_inv_joint, _target);
+  const SimdFloat4 joint_to_target_js_len2 = LengthSqr(joint_to_target_js);
+
+  // Recomputes forward vector to account for offset, see
+  // ComputeOffsettedForward.
+  const SimdFloat4 AOl = Dot(_forward, _offset);
+  const SimdFloat4 ACl2 = LengthSqr(_offset) - AOl * AOl;
+  const SimdFloat4 r2 = joint_to_target_js_len2;
+  const SimdInt4 reached = CmpLe(ACl2, r2);
+  const SimdFloat4 AIl = Sqrt(Max0(r2 - ACl2));
+  const SoaFloat3 offsetted_forward = _offset + _forward * (AIl - AOl);
+
+  // Calculates joint_to_target_rot_js quaternion which solves for
+  // offsetted_forward vector rotating onto the target.
+  const SoaQuaternion joint_to_target_rot_js =
+      internal::FromVectors(offsetted_forward, joint_to_target_js);
+
+  // Calculates rotate_plane_js quaternion which aligns joint up to the pole
+  // vector.
+  const SoaFloat3 corrected_up_js = internal::TransformVector(
+      joint_to_target_rot_js, internal::SplatSoa(_up));
+  const SoaFloat3 pole_vector_js =
+      internal::TransformVector(_inv_joint, _pole_vector);
+  const SoaFloat3 ref_joint_normal_js =
+      Cross(pole_vector_js, joint_to_target_js);
+  const SoaFloat3 joint_normal_js = Cross(corrected_up_js, joint_to_target_js);
+  const SimdFloat4 ref_joint_normal_js_len2 = LengthSqr(ref_joint_normal_js);
+  const SimdFloat4 joint_normal_js_len2 = LengthSqr(joint_normal_js);
+
+  const SoaFloat3 rotate_plane_axis_js =
+      joint_to_target_js * RSqrtEstNR(joint_to_target_js_len2);
+  const SimdFloat4 rotate_plane_cos_angle =
+      Dot(joint_normal_js * RSqrtEstNR(joint_normal_js_len2),
+          ref_joint_normal_js * RSqrtEstNR(ref_joint_normal_js_len2));
+  const SimdFloat4 axis_flip =
+      And(Dot(ref_joint_normal_js, corrected_up_js), simd_int4::mask_sign());
+  const SoaFloat3 rotate_plane_axis_flipped_js = {
+      Xor(rotate_plane_axis_js.x, axis_flip),
+      Xor(rotate_plane_axis_js.y, axis_flip),
+      Xor(rotate_plane_axis_js.z, axis_flip)};
+  const SoaQuaternion rotate_plane = internal::FromAxisCosAngle(
+      rotate_plane_axis_flipped_js, Clamp(-one, rotate_plane_cos_angle, one));
+
+  // Computing rotation plane requires valid normals.
+  const SimdInt4 valid_normals =
+      And(And(CmpNe(joint_to_target_js_len2, zero),
+              CmpNe(joint_normal_js_len2, zero)),
+          CmpNe(ref_joint_normal_js_len2, zero));
+  const SoaQuaternion rotate_plane_js =
+      internal::Select(valid_normals, rotate_plane, identity);
+
+  // Twists rotation plane.
+  SoaQuaternion twisted = rotate_plane_js * joint_to_target_rot_js;
+  if (_twist_angle != 0.f) {
+    twisted =
+        internal::FromAxisAngle(rotate_plane_axis_js, _twist_angle) * twisted;
+  }
+
+  // Weights output quaternion.
+  SoaQuaternion weighted;
+  if (_weight < 1.f) {
+    weighted = NormalizeEst(
+        Lerp(identity, twisted, Max0(simd_float4::Load1(_weight))));
+  } else {
+    weighted = internal::FixUp(twisted);
+  }
+
+  // Target can't be reached or is too close to joint position to find a
+  // direction.
+  *_correction = internal::Select(
+      And(reached, CmpNe(joint_to_target_js_len2, zero)), weighted, identity);
+
+  return reached;
+}
+}  // namespace
+
+bool BatchIKAimJob::Run() const {
+  OZZ_PROFILE_ZONE("BatchIKAimJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const size_t num_instances = targets.size();
+  const size_t length = static_cast<size_t>(chain_length);
+  for (size_t g = 0; g < num_instances; g += 4) {
+    // Gathers a group of 4 instances. The last group is padded with its last
+    // instance, whose outputs are only written once.
+    const size_t num_group_instances = math::Min(num_instances - g, size_t(4));
+    size_t n[4];
+    for (size_t k = 0; k < 4; ++k) {
+      n[k] = g + math::Min(k, num_group_instances - 1);
+    }
+    const SoaFloat3 target = internal::TransposeSoa(
+        targets[n[0]], targets[n[1]], targets[n[2]], targets[n[3]]);
+    const SoaFloat3 pole_vector =
+        internal::TransposeSoa(pole_vectors[n[0]], pole_vectors[n[1]],
+                               pole_vectors[n[2]], pole_vectors[n[3]]);
+
+    // First joint uses job forward and offset.
+    SoaFloat3 joint_forward = internal::SplatSoa(forward);
+    SoaFloat3 joint_offset = internal::SplatSoa(offset);
+    SoaQuaternion correction;
+    SoaFloat4x4 previous_joint;
+
+    for (size_t i = 0; i < length; ++i) {
+      const Float4x4* chain_joints[4];
+      for (size_t k = 0; k < 4; ++k) {
+        chain_joints[k] = joints[n[k] * length + i];
+      }
+      const SoaFloat4x4 joint = internal::TransposeSoa(chain_joints);
+
+      // If matrices aren't invertible, they'll be all 0 (ozz::math
+      // implementation), which will result in identity correction quaternions.
+      SimdInt4 invertible;
+      const SoaFloat4x4 inv_joint = Invert(joint, &invertible);
+
+      if (i != 0) {
+        // Applies previous correction to forward and offset, before bringing
+        // them to model-space (_ms), and then to joint local-space.
+        const SoaFloat3 corrected_forward_ms = internal::TransformVector(
+            previous_joint,
+            internal::TransformVector(correction, joint_forward));
+        const SoaFloat3 corrected_offset_ms = internal::TransformPoint(
+            previous_joint,
+            internal::TransformVector(correction, joint_offset));
+        joint_forward =
+            internal::TransformVector(inv_joint, corrected_forward_ms);
+        joint_offset = internal::TransformPoint(inv_joint, corrected_offset_ms);
+      }
+
+      const SimdInt4 lreached =
+          SolveSoa(inv_joint, target, pole_vector, joint_forward, joint_offset,
+                   ups[i], twist_angle, weights[i], &correction);
+      previous_joint = joint;
+
+      // Outputs.
+      SimdQuaternion corrections[4];
+      internal::TransposeAos(correction, corrections);
+      const int reached_mask = MoveMask(lreached);
+      for (size_t k = 0; k < num_group_instances; ++k) {
+        joint_corrections[(g + k) * length + i] = corrections[k];
+        if (!reached.empty()) {
+          reached[(g + k) * length + i] = (reached_mask & (1 << k)) != 0;
+        }
+      }
+    }
+  }
+  return true;
+}
 }  // namespace animation
 }  // namespace ozz
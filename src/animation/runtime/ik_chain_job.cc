@@ -0,0 +1,190 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/ik_chain_job.h"
+
+#include <cassert>
+
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_quaternion.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+
+using namespace ozz::math;
+
+namespace ozz {
+namespace animation {
+
+IKChainJob::IKChainJob()
+    : skeleton(nullptr),
+      target(simd_float4::zero()),
+      iterations(8),
+      tolerance(1e-3f),
+      weight(1.f),
+      reached(nullptr) {}
+
+bool IKChainJob::Validate() const {
+  if (!skeleton) {
+    return false;
+  }
+  bool valid = true;
+  const int num_joints = skeleton->num_joints();
+  valid &= locals.size() >= static_cast<size_t>(skeleton->num_soa_joints());
+  valid &= models.size() >= static_cast<size_t>(num_joints);
+  valid &= iterations > 0;
+  valid &= joints.size() >= 2;
+  if (!valid) {
+    return false;
+  }
+
+  // Every joint must be a descendant of the previous one. As parents are
+  // always stored before their children, walking up the hierarchy can stop as
+  // soon as the previous joint index is reached.
+  const span<const int16_t> parents = skeleton->joint_parents();
+  for (size_t i = 0; i < joints.size(); ++i) {
+    const int joint = joints[i];
+    if (joint < 0 || joint >= num_joints) {
+      return false;
+    }
+    if (i != 0) {
+      const int ancestor = joints[i - 1];
+      int parent = parents[joint];
+      while (parent > ancestor) {
+        parent = parents[parent];
+      }
+      if (parent != ancestor) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+namespace {
+
+// Post multiplies local-space rotation of joint _index by _quat.
+void MultiplyLocalRotation(int _index, const SimdQuaternion& _quat,
+                           const span<SoaTransform>& _locals) {
+  // Converts soa to aos in order to perform quaternion multiplication, and
+  // gets back to soa. Result is normalized as corrections accumulate over
+  // iterations.
+  SoaTransform& soa_transform = _locals[_index / 4];
+  SimdQuaternion aos_quats[4];
+  Transpose4x4(&soa_transform.rotation.x, &aos_quats->xyzw);
+  SimdQuaternion& aos_quat = aos_quats[_index & 3];
+  aos_quat = Normalize(aos_quat * _quat);
+  Transpose4x4(&aos_quats->xyzw, &soa_transform.rotation.x);
+}
+}  // namespace
+
+bool IKChainJob::Run() const {
+  OZZ_PROFILE_ZONE("IKChainJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int start = joints[0];
+  const int end = joints[joints.size() - 1];
+  const SimdFloat4 tolerance2 = simd_float4::Load1(tolerance * tolerance);
+  const SimdFloat4 simd_weight =
+      Clamp(simd_float4::zero(), simd_float4::Load1(weight),
+            simd_float4::one());
+
+  // Local-to-model job used to update the chain once a joint is rotated. Its
+  // "from" is set to the rotated joint, and "to" to the end of the chain.
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = skeleton;
+  ltm_job.input = locals;
+  ltm_job.output = models;
+  ltm_job.to = end;
+
+  bool lreached = false;
+  bool updated = false;
+  for (int it = 0;; ++it) {
+    lreached = AreAllTrue1(
+        CmpLe(Length3Sqr(models[end].cols[3] - target), tolerance2));
+    if (lreached || it == iterations) {
+      break;
+    }
+
+    // Iterates from the joint before the end, down to the start.
+    for (size_t i = joints.size() - 1; i-- > 0;) {
+      const int joint = joints[i];
+
+      // Computes joint to end and joint to target vectors, in joint
+      // local-space (_js). If matrices aren't invertible, they'll be all 0
+      // (ozz::math implementation), which will result in identity correction
+      // quaternions.
+      SimdInt4 invertible;
+      const Float4x4 inv_joint = Invert(models[joint], &invertible);
+      const SimdFloat4 joint_to_end_js =
+          TransformPoint(inv_joint, models[end].cols[3]);
+      const SimdFloat4 joint_to_target_js = TransformPoint(inv_joint, target);
+
+      // Fix up quaternion so w is always positive, which is required for NLerp
+      // (with identity quaternion) to lerp the shortest path.
+      SimdQuaternion correction =
+          SimdQuaternion::FromVectors(joint_to_end_js, joint_to_target_js);
+      correction.xyzw =
+          Xor(correction.xyzw,
+              And(simd_int4::mask_sign(),
+                  CmpLt(SplatW(correction.xyzw), simd_float4::zero())));
+      if (weight < 1.f) {
+        correction.xyzw = NormalizeEst4(
+            Lerp(simd_float4::w_axis(), correction.xyzw, simd_weight));
+      }
+
+      // Applies correction and updates model-space matrices of the chain,
+      // from the rotated joint to the end.
+      MultiplyLocalRotation(joint, correction, locals);
+      ltm_job.from = joint;
+      if (!ltm_job.Run()) {
+        return false;
+      }
+      updated = true;
+    }
+  }
+
+  // Chain joints descendants that aren't part of [start, end] range weren't
+  // updated by iterations.
+  if (updated) {
+    ltm_job.from = start;
+    ltm_job.to = Skeleton::kMaxJoints;
+    if (!ltm_job.Run()) {
+      return false;
+    }
+  }
+
+  if (reached) {
+    *reached = lreached;
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,207 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_ANIMATION_RUNTIME_IK_SOA_H_
+#define OZZ_ANIMATION_RUNTIME_IK_SOA_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+#include <cmath>
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/simd_quaternion.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_quaternion.h"
+
+namespace ozz {
+namespace animation {
+namespace internal {
+
+// Implements SoA helpers shared by batched IK jobs, which solve 4 IK problems
+// at once, one per SIMD lane.
+
+// Transposes 4 SimdFloat4 to a SoaFloat3, w components being ignored.
+inline math::SoaFloat3 TransposeSoa(math::_SimdFloat4 _v0,
+                                    math::_SimdFloat4 _v1,
+                                    math::_SimdFloat4 _v2,
+                                    math::_SimdFloat4 _v3) {
+  const math::SimdFloat4 in[4] = {_v0, _v1, _v2, _v3};
+  math::SimdFloat4 out[4];
+  math::Transpose4x4(in, out);
+  const math::SoaFloat3 ret = {out[0], out[1], out[2]};
+  return ret;
+}
+
+// Converts 4 matrices to a SoA matrix.
+inline math::SoaFloat4x4 TransposeSoa(const math::Float4x4* const* _matrices) {
+  math::SoaFloat4x4 ret;
+  for (int c = 0; c < 4; ++c) {
+    const math::SimdFloat4 in[4] = {
+        _matrices[0]->cols[c], _matrices[1]->cols[c], _matrices[2]->cols[c],
+        _matrices[3]->cols[c]};
+    math::Transpose4x4(in, &ret.cols[c].x);
+  }
+  return ret;
+}
+
+// Converts SoA quaternion _soa to 4 aos quaternions.
+inline void TransposeAos(const math::SoaQuaternion& _soa,
+                         math::SimdQuaternion* _aos) {
+  const math::SimdFloat4 in[4] = {_soa.x, _soa.y, _soa.z, _soa.w};
+  math::SimdFloat4 out[4];
+  math::Transpose4x4(in, out);
+  for (int i = 0; i < 4; ++i) {
+    _aos[i].xyzw = out[i];
+  }
+}
+
+// Splats _v xyz components to a SoaFloat3.
+inline math::SoaFloat3 SplatSoa(math::_SimdFloat4 _v) {
+  const math::SoaFloat3 ret = {math::SplatX(_v), math::SplatY(_v),
+                               math::SplatZ(_v)};
+  return ret;
+}
+
+// Returns the translation part of matrices _m.
+inline math::SoaFloat3 Translation(const math::SoaFloat4x4& _m) {
+  const math::SoaFloat3 ret = {_m.cols[3].x, _m.cols[3].y, _m.cols[3].z};
+  return ret;
+}
+
+// See TransformVector(Float4x4, SimdFloat4).
+inline math::SoaFloat3 TransformVector(const math::SoaFloat4x4& _m,
+                                       const math::SoaFloat3& _v) {
+  const math::SoaFloat3 ret = {
+      _m.cols[0].x * _v.x + _m.cols[1].x * _v.y + _m.cols[2].x * _v.z,
+      _m.cols[0].y * _v.x + _m.cols[1].y * _v.y + _m.cols[2].y * _v.z,
+      _m.cols[0].z * _v.x + _m.cols[1].z * _v.y + _m.cols[2].z * _v.z};
+  return ret;
+}
+
+// See TransformPoint(Float4x4, SimdFloat4).
+inline math::SoaFloat3 TransformPoint(const math::SoaFloat4x4& _m,
+                                      const math::SoaFloat3& _v) {
+  return TransformVector(_m, _v) + Translation(_m);
+}
+
+// See TransformVector(SimdQuaternion, SimdFloat4).
+inline math::SoaFloat3 TransformVector(const math::SoaQuaternion& _q,
+                                       const math::SoaFloat3& _v) {
+  const math::SoaFloat3 q = {_q.x, _q.y, _q.z};
+  const math::SoaFloat3 cross1 = _v * _q.w + math::Cross(q, _v);
+  const math::SoaFloat3 cross2 = math::Cross(q, cross1);
+  return _v + cross2 + cross2;
+}
+
+// Builds quaternions from normalized axes and half angles sine and cosine.
+inline math::SoaQuaternion FromAxisSinCos(const math::SoaFloat3& _axis,
+                                          math::_SimdFloat4 _half_sin,
+                                          math::_SimdFloat4 _half_cos) {
+  const math::SoaQuaternion ret = {_axis.x * _half_sin, _axis.y * _half_sin,
+                                   _axis.z * _half_sin, _half_cos};
+  return ret;
+}
+
+// See SimdQuaternion::FromAxisCosAngle. _cos must be in range [-1,1].
+inline math::SoaQuaternion FromAxisCosAngle(const math::SoaFloat3& _axis,
+                                            math::_SimdFloat4 _cos) {
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 half_cos2 =
+      (one + _cos) * math::simd_float4::Load1(.5f);
+  return FromAxisSinCos(_axis, math::Sqrt(one - half_cos2),
+                        math::Sqrt(half_cos2));
+}
+
+// Builds quaternions rotating around normalized axes _axis by a constant
+// _angle.
+inline math::SoaQuaternion FromAxisAngle(const math::SoaFloat3& _axis,
+                                         float _angle) {
+  const float half_angle = _angle * .5f;
+  return FromAxisSinCos(_axis, math::simd_float4::Load1(std::sin(half_angle)),
+                        math::simd_float4::Load1(std::cos(half_angle)));
+}
+
+// Selects _true quaternion lanes where _b is true, _false otherwise.
+inline math::SoaQuaternion Select(math::_SimdInt4 _b,
+                                  const math::SoaQuaternion& _true,
+                                  const math::SoaQuaternion& _false) {
+  const math::SoaQuaternion ret = {math::Select(_b, _true.x, _false.x),
+                                   math::Select(_b, _true.y, _false.y),
+                                   math::Select(_b, _true.z, _false.z),
+                                   math::Select(_b, _true.w, _false.w)};
+  return ret;
+}
+
+// Negates quaternions whose w is negative, so w is always positive, which is
+// required for NLerp (with identity quaternion) to lerp the shortest path.
+inline math::SoaQuaternion FixUp(const math::SoaQuaternion& _q) {
+  const math::SimdInt4 flip =
+      math::And(math::simd_int4::mask_sign(),
+                math::CmpLt(_q.w, math::simd_float4::zero()));
+  const math::SoaQuaternion ret = {math::Xor(_q.x, flip), math::Xor(_q.y, flip),
+                                   math::Xor(_q.z, flip),
+                                   math::Xor(_q.w, flip)};
+  return ret;
+}
+
+// See SimdQuaternion::FromVectors.
+inline math::SoaQuaternion FromVectors(const math::SoaFloat3& _from,
+                                       const math::SoaFloat3& _to) {
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 norm_from_norm_to =
+      math::Sqrt(math::LengthSqr(_from) * math::LengthSqr(_to));
+  const math::SimdFloat4 real_part = norm_from_norm_to + math::Dot(_from, _to);
+
+  // General case, and opposite vectors case, rotating 180 degrees around an
+  // arbitrary orthogonal axis.
+  const math::SoaFloat3 axis = math::Cross(_from, _to);
+  const math::SimdInt4 opposite = math::CmpLt(
+      real_part, math::simd_float4::Load1(1.e-6f) * norm_from_norm_to);
+  const math::SimdInt4 x_major =
+      math::CmpGt(math::Abs(_from.x), math::Abs(_from.z));
+  math::SoaQuaternion quat;
+  quat.x = math::Select(opposite, math::Select(x_major, -_from.y, zero),
+                        axis.x);
+  quat.y = math::Select(opposite, math::Select(x_major, _from.x, -_from.z),
+                        axis.y);
+  quat.z = math::Select(opposite, math::Select(x_major, zero, _from.y),
+                        axis.z);
+  quat.w = math::Select(opposite, zero, real_part);
+  quat = math::Normalize(quat);
+
+  // Null vectors case.
+  const math::SimdInt4 null =
+      math::CmpLt(norm_from_norm_to, math::simd_float4::Load1(1.e-6f));
+  return Select(null, math::SoaQuaternion::identity(), quat);
+}
+}  // namespace internal
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_ANIMATION_RUNTIME_IK_SOA_H_
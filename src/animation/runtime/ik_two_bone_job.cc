@@ -32,6 +32,14 @@
 #include "ozz/base/log.h"
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/simd_quaternion.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/profile.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/ik_soa.h"
 
 using namespace ozz::math;
 
@@ -345,6 +353,8 @@ void WeightOutput(const IKTwoBoneJob& _job, const IKConstantSetup& _setup,
 }  // namespace
 
 bool IKTwoBoneJob::Run() const {
+  OZZ_PROFILE_ZONE("IKTwoBoneJob::Run");
+
   if (!Validate()) {
     return false;
   }
@@ -388,5 +398,268 @@ bool IKTwoBoneJob::Run() const {
 
   return true;
 }
+
+BatchIKTwoBoneJob::BatchIKTwoBoneJob()
+    : mid_axis(math::simd_float4::z_axis()),
+      twist_angle(0.f),
+      soften(1.f),
+      weight(1.f) {}
+
+bool BatchIKTwoBoneJob::Validate() const {
+  bool valid = true;
+  const size_t num_chains = start_joints.size();
+  valid &= mid_joints.size() >= num_chains;
+  valid &= end_joints.size() >= num_chains;
+  valid &= targets.size() >= num_chains;
+  valid &= pole_vectors.size() >= num_chains;
+  valid &= start_joint_corrections.size() >= num_chains;
+  valid &= mid_joint_corrections.size() >= num_chains;
+  valid &= reached.empty() || reached.size() >= num_chains;
+  if (!valid) {
+    return false;
+  }
+  for (size_t i = 0; i < num_chains; ++i) {
+    valid &= start_joints[i] && mid_joints[i] && end_joints[i];
+  }
+  valid &= ozz::math::AreAllTrue1(ozz::math::IsNormalizedEst3(mid_axis));
+  return valid;
+}
+
+namespace {
+
+// Solves 4 chains, following IKTwoBoneJob stages. Returns reached mask.
+SimdInt4 SolveSoa(const BatchIKTwoBoneJob& _job, const Float4x4* const* _start,
+                  const Float4x4* const* _mid, const Float4x4* const* _end,
+                  _SimdFloat4 _target0, _SimdFloat4 _target1,
+                  _SimdFloat4 _target2, _SimdFloat4 _target3,
+                  _SimdFloat4 _pole0, _SimdFloat4 _pole1, _SimdFloat4 _pole2,
+                  _SimdFloat4 _pole3, SoaQuaternion* _start_rot,
+                  SoaQuaternion* _mid_rot) {
+  const SimdFloat4 zero = simd_float4::zero();
+  const SimdFloat4 one = simd_float4::one();
+  const SimdFloat4 m_one = -one;
+  const SimdFloat4 half = simd_float4::Load1(.5f);
+  const SimdInt4 mask_sign = simd_int4::mask_sign();
+
+  // Constant setup, see IKConstantSetup.
+  const SoaFloat4x4 start_joint = internal::TransposeSoa(_start);
+  const SoaFloat4x4 mid_joint = internal::TransposeSoa(_mid);
+  const SoaFloat3 start_pos = internal::Translation(start_joint);
+  const SoaFloat3 mid_pos = internal::Translation(mid_joint);
+  const SoaFloat3 end_pos =
+      internal::TransposeSoa(_end[0]->cols[3], _end[1]->cols[3],
+                             _end[2]->cols[3], _end[3]->cols[3]);
+  SimdInt4 invertible;
+  const SoaFloat4x4 inv_start_joint = Invert(start_joint, &invertible);
+  const SoaFloat4x4 inv_mid_joint = Invert(mid_joint, &invertible);
+
+  const SoaFloat3 start_mid_ms =
+      -internal::TransformPoint(inv_mid_joint, start_pos);
+  const SoaFloat3 mid_end_ms = internal::TransformPoint(inv_mid_joint, end_pos);
+  const SoaFloat3 start_mid_ss =
+      internal::TransformPoint(inv_start_joint, mid_pos);
+  const SoaFloat3 end_ss = internal::TransformPoint(inv_start_joint, end_pos);
+  const SimdFloat4 start_mid_ss_len2 = LengthSqr(start_mid_ss);
+  const SimdFloat4 mid_end_ss_len2 = LengthSqr(end_ss - start_mid_ss);
+  const SimdFloat4 start_end_ss_len2 = LengthSqr(end_ss);
+
+  // Softens target, see SoftenTarget.
+  const SoaFloat3 start_target_original_ss = internal::TransformPoint(
+      inv_start_joint,
+      internal::TransposeSoa(_target0, _target1, _target2, _target3));
+  const SimdFloat4 start_target_original_ss_len2 =
+      LengthSqr(start_target_original_ss);
+  const SimdFloat4 start_mid_ss_len = Sqrt(start_mid_ss_len2);
+  const SimdFloat4 mid_end_ss_len = Sqrt(mid_end_ss_len2);
+  const SimdFloat4 start_target_original_ss_len =
+      Sqrt(start_target_original_ss_len2);
+  const SimdFloat4 bone_len_diff_abs = Abs(start_mid_ss_len - mid_end_ss_len);
+  const SimdFloat4 bones_chain_len = start_mid_ss_len + mid_end_ss_len;
+  const SimdFloat4 da =
+      bones_chain_len * Clamp(zero, simd_float4::Load1(_job.soften), one);
+  const SimdFloat4 ds = bones_chain_len - da;
+
+  const SimdInt4 further = CmpGt(start_target_original_ss_len, da);
+  const SimdInt4 soften =
+      And(And(further, CmpGt(start_target_original_ss_len, zero)),
+          CmpGt(ds, zero));
+  const SimdFloat4 alpha = (start_target_original_ss_len - da) * RcpEst(ds);
+  const SimdFloat4 op = alpha + simd_float4::Load1(3.f);
+  const SimdFloat4 op2 = op * op;
+  const SimdFloat4 ratio = simd_float4::Load1(81.f) * RcpEst(op2 * op2);
+  const SimdFloat4 start_target_soften_ss_len = da + ds - ds * ratio;
+  const SimdFloat4 soften_scale =
+      start_target_soften_ss_len * RcpEst(start_target_original_ss_len);
+  const SoaFloat3 start_target_ss = {
+      Select(soften, start_target_original_ss.x * soften_scale,
+             start_target_original_ss.x),
+      Select(soften, start_target_original_ss.y * soften_scale,
+             start_target_original_ss.y),
+      Select(soften, start_target_original_ss.z * soften_scale,
+             start_target_original_ss.z)};
+  const SimdFloat4 start_target_ss_len2 =
+      Select(soften, start_target_soften_ss_len * start_target_soften_ss_len,
+             start_target_original_ss_len2);
+  const SimdInt4 reached = AndNot(
+      CmpGt(start_target_original_ss_len, bone_len_diff_abs), further);
+
+  // Computes mid joint rotation, see ComputeMidJoint. Angles are never
+  // computed, quaternion half angles sine and cosine are deduced from the
+  // cosines instead.
+  const SimdFloat4 start_mid_end_sum_ss_len2 =
+      start_mid_ss_len2 + mid_end_ss_len2;
+  const SimdFloat4 start_mid_end_ss_half_rlen =
+      half * RSqrtEstNR(start_mid_ss_len2 * mid_end_ss_len2);
+  const SimdFloat4 corrected_cos = Clamp(
+      m_one,
+      (start_mid_end_sum_ss_len2 - start_target_ss_len2) *
+          start_mid_end_ss_half_rlen,
+      one);
+  const SimdFloat4 initial_cos = Clamp(
+      m_one,
+      (start_mid_end_sum_ss_len2 - start_end_ss_len2) *
+          start_mid_end_ss_half_rlen,
+      one);
+  const SoaFloat3 mid_axis = internal::SplatSoa(_job.mid_axis);
+  const SoaFloat3 bent_side_ref = Cross(start_mid_ms, mid_axis);
+  const SimdInt4 bent_side_flip = CmpLt(Dot(bent_side_ref, mid_end_ms), zero);
+
+  // Corrected angle is in [0,pi], initial one in [-pi,pi].
+  const SimdFloat4 corrected_half_cos = Sqrt((one + corrected_cos) * half);
+  const SimdFloat4 corrected_half_sin = Sqrt((one - corrected_cos) * half);
+  const SimdFloat4 initial_half_cos = Sqrt((one + initial_cos) * half);
+  const SimdFloat4 initial_half_sin =
+      Xor(Sqrt((one - initial_cos) * half), And(bent_side_flip, mask_sign));
+
+  // Half angles difference.
+  const SimdFloat4 mid_half_cos = corrected_half_cos * initial_half_cos +
+                                  corrected_half_sin * initial_half_sin;
+  const SimdFloat4 mid_half_sin = corrected_half_sin * initial_half_cos -
+                                  corrected_half_cos * initial_half_sin;
+  const SoaQuaternion mid_rot_ms =
+      internal::FromAxisSinCos(mid_axis, mid_half_sin, mid_half_cos);
+
+  // Computes start joint rotation, see ComputeStartJoint.
+  const SoaFloat3 pole_ss = internal::TransformVector(
+      inv_start_joint,
+      internal::TransposeSoa(_pole0, _pole1, _pole2, _pole3));
+  const SoaFloat3 mid_end_ss_final = internal::TransformVector(
+      inv_start_joint,
+      internal::TransformVector(
+          mid_joint, internal::TransformVector(mid_rot_ms, mid_end_ms)));
+  const SoaFloat3 start_end_ss_final = start_mid_ss + mid_end_ss_final;
+  const SoaQuaternion end_to_target_rot_ss =
+      internal::FromVectors(start_end_ss_final, start_target_ss);
+
+  const SoaFloat3 ref_plane_normal_ss = Cross(start_target_ss, pole_ss);
+  const SimdFloat4 ref_plane_normal_ss_len2 = LengthSqr(ref_plane_normal_ss);
+  const SoaFloat3 mid_axis_ss = internal::TransformVector(
+      inv_start_joint, internal::TransformVector(mid_joint, mid_axis));
+  const SoaFloat3 joint_plane_normal_ss =
+      internal::TransformVector(end_to_target_rot_ss, mid_axis_ss);
+  const SimdFloat4 joint_plane_normal_ss_len2 =
+      LengthSqr(joint_plane_normal_ss);
+  const SimdFloat4 rotate_plane_cos_angle =
+      Dot(ref_plane_normal_ss * RSqrtEstNR(ref_plane_normal_ss_len2),
+          joint_plane_normal_ss * RSqrtEstNR(joint_plane_normal_ss_len2));
+  const SoaFloat3 rotate_plane_axis_ss =
+      start_target_ss * RSqrtEstNR(start_target_ss_len2);
+  const SimdFloat4 start_axis_flip =
+      And(Dot(joint_plane_normal_ss, pole_ss), mask_sign);
+  const SoaFloat3 rotate_plane_axis_flipped_ss = {
+      Xor(rotate_plane_axis_ss.x, start_axis_flip),
+      Xor(rotate_plane_axis_ss.y, start_axis_flip),
+      Xor(rotate_plane_axis_ss.z, start_axis_flip)};
+  const SoaQuaternion rotate_plane_ss = internal::FromAxisCosAngle(
+      rotate_plane_axis_flipped_ss, Clamp(m_one, rotate_plane_cos_angle, one));
+
+  SoaQuaternion start_rot_ss = rotate_plane_ss * end_to_target_rot_ss;
+  if (_job.twist_angle != 0.f) {
+    start_rot_ss =
+        internal::FromAxisAngle(rotate_plane_axis_ss, _job.twist_angle) *
+        start_rot_ss;
+  }
+
+  // Plane rotation can only be computed if start target axis isn't 0 length.
+  *_start_rot = internal::Select(CmpGt(start_target_ss_len2, zero),
+                                 start_rot_ss, end_to_target_rot_ss);
+  *_mid_rot = mid_rot_ms;
+  return reached;
+}
+
+// See WeightOutput.
+SoaQuaternion WeightSoa(const SoaQuaternion& _rot, float _weight) {
+  const SoaQuaternion rot_fu = internal::FixUp(_rot);
+  if (_weight >= 1.f) {
+    return rot_fu;
+  }
+
+  const SoaQuaternion lerp = Lerp(SoaQuaternion::identity(), rot_fu,
+                                  simd_float4::Load1(_weight));
+  const SimdFloat4 rsqrt = RSqrtEstNR(Dot(lerp, lerp));
+  const SoaQuaternion ret = {lerp.x * rsqrt, lerp.y * rsqrt, lerp.z * rsqrt,
+                             lerp.w * rsqrt};
+  return ret;
+}
+}  // namespace
+
+bool BatchIKTwoBoneJob::Run() const {
+  OZZ_PROFILE_ZONE("BatchIKTwoBoneJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const size_t num_chains = start_joints.size();
+
+  // Early out if weight is 0.
+  if (weight <= 0.f) {
+    for (size_t i = 0; i < num_chains; ++i) {
+      start_joint_corrections[i] = mid_joint_corrections[i] =
+          SimdQuaternion::identity();
+      if (!reached.empty()) {
+        reached[i] = false;
+      }
+    }
+    return true;
+  }
+
+  for (size_t g = 0; g < num_chains; g += 4) {
+    // Gathers a group of 4 chains. The last group is padded with its last
+    // chain, whose outputs are only written once.
+    const size_t num_group_chains = math::Min(num_chains - g, size_t(4));
+    size_t c[4];
+    const Float4x4* start[4];
+    const Float4x4* mid[4];
+    const Float4x4* end[4];
+    for (size_t k = 0; k < 4; ++k) {
+      c[k] = g + math::Min(k, num_group_chains - 1);
+      start[k] = start_joints[c[k]];
+      mid[k] = mid_joints[c[k]];
+      end[k] = end_joints[c[k]];
+    }
+
+    SoaQuaternion start_rot, mid_rot;
+    const SimdInt4 lreached =
+        SolveSoa(*this, start, mid, end, targets[c[0]], targets[c[1]],
+                 targets[c[2]], targets[c[3]], pole_vectors[c[0]],
+                 pole_vectors[c[1]], pole_vectors[c[2]], pole_vectors[c[3]],
+                 &start_rot, &mid_rot);
+
+    // Applies weight, normalizing w sign.
+    SimdQuaternion start_aos[4], mid_aos[4];
+    internal::TransposeAos(WeightSoa(start_rot, weight), start_aos);
+    internal::TransposeAos(WeightSoa(mid_rot, weight), mid_aos);
+    const int reached_mask = MoveMask(lreached);
+    for (size_t k = 0; k < num_group_chains; ++k) {
+      start_joint_corrections[g + k] = start_aos[k];
+      mid_joint_corrections[g + k] = mid_aos[k];
+      if (!reached.empty()) {
+        reached[g + k] = (reached_mask & (1 << k)) != 0 && weight >= 1.f;
+      }
+    }
+  }
+  return true;
+}
 }  // namespace animation
 }  // namespace ozz
@@ -0,0 +1,146 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#ifndef OZZ_ANIMATION_RUNTIME_KEY_DECOMPRESSION_H_
+#define OZZ_ANIMATION_RUNTIME_KEY_DECOMPRESSION_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+#include "animation/runtime/animation_keyframe.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
+
+namespace ozz {
+namespace animation {
+namespace internal {
+
+// Decompresses 4 float3 keys (half floats) to SoA format, whatever is their
+// format.
+template <typename _Key>
+inline void DecompressFloat3(const _Key& _k0, const _Key& _k1, const _Key& _k2,
+                             const _Key& _k3, math::SoaFloat3* _soa_float3) {
+  _soa_float3->x = math::HalfToFloat(math::simd_int4::Load(
+      _k0.value[0], _k1.value[0], _k2.value[0], _k3.value[0]));
+  _soa_float3->y = math::HalfToFloat(math::simd_int4::Load(
+      _k0.value[1], _k1.value[1], _k2.value[1], _k3.value[1]));
+  _soa_float3->z = math::HalfToFloat(math::simd_int4::Load(
+      _k0.value[2], _k1.value[2], _k2.value[2], _k3.value[2]));
+}
+
+// Defines a mapping table that defines components assignation in the output
+// quaternion.
+constexpr int kCpntMapping[4][4] = {
+    {0, 0, 1, 2}, {0, 0, 1, 2}, {0, 1, 0, 2}, {0, 1, 2, 0}};
+
+// Decompresses quaternion keys, whatever is their format. Quantized values are
+// unpacked to integers sharing the same quantization scale.
+template <typename _Key>
+inline void DecompressQuaternion(const _Key& _k0, const _Key& _k1,
+                                 const _Key& _k2, const _Key& _k3,
+                                 math::SoaQuaternion* _quaternion) {
+  // Selects proper mapping for each key.
+  const int* m0 = kCpntMapping[_k0.largest];
+  const int* m1 = kCpntMapping[_k1.largest];
+  const int* m2 = kCpntMapping[_k2.largest];
+  const int* m3 = kCpntMapping[_k3.largest];
+
+  // Unpacks quantized values.
+  int v0[3], v1[3], v2[3], v3[3];
+  UnpackQuaternionKey(_k0, v0);
+  UnpackQuaternionKey(_k1, v1);
+  UnpackQuaternionKey(_k2, v2);
+  UnpackQuaternionKey(_k3, v3);
+
+  // Prepares an array of input values, according to the mapping required to
+  // restore quaternion largest component.
+  alignas(16) int cmp_keys[4][4] = {
+      {v0[m0[0]], v1[m1[0]], v2[m2[0]], v3[m3[0]]},
+      {v0[m0[1]], v1[m1[1]], v2[m2[1]], v3[m3[1]]},
+      {v0[m0[2]], v1[m1[2]], v2[m2[2]], v3[m3[2]]},
+      {v0[m0[3]], v1[m1[3]], v2[m2[3]], v3[m3[3]]},
+  };
+
+  // Resets largest component to 0. Overwritting here avoids 16 branchings
+  // above.
+  cmp_keys[_k0.largest][0] = 0;
+  cmp_keys[_k1.largest][1] = 0;
+  cmp_keys[_k2.largest][2] = 0;
+  cmp_keys[_k3.largest][3] = 0;
+
+  // Rebuilds quaternion from quantized values.
+  const float kScale = QuaternionKeyQuantization<_Key>::kScale;
+  const math::SimdFloat4 kInt2Float =
+      math::simd_float4::Load1(1.f / (kScale * math::kSqrt2));
+  math::SimdFloat4 cpnt[4] = {
+      kInt2Float *
+          math::simd_float4::FromInt(math::simd_int4::LoadPtr(cmp_keys[0])),
+      kInt2Float *
+          math::simd_float4::FromInt(math::simd_int4::LoadPtr(cmp_keys[1])),
+      kInt2Float *
+          math::simd_float4::FromInt(math::simd_int4::LoadPtr(cmp_keys[2])),
+      kInt2Float *
+          math::simd_float4::FromInt(math::simd_int4::LoadPtr(cmp_keys[3])),
+  };
+
+  // Get back length of 4th component. Favors performance over accuracy by using
+  // x * RSqrtEst(x) instead of Sqrt(x).
+  // ww0 cannot be 0 because we 're recomputing the largest component.
+  const math::SimdFloat4 dot = cpnt[0] * cpnt[0] + cpnt[1] * cpnt[1] +
+                               cpnt[2] * cpnt[2] + cpnt[3] * cpnt[3];
+  const math::SimdFloat4 ww0 = math::Max(math::simd_float4::Load1(1e-16f),
+                                         math::simd_float4::one() - dot);
+  const math::SimdFloat4 w0 = ww0 * math::RSqrtEst(ww0);
+  // Re-applies 4th component' s sign.
+  const math::SimdInt4 sign = math::ShiftL(
+      math::simd_int4::Load(_k0.sign, _k1.sign, _k2.sign, _k3.sign), 31);
+  const math::SimdFloat4 restored = math::Or(w0, sign);
+
+  // Re-injects the largest component inside the SoA structure.
+  cpnt[_k0.largest] = math::Or(
+      cpnt[_k0.largest], math::And(restored, math::simd_int4::mask_f000()));
+  cpnt[_k1.largest] = math::Or(
+      cpnt[_k1.largest], math::And(restored, math::simd_int4::mask_0f00()));
+  cpnt[_k2.largest] = math::Or(
+      cpnt[_k2.largest], math::And(restored, math::simd_int4::mask_00f0()));
+  cpnt[_k3.largest] = math::Or(
+      cpnt[_k3.largest], math::And(restored, math::simd_int4::mask_000f()));
+
+  // Stores result.
+  _quaternion->x = cpnt[0];
+  _quaternion->y = cpnt[1];
+  _quaternion->z = cpnt[2];
+  _quaternion->w = cpnt[3];
+}
+
+}  // namespace internal
+}  // namespace animation
+}  // namespace ozz
+#endif  // OZZ_ANIMATION_RUNTIME_KEY_DECOMPRESSION_H_
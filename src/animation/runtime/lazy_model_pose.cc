@@ -0,0 +1,172 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/lazy_model_pose.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Gets the number of 32 bits words needed for a bit per joint.
+int DirtyWords(int _num_joints) { return (_num_joints + 31) / 32; }
+
+// Computes the local-space matrix of joint _joint from SoA transforms.
+math::Float4x4 LocalMatrix(const math::SoaTransform& _soa, int _lane) {
+  math::SimdFloat4 translations[4];
+  math::Transpose3x4(&_soa.translation.x, translations);
+  math::SimdFloat4 rotations[4];
+  math::Transpose4x4(&_soa.rotation.x, rotations);
+  math::SimdFloat4 scales[4];
+  math::Transpose3x4(&_soa.scale.x, scales);
+  return math::Float4x4::FromAffine(translations[_lane], rotations[_lane],
+                                    scales[_lane]);
+}
+}  // namespace
+
+LazyModelPose::LazyModelPose()
+    : skeleton_(nullptr),
+      num_evaluated_(0),
+      buffer_(nullptr),
+      root_(nullptr),
+      models_(nullptr),
+      chain_(nullptr),
+      dirty_(nullptr) {}
+
+LazyModelPose::~LazyModelPose() { Deallocate(); }
+
+bool LazyModelPose::Allocate(const Skeleton& _skeleton) {
+  Deallocate();
+  const int num_joints = _skeleton.num_joints();
+  if (num_joints == 0) {
+    return false;
+  }
+
+  // Computes buffers layout, biggest alignment first.
+  const size_t models_size = sizeof(math::Float4x4) * (num_joints + 1);
+  const size_t dirty_size = sizeof(uint32_t) * DirtyWords(num_joints);
+  const size_t chain_size = sizeof(int16_t) * num_joints;
+  static_assert(alignof(math::Float4x4) >= alignof(uint32_t) &&
+                    alignof(uint32_t) >= alignof(int16_t),
+                "Must serve each type alignment requirement.");
+
+  buffer_ = memory::default_allocator()->Allocate(
+      models_size + dirty_size + chain_size, alignof(math::Float4x4));
+  byte* alloc_cursor = static_cast<byte*>(buffer_);
+  root_ = reinterpret_cast<math::Float4x4*>(alloc_cursor);
+  models_ = root_ + 1;
+  alloc_cursor += models_size;
+  dirty_ = reinterpret_cast<uint32_t*>(alloc_cursor);
+  alloc_cursor += dirty_size;
+  chain_ = reinterpret_cast<int16_t*>(alloc_cursor);
+
+  skeleton_ = &_skeleton;
+  *root_ = math::Float4x4::identity();
+  Invalidate();
+
+  return true;
+}
+
+void LazyModelPose::Deallocate() {
+  memory::default_allocator()->Deallocate(buffer_);
+  skeleton_ = nullptr;
+  locals_ = {};
+  num_evaluated_ = 0;
+  buffer_ = nullptr;
+  root_ = nullptr;
+  models_ = nullptr;
+  chain_ = nullptr;
+  dirty_ = nullptr;
+}
+
+bool LazyModelPose::Bind(span<const math::SoaTransform> _locals,
+                         const math::Float4x4* _root) {
+  if (!skeleton_ ||
+      _locals.size() < static_cast<size_t>(skeleton_->num_soa_joints())) {
+    return false;
+  }
+  locals_ = _locals;
+  *root_ = _root ? *_root : math::Float4x4::identity();
+  Invalidate();
+  return true;
+}
+
+void LazyModelPose::Invalidate() {
+  num_evaluated_ = 0;
+  if (dirty_) {
+    std::memset(dirty_, 0xff,
+                sizeof(uint32_t) * DirtyWords(skeleton_->num_joints()));
+  }
+}
+
+bool LazyModelPose::evaluated(int _joint) const {
+  if (!skeleton_ || _joint < 0 || _joint >= skeleton_->num_joints()) {
+    return false;
+  }
+  return (dirty_[_joint / 32] & (1u << (_joint & 31))) == 0;
+}
+
+const math::Float4x4* LazyModelPose::Evaluate(int _joint) {
+  if (locals_.empty() || _joint < 0 || _joint >= skeleton_->num_joints()) {
+    return nullptr;
+  }
+
+  // Walks up the hierarchy, stacking joints until an evaluated one, or the
+  // root, is found.
+  const span<const int16_t>& parents = skeleton_->joint_parents();
+  int depth = 0;
+  int joint = _joint;
+  while (joint != Skeleton::kNoParent &&
+         (dirty_[joint / 32] & (1u << (joint & 31))) != 0) {
+    assert(depth < skeleton_->num_joints());
+    chain_[depth++] = static_cast<int16_t>(joint);
+    joint = parents[joint];
+  }
+
+  // Evaluates stacked joints, from the top of the chain down to _joint.
+  num_evaluated_ += depth;
+  const math::Float4x4* parent =
+      joint == Skeleton::kNoParent ? root_ : models_ + joint;
+  while (depth > 0) {
+    const int current = chain_[--depth];
+    models_[current] =
+        *parent * LocalMatrix(locals_[current / 4], current & 3);
+    dirty_[current / 32] &= ~(1u << (current & 31));
+    parent = models_ + current;
+  }
+
+  return models_ + _joint;
+}
+}  // namespace animation
+}  // namespace ozz
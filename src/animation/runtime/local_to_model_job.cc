@@ -28,13 +28,34 @@
 #include "ozz/animation/runtime/local_to_model_job.h"
 
 #include <cassert>
+#include <cmath>
+#include <cstring>
 
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_float3x4.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/soa_float4x4.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/scratch_buffer.h"
 
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+#include "ozz/base/profile.h"
+
+// Selects AVX path, which builds local matrices of 2 SoA joints at once. It's
+// always used if AVX is enabled for the whole build. Otherwise, for x86 SSE
+// builds, it's compiled with a function target attribute (GCC and Clang) and
+// selected at runtime according to host capabilities.
+#if defined(OZZ_SIMD_AVX)
+#define OZZ_LOCAL_TO_MODEL_AVX
+#define OZZ_LOCAL_TO_MODEL_AVX_TARGET
+#elif defined(OZZ_SIMD_SSEx) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define OZZ_LOCAL_TO_MODEL_AVX
+#define OZZ_LOCAL_TO_MODEL_AVX_DISPATCH
+#define OZZ_LOCAL_TO_MODEL_AVX_TARGET __attribute__((target("avx")))
+#endif
 
 namespace ozz {
 namespace animation {
@@ -44,7 +65,10 @@ LocalToModelJob::LocalToModelJob()
       root(nullptr),
       from(Skeleton::kNoParent),
       to(Skeleton::kMaxJoints),
-      from_excluded(false) {}
+      from_excluded(false),
+      parallel_for(nullptr),
+      parallel_for_user_data(nullptr),
+      parallel_grain(256) {}
 
 bool LocalToModelJob::Validate() const {
   // Don't need any early out, as jobs are valid in most of the performance
@@ -61,52 +85,802 @@ bool LocalToModelJob::Validate() const {
   const size_t num_soa_joints = (num_joints + 3) / 4;
 
   // Test input and output ranges, implicitly tests for nullptr end pointers.
+  // Only one of output ranges can be used.
   valid &= input.size() >= num_soa_joints;
-  valid &= output.size() >= num_joints;
+  valid &= output.empty() || affine_output.empty();
+  valid &= affine_output.empty() ? output.size() >= num_joints
+                                 : affine_output.size() >= num_joints;
+
+  // Test dirty mask size, which is optional.
+  valid &= dirty.empty() || dirty.size() >= (num_joints + 7) / 8;
+
+  // Test joints mask size, which is optional.
+  valid &= mask.empty() || mask.size() >= (num_joints + 7) / 8;
+
+  valid &= parallel_for == nullptr || parallel_grain > 0;
 
   return valid;
 }
 
+namespace {
+// Converts soa matrices to 4 aos matrices.
+inline void ToAos(const math::SoaFloat4x4& _soa, math::Float4x4* _aos) {
+  math::Transpose16x16(&_soa.cols[0].x, _aos->cols);
+}
+
+// Converts soa affine matrices to 4 aos affine matrices. Only the 3 first rows
+// are transposed, last one being implicit.
+inline void ToAos(const math::SoaFloat4x4& _soa, math::Float3x4* _aos) {
+  math::SimdFloat4 rows[4];
+  const math::SimdFloat4 x[4] = {_soa.cols[0].x, _soa.cols[1].x,
+                                 _soa.cols[2].x, _soa.cols[3].x};
+  math::Transpose4x4(x, rows);
+  for (int j = 0; j < 4; ++j) {
+    _aos[j].rows[0] = rows[j];
+  }
+  const math::SimdFloat4 y[4] = {_soa.cols[0].y, _soa.cols[1].y,
+                                 _soa.cols[2].y, _soa.cols[3].y};
+  math::Transpose4x4(y, rows);
+  for (int j = 0; j < 4; ++j) {
+    _aos[j].rows[1] = rows[j];
+  }
+  const math::SimdFloat4 z[4] = {_soa.cols[0].z, _soa.cols[1].z,
+                                 _soa.cols[2].z, _soa.cols[3].z};
+  math::Transpose4x4(z, rows);
+  for (int j = 0; j < 4; ++j) {
+    _aos[j].rows[2] = rows[j];
+  }
+}
+
+// Converts root matrix to output matrix type.
+inline math::Float4x4 ToRoot(const math::Float4x4& _root,
+                             const math::Float4x4*) {
+  return _root;
+}
+
+inline math::Float3x4 ToRoot(const math::Float4x4& _root,
+                             const math::Float3x4*) {
+  return math::Float3x4::FromFloat4x4(_root);
+}
+
+#if defined(OZZ_LOCAL_TO_MODEL_AVX)
+// Packs SSE vectors _lo and _hi to a single AVX one.
+OZZ_LOCAL_TO_MODEL_AVX_TARGET inline __m256 LocalPack8(__m128 _lo,
+                                                       __m128 _hi) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_lo), _hi, 1);
+}
+
+// Computes affine local matrices terms of _in[0] and _in[1] SoA transforms,
+// _in[0] in the low 128 bits lanes and _in[1] in the high ones. _m[c][r] is
+// row r of column c, column 3 being the translation. Operations match
+// SoaFloat4x4::FromAffine ones, so that both paths give the same result.
+OZZ_LOCAL_TO_MODEL_AVX_TARGET inline void LocalAffinex2(
+    const math::SoaTransform* _in, __m256 _m[4][3]) {
+  assert(math::AreAllTrue(math::IsNormalizedEst(_in[0].rotation)) &&
+         math::AreAllTrue(math::IsNormalizedEst(_in[1].rotation)));
+
+  const math::SoaTransform& a = _in[0];
+  const math::SoaTransform& b = _in[1];
+  const __m256 qx = LocalPack8(a.rotation.x, b.rotation.x);
+  const __m256 qy = LocalPack8(a.rotation.y, b.rotation.y);
+  const __m256 qz = LocalPack8(a.rotation.z, b.rotation.z);
+  const __m256 qw = LocalPack8(a.rotation.w, b.rotation.w);
+  const __m256 sx = LocalPack8(a.scale.x, b.scale.x);
+  const __m256 sy = LocalPack8(a.scale.y, b.scale.y);
+  const __m256 sz = LocalPack8(a.scale.z, b.scale.z);
+
+  const __m256 one = _mm256_set1_ps(1.f);
+  const __m256 two = _mm256_add_ps(one, one);
+
+  const __m256 xx = _mm256_mul_ps(qx, qx);
+  const __m256 xy = _mm256_mul_ps(qx, qy);
+  const __m256 xz = _mm256_mul_ps(qx, qz);
+  const __m256 xw = _mm256_mul_ps(qx, qw);
+  const __m256 yy = _mm256_mul_ps(qy, qy);
+  const __m256 yz = _mm256_mul_ps(qy, qz);
+  const __m256 yw = _mm256_mul_ps(qy, qw);
+  const __m256 zz = _mm256_mul_ps(qz, qz);
+  const __m256 zw = _mm256_mul_ps(qz, qw);
+
+  // Diagonal terms, _s * (1 - 2 * (_a + _b)).
+#define OZZ_LTM_DIAG(_s, _a, _b) \
+  _mm256_mul_ps(_s,              \
+                _mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(_a, _b))))
+  // Other terms, _s * 2 * (_a op _b).
+#define OZZ_LTM_TERM(_s, _op, _a, _b) \
+  _mm256_mul_ps(_mm256_mul_ps(_s, two), _op(_a, _b))
+  _m[0][0] = OZZ_LTM_DIAG(sx, yy, zz);
+  _m[0][1] = OZZ_LTM_TERM(sx, _mm256_add_ps, xy, zw);
+  _m[0][2] = OZZ_LTM_TERM(sx, _mm256_sub_ps, xz, yw);
+  _m[1][0] = OZZ_LTM_TERM(sy, _mm256_sub_ps, xy, zw);
+  _m[1][1] = OZZ_LTM_DIAG(sy, xx, zz);
+  _m[1][2] = OZZ_LTM_TERM(sy, _mm256_add_ps, yz, xw);
+  _m[2][0] = OZZ_LTM_TERM(sz, _mm256_add_ps, xz, yw);
+  _m[2][1] = OZZ_LTM_TERM(sz, _mm256_sub_ps, yz, xw);
+  _m[2][2] = OZZ_LTM_DIAG(sz, xx, yy);
+#undef OZZ_LTM_DIAG
+#undef OZZ_LTM_TERM
+
+  _m[3][0] = LocalPack8(a.translation.x, b.translation.x);
+  _m[3][1] = LocalPack8(a.translation.y, b.translation.y);
+  _m[3][2] = LocalPack8(a.translation.z, b.translation.z);
+}
+
+// Transposes _x, _y, _z and _w within each 128 bits lane, and stores the 8
+// resulting vectors to _out[0] to _out[7]. _out[j] and _out[j + 4] contain lane
+// j of the low and high 128 bits of each vector.
+OZZ_LOCAL_TO_MODEL_AVX_TARGET inline void LocalTransposeStorex2(
+    __m256 _x, __m256 _y, __m256 _z, __m256 _w, math::SimdFloat4* _out,
+    size_t _stride) {
+  const __m256 xy_lo = _mm256_unpacklo_ps(_x, _y);
+  const __m256 xy_hi = _mm256_unpackhi_ps(_x, _y);
+  const __m256 zw_lo = _mm256_unpacklo_ps(_z, _w);
+  const __m256 zw_hi = _mm256_unpackhi_ps(_z, _w);
+  const __m256 rows[4] = {
+      _mm256_shuffle_ps(xy_lo, zw_lo, _MM_SHUFFLE(1, 0, 1, 0)),
+      _mm256_shuffle_ps(xy_lo, zw_lo, _MM_SHUFFLE(3, 2, 3, 2)),
+      _mm256_shuffle_ps(xy_hi, zw_hi, _MM_SHUFFLE(1, 0, 1, 0)),
+      _mm256_shuffle_ps(xy_hi, zw_hi, _MM_SHUFFLE(3, 2, 3, 2))};
+  for (int j = 0; j < 4; ++j) {
+    _out[j * _stride] = _mm256_castps256_ps128(rows[j]);
+    _out[(j + 4) * _stride] = _mm256_extractf128_ps(rows[j], 1);
+  }
+}
+
+// Builds local matrices of _in[0] and _in[1] SoA transforms, straight to the 8
+// aos matrices _out[0] to _out[7]. SoA matrices are never materialized, terms
+// being transposed in registers.
+OZZ_LOCAL_TO_MODEL_AVX_TARGET void FromAffinex2(const math::SoaTransform* _in,
+                                                math::Float4x4* _out) {
+  __m256 m[4][3];
+  LocalAffinex2(_in, m);
+  const size_t stride = sizeof(math::Float4x4) / sizeof(math::SimdFloat4);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.f);
+  for (int c = 0; c < 4; ++c) {
+    LocalTransposeStorex2(m[c][0], m[c][1], m[c][2], c == 3 ? one : zero,
+                          &_out->cols[c], stride);
+  }
+}
+
+// Builds local affine matrices of _in[0] and _in[1] SoA transforms, straight
+// to the 8 aos matrices _out[0] to _out[7]. Each row is the transposition of
+// the same row of the 4 columns.
+OZZ_LOCAL_TO_MODEL_AVX_TARGET void FromAffinex2(const math::SoaTransform* _in,
+                                                math::Float3x4* _out) {
+  __m256 m[4][3];
+  LocalAffinex2(_in, m);
+  const size_t stride = sizeof(math::Float3x4) / sizeof(math::SimdFloat4);
+  for (int r = 0; r < 3; ++r) {
+    LocalTransposeStorex2(m[0][r], m[1][r], m[2][r], m[3][r], &_out->rows[r],
+                          stride);
+  }
+}
+
+// Tells if AVX path can be used on this host.
+bool HasLocalToModelAvx() {
+#if defined(OZZ_LOCAL_TO_MODEL_AVX_DISPATCH)
+  return math::SimdHostSupports(math::kSimdHostAvx);
+#else   // OZZ_LOCAL_TO_MODEL_AVX_DISPATCH
+  return true;
+#endif  // OZZ_LOCAL_TO_MODEL_AVX_DISPATCH
+}
+#endif  // OZZ_LOCAL_TO_MODEL_AVX
+
+// Builds aos local matrices of input transforms on demand. AVX path builds
+// them by pairs of SoA joints, keeping the second one for the next request.
+template <typename _Matrix>
+class LocalMatrices {
+ public:
+  // _end_soa is the index past the last SoA joint that can be requested.
+  LocalMatrices(const LocalToModelJob& _job, int _end_soa)
+      : input_(_job.input), first_(0), count_(0) {
+#if defined(OZZ_LOCAL_TO_MODEL_AVX)
+    // Pairs are never built if host doesn't support AVX path.
+    end_soa_ = HasLocalToModelAvx() ? _end_soa : 0;
+#else   // OZZ_LOCAL_TO_MODEL_AVX
+    (void)_end_soa;
+#endif  // OZZ_LOCAL_TO_MODEL_AVX
+  }
+
+  // Returns the 4 local matrices of SoA joint _soa.
+  const _Matrix* Get(int _soa) {
+    const int index = _soa - first_;
+    if (index >= 0 && index < count_) {
+      return matrices_ + index * 4;
+    }
+    first_ = _soa;
+#if defined(OZZ_LOCAL_TO_MODEL_AVX)
+    if (_soa + 1 < end_soa_) {
+      FromAffinex2(input_.begin() + _soa, matrices_);
+      count_ = 2;
+      return matrices_;
+    }
+#endif  // OZZ_LOCAL_TO_MODEL_AVX
+    const math::SoaTransform& transform = input_[_soa];
+    ToAos(math::SoaFloat4x4::FromAffine(transform.translation,
+                                        transform.rotation, transform.scale),
+          matrices_);
+    count_ = 1;
+    return matrices_;
+  }
+
+ private:
+  _Matrix matrices_[8];
+  const span<const math::SoaTransform> input_;
+  int first_;
+  int count_;
+#if defined(OZZ_LOCAL_TO_MODEL_AVX)
+  int end_soa_;
+#endif  // OZZ_LOCAL_TO_MODEL_AVX
+
+  // Disables copy and assignment.
+  LocalMatrices(const LocalMatrices&);
+  void operator=(const LocalMatrices&);
+};
+
+// Updates dirty joints and their descendants, see LocalToModelJob::dirty, and
+// restricts the update to enabled joints, see LocalToModelJob::mask.
+template <typename _Matrix>
+void RunDirty(const LocalToModelJob& _job, const _Matrix& _root_matrix,
+              const span<_Matrix>& _output) {
+  const span<const int16_t>& parents = _job.skeleton->joint_parents();
+  const span<const uint8_t>& dirty = _job.dirty;
+  const span<const uint8_t>& mask = _job.mask;
+  const int num_joints = _job.skeleton->num_joints();
+  LocalMatrices<_Matrix> locals(_job, (num_joints + 3) / 4);
+
+  // Per joint update flags. As parents are always ordered before their
+  // children, a parent is always processed before its children, so a joint
+  // needs to be updated if it's dirty or if its parent was updated. Without
+  // dirty mask, all joints are considered dirty.
+  memory::ScratchBuffer<bool, Skeleton::kMaxInlineJoints> updated(num_joints);
+
+  for (int i = 0; i < num_joints; i += 4) {
+    // Finds joints of this SoA group that need to be updated.
+    const int soa_end = math::Min(i + 4, num_joints);
+    bool any = false;
+    for (int j = i; j < soa_end; ++j) {
+      const int parent = parents[j];
+      const uint8_t bit = static_cast<uint8_t>(1 << (j & 7));
+      updated[j] = (mask.empty() || (mask[j / 8] & bit) != 0) &&
+                   (dirty.empty() || (dirty[j / 8] & bit) != 0 ||
+                    (parent != Skeleton::kNoParent && updated[parent]));
+      any |= updated[j];
+    }
+    if (!any) {
+      continue;
+    }
+
+    // Gets aos local matrices of this SoA joint.
+    const _Matrix* local_aos_matrices = locals.Get(i / 4);
+
+    for (int j = i; j < soa_end; ++j) {
+      if (updated[j]) {
+        const int parent = parents[j];
+        const _Matrix* parent_matrix =
+            parent == Skeleton::kNoParent ? &_root_matrix : &_output[parent];
+        _output[j] = *parent_matrix * local_aos_matrices[j & 3];
+      }
+    }
+  }
+}
+
+// Applies hierarchical transformation from "from" to "to" joints.
+template <typename _Matrix>
+void RunRange(const LocalToModelJob& _job, const math::Float4x4& _root,
+              const span<_Matrix>& _output) {
+  const span<const int16_t>& parents = _job.skeleton->joint_parents();
+  const _Matrix root_matrix = ToRoot(_root, _output.begin());
+
+  // Dirty and masked joints update is a different traversal.
+  if (!_job.dirty.empty() || !_job.mask.empty()) {
+    RunDirty(_job, root_matrix, _output);
+    return;
+  }
+
+  const int from = _job.from;
+  const int num_joints = _job.skeleton->num_joints();
+
+  // Begins iteration from "from", or the next joint if "from" is excluded.
+  // Loop ends after "to", or at the end of "from" sub-hierarchy.
+  int begin = 0;
+  int end = math::Min(_job.to + 1, num_joints);
+  if (from >= 0) {
+    begin = from + _job.from_excluded;
+    end = from < num_joints
+              ? math::Min<int>(end, _job.skeleton->joint_subtree_ends()[from])
+              : 0;
+  }
+  LocalMatrices<_Matrix> locals(_job, (end + 3) / 4);
+  for (int i = begin; i < end;) {
+    // Gets aos local matrices of this SoA joint.
+    const _Matrix* local_aos_matrices = locals.Get(i / 4);
+    for (const int soa_end = math::Min((i + 4) & ~3, end); i < soa_end; ++i) {
+      const int parent = parents[i];
+      const _Matrix* parent_matrix =
+          parent == Skeleton::kNoParent ? &root_matrix : &_output[parent];
+      _output[i] = *parent_matrix * local_aos_matrices[i & 3];
+    }
+  }
+}
+
+// Runs valid job _job from the calling thread.
+void RunSerial(const LocalToModelJob& _job) {
+  // Initializes an identity matrix that will be used to compute roots model
+  // matrices without requiring a branch.
+  const math::Float4x4 identity = math::Float4x4::identity();
+  const math::Float4x4* root_matrix =
+      (_job.root == nullptr) ? &identity : _job.root;
+
+  // Output type selects the matrix type used for the whole traversal, avoiding
+  // any conversion.
+  if (_job.affine_output.empty()) {
+    RunRange(_job, *root_matrix, _job.output);
+  } else {
+    RunRange(_job, *root_matrix, _job.affine_output);
+  }
+}
+
+// Independent sub-hierarchies to convert in parallel. Task t converts
+// sub-hierarchies of roots[tasks[t]] to roots[tasks[t + 1] - 1]. Each
+// sub-hierarchy is converted as a "from" range, as the skeleton is ordered
+// depth-first.
+struct ParallelSubtrees {
+  const LocalToModelJob* job;
+  const int* roots;
+  const int* tasks;
+};
+
+// Converts sub-hierarchies of task _task, for parallel_for.
+void RunSubtrees(int _task, void* _data) {
+  const ParallelSubtrees& subtrees = *static_cast<ParallelSubtrees*>(_data);
+  LocalToModelJob job = *subtrees.job;
+  job.from_excluded = false;
+  for (int r = subtrees.tasks[_task]; r < subtrees.tasks[_task + 1]; ++r) {
+    job.from = subtrees.roots[r];
+    RunSerial(job);
+  }
+}
+
+// Splits the hierarchy of valid job _job in a trunk, made of joints whose
+// sub-hierarchy is bigger than parallel_grain, and independent
+// sub-hierarchies. The trunk is converted first, then sub-hierarchies are
+// grouped in tasks run with parallel_for. Returns false, without converting
+// anything, if job can't be split.
+bool RunParallel(const LocalToModelJob& _job) {
+  const Skeleton& skeleton = *_job.skeleton;
+  const int num_joints = skeleton.num_joints();
+  const int grain = _job.parallel_grain;
+  if (!_job.dirty.empty() || !_job.mask.empty() ||
+      _job.from != Skeleton::kNoParent || _job.to < num_joints - 1 ||
+      num_joints <= grain || !IsDepthFirst(skeleton)) {
+    return false;
+  }
+
+  // Sub-hierarchy of joint i is the range [i, ends[i][.
+  const span<const int16_t>& ends = skeleton.joint_subtree_ends();
+
+  // Finds trunk joints, and the roots of the sub-hierarchies hanging from it,
+  // which are grouped in tasks of at least grain joints.
+  const size_t num_mask_bytes = static_cast<size_t>(num_joints + 7) / 8;
+  memory::ScratchBuffer<uint8_t, Skeleton::kMaxInlineJoints / 8> trunk(
+      num_mask_bytes);
+  memory::ScratchBuffer<int, Skeleton::kMaxInlineJoints> roots(num_joints);
+  memory::ScratchBuffer<int, Skeleton::kMaxInlineJoints + 1> tasks(num_joints +
+                                                                   1);
+  std::memset(trunk.data(), 0, num_mask_bytes);
+  bool has_trunk = false;
+  int num_roots = 0;
+  int num_tasks = 0;
+  int task_size = 0;
+  for (int i = 0; i < num_joints;) {
+    const int size = ends[i] - i;
+    if (size > grain) {
+      trunk[i / 8] |= static_cast<uint8_t>(1 << (i & 7));
+      has_trunk = true;
+      ++i;
+      continue;
+    }
+    if (task_size == 0) {
+      tasks[num_tasks++] = num_roots;
+    }
+    roots[num_roots++] = i;
+    task_size += size;
+    if (task_size >= grain) {
+      task_size = 0;
+    }
+    i = ends[i];  // Skips the sub-hierarchy.
+  }
+  tasks[num_tasks] = num_roots;
+  if (num_tasks < 2) {
+    return false;
+  }
+
+  // Converts the trunk, which contains all sub-hierarchies parents.
+  if (has_trunk) {
+    LocalToModelJob trunk_job = _job;
+    trunk_job.mask = {trunk.data(), num_mask_bytes};
+    RunSerial(trunk_job);
+  }
+
+  // Converts sub-hierarchies.
+  ParallelSubtrees subtrees = {&_job, roots.data(), tasks.data()};
+  _job.parallel_for(num_tasks, &RunSubtrees, &subtrees,
+                    _job.parallel_for_user_data);
+  return true;
+}
+}  // namespace
+
 bool LocalToModelJob::Run() const {
   if (!Validate()) {
     return false;
   }
+  RunUnchecked();
+  return true;
+}
 
-  const span<const int16_t>& parents = skeleton->joint_parents();
+void LocalToModelJob::RunUnchecked() const {
+  OZZ_PROFILE_ZONE("LocalToModelJob::Run");
 
-  // Initializes an identity matrix that will be used to compute roots model
-  // matrices without requiring a branch.
+  if (parallel_for == nullptr || !RunParallel(*this)) {
+    RunSerial(*this);
+  }
+}
+
+BatchLocalToModelJob::BatchLocalToModelJob() : skeleton(nullptr) {}
+
+bool BatchLocalToModelJob::Validate() const {
+  if (!skeleton) {
+    return false;
+  }
+  bool valid = true;
+
+  const size_t num_joints = static_cast<size_t>(skeleton->num_joints());
+  const size_t num_soa_joints = (num_joints + 3) / 4;
+  valid &= scratch.size() >= num_joints;
+  for (const Instance& instance : instances) {
+    valid &= instance.input.size() >= num_soa_joints;
+    valid &= instance.output.size() >= num_joints;
+  }
+
+  return valid;
+}
+
+namespace {
+// Transposes the 4 SoA vectors _v*, so that _out[j] contains lane j of the 4
+// vectors.
+inline void Transpose(math::_SimdFloat4 _v0, math::_SimdFloat4 _v1,
+                      math::_SimdFloat4 _v2, math::_SimdFloat4 _v3,
+                      math::SimdFloat4* _out) {
+  const math::SimdFloat4 in[4] = {_v0, _v1, _v2, _v3};
+  math::Transpose4x4(in, _out);
+}
+
+// Converts 4 matrices to a SoA matrix.
+inline math::SoaFloat4x4 ToSoa(const math::Float4x4* const* _matrices) {
+  math::SoaFloat4x4 ret;
+  for (int c = 0; c < 4; ++c) {
+    const math::SimdFloat4 in[4] = {
+        _matrices[0]->cols[c], _matrices[1]->cols[c], _matrices[2]->cols[c],
+        _matrices[3]->cols[c]};
+    math::Transpose4x4(in, &ret.cols[c].x);
+  }
+  return ret;
+}
+
+// Multiplies _parent by _local affine matrix, whose last row is (0,0,0,1).
+inline math::SoaFloat4x4 MultiplyAffine(const math::SoaFloat4x4& _parent,
+                                        const math::SoaFloat4x4& _local) {
+  math::SoaFloat4x4 ret;
+  for (int c = 0; c < 3; ++c) {
+    const math::SoaFloat4& l = _local.cols[c];
+    ret.cols[c].x = _parent.cols[0].x * l.x + _parent.cols[1].x * l.y +
+                    _parent.cols[2].x * l.z;
+    ret.cols[c].y = _parent.cols[0].y * l.x + _parent.cols[1].y * l.y +
+                    _parent.cols[2].y * l.z;
+    ret.cols[c].z = _parent.cols[0].z * l.x + _parent.cols[1].z * l.y +
+                    _parent.cols[2].z * l.z;
+    ret.cols[c].w = _parent.cols[0].w * l.x + _parent.cols[1].w * l.y +
+                    _parent.cols[2].w * l.z;
+  }
+  const math::SoaFloat4& t = _local.cols[3];
+  ret.cols[3].x = _parent.cols[0].x * t.x + _parent.cols[1].x * t.y +
+                  _parent.cols[2].x * t.z + _parent.cols[3].x;
+  ret.cols[3].y = _parent.cols[0].y * t.x + _parent.cols[1].y * t.y +
+                  _parent.cols[2].y * t.z + _parent.cols[3].y;
+  ret.cols[3].z = _parent.cols[0].z * t.x + _parent.cols[1].z * t.y +
+                  _parent.cols[2].z * t.z + _parent.cols[3].z;
+  ret.cols[3].w = _parent.cols[0].w * t.x + _parent.cols[1].w * t.y +
+                  _parent.cols[2].w * t.z + _parent.cols[3].w;
+  return ret;
+}
+}  // namespace
+
+bool BatchLocalToModelJob::Run() const {
+  OZZ_PROFILE_ZONE("BatchLocalToModelJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const span<const int16_t>& parents = skeleton->joint_parents();
+  const int num_joints = skeleton->num_joints();
   const math::Float4x4 identity = math::Float4x4::identity();
-  const math::Float4x4* root_matrix = (root == nullptr) ? &identity : root;
 
-  // Applies hierarchical transformation.
-  // Loop ends after "to".
-  const int end = math::Min(to + 1, skeleton->num_joints());
-  // Begins iteration from "from", or the next joint if "from" is excluded.
-  // Process next joint if end is not reach. parents[begin] >= from is true as
-  // long as "begin" is a child of "from".
-  for (int i = math::Max(from + from_excluded, 0),
-           process = i < end && (!from_excluded || parents[i] >= from);
-       process;) {
-    // Builds soa matrices from soa transforms.
+  for (size_t g = 0; g < instances.size(); g += 4) {
+    // Gathers a group of 4 instances. The last group is padded with its last
+    // instance, whose outputs are only written once.
+    const size_t num_group_instances = math::Min(instances.size() - g,
+                                                 size_t(4));
+    const Instance* group[4];
+    const math::Float4x4* roots[4];
+    for (size_t k = 0; k < 4; ++k) {
+      group[k] = &instances[g + math::Min(k, num_group_instances - 1)];
+      roots[k] = group[k]->root ? group[k]->root : &identity;
+    }
+    const math::SoaFloat4x4 root = ToSoa(roots);
+
+    for (int i = 0; i < num_joints; i += 4) {
+      // Transposes local transforms of the 4 joints of this SoA joint, so that
+      // each SIMD lane contains one instance.
+      const size_t soa = static_cast<size_t>(i / 4);
+      const math::SoaTransform* in[4] = {
+          &group[0]->input[soa], &group[1]->input[soa], &group[2]->input[soa],
+          &group[3]->input[soa]};
+      math::SimdFloat4 tx[4], ty[4], tz[4];
+      Transpose(in[0]->translation.x, in[1]->translation.x,
+                in[2]->translation.x, in[3]->translation.x, tx);
+      Transpose(in[0]->translation.y, in[1]->translation.y,
+                in[2]->translation.y, in[3]->translation.y, ty);
+      Transpose(in[0]->translation.z, in[1]->translation.z,
+                in[2]->translation.z, in[3]->translation.z, tz);
+      math::SimdFloat4 rx[4], ry[4], rz[4], rw[4];
+      Transpose(in[0]->rotation.x, in[1]->rotation.x, in[2]->rotation.x,
+                in[3]->rotation.x, rx);
+      Transpose(in[0]->rotation.y, in[1]->rotation.y, in[2]->rotation.y,
+                in[3]->rotation.y, ry);
+      Transpose(in[0]->rotation.z, in[1]->rotation.z, in[2]->rotation.z,
+                in[3]->rotation.z, rz);
+      Transpose(in[0]->rotation.w, in[1]->rotation.w, in[2]->rotation.w,
+                in[3]->rotation.w, rw);
+      math::SimdFloat4 sx[4], sy[4], sz[4];
+      Transpose(in[0]->scale.x, in[1]->scale.x, in[2]->scale.x,
+                in[3]->scale.x, sx);
+      Transpose(in[0]->scale.y, in[1]->scale.y, in[2]->scale.y,
+                in[3]->scale.y, sy);
+      Transpose(in[0]->scale.z, in[1]->scale.z, in[2]->scale.z,
+                in[3]->scale.z, sz);
+
+      for (int j = 0; j < 4 && i + j < num_joints; ++j) {
+        const int joint = i + j;
+
+        // Builds local and model-space matrices of the 4 instances.
+        const math::SoaFloat3 translation = {tx[j], ty[j], tz[j]};
+        const math::SoaQuaternion rotation = {rx[j], ry[j], rz[j], rw[j]};
+        const math::SoaFloat3 scale = {sx[j], sy[j], sz[j]};
+        const math::SoaFloat4x4 local =
+            math::SoaFloat4x4::FromAffine(translation, rotation, scale);
+        const int parent = parents[joint];
+        const math::SoaFloat4x4& parent_matrix =
+            parent == Skeleton::kNoParent ? root : scratch[parent];
+        const math::SoaFloat4x4 model = MultiplyAffine(parent_matrix, local);
+        scratch[joint] = model;
+
+        // Converts to aos matrices, one per instance.
+        math::Float4x4 aos[4];
+        math::Transpose16x16(&model.cols[0].x, aos->cols);
+        for (size_t k = 0; k < num_group_instances; ++k) {
+          group[k]->output[joint] = aos[k];
+        }
+      }
+    }
+  }
+  return true;
+}
+
+LocalToSkinningJob::LocalToSkinningJob()
+    : skeleton(nullptr),
+      root(nullptr),
+      streaming_output(false),
+      uniform_scale(nullptr) {}
+
+bool LocalToSkinningJob::Validate() const {
+  if (!skeleton) {
+    return false;
+  }
+  bool valid = true;
+
+  const int num_joints = skeleton->num_joints();
+  const size_t num_soa_joints = static_cast<size_t>(num_joints + 3) / 4;
+  valid &= input.size() >= num_soa_joints;
+  valid &= inverse_bind_poses.size() >= joint_remaps.size();
+  valid &= output.size() >= joint_remaps.size();
+  valid &= inverse_transpose_output.empty() ||
+           inverse_transpose_output.size() >= joint_remaps.size();
+  for (const uint16_t joint : joint_remaps) {
+    valid &= joint < num_joints;
+  }
+
+  // Computes hierarchy depth, which must fit in model-space matrices stack.
+  const span<const int16_t>& parents = skeleton->joint_parents();
+  memory::ScratchBuffer<int, Skeleton::kMaxInlineJoints> depths(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = parents[i];
+    depths[i] = parent == Skeleton::kNoParent ? 1 : depths[parent] + 1;
+    valid &= depths[i] <= kMaxDepth;
+  }
+
+  // Model-space matrices stack relies on depth-first ordering.
+  valid &= IsDepthFirst(*skeleton);
+
+  return valid;
+}
+
+namespace {
+// Tests if _m 3x3 part is a rotation with a uniform scale, aka if its axes are
+// orthogonal and have the same length. If so, outputs the squared scale.
+bool IsUniformScale(const math::Float4x4& _m, float* _sq_scale) {
+  const float kTolerance = 1e-4f;
+  const float sq0 = math::GetX(math::Dot3(_m.cols[0], _m.cols[0]));
+  const float sq1 = math::GetX(math::Dot3(_m.cols[1], _m.cols[1]));
+  const float sq2 = math::GetX(math::Dot3(_m.cols[2], _m.cols[2]));
+  const float d01 = math::GetX(math::Dot3(_m.cols[0], _m.cols[1]));
+  const float d02 = math::GetX(math::Dot3(_m.cols[0], _m.cols[2]));
+  const float d12 = math::GetX(math::Dot3(_m.cols[1], _m.cols[2]));
+  const float tolerance = kTolerance * sq0;
+  *_sq_scale = sq0;
+  return sq0 > 0.f && std::abs(sq1 - sq0) <= tolerance &&
+         std::abs(sq2 - sq0) <= tolerance && std::abs(d01) <= tolerance &&
+         std::abs(d02) <= tolerance && std::abs(d12) <= tolerance;
+}
+
+// Computes _m inverse transpose 3x3 part, avoiding matrix inversion for
+// uniformly scaled matrices. Returns true if _m is uniformly scaled.
+bool InverseTranspose(const math::Float4x4& _m, math::Float4x4* _it) {
+  float sq_scale;
+  if (IsUniformScale(_m, &sq_scale)) {
+    const math::SimdFloat4 rcp = math::simd_float4::Load1(1.f / sq_scale);
+    const math::SimdInt4 mask = math::simd_int4::mask_fff0();
+    _it->cols[0] = math::And(_m.cols[0], mask) * rcp;
+    _it->cols[1] = math::And(_m.cols[1], mask) * rcp;
+    _it->cols[2] = math::And(_m.cols[2], mask) * rcp;
+    _it->cols[3] = math::simd_float4::w_axis();
+    return true;
+  }
+  *_it = Transpose(Invert(_m));
+  return false;
+}
+
+// Writes _m to _output, bypassing caches with non-temporal stores if _stream
+// is true.
+void StoreMatrix(const math::Float4x4& _m, math::Float4x4* _output,
+                 bool _stream) {
+  if (_stream) {
+    float* output = reinterpret_cast<float*>(_output);
+    math::StreamPtr(_m.cols[0], output + 0);
+    math::StreamPtr(_m.cols[1], output + 4);
+    math::StreamPtr(_m.cols[2], output + 8);
+    math::StreamPtr(_m.cols[3], output + 12);
+  } else {
+    *_output = _m;
+  }
+}
+}  // namespace
+
+bool LocalToSkinningJob::Run() const {
+  OZZ_PROFILE_ZONE("LocalToSkinningJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const span<const int16_t>& parents = skeleton->joint_parents();
+  const int num_joints = skeleton->num_joints();
+  const math::Float4x4 root_matrix =
+      root ? *root : math::Float4x4::identity();
+
+  // Builds a per joint list of output slots, as a joint can be remapped more
+  // than once.
+  const int kNoSlot = -1;
+  memory::ScratchBuffer<int, Skeleton::kMaxInlineJoints> first_slot(
+      num_joints);
+  memory::ScratchBuffer<int, Skeleton::kMaxInlineJoints> next_slot(
+      joint_remaps.size());
+  for (int i = 0; i < num_joints; ++i) {
+    first_slot[i] = kNoSlot;
+  }
+  for (int i = static_cast<int>(joint_remaps.size()) - 1; i >= 0; --i) {
+    const int joint = joint_remaps[i];
+    next_slot[i] = first_slot[joint];
+    first_slot[joint] = i;
+  }
+
+  // Flags remapped joints and their ancestors. As joints are ordered
+  // depth-first, a reverse traversal visits children before their parent.
+  memory::ScratchBuffer<bool, Skeleton::kMaxInlineJoints> needed(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    needed[i] = first_slot[i] != kNoSlot;
+  }
+  for (int i = num_joints - 1; i > 0; --i) {
+    const int parent = parents[i];
+    if (needed[i] && parent != Skeleton::kNoParent) {
+      needed[parent] = true;
+    }
+  }
+
+  // Stack of model-space matrices along the current depth-first path. As
+  // joints are ordered depth-first, the parent of a needed joint is always in
+  // the stack, above the joints that aren't its ancestors.
+  math::Float4x4 stack_matrices[kMaxDepth];
+  int stack_joints[kMaxDepth];
+  int depth = 0;
+
+  // Uniform scale of all outputs, only computed on request.
+  bool all_uniform = true;
+
+  for (int i = 0; i < num_joints; i += 4) {
+    const int soa_end = math::Min(i + 4, num_joints);
+    bool any = false;
+    for (int j = i; j < soa_end; ++j) {
+      any |= needed[j];
+    }
+    if (!any) {
+      continue;
+    }
+
+    // Builds soa matrices from soa transforms, and converts them to aos.
     const math::SoaTransform& transform = input[i / 4];
     const math::SoaFloat4x4 local_soa_matrices = math::SoaFloat4x4::FromAffine(
         transform.translation, transform.rotation, transform.scale);
-
-    // Converts to aos matrices.
     math::Float4x4 local_aos_matrices[4];
-    math::Transpose16x16(&local_soa_matrices.cols[0].x,
-                         local_aos_matrices->cols);
+    ToAos(local_soa_matrices, local_aos_matrices);
 
-    // parents[i] >= from is true as long as "i" is a child of "from".
-    for (const int soa_end = (i + 4) & ~3; i < soa_end && process;
-         ++i, process = i < end && parents[i] >= from) {
-      const int parent = parents[i];
-      const math::Float4x4* parent_matrix =
-          parent == Skeleton::kNoParent ? root_matrix : &output[parent];
-      output[i] = *parent_matrix * local_aos_matrices[i & 3];
+    for (int j = i; j < soa_end; ++j) {
+      if (!needed[j]) {
+        continue;
+      }
+
+      // Pops joints that aren't j ancestors.
+      const int parent = parents[j];
+      while (depth > 0 && stack_joints[depth - 1] != parent) {
+        --depth;
+      }
+      const math::Float4x4& parent_matrix =
+          depth == 0 ? root_matrix : stack_matrices[depth - 1];
+      const math::Float4x4 model = parent_matrix * local_aos_matrices[j & 3];
+
+      for (int slot = first_slot[j]; slot != kNoSlot; slot = next_slot[slot]) {
+        // Output is never read back, as it can be write-combined memory.
+        const math::Float4x4 skinning = model * inverse_bind_poses[slot];
+        StoreMatrix(skinning, &output[slot], streaming_output);
+        if (!inverse_transpose_output.empty()) {
+          math::Float4x4 inverse_transpose;
+          all_uniform &= InverseTranspose(skinning, &inverse_transpose);
+          StoreMatrix(inverse_transpose, &inverse_transpose_output[slot],
+                      streaming_output);
+        } else if (uniform_scale && all_uniform) {
+          float sq_scale;
+          all_uniform = IsUniformScale(skinning, &sq_scale);
+        }
+      }
+
+      assert(depth < kMaxDepth);
+      stack_matrices[depth] = model;
+      stack_joints[depth] = j;
+      ++depth;
     }
   }
+
+  // Orders streamed stores before any subsequent store, like a fence or flag
+  // signaling that output is ready to be consumed.
+  if (streaming_output) {
+    math::StreamFence();
+  }
+
+  if (uniform_scale) {
+    *uniform_scale = all_uniform;
+  }
   return true;
 }
 }  // namespace animation
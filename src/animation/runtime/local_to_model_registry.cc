@@ -0,0 +1,88 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/local_to_model_registry.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Head of registered functions list. Zero initialized before any dynamic
+// initialization, so registrars can be constructed in any order.
+LocalToModelRegistrar* registrars_head = nullptr;
+
+// Updates FNV-1a _hash with a 16 bits value, independently of endianness.
+uint32_t HashU16(uint32_t _hash, uint16_t _value) {
+  const uint32_t kPrime = 16777619u;
+  _hash = (_hash ^ (_value & 0xff)) * kPrime;
+  _hash = (_hash ^ (_value >> 8)) * kPrime;
+  return _hash;
+}
+}  // namespace
+
+uint32_t HashSkeletonHierarchy(const Skeleton& _skeleton) {
+  uint32_t hash = 2166136261u;
+  hash = HashU16(hash, static_cast<uint16_t>(_skeleton.num_joints()));
+  for (const int16_t parent : _skeleton.joint_parents()) {
+    hash = HashU16(hash, static_cast<uint16_t>(parent));
+  }
+  return hash;
+}
+
+LocalToModelRegistrar::LocalToModelRegistrar(uint32_t _hash, int _num_joints,
+                                             LocalToModelFn _fn)
+    : hash_(_hash), num_joints_(_num_joints), fn_(_fn), next_(registrars_head) {
+  registrars_head = this;
+}
+
+LocalToModelRegistrar::~LocalToModelRegistrar() {
+  for (LocalToModelRegistrar** it = &registrars_head; *it;
+       it = &(*it)->next_) {
+    if (*it == this) {
+      *it = next_;
+      break;
+    }
+  }
+}
+
+LocalToModelFn FindLocalToModel(const Skeleton& _skeleton) {
+  if (!registrars_head) {
+    return nullptr;
+  }
+  const uint32_t hash = HashSkeletonHierarchy(_skeleton);
+  for (const LocalToModelRegistrar* it = registrars_head; it;
+       it = it->next_) {
+    if (it->hash_ == hash && it->num_joints_ == _skeleton.num_joints()) {
+      return it->fn_;
+    }
+  }
+  return nullptr;
+}
+}  // namespace animation
+}  // namespace ozz
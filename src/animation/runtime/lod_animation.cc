@@ -0,0 +1,105 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/lod_animation.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "ozz/base/containers/vector_archive.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+
+namespace ozz {
+namespace animation {
+
+LODAnimation::LODAnimation() {}
+
+LODAnimation::LODAnimation(LODAnimation&& _other) {
+  *this = std::move(_other);
+}
+
+LODAnimation& LODAnimation::operator=(LODAnimation&& _other) {
+  std::swap(tolerances_, _other.tolerances_);
+  std::swap(levels_, _other.levels_);
+  return *this;
+}
+
+LODAnimation::~LODAnimation() {}
+
+const Animation& LODAnimation::level(int _index) const {
+  assert(_index >= 0 && _index < num_levels() && "Invalid level index.");
+  return levels_[_index];
+}
+
+int LODAnimation::SelectLevel(float _max_error) const {
+  if (levels_.empty()) {
+    return -1;
+  }
+  // Finds the first tolerance strictly greater than _max_error, the level
+  // before being the coarsest one that's precise enough.
+  const int index = static_cast<int>(
+      std::upper_bound(tolerances_.begin(), tolerances_.end(), _max_error) -
+      tolerances_.begin());
+  return index > 0 ? index - 1 : 0;
+}
+
+size_t LODAnimation::size() const {
+  size_t size = sizeof(*this) + tolerances_.size() * sizeof(float) +
+                levels_.size() * sizeof(Animation);
+  for (const Animation& level : levels_) {
+    size += level.size() - sizeof(Animation);
+  }
+  return size;
+}
+
+void LODAnimation::Save(ozz::io::OArchive& _archive) const {
+  _archive << tolerances_;
+  for (const Animation& level : levels_) {
+    _archive << level;
+  }
+}
+
+void LODAnimation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Destroy animation in case it was already used before.
+  tolerances_.clear();
+  levels_.clear();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported LODAnimation version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  _archive >> tolerances_;
+  levels_.resize(tolerances_.size());
+  for (Animation& level : levels_) {
+    _archive >> level;
+  }
+}
+}  // namespace animation
+}  // namespace ozz
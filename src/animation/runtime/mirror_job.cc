@@ -0,0 +1,114 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/mirror_job.h"
+
+#include "ozz/animation/runtime/mirror_map.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+// SoaTransform is accessed as 10 consecutive SimdFloat4 (translation x, y, z,
+// rotation x, y, z, w and scale x, y, z) to gather lanes.
+static_assert(sizeof(math::SoaTransform) == 10 * sizeof(math::SimdFloat4),
+              "Unexpected SoaTransform layout");
+
+MirrorJob::MirrorJob() : map(nullptr) {}
+
+bool MirrorJob::Validate() const {
+  if (!map) {
+    return false;
+  }
+  bool valid = true;
+
+  const size_t num_soa_joints = (map->num_joints() + 3) / 4;
+  valid &= input.size() >= num_soa_joints;
+  valid &= output.size() >= num_soa_joints;
+
+  return valid;
+}
+
+bool MirrorJob::Run() const {
+  OZZ_PROFILE_ZONE("MirrorJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  // Sign masks of the translation component normal to the plane, and of the
+  // rotation components in the plane.
+  const math::SimdInt4 sign = math::simd_int4::mask_sign();
+  const math::SimdInt4 none = math::simd_int4::zero();
+  const MirrorMap::Axis axis = map->axis();
+  const math::SimdInt4 tx = axis == MirrorMap::kX ? sign : none;
+  const math::SimdInt4 ty = axis == MirrorMap::kY ? sign : none;
+  const math::SimdInt4 tz = axis == MirrorMap::kZ ? sign : none;
+  const math::SimdInt4 rx = axis == MirrorMap::kX ? none : sign;
+  const math::SimdInt4 ry = axis == MirrorMap::kY ? none : sign;
+  const math::SimdInt4 rz = axis == MirrorMap::kZ ? none : sign;
+
+  const int num_joints = map->num_joints();
+  const span<const int16_t> joint_remaps = map->joint_remaps();
+  const span<const int16_t> soa_remaps = map->soa_remaps();
+  for (size_t i = 0; i < soa_remaps.size(); ++i) {
+    math::SoaTransform& out = output[i];
+
+    const int soa_remap = soa_remaps[i];
+    if (soa_remap != -1) {
+      // Whole SoA joint copy.
+      out = input[soa_remap];
+    } else {
+      // Gathers lanes one by one.
+      float* out_f = reinterpret_cast<float*>(&out);
+      for (int j = 0; j < 4; ++j) {
+        // Lanes beyond the last joint are gathered from the last joint.
+        const int joint =
+            math::Min(static_cast<int>(i) * 4 + j, num_joints - 1);
+        const int remap = joint_remaps[joint];
+        const float* in = reinterpret_cast<const float*>(&input[remap / 4]);
+        const int lane = remap & 3;
+        for (int k = 0; k < 10; ++k) {
+          out_f[k * 4 + j] = in[k * 4 + lane];
+        }
+      }
+    }
+
+    // Reflects 4 joints at a time.
+    out.translation.x = math::Xor(out.translation.x, tx);
+    out.translation.y = math::Xor(out.translation.y, ty);
+    out.translation.z = math::Xor(out.translation.z, tz);
+    out.rotation.x = math::Xor(out.rotation.x, rx);
+    out.rotation.y = math::Xor(out.rotation.y, ry);
+    out.rotation.z = math::Xor(out.rotation.z, rz);
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,108 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/mirror_map.h"
+
+#include <utility>
+
+#include "ozz/base/containers/vector_archive.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+
+namespace ozz {
+namespace animation {
+
+MirrorMap::MirrorMap() : axis_(kX) {}
+
+MirrorMap::MirrorMap(MirrorMap&& _other) : axis_(kX) {
+  *this = std::move(_other);
+}
+
+MirrorMap& MirrorMap::operator=(MirrorMap&& _other) {
+  std::swap(axis_, _other.axis_);
+  std::swap(joint_remaps_, _other.joint_remaps_);
+  std::swap(soa_remaps_, _other.soa_remaps_);
+  return *this;
+}
+
+MirrorMap::~MirrorMap() {}
+
+void MirrorMap::BuildSoaRemaps() {
+  const int num_joints = this->num_joints();
+  const int num_soa_joints = (num_joints + 3) / 4;
+  soa_remaps_.resize(num_soa_joints);
+  for (int i = 0; i < num_soa_joints; ++i) {
+    // The first lane must be paired with the first lane of a SoA joint, and
+    // following lanes with following lanes. Lanes beyond the last joint are
+    // ignored.
+    const int first = joint_remaps_[i * 4];
+    bool copy = (first & 3) == 0;
+    for (int j = 1; copy && j < 4 && i * 4 + j < num_joints; ++j) {
+      copy = joint_remaps_[i * 4 + j] == first + j;
+    }
+    soa_remaps_[i] = static_cast<int16_t>(copy ? first / 4 : -1);
+  }
+}
+
+void MirrorMap::Save(ozz::io::OArchive& _archive) const {
+  _archive << static_cast<int32_t>(axis_);
+  _archive << joint_remaps_;
+}
+
+void MirrorMap::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Resets map in case it was already used before.
+  axis_ = kX;
+  joint_remaps_.clear();
+  soa_remaps_.clear();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported MirrorMap version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  int32_t axis;
+  _archive >> axis;
+  _archive >> joint_remaps_;
+
+  // Rejects invalid axis, and remaps that aren't symmetric pairs.
+  bool valid = axis >= kX && axis <= kZ;
+  const int num_joints = this->num_joints();
+  for (int i = 0; valid && i < num_joints; ++i) {
+    const int remap = joint_remaps_[i];
+    valid = remap >= 0 && remap < num_joints && joint_remaps_[remap] == i;
+  }
+  if (!valid) {
+    log::Err() << "Invalid MirrorMap." << std::endl;
+    joint_remaps_.clear();
+    return;
+  }
+  axis_ = static_cast<Axis>(axis);
+  BuildSoaRemaps();
+}
+}  // namespace animation
+}  // namespace ozz
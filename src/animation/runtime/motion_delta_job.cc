@@ -0,0 +1,131 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/motion_delta_job.h"
+
+#include <cstdlib>
+
+#include "ozz/animation/runtime/track.h"
+#include "ozz/animation/runtime/track_sampling_job.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/transform.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Samples motion frame at _ratio. Tracks are already validated.
+math::Transform SampleMotion(const Float3Track& _position,
+                             const QuaternionTrack* _rotation, float _ratio) {
+  math::Transform motion = math::Transform::identity();
+
+  Float3TrackSamplingJob position_job;
+  position_job.track = &_position;
+  position_job.ratio = _ratio;
+  position_job.result = &motion.translation;
+  position_job.Run();
+
+  if (_rotation) {
+    QuaternionTrackSamplingJob rotation_job;
+    rotation_job.track = _rotation;
+    rotation_job.ratio = _ratio;
+    rotation_job.result = &motion.rotation;
+    rotation_job.Run();
+  }
+  return motion;
+}
+
+// Computes the motion from _from to _to, in _from frame.
+math::Transform Delta(const math::Transform& _from,
+                      const math::Transform& _to) {
+  const math::Quaternion inv_rotation = Conjugate(_from.rotation);
+  math::Transform delta = math::Transform::identity();
+  delta.translation =
+      TransformVector(inv_rotation, _to.translation - _from.translation);
+  delta.rotation = inv_rotation * _to.rotation;
+  return delta;
+}
+
+// Appends _next motion, expressed in _motion end frame, to _motion.
+math::Transform Append(const math::Transform& _motion,
+                       const math::Transform& _next) {
+  math::Transform motion = math::Transform::identity();
+  motion.translation = _motion.translation +
+                       TransformVector(_motion.rotation, _next.translation);
+  motion.rotation = _motion.rotation * _next.rotation;
+  return motion;
+}
+}  // namespace
+
+MotionDeltaJob::MotionDeltaJob()
+    : from(0.f),
+      to(0.f),
+      loops(0),
+      position(nullptr),
+      rotation(nullptr),
+      delta(nullptr) {}
+
+bool MotionDeltaJob::Validate() const {
+  bool valid = true;
+  valid &= position != nullptr;
+  valid &= delta != nullptr;
+  return valid;
+}
+
+bool MotionDeltaJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const float clamped_from = math::Clamp(0.f, from, 1.f);
+  const float clamped_to = math::Clamp(0.f, to, 1.f);
+  const math::Transform start =
+      SampleMotion(*position, rotation, clamped_from);
+  const math::Transform end = SampleMotion(*position, rotation, clamped_to);
+
+  if (loops == 0) {
+    *delta = Delta(start, end);
+  } else {
+    // Plays up to the animation bound, then whole cycles, and finally from
+    // the opposite bound to "to".
+    const math::Transform first = SampleMotion(*position, rotation, 0.f);
+    const math::Transform last = SampleMotion(*position, rotation, 1.f);
+    const bool forward = loops > 0;
+    const math::Transform& exit = forward ? last : first;
+    const math::Transform& entry = forward ? first : last;
+    const math::Transform cycle = Delta(entry, exit);
+    math::Transform motion = Delta(start, exit);
+    for (int i = 1; i < std::abs(loops); ++i) {
+      motion = Append(motion, cycle);
+    }
+    *delta = Append(motion, Delta(entry, end));
+  }
+  delta->rotation = Normalize(delta->rotation);
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
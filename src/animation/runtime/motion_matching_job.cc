@@ -0,0 +1,175 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/motion_matching_job.h"
+
+#include <limits>
+
+#include "ozz/animation/runtime/feature_database.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/scratch_buffer.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Number of features that fit the stack.
+enum { kMaxInlineFeatures = 128 };
+
+// Computes the lower bound of the cost of any frame in _box, aka the squared
+// distance from _query to _box. Stops as soon as _best is reached.
+float BoxCost(const float* _box, const float* _query, int _num_features,
+              float _best) {
+  const float* mins = _box;
+  const float* maxs = _box + _num_features;
+  float cost = 0.f;
+  for (int f = 0; f < _num_features && cost < _best; ++f) {
+    const float q = _query[f];
+    const float d = math::Max(math::Max(mins[f] - q, q - maxs[f]), 0.f);
+    cost += d * d;
+  }
+  return cost;
+}
+
+// Searches a database, keeping the best match.
+class Search {
+ public:
+  Search(const FeatureDatabase& _database, const float* _query,
+         const math::SimdFloat4* _splat_query)
+      : database_(_database),
+        query_(_query),
+        splat_query_(_splat_query),
+        num_features_(_database.num_features()),
+        best_cost_(std::numeric_limits<float>::max()),
+        best_frame_(-1) {}
+
+  // Evaluates all frames of blocks [_begin,_end[.
+  void Blocks(int _begin, int _end) {
+    for (int b = _begin; b < _end; ++b) {
+      const math::SimdFloat4* features = database_.block(b).data();
+      math::SimdFloat4 cost = math::simd_float4::zero();
+      for (int f = 0; f < num_features_; ++f) {
+        const math::SimdFloat4 d = features[f] - splat_query_[f];
+        cost = math::MAdd(d, d, cost);
+      }
+      // Most blocks don't improve the best match, lanes are only inspected
+      // if one does.
+      const math::SimdFloat4 best = math::simd_float4::Load1(best_cost_);
+      const int mask = math::MoveMask(math::CmpLt(cost, best));
+      if (mask) {
+        float costs[4];
+        math::StorePtrU(cost, costs);
+        for (int l = 0; l < 4; ++l) {
+          const int frame = b * 4 + l;
+          if ((mask & (1 << l)) && costs[l] < best_cost_ &&
+              frame < database_.num_frames()) {
+            best_cost_ = costs[l];
+            best_frame_ = frame;
+          }
+        }
+      }
+    }
+  }
+
+  // Evaluates frames of blocks [_begin,_end[, skipping boxes of _box_frames
+  // frames that can't improve the best match.
+  void Boxes(span<const float> _boxes, int _box_frames, int _begin, int _end) {
+    const int box_blocks = _box_frames / 4;
+    for (int b = _begin; b < _end; b += box_blocks) {
+      const float* box = _boxes.data() + static_cast<size_t>(b / box_blocks) *
+                                             num_features_ * 2;
+      if (BoxCost(box, query_, num_features_, best_cost_) >= best_cost_) {
+        continue;
+      }
+      const int end = math::Min(b + box_blocks, _end);
+      if (_box_frames == FeatureDatabase::kLargeBoxFrames) {
+        Boxes(database_.small_boxes(), FeatureDatabase::kSmallBoxFrames, b,
+              end);
+      } else {
+        Blocks(b, end);
+      }
+    }
+  }
+
+  float best_cost() const { return best_cost_; }
+  int best_frame() const { return best_frame_; }
+
+ private:
+  const FeatureDatabase& database_;
+  const float* query_;
+  const math::SimdFloat4* splat_query_;
+  const int num_features_;
+  float best_cost_;
+  int best_frame_;
+};
+}  // namespace
+
+MotionMatchingJob::MotionMatchingJob()
+    : database(nullptr), accelerate(true), output(nullptr) {}
+
+bool MotionMatchingJob::Validate() const {
+  bool success = true;
+  success &= database != nullptr && database->num_frames() > 0;
+  success &= output != nullptr;
+  success &= database == nullptr ||
+             query.size() >= static_cast<size_t>(database->num_features());
+  return success;
+}
+
+bool MotionMatchingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Normalizes and splats query.
+  const int num_features = database->num_features();
+  memory::ScratchBuffer<float, kMaxInlineFeatures> normalized(num_features);
+  memory::ScratchBuffer<math::SimdFloat4, kMaxInlineFeatures> splat(num_features);
+  const span<float> normalized_span(normalized.data(),
+                                    static_cast<size_t>(num_features));
+  database->Normalize(query, normalized_span);
+  for (int f = 0; f < num_features; ++f) {
+    splat[f] = math::simd_float4::Load1(normalized[f]);
+  }
+
+  Search search(*database, normalized.data(), splat.data());
+  if (accelerate) {
+    search.Boxes(database->large_boxes(), FeatureDatabase::kLargeBoxFrames, 0,
+                 database->num_blocks());
+  } else {
+    search.Blocks(0, database->num_blocks());
+  }
+
+  output->frame = search.best_frame();
+  output->clip = database->clip(output->frame);
+  output->ratio = database->ratio(output->frame);
+  output->cost = search.best_cost();
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,158 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/multi_float_track.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+namespace ozz {
+namespace animation {
+
+MultiFloatTrack::MultiFloatTrack(memory::Allocator* _allocator)
+    : num_channels_(0), name_(nullptr), allocator_(_allocator) {}
+
+MultiFloatTrack::MultiFloatTrack(MultiFloatTrack&& _other)
+    : num_channels_(0), name_(nullptr), allocator_(nullptr) {
+  *this = std::move(_other);
+}
+
+MultiFloatTrack& MultiFloatTrack::operator=(MultiFloatTrack&& _other) {
+  std::swap(num_channels_, _other.num_channels_);
+  std::swap(values_, _other.values_);
+  std::swap(ratios_, _other.ratios_);
+  std::swap(steps_, _other.steps_);
+  std::swap(name_, _other.name_);
+  std::swap(allocator_, _other.allocator_);
+  return *this;
+}
+
+MultiFloatTrack::~MultiFloatTrack() { Deallocate(); }
+
+void MultiFloatTrack::Allocate(size_t _keys_count, int _num_channels,
+                               size_t _name_len) {
+  assert(ratios_.size() == 0 && values_.size() == 0);
+
+  num_channels_ = _num_channels;
+  const size_t values_count = _keys_count * num_soa_channels() * 4;
+
+  // Compute overall size and allocate a single buffer for all the data.
+  // Values are served first, so that each keyframe values are 16 bytes
+  // aligned.
+  const size_t buffer_size = values_count * sizeof(float) +     // values
+                             _keys_count * sizeof(float) +      // ratios
+                             (_keys_count + 7) * sizeof(uint8_t) / 8 +  // steps
+                             (_name_len > 0 ? _name_len + 1 : 0);
+  const memory::TagScope memory_tag(memory::kTagTrack);
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  span<byte> buffer = {
+      static_cast<byte*>(allocator->Allocate(buffer_size, 16)), buffer_size};
+
+  // Fix up pointers. Serves larger alignment values first.
+  values_ = fill_span<float>(buffer, values_count);
+  ratios_ = fill_span<float>(buffer, _keys_count);
+  steps_ = fill_span<uint8_t>(buffer, (_keys_count + 7) / 8);
+
+  // Let name be nullptr if track has no name.
+  name_ =
+      _name_len > 0 ? fill_span<char>(buffer, _name_len + 1).data() : nullptr;
+
+  assert(buffer.empty() && "Whole buffer should be consumned");
+}
+
+void MultiFloatTrack::Deallocate() {
+  // Deallocate everything at once.
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  allocator->Deallocate(as_writable_bytes(values_).data());
+
+  num_channels_ = 0;
+  values_ = {};
+  ratios_ = {};
+  steps_ = {};
+  name_ = nullptr;
+}
+
+size_t MultiFloatTrack::size() const {
+  const size_t size = sizeof(*this) + values_.size_bytes() +
+                      ratios_.size_bytes() + steps_.size_bytes();
+  return size;
+}
+
+void MultiFloatTrack::Save(ozz::io::OArchive& _archive) const {
+  const uint32_t num_keys = static_cast<uint32_t>(ratios_.size());
+  _archive << num_keys;
+  _archive << static_cast<int32_t>(num_channels_);
+
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  _archive << static_cast<int32_t>(name_len);
+
+  _archive << ozz::io::MakeArray(ratios_);
+  _archive << ozz::io::MakeArray(values_);
+  _archive << ozz::io::MakeArray(steps_);
+
+  _archive << ozz::io::MakeArray(name_, name_len);
+}
+
+void MultiFloatTrack::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Destroy track in case it was already used before.
+  Deallocate();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported MultiFloatTrack version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  uint32_t num_keys;
+  _archive >> num_keys;
+
+  int32_t num_channels;
+  _archive >> num_channels;
+
+  int32_t name_len;
+  _archive >> name_len;
+
+  Allocate(num_keys, num_channels, name_len);
+
+  _archive >> ozz::io::MakeArray(ratios_);
+  _archive >> ozz::io::MakeArray(values_);
+  _archive >> ozz::io::MakeArray(steps_);
+
+  if (name_) {  // nullptr name_ is supported.
+    _archive >> ozz::io::MakeArray(name_, name_len);
+    name_[name_len] = 0;
+  }
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,128 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/partitioned_animation.h"
+
+#include <cassert>
+
+#include "ozz/base/containers/string_archive.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+
+namespace ozz {
+namespace animation {
+
+PartitionedAnimation::PartitionedAnimation()
+    : duration_(0.f), num_tracks_(0), partition_soa_tracks_(0) {}
+
+PartitionedAnimation::PartitionedAnimation(PartitionedAnimation&& _other) {
+  *this = std::move(_other);
+}
+
+PartitionedAnimation& PartitionedAnimation::operator=(
+    PartitionedAnimation&& _other) {
+  std::swap(duration_, _other.duration_);
+  std::swap(num_tracks_, _other.num_tracks_);
+  std::swap(partition_soa_tracks_, _other.partition_soa_tracks_);
+  std::swap(name_, _other.name_);
+  std::swap(partitions_, _other.partitions_);
+  return *this;
+}
+
+PartitionedAnimation::~PartitionedAnimation() {}
+
+const Animation& PartitionedAnimation::partition(int _index) const {
+  assert(_index >= 0 && _index < num_partitions() &&
+         "Invalid partition index.");
+  return partitions_[_index];
+}
+
+size_t PartitionedAnimation::size() const {
+  size_t size =
+      sizeof(*this) + name_.size() + partitions_.size() * sizeof(Animation);
+  for (const Animation& partition : partitions_) {
+    size += partition.size() - sizeof(Animation);
+  }
+  return size;
+}
+
+void PartitionedAnimation::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
+  _archive << static_cast<int32_t>(partition_soa_tracks_);
+  _archive << name_;
+  _archive << static_cast<int32_t>(partitions_.size());
+  for (const Animation& partition : partitions_) {
+    _archive << partition;
+  }
+}
+
+void PartitionedAnimation::Load(ozz::io::IArchive& _archive,
+                                uint32_t _version) {
+  // Destroy animation in case it was already used before.
+  duration_ = 0.f;
+  num_tracks_ = 0;
+  partition_soa_tracks_ = 0;
+  name_.clear();
+  partitions_.clear();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported PartitionedAnimation version " << _version
+               << "." << std::endl;
+    return;
+  }
+
+  _archive >> duration_;
+  int32_t num_tracks;
+  _archive >> num_tracks;
+  int32_t partition_soa_tracks;
+  _archive >> partition_soa_tracks;
+  _archive >> name_;
+  int32_t num_partitions;
+  _archive >> num_partitions;
+
+  // Partitions must cover all tracks.
+  const int32_t num_soa_tracks = (num_tracks + 3) / 4;
+  if (num_tracks < 0 || num_partitions < 0 ||
+      (num_soa_tracks > 0 &&
+       (partition_soa_tracks <= 0 ||
+        num_partitions != (num_soa_tracks + partition_soa_tracks - 1) /
+                              partition_soa_tracks))) {
+    log::Err() << "Invalid PartitionedAnimation partitions." << std::endl;
+    name_.clear();
+    duration_ = 0.f;
+    return;
+  }
+  num_tracks_ = num_tracks;
+  partition_soa_tracks_ = partition_soa_tracks;
+  partitions_.resize(num_partitions);
+  for (Animation& partition : partitions_) {
+    _archive >> partition;
+  }
+}
+}  // namespace animation
+}  // namespace ozz
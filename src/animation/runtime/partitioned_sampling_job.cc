@@ -0,0 +1,104 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/partitioned_sampling_job.h"
+
+#include <cassert>
+
+#include "ozz/animation/runtime/partitioned_animation.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+namespace {
+
+// Samples partition _task of the valid job _data.
+void SamplePartition(int _task, void* _data) {
+  const PartitionedSamplingJob& job =
+      *static_cast<const PartitionedSamplingJob*>(_data);
+  const Animation& partition = job.animation->partition(_task);
+  const size_t offset =
+      static_cast<size_t>(_task) * job.animation->partition_soa_tracks();
+
+  SamplingJob sampling;
+  sampling.ratio = job.ratio;
+  sampling.animation = &partition;
+  sampling.context = &job.contexts[_task];
+  sampling.output = job.output.subspan(offset, partition.num_soa_tracks());
+  const bool success = sampling.Run();
+  (void)success;
+  assert(success && "Partition sampling job is valid.");
+}
+}  // namespace
+
+PartitionedSamplingJob::PartitionedSamplingJob()
+    : ratio(0.f),
+      animation(nullptr),
+      parallel_for(nullptr),
+      parallel_for_user_data(nullptr) {}
+
+bool PartitionedSamplingJob::Validate() const {
+  if (!animation) {
+    return false;
+  }
+  const int num_partitions = animation->num_partitions();
+  if (contexts.size() < static_cast<size_t>(num_partitions)) {
+    return false;
+  }
+
+  bool valid =
+      output.size() >= static_cast<size_t>(animation->num_soa_tracks());
+  for (int i = 0; i < num_partitions; ++i) {
+    const Animation& partition = animation->partition(i);
+    valid &= contexts[i].max_soa_tracks() >= partition.num_soa_tracks();
+    valid &= !partition.cubic() || contexts[i].cubic();
+  }
+  return valid;
+}
+
+bool PartitionedSamplingJob::Run() const {
+  OZZ_PROFILE_ZONE("PartitionedSamplingJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_partitions = animation->num_partitions();
+  if (parallel_for && num_partitions > 1) {
+    parallel_for(num_partitions, &SamplePartition,
+                 const_cast<PartitionedSamplingJob*>(this),
+                 parallel_for_user_data);
+  } else {
+    for (int i = 0; i < num_partitions; ++i) {
+      SamplePartition(i, const_cast<PartitionedSamplingJob*>(this));
+    }
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,114 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/pose_buffer.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Buffers are aligned to a cache line, which is also the size of a matrix.
+const size_t kPoseBufferAlignment = 64;
+static_assert(sizeof(math::Float4x4) % kPoseBufferAlignment == 0,
+              "Poses must start on a cache line.");
+}  // namespace
+
+PoseBuffer::PoseBuffer()
+    : num_joints_(0),
+      buffers_(nullptr),
+      back_(0),
+      shared_(1),
+      front_(2),
+      acquired_(false) {}
+
+PoseBuffer::~PoseBuffer() { Deallocate(); }
+
+bool PoseBuffer::Allocate(const Skeleton& _skeleton) {
+  Deallocate();
+  const int num_joints = _skeleton.num_joints();
+  if (num_joints == 0) {
+    return false;
+  }
+  void* buffers = memory::default_allocator()->Allocate(
+      sizeof(math::Float4x4) * num_joints * 3, kPoseBufferAlignment);
+  buffers_ = static_cast<math::Float4x4*>(buffers);
+  num_joints_ = num_joints;
+  return true;
+}
+
+void PoseBuffer::Deallocate() {
+  memory::default_allocator()->Deallocate(buffers_);
+  buffers_ = nullptr;
+  num_joints_ = 0;
+  back_ = 0;
+  shared_.store(1, std::memory_order_relaxed);
+  front_ = 2;
+  acquired_ = false;
+}
+
+math::Float4x4* PoseBuffer::buffer(int _index) const {
+  return buffers_ + _index * num_joints_;
+}
+
+span<math::Float4x4> PoseBuffer::back() const {
+  if (!buffers_) {
+    return {};
+  }
+  return {buffer(back_), static_cast<size_t>(num_joints_)};
+}
+
+void PoseBuffer::Publish() {
+  if (!buffers_) {
+    return;
+  }
+  // Release makes back buffer writes visible to the reader acquiring it, while
+  // acquire ensures reader is done with the buffer the writer gets back.
+  back_ = shared_.exchange(back_ | kFresh, std::memory_order_acq_rel) &
+          kIndexMask;
+}
+
+bool PoseBuffer::Acquire() {
+  if (!buffers_ || (shared_.load(std::memory_order_relaxed) & kFresh) == 0) {
+    return false;
+  }
+  front_ = shared_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+  acquired_ = true;
+  return true;
+}
+
+span<const math::Float4x4> PoseBuffer::front() const {
+  if (!acquired_) {
+    return {};
+  }
+  return {buffer(front_), static_cast<size_t>(num_joints_)};
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,238 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/pose_cache.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+namespace ozz {
+namespace animation {
+
+PoseCache::PoseCache()
+    : skeleton_(nullptr),
+      capacity_(0),
+      num_entries_(0),
+      num_evaluated_(0),
+      hits_(0),
+      ratio_step_(0.f),
+      buffer_(nullptr),
+      entries_(nullptr),
+      locals_(nullptr),
+      models_(nullptr),
+      table_(nullptr),
+      table_mask_(0) {}
+
+PoseCache::~PoseCache() { Deallocate(); }
+
+bool PoseCache::Allocate(const Skeleton& _skeleton, int _capacity,
+                         bool _model_space, bool _cubic) {
+  Deallocate();
+  if (_capacity <= 0 || _skeleton.num_joints() == 0) {
+    return false;
+  }
+
+  size_t table_size = 2;
+  while (table_size < static_cast<size_t>(_capacity) * 2) {
+    table_size *= 2;
+  }
+
+  // Computes buffers layout, biggest alignment first.
+  const size_t locals_size = sizeof(math::SoaTransform) *
+                             _skeleton.num_soa_joints() * _capacity;
+  const size_t models_size =
+      _model_space ? sizeof(math::Float4x4) * _skeleton.num_joints() * _capacity
+                   : 0;
+  const size_t entries_size = sizeof(Entry) * _capacity;
+  const size_t table_bytes = sizeof(int) * table_size;
+  static_assert(alignof(math::SoaTransform) >= alignof(math::Float4x4) &&
+                    alignof(math::Float4x4) >= alignof(Entry) &&
+                    alignof(Entry) >= alignof(int),
+                "Must serve each type alignment requirement.");
+
+  const memory::TagScope memory_tag(memory::kTagContext);
+  buffer_ = memory::default_allocator()->Allocate(
+      locals_size + models_size + entries_size + table_bytes,
+      alignof(math::SoaTransform));
+  byte* alloc_cursor = static_cast<byte*>(buffer_);
+  locals_ = reinterpret_cast<math::SoaTransform*>(alloc_cursor);
+  alloc_cursor += locals_size;
+  models_ = _model_space ? reinterpret_cast<math::Float4x4*>(alloc_cursor)
+                         : nullptr;
+  alloc_cursor += models_size;
+  entries_ = reinterpret_cast<Entry*>(alloc_cursor);
+  alloc_cursor += entries_size;
+  table_ = reinterpret_cast<int*>(alloc_cursor);
+  table_mask_ = table_size - 1;
+
+  skeleton_ = &_skeleton;
+  capacity_ = _capacity;
+  contexts_.Resize(_capacity, _skeleton.num_joints(), _cubic);
+  Clear();
+
+  return true;
+}
+
+void PoseCache::Deallocate() {
+  memory::default_allocator()->Deallocate(buffer_);
+  contexts_.Resize(0, 0);
+  skeleton_ = nullptr;
+  capacity_ = 0;
+  num_entries_ = 0;
+  num_evaluated_ = 0;
+  hits_ = 0;
+  buffer_ = nullptr;
+  entries_ = nullptr;
+  locals_ = nullptr;
+  models_ = nullptr;
+  table_ = nullptr;
+  table_mask_ = 0;
+}
+
+void PoseCache::set_ratio_step(float _step) {
+  ratio_step_ = math::Max(_step, 0.f);
+  Clear();
+}
+
+void PoseCache::Clear() {
+  num_entries_ = 0;
+  num_evaluated_ = 0;
+  hits_ = 0;
+  if (table_) {
+    std::memset(table_, 0xff, sizeof(int) * (table_mask_ + 1));
+  }
+}
+
+size_t PoseCache::Slot(const Animation* _animation, int32_t _key) const {
+  const uint64_t bits = static_cast<uint64_t>(
+                            reinterpret_cast<uintptr_t>(_animation)) ^
+                        (static_cast<uint64_t>(static_cast<uint32_t>(_key))
+                         << 32);
+  return static_cast<size_t>((bits * 0x9e3779b97f4a7c15ull) >> 32) &
+         table_mask_;
+}
+
+int PoseCache::Request(const Animation& _animation, float _ratio) {
+  if (!skeleton_ || _animation.num_tracks() != skeleton_->num_joints()) {
+    return -1;
+  }
+
+  // Quantizes ratio.
+  float ratio = math::Clamp(0.f, _ratio, 1.f);
+  int32_t key;
+  if (ratio_step_ > 0.f) {
+    key = static_cast<int32_t>(ratio / ratio_step_ + .5f);
+    ratio = math::Min(key * ratio_step_, 1.f);
+  } else {
+    std::memcpy(&key, &ratio, sizeof(key));
+  }
+
+  // Finds pose in the table, or the empty slot to insert it to.
+  size_t slot = Slot(&_animation, key);
+  for (int index = table_[slot]; index != -1; index = table_[slot]) {
+    const Entry& entry = entries_[index];
+    if (entry.animation == &_animation && entry.key == key) {
+      ++hits_;
+      return index;
+    }
+    slot = (slot + 1) & table_mask_;
+  }
+
+  if (num_entries_ == capacity_) {
+    return -1;
+  }
+  const int index = num_entries_++;
+  const Entry entry = {&_animation, key, ratio};
+  entries_[index] = entry;
+  table_[slot] = index;
+  return index;
+}
+
+bool PoseCache::Evaluate() {
+  bool success = true;
+  const int num_soa_joints = skeleton_ ? skeleton_->num_soa_joints() : 0;
+  const int num_joints = skeleton_ ? skeleton_->num_joints() : 0;
+  for (; num_evaluated_ < num_entries_; ++num_evaluated_) {
+    const int index = num_evaluated_;
+    const Entry& entry = entries_[index];
+
+    SamplingJob sampling_job;
+    sampling_job.animation = entry.animation;
+    sampling_job.context = &contexts_.contexts()[index];
+    sampling_job.ratio = entry.ratio;
+    sampling_job.output = {locals_ + index * num_soa_joints,
+                           static_cast<size_t>(num_soa_joints)};
+    if (!sampling_job.Run()) {
+      success = false;
+      continue;
+    }
+
+    if (models_) {
+      LocalToModelJob ltm_job;
+      ltm_job.skeleton = skeleton_;
+      ltm_job.input = sampling_job.output;
+      ltm_job.output = {models_ + index * num_joints,
+                        static_cast<size_t>(num_joints)};
+      success &= ltm_job.Run();
+    }
+  }
+  return success;
+}
+
+span<const math::SoaTransform> PoseCache::locals(int _entry) const {
+  if (_entry < 0 || _entry >= num_entries_) {
+    return {};
+  }
+  const size_t num_soa_joints = skeleton_->num_soa_joints();
+  return {locals_ + _entry * num_soa_joints, num_soa_joints};
+}
+
+span<const math::Float4x4> PoseCache::models(int _entry) const {
+  if (!models_ || _entry < 0 || _entry >= num_entries_) {
+    return {};
+  }
+  const size_t num_joints = skeleton_->num_joints();
+  return {models_ + _entry * num_joints, num_joints};
+}
+
+float PoseCache::ratio(int _entry) const {
+  if (_entry < 0 || _entry >= num_entries_) {
+    return 0.f;
+  }
+  return entries_[_entry].ratio;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,362 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/pose_codec.h"
+
+#include <cstring>
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Each joint component (rotation, translation, scale) is encoded as 3 16 bits
+// values.
+const size_t kComponentSize = 6;
+
+// Smallest three rotation components are in range [-1/sqrt(2),1/sqrt(2)],
+// quantized on 15 bits.
+const float kRotationMax = 32767.f;
+const float kRotationRange = 1.41421356f;  // sqrt(2)
+
+// Gets the size of presence bits of _num_joints joints.
+size_t PresenceSize(int _num_joints) {
+  return static_cast<size_t>(_num_joints + 7) / 8;
+}
+
+// Stores _value as a little endian 16 bits integer.
+inline byte* Store16(int _value, byte* _out) {
+  _out[0] = static_cast<byte>(_value & 0xff);
+  _out[1] = static_cast<byte>((_value >> 8) & 0xff);
+  return _out + 2;
+}
+
+// Loads a little endian 16 bits integer.
+inline const byte* Load16(const byte* _in, int* _value) {
+  *_value = _in[0] | (_in[1] << 8);
+  return _in + 2;
+}
+
+// Tests if any component of _a and _b differs more than _tolerance.
+inline math::SimdInt4 Differs(const math::SoaFloat3& _a,
+                              const math::SoaFloat3& _b,
+                              math::_SimdFloat4 _tolerance) {
+  const math::SoaFloat3 diff = _a - _b;
+  const math::SimdFloat4 max_diff = math::Max(
+      math::Max(math::Abs(diff.x), math::Abs(diff.y)), math::Abs(diff.z));
+  return math::CmpGt(max_diff, _tolerance);
+}
+}  // namespace
+
+PoseEncodeJob::PoseEncodeJob()
+    : skeleton(nullptr),
+      translation_tolerance(1e-5f),
+      scale_tolerance(1e-4f),
+      size(nullptr) {}
+
+size_t PoseEncodeJob::MaxEncodedSize(int _num_joints) {
+  return PresenceSize(_num_joints) * 2 + _num_joints * kComponentSize * 3;
+}
+
+bool PoseEncodeJob::Validate() const {
+  if (!skeleton) {
+    return false;
+  }
+  bool valid = size != nullptr;
+  valid &= input.size() >= static_cast<size_t>(skeleton->num_soa_joints());
+  valid &= output.size() >= MaxEncodedSize(skeleton->num_joints());
+  valid &= translation_tolerance >= 0.f && scale_tolerance >= 0.f;
+  return valid;
+}
+
+bool PoseEncodeJob::Run() const {
+  OZZ_PROFILE_ZONE("PoseEncodeJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_joints = skeleton->num_joints();
+  const span<const math::SoaTransform> rest = skeleton->joint_rest_poses();
+
+  // Presence bits are set while joints are encoded.
+  const size_t presence_size = PresenceSize(num_joints);
+  byte* translation_bits = output.begin();
+  byte* scale_bits = translation_bits + presence_size;
+  std::memset(translation_bits, 0, presence_size * 2);
+  byte* cursor = scale_bits + presence_size;
+
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 translation_tol =
+      math::simd_float4::Load1(translation_tolerance);
+  const math::SimdFloat4 scale_tol = math::simd_float4::Load1(scale_tolerance);
+  const math::SimdFloat4 rotation_max = math::simd_float4::Load1(kRotationMax);
+  const math::SimdFloat4 rotation_scale =
+      math::simd_float4::Load1(kRotationMax * kRotationRange * .5f);
+  const math::SimdFloat4 rotation_offset =
+      math::simd_float4::Load1(kRotationMax * .5f);
+
+  for (int i = 0; i < num_joints; i += 4) {
+    const math::SoaTransform& transform = input[i / 4];
+    const math::SoaTransform& rest_transform = rest[i / 4];
+
+    // Rotation delta from rest pose, smallest three components.
+    const math::SoaQuaternion delta =
+        Conjugate(rest_transform.rotation) * transform.rotation;
+    const math::SimdFloat4 ax = math::Abs(delta.x);
+    const math::SimdFloat4 ay = math::Abs(delta.y);
+    const math::SimdFloat4 az = math::Abs(delta.z);
+    const math::SimdFloat4 aw = math::Abs(delta.w);
+    const math::SimdFloat4 largest =
+        math::Max(math::Max(ax, ay), math::Max(az, aw));
+    const math::SimdInt4 mx = math::CmpEq(ax, largest);
+    const math::SimdInt4 my = math::AndNot(math::CmpEq(ay, largest), mx);
+    const math::SimdInt4 mxy = math::Or(mx, my);
+    const math::SimdInt4 mz = math::AndNot(math::CmpEq(az, largest), mxy);
+    const math::SimdInt4 mw = math::Not(math::Or(mxy, mz));
+
+    // Largest component is made positive, as q and -q are the same rotation,
+    // so its sign doesn't need to be stored.
+    const math::SimdFloat4 largest_signed = math::Select(
+        mx, delta.x,
+        math::Select(my, delta.y, math::Select(mz, delta.z, delta.w)));
+    const math::SimdFloat4 sign =
+        math::Select(math::CmpLt(largest_signed, zero), -one, one);
+    const math::SimdFloat4 a = math::Select(mx, delta.y, delta.x) * sign;
+    const math::SimdFloat4 b = math::Select(mxy, delta.z, delta.y) * sign;
+    const math::SimdFloat4 c = math::Select(mw, delta.z, delta.w) * sign;
+
+    int rotations[3][4];
+    math::StorePtrU(math::simd_int4::FromFloatRound(math::Clamp(
+                        zero, a * rotation_scale + rotation_offset,
+                        rotation_max)),
+                    rotations[0]);
+    math::StorePtrU(math::simd_int4::FromFloatRound(math::Clamp(
+                        zero, b * rotation_scale + rotation_offset,
+                        rotation_max)),
+                    rotations[1]);
+    math::StorePtrU(math::simd_int4::FromFloatRound(math::Clamp(
+                        zero, c * rotation_scale + rotation_offset,
+                        rotation_max)),
+                    rotations[2]);
+    int largest_index[4];
+    math::StorePtrU(
+        math::Or(math::Or(math::And(my, math::simd_int4::Load1(1)),
+                          math::And(mz, math::simd_int4::Load1(2))),
+                 math::And(mw, math::simd_int4::Load1(3))),
+        largest_index);
+
+    // Translation delta from rest pose.
+    const math::SoaFloat3 translation_delta =
+        transform.translation - rest_transform.translation;
+    int translation_present[4];
+    math::StorePtrU(Differs(transform.translation, rest_transform.translation,
+                            translation_tol),
+                    translation_present);
+    int translations[3][4];
+    math::StorePtrU(math::FloatToHalf(translation_delta.x), translations[0]);
+    math::StorePtrU(math::FloatToHalf(translation_delta.y), translations[1]);
+    math::StorePtrU(math::FloatToHalf(translation_delta.z), translations[2]);
+
+    // Scale.
+    int scale_present[4];
+    math::StorePtrU(
+        Differs(transform.scale, rest_transform.scale, scale_tol),
+        scale_present);
+    int scales[3][4];
+    math::StorePtrU(math::FloatToHalf(transform.scale.x), scales[0]);
+    math::StorePtrU(math::FloatToHalf(transform.scale.y), scales[1]);
+    math::StorePtrU(math::FloatToHalf(transform.scale.z), scales[2]);
+
+    // Writes joints data. Largest component index bits are stored in the
+    // unused high bits of the first 2 components.
+    const int soa_end = math::Min(num_joints - i, 4);
+    for (int j = 0; j < soa_end; ++j) {
+      const int joint = i + j;
+      cursor = Store16(rotations[0][j] | ((largest_index[j] & 1) << 15),
+                       cursor);
+      cursor = Store16(rotations[1][j] | ((largest_index[j] >> 1) << 15),
+                       cursor);
+      cursor = Store16(rotations[2][j], cursor);
+      if (translation_present[j]) {
+        translation_bits[joint / 8] |= static_cast<byte>(1 << (joint & 7));
+        cursor = Store16(translations[0][j], cursor);
+        cursor = Store16(translations[1][j], cursor);
+        cursor = Store16(translations[2][j], cursor);
+      }
+      if (scale_present[j]) {
+        scale_bits[joint / 8] |= static_cast<byte>(1 << (joint & 7));
+        cursor = Store16(scales[0][j], cursor);
+        cursor = Store16(scales[1][j], cursor);
+        cursor = Store16(scales[2][j], cursor);
+      }
+    }
+  }
+
+  *size = static_cast<size_t>(cursor - output.begin());
+  return true;
+}
+
+PoseDecodeJob::PoseDecodeJob() : skeleton(nullptr) {}
+
+bool PoseDecodeJob::Validate() const {
+  if (!skeleton) {
+    return false;
+  }
+  return output.size() >= static_cast<size_t>(skeleton->num_soa_joints());
+}
+
+bool PoseDecodeJob::Run() const {
+  OZZ_PROFILE_ZONE("PoseDecodeJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_joints = skeleton->num_joints();
+  const span<const math::SoaTransform> rest = skeleton->joint_rest_poses();
+
+  const size_t presence_size = PresenceSize(num_joints);
+  if (input.size() < presence_size * 2) {
+    return false;
+  }
+  const byte* translation_bits = input.begin();
+  const byte* scale_bits = translation_bits + presence_size;
+  const byte* cursor = scale_bits + presence_size;
+  const byte* end = input.end();
+
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 rotation_scale =
+      math::simd_float4::Load1(1.f / (kRotationMax * kRotationRange * .5f));
+  const math::SimdFloat4 rotation_offset =
+      math::simd_float4::Load1(-1.f / kRotationRange);
+
+  for (int i = 0; i < num_joints; i += 4) {
+    // Reads joints data. Padding joints default to identity rotation delta.
+    const int kHalfRotation = 16384;
+    int rotations[3][4] = {{kHalfRotation, kHalfRotation, kHalfRotation,
+                            kHalfRotation},
+                           {kHalfRotation, kHalfRotation, kHalfRotation,
+                            kHalfRotation},
+                           {kHalfRotation, kHalfRotation, kHalfRotation,
+                            kHalfRotation}};
+    int largest_index[4] = {3, 3, 3, 3};
+    int translations[3][4] = {};
+    int scale_present[4] = {};
+    int scales[3][4] = {};
+    const int soa_end = math::Min(num_joints - i, 4);
+    for (int j = 0; j < soa_end; ++j) {
+      const int joint = i + j;
+      const int bit = 1 << (joint & 7);
+      const bool translation = (translation_bits[joint / 8] & bit) != 0;
+      const bool scale = (scale_bits[joint / 8] & bit) != 0;
+      const size_t joint_size =
+          kComponentSize * (1 + (translation ? 1 : 0) + (scale ? 1 : 0));
+      if (static_cast<size_t>(end - cursor) < joint_size) {
+        return false;
+      }
+      int values[3];
+      cursor = Load16(cursor, &values[0]);
+      cursor = Load16(cursor, &values[1]);
+      cursor = Load16(cursor, &values[2]);
+      rotations[0][j] = values[0] & 0x7fff;
+      rotations[1][j] = values[1] & 0x7fff;
+      rotations[2][j] = values[2];
+      largest_index[j] = (values[0] >> 15) | ((values[1] >> 15) << 1);
+      if (translation) {
+        cursor = Load16(cursor, &translations[0][j]);
+        cursor = Load16(cursor, &translations[1][j]);
+        cursor = Load16(cursor, &translations[2][j]);
+      }
+      if (scale) {
+        scale_present[j] = -1;
+        cursor = Load16(cursor, &scales[0][j]);
+        cursor = Load16(cursor, &scales[1][j]);
+        cursor = Load16(cursor, &scales[2][j]);
+      }
+    }
+
+    const math::SoaTransform& rest_transform = rest[i / 4];
+    math::SoaTransform& transform = output[i / 4];
+
+    // Restores rotation delta largest component, and applies it to rest pose.
+    const math::SimdFloat4 a =
+        math::simd_float4::FromInt(math::simd_int4::LoadPtrU(rotations[0])) *
+            rotation_scale +
+        rotation_offset;
+    const math::SimdFloat4 b =
+        math::simd_float4::FromInt(math::simd_int4::LoadPtrU(rotations[1])) *
+            rotation_scale +
+        rotation_offset;
+    const math::SimdFloat4 c =
+        math::simd_float4::FromInt(math::simd_int4::LoadPtrU(rotations[2])) *
+            rotation_scale +
+        rotation_offset;
+    const math::SimdFloat4 largest =
+        math::Sqrt(math::Max(zero, one - a * a - b * b - c * c));
+    const math::SimdInt4 index = math::simd_int4::LoadPtrU(largest_index);
+    const math::SimdInt4 mx = math::CmpEq(index, math::simd_int4::zero());
+    const math::SimdInt4 my = math::CmpEq(index, math::simd_int4::Load1(1));
+    const math::SimdInt4 mz = math::CmpEq(index, math::simd_int4::Load1(2));
+    const math::SimdInt4 mw = math::CmpEq(index, math::simd_int4::Load1(3));
+    const math::SoaQuaternion delta = {
+        math::Select(mx, largest, a),
+        math::Select(mx, a, math::Select(my, largest, b)),
+        math::Select(math::Or(mx, my), b, math::Select(mz, largest, c)),
+        math::Select(mw, largest, c)};
+    transform.rotation = rest_transform.rotation * delta;
+
+    // Omitted translations are decoded as a null delta.
+    const math::SoaFloat3 translation_delta = {
+        math::HalfToFloat(math::simd_int4::LoadPtrU(translations[0])),
+        math::HalfToFloat(math::simd_int4::LoadPtrU(translations[1])),
+        math::HalfToFloat(math::simd_int4::LoadPtrU(translations[2]))};
+    transform.translation = rest_transform.translation + translation_delta;
+
+    // Omitted scales are rest pose ones.
+    const math::SimdInt4 scale_mask = math::simd_int4::LoadPtrU(scale_present);
+    transform.scale.x = math::Select(
+        scale_mask, math::HalfToFloat(math::simd_int4::LoadPtrU(scales[0])),
+        rest_transform.scale.x);
+    transform.scale.y = math::Select(
+        scale_mask, math::HalfToFloat(math::simd_int4::LoadPtrU(scales[1])),
+        rest_transform.scale.y);
+    transform.scale.z = math::Select(
+        scale_mask, math::HalfToFloat(math::simd_int4::LoadPtrU(scales[2])),
+        rest_transform.scale.z);
+  }
+
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
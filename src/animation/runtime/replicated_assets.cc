@@ -0,0 +1,189 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/replicated_assets.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/numa.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Replicates assets to a node, run from a thread pinned to that node.
+struct NodeReplica {
+  // Inputs.
+  const Skeleton* source_skeleton;
+  span<const Animation* const> source_animations;
+
+  // Outputs.
+  void* image;
+  Skeleton* skeleton;
+  span<Animation*> animations;
+  bool success;
+};
+
+size_t AlignImage(size_t _size) { return Align(_size, 16); }
+
+void ReplicateNode(void* _data) {
+  NodeReplica& replica = *static_cast<NodeReplica*>(_data);
+  static_assert(Skeleton::kImageAlignment <= 16 &&
+                    Animation::kImageAlignment <= 16,
+                "Images must be aligned to 16 bytes");
+
+  // Computes images layout.
+  size_t size = replica.source_skeleton
+                    ? AlignImage(replica.source_skeleton->image_size())
+                    : 0;
+  for (const Animation* animation : replica.source_animations) {
+    size += AlignImage(animation->image_size());
+  }
+
+  // Writes images from this thread, so that memory is allocated on its node.
+  byte* image =
+      static_cast<byte*>(memory::default_allocator()->Allocate(size, 16));
+  replica.image = image;
+  replica.success = true;
+  if (replica.source_skeleton) {
+    const size_t image_size = replica.source_skeleton->image_size();
+    replica.skeleton = New<Skeleton>();
+    replica.success &= replica.source_skeleton->ToImage({image, image_size}) &&
+                       replica.skeleton->FromImage({image, image_size});
+    image += AlignImage(image_size);
+  }
+  for (size_t i = 0; i < replica.source_animations.size(); ++i) {
+    const Animation& source = *replica.source_animations[i];
+    const size_t image_size = source.image_size();
+    replica.animations[i] = New<Animation>();
+    replica.success &= source.ToImage({image, image_size}) &&
+                       replica.animations[i]->FromImage({image, image_size});
+    image += AlignImage(image_size);
+  }
+}
+}  // namespace
+
+ReplicatedAssets::ReplicatedAssets() : num_nodes_(0), num_animations_(0) {}
+
+ReplicatedAssets::~ReplicatedAssets() { Release(); }
+
+bool ReplicatedAssets::Replicate(const Skeleton* _skeleton,
+                                 span<const Animation* const> _animations,
+                                 int _num_nodes) {
+  Release();
+  const int num_nodes = _num_nodes < 0 ? numa::NumNodes() : _num_nodes;
+  if (num_nodes == 0) {
+    return false;
+  }
+  for (const Animation* animation : _animations) {
+    if (!animation) {
+      return false;
+    }
+  }
+
+  num_nodes_ = num_nodes;
+  num_animations_ = static_cast<int>(_animations.size());
+
+  // A single node doesn't need any copy.
+  if (num_nodes == 1) {
+    skeletons_.assign(1, _skeleton);
+    animations_.assign(_animations.begin(), _animations.end());
+    return true;
+  }
+
+  bool success = true;
+  owned_animations_.resize(_animations.size() * num_nodes, nullptr);
+  for (int node = 0; node < num_nodes; ++node) {
+    NodeReplica replica = {_skeleton, _animations, nullptr, nullptr,
+                           {owned_animations_.data() +
+                                _animations.size() * node,
+                            _animations.size()},
+                           false};
+    numa::RunOnNode(node, &ReplicateNode, &replica);
+    images_.push_back(replica.image);
+    owned_skeletons_.push_back(replica.skeleton);
+    skeletons_.push_back(replica.skeleton);
+    success &= replica.success;
+  }
+  animations_.assign(owned_animations_.begin(), owned_animations_.end());
+
+  if (!success) {
+    Release();
+  }
+  return success;
+}
+
+void ReplicatedAssets::Release() {
+  for (Skeleton* skeleton : owned_skeletons_) {
+    Delete(skeleton);
+  }
+  for (Animation* animation : owned_animations_) {
+    Delete(animation);
+  }
+  // Images are released once objects using them are.
+  for (void* image : images_) {
+    memory::default_allocator()->Deallocate(image);
+  }
+  owned_skeletons_.clear();
+  owned_animations_.clear();
+  images_.clear();
+  skeletons_.clear();
+  animations_.clear();
+  num_nodes_ = 0;
+  num_animations_ = 0;
+}
+
+const Skeleton* ReplicatedAssets::skeleton(int _node) const {
+  if (_node < 0 || _node >= num_nodes_) {
+    return nullptr;
+  }
+  return skeletons_[_node];
+}
+
+const Animation* ReplicatedAssets::animation(int _node, int _index) const {
+  if (_node < 0 || _node >= num_nodes_ || _index < 0 ||
+      _index >= num_animations_) {
+    return nullptr;
+  }
+  return animations_[_node * num_animations_ + _index];
+}
+
+int ReplicatedAssets::local_node() const {
+  const int node = numa::CurrentNode();
+  return node < num_nodes_ ? node : 0;
+}
+
+const Skeleton* ReplicatedAssets::local_skeleton() const {
+  return skeleton(local_node());
+}
+
+const Animation* ReplicatedAssets::local_animation(int _index) const {
+  return animation(local_node(), _index);
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,93 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/retarget_job.h"
+
+#include "ozz/animation/runtime/retarget_map.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace ozz {
+namespace animation {
+
+// SoaTransform is accessed as 10 consecutive SimdFloat4 (translation x, y, z,
+// rotation x, y, z, w and scale x, y, z) to gather lanes.
+static_assert(sizeof(math::SoaTransform) == 10 * sizeof(math::SimdFloat4),
+              "Unexpected SoaTransform layout");
+
+RetargetJob::RetargetJob() : map(nullptr) {}
+
+bool RetargetJob::Validate() const {
+  if (!map) {
+    return false;
+  }
+  bool valid = true;
+
+  const size_t num_source_soa_joints = (map->num_source_joints() + 3) / 4;
+  const size_t num_target_soa_joints = (map->num_target_joints() + 3) / 4;
+  valid &= input.size() >= num_source_soa_joints;
+  valid &= rest_pose.size() >= num_target_soa_joints;
+  valid &= output.size() >= num_target_soa_joints;
+
+  return valid;
+}
+
+bool RetargetJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_joints = map->num_target_joints();
+  const span<const int16_t> joint_remaps = map->joint_remaps();
+  const span<const int16_t> soa_remaps = map->soa_remaps();
+  for (size_t i = 0; i < soa_remaps.size(); ++i) {
+    // Whole SoA joint copy.
+    const int soa_remap = soa_remaps[i];
+    if (soa_remap != -1) {
+      output[i] = input[soa_remap];
+      continue;
+    }
+
+    // Gathers lanes one by one, starting from rest pose for unmapped joints.
+    output[i] = rest_pose[i];
+    float* out = reinterpret_cast<float*>(&output[i]);
+    for (int j = 0; j < 4 && static_cast<int>(i) * 4 + j < num_joints; ++j) {
+      const int remap = joint_remaps[i * 4 + j];
+      if (remap == Skeleton::kNoParent) {
+        continue;
+      }
+      const float* in = reinterpret_cast<const float*>(&input[remap / 4]);
+      const int lane = remap & 3;
+      for (int k = 0; k < 10; ++k) {
+        out[k * 4 + j] = in[k * 4 + lane];
+      }
+    }
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
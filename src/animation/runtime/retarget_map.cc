@@ -0,0 +1,106 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/retarget_map.h"
+
+#include <utility>
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/vector_archive.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+
+namespace ozz {
+namespace animation {
+
+RetargetMap::RetargetMap() : num_source_joints_(0) {}
+
+RetargetMap::RetargetMap(RetargetMap&& _other) : num_source_joints_(0) {
+  *this = std::move(_other);
+}
+
+RetargetMap& RetargetMap::operator=(RetargetMap&& _other) {
+  std::swap(num_source_joints_, _other.num_source_joints_);
+  std::swap(joint_remaps_, _other.joint_remaps_);
+  std::swap(soa_remaps_, _other.soa_remaps_);
+  return *this;
+}
+
+RetargetMap::~RetargetMap() {}
+
+void RetargetMap::BuildSoaRemaps() {
+  const int num_joints = num_target_joints();
+  const int num_soa_joints = (num_joints + 3) / 4;
+  soa_remaps_.resize(num_soa_joints);
+  for (int i = 0; i < num_soa_joints; ++i) {
+    // The first lane must be mapped to the first lane of a source SoA joint,
+    // and following lanes to following source lanes. Lanes beyond the last
+    // joint are ignored.
+    const int first = joint_remaps_[i * 4];
+    bool copy = first != Skeleton::kNoParent && (first & 3) == 0;
+    for (int j = 1; copy && j < 4 && i * 4 + j < num_joints; ++j) {
+      copy = joint_remaps_[i * 4 + j] == first + j;
+    }
+    soa_remaps_[i] = static_cast<int16_t>(copy ? first / 4 : -1);
+  }
+}
+
+void RetargetMap::Save(ozz::io::OArchive& _archive) const {
+  _archive << static_cast<int32_t>(num_source_joints_);
+  _archive << joint_remaps_;
+}
+
+void RetargetMap::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Resets map in case it was already used before.
+  num_source_joints_ = 0;
+  joint_remaps_.clear();
+  soa_remaps_.clear();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported RetargetMap version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  int32_t num_source_joints;
+  _archive >> num_source_joints;
+  _archive >> joint_remaps_;
+
+  // Rejects remaps that don't point to a source joint.
+  for (const int16_t remap : joint_remaps_) {
+    if (remap != Skeleton::kNoParent &&
+        (remap < 0 || remap >= num_source_joints)) {
+      log::Err() << "Invalid RetargetMap joint remaps." << std::endl;
+      joint_remaps_.clear();
+      return;
+    }
+  }
+  num_source_joints_ = num_source_joints;
+  BuildSoaRemaps();
+}
+}  // namespace animation
+}  // namespace ozz
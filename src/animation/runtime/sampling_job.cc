@@ -27,17 +27,41 @@
 
 #include "ozz/animation/runtime/sampling_job.h"
 
+#include <algorithm>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <new>
 
 #include "ozz/animation/runtime/animation.h"
 #include "ozz/base/maths/math_constant.h"
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_half_transform.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
+#include "ozz/base/profile.h"
 
 // Internal include file
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
 #include "animation/runtime/animation_keyframe.h"
+#include "animation/runtime/key_decompression.h"
+
+// Selects AVX interpolation path, which processes 2 SoA entries at once. It's
+// always used if AVX is enabled for the whole build. Otherwise, for x86 SSE
+// builds, it's compiled with a function target attribute (GCC and Clang) and
+// selected at runtime according to host capabilities.
+#if defined(OZZ_SIMD_AVX)
+#define OZZ_SAMPLING_AVX
+#define OZZ_SAMPLING_AVX_TARGET
+#elif defined(OZZ_SIMD_SSEx) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define OZZ_SAMPLING_AVX
+#define OZZ_SAMPLING_AVX_DISPATCH
+#define OZZ_SAMPLING_AVX_TARGET __attribute__((target("avx")))
+#endif
 
 namespace ozz {
 namespace animation {
@@ -51,6 +75,11 @@ struct InterpSoaQuaternion {
   math::SimdFloat4 ratio[2];
   math::SoaQuaternion value[2];
 };
+// Tangents of InterpSoaFloat3 left and right keys, scaled by keys ratio
+// interval. Only cubic animations have tangents.
+struct InterpSoaTangents {
+  math::SoaFloat3 value[2];
+};
 }  // namespace internal
 
 bool SamplingJob::Validate() const {
@@ -63,27 +92,144 @@ bool SamplingJob::Validate() const {
   if (!animation || !context) {
     return false;
   }
-  valid &= !output.empty();
+  valid &= output.empty() != half_output.empty();
 
   const int num_soa_tracks = animation->num_soa_tracks();
 
-  // Tests context size.
+  // Tests context size, and tangents storage for cubic animations.
   valid &= context->max_soa_tracks() >= num_soa_tracks;
+  valid &= !animation->cubic() || context->cubic();
+
+  // Tests mask size.
+  valid &= mask.empty() ||
+           mask.size() >= static_cast<size_t>((num_soa_tracks + 7) / 8);
+
+  // Tests prefetch distance.
+  valid &= prefetch_distance >= 0;
 
   return valid;
 }
 
+uint32_t JobGeneration(const SamplingJob& _job) {
+  return _job.animation ? _job.animation->generation() : 0;
+}
+
 namespace {
-// Loops through the sorted key frames and update context structure.
+// Flags all soa entries as outdated. It cares to only flag valid soa entries as
+// this is the exit condition of other algorithms.
+void FlagAllOutdated(int _num_soa_tracks, uint8_t* _outdated) {
+  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
+  for (int i = 0; i < num_outdated_flags - 1; ++i) {
+    _outdated[i] = 0xff;
+  }
+  _outdated[num_outdated_flags - 1] =
+      0xff >> (num_outdated_flags * 8 - _num_soa_tracks);
+}
+
+// Finds the index of the key that precedes _key (in the same track), using
+// previous keys offsets.
 template <typename _Key>
-void UpdateCacheCursor(float _ratio, int _num_soa_tracks,
-                       const ozz::span<const _Key>& _keys, int* _cursor,
+int PreviousKey(const ozz::span<const _Key>& _keys,
+                const ozz::span<const uint16_t>& _previouses, int _key) {
+  const int offset = _previouses[_key];
+  if (offset) {
+    return _key - offset;
+  }
+  // Offset was too big to be stored, so previous key is searched for.
+  const int track = _keys[_key].track;
+  int previous = _key - 1;
+  while (_keys[previous].track != track) {
+    --previous;
+  }
+  return previous;
+}
+
+// Finds the right key of track _track at _ratio, using animation per track keys
+// indices. Right key is the first key whose ratio is greater than _ratio (or
+// the last one), which matches the key a context would cache for _ratio.
+// Returns a pointer to the right key entry in track indices, its left key
+// being the previous entry.
+template <typename _Key>
+const int* FindRightKey(const ozz::span<const _Key>& _keys,
+                        const ozz::span<const int>& _index, int _num_tracks,
+                        int _track, float _ratio) {
+  const int* offsets = _index.begin();
+  const int* indices = offsets + _num_tracks + 1;
+  // Every track has at least 2 keys, the first one being at ratio 0.
+  const int* first = indices + offsets[_track] + 1;
+  const int* last = indices + offsets[_track + 1] - 1;
+  return std::upper_bound(first, last, _ratio, [&_keys](float _r, int _key) {
+    return _r < internal::KeyRatio(_keys[_key]);
+  });
+}
+
+// Finds the left and right keys of each track of SoA entry _i, stored to
+// _interp with the layout of context cache (2 per track).
+template <typename _Key>
+void FindInterpKeys(const ozz::span<const _Key>& _keys,
+                    const ozz::span<const int>& _index, int _num_tracks, int _i,
+                    float _ratio, int* _interp) {
+  for (int j = 0; j < 4; ++j) {
+    const int* right = FindRightKey(_keys, _index, _num_tracks, _i * 4 + j,
+                                    _ratio);
+    _interp[j * 2] = right[-1];
+    _interp[j * 2 + 1] = *right;
+  }
+}
+
+// Searches for the keys that matches _ratio using animation per track keys
+// indices, instead of iterating keys from the current cursor. The cursor is
+// then positioned on the first key whose previous key (in the same track) is
+// after _ratio, as it would be after iterating. Keys being sorted by previous
+// key ratio, this is the earliest key following the right key of every track.
+template <typename _Key>
+void SearchCacheCursor(float _ratio, int _num_soa_tracks,
+                       const ozz::span<const _Key>& _keys,
+                       const ozz::span<const int>& _index, int* _cursor,
                        int* _cache, unsigned char* _outdated) {
+  const int num_tracks = _num_soa_tracks * 4;
+  const int* indices = _index.begin() + num_tracks + 1;
+  int cursor = static_cast<int>(_keys.size());
+  for (int i = 0; i < num_tracks; ++i) {
+    const int* right = FindRightKey(_keys, _index, num_tracks, i, _ratio);
+    _cache[i * 2] = right[-1];
+    _cache[i * 2 + 1] = *right;
+    if (right + 1 < indices + _index[i + 1]) {
+      cursor = math::Min(cursor, right[1]);
+    }
+  }
+  assert(cursor >= num_tracks * 2);
+  *_cursor = cursor;
+
+  // All entries are outdated.
+  FlagAllOutdated(_num_soa_tracks, _outdated);
+}
+
+// Loops through the sorted key frames and update context structure. Keys can
+// be iterated backward if _previouses aren't empty, meaning _ratio can be lower
+// than the one used to update the context last time. Keys are searched for
+// instead if the cursor was flagged by the context (negative value), which
+// requires per track keys indices. While iterating forward, the keys compared
+// _prefetch keys later are prefetched. Returns the number of keys iterated.
+template <typename _Key>
+int UpdateCacheCursor(float _ratio, int _num_soa_tracks,
+                       const ozz::span<const _Key>& _keys,
+                       const ozz::span<const uint16_t>& _previouses,
+                       const ozz::span<const int>& _index, int _prefetch,
+                       int* _cursor, int* _cache, unsigned char* _outdated) {
   assert(_num_soa_tracks >= 1);
   const int num_tracks = _num_soa_tracks * 4;
   assert(_keys.begin() + num_tracks * 2 <= _keys.end());
 
+  if (*_cursor < 0) {
+    assert(!_index.empty());
+    SearchCacheCursor(_ratio, _num_soa_tracks, _keys, _index, _cursor, _cache,
+                      _outdated);
+    return 0;
+  }
+
   const _Key* cursor = nullptr;
+  int advanced = 0;
   if (!*_cursor) {
     // Initializes interpolated entries with the first 2 sets of key frames.
     // The sorting algorithm ensures that the first 2 key frames of a track
@@ -103,18 +249,43 @@ void UpdateCacheCursor(float _ratio, int _num_soa_tracks,
     }
     cursor = _keys.begin() + num_tracks * 2;  // New cursor position.
 
-    // All entries are outdated. It cares to only flag valid soa entries as
-    // this is the exit condition of other algorithms.
-    const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-    for (int i = 0; i < num_outdated_flags - 1; ++i) {
-      _outdated[i] = 0xff;
-    }
-    _outdated[num_outdated_flags - 1] =
-        0xff >> (num_outdated_flags * 8 - _num_soa_tracks);
+    // All entries are outdated.
+    FlagAllOutdated(_num_soa_tracks, _outdated);
   } else {
     cursor = _keys.begin() + *_cursor;  // Might be == end()
     assert(cursor >= _keys.begin() + num_tracks * 2 && cursor <= _keys.end());
+
+    // Search backward for the keys that matches _ratio.
+    // Iterates while the left key of the last processed key track is greater
+    // than _ratio. The last processed key is always the right key of its
+    // track, so it can be removed from the context, being replaced by the left
+    // key, while the left key is replaced by its previous key. Thanks to the
+    // keyframe sorting, the loop can end as soon as it finds a left key lower
+    // than _ratio.
+    if (!_previouses.empty()) {
+      const _Key* first = _keys.begin() + num_tracks * 2;
+      while (cursor > first &&
+             internal::KeyRatio(_keys[_cache[cursor[-1].track * 2]]) > _ratio) {
+        --cursor;
+        // Flag this soa entry as outdated.
+        _outdated[cursor->track / 32] |= (1 << ((cursor->track & 0x1f) / 4));
+        // Updates context.
+        const int base = cursor->track * 2;
+        assert(_cache[base + 1] == cursor - _keys.begin());
+        _cache[base + 1] = _cache[base];
+        _cache[base] = PreviousKey(_keys, _previouses, _cache[base]);
+      }
+      advanced = static_cast<int>(_keys.begin() + *_cursor - cursor);
+    }
   }
+  const _Key* forward = cursor;
+
+  // Keys beyond prefetch_end have no key to prefetch for, _prefetch keys
+  // later.
+  const _Key* prefetch_end =
+      _prefetch > 0 && _prefetch < static_cast<int>(_keys.size())
+          ? _keys.end() - _prefetch
+          : _keys.begin();
 
   // Search for the keys that matches _ratio.
   // Iterates while the context is not updated with left and right keys required
@@ -123,7 +294,13 @@ void UpdateCacheCursor(float _ratio, int _num_soa_tracks,
   // _ratio. It will mean that all the keys lower than _ratio have been
   // processed, meaning all context entries are up to date.
   while (cursor < _keys.end() &&
-         _keys[_cache[cursor->track * 2 + 1]].ratio <= _ratio) {
+         internal::KeyRatio(_keys[_cache[cursor->track * 2 + 1]]) <= _ratio) {
+    // Prefetches the key that will be compared when reaching the key
+    // _prefetch keys later, aka the current right key of its track. Keys are
+    // iterated sequentially, but these ones are scattered.
+    if (cursor < prefetch_end) {
+      OZZ_PREFETCH(&_keys[_cache[cursor[_prefetch].track * 2 + 1]]);
+    }
     // Flag this soa entry as outdated.
     _outdated[cursor->track / 32] |= (1 << ((cursor->track & 0x1f) / 4));
     // Updates context.
@@ -137,320 +314,1612 @@ void UpdateCacheCursor(float _ratio, int _num_soa_tracks,
 
   // Updates cursor output.
   *_cursor = static_cast<int>(cursor - _keys.begin());
+
+  return advanced + static_cast<int>(cursor - forward);
 }
 
+// Decompresses left and right keys of a SoA entry, whose indices are stored in
+// _interp (2 per track).
+template <typename _Key, typename _InterpKey, typename _Decompress>
+inline void DecompressInterpKeys(const ozz::span<const _Key>& _keys,
+                                 const int* _interp, _InterpKey* _interp_key,
+                                 const _Decompress& _decompress) {
+  // Decompress left side keyframes and store them in soa structures.
+  const _Key& k00 = _keys[_interp[0]];
+  const _Key& k10 = _keys[_interp[2]];
+  const _Key& k20 = _keys[_interp[4]];
+  const _Key& k30 = _keys[_interp[6]];
+  _interp_key->ratio[0] = math::simd_float4::Load(
+      internal::KeyRatio(k00), internal::KeyRatio(k10),
+      internal::KeyRatio(k20), internal::KeyRatio(k30));
+  _decompress(k00, k10, k20, k30, &_interp_key->value[0]);
+
+  // Decompress right side keyframes and store them in soa structures.
+  const _Key& k01 = _keys[_interp[1]];
+  const _Key& k11 = _keys[_interp[3]];
+  const _Key& k21 = _keys[_interp[5]];
+  const _Key& k31 = _keys[_interp[7]];
+  _interp_key->ratio[1] = math::simd_float4::Load(
+      internal::KeyRatio(k01), internal::KeyRatio(k11),
+      internal::KeyRatio(k21), internal::KeyRatio(k31));
+  _decompress(k01, k11, k21, k31, &_interp_key->value[1]);
+}
+
+// Decompresses tangents of left and right keys of a SoA entry, whose indices
+// are stored in _interp (2 per track). Tangents are scaled by keys _ratio
+// interval, as expected by cubic interpolation.
+inline void DecompressInterpTangents(
+    const ozz::span<const uint16_t>& _tangents, const int* _interp,
+    const math::SimdFloat4 (&_ratio)[2],
+    internal::InterpSoaTangents* _interp_tangents) {
+  const math::SimdFloat4 interval = _ratio[1] - _ratio[0];
+  for (int i = 0; i < 2; ++i) {
+    const uint16_t* t0 = &_tangents[_interp[i] * 3];
+    const uint16_t* t1 = &_tangents[_interp[i + 2] * 3];
+    const uint16_t* t2 = &_tangents[_interp[i + 4] * 3];
+    const uint16_t* t3 = &_tangents[_interp[i + 6] * 3];
+    const math::SoaFloat3 tangent = {
+        math::HalfToFloat(math::simd_int4::Load(t0[0], t1[0], t2[0], t3[0])),
+        math::HalfToFloat(math::simd_int4::Load(t0[1], t1[1], t2[1], t3[1])),
+        math::HalfToFloat(math::simd_int4::Load(t0[2], t1[2], t2[2], t3[2]))};
+    _interp_tangents->value[i] = tangent * interval;
+  }
+}
+
+// Prefetches left and right keys of a SoA entry, and their tangents if any,
+// whose indices are stored in _interp (2 per track).
+template <typename _Key>
+inline void PrefetchInterpKeys(const ozz::span<const _Key>& _keys,
+                               const ozz::span<const uint16_t>& _tangents,
+                               const int* _interp) {
+  for (int i = 0; i < 8; ++i) {
+    OZZ_PREFETCH(&_keys[_interp[i]]);
+  }
+  if (!_tangents.empty()) {
+    for (int i = 0; i < 8; ++i) {
+      OZZ_PREFETCH(&_tangents[_interp[i] * 3]);
+    }
+  }
+}
+
+// Iterates outdated SoA entries that are enabled by _mask (all of them if
+// _mask is empty), in ascending order.
+class OutdatedEntries {
+ public:
+  OutdatedEntries(const uint8_t* _outdated,
+                  const ozz::span<const uint8_t>& _mask, int _num_flags)
+      : outdated_(_outdated),
+        mask_(_mask),
+        num_flags_(_num_flags),
+        flag_(0),
+        entry_(0),
+        bits_(0) {}
+
+  // Returns the next entry, or -1 once all entries were iterated.
+  int Next() {
+    while (!bits_) {
+      if (flag_ == num_flags_) {
+        return -1;
+      }
+      bits_ = outdated_[flag_];
+      if (!mask_.empty()) {
+        bits_ &= mask_[flag_];
+      }
+      entry_ = flag_++ * 8;
+    }
+    for (; !(bits_ & 1); bits_ >>= 1) {
+      ++entry_;
+    }
+    bits_ >>= 1;
+    return entry_++;
+  }
+
+ private:
+  const uint8_t* outdated_;
+  ozz::span<const uint8_t> mask_;
+  int num_flags_;
+  int flag_;
+  int entry_;
+  unsigned int bits_;
+};
+
+// Decompresses outdated keyframes, and their tangents to _interp_tangents
+// unless it's nullptr (animation isn't cubic). Masked out entries (if _mask
+// isn't empty) remain outdated, so they are processed once enabled again. Keys
+// of the _prefetch-th next outdated entry are prefetched while decompressing
+// the current one. Returns the number of entries decompressed.
 template <typename _Key, typename _InterpKey, typename _Decompress>
-void UpdateInterpKeyframes(int _num_soa_tracks,
+int UpdateInterpKeyframes(int _num_soa_tracks,
                            const ozz::span<const _Key>& _keys,
+                           const ozz::span<const uint16_t>& _tangents,
                            const int* _interp, uint8_t* _outdated,
                            _InterpKey* _interp_keys,
-                           const _Decompress& _decompress) {
+                           internal::InterpSoaTangents* _interp_tangents,
+                           const ozz::span<const uint8_t>& _mask,
+                           int _prefetch, const _Decompress& _decompress) {
+  assert(!_interp_tangents || !_tangents.empty());
+  int refreshed = 0;
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-  for (int j = 0; j < num_outdated_flags; ++j) {
-    uint8_t outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
-    for (int i = j * 8; outdated; ++i, outdated >>= 1) {
-      if (!(outdated & 1)) {
-        continue;
+  OutdatedEntries entries(_outdated, _mask, num_outdated_flags);
+
+  // Prefetches the first entries, then keeps _prefetch entries ahead.
+  OutdatedEntries ahead = entries;
+  for (int i = 0; i < _prefetch; ++i) {
+    const int entry = ahead.Next();
+    if (entry < 0) {
+      break;
+    }
+    PrefetchInterpKeys(_keys, _tangents, _interp + entry * 4 * 2);
+  }
+
+  for (int i = entries.Next(); i >= 0; i = entries.Next()) {
+    if (_prefetch > 0) {
+      const int entry = ahead.Next();
+      if (entry >= 0) {
+        PrefetchInterpKeys(_keys, _tangents, _interp + entry * 4 * 2);
       }
-      const int base = i * 4 * 2;  // * soa size * 2 keys
-
-      // Decompress left side keyframes and store them in soa structures.
-      const _Key& k00 = _keys[_interp[base + 0]];
-      const _Key& k10 = _keys[_interp[base + 2]];
-      const _Key& k20 = _keys[_interp[base + 4]];
-      const _Key& k30 = _keys[_interp[base + 6]];
-      _interp_keys[i].ratio[0] =
-          math::simd_float4::Load(k00.ratio, k10.ratio, k20.ratio, k30.ratio);
-      _decompress(k00, k10, k20, k30, &_interp_keys[i].value[0]);
-
-      // Decompress right side keyframes and store them in soa structures.
-      const _Key& k01 = _keys[_interp[base + 1]];
-      const _Key& k11 = _keys[_interp[base + 3]];
-      const _Key& k21 = _keys[_interp[base + 5]];
-      const _Key& k31 = _keys[_interp[base + 7]];
-      _interp_keys[i].ratio[1] =
-          math::simd_float4::Load(k01.ratio, k11.ratio, k21.ratio, k31.ratio);
-      _decompress(k01, k11, k21, k31, &_interp_keys[i].value[1]);
+    }
+    const int base = i * 4 * 2;  // * soa size * 2 keys
+    DecompressInterpKeys(_keys, _interp + base, &_interp_keys[i],
+                         _decompress);
+    if (_interp_tangents) {
+      DecompressInterpTangents(_tangents, _interp + base,
+                               _interp_keys[i].ratio, &_interp_tangents[i]);
+    }
+    ++refreshed;
+  }
+
+  // Resets processed entries.
+  for (int j = 0; j < num_outdated_flags; ++j) {
+    _outdated[j] &= _mask.empty() ? 0 : ~_mask[j];
+  }
+  return refreshed;
+}
+
+// Updates translation or scale cache and interpolation keys, whatever is the
+// keys format. Tangents are updated to _interp_tangents, unless it's nullptr.
+// Work statistics are added to _stats, unless it's nullptr.
+template <typename _Key>
+void UpdateFloat3s(float _ratio, int _num_soa_tracks,
+                   const ozz::span<const _Key>& _keys,
+                   const ozz::span<const uint16_t>& _previouses,
+                   const ozz::span<const int>& _index,
+                   const ozz::span<const uint16_t>& _tangents, int* _cursor,
+                   int* _cache, uint8_t* _outdated,
+                   internal::InterpSoaFloat3* _interp_keys,
+                   internal::InterpSoaTangents* _interp_tangents,
+                   const ozz::span<const uint8_t>& _mask, int _prefetch,
+                   SamplingJob::Stats* _stats) {
+  int advanced, refreshed;
+  {
+    OZZ_PROFILE_ZONE("SamplingJob::UpdateCacheCursor");
+    advanced =
+        UpdateCacheCursor(_ratio, _num_soa_tracks, _keys, _previouses, _index,
+                          _prefetch, _cursor, _cache, _outdated);
+  }
+  {
+    OZZ_PROFILE_ZONE("SamplingJob::UpdateInterpKeyframes");
+    refreshed =
+        UpdateInterpKeyframes(_num_soa_tracks, _keys, _tangents, _cache,
+                              _outdated, _interp_keys, _interp_tangents, _mask,
+                              _prefetch, &internal::DecompressFloat3<_Key>);
+  }
+  if (_stats) {
+    _stats->keys_advanced += advanced;
+    _stats->refreshed_entries += refreshed;
+  }
+}
+
+// Updates rotation cache and interpolation keys, whatever is rotation keys
+// format. Work statistics are added to _stats, unless it's nullptr.
+template <typename _Key>
+void UpdateRotations(float _ratio, int _num_soa_tracks,
+                     const ozz::span<const _Key>& _keys,
+                     const ozz::span<const uint16_t>& _previouses,
+                     const ozz::span<const int>& _index, int* _cursor,
+                     int* _cache, uint8_t* _outdated,
+                     internal::InterpSoaQuaternion* _interp_keys,
+                     const ozz::span<const uint8_t>& _mask, int _prefetch,
+                     SamplingJob::Stats* _stats) {
+  int advanced, refreshed;
+  {
+    OZZ_PROFILE_ZONE("SamplingJob::UpdateCacheCursor");
+    advanced =
+        UpdateCacheCursor(_ratio, _num_soa_tracks, _keys, _previouses, _index,
+                          _prefetch, _cursor, _cache, _outdated);
+  }
+  {
+    OZZ_PROFILE_ZONE("SamplingJob::UpdateInterpKeyframes");
+    refreshed = UpdateInterpKeyframes(
+        _num_soa_tracks, _keys, ozz::span<const uint16_t>(), _cache,
+        _outdated, _interp_keys, nullptr, _mask, _prefetch,
+        &internal::DecompressQuaternion<_Key>);
+  }
+  if (_stats) {
+    _stats->keys_advanced += advanced;
+    _stats->refreshed_entries += refreshed;
+  }
+}
+
+// Tells if SoA entry _i is flagged in _flags. Empty _flags flag nothing.
+inline bool IsFlagged(const ozz::span<const uint8_t>& _flags, int _i) {
+  return !_flags.empty() && (_flags[_i / 8] & (1 << (_i & 7)));
+}
+
+// Gets tangents of SoA entry _i, or nullptr if there's no _tangents (animation
+// isn't cubic).
+inline const internal::InterpSoaTangents* EntryTangents(
+    const internal::InterpSoaTangents* _tangents, int _i) {
+  return _tangents ? _tangents + _i : nullptr;
+}
+
+// Interpolates SoA entry _keys at _anim_ratio, linearly, or with a cubic
+// Hermite curve if _tangents isn't nullptr. Constant entries don't need
+// interpolation, as left and right keys have the same value (and null
+// tangents).
+inline void InterpolateFloat3(math::_SimdFloat4 _anim_ratio,
+                              const internal::InterpSoaFloat3& _keys,
+                              const internal::InterpSoaTangents* _tangents,
+                              bool _constant, math::SoaFloat3* _output) {
+  if (_constant) {
+    *_output = _keys.value[0];
+  } else {
+    const math::SimdFloat4 interp_ratio =
+        (_anim_ratio - _keys.ratio[0]) *
+        math::RcpEst(_keys.ratio[1] - _keys.ratio[0]);
+    if (_tangents) {
+      // Hermite polynomial, in Horner form.
+      const math::SoaFloat3 d = _keys.value[1] - _keys.value[0];
+      const math::SoaFloat3& m0 = _tangents->value[0];
+      const math::SoaFloat3& m1 = _tangents->value[1];
+      const math::SimdFloat4 two = math::simd_float4::Load1(2.f);
+      const math::SimdFloat4 three = math::simd_float4::Load1(3.f);
+      const math::SoaFloat3 c2 = d * three - m0 * two - m1;
+      const math::SoaFloat3 c3 = m0 + m1 - d * two;
+      *_output = _keys.value[0] +
+                 (m0 + (c2 + c3 * interp_ratio) * interp_ratio) * interp_ratio;
+    } else {
+      *_output = Lerp(_keys.value[0], _keys.value[1], interp_ratio);
+    }
+  }
+}
+
+// The lerp of the rotation uses the shortest path, because opposed
+// quaternions were negated during animation build stage (AnimationBuilder).
+inline void InterpolateQuaternion(math::_SimdFloat4 _anim_ratio,
+                                  const internal::InterpSoaQuaternion& _keys,
+                                  bool _constant,
+                                  math::SoaQuaternion* _output) {
+  if (_constant) {
+    *_output = _keys.value[0];
+  } else {
+    const math::SimdFloat4 interp_ratio =
+        (_anim_ratio - _keys.ratio[0]) *
+        math::RcpEst(_keys.ratio[1] - _keys.ratio[0]);
+    *_output = NLerpEst(_keys.value[0], _keys.value[1], interp_ratio);
+  }
+}
+
+// Soa hot data of a context, to interpolate. Tangents are nullptr if
+// animation isn't cubic.
+struct InterpEntries {
+  const internal::InterpSoaFloat3* translations;
+  const internal::InterpSoaQuaternion* rotations;
+  const internal::InterpSoaFloat3* scales;
+  const internal::InterpSoaTangents* translation_tangents;
+  const internal::InterpSoaTangents* scale_tangents;
+};
+
+// Interpolates all transforms of SoA entry _i to _output, unless it's masked
+// out.
+inline void InterpolatesEntry(math::_SimdFloat4 _anim_ratio, int _i,
+                              const InterpEntries& _entries,
+                              const Animation& _animation,
+                              const ozz::span<const uint8_t>& _mask,
+                              math::SoaTransform* _output) {
+  if (!_mask.empty() && !IsFlagged(_mask, _i)) {
+    return;  // Masked out entries are left unchanged.
+  }
+  InterpolateFloat3(_anim_ratio, _entries.translations[_i],
+                    EntryTangents(_entries.translation_tangents, _i),
+                    IsFlagged(_animation.constant_translations(), _i),
+                    &_output->translation);
+  InterpolateQuaternion(_anim_ratio, _entries.rotations[_i],
+                        IsFlagged(_animation.constant_rotations(), _i),
+                        &_output->rotation);
+  InterpolateFloat3(_anim_ratio, _entries.scales[_i],
+                    EntryTangents(_entries.scale_tangents, _i),
+                    IsFlagged(_animation.constant_scales(), _i),
+                    &_output->scale);
+}
+
+// Computes the derivative of SoA entry _keys interpolation (see
+// InterpolateFloat3) at _anim_ratio, multiplied by _rate (ratio per second).
+inline void DifferentiateFloat3(math::_SimdFloat4 _anim_ratio,
+                                math::_SimdFloat4 _rate,
+                                const internal::InterpSoaFloat3& _keys,
+                                const internal::InterpSoaTangents* _tangents,
+                                bool _constant, math::SoaFloat3* _output) {
+  if (_constant) {
+    *_output = math::SoaFloat3::zero();
+    return;
+  }
+  const math::SimdFloat4 rcp_interval =
+      math::RcpEstNR(_keys.ratio[1] - _keys.ratio[0]);
+  const math::SimdFloat4 scale = rcp_interval * _rate;
+  const math::SoaFloat3 d = _keys.value[1] - _keys.value[0];
+  if (_tangents) {
+    // Derivative of the Hermite polynomial.
+    const math::SimdFloat4 interp_ratio =
+        (_anim_ratio - _keys.ratio[0]) * rcp_interval;
+    const math::SoaFloat3& m0 = _tangents->value[0];
+    const math::SoaFloat3& m1 = _tangents->value[1];
+    const math::SimdFloat4 two = math::simd_float4::Load1(2.f);
+    const math::SimdFloat4 three = math::simd_float4::Load1(3.f);
+    const math::SoaFloat3 c2 = d * three - m0 * two - m1;
+    const math::SoaFloat3 c3 = m0 + m1 - d * two;
+    *_output =
+        (m0 + (c2 * two + c3 * (three * interp_ratio)) * interp_ratio) * scale;
+  } else {
+    *_output = d * scale;
+  }
+}
+
+// Computes the angular velocity of SoA entry _keys normalized lerp (see
+// InterpolateQuaternion) at _anim_ratio, multiplied by _rate (ratio per
+// second). With p the lerp of the keys and q = p / |p|, dq/dt is the
+// component of dp/dt orthogonal to q, divided by |p|. Angular velocity is
+// then the vector part of 2 * dq/dt * conjugate(q).
+inline void DifferentiateQuaternion(math::_SimdFloat4 _anim_ratio,
+                                    math::_SimdFloat4 _rate,
+                                    const internal::InterpSoaQuaternion& _keys,
+                                    bool _constant, math::SoaFloat3* _output) {
+  if (_constant) {
+    *_output = math::SoaFloat3::zero();
+    return;
+  }
+  const math::SimdFloat4 rcp_interval =
+      math::RcpEstNR(_keys.ratio[1] - _keys.ratio[0]);
+  const math::SimdFloat4 interp_ratio =
+      (_anim_ratio - _keys.ratio[0]) * rcp_interval;
+  const math::SoaQuaternion& q0 = _keys.value[0];
+  const math::SoaQuaternion& q1 = _keys.value[1];
+  const math::SoaQuaternion d = {q1.x - q0.x, q1.y - q0.y, q1.z - q0.z,
+                                 q1.w - q0.w};
+  const math::SoaQuaternion p = q0 + d * interp_ratio;
+  const math::SimdFloat4 rcp_len = math::RSqrtEstNR(Dot(p, p));
+  const math::SoaQuaternion q = p * rcp_len;
+  const math::SoaQuaternion dq =
+      (d + q * -Dot(q, d)) *
+      (rcp_len * rcp_interval * _rate * math::simd_float4::Load1(2.f));
+  const math::SoaQuaternion w = dq * Conjugate(q);
+  *_output = math::SoaFloat3::Load(w.x, w.y, w.z);
+}
+
+// Computes velocities of SoA entries [_begin,_end[, _linear and _angular
+// receiving entry _begin, unless they're nullptr.
+void Differentiates(float _anim_ratio, float _rate, int _begin, int _end,
+                    const InterpEntries& _entries, const Animation& _animation,
+                    const ozz::span<const uint8_t>& _mask,
+                    math::SoaFloat3* _linear, math::SoaFloat3* _angular) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_ratio);
+  const math::SimdFloat4 rate = math::simd_float4::Load1(_rate);
+  for (int i = _begin; i < _end; ++i) {
+    if (!_mask.empty() && !IsFlagged(_mask, i)) {
+      continue;  // Masked out entries are left unchanged.
+    }
+    if (_linear) {
+      DifferentiateFloat3(anim_ratio, rate, _entries.translations[i],
+                          EntryTangents(_entries.translation_tangents, i),
+                          IsFlagged(_animation.constant_translations(), i),
+                          _linear + (i - _begin));
+    }
+    if (_angular) {
+      DifferentiateQuaternion(anim_ratio, rate, _entries.rotations[i],
+                              IsFlagged(_animation.constant_rotations(), i),
+                              _angular + (i - _begin));
+    }
+  }
+}
+
+#if defined(OZZ_SAMPLING_AVX)
+// AVX path interpolates 2 SoA entries at once, 8 wide.
+
+// Packs SSE vectors _lo and _hi to a single AVX one.
+OZZ_SAMPLING_AVX_TARGET inline __m256 Pack8(__m128 _lo, __m128 _hi) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_lo), _hi, 1);
+}
+
+// Unpacks AVX vector _v to 2 SSE vectors.
+OZZ_SAMPLING_AVX_TARGET inline void Unpack8(__m256 _v, __m128* _lo,
+                                            __m128* _hi) {
+  *_lo = _mm256_castps256_ps128(_v);
+  *_hi = _mm256_extractf128_ps(_v, 1);
+}
+
+// Computes interpolation coefficients of the 2 entries of _keys. Operations
+// match SSE path ones, so that both paths give the same result.
+template <typename _InterpKey>
+OZZ_SAMPLING_AVX_TARGET inline __m256 InterpRatio8(__m256 _anim_ratio,
+                                                   const _InterpKey* _keys) {
+  const __m256 ratio0 = Pack8(_keys[0].ratio[0], _keys[1].ratio[0]);
+  const __m256 ratio1 = Pack8(_keys[0].ratio[1], _keys[1].ratio[1]);
+  return _mm256_mul_ps(_mm256_sub_ps(_anim_ratio, ratio0),
+                       _mm256_rcp_ps(_mm256_sub_ps(ratio1, ratio0)));
+}
+
+OZZ_SAMPLING_AVX_TARGET inline __m256 Lerp8(__m256 _a, __m256 _b,
+                                            __m256 _f) {
+  return _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(_b, _a), _f), _a);
+}
+
+OZZ_SAMPLING_AVX_TARGET void LerpFloat3x2(
+    __m256 _anim_ratio, const internal::InterpSoaFloat3* _keys,
+    math::SoaFloat3* _output0, math::SoaFloat3* _output1) {
+  const __m256 f = InterpRatio8(_anim_ratio, _keys);
+  const math::SoaFloat3* a = _keys[0].value;
+  const math::SoaFloat3* b = _keys[1].value;
+  Unpack8(Lerp8(Pack8(a[0].x, b[0].x), Pack8(a[1].x, b[1].x), f),
+          &_output0->x, &_output1->x);
+  Unpack8(Lerp8(Pack8(a[0].y, b[0].y), Pack8(a[1].y, b[1].y), f),
+          &_output0->y, &_output1->y);
+  Unpack8(Lerp8(Pack8(a[0].z, b[0].z), Pack8(a[1].z, b[1].z), f),
+          &_output0->z, &_output1->z);
+}
+
+OZZ_SAMPLING_AVX_TARGET void NLerpEstx2(
+    __m256 _anim_ratio, const internal::InterpSoaQuaternion* _keys,
+    math::SoaQuaternion* _output0, math::SoaQuaternion* _output1) {
+  const __m256 f = InterpRatio8(_anim_ratio, _keys);
+  const math::SoaQuaternion* a = _keys[0].value;
+  const math::SoaQuaternion* b = _keys[1].value;
+  const __m256 x = Lerp8(Pack8(a[0].x, b[0].x), Pack8(a[1].x, b[1].x), f);
+  const __m256 y = Lerp8(Pack8(a[0].y, b[0].y), Pack8(a[1].y, b[1].y), f);
+  const __m256 z = Lerp8(Pack8(a[0].z, b[0].z), Pack8(a[1].z, b[1].z), f);
+  const __m256 w = Lerp8(Pack8(a[0].w, b[0].w), Pack8(a[1].w, b[1].w), f);
+  const __m256 len2 = _mm256_add_ps(
+      _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)),
+                    _mm256_mul_ps(z, z)),
+      _mm256_mul_ps(w, w));
+  // Estimated reciprocal square root, with one Newton-Raphson step (as
+  // RSqrtEstNR).
+  const __m256 nr = _mm256_rsqrt_ps(len2);
+  const __m256 inv_len = _mm256_mul_ps(
+      _mm256_mul_ps(_mm256_set1_ps(.5f), nr),
+      _mm256_sub_ps(_mm256_set1_ps(3.f),
+                    _mm256_mul_ps(_mm256_mul_ps(len2, nr), nr)));
+  Unpack8(_mm256_mul_ps(x, inv_len), &_output0->x, &_output1->x);
+  Unpack8(_mm256_mul_ps(y, inv_len), &_output0->y, &_output1->y);
+  Unpack8(_mm256_mul_ps(z, inv_len), &_output0->z, &_output1->z);
+  Unpack8(_mm256_mul_ps(w, inv_len), &_output0->w, &_output1->w);
+}
+
+// Interpolates SoA entries [_begin,_end[ by pairs, _output receiving entry
+// _begin. Returns the index of the first entry that wasn't processed.
+OZZ_SAMPLING_AVX_TARGET int InterpolatesAvx(
+    float _anim_ratio, int _begin, int _end, const InterpEntries& _entries,
+    const Animation& _animation, const ozz::span<const uint8_t>& _mask,
+    math::SoaTransform* _output) {
+  const __m256 anim_ratio8 = _mm256_set1_ps(_anim_ratio);
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_ratio);
+  const ozz::span<const uint8_t>& constant_translations =
+      _animation.constant_translations();
+  const ozz::span<const uint8_t>& constant_rotations =
+      _animation.constant_rotations();
+  const ozz::span<const uint8_t>& constant_scales =
+      _animation.constant_scales();
+  const internal::InterpSoaFloat3* translations = _entries.translations;
+  const internal::InterpSoaQuaternion* rotations = _entries.rotations;
+  const internal::InterpSoaFloat3* scales = _entries.scales;
+  const internal::InterpSoaTangents* translation_tangents =
+      _entries.translation_tangents;
+  const internal::InterpSoaTangents* scale_tangents = _entries.scale_tangents;
+
+  int i = _begin;
+  for (; i + 1 < _end; i += 2) {
+    math::SoaTransform* output = _output + (i - _begin);
+
+    // Masked out pairs are processed per entry.
+    if (!_mask.empty() && (!IsFlagged(_mask, i) || !IsFlagged(_mask, i + 1))) {
+      InterpolatesEntry(anim_ratio, i, _entries, _animation, _mask, output);
+      InterpolatesEntry(anim_ratio, i + 1, _entries, _animation, _mask,
+                        output + 1);
+      continue;
+    }
+
+    // Pairs with a constant entry are also processed per entry, as well as
+    // cubic translations and scales.
+    const bool constant_t0 = IsFlagged(constant_translations, i);
+    const bool constant_t1 = IsFlagged(constant_translations, i + 1);
+    if (constant_t0 || constant_t1 || translation_tangents) {
+      InterpolateFloat3(anim_ratio, translations[i],
+                        EntryTangents(translation_tangents, i), constant_t0,
+                        &output[0].translation);
+      InterpolateFloat3(anim_ratio, translations[i + 1],
+                        EntryTangents(translation_tangents, i + 1),
+                        constant_t1, &output[1].translation);
+    } else {
+      LerpFloat3x2(anim_ratio8, translations + i, &output[0].translation,
+                   &output[1].translation);
+    }
+
+    const bool constant_r0 = IsFlagged(constant_rotations, i);
+    const bool constant_r1 = IsFlagged(constant_rotations, i + 1);
+    if (constant_r0 || constant_r1) {
+      InterpolateQuaternion(anim_ratio, rotations[i], constant_r0,
+                            &output[0].rotation);
+      InterpolateQuaternion(anim_ratio, rotations[i + 1], constant_r1,
+                            &output[1].rotation);
+    } else {
+      NLerpEstx2(anim_ratio8, rotations + i, &output[0].rotation,
+                 &output[1].rotation);
+    }
+
+    const bool constant_s0 = IsFlagged(constant_scales, i);
+    const bool constant_s1 = IsFlagged(constant_scales, i + 1);
+    if (constant_s0 || constant_s1 || scale_tangents) {
+      InterpolateFloat3(anim_ratio, scales[i], EntryTangents(scale_tangents, i),
+                        constant_s0, &output[0].scale);
+      InterpolateFloat3(anim_ratio, scales[i + 1],
+                        EntryTangents(scale_tangents, i + 1), constant_s1,
+                        &output[1].scale);
+    } else {
+      LerpFloat3x2(anim_ratio8, scales + i, &output[0].scale,
+                   &output[1].scale);
     }
   }
+  return i;
+}
+
+// Tells if AVX path can be used on this host.
+bool HasAvx() {
+#if defined(OZZ_SAMPLING_AVX_DISPATCH)
+  return math::SimdHostSupports(math::kSimdHostAvx);
+#else   // OZZ_SAMPLING_AVX_DISPATCH
+  return true;
+#endif  // OZZ_SAMPLING_AVX_DISPATCH
 }
+#endif  // OZZ_SAMPLING_AVX
 
-inline void DecompressFloat3(const Float3Key& _k0, const Float3Key& _k1,
-                             const Float3Key& _k2, const Float3Key& _k3,
-                             math::SoaFloat3* _soa_float3) {
-  _soa_float3->x = math::HalfToFloat(math::simd_int4::Load(
-      _k0.value[0], _k1.value[0], _k2.value[0], _k3.value[0]));
-  _soa_float3->y = math::HalfToFloat(math::simd_int4::Load(
-      _k0.value[1], _k1.value[1], _k2.value[1], _k3.value[1]));
-  _soa_float3->z = math::HalfToFloat(math::simd_int4::Load(
-      _k0.value[2], _k1.value[2], _k2.value[2], _k3.value[2]));
-}
-
-// Defines a mapping table that defines components assignation in the output
-// quaternion.
-constexpr int kCpntMapping[4][4] = {
-    {0, 0, 1, 2}, {0, 0, 1, 2}, {0, 1, 0, 2}, {0, 1, 2, 0}};
-
-void DecompressQuaternion(const QuaternionKey& _k0, const QuaternionKey& _k1,
-                          const QuaternionKey& _k2, const QuaternionKey& _k3,
-                          math::SoaQuaternion* _quaternion) {
-  // Selects proper mapping for each key.
-  const int* m0 = kCpntMapping[_k0.largest];
-  const int* m1 = kCpntMapping[_k1.largest];
-  const int* m2 = kCpntMapping[_k2.largest];
-  const int* m3 = kCpntMapping[_k3.largest];
-
-  // Prepares an array of input values, according to the mapping required to
-  // restore quaternion largest component.
-  alignas(16) int cmp_keys[4][4] = {
-      {_k0.value[m0[0]], _k1.value[m1[0]], _k2.value[m2[0]], _k3.value[m3[0]]},
-      {_k0.value[m0[1]], _k1.value[m1[1]], _k2.value[m2[1]], _k3.value[m3[1]]},
-      {_k0.value[m0[2]], _k1.value[m1[2]], _k2.value[m2[2]], _k3.value[m3[2]]},
-      {_k0.value[m0[3]], _k1.value[m1[3]], _k2.value[m2[3]], _k3.value[m3[3]]},
-  };
-
-  // Resets largest component to 0. Overwritting here avoids 16 branchings
-  // above.
-  cmp_keys[_k0.largest][0] = 0;
-  cmp_keys[_k1.largest][1] = 0;
-  cmp_keys[_k2.largest][2] = 0;
-  cmp_keys[_k3.largest][3] = 0;
-
-  // Rebuilds quaternion from quantized values.
-  const math::SimdFloat4 kInt2Float =
-      math::simd_float4::Load1(1.f / (32767.f * math::kSqrt2));
-  math::SimdFloat4 cpnt[4] = {
-      kInt2Float *
-          math::simd_float4::FromInt(math::simd_int4::LoadPtr(cmp_keys[0])),
-      kInt2Float *
-          math::simd_float4::FromInt(math::simd_int4::LoadPtr(cmp_keys[1])),
-      kInt2Float *
-          math::simd_float4::FromInt(math::simd_int4::LoadPtr(cmp_keys[2])),
-      kInt2Float *
-          math::simd_float4::FromInt(math::simd_int4::LoadPtr(cmp_keys[3])),
-  };
-
-  // Get back length of 4th component. Favors performance over accuracy by using
-  // x * RSqrtEst(x) instead of Sqrt(x).
-  // ww0 cannot be 0 because we 're recomputing the largest component.
-  const math::SimdFloat4 dot = cpnt[0] * cpnt[0] + cpnt[1] * cpnt[1] +
-                               cpnt[2] * cpnt[2] + cpnt[3] * cpnt[3];
-  const math::SimdFloat4 ww0 = math::Max(math::simd_float4::Load1(1e-16f),
-                                         math::simd_float4::one() - dot);
-  const math::SimdFloat4 w0 = ww0 * math::RSqrtEst(ww0);
-  // Re-applies 4th component' s sign.
-  const math::SimdInt4 sign = math::ShiftL(
-      math::simd_int4::Load(_k0.sign, _k1.sign, _k2.sign, _k3.sign), 31);
-  const math::SimdFloat4 restored = math::Or(w0, sign);
-
-  // Re-injects the largest component inside the SoA structure.
-  cpnt[_k0.largest] = math::Or(
-      cpnt[_k0.largest], math::And(restored, math::simd_int4::mask_f000()));
-  cpnt[_k1.largest] = math::Or(
-      cpnt[_k1.largest], math::And(restored, math::simd_int4::mask_0f00()));
-  cpnt[_k2.largest] = math::Or(
-      cpnt[_k2.largest], math::And(restored, math::simd_int4::mask_00f0()));
-  cpnt[_k3.largest] = math::Or(
-      cpnt[_k3.largest], math::And(restored, math::simd_int4::mask_000f()));
-
-  // Stores result.
-  _quaternion->x = cpnt[0];
-  _quaternion->y = cpnt[1];
-  _quaternion->z = cpnt[2];
-  _quaternion->w = cpnt[3];
-}
-
-void Interpolates(float _anim_ratio, int _num_soa_tracks,
-                  const internal::InterpSoaFloat3* _translations,
-                  const internal::InterpSoaQuaternion* _rotations,
-                  const internal::InterpSoaFloat3* _scales,
+// Interpolates SoA entries [_begin,_end[, _output receiving entry _begin.
+void Interpolates(float _anim_ratio, int _begin, int _end,
+                  const InterpEntries& _entries, const Animation& _animation,
+                  const ozz::span<const uint8_t>& _mask,
                   math::SoaTransform* _output) {
+  int i = _begin;
+#if defined(OZZ_SAMPLING_AVX)
+  if (HasAvx()) {
+    i = InterpolatesAvx(_anim_ratio, _begin, _end, _entries, _animation, _mask,
+                        _output);
+  }
+#endif  // OZZ_SAMPLING_AVX
+
+  // Processes remaining entries, or all of them if AVX isn't available.
   const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_anim_ratio);
+  for (; i < _end; ++i) {
+    InterpolatesEntry(anim_ratio, i, _entries, _animation, _mask,
+                      _output + (i - _begin));
+  }
+}
+
+// Samples translations or scales, whatever is the keys format, directly to
+// _member of _output transforms.
+template <typename _Key>
+void SampleFloat3s(float _ratio, int _num_soa_tracks, int _num_tracks,
+                   const ozz::span<const _Key>& _keys,
+                   const ozz::span<const int>& _index,
+                   const ozz::span<const uint16_t>& _tangents,
+                   const ozz::span<const uint8_t>& _constants,
+                   math::SoaFloat3 math::SoaTransform::*_member,
+                   math::SoaTransform* _output) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_ratio);
   for (int i = 0; i < _num_soa_tracks; ++i) {
-    // Prepares interpolation coefficients.
-    const math::SimdFloat4 interp_t_ratio =
-        (anim_ratio - _translations[i].ratio[0]) *
-        math::RcpEst(_translations[i].ratio[1] - _translations[i].ratio[0]);
-    const math::SimdFloat4 interp_r_ratio =
-        (anim_ratio - _rotations[i].ratio[0]) *
-        math::RcpEst(_rotations[i].ratio[1] - _rotations[i].ratio[0]);
-    const math::SimdFloat4 interp_s_ratio =
-        (anim_ratio - _scales[i].ratio[0]) *
-        math::RcpEst(_scales[i].ratio[1] - _scales[i].ratio[0]);
-
-    // Processes interpolations.
-    // The lerp of the rotation uses the shortest path, because opposed
-    // quaternions were negated during animation build stage (AnimationBuilder).
-    _output[i].translation = Lerp(_translations[i].value[0],
-                                  _translations[i].value[1], interp_t_ratio);
-    _output[i].rotation = NLerpEst(_rotations[i].value[0],
-                                   _rotations[i].value[1], interp_r_ratio);
-    _output[i].scale =
-        Lerp(_scales[i].value[0], _scales[i].value[1], interp_s_ratio);
+    int interp[8];
+    FindInterpKeys(_keys, _index, _num_tracks, i, _ratio, interp);
+    internal::InterpSoaFloat3 interp_key;
+    DecompressInterpKeys(_keys, interp, &interp_key,
+                         &internal::DecompressFloat3<_Key>);
+    internal::InterpSoaTangents interp_tangents;
+    if (!_tangents.empty()) {
+      DecompressInterpTangents(_tangents, interp, interp_key.ratio,
+                               &interp_tangents);
+    }
+    InterpolateFloat3(anim_ratio, interp_key,
+                      _tangents.empty() ? nullptr : &interp_tangents,
+                      IsFlagged(_constants, i), &(_output[i].*_member));
+  }
+}
+
+// Samples rotations, whatever is rotation keys format.
+template <typename _Key>
+void SampleRotations(float _ratio, int _num_soa_tracks, int _num_tracks,
+                     const ozz::span<const _Key>& _keys,
+                     const ozz::span<const int>& _index,
+                     const ozz::span<const uint8_t>& _constants,
+                     math::SoaTransform* _output) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_ratio);
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    int interp[8];
+    FindInterpKeys(_keys, _index, _num_tracks, i, _ratio, interp);
+    internal::InterpSoaQuaternion interp_key;
+    DecompressInterpKeys(_keys, interp, &interp_key,
+                         &internal::DecompressQuaternion<_Key>);
+    InterpolateQuaternion(anim_ratio, interp_key, IsFlagged(_constants, i),
+                          &_output[i].rotation);
   }
 }
 }  // namespace
 
-SamplingJob::SamplingJob() : ratio(0.f), animation(nullptr), context(nullptr) {}
+SamplingJob::SamplingJob()
+    : ratio(0.f),
+      animation(nullptr),
+      context(nullptr),
+      stats(nullptr),
+      prefetch_distance(kDefaultPrefetchDistance) {}
+
+SamplingJob::Stats::Stats() { Reset(); }
+
+void SamplingJob::Stats::Reset() {
+  keys_advanced = 0;
+  refreshed_entries = 0;
+  interpolated_entries = 0;
+  invalidations = 0;
+}
 
 bool SamplingJob::Run() const {
   if (!Validate()) {
     return false;
   }
+  RunUnchecked();
+  return true;
+}
+
+void SamplingJob::RunUnchecked() const {
+  OZZ_PROFILE_ZONE("SamplingJob::Run");
 
   const int num_soa_tracks = animation->num_soa_tracks();
   if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
-    return true;
+    return;
   }
 
   // Clamps ratio in range [0,duration].
   const float anim_ratio = math::Clamp(0.f, ratio, 1.f);
 
-  // Step the context to this potentially new animation and ratio.
+  // Updates context keyframes for this potentially new animation and ratio.
   assert(context->max_soa_tracks() >= num_soa_tracks);
-  context->Step(*animation, anim_ratio);
+  context->Update(*animation, anim_ratio, mask, stats, prefetch_distance);
 
-  // Fetch key frames from the animation to the context at r = anim_ratio.
-  // Then updates outdated soa hot values.
-  UpdateCacheCursor(anim_ratio, num_soa_tracks, animation->translations(),
-                    &context->translation_cursor_, context->translation_keys_,
-                    context->outdated_translations_);
-  UpdateInterpKeyframes(num_soa_tracks, animation->translations(),
-                        context->translation_keys_,
-                        context->outdated_translations_,
-                        context->soa_translations_, &DecompressFloat3);
-
-  UpdateCacheCursor(anim_ratio, num_soa_tracks, animation->rotations(),
-                    &context->rotation_cursor_, context->rotation_keys_,
-                    context->outdated_rotations_);
-  UpdateInterpKeyframes(num_soa_tracks, animation->rotations(),
-                        context->rotation_keys_, context->outdated_rotations_,
-                        context->soa_rotations_, &DecompressQuaternion);
-
-  UpdateCacheCursor(anim_ratio, num_soa_tracks, animation->scales(),
-                    &context->scale_cursor_, context->scale_keys_,
-                    context->outdated_scales_);
-  UpdateInterpKeyframes(num_soa_tracks, animation->scales(),
-                        context->scale_keys_, context->outdated_scales_,
-                        context->soa_scales_, &DecompressFloat3);
-
-  // only interp as much as we have output for.
-  const int num_soa_interp_tracks = math::Min(static_cast< int >(output.size()), num_soa_tracks);
+  // Only interpolates as much as there's output for.
+  const size_t num_outputs =
+      half_output.empty() ? output.size() : half_output.size();
+  const int num_soa_interp_tracks =
+      math::Min(static_cast<int>(num_outputs), num_soa_tracks);
 
   // Interpolates soa hot data.
-  Interpolates(anim_ratio, num_soa_interp_tracks, context->soa_translations_,
-               context->soa_rotations_, context->soa_scales_, output.begin());
+  if (half_output.empty()) {
+    context->Interpolate(0, num_soa_interp_tracks, mask, output.begin());
+  } else {
+    // Interpolates by chunks to a stack buffer, which is then converted to
+    // half output. Masked out entries are left unchanged.
+    const int kChunkSize = 8;
+    math::SoaTransform chunk[kChunkSize];
+    for (int begin = 0; begin < num_soa_interp_tracks; begin += kChunkSize) {
+      const int end = math::Min(begin + kChunkSize, num_soa_interp_tracks);
+      context->Interpolate(begin, end, mask, chunk);
+      for (int i = begin; i < end; ++i) {
+        if (mask.empty() || IsFlagged(mask, i)) {
+          math::PackHalf(chunk[i - begin], &half_output[i]);
+        }
+      }
+    }
+  }
 
-  return true;
+  // Computes velocities from the same keys. Both are computed in the same
+  // pass for the SoA tracks they have in common.
+  const int num_linear = math::Min(static_cast<int>(linear_velocities.size()),
+                                   num_soa_interp_tracks);
+  const int num_angular = math::Min(
+      static_cast<int>(angular_velocities.size()), num_soa_interp_tracks);
+  if (num_linear > 0 || num_angular > 0) {
+    const int num_both = math::Min(num_linear, num_angular);
+    context->Differentiate(0, num_both, mask, linear_velocities.begin(),
+                           angular_velocities.begin());
+    context->Differentiate(num_both, num_linear, mask,
+                           linear_velocities.begin() + num_both, nullptr);
+    context->Differentiate(num_both, num_angular, mask, nullptr,
+                           angular_velocities.begin() + num_both);
+  }
+
+  if (stats) {
+    int interpolated = num_soa_interp_tracks;
+    if (!mask.empty()) {
+      for (int i = 0; i < num_soa_interp_tracks; ++i) {
+        interpolated -= !IsFlagged(mask, i);
+      }
+    }
+    stats->interpolated_entries += interpolated;
+  }
+}
+
+void SamplingJob::Context::Update(const Animation& _animation, float _ratio,
+                                  const span<const uint8_t>& _mask,
+                                  SamplingJob::Stats* _stats,
+                                  int _prefetch_distance) {
+  OZZ_PROFILE_ZONE("SamplingJob::Context::Update");
+
+  const int num_soa_tracks = _animation.num_soa_tracks();
+
+  // Step the context to this potentially new animation and ratio.
+  const bool invalidated = Step(_animation, _ratio);
+  if (_stats) {
+    _stats->invalidations += invalidated;
+  }
+
+  // Tangents are only updated for cubic animations.
+  internal::InterpSoaTangents* translation_tangents = nullptr;
+  internal::InterpSoaTangents* scale_tangents = nullptr;
+  if (_animation.cubic()) {
+    assert(cubic() && "Context can't sample cubic animations.");
+    translation_tangents = soa_translation_tangents_;
+    scale_tangents = soa_scale_tangents_;
+  }
+
+  // Fetch key frames from the animation to the context at r = _ratio.
+  // Then updates outdated soa hot values.
+  // Only one of the translation (and scale) keys buffers is used, depending on
+  // the format.
+  if (!_animation.compact_translations().empty()) {
+    UpdateFloat3s(_ratio, num_soa_tracks, _animation.compact_translations(),
+                  _animation.translation_previouses(),
+                  _animation.translation_track_index(),
+                  _animation.translation_tangents(), &translation_cursor_,
+                  translation_keys_, outdated_translations_, soa_translations_,
+                  translation_tangents, _mask, _prefetch_distance, _stats);
+  } else {
+    UpdateFloat3s(_ratio, num_soa_tracks, _animation.translations(),
+                  _animation.translation_previouses(),
+                  _animation.translation_track_index(),
+                  _animation.translation_tangents(), &translation_cursor_,
+                  translation_keys_, outdated_translations_, soa_translations_,
+                  translation_tangents, _mask, _prefetch_distance, _stats);
+  }
+
+  // Only one of the rotation keys buffers is used, depending on the format.
+  if (!_animation.compact_rotations().empty()) {
+    UpdateRotations(_ratio, num_soa_tracks, _animation.compact_rotations(),
+                    _animation.rotation_previouses(),
+                    _animation.rotation_track_index(), &rotation_cursor_,
+                    rotation_keys_, outdated_rotations_, soa_rotations_,
+                    _mask, _prefetch_distance, _stats);
+  } else if (!_animation.packed_rotations().empty()) {
+    UpdateRotations(_ratio, num_soa_tracks, _animation.packed_rotations(),
+                    _animation.rotation_previouses(),
+                    _animation.rotation_track_index(), &rotation_cursor_,
+                    rotation_keys_, outdated_rotations_, soa_rotations_,
+                    _mask, _prefetch_distance, _stats);
+  } else {
+    UpdateRotations(_ratio, num_soa_tracks, _animation.rotations(),
+                    _animation.rotation_previouses(),
+                    _animation.rotation_track_index(), &rotation_cursor_,
+                    rotation_keys_, outdated_rotations_, soa_rotations_,
+                    _mask, _prefetch_distance, _stats);
+  }
+
+  if (!_animation.compact_scales().empty()) {
+    UpdateFloat3s(_ratio, num_soa_tracks, _animation.compact_scales(),
+                  _animation.scale_previouses(),
+                  _animation.scale_track_index(), _animation.scale_tangents(),
+                  &scale_cursor_, scale_keys_, outdated_scales_, soa_scales_,
+                  scale_tangents, _mask, _prefetch_distance, _stats);
+  } else {
+    UpdateFloat3s(_ratio, num_soa_tracks, _animation.scales(),
+                  _animation.scale_previouses(),
+                  _animation.scale_track_index(), _animation.scale_tangents(),
+                  &scale_cursor_, scale_keys_, outdated_scales_, soa_scales_,
+                  scale_tangents, _mask, _prefetch_distance, _stats);
+  }
+}
+
+void SamplingJob::Context::Interpolate(int _begin, int _end,
+                                       const span<const uint8_t>& _mask,
+                                       math::SoaTransform* _output) const {
+  assert(animation_ && _begin >= 0 && _begin <= _end &&
+         _end <= animation_->num_soa_tracks());
+  OZZ_PROFILE_ZONE("SamplingJob::Interpolates");
+  const bool cubic = animation_->cubic();
+  const InterpEntries entries = {
+      soa_translations_, soa_rotations_, soa_scales_,
+      cubic ? soa_translation_tangents_ : nullptr,
+      cubic ? soa_scale_tangents_ : nullptr};
+  Interpolates(ratio_, _begin, _end, entries, *animation_, _mask, _output);
+}
+
+void SamplingJob::Context::Differentiate(int _begin, int _end,
+                                         const span<const uint8_t>& _mask,
+                                         math::SoaFloat3* _linear,
+                                         math::SoaFloat3* _angular) const {
+  assert(animation_ && _begin >= 0 && _begin <= _end &&
+         _end <= animation_->num_soa_tracks());
+  OZZ_PROFILE_ZONE("SamplingJob::Differentiates");
+  const float duration = animation_->duration();
+  const float rate = duration > 0.f ? 1.f / duration : 0.f;
+  const bool cubic = animation_->cubic();
+  const InterpEntries entries = {
+      soa_translations_, soa_rotations_, soa_scales_,
+      cubic ? soa_translation_tangents_ : nullptr,
+      cubic ? soa_scale_tangents_ : nullptr};
+  Differentiates(ratio_, rate, _begin, _end, entries, *animation_, _mask,
+                 _linear, _angular);
 }
 
 SamplingJob::Context::Context()
     : max_soa_tracks_(0),
+      owns_buffer_(false),
       soa_translations_(
-          nullptr) {  // soa_translations_ is the allocation pointer.
+          nullptr),  // soa_translations_ is the allocation pointer.
+      soa_translation_tangents_(nullptr),
+      soa_scale_tangents_(nullptr) {
   Invalidate();
 }
 
-SamplingJob::Context::Context(int _max_tracks)
+SamplingJob::Context::Context(int _max_tracks, bool _cubic)
     : max_soa_tracks_(0),
+      owns_buffer_(false),
       soa_translations_(
-          nullptr) {  // soa_translations_ is the allocation pointer.
-  Resize(_max_tracks);
+          nullptr),  // soa_translations_ is the allocation pointer.
+      soa_translation_tangents_(nullptr),
+      soa_scale_tangents_(nullptr) {
+  Resize(_max_tracks, _cubic);
+}
+
+SamplingJob::Context::Context(int _max_tracks, span<byte> _buffer,
+                              bool _cubic)
+    : max_soa_tracks_(0),
+      owns_buffer_(false),
+      soa_translations_(nullptr),
+      soa_translation_tangents_(nullptr),
+      soa_scale_tangents_(nullptr) {
+  Resize(_max_tracks, _buffer, _cubic);
 }
 
 SamplingJob::Context::~Context() {
   // Deallocates everything at once.
-  memory::default_allocator()->Deallocate(soa_translations_);
+  if (owns_buffer_) {
+    memory::default_allocator()->Deallocate(soa_translations_);
+  }
 }
 
-void SamplingJob::Context::Resize(int _max_tracks) {
+size_t SamplingJob::Context::BufferSize(int _max_tracks, bool _cubic) {
   using internal::InterpSoaFloat3;
   using internal::InterpSoaQuaternion;
+  using internal::InterpSoaTangents;
+
+  const size_t max_soa_tracks = (_max_tracks + 3) / 4;
+  const size_t max_tracks = max_soa_tracks * 4;
+  const size_t num_outdated = (max_soa_tracks + 7) / 8;
+  const size_t size =
+      sizeof(InterpSoaFloat3) * max_soa_tracks +
+      sizeof(InterpSoaQuaternion) * max_soa_tracks +
+      sizeof(InterpSoaFloat3) * max_soa_tracks +
+      (_cubic ? sizeof(InterpSoaTangents) * max_soa_tracks * 2 : 0) +
+      sizeof(int) * max_tracks * 2 * 3 +  // 2 keys * (trans + rot + scale).
+      sizeof(uint8_t) * 3 * num_outdated;
+
+  // Rounds up, so that buffers can be contiguous.
+  return Align(size, static_cast<size_t>(kBufferAlignment));
+}
+
+void SamplingJob::Context::Resize(int _max_tracks, bool _cubic) {
+  // Allocates all context data at once in a single allocation.
+  const size_t size = BufferSize(_max_tracks, _cubic);
+  const memory::TagScope memory_tag(memory::kTagContext);
+  byte* buffer = reinterpret_cast<byte*>(
+      memory::default_allocator()->Allocate(size, kBufferAlignment));
+  Resize(_max_tracks, {buffer, size}, _cubic);
+  owns_buffer_ = true;
+}
+
+void SamplingJob::Context::Resize(int _max_tracks, span<byte> _buffer,
+                                  bool _cubic) {
+  using internal::InterpSoaFloat3;
+  using internal::InterpSoaQuaternion;
+  using internal::InterpSoaTangents;
+
+  static_assert(alignof(InterpSoaFloat3) <= kBufferAlignment,
+                "Invalid buffer alignment");
 
   // Reset existing data.
   Invalidate();
-  memory::default_allocator()->Deallocate(soa_translations_);
+  if (owns_buffer_) {
+    memory::default_allocator()->Deallocate(soa_translations_);
+  }
+  owns_buffer_ = false;
+  soa_translations_ = nullptr;
+  soa_translation_tangents_ = nullptr;
+  soa_scale_tangents_ = nullptr;
+  max_soa_tracks_ = 0;
+
+  // Leaves the context empty if buffer isn't valid.
+  const bool valid = _buffer.size() >= BufferSize(_max_tracks, _cubic) &&
+                     IsAligned(_buffer.data(), kBufferAlignment);
+  assert(valid && "Invalid context buffer.");
+  if (!valid) {
+    return;
+  }
 
   // Updates maximum supported soa tracks.
   max_soa_tracks_ = (_max_tracks + 3) / 4;
 
-  // Allocate all context data at once in a single allocation.
-  // Alignment is guaranteed because memory is dispatch from the highest
-  // alignment requirement (Soa data: SimdFloat4) to the lowest (outdated
-  // flag: unsigned char).
-
-  // Computes allocation size.
-  const size_t max_tracks = max_soa_tracks_ * 4;
-  const size_t num_outdated = (max_soa_tracks_ + 7) / 8;
-  const size_t size =
-      sizeof(InterpSoaFloat3) * max_soa_tracks_ +
-      sizeof(InterpSoaQuaternion) * max_soa_tracks_ +
-      sizeof(InterpSoaFloat3) * max_soa_tracks_ +
-      sizeof(int) * max_tracks * 2 * 3 +  // 2 keys * (trans + rot + scale).
-      sizeof(uint8_t) * 3 * num_outdated;
-
-  // Allocates all at once.
-  memory::Allocator* allocator = memory::default_allocator();
-  char* alloc_begin = reinterpret_cast<char*>(
-      allocator->Allocate(size, alignof(InterpSoaFloat3)));
-  char* alloc_cursor = alloc_begin;
-
   // Distributes buffer memory while ensuring proper alignment (serves larger
-  // alignment values first).
+  // alignment values first, from Soa data: SimdFloat4, to outdated flags:
+  // unsigned char).
   static_assert(alignof(InterpSoaFloat3) >= alignof(InterpSoaQuaternion) &&
                     alignof(InterpSoaQuaternion) >= alignof(InterpSoaFloat3) &&
-                    alignof(InterpSoaFloat3) >= alignof(int) &&
+                    alignof(InterpSoaFloat3) >= alignof(InterpSoaTangents) &&
+                    alignof(InterpSoaTangents) >= alignof(int) &&
                     alignof(int) >= alignof(uint8_t),
                 "Must serve larger alignment values first)");
 
-  soa_translations_ = reinterpret_cast<InterpSoaFloat3*>(alloc_cursor);
-  assert(IsAligned(soa_translations_, alignof(InterpSoaFloat3)));
-  alloc_cursor += sizeof(InterpSoaFloat3) * max_soa_tracks_;
-  soa_rotations_ = reinterpret_cast<InterpSoaQuaternion*>(alloc_cursor);
-  assert(IsAligned(soa_rotations_, alignof(InterpSoaQuaternion)));
-  alloc_cursor += sizeof(InterpSoaQuaternion) * max_soa_tracks_;
-  soa_scales_ = reinterpret_cast<InterpSoaFloat3*>(alloc_cursor);
-  assert(IsAligned(soa_scales_, alignof(InterpSoaFloat3)));
-  alloc_cursor += sizeof(InterpSoaFloat3) * max_soa_tracks_;
-
-  translation_keys_ = reinterpret_cast<int*>(alloc_cursor);
-  assert(IsAligned(translation_keys_, alignof(int)));
-  alloc_cursor += sizeof(int) * max_tracks * 2;
-  rotation_keys_ = reinterpret_cast<int*>(alloc_cursor);
-  alloc_cursor += sizeof(int) * max_tracks * 2;
-  scale_keys_ = reinterpret_cast<int*>(alloc_cursor);
-  alloc_cursor += sizeof(int) * max_tracks * 2;
-
-  outdated_translations_ = reinterpret_cast<uint8_t*>(alloc_cursor);
-  assert(IsAligned(outdated_translations_, alignof(uint8_t)));
-  alloc_cursor += sizeof(uint8_t) * num_outdated;
-  outdated_rotations_ = reinterpret_cast<uint8_t*>(alloc_cursor);
-  alloc_cursor += sizeof(uint8_t) * num_outdated;
-  outdated_scales_ = reinterpret_cast<uint8_t*>(alloc_cursor);
-  alloc_cursor += sizeof(uint8_t) * num_outdated;
-
-  assert(alloc_cursor == alloc_begin + size);
-}
-
-void SamplingJob::Context::Step(const Animation& _animation, float _ratio) {
-  // The context is invalidated if animation has changed or if it is being
-  // rewind.
-  if (animation_ != &_animation || _ratio < ratio_) {
+  const size_t max_tracks = max_soa_tracks_ * 4;
+  const size_t num_outdated = (max_soa_tracks_ + 7) / 8;
+  soa_translations_ =
+      fill_span<InterpSoaFloat3>(_buffer, max_soa_tracks_).data();
+  soa_rotations_ =
+      fill_span<InterpSoaQuaternion>(_buffer, max_soa_tracks_).data();
+  soa_scales_ = fill_span<InterpSoaFloat3>(_buffer, max_soa_tracks_).data();
+  if (_cubic) {
+    soa_translation_tangents_ =
+        fill_span<InterpSoaTangents>(_buffer, max_soa_tracks_).data();
+    soa_scale_tangents_ =
+        fill_span<InterpSoaTangents>(_buffer, max_soa_tracks_).data();
+  }
+
+  translation_keys_ = fill_span<int>(_buffer, max_tracks * 2).data();
+  rotation_keys_ = fill_span<int>(_buffer, max_tracks * 2).data();
+  scale_keys_ = fill_span<int>(_buffer, max_tracks * 2).data();
+
+  outdated_translations_ = fill_span<uint8_t>(_buffer, num_outdated).data();
+  outdated_rotations_ = fill_span<uint8_t>(_buffer, num_outdated).data();
+  outdated_scales_ = fill_span<uint8_t>(_buffer, num_outdated).data();
+}
+
+namespace {
+// Tells if searching for keys using animation per track keys indices is
+// cheaper than iterating keys, to update a context from _from to _to ratio.
+// Keys are assumed to be evenly distributed along the animation, so the number
+// of keys to iterate per track is compared to the cost of a binary search.
+bool ShouldSearchKeys(const Animation& _animation, float _from, float _to) {
+  const int num_tracks = _animation.num_soa_tracks() * 4;
+  const size_t num_indices = _animation.translation_track_index().size() +
+                             _animation.rotation_track_index().size() +
+                             _animation.scale_track_index().size();
+  const float keys_per_track =
+      static_cast<float>(num_indices - 3 * (num_tracks + 1)) /
+      static_cast<float>(3 * num_tracks);
+  const float iterations = keys_per_track * std::abs(_to - _from);
+  return iterations > 1.f + std::log2(keys_per_track);
+}
+}  // namespace
+
+bool SamplingJob::Context::Step(const Animation& _animation, float _ratio) {
+  const int num_seek_points = _animation.num_seek_points();
+  const int seek_point = internal::SeekPointIndex(_ratio, num_seek_points);
+
+  // The context is invalidated if animation or its data have changed, or if
+  // it is being rewind. It's restored from the nearest seek point if there's
+  // one. Bidirectional animations aren't invalidated when rewinding, unless a
+  // seek point is closer.
+  const bool reset =
+      animation_ != &_animation || generation_ != _animation.generation() ||
+      (_ratio < ratio_ &&
+       (!_animation.bidirectional() ||
+        seek_point < internal::SeekPointIndex(ratio_, num_seek_points) - 1));
+
+  bool invalidated = false;
+
+  // Random access animations allow to search for keys directly when ratio
+  // changes too much (ie: decimated updates, jumps), rather than iterating
+  // all the keys in between. This is flagged with negative cursors.
+  if (_animation.random_access() &&
+      ShouldSearchKeys(_animation, reset ? 0.f : ratio_, _ratio)) {
     animation_ = &_animation;
-    translation_cursor_ = 0;
-    rotation_cursor_ = 0;
-    scale_cursor_ = 0;
+    generation_ = _animation.generation();
+    translation_cursor_ = -1;
+    rotation_cursor_ = -1;
+    scale_cursor_ = -1;
+    invalidated = true;
+  } else if (reset) {
+    animation_ = &_animation;
+    generation_ = _animation.generation();
+    if (seek_point >= 0) {
+      RestoreSeekPoint(_animation, seek_point);
+    } else {
+      translation_cursor_ = 0;
+      rotation_cursor_ = 0;
+      scale_cursor_ = 0;
+    }
+    invalidated = true;
+  } else if (seek_point >
+             internal::SeekPointIndex(ratio_, num_seek_points) + 1) {
+    // Jumps forward over more than a seek interval, restoring from the seek
+    // point is cheaper than iterating all the keys in between.
+    RestoreSeekPoint(_animation, seek_point);
+    invalidated = true;
   }
   ratio_ = _ratio;
+  return invalidated;
+}
+
+void SamplingJob::Context::RestoreSeekPoint(const Animation& _animation,
+                                            int _point) {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  assert(max_soa_tracks_ >= num_soa_tracks);
+  assert(_point >= 0 && _point < _animation.num_seek_points());
+
+  const int* point = _animation.seek_table().begin() +
+                     _point * internal::SeekPointStride(num_soa_tracks);
+  translation_cursor_ = point[0];
+  rotation_cursor_ = point[1];
+  scale_cursor_ = point[2];
+
+  const size_t num_keys = num_soa_tracks * 4 * 2;
+  const int* keys = point + 3;
+  std::memcpy(translation_keys_, keys, sizeof(int) * num_keys);
+  std::memcpy(rotation_keys_, keys + num_keys, sizeof(int) * num_keys);
+  std::memcpy(scale_keys_, keys + num_keys * 2, sizeof(int) * num_keys);
+
+  // Soa hot data must be decompressed again.
+  FlagAllOutdated(num_soa_tracks, outdated_translations_);
+  FlagAllOutdated(num_soa_tracks, outdated_rotations_);
+  FlagAllOutdated(num_soa_tracks, outdated_scales_);
+}
+
+void SamplingJob::Context::CopyState(const Context& _other,
+                                     int _num_soa_tracks) {
+  assert(max_soa_tracks_ >= _num_soa_tracks &&
+         _other.max_soa_tracks_ >= _num_soa_tracks);
+
+  animation_ = _other.animation_;
+  generation_ = _other.generation_;
+  ratio_ = _other.ratio_;
+  translation_cursor_ = _other.translation_cursor_;
+  rotation_cursor_ = _other.rotation_cursor_;
+  scale_cursor_ = _other.scale_cursor_;
+
+  // Copies soa hot data.
+  const size_t num_soa_tracks = static_cast<size_t>(_num_soa_tracks);
+  std::memcpy(soa_translations_, _other.soa_translations_,
+              sizeof(internal::InterpSoaFloat3) * num_soa_tracks);
+  std::memcpy(soa_rotations_, _other.soa_rotations_,
+              sizeof(internal::InterpSoaQuaternion) * num_soa_tracks);
+  std::memcpy(soa_scales_, _other.soa_scales_,
+              sizeof(internal::InterpSoaFloat3) * num_soa_tracks);
+
+  // Copies tangents of cubic animations, which both contexts store as they
+  // were validated for the animation.
+  if (animation_ && animation_->cubic()) {
+    assert(cubic() && _other.cubic());
+    std::memcpy(soa_translation_tangents_, _other.soa_translation_tangents_,
+                sizeof(internal::InterpSoaTangents) * num_soa_tracks);
+    std::memcpy(soa_scale_tangents_, _other.soa_scale_tangents_,
+                sizeof(internal::InterpSoaTangents) * num_soa_tracks);
+  }
+
+  // Copies keys and outdated flags.
+  const size_t num_keys = num_soa_tracks * 4 * 2;
+  std::memcpy(translation_keys_, _other.translation_keys_,
+              sizeof(int) * num_keys);
+  std::memcpy(rotation_keys_, _other.rotation_keys_, sizeof(int) * num_keys);
+  std::memcpy(scale_keys_, _other.scale_keys_, sizeof(int) * num_keys);
+
+  const size_t num_outdated = (num_soa_tracks + 7) / 8;
+  std::memcpy(outdated_translations_, _other.outdated_translations_,
+              num_outdated);
+  std::memcpy(outdated_rotations_, _other.outdated_rotations_, num_outdated);
+  std::memcpy(outdated_scales_, _other.outdated_scales_, num_outdated);
 }
 
 void SamplingJob::Context::Invalidate() {
   animation_ = nullptr;
+  generation_ = 0;
   ratio_ = 0.f;
   translation_cursor_ = 0;
   rotation_cursor_ = 0;
   scale_cursor_ = 0;
 }
+
+namespace {
+// Context snapshot header, followed by soa tracks data. Tangents of cubic
+// animations aren't saved, they're decompressed again once restored.
+struct ContextSnapshotHeader {
+  const Animation* animation;
+  uint32_t generation;
+  float ratio;
+  int cursors[3];
+  int num_soa_tracks;
+  bool cubic;
+};
+
+// Gets the size in bytes of a snapshot of _num_soa_tracks soa tracks.
+size_t SoaSnapshotSize(size_t _num_soa_tracks) {
+  return sizeof(ContextSnapshotHeader) +
+         sizeof(internal::InterpSoaFloat3) * _num_soa_tracks * 2 +
+         sizeof(internal::InterpSoaQuaternion) * _num_soa_tracks +
+         sizeof(int) * _num_soa_tracks * 4 * 2 * 3 +
+         sizeof(uint8_t) * ((_num_soa_tracks + 7) / 8) * 3;
+}
+
+// Copies _size bytes from _src to _cursor, and advances _cursor.
+void Write(const void* _src, size_t _size, byte** _cursor) {
+  std::memcpy(*_cursor, _src, _size);
+  *_cursor += _size;
+}
+
+// Copies _size bytes from _cursor to _dest, and advances _cursor.
+void Read(void* _dest, size_t _size, const byte** _cursor) {
+  std::memcpy(_dest, *_cursor, _size);
+  *_cursor += _size;
+}
+}  // namespace
+
+size_t SamplingJob::Context::SnapshotSize(int _num_tracks) {
+  return SoaSnapshotSize(static_cast<size_t>(_num_tracks + 3) / 4);
+}
+
+size_t SamplingJob::Context::Snapshot(span<byte> _buffer) const {
+  const size_t num_soa_tracks =
+      animation_ ? static_cast<size_t>(animation_->num_soa_tracks()) : 0;
+  const size_t size = SoaSnapshotSize(num_soa_tracks);
+  if (_buffer.size() < size) {
+    return 0;
+  }
+
+  ContextSnapshotHeader header;
+  header.animation = animation_;
+  header.generation = generation_;
+  header.ratio = ratio_;
+  header.cursors[0] = translation_cursor_;
+  header.cursors[1] = rotation_cursor_;
+  header.cursors[2] = scale_cursor_;
+  header.num_soa_tracks = static_cast<int>(num_soa_tracks);
+  header.cubic = animation_ && animation_->cubic();
+
+  byte* cursor = _buffer.data();
+  Write(&header, sizeof(header), &cursor);
+  Write(soa_translations_, sizeof(internal::InterpSoaFloat3) * num_soa_tracks,
+        &cursor);
+  Write(soa_rotations_, sizeof(internal::InterpSoaQuaternion) * num_soa_tracks,
+        &cursor);
+  Write(soa_scales_, sizeof(internal::InterpSoaFloat3) * num_soa_tracks,
+        &cursor);
+  const size_t num_keys = num_soa_tracks * 4 * 2;
+  Write(translation_keys_, sizeof(int) * num_keys, &cursor);
+  Write(rotation_keys_, sizeof(int) * num_keys, &cursor);
+  Write(scale_keys_, sizeof(int) * num_keys, &cursor);
+  const size_t num_outdated = (num_soa_tracks + 7) / 8;
+  Write(outdated_translations_, num_outdated, &cursor);
+  Write(outdated_rotations_, num_outdated, &cursor);
+  Write(outdated_scales_, num_outdated, &cursor);
+  assert(cursor == _buffer.data() + size);
+
+  return size;
+}
+
+bool SamplingJob::Context::Restore(span<const byte> _buffer) {
+  ContextSnapshotHeader header;
+  const byte* cursor = _buffer.data();
+  if (_buffer.size() < sizeof(header)) {
+    Invalidate();
+    return false;
+  }
+  Read(&header, sizeof(header), &cursor);
+  const size_t num_soa_tracks = static_cast<size_t>(header.num_soa_tracks);
+  if (header.num_soa_tracks < 0 || header.num_soa_tracks > max_soa_tracks_ ||
+      _buffer.size() < SoaSnapshotSize(num_soa_tracks)) {
+    Invalidate();
+    return false;
+  }
+
+  animation_ = header.animation;
+  generation_ = header.generation;
+  ratio_ = header.ratio;
+  translation_cursor_ = header.cursors[0];
+  rotation_cursor_ = header.cursors[1];
+  scale_cursor_ = header.cursors[2];
+
+  Read(soa_translations_, sizeof(internal::InterpSoaFloat3) * num_soa_tracks,
+       &cursor);
+  Read(soa_rotations_, sizeof(internal::InterpSoaQuaternion) * num_soa_tracks,
+       &cursor);
+  Read(soa_scales_, sizeof(internal::InterpSoaFloat3) * num_soa_tracks,
+       &cursor);
+  const size_t num_keys = num_soa_tracks * 4 * 2;
+  Read(translation_keys_, sizeof(int) * num_keys, &cursor);
+  Read(rotation_keys_, sizeof(int) * num_keys, &cursor);
+  Read(scale_keys_, sizeof(int) * num_keys, &cursor);
+  const size_t num_outdated = (num_soa_tracks + 7) / 8;
+  Read(outdated_translations_, num_outdated, &cursor);
+  Read(outdated_rotations_, num_outdated, &cursor);
+  Read(outdated_scales_, num_outdated, &cursor);
+
+  // Tangents aren't part of the snapshot, so translations and scales of cubic
+  // animations must be decompressed again.
+  if (header.cubic) {
+    FlagAllOutdated(header.num_soa_tracks, outdated_translations_);
+    FlagAllOutdated(header.num_soa_tracks, outdated_scales_);
+  }
+
+  return true;
+}
+
+SamplingJob::ContextBank::ContextBank() {}
+
+SamplingJob::ContextBank::ContextBank(int _num_contexts, int _max_tracks,
+                                      bool _cubic) {
+  Resize(_num_contexts, _max_tracks, _cubic);
+}
+
+SamplingJob::ContextBank::~ContextBank() { Release(); }
+
+void SamplingJob::ContextBank::Resize(int _num_contexts, int _max_tracks,
+                                      bool _cubic) {
+  Release();
+  if (_num_contexts <= 0) {
+    return;
+  }
+
+  // Contexts objects are followed by their buffers.
+  const size_t num_contexts = static_cast<size_t>(_num_contexts);
+  const size_t contexts_size =
+      Align(sizeof(Context) * num_contexts,
+            static_cast<size_t>(Context::kBufferAlignment));
+  const size_t buffer_size = Context::BufferSize(_max_tracks, _cubic);
+  const size_t size = contexts_size + buffer_size * num_contexts;
+  static_assert(alignof(Context) <= Context::kBufferAlignment,
+                "Invalid alignment");
+  const memory::TagScope memory_tag(memory::kTagContext);
+  byte* alloc = reinterpret_cast<byte*>(
+      memory::default_allocator()->Allocate(size, Context::kBufferAlignment));
+
+  contexts_ = {reinterpret_cast<Context*>(alloc), num_contexts};
+  byte* buffer = alloc + contexts_size;
+  for (size_t i = 0; i < num_contexts; ++i, buffer += buffer_size) {
+    new (&contexts_[i]) Context(_max_tracks, {buffer, buffer_size}, _cubic);
+  }
+}
+
+void SamplingJob::ContextBank::Release() {
+  for (Context& context : contexts_) {
+    context.~Context();
+  }
+  memory::default_allocator()->Deallocate(contexts_.data());
+  contexts_ = {};
+}
+
+BatchSamplingJob::BatchSamplingJob() : animation(nullptr) {}
+
+bool BatchSamplingJob::Validate() const {
+  if (!animation) {
+    return false;
+  }
+  bool valid = ratios.size() == instances.size();
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  for (const Instance& instance : instances) {
+    if (!instance.context) {
+      return false;
+    }
+    valid &= instance.context->max_soa_tracks() >= num_soa_tracks;
+    valid &= !animation->cubic() || instance.context->cubic();
+    valid &= !instance.output.empty();
+  }
+
+  return valid;
+}
+
+bool BatchSamplingJob::Run() const {
+  OZZ_PROFILE_ZONE("BatchSamplingJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+
+  SamplingJob job;
+  job.animation = animation;
+
+  float prev_ratio = 0.f;
+  for (size_t i = 0; i < instances.size(); ++i) {
+    const Instance& instance = instances[i];
+    SamplingJob::Context* context = instance.context;
+    const float ratio = math::Clamp(0.f, ratios[i], 1.f);
+
+    // Seeds this instance context from the previous instance one, if it is
+    // closer to the expected ratio than the current context state.
+    if (i > 0 && prev_ratio <= ratio) {
+      const Instance& prev = instances[i - 1];
+      const bool usable =
+          context->animation_ == animation &&
+          context->generation_ == animation->generation() &&
+          context->ratio_ <= ratio;
+      if (prev.context != context &&
+          (!usable || context->ratio_ < prev_ratio)) {
+        context->CopyState(*prev.context, num_soa_tracks);
+
+        // Previous instance output is reused if it was sampled at the same
+        // ratio.
+        const size_t num_soa_interp_tracks = math::Min(
+            instance.output.size(), static_cast<size_t>(num_soa_tracks));
+        if (prev_ratio == ratio &&
+            prev.output.size() >= num_soa_interp_tracks) {
+          std::memcpy(instance.output.begin(), prev.output.begin(),
+                      sizeof(math::SoaTransform) * num_soa_interp_tracks);
+          continue;
+        }
+      }
+    }
+
+    job.ratio = ratio;
+    job.context = context;
+    job.output = instance.output;
+    if (!job.Run()) {
+      return false;
+    }
+    prev_ratio = ratio;
+  }
+
+  return true;
+}
+
+MultiRatioSamplingJob::MultiRatioSamplingJob()
+    : animation(nullptr), context(nullptr), stats(nullptr) {}
+
+bool MultiRatioSamplingJob::Validate() const {
+  if (!animation || !context) {
+    return false;
+  }
+  bool valid = context->max_soa_tracks() >= animation->num_soa_tracks();
+  valid &= !animation->cubic() || context->cubic();
+  valid &= ratios.size() == outputs.size();
+  for (size_t i = 1; i < ratios.size(); ++i) {
+    valid &= ratios[i - 1] <= ratios[i];
+  }
+  for (const span<math::SoaTransform>& output : outputs) {
+    valid &= !output.empty();
+  }
+  return valid;
+}
+
+bool MultiRatioSamplingJob::Run() const {
+  OZZ_PROFILE_ZONE("MultiRatioSamplingJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const size_t num_soa_tracks =
+      static_cast<size_t>(animation->num_soa_tracks());
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+
+  SamplingJob job;
+  job.animation = animation;
+  job.context = context;
+  job.stats = stats;
+
+  for (size_t i = 0; i < ratios.size(); ++i) {
+    const span<math::SoaTransform>& output = outputs[i];
+    const float ratio = math::Clamp(0.f, ratios[i], 1.f);
+
+    // Previous output is reused if it was sampled at the same ratio.
+    if (i > 0 && job.ratio == ratio) {
+      const size_t num_soa_interp_tracks =
+          math::Min(output.size(), num_soa_tracks);
+      if (outputs[i - 1].size() >= num_soa_interp_tracks) {
+        std::memcpy(output.begin(), outputs[i - 1].begin(),
+                    sizeof(math::SoaTransform) * num_soa_interp_tracks);
+        continue;
+      }
+    }
+
+    // Ratios are sorted, so the context only moves forward.
+    job.ratio = ratio;
+    job.output = output;
+    if (!job.Run()) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+CrowdSamplingJob::CrowdSamplingJob()
+    : parallel_for(nullptr), parallel_for_user_data(nullptr) {}
+
+bool CrowdSamplingJob::Validate() const {
+  bool valid = order.size() >= instances.size();
+  for (const Instance& instance : instances) {
+    if (!instance.animation || !instance.context) {
+      return false;
+    }
+    valid &= instance.context->max_soa_tracks() >=
+             instance.animation->num_soa_tracks();
+    valid &= !instance.animation->cubic() || instance.context->cubic();
+    valid &= !instance.output.empty();
+  }
+  return valid;
+}
+
+namespace {
+// Orders crowd instances by animation, then by ratio.
+struct CrowdInstanceLess {
+  bool operator()(int _a, int _b) const {
+    const CrowdSamplingJob::Instance& a = instances[_a];
+    const CrowdSamplingJob::Instance& b = instances[_b];
+    if (a.animation != b.animation) {
+      return std::less<const Animation*>()(a.animation, b.animation);
+    }
+    return a.ratio < b.ratio;
+  }
+  span<const CrowdSamplingJob::Instance> instances;
+};
+
+// Samples chunk _chunk of sorted instances of the valid job _data, batching
+// runs of instances that share the same animation.
+void SampleCrowdChunk(int _chunk, void* _data) {
+  const CrowdSamplingJob& job = *static_cast<const CrowdSamplingJob*>(_data);
+  const size_t count = job.instances.size();
+  const size_t begin =
+      static_cast<size_t>(_chunk) * CrowdSamplingJob::kChunkSize;
+  const size_t end = math::Min(begin + CrowdSamplingJob::kChunkSize, count);
+
+  float ratios[CrowdSamplingJob::kChunkSize];
+  BatchSamplingJob::Instance batch[CrowdSamplingJob::kChunkSize];
+  for (size_t run = begin; run < end;) {
+    BatchSamplingJob batch_job;
+    batch_job.animation = job.instances[job.order[run]].animation;
+    size_t num = 0;
+    for (; run < end; ++run, ++num) {
+      const CrowdSamplingJob::Instance& instance =
+          job.instances[job.order[run]];
+      if (instance.animation != batch_job.animation) {
+        break;
+      }
+      ratios[num] = instance.ratio;
+      batch[num].context = instance.context;
+      batch[num].output = instance.output;
+    }
+    batch_job.ratios = {ratios, num};
+    batch_job.instances = {batch, num};
+    const bool success = batch_job.Run();
+    (void)success;
+    assert(success && "Crowd job was validated.");
+  }
+}
+}  // namespace
+
+bool CrowdSamplingJob::Run() const {
+  OZZ_PROFILE_ZONE("CrowdSamplingJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  // Sorts instances by animation and ratio.
+  const int count = static_cast<int>(instances.size());
+  for (int i = 0; i < count; ++i) {
+    order[i] = i;
+  }
+  CrowdInstanceLess less;
+  less.instances = instances;
+  std::sort(order.begin(), order.begin() + count, less);
+
+  // Samples chunks of sorted instances.
+  const int chunks = (count + kChunkSize - 1) / kChunkSize;
+  if (parallel_for != nullptr && chunks > 1) {
+    parallel_for(chunks, &SampleCrowdChunk,
+                 const_cast<CrowdSamplingJob*>(this), parallel_for_user_data);
+  } else {
+    for (int i = 0; i < chunks; ++i) {
+      SampleCrowdChunk(i, const_cast<CrowdSamplingJob*>(this));
+    }
+  }
+  return true;
+}
+
+StatelessSamplingJob::StatelessSamplingJob()
+    : ratio(0.f), animation(nullptr) {}
+
+bool StatelessSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for nullptr pointers.
+  if (!animation) {
+    return false;
+  }
+  valid &= !output.empty();
+
+  // Tests animation has track indices.
+  valid &= animation->random_access();
+
+  return valid;
+}
+
+bool StatelessSamplingJob::Run() const {
+  OZZ_PROFILE_ZONE("StatelessSamplingJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+
+  // Clamps ratio in range [0,1].
+  const float anim_ratio = math::Clamp(0.f, ratio, 1.f);
+
+  // Only samples as much as there's output for.
+  const int num_soa_interp_tracks =
+      math::Min(static_cast<int>(output.size()), num_soa_tracks);
+  const int num_tracks = num_soa_tracks * 4;
+  math::SoaTransform* transforms = output.begin();
+
+  // Only one of the keys buffers of each type is used.
+  if (!animation->compact_translations().empty()) {
+    SampleFloat3s(anim_ratio, num_soa_interp_tracks, num_tracks,
+                  animation->compact_translations(),
+                  animation->translation_track_index(),
+                  animation->translation_tangents(),
+                  animation->constant_translations(),
+                  &math::SoaTransform::translation, transforms);
+  } else {
+    SampleFloat3s(anim_ratio, num_soa_interp_tracks, num_tracks,
+                  animation->translations(),
+                  animation->translation_track_index(),
+                  animation->translation_tangents(),
+                  animation->constant_translations(),
+                  &math::SoaTransform::translation, transforms);
+  }
+
+  if (!animation->compact_rotations().empty()) {
+    SampleRotations(anim_ratio, num_soa_interp_tracks, num_tracks,
+                    animation->compact_rotations(),
+                    animation->rotation_track_index(),
+                    animation->constant_rotations(), transforms);
+  } else if (!animation->packed_rotations().empty()) {
+    SampleRotations(anim_ratio, num_soa_interp_tracks, num_tracks,
+                    animation->packed_rotations(),
+                    animation->rotation_track_index(),
+                    animation->constant_rotations(), transforms);
+  } else {
+    SampleRotations(anim_ratio, num_soa_interp_tracks, num_tracks,
+                    animation->rotations(), animation->rotation_track_index(),
+                    animation->constant_rotations(), transforms);
+  }
+
+  if (!animation->compact_scales().empty()) {
+    SampleFloat3s(anim_ratio, num_soa_interp_tracks, num_tracks,
+                  animation->compact_scales(), animation->scale_track_index(),
+                  animation->scale_tangents(), animation->constant_scales(),
+                  &math::SoaTransform::scale, transforms);
+  } else {
+    SampleFloat3s(anim_ratio, num_soa_interp_tracks, num_tracks,
+                  animation->scales(), animation->scale_track_index(),
+                  animation->scale_tangents(), animation->constant_scales(),
+                  &math::SoaTransform::scale, transforms);
+  }
+
+  return true;
+}
 }  // namespace animation
 }  // namespace ozz
@@ -0,0 +1,196 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/segmented_animation.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "ozz/base/containers/string_archive.h"
+#include "ozz/base/containers/vector_archive.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/endianness.h"
+#include "ozz/base/log.h"
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace animation {
+
+SegmentedAnimation::SegmentedAnimation() : duration_(0.f), num_tracks_(0) {}
+
+SegmentedAnimation::SegmentedAnimation(SegmentedAnimation&& _other) {
+  *this = std::move(_other);
+}
+
+SegmentedAnimation& SegmentedAnimation::operator=(
+    SegmentedAnimation&& _other) {
+  std::swap(duration_, _other.duration_);
+  std::swap(num_tracks_, _other.num_tracks_);
+  std::swap(name_, _other.name_);
+  std::swap(ratios_, _other.ratios_);
+  std::swap(segments_, _other.segments_);
+  return *this;
+}
+
+SegmentedAnimation::~SegmentedAnimation() {}
+
+const Animation& SegmentedAnimation::segment(int _index) const {
+  assert(_index >= 0 && _index < num_segments() && "Invalid segment index.");
+  return segments_[_index];
+}
+
+int SegmentedAnimation::FindSegment(float _ratio, float* _segment_ratio) const {
+  assert(_segment_ratio);
+  if (segments_.empty()) {
+    *_segment_ratio = 0.f;
+    return -1;
+  }
+  const float ratio = math::Clamp(0.f, _ratio, 1.f);
+
+  // Finds the first boundary strictly after ratio, skipping the first one
+  // which is always 0. The last segment also owns ratio 1.
+  const float* begin = ratios_.data() + 1;
+  const float* end = ratios_.data() + ratios_.size() - 1;
+  const int index = static_cast<int>(std::upper_bound(begin, end, ratio) -
+                                     begin);
+
+  const float r0 = ratios_[index];
+  const float r1 = ratios_[index + 1];
+  *_segment_ratio =
+      r1 > r0 ? math::Clamp(0.f, (ratio - r0) / (r1 - r0), 1.f) : 0.f;
+  return index;
+}
+
+size_t SegmentedAnimation::size() const {
+  size_t size = sizeof(*this) + name_.size() +
+                ratios_.size() * sizeof(float) +
+                segments_.size() * sizeof(Animation);
+  for (const Animation& segment : segments_) {
+    size += segment.size() - sizeof(Animation);
+  }
+  return size;
+}
+
+void SegmentedAnimation::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
+  _archive << name_;
+  _archive << ratios_;
+
+  // Serializes each segment to its own archive, using the same endianness as
+  // _archive.
+  const Endianness native = GetNativeEndianness();
+  const Endianness endianness =
+      _archive.endian_swap()
+          ? (native == kBigEndian ? kLittleEndian : kBigEndian)
+          : native;
+  io::MemoryStream stream;
+  ozz::vector<uint32_t> sizes(segments_.size());
+  for (size_t i = 0; i < segments_.size(); ++i) {
+    const int64_t begin = stream.Tell();
+    io::OArchive archive(&stream, endianness);
+    archive << segments_[i];
+    sizes[i] = static_cast<uint32_t>(stream.Tell() - begin);
+  }
+
+  // Segments table gives each segment size, so any segment offset can be
+  // computed from the end of the table.
+  _archive << static_cast<int32_t>(segments_.size());
+  for (uint32_t size : sizes) {
+    _archive << size;
+  }
+
+  // Segments data.
+  ozz::vector<char> buffer(static_cast<size_t>(stream.Size()));
+  stream.Seek(0, io::Stream::kSet);
+  stream.Read(buffer.data(), buffer.size());
+  _archive.SaveBinary(buffer.data(), buffer.size());
+}
+
+void SegmentedAnimation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  ozz::vector<uint32_t> sizes;
+  if (!LoadHeader(_archive, _version, &sizes)) {
+    return;
+  }
+
+  // Every segment is an independent archive. Stream is moved to the end of
+  // the segment after loading, to stay consistent even if loading failed.
+  io::Stream* stream = _archive.stream();
+  for (size_t i = 0; i < segments_.size(); ++i) {
+    const int64_t end = stream->Tell() + sizes[i];
+    io::IArchive archive(stream);
+    archive >> segments_[i];
+    stream->Seek(end, io::Stream::kSet);
+  }
+}
+
+bool SegmentedAnimation::LoadHeader(ozz::io::IArchive& _archive,
+                                    uint32_t _version,
+                                    ozz::vector<uint32_t>* _sizes) {
+  // Destroy animation in case it was already used before.
+  duration_ = 0.f;
+  num_tracks_ = 0;
+  name_.clear();
+  ratios_.clear();
+  segments_.clear();
+  _sizes->clear();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported SegmentedAnimation version " << _version << "."
+               << std::endl;
+    return false;
+  }
+
+  _archive >> duration_;
+  int32_t num_tracks;
+  _archive >> num_tracks;
+  num_tracks_ = num_tracks;
+  _archive >> name_;
+  _archive >> ratios_;
+
+  int32_t num_segments;
+  _archive >> num_segments;
+  if (num_segments < 0 || ratios_.size() != static_cast<size_t>(num_segments) +
+                                                (num_segments > 0 ? 1 : 0)) {
+    log::Err() << "Invalid SegmentedAnimation segments table." << std::endl;
+    duration_ = 0.f;
+    num_tracks_ = 0;
+    ratios_.clear();
+    return false;
+  }
+  _sizes->resize(num_segments);
+  for (uint32_t& size : *_sizes) {
+    _archive >> size;
+  }
+
+  // Segments are allocated empty, they're loaded afterwards.
+  segments_.resize(num_segments);
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
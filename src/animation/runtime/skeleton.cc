@@ -35,18 +35,58 @@
 #include "ozz/base/maths/soa_math_archive.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
 
 namespace ozz {
 namespace animation {
 
-Skeleton::Skeleton() {}
+namespace {
+// 32 bits FNV-1a hash constants.
+const uint32_t kNameHashBasis = 2166136261u;
+const uint32_t kNameHashPrime = 16777619u;
 
-Skeleton::Skeleton(Skeleton&& _other) { *this = std::move(_other); }
+inline uint32_t HashNameChar(uint32_t _hash, char _c) {
+  return (_hash ^ static_cast<uint8_t>(_c)) * kNameHashPrime;
+}
+
+// Names table size is the power of 2 that's at least twice the number of
+// joints, so that probing always ends on an empty slot.
+size_t NameTableSize(size_t _num_joints) {
+  size_t size = 1;
+  while (size < _num_joints * 2) {
+    size <<= 1;
+  }
+  return size;
+}
+
+// Size of topology tables, see Skeleton::FillTopology().
+size_t TopologySize(size_t _num_joints) {
+  return (_num_joints * 4 + 2) * sizeof(int16_t);
+}
+}  // namespace
+
+Skeleton::Skeleton(memory::Allocator* _allocator, NameStorage _name_storage)
+    : name_storage_(_name_storage),
+      allocator_(_allocator),
+      allocation_(nullptr) {}
+
+Skeleton::Skeleton(Skeleton&& _other) : Skeleton() {
+  *this = std::move(_other);
+}
 
 Skeleton& Skeleton::operator=(Skeleton&& _other) {
   std::swap(joint_rest_poses_, _other.joint_rest_poses_);
   std::swap(joint_parents_, _other.joint_parents_);
+  std::swap(joint_children_, _other.joint_children_);
+  std::swap(joint_children_offsets_, _other.joint_children_offsets_);
+  std::swap(joint_subtree_ends_, _other.joint_subtree_ends_);
+  std::swap(joint_depths_, _other.joint_depths_);
   std::swap(joint_names_, _other.joint_names_);
+  std::swap(joint_name_hashes_, _other.joint_name_hashes_);
+  std::swap(joint_name_table_, _other.joint_name_table_);
+  std::swap(name_storage_, _other.name_storage_);
+  std::swap(allocator_, _other.allocator_);
+  std::swap(allocation_, _other.allocation_);
 
   return *this;
 }
@@ -57,12 +97,13 @@ char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
   // Distributes buffer memory while ensuring proper alignment (serves larger
   // alignment values first).
   static_assert(alignof(math::SoaTransform) >= alignof(char*) &&
-                    alignof(char*) >= alignof(int16_t) &&
+                    alignof(char*) >= alignof(uint32_t) &&
+                    alignof(uint32_t) >= alignof(int16_t) &&
                     alignof(int16_t) >= alignof(char),
                 "Must serve larger alignment values first)");
 
   assert(joint_rest_poses_.size() == 0 && joint_names_.size() == 0 &&
-         joint_parents_.size() == 0);
+         joint_name_hashes_.size() == 0 && joint_parents_.size() == 0);
 
   // Early out if no joint.
   if (_num_joints == 0) {
@@ -73,38 +114,321 @@ char* Skeleton::Allocate(size_t _chars_size, size_t _num_joints) {
   const size_t num_soa_joints = (_num_joints + 3) / 4;
   const size_t joint_rest_poses_size =
       num_soa_joints * sizeof(math::SoaTransform);
-  const size_t names_size = _num_joints * sizeof(char*);
   const size_t joint_parents_size = _num_joints * sizeof(int16_t);
-  const size_t buffer_size =
-      names_size + _chars_size + joint_parents_size + joint_rest_poses_size;
 
+  // Names strings are only allocated if they're stored.
+  const bool strings = name_storage_ == kNameStrings;
+  const size_t num_names = strings ? _num_joints : 0;
+  const size_t chars_size = strings ? _chars_size : 0;
+  const size_t names_size = num_names * sizeof(char*);
+  const size_t hashes_size = _num_joints * sizeof(uint32_t);
+  const size_t table_count = NameTableSize(_num_joints);
+  const size_t table_size = table_count * sizeof(int16_t);
+  const size_t topology_size = TopologySize(_num_joints);
+  const size_t buffer_size = names_size + chars_size + hashes_size +
+                             joint_parents_size + table_size + topology_size +
+                             joint_rest_poses_size;
+
+  const memory::TagScope memory_tag(memory::kTagSkeleton);
   // Allocates whole buffer.
-  span<byte> buffer = {static_cast<byte*>(memory::default_allocator()->Allocate(
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  span<byte> buffer = {static_cast<byte*>(allocator->Allocate(
                            buffer_size, alignof(math::SoaTransform))),
                        buffer_size};
+  allocation_ = buffer.data();
 
   // Serves larger alignment values first.
   // Rest pose first, biggest alignment.
   joint_rest_poses_ = fill_span<math::SoaTransform>(buffer, num_soa_joints);
 
   // Then names array, second biggest alignment.
-  joint_names_ = fill_span<char*>(buffer, _num_joints);
+  joint_names_ = fill_span<char*>(buffer, num_names);
 
-  // Parents, third biggest alignment.
+  // Names hashes.
+  joint_name_hashes_ = fill_span<uint32_t>(buffer, _num_joints);
+
+  // Parents, names table and topology, third biggest alignment.
   joint_parents_ = fill_span<int16_t>(buffer, _num_joints);
+  joint_name_table_ = fill_span<int16_t>(buffer, table_count);
+  FillTopology(&buffer, _num_joints);
 
   // Remaning buffer will be used to store joint names.
-  assert(buffer.size_bytes() == _chars_size &&
+  assert(buffer.size_bytes() == chars_size &&
          "Whole buffer should be consumned");
-  return reinterpret_cast<char*>(buffer.data());
+  return strings ? reinterpret_cast<char*>(buffer.data()) : nullptr;
 }
 
 void Skeleton::Deallocate() {
-  memory::default_allocator()->Deallocate(
-      as_writable_bytes(joint_rest_poses_).data());
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  allocator->Deallocate(allocation_);
+  allocation_ = nullptr;
   joint_rest_poses_ = {};
   joint_names_ = {};
+  joint_name_hashes_ = {};
+  joint_name_table_ = {};
   joint_parents_ = {};
+  joint_children_ = {};
+  joint_children_offsets_ = {};
+  joint_subtree_ends_ = {};
+  joint_depths_ = {};
+}
+
+void Skeleton::FillTopology(span<byte>* _buffer, size_t _num_joints) {
+  joint_children_ = fill_span<int16_t>(*_buffer, _num_joints);
+  joint_children_offsets_ = fill_span<int16_t>(*_buffer, _num_joints + 2);
+  joint_subtree_ends_ = fill_span<int16_t>(*_buffer, _num_joints);
+  joint_depths_ = fill_span<int16_t>(*_buffer, _num_joints);
+}
+
+bool Skeleton::BuildTopology() {
+  // Parents are always stored before their children, whatever the ordering,
+  // so every table is filled with a single pass.
+  const int num_joints = this->num_joints();
+  if (num_joints == 0) {
+    return true;
+  }
+
+  // Counts children of every joint, offset by one so that roots come first.
+  for (int16_t& offset : joint_children_offsets_) {
+    offset = 0;
+  }
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = joint_parents_[i];
+    if (parent < kNoParent || parent >= i) {
+      return false;
+    }
+    ++joint_children_offsets_[parent + 2];
+  }
+  for (int i = 2; i < num_joints + 2; ++i) {
+    joint_children_offsets_[i] += joint_children_offsets_[i - 1];
+  }
+
+  // Fills children in increasing order, using offsets j + 1 as cursors. They
+  // end up shifted to the next parent, which restores them.
+  for (int i = 0; i < num_joints; ++i) {
+    int16_t& cursor = joint_children_offsets_[joint_parents_[i] + 1];
+    joint_children_[cursor++] = static_cast<int16_t>(i);
+  }
+  for (int i = num_joints + 1; i > 0; --i) {
+    joint_children_offsets_[i] = joint_children_offsets_[i - 1];
+  }
+  joint_children_offsets_[0] = 0;
+
+  // Depths are propagated from parents, sub-hierarchy sizes from children.
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = joint_parents_[i];
+    joint_depths_[i] = parent == kNoParent
+                           ? 0
+                           : static_cast<int16_t>(joint_depths_[parent] + 1);
+    joint_subtree_ends_[i] = 1;
+  }
+  for (int i = num_joints - 1; i >= 0; --i) {
+    const int parent = joint_parents_[i];
+    if (parent != kNoParent) {
+      joint_subtree_ends_[parent] += joint_subtree_ends_[i];
+    }
+    joint_subtree_ends_[i] += static_cast<int16_t>(i);
+  }
+  return true;
+}
+
+void Skeleton::BuildNameTable() {
+  // Joints are inserted in order, so that the first joint matching a hash is
+  // the first found while probing.
+  const size_t mask = joint_name_table_.size() - 1;
+  for (int16_t& slot : joint_name_table_) {
+    slot = -1;
+  }
+  for (size_t i = 0; i < joint_name_hashes_.size(); ++i) {
+    size_t slot = joint_name_hashes_[i] & mask;
+    while (joint_name_table_[slot] != -1) {
+      slot = (slot + 1) & mask;
+    }
+    joint_name_table_[slot] = static_cast<int16_t>(i);
+  }
+}
+
+uint32_t Skeleton::HashName(const char* _name) {
+  uint32_t hash = kNameHashBasis;
+  for (; *_name; ++_name) {
+    hash = HashNameChar(hash, *_name);
+  }
+  return hash;
+}
+
+int Skeleton::FindJointByHash(uint32_t _hash, const char* _name) const {
+  if (joint_name_table_.empty()) {
+    return -1;
+  }
+  const bool compare = _name && !joint_names_.empty();
+  const size_t mask = joint_name_table_.size() - 1;
+  for (size_t slot = _hash & mask;; slot = (slot + 1) & mask) {
+    const int joint = joint_name_table_[slot];
+    if (joint == -1) {
+      return -1;
+    }
+    if (joint_name_hashes_[joint] == _hash &&
+        (!compare || std::strcmp(joint_names_[joint], _name) == 0)) {
+      return joint;
+    }
+  }
+}
+
+namespace {
+// Header of skeleton images, followed by rest poses, parents and names
+// characters.
+struct alignas(Skeleton::kImageAlignment) SkeletonImageHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size;
+  int32_t num_joints;
+  uint32_t chars_size;
+};
+
+// "ozzs" characters, in native endianness.
+const uint32_t kSkeletonImageMagic = 0x737a7a6f;
+
+size_t SkeletonImageSize(size_t _num_joints, size_t _chars_size) {
+  const size_t num_soa_joints = (_num_joints + 3) / 4;
+  return sizeof(SkeletonImageHeader) +
+         num_soa_joints * sizeof(math::SoaTransform) +
+         _num_joints * sizeof(int16_t) + _chars_size;
+}
+}  // namespace
+
+size_t Skeleton::image_size() const {
+  // Skeletons storing name hashes only are imaged with empty names.
+  size_t chars_size = joint_names_.empty() ? joint_parents_.size() : 0;
+  for (const char* name : joint_names_) {
+    chars_size += std::strlen(name) + 1;
+  }
+  return SkeletonImageSize(joint_parents_.size(), chars_size);
+}
+
+bool Skeleton::ToImage(span<byte> _image) const {
+  const size_t size = image_size();
+  if (!IsAligned(_image.data(), kImageAlignment) ||
+      _image.size_bytes() < size) {
+    return false;
+  }
+
+  SkeletonImageHeader header = {};
+  header.magic = kSkeletonImageMagic;
+  header.version = io::internal::Version<const Skeleton>::kValue;
+  header.size = static_cast<uint32_t>(size);
+  header.num_joints = num_joints();
+  header.chars_size = static_cast<uint32_t>(
+      size - SkeletonImageSize(joint_parents_.size(), 0));
+
+  byte* cursor = _image.data();
+  std::memcpy(cursor, &header, sizeof(header));
+  cursor += sizeof(header);
+  if (joint_rest_poses_.size_bytes() != 0) {
+    std::memcpy(cursor, joint_rest_poses_.data(),
+                joint_rest_poses_.size_bytes());
+    cursor += joint_rest_poses_.size_bytes();
+  }
+  if (joint_parents_.size_bytes() != 0) {
+    std::memcpy(cursor, joint_parents_.data(), joint_parents_.size_bytes());
+    cursor += joint_parents_.size_bytes();
+  }
+  if (joint_names_.empty()) {
+    std::memset(cursor, 0, joint_parents_.size());
+  }
+  for (const char* name : joint_names_) {
+    const size_t len = std::strlen(name) + 1;
+    std::memcpy(cursor, name, len);
+    cursor += len;
+  }
+  return true;
+}
+
+bool Skeleton::FromImage(span<const byte> _image) {
+  // Deallocate skeleton in case it was already used before.
+  Deallocate();
+
+  SkeletonImageHeader header;
+  if (!IsAligned(_image.data(), kImageAlignment) ||
+      _image.size_bytes() < sizeof(header)) {
+    log::Err() << "Invalid Skeleton image buffer." << std::endl;
+    return false;
+  }
+  std::memcpy(&header, _image.data(), sizeof(header));
+  if (header.magic != kSkeletonImageMagic) {
+    log::Err() << "Invalid Skeleton image, or image endianness doesn't match "
+                  "platform."
+               << std::endl;
+    return false;
+  }
+  if (header.version != io::internal::Version<const Skeleton>::kValue) {
+    log::Err() << "Unsupported Skeleton image version " << header.version
+               << "." << std::endl;
+    return false;
+  }
+  if (header.num_joints < 0 || header.num_joints > kMaxJoints ||
+      header.size != SkeletonImageSize(header.num_joints, header.chars_size) ||
+      _image.size_bytes() < header.size) {
+    log::Err() << "Invalid Skeleton image size." << std::endl;
+    return false;
+  }
+
+  // Early out if no joint.
+  if (header.num_joints == 0) {
+    return true;
+  }
+
+  // Skeleton data are never written once built, so they can point to the
+  // read-only image.
+  const size_t num_joints = header.num_joints;
+  span<byte> buffer = {const_cast<byte*>(_image.data()) + sizeof(header),
+                       header.size - sizeof(header)};
+  joint_rest_poses_ =
+      fill_span<math::SoaTransform>(buffer, (num_joints + 3) / 4);
+  joint_parents_ = fill_span<int16_t>(buffer, num_joints);
+  span<char> chars = fill_span<char>(buffer, header.chars_size);
+
+  // Names array requires pointers fix up, and names hashes, table and
+  // topology aren't part of the image, so they're allocated.
+  const memory::TagScope memory_tag(memory::kTagSkeleton);
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  const size_t num_names = name_storage_ == kNameStrings ? num_joints : 0;
+  const size_t table_count = NameTableSize(num_joints);
+  const size_t allocation_size =
+      num_names * sizeof(char*) + num_joints * sizeof(uint32_t) +
+      table_count * sizeof(int16_t) + TopologySize(num_joints);
+  span<byte> allocation = {static_cast<byte*>(allocator->Allocate(
+                               allocation_size, alignof(char*))),
+                           allocation_size};
+  allocation_ = allocation.data();
+  joint_names_ = fill_span<char*>(allocation, num_names);
+  joint_name_hashes_ = fill_span<uint32_t>(allocation, num_joints);
+  joint_name_table_ = fill_span<int16_t>(allocation, table_count);
+  FillTopology(&allocation, num_joints);
+
+  char* name = chars.begin();
+  for (size_t i = 0; i < num_joints; ++i) {
+    char* end = static_cast<char*>(std::memchr(name, 0, chars.end() - name));
+    if (!end) {
+      log::Err() << "Invalid Skeleton image joint names." << std::endl;
+      Deallocate();
+      return false;
+    }
+    if (num_names) {
+      joint_names_[i] = name;
+    }
+    joint_name_hashes_[i] = HashName(name);
+    name = end + 1;
+  }
+  BuildNameTable();
+  if (!BuildTopology()) {
+    log::Err() << "Invalid Skeleton image joint parents." << std::endl;
+    Deallocate();
+    return false;
+  }
+  return true;
 }
 
 void Skeleton::Save(ozz::io::OArchive& _archive) const {
@@ -117,13 +441,20 @@ void Skeleton::Save(ozz::io::OArchive& _archive) const {
   }
 
   // Stores names. They are all concatenated in the same buffer, starting at
-  // joint_names_[0].
-  size_t chars_count = 0;
-  for (int i = 0; i < num_joints; ++i) {
-    chars_count += (std::strlen(joint_names_[i]) + 1) * sizeof(char);
+  // joint_names_[0]. Skeletons storing name hashes only save empty names.
+  if (joint_names_.empty()) {
+    _archive << num_joints;
+    for (int i = 0; i < num_joints; ++i) {
+      _archive << '\0';
+    }
+  } else {
+    size_t chars_count = 0;
+    for (int i = 0; i < num_joints; ++i) {
+      chars_count += (std::strlen(joint_names_[i]) + 1) * sizeof(char);
+    }
+    _archive << static_cast<int32_t>(chars_count);
+    _archive << ozz::io::MakeArray(joint_names_[0], chars_count);
   }
-  _archive << static_cast<int32_t>(chars_count);
-  _archive << ozz::io::MakeArray(joint_names_[0], chars_count);
   _archive << ozz::io::MakeArray(joint_parents_);
   _archive << ozz::io::MakeArray(joint_rest_poses_);
 }
@@ -153,20 +484,54 @@ void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   // Allocates all skeleton data members.
   char* cursor = Allocate(chars_count, num_joints);
 
-  // Reads name's buffer, they are all contiguous in the same buffer.
-  _archive >> ozz::io::MakeArray(cursor, chars_count);
+  if (cursor) {
+    // Reads name's buffer, they are all contiguous in the same buffer.
+    _archive >> ozz::io::MakeArray(cursor, chars_count);
 
-  // Fixes up array of pointers. Stops at num_joints - 1, so that it doesn't
-  // read memory past the end of the buffer.
-  for (int i = 0; i < num_joints - 1; ++i) {
-    joint_names_[i] = cursor;
-    cursor += std::strlen(joint_names_[i]) + 1;
+    // Fixes up array of pointers. Stops at num_joints - 1, so that it doesn't
+    // read memory past the end of the buffer.
+    for (int i = 0; i < num_joints - 1; ++i) {
+      joint_names_[i] = cursor;
+      cursor += std::strlen(joint_names_[i]) + 1;
+    }
+    // num_joints is > 0, as this was tested at the beginning of the function.
+    joint_names_[num_joints - 1] = cursor;
+
+    for (int i = 0; i < num_joints; ++i) {
+      joint_name_hashes_[i] = HashName(joint_names_[i]);
+    }
+  } else {
+    // Names strings aren't stored, so they're hashed while being read by
+    // chunks.
+    for (uint32_t& hash : joint_name_hashes_) {
+      hash = kNameHashBasis;
+    }
+    char chunk[256];
+    uint32_t hash = kNameHashBasis;
+    int joint = 0;
+    for (int32_t read = 0; read < chars_count;) {
+      const int32_t count =
+          math::Min(chars_count - read, static_cast<int32_t>(sizeof(chunk)));
+      _archive >> ozz::io::MakeArray(chunk, count);
+      for (int32_t i = 0; i < count; ++i) {
+        if (chunk[i] != 0) {
+          hash = HashNameChar(hash, chunk[i]);
+        } else if (joint < num_joints) {
+          joint_name_hashes_[joint++] = hash;
+          hash = kNameHashBasis;
+        }
+      }
+      read += count;
+    }
   }
-  // num_joints is > 0, as this was tested at the beginning of the function.
-  joint_names_[num_joints - 1] = cursor;
+  BuildNameTable();
 
   _archive >> ozz::io::MakeArray(joint_parents_);
   _archive >> ozz::io::MakeArray(joint_rest_poses_);
+  if (!BuildTopology()) {
+    log::Err() << "Invalid Skeleton joint parents." << std::endl;
+    Deallocate();
+  }
 }
 }  // namespace animation
 }  // namespace ozz
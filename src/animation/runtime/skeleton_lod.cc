@@ -0,0 +1,154 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/skeleton_lod.h"
+
+#include <cassert>
+#include <utility>
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/vector_archive.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/memory/scratch_buffer.h"
+
+namespace ozz {
+namespace animation {
+
+SkeletonLOD::SkeletonLOD() : num_active_joints_(0) {}
+
+SkeletonLOD::SkeletonLOD(SkeletonLOD&& _other) : num_active_joints_(0) {
+  *this = std::move(_other);
+}
+
+SkeletonLOD& SkeletonLOD::operator=(SkeletonLOD&& _other) {
+  std::swap(num_active_joints_, _other.num_active_joints_);
+  std::swap(joints_mask_, _other.joints_mask_);
+  std::swap(soa_mask_, _other.soa_mask_);
+  std::swap(joint_remaps_, _other.joint_remaps_);
+  return *this;
+}
+
+SkeletonLOD::~SkeletonLOD() {}
+
+bool SkeletonLOD::IsActive(int _joint) const {
+  assert(_joint >= 0 && _joint < num_joints() && "_joint index out of range");
+  return joint_remaps_[_joint] == _joint;
+}
+
+void SkeletonLOD::BuildMasks() {
+  const int num_joints = this->num_joints();
+  const int num_soa_joints = (num_joints + 3) / 4;
+  joints_mask_.assign((num_joints + 7) / 8, 0);
+  soa_mask_.assign((num_soa_joints + 7) / 8, 0);
+  num_active_joints_ = 0;
+  for (int i = 0; i < num_joints; ++i) {
+    if (joint_remaps_[i] == i) {
+      joints_mask_[i / 8] |= 1 << (i & 7);
+      soa_mask_[i / 32] |= 1 << ((i / 4) & 7);
+      ++num_active_joints_;
+    }
+  }
+}
+
+bool SkeletonLOD::RemapPalette(const Skeleton& _skeleton,
+                               span<const uint16_t> _palette_joints,
+                               span<uint16_t> _palette_remaps) const {
+  const int num_joints = this->num_joints();
+  if (_skeleton.num_joints() != num_joints ||
+      _palette_remaps.size() < _palette_joints.size()) {
+    return false;
+  }
+
+  // Palette entry of every skeleton joint, -1 if joint isn't in the palette.
+  memory::ScratchBuffer<int, Skeleton::kMaxInlineJoints> palette_entries(
+      num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    palette_entries[i] = -1;
+  }
+  for (size_t i = 0; i < _palette_joints.size(); ++i) {
+    const int joint = _palette_joints[i];
+    if (joint >= num_joints) {
+      return false;
+    }
+    palette_entries[joint] = static_cast<int>(i);
+  }
+
+  // Walks up active ancestors until one is found in the palette. Active
+  // joints ancestors are all active.
+  const span<const int16_t> parents = _skeleton.joint_parents();
+  for (size_t i = 0; i < _palette_joints.size(); ++i) {
+    _palette_remaps[i] = static_cast<uint16_t>(i);
+    const int joint = _palette_joints[i];
+    if (joint_remaps_[joint] == joint) {
+      continue;
+    }
+    for (int ancestor = joint_remaps_[joint]; ancestor != Skeleton::kNoParent;
+         ancestor = parents[ancestor]) {
+      if (palette_entries[ancestor] != -1) {
+        _palette_remaps[i] = static_cast<uint16_t>(palette_entries[ancestor]);
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+void SkeletonLOD::Save(ozz::io::OArchive& _archive) const {
+  _archive << joint_remaps_;
+}
+
+void SkeletonLOD::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Resets level of detail in case it was already used before.
+  num_active_joints_ = 0;
+  joints_mask_.clear();
+  soa_mask_.clear();
+  joint_remaps_.clear();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported SkeletonLOD version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  _archive >> joint_remaps_;
+
+  // Rejects remaps that don't point to an active joint.
+  const int num_joints = this->num_joints();
+  for (int i = 0; i < num_joints; ++i) {
+    const int remap = joint_remaps_[i];
+    if (remap != Skeleton::kNoParent &&
+        (remap < 0 || remap > i || joint_remaps_[remap] != remap)) {
+      log::Err() << "Invalid SkeletonLOD joint remaps." << std::endl;
+      joint_remaps_.clear();
+      return;
+    }
+  }
+  BuildMasks();
+}
+}  // namespace animation
+}  // namespace ozz
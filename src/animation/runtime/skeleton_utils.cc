@@ -29,21 +29,14 @@
 
 #include <assert.h>
 
-#include <cstring>
-
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/scratch_buffer.h"
 
 namespace ozz {
 namespace animation {
 
 int FindJoint(const Skeleton& _skeleton, const char* _name) {
-  const auto& names = _skeleton.joint_names();
-  for (size_t i = 0; i < names.size(); ++i) {
-    if (std::strcmp(names[i], _name) == 0) {
-      return static_cast<int>(i);
-    }
-  }
-  return -1;
+  return _skeleton.FindJointByHash(Skeleton::HashName(_name), _name);
 }
 
 // Unpacks skeleton rest pose stored in soa format by the skeleton.
@@ -72,5 +65,26 @@ ozz::math::Transform GetJointLocalRestPose(const Skeleton& _skeleton,
 
   return rest_pose;
 }
+
+bool IsDepthFirst(const Skeleton& _skeleton) {
+  const span<const int16_t>& parents = _skeleton.joint_parents();
+  const int num_joints = _skeleton.num_joints();
+
+  // Joints are depth-first if every joint parent is on the path from the root
+  // to the previous joint. This path is kept as a stack.
+  memory::ScratchBuffer<int16_t, Skeleton::kMaxInlineJoints> path(num_joints);
+  int depth = 0;
+  for (int i = 0; i < num_joints; ++i) {
+    const int parent = parents[i];
+    while (depth > 0 && path[depth - 1] != parent) {
+      --depth;
+    }
+    if (depth == 0 && parent != Skeleton::kNoParent) {
+      return false;
+    }
+    path[depth++] = static_cast<int16_t>(i);
+  }
+  return true;
+}
 }  // namespace animation
 }  // namespace ozz
@@ -0,0 +1,370 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/spring_bone_job.h"
+
+#include <cassert>
+#include <new>
+
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+// SoaTransform and SoaFloat4x4 are accessed as consecutive SimdFloat4 to
+// gather and scatter lanes.
+static_assert(sizeof(math::SoaTransform) == 10 * sizeof(math::SimdFloat4),
+              "Unexpected SoaTransform layout");
+static_assert(sizeof(math::SoaFloat4x4) == 16 * sizeof(math::SimdFloat4),
+              "Unexpected SoaFloat4x4 layout");
+
+struct SpringBoneJob::Context::Slot {
+  // Particles current and previous positions, in model-space.
+  math::SoaFloat3 position;
+  math::SoaFloat3 previous;
+
+  // Per joint settings.
+  math::SimdFloat4 stiffness;
+  math::SimdFloat4 damping;
+
+  // Simulated joints, and their parents, -1 for masked lanes.
+  int16_t joints[4];
+  int16_t parents[4];
+};
+
+namespace {
+// Gathers _joint local transform to lane _lane of _out, or identity if _joint
+// is -1.
+void GatherLocal(span<const math::SoaTransform> _locals, int _joint,
+                 int _lane, math::SoaTransform* _out) {
+  float* out = reinterpret_cast<float*>(_out);
+  if (_joint < 0) {
+    static const float kIdentity[10] = {0.f, 0.f, 0.f, 0.f, 0.f,
+                                        0.f, 1.f, 1.f, 1.f, 1.f};
+    for (int k = 0; k < 10; ++k) {
+      out[k * 4 + _lane] = kIdentity[k];
+    }
+    return;
+  }
+  const float* in = reinterpret_cast<const float*>(&_locals[_joint / 4]);
+  const int lane = _joint & 3;
+  for (int k = 0; k < 10; ++k) {
+    out[k * 4 + _lane] = in[k * 4 + lane];
+  }
+}
+
+// Gathers _joint model matrix to lane _lane of _out, or identity if _joint is
+// -1.
+void GatherModel(span<const math::Float4x4> _models, int _joint, int _lane,
+                 math::SoaFloat4x4* _out) {
+  float* out = reinterpret_cast<float*>(_out);
+  for (int k = 0; k < 16; ++k) {
+    out[k * 4 + _lane] = k % 5 == 0 ? 1.f : 0.f;
+  }
+  if (_joint >= 0) {
+    for (int c = 0; c < 4; ++c) {
+      float col[4];
+      math::StorePtrU(_models[_joint].cols[c], col);
+      for (int r = 0; r < 4; ++r) {
+        out[(c * 4 + r) * 4 + _lane] = col[r];
+      }
+    }
+  }
+}
+
+// Scatters lane _lane rotation of _in to _joint local transform.
+void ScatterRotation(const math::SoaQuaternion& _in, int _lane, int _joint,
+                     span<math::SoaTransform> _locals) {
+  const float* in = reinterpret_cast<const float*>(&_in);
+  float* out = reinterpret_cast<float*>(&_locals[_joint / 4].rotation);
+  const int lane = _joint & 3;
+  for (int k = 0; k < 4; ++k) {
+    out[k * 4 + lane] = in[k * 4 + _lane];
+  }
+}
+
+// Transforms point _p by _m.
+math::SoaFloat3 TransformPoint(const math::SoaFloat4x4& _m,
+                               const math::SoaFloat3& _p) {
+  const math::SoaFloat4 p = _m * math::SoaFloat4::Load(
+                                     _p, math::simd_float4::one());
+  return math::SoaFloat3::Load(p.x, p.y, p.z);
+}
+
+// Transforms vector _v by the transpose of _m 3x3 part.
+math::SoaFloat3 TransformTransposed(const math::SoaFloat4x4& _m,
+                                    const math::SoaFloat3& _v) {
+  return math::SoaFloat3::Load(
+      math::Dot(math::SoaFloat3::Load(_m.cols[0].x, _m.cols[0].y,
+                                      _m.cols[0].z),
+                _v),
+      math::Dot(math::SoaFloat3::Load(_m.cols[1].x, _m.cols[1].y,
+                                      _m.cols[1].z),
+                _v),
+      math::Dot(math::SoaFloat3::Load(_m.cols[2].x, _m.cols[2].y,
+                                      _m.cols[2].z),
+                _v));
+}
+
+// Computes the shortest arc rotation from _from to _to directions, which
+// don't need to be normalized. Identity is returned for degenerated
+// (null or opposed) vectors.
+math::SoaQuaternion FromVectors(const math::SoaFloat3& _from,
+                                const math::SoaFloat3& _to) {
+  const math::SimdFloat4 norms =
+      math::Sqrt(math::LengthSqr(_from) * math::LengthSqr(_to));
+  const math::SoaFloat3 axis = math::Cross(_from, _to);
+  const math::SoaQuaternion q = {axis.x, axis.y, axis.z,
+                                 norms + math::Dot(_from, _to)};
+  const math::SimdFloat4 len2 = math::Dot(q, q);
+  const math::SimdInt4 valid =
+      math::CmpGt(len2, norms * norms * math::simd_float4::Load1(1e-8f));
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 inv_len =
+      one / math::Sqrt(math::Select(valid, len2, one));
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SoaQuaternion identity = math::SoaQuaternion::identity();
+  const math::SoaQuaternion result = {
+      math::Select(valid, q.x * inv_len, zero),
+      math::Select(valid, q.y * inv_len, zero),
+      math::Select(valid, q.z * inv_len, zero),
+      math::Select(valid, q.w * inv_len, identity.w)};
+  return result;
+}
+}  // namespace
+
+SpringBoneJob::Context::Context()
+    : slots_(nullptr),
+      num_slots_(0),
+      num_chains_(0),
+      num_joints_(0),
+      reset_(true) {}
+
+SpringBoneJob::Context::~Context() { Clear(); }
+
+void SpringBoneJob::Context::Clear() {
+  memory::default_allocator()->Deallocate(slots_);
+  slots_ = nullptr;
+  num_slots_ = 0;
+  groups_.clear();
+  dirty_.clear();
+  num_chains_ = 0;
+  num_joints_ = 0;
+  reset_ = true;
+}
+
+bool SpringBoneJob::Context::Setup(const Skeleton& _skeleton,
+                                   span<const Chain> _chains,
+                                   span<const float> _stiffness,
+                                   span<const float> _damping) {
+  Clear();
+
+  const int num_joints = _skeleton.num_joints();
+  if (_stiffness.size() < static_cast<size_t>(num_joints) ||
+      _damping.size() < static_cast<size_t>(num_joints)) {
+    return false;
+  }
+
+  // Validates chains and computes their length, aka the number of simulated
+  // joints.
+  const span<const int16_t> parents = _skeleton.joint_parents();
+  const int num_chains = static_cast<int>(_chains.size());
+  ozz::vector<int> lengths(num_chains);
+  for (int i = 0; i < num_chains; ++i) {
+    const Chain& chain = _chains[i];
+    if (chain.root < 0 || chain.root >= num_joints || chain.tip < 0 ||
+        chain.tip >= num_joints) {
+      return false;
+    }
+    int length = 0;
+    int joint = chain.tip;
+    for (; joint != chain.root && joint != Skeleton::kNoParent;
+         joint = parents[joint]) {
+      ++length;
+    }
+    if (joint != chain.root || length == 0) {
+      return false;
+    }
+    lengths[i] = length;
+  }
+
+  // Layouts groups of 4 chains, each group having as many slots as its longest
+  // chain.
+  const int num_groups = (num_chains + 3) / 4;
+  groups_.resize(num_groups + 1);
+  groups_[0] = 0;
+  for (int g = 0; g < num_groups; ++g) {
+    int longest = 0;
+    for (int c = g * 4; c < math::Min(g * 4 + 4, num_chains); ++c) {
+      longest = math::Max(longest, lengths[c]);
+    }
+    groups_[g + 1] = groups_[g] + longest;
+  }
+  num_slots_ = groups_[num_groups];
+  slots_ = static_cast<Slot*>(memory::default_allocator()->Allocate(
+      sizeof(Slot) * num_slots_, alignof(Slot)));
+
+  // Fills slots, walking chains from tip to root.
+  for (int s = 0; s < num_slots_; ++s) {
+    Slot* slot = new (slots_ + s) Slot;
+    slot->position = math::SoaFloat3::zero();
+    slot->previous = math::SoaFloat3::zero();
+    slot->stiffness = math::simd_float4::zero();
+    slot->damping = math::simd_float4::zero();
+    for (int l = 0; l < 4; ++l) {
+      slot->joints[l] = -1;
+      slot->parents[l] = -1;
+    }
+  }
+  dirty_.assign((num_joints + 7) / 8, 0);
+  for (int c = 0; c < num_chains; ++c) {
+    const int group = c / 4;
+    const int lane = c & 3;
+    const Chain& chain = _chains[c];
+    dirty_[chain.root / 8] |= 1 << (chain.root & 7);
+    int joint = chain.tip;
+    for (int depth = lengths[c] - 1; depth >= 0; --depth) {
+      Slot& slot = slots_[groups_[group] + depth];
+      float* stiffness = reinterpret_cast<float*>(&slot.stiffness);
+      float* damping = reinterpret_cast<float*>(&slot.damping);
+      stiffness[lane] = math::Clamp(0.f, _stiffness[joint], 1.f);
+      damping[lane] = math::Clamp(0.f, _damping[joint], 1.f);
+      slot.joints[lane] = static_cast<int16_t>(joint);
+      slot.parents[lane] = parents[joint];
+      joint = parents[joint];
+    }
+  }
+
+  num_chains_ = num_chains;
+  num_joints_ = num_joints;
+  return true;
+}
+
+SpringBoneJob::SpringBoneJob()
+    : context(nullptr), dt(0.f), gravity(math::Float3::zero()) {}
+
+bool SpringBoneJob::Validate() const {
+  if (!context || context->num_joints_ == 0) {
+    return false;
+  }
+  bool valid = true;
+
+  const size_t num_joints = context->num_joints_;
+  valid &= models.size() >= num_joints;
+  valid &= locals.size() >= (num_joints + 3) / 4;
+  valid &= dt >= 0.f;
+
+  return valid;
+}
+
+bool SpringBoneJob::Run() const {
+  OZZ_PROFILE_ZONE("SpringBoneJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const math::SimdFloat4 dt2 = math::simd_float4::Load1(dt * dt);
+  const math::SoaFloat3 acceleration = {
+      math::simd_float4::Load1(gravity.x) * dt2,
+      math::simd_float4::Load1(gravity.y) * dt2,
+      math::simd_float4::Load1(gravity.z) * dt2};
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 epsilon = math::simd_float4::Load1(1e-6f);
+  const bool reset = context->reset_;
+  context->reset_ = false;
+
+  const int num_groups = static_cast<int>(context->groups_.size()) - 1;
+  for (int g = 0; g < num_groups; ++g) {
+    Context::Slot* slot = context->slots_ + context->groups_[g];
+    Context::Slot* const end = context->slots_ + context->groups_[g + 1];
+
+    // Chains roots frames and local transforms.
+    math::SoaFloat4x4 parent;
+    math::SoaTransform parent_local;
+    for (int l = 0; l < 4; ++l) {
+      GatherModel(models, slot->parents[l], l, &parent);
+      GatherLocal(locals, slot->parents[l], l, &parent_local);
+    }
+
+    for (; slot < end; ++slot) {
+      math::SoaTransform local;
+      for (int l = 0; l < 4; ++l) {
+        GatherLocal(locals, slot->joints[l], l, &local);
+      }
+
+      // Integrates particles toward animated positions.
+      const math::SoaFloat3 target = TransformPoint(parent, local.translation);
+      if (reset) {
+        slot->position = target;
+        slot->previous = target;
+      }
+      const math::SoaFloat3 velocity =
+          (slot->position - slot->previous) * (one - slot->damping);
+      slot->previous = slot->position;
+      math::SoaFloat3 position = slot->position + velocity + acceleration;
+      position = position + (target - position) * slot->stiffness;
+
+      // Constrains bone length.
+      const math::SoaFloat3 origin =
+          math::SoaFloat3::Load(parent.cols[3].x, parent.cols[3].y,
+                                parent.cols[3].z);
+      const math::SoaFloat3 dir = position - origin;
+      const math::SimdFloat4 rest = math::Length(target - origin);
+      const math::SimdFloat4 len = math::Max(math::Length(dir), epsilon);
+      position = origin + dir * (rest / len);
+      slot->position = position;
+
+      // Rotates parent so that its child points to the particle. Parent space
+      // direction is obtained with the transposed model matrix, as scale is
+      // uniform.
+      const math::SoaQuaternion delta = FromVectors(
+          local.translation, TransformTransposed(parent, position - origin));
+      parent_local.rotation = parent_local.rotation * delta;
+      for (int l = 0; l < 4; ++l) {
+        if (slot->parents[l] >= 0) {
+          ScatterRotation(parent_local.rotation, l, slot->parents[l], locals);
+        }
+      }
+
+      // Continues down the chain.
+      parent = parent * math::SoaFloat4x4::FromQuaternion(delta);
+      parent = parent * math::SoaFloat4x4::FromAffine(
+                            local.translation, local.rotation, local.scale);
+      parent_local = local;
+    }
+  }
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,203 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/sync_group_job.h"
+
+#include <cmath>
+
+#include "ozz/animation/runtime/track.h"
+#include "ozz/animation/runtime/track_triggering_job.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+int ExtractSyncMarkers(const FloatTrack& _track, float _threshold,
+                       span<float> _markers) {
+  TrackTriggeringJob::Iterator iterator;
+  TrackTriggeringJob job;
+  job.track = &_track;
+  job.threshold = _threshold;
+  job.from = 0.f;
+  job.to = 1.f;
+  job.iterator = &iterator;
+  if (!job.Run()) {
+    return -1;
+  }
+
+  int count = 0;
+  for (const TrackTriggeringJob::Iterator end = job.end(); iterator != end;
+       ++iterator) {
+    const TrackTriggeringJob::Edge& edge = *iterator;
+    if (!edge.rising || edge.ratio >= 1.f) {
+      continue;  // Ratio 1 is the same as 0 for a looping clip.
+    }
+    if (static_cast<size_t>(count) < _markers.size()) {
+      _markers[count] = edge.ratio;
+    }
+    ++count;
+  }
+  return count;
+}
+
+SyncClip::SyncClip() : duration(1.f), weight(0.f) {}
+
+SyncGroup::SyncGroup()
+    : clips_begin(0),
+      num_clips(0),
+      playback_speed(1.f),
+      phase(0.f),
+      leader(0) {}
+
+SyncGroupJob::SyncGroupJob() : delta_time(0.f) {}
+
+namespace {
+bool ValidateClip(const SyncClip& _clip) {
+  bool valid = _clip.duration > 0.f && !_clip.markers.empty();
+  for (size_t i = 0; i < _clip.markers.size(); ++i) {
+    valid &= _clip.markers[i] >= 0.f && _clip.markers[i] < 1.f;
+    valid &= i == 0 || _clip.markers[i - 1] < _clip.markers[i];
+  }
+  return valid;
+}
+
+// Gets the length (as a ratio) from marker _i to the next one, which is the
+// first one of the next loop for the last marker.
+inline float SegmentLength(const span<const float>& _markers, int _i) {
+  const int next = _i + 1;
+  return static_cast<size_t>(next) < _markers.size()
+             ? _markers[next] - _markers[_i]
+             : _markers[0] + 1.f - _markers[_i];
+}
+
+// Advances _phase of _leader clip of _time seconds (negative to go backward).
+float Advance(const SyncClip& _leader, float _phase, float _time) {
+  const int num_markers = static_cast<int>(_leader.markers.size());
+
+  // More than a loop doesn't change the phase.
+  float time = std::fmod(_time, _leader.duration);
+
+  int segment = math::Min(static_cast<int>(_phase), num_markers - 1);
+  float progress = _phase - segment;
+  if (time >= 0.f) {
+    for (;;) {
+      const float length = SegmentLength(_leader.markers, segment) *
+                           _leader.duration;
+      const float remaining = (1.f - progress) * length;
+      if (time < remaining) {
+        progress += time / length;
+        break;
+      }
+      time -= remaining;
+      segment = segment + 1 < num_markers ? segment + 1 : 0;
+      progress = 0.f;
+    }
+  } else {
+    time = -time;
+    for (;;) {
+      const float length = SegmentLength(_leader.markers, segment) *
+                           _leader.duration;
+      const float remaining = progress * length;
+      if (time < remaining) {
+        progress -= time / length;
+        break;
+      }
+      time -= remaining;
+      segment = segment > 0 ? segment - 1 : num_markers - 1;
+      progress = 1.f;
+    }
+  }
+
+  // Rounding might lead progress out of the segment.
+  const float phase = segment + math::Clamp(0.f, progress, 1.f);
+  return phase < num_markers ? phase : 0.f;
+}
+}  // namespace
+
+bool SyncGroupJob::Validate() const {
+  bool valid = ratios.size() >= clips.size();
+  for (const SyncClip& clip : clips) {
+    valid &= ValidateClip(clip);
+  }
+  for (const SyncGroup& group : groups) {
+    if (group.num_clips <= 0 || group.clips_begin < 0 ||
+        static_cast<size_t>(group.clips_begin) + group.num_clips >
+            clips.size()) {
+      return false;
+    }
+    const size_t num_markers = clips[group.clips_begin].markers.size();
+    for (int i = 1; i < group.num_clips; ++i) {
+      valid &= clips[group.clips_begin + i].markers.size() == num_markers;
+    }
+  }
+  return valid;
+}
+
+bool SyncGroupJob::Run() const {
+  OZZ_PROFILE_ZONE("SyncGroupJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  for (SyncGroup& group : groups) {
+    const int begin = group.clips_begin;
+    const int end = begin + group.num_clips;
+    const int num_markers = static_cast<int>(clips[begin].markers.size());
+
+    // Finds the leader, the first clip with the highest weight.
+    int leader = begin;
+    for (int i = begin + 1; i < end; ++i) {
+      if (clips[i].weight > clips[leader].weight) {
+        leader = i;
+      }
+    }
+    group.leader = leader;
+
+    // Wraps phase to its valid range, then advances it.
+    float phase = std::fmod(group.phase, static_cast<float>(num_markers));
+    phase = phase < 0.f ? phase + num_markers : phase;
+    phase = phase < num_markers ? phase : 0.f;
+    group.phase =
+        Advance(clips[leader], phase, delta_time * group.playback_speed);
+
+    // All clips are set to the same phase.
+    const int segment = static_cast<int>(group.phase);
+    const float progress = group.phase - segment;
+    for (int i = begin; i < end; ++i) {
+      const span<const float>& markers = clips[i].markers;
+      const float ratio =
+          markers[segment] + progress * SegmentLength(markers, segment);
+      ratios[i] = math::Clamp(0.f, ratio < 1.f ? ratio : ratio - 1.f, 1.f);
+    }
+  }
+
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
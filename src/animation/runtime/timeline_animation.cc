@@ -0,0 +1,351 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/timeline_animation.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace io {
+OZZ_IO_TYPE_NOT_VERSIONABLE(animation::TimelineFloat3Key)
+template <>
+struct Extern<animation::TimelineFloat3Key> {
+  static void Save(OArchive& _archive,
+                   const animation::TimelineFloat3Key* _keys, size_t _count) {
+    for (size_t i = 0; i < _count; ++i) {
+      _archive << MakeArray(_keys[i].value);
+    }
+  }
+  static void Load(IArchive& _archive, animation::TimelineFloat3Key* _keys,
+                   size_t _count, uint32_t _version) {
+    (void)_version;
+    for (size_t i = 0; i < _count; ++i) {
+      _archive >> MakeArray(_keys[i].value);
+    }
+  }
+};
+
+// Largest component and sign bit fields are saved as a single byte.
+OZZ_IO_TYPE_NOT_VERSIONABLE(animation::TimelineQuaternionKey)
+template <>
+struct Extern<animation::TimelineQuaternionKey> {
+  static void Save(OArchive& _archive,
+                   const animation::TimelineQuaternionKey* _keys,
+                   size_t _count) {
+    for (size_t i = 0; i < _count; ++i) {
+      const animation::TimelineQuaternionKey& key = _keys[i];
+      const uint8_t bitset = static_cast<uint8_t>(key.largest | key.sign << 2);
+      _archive << bitset;
+      _archive << MakeArray(key.value);
+    }
+  }
+  static void Load(IArchive& _archive, animation::TimelineQuaternionKey* _keys,
+                   size_t _count, uint32_t _version) {
+    (void)_version;
+    for (size_t i = 0; i < _count; ++i) {
+      animation::TimelineQuaternionKey& key = _keys[i];
+      uint8_t bitset;
+      _archive >> bitset;
+      key.largest = bitset & 3;
+      key.sign = (bitset >> 2) & 1;
+      _archive >> MakeArray(key.value);
+    }
+  }
+};
+}  // namespace io
+
+namespace animation {
+
+TimelineAnimation::TimelineAnimation(memory::Allocator* _allocator)
+    : duration_(0.f), num_tracks_(0), name_(nullptr), allocator_(_allocator) {}
+
+TimelineAnimation::TimelineAnimation(TimelineAnimation&& _other)
+    : TimelineAnimation() {
+  *this = std::move(_other);
+}
+
+TimelineAnimation& TimelineAnimation::operator=(TimelineAnimation&& _other) {
+  std::swap(duration_, _other.duration_);
+  std::swap(num_tracks_, _other.num_tracks_);
+  std::swap(ratios_, _other.ratios_);
+  std::swap(translation_presence_, _other.translation_presence_);
+  std::swap(rotation_presence_, _other.rotation_presence_);
+  std::swap(scale_presence_, _other.scale_presence_);
+  std::swap(translation_offsets_, _other.translation_offsets_);
+  std::swap(rotation_offsets_, _other.rotation_offsets_);
+  std::swap(scale_offsets_, _other.scale_offsets_);
+  std::swap(translations_, _other.translations_);
+  std::swap(rotations_, _other.rotations_);
+  std::swap(scales_, _other.scales_);
+  std::swap(name_, _other.name_);
+  std::swap(allocator_, _other.allocator_);
+  return *this;
+}
+
+TimelineAnimation::~TimelineAnimation() { Deallocate(); }
+
+void TimelineAnimation::Allocate(const AllocatorParams& _params) {
+  assert(ratios_.empty() && translations_.empty() && rotations_.empty() &&
+         scales_.empty());
+
+  // Keys values are compressed to 16 bits components, hence aligned to 2
+  // bytes, after 4 bytes aligned ratios, presence and offsets buffers.
+  static_assert(alignof(float) >= alignof(uint32_t) &&
+                    alignof(uint32_t) >= alignof(TimelineQuaternionKey) &&
+                    alignof(TimelineQuaternionKey) >=
+                        alignof(TimelineFloat3Key) &&
+                    alignof(TimelineFloat3Key) >= alignof(char),
+                "Must serve larger alignment values first");
+
+  num_tracks_ = _params.num_tracks;
+  const size_t num_tracks = static_cast<size_t>(num_soa_tracks()) * 4;
+  const size_t num_words = (_params.num_frames + 31) / 32;
+  const size_t num_presence = num_tracks * num_words;
+  const size_t num_offsets = num_tracks > 0 ? num_tracks + 1 : 0;
+
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t buffer_size =
+      _params.num_frames * sizeof(float) +
+      3 * num_presence * sizeof(uint32_t) +
+      3 * num_offsets * sizeof(uint32_t) +
+      _params.rotation_count * sizeof(TimelineQuaternionKey) +
+      (_params.translation_count + _params.scale_count) *
+          sizeof(TimelineFloat3Key) +
+      (_params.name_len > 0 ? _params.name_len + 1 : 0);
+  const memory::TagScope memory_tag(memory::kTagAnimation);
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  span<byte> buffer = {
+      static_cast<byte*>(allocator->Allocate(buffer_size, alignof(float))),
+      buffer_size};
+
+  // Fix up pointers. Serves larger alignment values first.
+  ratios_ = fill_span<float>(buffer, _params.num_frames);
+  translation_presence_ = fill_span<uint32_t>(buffer, num_presence);
+  rotation_presence_ = fill_span<uint32_t>(buffer, num_presence);
+  scale_presence_ = fill_span<uint32_t>(buffer, num_presence);
+  translation_offsets_ = fill_span<uint32_t>(buffer, num_offsets);
+  rotation_offsets_ = fill_span<uint32_t>(buffer, num_offsets);
+  scale_offsets_ = fill_span<uint32_t>(buffer, num_offsets);
+  rotations_ =
+      fill_span<TimelineQuaternionKey>(buffer, _params.rotation_count);
+  translations_ =
+      fill_span<TimelineFloat3Key>(buffer, _params.translation_count);
+  scales_ = fill_span<TimelineFloat3Key>(buffer, _params.scale_count);
+
+  // Let name be nullptr if animation has no name.
+  name_ = _params.name_len > 0
+              ? fill_span<char>(buffer, _params.name_len + 1).data()
+              : nullptr;
+
+  assert(buffer.empty() && "Whole buffer should be consumned");
+}
+
+void TimelineAnimation::Deallocate() {
+  // Deallocate everything at once.
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  allocator->Deallocate(as_writable_bytes(ratios_).data());
+
+  duration_ = 0.f;
+  num_tracks_ = 0;
+  ratios_ = {};
+  translation_presence_ = {};
+  rotation_presence_ = {};
+  scale_presence_ = {};
+  translation_offsets_ = {};
+  rotation_offsets_ = {};
+  scale_offsets_ = {};
+  translations_ = {};
+  rotations_ = {};
+  scales_ = {};
+  name_ = nullptr;
+}
+
+size_t TimelineAnimation::size() const {
+  const size_t size =
+      sizeof(*this) + ratios_.size_bytes() +
+      translation_presence_.size_bytes() + rotation_presence_.size_bytes() +
+      scale_presence_.size_bytes() + translation_offsets_.size_bytes() +
+      rotation_offsets_.size_bytes() + scale_offsets_.size_bytes() +
+      translations_.size_bytes() + rotations_.size_bytes() +
+      scales_.size_bytes();
+  return size;
+}
+
+namespace {
+// Checks that each track of a channel has as many presence bits as values,
+// with first and last frames keyed.
+bool ValidateChannel(span<const uint32_t> _presence,
+                     span<const uint32_t> _offsets, size_t _num_values,
+                     int _num_frames) {
+  if (_offsets.empty()) {  // No track.
+    return _presence.empty() && _num_values == 0;
+  }
+  const size_t num_words = (_num_frames + 31) / 32;
+  const size_t num_tracks = _offsets.size() - 1;
+  if (_presence.size() != num_tracks * num_words || _offsets[0] != 0 ||
+      _offsets[num_tracks] != _num_values) {
+    return false;
+  }
+  for (size_t i = 0; i < num_tracks; ++i) {
+    if (_offsets[i + 1] < _offsets[i]) {
+      return false;
+    }
+    const uint32_t* words = _presence.data() + i * num_words;
+    if (_num_frames > 0) {
+      const int last = _num_frames - 1;
+      if (!(words[0] & 1) || !(words[last / 32] & (1u << (last % 32))) ||
+          (words[last / 32] >> (last % 32)) > 1) {
+        return false;
+      }
+    }
+    uint32_t count = 0;
+    for (size_t w = 0; w < num_words; ++w) {
+      for (uint32_t word = words[w]; word; word &= word - 1) {
+        ++count;
+      }
+    }
+    if (count != _offsets[i + 1] - _offsets[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace
+
+bool TimelineAnimation::Validate() const {
+  const int num_frames = this->num_frames();
+  if (num_tracks_ > 0) {
+    if (num_frames < 2 || ratios_[0] != 0.f) {
+      return false;
+    }
+  }
+  for (int i = 1; i < num_frames; ++i) {
+    if (!(ratios_[i - 1] < ratios_[i])) {
+      return false;
+    }
+  }
+  return ValidateChannel(translation_presence_, translation_offsets_,
+                         translations_.size(), num_frames) &&
+         ValidateChannel(rotation_presence_, rotation_offsets_,
+                         rotations_.size(), num_frames) &&
+         ValidateChannel(scale_presence_, scale_offsets_, scales_.size(),
+                         num_frames);
+}
+
+void TimelineAnimation::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
+  _archive << static_cast<uint32_t>(ratios_.size());
+  _archive << static_cast<uint32_t>(translations_.size());
+  _archive << static_cast<uint32_t>(rotations_.size());
+  _archive << static_cast<uint32_t>(scales_.size());
+
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  _archive << static_cast<int32_t>(name_len);
+  _archive << ozz::io::MakeArray(name_, name_len);
+
+  _archive << ozz::io::MakeArray(ratios_);
+  _archive << ozz::io::MakeArray(translation_presence_);
+  _archive << ozz::io::MakeArray(rotation_presence_);
+  _archive << ozz::io::MakeArray(scale_presence_);
+  _archive << ozz::io::MakeArray(translation_offsets_);
+  _archive << ozz::io::MakeArray(rotation_offsets_);
+  _archive << ozz::io::MakeArray(scale_offsets_);
+  _archive << ozz::io::MakeArray(translations_);
+  _archive << ozz::io::MakeArray(rotations_);
+  _archive << ozz::io::MakeArray(scales_);
+}
+
+void TimelineAnimation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Destroy animation in case it was already used before.
+  Deallocate();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported TimelineAnimation version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  float duration;
+  _archive >> duration;
+
+  int32_t num_tracks;
+  uint32_t num_frames, translation_count, rotation_count, scale_count;
+  _archive >> num_tracks;
+  _archive >> num_frames;
+  _archive >> translation_count;
+  _archive >> rotation_count;
+  _archive >> scale_count;
+
+  int32_t name_len;
+  _archive >> name_len;
+
+  const AllocatorParams params{static_cast<size_t>(name_len),
+                               num_tracks,
+                               num_frames,
+                               translation_count,
+                               rotation_count,
+                               scale_count};
+  Allocate(params);
+  duration_ = duration;
+
+  if (name_) {  // nullptr name_ is supported.
+    _archive >> ozz::io::MakeArray(name_, name_len);
+    name_[name_len] = 0;
+  }
+
+  _archive >> ozz::io::MakeArray(ratios_);
+  _archive >> ozz::io::MakeArray(translation_presence_);
+  _archive >> ozz::io::MakeArray(rotation_presence_);
+  _archive >> ozz::io::MakeArray(scale_presence_);
+  _archive >> ozz::io::MakeArray(translation_offsets_);
+  _archive >> ozz::io::MakeArray(rotation_offsets_);
+  _archive >> ozz::io::MakeArray(scale_offsets_);
+  _archive >> ozz::io::MakeArray(translations_);
+  _archive >> ozz::io::MakeArray(rotations_);
+  _archive >> ozz::io::MakeArray(scales_);
+
+  // Sampling relies on presence bits and offsets to index key values.
+  if (!Validate()) {
+    log::Err() << "Invalid TimelineAnimation data." << std::endl;
+    Deallocate();
+  }
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,363 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/timeline_sampling_job.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "ozz/animation/runtime/timeline_animation.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "animation/runtime/animation_keyframe.h"
+#include "animation/runtime/key_decompression.h"
+
+namespace ozz {
+namespace animation {
+
+namespace internal {
+struct TimelineInterpSoaFloat3 {
+  math::SimdFloat4 ratio[2];
+  math::SoaFloat3 value[2];
+};
+struct TimelineInterpSoaQuaternion {
+  math::SimdFloat4 ratio[2];
+  math::SoaQuaternion value[2];
+};
+}  // namespace internal
+
+namespace {
+// Number of cursor values per track: left key frame, right key frame and left
+// key value index.
+constexpr int kCursorStride = 3;
+
+// Returns the index of the lowest bit set in _word, which must not be 0.
+// Uses a de Bruijn sequence, as a portable bit scan.
+inline int LowestBit(uint32_t _word) {
+  static const int kDeBruijn[32] = {0,  1,  28, 2,  29, 14, 24, 3,
+                                    30, 22, 20, 15, 25, 17, 4,  8,
+                                    31, 27, 13, 23, 21, 19, 16, 7,
+                                    26, 12, 18, 6,  11, 5,  10, 9};
+  assert(_word != 0);
+  return kDeBruijn[((_word & (0u - _word)) * 0x077CB531u) >> 27];
+}
+
+// Finds the first frame after _frame whose presence bit is set. The last frame
+// being always keyed, a frame is always found if _frame isn't the last one.
+inline int NextFrame(const uint32_t* _words, int _frame) {
+  const int next = _frame + 1;
+  int w = next / 32;
+  uint32_t word = _words[w] & (~0u << (next % 32));
+  while (!word) {
+    word = _words[++w];
+  }
+  return w * 32 + LowestBit(word);
+}
+
+// Resets all channel tracks to their first and second keys.
+void ResetChannel(span<const uint32_t> _presence,
+                  span<const uint32_t> _offsets, int _num_words,
+                  int _num_soa_tracks, int* _cursors, uint8_t* _outdated) {
+  const int num_tracks = _num_soa_tracks * 4;
+  for (int i = 0; i < num_tracks; ++i) {
+    int* cursor = _cursors + i * kCursorStride;
+    cursor[0] = 0;
+    cursor[1] = NextFrame(_presence.data() + i * _num_words, 0);
+    cursor[2] = static_cast<int>(_offsets[i]);
+  }
+  std::memset(_outdated, 1, _num_soa_tracks);
+}
+
+// Advances tracks whose right key frame is before or at _frame, so that their
+// keys surround _frame. All tracks share the same test, without any dependency
+// on other tracks, which makes the loop vectorizable when no track needs to
+// advance, the most common case.
+void AdvanceChannel(span<const uint32_t> _presence, int _num_words,
+                    int _num_soa_tracks, int _frame, int* _cursors,
+                    uint8_t* _outdated) {
+  const int num_tracks = _num_soa_tracks * 4;
+  for (int i = 0; i < num_tracks; ++i) {
+    int* cursor = _cursors + i * kCursorStride;
+    if (cursor[1] > _frame) {
+      continue;
+    }
+    const uint32_t* words = _presence.data() + i * _num_words;
+    do {
+      cursor[0] = cursor[1];
+      cursor[1] = NextFrame(words, cursor[1]);
+      ++cursor[2];
+    } while (cursor[1] <= _frame);
+    _outdated[i / 4] = 1;
+  }
+}
+
+// Decompresses outdated SoA entries keys, whatever is the channel type.
+template <typename _Key, typename _InterpKey, typename _Decompress>
+void UpdateInterpKeys(span<const float> _ratios, span<const _Key> _keys,
+                      int _num_soa_tracks, const int* _cursors,
+                      uint8_t* _outdated, _Decompress _decompress,
+                      _InterpKey* _interp) {
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    if (!_outdated[i]) {
+      continue;
+    }
+    _outdated[i] = 0;
+    const int* c0 = _cursors + (i * 4 + 0) * kCursorStride;
+    const int* c1 = _cursors + (i * 4 + 1) * kCursorStride;
+    const int* c2 = _cursors + (i * 4 + 2) * kCursorStride;
+    const int* c3 = _cursors + (i * 4 + 3) * kCursorStride;
+    _InterpKey& interp = _interp[i];
+    interp.ratio[0] = math::simd_float4::Load(
+        _ratios[c0[0]], _ratios[c1[0]], _ratios[c2[0]], _ratios[c3[0]]);
+    interp.ratio[1] = math::simd_float4::Load(
+        _ratios[c0[1]], _ratios[c1[1]], _ratios[c2[1]], _ratios[c3[1]]);
+    _decompress(_keys[c0[2]], _keys[c1[2]], _keys[c2[2]], _keys[c3[2]],
+                &interp.value[0]);
+    _decompress(_keys[c0[2] + 1], _keys[c1[2] + 1], _keys[c2[2] + 1],
+                _keys[c3[2] + 1], &interp.value[1]);
+  }
+}
+
+// Interpolates all SoA entries, the same way SamplingJob does for linear keys.
+// The lerp of the rotation uses the shortest path, because opposed
+// quaternions were negated during animation build stage.
+void Interpolates(float _ratio, int _num_soa_tracks,
+                  const internal::TimelineInterpSoaFloat3* _translations,
+                  const internal::TimelineInterpSoaQuaternion* _rotations,
+                  const internal::TimelineInterpSoaFloat3* _scales,
+                  math::SoaTransform* _output) {
+  const math::SimdFloat4 anim_ratio = math::simd_float4::Load1(_ratio);
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    const internal::TimelineInterpSoaFloat3& t = _translations[i];
+    const math::SimdFloat4 t_ratio =
+        (anim_ratio - t.ratio[0]) * math::RcpEst(t.ratio[1] - t.ratio[0]);
+    _output[i].translation = Lerp(t.value[0], t.value[1], t_ratio);
+
+    const internal::TimelineInterpSoaQuaternion& r = _rotations[i];
+    const math::SimdFloat4 r_ratio =
+        (anim_ratio - r.ratio[0]) * math::RcpEst(r.ratio[1] - r.ratio[0]);
+    _output[i].rotation = NLerpEst(r.value[0], r.value[1], r_ratio);
+
+    const internal::TimelineInterpSoaFloat3& s = _scales[i];
+    const math::SimdFloat4 s_ratio =
+        (anim_ratio - s.ratio[0]) * math::RcpEst(s.ratio[1] - s.ratio[0]);
+    _output[i].scale = Lerp(s.value[0], s.value[1], s_ratio);
+  }
+}
+}  // namespace
+
+TimelineSamplingJob::TimelineSamplingJob()
+    : ratio(0.f), animation(nullptr), context(nullptr) {}
+
+bool TimelineSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for nullptr pointers.
+  if (!animation || !context) {
+    return false;
+  }
+  valid &= !output.empty();
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+
+  // Tests context size.
+  valid &= context->max_soa_tracks() >= num_soa_tracks;
+
+  return valid;
+}
+
+bool TimelineSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+
+  // Clamps ratio in range [0,duration].
+  const float anim_ratio = math::Clamp(0.f, ratio, 1.f);
+
+  // Steps the context to the new ratio, advancing tracks cursors.
+  context->Step(*animation, anim_ratio);
+
+  // Decompresses keys of the SoA entries whose tracks were advanced.
+  const int num_tracks = context->max_soa_tracks_ * 4;
+  const span<const float> ratios = animation->ratios();
+  UpdateInterpKeys(ratios, animation->translations(), num_soa_tracks,
+                   context->cursors_, context->outdated_,
+                   &internal::DecompressFloat3<TimelineFloat3Key>,
+                   context->soa_translations_);
+  UpdateInterpKeys(ratios, animation->rotations(), num_soa_tracks,
+                   context->cursors_ + num_tracks * kCursorStride,
+                   context->outdated_ + context->max_soa_tracks_,
+                   &internal::DecompressQuaternion<TimelineQuaternionKey>,
+                   context->soa_rotations_);
+  UpdateInterpKeys(ratios, animation->scales(), num_soa_tracks,
+                   context->cursors_ + num_tracks * kCursorStride * 2,
+                   context->outdated_ + context->max_soa_tracks_ * 2,
+                   &internal::DecompressFloat3<TimelineFloat3Key>,
+                   context->soa_scales_);
+
+  // Interpolates soa hierarchy.
+  const int num_soa_interp_tracks =
+      std::min(static_cast<int>(output.size()), num_soa_tracks);
+  Interpolates(anim_ratio, num_soa_interp_tracks, context->soa_translations_,
+               context->soa_rotations_, context->soa_scales_, output.begin());
+
+  return true;
+}
+
+TimelineSamplingJob::Context::Context()
+    : animation_(nullptr),
+      frame_(-1),
+      max_soa_tracks_(0),
+      soa_translations_(nullptr),
+      soa_rotations_(nullptr),
+      soa_scales_(nullptr),
+      cursors_(nullptr),
+      outdated_(nullptr) {}
+
+TimelineSamplingJob::Context::Context(int _max_tracks) : Context() {
+  Resize(_max_tracks);
+}
+
+TimelineSamplingJob::Context::~Context() { Deallocate(); }
+
+void TimelineSamplingJob::Context::Deallocate() {
+  memory::default_allocator()->Deallocate(soa_translations_);
+  soa_translations_ = nullptr;
+  soa_rotations_ = nullptr;
+  soa_scales_ = nullptr;
+  cursors_ = nullptr;
+  outdated_ = nullptr;
+  max_soa_tracks_ = 0;
+  Invalidate();
+}
+
+void TimelineSamplingJob::Context::Resize(int _max_tracks) {
+  using internal::TimelineInterpSoaFloat3;
+  using internal::TimelineInterpSoaQuaternion;
+
+  Deallocate();
+
+  max_soa_tracks_ = (_max_tracks + 3) / 4;
+  const size_t num_soa_tracks = static_cast<size_t>(max_soa_tracks_);
+  const size_t num_cursors = 3 * num_soa_tracks * 4 * kCursorStride;
+  const size_t num_outdated = 3 * num_soa_tracks;
+
+  // Allocates all context data at once in a single allocation. Serves larger
+  // alignment values first.
+  static_assert(alignof(TimelineInterpSoaFloat3) >= alignof(int) &&
+                    alignof(TimelineInterpSoaQuaternion) >= alignof(int) &&
+                    alignof(int) >= alignof(uint8_t),
+                "Must serve larger alignment values first");
+  const size_t size =
+      sizeof(TimelineInterpSoaFloat3) * num_soa_tracks * 2 +
+      sizeof(TimelineInterpSoaQuaternion) * num_soa_tracks +
+      sizeof(int) * num_cursors + sizeof(uint8_t) * num_outdated;
+  const memory::TagScope memory_tag(memory::kTagContext);
+  span<byte> buffer = {
+      static_cast<byte*>(memory::default_allocator()->Allocate(
+          size, alignof(TimelineInterpSoaQuaternion))),
+      size};
+
+  soa_translations_ =
+      fill_span<TimelineInterpSoaFloat3>(buffer, num_soa_tracks).data();
+  soa_scales_ =
+      fill_span<TimelineInterpSoaFloat3>(buffer, num_soa_tracks).data();
+  soa_rotations_ =
+      fill_span<TimelineInterpSoaQuaternion>(buffer, num_soa_tracks).data();
+  cursors_ = fill_span<int>(buffer, num_cursors).data();
+  outdated_ = fill_span<uint8_t>(buffer, num_outdated).data();
+
+  assert(buffer.empty() && "Whole buffer should be consumned");
+}
+
+void TimelineSamplingJob::Context::Invalidate() {
+  animation_ = nullptr;
+  frame_ = -1;
+}
+
+void TimelineSamplingJob::Context::Step(const TimelineAnimation& _animation,
+                                        float _ratio) {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  const int num_tracks = max_soa_tracks_ * 4;
+  const int num_words = _animation.num_presence_words();
+  const span<const float> ratios = _animation.ratios();
+  int* cursors[3] = {cursors_, cursors_ + num_tracks * kCursorStride,
+                     cursors_ + num_tracks * kCursorStride * 2};
+  uint8_t* outdated[3] = {outdated_, outdated_ + max_soa_tracks_,
+                          outdated_ + max_soa_tracks_ * 2};
+  const span<const uint32_t> presence[3] = {_animation.translation_presence(),
+                                            _animation.rotation_presence(),
+                                            _animation.scale_presence()};
+
+  // Resets all tracks to the first frame if animation changed or if it's
+  // played backward.
+  if (animation_ != &_animation || frame_ < 0 || _ratio < ratios[frame_]) {
+    animation_ = &_animation;
+    frame_ = 0;
+    const span<const uint32_t> offsets[3] = {_animation.translation_offsets(),
+                                             _animation.rotation_offsets(),
+                                             _animation.scale_offsets()};
+    for (int c = 0; c < 3; ++c) {
+      ResetChannel(presence[c], offsets[c], num_words, num_soa_tracks,
+                   cursors[c], outdated[c]);
+    }
+  }
+
+  // Searches the last frame before or at _ratio, excluding the last frame so
+  // that every track has a right key.
+  const int last = _animation.num_frames() - 2;
+  if (frame_ >= last || ratios[frame_ + 1] > _ratio) {
+    return;  // Still in the same frame interval, nothing to advance.
+  }
+  frame_ = static_cast<int>(std::upper_bound(ratios.begin() + frame_ + 1,
+                                             ratios.begin() + last + 1,
+                                             _ratio) -
+                            ratios.begin()) -
+           1;
+
+  // Advances all channels tracks whose right key was passed.
+  for (int c = 0; c < 3; ++c) {
+    AdvanceChannel(presence[c], num_words, num_soa_tracks, frame_, cursors[c],
+                   outdated[c]);
+  }
+}
+}  // namespace animation
+}  // namespace ozz
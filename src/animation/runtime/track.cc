@@ -28,12 +28,14 @@
 #include "ozz/animation/runtime/track.h"
 
 #include <cassert>
+#include <cstring>
 
 #include "ozz/base/io/archive.h"
 #include "ozz/base/log.h"
 #include "ozz/base/maths/math_archive.h"
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
 
 namespace ozz {
 namespace animation {
@@ -41,10 +43,16 @@ namespace animation {
 namespace internal {
 
 template <typename _ValueType>
-Track<_ValueType>::Track() : name_(nullptr) {}
+Track<_ValueType>::Track(memory::Allocator* _allocator)
+    : quantization_offset_(0.f),
+      quantization_scale_(0.f),
+      name_(nullptr),
+      allocator_(_allocator),
+      allocation_(nullptr),
+      allocation_size_(0) {}
 
 template <typename _ValueType>
-Track<_ValueType>::Track(Track<_ValueType>&& _other) {
+Track<_ValueType>::Track(Track<_ValueType>&& _other) : Track() {
   *this = std::move(_other);
 }
 
@@ -52,8 +60,15 @@ template <typename _ValueType>
 Track<_ValueType>& Track<_ValueType>::operator=(Track<_ValueType>&& _other) {
   std::swap(ratios_, _other.ratios_);
   std::swap(values_, _other.values_);
+  std::swap(compact_ratios_, _other.compact_ratios_);
+  std::swap(compact_values_, _other.compact_values_);
+  std::swap(quantization_offset_, _other.quantization_offset_);
+  std::swap(quantization_scale_, _other.quantization_scale_);
   std::swap(steps_, _other.steps_);
   std::swap(name_, _other.name_);
+  std::swap(allocator_, _other.allocator_);
+  std::swap(allocation_, _other.allocation_);
+  std::swap(allocation_size_, _other.allocation_size_);
   return *this;
 }
 
@@ -63,44 +78,80 @@ Track<_ValueType>::~Track() {
 }
 
 template <typename _ValueType>
-void Track<_ValueType>::Allocate(size_t _keys_count, size_t _name_len) {
-  assert(ratios_.size() == 0 && values_.size() == 0);
+size_t Track<_ValueType>::BufferSize(size_t _keys_count, size_t _name_len,
+                                     bool _quantized) {
+  const size_t float_keys = _quantized ? 0 : _keys_count;
+  const size_t compact_keys = _quantized ? _keys_count : 0;
+  return float_keys * sizeof(_ValueType) +                // values
+         float_keys * sizeof(float) +                     // ratios
+         compact_keys * kComponents * sizeof(uint16_t) +  // compact values
+         compact_keys * sizeof(uint16_t) +                // compact ratios
+         (_keys_count + 7) * sizeof(uint8_t) / 8 +        // steps
+         (_name_len > 0 ? _name_len + 1 : 0);
+}
 
+template <typename _ValueType>
+void Track<_ValueType>::Bind(size_t _keys_count, size_t _name_len,
+                             bool _quantized, span<byte> _buffer) {
   // Distributes buffer memory while ensuring proper alignment (serves larger
   // alignment values first).
   static_assert(alignof(_ValueType) >= alignof(float) &&
-                    alignof(float) >= alignof(uint8_t),
+                    alignof(float) >= alignof(uint16_t) &&
+                    alignof(uint16_t) >= alignof(uint8_t),
                 "Must serve larger alignment values first)");
 
-  // Compute overall size and allocate a single buffer for all the data.
-  const size_t buffer_size = _keys_count * sizeof(_ValueType) +  // values
-                             _keys_count * sizeof(float) +       // ratios
-                             (_keys_count + 7) * sizeof(uint8_t) / 8 +  // steps
-                             (_name_len > 0 ? _name_len + 1 : 0);
-  span<byte> buffer = {static_cast<byte*>(memory::default_allocator()->Allocate(
-                           buffer_size, alignof(_ValueType))),
-                       buffer_size};
-
-  // Fix up pointers. Serves larger alignment values first.
-  values_ = fill_span<_ValueType>(buffer, _keys_count);
-  ratios_ = fill_span<float>(buffer, _keys_count);
-  steps_ = fill_span<uint8_t>(buffer, (_keys_count + 7) / 8);
+  const size_t float_keys = _quantized ? 0 : _keys_count;
+  const size_t compact_keys = _quantized ? _keys_count : 0;
+  values_ = fill_span<_ValueType>(_buffer, float_keys);
+  ratios_ = fill_span<float>(_buffer, float_keys);
+  compact_values_ = fill_span<uint16_t>(_buffer, compact_keys * kComponents);
+  compact_ratios_ = fill_span<uint16_t>(_buffer, compact_keys);
+  steps_ = fill_span<uint8_t>(_buffer, (_keys_count + 7) / 8);
 
   // Let name be nullptr if track has no name. Allows to avoid allocating this
   // buffer in the constructor of empty animations.
   name_ =
-      _name_len > 0 ? fill_span<char>(buffer, _name_len + 1).data() : nullptr;
+      _name_len > 0 ? fill_span<char>(_buffer, _name_len + 1).data() : nullptr;
 
-  assert(buffer.empty() && "Whole buffer should be consumned");
+  assert(_buffer.empty() && "Whole buffer should be consumned");
+}
+
+template <typename _ValueType>
+void Track<_ValueType>::Allocate(size_t _keys_count, size_t _name_len,
+                                 bool _quantized) {
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t buffer_size = BufferSize(_keys_count, _name_len, _quantized);
+  if (allocation_ == nullptr || allocation_size_ < buffer_size) {
+    Deallocate();
+    const memory::TagScope memory_tag(memory::kTagTrack);
+    memory::Allocator* allocator =
+        allocator_ ? allocator_ : memory::default_allocator();
+    allocation_ = allocator->Allocate(buffer_size, alignof(_ValueType));
+    allocation_size_ = buffer_size;
+  }
+  quantization_offset_ = math::Float4(0.f);
+  quantization_scale_ = math::Float4(0.f);
+
+  // Fix up pointers.
+  Bind(_keys_count, _name_len, _quantized,
+       {static_cast<byte*>(allocation_), buffer_size});
 }
 
 template <typename _ValueType>
 void Track<_ValueType>::Deallocate() {
   // Deallocate everything at once.
-  memory::default_allocator()->Deallocate(as_writable_bytes(values_).data());
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  allocator->Deallocate(allocation_);
+  allocation_ = nullptr;
+  allocation_size_ = 0;
 
   values_ = {};
   ratios_ = {};
+  compact_values_ = {};
+  compact_ratios_ = {};
+  quantization_offset_ = math::Float4(0.f);
+  quantization_scale_ = math::Float4(0.f);
   steps_ = {};
   name_ = nullptr;
 }
@@ -108,20 +159,167 @@ void Track<_ValueType>::Deallocate() {
 template <typename _ValueType>
 size_t Track<_ValueType>::size() const {
   const size_t size = sizeof(*this) + values_.size_bytes() +
-                      ratios_.size_bytes() + steps_.size_bytes();
+                      ratios_.size_bytes() + compact_values_.size_bytes() +
+                      compact_ratios_.size_bytes() + steps_.size_bytes();
   return size;
 }
 
+namespace {
+// Header of track images, followed by track buffer.
+struct alignas(16) TrackImageHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t size;
+  uint32_t value_type;
+  uint32_t num_keys;
+  uint32_t name_len;
+  uint32_t quantized;
+  uint32_t padding;
+  math::Float4 quantization_offset;
+  math::Float4 quantization_scale;
+};
+
+// "ozzt" characters, in native endianness.
+const uint32_t kTrackImageMagic = 0x747a7a6f;
+const uint32_t kTrackImageVersion = 1;
+
+// Identifies track value types, so that an image can't be used for a track of
+// another type.
+template <typename _ValueType>
+struct TrackImageType;
+template <>
+struct TrackImageType<float> {
+  enum { kValue = 1 };
+};
+template <>
+struct TrackImageType<math::Float2> {
+  enum { kValue = 2 };
+};
+template <>
+struct TrackImageType<math::Float3> {
+  enum { kValue = 3 };
+};
+template <>
+struct TrackImageType<math::Float4> {
+  enum { kValue = 4 };
+};
+template <>
+struct TrackImageType<math::Quaternion> {
+  enum { kValue = 5 };
+};
+}  // namespace
+
+template <typename _ValueType>
+size_t Track<_ValueType>::image_size() const {
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  return sizeof(TrackImageHeader) +
+         BufferSize(num_keys(), name_len, quantized());
+}
+
+template <typename _ValueType>
+bool Track<_ValueType>::ToImage(span<byte> _image) const {
+  static_assert(sizeof(TrackImageHeader) % kImageAlignment == 0,
+                "Track buffer must be aligned.");
+  if (!IsAligned(_image.data(), kImageAlignment) ||
+      _image.size_bytes() < image_size()) {
+    return false;
+  }
+
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  TrackImageHeader header = {};
+  header.magic = kTrackImageMagic;
+  header.version = kTrackImageVersion;
+  header.size = static_cast<uint32_t>(image_size());
+  header.value_type = TrackImageType<_ValueType>::kValue;
+  header.num_keys = static_cast<uint32_t>(num_keys());
+  header.name_len = static_cast<uint32_t>(name_len);
+  header.quantized = quantized();
+  header.quantization_offset = quantization_offset_;
+  header.quantization_scale = quantization_scale_;
+  std::memcpy(_image.data(), &header, sizeof(header));
+
+  // Buffers are copied in the order they're distributed by Bind().
+  byte* cursor = _image.data() + sizeof(header);
+  const auto copy = [&cursor](const void* _src, size_t _size) {
+    if (_size != 0) {
+      std::memcpy(cursor, _src, _size);
+    }
+    cursor += _size;
+  };
+  copy(values_.data(), values_.size_bytes());
+  copy(ratios_.data(), ratios_.size_bytes());
+  copy(compact_values_.data(), compact_values_.size_bytes());
+  copy(compact_ratios_.data(), compact_ratios_.size_bytes());
+  copy(steps_.data(), steps_.size_bytes());
+  copy(name_, name_len > 0 ? name_len + 1 : 0);
+  return true;
+}
+
+template <typename _ValueType>
+bool Track<_ValueType>::FromImage(span<const byte> _image) {
+  // Destroy track in case it was already used before.
+  Deallocate();
+
+  TrackImageHeader header;
+  if (!IsAligned(_image.data(), kImageAlignment) ||
+      _image.size_bytes() < sizeof(header)) {
+    log::Err() << "Invalid Track image buffer." << std::endl;
+    return false;
+  }
+  std::memcpy(&header, _image.data(), sizeof(header));
+  if (header.magic != kTrackImageMagic) {
+    log::Err() << "Invalid Track image, or image endianness doesn't match "
+                  "platform."
+               << std::endl;
+    return false;
+  }
+  if (header.version != kTrackImageVersion) {
+    log::Err() << "Unsupported Track image version " << header.version << "."
+               << std::endl;
+    return false;
+  }
+  if (header.value_type != TrackImageType<_ValueType>::kValue) {
+    log::Err() << "Track image type doesn't match." << std::endl;
+    return false;
+  }
+  const bool quantized = header.quantized != 0;
+  const size_t buffer_size =
+      BufferSize(header.num_keys, header.name_len, quantized);
+  if (header.size != sizeof(header) + buffer_size ||
+      _image.size_bytes() < header.size) {
+    log::Err() << "Invalid Track image size." << std::endl;
+    return false;
+  }
+
+  // Track data are never written once built, so they can point to the
+  // read-only image.
+  Bind(header.num_keys, header.name_len, quantized,
+       {const_cast<byte*>(_image.data()) + sizeof(header), buffer_size});
+  quantization_offset_ = header.quantization_offset;
+  quantization_scale_ = header.quantization_scale;
+  return true;
+}
+
 template <typename _ValueType>
 void Track<_ValueType>::Save(ozz::io::OArchive& _archive) const {
-  uint32_t num_keys = static_cast<uint32_t>(ratios_.size());
+  uint32_t num_keys = static_cast<uint32_t>(this->num_keys());
   _archive << num_keys;
 
   const size_t name_len = name_ ? std::strlen(name_) : 0;
   _archive << static_cast<int32_t>(name_len);
 
-  _archive << ozz::io::MakeArray(ratios_);
-  _archive << ozz::io::MakeArray(values_);
+  const bool quantized = this->quantized();
+  _archive << quantized;
+
+  if (quantized) {
+    _archive << ozz::io::MakeArray(compact_ratios_);
+    _archive << ozz::io::MakeArray(compact_values_);
+    _archive << quantization_offset_;
+    _archive << quantization_scale_;
+  } else {
+    _archive << ozz::io::MakeArray(ratios_);
+    _archive << ozz::io::MakeArray(values_);
+  }
   _archive << ozz::io::MakeArray(steps_);
 
   _archive << ozz::io::MakeArray(name_, name_len);
@@ -132,7 +330,7 @@ void Track<_ValueType>::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   // Destroy animation in case it was already used before.
   Deallocate();
 
-  if (_version > 1) {
+  if (_version < 1 || _version > 2) {
     log::Err() << "Unsupported Track version " << _version << "." << std::endl;
     return;
   }
@@ -143,10 +341,23 @@ void Track<_ValueType>::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   int32_t name_len;
   _archive >> name_len;
 
-  Allocate(num_keys, name_len);
+  // Version 1 tracks are never quantized.
+  bool quantized = false;
+  if (_version >= 2) {
+    _archive >> quantized;
+  }
 
-  _archive >> ozz::io::MakeArray(ratios_);
-  _archive >> ozz::io::MakeArray(values_);
+  Allocate(num_keys, name_len, quantized);
+
+  if (quantized) {
+    _archive >> ozz::io::MakeArray(compact_ratios_);
+    _archive >> ozz::io::MakeArray(compact_values_);
+    _archive >> quantization_offset_;
+    _archive >> quantization_scale_;
+  } else {
+    _archive >> ozz::io::MakeArray(ratios_);
+    _archive >> ozz::io::MakeArray(values_);
+  }
   _archive >> ozz::io::MakeArray(steps_);
 
   if (name_) {  // nullptr name_ is supported.
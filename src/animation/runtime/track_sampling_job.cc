@@ -28,9 +28,13 @@
 #include "ozz/animation/runtime/track_sampling_job.h"
 #include "ozz/animation/runtime/track.h"
 #include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_quaternion.h"
+#include "ozz/base/profile.h"
 
 #include <algorithm>
 #include <cassert>
+#include <cstring>
 
 namespace ozz {
 namespace animation {
@@ -48,8 +52,118 @@ bool TrackSamplingJob<_Track>::Validate() const {
   return success;
 }
 
+namespace {
+
+// Converts float or 16 bits quantized key ratios to float.
+inline float KeyRatio(float _ratio) { return _ratio; }
+inline float KeyRatio(uint16_t _ratio) { return _ratio * (1.f / 65535.f); }
+
+// Finds the last key of [_begin, _end[ whose ratio is lower or equal to
+// _ratio.
+template <typename _Ratio>
+inline const _Ratio* FindKey(const _Ratio* _begin, const _Ratio* _end,
+                             float _ratio) {
+  return std::upper_bound(_begin, _end, _ratio,
+                          [](float _left, const _Ratio& _right) {
+                            return _left < KeyRatio(_right);
+                          }) -
+         1;
+}
+
+// Finds the last key whose ratio is lower or equal to _ratio, stepping from
+// _cursor key. Steps forward a few keys before falling back to a binary
+// search, which also handles backward jumps.
+template <typename _Ratio>
+inline size_t SeekKey(span<const _Ratio> _ratios, size_t _cursor,
+                      float _ratio) {
+  const size_t kMaxSteps = 4;
+  const _Ratio* begin = _ratios.begin();
+  const _Ratio* end = _ratios.end();
+  const _Ratio* cursor = begin + math::Min(_cursor, _ratios.size() - 1);
+  if (KeyRatio(*cursor) > _ratio) {
+    return FindKey(begin, cursor, _ratio) - begin;
+  }
+  for (size_t i = 0; i < kMaxSteps; ++i, ++cursor) {
+    if (cursor + 1 == end || KeyRatio(cursor[1]) > _ratio) {
+      return cursor - begin;
+    }
+  }
+  return FindKey(cursor, end, _ratio) - begin;
+}
+
+// Finds _track key to interpolate at _ratio, using _cursor if not nullptr.
+template <typename _Track>
+size_t SeekTrackKey(const _Track& _track, uint32_t* _cursor, float _ratio) {
+  size_t id0;
+  if (_track.quantized()) {
+    const span<const uint16_t> ratios = _track.compact_ratios();
+    id0 = _cursor ? SeekKey(ratios, *_cursor, _ratio)
+                  : FindKey(ratios.begin(), ratios.end(), _ratio) -
+                        ratios.begin();
+  } else {
+    const span<const float> ratios = _track.ratios();
+    id0 = _cursor ? SeekKey(ratios, *_cursor, _ratio)
+                  : FindKey(ratios.begin(), ratios.end(), _ratio) -
+                        ratios.begin();
+  }
+  if (_cursor) {
+    *_cursor = static_cast<uint32_t>(id0);
+  }
+  return id0;
+}
+
+// Gets _track key _i ratio and value, dequantized if needed.
+template <typename _Track>
+inline float TrackKeyRatio(const _Track& _track, size_t _i) {
+  return _track.quantized() ? KeyRatio(_track.compact_ratios()[_i])
+                            : _track.ratios()[_i];
+}
+template <typename _Track>
+inline typename _Track::ValueType TrackKeyValue(const _Track& _track,
+                                                size_t _i) {
+  typedef typename _Track::ValueType ValueType;
+  if (!_track.quantized()) {
+    return _track.values()[_i];
+  }
+  const int kComponents = _Track::kComponents;
+  const uint16_t* compact = &_track.compact_values()[_i * kComponents];
+  const float* offset = &_track.quantization_offset().x;
+  const float* scale = &_track.quantization_scale().x;
+  float components[4];
+  for (int c = 0; c < kComponents; ++c) {
+    components[c] = offset[c] + compact[c] * scale[c];
+  }
+  ValueType value;
+  std::memcpy(&value, components, sizeof(value));
+  return value;
+}
+
+// Interpolates _track keys _id0 and its successor at _ratio.
+template <typename _Track>
+typename _Track::ValueType SampleKeys(const _Track& _track, size_t _id0,
+                                      float _ratio) {
+  typedef typename _Track::ValueType ValueType;
+  const size_t id1 = _id0 + 1;
+
+  const bool id0step = (_track.steps()[_id0 / 8] & (1 << (_id0 & 7))) != 0;
+  if (id0step || id1 == _track.num_keys()) {
+    return TrackKeyValue(_track, _id0);
+  }
+
+  // Lerp relevant keys.
+  const float tk0 = TrackKeyRatio(_track, _id0);
+  const float tk1 = TrackKeyRatio(_track, id1);
+  assert(_ratio >= tk0 && _ratio < tk1 && tk0 != tk1);
+  const float alpha = (_ratio - tk0) / (tk1 - tk0);
+  return internal::TrackPolicy<ValueType>::Lerp(
+      TrackKeyValue(_track, _id0), TrackKeyValue(_track, id1), alpha);
+}
+}  // namespace
+
 template <typename _Track>
 bool TrackSamplingJob<_Track>::Run() const {
+  OZZ_PROFILE_ZONE("TrackSamplingJob::Run");
+
   if (!Validate()) {
     return false;
   }
@@ -57,38 +171,60 @@ bool TrackSamplingJob<_Track>::Run() const {
   // Clamps ratio in range [0,1].
   const float clamped_ratio = math::Clamp(0.f, ratio, 1.f);
 
-  // Search keyframes to interpolate.
-  const span<const float> ratios = track->ratios();
-  const span<const ValueType> values = track->values();
-  assert(ratios.size() == values.size() &&
-         track->steps().size() * 8 >= values.size());
-
   // Default track returns identity.
-  if (ratios.size() == 0) {
+  const size_t num_keys = track->num_keys();
+  assert(track->steps().size() * 8 >= num_keys);
+  if (num_keys == 0) {
     *result = internal::TrackPolicy<ValueType>::identity();
     return true;
   }
 
-  // Search for the first key frame with a ratio value greater than input ratio.
-  // Our ratio is between this one and the previous one.
-  const float* ptk1 = std::upper_bound(ratios.begin(), ratios.end(), clamped_ratio);
+  // Search keyframes to interpolate.
+  const size_t id0 = SeekTrackKey(*track, nullptr, clamped_ratio);
+  *result = SampleKeys(*track, id0, clamped_ratio);
+  return true;
+}
 
-  // Deduce keys indices.
-  const size_t id1 = ptk1 - ratios.begin();
-  const size_t id0 = id1 - 1;
+template <typename _Track>
+BatchTrackSamplingJob<_Track>::BatchTrackSamplingJob() : ratio(0.f) {}
 
-  const bool id0step = (track->steps()[id0 / 8] & (1 << (id0 & 7))) != 0;
-  if (id0step || ptk1 == ratios.end()) {
-    *result = values[id0];
-  } else {
-    // Lerp relevant keys.
-    const float tk0 = ratios[id0];
-    const float tk1 = ratios[id1];
-    assert(clamped_ratio >= tk0 && clamped_ratio < tk1 && tk0 != tk1);
-    const float alpha = (clamped_ratio - tk0) / (tk1 - tk0);
-    const ValueType& vk0 = values[id0];
-    const ValueType& vk1 = values[id1];
-    *result = internal::TrackPolicy<ValueType>::Lerp(vk0, vk1, alpha);
+template <typename _Track>
+bool BatchTrackSamplingJob<_Track>::Validate() const {
+  bool success = true;
+  success &= results.size() >= tracks.size();
+  success &= cursors.empty() || cursors.size() >= tracks.size();
+  for (size_t i = 0; success && i < tracks.size(); ++i) {
+    success &= tracks[i] != nullptr;
+  }
+  return success;
+}
+
+template <typename _Track>
+bool BatchTrackSamplingJob<_Track>::Run() const {
+  OZZ_PROFILE_ZONE("BatchTrackSamplingJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  // Clamps ratio in range [0,1].
+  const float clamped_ratio = math::Clamp(0.f, ratio, 1.f);
+
+  const bool use_cursors = !cursors.empty();
+  for (size_t i = 0; i < tracks.size(); ++i) {
+    const _Track& track = *tracks[i];
+
+    // Default track returns identity.
+    const size_t num_keys = track.num_keys();
+    assert(track.steps().size() * 8 >= num_keys);
+    if (num_keys == 0) {
+      results[i] = internal::TrackPolicy<ValueType>::identity();
+      continue;
+    }
+
+    const size_t id0 = SeekTrackKey(
+        track, use_cursors ? &cursors[i] : nullptr, clamped_ratio);
+    results[i] = SampleKeys(track, id0, clamped_ratio);
   }
   return true;
 }
@@ -99,6 +235,174 @@ template struct TrackSamplingJob<Float2Track>;
 template struct TrackSamplingJob<Float3Track>;
 template struct TrackSamplingJob<Float4Track>;
 template struct TrackSamplingJob<QuaternionTrack>;
+template struct BatchTrackSamplingJob<FloatTrack>;
+template struct BatchTrackSamplingJob<Float2Track>;
+template struct BatchTrackSamplingJob<Float3Track>;
+template struct BatchTrackSamplingJob<Float4Track>;
+template struct BatchTrackSamplingJob<QuaternionTrack>;
 }  // namespace internal
+
+MultiFloatTrackSamplingJob::MultiFloatTrackSamplingJob()
+    : ratio(0.f), track(nullptr), cursor(nullptr) {}
+
+bool MultiFloatTrackSamplingJob::Validate() const {
+  bool success = true;
+  success &= track != nullptr;
+  success &= track &&
+             results.size() >= static_cast<size_t>(track->num_channels());
+  return success;
+}
+
+bool MultiFloatTrackSamplingJob::Run() const {
+  OZZ_PROFILE_ZONE("MultiFloatTrackSamplingJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  // Clamps ratio in range [0,1].
+  const float clamped_ratio = math::Clamp(0.f, ratio, 1.f);
+
+  const int num_channels = track->num_channels();
+  const span<const float> ratios = track->ratios();
+  const span<const float> values = track->values();
+  const size_t stride = track->num_soa_channels() * 4;
+  assert(values.size() == ratios.size() * stride &&
+         track->steps().size() * 8 >= ratios.size());
+
+  // Default track returns identity.
+  if (ratios.size() == 0) {
+    std::fill(results.begin(), results.begin() + num_channels, 0.f);
+    return true;
+  }
+
+  // Search keyframes to interpolate.
+  size_t id0;
+  if (cursor) {
+    id0 = internal::SeekKey(ratios, *cursor, clamped_ratio);
+    *cursor = static_cast<uint32_t>(id0);
+  } else {
+    id0 = internal::FindKey(ratios.begin(), ratios.end(), clamped_ratio) -
+          ratios.begin();
+  }
+  const size_t id1 = id0 + 1;
+  const float* vk0 = values.begin() + id0 * stride;
+
+  const bool id0step = (track->steps()[id0 / 8] & (1 << (id0 & 7))) != 0;
+  if (id0step || id1 == ratios.size()) {
+    std::memcpy(results.data(), vk0, num_channels * sizeof(float));
+    return true;
+  }
+
+  // Lerp relevant keys, 4 channels at a time.
+  const float tk0 = ratios[id0];
+  const float tk1 = ratios[id1];
+  assert(clamped_ratio >= tk0 && clamped_ratio < tk1 && tk0 != tk1);
+  const math::SimdFloat4 alpha =
+      math::simd_float4::Load1((clamped_ratio - tk0) / (tk1 - tk0));
+  const float* vk1 = vk0 + stride;
+  float* result = results.data();
+  int i = 0;
+  for (; i + 4 <= num_channels; i += 4) {
+    const math::SimdFloat4 value = math::Lerp(
+        math::simd_float4::LoadPtr(vk0 + i),
+        math::simd_float4::LoadPtr(vk1 + i), alpha);
+    math::StorePtrU(value, result + i);
+  }
+  if (i < num_channels) {  // Remaining channels.
+    const math::SimdFloat4 value = math::Lerp(
+        math::simd_float4::LoadPtr(vk0 + i),
+        math::simd_float4::LoadPtr(vk1 + i), alpha);
+    switch (num_channels - i) {
+      case 1:
+        math::Store1PtrU(value, result + i);
+        break;
+      case 2:
+        math::Store2PtrU(value, result + i);
+        break;
+      default:
+        math::Store3PtrU(value, result + i);
+        break;
+    }
+  }
+  return true;
+}
+
+SoaQuaternionTrackSamplingJob::SoaQuaternionTrackSamplingJob() : ratio(0.f) {}
+
+bool SoaQuaternionTrackSamplingJob::Validate() const {
+  bool success = true;
+  success &= results.size() >= (tracks.size() + 3) / 4;
+  success &= cursors.empty() || cursors.size() >= tracks.size();
+  for (size_t i = 0; success && i < tracks.size(); ++i) {
+    success &= tracks[i] != nullptr;
+  }
+  return success;
+}
+
+bool SoaQuaternionTrackSamplingJob::Run() const {
+  OZZ_PROFILE_ZONE("SoaQuaternionTrackSamplingJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  // Clamps ratio in range [0,1].
+  const float clamped_ratio = math::Clamp(0.f, ratio, 1.f);
+
+  const bool use_cursors = !cursors.empty();
+  const size_t num_tracks = tracks.size();
+  for (size_t i = 0; i < num_tracks; i += 4) {
+    // Gathers the 2 keys to interpolate and the interpolation coefficient of
+    // each lane. Steps, last keys, empty tracks and unused lanes interpolate a
+    // key with itself.
+    math::Quaternion k0[4];
+    math::Quaternion k1[4];
+    float alpha[4] = {0.f, 0.f, 0.f, 0.f};
+    for (int l = 0; l < 4; ++l) {
+      k0[l] = k1[l] = math::Quaternion::identity();
+    }
+    for (size_t l = 0; l < 4 && i + l < num_tracks; ++l) {
+      const QuaternionTrack& track = *tracks[i + l];
+      const size_t num_keys = track.num_keys();
+      assert(track.steps().size() * 8 >= num_keys);
+      if (num_keys == 0) {
+        continue;
+      }
+      const size_t id0 = internal::SeekTrackKey(
+          track, use_cursors ? &cursors[i + l] : nullptr, clamped_ratio);
+      k0[l] = k1[l] = internal::TrackKeyValue(track, id0);
+
+      const size_t id1 = id0 + 1;
+      const bool id0step = (track.steps()[id0 / 8] & (1 << (id0 & 7))) != 0;
+      if (!id0step && id1 != num_keys) {
+        const float tk0 = internal::TrackKeyRatio(track, id0);
+        const float tk1 = internal::TrackKeyRatio(track, id1);
+        assert(clamped_ratio >= tk0 && clamped_ratio < tk1 && tk0 != tk1);
+        alpha[l] = (clamped_ratio - tk0) / (tk1 - tk0);
+        k1[l] = internal::TrackKeyValue(track, id1);
+      }
+    }
+
+    // Transposes keys to SoA, then interpolates and normalizes the 4 lanes at
+    // once.
+    math::SimdFloat4 aos0[4];
+    math::SimdFloat4 aos1[4];
+    for (int l = 0; l < 4; ++l) {
+      aos0[l] = math::simd_float4::LoadPtrU(&k0[l].x);
+      aos1[l] = math::simd_float4::LoadPtrU(&k1[l].x);
+    }
+    math::SimdFloat4 soa0[4];
+    math::SimdFloat4 soa1[4];
+    math::Transpose4x4(aos0, soa0);
+    math::Transpose4x4(aos1, soa1);
+    const math::SoaQuaternion q0 =
+        math::SoaQuaternion::Load(soa0[0], soa0[1], soa0[2], soa0[3]);
+    const math::SoaQuaternion q1 =
+        math::SoaQuaternion::Load(soa1[0], soa1[1], soa1[2], soa1[3]);
+    results[i / 4] = math::NLerp(q0, q1, math::simd_float4::LoadPtrU(alpha));
+  }
+  return true;
+}
 }  // namespace animation
 }  // namespace ozz
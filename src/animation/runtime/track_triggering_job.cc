@@ -27,6 +27,8 @@
 
 #include "ozz/animation/runtime/track_triggering_job.h"
 #include "ozz/animation/runtime/track.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/profile.h"
 
 #include <algorithm>
 #include <cassert>
@@ -35,16 +37,23 @@ namespace ozz {
 namespace animation {
 
 TrackTriggeringJob::TrackTriggeringJob()
-    : from(0.f), to(0.f), threshold(0.f), track(nullptr), iterator(nullptr) {}
+    : from(0.f),
+      to(0.f),
+      threshold(0.f),
+      track(nullptr),
+      index(nullptr),
+      iterator(nullptr) {}
 
 bool TrackTriggeringJob::Validate() const {
   bool valid = true;
-  valid &= track != nullptr;
+  valid &= index != nullptr || (track != nullptr && !track->quantized());
   valid &= iterator != nullptr;
   return valid;
 }
 
 bool TrackTriggeringJob::Run() const {
+  OZZ_PROFILE_ZONE("TrackTriggeringJob::Run");
+
   if (!Validate()) {
     return false;
   }
@@ -62,27 +71,27 @@ bool TrackTriggeringJob::Run() const {
 
 namespace {
 inline bool DetectEdge(ptrdiff_t _i0, ptrdiff_t _i1, bool _forward,
-                       const TrackTriggeringJob& _job,
+                       const FloatTrack& _track, float _threshold,
                        TrackTriggeringJob::Edge* _edge) {
-  const span<const float>& values = _job.track->values();
+  const span<const float>& values = _track.values();
 
   const float vk0 = values[_i0];
   const float vk1 = values[_i1];
 
   bool detected = false;
-  if (vk0 <= _job.threshold && vk1 > _job.threshold) {
+  if (vk0 <= _threshold && vk1 > _threshold) {
     // Rising edge
     _edge->rising = _forward;
     detected = true;
-  } else if (vk0 > _job.threshold && vk1 <= _job.threshold) {
+  } else if (vk0 > _threshold && vk1 <= _threshold) {
     // Falling edge
     _edge->rising = !_forward;
     detected = true;
   }
 
   if (detected) {
-    const span<const float>& ratios = _job.track->ratios();
-    const span<const uint8_t>& steps = _job.track->steps();
+    const span<const float>& ratios = _track.ratios();
+    const span<const uint8_t>& steps = _track.steps();
 
     const bool step = (steps[_i0 / 8] & (1 << (_i0 & 7))) != 0;
     if (step) {
@@ -96,7 +105,7 @@ inline bool DetectEdge(ptrdiff_t _i0, ptrdiff_t _i1, bool _forward,
         // Finds where the curve crosses threshold value.
         // This is the lerp equation, where we know the result and look for
         // alpha, aka un-lerp.
-        const float alpha = (_job.threshold - vk0) / (vk1 - vk0);
+        const float alpha = (_threshold - vk0) / (vk1 - vk0);
 
         // Remaps to keyframes actual times.
         const float tk0 = ratios[_i0];
@@ -109,11 +118,64 @@ inline bool DetectEdge(ptrdiff_t _i0, ptrdiff_t _i1, bool _forward,
 }
 }  // namespace
 
+TrackEdgeIndex::TrackEdgeIndex() : threshold_(0.f) {}
+
+bool TrackEdgeIndex::Build(const FloatTrack& _track, float _threshold) {
+  threshold_ = _threshold;
+  edges_.clear();
+  if (_track.quantized()) {
+    return false;
+  }
+
+  // Detects edges in the same order as a forward TrackTriggeringJob iteration,
+  // including the looping edge between the last and the first key.
+  const ptrdiff_t num_keys = _track.ratios().size();
+  for (ptrdiff_t i = 0; i < num_keys; ++i) {
+    const ptrdiff_t i0 = i == 0 ? num_keys - 1 : i - 1;
+    TrackTriggeringJob::Edge edge;
+    if (DetectEdge(i0, i, true, _track, _threshold, &edge)) {
+      edges_.push_back(edge);
+    }
+  }
+  return true;
+}
+
+namespace {
+// Finds the first edge whose global ratio (offset by _outer) isn't smaller than
+// _ratio. Comparison is done in global ratio space, exactly as the iterator
+// filters edges, so floating point rounding can't lead to missing one.
+inline ptrdiff_t LowerEdge(const span<const TrackTriggeringJob::Edge>& _edges,
+                           float _outer, float _ratio) {
+  const TrackTriggeringJob::Edge* it = std::lower_bound(
+      _edges.begin(), _edges.end(), _ratio,
+      [_outer](const TrackTriggeringJob::Edge& _edge, float _value) {
+        return _edge.ratio + _outer < _value;
+      });
+  return it - _edges.begin();
+}
+}  // namespace
+
 TrackTriggeringJob::Iterator::Iterator(const TrackTriggeringJob* _job)
     : job_(_job) {
   // Outer loop initialization.
   outer_ = floorf(job_->from);
 
+  if (job_->index != nullptr) {
+    const span<const Edge> edges = job_->index->edges();
+    if (edges.empty()) {
+      *this = job_->end();
+      return;
+    }
+    // Binary searches the first edge to process, with the same condition as
+    // the one used to filter edges against "from" ratio.
+    const ptrdiff_t lower = LowerEdge(edges, outer_, job_->from);
+    inner_ = job_->from < job_->to ? lower : lower - 1;
+
+    // Evaluates first edge.
+    ++*this;
+    return;
+  }
+
   // Search could start more closely to the "from" ratio, but it's not possible
   // to ensure that floating point precision will not lead to missing a key
   // (when from/to range is far from 0). This is less good in algorithmic
@@ -129,6 +191,51 @@ TrackTriggeringJob::Iterator::Iterator(const TrackTriggeringJob* _job)
 const TrackTriggeringJob::Iterator& TrackTriggeringJob::Iterator::operator++() {
   assert(*this != job_->end() && "Can't increment end iterator.");
 
+  if (job_->index != nullptr) {
+    const span<const Edge> edges = job_->index->edges();
+    const ptrdiff_t num_edges = edges.size();
+    if (job_->to > job_->from) {
+      for (; outer_ < job_->to; outer_ += 1.f) {
+        for (; inner_ < num_edges; ++inner_) {
+          edge_ = edges[inner_];
+          edge_.ratio += outer_;  // Convert to global ratio space.
+          if (edge_.ratio >= job_->from &&
+              (edge_.ratio < job_->to || job_->to >= 1.f + outer_)) {
+            ++inner_;
+            return *this;  // Yield found edge.
+          }
+          // Edges are sorted, won't find any further edge.
+          if (edge_.ratio >= job_->to) {
+            break;
+          }
+        }
+        inner_ = 0;  // Ready for next loop.
+      }
+    } else {
+      for (; outer_ + 1.f > job_->to; outer_ -= 1.f) {
+        for (; inner_ >= 0; --inner_) {
+          edge_ = edges[inner_];
+          edge_.ratio += outer_;  // Convert to global ratio space.
+          edge_.rising = !edge_.rising;
+          if (edge_.ratio >= job_->to &&
+              (edge_.ratio < job_->from || job_->from >= 1.f + outer_)) {
+            --inner_;
+            return *this;  // Yield found edge.
+          }
+          // Edges are sorted, won't find any further edge.
+          if (edge_.ratio < job_->to) {
+            break;
+          }
+        }
+        inner_ = num_edges - 1;  // Ready for next loop.
+      }
+    }
+
+    // Set iterator to end position.
+    *this = job_->end();
+    return *this;
+  }
+
   const span<const float>& ratios = job_->track->ratios();
   const ptrdiff_t num_keys = ratios.size();
 
@@ -136,7 +243,8 @@ const TrackTriggeringJob::Iterator& TrackTriggeringJob::Iterator::operator++() {
     for (; outer_ < job_->to; outer_ += 1.f) {
       for (; inner_ < num_keys; ++inner_) {
         const ptrdiff_t i0 = inner_ == 0 ? num_keys - 1 : inner_ - 1;
-        if (DetectEdge(i0, inner_, true, *job_, &edge_)) {
+        if (DetectEdge(i0, inner_, true, *job_->track, job_->threshold,
+                       &edge_)) {
           edge_.ratio += outer_;  // Convert to global ratio space.
           if (edge_.ratio >= job_->from &&
               (edge_.ratio < job_->to || job_->to >= 1.f + outer_)) {
@@ -155,7 +263,8 @@ const TrackTriggeringJob::Iterator& TrackTriggeringJob::Iterator::operator++() {
     for (; outer_ + 1.f > job_->to; outer_ -= 1.f) {
       for (; inner_ >= 0; --inner_) {
         const ptrdiff_t i0 = inner_ == 0 ? num_keys - 1 : inner_ - 1;
-        if (DetectEdge(i0, inner_, false, *job_, &edge_)) {
+        if (DetectEdge(i0, inner_, false, *job_->track, job_->threshold,
+                       &edge_)) {
           edge_.ratio += outer_;  // Convert to global ratio space.
           if (edge_.ratio >= job_->to &&
               (edge_.ratio < job_->from || job_->from >= 1.f + outer_)) {
@@ -177,5 +286,175 @@ const TrackTriggeringJob::Iterator& TrackTriggeringJob::Iterator::operator++() {
 
   return *this;
 }
+
+BatchTrackTriggeringJob::BatchTrackTriggeringJob() {}
+
+bool BatchTrackTriggeringJob::Validate() const {
+  bool valid = counts.size() >= queries.size();
+  for (const Query& query : queries) {
+    valid &= query.track != nullptr && !query.track->quantized();
+  }
+  return valid;
+}
+
+namespace {
+
+// Returns crossing mask of the 4 keyframe pairs (_i - 1 + j, _i + j), where bit
+// j is set if the pair crosses _threshold. Same test as DetectEdge.
+inline int CrossingMask(const float* _values, ptrdiff_t _i,
+                        math::_SimdFloat4 _threshold) {
+  const math::SimdInt4 above0 =
+      math::CmpGt(math::simd_float4::LoadPtrU(_values + _i - 1), _threshold);
+  const math::SimdInt4 above1 =
+      math::CmpGt(math::simd_float4::LoadPtrU(_values + _i), _threshold);
+  return math::MoveMask(math::Xor(above0, above1));
+}
+
+// Outputs edges to the job buffer, counting overflowing ones.
+class EdgeWriter {
+ public:
+  explicit EdgeWriter(const span<TrackTriggeringJob::Edge>& _edges)
+      : edges_(_edges), size_(0) {}
+
+  bool Push(const TrackTriggeringJob::Edge& _edge) {
+    if (size_ == edges_.size()) {
+      return false;
+    }
+    edges_[size_++] = _edge;
+    return true;
+  }
+
+  size_t size() const { return size_; }
+
+ private:
+  span<TrackTriggeringJob::Edge> edges_;
+  size_t size_;
+};
+
+// Detects edges of a query and pushes them to _writer, in the same order and
+// with the same filtering rules as TrackTriggeringJob::Iterator. Returns false
+// if _writer is full.
+bool TriggerQuery(const BatchTrackTriggeringJob::Query& _query,
+                  EdgeWriter* _writer) {
+  const FloatTrack& track = *_query.track;
+  const float* values = track.values().data();
+  const span<const float>& ratios = track.ratios();
+  const ptrdiff_t num_keys = ratios.size();
+  const float from = _query.from;
+  const float to = _query.to;
+  if (from == to || num_keys == 0) {
+    return true;
+  }
+
+  const math::SimdFloat4 threshold = math::simd_float4::Load1(_query.threshold);
+  float outer = floorf(from);
+
+  // Keyframes (hence edges) before "from" ratio don't need to be tested on
+  // the first loop. One extra keyframe is kept as a margin for the floating
+  // point rounding of the edge ratio.
+  const ptrdiff_t lower =
+      std::lower_bound(ratios.begin(), ratios.end(), from,
+                       [outer](float _ratio, float _value) {
+                         return _ratio + outer < _value;
+                       }) -
+      ratios.begin();
+
+  TrackTriggeringJob::Edge edge;
+  if (to > from) {
+    ptrdiff_t start = lower > 0 ? lower - 1 : 0;
+    for (; outer < to; outer += 1.f) {
+      for (ptrdiff_t inner = start; inner < num_keys;) {
+        // Tests 4 keyframes at a time, first one and the remaining ones are
+        // tested individually.
+        int mask;
+        ptrdiff_t width;
+        if (inner > 0 && inner + 4 <= num_keys) {
+          mask = CrossingMask(values, inner, threshold);
+          width = 4;
+        } else {
+          mask = 1;  // DetectEdge does the test.
+          width = 1;
+        }
+        for (ptrdiff_t j = 0; mask != 0; ++j, mask >>= 1) {
+          if ((mask & 1) == 0) {
+            continue;
+          }
+          const ptrdiff_t i1 = inner + j;
+          const ptrdiff_t i0 = i1 == 0 ? num_keys - 1 : i1 - 1;
+          if (!DetectEdge(i0, i1, true, track, _query.threshold, &edge)) {
+            continue;
+          }
+          edge.ratio += outer;  // Convert to global ratio space.
+          if (edge.ratio >= from && (edge.ratio < to || to >= 1.f + outer)) {
+            if (!_writer->Push(edge)) {
+              return false;
+            }
+          } else if (edge.ratio >= to) {
+            return true;  // Won't find any further edge.
+          }
+        }
+        inner += width;
+      }
+      start = 0;  // Ready for next loop.
+    }
+  } else {
+    ptrdiff_t start = lower + 1 < num_keys ? lower + 1 : num_keys - 1;
+    for (; outer + 1.f > to; outer -= 1.f) {
+      for (ptrdiff_t inner = start; inner >= 0;) {
+        // Tests 4 keyframes at a time, ending with inner, from the last one.
+        int mask;
+        ptrdiff_t width;
+        if (inner >= 4) {
+          mask = CrossingMask(values, inner - 3, threshold);
+          width = 4;
+        } else {
+          mask = 8;  // DetectEdge does the test.
+          width = 1;
+        }
+        for (ptrdiff_t j = 3; mask != 0; --j, mask = (mask << 1) & 0xf) {
+          if ((mask & 8) == 0) {
+            continue;
+          }
+          const ptrdiff_t i1 = inner - 3 + j;
+          const ptrdiff_t i0 = i1 == 0 ? num_keys - 1 : i1 - 1;
+          if (!DetectEdge(i0, i1, false, track, _query.threshold, &edge)) {
+            continue;
+          }
+          edge.ratio += outer;  // Convert to global ratio space.
+          if (edge.ratio >= to && (edge.ratio < from || from >= 1.f + outer)) {
+            if (!_writer->Push(edge)) {
+              return false;
+            }
+          } else if (edge.ratio < to) {
+            return true;  // Won't find any further edge.
+          }
+        }
+        inner -= width;
+      }
+      start = num_keys - 1;  // Ready for next loop.
+    }
+  }
+  return true;
+}
+}  // namespace
+
+bool BatchTrackTriggeringJob::Run() const {
+  OZZ_PROFILE_ZONE("BatchTrackTriggeringJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  EdgeWriter writer(edges);
+  bool success = true;
+  for (size_t i = 0; i < queries.size(); ++i) {
+    const size_t first = writer.size();
+    if (success) {
+      success = TriggerQuery(queries[i], &writer);
+    }
+    counts[i] = static_cast<uint32_t>(writer.size() - first);
+  }
+  return success;
+}
 }  // namespace animation
 }  // namespace ozz
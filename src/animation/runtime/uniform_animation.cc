@@ -0,0 +1,177 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/uniform_animation.h"
+
+#include <cassert>
+#include <cstring>
+#include <utility>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/log.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+namespace ozz {
+namespace animation {
+
+UniformAnimation::UniformAnimation(memory::Allocator* _allocator)
+    : duration_(0.f),
+      num_tracks_(0),
+      num_frames_(0),
+      name_(nullptr),
+      allocator_(_allocator) {}
+
+UniformAnimation::UniformAnimation(UniformAnimation&& _other)
+    : UniformAnimation() {
+  *this = std::move(_other);
+}
+
+UniformAnimation& UniformAnimation::operator=(UniformAnimation&& _other) {
+  std::swap(duration_, _other.duration_);
+  std::swap(num_tracks_, _other.num_tracks_);
+  std::swap(num_frames_, _other.num_frames_);
+  std::swap(ranges_, _other.ranges_);
+  std::swap(frames_, _other.frames_);
+  std::swap(name_, _other.name_);
+  std::swap(allocator_, _other.allocator_);
+  return *this;
+}
+
+UniformAnimation::~UniformAnimation() { Deallocate(); }
+
+void UniformAnimation::Allocate(size_t _name_len, int _num_tracks,
+                                int _num_frames) {
+  assert(ranges_.empty() && frames_.empty());
+
+  // Ranges are loaded as SIMD vectors, hence 16 bytes aligned, and followed by
+  // 2 bytes aligned frames.
+  static_assert(alignof(float) >= alignof(uint16_t) &&
+                    alignof(uint16_t) >= alignof(char),
+                "Must serve larger alignment values first");
+
+  num_tracks_ = _num_tracks;
+  num_frames_ = _num_frames;
+  const size_t num_values =
+      static_cast<size_t>(num_soa_tracks()) * kComponents * 4;
+  const size_t num_ranges = num_values * 2;
+  const size_t num_frame_values = num_values * _num_frames;
+
+  // Compute overall size and allocate a single buffer for all the data.
+  const size_t buffer_size = num_ranges * sizeof(float) +
+                             num_frame_values * sizeof(uint16_t) +
+                             (_name_len > 0 ? _name_len + 1 : 0);
+  const memory::TagScope memory_tag(memory::kTagAnimation);
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  span<byte> buffer = {
+      static_cast<byte*>(allocator->Allocate(buffer_size, 16)), buffer_size};
+
+  // Fix up pointers. Serves larger alignment values first.
+  ranges_ = fill_span<float>(buffer, num_ranges);
+  frames_ = fill_span<uint16_t>(buffer, num_frame_values);
+
+  // Let name be nullptr if animation has no name.
+  name_ = _name_len > 0 ? fill_span<char>(buffer, _name_len + 1).data()
+                        : nullptr;
+
+  assert(buffer.empty() && "Whole buffer should be consumned");
+}
+
+void UniformAnimation::Deallocate() {
+  // Deallocate everything at once.
+  memory::Allocator* allocator =
+      allocator_ ? allocator_ : memory::default_allocator();
+  allocator->Deallocate(as_writable_bytes(ranges_).data());
+
+  duration_ = 0.f;
+  num_tracks_ = 0;
+  num_frames_ = 0;
+  ranges_ = {};
+  frames_ = {};
+  name_ = nullptr;
+}
+
+size_t UniformAnimation::size() const {
+  const size_t size =
+      sizeof(*this) + ranges_.size_bytes() + frames_.size_bytes();
+  return size;
+}
+
+void UniformAnimation::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
+  _archive << static_cast<int32_t>(num_frames_);
+
+  const size_t name_len = name_ ? std::strlen(name_) : 0;
+  _archive << static_cast<int32_t>(name_len);
+  _archive << ozz::io::MakeArray(name_, name_len);
+
+  _archive << ozz::io::MakeArray(ranges_);
+  _archive << ozz::io::MakeArray(frames_);
+}
+
+void UniformAnimation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
+  // Destroy animation in case it was already used before.
+  Deallocate();
+
+  if (_version != 1) {
+    log::Err() << "Unsupported UniformAnimation version " << _version << "."
+               << std::endl;
+    return;
+  }
+
+  float duration;
+  _archive >> duration;
+
+  int32_t num_tracks, num_frames;
+  _archive >> num_tracks;
+  _archive >> num_frames;
+
+  int32_t name_len;
+  _archive >> name_len;
+
+  // Sampling relies on having at least 2 frames to interpolate.
+  if (num_tracks < 0 || name_len < 0 ||
+      (num_tracks > 0 && num_frames < 2)) {
+    log::Err() << "Invalid UniformAnimation data." << std::endl;
+    return;
+  }
+
+  Allocate(name_len, num_tracks, num_frames);
+  duration_ = duration;
+
+  if (name_) {  // nullptr name_ is supported.
+    _archive >> ozz::io::MakeArray(name_, name_len);
+    name_[name_len] = 0;
+  }
+
+  _archive >> ozz::io::MakeArray(ranges_);
+  _archive >> ozz::io::MakeArray(frames_);
+}
+}  // namespace animation
+}  // namespace ozz
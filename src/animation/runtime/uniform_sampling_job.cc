@@ -0,0 +1,119 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/uniform_sampling_job.h"
+
+#include <algorithm>
+
+#include "ozz/animation/runtime/uniform_animation.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Loads 4 quantized values to a SIMD vector.
+OZZ_INLINE math::SimdFloat4 LoadQuantized(const uint16_t* _values) {
+  return math::simd_float4::FromInt(
+      math::simd_int4::Load(_values[0], _values[1], _values[2], _values[3]));
+}
+}  // namespace
+
+UniformSamplingJob::UniformSamplingJob() : ratio(0.f), animation(nullptr) {}
+
+bool UniformSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for nullptr pointers.
+  if (!animation) {
+    return false;
+  }
+  valid &= !output.empty();
+
+  return valid;
+}
+
+bool UniformSamplingJob::Run() const {
+  OZZ_PROFILE_ZONE("UniformSamplingJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = std::min(animation->num_soa_tracks(),
+                                      static_cast<int>(output.size()));
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+
+  // Finds surrounding frames by direct indexing.
+  const float anim_ratio = math::Clamp(0.f, ratio, 1.f);
+  const int last = animation->num_frames() - 1;
+  const float frame = anim_ratio * last;
+  const int frame0 = std::min(static_cast<int>(frame), last - 1);
+  const math::SimdFloat4 alpha =
+      math::simd_float4::Load1(frame - static_cast<float>(frame0));
+
+  const int stride =
+      animation->num_soa_tracks() * UniformAnimation::kComponents * 4;
+  const uint16_t* values0 = animation->frames().data() + frame0 * stride;
+  const uint16_t* values1 = values0 + stride;
+  const float* ranges = animation->ranges().data();
+
+  for (int i = 0; i < num_soa_tracks; ++i) {
+    // Dequantizes and interpolates all components. As both frames share the
+    // same range, quantized values are interpolated before being scaled.
+    math::SimdFloat4 components[UniformAnimation::kComponents];
+    for (int c = 0; c < UniformAnimation::kComponents; ++c) {
+      const math::SimdFloat4 q0 = LoadQuantized(values0);
+      const math::SimdFloat4 q1 = LoadQuantized(values1);
+      const math::SimdFloat4 q = math::MAdd(q1 - q0, alpha, q0);
+      const math::SimdFloat4 min = math::simd_float4::LoadPtr(ranges);
+      const math::SimdFloat4 step = math::simd_float4::LoadPtr(ranges + 4);
+      components[c] = math::MAdd(step, q, min);
+      values0 += 4;
+      values1 += 4;
+      ranges += 8;
+    }
+
+    math::SoaTransform& transform = output[i];
+    transform.translation = {components[0], components[1], components[2]};
+    transform.rotation = math::NormalizeEst(math::SoaQuaternion{
+        components[3], components[4], components[5], components[6]});
+    transform.scale = {components[7], components[8], components[9]};
+  }
+
+  return true;
+}
+}  // namespace animation
+}  // namespace ozz
@@ -0,0 +1,248 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/update_rate_scheduler.h"
+
+#include <cstring>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+namespace ozz {
+namespace animation {
+
+UpdateRateScheduler::UpdateRateScheduler()
+    : skeleton_(nullptr),
+      num_instances_(0),
+      num_updates_(0),
+      frame_(0),
+      phase_counters_(),
+      buffer_(nullptr),
+      locals_(nullptr),
+      keys_(nullptr),
+      models_(nullptr),
+      instances_(nullptr) {}
+
+UpdateRateScheduler::~UpdateRateScheduler() { Deallocate(); }
+
+bool UpdateRateScheduler::Allocate(const Skeleton& _skeleton,
+                                   int _num_instances, bool _cubic) {
+  Deallocate();
+  if (_num_instances <= 0 || _skeleton.num_joints() == 0) {
+    return false;
+  }
+
+  // Computes buffers layout, biggest alignment first.
+  const size_t locals_size =
+      sizeof(math::SoaTransform) * _skeleton.num_soa_joints();
+  const size_t poses_size =
+      sizeof(math::Float4x4) * _skeleton.num_joints() * _num_instances;
+  const size_t instances_size = sizeof(Instance) * _num_instances;
+  static_assert(alignof(math::SoaTransform) >= alignof(math::Float4x4) &&
+                    alignof(math::Float4x4) >= alignof(Instance),
+                "Must serve each type alignment requirement.");
+
+  const memory::TagScope memory_tag(memory::kTagContext);
+  buffer_ = memory::default_allocator()->Allocate(
+      locals_size + poses_size * 3 + instances_size,
+      alignof(math::SoaTransform));
+  byte* alloc_cursor = static_cast<byte*>(buffer_);
+  locals_ = reinterpret_cast<math::SoaTransform*>(alloc_cursor);
+  alloc_cursor += locals_size;
+  keys_ = reinterpret_cast<math::Float4x4*>(alloc_cursor);
+  alloc_cursor += poses_size * 2;
+  models_ = reinterpret_cast<math::Float4x4*>(alloc_cursor);
+  alloc_cursor += poses_size;
+  instances_ = reinterpret_cast<Instance*>(alloc_cursor);
+
+  for (int i = 0; i < _num_instances; ++i) {
+    const Instance instance = {nullptr, 1, 0, 0, true, false};
+    instances_[i] = instance;
+  }
+  phase_counters_[1] = _num_instances;
+
+  skeleton_ = &_skeleton;
+  num_instances_ = _num_instances;
+  contexts_.Resize(_num_instances, _skeleton.num_joints(), _cubic);
+
+  return true;
+}
+
+void UpdateRateScheduler::Deallocate() {
+  memory::default_allocator()->Deallocate(buffer_);
+  contexts_.Resize(0, 0);
+  skeleton_ = nullptr;
+  num_instances_ = 0;
+  num_updates_ = 0;
+  frame_ = 0;
+  std::memset(phase_counters_, 0, sizeof(phase_counters_));
+  buffer_ = nullptr;
+  locals_ = nullptr;
+  keys_ = nullptr;
+  models_ = nullptr;
+  instances_ = nullptr;
+}
+
+int UpdateRateScheduler::PeriodFromDistance(float _distance,
+                                            float _full_rate_distance,
+                                            int _max_period) {
+  const int max_period = _max_period < kMaxPeriod ? _max_period : kMaxPeriod;
+  int period = 1;
+  for (float distance = _full_rate_distance;
+       _distance > distance && period * 2 <= max_period; distance *= 2.f) {
+    period *= 2;
+  }
+  return period;
+}
+
+bool UpdateRateScheduler::set_animation(int _instance,
+                                        const Animation* _animation) {
+  if (_instance < 0 || _instance >= num_instances_ ||
+      (_animation && _animation->num_tracks() != skeleton_->num_joints())) {
+    return false;
+  }
+  Instance& instance = instances_[_instance];
+  if (instance.animation != _animation) {
+    instance.animation = _animation;
+    instance.snap = true;
+    instance.valid = false;
+  }
+  return true;
+}
+
+bool UpdateRateScheduler::set_period(int _instance, int _period) {
+  if (_instance < 0 || _instance >= num_instances_) {
+    return false;
+  }
+  const int period =
+      _period < 1 ? 1 : (_period > kMaxPeriod ? kMaxPeriod : _period);
+  Instance& instance = instances_[_instance];
+  if (instance.period != period) {
+    --phase_counters_[instance.period];
+    instance.period = period;
+    // Phases are assigned round robin, so that updates of instances sharing
+    // a period are spread over the period frames.
+    instance.phase = phase_counters_[period]++ % period;
+    instance.snap = true;
+  }
+  return true;
+}
+
+int UpdateRateScheduler::period(int _instance) const {
+  if (_instance < 0 || _instance >= num_instances_) {
+    return 0;
+  }
+  return instances_[_instance].period;
+}
+
+math::Float4x4* UpdateRateScheduler::key(int _instance, int _key) const {
+  return keys_ + (_instance * 2 + _key) * skeleton_->num_joints();
+}
+
+bool UpdateRateScheduler::Update(span<const float> _ratios) {
+  num_updates_ = 0;
+  if (!skeleton_ || _ratios.size() < static_cast<size_t>(num_instances_)) {
+    return false;
+  }
+
+  bool success = true;
+  const int num_joints = skeleton_->num_joints();
+  for (int i = 0; i < num_instances_; ++i) {
+    Instance& instance = instances_[i];
+    if (!instance.animation) {
+      continue;
+    }
+
+    // Samples instance if it's due for an update.
+    const int elapsed = (frame_ + instance.phase) % instance.period;
+    if (elapsed == 0 || instance.snap) {
+      SamplingJob sampling_job;
+      sampling_job.animation = instance.animation;
+      sampling_job.context = &contexts_.contexts()[i];
+      sampling_job.ratio = _ratios[i];
+      sampling_job.output = {locals_,
+                             static_cast<size_t>(skeleton_->num_soa_joints())};
+
+      LocalToModelJob ltm_job;
+      ltm_job.skeleton = skeleton_;
+      ltm_job.input = sampling_job.output;
+      ltm_job.output = {key(i, instance.latest ^ 1),
+                        static_cast<size_t>(num_joints)};
+      if (!sampling_job.Run() || !ltm_job.Run()) {
+        success = false;
+        continue;
+      }
+      instance.latest ^= 1;
+      if (instance.snap) {
+        std::memcpy(key(i, instance.latest ^ 1), key(i, instance.latest),
+                    sizeof(math::Float4x4) * num_joints);
+        instance.snap = false;
+      }
+      instance.valid = true;
+      ++num_updates_;
+    }
+    if (!instance.valid) {
+      continue;
+    }
+
+    // Interpolates from the previous to the latest key pose, which is reached
+    // on the frame preceding next update.
+    const math::Float4x4* previous = key(i, instance.latest ^ 1);
+    const math::Float4x4* latest = key(i, instance.latest);
+    math::Float4x4* output = models_ + i * num_joints;
+    if (elapsed + 1 == instance.period) {
+      std::memcpy(output, latest, sizeof(math::Float4x4) * num_joints);
+      continue;
+    }
+    const math::SimdFloat4 alpha = math::simd_float4::Load1(
+        static_cast<float>(elapsed + 1) / instance.period);
+    for (int j = 0; j < num_joints; ++j) {
+      for (int c = 0; c < 4; ++c) {
+        output[j].cols[c] =
+            math::Lerp(previous[j].cols[c], latest[j].cols[c], alpha);
+      }
+    }
+  }
+  ++frame_;
+  return success;
+}
+
+span<const math::Float4x4> UpdateRateScheduler::models(int _instance) const {
+  if (_instance < 0 || _instance >= num_instances_ ||
+      !instances_[_instance].valid) {
+    return {};
+  }
+  const size_t num_joints = skeleton_->num_joints();
+  return {models_ + _instance * num_joints, num_joints};
+}
+}  // namespace animation
+}  // namespace ozz
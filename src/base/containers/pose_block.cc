@@ -0,0 +1,152 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/containers/pose_block.h"
+
+#include <utility>
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+
+namespace {
+size_t CacheAlign(size_t _size) {
+  return (_size + PoseBlock::kCacheLineSize - 1) &
+         ~static_cast<size_t>(PoseBlock::kCacheLineSize - 1);
+}
+}  // namespace
+
+PoseBlock::PoseBlock()
+    : num_joints_(0),
+      num_local_poses_(0),
+      locals_stride_(0),
+      matrices_stride_(0),
+      block_(nullptr),
+      size_(0) {}
+
+PoseBlock::PoseBlock(int _num_joints, int _num_local_poses) : PoseBlock() {
+  Resize(_num_joints, _num_local_poses);
+}
+
+PoseBlock::PoseBlock(PoseBlock&& _other) : PoseBlock() {
+  *this = std::move(_other);
+}
+
+PoseBlock& PoseBlock::operator=(PoseBlock&& _other) {
+  std::swap(num_joints_, _other.num_joints_);
+  std::swap(num_local_poses_, _other.num_local_poses_);
+  std::swap(locals_stride_, _other.locals_stride_);
+  std::swap(matrices_stride_, _other.matrices_stride_);
+  std::swap(block_, _other.block_);
+  std::swap(size_, _other.size_);
+  return *this;
+}
+
+PoseBlock::~PoseBlock() { Release(); }
+
+void PoseBlock::Release() {
+  if (block_) {
+    memory::default_allocator()->Deallocate(block_);
+  }
+  block_ = nullptr;
+  size_ = 0;
+  num_joints_ = 0;
+  num_local_poses_ = 0;
+  locals_stride_ = 0;
+  matrices_stride_ = 0;
+}
+
+bool PoseBlock::Resize(int _num_joints, int _num_local_poses) {
+  Release();
+  if (_num_joints < 0 || _num_local_poses < 0) {
+    return false;
+  }
+
+  const int num_soa_joints = (_num_joints + 3) / 4;
+  locals_stride_ = CacheAlign(sizeof(math::SoaTransform) * num_soa_joints);
+  matrices_stride_ = CacheAlign(sizeof(math::Float4x4) * _num_joints);
+  size_ = locals_stride_ * _num_local_poses + matrices_stride_ * 2;
+  num_joints_ = _num_joints;
+  num_local_poses_ = _num_local_poses;
+  if (size_ == 0) {
+    return true;
+  }
+  block_ = static_cast<byte*>(
+      memory::default_allocator()->Allocate(size_, kCacheLineSize));
+
+  // Initializes buffers to identity.
+  for (int i = 0; i < _num_local_poses; ++i) {
+    for (math::SoaTransform& transform : locals(i)) {
+      transform = math::SoaTransform::identity();
+    }
+  }
+  for (math::Float4x4& matrix : models()) {
+    matrix = math::Float4x4::identity();
+  }
+  for (math::Float4x4& matrix : palette()) {
+    matrix = math::Float4x4::identity();
+  }
+  return true;
+}
+
+span<math::SoaTransform> PoseBlock::locals(int _pose) {
+  if (_pose < 0 || _pose >= num_local_poses_) {
+    return span<math::SoaTransform>();
+  }
+  return span<math::SoaTransform>(
+      reinterpret_cast<math::SoaTransform*>(block_ + locals_stride_ * _pose),
+      num_soa_joints());
+}
+
+span<const math::SoaTransform> PoseBlock::locals(int _pose) const {
+  return const_cast<PoseBlock*>(this)->locals(_pose);
+}
+
+span<math::Float4x4> PoseBlock::models() {
+  return span<math::Float4x4>(
+      reinterpret_cast<math::Float4x4*>(block_ +
+                                        locals_stride_ * num_local_poses_),
+      num_joints_);
+}
+
+span<const math::Float4x4> PoseBlock::models() const {
+  return const_cast<PoseBlock*>(this)->models();
+}
+
+span<math::Float4x4> PoseBlock::palette() {
+  return span<math::Float4x4>(
+      reinterpret_cast<math::Float4x4*>(
+          block_ + locals_stride_ * num_local_poses_ + matrices_stride_),
+      num_joints_);
+}
+
+span<const math::Float4x4> PoseBlock::palette() const {
+  return const_cast<PoseBlock*>(this)->palette();
+}
+}  // namespace ozz
@@ -0,0 +1,112 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/endianness.h"
+
+#include <cstring>
+
+#include "ozz/base/maths/internal/simd_math_config.h"
+
+namespace ozz {
+
+namespace {
+// Swaps the remaining elements that don't fill a whole SIMD register.
+void EndianSwap16Scalar(byte* _data, size_t _count) {
+  for (size_t i = 0; i < _count; ++i, _data += 2) {
+    uint16_t v;
+    std::memcpy(&v, _data, sizeof(v));
+    v = static_cast<uint16_t>((v << 8) | (v >> 8));
+    std::memcpy(_data, &v, sizeof(v));
+  }
+}
+
+void EndianSwap32Scalar(byte* _data, size_t _count) {
+  for (size_t i = 0; i < _count; ++i, _data += 4) {
+    uint32_t v;
+    std::memcpy(&v, _data, sizeof(v));
+    v = (v << 24) | ((v << 8) & 0x00ff0000) | ((v >> 8) & 0x0000ff00) |
+        (v >> 24);
+    std::memcpy(_data, &v, sizeof(v));
+  }
+}
+}  // namespace
+
+void EndianSwap16(void* _data, size_t _count) {
+  byte* data = static_cast<byte*>(_data);
+  size_t i = 0;
+#if defined(OZZ_SIMD_SSSE3)
+  const __m128i shuffle =
+      _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+  for (; i + 8 <= _count; i += 8, data += 16) {
+    __m128i* p = reinterpret_cast<__m128i*>(data);
+    _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), shuffle));
+  }
+#elif defined(OZZ_SIMD_SSE2)
+  for (; i + 8 <= _count; i += 8, data += 16) {
+    __m128i* p = reinterpret_cast<__m128i*>(data);
+    const __m128i v = _mm_loadu_si128(p);
+    _mm_storeu_si128(p, _mm_or_si128(_mm_slli_epi16(v, 8),
+                                     _mm_srli_epi16(v, 8)));
+  }
+#elif defined(OZZ_SIMD_NEON)
+  for (; i + 8 <= _count; i += 8, data += 16) {
+    uint8_t* p = reinterpret_cast<uint8_t*>(data);
+    vst1q_u8(p, vrev16q_u8(vld1q_u8(p)));
+  }
+#endif
+  EndianSwap16Scalar(data, _count - i);
+}
+
+void EndianSwap32(void* _data, size_t _count) {
+  byte* data = static_cast<byte*>(_data);
+  size_t i = 0;
+#if defined(OZZ_SIMD_SSSE3)
+  const __m128i shuffle =
+      _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+  for (; i + 4 <= _count; i += 4, data += 16) {
+    __m128i* p = reinterpret_cast<__m128i*>(data);
+    _mm_storeu_si128(p, _mm_shuffle_epi8(_mm_loadu_si128(p), shuffle));
+  }
+#elif defined(OZZ_SIMD_SSE2)
+  for (; i + 4 <= _count; i += 4, data += 16) {
+    __m128i* p = reinterpret_cast<__m128i*>(data);
+    // Swaps 16 bits halves, then bytes of each half.
+    const __m128i v = _mm_shufflehi_epi16(
+        _mm_shufflelo_epi16(_mm_loadu_si128(p), _MM_SHUFFLE(2, 3, 0, 1)),
+        _MM_SHUFFLE(2, 3, 0, 1));
+    _mm_storeu_si128(p, _mm_or_si128(_mm_slli_epi16(v, 8),
+                                     _mm_srli_epi16(v, 8)));
+  }
+#elif defined(OZZ_SIMD_NEON)
+  for (; i + 4 <= _count; i += 4, data += 16) {
+    uint8_t* p = reinterpret_cast<uint8_t*>(data);
+    vst1q_u8(p, vrev32q_u8(vld1q_u8(p)));
+  }
+#endif
+  EndianSwap32Scalar(data, _count - i);
+}
+}  // namespace ozz
@@ -29,29 +29,79 @@
 
 #include <cassert>
 
+#include "ozz/base/io/compressed_stream.h"
+#include "ozz/base/log.h"
+#include "ozz/base/memory/allocator.h"
+
 namespace ozz {
 namespace io {
 
 // OArchive implementation.
 
-OArchive::OArchive(Stream* _stream, Endianness _endianness)
-    : stream_(_stream), endian_swap_(_endianness != GetNativeEndianness()) {
+OArchive::OArchive(Stream* _stream, Endianness _endianness, bool _compressed)
+    : stream_(_stream),
+      compressed_(nullptr),
+      endian_swap_(_endianness != GetNativeEndianness()) {
   assert(stream_ && stream_->opened() &&
          "_stream argument must point a valid opened stream.");
+  if (_compressed) {
+    compressed_ = New<CompressedStream>(_stream, CompressedStream::kWrite);
+    stream_ = compressed_;
+  }
   // Save as a single byte as it does not need to be swapped.
   uint8_t endianness = static_cast<uint8_t>(_endianness);
   *this << endianness;
 }
 
+OArchive::~OArchive() { Delete(compressed_); }
+
 // IArchive implementation.
 
-IArchive::IArchive(Stream* _stream) : stream_(_stream), endian_swap_(false) {
+IArchive::IArchive(Stream* _stream)
+    : stream_(_stream),
+      compressed_(nullptr),
+      endian_swap_(false),
+      legacy_versions_(true),
+      parallel_for_(nullptr),
+      parallel_for_user_data_(nullptr) {
   assert(stream_ && stream_->opened() &&
          "_stream argument must point a valid opened stream.");
+  // Compressed stream magic can't be mistaken with the endianness byte.
+  if (CompressedStream::Test(_stream)) {
+    compressed_ = New<CompressedStream>(_stream, CompressedStream::kRead);
+    stream_ = compressed_;
+  }
   // Endianness was saved as a single byte, as it does not need to be swapped.
   uint8_t endianness;
   *this >> endianness;
   endian_swap_ = endianness != GetNativeEndianness();
 }
+
+IArchive::~IArchive() { Delete(compressed_); }
+
+void IArchive::set_parallel_for(ParallelFor _parallel_for, void* _user_data) {
+  parallel_for_ = _parallel_for;
+  parallel_for_user_data_ = _user_data;
+  if (compressed_) {
+    compressed_->set_parallel_for(_parallel_for, _user_data);
+  }
+}
+
+void IArchive::RunTasks(int _count, ParallelForTask _task,
+                        void* _task_data) const {
+  if (parallel_for_) {
+    parallel_for_(_count, _task, _task_data, parallel_for_user_data_);
+  } else {
+    for (int i = 0; i < _count; ++i) {
+      _task(i, _task_data);
+    }
+  }
+}
+
+uint32_t IArchive::RejectVersion(uint32_t _version) {
+  log::Err() << "Legacy archive object version " << _version
+             << " is rejected, archive must be upgraded." << std::endl;
+  return 0;
+}
 }  // namespace io
 }  // namespace ozz
@@ -0,0 +1,133 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/asset_registry.h"
+
+#include <mutex>
+
+#include "ozz/base/containers/unordered_map.h"
+
+namespace ozz {
+namespace io {
+namespace internal {
+
+struct AssetTable::Internal {
+  // Guards entries table and references count.
+  mutable std::mutex mutex;
+  ozz::unordered_map<uint64_t, AssetEntry*> entries;
+};
+
+AssetTable::AssetTable() : internal_(New<Internal>()) {}
+
+AssetTable::~AssetTable() {
+  assert(internal_->entries.empty() && "All assets must be released.");
+  for (auto& entry : internal_->entries) {
+    Delete(entry.second);
+  }
+  Delete(internal_);
+}
+
+size_t AssetTable::size() const {
+  std::lock_guard<std::mutex> lock(internal_->mutex);
+  return internal_->entries.size();
+}
+
+bool AssetTable::ReadContent(Stream* _stream, MemoryStream* _content,
+                             uint64_t* _hash) {
+  if (!_stream || !_stream->opened()) {
+    return false;
+  }
+
+  // 64 bits FNV-1a, computed while content is copied by chunks.
+  uint64_t hash = 14695981039346656037ull;
+  size_t size = 0;
+  byte chunk[4096];
+  for (;;) {
+    const size_t read = _stream->Read(chunk, sizeof(chunk));
+    if (read == 0) {
+      break;
+    }
+    for (size_t i = 0; i < read; ++i) {
+      hash = (hash ^ chunk[i]) * 1099511628211ull;
+    }
+    if (_content->Write(chunk, read) != read) {
+      return false;
+    }
+    size += read;
+  }
+  *_hash = hash;
+  return size != 0;
+}
+
+AssetEntry* AssetTable::Acquire(uint64_t _hash, Create _create,
+                                bool* _created) {
+  std::lock_guard<std::mutex> lock(internal_->mutex);
+  AssetEntry*& entry = internal_->entries[_hash];
+  *_created = entry == nullptr;
+  if (*_created) {
+    entry = _create();
+    entry->hash_ = _hash;
+  }
+  ++entry->references_;
+  return entry;
+}
+
+AssetEntry* AssetTable::Find(uint64_t _hash) {
+  std::lock_guard<std::mutex> lock(internal_->mutex);
+  const auto it = internal_->entries.find(_hash);
+  if (it == internal_->entries.end()) {
+    return nullptr;
+  }
+  ++it->second->references_;
+  return it->second;
+}
+
+void AssetTable::Publish(AssetEntry* _entry, AsyncStatus _status) {
+  assert(_status != kAsyncPending);
+  _entry->status_.store(_status, std::memory_order_release);
+}
+
+void AssetTable::Release(const AssetEntry* _entry) {
+  if (!_entry) {
+    return;
+  }
+  AssetEntry* entry = const_cast<AssetEntry*>(_entry);
+  {
+    std::lock_guard<std::mutex> lock(internal_->mutex);
+    assert(entry->references_ > 0 && "Asset was already released.");
+    if (--entry->references_ != 0) {
+      return;
+    }
+    internal_->entries.erase(entry->hash_);
+  }
+  // Last reference is released, so no other thread can access the entry
+  // anymore.
+  Delete(entry);
+}
+}  // namespace internal
+}  // namespace io
+}  // namespace ozz
@@ -0,0 +1,94 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/async_load.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace io {
+
+namespace {
+// Read request, allocated with its file name that follows it in memory.
+struct AsyncReadRequest {
+  AsyncReader::Completion completion;
+  void* user_data;
+  size_t buffer_size;
+  const char* filename() const {
+    return reinterpret_cast<const char*>(this + 1);
+  }
+};
+}  // namespace
+
+FileAsyncReader::FileAsyncReader(Dispatch _dispatch, void* _user_data,
+                                 size_t _buffer_size)
+    : dispatch_(_dispatch),
+      user_data_(_user_data),
+      buffer_size_(_buffer_size) {}
+
+bool FileAsyncReader::Read(const char* _filename, Completion _completion,
+                           void* _user_data) {
+  if (!_filename || !_completion) {
+    return false;
+  }
+
+  const size_t filename_len = std::strlen(_filename);
+  AsyncReadRequest* request =
+      static_cast<AsyncReadRequest*>(memory::default_allocator()->Allocate(
+          sizeof(AsyncReadRequest) + filename_len + 1,
+          alignof(AsyncReadRequest)));
+  request->completion = _completion;
+  request->user_data = _user_data;
+  request->buffer_size = buffer_size_;
+  std::memcpy(request + 1, _filename, filename_len + 1);
+
+  if (dispatch_) {
+    dispatch_(&FileAsyncReader::ReadTask, request, user_data_);
+  } else {
+    ReadTask(request);
+  }
+  return true;
+}
+
+void FileAsyncReader::ReadTask(void* _data) {
+  AsyncReadRequest* request = static_cast<AsyncReadRequest*>(_data);
+  {
+    File file(request->filename(), "rb");
+    if (file.opened()) {
+      BufferedStream stream(&file, request->buffer_size);
+      request->completion(&stream, request->user_data);
+    } else {
+      request->completion(nullptr, request->user_data);
+    }
+  }
+  memory::default_allocator()->Deallocate(request);
+}
+}  // namespace io
+}  // namespace ozz
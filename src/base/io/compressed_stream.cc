@@ -0,0 +1,555 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/compressed_stream.h"
+
+#include <cassert>
+#include <cstring>
+#include <limits>
+
+namespace ozz {
+namespace io {
+
+namespace {
+
+// Compressed stream header layout, all values are little endian:
+// - 4 bytes magic, whose first byte can't be mistaken with an archive
+//   endianness tag.
+// - uint32_t uncompressed block size.
+// - uint64_t uncompressed stream size.
+// - uint64_t block table offset, from compressed stream beginning.
+// - uint32_t number of blocks.
+const char kCompressedMagic[4] = {'o', 'z', 'z', 'c'};
+const size_t kCompressedHeaderSize = 28;
+
+// Block table entry is a uint64_t offset and a uint32_t size.
+const size_t kCompressedBlockEntrySize = 12;
+
+void StoreLE(uint64_t _value, size_t _size, byte* _dest) {
+  for (size_t i = 0; i < _size; ++i) {
+    _dest[i] = static_cast<byte>(_value >> (i * 8));
+  }
+}
+
+uint64_t LoadLE(const byte* _src, size_t _size) {
+  uint64_t value = 0;
+  for (size_t i = 0; i < _size; ++i) {
+    value |= static_cast<uint64_t>(_src[i]) << (i * 8);
+  }
+  return value;
+}
+
+// LZ77 codec. A block is a sequence of:
+// - A token byte, whose high nibble is the literals count and low nibble is
+//   the match length minus kMinMatch. A nibble value of 15 is continued with
+//   extra bytes added to the length, until a byte different from 255.
+// - Literal bytes.
+// - Match offset, as 2 little endian bytes, followed by match length extra
+//   bytes. Last sequence has no match, it ends the block.
+const size_t kMinMatch = 4;
+const size_t kMaxOffset = 65535;
+const int kHashBits = 12;
+
+// Worst case compressed size, when no match is found.
+size_t CompressBound(size_t _size) { return _size + _size / 255 + 16; }
+
+uint32_t HashSequence(const byte* _src) {
+  uint32_t value;
+  std::memcpy(&value, _src, sizeof(value));
+  return (value * 2654435761u) >> (32 - kHashBits);
+}
+
+byte* WriteLength(size_t _length, byte* _dest) {
+  for (; _length >= 255; _length -= 255) {
+    *_dest++ = 255;
+  }
+  *_dest++ = static_cast<byte>(_length);
+  return _dest;
+}
+
+byte* WriteSequence(const byte* _literals, size_t _count, size_t _offset,
+                    size_t _match, byte* _dest) {
+  byte* token = _dest++;
+  *token = static_cast<byte>((_count < 15 ? _count : 15) << 4);
+  if (_count >= 15) {
+    _dest = WriteLength(_count - 15, _dest);
+  }
+  std::memcpy(_dest, _literals, _count);
+  _dest += _count;
+  if (_match != 0) {
+    const size_t length = _match - kMinMatch;
+    *token |= static_cast<byte>(length < 15 ? length : 15);
+    *_dest++ = static_cast<byte>(_offset);
+    *_dest++ = static_cast<byte>(_offset >> 8);
+    if (length >= 15) {
+      _dest = WriteLength(length - 15, _dest);
+    }
+  }
+  return _dest;
+}
+
+// Compresses _size bytes from _src to _dest, which must be at least
+// CompressBound(_size) bytes. Returns compressed size.
+size_t Compress(const byte* _src, size_t _size, byte* _dest) {
+  // Stores position + 1 of the last sequence for each hash, 0 being empty.
+  uint32_t table[1 << kHashBits] = {};
+  byte* out = _dest;
+  size_t anchor = 0;
+  size_t i = 0;
+  while (i + kMinMatch <= _size) {
+    const uint32_t hash = HashSequence(_src + i);
+    const size_t candidate = table[hash];
+    table[hash] = static_cast<uint32_t>(i + 1);
+    if (candidate == 0 || i + 1 - candidate > kMaxOffset ||
+        std::memcmp(_src + candidate - 1, _src + i, kMinMatch) != 0) {
+      ++i;
+      continue;
+    }
+    const size_t match = candidate - 1;
+    size_t length = kMinMatch;
+    while (i + length < _size && _src[match + length] == _src[i + length]) {
+      ++length;
+    }
+    out = WriteSequence(_src + anchor, i - anchor, i - match, length, out);
+    i += length;
+    anchor = i;
+  }
+  out = WriteSequence(_src + anchor, _size - anchor, 0, 0, out);
+  return static_cast<size_t>(out - _dest);
+}
+
+bool ReadLength(const byte** _src, const byte* _end, size_t* _length) {
+  for (;;) {
+    if (*_src == _end) {
+      return false;
+    }
+    const byte value = *(*_src)++;
+    *_length += value;
+    if (value != 255) {
+      return true;
+    }
+  }
+}
+
+// Decompresses _size bytes from _src to _dest, which must be _dest_size bytes.
+// Returns false if compressed data are corrupted.
+bool Decompress(const byte* _src, size_t _size, byte* _dest,
+                size_t _dest_size) {
+  const byte* in = _src;
+  const byte* in_end = _src + _size;
+  size_t out = 0;
+  while (in != in_end) {
+    const byte token = *in++;
+    size_t count = token >> 4;
+    if (count == 15 && !ReadLength(&in, in_end, &count)) {
+      return false;
+    }
+    if (count > static_cast<size_t>(in_end - in) || count > _dest_size - out) {
+      return false;
+    }
+    std::memcpy(_dest + out, in, count);
+    in += count;
+    out += count;
+    if (in == in_end) {
+      break;  // Last sequence has no match.
+    }
+    if (in_end - in < 2) {
+      return false;
+    }
+    const size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+    in += 2;
+    size_t length = token & 0xf;
+    if (length == 15 && !ReadLength(&in, in_end, &length)) {
+      return false;
+    }
+    length += kMinMatch;
+    if (offset == 0 || offset > out || length > _dest_size - out) {
+      return false;
+    }
+    // Copies byte per byte, as match can overlap output.
+    for (const byte* match = _dest + out - offset; length != 0; --length) {
+      _dest[out++] = *match++;
+    }
+  }
+  return out == _dest_size;
+}
+
+// Describes a block to decompress in parallel.
+struct ParallelBlock {
+  const byte* src;
+  size_t src_size;
+  byte* dest;
+  size_t dest_size;
+  bool success;
+};
+
+void DecompressBlockTask(int _task, void* _data) {
+  ParallelBlock& block = static_cast<ParallelBlock*>(_data)[_task];
+  if (block.src_size == block.dest_size) {  // Stored raw.
+    std::memcpy(block.dest, block.src, block.dest_size);
+    block.success = true;
+  } else {
+    block.success =
+        Decompress(block.src, block.src_size, block.dest, block.dest_size);
+  }
+}
+}  // namespace
+
+const size_t CompressedStream::kDefaultBlockSize = 64 << 10;
+
+bool CompressedStream::Test(Stream* _stream) {
+  const int64_t tell = _stream->Tell();
+  char magic[sizeof(kCompressedMagic)];
+  const bool valid =
+      _stream->Read(magic, sizeof(magic)) == sizeof(magic) &&
+      std::memcmp(magic, kCompressedMagic, sizeof(magic)) == 0;
+  _stream->Seek(tell, kSet);
+  return valid;
+}
+
+CompressedStream::CompressedStream(Stream* _stream, Mode _mode,
+                                   size_t _block_size)
+    : stream_(_stream),
+      mode_(_mode),
+      opened_(false),
+      origin_(_stream->Tell()),
+      block_size_(_block_size),
+      size_(0),
+      tell_(0),
+      parallel_for_(nullptr),
+      parallel_for_user_data_(nullptr),
+      loaded_(-1) {
+  assert(stream_ && stream_->opened() &&
+         "_stream argument must point a valid opened stream.");
+  byte header[kCompressedHeaderSize];
+  if (mode_ == kWrite) {
+    // Header is written again when closing.
+    if (block_size_ == 0 ||
+        block_size_ > std::numeric_limits<uint32_t>::max()) {
+      return;
+    }
+    std::memset(header, 0, sizeof(header));
+    opened_ = stream_->Write(header, sizeof(header)) == sizeof(header);
+    block_.reserve(block_size_);
+    compressed_.resize(CompressBound(block_size_));
+    return;
+  }
+
+  // Reads and validates header.
+  if (stream_->Read(header, sizeof(header)) != sizeof(header) ||
+      std::memcmp(header, kCompressedMagic, sizeof(kCompressedMagic)) != 0) {
+    return;
+  }
+  block_size_ = static_cast<size_t>(LoadLE(header + 4, 4));
+  size_ = LoadLE(header + 8, 8);
+  const uint64_t table_offset = LoadLE(header + 16, 8);
+  const uint64_t count = LoadLE(header + 24, 4);
+  const uint64_t stream_size = stream_->Size();
+  if (block_size_ == 0 ||
+      size_ > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) ||
+      count != (size_ + block_size_ - 1) / block_size_ ||
+      table_offset > stream_size ||
+      count * kCompressedBlockEntrySize > stream_size - table_offset ||
+      stream_->Seek(origin_ + static_cast<int64_t>(table_offset), kSet) != 0) {
+    return;
+  }
+
+  // Reads and validates block table.
+  blocks_.resize(static_cast<size_t>(count));
+  size_t max_compressed = 0;
+  for (size_t i = 0; i < blocks_.size(); ++i) {
+    byte entry[kCompressedBlockEntrySize];
+    if (stream_->Read(entry, sizeof(entry)) != sizeof(entry)) {
+      return;
+    }
+    Block& block = blocks_[i];
+    block.offset = LoadLE(entry, 8);
+    block.size = static_cast<uint32_t>(LoadLE(entry + 8, 4));
+    const uint64_t raw = size_ - static_cast<uint64_t>(i) * block_size_;
+    if (block.size > (raw < block_size_ ? raw : block_size_) ||
+        block.offset > table_offset ||
+        block.size > table_offset - block.offset) {
+      return;
+    }
+    max_compressed = block.size > max_compressed ? block.size : max_compressed;
+  }
+  compressed_.resize(max_compressed);
+  opened_ = true;
+}
+
+CompressedStream::~CompressedStream() { Close(); }
+
+bool CompressedStream::Close() {
+  if (!opened_) {
+    return false;
+  }
+  opened_ = false;
+  if (mode_ == kRead) {
+    return true;
+  }
+
+  // Flushes pending data and writes block table.
+  if (!FlushBlock()) {
+    return false;
+  }
+  const int64_t table = stream_->Tell();
+  for (size_t i = 0; i < blocks_.size(); ++i) {
+    byte entry[kCompressedBlockEntrySize];
+    StoreLE(blocks_[i].offset, 8, entry);
+    StoreLE(blocks_[i].size, 4, entry + 8);
+    if (stream_->Write(entry, sizeof(entry)) != sizeof(entry)) {
+      return false;
+    }
+  }
+  const int64_t end = stream_->Tell();
+
+  // Updates header.
+  byte header[kCompressedHeaderSize];
+  std::memcpy(header, kCompressedMagic, sizeof(kCompressedMagic));
+  StoreLE(block_size_, 4, header + 4);
+  StoreLE(size_, 8, header + 8);
+  StoreLE(static_cast<uint64_t>(table - origin_), 8, header + 16);
+  StoreLE(blocks_.size(), 4, header + 24);
+  return stream_->Seek(origin_, kSet) == 0 &&
+         stream_->Write(header, sizeof(header)) == sizeof(header) &&
+         stream_->Seek(end, kSet) == 0;
+}
+
+bool CompressedStream::opened() const { return opened_; }
+
+bool CompressedStream::LoadBlock(size_t _block) {
+  if (loaded_ == static_cast<int64_t>(_block)) {
+    return true;
+  }
+  loaded_ = -1;
+  const Block& block = blocks_[_block];
+  const uint64_t begin = static_cast<uint64_t>(_block) * block_size_;
+  const size_t raw = static_cast<size_t>(
+      size_ - begin < block_size_ ? size_ - begin : block_size_);
+  block_.resize(raw);
+  if (stream_->Seek(origin_ + static_cast<int64_t>(block.offset), kSet) != 0) {
+    return false;
+  }
+  if (block.size == raw) {  // Stored raw.
+    if (stream_->Read(block_.data(), raw) != raw) {
+      return false;
+    }
+  } else if (stream_->Read(compressed_.data(), block.size) != block.size ||
+             !Decompress(compressed_.data(), block.size, block_.data(), raw)) {
+    return false;
+  }
+  loaded_ = static_cast<int64_t>(_block);
+  return true;
+}
+
+bool CompressedStream::FlushBlock() {
+  if (block_.empty()) {
+    return true;
+  }
+  if (blocks_.size() == std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  Block block;
+  block.offset = static_cast<uint64_t>(stream_->Tell() - origin_);
+  const size_t size =
+      Compress(block_.data(), block_.size(), compressed_.data());
+  const byte* data = compressed_.data();
+  if (size < block_.size()) {
+    block.size = static_cast<uint32_t>(size);
+  } else {  // Stores raw data as compression doesn't help.
+    block.size = static_cast<uint32_t>(block_.size());
+    data = block_.data();
+  }
+  if (stream_->Write(data, block.size) != block.size) {
+    return false;
+  }
+  blocks_.push_back(block);
+  block_.clear();
+  return true;
+}
+
+void CompressedStream::set_parallel_for(ParallelFor _parallel_for,
+                                        void* _user_data) {
+  parallel_for_ = _parallel_for;
+  parallel_for_user_data_ = _user_data;
+}
+
+size_t CompressedStream::ParallelBlocks(size_t _first, size_t _size) const {
+  size_t count = 0;
+  uint64_t begin = static_cast<uint64_t>(_first) * block_size_;
+  for (size_t i = _first; i < blocks_.size(); ++i, ++count) {
+    const uint64_t raw = size_ - begin < block_size_ ? size_ - begin
+                                                     : block_size_;
+    // Compressed blocks must be contiguous to be read at once.
+    if (raw > _size ||
+        (i != _first && blocks_[i].offset !=
+                            blocks_[i - 1].offset + blocks_[i - 1].size)) {
+      break;
+    }
+    _size -= static_cast<size_t>(raw);
+    begin += raw;
+  }
+  return count;
+}
+
+bool CompressedStream::ReadBlocks(size_t _first, size_t _count,
+                                  byte* _buffer) {
+  const Block& last = blocks_[_first + _count - 1];
+  const uint64_t offset = blocks_[_first].offset;
+  const size_t size = static_cast<size_t>(last.offset + last.size - offset);
+  ozz::vector<byte> compressed(size);
+  if (stream_->Seek(origin_ + static_cast<int64_t>(offset), kSet) != 0 ||
+      stream_->Read(compressed.data(), size) != size) {
+    return false;
+  }
+
+  ozz::vector<ParallelBlock> blocks(_count);
+  uint64_t begin = static_cast<uint64_t>(_first) * block_size_;
+  for (size_t i = 0; i < _count; ++i) {
+    const Block& block = blocks_[_first + i];
+    const uint64_t raw = size_ - begin < block_size_ ? size_ - begin
+                                                     : block_size_;
+    ParallelBlock& task = blocks[i];
+    task.src = compressed.data() + (block.offset - offset);
+    task.src_size = block.size;
+    task.dest = _buffer + (i * block_size_);
+    task.dest_size = static_cast<size_t>(raw);
+    task.success = false;
+    begin += raw;
+  }
+  parallel_for_(static_cast<int>(_count), &DecompressBlockTask, blocks.data(),
+                parallel_for_user_data_);
+
+  for (const ParallelBlock& block : blocks) {
+    if (!block.success) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t CompressedStream::Read(void* _buffer, size_t _size) {
+  if (!opened_ || mode_ != kRead) {
+    return 0;
+  }
+  byte* buffer = static_cast<byte*>(_buffer);
+  size_t read = 0;
+  while (read < _size && static_cast<uint64_t>(tell_) < size_) {
+    const uint64_t tell = static_cast<uint64_t>(tell_);
+
+    // Whole blocks are decompressed in parallel, directly to _buffer.
+    if (parallel_for_ && tell % block_size_ == 0) {
+      const size_t first = static_cast<size_t>(tell / block_size_);
+      const size_t count = ParallelBlocks(first, _size - read);
+      if (count > 1 && count <= static_cast<size_t>(
+                                    std::numeric_limits<int>::max())) {
+        if (!ReadBlocks(first, count, buffer + read)) {
+          break;
+        }
+        const uint64_t end = static_cast<uint64_t>(first + count) * block_size_;
+        const size_t size =
+            static_cast<size_t>((end < size_ ? end : size_) - tell);
+        read += size;
+        tell_ += size;
+        continue;
+      }
+    }
+
+    if (!LoadBlock(static_cast<size_t>(tell / block_size_))) {
+      break;
+    }
+    const size_t offset = static_cast<size_t>(tell % block_size_);
+    const size_t available = block_.size() - offset;
+    const size_t copy = _size - read < available ? _size - read : available;
+    std::memcpy(buffer + read, block_.data() + offset, copy);
+    read += copy;
+    tell_ += copy;
+  }
+  return read;
+}
+
+size_t CompressedStream::Write(const void* _buffer, size_t _size) {
+  if (!opened_ || mode_ != kWrite) {
+    return 0;
+  }
+  const byte* buffer = static_cast<const byte*>(_buffer);
+  size_t written = 0;
+  while (written < _size) {
+    const size_t available = block_size_ - block_.size();
+    const size_t copy =
+        _size - written < available ? _size - written : available;
+    block_.insert(block_.end(), buffer + written, buffer + written + copy);
+    written += copy;
+    if (block_.size() == block_size_ && !FlushBlock()) {
+      // Data are lost, stream can't be written anymore.
+      opened_ = false;
+      return 0;
+    }
+  }
+  tell_ += written;
+  size_ += written;
+  return written;
+}
+
+int CompressedStream::Seek(int64_t _offset, Origin _origin) {
+  if (!opened_) {
+    return -1;
+  }
+  int64_t origin;
+  switch (_origin) {
+    case kCurrent:
+      origin = tell_;
+      break;
+    case kEnd:
+      origin = static_cast<int64_t>(size_);
+      break;
+    case kSet:
+      origin = 0;
+      break;
+    default:
+      return -1;
+  }
+
+  // Exit if seeking before stream begin or overflowing.
+  if (origin < -_offset ||
+      (_offset > 0 && origin > std::numeric_limits<int64_t>::max() - _offset)) {
+    return -1;
+  }
+
+  // Written data are compressed sequentially.
+  if (mode_ == kWrite && origin + _offset != tell_) {
+    return -1;
+  }
+  tell_ = origin + _offset;
+  return 0;
+}
+
+int64_t CompressedStream::Tell() const { return opened_ ? tell_ : -1; }
+
+uint64_t CompressedStream::Size() const { return opened_ ? size_ : 0; }
+}  // namespace io
+}  // namespace ozz
@@ -0,0 +1,227 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/pack.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/containers/string_archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/log.h"
+
+namespace ozz {
+namespace io {
+
+namespace {
+// Pack header tag, including null terminating character.
+const char kPackTag[] = "ozz-pack";
+
+// Pack format version.
+const uint32_t kPackVersion = 1;
+}  // namespace
+
+uint64_t PackHash(const char* _str) {
+  uint64_t hash = 14695981039346656037ull;
+  for (const char* c = _str; *c; ++c) {
+    hash ^= static_cast<uint8_t>(*c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// PackWriter implementation.
+
+PackWriter::PackWriter(Stream* _stream, Endianness _endianness)
+    : endianness_(_endianness),
+      archive_(_stream, _endianness),
+      toc_offset_position_(0),
+      finalized_(false) {
+  archive_.SaveBinary(kPackTag, sizeof(kPackTag));
+  archive_ << kPackVersion;
+
+  // Table of contents offset is patched by Finalize().
+  toc_offset_position_ = _stream->Tell();
+  archive_ << static_cast<int64_t>(0);
+}
+
+PackWriter::~PackWriter() {
+  if (!finalized_) {
+    Finalize();
+  }
+}
+
+bool PackWriter::BeginEntry(const char* _name, uint64_t _type) {
+  if (finalized_) {
+    log::Err() << "Can't add entry \"" << _name << "\" to a finalized pack."
+               << std::endl;
+    return false;
+  }
+  const uint64_t hash = PackHash(_name);
+  if (!index_.insert(std::make_pair(hash, static_cast<int>(entries_.size())))
+           .second) {
+    log::Err() << "Pack entry \"" << _name << "\" name is already used."
+               << std::endl;
+    return false;
+  }
+  const Entry entry = {_name, hash, _type, archive_.stream()->Tell(), 0};
+  entries_.push_back(entry);
+  return true;
+}
+
+void PackWriter::EndEntry() {
+  Entry& entry = entries_.back();
+  entry.size = static_cast<uint64_t>(archive_.stream()->Tell() - entry.offset);
+}
+
+bool PackWriter::Finalize() {
+  if (finalized_) {
+    return false;
+  }
+  finalized_ = true;
+
+  Stream* stream = archive_.stream();
+  const int64_t toc_offset = stream->Tell();
+  archive_ << static_cast<uint32_t>(entries_.size());
+  for (const Entry& entry : entries_) {
+    archive_ << entry.name;
+    archive_ << entry.hash;
+    archive_ << entry.type;
+    archive_ << entry.offset;
+    archive_ << entry.size;
+  }
+  const int64_t end = stream->Tell();
+
+  // Patches table of contents offset.
+  if (stream->Seek(toc_offset_position_, Stream::kSet) != 0) {
+    return false;
+  }
+  archive_ << toc_offset;
+  return stream->Seek(end, Stream::kSet) == 0;
+}
+
+// Pack implementation.
+
+Pack::Pack() : stream_(nullptr) {}
+
+bool Pack::Open(Stream* _stream) {
+  Close();
+
+  if (!_stream || !_stream->opened()) {
+    log::Err() << "Invalid pack stream." << std::endl;
+    return false;
+  }
+
+  IArchive archive(_stream);
+  char tag[sizeof(kPackTag)];
+  if (archive.LoadBinary(tag, sizeof(tag)) != sizeof(tag) ||
+      std::memcmp(tag, kPackTag, sizeof(tag)) != 0) {
+    log::Err() << "Stream isn't a pack." << std::endl;
+    return false;
+  }
+  uint32_t version;
+  archive >> version;
+  if (version != kPackVersion) {
+    log::Err() << "Unsupported pack version " << version << "." << std::endl;
+    return false;
+  }
+  int64_t toc_offset;
+  archive >> toc_offset;
+  const uint64_t size = _stream->Size();
+  if (toc_offset <= 0 || static_cast<uint64_t>(toc_offset) >= size ||
+      _stream->Seek(toc_offset, Stream::kSet) != 0) {
+    log::Err() << "Invalid pack table of contents." << std::endl;
+    return false;
+  }
+
+  // Entries count is validated against the table of contents size before
+  // allocating them, as a corrupted count could require a huge allocation.
+  // Every entry is at least its name size, hash, type, offset and size.
+  const uint64_t kMinEntrySize = sizeof(uint32_t) + sizeof(uint64_t) * 4;
+  uint32_t num_entries;
+  archive >> num_entries;
+  const uint64_t toc_size = size - toc_offset - sizeof(num_entries);
+  if (toc_size > size || num_entries > toc_size / kMinEntrySize) {
+    log::Err() << "Invalid pack entries count " << num_entries << "."
+               << std::endl;
+    return false;
+  }
+  entries_.resize(num_entries);
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    Entry& entry = entries_[i];
+    archive >> entry.name;
+    archive >> entry.hash;
+    archive >> entry.type;
+    archive >> entry.offset;
+    archive >> entry.size;
+    if (entry.offset < 0 || entry.offset > toc_offset ||
+        entry.size > static_cast<uint64_t>(toc_offset - entry.offset) ||
+        !index_.insert(std::make_pair(entry.hash, static_cast<int>(i)))
+             .second) {
+      log::Err() << "Invalid pack entry " << i << "." << std::endl;
+      Close();
+      return false;
+    }
+  }
+
+  stream_ = _stream;
+  return true;
+}
+
+void Pack::Close() {
+  stream_ = nullptr;
+  entries_.clear();
+  index_.clear();
+}
+
+const Pack::Entry& Pack::entry(int _index) const {
+  assert(_index >= 0 && _index < num_entries() && "Invalid entry index.");
+  return entries_[_index];
+}
+
+int Pack::Find(const char* _name) const {
+  const auto it = index_.find(PackHash(_name));
+  if (it == index_.end() || entries_[it->second].name != _name) {
+    return -1;
+  }
+  return it->second;
+}
+
+bool Pack::Seek(int _index, uint64_t _type, Stream* _stream) const {
+  if (!_stream || _index < 0 || _index >= num_entries()) {
+    return false;
+  }
+  const Entry& entry = entries_[_index];
+  if (entry.type != _type) {
+    log::Err() << "Pack entry \"" << entry.name << "\" type doesn't match."
+               << std::endl;
+    return false;
+  }
+  return _stream->Seek(entry.offset, Stream::kSet) == 0;
+}
+}  // namespace io
+}  // namespace ozz
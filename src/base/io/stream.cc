@@ -28,10 +28,26 @@
 #include "ozz/base/io/stream.h"
 
 #include <cassert>
+#include <cstddef>
 #include <cstdio>
 #include <cstring>
 #include <limits>
 
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif  // WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif  // NOMINMAX
+#include <windows.h>
+#else  // _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/memory/allocator.h"
 
@@ -76,40 +92,188 @@ size_t File::Write(const void* _buffer, size_t _size) {
   return std::fwrite(_buffer, 1, _size, file);
 }
 
-int File::Seek(int _offset, Origin _origin) {
+namespace {
+// 64 bits offsets versions of fseek and ftell.
+int FileSeek(std::FILE* _file, int64_t _offset, int _origin) {
+#ifdef _WIN32
+  return _fseeki64(_file, _offset, _origin);
+#else   // _WIN32
+  return fseeko(_file, static_cast<off_t>(_offset), _origin);
+#endif  // _WIN32
+}
+
+int64_t FileTell(std::FILE* _file) {
+#ifdef _WIN32
+  return _ftelli64(_file);
+#else   // _WIN32
+  return static_cast<int64_t>(ftello(_file));
+#endif  // _WIN32
+}
+}  // namespace
+
+int File::Seek(int64_t _offset, Origin _origin) {
   int origins[] = {SEEK_CUR, SEEK_END, SEEK_SET};
   if (_origin >= static_cast<int>(OZZ_ARRAY_SIZE(origins))) {
     return -1;
   }
   std::FILE* file = reinterpret_cast<std::FILE*>(file_);
-  return std::fseek(file, _offset, origins[_origin]);
+  return FileSeek(file, _offset, origins[_origin]);
 }
 
-int File::Tell() const {
+int64_t File::Tell() const {
   std::FILE* file = reinterpret_cast<std::FILE*>(file_);
-  const long current = std::ftell(file);
-  return static_cast<int>(current);
+  return FileTell(file);
 }
 
-size_t File::Size() const {
+uint64_t File::Size() const {
   std::FILE* file = reinterpret_cast<std::FILE*>(file_);
 
-  const long current = std::ftell(file);
+  const int64_t current = FileTell(file);
   assert(current >= 0);
-  int seek = std::fseek(file, 0, SEEK_END);
+  int seek = FileSeek(file, 0, SEEK_END);
   assert(seek == 0);
   (void)seek;
-  const long end = std::ftell(file);
+  const int64_t end = FileTell(file);
   assert(end >= 0);
-  seek = std::fseek(file, current, SEEK_SET);
+  seek = FileSeek(file, current, SEEK_SET);
   assert(seek == 0);
 
-  return static_cast<size_t>(end);
+  return static_cast<uint64_t>(end);
+}
+
+// Starts MappedFile implementation.
+
+MappedFile::MappedFile(const char* _filename)
+    : data_(nullptr), size_(0), tell_(0), opened_(false), handle_(nullptr) {
+#ifdef _WIN32
+  HANDLE file =
+      CreateFileA(_filename, GENERIC_READ, FILE_SHARE_READ, nullptr,
+                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return;
+  }
+  LARGE_INTEGER size;
+  if (GetFileSizeEx(file, &size) &&
+      static_cast<uint64_t>(size.QuadPart) <=
+          std::numeric_limits<size_t>::max()) {
+    size_ = static_cast<size_t>(size.QuadPart);
+    if (size_ == 0) {
+      opened_ = true;
+    } else {
+      HANDLE mapping =
+          CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping) {
+        data_ = static_cast<const byte*>(
+            MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (data_) {
+          handle_ = mapping;
+          opened_ = true;
+        } else {
+          CloseHandle(mapping);
+        }
+      }
+    }
+  }
+  CloseHandle(file);
+#else   // _WIN32
+  const int fd = open(_filename, O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) &&
+      static_cast<uint64_t>(st.st_size) <=
+          std::numeric_limits<size_t>::max()) {
+    size_ = static_cast<size_t>(st.st_size);
+    if (size_ == 0) {
+      opened_ = true;
+    } else {
+      void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (mapping != MAP_FAILED) {
+        data_ = static_cast<const byte*>(mapping);
+        opened_ = true;
+      }
+    }
+  }
+  // The mapping remains valid once the file descriptor is closed.
+  close(fd);
+#endif  // _WIN32
+  if (!opened_) {
+    size_ = 0;
+  }
+}
+
+MappedFile::~MappedFile() { Close(); }
+
+void MappedFile::Close() {
+  if (data_) {
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(reinterpret_cast<HANDLE>(handle_));
+#else   // _WIN32
+    munmap(const_cast<byte*>(data_), size_);
+#endif  // _WIN32
+  }
+  data_ = nullptr;
+  handle_ = nullptr;
+  size_ = 0;
+  tell_ = 0;
+  opened_ = false;
+}
+
+bool MappedFile::opened() const { return opened_; }
+
+size_t MappedFile::Read(void* _buffer, size_t _size) {
+  if (tell_ >= static_cast<int64_t>(size_)) {
+    return 0;
+  }
+  const size_t tell = static_cast<size_t>(tell_);
+  const size_t read_size = math::Min(size_ - tell, _size);
+  std::memcpy(_buffer, data_ + tell, read_size);
+  tell_ += static_cast<int64_t>(read_size);
+  return read_size;
 }
 
+size_t MappedFile::Write(const void* _buffer, size_t _size) {
+  (void)_buffer;
+  (void)_size;
+  return 0;
+}
+
+int MappedFile::Seek(int64_t _offset, Origin _origin) {
+  int64_t origin;
+  switch (_origin) {
+    case kCurrent:
+      origin = tell_;
+      break;
+    case kEnd:
+      origin = static_cast<int64_t>(size_);
+      break;
+    case kSet:
+      origin = 0;
+      break;
+    default:
+      return -1;
+  }
+
+  // Exit if seeking before file begin or beyond offsets range. Seeking beyond
+  // the end of the file is allowed, as for a CRT file.
+  if (origin < -_offset ||
+      (_offset > 0 &&
+       origin > std::numeric_limits<int64_t>::max() - _offset)) {
+    return -1;
+  }
+  tell_ = origin + _offset;
+  return 0;
+}
+
+int64_t MappedFile::Tell() const { return tell_; }
+
+uint64_t MappedFile::Size() const { return size_; }
+
 // Starts MemoryStream implementation.
 const size_t MemoryStream::kBufferSizeIncrement = 16 << 10;
-const size_t MemoryStream::kMaxSize = std::numeric_limits<int>::max();
+const size_t MemoryStream::kMaxSize = std::numeric_limits<ptrdiff_t>::max();
 
 MemoryStream::MemoryStream()
     : buffer_(nullptr), alloc_size_(0), end_(0), tell_(0) {}
@@ -128,14 +292,15 @@ size_t MemoryStream::Read(void* _buffer, size_t _size) {
     return 0;
   }
 
-  const int read_size = math::Min(end_ - tell_, static_cast<int>(_size));
-  std::memcpy(_buffer, buffer_ + tell_, read_size);
+  const int64_t read_size =
+      math::Min(end_ - tell_, static_cast<int64_t>(_size));
+  std::memcpy(_buffer, buffer_ + tell_, static_cast<size_t>(read_size));
   tell_ += read_size;
-  return read_size;
+  return static_cast<size_t>(read_size);
 }
 
 size_t MemoryStream::Write(const void* _buffer, size_t _size) {
-  if (_size > kMaxSize || tell_ > static_cast<int>(kMaxSize - _size)) {
+  if (_size > kMaxSize || tell_ > static_cast<int64_t>(kMaxSize - _size)) {
     // A write cannot exceed the maximum Stream size.
     return 0;
   }
@@ -144,18 +309,18 @@ size_t MemoryStream::Write(const void* _buffer, size_t _size) {
     // beyond the end of existing data in the file. If data is later written at
     // this point, subsequent reads of data in the gap shall return bytes with
     // the value 0 until data is actually written into the gap.
-    if (!Resize(tell_)) {
+    if (!Resize(static_cast<size_t>(tell_))) {
       return 0;
     }
     // Fills the gap with 0's.
-    const size_t gap = tell_ - end_;
+    const size_t gap = static_cast<size_t>(tell_ - end_);
     std::memset(buffer_ + end_, 0, gap);
     end_ = tell_;
   }
 
-  const int size = static_cast<int>(_size);
-  const int tell_end = tell_ + size;
-  if (Resize(tell_end)) {
+  const int64_t size = static_cast<int64_t>(_size);
+  const int64_t tell_end = tell_ + size;
+  if (Resize(static_cast<size_t>(tell_end))) {
     end_ = math::Max(tell_end, end_);
     std::memcpy(buffer_ + tell_, _buffer, _size);
     tell_ += size;
@@ -164,8 +329,8 @@ size_t MemoryStream::Write(const void* _buffer, size_t _size) {
   return 0;
 }
 
-int MemoryStream::Seek(int _offset, Origin _origin) {
-  int origin;
+int MemoryStream::Seek(int64_t _offset, Origin _origin) {
+  int64_t origin;
   switch (_origin) {
     case kCurrent:
       origin = tell_;
@@ -182,7 +347,7 @@ int MemoryStream::Seek(int _offset, Origin _origin) {
 
   // Exit if seeking before file begin or beyond max file size.
   if (origin < -_offset ||
-      (_offset > 0 && origin > static_cast<int>(kMaxSize) - _offset)) {
+      (_offset > 0 && origin > static_cast<int64_t>(kMaxSize) - _offset)) {
     return -1;
   }
 
@@ -192,9 +357,9 @@ int MemoryStream::Seek(int _offset, Origin _origin) {
   return 0;
 }
 
-int MemoryStream::Tell() const { return tell_; }
+int64_t MemoryStream::Tell() const { return tell_; }
 
-size_t MemoryStream::Size() const { return static_cast<size_t>(end_); }
+uint64_t MemoryStream::Size() const { return static_cast<uint64_t>(end_); }
 
 bool MemoryStream::Resize(size_t _size) {
   if (_size > alloc_size_) {
@@ -215,5 +380,112 @@ bool MemoryStream::Resize(size_t _size) {
   }
   return _size == 0 || buffer_ != nullptr;
 }
+
+// BufferedStream implementation.
+
+const size_t BufferedStream::kDefaultBufferSize = 16 << 10;
+
+BufferedStream::BufferedStream(Stream* _stream, size_t _buffer_size)
+    : stream_(_stream),
+      buffer_(nullptr),
+      capacity_(_buffer_size),
+      begin_(0),
+      size_(0),
+      cursor_(0) {
+  assert(stream_ && "_stream argument must point a valid stream.");
+  begin_ = stream_->Tell();
+  if (capacity_ != 0) {
+    buffer_ = static_cast<byte*>(
+        ozz::memory::default_allocator()->Allocate(capacity_, 16));
+  }
+}
+
+BufferedStream::~BufferedStream() {
+  Sync();
+  ozz::memory::default_allocator()->Deallocate(buffer_);
+  buffer_ = nullptr;
+}
+
+void BufferedStream::Sync() {
+  if (cursor_ != size_) {
+    stream_->Seek(static_cast<int64_t>(cursor_) - static_cast<int64_t>(size_),
+                  kCurrent);
+  }
+  begin_ += cursor_;
+  size_ = 0;
+  cursor_ = 0;
+}
+
+bool BufferedStream::opened() const { return stream_->opened(); }
+
+size_t BufferedStream::Read(void* _buffer, size_t _size) {
+  // Copies buffered data first.
+  byte* dst = static_cast<byte*>(_buffer);
+  const size_t buffered = math::Min(_size, size_ - cursor_);
+  if (buffered != 0) {
+    std::memcpy(dst, buffer_ + cursor_, buffered);
+    cursor_ += buffered;
+  }
+  if (buffered == _size) {
+    return _size;
+  }
+
+  // Buffer is exhausted, wrapped stream is at the position to read.
+  begin_ += size_;
+  size_ = 0;
+  cursor_ = 0;
+  const size_t remaining = _size - buffered;
+
+  // Big reads don't benefit from buffering, so they're direct.
+  if (remaining >= capacity_) {
+    const size_t read = stream_->Read(dst + buffered, remaining);
+    begin_ += read;
+    return buffered + read;
+  }
+
+  // Refills the buffer.
+  size_ = stream_->Read(buffer_, capacity_);
+  cursor_ = math::Min(remaining, size_);
+  std::memcpy(dst + buffered, buffer_, cursor_);
+  return buffered + cursor_;
+}
+
+size_t BufferedStream::Write(const void* _buffer, size_t _size) {
+  Sync();
+  const size_t written = stream_->Write(_buffer, _size);
+  begin_ += written;
+  return written;
+}
+
+int BufferedStream::Seek(int64_t _offset, Origin _origin) {
+  // Seeking within buffered data only moves the cursor.
+  int64_t cursor = -1;
+  if (_origin == kCurrent) {
+    if (_offset >= -static_cast<int64_t>(cursor_) &&
+        _offset <= static_cast<int64_t>(size_ - cursor_)) {
+      cursor = static_cast<int64_t>(cursor_) + _offset;
+    }
+  } else if (_origin == kSet) {
+    if (_offset >= begin_ && _offset - begin_ <= static_cast<int64_t>(size_)) {
+      cursor = _offset - begin_;
+    }
+  }
+  if (cursor >= 0) {
+    cursor_ = static_cast<size_t>(cursor);
+    return 0;
+  }
+
+  // Otherwise seeks wrapped stream, from the current position.
+  Sync();
+  const int ret = stream_->Seek(_offset, _origin);
+  begin_ = stream_->Tell();
+  return ret;
+}
+
+int64_t BufferedStream::Tell() const {
+  return begin_ + static_cast<int64_t>(cursor_);
+}
+
+uint64_t BufferedStream::Size() const { return stream_->Size(); }
 }  // namespace io
 }  // namespace ozz
@@ -27,26 +27,272 @@
 
 #include "ozz/base/log.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
 #include <iomanip>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/memory/allocator.h"
 
 namespace ozz {
 namespace log {
 
+static_assert(OZZ_LOG_MAX_LEVEL >= kSilent && OZZ_LOG_MAX_LEVEL <= kVerbose,
+              "OZZ_LOG_MAX_LEVEL must be a valid Level value.");
+
 // Default log level initialization.
 namespace {
 Level log_level = kStandard;
+
+// Null stream, which discards everything without formatting it as it has no
+// buffer (badbit is set). One per thread, as format can be modified.
+std::ostream& NullStream() {
+  static thread_local std::ostream stream(nullptr);
+  return stream;
+}
+
+// Pool of asynchronous logging buffers of a thread. Loggers can be nested
+// (a function called while streaming a log can log itself), hence a pool.
+struct BufferPool {
+  ~BufferPool() {
+    for (std::ostringstream* buffer : buffers) {
+      ozz::Delete(buffer);
+    }
+  }
+  ozz::vector<std::ostringstream*> buffers;
+};
+
+BufferPool& ThreadBufferPool() {
+  static thread_local BufferPool pool;
+  return pool;
+}
+
+std::ostringstream* AcquireBuffer(const std::ostream& _target) {
+  BufferPool& pool = ThreadBufferPool();
+  std::ostringstream* buffer;
+  if (pool.buffers.empty()) {
+    buffer = ozz::New<std::ostringstream>();
+  } else {
+    buffer = pool.buffers.back();
+    pool.buffers.pop_back();
+  }
+  // Inherits target format, but not its tie (tied stream would be flushed).
+  buffer->flags(_target.flags());
+  buffer->precision(_target.precision());
+  buffer->width(_target.width());
+  buffer->fill(_target.fill());
+  return buffer;
+}
+
+void ReleaseBuffer(std::ostringstream* _buffer) {
+  _buffer->str(std::string());
+  _buffer->clear();
+  ThreadBufferPool().buffers.push_back(_buffer);
+}
+
+// Lock-free multiple producers ring buffer of log messages, consumed by a
+// background thread (D. Vyukov bounded queue).
+class AsyncSink {
+ public:
+  explicit AsyncSink(size_t _capacity);
+  ~AsyncSink();
+
+  AsyncSink(const AsyncSink&) = delete;
+  AsyncSink& operator=(const AsyncSink&) = delete;
+
+  // Pushes _size characters of _text, to be written to _target. Drops
+  // message chunks that don't fit.
+  void Push(std::ostream* _target, const char* _text, size_t _size);
+
+  // Writes all pushed messages and flushes their streams.
+  void Flush();
+
+  size_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+ private:
+  // Slot text size, so that a slot fits 4 cache lines.
+  static const size_t kSlotTextSize =
+      256 - sizeof(std::atomic<size_t>) - sizeof(std::ostream*) -
+      sizeof(uint32_t);
+
+  struct Slot {
+    std::atomic<size_t> sequence;
+    std::ostream* target;
+    uint32_t size;
+    char text[kSlotTextSize];
+  };
+
+  // Writes available messages. Returns true if any was written.
+  // consumer_mutex_ must be locked.
+  bool Drain();
+
+  // Background thread function.
+  void Run();
+
+  Slot* slots_;
+  size_t mask_;
+
+  std::atomic<size_t> enqueue_;
+  size_t dequeue_;  // Protected by consumer_mutex_.
+  std::atomic<size_t> dropped_;
+
+  std::mutex consumer_mutex_;
+
+  // Stops the background thread.
+  std::mutex stop_mutex_;
+  std::condition_variable stop_cv_;
+  bool stop_;
+
+  std::thread thread_;
+};
+
+const size_t AsyncSink::kSlotTextSize;
+
+AsyncSink::AsyncSink(size_t _capacity)
+    : enqueue_(0), dequeue_(0), dropped_(0), stop_(false) {
+  // Sequences don't distinguish empty from full slots below 2 slots.
+  size_t capacity = 2;
+  while (capacity < _capacity) {
+    capacity <<= 1;
+  }
+  mask_ = capacity - 1;
+  slots_ = static_cast<Slot*>(memory::default_allocator()->Allocate(
+      sizeof(Slot) * capacity, alignof(Slot)));
+  for (size_t i = 0; i < capacity; ++i) {
+    new (&slots_[i].sequence) std::atomic<size_t>(i);
+  }
+  thread_ = std::thread(&AsyncSink::Run, this);
 }
 
+AsyncSink::~AsyncSink() {
+  {
+    std::lock_guard<std::mutex> lock(stop_mutex_);
+    stop_ = true;
+  }
+  stop_cv_.notify_one();
+  thread_.join();
+  Flush();
+  for (size_t i = 0; i <= mask_; ++i) {
+    slots_[i].sequence.~atomic();
+  }
+  memory::default_allocator()->Deallocate(slots_);
+}
+
+void AsyncSink::Push(std::ostream* _target, const char* _text, size_t _size) {
+  while (_size != 0) {
+    const size_t size = std::min(_size, kSlotTextSize);
+    size_t pos = enqueue_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+      slot = &slots_[pos & mask_];
+      const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+      const intptr_t diff =
+          static_cast<intptr_t>(sequence) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (enqueue_.compare_exchange_weak(pos, pos + 1,
+                                           std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);  // Full.
+        return;
+      } else {
+        pos = enqueue_.load(std::memory_order_relaxed);
+      }
+    }
+    slot->target = _target;
+    slot->size = static_cast<uint32_t>(size);
+    std::memcpy(slot->text, _text, size);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    _text += size;
+    _size -= size;
+  }
+}
+
+bool AsyncSink::Drain() {
+  bool written = false;
+  for (;; ++dequeue_) {
+    Slot& slot = slots_[dequeue_ & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != dequeue_ + 1) {
+      break;  // Empty, or next message isn't committed yet.
+    }
+    slot.target->write(slot.text, slot.size);
+    slot.sequence.store(dequeue_ + mask_ + 1, std::memory_order_release);
+    written = true;
+  }
+  return written;
+}
+
+void AsyncSink::Flush() {
+  std::lock_guard<std::mutex> lock(consumer_mutex_);
+  Drain();
+  std::cout.flush();
+  std::clog.flush();
+  std::cerr.flush();
+}
+
+void AsyncSink::Run() {
+  // Polls rather than being notified by producers, which would cost them a
+  // system call.
+  const std::chrono::milliseconds kPeriod(5);
+  std::unique_lock<std::mutex> lock(stop_mutex_);
+  while (!stop_cv_.wait_for(lock, kPeriod, [this] { return stop_; })) {
+    std::lock_guard<std::mutex> consumer_lock(consumer_mutex_);
+    if (Drain()) {
+      std::cout.flush();
+      std::clog.flush();
+    }
+  }
+}
+
+AsyncSink* g_async_sink = nullptr;
+
+// Disables asynchronous logging on exit, writing pending messages.
+struct AsyncShutdown {
+  ~AsyncShutdown() { DisableAsync(); }
+} g_async_shutdown;
+}  // namespace
+
 Level SetLevel(Level _level) {
   const Level previous_level = log_level;
   log_level = _level;
   return previous_level;
 }
 
-Level GetLevel() { return log_level; }
+Level GetLevel() {
+  return std::min(log_level, static_cast<Level>(OZZ_LOG_MAX_LEVEL));
+}
+
+bool EnableAsync(size_t _capacity) {
+  if (g_async_sink || _capacity == 0) {
+    return false;
+  }
+  g_async_sink = ozz::New<AsyncSink>(_capacity);
+  return true;
+}
+
+void DisableAsync() {
+  ozz::Delete(g_async_sink);
+  g_async_sink = nullptr;
+}
+
+bool IsAsync() { return g_async_sink != nullptr; }
+
+void Flush() {
+  if (g_async_sink) {
+    g_async_sink->Flush();
+  }
+}
+
+size_t Dropped() { return g_async_sink ? g_async_sink->dropped() : 0; }
 
 LogV::LogV() : Logger(std::clog, kVerbose) {}
 
@@ -57,11 +303,21 @@ Out::Out() : Logger(std::cout, kStandard) {}
 Err::Err() : Logger(std::cerr, kStandard) {}
 
 Logger::Logger(std::ostream& _stream, Level _level)
-    : stream_(_level <= GetLevel() ? _stream : *ozz::New<std::ostringstream>()),
-      local_stream_(&stream_ != &_stream) {}
+    : stream_(_level > GetLevel() ? NullStream()
+              : g_async_sink      ? *AcquireBuffer(_stream)
+                                  : _stream),
+      target_(&stream_ != &_stream && &stream_ != &NullStream() ? &_stream
+                                                                : nullptr) {}
 Logger::~Logger() {
-  if (local_stream_) {
-      ozz::Delete(&stream_);
+  if (target_) {
+    std::ostringstream& buffer = static_cast<std::ostringstream&>(stream_);
+    const std::string& text = buffer.str();
+    if (g_async_sink) {
+      g_async_sink->Push(target_, text.c_str(), text.size());
+    } else {  // Asynchronous logging was disabled meanwhile.
+      target_->write(text.c_str(), text.size());
+    }
+    ReleaseBuffer(&buffer);
   }
 }
 
@@ -0,0 +1,301 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/maths/quaternion_batch.h"
+
+#include <cstddef>
+
+namespace ozz {
+namespace math {
+
+namespace {
+
+// Eberly's SLerp polynomial coefficients, for 8 terms. The last term is scaled
+// by mu, which minimizes the approximation error.
+const float kSLerpMu = 1.85298109240830f;
+const float kSLerpU[8] = {1.f / (1 * 3),
+                          1.f / (2 * 5),
+                          1.f / (3 * 7),
+                          1.f / (4 * 9),
+                          1.f / (5 * 11),
+                          1.f / (6 * 13),
+                          1.f / (7 * 15),
+                          kSLerpMu / (8 * 17)};
+const float kSLerpV[8] = {1.f / 3,
+                          2.f / 5,
+                          3.f / 7,
+                          4.f / 9,
+                          5.f / 11,
+                          6.f / 13,
+                          7.f / 15,
+                          kSLerpMu * 8 / 17};
+
+// Evaluates Eberly's sin(_t * theta) / sin(theta) approximation, where _xm1
+// is cos(theta) - 1.
+OZZ_INLINE SimdFloat4 BatchSLerpCoeff(_SimdFloat4 _t, _SimdFloat4 _xm1) {
+  const SimdFloat4 one = simd_float4::one();
+  const SimdFloat4 sq_t = _t * _t;
+  SimdFloat4 acc = one;
+  for (int i = 7; i >= 0; --i) {
+    const SimdFloat4 u = simd_float4::Load1(kSLerpU[i]);
+    const SimdFloat4 v = simd_float4::Load1(kSLerpV[i]);
+    const SimdFloat4 b = (u * sq_t - v) * _xm1;
+    acc = MAdd(b, acc, one);
+  }
+  return _t * acc;
+}
+
+OZZ_INLINE SoaQuaternion BatchSLerp(const SoaQuaternion& _a,
+                                    const SoaQuaternion& _b,
+                                    _SimdFloat4 _f) {
+  // Flips _b to the same hemisphere as _a, to take the shortest path.
+  const SimdFloat4 cos = Dot(_a, _b);
+  const SimdInt4 sign = Sign(cos);
+  const SoaQuaternion b = {Xor(_b.x, sign), Xor(_b.y, sign), Xor(_b.z, sign),
+                           Xor(_b.w, sign)};
+  const SimdFloat4 xm1 = Abs(cos) - simd_float4::one();
+  const SimdFloat4 ca = BatchSLerpCoeff(simd_float4::one() - _f, xm1);
+  const SimdFloat4 cb = BatchSLerpCoeff(_f, xm1);
+  const SoaQuaternion r = {MAdd(_a.x, ca, b.x * cb), MAdd(_a.y, ca, b.y * cb),
+                           MAdd(_a.z, ca, b.z * cb), MAdd(_a.w, ca, b.w * cb)};
+  // Approximation error is mostly on the norm, which normalization fixes.
+  return Normalize(r);
+}
+
+// SoA operators are declared in the global namespace, hidden by ozz::math
+// ones.
+OZZ_INLINE SoaQuaternion BatchMultiply(const SoaQuaternion& _a,
+                                       const SoaQuaternion& _b) {
+  using ::operator*;
+  return _a * _b;
+}
+
+OZZ_INLINE SoaFloat3 BatchTransformVector(const SoaQuaternion& _q,
+                                          const SoaFloat3& _v) {
+  using ::operator*;
+  using ::operator+;
+  // _v + 2.f * cross(_q.xyz, cross(_q.xyz, _v) + _q.w * _v)
+  const SoaFloat3 xyz = {_q.x, _q.y, _q.z};
+  const SoaFloat3 cross1 = Cross(xyz, _v) + _v * _q.w;
+  const SoaFloat3 cross2 = Cross(xyz, cross1);
+  return _v + cross2 + cross2;
+}
+
+// Loads up to 4 SimdQuaternion from _q, starting at _i, as a SoaQuaternion.
+// Missing quaternions are set to identity.
+OZZ_INLINE SoaQuaternion BatchLoad(span<const SimdQuaternion> _q, size_t _i) {
+  SimdFloat4 aos[4];
+  if (_i + 4 <= _q.size()) {
+    aos[0] = _q[_i + 0].xyzw;
+    aos[1] = _q[_i + 1].xyzw;
+    aos[2] = _q[_i + 2].xyzw;
+    aos[3] = _q[_i + 3].xyzw;
+  } else {
+    for (size_t j = 0; j < 4; ++j) {
+      aos[j] = _i + j < _q.size() ? _q[_i + j].xyzw : simd_float4::w_axis();
+    }
+  }
+  SimdFloat4 soa[4];
+  Transpose4x4(aos, soa);
+  const SoaQuaternion r = {soa[0], soa[1], soa[2], soa[3]};
+  return r;
+}
+
+// Loads up to 4 SimdFloat4 from _v, starting at _i, as a SoaFloat3.
+OZZ_INLINE SoaFloat3 BatchLoad(span<const SimdFloat4> _v, size_t _i) {
+  SimdFloat4 aos[4];
+  if (_i + 4 <= _v.size()) {
+    aos[0] = _v[_i + 0];
+    aos[1] = _v[_i + 1];
+    aos[2] = _v[_i + 2];
+    aos[3] = _v[_i + 3];
+  } else {
+    for (size_t j = 0; j < 4; ++j) {
+      aos[j] = _i + j < _v.size() ? _v[_i + j] : simd_float4::zero();
+    }
+  }
+  SimdFloat4 soa[3];
+  Transpose4x3(aos, soa);
+  const SoaFloat3 r = {soa[0], soa[1], soa[2]};
+  return r;
+}
+
+// Stores _q to _count SimdQuaternion of _output, starting at _i.
+OZZ_INLINE void BatchStore(const SoaQuaternion& _q, size_t _count,
+                           span<SimdQuaternion> _output, size_t _i) {
+  const SimdFloat4 soa[4] = {_q.x, _q.y, _q.z, _q.w};
+  SimdFloat4 aos[4];
+  Transpose4x4(soa, aos);
+  for (size_t j = 0; j < 4 && _i + j < _count; ++j) {
+    _output[_i + j].xyzw = aos[j];
+  }
+}
+
+// Stores _v to _count SimdFloat4 of _output, starting at _i.
+OZZ_INLINE void BatchStore(const SoaFloat3& _v, size_t _count,
+                           span<SimdFloat4> _output, size_t _i) {
+  const SimdFloat4 soa[3] = {_v.x, _v.y, _v.z};
+  SimdFloat4 aos[4];
+  Transpose3x4(soa, aos);
+  for (size_t j = 0; j < 4 && _i + j < _count; ++j) {
+    _output[_i + j] = aos[j];
+  }
+}
+
+template <typename _T>
+OZZ_INLINE size_t BatchMin(span<const _T> _a, span<const _T> _b) {
+  return _a.size() < _b.size() ? _a.size() : _b.size();
+}
+}  // namespace
+
+bool Normalize(span<const SoaQuaternion> _input, span<SoaQuaternion> _output) {
+  if (_output.size() < _input.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < _input.size(); ++i) {
+    _output[i] = Normalize(_input[i]);
+  }
+  return true;
+}
+
+bool Normalize(span<const SimdQuaternion> _input,
+               span<SimdQuaternion> _output) {
+  const size_t count = _input.size();
+  if (_output.size() < count) {
+    return false;
+  }
+  for (size_t i = 0; i < count; i += 4) {
+    BatchStore(Normalize(BatchLoad(_input, i)), count, _output, i);
+  }
+  return true;
+}
+
+bool NLerp(span<const SoaQuaternion> _a, span<const SoaQuaternion> _b,
+           float _f, span<SoaQuaternion> _output) {
+  const size_t count = BatchMin(_a, _b);
+  if (_output.size() < count) {
+    return false;
+  }
+  const SimdFloat4 f = simd_float4::Load1(_f);
+  for (size_t i = 0; i < count; ++i) {
+    _output[i] = NLerp(_a[i], _b[i], f);
+  }
+  return true;
+}
+
+bool NLerp(span<const SimdQuaternion> _a, span<const SimdQuaternion> _b,
+           float _f, span<SimdQuaternion> _output) {
+  const size_t count = BatchMin(_a, _b);
+  if (_output.size() < count) {
+    return false;
+  }
+  const SimdFloat4 f = simd_float4::Load1(_f);
+  for (size_t i = 0; i < count; i += 4) {
+    BatchStore(NLerp(BatchLoad(_a, i), BatchLoad(_b, i), f), count, _output,
+               i);
+  }
+  return true;
+}
+
+bool SLerp(span<const SoaQuaternion> _a, span<const SoaQuaternion> _b,
+           float _f, span<SoaQuaternion> _output) {
+  const size_t count = BatchMin(_a, _b);
+  if (_output.size() < count) {
+    return false;
+  }
+  const SimdFloat4 f = simd_float4::Load1(_f);
+  for (size_t i = 0; i < count; ++i) {
+    _output[i] = BatchSLerp(_a[i], _b[i], f);
+  }
+  return true;
+}
+
+bool SLerp(span<const SimdQuaternion> _a, span<const SimdQuaternion> _b,
+           float _f, span<SimdQuaternion> _output) {
+  const size_t count = BatchMin(_a, _b);
+  if (_output.size() < count) {
+    return false;
+  }
+  const SimdFloat4 f = simd_float4::Load1(_f);
+  for (size_t i = 0; i < count; i += 4) {
+    BatchStore(BatchSLerp(BatchLoad(_a, i), BatchLoad(_b, i), f), count,
+               _output, i);
+  }
+  return true;
+}
+
+bool Multiply(span<const SoaQuaternion> _a, span<const SoaQuaternion> _b,
+              span<SoaQuaternion> _output) {
+  const size_t count = BatchMin(_a, _b);
+  if (_output.size() < count) {
+    return false;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    _output[i] = BatchMultiply(_a[i], _b[i]);
+  }
+  return true;
+}
+
+bool Multiply(span<const SimdQuaternion> _a, span<const SimdQuaternion> _b,
+              span<SimdQuaternion> _output) {
+  const size_t count = BatchMin(_a, _b);
+  if (_output.size() < count) {
+    return false;
+  }
+  for (size_t i = 0; i < count; i += 4) {
+    BatchStore(BatchMultiply(BatchLoad(_a, i), BatchLoad(_b, i)), count,
+               _output, i);
+  }
+  return true;
+}
+
+bool TransformVector(span<const SoaQuaternion> _q, span<const SoaFloat3> _v,
+                     span<SoaFloat3> _output) {
+  const size_t count = _q.size() < _v.size() ? _q.size() : _v.size();
+  if (_output.size() < count) {
+    return false;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    _output[i] = BatchTransformVector(_q[i], _v[i]);
+  }
+  return true;
+}
+
+bool TransformVector(span<const SimdQuaternion> _q, span<const SimdFloat4> _v,
+                     span<SimdFloat4> _output) {
+  const size_t count = _q.size() < _v.size() ? _q.size() : _v.size();
+  if (_output.size() < count) {
+    return false;
+  }
+  for (size_t i = 0; i < count; i += 4) {
+    BatchStore(BatchTransformVector(BatchLoad(_q, i), BatchLoad(_v, i)), count,
+               _output, i);
+  }
+  return true;
+}
+}  // namespace math
+}  // namespace ozz
@@ -27,6 +27,11 @@
 
 #include "ozz/base/maths/simd_math.h"
 
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
 namespace ozz {
 namespace math {
 
@@ -47,6 +52,10 @@ namespace math {
 #define _OZZ_SIMD_IMPLEMENTATION "SSE3"
 #elif defined(OZZ_SIMD_SSEx)
 #define _OZZ_SIMD_IMPLEMENTATION "SSE2"
+#elif defined(OZZ_SIMD_NEON)
+#define _OZZ_SIMD_IMPLEMENTATION "NEON"
+#elif defined(OZZ_SIMD_WASM)
+#define _OZZ_SIMD_IMPLEMENTATION "WASM-SIMD128"
 #elif defined(OZZ_SIMD_REF)
 #define _OZZ_SIMD_IMPLEMENTATION "Reference"
 #else
@@ -57,5 +66,65 @@ namespace math {
                 " SIMD math implementation")
 
 const char* SimdImplementationName() { return _OZZ_SIMD_IMPLEMENTATION; }
+
+namespace {
+// Detects _feature support, querying cpuid on x86 hosts. Other hosts only
+// support instruction sets enabled at build time.
+bool DetectSimdHostFeature(SimdHostFeature _feature) {
+#if (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+  switch (_feature) {
+    case kSimdHostAvx:
+      return __builtin_cpu_supports("avx") != 0;
+    case kSimdHostAvx2:
+      return __builtin_cpu_supports("avx2") != 0;
+    case kSimdHostFma:
+      return __builtin_cpu_supports("fma") != 0;
+    default:
+      return false;
+  }
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  int info[4];
+  __cpuid(info, 1);
+  // Ymm registers must also be saved by the OS (osxsave and xgetbv).
+  const bool ymm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+  switch (_feature) {
+    case kSimdHostAvx:
+      return ymm && (info[2] & (1 << 28)) != 0;
+    case kSimdHostAvx2:
+      __cpuidex(info, 7, 0);
+      return ymm && (info[1] & (1 << 5)) != 0;
+    case kSimdHostFma:
+      return ymm && (info[2] & (1 << 12)) != 0;
+    default:
+      return false;
+  }
+#else
+  switch (_feature) {
+#if defined(OZZ_SIMD_AVX)
+    case kSimdHostAvx:
+      return true;
+#endif  // OZZ_SIMD_AVX
+#if defined(OZZ_SIMD_AVX2)
+    case kSimdHostAvx2:
+      return true;
+#endif  // OZZ_SIMD_AVX2
+#if defined(OZZ_SIMD_FMA)
+    case kSimdHostFma:
+      return true;
+#endif  // OZZ_SIMD_FMA
+    default:
+      return false;
+  }
+#endif
+}
+}  // namespace
+
+bool SimdHostSupports(SimdHostFeature _feature) {
+  static const bool features[kSimdHostFeatureCount] = {
+      DetectSimdHostFeature(kSimdHostAvx), DetectSimdHostFeature(kSimdHostAvx2),
+      DetectSimdHostFeature(kSimdHostFma)};
+  return _feature < kSimdHostFeatureCount && features[_feature];
+}
 }  // namespace math
 }  // namespace ozz
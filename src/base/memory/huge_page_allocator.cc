@@ -0,0 +1,335 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/huge_page_allocator.h"
+
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif  // WIN32_LEAN_AND_MEAN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif  // NOMINMAX
+#include <windows.h>
+#else  // _WIN32
+#include <sys/mman.h>
+#endif  // _WIN32
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace memory {
+
+namespace {
+// PageRegion pages backing.
+enum PageBacking {
+  kHugePages,         // Explicit huge pages.
+  kTransparentPages,  // Regular pages, possibly transparent huge pages.
+};
+
+// PageRegion header, stored at the beginning of its mapping.
+struct PageRegion {
+  PageRegion* prev;
+  PageRegion* next;
+  size_t size;  // Mapping size.
+  size_t live;  // Number of allocated blocks.
+  char* current;
+  char* end;
+  PageBacking backing;
+};
+
+// Size reserved for the region header, which preserves cache line alignment
+// of the region free range.
+const size_t kRegionHeaderSize = 64;
+static_assert(sizeof(PageRegion) <= kRegionHeaderSize,
+              "PageRegion header doesn't fit its reserved size");
+
+// Header stored in front of each block.
+struct PageBlockHeader {
+  // PageRegion the block was allocated from, or nullptr if it was forwarded to
+  // the parent allocator.
+  PageRegion* region;
+  // Parent allocation of forwarded blocks.
+  void* base;
+  // Block size, including header and alignment padding.
+  size_t size;
+};
+
+// Maps _size bytes, multiple of _page_size. Returns nullptr on failure.
+void* MapPages(size_t _size, size_t _page_size, PageBacking* _backing) {
+#ifdef _WIN32
+  // Large pages require the lock memory privilege, and a size multiple of the
+  // minimum large page size.
+  const SIZE_T large_page_size = GetLargePageMinimum();
+  if (large_page_size != 0 && _size % large_page_size == 0) {
+    void* pages =
+        VirtualAlloc(nullptr, _size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                     PAGE_READWRITE);
+    if (pages) {
+      *_backing = kHugePages;
+      return pages;
+    }
+  }
+  *_backing = kTransparentPages;
+  (void)_page_size;
+  return VirtualAlloc(nullptr, _size, MEM_RESERVE | MEM_COMMIT,
+                      PAGE_READWRITE);
+#else  // _WIN32
+#ifdef MAP_HUGETLB
+  // Explicit huge pages, which must be reserved by the system.
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+  flags |= (_page_size > (2u << 20) ? 30 : 21) << MAP_HUGE_SHIFT;
+#endif  // MAP_HUGE_SHIFT
+  void* pages = mmap(nullptr, _size, PROT_READ | PROT_WRITE, flags, -1, 0);
+  if (pages != MAP_FAILED) {
+    *_backing = kHugePages;
+    return pages;
+  }
+#endif  // MAP_HUGETLB
+
+  // Transparent huge pages can only back ranges aligned to the huge page size,
+  // so one more page is mapped to align the range, and then trimmed.
+  const size_t mapped = _size + _page_size;
+  char* raw = static_cast<char*>(mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  if (raw == MAP_FAILED) {
+    return nullptr;
+  }
+  char* aligned = Align(raw, _page_size);
+  if (aligned != raw) {
+    munmap(raw, aligned - raw);
+  }
+  const size_t tail = (raw + mapped) - (aligned + _size);
+  if (tail != 0) {
+    munmap(aligned + _size, tail);
+  }
+#ifdef MADV_HUGEPAGE
+  madvise(aligned, _size, MADV_HUGEPAGE);
+#endif  // MADV_HUGEPAGE
+  *_backing = kTransparentPages;
+  return aligned;
+#endif  // _WIN32
+}
+
+// Unmaps pages mapped by MapPages.
+void UnmapPages(void* _pages, size_t _size) {
+#ifdef _WIN32
+  (void)_size;
+  VirtualFree(_pages, 0, MEM_RELEASE);
+#else   // _WIN32
+  munmap(_pages, _size);
+#endif  // _WIN32
+}
+}  // namespace
+
+struct HugePageAllocator::Internal {
+  Allocator* parent;
+
+  // Guards all members below.
+  mutable std::mutex mutex;
+
+  // List of mapped regions.
+  PageRegion* regions;
+
+  // PageRegion new blocks are allocated from.
+  PageRegion* current;
+
+  Stats stats;
+
+  // Unmaps empty _region.
+  void Release(PageRegion* _region) {
+    assert(_region->live == 0);
+    if (_region->prev) {
+      _region->prev->next = _region->next;
+    } else {
+      regions = _region->next;
+    }
+    if (_region->next) {
+      _region->next->prev = _region->prev;
+    }
+    if (_region->backing == kHugePages) {
+      --stats.huge_regions;
+      stats.huge_bytes -= _region->size;
+    } else {
+      --stats.transparent_regions;
+      stats.transparent_bytes -= _region->size;
+    }
+    UnmapPages(_region, _region->size);
+  }
+};
+
+HugePageAllocator::HugePageAllocator(PageSize _page_size, Allocator* _parent)
+    : page_size_(_page_size == k1GB ? size_t(1) << 30 : size_t(2) << 20) {
+  Allocator* parent = _parent ? _parent : default_allocator();
+  internal_ = new (parent->Allocate(sizeof(Internal), alignof(Internal)))
+      Internal();
+  internal_->parent = parent;
+  internal_->regions = nullptr;
+  internal_->current = nullptr;
+  internal_->stats = Stats();
+}
+
+HugePageAllocator::~HugePageAllocator() {
+  assert(internal_->stats.used_blocks == 0 &&
+         internal_->stats.forwarded == 0 && "Memory leak detected");
+  for (PageRegion* region = internal_->regions; region;) {
+    PageRegion* next = region->next;
+    UnmapPages(region, region->size);
+    region = next;
+  }
+  Allocator* parent = internal_->parent;
+  internal_->~Internal();
+  parent->Deallocate(internal_);
+}
+
+void* HugePageAllocator::Allocate(size_t _size, size_t _alignment) {
+  if (_alignment < alignof(PageBlockHeader)) {
+    _alignment = alignof(PageBlockHeader);
+  }
+  // Worst case size, including header and alignment padding.
+  const size_t needed = sizeof(PageBlockHeader) + _alignment + _size;
+
+  if (_alignment <= page_size_) {
+    std::lock_guard<std::mutex> lock(internal_->mutex);
+    Stats& stats = internal_->stats;
+
+    PageRegion* region = internal_->current;
+    if (!region ||
+        static_cast<size_t>(region->end - region->current) < needed) {
+      // Maps a new region, a dedicated one if needed exceeds a page.
+      const size_t size = Align(kRegionHeaderSize + needed, page_size_);
+      PageBacking backing;
+      void* pages = MapPages(size, page_size_, &backing);
+      region = pages ? static_cast<PageRegion*>(pages) : nullptr;
+      if (region) {
+        region->prev = nullptr;
+        region->next = internal_->regions;
+        if (region->next) {
+          region->next->prev = region;
+        }
+        internal_->regions = region;
+        region->size = size;
+        region->live = 0;
+        region->current = static_cast<char*>(pages) + kRegionHeaderSize;
+        region->end = static_cast<char*>(pages) + size;
+        region->backing = backing;
+        if (backing == kHugePages) {
+          ++stats.huge_regions;
+          stats.huge_bytes += size;
+        } else {
+          ++stats.transparent_regions;
+          stats.transparent_bytes += size;
+        }
+
+        // Keeps allocating from the region with the most free space. Dedicated
+        // regions never become current, so they're unmapped as soon as their
+        // block is released.
+        PageRegion* current = internal_->current;
+        const size_t remaining = size - kRegionHeaderSize - needed;
+        if (size == page_size_ &&
+            (!current || remaining > static_cast<size_t>(current->end -
+                                                         current->current))) {
+          internal_->current = region;
+          if (current && current->live == 0) {
+            internal_->Release(current);
+          }
+        }
+      }
+    }
+
+    if (region) {
+      char* block = Align(region->current + sizeof(PageBlockHeader),
+                                _alignment);
+      PageBlockHeader* header = reinterpret_cast<PageBlockHeader*>(block) - 1;
+      header->region = region;
+      header->base = nullptr;
+      header->size = (block + _size) - region->current;
+      region->current = block + _size;
+      ++region->live;
+      ++stats.used_blocks;
+      stats.used_bytes += header->size;
+      return block;
+    }
+  }
+
+  // Forwards to the parent allocator if pages can't be mapped.
+  void* base = internal_->parent->Allocate(needed, alignof(PageBlockHeader));
+  if (!base) {
+    return nullptr;
+  }
+  char* block =
+      Align(static_cast<char*>(base) + sizeof(PageBlockHeader), _alignment);
+  PageBlockHeader* header = reinterpret_cast<PageBlockHeader*>(block) - 1;
+  header->region = nullptr;
+  header->base = base;
+  header->size = needed;
+  std::lock_guard<std::mutex> lock(internal_->mutex);
+  ++internal_->stats.forwarded;
+  return block;
+}
+
+void HugePageAllocator::Deallocate(void* _block) {
+  if (!_block) {
+    return;
+  }
+  PageBlockHeader* header = static_cast<PageBlockHeader*>(_block) - 1;
+  PageRegion* region = header->region;
+  if (!region) {
+    internal_->parent->Deallocate(header->base);
+    std::lock_guard<std::mutex> lock(internal_->mutex);
+    --internal_->stats.forwarded;
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(internal_->mutex);
+  Stats& stats = internal_->stats;
+  assert(region->live > 0 && stats.used_blocks > 0);
+  --stats.used_blocks;
+  stats.used_bytes -= header->size;
+  if (--region->live != 0) {
+    return;
+  }
+  if (region == internal_->current) {
+    // Current region is rewound rather than unmapped.
+    region->current = reinterpret_cast<char*>(region) + kRegionHeaderSize;
+  } else {
+    internal_->Release(region);
+  }
+}
+
+HugePageAllocator::Stats HugePageAllocator::stats() const {
+  std::lock_guard<std::mutex> lock(internal_->mutex);
+  return internal_->stats;
+}
+}  // namespace memory
+}  // namespace ozz
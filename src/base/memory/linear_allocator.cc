@@ -0,0 +1,136 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/linear_allocator.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace memory {
+
+// Block header, stored at the beginning of each block allocated from the
+// parent allocator. Block memory follows.
+struct LinearAllocator::Block {
+  Block* next;
+  size_t size;
+};
+
+LinearAllocator::LinearAllocator(size_t _block_size, Allocator* _parent)
+    : parent_(_parent ? _parent : default_allocator()),
+      blocks_(nullptr),
+      current_(nullptr),
+      end_(nullptr),
+      block_size_(_block_size),
+      used_(0),
+      capacity_(0) {}
+
+LinearAllocator::~LinearAllocator() { Release(); }
+
+void* LinearAllocator::Allocate(size_t _size, size_t _alignment) {
+  char* aligned = current_ ? ozz::Align(current_, _alignment) : nullptr;
+  if (!aligned || aligned > end_ ||
+      _size > static_cast<size_t>(end_ - aligned)) {
+    // Current block is exhausted, allocates a new one big enough for this
+    // allocation whatever its alignment.
+    if (!Grow(_size + _alignment - 1)) {
+      return nullptr;
+    }
+    aligned = ozz::Align(current_, _alignment);
+  }
+  assert(aligned + _size <= end_);  // Don't overrun.
+  used_ += static_cast<size_t>(aligned + _size - current_);
+  current_ = aligned + _size;
+  return aligned;
+}
+
+void LinearAllocator::Deallocate(void* _block) { (void)_block; }
+
+void LinearAllocator::Reset() {
+  if (blocks_ && blocks_->next) {
+    // Merges all blocks in a single one, big enough for a similar frame.
+    const size_t capacity = capacity_;
+    Release();
+    block_size_ = math::Max(block_size_, capacity);
+    Grow(block_size_);
+  } else if (blocks_) {
+    current_ = reinterpret_cast<char*>(blocks_ + 1);
+  }
+  used_ = 0;
+}
+
+LinearAllocator::Marker LinearAllocator::marker() const {
+  const Marker marker = {blocks_, current_, used_};
+  return marker;
+}
+
+void LinearAllocator::Rewind(const Marker& _marker) {
+  if (blocks_ == _marker.block) {
+    current_ = _marker.current;
+  } else {
+    // Blocks were added since _marker. The last one is kept current, and is
+    // entirely free again, while the remaining space of older ones stays
+    // unused until Reset() merges all blocks.
+    current_ = reinterpret_cast<char*>(blocks_ + 1);
+  }
+  used_ = _marker.used;
+}
+
+bool LinearAllocator::Grow(size_t _size) {
+  const size_t size = math::Max(block_size_, _size);
+  void* alloc = parent_->Allocate(sizeof(Block) + size, alignof(Block));
+  if (!alloc) {
+    return false;
+  }
+  Block* block = reinterpret_cast<Block*>(alloc);
+  block->next = blocks_;
+  block->size = size;
+  blocks_ = block;
+  current_ = reinterpret_cast<char*>(block + 1);
+  end_ = current_ + size;
+  capacity_ += size;
+  return true;
+}
+
+void LinearAllocator::Release() {
+  while (blocks_) {
+    Block* next = blocks_->next;
+    parent_->Deallocate(blocks_);
+    blocks_ = next;
+  }
+  current_ = nullptr;
+  end_ = nullptr;
+  capacity_ = 0;
+}
+
+LinearAllocator* thread_frame_allocator() {
+  static thread_local LinearAllocator allocator;
+  return &allocator;
+}
+}  // namespace memory
+}  // namespace ozz
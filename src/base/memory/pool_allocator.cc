@@ -0,0 +1,311 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/pool_allocator.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace memory {
+
+namespace {
+// Header stored in front of each block.
+struct BlockHeader {
+  // Size class of the block, or kForwarded.
+  uint32_t size_class;
+  // Index of the block in its size class, or offset from the parent
+  // allocation for forwarded blocks.
+  uint32_t index;
+  // Free list link: index + 1 of the next free block, 0 ending the list.
+  std::atomic<uint32_t> next;
+  uint32_t padding;
+};
+static_assert(sizeof(BlockHeader) == PoolAllocator::kAlignment,
+              "Block header must preserve blocks alignment");
+
+// Size class of blocks forwarded to the parent allocator.
+const uint32_t kForwarded = 0xffffffff;
+
+// Maximum number of chunks per size class.
+const int kMaxChunks = 256;
+
+// Maximum number of blocks per chunk, as a power of 2, so that block indices
+// fit in 32 bits.
+const int kMaxChunkShift = 20;
+
+struct SizeClassPool {
+  // Size of blocks, and of blocks with their header.
+  size_t block_size;
+  size_t slot_size;
+
+  // Number of blocks per chunk is 1 << chunk_shift.
+  int chunk_shift;
+
+  // Free list head: index + 1 of the first free block in the low 32 bits, and
+  // a tag incremented by each update in the high 32 bits, which prevents ABA
+  // issues.
+  std::atomic<uint64_t> head;
+
+  // Chunks of blocks, num_chunks being guarded by the pool mutex.
+  std::atomic<char*> chunks[kMaxChunks];
+  int num_chunks;
+
+  // Number of allocated blocks.
+  std::atomic<size_t> used_blocks;
+};
+
+// Returns the header of block _index of _pool.
+inline BlockHeader* GetHeader(const SizeClassPool& _pool, uint32_t _index) {
+  char* chunk = _pool.chunks[_index >> _pool.chunk_shift].load(
+      std::memory_order_acquire);
+  const size_t offset = _index & ((1u << _pool.chunk_shift) - 1);
+  return reinterpret_cast<BlockHeader*>(chunk + offset * _pool.slot_size);
+}
+
+// Returns a new head value pointing to _first (index + 1), with _head tag
+// incremented.
+inline uint64_t NewHead(uint64_t _head, uint32_t _first) {
+  return (((_head >> 32) + 1) << 32) | _first;
+}
+
+// Pops a block from _pool free list, lock-free. Returns nullptr if the list is
+// empty.
+BlockHeader* Pop(SizeClassPool* _pool) {
+  uint64_t head = _pool->head.load(std::memory_order_acquire);
+  while (const uint32_t first = static_cast<uint32_t>(head)) {
+    BlockHeader* header = GetHeader(*_pool, first - 1);
+    const uint32_t next = header->next.load(std::memory_order_relaxed);
+    if (_pool->head.compare_exchange_weak(head, NewHead(head, next),
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_acquire)) {
+      return header;
+    }
+  }
+  return nullptr;
+}
+
+// Pushes the list of blocks from _first to _last (already linked together) to
+// _pool free list, lock-free.
+void Push(SizeClassPool* _pool, BlockHeader* _first, BlockHeader* _last) {
+  uint64_t head = _pool->head.load(std::memory_order_relaxed);
+  do {
+    _last->next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+  } while (!_pool->head.compare_exchange_weak(
+      head, NewHead(head, _first->index + 1), std::memory_order_release,
+      std::memory_order_relaxed));
+}
+}  // namespace
+
+struct PoolAllocator::Internal {
+  Allocator* parent;
+  size_t chunk_size;
+  int num_classes;
+  SizeClassPool classes[kMaxClasses];
+
+  // Guards chunks allocation.
+  std::mutex mutex;
+
+  std::atomic<size_t> allocations;
+  std::atomic<size_t> deallocations;
+  std::atomic<size_t> recycled;
+  std::atomic<size_t> forwarded;
+  std::atomic<size_t> chunks;
+  std::atomic<size_t> chunk_bytes;
+};
+
+PoolAllocator::PoolAllocator(size_t _max_block_size, size_t _chunk_size,
+                             Allocator* _parent) {
+  Allocator* parent = _parent ? _parent : default_allocator();
+  internal_ = new (parent->Allocate(sizeof(Internal), alignof(Internal)))
+      Internal();
+  internal_->parent = parent;
+  internal_->chunk_size = _chunk_size;
+  internal_->allocations = 0;
+  internal_->deallocations = 0;
+  internal_->recycled = 0;
+  internal_->forwarded = 0;
+  internal_->chunks = 0;
+  internal_->chunk_bytes = 0;
+
+  // Size classes cover up to _max_block_size.
+  int num_classes = 1;
+  while (num_classes < kMaxClasses &&
+         (kAlignment << (num_classes - 1)) < _max_block_size) {
+    ++num_classes;
+  }
+  internal_->num_classes = num_classes;
+
+  for (int i = 0; i < kMaxClasses; ++i) {
+    SizeClassPool& pool = internal_->classes[i];
+    pool.block_size = kAlignment << i;
+    pool.slot_size = pool.block_size + sizeof(BlockHeader);
+    pool.chunk_shift = 0;
+    while (pool.chunk_shift < kMaxChunkShift &&
+           (pool.slot_size << (pool.chunk_shift + 1)) <= _chunk_size) {
+      ++pool.chunk_shift;
+    }
+    pool.head = 0;
+    for (int j = 0; j < kMaxChunks; ++j) {
+      pool.chunks[j] = nullptr;
+    }
+    pool.num_chunks = 0;
+    pool.used_blocks = 0;
+  }
+}
+
+PoolAllocator::~PoolAllocator() {
+  assert(internal_->allocations.load() == internal_->deallocations.load() &&
+         "Memory leak detected");
+  Allocator* parent = internal_->parent;
+  for (int i = 0; i < kMaxClasses; ++i) {
+    const SizeClassPool& pool = internal_->classes[i];
+    for (int j = 0; j < pool.num_chunks; ++j) {
+      parent->Deallocate(pool.chunks[j].load());
+    }
+  }
+  internal_->~Internal();
+  parent->Deallocate(internal_);
+}
+
+int PoolAllocator::SizeClass(size_t _size) const {
+  int size_class = 0;
+  while (size_class < internal_->num_classes &&
+         (kAlignment << size_class) < _size) {
+    ++size_class;
+  }
+  return size_class < internal_->num_classes ? size_class : -1;
+}
+
+void* PoolAllocator::Allocate(size_t _size, size_t _alignment) {
+  const int size_class = _alignment <= kAlignment ? SizeClass(_size) : -1;
+  if (size_class >= 0) {
+    SizeClassPool* pool = &internal_->classes[size_class];
+    BlockHeader* header = Pop(pool);
+    if (header) {
+      ++internal_->recycled;
+    } else {
+      // Free list is empty, allocates a new chunk. Another thread might have
+      // allocated one in the meantime, so free list is tested again.
+      std::lock_guard<std::mutex> lock(internal_->mutex);
+      header = Pop(pool);
+      if (!header && pool->num_chunks < kMaxChunks) {
+        const uint32_t num_blocks = 1u << pool->chunk_shift;
+        const size_t chunk_bytes = pool->slot_size * num_blocks;
+        char* chunk = reinterpret_cast<char*>(
+            internal_->parent->Allocate(chunk_bytes, kAlignment));
+        if (chunk) {
+          const uint32_t first = static_cast<uint32_t>(pool->num_chunks)
+                                 << pool->chunk_shift;
+          for (uint32_t i = 0; i < num_blocks; ++i) {
+            BlockHeader* block =
+                reinterpret_cast<BlockHeader*>(chunk + i * pool->slot_size);
+            block->size_class = static_cast<uint32_t>(size_class);
+            block->index = first + i;
+            block->next.store(first + i + 2, std::memory_order_relaxed);
+            block->padding = 0;
+          }
+          pool->chunks[pool->num_chunks++].store(chunk,
+                                                 std::memory_order_release);
+          ++internal_->chunks;
+          internal_->chunk_bytes += chunk_bytes;
+
+          // First block is returned, others are pushed to the free list.
+          header = reinterpret_cast<BlockHeader*>(chunk);
+          if (num_blocks > 1) {
+            Push(pool,
+                 reinterpret_cast<BlockHeader*>(chunk + pool->slot_size),
+                 reinterpret_cast<BlockHeader*>(
+                     chunk + (num_blocks - 1) * pool->slot_size));
+          }
+        }
+      }
+    }
+    if (header) {
+      ++pool->used_blocks;
+      ++internal_->allocations;
+      return header + 1;
+    }
+  }
+
+  // Forwards to the parent allocator, keeping space for the header.
+  const size_t alignment = math::Max(_alignment, kAlignment);
+  char* alloc = reinterpret_cast<char*>(
+      internal_->parent->Allocate(_size + alignment, alignment));
+  if (!alloc) {
+    return nullptr;
+  }
+  BlockHeader* header =
+      reinterpret_cast<BlockHeader*>(alloc + alignment) - 1;
+  header->size_class = kForwarded;
+  header->index = static_cast<uint32_t>(alignment);
+  ++internal_->forwarded;
+  ++internal_->allocations;
+  return header + 1;
+}
+
+void PoolAllocator::Deallocate(void* _block) {
+  if (!_block) {
+    return;
+  }
+  BlockHeader* header = reinterpret_cast<BlockHeader*>(_block) - 1;
+  ++internal_->deallocations;
+  if (header->size_class == kForwarded) {
+    internal_->parent->Deallocate(reinterpret_cast<char*>(_block) -
+                                  header->index);
+    return;
+  }
+  assert(header->size_class < static_cast<uint32_t>(internal_->num_classes));
+  SizeClassPool* pool = &internal_->classes[header->size_class];
+  --pool->used_blocks;
+  Push(pool, header, header);
+}
+
+PoolAllocator::Stats PoolAllocator::stats() const {
+  Stats stats;
+  stats.allocations = internal_->allocations.load();
+  stats.deallocations = internal_->deallocations.load();
+  stats.recycled = internal_->recycled.load();
+  stats.forwarded = internal_->forwarded.load();
+  stats.chunks = internal_->chunks.load();
+  stats.chunk_bytes = internal_->chunk_bytes.load();
+  stats.used_blocks = 0;
+  stats.used_bytes = 0;
+  for (int i = 0; i < internal_->num_classes; ++i) {
+    const SizeClassPool& pool = internal_->classes[i];
+    const size_t used = pool.used_blocks.load();
+    stats.used_blocks += used;
+    stats.used_bytes += used * pool.block_size;
+  }
+  return stats;
+}
+}  // namespace memory
+}  // namespace ozz
@@ -0,0 +1,185 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/tracking_allocator.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace memory {
+
+namespace {
+// Header stored in front of each block.
+struct TrackingHeader {
+  size_t size;
+  uint32_t tag;
+  // Offset from the parent allocation to the block.
+  uint32_t offset;
+};
+static_assert(sizeof(TrackingHeader) <= 16, "Unexpected header size");
+
+// Calling thread current tag.
+thread_local MemoryTag g_current_tag = kTagUntagged;
+
+// Raises _peak to _value if it's bigger.
+void UpdatePeak(std::atomic<size_t>* _peak, size_t _value) {
+  size_t peak = _peak->load(std::memory_order_relaxed);
+  while (peak < _value &&
+         !_peak->compare_exchange_weak(peak, _value,
+                                       std::memory_order_relaxed)) {
+  }
+}
+
+template <typename _Counters>
+TrackingAllocator::Stats ToStats(const _Counters& _counters) {
+  TrackingAllocator::Stats stats;
+  stats.live_bytes = _counters.live_bytes.load();
+  stats.live_allocations = _counters.live_allocations.load();
+  stats.peak_bytes = _counters.peak_bytes.load();
+  stats.allocations = _counters.allocations.load();
+  stats.deallocations = _counters.deallocations.load();
+  stats.allocated_bytes = _counters.allocated_bytes.load();
+  return stats;
+}
+}  // namespace
+
+const char* TagName(MemoryTag _tag) {
+  static const char* kNames[] = {"untagged", "skeleton", "animation",
+                                 "track",    "context",  "offline"};
+  static_assert(OZZ_ARRAY_SIZE(kNames) == kTagCount,
+                "Tag names must match MemoryTag enum");
+  return _tag >= 0 && _tag < kTagCount ? kNames[_tag] : "invalid";
+}
+
+MemoryTag current_tag() { return g_current_tag; }
+
+TagScope::TagScope(MemoryTag _tag) : previous_(g_current_tag) {
+  assert(_tag >= 0 && _tag < kTagCount);
+  g_current_tag = _tag;
+}
+
+TagScope::~TagScope() { g_current_tag = previous_; }
+
+struct TrackingAllocator::Counters {
+  Counters()
+      : live_bytes(0),
+        live_allocations(0),
+        peak_bytes(0),
+        allocations(0),
+        deallocations(0),
+        allocated_bytes(0) {}
+
+  std::atomic<size_t> live_bytes;
+  std::atomic<size_t> live_allocations;
+  std::atomic<size_t> peak_bytes;
+  std::atomic<size_t> allocations;
+  std::atomic<size_t> deallocations;
+  std::atomic<size_t> allocated_bytes;
+};
+
+TrackingAllocator::TrackingAllocator(Allocator* _parent)
+    : parent_(_parent ? _parent : default_allocator()) {
+  // One set of counters per tag, plus the total.
+  counters_ = reinterpret_cast<Counters*>(parent_->Allocate(
+      sizeof(Counters) * (kTagCount + 1), alignof(Counters)));
+  for (int i = 0; i < kTagCount + 1; ++i) {
+    new (counters_ + i) Counters();
+  }
+}
+
+TrackingAllocator::~TrackingAllocator() {
+  for (int i = 0; i < kTagCount + 1; ++i) {
+    counters_[i].~Counters();
+  }
+  parent_->Deallocate(counters_);
+}
+
+void* TrackingAllocator::Allocate(size_t _size, size_t _alignment) {
+  // Header is stored in front of the block, in a space that preserves
+  // alignment.
+  const size_t offset = math::Max(_alignment, size_t(16));
+  char* alloc = reinterpret_cast<char*>(parent_->Allocate(
+      _size + offset, math::Max(_alignment, alignof(TrackingHeader))));
+  if (!alloc) {
+    return nullptr;
+  }
+  const MemoryTag tag = g_current_tag;
+  char* block = alloc + offset;
+  TrackingHeader* header = reinterpret_cast<TrackingHeader*>(block) - 1;
+  header->size = _size;
+  header->tag = static_cast<uint32_t>(tag);
+  header->offset = static_cast<uint32_t>(offset);
+
+  Counters* counters[] = {&counters_[tag], &counters_[kTagCount]};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(counters); ++i) {
+    Counters& c = *counters[i];
+    const size_t live = c.live_bytes.fetch_add(_size) + _size;
+    ++c.live_allocations;
+    ++c.allocations;
+    c.allocated_bytes += _size;
+    UpdatePeak(&c.peak_bytes, live);
+  }
+  return block;
+}
+
+void TrackingAllocator::Deallocate(void* _block) {
+  if (!_block) {
+    return;
+  }
+  const TrackingHeader* header =
+      reinterpret_cast<const TrackingHeader*>(_block) - 1;
+  assert(header->tag < kTagCount && "Invalid or corrupted block");
+  Counters* counters[] = {&counters_[header->tag], &counters_[kTagCount]};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(counters); ++i) {
+    Counters& c = *counters[i];
+    c.live_bytes -= header->size;
+    --c.live_allocations;
+    ++c.deallocations;
+  }
+  parent_->Deallocate(reinterpret_cast<char*>(_block) - header->offset);
+}
+
+TrackingAllocator::Stats TrackingAllocator::stats(MemoryTag _tag) const {
+  assert(_tag >= 0 && _tag < kTagCount);
+  return ToStats(counters_[_tag]);
+}
+
+TrackingAllocator::Stats TrackingAllocator::total() const {
+  return ToStats(counters_[kTagCount]);
+}
+
+void TrackingAllocator::ResetPeaks() {
+  for (int i = 0; i < kTagCount + 1; ++i) {
+    counters_[i].peak_bytes = counters_[i].live_bytes.load();
+  }
+}
+}  // namespace memory
+}  // namespace ozz
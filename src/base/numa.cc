@@ -0,0 +1,170 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/numa.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif  // __linux__
+
+#include "ozz/base/containers/vector.h"
+
+namespace ozz {
+namespace numa {
+
+namespace {
+// Host topology, queried once.
+struct NumaTopology {
+  NumaTopology() : num_nodes(1) {
+    const int num_cpus =
+        static_cast<int>(std::max(std::thread::hardware_concurrency(), 1u));
+    cpu_nodes.assign(num_cpus, 0);
+#ifdef __linux__
+    // Parses nodes cpu lists, formatted as "0-3,8,10-11".
+    for (int node = 0;; ++node) {
+      char path[64];
+      std::snprintf(path, sizeof(path),
+                    "/sys/devices/system/node/node%d/cpulist", node);
+      std::FILE* file = std::fopen(path, "r");
+      if (!file) {
+        break;
+      }
+      int first, last;
+      while (std::fscanf(file, "%d", &first) == 1) {
+        last = first;
+        int separator = std::fgetc(file);
+        if (separator == '-') {
+          if (std::fscanf(file, "%d", &last) != 1) {
+            break;
+          }
+          separator = std::fgetc(file);
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+          if (cpu >= static_cast<int>(cpu_nodes.size())) {
+            cpu_nodes.resize(cpu + 1, 0);
+          }
+          cpu_nodes[cpu] = node;
+        }
+        if (separator != ',') {
+          break;
+        }
+      }
+      std::fclose(file);
+      num_nodes = node + 1;
+    }
+#endif  // __linux__
+  }
+  int num_nodes;
+  ozz::vector<int> cpu_nodes;
+};
+
+const NumaTopology& Topology() {
+  static const NumaTopology topology;
+  return topology;
+}
+
+// Arguments of a RunOnNode thread.
+struct RunOnNodeArgs {
+  int node;
+  void (*fn)(void*);
+  void* data;
+};
+
+void RunOnNodeThread(const RunOnNodeArgs* _args) {
+  PinThreadToNode(_args->node);
+  _args->fn(_args->data);
+}
+}  // namespace
+
+int NumNodes() { return Topology().num_nodes; }
+
+int NumCpus() { return static_cast<int>(Topology().cpu_nodes.size()); }
+
+int CpuNode(int _cpu) {
+  const NumaTopology& topology = Topology();
+  if (_cpu < 0 || _cpu >= static_cast<int>(topology.cpu_nodes.size())) {
+    return 0;
+  }
+  return topology.cpu_nodes[_cpu];
+}
+
+int CurrentNode() {
+#ifdef __linux__
+  return CpuNode(sched_getcpu());
+#else   // __linux__
+  return 0;
+#endif  // __linux__
+}
+
+bool PinThread(int _cpu) {
+#ifdef __linux__
+  if (_cpu < 0 || _cpu >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(_cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else   // __linux__
+  (void)_cpu;
+  return false;
+#endif  // __linux__
+}
+
+bool PinThreadToNode(int _node) {
+#ifdef __linux__
+  const NumaTopology& topology = Topology();
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  bool empty = true;
+  for (size_t cpu = 0; cpu < topology.cpu_nodes.size() && cpu < CPU_SETSIZE;
+       ++cpu) {
+    if (topology.cpu_nodes[cpu] == _node) {
+      CPU_SET(cpu, &set);
+      empty = false;
+    }
+  }
+  return !empty && _node < topology.num_nodes &&
+         pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else   // __linux__
+  (void)_node;
+  return false;
+#endif  // __linux__
+}
+
+void RunOnNode(int _node, void (*_fn)(void*), void* _data) {
+  const RunOnNodeArgs args = {_node, _fn, _data};
+  std::thread thread(&RunOnNodeThread, &args);
+  thread.join();
+}
+}  // namespace numa
+}  // namespace ozz
@@ -0,0 +1,59 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace profile {
+
+namespace {
+// Current hooks, constant initialized so zones can be used during static
+// initialization.
+Hooks g_hooks = {nullptr, nullptr, nullptr};
+}  // namespace
+
+Hooks SetHooks(const Hooks& _hooks) {
+  const Hooks previous = g_hooks;
+  g_hooks = _hooks;
+  return previous;
+}
+
+Hooks GetHooks() { return g_hooks; }
+
+void ZoneBegin(const ZoneDesc& _zone) {
+  if (g_hooks.begin) {
+    g_hooks.begin(_zone, g_hooks.user_data);
+  }
+}
+
+void ZoneEnd(const ZoneDesc& _zone) {
+  if (g_hooks.end) {
+    g_hooks.end(_zone, g_hooks.user_data);
+  }
+}
+}  // namespace profile
+}  // namespace ozz
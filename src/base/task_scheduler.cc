@@ -0,0 +1,389 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/task_scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "ozz/base/containers/deque.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/numa.h"
+
+namespace ozz {
+
+static_assert(std::is_same<decltype(&TaskScheduler::ParallelForHook),
+                           ParallelForHook>::value,
+              "TaskScheduler::ParallelForHook must match hook signature.");
+
+void TaskScheduler::ParallelForHook(int _count, Task _task, void* _task_data,
+                                    void* _user_data) {
+  assert(_user_data && "TaskScheduler expected as hook user data.");
+  static_cast<TaskScheduler*>(_user_data)->ParallelFor(_count, _task,
+                                                       _task_data);
+}
+
+namespace {
+// Tasks of a single ParallelFor call, which lives on the caller stack.
+struct SchedulerJob {
+  TaskScheduler::Task task;
+  void* data;
+  std::atomic<int> remaining;  // Number of ranges not completed yet.
+};
+
+// Range of tasks [begin, end[ of a job.
+struct SchedulerRange {
+  SchedulerJob* job;
+  int begin;
+  int end;
+};
+
+// Queue of ranges, popped from the back by its owner, and from the front by
+// thieves.
+struct SchedulerQueue {
+  std::mutex mutex;
+  ozz::deque<SchedulerRange> ranges;
+};
+
+// Scheduler and queue index of the current thread, when it's a worker.
+thread_local const void* g_worker_scheduler = nullptr;
+thread_local int g_worker_queue = 0;
+
+// Number of ranges each ParallelFor is split into, per thread. More ranges
+// balance load better, fewer reduce scheduling overhead.
+const int kRangesPerThread = 4;
+}  // namespace
+
+struct WorkStealingScheduler::Impl {
+  // Queues, first one is shared by all non-worker threads, then one per
+  // worker.
+  ozz::vector<SchedulerQueue*> queues;
+  ozz::vector<std::thread> workers;
+
+  // Memory node of each queue owner, all 0 if workers aren't pinned.
+  ozz::vector<int> nodes;
+
+  // Number of ranges pushed to queues and not popped yet.
+  std::atomic<int> pending;
+
+  // Wakes up idle workers.
+  std::mutex mutex;
+  std::condition_variable wake;
+  bool stop;
+
+  // Pops a range from queue _queue back, or steals one from the front of
+  // other queues, the ones of _queue node first.
+  bool Pop(int _queue, SchedulerRange* _range) {
+    const int num_queues = static_cast<int>(queues.size());
+    const int node = nodes[_queue];
+    for (int pass = 0; pass < 2; ++pass) {
+      for (int i = 0; i < num_queues; ++i) {
+        const int index = (_queue + i) % num_queues;
+        if ((nodes[index] == node) != (pass == 0)) {
+          continue;
+        }
+        SchedulerQueue& queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.ranges.empty()) {
+          if (i == 0) {
+            *_range = queue.ranges.back();
+            queue.ranges.pop_back();
+          } else {
+            *_range = queue.ranges.front();
+            queue.ranges.pop_front();
+          }
+          pending.fetch_sub(1, std::memory_order_relaxed);
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  // Runs one range, if any can be found. Returns false otherwise.
+  bool RunOne(int _queue) {
+    SchedulerRange range;
+    if (!Pop(_queue, &range)) {
+      return false;
+    }
+    SchedulerJob* job = range.job;
+    for (int i = range.begin; i < range.end; ++i) {
+      job->task(i, job->data);
+    }
+    // Job can't be accessed anymore once completed.
+    job->remaining.fetch_sub(1, std::memory_order_acq_rel);
+    return true;
+  }
+
+  void WorkerLoop(int _queue, int _cpu) {
+    if (_cpu >= 0) {
+      numa::PinThread(_cpu);
+    }
+    g_worker_scheduler = this;
+    g_worker_queue = _queue;
+    for (;;) {
+      if (RunOne(_queue)) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [this] {
+        return stop || pending.load(std::memory_order_relaxed) > 0;
+      });
+      if (stop) {
+        return;
+      }
+    }
+  }
+};
+
+WorkStealingScheduler::WorkStealingScheduler(int _num_workers,
+                                             bool _pin_workers)
+    : impl_(New<Impl>()) {
+  if (_num_workers < 0) {
+    const int hardware = static_cast<int>(std::thread::hardware_concurrency());
+    _num_workers = std::max(hardware - 1, 0);
+  }
+  impl_->pending.store(0);
+  impl_->stop = false;
+  impl_->queues.resize(_num_workers + 1);
+  for (size_t i = 0; i < impl_->queues.size(); ++i) {
+    impl_->queues[i] = New<SchedulerQueue>();
+  }
+
+  // Sorts hardware threads by node, so that queues of the same node are
+  // contiguous. Queue 0 is given to the first hardware thread.
+  ozz::vector<int> cpus;
+  impl_->nodes.assign(impl_->queues.size(), 0);
+  if (_pin_workers) {
+    for (int cpu = 0; cpu < numa::NumCpus(); ++cpu) {
+      cpus.push_back(cpu);
+    }
+    std::stable_sort(cpus.begin(), cpus.end(), [](int _a, int _b) {
+      return numa::CpuNode(_a) < numa::CpuNode(_b);
+    });
+    for (size_t i = 0; i < impl_->queues.size(); ++i) {
+      impl_->nodes[i] = numa::CpuNode(cpus[i % cpus.size()]);
+    }
+  }
+
+  impl_->workers.reserve(_num_workers);
+  for (int i = 0; i < _num_workers; ++i) {
+    const int cpu = cpus.empty() ? -1 : cpus[(i + 1) % cpus.size()];
+    impl_->workers.emplace_back(&Impl::WorkerLoop, impl_, i + 1, cpu);
+  }
+}
+
+WorkStealingScheduler::~WorkStealingScheduler() {
+  assert(impl_->pending.load() == 0 && "ParallelFor still pending.");
+  {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->stop = true;
+  }
+  impl_->wake.notify_all();
+  for (size_t i = 0; i < impl_->workers.size(); ++i) {
+    impl_->workers[i].join();
+  }
+  for (size_t i = 0; i < impl_->queues.size(); ++i) {
+    Delete(impl_->queues[i]);
+  }
+  Delete(impl_);
+}
+
+int WorkStealingScheduler::num_workers() const {
+  return static_cast<int>(impl_->workers.size());
+}
+
+int WorkStealingScheduler::worker_node(int _worker) const {
+  if (_worker < 0 || _worker >= num_workers()) {
+    return 0;
+  }
+  return impl_->nodes[_worker + 1];
+}
+
+void WorkStealingScheduler::ParallelFor(int _count, Task _task, void* _data) {
+  if (_count <= 0) {
+    return;
+  }
+  const int num_queues = static_cast<int>(impl_->queues.size());
+  if (num_queues == 1 || _count == 1) {
+    for (int i = 0; i < _count; ++i) {
+      _task(i, _data);
+    }
+    return;
+  }
+
+  // Splits tasks in ranges, distributed to all queues, starting with the
+  // calling thread one. Consecutive ranges go to the same queue.
+  const int queue = g_worker_scheduler == impl_ ? g_worker_queue : 0;
+  const int num_ranges = std::min(_count, num_queues * kRangesPerThread);
+  SchedulerJob job;
+  job.task = _task;
+  job.data = _data;
+  job.remaining.store(num_ranges, std::memory_order_relaxed);
+  for (int r = 0; r < num_ranges; ++r) {
+    const SchedulerRange range = {
+        &job, static_cast<int>(static_cast<int64_t>(_count) * r / num_ranges),
+        static_cast<int>(static_cast<int64_t>(_count) * (r + 1) / num_ranges)};
+    const int target_queue =
+        (queue + static_cast<int>(static_cast<int64_t>(r) * num_queues /
+                                  num_ranges)) %
+        num_queues;
+    SchedulerQueue& target = *impl_->queues[target_queue];
+    std::lock_guard<std::mutex> lock(target.mutex);
+    target.ranges.push_back(range);
+  }
+  impl_->pending.fetch_add(num_ranges, std::memory_order_relaxed);
+  {
+    // Synchronizes with workers testing pending before waiting.
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+  }
+  impl_->wake.notify_all();
+
+  // Runs ranges until all job ranges are completed, possibly running ranges
+  // of other jobs.
+  while (job.remaining.load(std::memory_order_acquire) > 0) {
+    if (!impl_->RunOne(queue)) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+TaskGraph::TaskGraph() {}
+
+int TaskGraph::AddNode(int _count, TaskScheduler::Task _task, void* _data) {
+  const Node node = {_count, _task, _data};
+  nodes_.push_back(node);
+  return num_nodes() - 1;
+}
+
+bool TaskGraph::AddDependency(int _before, int _after) {
+  if (_before < 0 || _before >= num_nodes() || _after < 0 ||
+      _after >= num_nodes() || _before == _after) {
+    return false;
+  }
+  const Dependency dependency = {_before, _after};
+  dependencies_.push_back(dependency);
+  return true;
+}
+
+void TaskGraph::Clear() {
+  nodes_.clear();
+  dependencies_.clear();
+}
+
+namespace {
+// Runs the tasks of all nodes of a wave, flattened to a single index range.
+struct TaskGraphWave {
+  const TaskScheduler::Task* tasks;
+  void* const* data;
+  const int* offsets;  // First flattened task of each node, plus end.
+  int num_nodes;
+};
+
+void RunTaskGraphWave(int _task, void* _data) {
+  const TaskGraphWave& wave = *static_cast<const TaskGraphWave*>(_data);
+  const int node = static_cast<int>(
+      std::upper_bound(wave.offsets, wave.offsets + wave.num_nodes + 1,
+                       _task) -
+      wave.offsets - 1);
+  wave.tasks[node](_task - wave.offsets[node], wave.data[node]);
+}
+}  // namespace
+
+bool TaskGraph::Run(TaskScheduler* _scheduler) const {
+  // Sorts nodes in waves of nodes whose dependencies are all in previous
+  // waves.
+  const int count = num_nodes();
+  ozz::vector<int> in_degrees(count, 0);
+  for (size_t i = 0; i < dependencies_.size(); ++i) {
+    ++in_degrees[dependencies_[i].after];
+  }
+  ozz::vector<int> order;
+  order.reserve(count);
+  for (int i = 0; i < count; ++i) {
+    if (in_degrees[i] == 0) {
+      order.push_back(i);
+    }
+  }
+  ozz::vector<size_t> waves(1, 0);
+  for (size_t begin = 0; begin < order.size();) {
+    const size_t end = order.size();
+    for (size_t i = begin; i < end; ++i) {
+      for (size_t d = 0; d < dependencies_.size(); ++d) {
+        const Dependency& dependency = dependencies_[d];
+        if (dependency.before == order[i] &&
+            --in_degrees[dependency.after] == 0) {
+          order.push_back(dependency.after);
+        }
+      }
+    }
+    waves.push_back(end);
+    begin = end;
+  }
+  if (static_cast<int>(order.size()) != count) {
+    return false;  // Cycle detected.
+  }
+
+  ozz::vector<TaskScheduler::Task> tasks;
+  ozz::vector<void*> data;
+  ozz::vector<int> offsets;
+  for (size_t w = 1; w < waves.size(); ++w) {
+    tasks.clear();
+    data.clear();
+    offsets.assign(1, 0);
+    for (size_t i = waves[w - 1]; i < waves[w]; ++i) {
+      const Node& node = nodes_[order[i]];
+      if (node.count <= 0) {
+        continue;
+      }
+      if (!_scheduler) {
+        for (int t = 0; t < node.count; ++t) {
+          node.task(t, node.data);
+        }
+        continue;
+      }
+      tasks.push_back(node.task);
+      data.push_back(node.data);
+      offsets.push_back(offsets.back() + node.count);
+    }
+    if (tasks.size() == 1) {
+      _scheduler->ParallelFor(offsets[1], tasks[0], data[0]);
+    } else if (tasks.size() > 1) {
+      TaskGraphWave wave = {tasks.data(), data.data(), offsets.data(),
+                            static_cast<int>(tasks.size())};
+      _scheduler->ParallelFor(offsets.back(), &RunTaskGraphWave, &wave);
+    }
+  }
+  return true;
+}
+}  // namespace ozz
@@ -0,0 +1,410 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/character_pipeline.h"
+
+#include <cassert>
+#include <new>
+
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/task_scheduler.h"
+
+namespace ozz {
+namespace geometry {
+
+namespace {
+// Pipeline buffers are aligned and padded to cache lines, so that concurrent
+// tasks (of the same or different pipelines) never write to the same line.
+const size_t kCacheLineSize = 64;
+
+size_t CacheAlign(size_t _size) {
+  return (_size + kCacheLineSize - 1) & ~(kCacheLineSize - 1);
+}
+}  // namespace
+
+// Sampling state of a layer, written by its sampling task only.
+struct CharacterPipeline::LayerState {
+  LayerState(int _max_tracks, span<byte> _buffer, bool _cubic)
+      : context(_max_tracks, _buffer, _cubic), failed(false) {}
+  animation::SamplingJob::Context context;
+  bool failed;
+};
+
+CharacterPipeline::Layer::Layer()
+    : animation(nullptr), ratio(0.f), weight(1.f), additive(false) {}
+
+CharacterPipeline::CharacterPipeline()
+    : skeleton_(nullptr),
+      max_layers_(0),
+      num_soa_(0),
+      num_joints_(0),
+      buffer_(nullptr),
+      layers_(nullptr),
+      layers_states_(nullptr),
+      layers_locals_(nullptr),
+      layers_locals_stride_(0),
+      blend_layers_(nullptr),
+      locals_(nullptr),
+      models_(nullptr),
+      skinning_matrices_(nullptr),
+      ik_callback_(nullptr),
+      ik_user_data_(nullptr),
+      succeeded_(false) {}
+
+CharacterPipeline::~CharacterPipeline() { Deallocate(); }
+
+bool CharacterPipeline::Allocate(const animation::Skeleton& _skeleton,
+                                 int _max_layers, int _max_tracks,
+                                 bool _cubic) {
+  Deallocate();
+  if (_max_layers <= 0 || _max_tracks < 0 || _skeleton.num_joints() == 0) {
+    return false;
+  }
+
+  // Computes buffers layout.
+  const int num_soa = _skeleton.num_soa_joints();
+  const int num_joints = _skeleton.num_joints();
+  const size_t context_size =
+      CacheAlign(animation::SamplingJob::Context::BufferSize(_max_tracks,
+                                                             _cubic));
+  const size_t state_size = CacheAlign(sizeof(LayerState));
+  const size_t locals_size = CacheAlign(sizeof(math::SoaTransform) * num_soa);
+  const size_t matrices_size = CacheAlign(sizeof(math::Float4x4) * num_joints);
+  const size_t layers_size = CacheAlign(sizeof(Layer) * _max_layers);
+  const size_t blend_layers_size =
+      CacheAlign(sizeof(animation::BlendingJob::Layer) * _max_layers);
+  const size_t size = layers_size + blend_layers_size +
+                      (state_size + context_size + locals_size) * _max_layers +
+                      locals_size + matrices_size * 2;
+
+  buffer_ = memory::default_allocator()->Allocate(size, kCacheLineSize);
+  byte* alloc_cursor = static_cast<byte*>(buffer_);
+
+  skeleton_ = &_skeleton;
+  max_layers_ = _max_layers;
+  num_soa_ = num_soa;
+  num_joints_ = num_joints;
+
+  layers_ = reinterpret_cast<Layer*>(alloc_cursor);
+  alloc_cursor += layers_size;
+  blend_layers_ =
+      reinterpret_cast<animation::BlendingJob::Layer*>(alloc_cursor);
+  alloc_cursor += blend_layers_size;
+  layers_states_ = reinterpret_cast<LayerState*>(alloc_cursor);
+  alloc_cursor += state_size * _max_layers;
+  byte* contexts_buffer = alloc_cursor;
+  alloc_cursor += context_size * _max_layers;
+  layers_locals_ = alloc_cursor;
+  layers_locals_stride_ = locals_size;
+  alloc_cursor += locals_size * _max_layers;
+  locals_ = reinterpret_cast<math::SoaTransform*>(alloc_cursor);
+  alloc_cursor += locals_size;
+  models_ = reinterpret_cast<math::Float4x4*>(alloc_cursor);
+  alloc_cursor += matrices_size;
+  skinning_matrices_ = reinterpret_cast<math::Float4x4*>(alloc_cursor);
+  alloc_cursor += matrices_size;
+  assert(alloc_cursor == static_cast<byte*>(buffer_) + size);
+
+  // Constructs per layer objects.
+  for (int i = 0; i < _max_layers; ++i) {
+    new (&layers_[i]) Layer();
+    new (&blend_layers_[i]) animation::BlendingJob::Layer();
+    byte* state = reinterpret_cast<byte*>(layers_states_) + state_size * i;
+    new (state) LayerState(
+        _max_tracks,
+        span<byte>(contexts_buffer + context_size * i, context_size), _cubic);
+  }
+
+  ik_callback_ = nullptr;
+  ik_user_data_ = nullptr;
+  inverse_bind_poses_ = span<const math::Float4x4>();
+  succeeded_ = false;
+
+  return true;
+}
+
+void CharacterPipeline::Deallocate() {
+  if (buffer_) {
+    for (int i = 0; i < max_layers_; ++i) {
+      layer_state(i)->~LayerState();
+      blend_layers_[i].~Layer();
+      layers_[i].~Layer();
+    }
+    memory::default_allocator()->Deallocate(buffer_);
+  }
+  skeleton_ = nullptr;
+  max_layers_ = 0;
+  num_soa_ = 0;
+  num_joints_ = 0;
+  buffer_ = nullptr;
+  layers_ = nullptr;
+  layers_states_ = nullptr;
+  layers_locals_ = nullptr;
+  layers_locals_stride_ = 0;
+  blend_layers_ = nullptr;
+  locals_ = nullptr;
+  models_ = nullptr;
+  skinning_matrices_ = nullptr;
+  succeeded_ = false;
+}
+
+void CharacterPipeline::set_skinning_jobs(span<const SkinningJob> _jobs) {
+  skinning_jobs_.assign(_jobs.begin(), _jobs.end());
+  skinning_failed_.assign(_jobs.size(), 0);
+}
+
+span<const math::SoaTransform> CharacterPipeline::layer_locals(
+    int _layer) const {
+  if (_layer < 0 || _layer >= max_layers_) {
+    return span<const math::SoaTransform>();
+  }
+  return span<const math::SoaTransform>(
+      reinterpret_cast<const math::SoaTransform*>(
+          layers_locals_ + layers_locals_stride_ * _layer),
+      num_soa_);
+}
+
+CharacterPipeline::LayerState* CharacterPipeline::layer_state(
+    int _layer) const {
+  return reinterpret_cast<LayerState*>(
+      reinterpret_cast<byte*>(layers_states_) +
+      CacheAlign(sizeof(LayerState)) * _layer);
+}
+
+void CharacterPipeline::Sample(int _layer) {
+  LayerState& state = *layer_state(_layer);
+  const Layer& layer = layers_[_layer];
+  if (!layer.animation) {
+    state.failed = false;
+    return;
+  }
+  animation::SamplingJob job;
+  job.animation = layer.animation;
+  job.context = &state.context;
+  job.ratio = layer.ratio;
+  job.output = span<math::SoaTransform>(
+      reinterpret_cast<math::SoaTransform*>(layers_locals_ +
+                                            layers_locals_stride_ * _layer),
+      num_soa_);
+  state.failed = !job.Run();
+}
+
+bool CharacterPipeline::Blend() {
+  // Sampling stage status is collected here, as it's the first single task
+  // stage following it.
+  bool success = true;
+  int num_layers = 0;
+  int num_additive = 0;
+  for (int i = 0; i < max_layers_; ++i) {
+    const Layer& layer = layers_[i];
+    if (!layer.animation) {
+      continue;
+    }
+    // Layers that failed sampling are excluded from blending.
+    if (layer_state(i)->failed) {
+      success = false;
+      continue;
+    }
+
+    // Normal layers are stored from the beginning, additive ones from the
+    // end.
+    animation::BlendingJob::Layer& blend_layer =
+        layer.additive ? blend_layers_[max_layers_ - ++num_additive]
+                       : blend_layers_[num_layers++];
+    blend_layer.weight = layer.weight;
+    blend_layer.transform = layer_locals(i);
+    blend_layer.joint_weights = layer.joint_weights;
+  }
+
+  animation::BlendingJob job;
+  job.layers = span<const animation::BlendingJob::Layer>(blend_layers_,
+                                                         num_layers);
+  job.additive_layers = span<const animation::BlendingJob::Layer>(
+      blend_layers_ + max_layers_ - num_additive, num_additive);
+  job.rest_pose = skeleton_->joint_rest_poses();
+  job.output = locals();
+  success &= job.Run();
+
+  succeeded_ = success;
+  return success;
+}
+
+bool CharacterPipeline::LocalToModel() {
+  // Stages following a failure are skipped, as their inputs aren't valid.
+  if (!succeeded_) {
+    return false;
+  }
+  animation::LocalToModelJob job;
+  job.skeleton = skeleton_;
+  job.input = span<const math::SoaTransform>(locals_, num_soa_);
+  job.output = span<math::Float4x4>(models_, num_joints_);
+  const bool success = job.Run();
+  succeeded_ &= success;
+  return success;
+}
+
+bool CharacterPipeline::IK() {
+  if (!succeeded_) {
+    return false;
+  }
+  bool success = true;
+  if (ik_callback_) {
+    int update_from = kNoUpdate;
+    success = ik_callback_(this, &update_from, ik_user_data_);
+    if (success && update_from != kNoUpdate) {
+      animation::LocalToModelJob job;
+      job.skeleton = skeleton_;
+      job.from = update_from;
+      job.input = span<const math::SoaTransform>(locals_, num_soa_);
+      job.output = span<math::Float4x4>(models_, num_joints_);
+      success = job.Run();
+    }
+  }
+
+  // Computes skinning matrices.
+  if (inverse_bind_poses_.empty()) {
+    for (int i = 0; i < num_joints_; ++i) {
+      skinning_matrices_[i] = models_[i];
+    }
+  } else if (inverse_bind_poses_.size() >= static_cast<size_t>(num_joints_)) {
+    for (int i = 0; i < num_joints_; ++i) {
+      skinning_matrices_[i] = models_[i] * inverse_bind_poses_[i];
+    }
+  } else {
+    success = false;
+  }
+
+  succeeded_ &= success;
+  return success;
+}
+
+void CharacterPipeline::Skin(int _job) {
+  if (!succeeded_) {
+    skinning_failed_[_job] = true;
+    return;
+  }
+  SkinningJob job = skinning_jobs_[_job];
+  if (job.joint_matrices.empty() && job.joint_affine_matrices.empty() &&
+      job.joint_dual_quaternions.empty()) {
+    job.joint_matrices = skinning_matrices();
+  }
+  skinning_failed_[_job] = !job.Run();
+}
+
+bool CharacterPipeline::Run() {
+  bool success = true;
+  for (int i = 0; success && i < kStageCount; ++i) {
+    success = RunStage(static_cast<Stage>(i));
+  }
+  return success;
+}
+
+bool CharacterPipeline::RunStage(Stage _stage) {
+  if (!buffer_) {
+    return false;
+  }
+  switch (_stage) {
+    case kSampleStage: {
+      bool success = true;
+      for (int i = 0; i < max_layers_; ++i) {
+        Sample(i);
+        success &= !layer_state(i)->failed;
+      }
+      return success;
+    }
+    case kBlendStage:
+      return Blend();
+    case kLocalToModelStage:
+      return LocalToModel();
+    case kIKStage:
+      return IK();
+    case kSkinStage: {
+      bool success = true;
+      for (size_t i = 0; i < skinning_jobs_.size(); ++i) {
+        Skin(static_cast<int>(i));
+        success &= !skinning_failed_[i];
+      }
+      return success;
+    }
+    default:
+      return false;
+  }
+}
+
+void CharacterPipeline::SampleTask(int _task, void* _data) {
+  static_cast<CharacterPipeline*>(_data)->Sample(_task);
+}
+
+void CharacterPipeline::BlendTask(int, void* _data) {
+  static_cast<CharacterPipeline*>(_data)->Blend();
+}
+
+void CharacterPipeline::LocalToModelTask(int, void* _data) {
+  static_cast<CharacterPipeline*>(_data)->LocalToModel();
+}
+
+void CharacterPipeline::IKTask(int, void* _data) {
+  static_cast<CharacterPipeline*>(_data)->IK();
+}
+
+void CharacterPipeline::SkinTask(int _task, void* _data) {
+  static_cast<CharacterPipeline*>(_data)->Skin(_task);
+}
+
+int CharacterPipeline::AddTasks(TaskGraph* _graph) {
+  if (!buffer_ || !_graph) {
+    return -1;
+  }
+  const int first = _graph->AddNode(max_layers_, &SampleTask, this);
+  _graph->AddNode(1, &BlendTask, this);
+  _graph->AddNode(1, &LocalToModelTask, this);
+  _graph->AddNode(1, &IKTask, this);
+  _graph->AddNode(static_cast<int>(skinning_jobs_.size()), &SkinTask, this);
+  for (int i = 1; i < kStageCount; ++i) {
+    _graph->AddDependency(first + i - 1, first + i);
+  }
+  return first;
+}
+
+bool CharacterPipeline::succeeded() const {
+  if (!succeeded_) {
+    return false;
+  }
+  for (size_t i = 0; i < skinning_failed_.size(); ++i) {
+    if (skinning_failed_[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace geometry
+}  // namespace ozz
@@ -0,0 +1,101 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/inverse_transpose_job.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace geometry {
+
+InverseTransposeJob::InverseTransposeJob() : cofactor(false) {}
+
+bool InverseTransposeJob::Validate() const {
+  return output.size() >= input.size();
+}
+
+bool InverseTransposeJob::Run() const {
+  OZZ_PROFILE_ZONE("InverseTransposeJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const math::Float4x4 identity = math::Float4x4::identity();
+  const math::SimdFloat4 zero = math::simd_float4::zero();
+  const math::SimdFloat4 one = math::simd_float4::one();
+  const math::SimdFloat4 w_axis = math::simd_float4::w_axis();
+
+  const size_t count = input.size();
+  for (size_t i = 0; i < count; i += 4) {
+    const size_t batch = math::Min(count - i, size_t(4));
+
+    // Converts 3x3 part of 4 matrices to SoA, padding with identity.
+    math::SoaFloat3 cols[3];
+    for (int c = 0; c < 3; ++c) {
+      math::SimdFloat4 aos[4];
+      for (size_t j = 0; j < 4; ++j) {
+        aos[j] = j < batch ? input[i + j].cols[c] : identity.cols[c];
+      }
+      math::SimdFloat4 soa[4];
+      math::Transpose4x4(aos, soa);
+      cols[c] = {soa[0], soa[1], soa[2]};
+    }
+
+    // Cofactor matrix columns are the cross products of the other axes.
+    math::SoaFloat3 cofactors[3] = {math::Cross(cols[1], cols[2]),
+                                    math::Cross(cols[2], cols[0]),
+                                    math::Cross(cols[0], cols[1])};
+    if (!cofactor) {
+      const math::SimdFloat4 rcp_det = one / math::Dot(cols[0], cofactors[0]);
+      for (int c = 0; c < 3; ++c) {
+        cofactors[c] = cofactors[c] * rcp_det;
+      }
+    }
+
+    // Converts back to AoS. Input isn't read anymore, so output can alias it.
+    for (int c = 0; c < 3; ++c) {
+      const math::SimdFloat4 soa[4] = {cofactors[c].x, cofactors[c].y,
+                                       cofactors[c].z, zero};
+      math::SimdFloat4 aos[4];
+      math::Transpose4x4(soa, aos);
+      for (size_t j = 0; j < batch; ++j) {
+        output[i + j].cols[c] = aos[j];
+      }
+    }
+    for (size_t j = 0; j < batch; ++j) {
+      output[i + j].cols[3] = w_axis;
+    }
+  }
+
+  return true;
+}
+}  // namespace geometry
+}  // namespace ozz
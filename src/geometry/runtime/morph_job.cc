@@ -0,0 +1,170 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/morph_job.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace geometry {
+
+MorphJob::MorphJob()
+    : vertex_count(0),
+      first_vertex(0),
+      in_positions_stride(0),
+      in_normals_stride(0),
+      out_positions_stride(0),
+      out_normals_stride(0) {}
+
+namespace {
+// Computes the minimum size (in bytes) of a range of _count float3 separated
+// by _stride bytes.
+size_t Float3RangeSize(int _count, size_t _stride) {
+  return _count > 0 ? _stride * (_count - 1) + sizeof(float) * 3 : 0;
+}
+
+// Gets vertex _i of a strided buffer.
+const float* Stride(const float* _begin, size_t _stride, size_t _i) {
+  return reinterpret_cast<const float*>(
+      reinterpret_cast<const char*>(_begin) + _stride * _i);
+}
+float* Stride(float* _begin, size_t _stride, size_t _i) {
+  return reinterpret_cast<float*>(reinterpret_cast<char*>(_begin) +
+                                  _stride * _i);
+}
+
+// Copies _count float3 from _in to _out, unless they're the same buffer.
+void CopyFloat3(const float* _in, size_t _in_stride, float* _out,
+                size_t _out_stride, int _count) {
+  if (_in == _out && _in_stride == _out_stride) {
+    return;
+  }
+  for (int i = 0; i < _count; ++i) {
+    std::memcpy(Stride(_out, _out_stride, i), Stride(_in, _in_stride, i),
+                sizeof(float) * 3);
+  }
+}
+
+// Adds _weight * _deltas to _out float3, for target vertices in range
+// [_first, _first + _count[. Indices are sorted, so the first one in range is
+// found with a binary search. Each delta is weighted and accumulated as a
+// single SIMD vector.
+void AddDeltas(const span<const uint32_t>& _indices, const float* _deltas,
+               float _weight, int _first, int _count, float* _out,
+               size_t _stride) {
+  const uint32_t first = static_cast<uint32_t>(_first);
+  const uint32_t last = first + static_cast<uint32_t>(_count);
+  const uint32_t* begin =
+      std::lower_bound(_indices.begin(), _indices.end(), first);
+  const math::SimdFloat4 weight = math::simd_float4::Load1(_weight);
+  for (const uint32_t* it = begin; it < _indices.end() && *it < last; ++it) {
+    const float* delta = _deltas + (it - _indices.begin()) * 3;
+    float* out = Stride(_out, _stride, *it - first);
+    math::Store3PtrU(math::MAdd(math::simd_float4::Load3PtrU(delta), weight,
+                                math::simd_float4::Load3PtrU(out)),
+                     out);
+  }
+}
+}  // namespace
+
+bool MorphJob::Validate() const {
+  bool valid = true;
+
+  valid &= vertex_count >= 0;
+  valid &= first_vertex >= 0;
+
+  // Checks targets.
+  valid &= weights.size() >= targets.size();
+  for (const MorphTarget& target : targets) {
+    valid &= target.position_deltas.size() >= target.indices.size() * 3;
+    valid &= target.normal_deltas.empty() ||
+             target.normal_deltas.size() >= target.indices.size() * 3;
+  }
+
+  // Checks positions, mandatory.
+  valid &= in_positions.size_bytes() >=
+           Float3RangeSize(vertex_count, in_positions_stride);
+  valid &= out_positions.size_bytes() >=
+           Float3RangeSize(vertex_count, out_positions_stride);
+
+  // Checks normals, optional.
+  valid &= in_normals.empty() == out_normals.empty();
+  valid &= in_normals.size_bytes() >=
+           Float3RangeSize(in_normals.empty() ? 0 : vertex_count,
+                           in_normals_stride);
+  valid &= out_normals.size_bytes() >=
+           Float3RangeSize(out_normals.empty() ? 0 : vertex_count,
+                           out_normals_stride);
+
+  return valid;
+}
+
+bool MorphJob::Run() const {
+  OZZ_PROFILE_ZONE("MorphJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  // Early out if no vertex. This isn't an error.
+  if (vertex_count == 0) {
+    return true;
+  }
+
+  // Initializes output with input vertices, then accumulates weighted deltas.
+  CopyFloat3(in_positions.begin(), in_positions_stride, out_positions.begin(),
+             out_positions_stride, vertex_count);
+  const bool normals = !in_normals.empty();
+  if (normals) {
+    CopyFloat3(in_normals.begin(), in_normals_stride, out_normals.begin(),
+               out_normals_stride, vertex_count);
+  }
+
+  for (size_t t = 0; t < targets.size(); ++t) {
+    const float weight = weights[t];
+    if (weight == 0.f) {
+      continue;
+    }
+    const MorphTarget& target = targets[t];
+    AddDeltas(target.indices, target.position_deltas.begin(), weight,
+              first_vertex, vertex_count, out_positions.begin(),
+              out_positions_stride);
+    if (normals && !target.normal_deltas.empty()) {
+      AddDeltas(target.indices, target.normal_deltas.begin(), weight,
+                first_vertex, vertex_count, out_normals.begin(),
+                out_normals_stride);
+    }
+  }
+
+  return true;
+}
+}  // namespace geometry
+}  // namespace ozz
@@ -0,0 +1,178 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/skinned_bounds_job.h"
+
+#include <limits>
+
+#include "ozz/base/maths/box.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/profile.h"
+
+namespace ozz {
+namespace geometry {
+
+SkinnedBoundsJob::SkinnedBoundsJob() : bound(nullptr) {}
+
+bool SkinnedBoundsJob::Validate() const {
+  bool valid = true;
+
+  valid &= bound != nullptr;
+  valid &= joint_remaps.empty() || joint_remaps.size() >= joint_boxes.size();
+  valid &=
+      !joint_remaps.empty() || joint_matrices.size() >= joint_boxes.size();
+  valid &= joint_bounds.empty() || joint_bounds.size() >= joint_boxes.size();
+
+  return valid;
+}
+
+bool SkinnedBoundsJob::Run() const {
+  OZZ_PROFILE_ZONE("SkinnedBoundsJob::Run");
+
+  if (!Validate()) {
+    return false;
+  }
+
+  const math::SimdFloat4 half = math::simd_float4::Load1(.5f);
+  math::SimdFloat4 bound_min =
+      math::simd_float4::Load1(std::numeric_limits<float>::max());
+  math::SimdFloat4 bound_max =
+      math::simd_float4::Load1(-std::numeric_limits<float>::max());
+
+  const math::Box invalid;
+  for (size_t i = 0; i < joint_boxes.size(); ++i) {
+    const math::Box& box = joint_boxes[i];
+    if (!box.is_valid()) {
+      if (!joint_bounds.empty()) {
+        joint_bounds[i] = invalid;
+      }
+      continue;
+    }
+    const math::Float4x4& matrix =
+        joint_matrices[joint_remaps.empty() ? i : joint_remaps[i]];
+
+    // Transforms box center, and accumulates extents along each axis of the
+    // joint matrix, which gives the tight axis aligned box of the
+    // transformed box.
+    const math::SimdFloat4 min = math::simd_float4::Load3PtrU(&box.min.x);
+    const math::SimdFloat4 max = math::simd_float4::Load3PtrU(&box.max.x);
+    const math::SimdFloat4 center =
+        math::TransformPoint(matrix, (min + max) * half);
+    const math::SimdFloat4 extent = (max - min) * half;
+    const math::SimdFloat4 radius =
+        math::Abs(matrix.cols[0]) * math::SplatX(extent) +
+        math::Abs(matrix.cols[1]) * math::SplatY(extent) +
+        math::Abs(matrix.cols[2]) * math::SplatZ(extent);
+    const math::SimdFloat4 joint_min = center - radius;
+    const math::SimdFloat4 joint_max = center + radius;
+
+    if (!joint_bounds.empty()) {
+      math::Store3PtrU(joint_min, &joint_bounds[i].min.x);
+      math::Store3PtrU(joint_max, &joint_bounds[i].max.x);
+    }
+    bound_min = math::Min(bound_min, joint_min);
+    bound_max = math::Max(bound_max, joint_max);
+  }
+
+  math::Store3PtrU(bound_min, &bound->min.x);
+  math::Store3PtrU(bound_max, &bound->max.x);
+
+  return true;
+}
+
+bool ComputeJointBoxes(int _vertex_count, int _influences_count,
+                       span<const float> _positions, size_t _positions_stride,
+                       span<const uint16_t> _joint_indices,
+                       size_t _joint_indices_stride,
+                       span<const float> _joint_weights,
+                       size_t _joint_weights_stride,
+                       span<const math::Float4x4> _inverse_bind_poses,
+                       span<math::Box> _boxes) {
+  // Validates buffer sizes.
+  if (_vertex_count < 0 || _influences_count <= 0 ||
+      _boxes.size() != _inverse_bind_poses.size()) {
+    return false;
+  }
+  const size_t last = _vertex_count > 0 ? _vertex_count - 1 : 0;
+  if (_vertex_count > 0 &&
+      (_positions.size_bytes() <
+           _positions_stride * last + sizeof(float) * 3 ||
+       _joint_indices.size_bytes() < _joint_indices_stride * last +
+                                         sizeof(uint16_t) * _influences_count ||
+       (!_joint_weights.empty() && _influences_count > 1 &&
+        _joint_weights.size_bytes() <
+            _joint_weights_stride * last +
+                sizeof(float) * (_influences_count - 1)))) {
+    return false;
+  }
+
+  for (math::Box& box : _boxes) {
+    box = math::Box();
+  }
+
+  const char* positions = reinterpret_cast<const char*>(_positions.data());
+  const char* indices = reinterpret_cast<const char*>(_joint_indices.data());
+  const char* weights = reinterpret_cast<const char*>(_joint_weights.data());
+  for (int v = 0; v < _vertex_count; ++v) {
+    const math::SimdFloat4 position = math::simd_float4::Load3PtrU(
+        reinterpret_cast<const float*>(positions + _positions_stride * v));
+    const uint16_t* vertex_indices = reinterpret_cast<const uint16_t*>(
+        indices + _joint_indices_stride * v);
+    const float* vertex_weights =
+        _joint_weights.empty()
+            ? nullptr
+            : reinterpret_cast<const float*>(weights +
+                                             _joint_weights_stride * v);
+    float weight_sum = 0.f;
+    for (int i = 0; i < _influences_count; ++i) {
+      // Last weight is restored from the others, as their sum is 1.
+      if (vertex_weights && _influences_count > 1) {
+        const float weight = i == _influences_count - 1
+                                 ? 1.f - weight_sum
+                                 : vertex_weights[i];
+        weight_sum += weight;
+        if (weight == 0.f) {
+          continue;
+        }
+      }
+      const uint16_t joint = vertex_indices[i];
+      if (joint >= _boxes.size()) {
+        return false;
+      }
+      math::Float3 local;
+      math::Store3PtrU(
+          math::TransformPoint(_inverse_bind_poses[joint], position),
+          &local.x);
+      math::Box& box = _boxes[joint];
+      box.min = Min(box.min, local);
+      box.max = Max(box.max, local);
+    }
+  }
+  return true;
+}
+}  // namespace geometry
+}  // namespace ozz
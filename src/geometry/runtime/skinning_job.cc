@@ -28,8 +28,30 @@
 #include "ozz/geometry/runtime/skinning_job.h"
 
 #include <cassert>
+#include <cmath>
 
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_dual_quaternion.h"
+#include "ozz/base/maths/simd_float3x4.h"
 #include "ozz/base/maths/simd_math.h"
+#include "ozz/base/profile.h"
+#include "ozz/geometry/runtime/morph_job.h"
+
+// Selects AVX skinning path, which processes 2 vertices at once, one per 128
+// bits lane. It's always used if AVX is enabled for the whole build.
+// Otherwise, for x86 SSE builds, it's compiled with a function target
+// attribute (GCC and Clang) and selected at runtime according to host
+// capabilities.
+#if defined(OZZ_SIMD_AVX)
+#define OZZ_SKINNING_AVX
+#define OZZ_SKINNING_AVX_TARGET
+#elif defined(OZZ_SIMD_SSEx) && (defined(__GNUC__) || defined(__clang__)) && \
+    (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define OZZ_SKINNING_AVX
+#define OZZ_SKINNING_AVX_DISPATCH
+#define OZZ_SKINNING_AVX_TARGET __attribute__((target("avx")))
+#endif
 
 namespace ozz {
 namespace geometry {
@@ -44,7 +66,18 @@ SkinningJob::SkinningJob()
       in_tangents_stride(0),
       out_positions_stride(0),
       out_normals_stride(0),
-      out_tangents_stride(0) {}
+      out_tangents_stride(0),
+      streaming_output(false),
+      morph_first_vertex(0),
+      parallel_for(nullptr),
+      parallel_for_user_data(nullptr),
+      parallel_grain(4096) {}
+
+// Computes the minimum size (in bytes) of a range of _count elements of _size
+// bytes, separated by _stride bytes.
+size_t RangeSize(int _count, size_t _stride, size_t _size) {
+  return _count > 0 ? _stride * (_count - 1) + _size : 0;
+}
 
 bool SkinningJob::Validate() const {
   // Start validation of all parameters.
@@ -53,60 +86,100 @@ bool SkinningJob::Validate() const {
   // Checks influences bounds.
   valid &= influences_count > 0;
 
-  // Checks joints matrices, required.
-  valid &= !joint_matrices.empty();
-
-  // Prepares local variables used to compute buffer size.
-  const int vertex_count_minus_1 = vertex_count > 0 ? vertex_count - 1 : 0;
-  const int vertex_count_at_least_1 = vertex_count > 0;
-
-  // Checks indices, required.
-  valid &= joint_indices.size_bytes() >=
-           joint_indices_stride * vertex_count_minus_1 +
-               sizeof(uint16_t) * influences_count * vertex_count_at_least_1;
+  // Checks joints matrices, required. Only one matrix type can be used, and
+  // inverse transpose matrices must be of the same type.
+  valid &= (!joint_matrices.empty() + !joint_affine_matrices.empty() +
+            !joint_dual_quaternions.empty()) == 1;
+  valid &= joint_matrices.empty() ||
+           joint_affine_inverse_transpose_matrices.empty();
+  valid &= joint_affine_matrices.empty() ||
+           joint_inverse_transpose_matrices.empty();
+  valid &= joint_dual_quaternions.empty() ||
+           (joint_inverse_transpose_matrices.empty() &&
+            joint_affine_inverse_transpose_matrices.empty());
+
+  // Checks indices, required. Only one format can be used.
+  const size_t indices_size = joint_indices8.empty() ? sizeof(uint16_t) : 1;
+  valid &= joint_indices.empty() || joint_indices8.empty();
+  valid &= (joint_indices8.empty() ? joint_indices.size_bytes()
+                                   : joint_indices8.size_bytes()) >=
+           RangeSize(vertex_count, joint_indices_stride,
+                     indices_size * influences_count);
 
   // Checks weights, required if influences_count > 1.
+  const size_t weights_size = joint_weights8.empty() ? sizeof(float) : 1;
+  valid &= joint_weights.empty() || joint_weights8.empty();
   if (influences_count != 1) {
-    valid &=
-        joint_weights.size_bytes() >=
-        joint_weights_stride * vertex_count_minus_1 +
-            sizeof(float) * (influences_count - 1) * vertex_count_at_least_1;
+    valid &= (joint_weights8.empty() ? joint_weights.size_bytes()
+                                     : joint_weights8.size_bytes()) >=
+             RangeSize(vertex_count, joint_weights_stride,
+                       weights_size * (influences_count - 1));
   }
 
+  // Compressed and remapped indices, and compressed weights are decoded to
+  // fixed size buffers.
+  valid &= (joint_indices8.empty() && joint_weights8.empty() &&
+            joint_remaps.empty()) ||
+           influences_count <= kMaxCompressedInfluences;
+
   // Checks positions, mandatory.
-  valid &= in_positions.size_bytes() >=
-           in_positions_stride * vertex_count_minus_1 +
-               sizeof(float) * 3 * vertex_count_at_least_1;
+  valid &= in_positions.empty() || in_half_positions.empty();
+  valid &= in_half_positions.empty()
+               ? in_positions.size_bytes() >=
+                     RangeSize(vertex_count, in_positions_stride,
+                               sizeof(float) * 3)
+               : in_half_positions.size_bytes() >=
+                     RangeSize(vertex_count, in_positions_stride,
+                               sizeof(uint16_t) * 3);
   valid &= !out_positions.empty();
   valid &= out_positions.size_bytes() >=
-           out_positions_stride * vertex_count_minus_1 +
-               sizeof(float) * 3 * vertex_count_at_least_1;
+           RangeSize(vertex_count, out_positions_stride, sizeof(float) * 3);
 
   // Checks normals, optional.
-  if (!in_normals.empty()) {
-    valid &= in_normals.size_bytes() >=
-             in_normals_stride * vertex_count_minus_1 +
-                 sizeof(float) * 3 * vertex_count_at_least_1;
+  valid &= in_normals.empty() || in_oct_normals.empty();
+  valid &= in_tangents.empty() || in_oct_tangents.empty();
+  if (!in_normals.empty() || !in_oct_normals.empty()) {
+    valid &= in_oct_normals.empty()
+                 ? in_normals.size_bytes() >=
+                       RangeSize(vertex_count, in_normals_stride,
+                                 sizeof(float) * 3)
+                 : in_oct_normals.size_bytes() >=
+                       RangeSize(vertex_count, in_normals_stride,
+                                 sizeof(int16_t) * 2);
     valid &= !out_normals.empty();
     valid &= out_normals.size_bytes() >=
-             out_normals_stride * vertex_count_minus_1 +
-                 sizeof(float) * 3 * vertex_count_at_least_1;
+             RangeSize(vertex_count, out_normals_stride, sizeof(float) * 3);
 
     // Checks tangents, optional but requires normals.
-    if (!in_tangents.empty()) {
-      valid &= in_tangents.size_bytes() >=
-               in_tangents_stride * vertex_count_minus_1 +
-                   sizeof(float) * 3 * vertex_count_at_least_1;
+    if (!in_tangents.empty() || !in_oct_tangents.empty()) {
+      valid &= in_oct_tangents.empty()
+                   ? in_tangents.size_bytes() >=
+                         RangeSize(vertex_count, in_tangents_stride,
+                                   sizeof(float) * 3)
+                   : in_oct_tangents.size_bytes() >=
+                         RangeSize(vertex_count, in_tangents_stride,
+                                   sizeof(int16_t) * 2);
       valid &= !out_tangents.empty();
       valid &= out_tangents.size_bytes() >=
-               out_tangents_stride * vertex_count_minus_1 +
-                   sizeof(float) * 3 * vertex_count_at_least_1;
+               RangeSize(vertex_count, out_tangents_stride, sizeof(float) * 3);
     }
   } else {
     // Tangents are not supported if normals are not there.
-    valid &= in_tangents.empty();
+    valid &= in_tangents.empty() && in_oct_tangents.empty();
   }
 
+  // Checks morph targets, optional.
+  valid &= morph_weights.size() >= morph_targets.size();
+  valid &= morph_first_vertex >= 0;
+  for (const MorphTarget& target : morph_targets) {
+    valid &= target.position_deltas.size() >= target.indices.size() * 3;
+    valid &= target.normal_deltas.empty() ||
+             target.normal_deltas.size() >= target.indices.size() * 3;
+  }
+
+  // Checks parallel_for chunks.
+  valid &= parallel_for == nullptr || parallel_grain > 0;
+
   return valid;
 }
 
@@ -118,15 +191,18 @@ bool SkinningJob::Validate() const {
 // calls MACRO that are shared or specialized according to skinning variants.
 
 // Defines the skeleton code for the per vertex skinning loop.
-#define SKINNING_FN(_type, _it, _inf)                                        \
-  void SKINNING_FN_NAME(_type, _it, _inf)(const SkinningJob& _job) {         \
-    ASSERT_##_type() ASSERT_##_it() INIT_##_type() INIT_W##_inf()            \
-        const int loops = _job.vertex_count - 1;                             \
-    for (int i = 0; i < loops; ++i) {                                        \
-      PREPARE_##_inf##_INNER(_it) TRANSFORM_##_type##_INNER() NEXT_##_type() \
-          NEXT_W##_inf()                                                     \
-    }                                                                        \
-    PREPARE_##_inf##_OUTER(_it) TRANSFORM_##_type##_OUTER()                  \
+#define SKINNING_FN(_type, _it, _inf)                                         \
+  template <typename _Matrix, bool _Stream>                                   \
+  void SKINNING_FN_NAME(_type, _it, _inf)(                                    \
+      const SkinningJob& _job, const span<const _Matrix>& _matrices,          \
+      const span<const _Matrix>& _it_matrices) {                              \
+    ASSERT_##_type() ASSERT_##_it() INIT_##_type() INIT_W##_inf()             \
+        const int loops = _job.vertex_count - 1;                              \
+    for (int i = 0; i < loops; ++i) {                                         \
+      PREPARE_##_inf##_INNER(_it) RESOLVE_##_it() TRANSFORM_##_type##_INNER() \
+          NEXT_##_type() NEXT_W##_inf()                                       \
+    }                                                                         \
+    PREPARE_##_inf##_OUTER(_it) RESOLVE_##_it() TRANSFORM_##_type##_OUTER()   \
   }
 
 // Defines skinning function name.
@@ -147,7 +223,7 @@ bool SkinningJob::Validate() const {
 
 #define ASSERT_NOIT()
 
-#define ASSERT_IT() assert(!_job.joint_inverse_transpose_matrices.empty());
+#define ASSERT_IT() assert(!_it_matrices.empty());
 
 // Implements loop initializations for positions, ...
 #define INIT_P()                                              \
@@ -211,72 +287,116 @@ bool SkinningJob::Validate() const {
   in_tangents = NEXT(const float*, in_tangents, _job.in_tangents_stride); \
   out_tangents = NEXT(float*, out_tangents, _job.out_tangents_stride);
 
+// Weights joint matrix _m with splatted weight _w.
+OZZ_INLINE math::Float4x4 Weight(const math::Float4x4& _m,
+                                 math::_SimdFloat4 _w) {
+  return math::ColumnMultiply(_m, _w);
+}
+
+OZZ_INLINE math::Float3x4 Weight(const math::Float3x4& _m,
+                                 math::_SimdFloat4 _w) {
+  return math::RowMultiply(_m, _w);
+}
+
+OZZ_INLINE math::DualQuaternion Weight(const math::DualQuaternion& _dq,
+                                       math::_SimdFloat4 _w) {
+  return _dq * _w;
+}
+
+// Weights joint matrix _m with splatted weight _w, _pivot being the first
+// influence of the vertex. Matrices ignore it, while dual quaternions are
+// negated if they aren't in the same hemisphere as _pivot, so that blending
+// takes the shortest path.
+template <typename _Matrix>
+OZZ_INLINE _Matrix Weight(const _Matrix& _m, math::_SimdFloat4 _w,
+                          const _Matrix& _pivot) {
+  (void)_pivot;
+  return Weight(_m, _w);
+}
+
+OZZ_INLINE math::DualQuaternion Weight(const math::DualQuaternion& _dq,
+                                       math::_SimdFloat4 _w,
+                                       const math::DualQuaternion& _pivot) {
+  const math::SimdFloat4 sign =
+      math::And(math::SplatX(math::Dot4(_dq.real.xyzw, _pivot.real.xyzw)),
+                math::simd_int4::mask_sign());
+  return _dq * math::Xor(_w, sign);
+}
+
+// Resolves blended joint transform to the type used to transform vertices.
+// Matrices are used as is, dual quaternions need to be normalized.
+OZZ_INLINE const math::Float4x4& Resolve(const math::Float4x4& _m) {
+  return _m;
+}
+
+OZZ_INLINE const math::Float3x4& Resolve(const math::Float3x4& _m) {
+  return _m;
+}
+
+OZZ_INLINE math::DualQuaternion Resolve(const math::DualQuaternion& _dq) {
+  return Normalize(_dq);
+}
+
 // Implements weighted matrix preparation.
 // _INNER functions are intended to be used inside the vertex loop. They take
 // advantage of the fact that the buffers they are reading from contain enough
 // remaining data to use more optimized SIMD load functions. At the opposite,
 // _OUTER functions restrict access to data that are sure to be readable from
 // the buffer.
-#define PREPARE_1_INNER(_it)                                 \
-  const uint16_t i0 = joint_indices[0];                      \
-  const math::Float4x4& transform = _job.joint_matrices[i0]; \
+#define PREPARE_1_INNER(_it)                \
+  const uint16_t i0 = joint_indices[0];     \
+  const _Matrix& transform = _matrices[i0]; \
   PREPARE_##_it##_1()
 
 #define PREPARE_1_OUTER(_it) PREPARE_1_INNER(_it)
 
-#define PREPARE_NOIT()                            \
-  const math::Float4x4& it_transform = transform; \
-  (void)it_transform;
+// Without inverse transpose matrices, transform is also used for vectors. See
+// RESOLVE_NOIT.
+#define PREPARE_NOIT()
 
 #define PREPARE_NOIT_1() PREPARE_NOIT()
 
-#define PREPARE_IT_1()                 \
-  const math::Float4x4& it_transform = \
-      _job.joint_inverse_transpose_matrices[i0];
+#define PREPARE_IT_1() const _Matrix& it_transform = _it_matrices[i0];
 
 #define PREPARE_2_INNER(_it)                                                   \
   const math::SimdFloat4 w0 = math::simd_float4::Load1PtrU(joint_weights + 0); \
   const uint16_t i0 = joint_indices[0];                                        \
   const uint16_t i1 = joint_indices[1];                                        \
-  const math::Float4x4& m0 = _job.joint_matrices[i0];                          \
-  const math::Float4x4& m1 = _job.joint_matrices[i1];                          \
+  const _Matrix& m0 = _matrices[i0];                                           \
+  const _Matrix& m1 = _matrices[i1];                                           \
   const math::SimdFloat4 w1 = one - w0;                                        \
-  const math::Float4x4 transform =                                             \
-      math::ColumnMultiply(m0, w0) + math::ColumnMultiply(m1, w1);             \
+  const _Matrix transform = Weight(m0, w0) + Weight(m1, w1, m0);               \
   PREPARE_##_it##_2()
 
 #define PREPARE_NOIT_2() PREPARE_NOIT()
 
 #define PREPARE_IT_2()                                                    \
-  const math::Float4x4& mit0 = _job.joint_inverse_transpose_matrices[i0]; \
-  const math::Float4x4& mit1 = _job.joint_inverse_transpose_matrices[i1]; \
-  const math::Float4x4 it_transform =                                     \
-      math::ColumnMultiply(mit0, w0) + math::ColumnMultiply(mit1, w1);
+  const _Matrix& mit0 = _it_matrices[i0];                                 \
+  const _Matrix& mit1 = _it_matrices[i1];                                 \
+  const _Matrix it_transform = Weight(mit0, w0) + Weight(mit1, w1, mit0);
 
 #define PREPARE_2_OUTER(_it) PREPARE_2_INNER(_it)
 
-#define PREPARE_3_CONCAT(_it)                                     \
-  const uint16_t i0 = joint_indices[0];                           \
-  const uint16_t i1 = joint_indices[1];                           \
-  const uint16_t i2 = joint_indices[2];                           \
-  const math::Float4x4& m0 = _job.joint_matrices[i0];             \
-  const math::Float4x4& m1 = _job.joint_matrices[i1];             \
-  const math::Float4x4& m2 = _job.joint_matrices[i2];             \
-  const math::SimdFloat4 w2 = one - (w0 + w1);                    \
-  const math::Float4x4 transform = math::ColumnMultiply(m0, w0) + \
-                                   math::ColumnMultiply(m1, w1) + \
-                                   math::ColumnMultiply(m2, w2);  \
+#define PREPARE_3_CONCAT(_it)                                   \
+  const uint16_t i0 = joint_indices[0];                         \
+  const uint16_t i1 = joint_indices[1];                         \
+  const uint16_t i2 = joint_indices[2];                         \
+  const _Matrix& m0 = _matrices[i0];                            \
+  const _Matrix& m1 = _matrices[i1];                            \
+  const _Matrix& m2 = _matrices[i2];                            \
+  const math::SimdFloat4 w2 = one - (w0 + w1);                  \
+  const _Matrix transform =                                     \
+      Weight(m0, w0) + Weight(m1, w1, m0) + Weight(m2, w2, m0); \
   PREPARE_##_it##_3()
 
 #define PREPARE_NOIT_3() PREPARE_NOIT()
 
 #define PREPARE_IT_3()                                                    \
-  const math::Float4x4& mit0 = _job.joint_inverse_transpose_matrices[i0]; \
-  const math::Float4x4& mit1 = _job.joint_inverse_transpose_matrices[i1]; \
-  const math::Float4x4& mit2 = _job.joint_inverse_transpose_matrices[i2]; \
-  const math::Float4x4 it_transform = math::ColumnMultiply(mit0, w0) +    \
-                                      math::ColumnMultiply(mit1, w1) +    \
-                                      math::ColumnMultiply(mit2, w2);
+  const _Matrix& mit0 = _it_matrices[i0];                                 \
+  const _Matrix& mit1 = _it_matrices[i1];                                 \
+  const _Matrix& mit2 = _it_matrices[i2];                                 \
+  const _Matrix it_transform =                                            \
+      Weight(mit0, w0) + Weight(mit1, w1, mit0) + Weight(mit2, w2, mit0);
 
 #define PREPARE_3_INNER(_it)                                             \
   const math::SimdFloat4 w = math::simd_float4::LoadPtrU(joint_weights); \
@@ -289,31 +409,30 @@ bool SkinningJob::Validate() const {
   const math::SimdFloat4 w1 = math::simd_float4::Load1PtrU(joint_weights + 1); \
   PREPARE_3_CONCAT(_it)
 
-#define PREPARE_4_CONCAT(_it)                                       \
-  const uint16_t i0 = joint_indices[0];                             \
-  const uint16_t i1 = joint_indices[1];                             \
-  const uint16_t i2 = joint_indices[2];                             \
-  const uint16_t i3 = joint_indices[3];                             \
-  const math::Float4x4& m0 = _job.joint_matrices[i0];               \
-  const math::Float4x4& m1 = _job.joint_matrices[i1];               \
-  const math::Float4x4& m2 = _job.joint_matrices[i2];               \
-  const math::Float4x4& m3 = _job.joint_matrices[i3];               \
-  const math::SimdFloat4 w3 = one - (w0 + w1 + w2);                 \
-  const math::Float4x4 transform =                                  \
-      math::ColumnMultiply(m0, w0) + math::ColumnMultiply(m1, w1) + \
-      math::ColumnMultiply(m2, w2) + math::ColumnMultiply(m3, w3);  \
+#define PREPARE_4_CONCAT(_it)                                        \
+  const uint16_t i0 = joint_indices[0];                              \
+  const uint16_t i1 = joint_indices[1];                              \
+  const uint16_t i2 = joint_indices[2];                              \
+  const uint16_t i3 = joint_indices[3];                              \
+  const _Matrix& m0 = _matrices[i0];                                 \
+  const _Matrix& m1 = _matrices[i1];                                 \
+  const _Matrix& m2 = _matrices[i2];                                 \
+  const _Matrix& m3 = _matrices[i3];                                 \
+  const math::SimdFloat4 w3 = one - (w0 + w1 + w2);                  \
+  const _Matrix transform = Weight(m0, w0) + Weight(m1, w1, m0) +    \
+                            Weight(m2, w2, m0) + Weight(m3, w3, m0); \
   PREPARE_##_it##_4()
 
 #define PREPARE_NOIT_4() PREPARE_NOIT()
 
-#define PREPARE_IT_4()                                                    \
-  const math::Float4x4& mit0 = _job.joint_inverse_transpose_matrices[i0]; \
-  const math::Float4x4& mit1 = _job.joint_inverse_transpose_matrices[i1]; \
-  const math::Float4x4& mit2 = _job.joint_inverse_transpose_matrices[i2]; \
-  const math::Float4x4& mit3 = _job.joint_inverse_transpose_matrices[i3]; \
-  const math::Float4x4 it_transform =                                     \
-      math::ColumnMultiply(mit0, w0) + math::ColumnMultiply(mit1, w1) +   \
-      math::ColumnMultiply(mit2, w2) + math::ColumnMultiply(mit3, w3);
+#define PREPARE_IT_4()                                             \
+  const _Matrix& mit0 = _it_matrices[i0];                          \
+  const _Matrix& mit1 = _it_matrices[i1];                          \
+  const _Matrix& mit2 = _it_matrices[i2];                          \
+  const _Matrix& mit3 = _it_matrices[i3];                          \
+  const _Matrix it_transform =                                     \
+      Weight(mit0, w0) + Weight(mit1, w1, mit0) +                  \
+      Weight(mit2, w2, mit0) + Weight(mit3, w3, mit0);
 
 #define PREPARE_4_INNER(_it)                                             \
   const math::SimdFloat4 w = math::simd_float4::LoadPtrU(joint_weights); \
@@ -328,88 +447,103 @@ bool SkinningJob::Validate() const {
   const math::SimdFloat4 w2 = math::simd_float4::Load1PtrU(joint_weights + 2); \
   PREPARE_4_CONCAT(_it)
 
-#define PREPARE_NOIT_N()                                                     \
-  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0);   \
-  math::Float4x4 transform =                                                 \
-      math::ColumnMultiply(_job.joint_matrices[joint_indices[0]], wsum);     \
-  const int last = _job.influences_count - 1;                                \
-  for (int j = 1; j < last; ++j) {                                           \
-    const math::SimdFloat4 w =                                               \
-        math::simd_float4::Load1PtrU(joint_weights + j);                     \
-    wsum = wsum + w;                                                         \
-    transform = transform + math::ColumnMultiply(                            \
-                                _job.joint_matrices[joint_indices[j]], w);   \
-  }                                                                          \
-  transform =                                                                \
-      transform + math::ColumnMultiply(                                      \
-                      _job.joint_matrices[joint_indices[last]], one - wsum); \
+#define PREPARE_NOIT_N()                                                   \
+  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0); \
+  const _Matrix& m0 = _matrices[joint_indices[0]];                         \
+  _Matrix transform = Weight(m0, wsum);                                    \
+  const int last = _job.influences_count - 1;                              \
+  for (int j = 1; j < last; ++j) {                                         \
+    const math::SimdFloat4 w =                                             \
+        math::simd_float4::Load1PtrU(joint_weights + j);                   \
+    wsum = wsum + w;                                                       \
+    transform = transform + Weight(_matrices[joint_indices[j]], w, m0);    \
+  }                                                                        \
+  transform =                                                              \
+      transform + Weight(_matrices[joint_indices[last]], one - wsum, m0);  \
   PREPARE_NOIT()
 
-#define PREPARE_IT_N()                                                        \
-  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0);    \
-  const uint16_t i0 = joint_indices[0];                                       \
-  math::Float4x4 transform =                                                  \
-      math::ColumnMultiply(_job.joint_matrices[i0], wsum);                    \
-  math::Float4x4 it_transform =                                               \
-      math::ColumnMultiply(_job.joint_inverse_transpose_matrices[i0], wsum);  \
-  const int last = _job.influences_count - 1;                                 \
-  for (int j = 1; j < last; ++j) {                                            \
-    const uint16_t ij = joint_indices[j];                                     \
-    const math::SimdFloat4 w =                                                \
-        math::simd_float4::Load1PtrU(joint_weights + j);                      \
-    wsum = wsum + w;                                                          \
-    transform = transform + math::ColumnMultiply(_job.joint_matrices[ij], w); \
-    it_transform =                                                            \
-        it_transform +                                                        \
-        math::ColumnMultiply(_job.joint_inverse_transpose_matrices[ij], w);   \
-  }                                                                           \
-  const math::SimdFloat4 wlast = one - wsum;                                  \
-  const int ilast = joint_indices[last];                                      \
-  transform =                                                                 \
-      transform + math::ColumnMultiply(_job.joint_matrices[ilast], wlast);    \
-  it_transform =                                                              \
-      it_transform + math::ColumnMultiply(                                    \
-                         _job.joint_inverse_transpose_matrices[ilast], wlast);
+#define PREPARE_IT_N()                                                     \
+  math::SimdFloat4 wsum = math::simd_float4::Load1PtrU(joint_weights + 0); \
+  const uint16_t i0 = joint_indices[0];                                    \
+  const _Matrix& m0 = _matrices[i0];                                       \
+  const _Matrix& mit0 = _it_matrices[i0];                                  \
+  _Matrix transform = Weight(m0, wsum);                                    \
+  _Matrix it_transform = Weight(mit0, wsum);                               \
+  const int last = _job.influences_count - 1;                              \
+  for (int j = 1; j < last; ++j) {                                         \
+    const uint16_t ij = joint_indices[j];                                  \
+    const math::SimdFloat4 w =                                             \
+        math::simd_float4::Load1PtrU(joint_weights + j);                   \
+    wsum = wsum + w;                                                       \
+    transform = transform + Weight(_matrices[ij], w, m0);                  \
+    it_transform = it_transform + Weight(_it_matrices[ij], w, mit0);       \
+  }                                                                        \
+  const math::SimdFloat4 wlast = one - wsum;                               \
+  const int ilast = joint_indices[last];                                   \
+  transform = transform + Weight(_matrices[ilast], wlast, m0);             \
+  it_transform = it_transform + Weight(_it_matrices[ilast], wlast, mit0);
 
 #define PREPARE_N_INNER(_it) PREPARE_##_it##_N()
 
 #define PREPARE_N_OUTER(_it) PREPARE_##_it##_N()
 
+// Resolves blended transforms to the types used to transform points and
+// vectors.
+#define RESOLVE_NOIT()                     \
+  const auto& matrix = Resolve(transform); \
+  const auto& it_matrix = matrix;          \
+  (void)it_matrix;
+
+#define RESOLVE_IT()                             \
+  const auto& matrix = Resolve(transform);       \
+  const auto& it_matrix = Resolve(it_transform);
+
+// Stores x, y and z components of _v to _f, with non-temporal stores if
+// _Stream is true.
+template <bool _Stream>
+OZZ_INLINE void Store3(math::_SimdFloat4 _v, float* _f) {
+  if (_Stream) {
+    math::Stream3PtrU(_v, _f);
+  } else {
+    math::Store3PtrU(_v, _f);
+  }
+}
+
 // Implement point and vector transformation. _INNER and _OUTER have the same
 // meaning as defined for the PREPARE functions.
 #define TRANSFORM_P_INNER()                                                \
   const math::SimdFloat4 in_p = math::simd_float4::LoadPtrU(in_positions); \
-  const math::SimdFloat4 out_p = TransformPoint(transform, in_p);          \
-  math::Store3PtrU(out_p, out_positions);
+  const math::SimdFloat4 out_p = TransformPoint(matrix, in_p);             \
+  Store3<_Stream>(out_p, out_positions);
 
 #define TRANSFORM_PN_INNER()                                             \
   TRANSFORM_P_INNER();                                                   \
   const math::SimdFloat4 in_n = math::simd_float4::LoadPtrU(in_normals); \
-  const math::SimdFloat4 out_n = TransformVector(it_transform, in_n);    \
-  math::Store3PtrU(out_n, out_normals);
+  const math::SimdFloat4 out_n = TransformVector(it_matrix, in_n);       \
+  Store3<_Stream>(out_n, out_normals);
 
 #define TRANSFORM_PNT_INNER()                                             \
   TRANSFORM_PN_INNER();                                                   \
   const math::SimdFloat4 in_t = math::simd_float4::LoadPtrU(in_tangents); \
-  const math::SimdFloat4 out_t = TransformVector(it_transform, in_t);     \
-  math::Store3PtrU(out_t, out_tangents);
+  const math::SimdFloat4 out_t = TransformVector(it_matrix, in_t);        \
+  Store3<_Stream>(out_t, out_tangents);
 
 #define TRANSFORM_P_OUTER()                                                 \
   const math::SimdFloat4 in_p = math::simd_float4::Load3PtrU(in_positions); \
-  const math::SimdFloat4 out_p = TransformPoint(transform, in_p);           \
-  math::Store3PtrU(out_p, out_positions);
+  const math::SimdFloat4 out_p = TransformPoint(matrix, in_p);              \
+  Store3<_Stream>(out_p, out_positions);
 
 #define TRANSFORM_PN_OUTER()                                              \
   TRANSFORM_P_OUTER();                                                    \
   const math::SimdFloat4 in_n = math::simd_float4::Load3PtrU(in_normals); \
-  const math::SimdFloat4 out_n = TransformVector(it_transform, in_n);     \
-  math::Store3PtrU(out_n, out_normals);
+  const math::SimdFloat4 out_n = TransformVector(it_matrix, in_n);        \
+  Store3<_Stream>(out_n, out_normals);
 
 #define TRANSFORM_PNT_OUTER()                                              \
   TRANSFORM_PN_OUTER();                                                    \
   const math::SimdFloat4 in_t = math::simd_float4::Load3PtrU(in_tangents); \
-  const math::SimdFloat4 out_t = TransformVector(it_transform, in_t);      \
-  math::Store3PtrU(out_t, out_tangents);
+  const math::SimdFloat4 out_t = TransformVector(it_matrix, in_t);         \
+  Store3<_Stream>(out_t, out_tangents);
 
 // Instantiates all skinning function variants.
 SKINNING_FN(P, NOIT, 1)
@@ -438,10 +572,23 @@ SKINNING_FN(PNT, NOIT, N)
 SKINNING_FN(PN, IT, N)
 SKINNING_FN(PNT, IT, N)
 
-// Defines a matrix of skinning function pointers. This matrix will then be
-// indexed according to skinning jobs parameters.
-typedef void (*SkiningFct)(const SkinningJob&);
-static const SkiningFct kSkinningFct[2][5][3] = {
+// Defines a matrix of skinning function pointers, for each joint matrix type
+// and store mode. This matrix will then be indexed according to skinning jobs
+// parameters.
+template <typename _Matrix, bool _Stream>
+struct SkinningFct {
+  typedef void (*Fct)(const SkinningJob&, const span<const _Matrix>&,
+                      const span<const _Matrix>&);
+  static const Fct kFct[2][5][3];
+};
+
+#undef SKINNING_FN_NAME
+#define SKINNING_FN_NAME(_type, _it, _inf) \
+  Skinning##_type##_it##_inf<_Matrix, _Stream>
+
+template <typename _Matrix, bool _Stream>
+const typename SkinningFct<_Matrix, _Stream>::Fct
+    SkinningFct<_Matrix, _Stream>::kFct[2][5][3] = {
     {
         {&SKINNING_FN_NAME(P, NOIT, 1), &SKINNING_FN_NAME(PN, NOIT, 1),
          &SKINNING_FN_NAME(PNT, NOIT, 1)},
@@ -466,6 +613,473 @@ static const SkiningFct kSkinningFct[2][5][3] = {
         {&SKINNING_FN_NAME(P, NOIT, N), &SKINNING_FN_NAME(PN, IT, N),
          &SKINNING_FN_NAME(PNT, IT, N)},
     }};
+#undef SKINNING_FN_NAME
+
+// Selects and calls the skinning function matching job parameters.
+template <typename _Matrix, bool _Stream>
+void SkinWith(const SkinningJob& _job, const span<const _Matrix>& _matrices,
+              const span<const _Matrix>& _it_matrices) {
+  typedef SkinningFct<_Matrix, _Stream> Fcts;
+
+  // Find skinning function index.
+  const size_t it = !_it_matrices.empty();
+  assert(it < OZZ_ARRAY_SIZE(Fcts::kFct));
+  const size_t inf =
+      static_cast<size_t>(_job.influences_count) > OZZ_ARRAY_SIZE(Fcts::kFct[0])
+          ? OZZ_ARRAY_SIZE(Fcts::kFct[0]) - 1
+          : _job.influences_count - 1;
+  assert(inf < OZZ_ARRAY_SIZE(Fcts::kFct[0]));
+  const size_t fct = !_job.in_normals.empty() + !_job.in_tangents.empty();
+  assert(fct < OZZ_ARRAY_SIZE(Fcts::kFct[0][0]));
+
+  // Calls skinning function. Cannot fail because job is valid.
+  Fcts::kFct[it][inf][fct](_job, _matrices, _it_matrices);
+}
+
+// Selects skinning functions matching job store mode.
+template <typename _Matrix>
+void Skin(const SkinningJob& _job, const span<const _Matrix>& _matrices,
+          const span<const _Matrix>& _it_matrices) {
+  if (_job.streaming_output) {
+    SkinWith<_Matrix, true>(_job, _matrices, _it_matrices);
+  } else {
+    SkinWith<_Matrix, false>(_job, _matrices, _it_matrices);
+  }
+}
+
+#if defined(OZZ_SKINNING_AVX)
+// AVX path skins vertices by pairs, 8 wide. Each 128 bits lane holds one
+// vertex, so that joint matrices columns are loaded as is. Weighted matrices
+// accumulation, the most costly part of the skinning, is thus done for 2
+// vertices with a single instruction.
+
+// Packs SSE vectors _lo and _hi to a single AVX one.
+OZZ_SKINNING_AVX_TARGET inline __m256 Pack8(__m128 _lo, __m128 _hi) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_lo), _hi, 1);
+}
+
+// Packs weights _lo and _hi, splatted to their respective lanes.
+OZZ_SKINNING_AVX_TARGET inline __m256 PackWeights8(float _lo, float _hi) {
+  return Pack8(_mm_set1_ps(_lo), _mm_set1_ps(_hi));
+}
+
+// Loads 4 floats from both _lo and _hi.
+OZZ_SKINNING_AVX_TARGET inline __m256 Load8(const float* _lo,
+                                            const float* _hi) {
+  return Pack8(_mm_loadu_ps(_lo), _mm_loadu_ps(_hi));
+}
+
+// Stores x, y and z components of both lanes of _v to _lo and _hi, with
+// non-temporal stores if _Stream is true.
+template <bool _Stream>
+OZZ_SKINNING_AVX_TARGET inline void Store3x2(__m256 _v, float* _lo,
+                                             float* _hi) {
+  Store3<_Stream>(_mm256_castps256_ps128(_v), _lo);
+  Store3<_Stream>(_mm256_extractf128_ps(_v, 1), _hi);
+}
+
+// Accumulates weighted matrices of 2 vertices, whose joint indices are _i0 and
+// _i1 and weights _w0 and _w1. Last weight is deduced from the others, as
+// their sum is 1. _Inf is the number of influences, or 0 if it's only known
+// at runtime (_influences).
+template <int _Inf>
+OZZ_SKINNING_AVX_TARGET inline void Blend8(const math::Float4x4* _matrices,
+                                           int _influences,
+                                           const uint16_t* _i0,
+                                           const uint16_t* _i1,
+                                           const float* _w0, const float* _w1,
+                                           __m256 _cols[4]) {
+  const int influences = _Inf ? _Inf : _influences;
+  if (influences == 1) {
+    const math::Float4x4& m0 = _matrices[_i0[0]];
+    const math::Float4x4& m1 = _matrices[_i1[0]];
+    for (int c = 0; c < 4; ++c) {
+      _cols[c] = Pack8(m0.cols[c], m1.cols[c]);
+    }
+    return;
+  }
+  __m256 wsum = PackWeights8(_w0[0], _w1[0]);
+  {
+    const math::Float4x4& m0 = _matrices[_i0[0]];
+    const math::Float4x4& m1 = _matrices[_i1[0]];
+    for (int c = 0; c < 4; ++c) {
+      _cols[c] = _mm256_mul_ps(Pack8(m0.cols[c], m1.cols[c]), wsum);
+    }
+  }
+  const int last = influences - 1;
+  for (int j = 1; j < last; ++j) {
+    const __m256 w = PackWeights8(_w0[j], _w1[j]);
+    wsum = _mm256_add_ps(wsum, w);
+    const math::Float4x4& m0 = _matrices[_i0[j]];
+    const math::Float4x4& m1 = _matrices[_i1[j]];
+    for (int c = 0; c < 4; ++c) {
+      _cols[c] = _mm256_add_ps(
+          _cols[c], _mm256_mul_ps(Pack8(m0.cols[c], m1.cols[c]), w));
+    }
+  }
+  const __m256 wlast = _mm256_sub_ps(_mm256_set1_ps(1.f), wsum);
+  const math::Float4x4& m0 = _matrices[_i0[last]];
+  const math::Float4x4& m1 = _matrices[_i1[last]];
+  for (int c = 0; c < 4; ++c) {
+    _cols[c] = _mm256_add_ps(
+        _cols[c], _mm256_mul_ps(Pack8(m0.cols[c], m1.cols[c]), wlast));
+  }
+}
+
+// Transforms vectors _v (one per lane) by matrices _cols.
+OZZ_SKINNING_AVX_TARGET inline __m256 TransformVector8(const __m256 _cols[4],
+                                                       __m256 _v) {
+  const __m256 x = _mm256_mul_ps(_mm256_permute_ps(_v, 0x00), _cols[0]);
+  const __m256 y = _mm256_mul_ps(_mm256_permute_ps(_v, 0x55), _cols[1]);
+  const __m256 z = _mm256_mul_ps(_mm256_permute_ps(_v, 0xaa), _cols[2]);
+  return _mm256_add_ps(_mm256_add_ps(x, y), z);
+}
+
+// Transforms points _p (one per lane) by matrices _cols.
+OZZ_SKINNING_AVX_TARGET inline __m256 TransformPoint8(const __m256 _cols[4],
+                                                      __m256 _p) {
+  return _mm256_add_ps(TransformVector8(_cols, _p), _cols[3]);
+}
+
+// Skins _pairs pairs of vertices from the beginning of _job buffers. Vertex
+// buffers are read 4 floats at a time, so the last vertex of the job must not
+// be processed.
+template <int _Inf, int _Fct, bool _It, bool _Stream>
+OZZ_SKINNING_AVX_TARGET void SkinningPairs8(const SkinningJob& _job,
+                                            int _pairs) {
+  const math::Float4x4* matrices = _job.joint_matrices.begin();
+  const math::Float4x4* it_matrices =
+      _It ? _job.joint_inverse_transpose_matrices.begin() : matrices;
+  const uint16_t* joint_indices = _job.joint_indices.begin();
+  const float* joint_weights = _job.joint_weights.begin();
+  const float* in_positions = _job.in_positions.begin();
+  float* out_positions = _job.out_positions.begin();
+  const float* in_normals = _job.in_normals.begin();
+  float* out_normals = _job.out_normals.begin();
+  const float* in_tangents = _job.in_tangents.begin();
+  float* out_tangents = _job.out_tangents.begin();
+
+  for (int i = 0; i < _pairs; ++i) {
+    const uint16_t* joint_indices1 =
+        NEXT(const uint16_t*, joint_indices, _job.joint_indices_stride);
+    const float* joint_weights1 =
+        _Inf == 1 ? joint_weights
+                  : NEXT(const float*, joint_weights, _job.joint_weights_stride);
+
+    __m256 cols[4];
+    Blend8<_Inf>(matrices, _job.influences_count, joint_indices,
+                 joint_indices1, joint_weights, joint_weights1, cols);
+
+    const float* in_positions1 =
+        NEXT(const float*, in_positions, _job.in_positions_stride);
+    float* out_positions1 =
+        NEXT(float*, out_positions, _job.out_positions_stride);
+    Store3x2<_Stream>(TransformPoint8(cols, Load8(in_positions, in_positions1)),
+                      out_positions, out_positions1);
+    in_positions = NEXT(const float*, in_positions1, _job.in_positions_stride);
+    out_positions = NEXT(float*, out_positions1, _job.out_positions_stride);
+
+    if (_Fct > 0) {
+      __m256 it_cols[4];
+      if (_It) {
+        Blend8<_Inf>(it_matrices, _job.influences_count, joint_indices,
+                     joint_indices1, joint_weights, joint_weights1, it_cols);
+      } else {
+        for (int c = 0; c < 3; ++c) {
+          it_cols[c] = cols[c];
+        }
+      }
+
+      const float* in_normals1 =
+          NEXT(const float*, in_normals, _job.in_normals_stride);
+      float* out_normals1 = NEXT(float*, out_normals, _job.out_normals_stride);
+      Store3x2<_Stream>(
+          TransformVector8(it_cols, Load8(in_normals, in_normals1)),
+          out_normals, out_normals1);
+      in_normals = NEXT(const float*, in_normals1, _job.in_normals_stride);
+      out_normals = NEXT(float*, out_normals1, _job.out_normals_stride);
+
+      if (_Fct > 1) {
+        const float* in_tangents1 =
+            NEXT(const float*, in_tangents, _job.in_tangents_stride);
+        float* out_tangents1 =
+            NEXT(float*, out_tangents, _job.out_tangents_stride);
+        Store3x2<_Stream>(
+            TransformVector8(it_cols, Load8(in_tangents, in_tangents1)),
+            out_tangents, out_tangents1);
+        in_tangents = NEXT(const float*, in_tangents1, _job.in_tangents_stride);
+        out_tangents = NEXT(float*, out_tangents1, _job.out_tangents_stride);
+      }
+    }
+
+    joint_indices =
+        NEXT(const uint16_t*, joint_indices1, _job.joint_indices_stride);
+    if (_Inf != 1) {
+      joint_weights =
+          NEXT(const float*, joint_weights1, _job.joint_weights_stride);
+    }
+  }
+}
+
+// Defines a matrix of AVX skinning function pointers, indexed as kSkinningFct,
+// with an additional store mode dimension.
+typedef void (*SkinningPairs8Fct)(const SkinningJob&, int);
+#define SKINNING_PAIRS8_FCTS(_it, _s)                                       \
+  {                                                                         \
+    {&SkinningPairs8<1, 0, false, _s>, &SkinningPairs8<1, 1, _it, _s>,      \
+     &SkinningPairs8<1, 2, _it, _s>},                                       \
+        {&SkinningPairs8<2, 0, false, _s>, &SkinningPairs8<2, 1, _it, _s>,  \
+         &SkinningPairs8<2, 2, _it, _s>},                                   \
+        {&SkinningPairs8<3, 0, false, _s>, &SkinningPairs8<3, 1, _it, _s>,  \
+         &SkinningPairs8<3, 2, _it, _s>},                                   \
+        {&SkinningPairs8<4, 0, false, _s>, &SkinningPairs8<4, 1, _it, _s>,  \
+         &SkinningPairs8<4, 2, _it, _s>},                                   \
+    {                                                                       \
+      &SkinningPairs8<0, 0, false, _s>, &SkinningPairs8<0, 1, _it, _s>,     \
+          &SkinningPairs8<0, 2, _it, _s>                                    \
+    }                                                                       \
+  }
+static const SkinningPairs8Fct kSkinningPairs8Fct[2][2][5][3] = {
+    {SKINNING_PAIRS8_FCTS(false, false), SKINNING_PAIRS8_FCTS(true, false)},
+    {SKINNING_PAIRS8_FCTS(false, true), SKINNING_PAIRS8_FCTS(true, true)}};
+#undef SKINNING_PAIRS8_FCTS
+
+// Tells if AVX path can be used on this host.
+bool HasAvx() {
+#if defined(OZZ_SKINNING_AVX_DISPATCH)
+  return math::SimdHostSupports(math::kSimdHostAvx);
+#else   // OZZ_SKINNING_AVX_DISPATCH
+  return true;
+#endif  // OZZ_SKINNING_AVX_DISPATCH
+}
+
+// Skins Float4x4 joint matrices with AVX path, which processes pairs of
+// vertices. The remaining vertices (including the last one, which can't be
+// read 4 floats at a time) are processed by the SSE path.
+void SkinAvx(const SkinningJob& _job) {
+  const int pairs = (_job.vertex_count - 1) / 2;
+  if (pairs > 0) {
+    const size_t stream = _job.streaming_output;
+    const size_t it = !_job.joint_inverse_transpose_matrices.empty();
+    const size_t inf = static_cast<size_t>(_job.influences_count) >
+                               OZZ_ARRAY_SIZE(kSkinningPairs8Fct[0][0])
+                           ? OZZ_ARRAY_SIZE(kSkinningPairs8Fct[0][0]) - 1
+                           : _job.influences_count - 1;
+    const size_t fct = !_job.in_normals.empty() + !_job.in_tangents.empty();
+    kSkinningPairs8Fct[stream][it][inf][fct](_job, pairs);
+  }
+
+  // Rebases job on the remaining vertices.
+  const int done = pairs * 2;
+  const SkinningJob job = _job.Range(done, _job.vertex_count - done);
+  Skin(job, job.joint_matrices, job.joint_inverse_transpose_matrices);
+}
+#endif  // OZZ_SKINNING_AVX
+
+// Skins all vertices of job _job, which is valid and only has float inputs.
+void RunDecoded(const SkinningJob& _job) {
+  if (!_job.joint_matrices.empty()) {
+#if defined(OZZ_SKINNING_AVX)
+    if (HasAvx()) {
+      SkinAvx(_job);
+      return;
+    }
+#endif  // OZZ_SKINNING_AVX
+    Skin(_job, _job.joint_matrices, _job.joint_inverse_transpose_matrices);
+  } else if (!_job.joint_affine_matrices.empty()) {
+    Skin(_job, _job.joint_affine_matrices,
+         _job.joint_affine_inverse_transpose_matrices);
+  } else {
+    Skin(_job, _job.joint_dual_quaternions,
+         span<const math::DualQuaternion>());
+  }
+}
+
+// Decodes an octahedral encoded snorm16 unit vector to _out (3 floats).
+void DecodeOctahedral(const int16_t* _in, float* _out) {
+  const float kNorm = 1.f / 32767.f;
+  float x = math::Max(_in[0] * kNorm, -1.f);
+  float y = math::Max(_in[1] * kNorm, -1.f);
+  const float z = 1.f - std::abs(x) - std::abs(y);
+  if (z < 0.f) {  // Lower hemisphere is folded over the diagonals.
+    const float fx = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+    const float fy = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+    x = fx;
+    y = fy;
+  }
+  const float inv_len = 1.f / std::sqrt(x * x + y * y + z * z);
+  _out[0] = x * inv_len;
+  _out[1] = y * inv_len;
+  _out[2] = z * inv_len;
+}
+
+// Decodes _count octahedral vectors from _in (separated by _stride bytes) to
+// packed float3 buffer _out.
+void DecodeOctahedrals(const span<const int16_t>& _in, size_t _stride,
+                       int _count, float* _out) {
+  for (int i = 0; i < _count; ++i) {
+    DecodeOctahedral(NEXT(const int16_t*, _in.begin(), _stride * i),
+                     _out + i * 3);
+  }
+}
+
+// Tells if any morph target of _job has a non 0 weight.
+bool HasActiveMorphTargets(const SkinningJob& _job) {
+  for (size_t i = 0; i < _job.morph_targets.size(); ++i) {
+    if (_job.morph_weights[i] != 0.f) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Skins job _job, which has compressed inputs, remapped indices or active
+// morph targets. Compressed inputs are decoded, indices remapped and vertices
+// morphed chunk by chunk to stack buffers, which are then skinned by the float
+// path.
+void RunCompressed(const SkinningJob& _job, bool _morph) {
+  const int kMaxVertices = 64;
+  const int kMaxInfluences = kMaxVertices * 8;
+  static_assert(kMaxInfluences >= SkinningJob::kMaxCompressedInfluences,
+                "Decoding buffers are too small for a single vertex");
+  float positions[kMaxVertices * 3];
+  float normals[kMaxVertices * 3];
+  float tangents[kMaxVertices * 3];
+  uint16_t indices[kMaxInfluences];
+  float weights[kMaxInfluences];
+
+  const int influences = _job.influences_count;
+  const int max_vertices = math::Min(kMaxVertices, kMaxInfluences / influences);
+  for (int begin = 0; begin < _job.vertex_count; begin += max_vertices) {
+    SkinningJob job = _job.Range(begin, max_vertices);
+    const int count = job.vertex_count;
+
+    if (!job.joint_indices8.empty()) {
+      for (int i = 0; i < count; ++i) {
+        const uint8_t* in = NEXT(const uint8_t*, job.joint_indices8.begin(),
+                                 job.joint_indices_stride * i);
+        for (int j = 0; j < influences; ++j) {
+          indices[i * influences + j] = in[j];
+        }
+      }
+      job.joint_indices = make_span(indices).first(count * influences);
+      job.joint_indices_stride = sizeof(uint16_t) * influences;
+      job.joint_indices8 = {};
+    }
+    if (!job.joint_remaps.empty()) {
+      // Indices can be remapped in place if they were already decoded.
+      for (int i = 0; i < count; ++i) {
+        const uint16_t* in = NEXT(const uint16_t*, job.joint_indices.begin(),
+                                  job.joint_indices_stride * i);
+        for (int j = 0; j < influences; ++j) {
+          indices[i * influences + j] = job.joint_remaps[in[j]];
+        }
+      }
+      job.joint_indices = make_span(indices).first(count * influences);
+      job.joint_indices_stride = sizeof(uint16_t) * influences;
+      job.joint_remaps = {};
+    }
+    if (!job.joint_weights8.empty() && influences != 1) {
+      const int stride = influences - 1;
+      for (int i = 0; i < count; ++i) {
+        const uint8_t* in = NEXT(const uint8_t*, job.joint_weights8.begin(),
+                                 job.joint_weights_stride * i);
+        for (int j = 0; j < stride; ++j) {
+          weights[i * stride + j] = in[j] * (1.f / 255.f);
+        }
+      }
+      job.joint_weights = make_span(weights).first(count * stride);
+      job.joint_weights_stride = sizeof(float) * stride;
+    }
+    job.joint_weights8 = {};
+    if (!job.in_half_positions.empty()) {
+      for (int i = 0; i < count; ++i) {
+        const uint16_t* in =
+            NEXT(const uint16_t*, job.in_half_positions.begin(),
+                 job.in_positions_stride * i);
+        for (int j = 0; j < 3; ++j) {
+          positions[i * 3 + j] = math::HalfToFloat(in[j]);
+        }
+      }
+      job.in_positions = make_span(positions).first(count * 3);
+      job.in_positions_stride = sizeof(float) * 3;
+      job.in_half_positions = {};
+    }
+    if (!job.in_oct_normals.empty()) {
+      DecodeOctahedrals(job.in_oct_normals, job.in_normals_stride, count,
+                        normals);
+      job.in_normals = make_span(normals).first(count * 3);
+      job.in_normals_stride = sizeof(float) * 3;
+      job.in_oct_normals = {};
+    }
+    if (!job.in_oct_tangents.empty()) {
+      DecodeOctahedrals(job.in_oct_tangents, job.in_tangents_stride, count,
+                        tangents);
+      job.in_tangents = make_span(tangents).first(count * 3);
+      job.in_tangents_stride = sizeof(float) * 3;
+      job.in_oct_tangents = {};
+    }
+    if (_morph) {
+      // Morphs decoded (or original) inputs to the chunk buffers.
+      MorphJob morph;
+      morph.vertex_count = count;
+      morph.first_vertex = job.morph_first_vertex;
+      morph.targets = job.morph_targets;
+      morph.weights = job.morph_weights;
+      morph.in_positions = job.in_positions;
+      morph.in_positions_stride = job.in_positions_stride;
+      morph.out_positions = make_span(positions).first(count * 3);
+      morph.out_positions_stride = sizeof(float) * 3;
+      if (!job.in_normals.empty()) {
+        morph.in_normals = job.in_normals;
+        morph.in_normals_stride = job.in_normals_stride;
+        morph.out_normals = make_span(normals).first(count * 3);
+        morph.out_normals_stride = sizeof(float) * 3;
+      }
+      const bool success = morph.Run();
+      (void)success;
+      assert(success);
+      job.in_positions = morph.out_positions;
+      job.in_positions_stride = morph.out_positions_stride;
+      if (!job.in_normals.empty()) {
+        job.in_normals = morph.out_normals;
+        job.in_normals_stride = morph.out_normals_stride;
+      }
+    }
+
+    RunDecoded(job);
+  }
+}
+
+// Skins all vertices of job _job, which is valid.
+void RunValid(const SkinningJob& _job) {
+  // Early out if no vertex. This isn't an error.
+  // Skinning function algorithm doesn't support the case.
+  if (_job.vertex_count == 0) {
+    return;
+  }
+
+  const bool morph = HasActiveMorphTargets(_job);
+  if (morph || !_job.joint_indices8.empty() || !_job.joint_weights8.empty() ||
+      !_job.joint_remaps.empty() || !_job.in_half_positions.empty() ||
+      !_job.in_oct_normals.empty() || !_job.in_oct_tangents.empty()) {
+    RunCompressed(_job, morph);
+  } else {
+    RunDecoded(_job);
+  }
+
+  // Orders streamed stores before any store following this chunk, so output
+  // is complete once the job (or its parallel_for) returns.
+  if (_job.streaming_output) {
+    math::StreamFence();
+  }
+}
+
+// Skins chunk _chunk of the valid job _data, for parallel_for.
+void RunChunk(int _chunk, void* _data) {
+  const SkinningJob& job = *static_cast<const SkinningJob*>(_data);
+  RunValid(job.Range(_chunk * job.parallel_grain, job.parallel_grain));
+}
 
 // Implements job Run function.
 bool SkinningJob::Run() const {
@@ -473,28 +1087,63 @@ bool SkinningJob::Run() const {
   if (!Validate()) {
     return false;
   }
+  RunUnchecked();
+  return true;
+}
 
-  // Early out if no vertex. This isn't an error.
-  // Skinning function algorithm doesn't support the case.
-  if (vertex_count == 0) {
-    return true;
+void SkinningJob::RunUnchecked() const {
+  OZZ_PROFILE_ZONE("SkinningJob::Run");
+
+  // Dispatches chunks to the task scheduler, unless there's a single one.
+  if (parallel_for != nullptr && vertex_count > parallel_grain) {
+    const int chunks = (vertex_count + parallel_grain - 1) / parallel_grain;
+    parallel_for(chunks, &RunChunk,
+                 const_cast<void*>(static_cast<const void*>(this)),
+                 parallel_for_user_data);
+  } else {
+    RunValid(*this);
   }
+}
 
-  // Find skinning function index.
-  const size_t it = !joint_inverse_transpose_matrices.empty();
-  assert(it < OZZ_ARRAY_SIZE(kSkinningFct));
-  const size_t inf =
-      static_cast<size_t>(influences_count) > OZZ_ARRAY_SIZE(kSkinningFct[0])
-          ? OZZ_ARRAY_SIZE(kSkinningFct[0]) - 1
-          : influences_count - 1;
-  assert(inf < OZZ_ARRAY_SIZE(kSkinningFct[0]));
-  const size_t fct = !in_normals.empty() + !in_tangents.empty();
-  assert(fct < OZZ_ARRAY_SIZE(kSkinningFct[0][0]));
+// Offsets span _span by _count elements of _stride bytes. Empty spans remain
+// empty.
+template <typename _Type>
+span<_Type> Offset(const span<_Type>& _span, int _count, size_t _stride) {
+  if (_span.empty()) {
+    return _span;
+  }
+  return span<_Type>(NEXT(_Type*, _span.begin(), _stride * _count),
+                     _span.end());
+}
 
-  // Calls skinning function. Cannot fail because job is valid.
-  kSkinningFct[it][inf][fct](*this);
+SkinningJob SkinningJob::Range(int _begin, int _count) const {
+  const int begin = math::Clamp(0, _begin, vertex_count);
+  const int count = math::Clamp(0, _count, vertex_count - begin);
 
-  return true;
+  SkinningJob job = *this;
+  job.vertex_count = count;
+
+  // Ranges are left untouched for an empty job, so it remains valid.
+  if (count == 0) {
+    return job;
+  }
+
+  job.joint_indices = Offset(joint_indices, begin, joint_indices_stride);
+  job.joint_indices8 = Offset(joint_indices8, begin, joint_indices_stride);
+  job.joint_weights = Offset(joint_weights, begin, joint_weights_stride);
+  job.joint_weights8 = Offset(joint_weights8, begin, joint_weights_stride);
+  job.in_positions = Offset(in_positions, begin, in_positions_stride);
+  job.in_half_positions =
+      Offset(in_half_positions, begin, in_positions_stride);
+  job.in_normals = Offset(in_normals, begin, in_normals_stride);
+  job.in_oct_normals = Offset(in_oct_normals, begin, in_normals_stride);
+  job.in_tangents = Offset(in_tangents, begin, in_tangents_stride);
+  job.in_oct_tangents = Offset(in_oct_tangents, begin, in_tangents_stride);
+  job.out_positions = Offset(out_positions, begin, out_positions_stride);
+  job.out_normals = Offset(out_normals, begin, out_normals_stride);
+  job.out_tangents = Offset(out_tangents, begin, out_tangents_stride);
+  job.morph_first_vertex = morph_first_vertex + begin;
+  return job;
 }
 }  // namespace geometry
 }  // namespace ozz
@@ -25,9 +25,12 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include <cmath>
+
 #include "gtest/gtest.h"
 #include "ozz/animation/offline/additive_animation_builder.h"
 #include "ozz/animation/offline/raw_animation.h"
+#include "ozz/base/gtest_parallel_for_helper.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 #include "ozz/base/maths/math_constant.h"
 #include "ozz/base/maths/transform.h"
@@ -316,3 +319,122 @@ TEST(BuildRefPose, AdditiveAnimationBuilder) {
     }
   }
 }
+
+namespace {
+// Builds a clip whose tracks have a number of keys that isn't a multiple of 4.
+RawAnimation BuildBatchClip(int _seed) {
+  RawAnimation input;
+  input.duration = 1.f;
+  input.name = "batch";
+  input.tracks.resize(3);
+  for (int i = 0; i < input.num_tracks(); ++i) {
+    const int num_keys = _seed + i * 3;
+    for (int k = 0; k < num_keys; ++k) {
+      const float time = static_cast<float>(k) / num_keys;
+      const float v = static_cast<float>(_seed * 7 + i * 5 + k);
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(v, -v * .5f, v * 2.f)};
+      input.tracks[i].translations.push_back(tkey);
+      const float angle = v * .1f;
+      const RawAnimation::RotationKey rkey = {
+          time,
+          ozz::math::Quaternion(std::sin(angle), 0.f, 0.f, std::cos(angle))};
+      input.tracks[i].rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f + v, 2.f, -v - 1.f)};
+      input.tracks[i].scales.push_back(skey);
+    }
+  }
+  return input;
+}
+}  // namespace
+
+TEST(BuildBatch, AdditiveAnimationBuilder) {
+  AdditiveAnimationBuilder builder;
+
+  ozz::math::Transform ref_pose[3];
+  ref_pose[0] = ozz::math::Transform::identity();
+  ref_pose[1].translation = ozz::math::Float3(1.f, 2.f, 3.f);
+  ref_pose[1].rotation =
+      ozz::math::Quaternion(0.f, 0.f, .70710677f, .70710677f);
+  ref_pose[1].scale = ozz::math::Float3(1.f, -1.f, 2.f);
+  ref_pose[2].translation = ozz::math::Float3(-4.f, 0.f, 1.f);
+  ref_pose[2].rotation =
+      ozz::math::Quaternion(.70710677f, 0.f, 0.f, .70710677f);
+  ref_pose[2].scale = ozz::math::Float3(3.f, 4.f, .5f);
+
+  RawAnimation inputs[5];
+  for (int i = 0; i < 5; ++i) {
+    inputs[i] = BuildBatchClip(i);
+  }
+
+  {  // Output range too small.
+    RawAnimation outputs[4];
+    EXPECT_FALSE(builder(inputs, ozz::span<ozz::math::Transform>(ref_pose),
+                         outputs));
+  }
+
+  // Outlives the batch block, as builder keeps pointing to it.
+  int tasks = 0;
+  {  // Batch matches single clip version.
+    builder.parallel_for = &ReverseParallelFor;
+    builder.parallel_for_user_data = &tasks;
+
+    RawAnimation outputs[5];
+    ASSERT_TRUE(builder(inputs, ozz::span<ozz::math::Transform>(ref_pose),
+                        outputs));
+    EXPECT_EQ(tasks, 5);
+
+    for (int i = 0; i < 5; ++i) {
+      RawAnimation expected;
+      ASSERT_TRUE(builder(inputs[i],
+                          ozz::span<ozz::math::Transform>(ref_pose),
+                          &expected));
+      EXPECT_STREQ(outputs[i].name.c_str(), expected.name.c_str());
+      EXPECT_FLOAT_EQ(outputs[i].duration, expected.duration);
+      ASSERT_EQ(outputs[i].num_tracks(), expected.num_tracks());
+      for (int t = 0; t < expected.num_tracks(); ++t) {
+        const RawAnimation::JointTrack& track = outputs[i].tracks[t];
+        const RawAnimation::JointTrack& etrack = expected.tracks[t];
+        ASSERT_EQ(track.translations.size(), etrack.translations.size());
+        for (size_t k = 0; k < etrack.translations.size(); ++k) {
+          const ozz::math::Float3& e = etrack.translations[k].value;
+          EXPECT_FLOAT_EQ(track.translations[k].time,
+                          etrack.translations[k].time);
+          EXPECT_FLOAT3_EQ(track.translations[k].value, e.x, e.y, e.z);
+        }
+        ASSERT_EQ(track.rotations.size(), etrack.rotations.size());
+        for (size_t k = 0; k < etrack.rotations.size(); ++k) {
+          const ozz::math::Quaternion& e = etrack.rotations[k].value;
+          EXPECT_FLOAT_EQ(track.rotations[k].time, etrack.rotations[k].time);
+          EXPECT_QUATERNION_EQ(track.rotations[k].value, e.x, e.y, e.z, e.w);
+        }
+        ASSERT_EQ(track.scales.size(), etrack.scales.size());
+        for (size_t k = 0; k < etrack.scales.size(); ++k) {
+          const ozz::math::Float3& e = etrack.scales[k].value;
+          EXPECT_FLOAT_EQ(track.scales[k].time, etrack.scales[k].time);
+          EXPECT_FLOAT3_EQ(track.scales[k].value, e.x, e.y, e.z);
+        }
+      }
+    }
+  }
+
+  {  // An invalid clip fails, but others are still built.
+    inputs[1].duration = -1.f;
+    RawAnimation outputs[5];
+    outputs[1].tracks.resize(2);
+    EXPECT_FALSE(builder(inputs, ozz::span<ozz::math::Transform>(ref_pose),
+                         outputs));
+    EXPECT_EQ(outputs[1].num_tracks(), 0);
+    EXPECT_EQ(outputs[0].num_tracks(), 3);
+    EXPECT_EQ(outputs[4].num_tracks(), 3);
+  }
+
+  {  // Reference pose too small.
+    RawAnimation outputs[5];
+    EXPECT_FALSE(builder(ozz::span<const RawAnimation>(inputs, 1),
+                         ozz::span<ozz::math::Transform>(ref_pose, 2),
+                         outputs));
+    EXPECT_EQ(outputs[0].num_tracks(), 0);
+  }
+}
@@ -0,0 +1,193 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/animation_analyzer.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::offline::AnimationAnalysis;
+using ozz::animation::offline::AnimationAnalyzer;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds an animation of 2 tracks and 1s, whose track 0 has 6 varying
+// translation keys and 6 constant rotation keys. Other keys are default ones.
+ozz::unique_ptr<Animation> BuildAnimation(const AnimationBuilder& _builder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  RawAnimation::JointTrack& track = raw_animation.tracks[0];
+  for (int k = 0; k <= 5; ++k) {
+    const float time = k / 5.f;
+    const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(0.f, static_cast<float>(k), 0.f)};
+    track.translations.push_back(tkey);
+    const RawAnimation::RotationKey rkey = {
+        time, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                   ozz::math::kPi_4)};
+    track.rotations.push_back(rkey);
+  }
+  return _builder(raw_animation);
+}
+}  // namespace
+
+TEST(Error, AnimationAnalyzer) {
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation = BuildAnimation(builder);
+  ASSERT_TRUE(animation);
+
+  AnimationAnalyzer analyzer;
+  EXPECT_FALSE(analyzer(*animation, nullptr));
+
+  AnimationAnalysis analysis;
+  {  // Invalid frame rate.
+    AnimationAnalyzer invalid;
+    invalid.frame_rate = 0.f;
+    EXPECT_FALSE(invalid(*animation, &analysis));
+    EXPECT_TRUE(analysis.tracks.empty());
+    EXPECT_EQ(analysis.size, 0u);
+  }
+  {  // Invalid tolerance.
+    AnimationAnalyzer invalid;
+    invalid.rotation_tolerance = -1.f;
+    EXPECT_FALSE(invalid(*animation, &analysis));
+    EXPECT_TRUE(analysis.tracks.empty());
+  }
+  {  // Invalid tier.
+    AnimationAnalyzer invalid;
+    invalid.tiers.push_back(0.f);
+    EXPECT_FALSE(invalid(*animation, &analysis));
+    EXPECT_TRUE(analysis.tiers.empty());
+  }
+
+  EXPECT_TRUE(analyzer(*animation, &analysis));
+}
+
+TEST(Empty, AnimationAnalyzer) {
+  Animation animation;
+  AnimationAnalyzer analyzer;
+  AnimationAnalysis analysis;
+  ASSERT_TRUE(analyzer(animation, &analysis));
+  EXPECT_TRUE(analysis.tracks.empty());
+  EXPECT_EQ(analysis.keys_size, 0u);
+  EXPECT_EQ(analysis.num_constant_candidates, 0);
+  EXPECT_FLOAT_EQ(analysis.bytes_per_second, 0.f);
+}
+
+TEST(Analysis, AnimationAnalyzer) {
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation = BuildAnimation(builder);
+  ASSERT_TRUE(animation);
+
+  AnimationAnalyzer analyzer;
+  analyzer.tiers.clear();
+  analyzer.tiers.push_back(30.f);
+  analyzer.tiers.push_back(1.f);
+
+  AnimationAnalysis analysis;
+  ASSERT_TRUE(analyzer(*animation, &analysis));
+
+  EXPECT_FLOAT_EQ(analysis.duration, 1.f);
+  EXPECT_EQ(analysis.size, animation->size());
+  EXPECT_FLOAT_EQ(analysis.bytes_per_second,
+                  static_cast<float>(animation->size()));
+
+  // Padding tracks aren't analyzed.
+  ASSERT_EQ(analysis.tracks.size(), 2u);
+
+  // Default formats store 12 bytes keys.
+  const AnimationAnalysis::Track& track0 = analysis.tracks[0];
+  EXPECT_EQ(track0.translation_keys, 6);
+  EXPECT_EQ(track0.rotation_keys, 6);
+  EXPECT_EQ(track0.scale_keys, 2);
+  EXPECT_FLOAT_EQ(track0.keys_per_second, 14.f);
+  EXPECT_EQ(track0.size, 14u * 12u);
+  EXPECT_FALSE(track0.constant_translation);
+  EXPECT_TRUE(track0.constant_rotation);
+  EXPECT_FALSE(track0.constant_scale);
+
+  // Default keys are constant, but already optimal.
+  const AnimationAnalysis::Track& track1 = analysis.tracks[1];
+  EXPECT_EQ(track1.translation_keys, 2);
+  EXPECT_EQ(track1.rotation_keys, 2);
+  EXPECT_EQ(track1.scale_keys, 2);
+  EXPECT_EQ(track1.size, 6u * 12u);
+  EXPECT_FALSE(track1.constant_translation);
+  EXPECT_FALSE(track1.constant_rotation);
+  EXPECT_FALSE(track1.constant_scale);
+
+  EXPECT_EQ(analysis.keys_size, track0.size + track1.size);
+  EXPECT_EQ(analysis.num_constant_candidates, 1);
+  EXPECT_EQ(analysis.constant_savings, 4u * 12u);
+
+  // Compact translations and scales keys are 10 bytes, packed rotations 8.
+  EXPECT_EQ(analysis.compact_size, 8u * 10u + 8u * 8u + 4u * 10u);
+
+  // Tiers.
+  ASSERT_EQ(analysis.tiers.size(), 2u);
+  EXPECT_FLOAT_EQ(analysis.tiers[0].frequency, 30.f);
+  EXPECT_EQ(analysis.tiers[0].size, analysis.keys_size);
+  EXPECT_FLOAT_EQ(analysis.tiers[1].frequency, 1.f);
+  EXPECT_EQ(analysis.tiers[1].size, 12u * 12u);
+}
+
+TEST(Formats, AnimationAnalyzer) {
+  AnimationBuilder builder;
+  builder.compact_ratios = true;
+  builder.rotation_format = AnimationBuilder::kRotationCompact32;
+  builder.bidirectional = true;
+  builder.random_access = true;
+  ozz::unique_ptr<Animation> animation = BuildAnimation(builder);
+  ASSERT_TRUE(animation);
+
+  AnimationAnalyzer analyzer;
+  AnimationAnalysis analysis;
+  ASSERT_TRUE(analyzer(*animation, &analysis));
+
+  // Keys are already compact, previous offsets and indices cost 6 bytes per
+  // key.
+  ASSERT_EQ(analysis.tracks.size(), 2u);
+  EXPECT_EQ(analysis.tracks[0].size, 8u * 16u + 6u * 14u);
+  EXPECT_EQ(analysis.compact_size, analysis.keys_size);
+  EXPECT_TRUE(analysis.tracks[0].constant_rotation);
+
+  // Tolerance can exclude constant candidates.
+  analyzer.rotation_tolerance = 0.f;
+  ASSERT_TRUE(analyzer(*animation, &analysis));
+  EXPECT_EQ(analysis.num_constant_candidates, 1);
+  analyzer.translation_tolerance = 10.f;
+  ASSERT_TRUE(analyzer(*animation, &analysis));
+  EXPECT_TRUE(analysis.tracks[0].constant_translation);
+  EXPECT_EQ(analysis.num_constant_candidates, 2);
+}
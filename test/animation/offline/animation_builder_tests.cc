@@ -25,12 +25,16 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "ozz/animation/offline/animation_builder.h"
 #include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
 #include "ozz/animation/runtime/animation.h"
 #include "ozz/animation/runtime/sampling_job.h"
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/unique_ptr.h"
@@ -377,3 +381,322 @@ TEST(Sort, AnimationBuilder) {
     }
   }
 }
+
+TEST(SortMany, AnimationBuilder) {
+  // Builds an animation with many tracks of various keys count. Keys times are
+  // multiples of 1/64, so that lots of keys share the same previous key time.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(37);
+  uint32_t seed = 17;
+  for (size_t t = 0; t < raw_animation.tracks.size(); ++t) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[t];
+    float time = 0.f;
+    for (;;) {
+      seed = seed * 1664525u + 1013904223u;
+      time += ((seed >> 16) % 8) / 64.f;
+      if (time > raw_animation.duration) {
+        break;
+      }
+      const float value = ((seed >> 8) % 1000) / 1000.f;
+      const RawAnimation::TranslationKey key = {
+          time, ozz::math::Float3(value, -value, static_cast<float>(t))};
+      track.translations.push_back(key);
+      time += 1.f / 64.f;
+    }
+  }
+  ASSERT_TRUE(raw_animation.Validate());
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  // Sampling forward relies on keys order, so sampled values match raw
+  // animation only if keys are correctly sorted.
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingJob::Context context(animation->num_tracks());
+  ozz::math::SoaTransform output[10];
+  ozz::math::Transform expected[37];
+  job.animation = animation.get();
+  job.context = &context;
+  job.output = output;
+  for (int s = 0; s <= 128; ++s) {
+    const float time = s / 128.f;
+    job.ratio = time;
+    ASSERT_TRUE(job.Run());
+    ASSERT_TRUE(SampleAnimation(raw_animation, time, expected));
+
+    for (size_t t = 0; t < raw_animation.tracks.size(); ++t) {
+      float x[4], y[4], z[4];
+      ozz::math::StorePtrU(output[t / 4].translation.x, x);
+      ozz::math::StorePtrU(output[t / 4].translation.y, y);
+      ozz::math::StorePtrU(output[t / 4].translation.z, z);
+      EXPECT_NEAR(x[t % 4], expected[t].translation.x, 2e-3f);
+      EXPECT_NEAR(y[t % 4], expected[t].translation.y, 2e-3f);
+      EXPECT_NEAR(z[t % 4], expected[t].translation.z, 2e-2f);
+    }
+  }
+}
+
+TEST(InPlace, AnimationBuilder) {
+  AnimationBuilder builder;
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.name = "long name of a big animation";
+  raw_animation.tracks.resize(5);
+  for (int i = 0; i < 10; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i / 10.f, ozz::math::Float3(static_cast<float>(i), 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+
+  // Invalid cases.
+  EXPECT_FALSE(builder(raw_animation, nullptr));
+  Animation animation;
+  RawAnimation invalid;
+  invalid.duration = -1.f;
+  EXPECT_FALSE(builder(invalid, &animation));
+  EXPECT_EQ(animation.num_tracks(), 0);
+
+  // Builds big animation.
+  ASSERT_TRUE(builder(raw_animation, &animation));
+  EXPECT_EQ(animation.num_tracks(), 5);
+  EXPECT_STREQ(animation.name(), "long name of a big animation");
+  const void* data = animation.translations().data();
+
+  // Rebuilds a smaller animation in place, reusing animation buffer.
+  raw_animation.name = "small";
+  raw_animation.tracks.resize(2);
+  raw_animation.tracks[0].translations.resize(3);
+  builder.bidirectional = true;  // Changes layout too.
+  ASSERT_TRUE(builder(raw_animation, &animation));
+  EXPECT_EQ(animation.num_tracks(), 2);
+  EXPECT_STREQ(animation.name(), "small");
+  EXPECT_EQ(animation.translations().data(), data);
+  EXPECT_TRUE(animation.bidirectional());
+
+  // Compares with a newly allocated animation.
+  ozz::unique_ptr<Animation> reference(builder(raw_animation));
+  ASSERT_TRUE(reference);
+  EXPECT_EQ(animation.size(), reference->size());
+  EXPECT_EQ(animation.translations().size(), reference->translations().size());
+  EXPECT_EQ(animation.rotations().size(), reference->rotations().size());
+  EXPECT_EQ(animation.scales().size(), reference->scales().size());
+
+  // Rebuilds without name nor bidirectional data.
+  raw_animation.name.clear();
+  builder.bidirectional = false;
+  ASSERT_TRUE(builder(raw_animation, &animation));
+  EXPECT_STREQ(animation.name(), "");
+  EXPECT_FALSE(animation.bidirectional());
+  EXPECT_EQ(animation.translations().data(), data);
+
+  // Rebuilds a bigger animation, which reallocates.
+  raw_animation.tracks.resize(40);
+  ASSERT_TRUE(builder(raw_animation, &animation));
+  EXPECT_EQ(animation.num_tracks(), 40);
+}
+
+TEST(Incremental, AnimationBuilder) {
+  AnimationBuilder builder;
+  builder.bidirectional = true;
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.name = "incremental";
+  raw_animation.tracks.resize(7);
+  for (int t = 0; t < 7; ++t) {
+    for (int i = 0; i < 10; ++i) {
+      const RawAnimation::TranslationKey key = {
+          i / 10.f, ozz::math::Float3(static_cast<float>(i * t), 0.f, 0.f)};
+      raw_animation.tracks[t].translations.push_back(key);
+    }
+  }
+
+  ozz::animation::offline::IncrementalAnimationBuilder incremental;
+  EXPECT_TRUE(incremental.done());
+  EXPECT_TRUE(incremental.Step(1));
+
+  // Invalid cases.
+  Animation animation;
+  EXPECT_FALSE(incremental.Begin(builder, raw_animation, nullptr));
+  RawAnimation invalid;
+  invalid.duration = -1.f;
+  EXPECT_FALSE(incremental.Begin(builder, invalid, &animation));
+  EXPECT_TRUE(incremental.done());
+  EXPECT_FALSE(incremental.succeeded());
+
+  // Copies 3 tracks per step, then builds. Animation is only modified by the
+  // last step.
+  ASSERT_TRUE(incremental.Begin(builder, raw_animation, &animation));
+  builder.bidirectional = false;
+  EXPECT_FLOAT_EQ(incremental.progress(), 0.f);
+  int steps = 1;
+  while (!incremental.Step(3)) {
+    EXPECT_EQ(animation.num_tracks(), 0);
+    EXPECT_LT(incremental.progress(), 1.f);
+    ++steps;
+  }
+  EXPECT_EQ(steps, 4);
+  EXPECT_TRUE(incremental.succeeded());
+  EXPECT_FLOAT_EQ(incremental.progress(), 1.f);
+
+  // Compares with a directly built animation.
+  builder.bidirectional = true;
+  ozz::unique_ptr<Animation> reference(builder(raw_animation));
+  ASSERT_TRUE(reference);
+  EXPECT_EQ(animation.num_tracks(), 7);
+  EXPECT_STREQ(animation.name(), "incremental");
+  EXPECT_TRUE(animation.bidirectional());
+  EXPECT_EQ(animation.size(), reference->size());
+  EXPECT_EQ(animation.translations().size(),
+            reference->translations().size());
+  ozz::animation::SamplingJob::Context context(7);
+  ozz::math::SoaTransform output[2], expected[2];
+  for (float ratio = 0.f; ratio <= 1.f; ratio += .15f) {
+    ozz::animation::SamplingJob job;
+    job.context = &context;
+    job.ratio = ratio;
+    job.animation = &animation;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+    job.animation = reference.get();
+    job.output = expected;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 2; ++i) {
+      float x[4], expected_x[4];
+      ozz::math::StorePtrU(output[i].translation.x, x);
+      ozz::math::StorePtrU(expected[i].translation.x, expected_x);
+      for (int j = 0; j < 4; ++j) {
+        EXPECT_FLOAT_EQ(x[j], expected_x[j]);
+      }
+    }
+  }
+
+  // Cancels a build, leaving animation unchanged.
+  raw_animation.tracks.resize(3);
+  ASSERT_TRUE(incremental.Begin(builder, raw_animation, &animation));
+  EXPECT_FALSE(incremental.Step(1));
+  incremental.Cancel();
+  EXPECT_TRUE(incremental.done());
+  EXPECT_FALSE(incremental.succeeded());
+  EXPECT_EQ(animation.num_tracks(), 7);
+}
+
+namespace {
+// Samples _animation at a few ratios and returns the concatenated poses.
+ozz::vector<ozz::math::SoaTransform> SamplePoses(const Animation& _animation) {
+  ozz::animation::SamplingJob::Context context(_animation.num_tracks());
+  ozz::vector<ozz::math::SoaTransform> poses;
+  ozz::math::SoaTransform output[2];
+  ozz::animation::SamplingJob job;
+  job.animation = &_animation;
+  job.context = &context;
+  job.output = output;
+  const float ratios[] = {0.f, .3f, .55f, 1.f, .2f};
+  for (const float ratio : ratios) {
+    job.ratio = ratio;
+    EXPECT_TRUE(job.Run());
+    poses.insert(poses.end(), output, output + 2);
+  }
+  return poses;
+}
+
+bool EqualPoses(const ozz::vector<ozz::math::SoaTransform>& _a,
+                const ozz::vector<ozz::math::SoaTransform>& _b) {
+  return _a.size() == _b.size() &&
+         std::memcmp(_a.data(), _b.data(),
+                     _a.size() * sizeof(ozz::math::SoaTransform)) == 0;
+}
+}  // namespace
+
+TEST(ShareRotations, AnimationBuilder) {
+  // Builds a base clip, and a variant for a smaller rig whose translations
+  // differ but rotations are the same.
+  RawAnimation raw_base;
+  raw_base.duration = 2.f;
+  raw_base.tracks.resize(6);
+  for (int i = 0; i < 6; ++i) {
+    const float fi = static_cast<float>(i);
+    for (int k = 0; k < 5; ++k) {
+      const float fk = static_cast<float>(k);
+      const RawAnimation::TranslationKey tkey = {
+          fk * .5f, ozz::math::Float3(fi, fk, 1.f)};
+      raw_base.tracks[i].translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          fk * .4f, ozz::math::Quaternion::FromAxisAngle(
+                        ozz::math::Float3::y_axis(), fi * .1f + fk * .3f)};
+      raw_base.tracks[i].rotations.push_back(rkey);
+    }
+  }
+  RawAnimation raw_variant = raw_base;
+  for (RawAnimation::JointTrack& track : raw_variant.tracks) {
+    for (RawAnimation::TranslationKey& key : track.translations) {
+      key.value = key.value * .8f;
+    }
+  }
+
+  AnimationBuilder builder;
+  builder.bidirectional = true;
+  builder.random_access = true;
+  ozz::unique_ptr<Animation> base(builder(raw_base));
+  ASSERT_TRUE(base);
+  ozz::unique_ptr<Animation> variant(builder(raw_variant));
+  ASSERT_TRUE(variant);
+  const ozz::vector<ozz::math::SoaTransform> expected = SamplePoses(*variant);
+  EXPECT_FALSE(EqualPoses(expected, SamplePoses(*base)));
+
+  // Rotations can't be shared with a different clip.
+  RawAnimation raw_other = raw_base;
+  raw_other.tracks[3].rotations[1].value = ozz::math::Quaternion::identity();
+  ozz::unique_ptr<Animation> other(builder(raw_other));
+  ASSERT_TRUE(other);
+  EXPECT_FALSE(variant->ShareRotations(*other));
+  EXPECT_EQ(variant->shared_rotations(), nullptr);
+
+  // Shares base rotations.
+  const size_t variant_size = variant->size();
+  EXPECT_TRUE(variant->ShareRotations(*base));
+  EXPECT_EQ(variant->shared_rotations(), base.get());
+  EXPECT_EQ(variant->rotations().data(),
+            base->rotations().data());
+  EXPECT_EQ(variant->rotation_track_index().data(),
+            base->rotation_track_index().data());
+  EXPECT_EQ(variant->rotation_previouses().data(),
+            base->rotation_previouses().data());
+  EXPECT_LT(variant->size(), variant_size);
+  EXPECT_TRUE(EqualPoses(expected, SamplePoses(*variant)));
+
+  // Sharing with a variant shares with the owner.
+  ozz::unique_ptr<Animation> variant2(builder(raw_variant));
+  ASSERT_TRUE(variant2);
+  EXPECT_TRUE(variant2->ShareRotations(*variant));
+  EXPECT_EQ(variant2->shared_rotations(), base.get());
+  EXPECT_TRUE(EqualPoses(expected, SamplePoses(*variant2)));
+
+  // Moving keeps sharing.
+  Animation moved(std::move(*variant2));
+  EXPECT_EQ(moved.shared_rotations(), base.get());
+  EXPECT_EQ(variant2->shared_rotations(), nullptr);
+  EXPECT_TRUE(EqualPoses(expected, SamplePoses(moved)));
+
+  // Images are self-contained.
+  ozz::vector<ozz::math::SimdFloat4> image(
+      (variant->image_size() + sizeof(ozz::math::SimdFloat4) - 1) /
+      sizeof(ozz::math::SimdFloat4));
+  const ozz::span<ozz::byte> image_bytes(
+      reinterpret_cast<ozz::byte*>(image.data()), variant->image_size());
+  ASSERT_TRUE(variant->ToImage(image_bytes));
+  Animation from_image;
+  ASSERT_TRUE(from_image.FromImage(image_bytes));
+  EXPECT_EQ(from_image.shared_rotations(), nullptr);
+  EXPECT_TRUE(EqualPoses(expected, SamplePoses(from_image)));
+
+  // Rebuilding resets sharing.
+  ASSERT_TRUE(builder(raw_variant, variant.get()));
+  EXPECT_EQ(variant->shared_rotations(), nullptr);
+  EXPECT_NE(variant->rotations().data(),
+            base->rotations().data());
+  EXPECT_TRUE(EqualPoses(expected, SamplePoses(*variant)));
+}
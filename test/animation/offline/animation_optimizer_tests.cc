@@ -27,6 +27,9 @@
 
 #include "ozz/animation/offline/animation_optimizer.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include "gtest/gtest.h"
 
 #include "ozz/base/maths/math_constant.h"
@@ -34,13 +37,24 @@
 #include "ozz/base/memory/unique_ptr.h"
 
 #include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/animation_validator.h"
 #include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
 
 #include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/raw_track.h"
 #include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/offline/track_optimizer.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/gtest_parallel_for_helper.h"
+#include "ozz/base/maths/soa_transform.h"
 
+using ozz::animation::Animation;
+using ozz::animation::SamplingJob;
 using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
 using ozz::animation::offline::AnimationOptimizer;
 using ozz::animation::offline::RawAnimation;
 using ozz::animation::offline::RawSkeleton;
@@ -670,3 +684,506 @@ TEST(OptimizeOverride, AnimationOptimizer) {
     input.tracks[4].scales.clear();
   }
 }
+
+TEST(OptimizeCubic, AnimationOptimizer) {
+  // Prepares a skeleton.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  SkeletonBuilder skeleton_builder;
+  ozz::unique_ptr<Skeleton> skeleton(skeleton_builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+
+  // Smooth translation and scale curves, densely sampled.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(1);
+  const int kNumKeys = 41;
+  for (int i = 0; i < kNumKeys; ++i) {
+    const float time = i / (kNumKeys - 1.f);
+    const float sine = std::sin(time * ozz::math::k2Pi);
+    const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(sine, 0.f, 1.f - sine)};
+    input.tracks[0].translations.push_back(tkey);
+    const RawAnimation::ScaleKey skey = {
+        time, ozz::math::Float3(1.f + sine * .5f, 1.f, 1.f)};
+    input.tracks[0].scales.push_back(skey);
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  optimizer.setting.tolerance = 1e-2f;
+  optimizer.setting.distance = 1.f;
+
+  RawAnimation linear;
+  ASSERT_TRUE(optimizer(input, *skeleton, &linear));
+
+  optimizer.cubic_interpolation = true;
+  RawAnimation cubic;
+  ASSERT_TRUE(optimizer(input, *skeleton, &cubic));
+
+  // Cubic curves need less keys, still keeping first and last ones.
+  const RawAnimation::JointTrack::Translations& translations =
+      cubic.tracks[0].translations;
+  EXPECT_LT(translations.size(), linear.tracks[0].translations.size());
+  EXPECT_LT(cubic.tracks[0].scales.size(), linear.tracks[0].scales.size());
+  ASSERT_GE(translations.size(), 2u);
+  EXPECT_FLOAT_EQ(translations.front().time, 0.f);
+  EXPECT_FLOAT_EQ(translations.back().time, 1.f);
+
+  // Runtime cubic animation remains within tolerance (plus keys
+  // quantization error).
+  AnimationBuilder builder;
+  builder.cubic_interpolation = true;
+  ozz::unique_ptr<Animation> animation(builder(cubic));
+  ASSERT_TRUE(animation);
+
+  SamplingJob::Context context(1, true);
+  ozz::math::SoaTransform output[1];
+  SamplingJob job;
+  job.animation = animation.get();
+  job.context = &context;
+  job.output = output;
+  for (int i = 0; i < kNumKeys; ++i) {
+    const RawAnimation::TranslationKey& key = input.tracks[0].translations[i];
+    job.ratio = key.time;
+    ASSERT_TRUE(job.Run());
+    float x[4], z[4];
+    ozz::math::StorePtrU(output[0].translation.x, x);
+    ozz::math::StorePtrU(output[0].translation.z, z);
+    EXPECT_NEAR(x[0], key.value.x, 2e-2f);
+    EXPECT_NEAR(z[0], key.value.z, 2e-2f);
+  }
+}
+
+TEST(OptimizeFitting, AnimationOptimizer) {
+  // Prepares a skeleton.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  SkeletonBuilder skeleton_builder;
+  ozz::unique_ptr<Skeleton> skeleton(skeleton_builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+
+  // Noisy curves, as motion capture data.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(1);
+  const int kNumKeys = 61;
+  for (int i = 0; i < kNumKeys; ++i) {
+    const float time = i / (kNumKeys - 1.f);
+    const float noise = (i & 1 ? 1.f : -1.f) * 4e-3f;
+    const float sine = std::sin(time * ozz::math::k2Pi);
+    const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(sine + noise, 0.f, time * 2.f - noise)};
+    input.tracks[0].translations.push_back(tkey);
+    const RawAnimation::RotationKey rkey = {
+        time, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                   sine + noise)};
+    input.tracks[0].rotations.push_back(rkey);
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  optimizer.setting.tolerance = 1e-2f;
+  optimizer.setting.distance = 1.f;
+
+  RawAnimation decimated;
+  ASSERT_TRUE(optimizer(input, *skeleton, &decimated));
+
+  optimizer.reduction = AnimationOptimizer::kFitting;
+  for (int c = 0; c < 2; ++c) {
+    optimizer.cubic_interpolation = c != 0;
+
+    RawAnimation fitted;
+    ASSERT_TRUE(optimizer(input, *skeleton, &fitted));
+    EXPECT_LT(fitted.tracks[0].translations.size(),
+              decimated.tracks[0].translations.size());
+    EXPECT_LT(fitted.tracks[0].rotations.size(),
+              decimated.tracks[0].rotations.size());
+
+    // Linear fitted curves remain within tolerance.
+    if (!optimizer.cubic_interpolation) {
+      for (int i = 0; i < kNumKeys; ++i) {
+        const RawAnimation::TranslationKey& key =
+            input.tracks[0].translations[i];
+        ozz::math::Transform transform;
+        ASSERT_TRUE(ozz::animation::offline::SampleTrack(fitted.tracks[0],
+                                                         key.time, &transform));
+        EXPECT_LE(Length(transform.translation - key.value), 1e-2f + 1e-5f);
+      }
+    }
+  }
+}
+
+TEST(OptimizeLevels, AnimationOptimizer) {
+  // Prepares a skeleton.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(1);
+  SkeletonBuilder skeleton_builder;
+  ozz::unique_ptr<Skeleton> skeleton(skeleton_builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+
+  // Noisy curves, with noise amplitude between levels tolerances.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(2);
+  const int kNumKeys = 61;
+  for (int i = 0; i < kNumKeys; ++i) {
+    const float time = i / (kNumKeys - 1.f);
+    const float noise = (i & 1 ? 1.f : -1.f) * 3e-3f;
+    const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(time + noise, 0.f, 0.f)};
+    input.tracks[0].translations.push_back(tkey);
+    input.tracks[1].translations.push_back(tkey);
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  optimizer.setting.tolerance = 1e-3f;
+  // Second joint is twice as precise.
+  optimizer.joints_setting_override[1] =
+      AnimationOptimizer::Setting(5e-4f, optimizer.setting.distance);
+
+  const float tolerances[] = {1e-3f, 1e-2f, 2e-2f};
+  RawAnimation levels[3];
+
+  // Invalid arguments.
+  EXPECT_FALSE(optimizer(input, *skeleton, tolerances, {levels, 2}));
+  const float negative[] = {-1.f};
+  EXPECT_FALSE(optimizer(input, *skeleton, negative, levels));
+
+  ASSERT_TRUE(optimizer(input, *skeleton, tolerances, levels));
+
+  // Every level matches a single optimization with the same setting.
+  for (int i = 0; i < 3; ++i) {
+    AnimationOptimizer single = optimizer;
+    single.setting.tolerance = tolerances[i];
+    single.joints_setting_override[1].tolerance = tolerances[i] * .5f;
+    RawAnimation expected;
+    ASSERT_TRUE(single(input, *skeleton, &expected));
+    for (int t = 0; t < 2; ++t) {
+      EXPECT_EQ(levels[i].tracks[t].translations.size(),
+                expected.tracks[t].translations.size());
+    }
+  }
+
+  // Finest level keeps the noise, coarsest one removes it.
+  EXPECT_EQ(levels[0].tracks[0].translations.size(),
+            static_cast<size_t>(kNumKeys));
+  EXPECT_LT(levels[1].tracks[0].translations.size(),
+            levels[0].tracks[0].translations.size());
+  EXPECT_EQ(levels[2].tracks[0].translations.size(), 2u);
+  EXPECT_EQ(levels[2].tracks[1].translations.size(), 2u);
+}
+
+TEST(Dense, AnimationOptimizer) {
+  // Prepares a single joint skeleton.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  SkeletonBuilder skeleton_builder;
+  ozz::unique_ptr<Skeleton> skeleton(skeleton_builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+
+  // Dense noisy keys, so that decimation visits segments of any length.
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(1);
+  ozz::animation::offline::RawFloat3Track float3_input;
+  const int kNumKeys = 241;
+  for (int i = 0; i < kNumKeys; ++i) {
+    const float time = i / (kNumKeys - 1.f);
+    const float noise = ((i * 7919) % 13 - 6) * 2e-4f;
+    const ozz::math::Float3 value(std::sin(time * 7.f) + noise,
+                                  std::cos(time * 3.f) * .5f, noise);
+    const RawAnimation::TranslationKey tkey = {time, value};
+    input.tracks[0].translations.push_back(tkey);
+    const ozz::animation::offline::RawFloat3Track::Keyframe fkey = {
+        ozz::animation::offline::RawTrackInterpolation::kLinear, time, value};
+    float3_input.keyframes.push_back(fkey);
+    const RawAnimation::RotationKey rkey = {
+        time, ozz::math::Quaternion::FromAxisAngle(
+                  ozz::math::Float3::y_axis(),
+                  std::sin(time * 5.f) * 2.f + noise * 10.f)};
+    input.tracks[0].rotations.push_back(rkey);
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  RawAnimation output;
+  ASSERT_TRUE(optimizer(input, *skeleton, &output));
+  const RawAnimation::JointTrack& track = output.tracks[0];
+
+  // Translations must be decimated exactly like the (scalar) track optimizer
+  // does, as distances are computed the same way for a root joint.
+  ozz::animation::offline::TrackOptimizer track_optimizer;
+  track_optimizer.tolerance = optimizer.setting.tolerance;
+  ozz::animation::offline::RawFloat3Track float3_output;
+  ASSERT_TRUE(track_optimizer(float3_input, &float3_output));
+  EXPECT_LT(track.translations.size(), float3_input.keyframes.size());
+  ASSERT_EQ(track.translations.size(), float3_output.keyframes.size());
+  for (size_t i = 0; i < track.translations.size(); ++i) {
+    EXPECT_EQ(track.translations[i].time, float3_output.keyframes[i].ratio);
+  }
+
+  // All input rotations are within tolerance of the decimated track, measured
+  // at setting distance.
+  EXPECT_LT(track.rotations.size(), input.tracks[0].rotations.size());
+  for (const RawAnimation::RotationKey& key : input.tracks[0].rotations) {
+    ozz::math::Transform transform;
+    ASSERT_TRUE(
+        ozz::animation::offline::SampleTrack(track, key.time, &transform));
+    const float cos_half_angle =
+        std::min(1.f, std::abs(Dot(transform.rotation, key.value)));
+    const float distance = 2.f *
+                           std::sqrt(1.f - cos_half_angle * cos_half_angle) *
+                           optimizer.setting.distance;
+    EXPECT_LE(distance, optimizer.setting.tolerance * 1.01f);
+  }
+}
+
+namespace {
+// Counts all keys of _animation.
+size_t CountKeys(const RawAnimation& _animation) {
+  size_t count = 0;
+  for (const RawAnimation::JointTrack& track : _animation.tracks) {
+    count += track.translations.size() + track.rotations.size() +
+             track.scales.size();
+  }
+  return count;
+}
+}  // namespace
+
+TEST(ErrorBudget, AnimationOptimizer) {
+  // Prepares a skeleton: root, spine, chest, then arm and hand, plus head.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& spine = raw_skeleton.roots[0];
+  spine.children.resize(1);
+  RawSkeleton::Joint& chest = spine.children[0];
+  chest.children.resize(1);
+  chest.children[0].children.resize(2);
+  chest.children[0].children[0].children.resize(1);
+  SkeletonBuilder skeleton_builder;
+  ozz::unique_ptr<Skeleton> skeleton(skeleton_builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+  ASSERT_EQ(num_joints, 6);
+
+  // Noisy rotations, around 20cm bones.
+  RawAnimation input;
+  input.duration = 2.f;
+  input.tracks.resize(num_joints);
+  const int kNumKeys = 121;
+  for (int j = 0; j < num_joints; ++j) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      const float time = input.duration * i / (kNumKeys - 1.f);
+      const float noise = ((i * 7919 + j * 104729) % 17 - 8) * 4e-4f;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(0.f, .2f, 0.f)};
+      input.tracks[j].translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::z_axis(),
+                    std::sin(time * (j + 2.f)) * .5f + noise)};
+      input.tracks[j].rotations.push_back(rkey);
+    }
+  }
+  ASSERT_TRUE(input.Validate());
+
+  // Uniform tolerance bounding end effectors error to the budget, as chains
+  // have up to 5 joints.
+  const float kBudget = 1e-2f;
+  AnimationOptimizer optimizer;
+  optimizer.setting.tolerance = kBudget / 5.f;
+  RawAnimation uniform;
+  ASSERT_TRUE(optimizer(input, *skeleton, &uniform));
+
+  optimizer.error_budget = kBudget;
+  RawAnimation budget;
+  ASSERT_TRUE(optimizer(input, *skeleton, &budget));
+  EXPECT_LT(CountKeys(budget), CountKeys(uniform));
+
+  // Measures end effectors error.
+  AnimationBuilder animation_builder;
+  ozz::unique_ptr<Animation> animation(animation_builder(budget));
+  ASSERT_TRUE(animation);
+  ozz::animation::offline::AnimationValidator validator;
+  validator.setting.tolerance = kBudget;
+  ozz::animation::offline::AnimationValidator::Report report;
+  ASSERT_TRUE(validator(input, *animation, *skeleton, &report));
+  EXPECT_EQ(report.num_joints_over_tolerance, 0);
+
+  // Setting tolerances are ignored.
+  optimizer.setting.tolerance = 1.f;
+  RawAnimation ignored;
+  ASSERT_TRUE(optimizer(input, *skeleton, &ignored));
+  EXPECT_EQ(CountKeys(ignored), CountKeys(budget));
+
+  // Levels of detail scale the budget.
+  const float tolerances[] = {kBudget, kBudget * 4.f};
+  RawAnimation levels[2];
+  ASSERT_TRUE(optimizer(input, *skeleton, tolerances, levels));
+  EXPECT_EQ(CountKeys(levels[0]), CountKeys(budget));
+  EXPECT_LT(CountKeys(levels[1]), CountKeys(levels[0]));
+
+  // Parallel and incremental optimizations give the same result.
+  int tasks = 0;
+  optimizer.parallel_for = &ReverseParallelFor;
+  optimizer.parallel_for_user_data = &tasks;
+  RawAnimation parallel;
+  ASSERT_TRUE(optimizer(input, *skeleton, &parallel));
+  EXPECT_EQ(CountKeys(parallel), CountKeys(budget));
+  EXPECT_GT(tasks, num_joints);
+
+  ozz::animation::offline::IncrementalAnimationOptimizer incremental;
+  RawAnimation stepped;
+  ASSERT_TRUE(incremental.Begin(optimizer, input, *skeleton, &stepped));
+  while (!incremental.Step(2)) {
+  }
+  EXPECT_TRUE(incremental.succeeded());
+  EXPECT_EQ(CountKeys(stepped), CountKeys(budget));
+}
+
+TEST(ParallelFor, AnimationOptimizer) {
+  // Prepares a skeleton.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(2);
+  SkeletonBuilder skeleton_builder;
+  ozz::unique_ptr<Skeleton> skeleton(skeleton_builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+
+  RawAnimation input;
+  input.duration = 1.f;
+  input.tracks.resize(3);
+  const int kNumKeys = 31;
+  for (int t = 0; t < 3; ++t) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      const float time = i / (kNumKeys - 1.f);
+      const float noise = (i % (t + 2) ? 1.f : -1.f) * 2e-3f;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(std::sin(time * 3.f) + noise, 0.f, 0.f)};
+      input.tracks[t].translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::y_axis(), time * t + noise)};
+      input.tracks[t].rotations.push_back(rkey);
+    }
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  RawAnimation serial;
+  ASSERT_TRUE(optimizer(input, *skeleton, &serial));
+
+  int tasks = 0;
+  optimizer.parallel_for = &ReverseParallelFor;
+  optimizer.parallel_for_user_data = &tasks;
+  RawAnimation parallel;
+  ASSERT_TRUE(optimizer(input, *skeleton, &parallel));
+  EXPECT_EQ(tasks, 3);
+
+  ASSERT_EQ(parallel.num_tracks(), 3);
+  for (int t = 0; t < 3; ++t) {
+    const RawAnimation::JointTrack& a = serial.tracks[t];
+    const RawAnimation::JointTrack& b = parallel.tracks[t];
+    ASSERT_EQ(a.translations.size(), b.translations.size());
+    for (size_t k = 0; k < a.translations.size(); ++k) {
+      EXPECT_EQ(a.translations[k].time, b.translations[k].time);
+    }
+    ASSERT_EQ(a.rotations.size(), b.rotations.size());
+    for (size_t k = 0; k < a.rotations.size(); ++k) {
+      EXPECT_EQ(a.rotations[k].time, b.rotations[k].time);
+    }
+  }
+
+  // Levels of detail tracks are all tasks.
+  tasks = 0;
+  const float tolerances[] = {1e-3f, 1e-2f};
+  RawAnimation levels[2];
+  ASSERT_TRUE(optimizer(input, *skeleton, tolerances, levels));
+  EXPECT_EQ(tasks, 6);
+  EXPECT_EQ(levels[0].tracks[2].translations.size(),
+            serial.tracks[2].translations.size());
+}
+
+TEST(Incremental, AnimationOptimizer) {
+  // Prepares a skeleton.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(4);
+  SkeletonBuilder skeleton_builder;
+  ozz::unique_ptr<Skeleton> skeleton(skeleton_builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+
+  RawAnimation input;
+  input.name = "incremental";
+  input.duration = 1.f;
+  input.tracks.resize(5);
+  const int kNumKeys = 31;
+  for (int t = 0; t < 5; ++t) {
+    for (int i = 0; i < kNumKeys; ++i) {
+      const float time = i / (kNumKeys - 1.f);
+      const float noise = (i % (t + 2) ? 1.f : -1.f) * 2e-3f;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(std::sin(time * 3.f) + noise, 0.f, 0.f)};
+      input.tracks[t].translations.push_back(tkey);
+    }
+  }
+  ASSERT_TRUE(input.Validate());
+
+  AnimationOptimizer optimizer;
+  ozz::animation::offline::IncrementalAnimationOptimizer incremental;
+  EXPECT_TRUE(incremental.done());
+  EXPECT_FALSE(incremental.succeeded());
+  EXPECT_TRUE(incremental.Step(1));
+
+  {  // Invalid inputs.
+    RawAnimation output;
+    EXPECT_FALSE(incremental.Begin(optimizer, input, *skeleton, nullptr));
+    RawAnimation invalid;
+    invalid.duration = -1.f;
+    EXPECT_FALSE(incremental.Begin(optimizer, invalid, *skeleton, &output));
+    EXPECT_FALSE(incremental.Begin(optimizer, input, Skeleton(), &output));
+    EXPECT_TRUE(incremental.done());
+    EXPECT_FALSE(incremental.succeeded());
+    EXPECT_FLOAT_EQ(incremental.progress(), 0.f);
+  }
+
+  RawAnimation reference;
+  ASSERT_TRUE(optimizer(input, *skeleton, &reference));
+
+  // Optimizes 2 tracks per step, settings being copied by Begin().
+  RawAnimation output;
+  ASSERT_TRUE(incremental.Begin(optimizer, input, *skeleton, &output));
+  optimizer.setting.tolerance = 1.f;
+  EXPECT_FALSE(incremental.done());
+  EXPECT_FLOAT_EQ(incremental.progress(), 0.f);
+  EXPECT_FALSE(incremental.Step(2));
+  EXPECT_FLOAT_EQ(incremental.progress(), .4f);
+  EXPECT_FALSE(incremental.Step(2));
+  EXPECT_FLOAT_EQ(incremental.progress(), .8f);
+  EXPECT_TRUE(incremental.Step(2));
+  EXPECT_TRUE(incremental.done());
+  EXPECT_TRUE(incremental.succeeded());
+  EXPECT_FLOAT_EQ(incremental.progress(), 1.f);
+
+  EXPECT_EQ(output.name, "incremental");
+  ASSERT_EQ(output.num_tracks(), 5);
+  for (int t = 0; t < 5; ++t) {
+    const RawAnimation::JointTrack& a = reference.tracks[t];
+    const RawAnimation::JointTrack& b = output.tracks[t];
+    ASSERT_EQ(a.translations.size(), b.translations.size());
+    for (size_t k = 0; k < a.translations.size(); ++k) {
+      EXPECT_EQ(a.translations[k].time, b.translations[k].time);
+    }
+  }
+
+  // Cancels an optimization.
+  ASSERT_TRUE(incremental.Begin(optimizer, input, *skeleton, &output));
+  EXPECT_FALSE(incremental.Step(0));
+  EXPECT_FLOAT_EQ(incremental.progress(), .2f);
+  incremental.Cancel();
+  EXPECT_TRUE(incremental.done());
+  EXPECT_FALSE(incremental.succeeded());
+}
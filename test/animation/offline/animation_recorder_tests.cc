@@ -0,0 +1,182 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/animation_recorder.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingJob;
+using ozz::animation::offline::AnimationRecorder;
+
+namespace {
+// Computes the recorded pose of 5 tracks at time _time. Track 0 translates
+// along a sine curve, track 1 rotates at a constant speed, others are linear.
+void ComputePose(float _time, ozz::math::SoaTransform _pose[2]) {
+  const float angle = _time * 2.f;
+  const ozz::math::Quaternion q =
+      ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(), angle);
+  for (int i = 0; i < 2; ++i) {
+    _pose[i] = ozz::math::SoaTransform::identity();
+  }
+  _pose[0].translation = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(std::sin(_time * 6.f), _time, _time * 2.f,
+                                   _time * 3.f),
+      ozz::math::simd_float4::zero(), ozz::math::simd_float4::zero());
+  _pose[0].rotation = ozz::math::SoaQuaternion::Load(
+      ozz::math::simd_float4::zero(),
+      ozz::math::simd_float4::Load(0.f, q.y, 0.f, 0.f),
+      ozz::math::simd_float4::zero(),
+      ozz::math::simd_float4::Load(1.f, q.w, 1.f, 1.f));
+  _pose[1].translation = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load1(_time * 4.f),
+      ozz::math::simd_float4::zero(), ozz::math::simd_float4::zero());
+}
+}  // namespace
+
+TEST(Error, AnimationRecorder) {
+  AnimationRecorder recorder;
+  ozz::math::SoaTransform pose[2];
+  ComputePose(0.f, pose);
+  Animation animation;
+
+  // Not started.
+  EXPECT_FALSE(recorder.Record(0.f, pose));
+  EXPECT_FALSE(recorder.Build(&animation));
+
+  recorder.Start(5);
+
+  // Pose too small.
+  EXPECT_FALSE(recorder.Record(0.f, ozz::make_span(pose).first(1)));
+  EXPECT_EQ(recorder.num_frames(), 0);
+
+  EXPECT_TRUE(recorder.Record(0.f, pose));
+
+  // Not enough frames.
+  EXPECT_FALSE(recorder.Build(&animation));
+
+  // Time must be increasing.
+  EXPECT_FALSE(recorder.Record(0.f, pose));
+  EXPECT_FALSE(recorder.Record(-1.f, pose));
+  EXPECT_EQ(recorder.num_frames(), 1);
+
+  EXPECT_TRUE(recorder.Record(1.f, pose));
+  EXPECT_TRUE(recorder.Build(&animation));
+  EXPECT_EQ(animation.num_tracks(), 5);
+  EXPECT_FLOAT_EQ(animation.duration(), 1.f);
+}
+
+TEST(Record, AnimationRecorder) {
+  AnimationRecorder recorder;
+  recorder.Start(5, "recorded");
+
+  // Records 1s at 120 fps, starting at an arbitrary time.
+  const int kFrames = 121;
+  const float kStart = 10.f;
+  ozz::math::SoaTransform pose[2];
+  for (int i = 0; i < kFrames; ++i) {
+    const float time = i / (kFrames - 1.f);
+    ComputePose(time, pose);
+    ASSERT_TRUE(recorder.Record(kStart + time, pose));
+  }
+  EXPECT_EQ(recorder.num_frames(), kFrames);
+
+  Animation animation;
+  ASSERT_TRUE(recorder.Build(&animation));
+  EXPECT_STREQ(animation.name(), "recorded");
+  EXPECT_NEAR(animation.duration(), 1.f, 1e-5f);
+
+  // Linear and constant tracks are decimated to their 2 extreme keys, only
+  // track 0 translation and track 1 rotation need more.
+  const size_t keys = recorder.num_keys();
+  EXPECT_LT(keys, static_cast<size_t>(5 * 3 * kFrames / 4));
+  EXPECT_GE(keys, static_cast<size_t>(5 * 3 * 2));
+
+  // Sampled animation matches recorded poses.
+  SamplingJob::Context context(5);
+  ozz::math::SoaTransform output[2];
+  SamplingJob job;
+  job.animation = &animation;
+  job.context = &context;
+  job.output = output;
+  for (int i = 0; i < kFrames; ++i) {
+    const float time = i / (kFrames - 1.f);
+    ComputePose(time, pose);
+    job.ratio = time;
+    ASSERT_TRUE(job.Run());
+    for (int s = 0; s < 2; ++s) {
+      float expected[4], actual[4];
+      ozz::math::StorePtrU(pose[s].translation.x, expected);
+      ozz::math::StorePtrU(output[s].translation.x, actual);
+      for (int j = 0; j < 4 && s * 4 + j < 5; ++j) {
+        EXPECT_NEAR(expected[j], actual[j], 2e-3f);
+      }
+      ozz::math::StorePtrU(pose[s].rotation.y, expected);
+      ozz::math::StorePtrU(output[s].rotation.y, actual);
+      for (int j = 0; j < 4 && s * 4 + j < 5; ++j) {
+        EXPECT_NEAR(std::abs(expected[j]), std::abs(actual[j]), 2e-3f);
+      }
+    }
+  }
+
+  // Recording can go on after building.
+  ComputePose(1.5f, pose);
+  EXPECT_TRUE(recorder.Record(kStart + 1.5f, pose));
+  ASSERT_TRUE(recorder.Build(&animation));
+  EXPECT_NEAR(animation.duration(), 1.5f, 1e-5f);
+}
+
+TEST(Latency, AnimationRecorder) {
+  AnimationRecorder recorder;
+  recorder.max_latency = 4;
+  recorder.Start(1);
+
+  // A constant pose is still keyed every max_latency frames.
+  ozz::math::SoaTransform pose[1] = {ozz::math::SoaTransform::identity()};
+  for (int i = 0; i < 41; ++i) {
+    ASSERT_TRUE(recorder.Record(i * .1f, pose));
+  }
+  Animation animation;
+  ASSERT_TRUE(recorder.Build(&animation));
+  EXPECT_EQ(recorder.num_keys(), static_cast<size_t>(3 * 11));
+
+  // Without latency constraint, only extreme keys remain.
+  recorder.max_latency = 1000;
+  recorder.Start(1);
+  for (int i = 0; i < 41; ++i) {
+    ASSERT_TRUE(recorder.Record(i * .1f, pose));
+  }
+  ASSERT_TRUE(recorder.Build(&animation));
+  EXPECT_EQ(recorder.num_keys(), static_cast<size_t>(3 * 2));
+}
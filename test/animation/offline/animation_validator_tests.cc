@@ -0,0 +1,239 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/animation_validator.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/gtest_parallel_for_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::AnimationOptimizer;
+using ozz::animation::offline::AnimationValidator;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 2 joints skeleton, child is 1m away from its parent along x.
+ozz::unique_ptr<Skeleton> BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].transform.translation =
+      ozz::math::Float3::x_axis();
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Root rotates a quarter turn around z, with a key every 1/30s.
+RawAnimation BuildRawAnimation() {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  for (int i = 0; i <= 30; ++i) {
+    const float time = i / 30.f;
+    const float angle = ozz::math::kPi_2 * time * time;
+    const RawAnimation::RotationKey key = {
+        time, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::z_axis(),
+                                                   angle)};
+    raw_animation.tracks[0].rotations.push_back(key);
+  }
+  const RawAnimation::TranslationKey child = {0.f,
+                                              ozz::math::Float3::x_axis()};
+  raw_animation.tracks[1].translations.push_back(child);
+  return raw_animation;
+}
+
+}  // namespace
+
+TEST(Error, AnimationValidator) {
+  const ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  const RawAnimation raw_animation = BuildRawAnimation();
+  AnimationBuilder builder;
+  const ozz::unique_ptr<Animation> animation = builder(raw_animation);
+  ASSERT_TRUE(animation);
+
+  AnimationValidator validator;
+  AnimationValidator::Report report;
+
+  {  // Invalid raw animation.
+    RawAnimation invalid = raw_animation;
+    invalid.duration = 0.f;
+    EXPECT_FALSE(validator(invalid, *animation, *skeleton, &report));
+    EXPECT_EQ(report.joints.size(), 0u);
+  }
+
+  {  // Tracks count mismatch.
+    RawAnimation smaller = raw_animation;
+    smaller.tracks.resize(1);
+    const ozz::unique_ptr<Animation> smaller_animation = builder(smaller);
+    ASSERT_TRUE(smaller_animation);
+    EXPECT_FALSE(validator(smaller, *smaller_animation, *skeleton, &report));
+    EXPECT_FALSE(validator(raw_animation, *smaller_animation, *skeleton,
+                           &report));
+  }
+
+  {  // Invalid frequency.
+    AnimationValidator zero;
+    zero.frequency = 0.f;
+    EXPECT_FALSE(zero(raw_animation, *animation, *skeleton, &report));
+  }
+
+  {  // Reports too small.
+    const AnimationValidator::Clip clips[] = {
+        {&raw_animation, animation.get()}};
+    EXPECT_FALSE(validator(clips, *skeleton,
+                           ozz::span<AnimationValidator::Report>()));
+  }
+
+  {  // nullptr report.
+    EXPECT_FALSE(validator(raw_animation, *animation, *skeleton, nullptr));
+  }
+}
+
+TEST(Validate, AnimationValidator) {
+  const ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  const RawAnimation raw_animation = BuildRawAnimation();
+  AnimationBuilder builder;
+  AnimationValidator validator;
+
+  {  // Built from the source, only quantization error remains.
+    const ozz::unique_ptr<Animation> animation = builder(raw_animation);
+    ASSERT_TRUE(animation);
+    AnimationValidator::Report report;
+    ASSERT_TRUE(validator(raw_animation, *animation, *skeleton, &report));
+    EXPECT_EQ(report.num_frames, 31);
+    ASSERT_EQ(report.joints.size(), 2u);
+    EXPECT_EQ(report.num_joints_over_tolerance, 0);
+    for (size_t i = 0; i < report.joints.size(); ++i) {
+      EXPECT_LT(report.joints[i].max, 1e-3f);
+      EXPECT_LE(report.joints[i].percentile, report.joints[i].max);
+      EXPECT_FLOAT_EQ(report.joints[i].tolerance, 1e-3f);
+    }
+  }
+
+  // Degraded animation, only keeping first and last keys.
+  RawAnimation degraded = raw_animation;
+  RawAnimation::JointTrack::Rotations& rotations = degraded.tracks[0].rotations;
+  rotations.erase(rotations.begin() + 1, rotations.end() - 1);
+  const ozz::unique_ptr<Animation> animation = builder(degraded);
+  ASSERT_TRUE(animation);
+
+  AnimationValidator::Report report;
+  ASSERT_TRUE(validator(raw_animation, *animation, *skeleton, &report));
+  ASSERT_EQ(report.joints.size(), 2u);
+  EXPECT_EQ(report.num_joints_over_tolerance, 2);
+
+  // Child is 1m away, so its error is far bigger than root one measured at
+  // 10cm.
+  EXPECT_EQ(report.worst_joint, 1);
+  EXPECT_GT(report.joints[1].max, report.joints[0].max * 5.f);
+  EXPECT_LE(report.joints[1].percentile, report.joints[1].max);
+  EXPECT_GT(report.joints[1].max_time, 0.f);
+  EXPECT_LT(report.joints[1].max_time, 1.f);
+
+  // Extremes keys match.
+  AnimationValidator min_validator;
+  min_validator.percentile = 0.f;
+  ASSERT_TRUE(min_validator(raw_animation, *animation, *skeleton, &report));
+  EXPECT_LT(report.joints[1].percentile, 1e-3f);
+
+  // Joint override.
+  AnimationValidator override_validator;
+  override_validator.joints_setting_override[0] =
+      AnimationOptimizer::Setting(1.f, 0.f);
+  override_validator.joints_setting_override[1] =
+      AnimationOptimizer::Setting(1.f, 0.f);
+  ASSERT_TRUE(
+      override_validator(raw_animation, *animation, *skeleton, &report));
+  EXPECT_EQ(report.num_joints_over_tolerance, 0);
+  EXPECT_FLOAT_EQ(report.joints[0].tolerance, 1.f);
+  EXPECT_LT(report.joints[0].max, 1e-3f);  // Measured at the joint.
+}
+
+TEST(ParallelFor, AnimationValidator) {
+  const ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  const RawAnimation raw_animation = BuildRawAnimation();
+  RawAnimation degraded = raw_animation;
+  RawAnimation::JointTrack::Rotations& rotations = degraded.tracks[0].rotations;
+  rotations.erase(rotations.begin() + 1, rotations.end() - 1);
+
+  AnimationBuilder builder;
+  const ozz::unique_ptr<Animation> animation = builder(raw_animation);
+  const ozz::unique_ptr<Animation> degraded_animation = builder(degraded);
+  ASSERT_TRUE(animation && degraded_animation);
+
+  AnimationValidator validator;
+  int tasks = 0;
+  validator.parallel_for = &ReverseParallelFor;
+  validator.parallel_for_user_data = &tasks;
+
+  const AnimationValidator::Clip clips[] = {
+      {&raw_animation, animation.get()},
+      {&raw_animation, degraded_animation.get()},
+      {&degraded, degraded_animation.get()}};
+  AnimationValidator::Report reports[3];
+  ASSERT_TRUE(validator(clips, *skeleton, reports));
+  EXPECT_EQ(tasks, 3);
+
+  for (int i = 0; i < 3; ++i) {
+    AnimationValidator::Report expected;
+    ASSERT_TRUE(validator(*clips[i].raw_animation, *clips[i].animation,
+                          *skeleton, &expected));
+    EXPECT_EQ(reports[i].num_joints_over_tolerance,
+              expected.num_joints_over_tolerance);
+    ASSERT_EQ(reports[i].joints.size(), expected.joints.size());
+    for (size_t j = 0; j < expected.joints.size(); ++j) {
+      EXPECT_FLOAT_EQ(reports[i].joints[j].max, expected.joints[j].max);
+      EXPECT_FLOAT_EQ(reports[i].joints[j].percentile,
+                      expected.joints[j].percentile);
+    }
+  }
+  EXPECT_EQ(reports[0].num_joints_over_tolerance, 0);
+  EXPECT_EQ(reports[1].num_joints_over_tolerance, 2);
+  EXPECT_EQ(reports[2].num_joints_over_tolerance, 0);
+
+  // A missing animation fails, but others are still validated.
+  const AnimationValidator::Clip invalid_clips[] = {
+      {&raw_animation, nullptr}, {&raw_animation, animation.get()}};
+  ASSERT_FALSE(validator(invalid_clips, *skeleton, reports));
+  EXPECT_EQ(reports[0].joints.size(), 0u);
+  EXPECT_EQ(reports[1].joints.size(), 2u);
+}
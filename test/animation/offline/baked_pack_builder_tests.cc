@@ -0,0 +1,252 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/baked_pack_builder.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/raw_track.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/offline/track_builder.h"
+#include "ozz/animation/runtime/baked_pack.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/track_sampling_job.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::BakedPack;
+using ozz::animation::FloatTrack;
+using ozz::animation::FloatTrackSamplingJob;
+using ozz::animation::QuaternionTrack;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::BakedPackBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawFloatTrack;
+using ozz::animation::offline::RawQuaternionTrack;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::RawTrackInterpolation;
+using ozz::animation::offline::SkeletonBuilder;
+using ozz::animation::offline::TrackBuilder;
+
+namespace {
+ozz::unique_ptr<Skeleton> BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(2);
+  raw_skeleton.roots[0].children[0].name = "child0";
+  raw_skeleton.roots[0].children[1].name = "child1";
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+ozz::unique_ptr<Animation> BuildAnimation(const char* _name, float _x) {
+  RawAnimation raw_animation;
+  raw_animation.name = _name;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(3);
+  const RawAnimation::TranslationKey key = {0.f,
+                                            ozz::math::Float3(_x, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(key);
+  return AnimationBuilder()(raw_animation);
+}
+
+ozz::unique_ptr<FloatTrack> BuildFloatTrack(const char* _name, float _value) {
+  RawFloatTrack raw_track;
+  raw_track.name = _name;
+  const RawFloatTrack::Keyframe key = {RawTrackInterpolation::kLinear, 0.f,
+                                       _value};
+  raw_track.keyframes.push_back(key);
+  return TrackBuilder()(raw_track);
+}
+
+// Allocates an aligned image buffer.
+ozz::span<ozz::byte> AllocateImage(size_t _size) {
+  return {static_cast<ozz::byte*>(ozz::memory::default_allocator()->Allocate(
+              _size, BakedPack::kImageAlignment)),
+          _size};
+}
+}  // namespace
+
+TEST(Error, BakedPackBuilder) {
+  const ozz::unique_ptr<Animation> animation = BuildAnimation("anim", 1.f);
+  ASSERT_TRUE(animation);
+
+  BakedPackBuilder builder;
+  builder.animations.push_back(animation.get());
+  const size_t size = builder.image_size();
+  EXPECT_EQ(size % BakedPack::kImageAlignment, 0u);
+  ozz::span<ozz::byte> image = AllocateImage(size + BakedPack::kImageAlignment);
+
+  // Invalid buffers.
+  EXPECT_FALSE(builder({image.data(), size - 1}));
+  EXPECT_FALSE(builder({image.data() + 1, size}));
+  EXPECT_FALSE(builder(static_cast<ozz::io::Stream*>(nullptr)));
+  ASSERT_TRUE(builder({image.data(), size}));
+
+  {  // Invalid images.
+    BakedPack pack;
+    EXPECT_FALSE(pack.FromImage({image.data(), size - 1}));
+    EXPECT_FALSE(pack.FromImage({image.data() + 1, size}));
+    EXPECT_FALSE(pack.FromImage({image.data(), 4}));
+
+    image[0] = static_cast<ozz::byte>(~image[0]);
+    EXPECT_FALSE(pack.FromImage({image.data(), size}));
+    image[0] = static_cast<ozz::byte>(~image[0]);
+
+    // Corrupted entry image.
+    BakedPack::Entry entry;
+    ozz::byte* entry_image = image.data() + sizeof(BakedPack::Header);
+    std::memcpy(&entry, entry_image, sizeof(entry));
+    image[entry.offset] = static_cast<ozz::byte>(~image[entry.offset]);
+    EXPECT_FALSE(pack.FromImage({image.data(), size}));
+    image[entry.offset] = static_cast<ozz::byte>(~image[entry.offset]);
+
+    // Invalid entry type.
+    entry.type = BakedPack::kTypeCount;
+    std::memcpy(entry_image, &entry, sizeof(entry));
+    EXPECT_FALSE(pack.FromImage({image.data(), size}));
+    EXPECT_EQ(pack.animations().size(), 0u);
+  }
+
+  ozz::memory::default_allocator()->Deallocate(image.data());
+
+  // nullptr objects can't be baked.
+  builder.animations.push_back(nullptr);
+  EXPECT_EQ(builder.image_size(), 0u);
+  ozz::io::MemoryStream stream;
+  EXPECT_FALSE(builder(&stream));
+}
+
+TEST(Empty, BakedPackBuilder) {
+  BakedPackBuilder builder;
+  const size_t size = builder.image_size();
+  EXPECT_EQ(size, sizeof(BakedPack::Header));
+
+  ozz::span<ozz::byte> image = AllocateImage(size);
+  ASSERT_TRUE(builder(image));
+
+  BakedPack pack;
+  ASSERT_TRUE(pack.FromImage(image));
+  EXPECT_TRUE(pack.skeleton() == nullptr);
+  EXPECT_EQ(pack.animations().size(), 0u);
+  EXPECT_EQ(pack.float_tracks().size(), 0u);
+
+  ozz::memory::default_allocator()->Deallocate(image.data());
+}
+
+TEST(Bake, BakedPackBuilder) {
+  const ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  const ozz::unique_ptr<Animation> animation0 = BuildAnimation("anim0", 1.f);
+  ASSERT_TRUE(animation0);
+  const ozz::unique_ptr<Animation> animation1 = BuildAnimation("anim1", 2.f);
+  ASSERT_TRUE(animation1);
+  const ozz::unique_ptr<FloatTrack> track = BuildFloatTrack("track", 46.f);
+  ASSERT_TRUE(track);
+  const QuaternionTrack quaternion_track;
+
+  BakedPackBuilder builder;
+  builder.skeleton = skeleton.get();
+  builder.animations.push_back(animation0.get());
+  builder.animations.push_back(animation1.get());
+  builder.float_tracks.push_back(track.get());
+  builder.quaternion_tracks.push_back(&quaternion_track);
+
+  // Bakes to a stream, at a non zero position.
+  ozz::io::MemoryStream stream;
+  const uint32_t prefix = 46;
+  ASSERT_EQ(stream.Write(&prefix, sizeof(prefix)), sizeof(prefix));
+  ASSERT_TRUE(builder(&stream));
+  EXPECT_EQ(stream.Size(), sizeof(prefix) + builder.image_size());
+
+  BakedPack pack;
+  EXPECT_FALSE(pack.Load(nullptr));
+  EXPECT_FALSE(pack.Load(&stream));  // Stream is at its end.
+
+  stream.Seek(sizeof(prefix), ozz::io::Stream::kSet);
+  ASSERT_TRUE(pack.Load(&stream));
+
+  ASSERT_TRUE(pack.skeleton() != nullptr);
+  EXPECT_EQ(pack.skeleton()->num_joints(), 3);
+  EXPECT_STREQ(pack.skeleton()->joint_names()[1], "child0");
+
+  ASSERT_EQ(pack.animations().size(), 2u);
+  EXPECT_STREQ(pack.animations()[0].name(), "anim0");
+  EXPECT_STREQ(pack.animations()[1].name(), "anim1");
+  EXPECT_EQ(pack.FindAnimation("anim1"), &pack.animations()[1]);
+  EXPECT_TRUE(pack.FindAnimation("anim2") == nullptr);
+
+  ASSERT_EQ(pack.float_tracks().size(), 1u);
+  EXPECT_STREQ(pack.float_tracks()[0].name(), "track");
+  EXPECT_EQ(pack.float2_tracks().size(), 0u);
+  EXPECT_EQ(pack.float3_tracks().size(), 0u);
+  EXPECT_EQ(pack.float4_tracks().size(), 0u);
+  EXPECT_EQ(pack.quaternion_tracks().size(), 1u);
+
+  {  // Samples baked objects.
+    SamplingJob::Context context(pack.animations()[1].num_tracks());
+    ozz::math::SoaTransform output[1];
+    SamplingJob sampling;
+    sampling.animation = &pack.animations()[1];
+    sampling.context = &context;
+    sampling.ratio = .5f;
+    sampling.output = output;
+    ASSERT_TRUE(sampling.Run());
+    EXPECT_SIMDFLOAT_EQ(output[0].translation.x, 2.f, 0.f, 0.f, 0.f);
+
+    FloatTrackSamplingJob track_sampling;
+    float result;
+    track_sampling.track = &pack.float_tracks()[0];
+    track_sampling.ratio = .5f;
+    track_sampling.result = &result;
+    ASSERT_TRUE(track_sampling.Run());
+    EXPECT_FLOAT_EQ(result, 46.f);
+  }
+
+  // Reloading releases previous objects.
+  ozz::span<ozz::byte> image = AllocateImage(builder.image_size());
+  builder.animations.pop_back();
+  ASSERT_TRUE(builder(image));
+  ASSERT_TRUE(pack.FromImage(image));
+  EXPECT_EQ(pack.animations().size(), 1u);
+  EXPECT_EQ(pack.float_tracks().size(), 1u);
+
+  pack.Reset();
+  EXPECT_TRUE(pack.skeleton() == nullptr);
+  EXPECT_EQ(pack.animations().size(), 0u);
+  ozz::memory::default_allocator()->Deallocate(image.data());
+}
@@ -0,0 +1,341 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/feature_database_builder.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/feature_database.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::FeatureDatabase;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::FeatureDatabaseBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Animation keys are compressed, so features are compared with a tolerance.
+const float kTolerance = 2e-3f;
+
+// Builds a 2 joints skeleton.
+ozz::unique_ptr<Skeleton> BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.children.resize(1);
+  root.children[0].name = "child";
+  root.children[0].transform = ozz::math::Transform::identity();
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+// Builds a 1s animation, moving root forward (z) by _distance, whose child is
+// 1 unit above root.
+ozz::unique_ptr<Animation> BuildWalk(float _distance) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  const RawAnimation::TranslationKey first = {0.f, ozz::math::Float3::zero()};
+  const RawAnimation::TranslationKey last = {
+      1.f, ozz::math::Float3(0.f, 0.f, _distance)};
+  raw_animation.tracks[0].translations.push_back(first);
+  raw_animation.tracks[0].translations.push_back(last);
+  const RawAnimation::TranslationKey child = {0.f,
+                                              ozz::math::Float3::y_axis()};
+  raw_animation.tracks[1].translations.push_back(child);
+  return AnimationBuilder()(raw_animation);
+}
+
+// Builds a builder extracting child position and velocity, and trajectory at
+// .5s.
+FeatureDatabaseBuilder BuildBuilder() {
+  FeatureDatabaseBuilder builder;
+  builder.sample_rate = 10.f;
+  const FeatureDatabaseBuilder::JointFeature feature = {1, 1.f, 1.f};
+  builder.joints.push_back(feature);
+  builder.trajectory_times.push_back(.5f);
+  return builder;
+}
+}  // namespace
+
+TEST(Error, FeatureDatabaseBuilder) {
+  const ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  const ozz::unique_ptr<Animation> animation = BuildWalk(3.f);
+  ASSERT_TRUE(skeleton && animation);
+  const Animation* animations[] = {animation.get()};
+
+  {  // Valid.
+    EXPECT_TRUE(BuildBuilder()(*skeleton, animations));
+  }
+
+  {  // No animation.
+    EXPECT_TRUE(
+        BuildBuilder()(*skeleton, ozz::span<const Animation* const>()));
+  }
+
+  {  // Invalid sample rate.
+    FeatureDatabaseBuilder builder = BuildBuilder();
+    builder.sample_rate = 0.f;
+    EXPECT_FALSE(builder(*skeleton, animations));
+  }
+
+  {  // Invalid root joint.
+    FeatureDatabaseBuilder builder = BuildBuilder();
+    builder.root_joint = 2;
+    EXPECT_FALSE(builder(*skeleton, animations));
+  }
+
+  {  // Invalid feature joint.
+    FeatureDatabaseBuilder builder = BuildBuilder();
+    builder.joints[0].joint = -1;
+    EXPECT_FALSE(builder(*skeleton, animations));
+  }
+
+  {  // Invalid trajectory time.
+    FeatureDatabaseBuilder builder = BuildBuilder();
+    builder.trajectory_times[0] = -1.f;
+    EXPECT_FALSE(builder(*skeleton, animations));
+  }
+
+  {  // No feature.
+    FeatureDatabaseBuilder builder;
+    EXPECT_FALSE(builder(*skeleton, animations));
+    builder.joints = BuildBuilder().joints;
+    builder.joints[0].position_weight = 0.f;
+    builder.joints[0].velocity_weight = 0.f;
+    EXPECT_FALSE(builder(*skeleton, animations));
+  }
+
+  {  // Null animation.
+    const Animation* nulls[] = {animation.get(), nullptr};
+    EXPECT_FALSE(BuildBuilder()(*skeleton, nulls));
+  }
+
+  {  // Skeleton mismatch.
+    EXPECT_FALSE(BuildBuilder()(Skeleton(), animations));
+  }
+}
+
+TEST(Features, FeatureDatabaseBuilder) {
+  const ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  const ozz::unique_ptr<Animation> animation = BuildWalk(3.f);
+  ASSERT_TRUE(skeleton && animation);
+  const Animation* animations[] = {animation.get()};
+
+  const ozz::unique_ptr<FeatureDatabase> database =
+      BuildBuilder()(*skeleton, animations);
+  ASSERT_TRUE(database);
+  EXPECT_EQ(database->num_features(), 10);
+  EXPECT_EQ(database->num_frames(), 11);
+  EXPECT_EQ(database->num_blocks(), 3);
+  ASSERT_EQ(database->num_clips(), 1);
+  EXPECT_EQ(database->clips()[0].first_frame, 0);
+  EXPECT_EQ(database->clips()[0].num_frames, 11);
+  EXPECT_FLOAT_EQ(database->clips()[0].duration, 1.f);
+
+  float raw[10];
+  EXPECT_FALSE(database->GetFeatures(11, raw));
+  EXPECT_FALSE(database->GetFeatures(0, ozz::span<float>(raw, 9)));
+
+  for (int i = 0; i < database->num_frames(); ++i) {
+    ASSERT_TRUE(database->GetFeatures(i, raw));
+    // Child position and velocity.
+    EXPECT_NEAR(raw[0], 0.f, kTolerance);
+    EXPECT_NEAR(raw[1], 1.f, kTolerance);
+    EXPECT_NEAR(raw[2], 0.f, kTolerance);
+    EXPECT_NEAR(raw[3], 0.f, kTolerance);
+    EXPECT_NEAR(raw[4], 0.f, kTolerance);
+    EXPECT_NEAR(raw[5], 3.f, kTolerance);
+    // Trajectory position, clamped to the last frame.
+    const int future = ozz::math::Min(i + 5, 10);
+    EXPECT_NEAR(raw[6], 0.f, kTolerance);
+    EXPECT_NEAR(raw[7], (future - i) * .3f, kTolerance);
+    // Trajectory direction.
+    EXPECT_NEAR(raw[8], 0.f, kTolerance);
+    EXPECT_NEAR(raw[9], 1.f, kTolerance);
+
+    // Normalized features are stored in SoA blocks.
+    float normalized[10];
+    ASSERT_TRUE(database->Normalize(raw, normalized));
+    const ozz::span<const ozz::math::SimdFloat4> block =
+        database->block(i / 4);
+    ASSERT_EQ(block.size(), 10u);
+    for (int f = 0; f < 10; ++f) {
+      float lanes[4];
+      ozz::math::StorePtrU(block[f], lanes);
+      EXPECT_NEAR(lanes[i & 3], normalized[f], 1e-5f);
+    }
+  }
+
+  // Unused lanes of the last block are zeroed.
+  for (const ozz::math::SimdFloat4& value : database->block(2)) {
+    EXPECT_EQ(ozz::math::GetW(value), 0.f);
+  }
+  EXPECT_EQ(database->block(3).size(), 0u);
+
+  // Boxes bound normalized features.
+  ASSERT_EQ(database->small_boxes().size(), 20u);
+  ASSERT_EQ(database->large_boxes().size(), 20u);
+  for (int f = 0; f < 10; ++f) {
+    EXPECT_LE(database->small_boxes()[f], database->small_boxes()[10 + f]);
+  }
+}
+
+TEST(Heading, FeatureDatabaseBuilder) {
+  const ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+
+  // Root is turned a quarter around y, and moved on x. Child is in front of
+  // root.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  const RawAnimation::TranslationKey root_translation = {
+      0.f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(root_translation);
+  const RawAnimation::RotationKey root_rotation = {
+      0.f, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                ozz::math::kPi_2)};
+  raw_animation.tracks[0].rotations.push_back(root_rotation);
+  const RawAnimation::TranslationKey child = {0.f,
+                                              ozz::math::Float3::z_axis()};
+  raw_animation.tracks[1].translations.push_back(child);
+  const ozz::unique_ptr<Animation> animation =
+      AnimationBuilder()(raw_animation);
+  ASSERT_TRUE(animation);
+  const Animation* animations[] = {animation.get()};
+
+  FeatureDatabaseBuilder builder = BuildBuilder();
+  builder.joints[0].velocity_weight = 0.f;
+  builder.trajectory_position_weight = 0.f;
+  const ozz::unique_ptr<FeatureDatabase> database =
+      builder(*skeleton, animations);
+  ASSERT_TRUE(database);
+  ASSERT_EQ(database->num_features(), 5);
+
+  float raw[5];
+  ASSERT_TRUE(database->GetFeatures(3, raw));
+  EXPECT_NEAR(raw[0], 0.f, kTolerance);
+  EXPECT_NEAR(raw[1], 0.f, kTolerance);
+  EXPECT_NEAR(raw[2], 1.f, kTolerance);
+  EXPECT_NEAR(raw[3], 0.f, kTolerance);
+  EXPECT_NEAR(raw[4], 1.f, kTolerance);
+}
+
+TEST(Clips, FeatureDatabaseBuilder) {
+  const ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  const ozz::unique_ptr<Animation> walk = BuildWalk(3.f);
+  const ozz::unique_ptr<Animation> run = BuildWalk(6.f);
+  ASSERT_TRUE(skeleton && walk && run);
+  const Animation* animations[] = {walk.get(), run.get()};
+
+  const ozz::unique_ptr<FeatureDatabase> database =
+      BuildBuilder()(*skeleton, animations);
+  ASSERT_TRUE(database);
+  EXPECT_EQ(database->num_frames(), 22);
+  ASSERT_EQ(database->num_clips(), 2);
+  EXPECT_EQ(database->clips()[1].first_frame, 11);
+  EXPECT_EQ(database->clips()[1].num_frames, 11);
+
+  EXPECT_EQ(database->clip(-1), -1);
+  EXPECT_EQ(database->clip(0), 0);
+  EXPECT_EQ(database->clip(10), 0);
+  EXPECT_EQ(database->clip(11), 1);
+  EXPECT_EQ(database->clip(21), 1);
+  EXPECT_EQ(database->clip(22), -1);
+
+  EXPECT_FLOAT_EQ(database->ratio(0), 0.f);
+  EXPECT_FLOAT_EQ(database->ratio(5), .5f);
+  EXPECT_FLOAT_EQ(database->ratio(10), 1.f);
+  EXPECT_FLOAT_EQ(database->ratio(14), .3f);
+  EXPECT_FLOAT_EQ(database->ratio(22), 0.f);
+
+  EXPECT_EQ(database->frame(-1, 0.f), -1);
+  EXPECT_EQ(database->frame(2, 0.f), -1);
+  EXPECT_EQ(database->frame(0, 0.f), 0);
+  EXPECT_EQ(database->frame(0, .5f), 5);
+  EXPECT_EQ(database->frame(1, .3f), 14);
+  EXPECT_EQ(database->frame(1, 2.f), 21);
+
+  // Run velocity is twice walk one.
+  float raw[10];
+  ASSERT_TRUE(database->GetFeatures(14, raw));
+  EXPECT_NEAR(raw[5], 6.f, kTolerance);
+}
+
+TEST(Archive, FeatureDatabaseBuilder) {
+  const ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  const ozz::unique_ptr<Animation> walk = BuildWalk(3.f);
+  const ozz::unique_ptr<Animation> run = BuildWalk(6.f);
+  ASSERT_TRUE(skeleton && walk && run);
+  const Animation* animations[] = {walk.get(), run.get()};
+
+  const ozz::unique_ptr<FeatureDatabase> database =
+      BuildBuilder()(*skeleton, animations);
+  ASSERT_TRUE(database);
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *database;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  FeatureDatabase loaded;
+  i >> loaded;
+
+  EXPECT_EQ(loaded.num_features(), database->num_features());
+  EXPECT_EQ(loaded.num_frames(), database->num_frames());
+  EXPECT_EQ(loaded.num_clips(), database->num_clips());
+  EXPECT_FLOAT_EQ(loaded.sample_rate(), database->sample_rate());
+  EXPECT_EQ(loaded.clip(14), 1);
+  ASSERT_EQ(loaded.small_boxes().size(), database->small_boxes().size());
+  for (size_t b = 0; b < loaded.small_boxes().size(); ++b) {
+    EXPECT_FLOAT_EQ(loaded.small_boxes()[b], database->small_boxes()[b]);
+  }
+  for (int f = 0; f < loaded.num_frames(); ++f) {
+    float expected[10], actual[10];
+    ASSERT_TRUE(database->GetFeatures(f, expected));
+    ASSERT_TRUE(loaded.GetFeatures(f, actual));
+    for (int j = 0; j < 10; ++j) {
+      EXPECT_FLOAT_EQ(actual[j], expected[j]);
+    }
+  }
+}
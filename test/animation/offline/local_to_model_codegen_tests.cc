@@ -0,0 +1,167 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/local_to_model_codegen.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/local_to_model_registry.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::FindLocalToModel;
+using ozz::animation::HashSkeletonHierarchy;
+using ozz::animation::LocalToModelRegistrar;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::LocalToModelCodegen;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton with a root and _num_children children. Root is named
+// _root_name.
+ozz::unique_ptr<Skeleton> BuildSkeleton(const char* _root_name,
+                                        int _num_children) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = _root_name;
+  root.children.resize(_num_children);
+  for (int i = 0; i < _num_children; ++i) {
+    root.children[i].name = "child";
+    root.children[i].name += static_cast<char>('0' + i);
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+void DummyLocalToModel(ozz::span<const ozz::math::SoaTransform>,
+                       const ozz::math::Float4x4&,
+                       ozz::span<ozz::math::Float4x4>) {}
+}  // namespace
+
+TEST(Hash, LocalToModelCodegen) {
+  ozz::unique_ptr<Skeleton> skeleton0 = BuildSkeleton("root", 2);
+  ozz::unique_ptr<Skeleton> skeleton1 = BuildSkeleton("other_root", 2);
+  ozz::unique_ptr<Skeleton> skeleton2 = BuildSkeleton("root", 3);
+  ASSERT_TRUE(skeleton0 && skeleton1 && skeleton2);
+
+  // Names don't matter, hierarchy does.
+  EXPECT_EQ(HashSkeletonHierarchy(*skeleton0),
+            HashSkeletonHierarchy(*skeleton1));
+  EXPECT_NE(HashSkeletonHierarchy(*skeleton0),
+            HashSkeletonHierarchy(*skeleton2));
+}
+
+TEST(Registry, LocalToModelCodegen) {
+  ozz::unique_ptr<Skeleton> skeleton0 = BuildSkeleton("root", 2);
+  ozz::unique_ptr<Skeleton> skeleton1 = BuildSkeleton("root", 3);
+  ASSERT_TRUE(skeleton0 && skeleton1);
+
+  EXPECT_TRUE(FindLocalToModel(*skeleton0) == nullptr);
+  {
+    const LocalToModelRegistrar registrar(HashSkeletonHierarchy(*skeleton0),
+                                          skeleton0->num_joints(),
+                                          &DummyLocalToModel);
+    EXPECT_TRUE(FindLocalToModel(*skeleton0) == &DummyLocalToModel);
+    EXPECT_TRUE(FindLocalToModel(*skeleton1) == nullptr);
+
+    // Number of joints must match also.
+    const LocalToModelRegistrar mismatch(HashSkeletonHierarchy(*skeleton1),
+                                         skeleton1->num_joints() + 1,
+                                         &DummyLocalToModel);
+    EXPECT_TRUE(FindLocalToModel(*skeleton1) == nullptr);
+  }
+  // Unregistered.
+  EXPECT_TRUE(FindLocalToModel(*skeleton0) == nullptr);
+}
+
+TEST(Generate, LocalToModelCodegen) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton("root", 4);
+  ASSERT_TRUE(skeleton);
+
+  LocalToModelCodegen codegen;
+  ozz::string source;
+  ASSERT_TRUE(codegen(*skeleton, &source));
+
+  // Parents are baked, 2 SoA joints are converted.
+  EXPECT_TRUE(std::strstr(source.c_str(), "void LocalToModel("));
+  EXPECT_TRUE(std::strstr(source.c_str(), "out[0] = _root * l[0];"));
+  EXPECT_TRUE(std::strstr(source.c_str(), "out[3] = out[0] * l[3];"));
+  EXPECT_TRUE(std::strstr(source.c_str(), "out[4] = out[0] * l[0];"));
+  EXPECT_TRUE(std::strstr(source.c_str(), "SoaTransformToMatrices(in[1], l)"));
+  EXPECT_FALSE(std::strstr(source.c_str(), "SoaTransformToMatrices(in[2]"));
+  EXPECT_FALSE(std::strstr(source.c_str(), "Palette"));
+
+  char registration[128];
+  std::snprintf(registration, sizeof(registration), "0x%08xu, 5, &LocalToModel",
+                HashSkeletonHierarchy(*skeleton));
+  EXPECT_TRUE(std::strstr(source.c_str(), registration));
+
+  // Palette, without registration.
+  const uint16_t remaps[] = {4, 1};
+  codegen.name = "Hero";
+  codegen.joint_remaps = remaps;
+  codegen.register_function = false;
+  ASSERT_TRUE(codegen(*skeleton, &source));
+  EXPECT_TRUE(std::strstr(source.c_str(), "void Hero("));
+  EXPECT_TRUE(std::strstr(source.c_str(), "void HeroPalette("));
+  EXPECT_TRUE(std::strstr(source.c_str(), "out[0] = models[4] * ibp[0];"));
+  EXPECT_TRUE(std::strstr(source.c_str(), "out[1] = models[1] * ibp[1];"));
+  EXPECT_FALSE(std::strstr(source.c_str(), "Registrar"));
+}
+
+TEST(Invalid, LocalToModelCodegen) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton("root", 1);
+  ASSERT_TRUE(skeleton);
+
+  LocalToModelCodegen codegen;
+  ozz::string source;
+  EXPECT_FALSE(codegen(*skeleton, nullptr));
+
+  // Empty skeleton.
+  EXPECT_FALSE(codegen(Skeleton(), &source));
+
+  // Invalid names.
+  codegen.name = "";
+  EXPECT_FALSE(codegen(*skeleton, &source));
+  codegen.name = "0name";
+  EXPECT_FALSE(codegen(*skeleton, &source));
+  codegen.name = "na-me";
+  EXPECT_FALSE(codegen(*skeleton, &source));
+  codegen.name = "_name0";
+  EXPECT_TRUE(codegen(*skeleton, &source));
+
+  // Remap out of range.
+  const uint16_t remaps[] = {0, 2};
+  codegen.joint_remaps = remaps;
+  EXPECT_FALSE(codegen(*skeleton, &source));
+}
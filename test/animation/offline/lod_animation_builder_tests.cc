@@ -0,0 +1,158 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/lod_animation_builder.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/lod_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::LODAnimation;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::LODAnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a single joint skeleton, and a matching animation whose translation
+// noise amplitude is 3mm.
+void BuildInputs(ozz::unique_ptr<Skeleton>* _skeleton,
+                 RawAnimation* _animation) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  SkeletonBuilder skeleton_builder;
+  *_skeleton = skeleton_builder(raw_skeleton);
+
+  _animation->duration = 1.f;
+  _animation->tracks.resize(1);
+  const int kNumKeys = 61;
+  for (int i = 0; i < kNumKeys; ++i) {
+    const float time = i / (kNumKeys - 1.f);
+    const float noise = (i & 1 ? 1.f : -1.f) * 3e-3f;
+    const RawAnimation::TranslationKey key = {
+        time, ozz::math::Float3(time + noise, 0.f, 0.f)};
+    _animation->tracks[0].translations.push_back(key);
+  }
+}
+}  // namespace
+
+TEST(Error, LODAnimationBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton;
+  RawAnimation input;
+  BuildInputs(&skeleton, &input);
+  ASSERT_TRUE(skeleton);
+
+  {  // Invalid raw animation.
+    LODAnimationBuilder builder;
+    RawAnimation invalid;
+    invalid.duration = -1.f;
+    EXPECT_FALSE(builder(invalid, *skeleton));
+  }
+
+  {  // Skeleton mismatch.
+    LODAnimationBuilder builder;
+    EXPECT_FALSE(builder(input, Skeleton()));
+  }
+
+  {  // No level.
+    LODAnimationBuilder builder;
+    builder.tolerances.clear();
+    EXPECT_FALSE(builder(input, *skeleton));
+  }
+
+  {  // Tolerances not increasing.
+    LODAnimationBuilder builder;
+    builder.tolerances[1] = builder.tolerances[0];
+    EXPECT_FALSE(builder(input, *skeleton));
+  }
+}
+
+TEST(Build, LODAnimationBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton;
+  RawAnimation input;
+  BuildInputs(&skeleton, &input);
+  ASSERT_TRUE(skeleton);
+
+  LODAnimationBuilder builder;
+  ozz::unique_ptr<LODAnimation> animation = builder(input, *skeleton);
+  ASSERT_TRUE(animation);
+  ASSERT_EQ(animation->num_levels(), 3);
+  ASSERT_EQ(animation->tolerances().size(), 3u);
+  EXPECT_FLOAT_EQ(animation->tolerances()[0], 1e-3f);
+  EXPECT_FLOAT_EQ(animation->tolerances()[2], 2e-2f);
+
+  // Coarser levels are smaller.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FLOAT_EQ(animation->level(i).duration(), 1.f);
+    EXPECT_EQ(animation->level(i).num_tracks(), 1);
+  }
+  EXPECT_GT(animation->level(0).size(), animation->level(1).size());
+  EXPECT_GT(animation->size(), animation->level(0).size());
+
+  // Levels selection.
+  EXPECT_EQ(animation->SelectLevel(0.f), 0);
+  EXPECT_EQ(animation->SelectLevel(1e-3f), 0);
+  EXPECT_EQ(animation->SelectLevel(4e-3f), 0);
+  EXPECT_EQ(animation->SelectLevel(5e-3f), 1);
+  EXPECT_EQ(animation->SelectLevel(1.f), 2);
+  EXPECT_EQ(LODAnimation().SelectLevel(1.f), -1);
+}
+
+TEST(Archive, LODAnimationBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton;
+  RawAnimation input;
+  BuildInputs(&skeleton, &input);
+  ASSERT_TRUE(skeleton);
+
+  LODAnimationBuilder builder;
+  ozz::unique_ptr<LODAnimation> animation = builder(input, *skeleton);
+  ASSERT_TRUE(animation);
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *animation;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  LODAnimation loaded;
+  i >> loaded;
+
+  ASSERT_EQ(loaded.num_levels(), animation->num_levels());
+  for (int l = 0; l < loaded.num_levels(); ++l) {
+    EXPECT_FLOAT_EQ(loaded.tolerances()[l], animation->tolerances()[l]);
+    EXPECT_EQ(loaded.level(l).size(), animation->level(l).size());
+    EXPECT_EQ(loaded.level(l).num_tracks(), 1);
+  }
+}
@@ -0,0 +1,276 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/mirror_map_builder.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/mirror_job.h"
+#include "ozz/animation/runtime/mirror_map.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::MirrorJob;
+using ozz::animation::MirrorMap;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::MirrorMapBuilder;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Appends a chain of joints named _names to _joints.
+void AddChain(RawSkeleton::Joint::Children* _joints, const char** _names,
+              int _count) {
+  _joints->resize(_joints->size() + 1);
+  RawSkeleton::Joint& joint = _joints->back();
+  joint.name = _names[0];
+  if (_count > 1) {
+    AddChain(&joint.children, _names + 1, _count - 1);
+  }
+}
+
+// Builds the following skeleton, depth-first ordered:
+// 0 root
+// 1  spine
+// 2   neck
+// 3    head
+// 4  arm_l
+// 5   forearm_l
+// 6    hand_l
+// 7     finger_l
+// 8  arm_r
+// 9   forearm_r
+// 10   hand_r
+// 11    finger_r
+// 12 LeftLeg
+// 13 RightLeg
+ozz::unique_ptr<Skeleton> BuildSkeleton(
+    Skeleton::NameStorage _storage = Skeleton::kNameStrings) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  const char* spine[] = {"spine", "neck", "head"};
+  AddChain(&root.children, spine, 3);
+  const char* left_arm[] = {"arm_l", "forearm_l", "hand_l", "finger_l"};
+  AddChain(&root.children, left_arm, 4);
+  const char* right_arm[] = {"arm_r", "forearm_r", "hand_r", "finger_r"};
+  AddChain(&root.children, right_arm, 4);
+  const char* left_leg[] = {"LeftLeg"};
+  AddChain(&root.children, left_leg, 1);
+  const char* right_leg[] = {"RightLeg"};
+  AddChain(&root.children, right_leg, 1);
+
+  ozz::unique_ptr<Skeleton> skeleton =
+      ozz::make_unique<Skeleton>(nullptr, _storage);
+  SkeletonBuilder builder;
+  if (!builder(raw_skeleton, skeleton.get())) {
+    return nullptr;
+  }
+  return skeleton;
+}
+}  // namespace
+
+TEST(Error, MirrorMapBuilder) {
+  MirrorMapBuilder builder;
+
+  {  // Names strings are required.
+    ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton(Skeleton::kNameHashes);
+    ASSERT_TRUE(skeleton);
+    EXPECT_FALSE(builder(*skeleton));
+  }
+
+  {  // Ambiguous pairs, "forearm_l" would be paired with "arm_l" too.
+    ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+    ASSERT_TRUE(skeleton);
+    const MirrorMapBuilder::Pattern pattern = {"forearm_l", "arm_r"};
+    builder.patterns.insert(builder.patterns.begin(), pattern);
+    EXPECT_FALSE(builder(*skeleton));
+  }
+
+  {  // Empty skeleton.
+    Skeleton empty;
+    MirrorMapBuilder default_builder;
+    ozz::unique_ptr<MirrorMap> map = default_builder(empty);
+    ASSERT_TRUE(map);
+    EXPECT_EQ(map->num_joints(), 0);
+  }
+}
+
+TEST(Build, MirrorMapBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  ASSERT_EQ(skeleton->num_joints(), 14);
+
+  MirrorMapBuilder builder;
+
+  {  // Default patterns.
+    ozz::unique_ptr<MirrorMap> map = builder(*skeleton);
+    ASSERT_TRUE(map);
+    EXPECT_EQ(map->axis(), MirrorMap::kX);
+    ASSERT_EQ(map->num_joints(), 14);
+    const int16_t expected[] = {0, 1, 2,  3,  8,  9,  10,
+                                11, 4, 5, 6, 7, 13, 12};
+    for (int i = 0; i < 14; ++i) {
+      EXPECT_EQ(map->joint_remaps()[i], expected[i]);
+    }
+    ASSERT_EQ(map->soa_remaps().size(), 4u);
+    EXPECT_EQ(map->soa_remaps()[0], 0);
+    EXPECT_EQ(map->soa_remaps()[1], 2);
+    EXPECT_EQ(map->soa_remaps()[2], 1);
+    EXPECT_EQ(map->soa_remaps()[3], -1);
+  }
+
+  {  // Custom patterns and axis.
+    builder.axis = MirrorMap::kZ;
+    builder.patterns.resize(1);
+    builder.patterns[0].left = "Left";
+    builder.patterns[0].right = "Right";
+    ozz::unique_ptr<MirrorMap> map = builder(*skeleton);
+    ASSERT_TRUE(map);
+    EXPECT_EQ(map->axis(), MirrorMap::kZ);
+    const int16_t expected[] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 12};
+    for (int i = 0; i < 14; ++i) {
+      EXPECT_EQ(map->joint_remaps()[i], expected[i]);
+    }
+  }
+}
+
+TEST(Archive, MirrorMapBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+
+  MirrorMapBuilder builder;
+  builder.axis = MirrorMap::kY;
+  ozz::unique_ptr<MirrorMap> map = builder(*skeleton);
+  ASSERT_TRUE(map);
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *map;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  MirrorMap loaded;
+  i >> loaded;
+
+  EXPECT_EQ(loaded.axis(), MirrorMap::kY);
+  ASSERT_EQ(loaded.num_joints(), map->num_joints());
+  for (int j = 0; j < map->num_joints(); ++j) {
+    EXPECT_EQ(loaded.joint_remaps()[j], map->joint_remaps()[j]);
+  }
+  ASSERT_EQ(loaded.soa_remaps().size(), map->soa_remaps().size());
+  for (size_t j = 0; j < map->soa_remaps().size(); ++j) {
+    EXPECT_EQ(loaded.soa_remaps()[j], map->soa_remaps()[j]);
+  }
+}
+
+TEST(Job, MirrorMapBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+
+  // Transform components are set to a function of joint index.
+  ozz::math::SoaTransform input[4];
+  for (int i = 0; i < 4; ++i) {
+    const float base = i * 4.f;
+    const ozz::math::SimdFloat4 index = ozz::math::simd_float4::Load(
+        base, base + 1.f, base + 2.f, base + 3.f);
+    const ozz::math::SimdFloat4 one = ozz::math::simd_float4::one();
+    input[i].translation = ozz::math::SoaFloat3::Load(index, index + one,
+                                                      index + one + one);
+    input[i].rotation = ozz::math::SoaQuaternion::Load(
+        -index, index * index, one - index, index + index);
+    input[i].scale = ozz::math::SoaFloat3::Load(one, index, one);
+  }
+  ozz::math::SoaTransform output[4];
+
+  const MirrorMap::Axis axes[] = {MirrorMap::kX, MirrorMap::kY,
+                                  MirrorMap::kZ};
+  for (const MirrorMap::Axis axis : axes) {
+    MirrorMapBuilder builder;
+    builder.axis = axis;
+    ozz::unique_ptr<MirrorMap> map = builder(*skeleton);
+    ASSERT_TRUE(map);
+
+    MirrorJob job;
+    EXPECT_FALSE(job.Validate());
+    job.map = map.get();
+    job.input = input;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+
+    {  // Too small buffers.
+      MirrorJob invalid = job;
+      invalid.input = ozz::make_span(input).first(3);
+      EXPECT_FALSE(invalid.Validate());
+      invalid = job;
+      invalid.output = ozz::make_span(output).first(3);
+      EXPECT_FALSE(invalid.Run());
+    }
+
+    ASSERT_TRUE(job.Run());
+
+    const float* in = reinterpret_cast<const float*>(input);
+    const float* out = reinterpret_cast<const float*>(output);
+    for (int i = 0; i < map->num_joints(); ++i) {
+      const int remap = map->joint_remaps()[i];
+      const float* src = in + (remap / 4) * 40 + (remap & 3);
+      const float* dest = out + (i / 4) * 40 + (i & 3);
+      // Translation component normal to the plane is negated.
+      EXPECT_FLOAT_EQ(dest[0], axis == MirrorMap::kX ? -src[0] : src[0]);
+      EXPECT_FLOAT_EQ(dest[4], axis == MirrorMap::kY ? -src[4] : src[4]);
+      EXPECT_FLOAT_EQ(dest[8], axis == MirrorMap::kZ ? -src[8] : src[8]);
+      // Rotation components in the plane are negated.
+      EXPECT_FLOAT_EQ(dest[12], axis == MirrorMap::kX ? src[12] : -src[12]);
+      EXPECT_FLOAT_EQ(dest[16], axis == MirrorMap::kY ? src[16] : -src[16]);
+      EXPECT_FLOAT_EQ(dest[20], axis == MirrorMap::kZ ? src[20] : -src[20]);
+      EXPECT_FLOAT_EQ(dest[24], src[24]);
+      // Scale is unchanged.
+      for (int k = 7; k < 10; ++k) {
+        EXPECT_FLOAT_EQ(dest[k * 4], src[k * 4]);
+      }
+    }
+
+    // Mirroring twice restores the input.
+    ozz::math::SoaTransform restored[4];
+    job.input = output;
+    job.output = restored;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < map->num_joints(); ++i) {
+      for (int k = 0; k < 10; ++k) {
+        const int offset = (i / 4) * 40 + k * 4 + (i & 3);
+        EXPECT_FLOAT_EQ(reinterpret_cast<const float*>(restored)[offset],
+                        in[offset]);
+      }
+    }
+  }
+}
@@ -0,0 +1,143 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/motion_extractor.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_animation_utils.h"
+#include "ozz/animation/offline/raw_track.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/transform.h"
+
+using ozz::animation::offline::MotionExtractor;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawFloat3Track;
+using ozz::animation::offline::RawQuaternionTrack;
+
+namespace {
+// Builds a 2 joints animation, whose root walks forward while turning, and
+// bounces up and down.
+RawAnimation BuildWalk() {
+  RawAnimation raw;
+  raw.duration = 2.f;
+  raw.tracks.resize(2);
+  for (int i = 0; i <= 4; ++i) {
+    const float time = i * .5f;
+    const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(time, i % 2 ? 1.1f : 1.f, time * 2.f)};
+    raw.tracks[0].translations.push_back(tkey);
+    const RawAnimation::RotationKey rkey = {
+        time, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                   time * .5f) *
+                  ozz::math::Quaternion::FromAxisAngle(
+                      ozz::math::Float3::x_axis(), .1f)};
+    raw.tracks[0].rotations.push_back(rkey);
+  }
+  const RawAnimation::TranslationKey child_key = {
+      0.f, ozz::math::Float3(0.f, 1.f, 0.f)};
+  raw.tracks[1].translations.push_back(child_key);
+  return raw;
+}
+}  // namespace
+
+TEST(Error, MotionExtractor) {
+  MotionExtractor extractor;
+  const RawAnimation walk = BuildWalk();
+  RawFloat3Track position;
+  RawQuaternionTrack rotation;
+  RawAnimation output;
+
+  EXPECT_FALSE(extractor(walk, nullptr, &rotation, &output));
+  EXPECT_FALSE(extractor(walk, &position, nullptr, &output));
+  EXPECT_FALSE(extractor(walk, &position, &rotation, nullptr));
+
+  RawAnimation invalid;
+  invalid.duration = -1.f;
+  EXPECT_FALSE(extractor(invalid, &position, &rotation, &output));
+
+  extractor.root_joint = 2;
+  EXPECT_FALSE(extractor(walk, &position, &rotation, &output));
+  extractor.root_joint = -1;
+  EXPECT_FALSE(extractor(walk, &position, &rotation, &output));
+
+  extractor.root_joint = 1;
+  EXPECT_TRUE(extractor(walk, &position, &rotation, &output));
+}
+
+TEST(Extract, MotionExtractor) {
+  MotionExtractor extractor;
+  const RawAnimation walk = BuildWalk();
+  RawFloat3Track position;
+  RawQuaternionTrack rotation;
+  RawAnimation output;
+  ASSERT_TRUE(extractor(walk, &position, &rotation, &output));
+  ASSERT_TRUE(position.Validate());
+  ASSERT_TRUE(rotation.Validate());
+  ASSERT_TRUE(output.Validate());
+
+  // Motion is keyed at root keys time, horizontal only.
+  ASSERT_EQ(position.keyframes.size(), 5u);
+  ASSERT_EQ(rotation.keyframes.size(), 5u);
+  EXPECT_FLOAT_EQ(position.keyframes[2].ratio, .5f);
+  EXPECT_FLOAT3_EQ(position.keyframes[2].value, 1.f, 0.f, 2.f);
+  EXPECT_FLOAT3_EQ(position.keyframes[4].value, 2.f, 0.f, 4.f);
+  const ozz::math::Quaternion heading = ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float3::y_axis(), 1.f);
+  EXPECT_QUATERNION_EQ(rotation.keyframes[4].value, heading.x, heading.y,
+                       heading.z, heading.w);
+
+  // Baked root plays in place, keeping vertical motion and tilt.
+  for (int i = 0; i <= 4; ++i) {
+    const float time = i * .5f;
+    ozz::math::Transform transform;
+    ASSERT_TRUE(ozz::animation::offline::SampleTrack(output.tracks[0], time,
+                                                     &transform));
+    EXPECT_FLOAT3_EQ(transform.translation, 0.f, i % 2 ? 1.1f : 1.f, 0.f);
+    EXPECT_QUATERNION_EQ(transform.rotation, std::sin(.05f), 0.f, 0.f,
+                         std::cos(.05f));
+  }
+  EXPECT_EQ(output.tracks[1].translations.size(), 1u);
+
+  // Without bake, animation is unchanged.
+  extractor.bake = false;
+  extractor.heading = false;
+  extractor.position_y = true;
+  ASSERT_TRUE(extractor(walk, &position, &rotation, &output));
+  EXPECT_FLOAT3_EQ(position.keyframes[1].value, .5f, 1.1f, 1.f);
+  EXPECT_QUATERNION_EQ(rotation.keyframes[3].value, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_EQ(output.tracks[0].translations.size(), 5u);
+  EXPECT_FLOAT3_EQ(output.tracks[0].translations[1].value, .5f, 1.1f, 1.f);
+
+  // In place.
+  RawAnimation in_place = walk;
+  extractor.bake = true;
+  ASSERT_TRUE(extractor(in_place, &position, &rotation, &in_place));
+  EXPECT_FLOAT3_EQ(in_place.tracks[0].translations[1].value, 0.f, 0.f, 0.f);
+}
@@ -0,0 +1,117 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/partitioned_animation_builder.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/partitioned_animation.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::PartitionedAnimation;
+using ozz::animation::offline::PartitionedAnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+TEST(Error, PartitionedAnimationBuilder) {
+  PartitionedAnimationBuilder builder;
+
+  {  // Invalid raw animation.
+    RawAnimation raw_animation;
+    raw_animation.duration = -1.f;
+    EXPECT_FALSE(builder(raw_animation));
+  }
+
+  {  // Invalid partition size.
+    RawAnimation raw_animation;
+    raw_animation.tracks.resize(1);
+    PartitionedAnimationBuilder invalid;
+    invalid.partition_tracks = 0;
+    EXPECT_FALSE(invalid(raw_animation));
+  }
+
+  {  // Valid.
+    RawAnimation raw_animation;
+    raw_animation.tracks.resize(1);
+    EXPECT_TRUE(builder(raw_animation));
+  }
+}
+
+TEST(Partitions, PartitionedAnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 3.f;
+  raw_animation.name = "partitioned";
+  raw_animation.tracks.resize(150);
+
+  {  // Default partitions.
+    PartitionedAnimationBuilder builder;
+    ozz::unique_ptr<PartitionedAnimation> animation = builder(raw_animation);
+    ASSERT_TRUE(animation);
+
+    EXPECT_FLOAT_EQ(animation->duration(), 3.f);
+    EXPECT_EQ(animation->num_tracks(), 150);
+    EXPECT_EQ(animation->num_soa_tracks(), 38);
+    EXPECT_STREQ(animation->name(), "partitioned");
+    EXPECT_EQ(animation->partition_soa_tracks(), 16);
+    ASSERT_EQ(animation->num_partitions(), 3);
+    EXPECT_EQ(animation->partition(0).num_tracks(), 64);
+    EXPECT_EQ(animation->partition(1).num_tracks(), 64);
+    EXPECT_EQ(animation->partition(2).num_tracks(), 22);
+    for (int i = 0; i < animation->num_partitions(); ++i) {
+      EXPECT_FLOAT_EQ(animation->partition(i).duration(), 3.f);
+    }
+  }
+
+  {  // Partition size is rounded up to a multiple of 4.
+    PartitionedAnimationBuilder builder;
+    builder.partition_tracks = 49;
+    ozz::unique_ptr<PartitionedAnimation> animation = builder(raw_animation);
+    ASSERT_TRUE(animation);
+    EXPECT_EQ(animation->partition_soa_tracks(), 13);
+    ASSERT_EQ(animation->num_partitions(), 3);
+    EXPECT_EQ(animation->partition(0).num_tracks(), 52);
+    EXPECT_EQ(animation->partition(2).num_tracks(), 46);
+  }
+
+  {  // A single partition.
+    PartitionedAnimationBuilder builder;
+    builder.partition_tracks = 1000;
+    ozz::unique_ptr<PartitionedAnimation> animation = builder(raw_animation);
+    ASSERT_TRUE(animation);
+    ASSERT_EQ(animation->num_partitions(), 1);
+    EXPECT_EQ(animation->partition(0).num_tracks(), 150);
+  }
+
+  {  // No track, no partition.
+    RawAnimation empty;
+    PartitionedAnimationBuilder builder;
+    ozz::unique_ptr<PartitionedAnimation> animation = builder(empty);
+    ASSERT_TRUE(animation);
+    EXPECT_EQ(animation->num_tracks(), 0);
+    EXPECT_EQ(animation->num_partitions(), 0);
+  }
+}
@@ -0,0 +1,216 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/pose_atlas_builder.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/endianness.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::PoseAtlas;
+using ozz::animation::offline::PoseAtlasBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 2 joints skeleton, whose root rest pose is translated by 2 on x,
+// and a 1s animation translating root from 0 to 1 on x.
+void BuildInputs(ozz::unique_ptr<Skeleton>* _skeleton,
+                 ozz::unique_ptr<Animation>* _animation) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.transform.translation = ozz::math::Float3(2.f, 0.f, 0.f);
+  root.children.resize(1);
+  root.children[0].name = "child";
+  root.children[0].transform = ozz::math::Transform::identity();
+  *_skeleton = SkeletonBuilder()(raw_skeleton);
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  const RawAnimation::TranslationKey first = {0.f,
+                                              ozz::math::Float3::zero()};
+  const RawAnimation::TranslationKey last = {1.f, ozz::math::Float3::x_axis()};
+  raw_animation.tracks[0].translations.push_back(first);
+  raw_animation.tracks[0].translations.push_back(last);
+  *_animation = AnimationBuilder()(raw_animation);
+}
+
+// Reads the 4 floats of a texel.
+void ReadTexel(const PoseAtlas& _atlas, int _frame, int _texel,
+               float _values[4]) {
+  const ozz::byte* src = _atlas.texels.data() + _atlas.row_pitch() * _frame +
+                         _atlas.texel_size() * _texel;
+  for (int i = 0; i < 4; ++i) {
+    if (_atlas.format == PoseAtlas::kHalf) {
+      uint16_t half;
+      std::memcpy(&half, src + i * sizeof(uint16_t), sizeof(uint16_t));
+      _values[i] = ozz::math::HalfToFloat(half);
+    } else {
+      std::memcpy(&_values[i], src + i * sizeof(float), sizeof(float));
+    }
+  }
+}
+}  // namespace
+
+TEST(Error, PoseAtlasBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton;
+  ozz::unique_ptr<Animation> animation;
+  BuildInputs(&skeleton, &animation);
+  ASSERT_TRUE(skeleton && animation);
+
+  {  // No output.
+    PoseAtlasBuilder builder;
+    EXPECT_FALSE(builder(*skeleton, *animation, nullptr));
+  }
+
+  {  // Invalid frame rate.
+    PoseAtlasBuilder builder;
+    builder.frame_rate = 0.f;
+    PoseAtlas atlas;
+    EXPECT_FALSE(builder(*skeleton, *animation, &atlas));
+    EXPECT_EQ(atlas.num_frames, 0);
+    EXPECT_TRUE(atlas.texels.empty());
+  }
+
+  {  // Skeleton mismatch.
+    PoseAtlasBuilder builder;
+    PoseAtlas atlas;
+    EXPECT_FALSE(builder(Skeleton(), *animation, &atlas));
+    EXPECT_TRUE(atlas.texels.empty());
+  }
+}
+
+TEST(Build, PoseAtlasBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton;
+  ozz::unique_ptr<Animation> animation;
+  BuildInputs(&skeleton, &animation);
+  ASSERT_TRUE(skeleton && animation);
+
+  PoseAtlasBuilder builder;
+  builder.format = PoseAtlas::kFloat;
+  PoseAtlas atlas;
+  ASSERT_TRUE(builder(*skeleton, *animation, &atlas));
+  EXPECT_EQ(atlas.num_frames, 31);
+  EXPECT_EQ(atlas.num_joints, 2);
+  EXPECT_FLOAT_EQ(atlas.frame_rate, 30.f);
+  EXPECT_EQ(atlas.texel_size(), 16u);
+  EXPECT_EQ(atlas.row_pitch(), 96u);
+  EXPECT_EQ(atlas.texels.size(), 96u * 31u);
+
+  // Root first row is (1, 0, 0, tx), tx going from 0 to 1. Child inherits root
+  // translation.
+  float texel[4];
+  ReadTexel(atlas, 0, 0, texel);
+  EXPECT_FLOAT_EQ(texel[0], 1.f);
+  EXPECT_FLOAT_EQ(texel[1], 0.f);
+  EXPECT_FLOAT_EQ(texel[3], 0.f);
+  // Animation translations are quantized.
+  ReadTexel(atlas, 15, 0, texel);
+  EXPECT_NEAR(texel[3], .5f, 1e-3f);
+  ReadTexel(atlas, 30, 3, texel);
+  EXPECT_NEAR(texel[3], 1.f, 1e-3f);
+
+  // Second and third rows.
+  ReadTexel(atlas, 30, 1, texel);
+  EXPECT_FLOAT_EQ(texel[1], 1.f);
+  EXPECT_FLOAT_EQ(texel[3], 0.f);
+  ReadTexel(atlas, 30, 2, texel);
+  EXPECT_FLOAT_EQ(texel[2], 1.f);
+  EXPECT_FLOAT_EQ(texel[3], 0.f);
+}
+
+TEST(BuildSkinningHalf, PoseAtlasBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton;
+  ozz::unique_ptr<Animation> animation;
+  BuildInputs(&skeleton, &animation);
+  ASSERT_TRUE(skeleton && animation);
+
+  PoseAtlasBuilder builder;
+  builder.frame_rate = 4.f;
+  builder.skinning = true;
+  PoseAtlas atlas;
+  ASSERT_TRUE(builder(*skeleton, *animation, &atlas));
+  EXPECT_EQ(atlas.format, PoseAtlas::kHalf);
+  EXPECT_EQ(atlas.num_frames, 5);
+  EXPECT_EQ(atlas.texel_size(), 8u);
+
+  // Skinning matrices are relative to rest pose root translation of 2.
+  float texel[4];
+  ReadTexel(atlas, 0, 0, texel);
+  EXPECT_FLOAT_EQ(texel[0], 1.f);
+  EXPECT_FLOAT_EQ(texel[3], -2.f);
+  ReadTexel(atlas, 4, 3, texel);
+  EXPECT_NEAR(texel[3], -1.f, 1e-3f);
+}
+
+TEST(Write, PoseAtlasBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton;
+  ozz::unique_ptr<Animation> animation;
+  BuildInputs(&skeleton, &animation);
+  ASSERT_TRUE(skeleton && animation);
+
+  PoseAtlas atlas;
+  ASSERT_TRUE(PoseAtlasBuilder()(*skeleton, *animation, &atlas));
+
+  EXPECT_FALSE(atlas.Write(nullptr));
+
+  ozz::io::MemoryStream stream;
+  ASSERT_TRUE(atlas.Write(&stream));
+  EXPECT_EQ(stream.Size(), 24u + atlas.texels.size());
+
+  uint32_t header[5];
+  float frame_rate;
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ASSERT_EQ(stream.Read(header, sizeof(header)), sizeof(header));
+  ASSERT_EQ(stream.Read(&frame_rate, sizeof(frame_rate)), sizeof(frame_rate));
+  if (ozz::GetNativeEndianness() == ozz::kLittleEndian) {
+    EXPECT_EQ(header[0], static_cast<uint32_t>(PoseAtlas::kFileMagic));
+    EXPECT_EQ(header[1], static_cast<uint32_t>(PoseAtlas::kFileVersion));
+    EXPECT_EQ(header[2], 31u);
+    EXPECT_EQ(header[3], 2u);
+    EXPECT_EQ(header[4], static_cast<uint32_t>(PoseAtlas::kHalf));
+    EXPECT_FLOAT_EQ(frame_rate, 30.f);
+  }
+}
@@ -33,6 +33,8 @@
 #include "ozz/base/maths/gtest_math_helper.h"
 
 #include "ozz/animation/offline/raw_animation.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
 
 using ozz::animation::offline::RawAnimation;
 
@@ -272,3 +274,91 @@ TEST(FixedRateSamplingTime, Utils) {
     EXPECT_EQ(it.time(30000), 1000.f);
   }
 }
+
+TEST(Sampler, Utils) {
+  ozz::animation::offline::RawAnimationSampler sampler;
+  ozz::math::SoaTransform output[2];
+
+  // Unbound.
+  EXPECT_FALSE(sampler.Sample(0.f, output));
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(6);
+
+  // Invalid animation.
+  const RawAnimation::TranslationKey invalid = {3.f, ozz::math::Float3::one()};
+  raw_animation.tracks[0].translations.push_back(invalid);
+  EXPECT_FALSE(sampler.Bind(raw_animation));
+  EXPECT_FALSE(sampler.Sample(0.f, output));
+  raw_animation.tracks[0].translations.clear();
+
+  // Track 0 and 5 have no key, track 1 a single one, others are random.
+  const RawAnimation::ScaleKey single = {.5f, ozz::math::Float3(2.f)};
+  raw_animation.tracks[1].scales.push_back(single);
+  unsigned int seed = 17;
+  for (int t = 2; t < 5; ++t) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[t];
+    for (float time = 0.f; time <= raw_animation.duration;) {
+      seed = seed * 1103515245u + 12345u;
+      const float value = ((seed >> 8) % 1000) / 500.f - 1.f;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(value, -value, time)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::x_axis(), value * 3.f)};
+      track.rotations.push_back(rkey);
+      if (t != 3) {
+        const RawAnimation::ScaleKey skey = {time,
+                                             ozz::math::Float3(1.f + value)};
+        track.scales.push_back(skey);
+      }
+      time += (1 + (seed >> 4) % 8) / 32.f;
+    }
+  }
+  ASSERT_TRUE(sampler.Bind(raw_animation));
+
+  // Output too small.
+  EXPECT_FALSE(sampler.Sample(0.f, ozz::make_span(output).first(1)));
+
+  // Compares with SampleAnimation, sampling forward at a fixed rate, then
+  // backward and out of range.
+  const ozz::animation::offline::FixedRateSamplingTime fixed(
+      raw_animation.duration, 60.f);
+  for (int pass = 0; pass < 2; ++pass) {
+    for (size_t k = 0; k < fixed.num_keys() + 4; ++k) {
+      const float time =
+          pass == 0 ? fixed.time(ozz::math::Min(k, fixed.num_keys() - 1))
+                    : 2.1f - k * .075f;
+      ASSERT_TRUE(sampler.Sample(time, output));
+
+      ozz::math::Transform expected[6];
+      ASSERT_TRUE(SampleAnimation(raw_animation, time, expected));
+      for (int t = 0; t < 8; ++t) {
+        const ozz::math::SoaTransform& soa = output[t / 4];
+        float values[10][4];
+        ozz::math::StorePtrU(soa.translation.x, values[0]);
+        ozz::math::StorePtrU(soa.translation.y, values[1]);
+        ozz::math::StorePtrU(soa.translation.z, values[2]);
+        ozz::math::StorePtrU(soa.rotation.x, values[3]);
+        ozz::math::StorePtrU(soa.rotation.y, values[4]);
+        ozz::math::StorePtrU(soa.rotation.z, values[5]);
+        ozz::math::StorePtrU(soa.rotation.w, values[6]);
+        ozz::math::StorePtrU(soa.scale.x, values[7]);
+        ozz::math::StorePtrU(soa.scale.y, values[8]);
+        ozz::math::StorePtrU(soa.scale.z, values[9]);
+        const ozz::math::Transform& ref =
+            t < 6 ? expected[t] : ozz::math::Transform::identity();
+        const float refs[10] = {ref.translation.x, ref.translation.y,
+                                ref.translation.z, ref.rotation.x,
+                                ref.rotation.y,    ref.rotation.z,
+                                ref.rotation.w,    ref.scale.x,
+                                ref.scale.y,       ref.scale.z};
+        for (int v = 0; v < 10; ++v) {
+          EXPECT_NEAR(values[v][t % 4], refs[v], 1e-5f);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,307 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/retarget_map_builder.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/retarget_job.h"
+#include "ozz/animation/runtime/retarget_map.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::RetargetJob;
+using ozz::animation::RetargetMap;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::RetargetMapBuilder;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Sets every joint transform to an offset of _x along x.
+void SetTransforms(RawSkeleton::Joint::Children* _joints, float _x) {
+  for (RawSkeleton::Joint& joint : *_joints) {
+    joint.transform = ozz::math::Transform::identity();
+    joint.transform.translation = ozz::math::Float3(_x, 0.f, 0.f);
+    SetTransforms(&joint.children, _x);
+  }
+}
+
+// Builds the following source skeleton, depth-first ordered:
+// 0 root
+// 1  spine
+// 2   head
+// 3   arm
+// 4    hand
+// 5     finger0
+// 6     finger1
+// 7  leg
+ozz::unique_ptr<Skeleton> BuildSource() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  RawSkeleton::Joint& spine = root.children[0];
+  spine.name = "spine";
+  spine.children.resize(2);
+  spine.children[0].name = "head";
+  RawSkeleton::Joint& arm = spine.children[1];
+  arm.name = "arm";
+  arm.children.resize(1);
+  RawSkeleton::Joint& hand = arm.children[0];
+  hand.name = "hand";
+  hand.children.resize(2);
+  hand.children[0].name = "finger0";
+  hand.children[1].name = "finger1";
+  root.children[1].name = "leg";
+
+  SetTransforms(&raw_skeleton.roots, 1.f);
+
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds the following target skeleton, with an extra twist joint and a
+// differently named leg, depth-first ordered:
+// 0 root
+// 1  spine
+// 2   head
+// 3   arm
+// 4    hand
+// 5     finger0
+// 6     finger1
+// 7    arm_twist
+// 8  leg_l
+ozz::unique_ptr<Skeleton> BuildTarget(
+    Skeleton::NameStorage _storage = Skeleton::kNameStrings) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  RawSkeleton::Joint& spine = root.children[0];
+  spine.name = "spine";
+  spine.children.resize(2);
+  spine.children[0].name = "head";
+  RawSkeleton::Joint& arm = spine.children[1];
+  arm.name = "arm";
+  arm.children.resize(2);
+  RawSkeleton::Joint& hand = arm.children[0];
+  hand.name = "hand";
+  hand.children.resize(2);
+  hand.children[0].name = "finger0";
+  hand.children[1].name = "finger1";
+  arm.children[1].name = "arm_twist";
+  root.children[1].name = "leg_l";
+
+  SetTransforms(&raw_skeleton.roots, -1.f);
+
+  ozz::unique_ptr<Skeleton> skeleton =
+      ozz::make_unique<Skeleton>(nullptr, _storage);
+  SkeletonBuilder builder;
+  if (!builder(raw_skeleton, skeleton.get())) {
+    return nullptr;
+  }
+  return skeleton;
+}
+}  // namespace
+
+TEST(Error, RetargetMapBuilder) {
+  ozz::unique_ptr<Skeleton> source = BuildSource();
+  ozz::unique_ptr<Skeleton> target = BuildTarget();
+  ASSERT_TRUE(source && target);
+
+  RetargetMapBuilder builder;
+  const RetargetMapBuilder::Mapping mapping = {"leg_l", "unknown"};
+  builder.mappings.push_back(mapping);
+  EXPECT_FALSE(builder(*source, *target));
+}
+
+TEST(Build, RetargetMapBuilder) {
+  ozz::unique_ptr<Skeleton> source = BuildSource();
+  ozz::unique_ptr<Skeleton> target = BuildTarget();
+  ASSERT_TRUE(source && target);
+  ASSERT_EQ(source->num_joints(), 8);
+  ASSERT_EQ(target->num_joints(), 9);
+
+  RetargetMapBuilder builder;
+
+  {  // No matching.
+    builder.matching = RetargetMapBuilder::kNone;
+    ozz::unique_ptr<RetargetMap> map = builder(*source, *target);
+    ASSERT_TRUE(map);
+    EXPECT_EQ(map->num_source_joints(), 8);
+    EXPECT_EQ(map->num_target_joints(), 9);
+    for (int i = 0; i < 9; ++i) {
+      EXPECT_EQ(map->joint_remaps()[i], Skeleton::kNoParent);
+    }
+    ASSERT_EQ(map->soa_remaps().size(), 3u);
+    EXPECT_EQ(map->soa_remaps()[0], -1);
+  }
+
+  {  // Name matching.
+    builder.matching = RetargetMapBuilder::kName;
+    ozz::unique_ptr<RetargetMap> map = builder(*source, *target);
+    ASSERT_TRUE(map);
+    const int16_t expected[] = {0, 1, 2, 3, 4, 5, 6, -1, -1};
+    for (int i = 0; i < 9; ++i) {
+      EXPECT_EQ(map->joint_remaps()[i], expected[i]);
+    }
+    EXPECT_EQ(map->soa_remaps()[0], 0);
+    EXPECT_EQ(map->soa_remaps()[1], -1);
+    EXPECT_EQ(map->soa_remaps()[2], -1);
+  }
+
+  {  // Name matching, without target names strings.
+    ozz::unique_ptr<Skeleton> hashed = BuildTarget(Skeleton::kNameHashes);
+    ASSERT_TRUE(hashed);
+    RetargetMapBuilder hash_builder;
+    const RetargetMapBuilder::Mapping mapping = {"leg_l", "leg"};
+    hash_builder.mappings.push_back(mapping);
+    ozz::unique_ptr<RetargetMap> map = hash_builder(*source, *hashed);
+    ASSERT_TRUE(map);
+    const int16_t expected[] = {0, 1, 2, 3, 4, 5, 6, -1, 7};
+    for (int i = 0; i < 9; ++i) {
+      EXPECT_EQ(map->joint_remaps()[i], expected[i]);
+    }
+  }
+
+  {  // Hierarchy matching.
+    builder.matching = RetargetMapBuilder::kHierarchy;
+    ozz::unique_ptr<RetargetMap> map = builder(*source, *target);
+    ASSERT_TRUE(map);
+    const int16_t expected[] = {0, 1, 2, 3, 4, 5, 6, -1, 7};
+    for (int i = 0; i < 9; ++i) {
+      EXPECT_EQ(map->joint_remaps()[i], expected[i]);
+    }
+  }
+
+  {  // Explicit mappings, applied in order.
+    builder.matching = RetargetMapBuilder::kName;
+    const RetargetMapBuilder::Mapping mappings[] = {
+        {"leg_l", "leg"}, {"finger*", ""}, {"arm_twist", "arm"}};
+    builder.mappings.assign(mappings, mappings + 3);
+    ozz::unique_ptr<RetargetMap> map = builder(*source, *target);
+    ASSERT_TRUE(map);
+    const int16_t expected[] = {0, 1, 2, 3, 4, -1, -1, 3, 7};
+    for (int i = 0; i < 9; ++i) {
+      EXPECT_EQ(map->joint_remaps()[i], expected[i]);
+    }
+  }
+}
+
+TEST(Archive, RetargetMapBuilder) {
+  ozz::unique_ptr<Skeleton> source = BuildSource();
+  ozz::unique_ptr<Skeleton> target = BuildTarget();
+  ASSERT_TRUE(source && target);
+
+  RetargetMapBuilder builder;
+  ozz::unique_ptr<RetargetMap> map = builder(*source, *target);
+  ASSERT_TRUE(map);
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *map;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  RetargetMap loaded;
+  i >> loaded;
+
+  EXPECT_EQ(loaded.num_source_joints(), map->num_source_joints());
+  ASSERT_EQ(loaded.num_target_joints(), map->num_target_joints());
+  for (int j = 0; j < map->num_target_joints(); ++j) {
+    EXPECT_EQ(loaded.joint_remaps()[j], map->joint_remaps()[j]);
+  }
+  ASSERT_EQ(loaded.soa_remaps().size(), map->soa_remaps().size());
+  for (size_t j = 0; j < map->soa_remaps().size(); ++j) {
+    EXPECT_EQ(loaded.soa_remaps()[j], map->soa_remaps()[j]);
+  }
+}
+
+TEST(Job, RetargetMapBuilder) {
+  ozz::unique_ptr<Skeleton> source = BuildSource();
+  ozz::unique_ptr<Skeleton> target = BuildTarget();
+  ASSERT_TRUE(source && target);
+
+  RetargetMapBuilder builder;
+  const RetargetMapBuilder::Mapping mapping = {"leg_l", "leg"};
+  builder.mappings.push_back(mapping);
+  ozz::unique_ptr<RetargetMap> map = builder(*source, *target);
+  ASSERT_TRUE(map);
+
+  // Source pose translation x and scale x are set to joint index.
+  ozz::math::SoaTransform input[2];
+  for (int i = 0; i < 2; ++i) {
+    const float base = i * 4.f;
+    const ozz::math::SimdFloat4 index = ozz::math::simd_float4::Load(
+        base, base + 1.f, base + 2.f, base + 3.f);
+    input[i] = ozz::math::SoaTransform::identity();
+    input[i].translation.x = index;
+    input[i].scale.x = index;
+  }
+  ozz::math::SoaTransform output[3];
+
+  RetargetJob job;
+  EXPECT_FALSE(job.Validate());
+  job.map = map.get();
+  job.input = input;
+  job.rest_pose = target->joint_rest_poses();
+  job.output = output;
+  EXPECT_TRUE(job.Validate());
+
+  {  // Too small buffers.
+    RetargetJob invalid = job;
+    invalid.input = ozz::make_span(input).first(1);
+    EXPECT_FALSE(invalid.Validate());
+    invalid = job;
+    invalid.output = ozz::make_span(output).first(2);
+    EXPECT_FALSE(invalid.Validate());
+    invalid = job;
+    invalid.rest_pose = invalid.rest_pose.first(2);
+    EXPECT_FALSE(invalid.Run());
+  }
+
+  ASSERT_TRUE(job.Run());
+
+  // Unmapped arm_twist keeps target rest pose.
+  const float expected[] = {0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, -1.f, 7.f};
+  for (int i = 0; i < 9; ++i) {
+    float translations[4];
+    float scales[4];
+    ozz::math::StorePtrU(output[i / 4].translation.x, translations);
+    ozz::math::StorePtrU(output[i / 4].scale.x, scales);
+    EXPECT_FLOAT_EQ(translations[i & 3], expected[i]);
+    EXPECT_FLOAT_EQ(scales[i & 3], i == 7 ? 1.f : expected[i]);
+  }
+}
@@ -0,0 +1,223 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/sampling_access_analyzer.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::SamplingAccessAnalysis;
+using ozz::animation::offline::SamplingAccessAnalyzer;
+
+namespace {
+// Builds an animation of 4 tracks and 1s, whose tracks have 6 translation
+// keys each. Rotations and scales have the 2 default keys per track.
+ozz::unique_ptr<Animation> BuildAnimation(const AnimationBuilder& _builder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(4);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    for (int k = 0; k <= 5; ++k) {
+      const RawAnimation::TranslationKey key = {
+          k / 5.f, ozz::math::Float3(static_cast<float>(i),
+                                     static_cast<float>(k), 0.f)};
+      raw_animation.tracks[i].translations.push_back(key);
+    }
+  }
+  return _builder(raw_animation);
+}
+
+// Gets _count ratios uniformly distributed in range [0,1].
+ozz::vector<float> ForwardRatios(int _count) {
+  ozz::vector<float> ratios;
+  for (int i = 0; i < _count; ++i) {
+    ratios.push_back(static_cast<float>(i) / (_count - 1));
+  }
+  return ratios;
+}
+}  // namespace
+
+TEST(Error, SamplingAccessAnalyzer) {
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation = BuildAnimation(builder);
+  ASSERT_TRUE(animation);
+  const ozz::vector<float> ratios = ForwardRatios(10);
+
+  SamplingAccessAnalyzer analyzer;
+  EXPECT_FALSE(analyzer(*animation, make_span(ratios), nullptr));
+
+  SamplingAccessAnalysis analysis;
+  {  // Invalid chunk duration.
+    SamplingAccessAnalyzer invalid;
+    invalid.chunk_duration = 0.f;
+    EXPECT_FALSE(invalid(*animation, make_span(ratios), &analysis));
+    EXPECT_TRUE(analysis.frames.empty());
+  }
+  {  // Invalid cache line size.
+    SamplingAccessAnalyzer invalid;
+    invalid.cache_line_size = 0;
+    EXPECT_FALSE(invalid(*animation, make_span(ratios), &analysis));
+    EXPECT_TRUE(analysis.frames.empty());
+  }
+  {  // Invalid layout.
+    SamplingAccessAnalyzer invalid;
+    invalid.layout = static_cast<SamplingAccessAnalyzer::Layout>(42);
+    EXPECT_FALSE(invalid(*animation, make_span(ratios), &analysis));
+    EXPECT_TRUE(analysis.frames.empty());
+  }
+  {  // No ratio.
+    EXPECT_TRUE(analyzer(*animation, ozz::span<const float>(), &analysis));
+    EXPECT_TRUE(analysis.frames.empty());
+    EXPECT_EQ(analysis.bytes, 0u);
+    EXPECT_EQ(analysis.footprint, 0u);
+  }
+  {  // Empty animation.
+    Animation empty;
+    EXPECT_TRUE(analyzer(empty, make_span(ratios), &analysis));
+    ASSERT_EQ(analysis.frames.size(), ratios.size());
+    EXPECT_EQ(analysis.bytes, 0u);
+    EXPECT_EQ(analysis.lines, 0);
+  }
+}
+
+TEST(Forward, SamplingAccessAnalyzer) {
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation = BuildAnimation(builder);
+  ASSERT_TRUE(animation);
+  const ozz::vector<float> ratios = ForwardRatios(31);
+
+  SamplingAccessAnalyzer analyzer;
+  SamplingAccessAnalysis analysis;
+  ASSERT_TRUE(analyzer(*animation, make_span(ratios), &analysis));
+  ASSERT_EQ(analysis.frames.size(), ratios.size());
+
+  // First frame reads the 2 first keys of every track, plus the next
+  // translation key the cursor stops at.
+  EXPECT_EQ(analysis.frames[0].ratio, 0.f);
+  EXPECT_EQ(analysis.frames[0].keys_advanced, 0);
+  EXPECT_EQ(analysis.frames[0].keys_read, 4 * 2 * 3 + 1);
+  EXPECT_EQ(analysis.frames[0].lines, analysis.frames[0].misses);
+
+  // Cursor advances over all the keys that aren't initially loaded.
+  int keys_advanced = 0;
+  size_t bytes = 0;
+  int lines = 0, misses = 0;
+  for (const SamplingAccessAnalysis::Frame& frame : analysis.frames) {
+    keys_advanced += frame.keys_advanced;
+    bytes += frame.bytes;
+    lines += frame.lines;
+    misses += frame.misses;
+    EXPECT_LE(frame.misses, frame.lines);
+  }
+  EXPECT_EQ(keys_advanced, 4 * 6 - 4 * 2);
+  EXPECT_EQ(analysis.bytes, bytes);
+  EXPECT_EQ(analysis.lines, lines);
+  EXPECT_EQ(analysis.misses, misses);
+
+  // Animation keys fit in the cache, so each line misses once.
+  EXPECT_EQ(static_cast<size_t>(analysis.misses) * 64, analysis.footprint);
+  EXPECT_LE(analysis.footprint, animation->size() + 3 * 64);
+
+  // Without cache, every line touched is a miss.
+  SamplingAccessAnalyzer uncached;
+  uncached.cache_size = 0;
+  SamplingAccessAnalysis uncached_analysis;
+  ASSERT_TRUE(uncached(*animation, make_span(ratios), &uncached_analysis));
+  EXPECT_EQ(uncached_analysis.lines, analysis.lines);
+  EXPECT_EQ(uncached_analysis.misses, uncached_analysis.lines);
+}
+
+TEST(Backward, SamplingAccessAnalyzer) {
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation = BuildAnimation(builder);
+  ASSERT_TRUE(animation);
+
+  // Ratios are clamped, and playing backward restarts.
+  const float ratios[] = {2.f, .5f, .5f, -1.f};
+  SamplingAccessAnalyzer analyzer;
+  SamplingAccessAnalysis analysis;
+  ASSERT_TRUE(analyzer(*animation, ratios, &analysis));
+  ASSERT_EQ(analysis.frames.size(), 4u);
+  EXPECT_EQ(analysis.frames[0].ratio, 1.f);
+  EXPECT_EQ(analysis.frames[0].keys_advanced, 4 * 6 - 4 * 2);
+  EXPECT_GT(analysis.frames[1].keys_advanced, 0);
+
+  // Same ratio only checks the cursor, which is still cached.
+  EXPECT_EQ(analysis.frames[2].keys_advanced, 0);
+  EXPECT_GT(analysis.frames[2].lines, 0);
+  EXPECT_EQ(analysis.frames[2].misses, 0);
+
+  EXPECT_EQ(analysis.frames[3].ratio, 0.f);
+  EXPECT_EQ(analysis.frames[3].keys_advanced, 0);
+  EXPECT_EQ(analysis.frames[3].keys_read, 4 * 2 * 3 + 1);
+}
+
+TEST(Layouts, SamplingAccessAnalyzer) {
+  AnimationBuilder builder;
+  builder.cubic_interpolation = true;
+  ozz::unique_ptr<Animation> animation = BuildAnimation(builder);
+  ASSERT_TRUE(animation);
+  const ozz::vector<float> ratios = ForwardRatios(31);
+
+  SamplingAccessAnalyzer analyzer;
+  analyzer.chunk_duration = .5f;
+  SamplingAccessAnalysis sorted, per_track, chunked;
+  analyzer.layout = SamplingAccessAnalyzer::kSorted;
+  ASSERT_TRUE(analyzer(*animation, make_span(ratios), &sorted));
+  analyzer.layout = SamplingAccessAnalyzer::kPerTrack;
+  ASSERT_TRUE(analyzer(*animation, make_span(ratios), &per_track));
+  analyzer.layout = SamplingAccessAnalyzer::kChunked;
+  ASSERT_TRUE(analyzer(*animation, make_span(ratios), &chunked));
+
+  // Layouts change addresses, not keys read.
+  ASSERT_EQ(sorted.frames.size(), per_track.frames.size());
+  ASSERT_EQ(sorted.frames.size(), chunked.frames.size());
+  for (size_t i = 0; i < sorted.frames.size(); ++i) {
+    EXPECT_EQ(sorted.frames[i].keys_read, per_track.frames[i].keys_read);
+    EXPECT_EQ(sorted.frames[i].keys_read, chunked.frames[i].keys_read);
+    EXPECT_EQ(sorted.frames[i].bytes, per_track.frames[i].bytes);
+    EXPECT_EQ(sorted.frames[i].bytes, chunked.frames[i].bytes);
+  }
+  // All keys are read, whatever the layout.
+  EXPECT_EQ(sorted.footprint, per_track.footprint);
+  EXPECT_EQ(sorted.footprint, chunked.footprint);
+
+  // Cubic animations also read tangents.
+  SamplingAccessAnalysis linear;
+  builder.cubic_interpolation = false;
+  animation = BuildAnimation(builder);
+  ASSERT_TRUE(animation);
+  analyzer.layout = SamplingAccessAnalyzer::kSorted;
+  ASSERT_TRUE(analyzer(*animation, make_span(ratios), &linear));
+  EXPECT_LT(linear.bytes, sorted.bytes);
+}
@@ -0,0 +1,399 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/segmented_animation_builder.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/animation_optimizer.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/segmented_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SegmentedAnimation;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::AnimationOptimizer;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawAnimationSource;
+using ozz::animation::offline::SegmentedAnimationBuilder;
+
+TEST(Error, SegmentedAnimationBuilder) {
+  SegmentedAnimationBuilder builder;
+
+  {  // Invalid raw animation.
+    RawAnimation raw_animation;
+    raw_animation.duration = -1.f;
+    EXPECT_FALSE(builder(raw_animation));
+  }
+
+  {  // Invalid segment duration.
+    RawAnimation raw_animation;
+    raw_animation.tracks.resize(1);
+    SegmentedAnimationBuilder invalid;
+    invalid.segment_duration = 0.f;
+    EXPECT_FALSE(invalid(raw_animation));
+  }
+
+  {  // Valid.
+    RawAnimation raw_animation;
+    raw_animation.tracks.resize(1);
+    EXPECT_TRUE(builder(raw_animation));
+  }
+}
+
+TEST(Segments, SegmentedAnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 25.f;
+  raw_animation.name = "segmented";
+  raw_animation.tracks.resize(5);
+
+  SegmentedAnimationBuilder builder;
+  builder.segment_duration = 10.f;
+  ozz::unique_ptr<SegmentedAnimation> animation = builder(raw_animation);
+  ASSERT_TRUE(animation);
+
+  EXPECT_FLOAT_EQ(animation->duration(), 25.f);
+  EXPECT_EQ(animation->num_tracks(), 5);
+  EXPECT_EQ(animation->num_soa_tracks(), 2);
+  EXPECT_STREQ(animation->name(), "segmented");
+  ASSERT_EQ(animation->num_segments(), 3);
+
+  ASSERT_EQ(animation->segment_ratios().size(), 4u);
+  EXPECT_FLOAT_EQ(animation->segment_ratios()[0], 0.f);
+  EXPECT_FLOAT_EQ(animation->segment_ratios()[1], 1.f / 3.f);
+  EXPECT_FLOAT_EQ(animation->segment_ratios()[2], 2.f / 3.f);
+  EXPECT_FLOAT_EQ(animation->segment_ratios()[3], 1.f);
+
+  for (int i = 0; i < animation->num_segments(); ++i) {
+    EXPECT_FLOAT_EQ(animation->segment(i).duration(), 25.f / 3.f);
+    EXPECT_EQ(animation->segment(i).num_tracks(), 5);
+  }
+
+  // Finds segments.
+  float segment_ratio;
+  EXPECT_EQ(animation->FindSegment(-1.f, &segment_ratio), 0);
+  EXPECT_FLOAT_EQ(segment_ratio, 0.f);
+  EXPECT_EQ(animation->FindSegment(0.f, &segment_ratio), 0);
+  EXPECT_FLOAT_EQ(segment_ratio, 0.f);
+  EXPECT_EQ(animation->FindSegment(.5f, &segment_ratio), 1);
+  EXPECT_FLOAT_EQ(segment_ratio, .5f);
+  EXPECT_EQ(animation->FindSegment(2.f / 3.f, &segment_ratio), 2);
+  EXPECT_FLOAT_EQ(segment_ratio, 0.f);
+  EXPECT_EQ(animation->FindSegment(1.f, &segment_ratio), 2);
+  EXPECT_FLOAT_EQ(segment_ratio, 1.f);
+  EXPECT_EQ(animation->FindSegment(2.f, &segment_ratio), 2);
+  EXPECT_FLOAT_EQ(segment_ratio, 1.f);
+
+  {  // Shorter than a segment.
+    builder.segment_duration = 100.f;
+    ozz::unique_ptr<SegmentedAnimation> single = builder(raw_animation);
+    ASSERT_TRUE(single);
+    EXPECT_EQ(single->num_segments(), 1);
+    EXPECT_FLOAT_EQ(single->segment(0).duration(), 25.f);
+  }
+
+  {  // Default animation has no segment.
+    SegmentedAnimation empty;
+    EXPECT_EQ(empty.num_segments(), 0);
+    EXPECT_EQ(empty.FindSegment(.5f, &segment_ratio), -1);
+  }
+}
+
+TEST(Sampling, SegmentedAnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 7.f;
+  raw_animation.tracks.resize(3);
+
+  // Track 0 is animated all along, track 1 has a single key per channel and
+  // track 2 is empty.
+  for (int i = 0; i <= 14; ++i) {
+    const float time = i * .5f;
+    const float value = (i % 3) * 2.f - i * .25f;
+    const RawAnimation::TranslationKey tkey = {
+        time, ozz::math::Float3(value, -value, 1.f)};
+    raw_animation.tracks[0].translations.push_back(tkey);
+    const RawAnimation::RotationKey rkey = {
+        time, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                   value * .2f)};
+    raw_animation.tracks[0].rotations.push_back(rkey);
+    if (i % 4 == 1) {
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f + i * .1f, 2.f, 3.f)};
+      raw_animation.tracks[0].scales.push_back(skey);
+    }
+  }
+  const RawAnimation::TranslationKey tkey = {3.f,
+                                             ozz::math::Float3(4.f, 5.f, 6.f)};
+  raw_animation.tracks[1].translations.push_back(tkey);
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation = builder(raw_animation);
+  ASSERT_TRUE(animation);
+
+  SegmentedAnimationBuilder segmented_builder;
+  segmented_builder.segment_duration = 2.f;
+  ozz::unique_ptr<SegmentedAnimation> segmented =
+      segmented_builder(raw_animation);
+  ASSERT_TRUE(segmented);
+  EXPECT_EQ(segmented->num_segments(), 4);
+
+  ozz::animation::SamplingJob::Context context(3);
+  ozz::animation::SamplingJob::Context segment_context(3);
+  ozz::math::SoaTransform expected[1];
+  ozz::math::SoaTransform output[1];
+
+  for (float ratio = 0.f; ratio <= 1.f; ratio += .01f) {
+    ozz::animation::SamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.ratio = ratio;
+    job.output = expected;
+    ASSERT_TRUE(job.Run());
+
+    float segment_ratio;
+    const int segment = segmented->FindSegment(ratio, &segment_ratio);
+    ASSERT_GE(segment, 0);
+    ozz::animation::SamplingJob segment_job;
+    segment_job.animation = &segmented->segment(segment);
+    segment_job.context = &segment_context;
+    segment_job.ratio = segment_ratio;
+    segment_job.output = output;
+    ASSERT_TRUE(segment_job.Run());
+
+    float e[4], o[4];
+    const ozz::math::SimdFloat4* const expected_values[] = {
+        &expected[0].translation.x, &expected[0].translation.y,
+        &expected[0].translation.z, &expected[0].scale.x,
+        &expected[0].scale.y,       &expected[0].scale.z};
+    const ozz::math::SimdFloat4* const output_values[] = {
+        &output[0].translation.x, &output[0].translation.y,
+        &output[0].translation.z, &output[0].scale.x,
+        &output[0].scale.y,       &output[0].scale.z};
+    for (int c = 0; c < 6; ++c) {
+      ozz::math::StorePtrU(*expected_values[c], e);
+      ozz::math::StorePtrU(*output_values[c], o);
+      for (int t = 0; t < 3; ++t) {
+        EXPECT_NEAR(e[t], o[t], 2e-3f) << "ratio " << ratio;
+      }
+    }
+
+    // Rotations are compared with their dot product, as q and -q are the same
+    // rotation.
+    ozz::math::StorePtrU(
+        ozz::math::Dot(expected[0].rotation, output[0].rotation), e);
+    for (int t = 0; t < 3; ++t) {
+      EXPECT_NEAR(std::abs(e[t]), 1.f, 1e-3f) << "ratio " << ratio;
+    }
+  }
+}
+
+namespace {
+// Procedural source, whose tracks translation x is a function of time, sampled
+// at 30Hz. It records the longest window it was read.
+class ProceduralSource : public RawAnimationSource {
+ public:
+  ProceduralSource(float _duration, int _num_tracks)
+      : duration_(_duration),
+        num_tracks_(_num_tracks),
+        num_reads_(0),
+        fail_at_read_(-1),
+        longest_window_(0.f) {}
+
+  virtual float duration() const { return duration_; }
+  virtual int num_tracks() const { return num_tracks_; }
+  virtual const char* name() const { return "procedural"; }
+
+  virtual bool Read(float _begin, float _end, RawAnimation* _window) {
+    if (num_reads_++ == fail_at_read_) {
+      return false;
+    }
+    longest_window_ = std::max(longest_window_, _end - _begin);
+    _window->duration = _end - _begin;
+    _window->tracks.resize(num_tracks_);
+    const int first = static_cast<int>(std::floor(_begin * kRate));
+    const int last = static_cast<int>(std::ceil(_end * kRate));
+    for (int t = 0; t < num_tracks_; ++t) {
+      for (int k = first; k <= last; ++k) {
+        const float time = std::min(std::max(k / kRate, _begin), _end);
+        const RawAnimation::TranslationKey key = {
+            time - _begin, ozz::math::Float3(Value(t, time), 0.f, 0.f)};
+        _window->tracks[t].translations.push_back(key);
+      }
+    }
+    return true;
+  }
+
+  // Gets track _track value at _time.
+  static float Value(int _track, float _time) {
+    return std::sin(_time * (1.f + _track * .3f)) * (1.f + _track);
+  }
+
+  static const float kRate;
+
+  float duration_;
+  int num_tracks_;
+  int num_reads_;
+  int fail_at_read_;
+  float longest_window_;
+};
+
+const float ProceduralSource::kRate = 30.f;
+
+// Gets first joint translation x sampled from _animation at _time.
+float SampleX(const SegmentedAnimation& _animation, float _time, int _track) {
+  float segment_ratio;
+  const int segment =
+      _animation.FindSegment(_time / _animation.duration(), &segment_ratio);
+  ozz::animation::SamplingJob::Context context(_animation.num_tracks());
+  ozz::math::SoaTransform output[2];
+  ozz::animation::SamplingJob job;
+  job.animation = &_animation.segment(segment);
+  job.context = &context;
+  job.ratio = segment_ratio;
+  job.output = output;
+  if (!job.Run()) {
+    return 0.f;
+  }
+  float x[4];
+  ozz::math::StorePtrU(output[_track / 4].translation.x, x);
+  return x[_track & 3];
+}
+}  // namespace
+
+TEST(StreamError, SegmentedAnimationBuilder) {
+  SegmentedAnimationBuilder builder;
+  builder.segment_duration = 2.f;
+
+  {  // Invalid duration.
+    ProceduralSource source(0.f, 2);
+    EXPECT_FALSE(builder(source));
+  }
+  {  // Read failure.
+    ProceduralSource source(10.f, 2);
+    source.fail_at_read_ = 2;
+    EXPECT_FALSE(builder(source));
+  }
+  {  // Optimizer requires a skeleton.
+    AnimationOptimizer optimizer;
+    SegmentedAnimationBuilder optimizing = builder;
+    optimizing.optimizer = &optimizer;
+    ProceduralSource source(10.f, 2);
+    EXPECT_FALSE(optimizing(source));
+  }
+  {  // Invalid overlap.
+    SegmentedAnimationBuilder invalid = builder;
+    invalid.overlap = -1.f;
+    ProceduralSource source(10.f, 2);
+    EXPECT_FALSE(invalid(source));
+  }
+  {  // Valid.
+    ProceduralSource source(10.f, 2);
+    EXPECT_TRUE(builder(source));
+  }
+}
+
+TEST(Stream, SegmentedAnimationBuilder) {
+  const float duration = 10.f;
+  const int num_tracks = 5;
+
+  SegmentedAnimationBuilder builder;
+  builder.segment_duration = 2.f;
+  builder.overlap = .5f;
+  ProceduralSource source(duration, num_tracks);
+  ozz::unique_ptr<SegmentedAnimation> streamed = builder(source);
+  ASSERT_TRUE(streamed);
+
+  // Peak memory is bounded by windows.
+  EXPECT_EQ(source.num_reads_, 5);
+  EXPECT_FLOAT_EQ(source.longest_window_, 3.f);
+
+  // Same as a build from the whole raw animation.
+  RawAnimation raw_animation;
+  ASSERT_TRUE(source.Read(0.f, duration, &raw_animation));
+  ozz::unique_ptr<SegmentedAnimation> whole = builder(raw_animation);
+  ASSERT_TRUE(whole);
+
+  EXPECT_STREQ(streamed->name(), "procedural");
+  EXPECT_FLOAT_EQ(streamed->duration(), duration);
+  EXPECT_EQ(streamed->num_tracks(), num_tracks);
+  ASSERT_EQ(streamed->num_segments(), whole->num_segments());
+  for (float time = 0.f; time <= duration; time += .07f) {
+    for (int t = 0; t < num_tracks; ++t) {
+      EXPECT_NEAR(SampleX(*streamed, time, t), SampleX(*whole, time, t), 1e-3f)
+          << "time " << time;
+    }
+  }
+}
+
+TEST(StreamOptimize, SegmentedAnimationBuilder) {
+  const float duration = 10.f;
+  const int num_tracks = 3;
+
+  // Skeleton with as many joints as tracks.
+  ozz::animation::offline::RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(num_tracks);
+  for (int i = 0; i < num_tracks; ++i) {
+    raw_skeleton.roots[i].name = "joint";
+    raw_skeleton.roots[i].name += static_cast<char>('0' + i);
+    raw_skeleton.roots[i].transform = ozz::math::Transform::identity();
+  }
+  ozz::unique_ptr<ozz::animation::Skeleton> skeleton =
+      ozz::animation::offline::SkeletonBuilder()(raw_skeleton);
+  ASSERT_TRUE(skeleton);
+
+  AnimationOptimizer optimizer;
+  SegmentedAnimationBuilder builder;
+  builder.segment_duration = 2.f;
+  ProceduralSource source(duration, num_tracks);
+  ozz::unique_ptr<SegmentedAnimation> raw = builder(source);
+  ASSERT_TRUE(raw);
+
+  builder.optimizer = &optimizer;
+  ozz::unique_ptr<SegmentedAnimation> optimized =
+      builder(source, skeleton.get());
+  ASSERT_TRUE(optimized);
+  EXPECT_LT(optimized->size(), raw->size());
+
+  for (float time = 0.f; time <= duration; time += .07f) {
+    for (int t = 0; t < num_tracks; ++t) {
+      EXPECT_NEAR(SampleX(*optimized, time, t),
+                  ProceduralSource::Value(t, time), 1e-2f)
+          << "time " << time;
+    }
+  }
+}
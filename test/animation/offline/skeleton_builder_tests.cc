@@ -30,10 +30,13 @@
 #include "gtest/gtest.h"
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 #include "ozz/base/maths/simd_math.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/tracking_allocator.h"
 #include "ozz/base/memory/unique_ptr.h"
 
 using ozz::animation::Skeleton;
@@ -603,6 +606,87 @@ TEST(MultiRoots, SkeletonBuilder) {
   }
 }
 
+TEST(Ordering, SkeletonBuilder) {
+  /*
+  6 joints (2 roots)
+     *
+    /  \
+   j0   j2
+   |    |  \
+   j1  j3  j5
+        |
+       j4
+  */
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  raw_skeleton.roots[0].name = "j0";
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].name = "j1";
+  raw_skeleton.roots[1].name = "j2";
+  raw_skeleton.roots[1].children.resize(2);
+  raw_skeleton.roots[1].children[0].name = "j3";
+  raw_skeleton.roots[1].children[1].name = "j5";
+  raw_skeleton.roots[1].children[0].children.resize(1);
+  raw_skeleton.roots[1].children[0].children[0].name = "j4";
+
+  // Every joint is translated by its number along x.
+  RawSkeleton::Joint* joints[] = {
+      &raw_skeleton.roots[0],
+      &raw_skeleton.roots[0].children[0],
+      &raw_skeleton.roots[1],
+      &raw_skeleton.roots[1].children[0],
+      &raw_skeleton.roots[1].children[0].children[0],
+      &raw_skeleton.roots[1].children[1]};
+  for (int i = 0; i < 6; ++i) {
+    joints[i]->transform = ozz::math::Transform::identity();
+    joints[i]->transform.translation.x = static_cast<float>(i);
+  }
+
+  SkeletonBuilder builder;
+  EXPECT_EQ(builder.ordering, SkeletonBuilder::kDepthFirst);
+  ozz::unique_ptr<Skeleton> depth_first(builder(raw_skeleton));
+  ASSERT_TRUE(depth_first);
+  EXPECT_TRUE(ozz::animation::IsDepthFirst(*depth_first));
+
+  builder.ordering = SkeletonBuilder::kSiblingsGrouped;
+  ozz::unique_ptr<Skeleton> grouped(builder(raw_skeleton));
+  ASSERT_TRUE(grouped);
+  EXPECT_FALSE(ozz::animation::IsDepthFirst(*grouped));
+
+  // Siblings are contiguous, parents are before their children.
+  const char* names[] = {"j0", "j2", "j1", "j3", "j5", "j4"};
+  const int16_t parents[] = {-1, -1, 0, 1, 1, 3};
+  ASSERT_EQ(grouped->num_joints(), 6);
+  for (int i = 0; i < 6; ++i) {
+    EXPECT_STREQ(grouped->joint_names()[i], names[i]);
+    EXPECT_EQ(grouped->joint_parents()[i], parents[i]);
+  }
+
+  // Both orderings give the same model-space matrices.
+  ozz::math::Float4x4 df_models[6];
+  ozz::animation::LocalToModelJob df_job;
+  df_job.skeleton = depth_first.get();
+  df_job.input = depth_first->joint_rest_poses();
+  df_job.output = df_models;
+  ASSERT_TRUE(df_job.Run());
+
+  ozz::math::Float4x4 grouped_models[6];
+  ozz::animation::LocalToModelJob grouped_job;
+  grouped_job.skeleton = grouped.get();
+  grouped_job.input = grouped->joint_rest_poses();
+  grouped_job.output = grouped_models;
+  ASSERT_TRUE(grouped_job.Run());
+
+  for (int i = 0; i < 6; ++i) {
+    const int df = ozz::animation::FindJoint(*depth_first, names[i]);
+    ASSERT_NE(df, -1);
+    const ozz::math::SimdFloat4 t = df_models[df].cols[3];
+    EXPECT_SIMDFLOAT_EQ(grouped_models[i].cols[3], ozz::math::GetX(t),
+                        ozz::math::GetY(t), ozz::math::GetZ(t),
+                        ozz::math::GetW(t));
+  }
+}
+
 TEST(RestPose, SkeletonBuilder) {
   using ozz::math::Float3;
   using ozz::math::Float4;
@@ -744,3 +828,40 @@ TEST(Move, SkeletonBuilder) {
     EXPECT_EQ(skeleton2->num_joints(), 46);
   }
 }
+
+TEST(InPlace, SkeletonBuilder) {
+  SkeletonBuilder builder;
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  root.children[0].name = "j0";
+  root.children[1].name = "j1";
+
+  ozz::memory::TrackingAllocator allocator;
+  {
+    Skeleton skeleton(&allocator);
+    EXPECT_EQ(skeleton.allocator(), &allocator);
+    EXPECT_FALSE(builder(raw_skeleton, nullptr));
+
+    ASSERT_TRUE(builder(raw_skeleton, &skeleton));
+    EXPECT_EQ(skeleton.num_joints(), 3);
+    EXPECT_STREQ(skeleton.joint_names()[2], "j1");
+    EXPECT_EQ(allocator.total().live_allocations, 1u);
+
+    // Rebuilds, releasing previous data.
+    root.children.resize(5);
+    ASSERT_TRUE(builder(raw_skeleton, &skeleton));
+    EXPECT_EQ(skeleton.num_joints(), 6);
+    EXPECT_EQ(allocator.total().live_allocations, 1u);
+    EXPECT_EQ(allocator.total().allocations, 2u);
+
+    // Invalid skeleton leaves skeleton unchanged.
+    RawSkeleton invalid;
+    invalid.roots.resize(Skeleton::kMaxJoints + 1);
+    EXPECT_FALSE(builder(invalid, &skeleton));
+    EXPECT_EQ(skeleton.num_joints(), 6);
+  }
+  EXPECT_EQ(allocator.total().live_allocations, 0u);
+}
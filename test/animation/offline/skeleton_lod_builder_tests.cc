@@ -0,0 +1,285 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/skeleton_lod_builder.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_lod.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::LocalToModelJob;
+using ozz::animation::Skeleton;
+using ozz::animation::SkeletonLOD;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+using ozz::animation::offline::SkeletonLODBuilder;
+
+namespace {
+// Sets every joint transform to an offset of 1 along x.
+void SetTransforms(RawSkeleton::Joint::Children* _joints) {
+  for (RawSkeleton::Joint& joint : *_joints) {
+    joint.transform = ozz::math::Transform::identity();
+    joint.transform.translation = ozz::math::Float3(1.f, 0.f, 0.f);
+    SetTransforms(&joint.children);
+  }
+}
+
+// Builds the following skeleton, depth-first ordered:
+// 0 root
+// 1  spine
+// 2   head
+// 3   arm
+// 4    hand
+// 5     finger0
+// 6     finger1
+// 7  leg
+ozz::unique_ptr<Skeleton> BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  RawSkeleton::Joint& spine = root.children[0];
+  spine.name = "spine";
+  spine.children.resize(2);
+  spine.children[0].name = "head";
+  RawSkeleton::Joint& arm = spine.children[1];
+  arm.name = "arm";
+  arm.children.resize(1);
+  RawSkeleton::Joint& hand = arm.children[0];
+  hand.name = "hand";
+  hand.children.resize(2);
+  hand.children[0].name = "finger0";
+  hand.children[1].name = "finger1";
+  root.children[1].name = "leg";
+
+  SetTransforms(&raw_skeleton.roots);
+
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+}  // namespace
+
+TEST(Error, SkeletonLODBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+
+  SkeletonLODBuilder builder;
+  builder.max_depth = -1;
+  EXPECT_FALSE(builder(*skeleton));
+}
+
+TEST(Build, SkeletonLODBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  ASSERT_EQ(skeleton->num_joints(), 8);
+  ASSERT_EQ(ozz::animation::FindJoint(*skeleton, "finger1"), 6);
+
+  {  // Empty skeleton.
+    SkeletonLODBuilder builder;
+    ozz::unique_ptr<SkeletonLOD> lod = builder(Skeleton());
+    ASSERT_TRUE(lod);
+    EXPECT_EQ(lod->num_joints(), 0);
+    EXPECT_EQ(lod->num_active_joints(), 0);
+    EXPECT_TRUE(lod->joints_mask().empty());
+    EXPECT_TRUE(lod->soa_mask().empty());
+  }
+
+  {  // Default activates all joints.
+    SkeletonLODBuilder builder;
+    ozz::unique_ptr<SkeletonLOD> lod = builder(*skeleton);
+    ASSERT_TRUE(lod);
+    EXPECT_EQ(lod->num_joints(), 8);
+    EXPECT_EQ(lod->num_active_joints(), 8);
+    for (int i = 0; i < 8; ++i) {
+      EXPECT_TRUE(lod->IsActive(i));
+      EXPECT_EQ(lod->joint_remaps()[i], i);
+    }
+    ASSERT_EQ(lod->joints_mask().size(), 1u);
+    EXPECT_EQ(lod->joints_mask()[0], 0xff);
+    ASSERT_EQ(lod->soa_mask().size(), 1u);
+    EXPECT_EQ(lod->soa_mask()[0], 0x3);
+  }
+
+  {  // Depth based.
+    SkeletonLODBuilder builder;
+    builder.max_depth = 1;
+    ozz::unique_ptr<SkeletonLOD> lod = builder(*skeleton);
+    ASSERT_TRUE(lod);
+    EXPECT_EQ(lod->num_active_joints(), 3);
+    const int16_t expected[] = {0, 1, 1, 1, 1, 1, 1, 7};
+    for (int i = 0; i < 8; ++i) {
+      EXPECT_EQ(lod->joint_remaps()[i], expected[i]);
+    }
+    EXPECT_EQ(lod->joints_mask()[0], 0x83);
+    EXPECT_EQ(lod->soa_mask()[0], 0x3);
+  }
+
+  {  // Overrides, with ancestors activation.
+    SkeletonLODBuilder builder;
+    builder.max_depth = 0;
+    const SkeletonLODBuilder::Override hand = {"hand", true};
+    builder.overrides.push_back(hand);
+    ozz::unique_ptr<SkeletonLOD> lod = builder(*skeleton);
+    ASSERT_TRUE(lod);
+    EXPECT_EQ(lod->num_active_joints(), 4);
+    const int16_t expected[] = {0, 1, 1, 3, 4, 4, 4, 0};
+    for (int i = 0; i < 8; ++i) {
+      EXPECT_EQ(lod->joint_remaps()[i], expected[i]);
+    }
+    EXPECT_EQ(lod->joints_mask()[0], 0x1b);
+    EXPECT_EQ(lod->soa_mask()[0], 0x3);
+  }
+
+  {  // Wildcard overrides, applied in order.
+    SkeletonLODBuilder builder;
+    const SkeletonLODBuilder::Override fingers = {"finger*", false};
+    const SkeletonLODBuilder::Override finger1 = {"finger1", true};
+    const SkeletonLODBuilder::Override root = {"root", false};
+    builder.overrides.push_back(fingers);
+    builder.overrides.push_back(finger1);
+    builder.overrides.push_back(root);
+    ozz::unique_ptr<SkeletonLOD> lod = builder(*skeleton);
+    ASSERT_TRUE(lod);
+    EXPECT_EQ(lod->num_active_joints(), 7);
+    EXPECT_FALSE(lod->IsActive(5));
+    EXPECT_TRUE(lod->IsActive(6));
+    EXPECT_TRUE(lod->IsActive(0));
+    EXPECT_EQ(lod->joint_remaps()[5], 4);
+  }
+
+  {  // No active joint.
+    SkeletonLODBuilder builder;
+    const SkeletonLODBuilder::Override all = {"*", false};
+    builder.overrides.push_back(all);
+    ozz::unique_ptr<SkeletonLOD> lod = builder(*skeleton);
+    ASSERT_TRUE(lod);
+    EXPECT_EQ(lod->num_active_joints(), 0);
+    for (int i = 0; i < 8; ++i) {
+      EXPECT_EQ(lod->joint_remaps()[i], Skeleton::kNoParent);
+    }
+    EXPECT_EQ(lod->joints_mask()[0], 0);
+    EXPECT_EQ(lod->soa_mask()[0], 0);
+  }
+}
+
+TEST(Palette, SkeletonLODBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+
+  SkeletonLODBuilder builder;
+  builder.max_depth = 2;
+  ozz::unique_ptr<SkeletonLOD> lod = builder(*skeleton);
+  ASSERT_TRUE(lod);
+
+  // Palette doesn't contain arm joint, so fingers are remapped to spine.
+  const uint16_t palette[] = {6, 1, 4, 2, 5};
+  uint16_t remaps[5];
+  EXPECT_FALSE(lod->RemapPalette(Skeleton(), palette, remaps));
+  EXPECT_FALSE(lod->RemapPalette(*skeleton, palette, {remaps, 4}));
+  const uint16_t invalid[] = {8};
+  EXPECT_FALSE(lod->RemapPalette(*skeleton, invalid, remaps));
+
+  ASSERT_TRUE(lod->RemapPalette(*skeleton, palette, remaps));
+  const uint16_t expected[] = {1, 1, 1, 3, 1};
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(remaps[i], expected[i]);
+  }
+
+  // No active ancestor in the palette.
+  const uint16_t fingers[] = {5, 6};
+  ASSERT_TRUE(lod->RemapPalette(*skeleton, fingers, remaps));
+  EXPECT_EQ(remaps[0], 0);
+  EXPECT_EQ(remaps[1], 1);
+}
+
+TEST(Archive, SkeletonLODBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+
+  SkeletonLODBuilder builder;
+  builder.max_depth = 1;
+  ozz::unique_ptr<SkeletonLOD> lod = builder(*skeleton);
+  ASSERT_TRUE(lod);
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  o << *lod;
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  SkeletonLOD loaded;
+  i >> loaded;
+
+  EXPECT_EQ(loaded.num_joints(), lod->num_joints());
+  EXPECT_EQ(loaded.num_active_joints(), lod->num_active_joints());
+  for (int j = 0; j < lod->num_joints(); ++j) {
+    EXPECT_EQ(loaded.joint_remaps()[j], lod->joint_remaps()[j]);
+  }
+  EXPECT_EQ(loaded.joints_mask()[0], lod->joints_mask()[0]);
+  EXPECT_EQ(loaded.soa_mask()[0], lod->soa_mask()[0]);
+}
+
+TEST(LocalToModel, SkeletonLODBuilder) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+
+  SkeletonLODBuilder builder;
+  builder.max_depth = 1;
+  ozz::unique_ptr<SkeletonLOD> lod = builder(*skeleton);
+  ASSERT_TRUE(lod);
+
+  ozz::math::Float4x4 models[8];
+  for (ozz::math::Float4x4& model : models) {
+    model = ozz::math::Float4x4::Scaling(ozz::math::simd_float4::zero());
+  }
+
+  LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.input = skeleton->joint_rest_poses();
+  job.output = models;
+  job.mask = lod->joints_mask();
+  ASSERT_TRUE(job.Run());
+
+  // Only active joints are updated.
+  EXPECT_SIMDFLOAT_EQ(models[0].cols[3], 1.f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(models[1].cols[3], 2.f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(models[7].cols[3], 2.f, 0.f, 0.f, 1.f);
+  for (int i = 2; i < 7; ++i) {
+    EXPECT_SIMDFLOAT_EQ(models[i].cols[3], 0.f, 0.f, 0.f, 1.f);
+  }
+}
@@ -0,0 +1,224 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/synthetic_generator.h"
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+using ozz::animation::offline::SyntheticAnimationGenerator;
+using ozz::animation::offline::SyntheticSkeletonGenerator;
+
+namespace {
+// Gets the depth of _joints hierarchy.
+int Depth(const RawSkeleton::Joint::Children& _joints) {
+  int depth = 0;
+  for (const RawSkeleton::Joint& joint : _joints) {
+    depth = std::max(depth, Depth(joint.children) + 1);
+  }
+  return depth;
+}
+}  // namespace
+
+TEST(Error, SyntheticSkeletonGenerator) {
+  RawSkeleton raw_skeleton;
+  SyntheticSkeletonGenerator generator;
+
+  generator.num_joints = -1;
+  EXPECT_FALSE(generator(&raw_skeleton));
+  generator.num_joints = Skeleton::kMaxJoints + 1;
+  EXPECT_FALSE(generator(&raw_skeleton));
+
+  generator.num_joints = 8;
+  generator.fan_out = 0;
+  EXPECT_FALSE(generator(&raw_skeleton));
+
+  generator.fan_out = 2;
+  generator.depth = -1;
+  EXPECT_FALSE(generator(&raw_skeleton));
+  EXPECT_EQ(raw_skeleton.num_joints(), 0);
+
+  generator.depth = 0;
+  generator.num_joints = 0;
+  EXPECT_TRUE(generator(&raw_skeleton));
+  EXPECT_EQ(raw_skeleton.num_joints(), 0);
+}
+
+TEST(Shape, SyntheticSkeletonGenerator) {
+  RawSkeleton raw_skeleton;
+  SyntheticSkeletonGenerator generator;
+
+  {  // Default.
+    ASSERT_TRUE(generator(&raw_skeleton));
+    EXPECT_TRUE(raw_skeleton.Validate());
+    EXPECT_EQ(raw_skeleton.num_joints(), 64);
+    ASSERT_EQ(raw_skeleton.roots.size(), 1u);
+    EXPECT_STREQ(raw_skeleton.roots[0].name.c_str(), "joint0");
+    EXPECT_EQ(raw_skeleton.roots[0].children.size(), 3u);
+    EXPECT_STREQ(raw_skeleton.roots[0].children[2].name.c_str(), "joint3");
+    // 1 + 3 + 9 + 27 < 64 joints.
+    EXPECT_EQ(Depth(raw_skeleton.roots), 5);
+  }
+
+  {  // Chain.
+    generator.num_joints = 16;
+    generator.fan_out = 1;
+    ASSERT_TRUE(generator(&raw_skeleton));
+    EXPECT_EQ(raw_skeleton.num_joints(), 16);
+    EXPECT_EQ(Depth(raw_skeleton.roots), 16);
+  }
+
+  {  // Complete tree stops before num_joints.
+    generator.num_joints = 100;
+    generator.fan_out = 2;
+    generator.depth = 4;
+    ASSERT_TRUE(generator(&raw_skeleton));
+    EXPECT_EQ(raw_skeleton.num_joints(), 15);
+    EXPECT_EQ(Depth(raw_skeleton.roots), 4);
+  }
+
+  {  // Bone length.
+    generator.num_joints = 2;
+    generator.bone_length = 2.f;
+    ASSERT_TRUE(generator(&raw_skeleton));
+    EXPECT_FLOAT_EQ(
+        Length(raw_skeleton.roots[0].children[0].transform.translation), 2.f);
+  }
+
+  {  // Maximum number of joints, built to a runtime skeleton.
+    generator.num_joints = Skeleton::kMaxJoints;
+    generator.fan_out = 4;
+    generator.depth = 0;
+    ASSERT_TRUE(generator(&raw_skeleton));
+    EXPECT_EQ(raw_skeleton.num_joints(), Skeleton::kMaxJoints);
+    ozz::unique_ptr<Skeleton> skeleton = SkeletonBuilder()(raw_skeleton);
+    ASSERT_TRUE(skeleton);
+    EXPECT_EQ(skeleton->num_joints(), Skeleton::kMaxJoints);
+  }
+}
+
+TEST(Error, SyntheticAnimationGenerator) {
+  RawSkeleton raw_skeleton;
+  ASSERT_TRUE(SyntheticSkeletonGenerator()(&raw_skeleton));
+
+  RawAnimation raw_animation;
+  SyntheticAnimationGenerator generator;
+  generator.duration = 0.f;
+  EXPECT_FALSE(generator(raw_skeleton, &raw_animation));
+  generator.duration = 1.f;
+  generator.key_frequency = 0.f;
+  EXPECT_FALSE(generator(raw_skeleton, &raw_animation));
+  generator.key_frequency = 30.f;
+  generator.amplitude = -1.f;
+  EXPECT_FALSE(generator(raw_skeleton, &raw_animation));
+  generator.amplitude = 1.f;
+  generator.noise = -1.f;
+  EXPECT_FALSE(generator(raw_skeleton, &raw_animation));
+  EXPECT_EQ(raw_animation.num_tracks(), 0);
+
+  // Empty skeleton.
+  generator.noise = 0.f;
+  EXPECT_TRUE(generator(RawSkeleton(), &raw_animation));
+  EXPECT_EQ(raw_animation.num_tracks(), 0);
+  EXPECT_TRUE(raw_animation.Validate());
+}
+
+TEST(Density, SyntheticAnimationGenerator) {
+  SyntheticSkeletonGenerator skeleton_generator;
+  skeleton_generator.num_joints = 50;
+  RawSkeleton raw_skeleton;
+  ASSERT_TRUE(skeleton_generator(&raw_skeleton));
+
+  SyntheticAnimationGenerator generator;
+  generator.duration = 2.f;
+  generator.key_frequency = 120.f;
+  RawAnimation raw_animation;
+  ASSERT_TRUE(generator(raw_skeleton, &raw_animation));
+  EXPECT_TRUE(raw_animation.Validate());
+  EXPECT_FLOAT_EQ(raw_animation.duration, 2.f);
+  ASSERT_EQ(raw_animation.num_tracks(), 50);
+  for (const RawAnimation::JointTrack& track : raw_animation.tracks) {
+    ASSERT_EQ(track.translations.size(), 241u);
+    EXPECT_EQ(track.rotations.size(), 241u);
+    EXPECT_EQ(track.scales.size(), 241u);
+    EXPECT_FLOAT_EQ(track.translations.front().time, 0.f);
+    EXPECT_FLOAT_EQ(track.translations.back().time, 2.f);
+  }
+
+  // Builds runtime objects, noise keeps keys distinct.
+  ozz::unique_ptr<Skeleton> skeleton = SkeletonBuilder()(raw_skeleton);
+  ozz::unique_ptr<Animation> animation = AnimationBuilder()(raw_animation);
+  ASSERT_TRUE(skeleton && animation);
+  EXPECT_EQ(animation->num_tracks(), skeleton->num_joints());
+  EXPECT_GE(animation->translations().size(), 50u * 241u);
+}
+
+TEST(Noise, SyntheticAnimationGenerator) {
+  RawSkeleton raw_skeleton;
+  ASSERT_TRUE(SyntheticSkeletonGenerator()(&raw_skeleton));
+
+  SyntheticAnimationGenerator generator;
+  RawAnimation a, b;
+
+  // Same seed, same animation.
+  ASSERT_TRUE(generator(raw_skeleton, &a));
+  ASSERT_TRUE(generator(raw_skeleton, &b));
+  EXPECT_EQ(a.tracks[10].rotations[5].value.x,
+            b.tracks[10].rotations[5].value.x);
+
+  // Different seed.
+  generator.seed = 46;
+  ASSERT_TRUE(generator(raw_skeleton, &b));
+  EXPECT_NE(a.tracks[10].rotations[5].value.x,
+            b.tracks[10].rotations[5].value.x);
+
+  // No noise and no amplitude, animation is the rest pose.
+  generator.noise = 0.f;
+  generator.amplitude = 0.f;
+  ASSERT_TRUE(generator(raw_skeleton, &a));
+  EXPECT_FLOAT3_EQ(a.tracks[0].translations[3].value, 0.f, 0.f, 0.f);
+  EXPECT_QUATERNION_EQ(a.tracks[0].rotations[3].value, 0.f, 0.f, 0.f, 1.f);
+  // Tracks follow depth-first order, joint1 is the first child of the root.
+  const ozz::math::Float3& rest =
+      raw_skeleton.roots[0].children[0].transform.translation;
+  EXPECT_FLOAT3_EQ(a.tracks[1].translations[3].value, rest.x, rest.y, rest.z);
+}
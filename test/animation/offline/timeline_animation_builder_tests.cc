@@ -0,0 +1,162 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/timeline_animation_builder.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/timeline_animation.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::TimelineAnimation;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::TimelineAnimationBuilder;
+
+TEST(Error, TimelineAnimationBuilder) {
+  TimelineAnimationBuilder builder;
+
+  {  // Invalid raw animation.
+    RawAnimation raw_animation;
+    raw_animation.duration = -1.f;
+    EXPECT_FALSE(builder(raw_animation));
+  }
+
+  {  // No track.
+    RawAnimation raw_animation;
+    raw_animation.name = "empty";
+    ozz::unique_ptr<TimelineAnimation> animation(builder(raw_animation));
+    ASSERT_TRUE(animation);
+    EXPECT_EQ(animation->num_tracks(), 0);
+    EXPECT_EQ(animation->num_frames(), 0);
+    EXPECT_STREQ(animation->name(), "empty");
+  }
+}
+
+TEST(Build, TimelineAnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.name = "timeline";
+  raw_animation.tracks.resize(5);
+
+  // Track 0 translations are keyed at .5 and 1.5, track 1 at .5 only (which
+  // makes it constant), and track 2 rotations at 1 and 2. Other tracks are
+  // empty.
+  const RawAnimation::TranslationKey t0 = {.5f,
+                                           ozz::math::Float3(1.f, 2.f, 3.f)};
+  const RawAnimation::TranslationKey t1 = {1.5f,
+                                           ozz::math::Float3(4.f, 5.f, 6.f)};
+  raw_animation.tracks[0].translations.push_back(t0);
+  raw_animation.tracks[0].translations.push_back(t1);
+  raw_animation.tracks[1].translations.push_back(t0);
+  const RawAnimation::RotationKey r0 = {
+      1.f, ozz::math::Quaternion::FromEuler(.5f, 0.f, 0.f)};
+  const RawAnimation::RotationKey r1 = {
+      2.f, ozz::math::Quaternion::FromEuler(1.f, 0.f, 0.f)};
+  raw_animation.tracks[2].rotations.push_back(r0);
+  raw_animation.tracks[2].rotations.push_back(r1);
+
+  TimelineAnimationBuilder builder;
+  ozz::unique_ptr<TimelineAnimation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+  EXPECT_EQ(animation->num_tracks(), 5);
+  EXPECT_EQ(animation->num_soa_tracks(), 2);
+  EXPECT_FLOAT_EQ(animation->duration(), 2.f);
+  EXPECT_STREQ(animation->name(), "timeline");
+
+  // Frames are the union of all keys times, including first and last ones.
+  ASSERT_EQ(animation->num_frames(), 5);
+  EXPECT_EQ(animation->num_presence_words(), 1);
+  EXPECT_FLOAT_EQ(animation->ratios()[0], 0.f);
+  EXPECT_FLOAT_EQ(animation->ratios()[1], .25f);
+  EXPECT_FLOAT_EQ(animation->ratios()[2], .5f);
+  EXPECT_FLOAT_EQ(animation->ratios()[3], .75f);
+  EXPECT_FLOAT_EQ(animation->ratios()[4], 1.f);
+
+  // Translations presence and values of the 8 SoA tracks.
+  ASSERT_EQ(animation->translation_presence().size(), 8u);
+  EXPECT_EQ(animation->translation_presence()[0], 0x1bu);
+  for (int i = 1; i < 8; ++i) {
+    EXPECT_EQ(animation->translation_presence()[i], 0x11u);
+  }
+  ASSERT_EQ(animation->translation_offsets().size(), 9u);
+  EXPECT_EQ(animation->translation_offsets()[0], 0u);
+  EXPECT_EQ(animation->translation_offsets()[1], 4u);
+  EXPECT_EQ(animation->translation_offsets()[2], 6u);
+  EXPECT_EQ(animation->translation_offsets()[8], 18u);
+  EXPECT_EQ(animation->translations().size(), 18u);
+
+  EXPECT_EQ(animation->rotation_presence()[2], 0x15u);
+  EXPECT_EQ(animation->rotation_presence()[3], 0x11u);
+  EXPECT_EQ(animation->rotations().size(), 17u);
+  EXPECT_EQ(animation->scales().size(), 16u);
+}
+
+TEST(Size, TimelineAnimationBuilder) {
+  // Dense baked clip, all tracks keyed at every frame.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(32);
+  const int kFrames = 31;
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int f = 0; f < kFrames; ++f) {
+      const float time = f / (kFrames - 1.f);
+      const float v = time + i;
+      const RawAnimation::TranslationKey t = {time,
+                                              ozz::math::Float3(v, -v, 0.f)};
+      track.translations.push_back(t);
+      const RawAnimation::RotationKey r = {
+          time, ozz::math::Quaternion::FromEuler(v, 0.f, 0.f)};
+      track.rotations.push_back(r);
+      const RawAnimation::ScaleKey s = {time,
+                                        ozz::math::Float3(1.f + time)};
+      track.scales.push_back(s);
+    }
+  }
+
+  TimelineAnimationBuilder builder;
+  ozz::unique_ptr<TimelineAnimation> timeline(builder(raw_animation));
+  ASSERT_TRUE(timeline);
+  EXPECT_EQ(timeline->num_frames(), kFrames);
+
+  AnimationBuilder animation_builder;
+  ozz::unique_ptr<Animation> animation(animation_builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  // Same keys count, without any ratio nor track index per key, which saves
+  // 6 bytes per translation and scale key, and 4 bytes per rotation key.
+  EXPECT_EQ(timeline->translations().size(),
+            animation->translations().size());
+  EXPECT_EQ(timeline->rotations().size(), animation->rotations().size());
+  EXPECT_EQ(timeline->scales().size(), animation->scales().size());
+  EXPECT_LT(timeline->size() * 3, animation->size() * 2);
+}
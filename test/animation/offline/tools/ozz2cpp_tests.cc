@@ -0,0 +1,130 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "gtest/gtest.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/local_to_model_registry.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/options/options.h"
+
+// Palette function generated by ozz2cpp, see CMakeLists.txt.
+void PabLocalToModelPalette(
+    ozz::span<const ozz::math::Float4x4> _models,
+    ozz::span<const ozz::math::Float4x4> _inverse_bind_poses,
+    ozz::span<ozz::math::Float4x4> _output);
+
+OZZ_OPTIONS_DECLARE_STRING(skeleton, "Skeleton the source was generated from",
+                           "", true)
+
+int main(int _argc, char** _argv) {
+  // Parses arguments.
+  testing::InitGoogleTest(&_argc, _argv);
+  ozz::options::ParseResult parse_result = ozz::options::ParseCommandLine(
+      _argc, _argv, "1.0", "Test ozz2cpp generated local-to-model function");
+  if (parse_result != ozz::options::kSuccess) {
+    return parse_result == ozz::options::kExitSuccess ? EXIT_SUCCESS
+                                                      : EXIT_FAILURE;
+  }
+
+  return RUN_ALL_TESTS();
+}
+
+TEST(Generated, Ozz2Cpp) {
+  ozz::io::File file(OPTIONS_skeleton, "rb");
+  ASSERT_TRUE(file.opened());
+  ozz::io::IArchive archive(&file);
+  ozz::animation::Skeleton skeleton;
+  archive >> skeleton;
+  ASSERT_GT(skeleton.num_joints(), 3);
+
+  // Generated function was registered at static initialization.
+  const ozz::animation::LocalToModelFn fn =
+      ozz::animation::FindLocalToModel(skeleton);
+  ASSERT_TRUE(fn != nullptr);
+
+  // Perturbs rest pose so that every joint has a non trivial transform.
+  const ozz::span<const ozz::math::SoaTransform> rest_poses =
+      skeleton.joint_rest_poses();
+  ozz::vector<ozz::math::SoaTransform> locals(rest_poses.begin(),
+                                              rest_poses.end());
+  for (size_t i = 0; i < locals.size(); ++i) {
+    const float f = .1f * static_cast<float>(i + 1);
+    locals[i].translation.y =
+        locals[i].translation.y + ozz::math::simd_float4::Load1(f);
+  }
+
+  const ozz::math::Float4x4 root =
+      ozz::math::Float4x4::Translation(ozz::math::simd_float4::Load(
+          1.f, 2.f, 3.f, 0.f));
+
+  ozz::vector<ozz::math::Float4x4> expected(skeleton.num_joints());
+  ozz::animation::LocalToModelJob job;
+  job.skeleton = &skeleton;
+  job.root = &root;
+  job.input = ozz::make_span(locals);
+  job.output = ozz::make_span(expected);
+  ASSERT_TRUE(job.Run());
+
+  ozz::vector<ozz::math::Float4x4> models(skeleton.num_joints());
+  fn(ozz::make_span(locals), root, ozz::make_span(models));
+  for (int i = 0; i < skeleton.num_joints(); ++i) {
+    const ozz::math::Float4x4& e = expected[i];
+    EXPECT_SIMDFLOAT_EQ_EST(models[i].cols[0], ozz::math::GetX(e.cols[0]),
+                            ozz::math::GetY(e.cols[0]),
+                            ozz::math::GetZ(e.cols[0]),
+                            ozz::math::GetW(e.cols[0]));
+    EXPECT_SIMDFLOAT_EQ_EST(models[i].cols[3], ozz::math::GetX(e.cols[3]),
+                            ozz::math::GetY(e.cols[3]),
+                            ozz::math::GetZ(e.cols[3]),
+                            ozz::math::GetW(e.cols[3]));
+  }
+
+  // Palette uses the remap table "3,1" (see CMakeLists.txt).
+  const ozz::math::Float4x4 ibps[2] = {
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(0.f, -1.f, 0.f, 0.f)),
+      ozz::math::Float4x4::identity()};
+  ozz::math::Float4x4 palette[2];
+  PabLocalToModelPalette(ozz::make_span(models), ibps, palette);
+  const ozz::math::Float4x4 palette0 = models[3] * ibps[0];
+  for (int c = 0; c < 4; ++c) {
+    EXPECT_SIMDFLOAT_EQ(palette[0].cols[c], ozz::math::GetX(palette0.cols[c]),
+                        ozz::math::GetY(palette0.cols[c]),
+                        ozz::math::GetZ(palette0.cols[c]),
+                        ozz::math::GetW(palette0.cols[c]));
+  }
+  EXPECT_SIMDFLOAT_EQ(palette[1].cols[3], ozz::math::GetX(models[1].cols[3]),
+                      ozz::math::GetY(models[1].cols[3]),
+                      ozz::math::GetZ(models[1].cols[3]),
+                      ozz::math::GetW(models[1].cols[3]));
+}
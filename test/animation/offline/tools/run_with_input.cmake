@@ -0,0 +1,23 @@
+# Runs the command following "--" on the command line, feeding its standard
+# input with ozz_input_file. Fails if the command returns a non zero code.
+# Usage: cmake -Dozz_input_file=file -P run_with_input.cmake -- command args
+
+set(command)
+set(found FALSE)
+math(EXPR last "${CMAKE_ARGC} - 1")
+foreach(i RANGE ${last})
+  if(found)
+    list(APPEND command "${CMAKE_ARGV${i}}")
+  elseif("${CMAKE_ARGV${i}}" STREQUAL "--")
+    set(found TRUE)
+  endif()
+endforeach()
+
+execute_process(
+  COMMAND ${command}
+  INPUT_FILE "${ozz_input_file}"
+  RESULT_VARIABLE result)
+
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "Command returned: ${result}")
+endif()
@@ -30,6 +30,8 @@
 #include "gtest/gtest.h"
 #include "ozz/animation/offline/raw_track.h"
 #include "ozz/animation/offline/track_builder.h"
+#include "ozz/animation/runtime/event_track.h"
+#include "ozz/animation/runtime/multi_float_track.h"
 #include "ozz/animation/runtime/track.h"
 #include "ozz/animation/runtime/track_sampling_job.h"
 #include "ozz/base/maths/gtest_math_helper.h"
@@ -1082,3 +1084,240 @@ TEST(Quaternion, TrackBuilder) {
     EXPECT_QUATERNION_EQ(result, 0.f, .70710677f, 0.f, .70710677f);
   }
 }
+
+TEST(MultiFloat, TrackBuilder) {
+  TrackBuilder builder;
+  ozz::animation::offline::RawMultiFloatTrack raw_track;
+
+  {  // Default is valid, and builds a track without channels.
+    EXPECT_TRUE(raw_track.Validate());
+    ozz::unique_ptr<ozz::animation::MultiFloatTrack> track(builder(raw_track));
+    ASSERT_TRUE(track);
+    EXPECT_EQ(track->num_channels(), 0);
+    EXPECT_EQ(track->ratios().size(), 2u);
+  }
+
+  raw_track.num_channels = 5;
+  raw_track.name = "face";
+
+  {  // Invalid number of channels.
+    raw_track.num_channels = -1;
+    EXPECT_FALSE(raw_track.Validate());
+    EXPECT_FALSE(builder(raw_track));
+    raw_track.num_channels = 5;
+  }
+
+  const ozz::animation::offline::RawMultiFloatTrack::Keyframe key0 = {
+      RawTrackInterpolation::kLinear, .2f, {1.f, 2.f, 3.f, 4.f, 5.f}};
+  raw_track.keyframes.push_back(key0);
+  const ozz::animation::offline::RawMultiFloatTrack::Keyframe key1 = {
+      RawTrackInterpolation::kStep, .6f, {6.f, 7.f, 8.f, 9.f, 10.f}};
+  raw_track.keyframes.push_back(key1);
+
+  {  // Missing channel value.
+    raw_track.keyframes[1].values.pop_back();
+    EXPECT_FALSE(raw_track.Validate());
+    EXPECT_FALSE(builder(raw_track));
+    raw_track.keyframes[1].values.push_back(10.f);
+  }
+
+  {  // Unsorted keys.
+    raw_track.keyframes[1].ratio = .1f;
+    EXPECT_FALSE(raw_track.Validate());
+    raw_track.keyframes[1].ratio = .6f;
+  }
+
+  EXPECT_TRUE(raw_track.Validate());
+  ozz::unique_ptr<ozz::animation::MultiFloatTrack> track(builder(raw_track));
+  ASSERT_TRUE(track);
+  EXPECT_STREQ(track->name(), "face");
+  EXPECT_EQ(track->num_channels(), 5);
+  EXPECT_EQ(track->num_soa_channels(), 2);
+
+  // First and last keys are added.
+  ASSERT_EQ(track->ratios().size(), 4u);
+  EXPECT_FLOAT_EQ(track->ratios()[0], 0.f);
+  EXPECT_FLOAT_EQ(track->ratios()[1], .2f);
+  EXPECT_FLOAT_EQ(track->ratios()[2], .6f);
+  EXPECT_FLOAT_EQ(track->ratios()[3], 1.f);
+  EXPECT_EQ(track->steps()[0], 1 << 2);
+
+  // Values are padded to SoA channels.
+  ASSERT_EQ(track->values().size(), 4u * 8u);
+  EXPECT_FLOAT_EQ(track->values()[0], 1.f);
+  EXPECT_FLOAT_EQ(track->values()[4], 5.f);
+  EXPECT_FLOAT_EQ(track->values()[5], 0.f);
+  EXPECT_FLOAT_EQ(track->values()[8 + 4], 5.f);
+  EXPECT_FLOAT_EQ(track->values()[16], 6.f);
+  EXPECT_FLOAT_EQ(track->values()[24 + 4], 10.f);
+}
+
+TEST(Event, TrackBuilder) {
+  TrackBuilder builder;
+  ozz::animation::offline::RawEventTrack raw_track;
+
+  {  // Default is valid, and builds a track without toggles.
+    EXPECT_TRUE(raw_track.Validate());
+    ozz::unique_ptr<ozz::animation::EventTrack> track(builder(raw_track));
+    ASSERT_TRUE(track);
+    EXPECT_EQ(track->num_toggles(), 0);
+    EXPECT_FALSE(track->State(.5f));
+  }
+
+  {  // Invalid ratio.
+    ozz::animation::offline::RawEventTrack invalid;
+    const ozz::animation::offline::RawEventTrack::Keyframe key = {1.1f, true};
+    invalid.keyframes.push_back(key);
+    EXPECT_FALSE(invalid.Validate());
+    EXPECT_FALSE(builder(invalid));
+  }
+
+  {  // Unsorted keys.
+    ozz::animation::offline::RawEventTrack invalid;
+    const ozz::animation::offline::RawEventTrack::Keyframe key0 = {.5f, true};
+    invalid.keyframes.push_back(key0);
+    const ozz::animation::offline::RawEventTrack::Keyframe key1 = {.2f,
+                                                                   false};
+    invalid.keyframes.push_back(key1);
+    EXPECT_FALSE(invalid.Validate());
+    ozz::animation::EventTrack track;
+    EXPECT_FALSE(builder(invalid, &track));
+    EXPECT_FALSE(builder(raw_track, nullptr));
+  }
+
+  raw_track.name = "contacts";
+  const ozz::animation::offline::RawEventTrack::Keyframe keys[] = {
+      {0.f, false}, {.2f, true},         {.3f, true},
+      {.5f, false}, {.6f, true},         {.6f + 1e-6f, false},
+      {.8f, true},  {.9f, true}};
+  raw_track.keyframes.assign(keys, keys + OZZ_ARRAY_SIZE(keys));
+  EXPECT_TRUE(raw_track.Validate());
+
+  ozz::unique_ptr<ozz::animation::EventTrack> track(builder(raw_track));
+  ASSERT_TRUE(track);
+  EXPECT_STREQ(track->name(), "contacts");
+
+  // Keys that don't change the state are skipped, and the empty window at .6
+  // is removed once quantized.
+  ASSERT_EQ(track->num_toggles(), 3);
+  EXPECT_NEAR(track->toggle_ratio(0), .2f, 1e-5f);
+  EXPECT_NEAR(track->toggle_ratio(1), .5f, 1e-5f);
+  EXPECT_NEAR(track->toggle_ratio(2), .8f, 1e-5f);
+  EXPECT_LT(track->size(), sizeof(ozz::animation::EventTrack) + 8u);
+}
+
+TEST(Quantize, TrackBuilder) {
+  TrackBuilder builder;
+  EXPECT_FALSE(builder.quantize);
+  builder.quantize = true;
+
+  RawFloatTrack raw_track;
+  const RawFloatTrack::Keyframe key0 = {RawTrackInterpolation::kLinear, .2f,
+                                        -2.f};
+  raw_track.keyframes.push_back(key0);
+  const RawFloatTrack::Keyframe key1 = {RawTrackInterpolation::kStep, .6f,
+                                        6.f};
+  raw_track.keyframes.push_back(key1);
+
+  {
+    ozz::unique_ptr<FloatTrack> track(builder(raw_track));
+    ASSERT_TRUE(track);
+    EXPECT_TRUE(track->quantized());
+    EXPECT_EQ(track->num_keys(), 4u);
+    EXPECT_TRUE(track->ratios().empty());
+    EXPECT_TRUE(track->values().empty());
+    ASSERT_EQ(track->compact_ratios().size(), 4u);
+    EXPECT_EQ(track->compact_ratios()[0], 0);
+    EXPECT_EQ(track->compact_ratios()[3], 65535);
+    ASSERT_EQ(track->compact_values().size(), 4u);
+    EXPECT_EQ(track->compact_values()[0], 0);
+    EXPECT_EQ(track->compact_values()[3], 65535);
+    EXPECT_FLOAT_EQ(track->quantization_offset().x, -2.f);
+    EXPECT_FLOAT_EQ(track->quantization_scale().x, 8.f / 65535.f);
+  }
+
+  {  // Falls back to float keys if ratios can't be quantized.
+    const RawFloatTrack::Keyframe key2 = {RawTrackInterpolation::kLinear,
+                                          .6f + 1e-6f, 3.f};
+    raw_track.keyframes.push_back(key2);
+    ozz::unique_ptr<FloatTrack> track(builder(raw_track));
+    ASSERT_TRUE(track);
+    EXPECT_FALSE(track->quantized());
+    EXPECT_EQ(track->num_keys(), 5u);
+    EXPECT_EQ(track->ratios().size(), 5u);
+  }
+}
+
+TEST(InPlace, TrackBuilder) {
+  TrackBuilder builder;
+
+  RawFloatTrack raw_track;
+  raw_track.name = "long name of a big track";
+  for (int i = 0; i < 10; ++i) {
+    const RawFloatTrack::Keyframe key = {RawTrackInterpolation::kLinear,
+                                         i / 10.f, static_cast<float>(i)};
+    raw_track.keyframes.push_back(key);
+  }
+
+  // Invalid cases.
+  EXPECT_FALSE(builder(raw_track, static_cast<FloatTrack*>(nullptr)));
+  FloatTrack track;
+  RawFloatTrack invalid;
+  const RawFloatTrack::Keyframe bad_key = {RawTrackInterpolation::kLinear, 2.f,
+                                           0.f};
+  invalid.keyframes.push_back(bad_key);
+  EXPECT_FALSE(builder(invalid, &track));
+  EXPECT_EQ(track.num_keys(), 0u);
+
+  // Builds big track.
+  ASSERT_TRUE(builder(raw_track, &track));
+  EXPECT_EQ(track.num_keys(), 11u);
+  EXPECT_STREQ(track.name(), "long name of a big track");
+  const float* data = track.values().data();
+
+  // Rebuilds a smaller quantized track in place, reusing track buffer.
+  raw_track.name = "small";
+  raw_track.keyframes.resize(3);
+  builder.quantize = true;
+  ASSERT_TRUE(builder(raw_track, &track));
+  EXPECT_TRUE(track.quantized());
+  EXPECT_EQ(track.num_keys(), 4u);
+  EXPECT_STREQ(track.name(), "small");
+  EXPECT_EQ(static_cast<const void*>(track.compact_values().data()),
+            static_cast<const void*>(data));
+
+  // Rebuilds a smaller float track, without name.
+  raw_track.name.clear();
+  builder.quantize = false;
+  ASSERT_TRUE(builder(raw_track, &track));
+  EXPECT_FALSE(track.quantized());
+  EXPECT_STREQ(track.name(), "");
+  EXPECT_EQ(track.values().data(), data);
+  EXPECT_FLOAT_EQ(track.quantization_scale().x, 0.f);
+
+  // Compares sampling with a newly allocated track.
+  ozz::unique_ptr<FloatTrack> reference(builder(raw_track));
+  ASSERT_TRUE(reference);
+  EXPECT_EQ(track.size(), reference->size());
+  for (int i = 0; i <= 10; ++i) {
+    float result, expected;
+    FloatTrackSamplingJob job;
+    job.ratio = i / 10.f;
+    job.track = &track;
+    job.result = &result;
+    ASSERT_TRUE(job.Run());
+    job.track = reference.get();
+    job.result = &expected;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(result, expected);
+  }
+
+  // Rebuilds a bigger track, which reallocates.
+  const RawFloatTrack::Keyframe last = raw_track.keyframes.back();
+  raw_track.keyframes.resize(40, last);
+  for (size_t i = 0; i < raw_track.keyframes.size(); ++i) {
+    raw_track.keyframes[i].ratio = i / 40.f;
+  }
+  ASSERT_TRUE(builder(raw_track, &track));
+  EXPECT_EQ(track.num_keys(), 41u);
+}
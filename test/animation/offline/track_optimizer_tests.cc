@@ -26,6 +26,7 @@
 //----------------------------------------------------------------------------//
 
 #include "ozz/animation/offline/track_optimizer.h"
+#include "ozz/base/gtest_parallel_for_helper.h"
 
 #include "gtest/gtest.h"
 #include "ozz/base/maths/gtest_math_helper.h"
@@ -400,3 +401,62 @@ TEST(Quaternion, TrackOptimizer) {
   EXPECT_QUATERNION_EQ(output.keyframes[1].value, key2.value.x, key2.value.y,
                        key2.value.z, key2.value.w);
 }
+
+TEST(Batch, TrackOptimizer) {
+  RawFloat3Track inputs[3];
+  for (int t = 0; t < 3; ++t) {
+    inputs[t].name = t == 0 ? "a" : (t == 1 ? "b" : "c");
+    for (int i = 0; i < 11; ++i) {
+      const RawFloat3Track::Keyframe key = {
+          RawTrackInterpolation::kLinear, i / 10.f,
+          ozz::math::Float3(static_cast<float>(i * t), 0.f,
+                            static_cast<float>(i % 2))};
+      inputs[t].keyframes.push_back(key);
+    }
+  }
+
+  TrackOptimizer optimizer;
+
+  {  // Output too small.
+    RawFloat3Track outputs[2];
+    EXPECT_FALSE(optimizer(inputs, outputs));
+  }
+
+  RawFloat3Track serial[3];
+  for (int t = 0; t < 3; ++t) {
+    ASSERT_TRUE(optimizer(inputs[t], &serial[t]));
+  }
+
+  {  // Serial batch.
+    RawFloat3Track outputs[3];
+    ASSERT_TRUE(optimizer(inputs, outputs));
+    for (int t = 0; t < 3; ++t) {
+      EXPECT_STREQ(outputs[t].name.c_str(), inputs[t].name.c_str());
+      ASSERT_EQ(outputs[t].keyframes.size(), serial[t].keyframes.size());
+    }
+  }
+
+  // Outlives the parallel block, as optimizer keeps pointing to it.
+  int tasks = 0;
+  {  // Parallel batch.
+    optimizer.parallel_for = &ReverseParallelFor;
+    optimizer.parallel_for_user_data = &tasks;
+    RawFloat3Track outputs[3];
+    ASSERT_TRUE(optimizer(inputs, outputs));
+    EXPECT_EQ(tasks, 3);
+    for (int t = 0; t < 3; ++t) {
+      ASSERT_EQ(outputs[t].keyframes.size(), serial[t].keyframes.size());
+      for (size_t k = 0; k < serial[t].keyframes.size(); ++k) {
+        EXPECT_EQ(outputs[t].keyframes[k].ratio, serial[t].keyframes[k].ratio);
+      }
+    }
+  }
+
+  {  // Invalid track.
+    inputs[1].keyframes[2].ratio = 2.f;
+    RawFloat3Track outputs[3];
+    EXPECT_FALSE(optimizer(inputs, outputs));
+    EXPECT_EQ(outputs[0].keyframes.size(), serial[0].keyframes.size());
+    EXPECT_TRUE(outputs[1].keyframes.empty());
+  }
+}
@@ -0,0 +1,190 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/offline/uniform_animation_builder.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/uniform_animation.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::UniformAnimation;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::UniformAnimationBuilder;
+
+TEST(Error, UniformAnimationBuilder) {
+  UniformAnimationBuilder builder;
+
+  {  // Invalid duration.
+    RawAnimation raw_animation;
+    raw_animation.duration = 0.f;
+    EXPECT_FALSE(raw_animation.Validate());
+    EXPECT_TRUE(!builder(raw_animation));
+  }
+
+  {  // Unsorted keys.
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(1);
+    const RawAnimation::TranslationKey first = {.8f, ozz::math::Float3(0.f)};
+    raw_animation.tracks[0].translations.push_back(first);
+    const RawAnimation::TranslationKey second = {.2f, ozz::math::Float3(0.f)};
+    raw_animation.tracks[0].translations.push_back(second);
+    EXPECT_FALSE(raw_animation.Validate());
+    EXPECT_TRUE(!builder(raw_animation));
+    EXPECT_FLOAT_EQ(builder.KeyDensity(raw_animation), 0.f);
+  }
+
+  {  // Invalid frame rate.
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(1);
+    UniformAnimationBuilder zero_rate;
+    zero_rate.frame_rate = 0.f;
+    EXPECT_TRUE(!zero_rate(raw_animation));
+  }
+}
+
+TEST(Build, UniformAnimationBuilder) {
+  UniformAnimationBuilder builder;
+
+  {  // No track.
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.name = "uniform";
+    ozz::unique_ptr<UniformAnimation> animation(builder(raw_animation));
+    ASSERT_TRUE(animation);
+    EXPECT_EQ(animation->num_tracks(), 0);
+    EXPECT_EQ(animation->num_soa_tracks(), 0);
+    EXPECT_EQ(animation->num_frames(), 31);
+    EXPECT_TRUE(animation->frames().empty());
+    EXPECT_STREQ(animation->name(), "uniform");
+  }
+
+  {  // Frames are spread over the whole duration, first and last included.
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.01f;
+    raw_animation.tracks.resize(5);
+    ozz::unique_ptr<UniformAnimation> animation(builder(raw_animation));
+    ASSERT_TRUE(animation);
+    EXPECT_FLOAT_EQ(animation->duration(), 1.01f);
+    EXPECT_EQ(animation->num_tracks(), 5);
+    EXPECT_EQ(animation->num_soa_tracks(), 2);
+    EXPECT_EQ(animation->num_frames(), 32);
+    EXPECT_EQ(animation->frames().size(), 2u * 10 * 4 * 32);
+    EXPECT_EQ(animation->ranges().size(), 2u * 10 * 4 * 2);
+    EXPECT_STREQ(animation->name(), "");
+  }
+
+  {  // Short animations still have 2 frames.
+    RawAnimation raw_animation;
+    raw_animation.duration = .001f;
+    raw_animation.tracks.resize(1);
+    ozz::unique_ptr<UniformAnimation> animation(builder(raw_animation));
+    ASSERT_TRUE(animation);
+    EXPECT_EQ(animation->num_frames(), 2);
+  }
+}
+
+TEST(Quantization, UniformAnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  const RawAnimation::TranslationKey t0 = {0.f,
+                                           ozz::math::Float3(-1.f, 2.f, 3.f)};
+  raw_animation.tracks[0].translations.push_back(t0);
+  const RawAnimation::TranslationKey t1 = {1.f,
+                                           ozz::math::Float3(1.f, 2.f, 7.f)};
+  raw_animation.tracks[0].translations.push_back(t1);
+
+  UniformAnimationBuilder builder;
+  builder.frame_rate = 2.f;
+  ozz::unique_ptr<UniformAnimation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+  ASSERT_EQ(animation->num_frames(), 3);
+
+  // Translation x range: mins first, steps then.
+  const ozz::span<const float> ranges = animation->ranges();
+  EXPECT_FLOAT_EQ(ranges[0], -1.f);
+  EXPECT_FLOAT_EQ(ranges[4], 2.f / 65535.f);
+
+  // Constant translation y has a null step.
+  EXPECT_FLOAT_EQ(ranges[8], 2.f);
+  EXPECT_FLOAT_EQ(ranges[12], 0.f);
+
+  // Padding lanes are identity, hence constant.
+  EXPECT_FLOAT_EQ(ranges[1], 0.f);
+  EXPECT_FLOAT_EQ(ranges[5], 0.f);
+
+  // Frames of translation x, lane 0.
+  const ozz::span<const uint16_t> frames = animation->frames();
+  const size_t stride = 10 * 4;
+  EXPECT_EQ(frames[0], 0);
+  EXPECT_NEAR(frames[stride], 32768, 1);
+  EXPECT_EQ(frames[2 * stride], 65535);
+
+  // Frames of translation z, lane 0.
+  EXPECT_EQ(frames[8], 0);
+  EXPECT_NEAR(frames[stride + 8], 32768, 1);
+  EXPECT_EQ(frames[2 * stride + 8], 65535);
+}
+
+TEST(Density, UniformAnimationBuilder) {
+  UniformAnimationBuilder builder;
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  EXPECT_FLOAT_EQ(builder.KeyDensity(raw_animation), 0.f);
+  EXPECT_FALSE(builder.IsDense(raw_animation));
+
+  // 31 frames for 2 tracks, 3 channels each.
+  raw_animation.tracks.resize(2);
+  EXPECT_FLOAT_EQ(builder.KeyDensity(raw_animation), 0.f);
+  EXPECT_FALSE(builder.IsDense(raw_animation));
+
+  // Keys every frame for 2 channels of the 6.
+  for (int i = 0; i <= 30; ++i) {
+    const float time = i / 30.f;
+    const RawAnimation::TranslationKey t = {time, ozz::math::Float3(i * 1.f)};
+    raw_animation.tracks[0].translations.push_back(t);
+    const RawAnimation::RotationKey r = {
+        time, ozz::math::Quaternion::FromEuler(i * .1f, 0.f, 0.f)};
+    raw_animation.tracks[1].rotations.push_back(r);
+  }
+  EXPECT_FLOAT_EQ(builder.KeyDensity(raw_animation), 1.f / 3.f);
+  EXPECT_FALSE(builder.IsDense(raw_animation));
+
+  // Densities are relative to the frame rate.
+  builder.frame_rate = 15.f;
+  EXPECT_FLOAT_EQ(builder.KeyDensity(raw_animation), 62.f / (3.f * 2 * 16));
+  EXPECT_TRUE(builder.IsDense(raw_animation));
+
+  builder.frame_rate = 30.f;
+  builder.min_density = .3f;
+  EXPECT_TRUE(builder.IsDense(raw_animation));
+}
@@ -0,0 +1,177 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/additive_delta_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+using ozz::animation::AdditiveDeltaJob;
+using ozz::animation::BlendingJob;
+
+TEST(JobValidity, AdditiveDeltaJob) {
+  ozz::math::SoaTransform reference[2];
+  ozz::math::SoaTransform input[2];
+  ozz::math::SoaTransform output[2];
+
+  {  // Default job is valid, with nothing to process.
+    AdditiveDeltaJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Reference too small.
+    AdditiveDeltaJob job;
+    job.reference = ozz::make_span(reference).first(1);
+    job.input = input;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Output too small.
+    AdditiveDeltaJob job;
+    job.reference = reference;
+    job.input = input;
+    job.output = ozz::make_span(output).first(1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid, bigger reference and output.
+    AdditiveDeltaJob job;
+    job.reference = reference;
+    job.input = ozz::make_span(input).first(1);
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+namespace {
+void InitPoses(ozz::math::SoaTransform* _reference,
+               ozz::math::SoaTransform* _input) {
+  _reference->translation = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f),
+      ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 7.f),
+      ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 11.f));
+  _reference->rotation = ozz::math::SoaQuaternion::Load(
+      ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, .382683432f),
+      ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(.70710677f, 1.f, .70710677f, .9238795f));
+  _reference->scale = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(1.f, 2.f, 4.f, 1.f),
+      ozz::math::simd_float4::Load(1.f, 2.f, 4.f, -1.f),
+      ozz::math::simd_float4::Load(1.f, 2.f, 4.f, .5f));
+
+  _input->translation = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(1.f, 1.f, 0.f, 3.f),
+      ozz::math::simd_float4::Load(4.f, 7.f, 6.f, 7.f),
+      ozz::math::simd_float4::Load(8.f, 9.f, 12.f, 11.f));
+  _input->rotation = ozz::math::SoaQuaternion::Load(
+      ozz::math::simd_float4::Load(.70710677f, .70710677f, 0.f, .382683432f),
+      ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+      ozz::math::simd_float4::Load(.70710677f, .70710677f, .70710677f,
+                                   .9238795f));
+  _input->scale = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(2.f, 2.f, 2.f, 1.f),
+      ozz::math::simd_float4::Load(1.f, 4.f, 2.f, 1.f),
+      ozz::math::simd_float4::Load(1.f, 2.f, 8.f, 1.f));
+}
+}  // namespace
+
+TEST(Delta, AdditiveDeltaJob) {
+  ozz::math::SoaTransform reference[1];
+  ozz::math::SoaTransform input[1];
+  InitPoses(reference, input);
+
+  ozz::math::SoaTransform output[1];
+  AdditiveDeltaJob job;
+  job.reference = reference;
+  job.input = input;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, 1.f, 0.f, -2.f, 0.f, 0.f, 2.f,
+                      0.f, 0.f, 0.f, 0.f, 2.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ(output[0].rotation, 0.f, .70710677f, .5f, 0.f, 0.f,
+                          0.f, -.5f, 0.f, 0.f, 0.f, .5f, 0.f, 1.f, .70710677f,
+                          .5f, 1.f);
+  EXPECT_SOAFLOAT3_EQ(output[0].scale, 2.f, 1.f, .5f, 1.f, 1.f, 2.f, .5f, -1.f,
+                      1.f, 1.f, 2.f, 2.f);
+
+  // In-place computation gives the same result.
+  ozz::math::SoaTransform in_place[1] = {input[0]};
+  job.input = in_place;
+  job.output = in_place;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ(in_place[0].translation, 1.f, 0.f, -2.f, 0.f, 0.f, 2.f,
+                      0.f, 0.f, 0.f, 0.f, 2.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(in_place[0].scale, 2.f, 1.f, .5f, 1.f, 1.f, 2.f, .5f,
+                      -1.f, 1.f, 1.f, 2.f, 2.f);
+}
+
+TEST(AdditiveLayer, AdditiveDeltaJob) {
+  ozz::math::SoaTransform reference[1];
+  ozz::math::SoaTransform input[1];
+  InitPoses(reference, input);
+
+  ozz::math::SoaTransform delta[1];
+  AdditiveDeltaJob delta_job;
+  delta_job.reference = reference;
+  delta_job.input = input;
+  delta_job.output = delta;
+  ASSERT_TRUE(delta_job.Run());
+
+  // Adding the delta to the reference restores input pose.
+  BlendingJob::Layer layers[1];
+  layers[0].transform = reference;
+  layers[0].weight = 1.f;
+  BlendingJob::Layer additive_layers[1];
+  additive_layers[0].transform = delta;
+  additive_layers[0].weight = 1.f;
+
+  ozz::math::SoaTransform output[1];
+  BlendingJob job;
+  job.layers = layers;
+  job.additive_layers = additive_layers;
+  job.rest_pose = reference;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, 1.f, 1.f, 0.f, 3.f, 4.f, 7.f, 6.f,
+                      7.f, 8.f, 9.f, 12.f, 11.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, .70710677f, .70710677f, 0.f,
+                              .382683432f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                              .70710677f, 0.f, .70710677f, .70710677f,
+                              .70710677f, .9238795f);
+  EXPECT_SOAFLOAT3_EQ(output[0].scale, 2.f, 2.f, 2.f, 1.f, 1.f, 4.f, 2.f, 1.f,
+                      1.f, 2.f, 8.f, 1.f);
+}
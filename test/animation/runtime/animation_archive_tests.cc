@@ -25,15 +25,24 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "ozz/animation/offline/animation_builder.h"
 #include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/runtime/animation.h"
 #include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/gtest_parallel_for_helper.h"
 #include "ozz/base/io/archive.h"
 #include "ozz/base/io/stream.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/huge_page_allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
 #include "ozz/base/memory/unique_ptr.h"
 
 using ozz::animation::Animation;
@@ -178,3 +187,820 @@ TEST(AlreadyInitialized, AnimationSerialize) {
     ASSERT_EQ(i_animation.num_tracks(), 2);
   }
 }
+
+TEST(Allocator, AnimationSerialize) {
+  ozz::io::MemoryStream stream;
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(3);
+  const RawAnimation::TranslationKey key = {.5f, ozz::math::Float3(1.f)};
+  raw_animation.tracks[1].translations.push_back(key);
+
+  ozz::memory::TrackingAllocator allocator;
+  {
+    // Builds in place with a specific allocator.
+    Animation o_animation(&allocator);
+    EXPECT_EQ(o_animation.allocator(), &allocator);
+    AnimationBuilder builder;
+    ASSERT_TRUE(builder(raw_animation, &o_animation));
+    EXPECT_EQ(allocator.total().live_allocations, 1u);
+
+    ozz::io::OArchive o(&stream);
+    o << o_animation;
+  }
+  EXPECT_EQ(allocator.total().live_allocations, 0u);
+
+  {
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    // Loads with a specific allocator.
+    Animation i_animation(&allocator);
+    i >> i_animation;
+    EXPECT_EQ(i_animation.num_tracks(), 3);
+    EXPECT_EQ(allocator.total().live_allocations, 1u);
+    EXPECT_GT(allocator.total().live_bytes, 0u);
+
+    // Allocator follows animation buffers when moved.
+    Animation moved(std::move(i_animation));
+    EXPECT_EQ(moved.allocator(), &allocator);
+    EXPECT_TRUE(i_animation.allocator() == nullptr);
+    EXPECT_EQ(moved.num_tracks(), 3);
+  }
+  EXPECT_EQ(allocator.total().live_allocations, 0u);
+  EXPECT_EQ(allocator.total().allocations, 2u);
+}
+
+TEST(HugePageAllocator, AnimationSerialize) {
+  ozz::io::MemoryStream stream;
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(3);
+  const RawAnimation::TranslationKey key = {.5f, ozz::math::Float3(1.f)};
+  raw_animation.tracks[1].translations.push_back(key);
+  {
+    AnimationBuilder builder;
+    ozz::unique_ptr<Animation> o_animation = builder(raw_animation);
+    ASSERT_TRUE(o_animation);
+    ozz::io::OArchive o(&stream);
+    o << *o_animation;
+  }
+
+  // Huge page allocator is selected at load time.
+  ozz::memory::HugePageAllocator allocator;
+  {
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    Animation i_animation(&allocator);
+    i >> i_animation;
+    EXPECT_EQ(i_animation.num_tracks(), 3);
+    EXPECT_EQ(allocator.stats().used_blocks, 1u);
+
+    // Samples loaded animation.
+    ozz::animation::SamplingJob::Context context(1);
+    ozz::math::SoaTransform output[1];
+    ozz::animation::SamplingJob job;
+    job.animation = &i_animation;
+    job.context = &context;
+    job.ratio = .5f;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ(output[0].translation, 0.f, 1.f, 0.f, 0.f, 0.f, 1.f,
+                        0.f, 0.f, 0.f, 1.f, 0.f, 0.f);
+  }
+  EXPECT_EQ(allocator.stats().used_blocks, 0u);
+}
+
+TEST(SeekPoints, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(5);
+  for (int i = 0; i < 10; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i * .2f, ozz::math::Float3(static_cast<float>(i), 0.f, 0.f)};
+    raw_animation.tracks[3].translations.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  builder.seek_interval = .5f;
+  ozz::unique_ptr<Animation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+  ASSERT_EQ(o_animation->num_seek_points(), 3);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    Animation i_animation;
+    i >> i_animation;
+
+    EXPECT_EQ(o_animation->size(), i_animation.size());
+    ASSERT_EQ(o_animation->num_seek_points(), i_animation.num_seek_points());
+    EXPECT_EQ(memcmp(o_animation->seek_table().data(),
+                     i_animation.seek_table().data(),
+                     o_animation->seek_table().size_bytes()),
+              0);
+
+    // Samples backward, which uses seek points.
+    ozz::animation::SamplingJob job;
+    ozz::animation::SamplingJob::Context context(5);
+    ozz::math::SoaTransform output[2];
+    job.animation = &i_animation;
+    job.context = &context;
+    job.output = output;
+    job.ratio = 1.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 0.f, 0.f, 0.f, 9.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+    job.ratio = .6f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 0.f, 0.f, 0.f, 6.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  }
+}
+
+TEST(Bidirectional, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(3);
+  for (int i = 0; i < 10; ++i) {
+    const RawAnimation::RotationKey key = {
+        i * .1f, ozz::math::Quaternion::FromAxisAngle(
+                     ozz::math::Float3::y_axis(), i * .1f)};
+    raw_animation.tracks[1].rotations.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  builder.bidirectional = true;
+  ozz::unique_ptr<Animation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+  ASSERT_TRUE(o_animation->bidirectional());
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    Animation i_animation;
+    i >> i_animation;
+
+    EXPECT_EQ(o_animation->size(), i_animation.size());
+    ASSERT_TRUE(i_animation.bidirectional());
+    ASSERT_EQ(o_animation->rotation_previouses().size(),
+              i_animation.rotation_previouses().size());
+    EXPECT_EQ(memcmp(o_animation->rotation_previouses().data(),
+                     i_animation.rotation_previouses().data(),
+                     o_animation->rotation_previouses().size_bytes()),
+              0);
+  }
+}
+
+TEST(RotationFormats, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(3);
+  for (int i = 0; i < 10; ++i) {
+    const RawAnimation::RotationKey key = {
+        i * .1f, ozz::math::Quaternion::FromAxisAngle(
+                     ozz::math::Float3::y_axis(), i * -.2f)};
+    raw_animation.tracks[2].rotations.push_back(key);
+  }
+
+  const AnimationBuilder::RotationFormat formats[] = {
+      AnimationBuilder::kRotationCompact48,
+      AnimationBuilder::kRotationCompact32};
+  for (size_t f = 0; f < OZZ_ARRAY_SIZE(formats); ++f) {
+    AnimationBuilder builder;
+    builder.rotation_format = formats[f];
+    ozz::unique_ptr<Animation> o_animation(builder(raw_animation));
+    ASSERT_TRUE(o_animation);
+    ASSERT_TRUE(o_animation->rotations().empty());
+
+    for (int e = 0; e < 2; ++e) {
+      ozz::Endianness endianess =
+          e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+      ozz::io::MemoryStream stream;
+
+      // Streams out.
+      ozz::io::OArchive o(&stream, endianess);
+      o << *o_animation;
+
+      // Streams in.
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+
+      Animation i_animation;
+      i >> i_animation;
+
+      EXPECT_EQ(o_animation->size(), i_animation.size());
+      EXPECT_TRUE(i_animation.rotations().empty());
+      EXPECT_EQ(o_animation->compact_rotations().size(),
+                i_animation.compact_rotations().size());
+      EXPECT_EQ(o_animation->packed_rotations().size(),
+                i_animation.packed_rotations().size());
+
+      // Sampling both animations should give the same result.
+      ozz::animation::SamplingJob::Context context(3);
+      ozz::math::SoaTransform o_output[1];
+      ozz::math::SoaTransform i_output[1];
+      for (float ratio = 0.f; ratio <= 1.f; ratio += .05f) {
+        ozz::animation::SamplingJob job;
+        job.context = &context;
+        job.ratio = ratio;
+        job.animation = o_animation.get();
+        job.output = o_output;
+        ASSERT_TRUE(job.Run());
+        job.animation = &i_animation;
+        job.output = i_output;
+        ASSERT_TRUE(job.Run());
+        EXPECT_EQ(memcmp(o_output, i_output, sizeof(i_output)), 0);
+      }
+    }
+  }
+}
+
+TEST(ParallelFor, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+  for (int i = 0; i < 3000; ++i) {
+    const float time = i / 3000.f;
+    for (int t = 0; t < 5; ++t) {
+      RawAnimation::JointTrack& track = raw_animation.tracks[t];
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(i * .1f, t * 1.f, std::sin(i * .1f))};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::y_axis(), i * .01f * t)};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f + std::cos(i * .1f))};
+      track.scales.push_back(skey);
+    }
+  }
+
+  const AnimationBuilder::RotationFormat formats[] = {
+      AnimationBuilder::kRotationDefault,
+      AnimationBuilder::kRotationCompact48,
+      AnimationBuilder::kRotationCompact32};
+  for (size_t f = 0; f < OZZ_ARRAY_SIZE(formats); ++f) {
+    AnimationBuilder builder;
+    builder.rotation_format = formats[f];
+    builder.compact_ratios = f == 1;
+    ozz::unique_ptr<Animation> o_animation(builder(raw_animation));
+    ASSERT_TRUE(o_animation);
+
+    for (int e = 0; e < 4; ++e) {
+      ozz::Endianness endianess =
+          e % 2 == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+      const bool compressed = e >= 2;
+      ozz::io::MemoryStream stream;
+      {  // Streams out. Compressed keys span many blocks.
+        ozz::io::OArchive o(&stream, endianess, compressed);
+        o << *o_animation;
+      }
+
+      // Streams in.
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::io::IArchive i(&stream);
+      int tasks = 0;
+      i.set_parallel_for(&ReverseParallelFor, &tasks);
+      EXPECT_TRUE(i.parallel_for() == &ReverseParallelFor);
+
+      Animation i_animation;
+      i >> i_animation;
+      // Compressed blocks are decompressed in parallel too.
+      if (compressed) {
+        EXPECT_GT(tasks, 3);
+      } else {
+        EXPECT_EQ(tasks, 3);
+      }
+      EXPECT_EQ(o_animation->size(), i_animation.size());
+
+      // Sampling both animations should give the same result.
+      ozz::animation::SamplingJob::Context context(5);
+      ozz::math::SoaTransform o_output[2];
+      ozz::math::SoaTransform i_output[2];
+      for (float ratio = 0.f; ratio <= 1.f; ratio += .05f) {
+        ozz::animation::SamplingJob job;
+        job.context = &context;
+        job.ratio = ratio;
+        job.animation = o_animation.get();
+        job.output = o_output;
+        ASSERT_TRUE(job.Run());
+        job.animation = &i_animation;
+        job.output = i_output;
+        ASSERT_TRUE(job.Run());
+        EXPECT_EQ(memcmp(o_output, i_output, sizeof(i_output)), 0);
+      }
+    }
+  }
+}
+
+TEST(InvalidTrack, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(8);
+  const RawAnimation::TranslationKey key = {.5f,
+                                            ozz::math::Float3(1.f, 2.f, 3.f)};
+  raw_animation.tracks[7].translations.push_back(key);
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+
+  for (int p = 0; p < 2; ++p) {
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+      o << *o_animation;
+    }
+
+    // Patches number of tracks, which follows endianness byte, tag, version
+    // and duration, so that keys of tracks 4 to 7 are out of range.
+    const int64_t offset = 1 + sizeof("ozz-animation") + sizeof(uint32_t) +
+                           sizeof(float);
+    const int32_t num_tracks = 4;
+    stream.Seek(offset, ozz::io::Stream::kSet);
+    stream.Write(&num_tracks, sizeof(num_tracks));
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    int tasks = 0;
+    if (p == 1) {
+      i.set_parallel_for(&ReverseParallelFor, &tasks);
+    }
+    Animation i_animation;
+    i >> i_animation;
+    EXPECT_EQ(i_animation.num_tracks(), 0);
+    EXPECT_EQ(i_animation.translations().size(), 0u);
+    EXPECT_EQ(tasks, p == 1 ? 3 : 0);
+  }
+}
+
+TEST(InvalidSeekTable, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(5);
+  for (int i = 0; i < 10; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i * .2f, ozz::math::Float3(static_cast<float>(i), 0.f, 0.f)};
+    raw_animation.tracks[3].translations.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  builder.seek_interval = .5f;
+  ozz::unique_ptr<Animation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+  ASSERT_EQ(o_animation->num_seek_points(), 3);
+  const ozz::span<const int> seek_table = o_animation->seek_table();
+
+  // Seek table size follows endianness byte, tag, version, duration, number of
+  // tracks, name length and translation, rotation and scale keys counts.
+  const int64_t size_offset = 1 + sizeof("ozz-animation") + sizeof(uint32_t) +
+                              sizeof(float) + sizeof(int32_t) * 5;
+
+  for (int p = 0; p < 4; ++p) {
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+      o << *o_animation;
+    }
+
+    if (p < 3) {  // Patches seek table size.
+      const int32_t sizes[] = {static_cast<int32_t>(seek_table.size()) + 1, -1,
+                               static_cast<int32_t>(seek_table.size())};
+      int32_t size;
+      stream.Seek(size_offset, ozz::io::Stream::kSet);
+      stream.Read(&size, sizeof(size));
+      EXPECT_EQ(size, sizes[2]);
+      stream.Seek(size_offset, ozz::io::Stream::kSet);
+      stream.Write(&sizes[p], sizeof(sizes[p]));
+    } else {  // Patches a cached key index of the seek table.
+      ozz::vector<char> buffer(static_cast<size_t>(stream.Size()));
+      stream.Seek(0, ozz::io::Stream::kSet);
+      stream.Read(buffer.data(), buffer.size());
+      const char* found = std::search(
+          buffer.data(), buffer.data() + buffer.size(),
+          reinterpret_cast<const char*>(seek_table.data()),
+          reinterpret_cast<const char*>(seek_table.data() + seek_table.size()));
+      ASSERT_NE(found, buffer.data() + buffer.size());
+      const int32_t index = 1000;
+      stream.Seek(found - buffer.data() + sizeof(int32_t) * 3,
+                  ozz::io::Stream::kSet);
+      stream.Write(&index, sizeof(index));
+    }
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    Animation i_animation;
+    i >> i_animation;
+    if (p == 2) {  // Unchanged size.
+      EXPECT_EQ(i_animation.num_tracks(), 5);
+      EXPECT_EQ(i_animation.num_seek_points(), 3);
+    } else {
+      EXPECT_EQ(i_animation.num_tracks(), 0);
+      EXPECT_EQ(i_animation.num_seek_points(), 0);
+      EXPECT_EQ(i_animation.translations().size(), 0u);
+    }
+  }
+}
+
+TEST(InvalidCounts, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(9);
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+  ASSERT_EQ(o_animation->constant_translations().size(), 1u);
+
+  // Header counts follow endianness byte, tag, version and duration. Constant
+  // flags count follows number of tracks, name length, translation, rotation
+  // and scale keys counts, seek table size, bidirectional flag and keys
+  // formats.
+  const int64_t tracks_offset =
+      1 + sizeof("ozz-animation") + sizeof(uint32_t) + sizeof(float);
+  const int64_t translations_offset = tracks_offset + sizeof(int32_t) * 2;
+  const int64_t flags_offset = tracks_offset + sizeof(int32_t) * 6 +
+                               sizeof(bool) + sizeof(uint8_t) * 3;
+
+  const struct {
+    int64_t offset;
+    int32_t value;
+    bool valid;
+  } patches[] = {{tracks_offset, -1, false},
+                 {translations_offset, -1, false},
+                 {flags_offset, -1, false},
+                 {flags_offset, 2, false},
+                 {flags_offset, 0, true},
+                 {flags_offset, 1, true}};
+
+  for (const auto& patch : patches) {
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+      o << *o_animation;
+    }
+    stream.Seek(patch.offset, ozz::io::Stream::kSet);
+    stream.Write(&patch.value, sizeof(patch.value));
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    Animation i_animation;
+    i >> i_animation;
+    if (patch.valid) {
+      EXPECT_EQ(i_animation.num_tracks(), 9);
+      EXPECT_EQ(i_animation.constant_translations().size(),
+                static_cast<size_t>(patch.value));
+    } else {
+      EXPECT_EQ(i_animation.num_tracks(), 0);
+      EXPECT_EQ(i_animation.constant_translations().size(), 0u);
+    }
+  }
+}
+
+TEST(CompactRatios, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  for (int i = 0; i < 10; ++i) {
+    const RawAnimation::TranslationKey tkey = {
+        i * .1f, ozz::math::Float3(0.f, i * 2.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(tkey);
+    const RawAnimation::ScaleKey skey = {
+        i * .1f, ozz::math::Float3(1.f, 1.f, 1.f + i)};
+    raw_animation.tracks[1].scales.push_back(skey);
+  }
+
+  AnimationBuilder builder;
+  builder.compact_ratios = true;
+  ozz::unique_ptr<Animation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+  ASSERT_TRUE(o_animation->translations().empty());
+  ASSERT_TRUE(o_animation->scales().empty());
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    Animation i_animation;
+    i >> i_animation;
+
+    EXPECT_EQ(o_animation->size(), i_animation.size());
+    EXPECT_TRUE(i_animation.translations().empty());
+    EXPECT_EQ(o_animation->compact_translations().size(),
+              i_animation.compact_translations().size());
+    EXPECT_TRUE(i_animation.scales().empty());
+    EXPECT_EQ(o_animation->compact_scales().size(),
+              i_animation.compact_scales().size());
+
+    ozz::animation::SamplingJob job;
+    ozz::animation::SamplingJob::Context context(2);
+    ozz::math::SoaTransform output[1];
+    job.animation = &i_animation;
+    job.context = &context;
+    job.output = output;
+    job.ratio = .5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 0.f, 0.f, 0.f, 0.f, 10.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                            1.f, 1.f, 6.f, 1.f, 1.f);
+  }
+}
+
+TEST(ConstantTracks, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(9);
+  for (int i = 0; i < 2; ++i) {
+    const RawAnimation::ScaleKey key = {
+        i * .5f, ozz::math::Float3(1.f, 1.f, 1.f + i)};
+    raw_animation.tracks[6].scales.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+  ASSERT_EQ(o_animation->constant_scales().size(), 1u);
+  EXPECT_EQ(o_animation->constant_scales()[0], 5);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    Animation i_animation;
+    i >> i_animation;
+
+    EXPECT_EQ(o_animation->size(), i_animation.size());
+    ASSERT_EQ(i_animation.constant_translations().size(), 1u);
+    EXPECT_EQ(i_animation.constant_translations()[0], 7);
+    ASSERT_EQ(i_animation.constant_rotations().size(), 1u);
+    EXPECT_EQ(i_animation.constant_rotations()[0], 7);
+    ASSERT_EQ(i_animation.constant_scales().size(), 1u);
+    EXPECT_EQ(i_animation.constant_scales()[0], 5);
+  }
+}
+
+TEST(RandomAccess, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(3);
+  for (int i = 0; i < 4; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i * .3f, ozz::math::Float3(static_cast<float>(i), 0.f, 0.f)};
+    raw_animation.tracks[1].translations.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  builder.random_access = true;
+  builder.compact_ratios = true;
+  ozz::unique_ptr<Animation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+  ASSERT_TRUE(o_animation->random_access());
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    Animation i_animation;
+    i >> i_animation;
+
+    // Indices are rebuilt on load.
+    EXPECT_EQ(o_animation->size(), i_animation.size());
+    ASSERT_TRUE(i_animation.random_access());
+    const ozz::span<const int> o_indices[] = {
+        o_animation->translation_track_index(),
+        o_animation->rotation_track_index(),
+        o_animation->scale_track_index()};
+    const ozz::span<const int> i_indices[] = {
+        i_animation.translation_track_index(),
+        i_animation.rotation_track_index(),
+        i_animation.scale_track_index()};
+    for (size_t t = 0; t < OZZ_ARRAY_SIZE(o_indices); ++t) {
+      ASSERT_EQ(o_indices[t].size(), i_indices[t].size());
+      for (size_t k = 0; k < o_indices[t].size(); ++k) {
+        EXPECT_EQ(o_indices[t][k], i_indices[t][k]);
+      }
+    }
+
+    // 4 tracks offsets (plus one), then 5 keys for track 1 (a key is added at
+    // the end), 2 for the others.
+    const ozz::span<const int> translations =
+        i_animation.translation_track_index();
+    ASSERT_EQ(translations.size(), 4u + 1u + 11u);
+    EXPECT_EQ(translations[0], 0);
+    EXPECT_EQ(translations[1], 2);
+    EXPECT_EQ(translations[2], 7);
+    EXPECT_EQ(translations[3], 9);
+    EXPECT_EQ(translations[4], 11);
+  }
+}
+
+TEST(Cubic, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  for (int i = 0; i < 4; ++i) {
+    const float fi = static_cast<float>(i);
+    const RawAnimation::TranslationKey tkey = {
+        i * .3f, ozz::math::Float3(fi, fi * fi, 0.f)};
+    raw_animation.tracks[1].translations.push_back(tkey);
+    const RawAnimation::ScaleKey skey = {
+        i * .25f, ozz::math::Float3(1.f, 1.f + fi, 1.f)};
+    raw_animation.tracks[0].scales.push_back(skey);
+  }
+
+  AnimationBuilder builder;
+  builder.cubic_interpolation = true;
+  ozz::unique_ptr<Animation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+  ASSERT_TRUE(o_animation->cubic());
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    Animation i_animation;
+    i >> i_animation;
+
+    EXPECT_EQ(o_animation->size(), i_animation.size());
+    ASSERT_TRUE(i_animation.cubic());
+    const ozz::span<const uint16_t> o_tangents[] = {
+        o_animation->translation_tangents(), o_animation->scale_tangents()};
+    const ozz::span<const uint16_t> i_tangents[] = {
+        i_animation.translation_tangents(), i_animation.scale_tangents()};
+    for (size_t t = 0; t < OZZ_ARRAY_SIZE(o_tangents); ++t) {
+      ASSERT_EQ(o_tangents[t].size(), i_tangents[t].size());
+      for (size_t k = 0; k < o_tangents[t].size(); ++k) {
+        EXPECT_EQ(o_tangents[t][k], i_tangents[t][k]);
+      }
+    }
+  }
+}
+
+TEST(Image, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.name = "image";
+  raw_animation.tracks.resize(5);
+  for (int i = 0; i < 5; ++i) {
+    const float fi = static_cast<float>(i);
+    const RawAnimation::TranslationKey tkey = {
+        i * .2f, ozz::math::Float3(fi, fi * fi, 0.f)};
+    raw_animation.tracks[0].translations.push_back(tkey);
+    if (i != 0) {
+      raw_animation.tracks[i].translations.push_back(tkey);
+    }
+    const RawAnimation::RotationKey rkey = {
+        i * .25f, ozz::math::Quaternion::FromAxisAngle(
+                      ozz::math::Float3::x_axis(), fi * .3f)};
+    raw_animation.tracks[1].rotations.push_back(rkey);
+    const RawAnimation::ScaleKey skey = {
+        i * .25f, ozz::math::Float3(1.f, 1.f + fi, 1.f)};
+    raw_animation.tracks[4].scales.push_back(skey);
+  }
+  AnimationBuilder builder;
+  builder.seek_interval = .3f;
+  builder.bidirectional = true;
+  builder.random_access = true;
+  builder.cubic_interpolation = true;
+  ozz::unique_ptr<Animation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t image_size = o_animation->image_size();
+  ozz::span<ozz::byte> image = {
+      static_cast<ozz::byte*>(
+          allocator->Allocate(image_size + 1, Animation::kImageAlignment)),
+      image_size + 1};
+
+  // Invalid buffers.
+  EXPECT_FALSE(o_animation->ToImage({image.data(), image_size - 1}));
+  EXPECT_FALSE(o_animation->ToImage({image.data() + 1, image_size}));
+  ASSERT_TRUE(o_animation->ToImage({image.data(), image_size}));
+
+  {  // Invalid images.
+    Animation i_animation;
+    EXPECT_FALSE(i_animation.FromImage({image.data(), image_size - 1}));
+    EXPECT_FALSE(i_animation.FromImage({image.data() + 1, image_size}));
+    EXPECT_FALSE(i_animation.FromImage({image.data(), 4}));
+    EXPECT_EQ(i_animation.num_tracks(), 0);
+
+    image[0] = static_cast<ozz::byte>(~image[0]);
+    EXPECT_FALSE(i_animation.FromImage({image.data(), image_size}));
+    image[0] = static_cast<ozz::byte>(~image[0]);
+  }
+
+  // Images are relocatable, so it's tested from a copy.
+  ozz::span<ozz::byte> copy = {
+      static_cast<ozz::byte*>(
+          allocator->Allocate(image_size, Animation::kImageAlignment)),
+      image_size};
+  std::memcpy(copy.data(), image.data(), image_size);
+  allocator->Deallocate(image.data());
+
+  Animation i_animation;
+  ASSERT_TRUE(i_animation.FromImage({copy.data(), copy.size()}));
+  EXPECT_FLOAT_EQ(i_animation.duration(), o_animation->duration());
+  EXPECT_EQ(i_animation.num_tracks(), o_animation->num_tracks());
+  EXPECT_STREQ(i_animation.name(), o_animation->name());
+  EXPECT_EQ(i_animation.size(), o_animation->size());
+  EXPECT_EQ(i_animation.image_size(), image_size);
+  EXPECT_EQ(i_animation.num_seek_points(), o_animation->num_seek_points());
+  EXPECT_TRUE(i_animation.bidirectional());
+  EXPECT_TRUE(i_animation.random_access());
+  EXPECT_TRUE(i_animation.cubic());
+
+  // Data point to the image.
+  const ozz::byte* keys =
+      reinterpret_cast<const ozz::byte*>(i_animation.translations().data());
+  EXPECT_TRUE(keys > copy.data() && keys < copy.data() + image_size);
+
+  // Samples both animations.
+  ozz::animation::SamplingJob::Context o_context(5, true);
+  ozz::animation::SamplingJob::Context i_context(5, true);
+  ozz::math::SoaTransform o_output[2];
+  ozz::math::SoaTransform i_output[2];
+  for (float ratio = 0.f; ratio <= 1.f; ratio += .1f) {
+    ozz::animation::SamplingJob job;
+    job.ratio = ratio;
+    job.animation = o_animation.get();
+    job.context = &o_context;
+    job.output = o_output;
+    ASSERT_TRUE(job.Run());
+    job.animation = &i_animation;
+    job.context = &i_context;
+    job.output = i_output;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < 2; ++i) {
+      EXPECT_TRUE(ozz::math::AreAllTrue(o_output[i].translation ==
+                                        i_output[i].translation));
+      EXPECT_TRUE(
+          ozz::math::AreAllTrue(o_output[i].rotation == i_output[i].rotation));
+      EXPECT_TRUE(ozz::math::AreAllTrue(o_output[i].scale == i_output[i].scale));
+    }
+  }
+
+  // Image can be reused by many animations, and is released after them.
+  {
+    Animation other;
+    EXPECT_TRUE(other.FromImage({copy.data(), copy.size()}));
+    Animation moved(std::move(other));
+    EXPECT_EQ(moved.size(), o_animation->size());
+  }
+  i_animation = Animation();
+  allocator->Deallocate(copy.data());
+}
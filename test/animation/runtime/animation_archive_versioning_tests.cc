@@ -39,6 +39,7 @@ OZZ_OPTIONS_DECLARE_STRING(file, "Specifies input file", "", true)
 OZZ_OPTIONS_DECLARE_INT(tracks, "Number of tracks", 0, true)
 OZZ_OPTIONS_DECLARE_FLOAT(duration, "Duration", 0.f, true)
 OZZ_OPTIONS_DECLARE_STRING(name, "Name", "", true)
+OZZ_OPTIONS_DECLARE_BOOL(legacy, "Accepts legacy versions", true, false)
 
 int main(int _argc, char** _argv) {
   // Parses arguments.
@@ -62,6 +63,7 @@ TEST(Versioning, AnimationSerialize) {
 
   // Open archive and test object tag.
   ozz::io::IArchive archive(&file);
+  archive.set_legacy_versions(OPTIONS_legacy);
   ASSERT_TRUE(archive.TestTag<ozz::animation::Animation>());
 
   // Read the object.
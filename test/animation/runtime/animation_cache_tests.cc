@@ -0,0 +1,229 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/animation_cache.h"
+
+#include <cstdio>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/async_load.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::AnimationCache;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Saves a one track animation named _name to file _filename, and returns its
+// runtime size.
+size_t SaveAnimation(const char* _filename, const char* _name) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.name = _name;
+  raw_animation.tracks.resize(1);
+  const RawAnimation::TranslationKey key = {.5f,
+                                            ozz::math::Float3(1.f, 2.f, 3.f)};
+  raw_animation.tracks[0].translations.push_back(key);
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation = builder(raw_animation);
+  EXPECT_TRUE(animation);
+
+  ozz::io::File file(_filename, "wb");
+  EXPECT_TRUE(file.opened());
+  ozz::io::OArchive archive(&file);
+  archive << *animation;
+  return animation->size();
+}
+
+// Defers tasks, which are run on demand.
+struct DeferredTask {
+  ozz::io::FileAsyncReader::Task task;
+  void* data;
+};
+
+void DeferredDispatch(ozz::io::FileAsyncReader::Task _task, void* _task_data,
+                      void* _user_data) {
+  const DeferredTask task = {_task, _task_data};
+  static_cast<ozz::vector<DeferredTask>*>(_user_data)->push_back(task);
+}
+}  // namespace
+
+TEST(Error, AnimationCache) {
+  ozz::io::FileAsyncReader reader;
+  AnimationCache cache(&reader, 0);
+  EXPECT_EQ(cache.num_clips(), 0);
+  EXPECT_EQ(cache.Register(nullptr), -1);
+  EXPECT_EQ(cache.num_clips(), 0);
+
+  EXPECT_EQ(cache.Acquire(-1), nullptr);
+  EXPECT_EQ(cache.Acquire(0), nullptr);
+  EXPECT_FALSE(cache.Prefetch(0));
+  EXPECT_EQ(cache.state(0), AnimationCache::kUnloaded);
+  EXPECT_EQ(cache.stats().misses, 0);
+
+  // Missing file.
+  const int clip = cache.Register("animation_cache_missing.ozz");
+  EXPECT_EQ(clip, 0);
+  EXPECT_EQ(cache.Acquire(clip), nullptr);
+  cache.Update();
+  EXPECT_EQ(cache.state(clip), AnimationCache::kFailed);
+  EXPECT_EQ(cache.Acquire(clip), nullptr);
+  EXPECT_FALSE(cache.Prefetch(clip));
+  EXPECT_EQ(cache.num_pending_loads(), 0);
+  EXPECT_EQ(cache.stats().misses, 2);
+  EXPECT_EQ(cache.stats().loads, 1);
+  EXPECT_EQ(cache.stats().failures, 1);
+  EXPECT_EQ(cache.num_resident(), 0);
+}
+
+TEST(Load, AnimationCache) {
+  const size_t size = SaveAnimation("animation_cache0.ozz", "clip0");
+
+  // Without dispatcher, files are read immediately.
+  ozz::io::FileAsyncReader reader;
+  AnimationCache cache(&reader, 1 << 20);
+  const int clip = cache.Register("animation_cache0.ozz");
+
+  // Loads are integrated by Update().
+  EXPECT_EQ(cache.Acquire(clip), nullptr);
+  EXPECT_EQ(cache.state(clip), AnimationCache::kLoading);
+  EXPECT_EQ(cache.num_pending_loads(), 1);
+  EXPECT_EQ(cache.Acquire(clip), nullptr);
+  cache.Update();
+  EXPECT_EQ(cache.state(clip), AnimationCache::kResident);
+  EXPECT_EQ(cache.num_pending_loads(), 0);
+  EXPECT_EQ(cache.num_resident(), 1);
+  EXPECT_EQ(cache.resident_size(), size);
+
+  const Animation* animation = cache.Acquire(clip);
+  ASSERT_NE(animation, nullptr);
+  EXPECT_STREQ(animation->name(), "clip0");
+  EXPECT_EQ(animation->num_tracks(), 1);
+
+  const AnimationCache::Stats& stats = cache.stats();
+  EXPECT_EQ(stats.hits, 1);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.loads, 1);
+  EXPECT_EQ(stats.failures, 0);
+  EXPECT_EQ(stats.evictions, 0);
+  EXPECT_GE(stats.max_load_latency, 0.f);
+  EXPECT_FLOAT_EQ(stats.average_load_latency(), stats.total_load_latency);
+
+  cache.ResetStats();
+  EXPECT_EQ(cache.stats().hits, 0);
+  EXPECT_EQ(cache.stats().misses, 0);
+  EXPECT_EQ(cache.stats().loads, 0);
+  EXPECT_EQ(cache.stats().average_load_latency(), 0.f);
+}
+
+TEST(Eviction, AnimationCache) {
+  const size_t size = SaveAnimation("animation_cache0.ozz", "clip0");
+  EXPECT_EQ(SaveAnimation("animation_cache1.ozz", "clip1"), size);
+  EXPECT_EQ(SaveAnimation("animation_cache2.ozz", "clip2"), size);
+
+  // Budget fits 2 clips.
+  ozz::io::FileAsyncReader reader;
+  AnimationCache cache(&reader, size * 2);
+  const int clips[] = {cache.Register("animation_cache0.ozz"),
+                       cache.Register("animation_cache1.ozz"),
+                       cache.Register("animation_cache2.ozz")};
+
+  EXPECT_TRUE(cache.Prefetch(clips[0]));
+  EXPECT_TRUE(cache.Prefetch(clips[1]));
+  cache.Update();
+  EXPECT_EQ(cache.num_resident(), 2);
+  EXPECT_EQ(cache.stats().misses, 0);
+
+  // Clip 0 is the least recently used.
+  EXPECT_NE(cache.Acquire(clips[1]), nullptr);
+  EXPECT_EQ(cache.Acquire(clips[2]), nullptr);
+  cache.Update();
+  EXPECT_EQ(cache.state(clips[0]), AnimationCache::kUnloaded);
+  EXPECT_EQ(cache.state(clips[1]), AnimationCache::kResident);
+  EXPECT_EQ(cache.state(clips[2]), AnimationCache::kResident);
+  EXPECT_EQ(cache.num_resident(), 2);
+  EXPECT_EQ(cache.resident_size(), size * 2);
+  EXPECT_EQ(cache.stats().evictions, 1);
+
+  // Evicted clips are loaded again.
+  EXPECT_EQ(cache.Acquire(clips[0]), nullptr);
+  cache.Update();
+  EXPECT_EQ(cache.state(clips[0]), AnimationCache::kResident);
+  EXPECT_EQ(cache.state(clips[1]), AnimationCache::kUnloaded);
+  EXPECT_EQ(cache.stats().evictions, 2);
+  const Animation* animation = cache.Acquire(clips[0]);
+  ASSERT_NE(animation, nullptr);
+  EXPECT_STREQ(animation->name(), "clip0");
+
+  // Clips used since the last update aren't evicted, even beyond budget.
+  cache.set_budget(0);
+  EXPECT_NE(cache.Acquire(clips[2]), nullptr);
+  cache.Update();
+  EXPECT_EQ(cache.state(clips[0]), AnimationCache::kResident);
+  EXPECT_EQ(cache.state(clips[2]), AnimationCache::kResident);
+  EXPECT_EQ(cache.resident_size(), size * 2);
+
+  cache.Update();
+  EXPECT_EQ(cache.num_resident(), 0);
+  EXPECT_EQ(cache.resident_size(), 0u);
+  EXPECT_EQ(cache.stats().evictions, 4);
+}
+
+TEST(Deferred, AnimationCache) {
+  SaveAnimation("animation_cache0.ozz", "clip0");
+
+  ozz::vector<DeferredTask> tasks;
+  ozz::io::FileAsyncReader reader(&DeferredDispatch, &tasks);
+  AnimationCache cache(&reader, 1 << 20);
+  const int clip = cache.Register("animation_cache0.ozz");
+
+  // Loads remain pending until read.
+  EXPECT_EQ(cache.Acquire(clip), nullptr);
+  EXPECT_EQ(cache.Acquire(clip), nullptr);
+  ASSERT_EQ(tasks.size(), 1u);
+  cache.Update();
+  EXPECT_EQ(cache.state(clip), AnimationCache::kLoading);
+  EXPECT_EQ(cache.num_pending_loads(), 1);
+  EXPECT_EQ(cache.Acquire(clip), nullptr);
+
+  tasks[0].task(tasks[0].data);
+  cache.Update();
+  EXPECT_EQ(cache.state(clip), AnimationCache::kResident);
+  EXPECT_NE(cache.Acquire(clip), nullptr);
+  EXPECT_EQ(cache.stats().misses, 3);
+  EXPECT_EQ(cache.stats().hits, 1);
+  EXPECT_EQ(cache.stats().loads, 1);
+  EXPECT_GE(cache.stats().max_load_latency, 0.f);
+}
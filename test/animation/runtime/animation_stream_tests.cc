@@ -0,0 +1,393 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/animation_stream.h"
+
+#include <cstdio>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/segmented_animation_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/async_load.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::AnimationStream;
+using ozz::animation::SegmentedAnimation;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::SegmentedAnimationBuilder;
+
+namespace {
+// Builds a 4 segments animation, whose translation x equals time.
+void SaveAnimation(ozz::io::Stream* _stream, ozz::Endianness _endianness,
+                   bool _compressed = false) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 8.f;
+  raw_animation.name = "stream";
+  raw_animation.tracks.resize(1);
+  for (int i = 0; i <= 16; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i * .5f, ozz::math::Float3(i * .5f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+
+  SegmentedAnimationBuilder builder;
+  builder.segment_duration = 2.f;
+  ozz::unique_ptr<SegmentedAnimation> animation = builder(raw_animation);
+  ASSERT_TRUE(animation);
+  ASSERT_EQ(animation->num_segments(), 4);
+
+  ozz::io::OArchive archive(_stream, _endianness, _compressed);
+  archive << *animation;
+}
+
+void SaveAnimation(const char* _filename) {
+  ozz::io::File file(_filename, "wb");
+  ASSERT_TRUE(file.opened());
+  SaveAnimation(&file, ozz::GetNativeEndianness());
+}
+
+// Samples _stream at _ratio, expecting translation x to equal time.
+void ExpectSampled(const AnimationStream& _stream, float _ratio) {
+  float segment_ratio;
+  const Animation* segment = _stream.FindSegment(_ratio, &segment_ratio);
+  ASSERT_TRUE(segment != nullptr);
+
+  ozz::animation::SamplingJob::Context context(1);
+  ozz::math::SoaTransform output[1];
+  ozz::animation::SamplingJob job;
+  job.animation = segment;
+  job.context = &context;
+  job.ratio = segment_ratio;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  const float time = _ratio * 8.f;
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, time, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+}
+
+// Stores read tasks, to be run later.
+struct DeferredTask {
+  ozz::io::FileAsyncReader::Task task;
+  void* data;
+};
+
+void DeferredDispatch(ozz::io::FileAsyncReader::Task _task, void* _task_data,
+                      void* _user_data) {
+  const DeferredTask task = {_task, _task_data};
+  static_cast<ozz::vector<DeferredTask>*>(_user_data)->push_back(task);
+}
+
+// Runs read tasks on threads.
+void ThreadDispatch(ozz::io::FileAsyncReader::Task _task, void* _task_data,
+                    void* _user_data) {
+  static_cast<ozz::vector<std::thread>*>(_user_data)
+      ->emplace_back(_task, _task_data);
+}
+}  // namespace
+
+TEST(Error, AnimationStream) {
+  AnimationStream stream;
+  EXPECT_FALSE(stream.opened());
+  EXPECT_FALSE(stream.Update(0.f));
+  EXPECT_EQ(stream.num_segments(), 0);
+
+  float segment_ratio;
+  EXPECT_EQ(stream.FindSegment(.5f, &segment_ratio), nullptr);
+
+  {  // No stream.
+    EXPECT_FALSE(stream.Open(nullptr));
+  }
+
+  {  // Not a segmented animation.
+    ozz::io::MemoryStream memory;
+    ozz::io::OArchive archive(&memory);
+    archive << Animation();
+    memory.Seek(0, ozz::io::Stream::kSet);
+    EXPECT_FALSE(stream.Open(&memory));
+    EXPECT_FALSE(stream.opened());
+  }
+
+  {  // Truncated stream.
+    ozz::io::MemoryStream memory;
+    SaveAnimation(&memory, ozz::GetNativeEndianness());
+    ozz::vector<char> buffer(memory.Size() - 8);
+    memory.Seek(0, ozz::io::Stream::kSet);
+    memory.Read(buffer.data(), buffer.size());
+
+    ozz::io::MemoryStream truncated;
+    truncated.Write(buffer.data(), buffer.size());
+    truncated.Seek(0, ozz::io::Stream::kSet);
+    EXPECT_FALSE(stream.Open(&truncated));
+    EXPECT_FALSE(stream.opened());
+  }
+
+  {  // Compressed archive can be loaded, but not streamed.
+    ozz::io::MemoryStream memory;
+    SaveAnimation(&memory, ozz::GetNativeEndianness(), true);
+    memory.Seek(0, ozz::io::Stream::kSet);
+    EXPECT_FALSE(stream.Open(&memory));
+    EXPECT_FALSE(stream.opened());
+
+    memory.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive archive(&memory);
+    SegmentedAnimation animation;
+    archive >> animation;
+    EXPECT_EQ(animation.num_segments(), 4);
+  }
+}
+
+TEST(Residency, AnimationStream) {
+  for (int e = 0; e < 2; ++e) {
+    const ozz::Endianness endianess =
+        e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream memory;
+    SaveAnimation(&memory, endianess);
+    memory.Seek(0, ozz::io::Stream::kSet);
+
+    AnimationStream stream;
+    ASSERT_TRUE(stream.Open(&memory));
+    EXPECT_TRUE(stream.opened());
+    EXPECT_FLOAT_EQ(stream.duration(), 8.f);
+    EXPECT_EQ(stream.num_tracks(), 1);
+    EXPECT_STREQ(stream.name(), "stream");
+    ASSERT_EQ(stream.num_segments(), 4);
+    EXPECT_EQ(stream.segment_ratios().size(), 5u);
+
+    // Nothing is resident after opening.
+    float segment_ratio;
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_FALSE(stream.resident(i));
+    }
+    EXPECT_EQ(stream.FindSegment(0.f, &segment_ratio), nullptr);
+    const size_t empty_size = stream.size();
+
+    // Loads current and next segments.
+    EXPECT_TRUE(stream.Update(.1f));
+    EXPECT_TRUE(stream.resident(0));
+    EXPECT_TRUE(stream.resident(1));
+    EXPECT_FALSE(stream.resident(2));
+    EXPECT_FALSE(stream.resident(3));
+    EXPECT_GT(stream.size(), empty_size);
+
+    // Moves forward, first segment is unloaded.
+    EXPECT_TRUE(stream.Update(.3f));
+    EXPECT_FALSE(stream.resident(0));
+    EXPECT_TRUE(stream.resident(1));
+    EXPECT_TRUE(stream.resident(2));
+    EXPECT_FALSE(stream.resident(3));
+
+    // Jumps to the end, without looping.
+    EXPECT_TRUE(stream.Update(.9f));
+    EXPECT_FALSE(stream.resident(0));
+    EXPECT_FALSE(stream.resident(1));
+    EXPECT_FALSE(stream.resident(2));
+    EXPECT_TRUE(stream.resident(3));
+
+    // Looping loads the first segment ahead.
+    EXPECT_TRUE(stream.Update(.9f, true));
+    EXPECT_TRUE(stream.resident(0));
+    EXPECT_FALSE(stream.resident(1));
+    EXPECT_FALSE(stream.resident(2));
+    EXPECT_TRUE(stream.resident(3));
+
+    // No lookahead.
+    stream.lookahead = 0;
+    EXPECT_TRUE(stream.Update(.6f));
+    EXPECT_FALSE(stream.resident(0));
+    EXPECT_FALSE(stream.resident(1));
+    EXPECT_TRUE(stream.resident(2));
+    EXPECT_FALSE(stream.resident(3));
+
+    // Bigger lookahead.
+    stream.lookahead = 10;
+    EXPECT_TRUE(stream.Update(0.f));
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_TRUE(stream.resident(i));
+    }
+
+    stream.Close();
+    EXPECT_FALSE(stream.opened());
+    EXPECT_EQ(stream.num_segments(), 0);
+  }
+}
+
+TEST(Sampling, AnimationStream) {
+  ozz::io::MemoryStream memory;
+  SaveAnimation(&memory, ozz::GetNativeEndianness());
+  memory.Seek(0, ozz::io::Stream::kSet);
+
+  AnimationStream stream;
+  ASSERT_TRUE(stream.Open(&memory));
+
+  ozz::animation::SamplingJob::Context context(1);
+  ozz::math::SoaTransform output[1];
+  for (float ratio = 0.f; ratio <= 1.f; ratio += .05f) {
+    ASSERT_TRUE(stream.Update(ratio));
+
+    float segment_ratio;
+    const Animation* segment = stream.FindSegment(ratio, &segment_ratio);
+    ASSERT_TRUE(segment != nullptr);
+
+    ozz::animation::SamplingJob job;
+    job.animation = segment;
+    job.context = &context;
+    job.ratio = segment_ratio;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    const float time = ratio * 8.f;
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, time, 0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  }
+}
+
+TEST(AsyncError, AnimationStream) {
+  AnimationStream stream;
+  ozz::io::FileAsyncReader reader;
+  EXPECT_FALSE(stream.Open(nullptr, "animation_stream.ozz"));
+  EXPECT_FALSE(stream.Open(&reader, nullptr));
+  EXPECT_FALSE(stream.Open(&reader, "missing_animation_stream.ozz"));
+  EXPECT_FALSE(stream.opened());
+
+  // File is removed while loads are pending.
+  SaveAnimation("animation_stream_removed.ozz");
+  ozz::vector<DeferredTask> tasks;
+  ozz::io::FileAsyncReader deferred(&DeferredDispatch, &tasks);
+  ASSERT_TRUE(stream.Open(&deferred, "animation_stream_removed.ozz"));
+  EXPECT_TRUE(stream.Update(0.f));
+  ASSERT_EQ(tasks.size(), 2u);
+  std::remove("animation_stream_removed.ozz");
+  for (const DeferredTask& task : tasks) {
+    task.task(task.data);
+  }
+  tasks.clear();
+  EXPECT_FALSE(stream.loading(0));
+  EXPECT_FALSE(stream.resident(0));
+
+  // Failure is reported once, and loads are issued again.
+  EXPECT_FALSE(stream.Update(0.f));
+  EXPECT_EQ(tasks.size(), 2u);
+  SaveAnimation("animation_stream_removed.ozz");
+  for (const DeferredTask& task : tasks) {
+    task.task(task.data);
+  }
+  EXPECT_TRUE(stream.Update(0.f));
+  EXPECT_TRUE(stream.resident(0));
+  EXPECT_TRUE(stream.resident(1));
+}
+
+TEST(AsyncInFlight, AnimationStream) {
+  SaveAnimation("animation_stream.ozz");
+
+  ozz::vector<DeferredTask> tasks;
+  ozz::io::FileAsyncReader reader(&DeferredDispatch, &tasks);
+  AnimationStream stream;
+  ASSERT_TRUE(stream.Open(&reader, "animation_stream.ozz"));
+  EXPECT_TRUE(stream.opened());
+  ASSERT_EQ(stream.num_segments(), 4);
+
+  // Update only issues loads.
+  EXPECT_TRUE(stream.Update(.1f));
+  ASSERT_EQ(tasks.size(), 2u);
+  EXPECT_TRUE(stream.loading(0));
+  EXPECT_TRUE(stream.loading(1));
+  EXPECT_FALSE(stream.resident(0));
+  float segment_ratio;
+  EXPECT_EQ(stream.FindSegment(.1f, &segment_ratio), nullptr);
+
+  // Pending loads aren't issued again.
+  EXPECT_TRUE(stream.Update(.1f));
+  EXPECT_EQ(tasks.size(), 2u);
+
+  // Samples first segment while the second one is still in flight.
+  tasks[0].task(tasks[0].data);
+  EXPECT_TRUE(stream.resident(0));
+  EXPECT_FALSE(stream.loading(0));
+  EXPECT_TRUE(stream.loading(1));
+  ExpectSampled(stream, .1f);
+  EXPECT_EQ(stream.FindSegment(.3f, &segment_ratio), nullptr);
+
+  // Jumping away unloads resident segments, but not loading ones.
+  EXPECT_TRUE(stream.Update(.9f));
+  EXPECT_FALSE(stream.resident(0));
+  EXPECT_TRUE(stream.loading(1));
+  EXPECT_TRUE(stream.loading(3));
+  ASSERT_EQ(tasks.size(), 3u);
+  tasks[1].task(tasks[1].data);
+  tasks[2].task(tasks[2].data);
+  EXPECT_TRUE(stream.resident(1));
+  ExpectSampled(stream, .9f);
+
+  // Segment 1 is out of the window, and unloaded by the next update.
+  EXPECT_TRUE(stream.Update(.9f));
+  EXPECT_FALSE(stream.resident(1));
+  EXPECT_TRUE(stream.resident(3));
+
+  stream.Close();
+  EXPECT_FALSE(stream.opened());
+}
+
+TEST(AsyncThreaded, AnimationStream) {
+  SaveAnimation("animation_stream.ozz");
+
+  ozz::vector<std::thread> threads;
+  {
+    ozz::io::FileAsyncReader reader(&ThreadDispatch, &threads, 64);
+    AnimationStream stream;
+    ASSERT_TRUE(stream.Open(&reader, "animation_stream.ozz"));
+
+    // Samples resident segments while others are loaded by threads.
+    int sampled = 0;
+    for (float ratio = 0.f; ratio <= 1.f;) {
+      ASSERT_TRUE(stream.Update(ratio));
+      float segment_ratio;
+      if (stream.FindSegment(ratio, &segment_ratio)) {
+        ExpectSampled(stream, ratio);
+        ++sampled;
+        ratio += .05f;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    EXPECT_GT(sampled, 0);
+
+    // Close waits for pending loads.
+    stream.Close();
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
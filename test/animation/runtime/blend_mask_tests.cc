@@ -0,0 +1,301 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/blend_mask.h"
+
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::BlendMask;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton of 10 joints:
+// hips
+//  +- spine
+//  |   +- head
+//  |   +- l_arm - l_hand
+//  |   +- r_arm - r_hand
+//  +- l_leg - l_foot
+//  +- r_leg
+ozz::unique_ptr<Skeleton> BuildSkeleton(SkeletonBuilder::Ordering _ordering) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& hips = raw_skeleton.roots[0];
+  hips.name = "hips";
+  hips.children.resize(3);
+  RawSkeleton::Joint& spine = hips.children[0];
+  spine.name = "spine";
+  spine.children.resize(3);
+  spine.children[0].name = "head";
+  spine.children[1].name = "l_arm";
+  spine.children[1].children.resize(1);
+  spine.children[1].children[0].name = "l_hand";
+  spine.children[2].name = "r_arm";
+  spine.children[2].children.resize(1);
+  spine.children[2].children[0].name = "r_hand";
+  hips.children[1].name = "l_leg";
+  hips.children[1].children.resize(1);
+  hips.children[1].children[0].name = "l_foot";
+  hips.children[2].name = "r_leg";
+
+  struct {
+    void operator()(RawSkeleton::Joint& _joint) {
+      _joint.transform = ozz::math::Transform::identity();
+      for (RawSkeleton::Joint& child : _joint.children) {
+        (*this)(child);
+      }
+    }
+  } identity;
+  identity(hips);
+
+  SkeletonBuilder builder;
+  builder.ordering = _ordering;
+  return builder(raw_skeleton);
+}
+
+// Returns joint _name weight in _mask.
+float JointWeight(const BlendMask& _mask, const Skeleton& _skeleton,
+                  const char* _name) {
+  const int joint = ozz::animation::FindJoint(_skeleton, _name);
+  EXPECT_GE(joint, 0);
+  const float* weights =
+      reinterpret_cast<const float*>(_mask.joint_weights().data());
+  return weights[joint];
+}
+}  // namespace
+
+TEST(Default, BlendMask) {
+  const BlendMask mask;
+  EXPECT_EQ(mask.num_joints(), 0);
+  EXPECT_TRUE(mask.joint_weights().empty());
+  EXPECT_TRUE(mask.mask().empty());
+  EXPECT_EQ(mask.soa_begin(), 0);
+  EXPECT_EQ(mask.soa_end(), 0);
+
+  BlendMask unset;
+  EXPECT_FALSE(unset.SetSubtree(0, 1.f));
+  EXPECT_EQ(unset.SetPattern("*", 1.f), 0);
+}
+
+TEST(Subtree, BlendMask) {
+  const ozz::unique_ptr<Skeleton> skeleton =
+      BuildSkeleton(SkeletonBuilder::kDepthFirst);
+  ASSERT_TRUE(skeleton);
+  ASSERT_EQ(skeleton->num_joints(), 10);
+
+  BlendMask mask;
+  mask.Reset(*skeleton);
+  EXPECT_EQ(mask.num_joints(), 10);
+  ASSERT_EQ(mask.joint_weights().size(), 3u);
+  ASSERT_EQ(mask.mask().size(), 1u);
+  EXPECT_EQ(mask.mask()[0], 0);
+  EXPECT_EQ(mask.soa_begin(), 0);
+  EXPECT_EQ(mask.soa_end(), 0);
+
+  EXPECT_FALSE(mask.SetSubtree(-1, 1.f));
+  EXPECT_FALSE(mask.SetSubtree(10, 1.f));
+
+  // Depth-first: hips, spine, head, l_arm | l_hand, r_arm, r_hand, l_leg |
+  // l_foot, r_leg.
+  EXPECT_TRUE(
+      mask.SetSubtree(ozz::animation::FindJoint(*skeleton, "spine"), 1.f));
+  EXPECT_SIMDFLOAT_EQ(mask.joint_weights()[0], 0.f, 1.f, 1.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(mask.joint_weights()[1], 1.f, 1.f, 1.f, 0.f);
+  EXPECT_SIMDFLOAT_EQ(mask.joint_weights()[2], 0.f, 0.f, 0.f, 0.f);
+  EXPECT_EQ(mask.mask()[0], 3);
+  EXPECT_EQ(mask.soa_begin(), 0);
+  EXPECT_EQ(mask.soa_end(), 2);
+
+  // Overrides a sub-subtree.
+  EXPECT_TRUE(
+      mask.SetSubtree(ozz::animation::FindJoint(*skeleton, "l_arm"), .5f));
+  EXPECT_SIMDFLOAT_EQ(mask.joint_weights()[0], 0.f, 1.f, 1.f, .5f);
+  EXPECT_SIMDFLOAT_EQ(mask.joint_weights()[1], .5f, 1.f, 1.f, 0.f);
+
+  // Leaf.
+  EXPECT_TRUE(
+      mask.SetSubtree(ozz::animation::FindJoint(*skeleton, "r_leg"), 1.f));
+  EXPECT_SIMDFLOAT_EQ(mask.joint_weights()[2], 0.f, 1.f, 0.f, 0.f);
+  EXPECT_EQ(mask.mask()[0], 7);
+  EXPECT_EQ(mask.soa_end(), 3);
+
+  // Removes all but the leaf.
+  EXPECT_TRUE(mask.SetSubtree(0, 0.f));
+  EXPECT_TRUE(
+      mask.SetSubtree(ozz::animation::FindJoint(*skeleton, "r_leg"), 1.f));
+  EXPECT_EQ(mask.mask()[0], 4);
+  EXPECT_EQ(mask.soa_begin(), 2);
+  EXPECT_EQ(mask.soa_end(), 3);
+
+  // Resets to a weight, padding lanes are null.
+  mask.Reset(*skeleton, 1.f);
+  EXPECT_SIMDFLOAT_EQ(mask.joint_weights()[0], 1.f, 1.f, 1.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(mask.joint_weights()[2], 1.f, 1.f, 0.f, 0.f);
+  EXPECT_EQ(mask.mask()[0], 7);
+  EXPECT_EQ(mask.soa_begin(), 0);
+  EXPECT_EQ(mask.soa_end(), 3);
+
+  // Negative weights are considered null.
+  EXPECT_TRUE(mask.SetSubtree(0, -1.f));
+  EXPECT_EQ(mask.mask()[0], 0);
+  EXPECT_EQ(mask.soa_begin(), 0);
+  EXPECT_EQ(mask.soa_end(), 0);
+}
+
+TEST(SubtreeSiblingsGrouped, BlendMask) {
+  const ozz::unique_ptr<Skeleton> skeleton =
+      BuildSkeleton(SkeletonBuilder::kSiblingsGrouped);
+  ASSERT_TRUE(skeleton);
+  ASSERT_FALSE(ozz::animation::IsDepthFirst(*skeleton));
+
+  BlendMask mask;
+  mask.Reset(*skeleton);
+  EXPECT_TRUE(
+      mask.SetSubtree(ozz::animation::FindJoint(*skeleton, "spine"), 1.f));
+  for (const char* name : {"spine", "head", "l_arm", "l_hand", "r_arm",
+                           "r_hand"}) {
+    EXPECT_FLOAT_EQ(JointWeight(mask, *skeleton, name), 1.f) << name;
+  }
+  for (const char* name : {"hips", "l_leg", "l_foot", "r_leg"}) {
+    EXPECT_FLOAT_EQ(JointWeight(mask, *skeleton, name), 0.f) << name;
+  }
+}
+
+TEST(Pattern, BlendMask) {
+  const ozz::unique_ptr<Skeleton> skeleton =
+      BuildSkeleton(SkeletonBuilder::kDepthFirst);
+  ASSERT_TRUE(skeleton);
+
+  BlendMask mask;
+  mask.Reset(*skeleton);
+
+  EXPECT_EQ(mask.SetPattern("nothing", 1.f), 0);
+  EXPECT_EQ(mask.mask()[0], 0);
+
+  // Matching joints only.
+  EXPECT_EQ(mask.SetPattern("*_arm", 1.f, false), 2);
+  EXPECT_FLOAT_EQ(JointWeight(mask, *skeleton, "l_arm"), 1.f);
+  EXPECT_FLOAT_EQ(JointWeight(mask, *skeleton, "r_arm"), 1.f);
+  EXPECT_FLOAT_EQ(JointWeight(mask, *skeleton, "l_hand"), 0.f);
+  EXPECT_FLOAT_EQ(JointWeight(mask, *skeleton, "r_hand"), 0.f);
+  EXPECT_EQ(mask.mask()[0], 3);
+
+  // With their descendants.
+  mask.Reset(*skeleton);
+  EXPECT_EQ(mask.SetPattern("?_leg", .5f), 2);
+  for (const char* name : {"l_leg", "l_foot", "r_leg"}) {
+    EXPECT_FLOAT_EQ(JointWeight(mask, *skeleton, name), .5f) << name;
+  }
+  EXPECT_FLOAT_EQ(JointWeight(mask, *skeleton, "hips"), 0.f);
+  EXPECT_EQ(mask.mask()[0], 6);
+  EXPECT_EQ(mask.soa_begin(), 1);
+  EXPECT_EQ(mask.soa_end(), 3);
+
+  // Subtractive pattern.
+  mask.Reset(*skeleton, 1.f);
+  EXPECT_EQ(mask.SetPattern("*_hand", 0.f), 2);
+  EXPECT_FLOAT_EQ(JointWeight(mask, *skeleton, "l_hand"), 0.f);
+  EXPECT_FLOAT_EQ(JointWeight(mask, *skeleton, "r_hand"), 0.f);
+  EXPECT_FLOAT_EQ(JointWeight(mask, *skeleton, "r_arm"), 1.f);
+}
+
+TEST(Move, BlendMask) {
+  const ozz::unique_ptr<Skeleton> skeleton =
+      BuildSkeleton(SkeletonBuilder::kDepthFirst);
+  ASSERT_TRUE(skeleton);
+
+  BlendMask mask;
+  mask.Reset(*skeleton);
+  mask.SetPattern("head", 1.f);
+
+  BlendMask moved(std::move(mask));
+  EXPECT_EQ(moved.num_joints(), 10);
+  EXPECT_EQ(moved.mask()[0], 1);
+  EXPECT_FLOAT_EQ(JointWeight(moved, *skeleton, "head"), 1.f);
+
+  BlendMask assigned;
+  assigned = std::move(moved);
+  EXPECT_EQ(assigned.num_joints(), 10);
+  EXPECT_EQ(assigned.SetPattern("r_leg", 1.f), 1);
+  EXPECT_EQ(assigned.mask()[0], 5);
+}
+
+TEST(Blending, BlendMask) {
+  const ozz::unique_ptr<Skeleton> skeleton =
+      BuildSkeleton(SkeletonBuilder::kDepthFirst);
+  ASSERT_TRUE(skeleton);
+
+  // Upper body layer translates joints by 1 on x, lower body layer by 2.
+  ozz::math::SoaTransform upper[3];
+  ozz::math::SoaTransform lower[3];
+  for (int i = 0; i < 3; ++i) {
+    upper[i] = ozz::math::SoaTransform::identity();
+    upper[i].translation.x = ozz::math::simd_float4::Load1(1.f);
+    lower[i] = ozz::math::SoaTransform::identity();
+    lower[i].translation.x = ozz::math::simd_float4::Load1(2.f);
+  }
+
+  BlendMask upper_mask;
+  upper_mask.Reset(*skeleton);
+  upper_mask.SetPattern("spine", 1.f);
+  BlendMask lower_mask;
+  lower_mask.Reset(*skeleton, 1.f);
+  lower_mask.SetPattern("spine", 0.f);
+
+  ozz::animation::BlendingJob::Layer layers[2];
+  layers[0].weight = 1.f;
+  layers[0].transform = upper;
+  upper_mask.Apply(&layers[0]);
+  layers[1].weight = 1.f;
+  layers[1].transform = lower;
+  lower_mask.Apply(&layers[1]);
+  EXPECT_EQ(layers[0].mask.data(), upper_mask.mask().data());
+  EXPECT_EQ(layers[0].joint_weights.data(), upper_mask.joint_weights().data());
+
+  ozz::math::SoaTransform output[3];
+  ozz::animation::BlendingJob job;
+  job.layers = layers;
+  job.rest_pose = skeleton->joint_rest_poses();
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_SIMDFLOAT_EQ(output[0].translation.x, 2.f, 1.f, 1.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(output[1].translation.x, 1.f, 1.f, 1.f, 2.f);
+  EXPECT_SIMDFLOAT_EQ(output[2].translation.x, 2.f, 2.f, 0.f, 0.f);
+}
@@ -0,0 +1,343 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/blend_tree.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::BlendingJob;
+using ozz::animation::BlendTree;
+using ozz::animation::SamplingJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds an animation with _num_tracks tracks, whose keys depends on _seed.
+ozz::unique_ptr<Animation> BuildAnimation(int _num_tracks, float _seed) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i) + _seed;
+    for (int k = 0; k <= 2; ++k) {
+      const float time = k / 2.f;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi, fi * k, _seed)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::z_axis(), .1f * (fi + k))};
+      track.rotations.push_back(rkey);
+    }
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+bool Equal(const ozz::span<const ozz::math::SoaTransform>& _a,
+           const ozz::span<const ozz::math::SoaTransform>& _b) {
+  return _a.size() == _b.size() &&
+         std::memcmp(_a.data(), _b.data(), _a.size_bytes()) == 0;
+}
+}  // namespace
+
+TEST(Error, BlendTree) {
+  ozz::unique_ptr<Animation> animation = BuildAnimation(8, 0.f);
+  ASSERT_TRUE(animation);
+  const ozz::math::SoaTransform rest_pose[2] = {
+      ozz::math::SoaTransform::identity(), ozz::math::SoaTransform::identity()};
+
+  BlendTree tree;
+  EXPECT_EQ(tree.num_nodes(), 0);
+  EXPECT_FALSE(tree.Evaluate(0, rest_pose));
+  EXPECT_TRUE(tree.output(0).empty());
+
+  const int clip = tree.AddClip(*animation);
+  EXPECT_EQ(clip, 0);
+  const int blend = tree.AddBlend();
+  EXPECT_EQ(blend, 1);
+  EXPECT_EQ(tree.num_nodes(), 2);
+
+  // Invalid connections.
+  EXPECT_EQ(tree.AddInput(clip, clip), -1);
+  EXPECT_EQ(tree.AddInput(blend, blend), -1);
+  EXPECT_EQ(tree.AddInput(blend, 2), -1);
+  EXPECT_EQ(tree.AddInput(2, clip), -1);
+  EXPECT_EQ(tree.AddInput(blend, -1), -1);
+  EXPECT_EQ(tree.AddInput(blend, clip), 0);
+
+  // Invalid parameters.
+  EXPECT_FALSE(tree.SetRatio(blend, .5f));
+  EXPECT_FALSE(tree.SetRatio(2, .5f));
+  EXPECT_TRUE(tree.SetRatio(clip, .5f));
+  EXPECT_FALSE(tree.SetWeight(blend, 1, 1.f));
+  EXPECT_FALSE(tree.SetWeight(clip, 0, 1.f));
+  EXPECT_TRUE(tree.SetWeight(blend, 0, 1.f));
+  EXPECT_FALSE(tree.SetJointWeights(blend, 1, {}));
+  EXPECT_TRUE(tree.SetJointWeights(blend, 0, {}));
+  EXPECT_FALSE(tree.SetMask(blend, 1, {}));
+  EXPECT_TRUE(tree.SetMask(blend, 0, {}));
+  EXPECT_FALSE(tree.SetThreshold(clip, .1f));
+  EXPECT_FALSE(tree.SetThreshold(blend, 0.f));
+  EXPECT_TRUE(tree.SetThreshold(blend, .2f));
+
+  // Invalid evaluation.
+  EXPECT_FALSE(tree.Evaluate(-1, rest_pose));
+  EXPECT_FALSE(tree.Evaluate(2, rest_pose));
+  EXPECT_FALSE(tree.Evaluate(blend, {}));
+
+  // Animation bigger than the rest pose.
+  EXPECT_FALSE(tree.Evaluate(blend, ozz::make_span(rest_pose).subspan(0, 1)));
+  EXPECT_TRUE(tree.output(blend).empty());
+
+  EXPECT_TRUE(tree.Evaluate(blend, rest_pose));
+  EXPECT_EQ(tree.output(blend).size(), 2u);
+  EXPECT_EQ(tree.output(clip).size(), 2u);
+  EXPECT_TRUE(tree.output(2).empty());
+
+  // Changing layout requires a new evaluation.
+  tree.AddBlend();
+  EXPECT_TRUE(tree.output(blend).empty());
+  EXPECT_TRUE(tree.Evaluate(blend, rest_pose));
+  EXPECT_EQ(tree.output(blend).size(), 2u);
+}
+
+TEST(Evaluate, BlendTree) {
+  // Last animation has less tracks than the rest pose.
+  const int kNumSoaJoints = 3;
+  ozz::unique_ptr<Animation> animations[4] = {
+      BuildAnimation(12, 0.f), BuildAnimation(12, 10.f),
+      BuildAnimation(12, 20.f), BuildAnimation(5, 30.f)};
+
+  ozz::math::SoaTransform rest_pose[kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    rest_pose[i] = ozz::math::SoaTransform::identity();
+    rest_pose[i].translation.x = ozz::math::simd_float4::Load1(-1.f * i);
+  }
+
+  // Tree is: root = blend(blend(a, b), d) + c.
+  BlendTree tree;
+  int clips[4];
+  for (int i = 0; i < 4; ++i) {
+    clips[i] = tree.AddClip(*animations[i]);
+  }
+  const int blend = tree.AddBlend();
+  EXPECT_EQ(tree.AddInput(blend, clips[0]), 0);
+  EXPECT_EQ(tree.AddInput(blend, clips[1]), 1);
+  const int root = tree.AddBlend();
+  EXPECT_EQ(tree.AddInput(root, blend), 0);
+  EXPECT_EQ(tree.AddInput(root, clips[3]), 1);
+  EXPECT_EQ(tree.AddInput(root, clips[2], true), 2);
+
+  // Reference evaluation, with the same jobs.
+  float ratios[4] = {0.f, 0.f, 0.f, 0.f};
+  float weights[2][3] = {{0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}};
+  SamplingJob::Context contexts[4];
+  ozz::math::SoaTransform locals[4][kNumSoaJoints];
+  ozz::math::SoaTransform blend_output[kNumSoaJoints];
+  ozz::math::SoaTransform expected[kNumSoaJoints];
+  for (int i = 0; i < 4; ++i) {
+    contexts[i].Resize(12);
+    for (int j = 0; j < kNumSoaJoints; ++j) {
+      locals[i][j] = rest_pose[j];
+    }
+  }
+  auto reference = [&]() {
+    for (int i = 0; i < 4; ++i) {
+      SamplingJob sampling_job;
+      sampling_job.animation = animations[i].get();
+      sampling_job.context = &contexts[i];
+      sampling_job.ratio = ratios[i];
+      sampling_job.output = locals[i];
+      ASSERT_TRUE(sampling_job.Run());
+    }
+    BlendingJob::Layer layers[2];
+    layers[0].weight = weights[0][0];
+    layers[0].transform = locals[0];
+    layers[1].weight = weights[0][1];
+    layers[1].transform = locals[1];
+    BlendingJob blending_job;
+    blending_job.layers = layers;
+    blending_job.rest_pose = rest_pose;
+    blending_job.output = blend_output;
+    ASSERT_TRUE(blending_job.Run());
+
+    layers[0].weight = weights[1][0];
+    layers[0].transform = blend_output;
+    layers[1].weight = weights[1][1];
+    layers[1].transform = locals[3];
+    BlendingJob::Layer additive_layers[1];
+    additive_layers[0].weight = weights[1][2];
+    additive_layers[0].transform = locals[2];
+    blending_job.layers = layers;
+    blending_job.additive_layers = additive_layers;
+    blending_job.output = expected;
+    ASSERT_TRUE(blending_job.Run());
+  };
+  auto set = [&](float _r0, float _r1, float _r2, float _r3, float _w0,
+                 float _w1, float _w2, float _w3, float _w4) {
+    const float r[4] = {_r0, _r1, _r2, _r3};
+    for (int i = 0; i < 4; ++i) {
+      ratios[i] = r[i];
+      EXPECT_TRUE(tree.SetRatio(clips[i], r[i]));
+    }
+    const float w[2][3] = {{_w0, _w1, 0.f}, {_w2, _w3, _w4}};
+    for (int i = 0; i < 3; ++i) {
+      weights[0][i] = w[0][i];
+      weights[1][i] = w[1][i];
+      EXPECT_TRUE(i == 2 || tree.SetWeight(blend, i, w[0][i]));
+      EXPECT_TRUE(tree.SetWeight(root, i, w[1][i]));
+    }
+    reference();
+    EXPECT_TRUE(tree.Evaluate(root, rest_pose));
+    EXPECT_TRUE(Equal(tree.output(root), expected));
+  };
+
+  // All nodes active.
+  set(.1f, .2f, .3f, .4f, .5f, .5f, .7f, .3f, .5f);
+  EXPECT_EQ(tree.num_updated_nodes(), 6);
+
+  // Nothing changed.
+  set(.1f, .2f, .3f, .4f, .5f, .5f, .7f, .3f, .5f);
+  EXPECT_EQ(tree.num_updated_nodes(), 0);
+
+  // Additive clip changes.
+  set(.1f, .2f, .35f, .4f, .5f, .5f, .7f, .3f, .5f);
+  EXPECT_EQ(tree.num_updated_nodes(), 2);
+
+  // A clip of the sub-blend changes.
+  set(.15f, .2f, .35f, .4f, .5f, .5f, .7f, .3f, .5f);
+  EXPECT_EQ(tree.num_updated_nodes(), 3);
+
+  // Sub-blend weight changes.
+  set(.15f, .2f, .35f, .4f, .5f, .6f, .7f, .3f, .5f);
+  EXPECT_EQ(tree.num_updated_nodes(), 2);
+
+  // Sub-blend is disabled, so changing its clips doesn't update anything.
+  set(.15f, .2f, .35f, .4f, .5f, .6f, 0.f, .3f, .5f);
+  EXPECT_EQ(tree.num_updated_nodes(), 1);
+  set(.25f, .3f, .35f, .4f, .5f, .6f, 0.f, .3f, .5f);
+  EXPECT_EQ(tree.num_updated_nodes(), 0);
+
+  // Sub-blend is enabled again, and updated.
+  set(.25f, .3f, .35f, .4f, .5f, .6f, 1.f, .3f, .5f);
+  EXPECT_EQ(tree.num_updated_nodes(), 4);
+
+  // Additive layer disabled, then enabled as subtractive.
+  set(.25f, .3f, .9f, .4f, .5f, .6f, 1.f, .3f, 0.f);
+  EXPECT_EQ(tree.num_updated_nodes(), 1);
+  set(.25f, .3f, .9f, .4f, .5f, .6f, 1.f, .3f, -.5f);
+  EXPECT_EQ(tree.num_updated_nodes(), 2);
+
+  // Everything changes.
+  set(.3f, .4f, .5f, .6f, .1f, .2f, .3f, .4f, .5f);
+  EXPECT_EQ(tree.num_updated_nodes(), 6);
+
+  // All weights null, outputs rest pose.
+  set(.3f, .4f, .5f, .6f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_EQ(tree.num_updated_nodes(), 1);
+
+  // Invalidation.
+  tree.Invalidate(clips[0]);
+  EXPECT_TRUE(tree.Evaluate(root, rest_pose));
+  EXPECT_EQ(tree.num_updated_nodes(), 0);
+  tree.Invalidate(root);
+  EXPECT_TRUE(tree.Evaluate(root, rest_pose));
+  EXPECT_EQ(tree.num_updated_nodes(), 1);
+  tree.Invalidate();
+  EXPECT_TRUE(tree.Evaluate(blend, rest_pose));
+  EXPECT_EQ(tree.num_updated_nodes(), 1);
+  set(.3f, .4f, .5f, .6f, .1f, .2f, .3f, .4f, .5f);
+  EXPECT_EQ(tree.num_updated_nodes(), 6);
+
+  // Changing rest pose range invalidates everything.
+  ozz::math::SoaTransform other_rest_pose[kNumSoaJoints];
+  std::memcpy(other_rest_pose, rest_pose, sizeof(rest_pose));
+  EXPECT_TRUE(tree.Evaluate(root, other_rest_pose));
+  EXPECT_EQ(tree.num_updated_nodes(), 6);
+  EXPECT_TRUE(Equal(tree.output(root), expected));
+  EXPECT_FALSE(tree.Evaluate(root, ozz::make_span(rest_pose).subspan(0, 2)));
+}
+
+TEST(Graph, BlendTree) {
+  ozz::unique_ptr<Animation> animations[2] = {BuildAnimation(4, 0.f),
+                                              BuildAnimation(4, 10.f)};
+  const ozz::math::SoaTransform rest_pose[1] = {
+      ozz::math::SoaTransform::identity()};
+
+  // A clip shared by two blend nodes, both inputs of the root.
+  BlendTree tree;
+  const int a = tree.AddClip(*animations[0]);
+  const int b = tree.AddClip(*animations[1]);
+  const int blend0 = tree.AddBlend();
+  const int blend1 = tree.AddBlend();
+  const int root = tree.AddBlend();
+  tree.AddInput(blend0, a);
+  tree.AddInput(blend0, b);
+  tree.AddInput(blend1, a);
+  tree.AddInput(root, blend0);
+  tree.AddInput(root, blend1);
+  for (int i = 0; i < 2; ++i) {
+    tree.SetWeight(blend0, i, .5f);
+    tree.SetWeight(blend1, i, 1.f);
+    tree.SetWeight(root, i, .5f);
+  }
+
+  EXPECT_TRUE(tree.Evaluate(root, rest_pose));
+  EXPECT_EQ(tree.num_updated_nodes(), 5);
+
+  // Shared clip is only sampled once, but both blend nodes are updated.
+  tree.SetRatio(a, .5f);
+  EXPECT_TRUE(tree.Evaluate(root, rest_pose));
+  EXPECT_EQ(tree.num_updated_nodes(), 4);
+
+  // blend1 output is a's one.
+  ozz::math::SoaTransform output = tree.output(blend1)[0];
+  ozz::math::SoaTransform expected = tree.output(a)[0];
+  EXPECT_EQ(std::memcmp(&output.translation, &expected.translation,
+                        sizeof(output.translation)),
+            0);
+
+  // Evaluating an inner node doesn't update the root, which is updated during
+  // next root evaluation.
+  tree.SetRatio(b, .5f);
+  EXPECT_TRUE(tree.Evaluate(blend0, rest_pose));
+  EXPECT_EQ(tree.num_updated_nodes(), 2);
+  EXPECT_TRUE(tree.Evaluate(root, rest_pose));
+  EXPECT_EQ(tree.num_updated_nodes(), 1);
+}
@@ -25,12 +25,28 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include <cmath>
+#include <cstring>
+
 #include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
 #include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_half_transform.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
 
+using ozz::animation::Animation;
 using ozz::animation::BlendingJob;
+using ozz::animation::SampleBlendingJob;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
 
 TEST(JobValidity, BlendingJob) {
   const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
@@ -349,6 +365,18 @@ TEST(Weight, BlendingJob) {
                         0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
     EXPECT_SOAFLOAT3_EQ(output_transforms[1].scale, 1.f, 1.f, 1.f, 1.f, 1.f,
                         1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f);
+
+    // Validated plan, whose layer weights are changed in place.
+    const ozz::JobPlan<BlendingJob> plan(job);
+    ASSERT_TRUE(plan.valid());
+    layers[0].weight = 1.f;
+    layers[1].weight = 0.f;
+    EXPECT_TRUE(plan.Execute());
+
+    EXPECT_SOAFLOAT3_EQ(output_transforms[0].translation, 0.f, 1.f, 2.f, 3.f,
+                        4.f, 5.f, 6.f, 7.f, 8.f, 9.f, 10.f, 11.f);
+    EXPECT_SOAFLOAT3_EQ(output_transforms[1].translation, 12.f, 13.f, 14.f,
+                        15.f, 16.f, 17.f, 18.f, 19.f, 20.f, 21.f, 22.f, 23.f);
   }
 }
 
@@ -869,3 +897,697 @@ TEST(AdditiveJointWeight, BlendingJob) {
                             1.f / 20.f, 1.f / 11.f, 1.f, 1.f);
   }
 }
+
+TEST(Mask, BlendingJob) {
+  // 20 SoA joints, so that masks span 3 bytes.
+  const int kNumSoaJoints = 20;
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  ozz::math::SoaTransform rest_poses[kNumSoaJoints];
+  ozz::math::SoaTransform input_transforms[3][kNumSoaJoints];
+  ozz::math::SimdFloat4 joint_weights[kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    const float fi = static_cast<float>(i);
+    rest_poses[i] = identity;
+    rest_poses[i].translation.y = ozz::math::simd_float4::Load1(fi);
+    for (int l = 0; l < 3; ++l) {
+      const float fl = static_cast<float>(l + 1);
+      input_transforms[l][i] = identity;
+      input_transforms[l][i].translation = ozz::math::SoaFloat3::Load(
+          ozz::math::simd_float4::Load(fi, fl, -fi, fi * fl),
+          ozz::math::simd_float4::Load(fl, fi, 1.f, 2.f),
+          ozz::math::simd_float4::Load(0.f, -fl, fi, 3.f));
+      const float angles[4] = {.1f * fi, .2f * fl, .3f, -.1f * fi};
+      input_transforms[l][i].rotation.x = ozz::math::simd_float4::Load(
+          std::sin(angles[0]), std::sin(angles[1]), std::sin(angles[2]),
+          std::sin(angles[3]));
+      input_transforms[l][i].rotation.w = ozz::math::simd_float4::Load(
+          std::cos(angles[0]), std::cos(angles[1]), std::cos(angles[2]),
+          std::cos(angles[3]));
+      input_transforms[l][i].scale = ozz::math::SoaFloat3::Load(
+          ozz::math::simd_float4::Load1(1.f + .1f * fl),
+          ozz::math::simd_float4::Load1(1.f),
+          ozz::math::simd_float4::Load1(1.f - .01f * fi));
+    }
+    joint_weights[i] = ozz::math::simd_float4::Load(.5f, .1f * (i % 10), 1.f,
+                                                      i % 3 ? 1.f : 0.f);
+  }
+
+  // Masks enable SoA joints 0, 2, 4-9 and 17.
+  // Second one is all disabled, except for joint 19.
+  const uint8_t masks[2][3] = {{0xf5, 0x03, 0x02}, {0x00, 0x00, 0x08}};
+
+  // Expands masks to joint weights, as reference.
+  ozz::math::SimdFloat4 masked_weights[2][2][kNumSoaJoints];
+  for (int m = 0; m < 2; ++m) {
+    for (int i = 0; i < kNumSoaJoints; ++i) {
+      const bool enabled = (masks[m][i / 8] & (1 << (i % 8))) != 0;
+      masked_weights[m][0][i] =
+          enabled ? ozz::math::simd_float4::one()
+                  : ozz::math::simd_float4::zero();
+      masked_weights[m][1][i] =
+          enabled ? joint_weights[i] : ozz::math::simd_float4::zero();
+    }
+  }
+
+  {  // Mask too small.
+    BlendingJob::Layer layers[1];
+    layers[0].transform = input_transforms[0];
+    layers[0].mask = ozz::span<const uint8_t>(masks[0], 2);
+    ozz::math::SoaTransform output[kNumSoaJoints];
+    BlendingJob job;
+    job.layers = layers;
+    job.rest_pose = rest_poses;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    job.rest_pose = ozz::make_span(rest_poses).subspan(0, 16);
+    EXPECT_TRUE(job.Validate());
+    job.rest_pose = rest_poses;
+    job.layers = {};
+    job.additive_layers = layers;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  // Tests all combinations of masks, per-joint weights, layer order (masked
+  // layer first or not) and additive layers.
+  for (int m = 0; m < 2; ++m) {
+    for (int jw = 0; jw < 2; ++jw) {
+      for (int first = 0; first < 2; ++first) {
+        for (int additive = 0; additive < 2; ++additive) {
+          BlendingJob::Layer layers[2];
+          BlendingJob::Layer additive_layers[1];
+          BlendingJob::Layer masked;
+          masked.weight = additive && first ? -.7f : .7f;
+          masked.transform = input_transforms[2];
+          masked.mask = masks[m];
+          if (jw) {
+            masked.joint_weights = joint_weights;
+          }
+          BlendingJob::Layer full;
+          full.weight = .4f;
+          full.transform = input_transforms[first];
+
+          // Reference layer uses weights instead of mask.
+          BlendingJob::Layer reference = masked;
+          reference.mask = {};
+          reference.joint_weights = masked_weights[m][jw];
+
+          ozz::math::SoaTransform expected[kNumSoaJoints];
+          ozz::math::SoaTransform output[kNumSoaJoints];
+          for (int r = 0; r < 2; ++r) {
+            const BlendingJob::Layer& layer = r ? masked : reference;
+            BlendingJob job;
+            job.rest_pose = rest_poses;
+            job.output = r ? output : expected;
+            if (additive) {
+              layers[0] = full;
+              additive_layers[0] = layer;
+              job.layers = ozz::make_span(layers).subspan(0, 1);
+              job.additive_layers = additive_layers;
+            } else {
+              layers[first ? 0 : 1] = layer;
+              layers[first ? 1 : 0] = full;
+              job.layers = layers;
+            }
+            ASSERT_TRUE(job.Run());
+          }
+
+          const float* floats = reinterpret_cast<const float*>(output);
+          const float* expected_floats =
+              reinterpret_cast<const float*>(expected);
+          const size_t num_floats =
+              kNumSoaJoints * sizeof(ozz::math::SoaTransform) / sizeof(float);
+          for (size_t f = 0; f < num_floats; ++f) {
+            ASSERT_NEAR(floats[f], expected_floats[f], 2e-3f)
+                << "mask " << m << ", jw " << jw << ", first " << first
+                << ", additive " << additive << ", float " << f;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(Sparse, BlendingJob) {
+  const int kNumSoaJoints = 12;
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  ozz::math::SoaTransform rest_poses[kNumSoaJoints];
+  ozz::math::SoaTransform full_transforms[kNumSoaJoints];
+  ozz::math::SoaTransform dense_transforms[kNumSoaJoints];
+  ozz::math::SimdFloat4 dense_weights[kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    const float fi = static_cast<float>(i);
+    rest_poses[i] = identity;
+    rest_poses[i].translation.x = ozz::math::simd_float4::Load1(fi);
+    full_transforms[i] = identity;
+    full_transforms[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(fi, 1.f, -fi, 2.f),
+        ozz::math::simd_float4::Load(1.f, fi, 3.f, -2.f),
+        ozz::math::simd_float4::Load(0.f, -1.f, fi, 3.f));
+    dense_transforms[i] = identity;
+    dense_transforms[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(1.f, -fi, 2.f, fi),
+        ozz::math::simd_float4::Load(fi, 2.f, 1.f, 0.f),
+        ozz::math::simd_float4::Load(-2.f, 0.f, 1.f, fi));
+    const float angles[4] = {.1f * fi, .4f, -.3f, .2f * fi};
+    dense_transforms[i].rotation.y = ozz::math::simd_float4::Load(
+        std::sin(angles[0]), std::sin(angles[1]), std::sin(angles[2]),
+        std::sin(angles[3]));
+    dense_transforms[i].rotation.w = ozz::math::simd_float4::Load(
+        std::cos(angles[0]), std::cos(angles[1]), std::cos(angles[2]),
+        std::cos(angles[3]));
+    dense_transforms[i].scale = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load1(1.f + .1f * fi),
+        ozz::math::simd_float4::Load1(.9f),
+        ozz::math::simd_float4::Load1(1.f));
+    dense_weights[i] =
+        ozz::math::simd_float4::Load(.5f, .1f * fi, 1.f, i % 2 ? 1.f : 0.f);
+  }
+
+  // Sparse layer stores SoA joints 1, 4, 5 and 9, compacted from dense
+  // buffers. Reference is the same layer, masked.
+  const uint16_t soa_joints[] = {1, 4, 5, 9};
+  const uint8_t mask[] = {0x32, 0x02};
+  ozz::math::SoaTransform sparse_transforms[4];
+  ozz::math::SimdFloat4 sparse_weights[4];
+  for (int k = 0; k < 4; ++k) {
+    sparse_transforms[k] = dense_transforms[soa_joints[k]];
+    sparse_weights[k] = dense_weights[soa_joints[k]];
+  }
+
+  {  // Validation.
+    BlendingJob::Layer layers[1];
+    layers[0].transform = sparse_transforms;
+    layers[0].soa_joints = soa_joints;
+    ozz::math::SoaTransform output[kNumSoaJoints];
+    BlendingJob job;
+    job.layers = layers;
+    job.rest_pose = rest_poses;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+
+    // Compact joint weights.
+    layers[0].joint_weights = sparse_weights;
+    EXPECT_TRUE(job.Validate());
+    layers[0].joint_weights = ozz::make_span(sparse_weights).subspan(0, 3);
+    EXPECT_FALSE(job.Validate());
+    layers[0].joint_weights = {};
+
+    // Transforms too small.
+    layers[0].transform = ozz::make_span(sparse_transforms).subspan(0, 3);
+    EXPECT_FALSE(job.Validate());
+    layers[0].transform = sparse_transforms;
+
+    // Out of rest pose range.
+    job.rest_pose = ozz::make_span(rest_poses).subspan(0, 9);
+    EXPECT_FALSE(job.Validate());
+    job.rest_pose = rest_poses;
+
+    // Not sorted.
+    const uint16_t unsorted[] = {1, 5, 4, 9};
+    layers[0].soa_joints = unsorted;
+    EXPECT_FALSE(job.Validate());
+    const uint16_t duplicated[] = {1, 4, 4, 9};
+    layers[0].soa_joints = duplicated;
+    EXPECT_FALSE(job.Validate());
+    layers[0].soa_joints = soa_joints;
+
+    // Can't be masked.
+    layers[0].mask = mask;
+    EXPECT_FALSE(job.Validate());
+    layers[0].mask = {};
+
+    // Also applies to additive layers.
+    job.layers = {};
+    job.additive_layers = layers;
+    EXPECT_TRUE(job.Validate());
+    layers[0].soa_joints = unsorted;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  // Tests sparse layers against masked ones, with and without per-joint
+  // weights, as first blended layer or not, and as additive layers.
+  for (int jw = 0; jw < 2; ++jw) {
+    for (int first = 0; first < 2; ++first) {
+      for (int additive = 0; additive < 2; ++additive) {
+        BlendingJob::Layer full;
+        full.weight = .4f;
+        full.transform = full_transforms;
+
+        BlendingJob::Layer sparse;
+        sparse.weight = additive && first ? -.6f : .6f;
+        sparse.transform = sparse_transforms;
+        sparse.soa_joints = soa_joints;
+        if (jw) {
+          sparse.joint_weights = sparse_weights;
+        }
+
+        BlendingJob::Layer masked = sparse;
+        masked.soa_joints = {};
+        masked.mask = mask;
+        masked.transform = dense_transforms;
+        if (jw) {
+          masked.joint_weights = dense_weights;
+        }
+
+        ozz::math::SoaTransform expected[kNumSoaJoints];
+        ozz::math::SoaTransform output[kNumSoaJoints];
+        for (int r = 0; r < 2; ++r) {
+          BlendingJob::Layer layers[2];
+          BlendingJob::Layer additive_layers[1];
+          const BlendingJob::Layer& layer = r ? sparse : masked;
+          BlendingJob job;
+          job.rest_pose = rest_poses;
+          job.output = r ? output : expected;
+          if (additive) {
+            layers[0] = full;
+            additive_layers[0] = layer;
+            job.layers = ozz::make_span(layers).subspan(0, 1);
+            job.additive_layers = additive_layers;
+          } else {
+            layers[first ? 0 : 1] = layer;
+            layers[first ? 1 : 0] = full;
+            job.layers = layers;
+          }
+          ASSERT_TRUE(job.Run());
+        }
+
+        const float* floats = reinterpret_cast<const float*>(output);
+        const float* expected_floats = reinterpret_cast<const float*>(expected);
+        const size_t num_floats =
+            kNumSoaJoints * sizeof(ozz::math::SoaTransform) / sizeof(float);
+        for (size_t f = 0; f < num_floats; ++f) {
+          ASSERT_FLOAT_EQ(floats[f], expected_floats[f])
+              << "jw " << jw << ", first " << first << ", additive "
+              << additive << ", float " << f;
+        }
+      }
+    }
+  }
+}
+
+TEST(SampleBlendJobValidity, BlendingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(8);
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+  const ozz::math::SoaTransform rest_poses[3] = {identity, identity, identity};
+  ozz::math::SoaTransform output[3];
+  ozz::math::SimdFloat4 joint_weights[3] = {zero, zero, zero};
+  SamplingJob::Context context(8);
+  SamplingJob::Context small_context(4);
+
+  {  // Default job.
+    SampleBlendingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // No layer.
+    SampleBlendingJob job;
+    job.rest_pose = ozz::make_span(rest_poses).subspan(0, 2);
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Invalid threshold.
+    SampleBlendingJob job;
+    job.threshold = 0.f;
+    job.rest_pose = ozz::make_span(rest_poses).subspan(0, 2);
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Output too small.
+    SampleBlendingJob job;
+    job.rest_pose = ozz::make_span(rest_poses).subspan(0, 2);
+    job.output = ozz::make_span(output).subspan(0, 1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Layer without animation or context.
+    SampleBlendingJob::Layer layers[1];
+    SampleBlendingJob job;
+    job.rest_pose = ozz::make_span(rest_poses).subspan(0, 2);
+    job.output = output;
+    job.layers = layers;
+    EXPECT_FALSE(job.Validate());
+    layers[0].animation = animation.get();
+    EXPECT_FALSE(job.Validate());
+    layers[0].context = &context;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    layers[0].animation = nullptr;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Context too small.
+    SampleBlendingJob::Layer layers[1];
+    layers[0].animation = animation.get();
+    layers[0].context = &small_context;
+    SampleBlendingJob job;
+    job.rest_pose = ozz::make_span(rest_poses).subspan(0, 1);
+    job.output = output;
+    job.additive_layers = layers;
+    EXPECT_FALSE(job.Validate());
+    layers[0].context = &context;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Animation has less tracks than the rest pose.
+    SampleBlendingJob::Layer layers[1];
+    layers[0].animation = animation.get();
+    layers[0].context = &context;
+    SampleBlendingJob job;
+    job.rest_pose = rest_poses;
+    job.output = output;
+    job.layers = layers;
+    EXPECT_FALSE(job.Validate());
+    job.rest_pose = ozz::make_span(rest_poses).subspan(0, 2);
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Joint weights too small.
+    SampleBlendingJob::Layer layers[1];
+    layers[0].animation = animation.get();
+    layers[0].context = &context;
+    layers[0].joint_weights = ozz::make_span(joint_weights).subspan(0, 1);
+    SampleBlendingJob job;
+    job.rest_pose = ozz::make_span(rest_poses).subspan(0, 2);
+    job.output = output;
+    job.layers = layers;
+    EXPECT_FALSE(job.Validate());
+    layers[0].joint_weights = joint_weights;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(SampleBlend, BlendingJob) {
+  // Builds 3 animations with 40 tracks (10 SoA tracks, more than a chunk).
+  const int kNumTracks = 40;
+  const int kNumSoaTracks = kNumTracks / 4;
+  const int kNumAnimations = 3;
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animations[kNumAnimations];
+  for (int a = 0; a < kNumAnimations; ++a) {
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(kNumTracks);
+    for (int i = 0; i < kNumTracks; ++i) {
+      RawAnimation::JointTrack& track = raw_animation.tracks[i];
+      const float fi = static_cast<float>(i + a * 7);
+      for (int k = 0; k <= 4; ++k) {
+        const float time = k / 4.f;
+        const RawAnimation::TranslationKey tkey = {
+            time, ozz::math::Float3(fi, fi * k, -1.f * a)};
+        track.translations.push_back(tkey);
+        const RawAnimation::RotationKey rkey = {
+            time, ozz::math::Quaternion::FromAxisAngle(
+                      ozz::math::Float3::y_axis(), .05f * (fi + k))};
+        track.rotations.push_back(rkey);
+        const RawAnimation::ScaleKey skey = {
+            time, ozz::math::Float3(1.f + .1f * k, 1.f, 1.f + .01f * fi)};
+        track.scales.push_back(skey);
+      }
+    }
+    animations[a] = builder(raw_animation);
+    ASSERT_TRUE(animations[a]);
+  }
+
+  ozz::math::SoaTransform rest_pose[kNumSoaTracks];
+  ozz::math::SimdFloat4 joint_weights[kNumSoaTracks];
+  for (int i = 0; i < kNumSoaTracks; ++i) {
+    rest_pose[i] = ozz::math::SoaTransform::identity();
+    rest_pose[i].translation.x = ozz::math::simd_float4::Load1(1.f * i);
+    joint_weights[i] = ozz::math::simd_float4::Load(
+        0.f, .1f * i, i % 2 ? 1.f : 0.f, 1.f - .1f * i);
+  }
+
+  // Reference, sampling each layer to its own buffer.
+  SamplingJob::Context ref_contexts[kNumAnimations];
+  ozz::math::SoaTransform locals[kNumAnimations][kNumSoaTracks];
+
+  // Fused job contexts.
+  SamplingJob::Context contexts[kNumAnimations];
+  for (int a = 0; a < kNumAnimations; ++a) {
+    ref_contexts[a].Resize(kNumTracks);
+    contexts[a].Resize(kNumTracks);
+  }
+
+  struct {
+    float weights[kNumAnimations];
+    bool partial[kNumAnimations];
+    bool additive[kNumAnimations];
+    float threshold;
+  } configs[] = {
+      {{1.f, 0.f, 0.f}, {false, false, false}, {false, false, false}, .1f},
+      {{.3f, .7f, .2f}, {false, false, false}, {false, false, false}, .1f},
+      {{0.f, 0.f, 0.f}, {false, false, false}, {false, false, false}, .1f},
+      {{.01f, .02f, 0.f}, {false, false, false}, {false, false, false}, .1f},
+      {{.5f, 1.f, .2f}, {true, false, true}, {false, false, false}, .1f},
+      {{.5f, .1f, 0.f}, {true, true, false}, {false, false, false}, .4f},
+      {{1.f, .5f, -.6f}, {false, true, false}, {false, true, true}, .1f},
+      {{.8f, .5f, 1.f}, {true, false, true}, {false, true, true}, .1f},
+      {{0.f, -1.f, .3f}, {false, false, false}, {false, true, true}, .1f},
+  };
+
+  const float ratios[] = {0.f, .2f, .5f, .55f, 1.f, .3f};
+  for (size_t c = 0; c < OZZ_ARRAY_SIZE(configs); ++c) {
+    for (size_t r = 0; r < OZZ_ARRAY_SIZE(ratios); ++r) {
+      BlendingJob::Layer ref_layers[kNumAnimations];
+      BlendingJob::Layer ref_additive_layers[kNumAnimations];
+      SampleBlendingJob::Layer layers[kNumAnimations];
+      SampleBlendingJob::Layer additive_layers[kNumAnimations];
+      size_t num_layers = 0;
+      size_t num_additive_layers = 0;
+      for (int a = 0; a < kNumAnimations; ++a) {
+        const float ratio = ratios[r] + .1f * a;
+
+        SamplingJob sampling_job;
+        sampling_job.animation = animations[a].get();
+        sampling_job.context = &ref_contexts[a];
+        sampling_job.ratio = ratio;
+        sampling_job.output = locals[a];
+        ASSERT_TRUE(sampling_job.Run());
+
+        BlendingJob::Layer ref_layer;
+        ref_layer.weight = configs[c].weights[a];
+        ref_layer.transform = locals[a];
+        SampleBlendingJob::Layer layer;
+        layer.weight = configs[c].weights[a];
+        layer.animation = animations[a].get();
+        layer.ratio = ratio;
+        layer.context = &contexts[a];
+        if (configs[c].partial[a]) {
+          ref_layer.joint_weights = joint_weights;
+          layer.joint_weights = joint_weights;
+        }
+        if (configs[c].additive[a]) {
+          ref_additive_layers[num_additive_layers] = ref_layer;
+          additive_layers[num_additive_layers++] = layer;
+        } else {
+          ref_layers[num_layers] = ref_layer;
+          layers[num_layers++] = layer;
+        }
+      }
+
+      ozz::math::SoaTransform ref_output[kNumSoaTracks];
+      BlendingJob ref_job;
+      ref_job.threshold = configs[c].threshold;
+      ref_job.layers = ozz::make_span(ref_layers).subspan(0, num_layers);
+      ref_job.additive_layers =
+          ozz::make_span(ref_additive_layers).subspan(0, num_additive_layers);
+      ref_job.rest_pose = rest_pose;
+      ref_job.output = ref_output;
+      ASSERT_TRUE(ref_job.Run());
+
+      ozz::math::SoaTransform output[kNumSoaTracks];
+      SampleBlendingJob job;
+      job.threshold = configs[c].threshold;
+      job.layers = ozz::make_span(layers).subspan(0, num_layers);
+      job.additive_layers =
+          ozz::make_span(additive_layers).subspan(0, num_additive_layers);
+      job.rest_pose = rest_pose;
+      job.output = output;
+      ASSERT_TRUE(job.Run());
+
+      // Same operations are performed, so results are strictly the same.
+      EXPECT_EQ(std::memcmp(output, ref_output, sizeof(output)), 0)
+          << "config " << c << ", ratio " << ratios[r];
+
+      // Synchronized job ignores layers ratio.
+      for (size_t l = 0; l < num_layers; ++l) {
+        layers[l].ratio = -1.f;
+      }
+      for (size_t l = 0; l < num_additive_layers; ++l) {
+        additive_layers[l].ratio = 2.f;
+      }
+      job.synchronized = true;
+      job.ratio = ratios[r];
+      ozz::math::SoaTransform sync_output[kNumSoaTracks];
+      job.output = sync_output;
+      ASSERT_TRUE(job.Run());
+
+      // Reference, all layers sampled at the same ratio.
+      for (size_t l = 0; l < num_layers; ++l) {
+        layers[l].ratio = ratios[r];
+      }
+      for (size_t l = 0; l < num_additive_layers; ++l) {
+        additive_layers[l].ratio = ratios[r];
+      }
+      job.synchronized = false;
+      job.ratio = 0.f;
+      job.output = output;
+      ASSERT_TRUE(job.Run());
+      EXPECT_EQ(std::memcmp(output, sync_output, sizeof(output)), 0)
+          << "config " << c << ", ratio " << ratios[r];
+    }
+  }
+}
+
+TEST(LargeSkeleton, BlendingJob) {
+  // More joints than Skeleton::kMaxInlineJoints, so that the job uses
+  // allocated scratch memory.
+  const size_t num_soa_joints = Skeleton::kMaxSoAJoints;
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  ozz::vector<ozz::math::SoaTransform> rest_pose(num_soa_joints, identity);
+  ozz::vector<ozz::math::SoaTransform> inputs[2] = {
+      ozz::vector<ozz::math::SoaTransform>(num_soa_joints, identity),
+      ozz::vector<ozz::math::SoaTransform>(num_soa_joints, identity)};
+  for (size_t i = 0; i < num_soa_joints; ++i) {
+    inputs[0][i].translation.x = ozz::math::simd_float4::Load1(2.f);
+    inputs[1][i].translation.x = ozz::math::simd_float4::Load1(4.f);
+  }
+
+  // Second layer doesn't affect the last SoA joint.
+  ozz::vector<ozz::math::SimdFloat4> joint_weights(
+      num_soa_joints, ozz::math::simd_float4::one());
+  joint_weights.back() = ozz::math::simd_float4::zero();
+
+  BlendingJob::Layer layers[2];
+  layers[0].transform = make_span(inputs[0]);
+  layers[0].weight = 1.f;
+  layers[1].transform = make_span(inputs[1]);
+  layers[1].weight = 1.f;
+  layers[1].joint_weights = make_span(joint_weights);
+
+  ozz::vector<ozz::math::SoaTransform> output(num_soa_joints);
+  BlendingJob job;
+  job.layers = layers;
+  job.rest_pose = make_span(rest_pose);
+  job.output = make_span(output);
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_SOAFLOAT3_EQ(output[0].translation, 3.f, 3.f, 3.f, 3.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(output[num_soa_joints - 2].translation, 3.f, 3.f, 3.f,
+                      3.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ(output[num_soa_joints - 1].translation, 2.f, 2.f, 2.f,
+                      2.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+}
+
+TEST(HalfLayers, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const int kNumSoaJoints = 3;
+
+  // Builds layers transforms, and their half precision version.
+  ozz::math::SoaTransform transforms[3][kNumSoaJoints];
+  ozz::math::SoaHalfTransform halves[3][kNumSoaJoints];
+  for (int l = 0; l < 3; ++l) {
+    for (int i = 0; i < kNumSoaJoints; ++i) {
+      const float f = static_cast<float>(l * kNumSoaJoints + i);
+      ozz::math::SoaTransform& transform = transforms[l][i];
+      transform.translation = ozz::math::SoaFloat3::Load(
+          ozz::math::simd_float4::Load(f, 1.f, -2.f, .5f),
+          ozz::math::simd_float4::Load(-f, 0.f, 3.f, .25f),
+          ozz::math::simd_float4::Load(1.f, f, 2.f, -.5f));
+      transform.rotation = ozz::math::SoaQuaternion::Load(
+          ozz::math::simd_float4::Load(0.f, .6f, 0.f, .70710677f),
+          ozz::math::simd_float4::Load(0.f, 0.f, .8f, 0.f),
+          ozz::math::simd_float4::Load(.6f, 0.f, 0.f, 0.f),
+          ozz::math::simd_float4::Load(.8f, .8f, -.6f, .70710677f));
+      transform.scale = ozz::math::SoaFloat3::Load(
+          ozz::math::simd_float4::Load(1.f, 2.f, .5f, 1.5f),
+          ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f),
+          ozz::math::simd_float4::Load(2.f, 1.f, .25f, 1.f));
+      ozz::math::PackHalf(transform, &halves[l][i]);
+    }
+  }
+
+  const ozz::math::SoaTransform rest_pose[kNumSoaJoints] = {identity, identity,
+                                                            identity};
+  const ozz::math::SimdFloat4 joint_weights[kNumSoaJoints] = {
+      ozz::math::simd_float4::Load(1.f, .5f, 0.f, .25f),
+      ozz::math::simd_float4::one(), ozz::math::simd_float4::Load1(.75f)};
+  const uint8_t mask[] = {0x5};
+  const uint16_t soa_joints[] = {1};
+
+  // Runs the same job with full and half precision layers.
+  ozz::math::SoaTransform outputs[2][kNumSoaJoints];
+  for (int half = 0; half < 2; ++half) {
+    BlendingJob::Layer layers[3];
+    BlendingJob::Layer additive_layers[2];
+    for (int l = 0; l < 3; ++l) {
+      if (half) {
+        layers[l].half_transform = halves[l];
+      } else {
+        layers[l].transform = transforms[l];
+      }
+    }
+    layers[0].weight = .5f;
+    layers[0].joint_weights = joint_weights;
+    layers[1].weight = .25f;
+    layers[1].mask = mask;
+    layers[2].weight = 1.f;
+    layers[2].soa_joints = soa_joints;
+    if (half) {
+      layers[2].half_transform = {halves[2], 1};
+    } else {
+      layers[2].transform = {transforms[2], 1};
+    }
+    additive_layers[0] = layers[1];
+    additive_layers[0].weight = .5f;
+    additive_layers[1] = layers[0];
+    additive_layers[1].weight = -.25f;
+
+    BlendingJob job;
+    job.layers = layers;
+    job.additive_layers = additive_layers;
+    job.rest_pose = rest_pose;
+    job.output = outputs[half];
+    ASSERT_TRUE(job.Run());
+  }
+
+  const float* expected = reinterpret_cast<const float*>(outputs[0]);
+  const float* actual = reinterpret_cast<const float*>(outputs[1]);
+  const size_t num_floats = kNumSoaJoints * sizeof(identity) / sizeof(float);
+  for (size_t i = 0; i < num_floats; ++i) {
+    EXPECT_NEAR(actual[i], expected[i], 2e-3f) << i;
+  }
+
+  {  // Transform and half_transform are exclusive.
+    BlendingJob::Layer layer;
+    layer.weight = 1.f;
+    layer.transform = transforms[0];
+    layer.half_transform = halves[0];
+    ozz::math::SoaTransform output[kNumSoaJoints];
+    BlendingJob job;
+    job.layers = {&layer, 1};
+    job.rest_pose = rest_pose;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    layer.transform = {};
+    EXPECT_TRUE(job.Validate());
+    layer.half_transform = {halves[0], 2};
+    EXPECT_FALSE(job.Validate());
+  }
+}
@@ -0,0 +1,144 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/event_track.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_track.h"
+#include "ozz/animation/offline/track_builder.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::EventTrack;
+using ozz::animation::offline::RawEventTrack;
+using ozz::animation::offline::TrackBuilder;
+
+TEST(State, EventTrack) {
+  {  // Default track.
+    EventTrack track;
+    EXPECT_FALSE(track.State(0.f));
+    EXPECT_FALSE(track.State(1.f));
+    EventTrack::Window windows[2];
+    EXPECT_EQ(track.Windows(0.f, 1.f, windows), 0u);
+  }
+
+  RawEventTrack raw_track;
+  const RawEventTrack::Keyframe keys[] = {
+      {0.f, true}, {.25f, false}, {.5f, true}, {.75f, false}, {.9f, true}};
+  raw_track.keyframes.assign(keys, keys + OZZ_ARRAY_SIZE(keys));
+
+  TrackBuilder builder;
+  ozz::unique_ptr<EventTrack> track(builder(raw_track));
+  ASSERT_TRUE(track);
+  ASSERT_EQ(track->num_toggles(), 5);
+
+  // Toggles are included.
+  EXPECT_TRUE(track->State(-1.f));
+  EXPECT_TRUE(track->State(0.f));
+  EXPECT_TRUE(track->State(.1f));
+  EXPECT_FALSE(track->State(track->toggle_ratio(1)));
+  EXPECT_FALSE(track->State(.3f));
+  EXPECT_TRUE(track->State(track->toggle_ratio(2)));
+  EXPECT_TRUE(track->State(.6f));
+  EXPECT_FALSE(track->State(.8f));
+  EXPECT_TRUE(track->State(track->toggle_ratio(4)));
+  EXPECT_TRUE(track->State(1.f));
+  EXPECT_TRUE(track->State(2.f));
+
+  // States match the raw track, away from quantized toggles.
+  for (int i = 0; i < 1000; ++i) {
+    const float ratio = (i + .5f) / 1000.f;
+    bool expected = false;
+    for (const RawEventTrack::Keyframe& key : raw_track.keyframes) {
+      if (key.ratio <= ratio) {
+        expected = key.value;
+      }
+    }
+    EXPECT_EQ(track->State(ratio), expected) << ratio;
+  }
+}
+
+TEST(Windows, EventTrack) {
+  RawEventTrack raw_track;
+  const RawEventTrack::Keyframe keys[] = {
+      {.1f, true}, {.2f, false}, {.4f, true}, {.5f, false}, {.8f, true}};
+  raw_track.keyframes.assign(keys, keys + OZZ_ARRAY_SIZE(keys));
+
+  TrackBuilder builder;
+  ozz::unique_ptr<EventTrack> track(builder(raw_track));
+  ASSERT_TRUE(track);
+
+  EventTrack::Window windows[3];
+
+  {  // Whole track.
+    ASSERT_EQ(track->Windows(0.f, 1.f, windows), 3u);
+    EXPECT_NEAR(windows[0].begin, .1f, 1e-5f);
+    EXPECT_NEAR(windows[0].end, .2f, 1e-5f);
+    EXPECT_NEAR(windows[1].begin, .4f, 1e-5f);
+    EXPECT_NEAR(windows[1].end, .5f, 1e-5f);
+    EXPECT_NEAR(windows[2].begin, .8f, 1e-5f);
+    EXPECT_FLOAT_EQ(windows[2].end, 1.f);
+  }
+
+  {  // Windows aren't clipped.
+    ASSERT_EQ(track->Windows(.15f, .45f, windows), 2u);
+    EXPECT_NEAR(windows[0].begin, .1f, 1e-5f);
+    EXPECT_NEAR(windows[1].end, .5f, 1e-5f);
+  }
+
+  {  // Range between windows.
+    EXPECT_EQ(track->Windows(.25f, .35f, windows), 0u);
+    EXPECT_EQ(track->Windows(0.f, .05f, windows), 0u);
+  }
+
+  {  // Window end is excluded, begin is included.
+    EXPECT_EQ(track->Windows(track->toggle_ratio(1), .3f, windows), 0u);
+    ASSERT_EQ(track->Windows(.3f, track->toggle_ratio(2), windows), 1u);
+    EXPECT_NEAR(windows[0].begin, .4f, 1e-5f);
+  }
+
+  {  // Single ratio range.
+    EXPECT_EQ(track->Windows(.45f, .45f, windows), 1u);
+    EXPECT_EQ(track->Windows(.6f, .6f, windows), 0u);
+    ASSERT_EQ(track->Windows(1.f, 1.f, windows), 1u);
+    EXPECT_NEAR(windows[0].begin, .8f, 1e-5f);
+  }
+
+  {  // Output too small.
+    EventTrack::Window window = {0.f, 0.f};
+    const ozz::span<EventTrack::Window> one(&window, 1);
+    EXPECT_EQ(track->Windows(0.f, 1.f, one), 3u);
+    EXPECT_NEAR(window.begin, .1f, 1e-5f);
+    EXPECT_EQ(track->Windows(0.f, 1.f, ozz::span<EventTrack::Window>()), 3u);
+  }
+
+  // Windows match states.
+  for (int i = 0; i <= 100; ++i) {
+    const float ratio = i / 100.f;
+    EXPECT_EQ(track->Windows(ratio, ratio, windows) == 1u,
+              track->State(ratio));
+  }
+}
@@ -0,0 +1,319 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/fixed_size_jobs.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::BlendingJob;
+using ozz::animation::FixedBlendingJob;
+using ozz::animation::FixedLocalToModelJob;
+using ozz::animation::FixedSamplingJob;
+using ozz::animation::FixedSkeletonSize;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// 6 joints skeleton, whose last SoA joint is partial.
+typedef FixedSkeletonSize<6> TestRig;
+
+ozz::unique_ptr<Skeleton> BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  RawSkeleton::Joint& root0 = raw_skeleton.roots[0];
+  root0.name = "root0";
+  root0.children.resize(2);
+  root0.children[0].name = "j0";
+  root0.children[0].children.resize(1);
+  root0.children[0].children[0].name = "j1";
+  root0.children[1].name = "j2";
+  RawSkeleton::Joint& root1 = raw_skeleton.roots[1];
+  root1.name = "root1";
+  root1.children.resize(1);
+  root1.children[0].name = "j3";
+  EXPECT_EQ(raw_skeleton.num_joints(), TestRig::kNumJoints);
+
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Builds a pose whose values depend on _seed.
+void BuildPose(float _seed, ozz::math::SoaTransform* _pose) {
+  for (int i = 0; i < TestRig::kNumSoaJoints; ++i) {
+    const float s = _seed + i;
+    const ozz::math::SimdFloat4 t =
+        ozz::math::simd_float4::Load(s, s + .1f, -s, s * .5f);
+    const ozz::math::SoaQuaternion q =
+        NormalizeEst(ozz::math::SoaQuaternion::Load(
+            t, ozz::math::simd_float4::Load(.2f, -.3f, .4f, .1f) * t,
+            ozz::math::simd_float4::Load1(.5f),
+            ozz::math::simd_float4::Load(1.f, -1.f, .7f, .3f)));
+    _pose[i].translation = ozz::math::SoaFloat3::Load(t, t * t, -t);
+    _pose[i].rotation = q;
+    _pose[i].scale = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(1.f, 2.f, .5f, 1.5f),
+        ozz::math::simd_float4::one(),
+        ozz::math::simd_float4::Load1(1.2f));
+  }
+}
+
+void ExpectSimdFloatNear(ozz::math::SimdFloat4 _a, ozz::math::SimdFloat4 _b) {
+  float a[4], b[4];
+  ozz::math::StorePtrU(_a, a);
+  ozz::math::StorePtrU(_b, b);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NEAR(a[i], b[i], 1e-5f);
+  }
+}
+
+void ExpectTransformNear(const ozz::math::SoaTransform& _a,
+                         const ozz::math::SoaTransform& _b) {
+  ExpectSimdFloatNear(_a.translation.x, _b.translation.x);
+  ExpectSimdFloatNear(_a.translation.y, _b.translation.y);
+  ExpectSimdFloatNear(_a.translation.z, _b.translation.z);
+  ExpectSimdFloatNear(_a.rotation.x, _b.rotation.x);
+  ExpectSimdFloatNear(_a.rotation.y, _b.rotation.y);
+  ExpectSimdFloatNear(_a.rotation.z, _b.rotation.z);
+  ExpectSimdFloatNear(_a.rotation.w, _b.rotation.w);
+  ExpectSimdFloatNear(_a.scale.x, _b.scale.x);
+  ExpectSimdFloatNear(_a.scale.y, _b.scale.y);
+  ExpectSimdFloatNear(_a.scale.z, _b.scale.z);
+}
+}  // namespace
+
+TEST(FixedSkeletonSize, FixedSizeJobs) {
+  EXPECT_EQ(FixedSkeletonSize<1>::kNumSoaJoints, 1);
+  EXPECT_EQ(FixedSkeletonSize<4>::kNumSoaJoints, 1);
+  EXPECT_EQ(FixedSkeletonSize<5>::kNumSoaJoints, 2);
+  EXPECT_EQ(TestRig::kNumSoaJoints, 2);
+}
+
+TEST(Sampling, FixedSizeJobs) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(TestRig::kNumJoints);
+  for (int i = 0; i < TestRig::kNumJoints; ++i) {
+    const RawAnimation::TranslationKey key0 = {
+        0.f, ozz::math::Float3(0.f, 1.f * i, 0.f)};
+    const RawAnimation::TranslationKey key1 = {
+        1.f, ozz::math::Float3(2.f, 1.f * i, -4.f)};
+    raw_animation.tracks[i].translations.push_back(key0);
+    raw_animation.tracks[i].translations.push_back(key1);
+  }
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  SamplingJob::Context context(TestRig::kNumJoints);
+  ozz::math::SoaTransform output[TestRig::kNumSoaJoints];
+  ozz::math::SoaTransform expected[TestRig::kNumSoaJoints];
+
+  FixedSamplingJob<TestRig::kNumSoaJoints> job;
+  EXPECT_FALSE(job.Validate());
+  job.animation = animation.get();
+  job.context = &context;
+  job.ratio = .5f;
+  EXPECT_FALSE(job.Validate());
+  job.output = ozz::span<ozz::math::SoaTransform>(output, 1);
+  EXPECT_FALSE(job.Validate());
+  job.output = output;
+  EXPECT_TRUE(job.Validate());
+
+  // Animation size mismatch.
+  FixedSamplingJob<3> mismatch_job;
+  mismatch_job.animation = animation.get();
+  mismatch_job.context = &context;
+  mismatch_job.output = output;
+  EXPECT_FALSE(mismatch_job.Validate());
+  EXPECT_FALSE(mismatch_job.Run());
+
+  ASSERT_TRUE(job.Run());
+
+  SamplingJob::Context expected_context(TestRig::kNumJoints);
+  SamplingJob expected_job;
+  expected_job.animation = animation.get();
+  expected_job.context = &expected_context;
+  expected_job.ratio = .5f;
+  expected_job.output = expected;
+  ASSERT_TRUE(expected_job.Run());
+
+  for (int i = 0; i < TestRig::kNumSoaJoints; ++i) {
+    ExpectTransformNear(output[i], expected[i]);
+  }
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 1.f, 1.f, 1.f, 0.f, 1.f,
+                          2.f, 3.f, -2.f, -2.f, -2.f, -2.f);
+}
+
+TEST(Blending, FixedSizeJobs) {
+  const int kNumSoa = TestRig::kNumSoaJoints;
+  ozz::math::SoaTransform rest_pose[kNumSoa];
+  ozz::math::SoaTransform poses[4][kNumSoa];
+  BuildPose(0.f, rest_pose);
+  for (int i = 0; i < 4; ++i) {
+    BuildPose(1.f + i, poses[i]);
+  }
+
+  // Layers weights, the last configuration requires the rest pose.
+  const float weights[][4] = {{.5f, 1.f, -1.f, .7f},
+                              {0.f, 0.f, .5f, -.3f},
+                              {.02f, 0.f, 0.f, 0.f},
+                              {0.f, 0.f, 0.f, 0.f}};
+  for (size_t w = 0; w < OZZ_ARRAY_SIZE(weights); ++w) {
+    FixedBlendingJob<kNumSoa>::Layer layers[2];
+    FixedBlendingJob<kNumSoa>::Layer additive_layers[2];
+    BlendingJob::Layer expected_layers[2];
+    BlendingJob::Layer expected_additive_layers[2];
+    for (int l = 0; l < 2; ++l) {
+      layers[l].weight = weights[w][l];
+      layers[l].transform = poses[l];
+      additive_layers[l].weight = weights[w][2 + l];
+      additive_layers[l].transform = poses[2 + l];
+      expected_layers[l].weight = weights[w][l];
+      expected_layers[l].transform = poses[l];
+      expected_additive_layers[l].weight = weights[w][2 + l];
+      expected_additive_layers[l].transform = poses[2 + l];
+    }
+
+    ozz::math::SoaTransform output[kNumSoa];
+    FixedBlendingJob<kNumSoa> job;
+    job.layers = layers;
+    job.additive_layers = additive_layers;
+    job.rest_pose = rest_pose;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    ozz::math::SoaTransform expected[kNumSoa];
+    BlendingJob expected_job;
+    expected_job.layers = expected_layers;
+    expected_job.additive_layers = expected_additive_layers;
+    expected_job.rest_pose = rest_pose;
+    expected_job.output = expected;
+    ASSERT_TRUE(expected_job.Run());
+
+    for (int i = 0; i < kNumSoa; ++i) {
+      ExpectTransformNear(output[i], expected[i]);
+    }
+  }
+}
+
+TEST(BlendingValidity, FixedSizeJobs) {
+  const int kNumSoa = TestRig::kNumSoaJoints;
+  ozz::math::SoaTransform rest_pose[kNumSoa];
+  ozz::math::SoaTransform output[kNumSoa];
+  BuildPose(0.f, rest_pose);
+  FixedBlendingJob<kNumSoa>::Layer layers[1];
+  layers[0].weight = 1.f;
+  layers[0].transform = rest_pose;
+
+  FixedBlendingJob<kNumSoa> job;
+  EXPECT_FALSE(job.Validate());
+  job.rest_pose = rest_pose;
+  job.output = output;
+  EXPECT_TRUE(job.Validate());
+  job.layers = layers;
+  EXPECT_TRUE(job.Validate());
+
+  // Buffers too small.
+  layers[0].transform = ozz::span<const ozz::math::SoaTransform>(rest_pose, 1);
+  EXPECT_FALSE(job.Validate());
+  layers[0].transform = rest_pose;
+  job.output = ozz::span<ozz::math::SoaTransform>(output, 1);
+  EXPECT_FALSE(job.Validate());
+  EXPECT_FALSE(job.Run());
+  job.output = output;
+
+  // Invalid threshold.
+  job.threshold = 0.f;
+  EXPECT_FALSE(job.Validate());
+}
+
+TEST(LocalToModel, FixedSizeJobs) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+
+  ozz::math::SoaTransform input[TestRig::kNumSoaJoints];
+  BuildPose(1.f, input);
+  const ozz::math::Float4x4 root = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f));
+
+  ozz::math::Float4x4 output[TestRig::kNumJoints];
+  FixedLocalToModelJob<TestRig::kNumSoaJoints> job;
+  EXPECT_FALSE(job.Validate());
+  job.skeleton = skeleton.get();
+  job.input = input;
+  job.output = output;
+  job.root = &root;
+  EXPECT_TRUE(job.Validate());
+
+  // Buffers too small.
+  job.output = ozz::span<ozz::math::Float4x4>(output, TestRig::kNumJoints - 1);
+  EXPECT_FALSE(job.Validate());
+  job.output = output;
+
+  // Skeleton size mismatch.
+  FixedLocalToModelJob<1> mismatch_job;
+  mismatch_job.skeleton = skeleton.get();
+  mismatch_job.input = input;
+  mismatch_job.output = output;
+  EXPECT_FALSE(mismatch_job.Validate());
+  EXPECT_FALSE(mismatch_job.Run());
+
+  ASSERT_TRUE(job.Run());
+
+  ozz::math::Float4x4 expected[TestRig::kNumJoints];
+  LocalToModelJob expected_job;
+  expected_job.skeleton = skeleton.get();
+  expected_job.input = input;
+  expected_job.output = expected;
+  expected_job.root = &root;
+  ASSERT_TRUE(expected_job.Run());
+
+  for (int i = 0; i < TestRig::kNumJoints; ++i) {
+    for (int c = 0; c < 4; ++c) {
+      ExpectSimdFloatNear(output[i].cols[c], expected[i].cols[c]);
+    }
+  }
+}
@@ -0,0 +1,237 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/frame_budget_governor.h"
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/runtime/update_rate_scheduler.h"
+#include "ozz/base/profile.h"
+
+using ozz::animation::FrameBudgetGovernor;
+
+namespace {
+// Simulates the cost of a frame, given the cost of an instance at full
+// quality.
+float SimulateCost(const FrameBudgetGovernor& _governor, float _unit_cost) {
+  float cost = 0.f;
+  for (int i = 0; i < _governor.num_instances(); ++i) {
+    if (_governor.importance(i) > 0.f) {
+      cost += _governor.level(i).cost * _unit_cost;
+    }
+  }
+  return cost;
+}
+}  // namespace
+
+TEST(Validity, FrameBudgetGovernor) {
+  FrameBudgetGovernor governor;
+  EXPECT_EQ(governor.num_instances(), 0);
+  EXPECT_FALSE(governor.Update(1e-3f));
+  EXPECT_FALSE(governor.Update());
+  EXPECT_FALSE(governor.set_importance(0, 1.f));
+  EXPECT_EQ(governor.importance(0), 0.f);
+
+  FrameBudgetGovernor::Settings settings;
+  EXPECT_FALSE(governor.Allocate(0, settings));
+  {
+    FrameBudgetGovernor::Settings invalid;
+    invalid.budget = 0.f;
+    EXPECT_FALSE(governor.Allocate(1, invalid));
+  }
+  {
+    FrameBudgetGovernor::Settings invalid;
+    invalid.max_period = 0;
+    EXPECT_FALSE(governor.Allocate(1, invalid));
+  }
+  {  // Increasing costs.
+    const float costs[] = {.5f, 1.f};
+    FrameBudgetGovernor::Settings invalid;
+    invalid.skeleton_costs = costs;
+    EXPECT_FALSE(governor.Allocate(1, invalid));
+  }
+  {  // Null cost.
+    const float costs[] = {1.f, 0.f};
+    FrameBudgetGovernor::Settings invalid;
+    invalid.animation_costs = costs;
+    EXPECT_FALSE(governor.Allocate(1, invalid));
+  }
+  EXPECT_EQ(governor.num_instances(), 0);
+
+  // Default settings, a single skeleton level and animation tier.
+  ASSERT_TRUE(governor.Allocate(2, settings));
+  EXPECT_EQ(governor.num_instances(), 2);
+  EXPECT_EQ(governor.importance(1), 1.f);
+  EXPECT_TRUE(governor.set_importance(1, 2.f));
+  EXPECT_FALSE(governor.set_importance(2, 2.f));
+  EXPECT_EQ(governor.importance(1), 2.f);
+  EXPECT_FALSE(governor.Update(-1.f));
+  EXPECT_TRUE(governor.Update(0.f));
+  EXPECT_EQ(governor.level(0).period, 1);
+
+  // Periods only.
+  ASSERT_EQ(governor.levels().size(), 4u);
+  EXPECT_EQ(governor.levels()[3].period, 8);
+  EXPECT_FLOAT_EQ(governor.levels()[3].cost, .125f);
+
+  // Max period is clamped.
+  settings.max_period = 1000;
+  ASSERT_TRUE(governor.Allocate(1, settings));
+  EXPECT_EQ(governor.settings().max_period,
+            ozz::animation::UpdateRateScheduler::kMaxPeriod);
+
+  governor.Deallocate();
+  EXPECT_EQ(governor.num_instances(), 0);
+}
+
+TEST(Ladder, FrameBudgetGovernor) {
+  const float skeleton_costs[] = {1.f, .5f};
+  const float animation_costs[] = {1.f, .6f};
+  FrameBudgetGovernor::Settings settings;
+  settings.max_period = 4;
+  settings.skeleton_costs = skeleton_costs;
+  settings.animation_costs = animation_costs;
+
+  FrameBudgetGovernor governor;
+  ASSERT_TRUE(governor.Allocate(1, settings));
+
+  // Each step is the move that saves the most.
+  const FrameBudgetGovernor::Level expected[] = {{1, 0, 0, 1.f},
+                                                 {1, 1, 0, .5f},
+                                                 {2, 1, 0, .25f},
+                                                 {4, 1, 0, .125f},
+                                                 {4, 1, 1, .075f}};
+  const int num_levels = sizeof(expected) / sizeof(expected[0]);
+  ASSERT_EQ(governor.levels().size(), static_cast<size_t>(num_levels));
+  for (int i = 0; i < num_levels; ++i) {
+    const FrameBudgetGovernor::Level& level = governor.levels()[i];
+    EXPECT_EQ(level.period, expected[i].period) << i;
+    EXPECT_EQ(level.skeleton_level, expected[i].skeleton_level) << i;
+    EXPECT_EQ(level.animation_tier, expected[i].animation_tier) << i;
+    EXPECT_FLOAT_EQ(level.cost, expected[i].cost) << i;
+  }
+}
+
+TEST(Control, FrameBudgetGovernor) {
+  const float skeleton_costs[] = {1.f, .5f};
+  const float animation_costs[] = {1.f, .6f};
+  FrameBudgetGovernor::Settings settings;
+  settings.budget = 2e-3f;
+  settings.max_period = 4;
+  settings.skeleton_costs = skeleton_costs;
+  settings.animation_costs = animation_costs;
+
+  FrameBudgetGovernor governor;
+  ASSERT_TRUE(governor.Allocate(10, settings));
+  for (int i = 0; i < governor.num_instances(); ++i) {
+    EXPECT_TRUE(governor.set_importance(i, 1.f + i));
+  }
+
+  // Full quality costs twice the budget.
+  const float unit_cost = .4e-3f;
+  ASSERT_TRUE(governor.Update(SimulateCost(governor, unit_cost)));
+  EXPECT_FLOAT_EQ(governor.cost(), 4e-3f);
+
+  // Least important instances are fully degraded first.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(governor.level(i).period, 4) << i;
+    EXPECT_EQ(governor.level(i).animation_tier, 1) << i;
+  }
+  EXPECT_EQ(governor.level(5).period, 2);
+  EXPECT_EQ(governor.level(5).skeleton_level, 1);
+  for (int i = 6; i < 10; ++i) {
+    EXPECT_EQ(governor.level(i).period, 1) << i;
+    EXPECT_EQ(governor.level(i).skeleton_level, 0) << i;
+  }
+  EXPECT_NEAR(governor.estimated_cost(), 1.85e-3f, 1e-6f);
+
+  // Cost is now within the tolerance band, levels are kept.
+  const float cost = SimulateCost(governor, unit_cost);
+  EXPECT_LE(cost, settings.budget);
+  EXPECT_GE(cost, settings.budget * (1.f - settings.tolerance));
+  ASSERT_TRUE(governor.Update(cost));
+  EXPECT_EQ(governor.level(5).period, 2);
+
+  // Disabling an instance frees budget for more important ones.
+  EXPECT_TRUE(governor.set_importance(9, 0.f));
+  ASSERT_TRUE(governor.Update(SimulateCost(governor, unit_cost)));
+  EXPECT_EQ(governor.level(9).period, 4);
+  EXPECT_EQ(governor.level(9).animation_tier, 1);
+  EXPECT_EQ(governor.level(5).period, 1);
+
+  // Instances get cheaper, all fit the budget after a few frames.
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_TRUE(governor.Update(SimulateCost(governor, unit_cost * .1f)));
+  }
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_EQ(governor.level(i).period, 1) << i;
+    EXPECT_EQ(governor.level(i).skeleton_level, 0) << i;
+    EXPECT_EQ(governor.level(i).animation_tier, 0) << i;
+  }
+
+  // Instances get much more expensive, cost converges below the budget.
+  for (int i = 0; i < 20; ++i) {
+    ASSERT_TRUE(governor.Update(SimulateCost(governor, unit_cost * 2.f)));
+  }
+  EXPECT_LE(SimulateCost(governor, unit_cost * 2.f), settings.budget);
+  EXPECT_EQ(governor.level(8).period, 1);
+}
+
+TEST(Hooks, FrameBudgetGovernor) {
+  FrameBudgetGovernor governor;
+  ASSERT_TRUE(governor.Allocate(1, FrameBudgetGovernor::Settings()));
+
+  static const ozz::profile::ZoneDesc outer = {"Outer", "", "", 0};
+  static const ozz::profile::ZoneDesc inner = {"Inner", "", "", 0};
+  const ozz::profile::Hooks previous =
+      ozz::profile::SetHooks(governor.hooks());
+  for (int i = 0; i < 2; ++i) {
+    ozz::profile::ZoneBegin(outer);
+    ozz::profile::ZoneBegin(inner);
+    const auto begin = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - begin <
+           std::chrono::milliseconds(1)) {
+    }
+    ozz::profile::ZoneEnd(inner);
+    ozz::profile::ZoneEnd(outer);
+  }
+  ozz::profile::SetHooks(previous);
+
+  // Only outermost zones are measured.
+  ASSERT_TRUE(governor.Update());
+  ASSERT_EQ(governor.stages().size(), 1u);
+  EXPECT_STREQ(governor.stages()[0].name, "Outer");
+  EXPECT_GE(governor.stages()[0].cost, 2e-3f);
+  EXPECT_FLOAT_EQ(governor.cost(), governor.stages()[0].cost);
+
+  // Measures are reset by Update.
+  ASSERT_TRUE(governor.Update());
+  ASSERT_EQ(governor.stages().size(), 1u);
+  EXPECT_EQ(governor.stages()[0].cost, 0.f);
+  EXPECT_EQ(governor.cost(), 0.f);
+}
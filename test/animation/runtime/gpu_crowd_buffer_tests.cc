@@ -0,0 +1,568 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/gpu_crowd_buffer.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#ifdef OZZ_GPU_CROWD_BUFFER_DISPATCH
+// Don't allow gl.h to automatically include glext.h
+#define GL_GLEXT_LEGACY
+// Including glfw includes gl.h
+#include "GL/glfw.h"
+// Compute shaders entry points.
+#include "GL/glext.h"
+#endif  // OZZ_GPU_CROWD_BUFFER_DISPATCH
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::BlendingJob;
+using ozz::animation::GpuCrowdBuffer;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 5 joints skeleton, with 2 branches.
+ozz::unique_ptr<Skeleton> BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(2);
+  root.children[0].name = "a0";
+  root.children[0].children.resize(1);
+  root.children[0].children[0].name = "a1";
+  root.children[1].name = "b0";
+  root.children[1].children.resize(1);
+  root.children[1].children[0].name = "b1";
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+// Builds a raw animation of _num_tracks tracks, with a different number of
+// keys per track.
+RawAnimation BuildRawAnimation(int _num_tracks, float _seed) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i) + _seed;
+    const int num_keys = 1 + i * 3;
+    for (int k = 0; k < num_keys; ++k) {
+      const float fk = static_cast<float>(k);
+      const float time = raw_animation.duration * (fk + .5f) / num_keys;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi * .1f + fk * .2f, .5f - fk * .1f, fi)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Normalize(ozz::math::Float3(1.f, fi, fk)),
+                    .4f * (fi + fk))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f + fk * .1f, 1.f, 1.f - fi * .05f)};
+      track.scales.push_back(skey);
+    }
+  }
+  return raw_animation;
+}
+
+void ExpectMatrixNear(const ozz::math::Float4x4& _expected,
+                      const ozz::math::Float4x4& _actual) {
+  float expected[16], actual[16];
+  for (int c = 0; c < 4; ++c) {
+    ozz::math::StorePtrU(_expected.cols[c], expected + c * 4);
+    ozz::math::StorePtrU(_actual.cols[c], actual + c * 4);
+  }
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_NEAR(expected[i], actual[i], 2e-3f);
+  }
+}
+}  // namespace
+
+TEST(Build, GpuCrowdBuffer) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+
+  AnimationBuilder builder;
+  const RawAnimation raw_animation = BuildRawAnimation(num_joints, 0.f);
+  ozz::unique_ptr<Animation> sequential = builder(raw_animation);
+  builder.random_access = true;
+  ozz::unique_ptr<Animation> animation = builder(raw_animation);
+  ozz::unique_ptr<Animation> mismatching =
+      builder(BuildRawAnimation(num_joints - 1, 0.f));
+  builder.cubic_interpolation = true;
+  ozz::unique_ptr<Animation> cubic = builder(raw_animation);
+  ASSERT_TRUE(sequential && animation && mismatching && cubic);
+
+  GpuCrowdBuffer buffer;
+  EXPECT_TRUE(buffer.buffer().empty());
+  EXPECT_EQ(buffer.num_joints(), 0);
+  EXPECT_EQ(buffer.num_animations(), 0);
+
+  const Animation* null = nullptr;
+  EXPECT_FALSE(buffer.Build(*skeleton, {&null, 1}, {}));
+  const Animation* sequential_ptr = sequential.get();
+  EXPECT_FALSE(buffer.Build(*skeleton, {&sequential_ptr, 1}, {}));
+  const Animation* mismatching_ptr = mismatching.get();
+  EXPECT_FALSE(buffer.Build(*skeleton, {&mismatching_ptr, 1}, {}));
+  const Animation* cubic_ptr = cubic.get();
+  EXPECT_FALSE(buffer.Build(*skeleton, {&cubic_ptr, 1}, {}));
+  EXPECT_TRUE(buffer.buffer().empty());
+
+  // Invalid inverse bind poses count.
+  const Animation* animation_ptr = animation.get();
+  ozz::math::Float4x4 inverse_bind_poses[2] = {
+      ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity()};
+  EXPECT_FALSE(buffer.Build(*skeleton, {&animation_ptr, 1},
+                            inverse_bind_poses));
+
+  // No animation.
+  EXPECT_TRUE(buffer.Build(*skeleton, {}, {}));
+  EXPECT_EQ(buffer.num_joints(), num_joints);
+  EXPECT_EQ(buffer.num_animations(), 0);
+
+  ASSERT_TRUE(buffer.Build(*skeleton, {&animation_ptr, 1}, {}));
+  EXPECT_EQ(buffer.num_joints(), num_joints);
+  EXPECT_EQ(buffer.num_animations(), 1);
+  const ozz::span<const uint32_t> words = buffer.buffer();
+  ASSERT_GE(words.size(), static_cast<size_t>(GpuCrowdBuffer::kHeaderSize));
+  EXPECT_EQ(words[GpuCrowdBuffer::kHeaderNumJoints],
+            static_cast<uint32_t>(num_joints));
+  for (int i = 0; i < num_joints; ++i) {
+    EXPECT_EQ(static_cast<int32_t>(words[words[GpuCrowdBuffer::kHeaderParents] +
+                                         i]),
+              skeleton->joint_parents()[i]);
+  }
+
+  // Keys indices are copied as is.
+  const uint32_t* desc =
+      words.begin() + words[GpuCrowdBuffer::kHeaderAnimations];
+  EXPECT_EQ(desc[GpuCrowdBuffer::kDescFormats], 0u);
+  const ozz::span<const int> index = animation->rotation_track_index();
+  const uint32_t* words_index =
+      words.begin() + desc[GpuCrowdBuffer::kDescRotationIndex];
+  EXPECT_EQ(std::memcmp(words_index, index.data(), index.size_bytes()), 0);
+}
+
+TEST(Evaluate, GpuCrowdBuffer) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+
+  // Builds animations using every keys format.
+  AnimationBuilder builder;
+  builder.random_access = true;
+  const AnimationBuilder::RotationFormat formats[] = {
+      AnimationBuilder::kRotationDefault, AnimationBuilder::kRotationCompact48,
+      AnimationBuilder::kRotationCompact32};
+  ozz::unique_ptr<Animation> animations[OZZ_ARRAY_SIZE(formats)];
+  const Animation* animation_ptrs[OZZ_ARRAY_SIZE(formats)];
+  for (size_t f = 0; f < OZZ_ARRAY_SIZE(formats); ++f) {
+    builder.rotation_format = formats[f];
+    builder.compact_ratios = f != 0;
+    animations[f] =
+        builder(BuildRawAnimation(num_joints, static_cast<float>(f)));
+    ASSERT_TRUE(animations[f]);
+    animation_ptrs[f] = animations[f].get();
+  }
+
+  // Skinning matrices use inverse bind poses.
+  ozz::vector<ozz::math::Float4x4> inverse_bind_poses(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    inverse_bind_poses[i] = ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(-.1f * i, .2f, .3f * i, 1.f));
+  }
+
+  GpuCrowdBuffer buffer;
+  ASSERT_TRUE(
+      buffer.Build(*skeleton, animation_ptrs, make_span(inverse_bind_poses)));
+  EXPECT_EQ(buffer.num_animations(), 3);
+  const uint32_t* descs =
+      buffer.buffer().begin() +
+      buffer.buffer()[GpuCrowdBuffer::kHeaderAnimations];
+  EXPECT_EQ(descs[GpuCrowdBuffer::kDescFormats], 0u);
+  EXPECT_EQ(descs[GpuCrowdBuffer::kDescSize + GpuCrowdBuffer::kDescFormats],
+            static_cast<uint32_t>(GpuCrowdBuffer::kCompactFloat3Key |
+                                  GpuCrowdBuffer::kCompactQuaternionKey << 2 |
+                                  GpuCrowdBuffer::kCompactFloat3Key << 4));
+  EXPECT_EQ(
+      descs[GpuCrowdBuffer::kDescSize * 2 + GpuCrowdBuffer::kDescFormats],
+      static_cast<uint32_t>(GpuCrowdBuffer::kCompactFloat3Key |
+                            GpuCrowdBuffer::kPackedQuaternionKey << 2 |
+                            GpuCrowdBuffer::kCompactFloat3Key << 4));
+
+  // Instances, including out of range and key ratios.
+  const float ratios[] = {0.f, .7f, .125f, 1.f, -1.f, .5f, .25f, 2.f, .99f};
+  GpuCrowdBuffer::Instance instances[OZZ_ARRAY_SIZE(ratios)];
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+    const GpuCrowdBuffer::Instance instance = {static_cast<uint32_t>(i % 3),
+                                               ratios[i]};
+    instances[i] = instance;
+  }
+
+  ozz::vector<ozz::math::Float4x4> palettes(OZZ_ARRAY_SIZE(instances) *
+                                            num_joints);
+
+  // Invalid evaluations.
+  EXPECT_FALSE(GpuCrowdBuffer().Evaluate(instances, make_span(palettes)));
+  EXPECT_FALSE(buffer.Evaluate(instances,
+                               make_span(palettes).first(palettes.size() - 1)));
+  GpuCrowdBuffer::Instance invalid = {3, 0.f};
+  EXPECT_FALSE(buffer.Evaluate({&invalid, 1}, make_span(palettes)));
+  GpuCrowdBuffer::Instance invalid_blend = {0, 0.f, 3, 0.f, .5f};
+  EXPECT_FALSE(buffer.Evaluate({&invalid_blend, 1}, make_span(palettes)));
+
+  // Blend animation index is ignored when not blended.
+  GpuCrowdBuffer::Instance unblended = {0, 0.f, 3, 0.f, 0.f};
+  EXPECT_TRUE(buffer.Evaluate({&unblended, 1}, make_span(palettes)));
+
+  ASSERT_TRUE(buffer.Evaluate(instances, make_span(palettes)));
+
+  // Compares with SamplingJob and LocalToModelJob.
+  SamplingJob::Context context(num_joints);
+  ozz::vector<ozz::math::SoaTransform> locals(skeleton->num_soa_joints());
+  ozz::vector<ozz::math::Float4x4> models(num_joints);
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(instances); ++i) {
+    SamplingJob sampling_job;
+    sampling_job.animation = animation_ptrs[instances[i].animation];
+    sampling_job.context = &context;
+    sampling_job.ratio = instances[i].ratio;
+    sampling_job.output = make_span(locals);
+    ASSERT_TRUE(sampling_job.Run());
+
+    LocalToModelJob ltm_job;
+    ltm_job.skeleton = skeleton.get();
+    ltm_job.input = make_span(locals);
+    ltm_job.output = make_span(models);
+    ASSERT_TRUE(ltm_job.Run());
+
+    for (int j = 0; j < num_joints; ++j) {
+      ExpectMatrixNear(models[j] * inverse_bind_poses[j],
+                       palettes[i * num_joints + j]);
+    }
+  }
+}
+
+TEST(Blend, GpuCrowdBuffer) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+
+  AnimationBuilder builder;
+  builder.random_access = true;
+  ozz::unique_ptr<Animation> animations[2] = {
+      builder(BuildRawAnimation(num_joints, 0.f)),
+      builder(BuildRawAnimation(num_joints, 3.f))};
+  ASSERT_TRUE(animations[0] && animations[1]);
+  const Animation* animation_ptrs[2] = {animations[0].get(),
+                                        animations[1].get()};
+
+  GpuCrowdBuffer buffer;
+  ASSERT_TRUE(buffer.Build(*skeleton, animation_ptrs, {}));
+
+  // Weights out of the unit interval are clamped.
+  const float weights[] = {0.f, .3f, .5f, .9f, 1.f, 2.f, -1.f};
+  GpuCrowdBuffer::Instance instances[OZZ_ARRAY_SIZE(weights)];
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(weights); ++i) {
+    const GpuCrowdBuffer::Instance instance = {
+        static_cast<uint32_t>(i % 2), .1f * i, static_cast<uint32_t>(1 - i % 2),
+        .9f - .1f * i, weights[i]};
+    instances[i] = instance;
+  }
+  ozz::vector<ozz::math::Float4x4> palettes(OZZ_ARRAY_SIZE(instances) *
+                                            num_joints);
+  ASSERT_TRUE(buffer.Evaluate(instances, make_span(palettes)));
+
+  // Compares with SamplingJob, BlendingJob and LocalToModelJob.
+  SamplingJob::Context context(num_joints);
+  ozz::vector<ozz::math::SoaTransform> locals[2];
+  ozz::vector<ozz::math::SoaTransform> blended(skeleton->num_soa_joints());
+  ozz::vector<ozz::math::Float4x4> models(num_joints);
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(instances); ++i) {
+    const uint32_t indices[2] = {instances[i].animation,
+                                 instances[i].blend_animation};
+    const float ratios[2] = {instances[i].ratio, instances[i].blend_ratio};
+    const float weight = ozz::math::Clamp(0.f, instances[i].blend_weight, 1.f);
+    BlendingJob::Layer layers[2];
+    for (int l = 0; l < 2; ++l) {
+      locals[l].resize(skeleton->num_soa_joints());
+      SamplingJob sampling_job;
+      sampling_job.animation = animation_ptrs[indices[l]];
+      sampling_job.context = &context;
+      sampling_job.ratio = ratios[l];
+      sampling_job.output = make_span(locals[l]);
+      ASSERT_TRUE(sampling_job.Run());
+      layers[l].transform = make_span(locals[l]);
+    }
+    layers[0].weight = 1.f - weight;
+    layers[1].weight = weight;
+
+    BlendingJob blending_job;
+    blending_job.layers = layers;
+    blending_job.rest_pose = skeleton->joint_rest_poses();
+    blending_job.output = make_span(blended);
+    ASSERT_TRUE(blending_job.Run());
+
+    LocalToModelJob ltm_job;
+    ltm_job.skeleton = skeleton.get();
+    ltm_job.input = make_span(blended);
+    ltm_job.output = make_span(models);
+    ASSERT_TRUE(ltm_job.Run());
+
+    for (int j = 0; j < num_joints; ++j) {
+      ExpectMatrixNear(models[j], palettes[i * num_joints + j]);
+    }
+  }
+}
+
+TEST(ComputeShader, GpuCrowdBuffer) {
+  // Compute kernel source is provided for upload.
+  const char* source = GpuCrowdBuffer::compute_shader();
+  ASSERT_TRUE(source != nullptr);
+  EXPECT_EQ(std::strncmp(source, "#version 430", 12), 0);
+  EXPECT_TRUE(std::strstr(source, "void main()") != nullptr);
+
+  // Writes the kernel, to be compiled by the glslangValidator test when
+  // available.
+  std::ofstream file("gpu_crowd_buffer.comp");
+  file << source;
+  EXPECT_TRUE(file.good());
+}
+
+#ifdef OZZ_GPU_CROWD_BUFFER_DISPATCH
+namespace {
+// OpenGL 4.3 compute entry points, loaded once a context is opened.
+struct GlCompute {
+  PFNGLCREATESHADERPROC CreateShader;
+  PFNGLSHADERSOURCEPROC ShaderSource;
+  PFNGLCOMPILESHADERPROC CompileShader;
+  PFNGLGETSHADERIVPROC GetShaderiv;
+  PFNGLGETSHADERINFOLOGPROC GetShaderInfoLog;
+  PFNGLDELETESHADERPROC DeleteShader;
+  PFNGLCREATEPROGRAMPROC CreateProgram;
+  PFNGLATTACHSHADERPROC AttachShader;
+  PFNGLLINKPROGRAMPROC LinkProgram;
+  PFNGLGETPROGRAMIVPROC GetProgramiv;
+  PFNGLUSEPROGRAMPROC UseProgram;
+  PFNGLDELETEPROGRAMPROC DeleteProgram;
+  PFNGLGETUNIFORMLOCATIONPROC GetUniformLocation;
+  PFNGLUNIFORM1UIPROC Uniform1ui;
+  PFNGLGENBUFFERSPROC GenBuffers;
+  PFNGLBINDBUFFERPROC BindBuffer;
+  PFNGLBUFFERDATAPROC BufferData;
+  PFNGLBINDBUFFERBASEPROC BindBufferBase;
+  PFNGLGETBUFFERSUBDATAPROC GetBufferSubData;
+  PFNGLDELETEBUFFERSPROC DeleteBuffers;
+  PFNGLDISPATCHCOMPUTEPROC DispatchCompute;
+  PFNGLMEMORYBARRIERPROC MemoryBarrier;
+};
+
+template <typename _Proc>
+bool LoadGlProc(const char* _name, _Proc* _proc) {
+  *_proc = reinterpret_cast<_Proc>(glfwGetProcAddress(_name));
+  return *_proc != nullptr;
+}
+
+// Opens an OpenGL 4.3 context, and loads compute entry points. Returns false
+// if there's no display or if the driver doesn't support compute shaders.
+bool OpenGlCompute(GlCompute* _gl) {
+  if (!glfwInit()) {
+    return false;
+  }
+  glfwOpenWindowHint(GLFW_OPENGL_VERSION_MAJOR, 4);
+  glfwOpenWindowHint(GLFW_OPENGL_VERSION_MINOR, 3);
+  glfwOpenWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+  if (!glfwOpenWindow(16, 16, 8, 8, 8, 8, 0, 0, GLFW_WINDOW)) {
+    glfwTerminate();
+    return false;
+  }
+  const bool loaded =
+      LoadGlProc("glCreateShader", &_gl->CreateShader) &&
+      LoadGlProc("glShaderSource", &_gl->ShaderSource) &&
+      LoadGlProc("glCompileShader", &_gl->CompileShader) &&
+      LoadGlProc("glGetShaderiv", &_gl->GetShaderiv) &&
+      LoadGlProc("glGetShaderInfoLog", &_gl->GetShaderInfoLog) &&
+      LoadGlProc("glDeleteShader", &_gl->DeleteShader) &&
+      LoadGlProc("glCreateProgram", &_gl->CreateProgram) &&
+      LoadGlProc("glAttachShader", &_gl->AttachShader) &&
+      LoadGlProc("glLinkProgram", &_gl->LinkProgram) &&
+      LoadGlProc("glGetProgramiv", &_gl->GetProgramiv) &&
+      LoadGlProc("glUseProgram", &_gl->UseProgram) &&
+      LoadGlProc("glDeleteProgram", &_gl->DeleteProgram) &&
+      LoadGlProc("glGetUniformLocation", &_gl->GetUniformLocation) &&
+      LoadGlProc("glUniform1ui", &_gl->Uniform1ui) &&
+      LoadGlProc("glGenBuffers", &_gl->GenBuffers) &&
+      LoadGlProc("glBindBuffer", &_gl->BindBuffer) &&
+      LoadGlProc("glBufferData", &_gl->BufferData) &&
+      LoadGlProc("glBindBufferBase", &_gl->BindBufferBase) &&
+      LoadGlProc("glGetBufferSubData", &_gl->GetBufferSubData) &&
+      LoadGlProc("glDeleteBuffers", &_gl->DeleteBuffers) &&
+      LoadGlProc("glDispatchCompute", &_gl->DispatchCompute) &&
+      LoadGlProc("glMemoryBarrier", &_gl->MemoryBarrier);
+  if (!loaded) {
+    glfwTerminate();
+  }
+  return loaded;
+}
+}  // namespace
+
+TEST(Dispatch, GpuCrowdBuffer) {
+  GlCompute gl;
+  if (!OpenGlCompute(&gl)) {
+    // Reported as skipped by ctest, see SKIP_REGULAR_EXPRESSION.
+    std::cout << "No OpenGL 4.3 compute context available, test skipped."
+              << std::endl;
+    return;
+  }
+
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+
+  // Animations use different keys formats.
+  AnimationBuilder builder;
+  builder.random_access = true;
+  ozz::unique_ptr<Animation> animations[2];
+  const Animation* animation_ptrs[2];
+  for (int i = 0; i < 2; ++i) {
+    builder.rotation_format = i ? AnimationBuilder::kRotationCompact32
+                                : AnimationBuilder::kRotationDefault;
+    builder.compact_ratios = i != 0;
+    animations[i] = builder(BuildRawAnimation(num_joints, 2.f * i));
+    ASSERT_TRUE(animations[i]);
+    animation_ptrs[i] = animations[i].get();
+  }
+  ozz::vector<ozz::math::Float4x4> inverse_bind_poses(num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    inverse_bind_poses[i] = ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load(.2f * i, -.1f, .1f * i, 1.f));
+  }
+  GpuCrowdBuffer buffer;
+  ASSERT_TRUE(
+      buffer.Build(*skeleton, animation_ptrs, make_span(inverse_bind_poses)));
+
+  // More instances than a work group, blended or not.
+  const size_t kNumInstances = 100;
+  ozz::vector<GpuCrowdBuffer::Instance> instances(kNumInstances);
+  for (size_t i = 0; i < kNumInstances; ++i) {
+    const float fi = static_cast<float>(i);
+    const GpuCrowdBuffer::Instance instance = {
+        static_cast<uint32_t>(i % 2), fi / kNumInstances,
+        static_cast<uint32_t>(1 - i % 2), 1.f - fi / kNumInstances,
+        (i % 3) * .4f};
+    instances[i] = instance;
+  }
+  ozz::vector<ozz::math::Float4x4> expected(kNumInstances * num_joints);
+  ASSERT_TRUE(buffer.Evaluate(make_span(instances), make_span(expected)));
+
+  // Compiles the kernel.
+  const char* source = GpuCrowdBuffer::compute_shader();
+  const GLuint shader = gl.CreateShader(GL_COMPUTE_SHADER);
+  gl.ShaderSource(shader, 1, &source, nullptr);
+  gl.CompileShader(shader);
+  GLint compiled = GL_FALSE;
+  gl.GetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+  if (!compiled) {
+    char log[1024];
+    gl.GetShaderInfoLog(shader, sizeof(log), nullptr, log);
+    ADD_FAILURE() << log;
+  }
+  const GLuint program = gl.CreateProgram();
+  gl.AttachShader(program, shader);
+  gl.LinkProgram(program);
+  GLint linked = GL_FALSE;
+  gl.GetProgramiv(program, GL_LINK_STATUS, &linked);
+  EXPECT_TRUE(compiled && linked);
+
+  // Uploads buffers and dispatches an invocation per instance.
+  GLuint buffers[3];
+  gl.GenBuffers(3, buffers);
+  const ozz::span<const uint32_t> crowd = buffer.buffer();
+  const size_t palettes_size = sizeof(float) * 16 * expected.size();
+  const struct {
+    const void* data;
+    size_t size;
+  } datas[3] = {{crowd.data(), crowd.size_bytes()},
+                {instances.data(), sizeof(instances[0]) * kNumInstances},
+                {nullptr, palettes_size}};
+  for (GLuint i = 0; i < 3; ++i) {
+    gl.BindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[i]);
+    gl.BufferData(GL_SHADER_STORAGE_BUFFER,
+                  static_cast<GLsizeiptr>(datas[i].size), datas[i].data,
+                  GL_STATIC_DRAW);
+    gl.BindBufferBase(GL_SHADER_STORAGE_BUFFER, i, buffers[i]);
+  }
+  gl.UseProgram(program);
+  gl.Uniform1ui(gl.GetUniformLocation(program, "num_instances"),
+                static_cast<GLuint>(kNumInstances));
+  gl.DispatchCompute((kNumInstances + 63) / 64, 1, 1);
+  gl.MemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+
+  // Reads back palettes, column major matrices like Float4x4.
+  ozz::vector<float> palettes(16 * expected.size());
+  gl.BindBuffer(GL_SHADER_STORAGE_BUFFER, buffers[2]);
+  gl.GetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0,
+                      static_cast<GLsizeiptr>(palettes_size), palettes.data());
+  EXPECT_EQ(glGetError(), static_cast<GLenum>(GL_NO_ERROR));
+
+  for (size_t m = 0; m < expected.size(); ++m) {
+    ozz::math::Float4x4 palette;
+    for (int c = 0; c < 4; ++c) {
+      palette.cols[c] =
+          ozz::math::simd_float4::LoadPtrU(&palettes[m * 16 + c * 4]);
+    }
+    ExpectMatrixNear(expected[m], palette);
+  }
+
+  gl.DeleteBuffers(3, buffers);
+  gl.DeleteProgram(program);
+  gl.DeleteShader(shader);
+  glfwTerminate();
+}
+#endif  // OZZ_GPU_CROWD_BUFFER_DISPATCH
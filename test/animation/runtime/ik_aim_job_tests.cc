@@ -603,3 +603,144 @@ TEST(ZeroScale, IKAimJob) {
   EXPECT_TRUE(job.Run());
   EXPECT_SIMDQUATERNION_EQ_TOL(quat, 0.f, 0.f, 0.f, 1.f, 2e-3f);
 }
+
+TEST(Batch, IKAimJob) {
+  // Builds 9 instances of a 3 joints chain, ordered from child to parent. Last
+  // group of instances is incomplete. Instance 4 has a target too close to be
+  // reached, and instance 7 a zero scale joint.
+  const int kNumInstances = 9;
+  const int kChainLength = 3;
+  ozz::math::Float4x4 models[kNumInstances][kChainLength];
+  const ozz::math::Float4x4* joints[kNumInstances * kChainLength];
+  ozz::math::SimdFloat4 targets[kNumInstances];
+  ozz::math::SimdFloat4 poles[kNumInstances];
+  for (int n = 0; n < kNumInstances; ++n) {
+    const float fn = static_cast<float>(n);
+    const ozz::math::Float4x4 local = ozz::math::Float4x4::FromAffine(
+        ozz::math::simd_float4::Load(.5f, .1f * fn, 0.f, 0.f),
+        ozz::math::SimdQuaternion::FromAxisAngle(
+            ozz::math::simd_float4::z_axis(),
+            ozz::math::simd_float4::Load1(.1f * fn))
+            .xyzw,
+        ozz::math::simd_float4::one());
+    models[n][2] = ozz::math::Float4x4::FromAffine(
+        ozz::math::simd_float4::Load(fn, 0.f, -fn, 0.f),
+        ozz::math::SimdQuaternion::FromAxisAngle(
+            ozz::math::simd_float4::y_axis(),
+            ozz::math::simd_float4::Load1(.3f * fn))
+            .xyzw,
+        ozz::math::simd_float4::Load1(n == 7 ? 0.f : 1.f));
+    models[n][1] = models[n][2] * local;
+    models[n][0] = models[n][1] * local;
+    for (int i = 0; i < kChainLength; ++i) {
+      joints[n * kChainLength + i] = &models[n][i];
+    }
+    targets[n] = n == 4 ? models[n][0].cols[3]
+                        : ozz::math::simd_float4::Load(fn - 2.f, 3.f, 1.f - fn,
+                                                       0.f);
+    poles[n] = ozz::math::Normalize3(
+        ozz::math::simd_float4::Load(.1f * fn, 1.f, 0.f, 0.f));
+  }
+  const ozz::math::SimdFloat4 ups[kChainLength] = {
+      ozz::math::simd_float4::y_axis(), ozz::math::simd_float4::x_axis(),
+      ozz::math::simd_float4::y_axis()};
+  const float weights[kChainLength] = {.5f, .8f, 1.f};
+  const ozz::math::SimdFloat4 forward = ozz::math::simd_float4::x_axis();
+  const ozz::math::SimdFloat4 offset =
+      ozz::math::simd_float4::Load(.1f, .2f, 0.f, 0.f);
+
+  ozz::math::SimdQuaternion corrections[kNumInstances * kChainLength];
+  bool reached[kNumInstances * kChainLength];
+
+  {  // Validity.
+    ozz::animation::BatchIKAimJob job;
+    EXPECT_FALSE(job.Validate());  // No ups and weights.
+    job.ups = ups;
+    job.weights = weights;
+    EXPECT_TRUE(job.Validate());  // No instance.
+    job.targets = targets;
+    EXPECT_FALSE(job.Validate());
+    job.pole_vectors = poles;
+    job.joints = joints;
+    job.joint_corrections = corrections;
+    EXPECT_TRUE(job.Validate());
+    job.chain_length = kChainLength;
+    EXPECT_TRUE(job.Validate());
+    job.chain_length = kChainLength + 1;
+    EXPECT_FALSE(job.Validate());
+    job.chain_length = 0;
+    EXPECT_FALSE(job.Validate());
+    job.chain_length = kChainLength;
+    job.reached = ozz::make_span(reached).subspan(0, 2);
+    EXPECT_FALSE(job.Validate());
+    job.reached = reached;
+    job.forward = ozz::math::simd_float4::Load(1.f, 1.f, 0.f, 0.f);
+    EXPECT_FALSE(job.Run());
+  }
+
+  const float twists[] = {0.f, .5f};
+  for (const float twist : twists) {
+    ozz::animation::BatchIKAimJob job;
+    job.targets = targets;
+    job.pole_vectors = poles;
+    job.forward = forward;
+    job.offset = offset;
+    job.chain_length = kChainLength;
+    job.ups = ups;
+    job.weights = weights;
+    job.twist_angle = twist;
+    job.joints = joints;
+    job.joint_corrections = corrections;
+    job.reached = reached;
+    ASSERT_TRUE(job.Run());
+
+    // Compares with IKAimJob, run for each joint of the chain like look at
+    // sample does.
+    for (int n = 0; n < kNumInstances; ++n) {
+      ozz::math::SimdQuaternion correction;
+      bool expected_reached;
+      ozz::animation::IKAimJob single;
+      single.target = targets[n];
+      single.pole_vector = poles[n];
+      single.twist_angle = twist;
+      single.joint_correction = &correction;
+      single.reached = &expected_reached;
+      for (int i = 0; i < kChainLength; ++i) {
+        single.joint = &models[n][i];
+        single.up = ups[i];
+        single.weight = weights[i];
+        if (i == 0) {
+          single.forward = forward;
+          single.offset = offset;
+        } else {
+          const ozz::math::SimdFloat4 corrected_forward_ms =
+              TransformVector(models[n][i - 1],
+                              TransformVector(correction, single.forward));
+          const ozz::math::SimdFloat4 corrected_offset_ms =
+              TransformPoint(models[n][i - 1],
+                             TransformVector(correction, single.offset));
+          ozz::math::SimdInt4 invertible;
+          const ozz::math::Float4x4 inv_joint =
+              Invert(models[n][i], &invertible);
+          single.forward = TransformVector(inv_joint, corrected_forward_ms);
+          single.offset = TransformPoint(inv_joint, corrected_offset_ms);
+        }
+        if (n == 7) {
+          // Zero scale chain forward can't be validated.
+          single.forward = forward;
+        }
+        ASSERT_TRUE(single.Run());
+
+        const int j = n * kChainLength + i;
+        EXPECT_EQ(reached[j], expected_reached) << "instance " << n;
+        EXPECT_SIMDQUATERNION_EQ_TOL(corrections[j],
+                                     ozz::math::GetX(correction.xyzw),
+                                     ozz::math::GetY(correction.xyzw),
+                                     ozz::math::GetZ(correction.xyzw),
+                                     ozz::math::GetW(correction.xyzw), 2e-3f);
+      }
+    }
+    EXPECT_FALSE(reached[4 * kChainLength]);
+    EXPECT_TRUE(reached[3 * kChainLength]);
+  }
+}
@@ -0,0 +1,301 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include <algorithm>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/runtime/ik_chain_job.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::IKChainJob;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton made of a chain of 5 joints along x axis, 1 unit apart.
+// The last chain joint has a child (5), and the first one a sibling branch
+// (6).
+ozz::unique_ptr<Skeleton> BuildChain() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* joint = &raw_skeleton.roots[0];
+  joint->name = "j0";
+  joint->transform = ozz::math::Transform::identity();
+  for (int i = 1; i < 6; ++i) {
+    joint->children.resize(1);
+    joint = &joint->children[0];
+    const char name[] = {'j', static_cast<char>('0' + i), 0};
+    joint->name = name;
+    joint->transform = ozz::math::Transform::identity();
+    joint->transform.translation = ozz::math::Float3(1.f, 0.f, 0.f);
+  }
+  raw_skeleton.roots[0].children.resize(2);
+  RawSkeleton::Joint& sibling = raw_skeleton.roots[0].children[1];
+  sibling.name = "j6";
+  sibling.transform = ozz::math::Transform::identity();
+  sibling.transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+bool UpdateModels(const Skeleton& _skeleton,
+                  ozz::span<const ozz::math::SoaTransform> _locals,
+                  ozz::span<ozz::math::Float4x4> _models) {
+  LocalToModelJob job;
+  job.skeleton = &_skeleton;
+  job.input = _locals;
+  job.output = _models;
+  return job.Run();
+}
+}  // namespace
+
+TEST(JobValidity, IKChainJob) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildChain();
+  ASSERT_TRUE(skeleton);
+  ASSERT_EQ(skeleton->num_joints(), 7);
+
+  ozz::math::SoaTransform locals[2];
+  ozz::math::Float4x4 models[7];
+  const int chain[] = {0, 1, 2, 3, 4};
+  const int not_a_chain[] = {0, 6, 4};
+  const int reversed[] = {4, 2};
+  const int out_of_range[] = {0, 7};
+
+  {  // Default is invalid
+    IKChainJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid
+    IKChainJob job;
+    job.skeleton = skeleton.get();
+    job.joints = chain;
+    job.locals = locals;
+    job.models = models;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Invalid locals
+    IKChainJob job;
+    job.skeleton = skeleton.get();
+    job.joints = chain;
+    job.locals = {locals, 1};
+    job.models = models;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Invalid models
+    IKChainJob job;
+    job.skeleton = skeleton.get();
+    job.joints = chain;
+    job.locals = locals;
+    job.models = {models, 6};
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Invalid iterations
+    IKChainJob job;
+    job.skeleton = skeleton.get();
+    job.joints = chain;
+    job.locals = locals;
+    job.models = models;
+    job.iterations = 0;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Chain too short
+    IKChainJob job;
+    job.skeleton = skeleton.get();
+    job.joints = {chain, 1};
+    job.locals = locals;
+    job.models = models;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Joints aren't descendants
+    IKChainJob job;
+    job.skeleton = skeleton.get();
+    job.joints = not_a_chain;
+    job.locals = locals;
+    job.models = models;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Joints in reversed order
+    IKChainJob job;
+    job.skeleton = skeleton.get();
+    job.joints = reversed;
+    job.locals = locals;
+    job.models = models;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Joint out of range
+    IKChainJob job;
+    job.skeleton = skeleton.get();
+    job.joints = out_of_range;
+    job.locals = locals;
+    job.models = models;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+TEST(Reach, IKChainJob) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildChain();
+  ASSERT_TRUE(skeleton);
+
+  const ozz::span<const ozz::math::SoaTransform> rest =
+      skeleton->joint_rest_poses();
+  ozz::math::SoaTransform locals[2];
+  ozz::math::Float4x4 models[7];
+  ozz::math::Float4x4 expected[7];
+  const int chain[] = {0, 1, 2, 3, 4};
+
+  {  // Reachable target
+    std::copy(rest.begin(), rest.end(), locals);
+    ASSERT_TRUE(UpdateModels(*skeleton, locals, models));
+
+    IKChainJob job;
+    bool reached = false;
+    job.skeleton = skeleton.get();
+    job.joints = chain;
+    job.locals = locals;
+    job.models = models;
+    job.target = ozz::math::simd_float4::Load(1.f, 2.f, 1.f, 0.f);
+    job.iterations = 32;
+    job.reached = &reached;
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(reached);
+
+    EXPECT_LE(ozz::math::GetX(ozz::math::Length3(models[4].cols[3] -
+                                                 job.target)),
+              job.tolerance);
+
+    // Models must be up to date with corrected locals, including chain
+    // joints descendants.
+    ASSERT_TRUE(UpdateModels(*skeleton, locals, expected));
+    for (int i = 0; i < 7; ++i) {
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_SIMDFLOAT_EQ_EST(models[i].cols[c],
+                                ozz::math::GetX(expected[i].cols[c]),
+                                ozz::math::GetY(expected[i].cols[c]),
+                                ozz::math::GetZ(expected[i].cols[c]),
+                                ozz::math::GetW(expected[i].cols[c]));
+      }
+    }
+  }
+
+  {  // Already reached, nothing changes.
+    std::copy(rest.begin(), rest.end(), locals);
+    ASSERT_TRUE(UpdateModels(*skeleton, locals, models));
+
+    IKChainJob job;
+    bool reached = false;
+    job.skeleton = skeleton.get();
+    job.joints = chain;
+    job.locals = locals;
+    job.models = models;
+    job.target = ozz::math::simd_float4::Load(4.f, 0.f, 0.f, 0.f);
+    job.reached = &reached;
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(reached);
+    EXPECT_SIMDFLOAT_EQ(models[5].cols[3], 5.f, 0.f, 0.f, 1.f);
+  }
+
+  {  // Unreachable target, chain is stretched toward the target.
+    std::copy(rest.begin(), rest.end(), locals);
+    ASSERT_TRUE(UpdateModels(*skeleton, locals, models));
+
+    IKChainJob job;
+    bool reached = true;
+    job.skeleton = skeleton.get();
+    job.joints = chain;
+    job.locals = locals;
+    job.models = models;
+    job.target = ozz::math::simd_float4::Load(0.f, 10.f, 0.f, 0.f);
+    job.reached = &reached;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FALSE(reached);
+    // Chain end gets closer to the target than at rest pose.
+    EXPECT_LT(ozz::math::GetX(ozz::math::Length3(models[4].cols[3] -
+                                                 job.target)),
+              ozz::math::GetX(ozz::math::Length3(
+                  ozz::math::simd_float4::Load(4.f, 0.f, 0.f, 0.f) -
+                  job.target)));
+    EXPECT_GT(ozz::math::GetY(models[4].cols[3]), 3.f);
+  }
+
+  {  // Partial chain, joints in-between remain fixed.
+    std::copy(rest.begin(), rest.end(), locals);
+    ASSERT_TRUE(UpdateModels(*skeleton, locals, models));
+
+    const int partial[] = {1, 4};
+    IKChainJob job;
+    bool reached = false;
+    job.skeleton = skeleton.get();
+    job.joints = partial;
+    job.locals = locals;
+    job.models = models;
+    job.target = ozz::math::simd_float4::Load(1.f, 3.f, 0.f, 0.f);
+    job.reached = &reached;
+    ASSERT_TRUE(job.Run());
+    EXPECT_TRUE(reached);
+    EXPECT_SIMDFLOAT_EQ(models[0].cols[3], 0.f, 0.f, 0.f, 1.f);
+    EXPECT_SIMDFLOAT_EQ(models[1].cols[3], 1.f, 0.f, 0.f, 1.f);
+    EXPECT_SIMDFLOAT_EQ(models[6].cols[3], 0.f, 1.f, 0.f, 1.f);
+    EXPECT_SIMDFLOAT_EQ_EST(models[4].cols[3], 1.f, 3.f, 0.f, 1.f);
+  }
+
+  {  // Zero weight doesn't change anything.
+    std::copy(rest.begin(), rest.end(), locals);
+    ASSERT_TRUE(UpdateModels(*skeleton, locals, models));
+
+    IKChainJob job;
+    bool reached = true;
+    job.skeleton = skeleton.get();
+    job.joints = chain;
+    job.locals = locals;
+    job.models = models;
+    job.target = ozz::math::simd_float4::Load(1.f, 2.f, 1.f, 0.f);
+    job.weight = 0.f;
+    job.reached = &reached;
+    ASSERT_TRUE(job.Run());
+    EXPECT_FALSE(reached);
+    EXPECT_SIMDFLOAT_EQ(models[5].cols[3], 5.f, 0.f, 0.f, 1.f);
+  }
+}
@@ -974,3 +974,144 @@ TEST(ZeroLengthBoneChain, IKTwoBoneJob) {
 
   EXPECT_NOT_REACHED(job);
 }
+
+TEST(Batch, IKTwoBoneJob) {
+  // Builds chains of various orientations, lengths and scales, with targets
+  // reachable or not. Last chain has a zero scale start joint. 11 chains, so
+  // that the last group is incomplete.
+  const int kNumChains = 11;
+  ozz::math::Float4x4 starts[kNumChains];
+  ozz::math::Float4x4 mids[kNumChains];
+  ozz::math::Float4x4 ends[kNumChains];
+  ozz::math::SimdFloat4 targets[kNumChains];
+  ozz::math::SimdFloat4 poles[kNumChains];
+  const ozz::math::Float4x4* start_joints[kNumChains];
+  const ozz::math::Float4x4* mid_joints[kNumChains];
+  const ozz::math::Float4x4* end_joints[kNumChains];
+  for (int i = 0; i < kNumChains; ++i) {
+    const float fi = static_cast<float>(i);
+    starts[i] = ozz::math::Float4x4::FromAffine(
+        ozz::math::simd_float4::Load(fi, 1.f - fi, .5f * fi, 0.f),
+        ozz::math::SimdQuaternion::FromAxisAngle(
+            ozz::math::Normalize3(
+                ozz::math::simd_float4::Load(1.f, fi, -2.f, 0.f)),
+            ozz::math::simd_float4::Load1(.4f * fi))
+            .xyzw,
+        ozz::math::simd_float4::Load1(i == kNumChains - 1 ? 0.f
+                                                          : 1.f + .1f * fi));
+    mids[i] = starts[i] *
+              ozz::math::Float4x4::FromAffine(
+                  ozz::math::simd_float4::Load(1.f + .1f * fi, 0.f, 0.f, 0.f),
+                  ozz::math::SimdQuaternion::FromAxisAngle(
+                      ozz::math::simd_float4::z_axis(),
+                      ozz::math::simd_float4::Load1(.2f * fi - .5f))
+                      .xyzw,
+                  ozz::math::simd_float4::one());
+    ends[i] = mids[i] * ozz::math::Float4x4::Translation(
+                            ozz::math::simd_float4::Load(1.f, 0.f, 0.f, 0.f));
+    targets[i] = starts[i].cols[3] +
+                 ozz::math::simd_float4::Load(.3f * fi - 1.f, .5f,
+                                              .25f * fi - 1.f, 0.f);
+    poles[i] = ozz::math::Normalize3(
+        ozz::math::simd_float4::Load(-.1f * fi, 1.f, .2f * fi, 0.f));
+    start_joints[i] = &starts[i];
+    mid_joints[i] = &mids[i];
+    end_joints[i] = &ends[i];
+  }
+
+  ozz::math::SimdQuaternion start_corrections[kNumChains];
+  ozz::math::SimdQuaternion mid_corrections[kNumChains];
+  bool reached[kNumChains];
+
+  {  // Validity.
+    ozz::animation::BatchIKTwoBoneJob job;
+    EXPECT_TRUE(job.Validate());  // No chain.
+    job.start_joints = start_joints;
+    EXPECT_FALSE(job.Validate());
+    job.mid_joints = mid_joints;
+    job.end_joints = end_joints;
+    job.targets = targets;
+    job.pole_vectors = poles;
+    job.start_joint_corrections = start_corrections;
+    EXPECT_FALSE(job.Validate());
+    job.mid_joint_corrections = mid_corrections;
+    EXPECT_TRUE(job.Validate());
+    job.reached = ozz::make_span(reached).subspan(0, kNumChains - 1);
+    EXPECT_FALSE(job.Validate());
+    job.reached = reached;
+    EXPECT_TRUE(job.Validate());
+    job.mid_axis = ozz::math::simd_float4::Load(1.f, 1.f, 0.f, 0.f);
+    EXPECT_FALSE(job.Validate());
+    job.mid_axis = ozz::math::simd_float4::z_axis();
+    const ozz::math::Float4x4* invalid_joints[kNumChains];
+    for (int i = 0; i < kNumChains; ++i) {
+      invalid_joints[i] = &mids[i];
+    }
+    invalid_joints[5] = nullptr;
+    job.mid_joints = invalid_joints;
+    EXPECT_FALSE(job.Run());
+  }
+
+  const float weights[] = {1.f, .6f, 0.f};
+  const float softens[] = {1.f, .7f};
+  const float twists[] = {0.f, .7f};
+  for (const float weight : weights) {
+    for (const float soften : softens) {
+      for (const float twist : twists) {
+        ozz::animation::BatchIKTwoBoneJob job;
+        job.weight = weight;
+        job.soften = soften;
+        job.twist_angle = twist;
+        job.start_joints = start_joints;
+        job.mid_joints = mid_joints;
+        job.end_joints = end_joints;
+        job.targets = targets;
+        job.pole_vectors = poles;
+        job.start_joint_corrections = start_corrections;
+        job.mid_joint_corrections = mid_corrections;
+        job.reached = reached;
+        ASSERT_TRUE(job.Run());
+
+        // Compares with single chain job.
+        int num_reached = 0;
+        for (int i = 0; i < kNumChains; ++i) {
+          num_reached += reached[i];
+          ozz::math::SimdQuaternion start_correction;
+          ozz::math::SimdQuaternion mid_correction;
+          bool expected_reached;
+          ozz::animation::IKTwoBoneJob single;
+          single.weight = weight;
+          single.soften = soften;
+          single.twist_angle = twist;
+          single.start_joint = &starts[i];
+          single.mid_joint = &mids[i];
+          single.end_joint = &ends[i];
+          single.target = targets[i];
+          single.pole_vector = poles[i];
+          single.start_joint_correction = &start_correction;
+          single.mid_joint_correction = &mid_correction;
+          single.reached = &expected_reached;
+          ASSERT_TRUE(single.Run());
+
+          EXPECT_EQ(reached[i], expected_reached) << "chain " << i;
+          EXPECT_SIMDQUATERNION_EQ_TOL(
+              start_corrections[i], ozz::math::GetX(start_correction.xyzw),
+              ozz::math::GetY(start_correction.xyzw),
+              ozz::math::GetZ(start_correction.xyzw),
+              ozz::math::GetW(start_correction.xyzw), 2e-3f);
+          EXPECT_SIMDQUATERNION_EQ_TOL(
+              mid_corrections[i], ozz::math::GetX(mid_correction.xyzw),
+              ozz::math::GetY(mid_correction.xyzw),
+              ozz::math::GetZ(mid_correction.xyzw),
+              ozz::math::GetW(mid_correction.xyzw), 2e-3f);
+        }
+
+        // Chains cover both reached and unreached targets.
+        if (weight >= 1.f) {
+          EXPECT_GT(num_reached, 0);
+          EXPECT_LT(num_reached, kNumChains);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,186 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/lazy_model_pose.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::LazyModelPose;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton with 2 branches:
+// root -> a0 -> a1 -> a2
+//      -> b0 -> b1
+ozz::unique_ptr<Skeleton> BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  root.children.resize(2);
+  RawSkeleton::Joint* joint = &root.children[0];
+  const char* a_names[] = {"a0", "a1", "a2"};
+  for (int i = 0; i < 3; ++i) {
+    joint->name = a_names[i];
+    joint->transform = ozz::math::Transform::identity();
+    joint->transform.translation = ozz::math::Float3(1.f, 0.f, 0.f);
+    joint->transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float3::z_axis(), .5f);
+    if (i != 2) {
+      joint->children.resize(1);
+      joint = &joint->children[0];
+    }
+  }
+  RawSkeleton::Joint& b0 = root.children[1];
+  b0.name = "b0";
+  b0.transform = ozz::math::Transform::identity();
+  b0.transform.translation = ozz::math::Float3(0.f, 0.f, 1.f);
+  b0.transform.scale = ozz::math::Float3(2.f, 2.f, 2.f);
+  b0.children.resize(1);
+  b0.children[0].name = "b1";
+  b0.children[0].transform = ozz::math::Transform::identity();
+  b0.children[0].transform.translation = ozz::math::Float3(0.f, 1.f, 0.f);
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+void ExpectMatrixEq(const ozz::math::Float4x4& _actual,
+                    const ozz::math::Float4x4& _expected) {
+  for (int c = 0; c < 4; ++c) {
+    EXPECT_SIMDFLOAT_EQ_EST(_actual.cols[c], ozz::math::GetX(_expected.cols[c]),
+                            ozz::math::GetY(_expected.cols[c]),
+                            ozz::math::GetZ(_expected.cols[c]),
+                            ozz::math::GetW(_expected.cols[c]));
+  }
+}
+}  // namespace
+
+TEST(Validity, LazyModelPose) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  const ozz::span<const ozz::math::SoaTransform> locals =
+      skeleton->joint_rest_poses();
+
+  LazyModelPose pose;
+  EXPECT_FALSE(pose.Bind(locals));
+  EXPECT_TRUE(pose.Evaluate(0) == nullptr);
+  EXPECT_FALSE(pose.evaluated(0));
+
+  EXPECT_FALSE(pose.Allocate(Skeleton()));
+  ASSERT_TRUE(pose.Allocate(*skeleton));
+
+  // Not bound yet.
+  EXPECT_TRUE(pose.Evaluate(0) == nullptr);
+
+  // Too small input.
+  EXPECT_FALSE(pose.Bind({}));
+  EXPECT_TRUE(pose.Evaluate(0) == nullptr);
+
+  ASSERT_TRUE(pose.Bind(locals));
+  EXPECT_TRUE(pose.Evaluate(-1) == nullptr);
+  EXPECT_TRUE(pose.Evaluate(skeleton->num_joints()) == nullptr);
+  EXPECT_TRUE(pose.Evaluate(0) != nullptr);
+
+  pose.Deallocate();
+  EXPECT_TRUE(pose.Evaluate(0) == nullptr);
+  EXPECT_FALSE(pose.Bind(locals));
+}
+
+TEST(Evaluate, LazyModelPose) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+  const int a2 = ozz::animation::FindJoint(*skeleton, "a2");
+  const int a0 = ozz::animation::FindJoint(*skeleton, "a0");
+  const int b1 = ozz::animation::FindJoint(*skeleton, "b1");
+  const int root_joint = ozz::animation::FindJoint(*skeleton, "root");
+  ASSERT_TRUE(a2 >= 0 && a0 >= 0 && b1 >= 0 && root_joint >= 0);
+
+  const ozz::math::Float4x4 root = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 0.f));
+
+  // Reference.
+  ozz::vector<ozz::math::Float4x4> expected(num_joints);
+  LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.root = &root;
+  job.input = skeleton->joint_rest_poses();
+  job.output = ozz::make_span(expected);
+  ASSERT_TRUE(job.Run());
+
+  LazyModelPose pose;
+  ASSERT_TRUE(pose.Allocate(*skeleton));
+  ASSERT_TRUE(pose.Bind(skeleton->joint_rest_poses(), &root));
+  EXPECT_EQ(pose.num_evaluated(), 0);
+
+  // Evaluates the whole chain to a2.
+  const ozz::math::Float4x4* model = pose.Evaluate(a2);
+  ASSERT_TRUE(model != nullptr);
+  ExpectMatrixEq(*model, expected[a2]);
+  EXPECT_EQ(pose.num_evaluated(), 4);
+  EXPECT_TRUE(pose.evaluated(root_joint));
+  EXPECT_TRUE(pose.evaluated(a0));
+  EXPECT_FALSE(pose.evaluated(b1));
+
+  // Ancestors are memoized.
+  ExpectMatrixEq(*pose.Evaluate(a0), expected[a0]);
+  EXPECT_EQ(pose.num_evaluated(), 4);
+
+  // Other branch only evaluates from the root.
+  ExpectMatrixEq(*pose.Evaluate(b1), expected[b1]);
+  EXPECT_EQ(pose.num_evaluated(), num_joints);
+  for (int i = 0; i < num_joints; ++i) {
+    EXPECT_TRUE(pose.evaluated(i));
+    ExpectMatrixEq(*pose.Evaluate(i), expected[i]);
+  }
+
+  // Invalidation.
+  pose.Invalidate();
+  EXPECT_EQ(pose.num_evaluated(), 0);
+  EXPECT_FALSE(pose.evaluated(root_joint));
+
+  // Rebinds without root.
+  ASSERT_TRUE(pose.Bind(skeleton->joint_rest_poses()));
+  job.root = nullptr;
+  ASSERT_TRUE(job.Run());
+  ExpectMatrixEq(*pose.Evaluate(b1), expected[b1]);
+  EXPECT_EQ(pose.num_evaluated(), 3);
+}
@@ -25,16 +25,25 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
 #include "ozz/animation/runtime/local_to_model_job.h"
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/gtest_parallel_for_helper.h"
 #include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_float3x4.h"
+#include "ozz/base/maths/soa_float4x4.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/unique_ptr.h"
+#include "ozz/base/task_scheduler.h"
 
+using ozz::animation::BatchLocalToModelJob;
 using ozz::animation::LocalToModelJob;
+using ozz::animation::LocalToSkinningJob;
 using ozz::animation::Skeleton;
 using ozz::animation::offline::RawSkeleton;
 using ozz::animation::offline::SkeletonBuilder;
@@ -1026,3 +1035,890 @@ TEST(Empty, LocalToModel) {
     EXPECT_TRUE(job.Run());
   }
 }
+
+TEST(TransformationDirty, LocalToModel) {
+  // Builds a skeleton with 2 roots and a few chains:
+  // j0 -> (j1 -> j2 -> j3, j4 -> j5, j6 -> (j7, j8)), j9 -> j10.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  RawSkeleton::Joint& j0 = raw_skeleton.roots[0];
+  j0.children.resize(3);
+  j0.children[0].children.resize(1);
+  j0.children[0].children[0].children.resize(1);
+  j0.children[1].children.resize(1);
+  j0.children[2].children.resize(2);
+  raw_skeleton.roots[1].children.resize(1);
+  EXPECT_EQ(raw_skeleton.num_joints(), 11);
+
+  SkeletonBuilder builder;
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+  const ozz::span<const int16_t>& parents = skeleton->joint_parents();
+
+  // Local transforms, different for every joint.
+  ozz::math::SoaTransform input[3];
+  for (int i = 0; i < 3; ++i) {
+    const float fi = static_cast<float>(i * 4);
+    input[i] = ozz::math::SoaTransform::identity();
+    input[i].translation.x =
+        ozz::math::simd_float4::Load(fi, fi + 1.f, fi + 2.f, fi + 3.f);
+    input[i].translation.y = ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 4.f);
+    input[i].rotation.z = ozz::math::simd_float4::Load(.1f, .2f, .3f, .4f);
+    input[i].rotation.w = ozz::math::simd_float4::Load(.99f, .98f, .95f, .91f);
+    input[i].rotation = ozz::math::Normalize(input[i].rotation);
+  }
+
+  const ozz::math::Float4x4 root =
+      ozz::math::Float4x4::Translation(ozz::math::simd_float4::x_axis());
+
+  LocalToModelJob full_job;
+  full_job.skeleton = skeleton.get();
+  full_job.root = &root;
+  full_job.input = input;
+  ozz::math::Float4x4 before[11];
+  full_job.output = before;
+  ASSERT_TRUE(full_job.Run());
+
+  // Tests different sets of dirty joints, including disjoint chains.
+  const uint8_t dirties[][2] = {{0x00, 0x00}, {0x01, 0x00}, {0x04, 0x00},
+                                {0x24, 0x02}, {0x88, 0x04}, {0xff, 0x07}};
+  for (size_t d = 0; d < OZZ_ARRAY_SIZE(dirties); ++d) {
+    const uint8_t* dirty = dirties[d];
+
+    // Tells if a joint is expected to be updated.
+    bool updated[11] = {};
+    for (int i = 0; i < num_joints; ++i) {
+      updated[i] = (dirty[i / 8] & (1 << (i % 8))) != 0 ||
+                   (parents[i] != Skeleton::kNoParent && updated[parents[i]]);
+    }
+
+    // Only dirty joints local transforms change.
+    ozz::math::SoaTransform edited[3];
+    for (int i = 0; i < 3; ++i) {
+      edited[i] = input[i];
+      const float zs[4] = {
+          (dirty[(i * 4) / 8] & (1 << ((i * 4) % 8))) ? 5.f : 0.f,
+          (dirty[(i * 4 + 1) / 8] & (1 << ((i * 4 + 1) % 8))) ? 6.f : 0.f,
+          (dirty[(i * 4 + 2) / 8] & (1 << ((i * 4 + 2) % 8))) ? 7.f : 0.f,
+          (dirty[(i * 4 + 3) / 8] & (1 << ((i * 4 + 3) % 8))) ? 8.f : 0.f};
+      edited[i].translation.z =
+          ozz::math::simd_float4::Load(zs[0], zs[1], zs[2], zs[3]);
+    }
+
+    // Reference.
+    ozz::math::Float4x4 expected[11];
+    full_job.input = edited;
+    full_job.output = expected;
+    ASSERT_TRUE(full_job.Run());
+
+    // Dirty update, starting from previous output.
+    ozz::math::Float4x4 output[11];
+    for (int i = 0; i < num_joints; ++i) {
+      output[i] = before[i];
+    }
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.root = &root;
+    job.input = edited;
+    job.output = output;
+    job.from = 4;  // Ignored.
+    job.to = 5;
+    job.dirty = ozz::span<const uint8_t>(dirty, 1);
+    EXPECT_FALSE(job.Validate());
+    job.dirty = ozz::span<const uint8_t>(dirty, 2);
+    EXPECT_TRUE(job.Validate());
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < num_joints; ++i) {
+      const ozz::math::Float4x4& ref = updated[i] ? expected[i] : before[i];
+      EXPECT_EQ(std::memcmp(&output[i], &ref, sizeof(ref)), 0)
+          << "dirty set " << d << ", joint " << i;
+    }
+  }
+}
+
+TEST(Affine, LocalToModel) {
+  // Builds a skeleton with 2 roots: j0 -> (j1 -> j2, j3 -> (j4, j5)), j6.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  RawSkeleton::Joint& j0 = raw_skeleton.roots[0];
+  j0.children.resize(2);
+  j0.children[0].children.resize(1);
+  j0.children[1].children.resize(2);
+  EXPECT_EQ(raw_skeleton.num_joints(), 7);
+
+  SkeletonBuilder builder;
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+
+  // Local transforms, with rotations and non uniform scales.
+  ozz::math::SoaTransform input[2];
+  for (int i = 0; i < 2; ++i) {
+    const float fi = static_cast<float>(i * 4);
+    input[i] = ozz::math::SoaTransform::identity();
+    input[i].translation.x =
+        ozz::math::simd_float4::Load(fi, fi + 1.f, fi + 2.f, fi + 3.f);
+    input[i].translation.z = ozz::math::simd_float4::Load(1.f, -2.f, 3.f, 4.f);
+    input[i].rotation.x = ozz::math::simd_float4::Load(.3f, .2f, .1f, 0.f);
+    input[i].rotation.w = ozz::math::simd_float4::Load(.9f, .98f, .95f, 1.f);
+    input[i].rotation = ozz::math::Normalize(input[i].rotation);
+    input[i].scale.y = ozz::math::simd_float4::Load(2.f, .5f, 1.f, 3.f);
+  }
+
+  const ozz::math::Float4x4 root = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(4.f, 3.f, 2.f, 0.f));
+
+  // Reference.
+  ozz::math::Float4x4 expected[7];
+  LocalToModelJob ref_job;
+  ref_job.skeleton = skeleton.get();
+  ref_job.root = &root;
+  ref_job.input = input;
+  ref_job.output = expected;
+  ASSERT_TRUE(ref_job.Run());
+
+  ozz::math::Float3x4 output[7];
+  LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.root = &root;
+  job.input = input;
+
+  // Only one output can be set, and must be big enough.
+  job.output = expected;
+  job.affine_output = output;
+  EXPECT_FALSE(job.Validate());
+  job.output = {};
+  job.affine_output = {output, 6};
+  EXPECT_FALSE(job.Validate());
+  job.affine_output = output;
+  EXPECT_TRUE(job.Validate());
+  ASSERT_TRUE(job.Run());
+
+  for (int i = 0; i < num_joints; ++i) {
+    const ozz::math::Float4x4 m = ToFloat4x4(output[i]);
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ_EST(m.cols[c], ozz::math::GetX(expected[i].cols[c]),
+                              ozz::math::GetY(expected[i].cols[c]),
+                              ozz::math::GetZ(expected[i].cols[c]),
+                              ozz::math::GetW(expected[i].cols[c]));
+    }
+  }
+
+  // Dirty update must also support affine output.
+  const uint8_t dirty[] = {0x08};
+  job.dirty = dirty;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < num_joints; ++i) {
+    const ozz::math::Float4x4 m = ToFloat4x4(output[i]);
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ_EST(m.cols[c], ozz::math::GetX(expected[i].cols[c]),
+                              ozz::math::GetY(expected[i].cols[c]),
+                              ozz::math::GetZ(expected[i].cols[c]),
+                              ozz::math::GetW(expected[i].cols[c]));
+    }
+  }
+
+  // Validated plan outputs the same matrices.
+  ozz::math::Float3x4 plan_output[7];
+  job.dirty = {};
+  job.affine_output = plan_output;
+  const ozz::JobPlan<LocalToModelJob> plan(job);
+  ASSERT_TRUE(plan.valid());
+  EXPECT_TRUE(plan.Execute());
+  EXPECT_EQ(std::memcmp(output, plan_output, sizeof(output)), 0);
+}
+
+TEST(Batch, LocalToModel) {
+  // Builds a skeleton of 11 joints, whose last SoA joint is incomplete.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  RawSkeleton::Joint& j0 = raw_skeleton.roots[0];
+  j0.children.resize(3);
+  j0.children[0].children.resize(1);
+  j0.children[0].children[0].children.resize(1);
+  j0.children[1].children.resize(1);
+  j0.children[2].children.resize(2);
+  raw_skeleton.roots[1].children.resize(1);
+
+  SkeletonBuilder builder;
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+  ASSERT_EQ(num_joints, 11);
+
+  // 7 instances, so that the last group is incomplete.
+  const int kNumInstances = 7;
+  ozz::math::SoaTransform inputs[kNumInstances][3];
+  ozz::math::Float4x4 outputs[kNumInstances][11];
+  ozz::math::Float4x4 expected[kNumInstances][11];
+  ozz::math::Float4x4 roots[kNumInstances];
+  BatchLocalToModelJob::Instance instances[kNumInstances];
+  for (int n = 0; n < kNumInstances; ++n) {
+    const float fn = static_cast<float>(n);
+    for (int i = 0; i < 3; ++i) {
+      const float fi = static_cast<float>(i * 4) + fn;
+      ozz::math::SoaTransform& input = inputs[n][i];
+      input.translation = ozz::math::SoaFloat3::Load(
+          ozz::math::simd_float4::Load(fi, fi + 1.f, fi + 2.f, fi + 3.f),
+          ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 4.f),
+          ozz::math::simd_float4::Load1(-fn));
+      input.rotation = ozz::math::SoaQuaternion::Load(
+          ozz::math::simd_float4::Load(.1f * fn, 0.f, .2f, 0.f),
+          ozz::math::simd_float4::Load(0.f, .3f, .1f, -.1f * fn),
+          ozz::math::simd_float4::Load(.2f, .1f, 0.f, .4f),
+          ozz::math::simd_float4::Load(.9f, .95f, .97f, .8f));
+      input.rotation = ozz::math::Normalize(input.rotation);
+      input.scale = ozz::math::SoaFloat3::Load(
+          ozz::math::simd_float4::Load1(1.f + .1f * fn),
+          ozz::math::simd_float4::Load(1.f, 2.f, 1.f, .5f),
+          ozz::math::simd_float4::one());
+    }
+    roots[n] = ozz::math::Float4x4::Translation(
+                   ozz::math::simd_float4::Load(fn, 0.f, 1.f, 0.f)) *
+               ozz::math::Float4x4::Scaling(
+                   ozz::math::simd_float4::Load(2.f, 1.f, 1.f, 1.f));
+
+    // Every other instance has no root.
+    instances[n].root = n % 2 ? &roots[n] : nullptr;
+    instances[n].input = inputs[n];
+    instances[n].output = outputs[n];
+
+    LocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.root = instances[n].root;
+    job.input = inputs[n];
+    job.output = expected[n];
+    ASSERT_TRUE(job.Run());
+  }
+
+  ozz::math::SoaFloat4x4 scratch[11];
+
+  {  // Validity.
+    BatchLocalToModelJob job;
+    EXPECT_FALSE(job.Validate());
+    job.skeleton = skeleton.get();
+    EXPECT_FALSE(job.Validate());
+    job.scratch = scratch;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    job.instances = instances;
+    EXPECT_TRUE(job.Validate());
+    job.scratch = ozz::make_span(scratch).subspan(0, 10);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+    job.scratch = scratch;
+
+    BatchLocalToModelJob::Instance invalids[2] = {instances[0], instances[1]};
+    job.instances = invalids;
+    invalids[1].input = ozz::make_span(inputs[1]).subspan(0, 2);
+    EXPECT_FALSE(job.Validate());
+    invalids[1].input = inputs[1];
+    invalids[1].output = ozz::make_span(outputs[1]).subspan(0, 10);
+    EXPECT_FALSE(job.Validate());
+  }
+
+  // Tests all batch sizes.
+  for (int num_instances = 1; num_instances <= kNumInstances;
+       ++num_instances) {
+    memset(outputs, 0, sizeof(outputs));
+
+    BatchLocalToModelJob job;
+    job.skeleton = skeleton.get();
+    job.instances = ozz::make_span(instances).subspan(0, num_instances);
+    job.scratch = scratch;
+    ASSERT_TRUE(job.Run());
+
+    for (int n = 0; n < kNumInstances; ++n) {
+      for (int i = 0; i < num_joints; ++i) {
+        const float* a = reinterpret_cast<const float*>(&outputs[n][i]);
+        const float* b = reinterpret_cast<const float*>(&expected[n][i]);
+        for (int f = 0; f < 16; ++f) {
+          // Instances out of the batch aren't written.
+          const float ref = n < num_instances ? b[f] : 0.f;
+          ASSERT_NEAR(a[f], ref, 1e-4f)
+              << "batch " << num_instances << ", instance " << n
+              << ", joint " << i << ", float " << f;
+        }
+      }
+    }
+  }
+}
+
+TEST(Skinning, LocalToModel) {
+  // Builds a skeleton of 11 joints, with 2 roots.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  RawSkeleton::Joint& j0 = raw_skeleton.roots[0];
+  j0.children.resize(3);
+  j0.children[0].children.resize(1);
+  j0.children[0].children[0].children.resize(1);
+  j0.children[1].children.resize(1);
+  j0.children[2].children.resize(2);
+  raw_skeleton.roots[1].children.resize(1);
+
+  SkeletonBuilder builder;
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+  ASSERT_EQ(num_joints, 11);
+
+  ozz::math::SoaTransform input[3];
+  for (int i = 0; i < 3; ++i) {
+    const float fi = static_cast<float>(i * 4);
+    input[i].translation = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load(fi, fi + 1.f, fi + 2.f, fi + 3.f),
+        ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 4.f),
+        ozz::math::simd_float4::Load1(-fi));
+    input[i].rotation = ozz::math::Normalize(ozz::math::SoaQuaternion::Load(
+        ozz::math::simd_float4::Load(.1f * fi, 0.f, .2f, 0.f),
+        ozz::math::simd_float4::Load(0.f, .3f, .1f, -.1f * fi),
+        ozz::math::simd_float4::Load(.2f, .1f, 0.f, .4f),
+        ozz::math::simd_float4::Load(.9f, .95f, .97f, .8f)));
+    input[i].scale = ozz::math::SoaFloat3::Load(
+        ozz::math::simd_float4::Load1(1.f + .1f * fi),
+        ozz::math::simd_float4::Load(1.f, 2.f, 1.f, .5f),
+        ozz::math::simd_float4::one());
+  }
+  const ozz::math::Float4x4 root = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(1.f, 0.f, 1.f, 0.f));
+
+  // Reference model-space matrices.
+  ozz::math::Float4x4 models[11];
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = skeleton.get();
+  ltm_job.root = &root;
+  ltm_job.input = input;
+  ltm_job.output = models;
+  ASSERT_TRUE(ltm_job.Run());
+
+  // Uses a subset of the joints, one of them twice, and none of the second
+  // root hierarchy.
+  const uint16_t joint_remaps[] = {3, 9, 3, 7, 1};
+  ozz::math::Float4x4 inverse_bind_poses[5];
+  for (int i = 0; i < 5; ++i) {
+    const float fi = static_cast<float>(i);
+    inverse_bind_poses[i] =
+        ozz::math::Float4x4::Translation(
+            ozz::math::simd_float4::Load(fi, -fi, 2.f, 0.f)) *
+        ozz::math::Float4x4::Scaling(ozz::math::simd_float4::Load1(1.f + fi));
+  }
+  ozz::math::Float4x4 output[5];
+
+  LocalToSkinningJob job;
+  EXPECT_FALSE(job.Validate());
+  job.skeleton = skeleton.get();
+  job.input = input;
+  EXPECT_TRUE(job.Validate());
+  EXPECT_TRUE(job.Run());  // No remap, no output.
+  job.joint_remaps = joint_remaps;
+  EXPECT_FALSE(job.Validate());
+  job.inverse_bind_poses = inverse_bind_poses;
+  EXPECT_FALSE(job.Validate());
+  job.output = output;
+  EXPECT_TRUE(job.Validate());
+  job.input = ozz::make_span(input).subspan(0, 2);
+  EXPECT_FALSE(job.Validate());
+  job.input = input;
+  const uint16_t invalid_remaps[] = {3, 11};
+  job.joint_remaps = invalid_remaps;
+  EXPECT_FALSE(job.Run());
+  job.joint_remaps = joint_remaps;
+
+  job.root = &root;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < 5; ++i) {
+    const ozz::math::Float4x4 expected =
+        models[joint_remaps[i]] * inverse_bind_poses[i];
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ_EST(output[i].cols[c],
+                              ozz::math::GetX(expected.cols[c]),
+                              ozz::math::GetY(expected.cols[c]),
+                              ozz::math::GetZ(expected.cols[c]),
+                              ozz::math::GetW(expected.cols[c]));
+    }
+  }
+}
+
+TEST(SkinningDepth, LocalToModel) {
+  // Builds a chain deeper than the job supports.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* joint = &raw_skeleton.roots[0];
+  for (int i = 1; i < LocalToSkinningJob::kMaxDepth; ++i) {
+    joint->children.resize(1);
+    joint = &joint->children[0];
+  }
+
+  SkeletonBuilder builder;
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  ozz::math::SoaTransform input[LocalToSkinningJob::kMaxDepth / 4 + 1];
+  for (ozz::math::SoaTransform& transform : input) {
+    transform = ozz::math::SoaTransform::identity();
+  }
+  LocalToSkinningJob job;
+  job.skeleton = skeleton.get();
+  job.input = input;
+  EXPECT_TRUE(job.Validate());
+
+  joint->children.resize(1);
+  skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton);
+  job.skeleton = skeleton.get();
+  EXPECT_FALSE(job.Validate());
+}
+
+namespace {
+// Builds a skeleton of _num_roots roots, each with a single child.
+ozz::unique_ptr<Skeleton> BuildPairsSkeleton(int _num_roots) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(_num_roots);
+  for (RawSkeleton::Joint& root : raw_skeleton.roots) {
+    root.children.resize(1);
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Fills local transforms with rotations, translations and non uniform scales.
+void FillLocals(ozz::span<ozz::math::SoaTransform> _input) {
+  for (size_t i = 0; i < _input.size(); ++i) {
+    const float fi = static_cast<float>(i);
+    ozz::math::SoaTransform& transform = _input[i];
+    transform.translation.x =
+        ozz::math::simd_float4::Load(fi, fi + 1.f, fi + 2.f, fi + 3.f);
+    transform.translation.y = ozz::math::simd_float4::Load(-1.f, 2.f, 0.f, 5.f);
+    transform.translation.z = ozz::math::simd_float4::Load(1.f, -2.f, 3.f, fi);
+    transform.rotation.x = ozz::math::simd_float4::Load(.3f, .2f, .1f, 0.f);
+    transform.rotation.y = ozz::math::simd_float4::Load(0.f, -.4f, .1f, .7f);
+    transform.rotation.z = ozz::math::simd_float4::Load(.1f, .2f, -.5f, 0.f);
+    transform.rotation.w = ozz::math::simd_float4::Load(.9f, .8f, .7f, .6f);
+    transform.rotation = ozz::math::Normalize(transform.rotation);
+    transform.scale.x = ozz::math::simd_float4::Load(1.f, 2.f, .5f, 1.f);
+    transform.scale.y = ozz::math::simd_float4::Load(2.f, .5f, 1.f, 3.f);
+    transform.scale.z = ozz::math::simd_float4::Load(1.f, 1.f, 4.f, .2f);
+  }
+}
+
+// Builds local matrices the legacy way, building SoA matrices and transposing
+// them to aos.
+void LocalsReference(ozz::span<const ozz::math::SoaTransform> _input,
+                     ozz::span<ozz::math::Float4x4> _output) {
+  for (size_t i = 0; i < _input.size(); ++i) {
+    const ozz::math::SoaTransform& transform = _input[i];
+    const ozz::math::SoaFloat4x4 soa = ozz::math::SoaFloat4x4::FromAffine(
+        transform.translation, transform.rotation, transform.scale);
+    ozz::math::Transpose16x16(&soa.cols[0].x, _output[i * 4].cols);
+  }
+}
+}  // namespace
+
+TEST(LocalMatrices, LocalToModel) {
+  // Roots only skeleton, so that model-space matrices are local ones. An odd
+  // number of SoA joints covers AVX path pairs and the remaining single one.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(22);
+  SkeletonBuilder builder;
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+  EXPECT_EQ(skeleton->num_soa_joints(), 6);
+
+  ozz::math::SoaTransform input[6];
+  FillLocals(input);
+  ozz::math::Float4x4 expected[24];
+  LocalsReference(input, expected);
+
+  LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.input = input;
+
+  ozz::math::Float4x4 output[22];
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < num_joints; ++i) {
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ_EST(output[i].cols[c],
+                              ozz::math::GetX(expected[i].cols[c]),
+                              ozz::math::GetY(expected[i].cols[c]),
+                              ozz::math::GetZ(expected[i].cols[c]),
+                              ozz::math::GetW(expected[i].cols[c]));
+    }
+  }
+
+  ozz::math::Float3x4 affine_output[22];
+  job.output = {};
+  job.affine_output = affine_output;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < num_joints; ++i) {
+    const ozz::math::Float4x4 m = ToFloat4x4(affine_output[i]);
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ_EST(m.cols[c], ozz::math::GetX(expected[i].cols[c]),
+                              ozz::math::GetY(expected[i].cols[c]),
+                              ozz::math::GetZ(expected[i].cols[c]),
+                              ozz::math::GetW(expected[i].cols[c]));
+    }
+  }
+}
+
+// Benchmarks below compare LocalToModelJob, which builds local matrices
+// straight to aos on AVX hosts, with the legacy path that builds SoA matrices
+// and transposes them.
+TEST(Benchmark, LocalToModelReference) {
+  ozz::unique_ptr<Skeleton> skeleton =
+      BuildPairsSkeleton(Skeleton::kMaxInlineJoints / 2);
+  ASSERT_TRUE(skeleton);
+  const ozz::span<const int16_t>& parents = skeleton->joint_parents();
+  ozz::vector<ozz::math::SoaTransform> input(skeleton->num_soa_joints());
+  FillLocals(make_span(input));
+  ozz::vector<ozz::math::Float4x4> locals(skeleton->num_joints());
+  ozz::vector<ozz::math::Float4x4> output(skeleton->num_joints());
+
+  for (int i = 0; i < 1000; ++i) {
+    LocalsReference(make_span(input), make_span(locals));
+    for (int j = 0; j < skeleton->num_joints(); ++j) {
+      const int parent = parents[j];
+      output[j] = parent == Skeleton::kNoParent ? locals[j]
+                                                : output[parent] * locals[j];
+    }
+  }
+}
+
+TEST(Benchmark, LocalToModel) {
+  ozz::unique_ptr<Skeleton> skeleton =
+      BuildPairsSkeleton(Skeleton::kMaxInlineJoints / 2);
+  ASSERT_TRUE(skeleton);
+  ozz::vector<ozz::math::SoaTransform> input(skeleton->num_soa_joints());
+  FillLocals(make_span(input));
+  ozz::vector<ozz::math::Float4x4> output(skeleton->num_joints());
+
+  LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.input = make_span(input);
+  job.output = make_span(output);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Benchmark, LocalToModelAffine) {
+  ozz::unique_ptr<Skeleton> skeleton =
+      BuildPairsSkeleton(Skeleton::kMaxInlineJoints / 2);
+  ASSERT_TRUE(skeleton);
+  ozz::vector<ozz::math::SoaTransform> input(skeleton->num_soa_joints());
+  FillLocals(make_span(input));
+  ozz::vector<ozz::math::Float3x4> output(skeleton->num_joints());
+
+  LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.input = make_span(input);
+  job.affine_output = make_span(output);
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(SkinningInverseTranspose, LocalToModel) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildPairsSkeleton(2);
+  ASSERT_TRUE(skeleton);
+
+  // Rotated and uniformly scaled locals.
+  ozz::math::SoaTransform input[1];
+  input[0].translation = ozz::math::SoaFloat3::Load(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 4.f),
+      ozz::math::simd_float4::Load(-1.f, 0.f, 5.f, 2.f),
+      ozz::math::simd_float4::Load(0.f, 3.f, -2.f, 1.f));
+  input[0].rotation = ozz::math::Normalize(ozz::math::SoaQuaternion::Load(
+      ozz::math::simd_float4::Load(.3f, .2f, .1f, 0.f),
+      ozz::math::simd_float4::Load(0.f, -.4f, .1f, .7f),
+      ozz::math::simd_float4::Load(.1f, .2f, -.5f, 0.f),
+      ozz::math::simd_float4::Load(.9f, .8f, .7f, .6f)));
+  const ozz::math::SimdFloat4 scale =
+      ozz::math::simd_float4::Load(2.f, .5f, 1.f, 3.f);
+  input[0].scale = ozz::math::SoaFloat3::Load(scale, scale, scale);
+
+  const uint16_t joint_remaps[] = {0, 1, 2, 3};
+  ozz::math::Float4x4 inverse_bind_poses[4];
+  for (int i = 0; i < 4; ++i) {
+    inverse_bind_poses[i] = ozz::math::Float4x4::Scaling(
+        ozz::math::simd_float4::Load1(1.f + static_cast<float>(i)));
+  }
+  ozz::math::Float4x4 output[4];
+  ozz::math::Float4x4 inverse_transpose[4];
+  bool uniform_scale = false;
+
+  LocalToSkinningJob job;
+  job.skeleton = skeleton.get();
+  job.input = input;
+  job.joint_remaps = joint_remaps;
+  job.inverse_bind_poses = inverse_bind_poses;
+  job.output = output;
+  job.inverse_transpose_output = {inverse_transpose, 3};
+  EXPECT_FALSE(job.Validate());
+  job.inverse_transpose_output = inverse_transpose;
+  job.uniform_scale = &uniform_scale;
+  ASSERT_TRUE(job.Run());
+  EXPECT_TRUE(uniform_scale);
+
+  const auto check = [&]() {
+    const ozz::math::SimdFloat4 v =
+        ozz::math::simd_float4::Load(.3f, -.7f, .2f, 0.f);
+    for (int i = 0; i < 4; ++i) {
+      const ozz::math::Float4x4 reference =
+          ozz::math::Transpose(ozz::math::Invert(output[i]));
+      const ozz::math::SimdFloat4 ref_v =
+          ozz::math::TransformVector(reference, v);
+      EXPECT_SIMDFLOAT3_EQ_TOL(
+          ozz::math::TransformVector(inverse_transpose[i], v),
+          ozz::math::GetX(ref_v), ozz::math::GetY(ref_v),
+          ozz::math::GetZ(ref_v), 1e-4f);
+    }
+  };
+  check();
+
+  // Without inverse transpose output.
+  uniform_scale = false;
+  job.inverse_transpose_output = {};
+  ASSERT_TRUE(job.Run());
+  EXPECT_TRUE(uniform_scale);
+
+  // Non uniformly scaled inverse bind pose.
+  inverse_bind_poses[2] = ozz::math::Float4x4::Scaling(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f));
+  ASSERT_TRUE(job.Run());
+  EXPECT_FALSE(uniform_scale);
+
+  uniform_scale = true;
+  job.inverse_transpose_output = inverse_transpose;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FALSE(uniform_scale);
+  check();
+
+  // Streaming stores output the same matrices.
+  ozz::math::Float4x4 streamed[4];
+  ozz::math::Float4x4 streamed_inverse_transpose[4];
+  job.streaming_output = true;
+  job.output = streamed;
+  job.inverse_transpose_output = streamed_inverse_transpose;
+  uniform_scale = true;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FALSE(uniform_scale);
+  EXPECT_EQ(std::memcmp(output, streamed, sizeof(output)), 0);
+  EXPECT_EQ(std::memcmp(inverse_transpose, streamed_inverse_transpose,
+                        sizeof(inverse_transpose)),
+            0);
+}
+
+TEST(SkinningOrdering, LocalToModel) {
+  // Builds 2 chains, whose siblings grouped ordering isn't depth-first.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(2);
+  raw_skeleton.roots[0].children[0].children.resize(1);
+  raw_skeleton.roots[0].children[1].children.resize(1);
+
+  SkeletonBuilder builder;
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  ozz::math::SoaTransform input[2] = {ozz::math::SoaTransform::identity(),
+                                      ozz::math::SoaTransform::identity()};
+  LocalToSkinningJob job;
+  job.skeleton = skeleton.get();
+  job.input = input;
+  EXPECT_TRUE(job.Validate());
+
+  builder.ordering = SkeletonBuilder::kSiblingsGrouped;
+  skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton);
+  job.skeleton = skeleton.get();
+  EXPECT_FALSE(job.Validate());
+
+  // Full local-to-model conversion only needs parents before children.
+  ozz::math::Float4x4 models[5];
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = skeleton.get();
+  ltm_job.input = input;
+  ltm_job.output = models;
+  EXPECT_TRUE(ltm_job.Run());
+}
+
+TEST(LargeSkeleton, LocalToModel) {
+  // Skeleton beyond Skeleton::kMaxInlineJoints, so that jobs use allocated
+  // scratch memory.
+  ozz::unique_ptr<Skeleton> skeleton =
+      BuildPairsSkeleton(Skeleton::kMaxJoints / 2);
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+  ASSERT_EQ(num_joints, Skeleton::kMaxJoints);
+  ozz::vector<ozz::math::SoaTransform> input(skeleton->num_soa_joints());
+  FillLocals(make_span(input));
+  ozz::vector<ozz::math::Float4x4> locals(num_joints);
+  LocalsReference(make_span(input), make_span(locals));
+
+  ozz::vector<ozz::math::Float4x4> models(num_joints);
+  LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.input = make_span(input);
+  job.output = make_span(models);
+  ASSERT_TRUE(job.Run());
+
+  // Dirties the last pair only.
+  ozz::vector<ozz::math::Float4x4> dirty_models(num_joints);
+  ozz::vector<uint8_t> dirty((num_joints + 7) / 8, 0);
+  dirty[(num_joints - 2) / 8] = uint8_t(1 << ((num_joints - 2) & 7));
+  job.dirty = make_span(dirty);
+  job.output = make_span(dirty_models);
+  ASSERT_TRUE(job.Run());
+
+  const int joints[] = {0, 1, num_joints - 2, num_joints - 1};
+  for (const int joint : joints) {
+    const int parent = skeleton->joint_parents()[joint];
+    const ozz::math::Float4x4 expected =
+        parent == Skeleton::kNoParent ? locals[joint]
+                                      : locals[parent] * locals[joint];
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ_EST(models[joint].cols[c],
+                              ozz::math::GetX(expected.cols[c]),
+                              ozz::math::GetY(expected.cols[c]),
+                              ozz::math::GetZ(expected.cols[c]),
+                              ozz::math::GetW(expected.cols[c]));
+    }
+  }
+  for (int c = 0; c < 4; ++c) {
+    EXPECT_SIMDFLOAT_EQ_EST(
+        dirty_models[num_joints - 1].cols[c],
+        ozz::math::GetX(models[num_joints - 1].cols[c]),
+        ozz::math::GetY(models[num_joints - 1].cols[c]),
+        ozz::math::GetZ(models[num_joints - 1].cols[c]),
+        ozz::math::GetW(models[num_joints - 1].cols[c]));
+  }
+
+  // Skinning matrices of the last joints.
+  const uint16_t joint_remaps[] = {uint16_t(num_joints - 1), 1};
+  const ozz::math::Float4x4 inverse_bind_poses[] = {
+      ozz::math::Float4x4::identity(), ozz::math::Float4x4::identity()};
+  ozz::math::Float4x4 output[2];
+  LocalToSkinningJob skinning_job;
+  skinning_job.skeleton = skeleton.get();
+  skinning_job.input = make_span(input);
+  skinning_job.joint_remaps = joint_remaps;
+  skinning_job.inverse_bind_poses = inverse_bind_poses;
+  skinning_job.output = output;
+  ASSERT_TRUE(skinning_job.Run());
+  for (int i = 0; i < 2; ++i) {
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ_EST(
+          output[i].cols[c], ozz::math::GetX(models[joint_remaps[i]].cols[c]),
+          ozz::math::GetY(models[joint_remaps[i]].cols[c]),
+          ozz::math::GetZ(models[joint_remaps[i]].cols[c]),
+          ozz::math::GetW(models[joint_remaps[i]].cols[c]));
+    }
+  }
+}
+
+TEST(Parallel, LocalToModel) {
+  // Builds a creature like skeleton: 2 roots, each with a spine of 6 joints
+  // that have 3 limbs of 20 joints each.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  for (RawSkeleton::Joint& root : raw_skeleton.roots) {
+    RawSkeleton::Joint* spine = &root;
+    for (int s = 0; s < 6; ++s) {
+      spine->children.resize(4);
+      for (int l = 1; l < 4; ++l) {
+        RawSkeleton::Joint* limb = &spine->children[l];
+        for (int j = 1; j < 20; ++j) {
+          limb->children.resize(1);
+          limb = &limb->children[0];
+        }
+      }
+      spine = &spine->children[0];
+    }
+  }
+  SkeletonBuilder builder;
+  ozz::unique_ptr<Skeleton> skeleton(builder(raw_skeleton));
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+  ASSERT_EQ(num_joints, 2 * (7 + 6 * 3 * 20));
+
+  ozz::vector<ozz::math::SoaTransform> input(skeleton->num_soa_joints());
+  FillLocals(make_span(input));
+  const ozz::math::Float4x4 root = ozz::math::Float4x4::Translation(
+      ozz::math::simd_float4::Load(4.f, 3.f, 2.f, 0.f));
+
+  // Serial reference.
+  ozz::vector<ozz::math::Float4x4> expected(num_joints);
+  ozz::vector<ozz::math::Float3x4> expected_affine(num_joints);
+  LocalToModelJob job;
+  job.skeleton = skeleton.get();
+  job.root = &root;
+  job.input = make_span(input);
+  job.output = make_span(expected);
+  ASSERT_TRUE(job.Run());
+  job.output = {};
+  job.affine_output = make_span(expected_affine);
+  ASSERT_TRUE(job.Run());
+
+  int tasks = 0;
+  job.parallel_for = &ReverseParallelFor;
+  job.parallel_for_user_data = &tasks;
+  job.parallel_grain = 0;
+  EXPECT_FALSE(job.Validate());
+
+  // Parallel conversion gives the same result, whatever the grain. Only
+  // grains smaller than the skeleton are split.
+  const int grains[] = {1, 7, 20, 64, 200, 1000};
+  for (size_t g = 0; g < OZZ_ARRAY_SIZE(grains); ++g) {
+    ozz::vector<ozz::math::Float4x4> output(num_joints);
+    ozz::vector<ozz::math::Float3x4> affine_output(num_joints);
+    job.parallel_grain = grains[g];
+    job.output = make_span(output);
+    job.affine_output = {};
+    tasks = 0;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(tasks > 1, grains[g] < num_joints);
+    EXPECT_EQ(memcmp(output.data(), expected.data(),
+                     sizeof(ozz::math::Float4x4) * num_joints),
+              0);
+
+    job.output = {};
+    job.affine_output = make_span(affine_output);
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(memcmp(affine_output.data(), expected_affine.data(),
+                     sizeof(ozz::math::Float3x4) * num_joints),
+              0);
+  }
+
+  // Partial updates are converted serially.
+  ozz::vector<ozz::math::Float4x4> output(expected);
+  job.parallel_grain = 1;
+  job.output = make_span(output);
+  job.affine_output = {};
+  job.from = 1;
+  tasks = 0;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(tasks, 0);
+  job.from = Skeleton::kNoParent;
+  const ozz::vector<uint8_t> dirty((num_joints + 7) / 8, 0xff);
+  job.dirty = make_span(dirty);
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(tasks, 0);
+  EXPECT_EQ(memcmp(output.data(), expected.data(),
+                   sizeof(ozz::math::Float4x4) * num_joints),
+            0);
+
+  // With a task scheduler.
+  ozz::WorkStealingScheduler scheduler(3);
+  ozz::vector<ozz::math::Float4x4> scheduled(num_joints);
+  job.dirty = {};
+  job.output = make_span(scheduled);
+  job.parallel_for = &ozz::TaskScheduler::ParallelForHook;
+  job.parallel_for_user_data = &scheduler;
+  job.parallel_grain = 16;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(memcmp(scheduled.data(), expected.data(),
+                   sizeof(ozz::math::Float4x4) * num_joints),
+            0);
+}
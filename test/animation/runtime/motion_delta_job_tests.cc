@@ -0,0 +1,180 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/motion_delta_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_track.h"
+#include "ozz/animation/offline/track_builder.h"
+#include "ozz/animation/runtime/track.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Float3Track;
+using ozz::animation::MotionDeltaJob;
+using ozz::animation::QuaternionTrack;
+using ozz::animation::offline::RawFloat3Track;
+using ozz::animation::offline::RawQuaternionTrack;
+using ozz::animation::offline::RawTrackInterpolation;
+using ozz::animation::offline::TrackBuilder;
+
+namespace {
+// Motion moving 4 units forward (z), while turning a quarter around y.
+struct Motion {
+  Motion() {
+    RawFloat3Track raw_position;
+    const RawFloat3Track::Keyframe p0 = {RawTrackInterpolation::kLinear, 0.f,
+                                         ozz::math::Float3::zero()};
+    const RawFloat3Track::Keyframe p1 = {RawTrackInterpolation::kLinear, 1.f,
+                                         ozz::math::Float3(0.f, 0.f, 4.f)};
+    raw_position.keyframes.push_back(p0);
+    raw_position.keyframes.push_back(p1);
+
+    RawQuaternionTrack raw_rotation;
+    const RawQuaternionTrack::Keyframe r0 = {
+        RawTrackInterpolation::kLinear, 0.f,
+        ozz::math::Quaternion::identity()};
+    const RawQuaternionTrack::Keyframe r1 = {
+        RawTrackInterpolation::kLinear, 1.f,
+        ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                             ozz::math::kPi_2)};
+    raw_rotation.keyframes.push_back(r0);
+    raw_rotation.keyframes.push_back(r1);
+
+    TrackBuilder builder;
+    position = builder(raw_position);
+    rotation = builder(raw_rotation);
+  }
+  ozz::unique_ptr<Float3Track> position;
+  ozz::unique_ptr<QuaternionTrack> rotation;
+};
+}  // namespace
+
+TEST(JobValidity, MotionDeltaJob) {
+  const Motion motion;
+  ozz::math::Transform delta;
+
+  MotionDeltaJob job;
+  EXPECT_FALSE(job.Validate());
+  EXPECT_FALSE(job.Run());
+
+  job.position = motion.position.get();
+  EXPECT_FALSE(job.Validate());
+
+  job.delta = &delta;
+  EXPECT_TRUE(job.Validate());
+  EXPECT_TRUE(job.Run());
+
+  job.rotation = motion.rotation.get();
+  EXPECT_TRUE(job.Validate());
+  EXPECT_TRUE(job.Run());
+}
+
+TEST(Translation, MotionDeltaJob) {
+  const Motion motion;
+  ozz::math::Transform delta;
+
+  MotionDeltaJob job;
+  job.position = motion.position.get();
+  job.delta = &delta;
+
+  job.from = .25f;
+  job.to = .75f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 0.f, 0.f, 2.f);
+  EXPECT_QUATERNION_EQ(delta.rotation, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_FLOAT3_EQ(delta.scale, 1.f, 1.f, 1.f);
+
+  // Backward.
+  job.from = .75f;
+  job.to = .25f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 0.f, 0.f, -2.f);
+
+  // Loops forward.
+  job.loops = 1;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 0.f, 0.f, 2.f);
+  job.loops = 3;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 0.f, 0.f, 10.f);
+
+  // Loops backward.
+  job.from = .25f;
+  job.to = .75f;
+  job.loops = -1;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 0.f, 0.f, -2.f);
+
+  // Clamps ratios.
+  job.from = -1.f;
+  job.to = 2.f;
+  job.loops = 0;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 0.f, 0.f, 4.f);
+}
+
+TEST(Rotation, MotionDeltaJob) {
+  const Motion motion;
+  ozz::math::Transform delta;
+
+  MotionDeltaJob job;
+  job.position = motion.position.get();
+  job.rotation = motion.rotation.get();
+  job.delta = &delta;
+
+  // Whole animation.
+  job.from = 0.f;
+  job.to = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 0.f, 0.f, 4.f);
+  const ozz::math::Quaternion quarter = ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float3::y_axis(), ozz::math::kPi_2);
+  EXPECT_QUATERNION_EQ(delta.rotation, quarter.x, quarter.y, quarter.z,
+                       quarter.w);
+
+  // Delta is expressed in the motion frame at "from".
+  job.from = .5f;
+  ASSERT_TRUE(job.Run());
+  const ozz::math::Float3 forward = TransformVector(
+      Conjugate(ozz::math::Quaternion::FromAxisAngle(
+          ozz::math::Float3::y_axis(), ozz::math::kPi_4)),
+      ozz::math::Float3(0.f, 0.f, 2.f));
+  EXPECT_FLOAT3_EQ(delta.translation, forward.x, forward.y, forward.z);
+
+  // Two whole cycles, the second one being rotated by the first.
+  job.from = 0.f;
+  job.to = 0.f;
+  job.loops = 2;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(delta.translation, 4.f, 0.f, 4.f);
+  const ozz::math::Quaternion half = ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float3::y_axis(), ozz::math::kPi);
+  EXPECT_QUATERNION_EQ(delta.rotation, half.x, half.y, half.z, half.w);
+}
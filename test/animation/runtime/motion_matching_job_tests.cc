@@ -0,0 +1,206 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/motion_matching_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/feature_database_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/offline/synthetic_generator.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/feature_database.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::FeatureDatabase;
+using ozz::animation::MotionMatchingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::FeatureDatabaseBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+using ozz::animation::offline::SyntheticAnimationGenerator;
+using ozz::animation::offline::SyntheticSkeletonGenerator;
+
+namespace {
+// Builds a database from synthetic clips of a 16 joints skeleton.
+ozz::unique_ptr<FeatureDatabase> BuildDatabase() {
+  RawSkeleton raw_skeleton;
+  SyntheticSkeletonGenerator skeleton_generator;
+  skeleton_generator.num_joints = 16;
+  if (!skeleton_generator(&raw_skeleton)) {
+    return nullptr;
+  }
+  const ozz::unique_ptr<Skeleton> skeleton = SkeletonBuilder()(raw_skeleton);
+  if (!skeleton) {
+    return nullptr;
+  }
+
+  ozz::vector<ozz::unique_ptr<Animation>> animations;
+  ozz::vector<const Animation*> clips;
+  for (int i = 0; i < 4; ++i) {
+    SyntheticAnimationGenerator generator;
+    generator.seed = i;
+    generator.amplitude = .3f + i * .2f;
+    RawAnimation raw_animation;
+    if (!generator(raw_skeleton, &raw_animation)) {
+      return nullptr;
+    }
+    animations.push_back(AnimationBuilder()(raw_animation));
+    if (!animations.back()) {
+      return nullptr;
+    }
+    clips.push_back(animations.back().get());
+  }
+
+  FeatureDatabaseBuilder builder;
+  const int joints[] = {5, 10, 15};
+  for (const int joint : joints) {
+    const FeatureDatabaseBuilder::JointFeature feature = {joint, 1.f, .5f};
+    builder.joints.push_back(feature);
+  }
+  builder.trajectory_times.push_back(.2f);
+  builder.trajectory_times.push_back(.4f);
+  return builder(*skeleton, make_span(clips));
+}
+}  // namespace
+
+TEST(JobValidity, MotionMatchingJob) {
+  const ozz::unique_ptr<FeatureDatabase> database = BuildDatabase();
+  ASSERT_TRUE(database);
+  ozz::vector<float> query(database->num_features());
+  MotionMatchingJob::Match match;
+
+  {  // Default is invalid.
+    MotionMatchingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Empty database.
+    const FeatureDatabase empty;
+    MotionMatchingJob job;
+    job.database = &empty;
+    job.query = make_span(query);
+    job.output = &match;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Query too small.
+    MotionMatchingJob job;
+    job.database = database.get();
+    job.query = make_span(query).first(query.size() - 1);
+    job.output = &match;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // No output.
+    MotionMatchingJob job;
+    job.database = database.get();
+    job.query = make_span(query);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid.
+    MotionMatchingJob job;
+    job.database = database.get();
+    job.query = make_span(query);
+    job.output = &match;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    EXPECT_GE(match.frame, 0);
+    EXPECT_LT(match.frame, database->num_frames());
+  }
+}
+
+TEST(Match, MotionMatchingJob) {
+  const ozz::unique_ptr<FeatureDatabase> database = BuildDatabase();
+  ASSERT_TRUE(database);
+  ozz::vector<float> query(database->num_features());
+
+  MotionMatchingJob job;
+  job.database = database.get();
+  job.query = make_span(query);
+  MotionMatchingJob::Match match;
+  job.output = &match;
+
+  // Frames features find themselves.
+  for (int frame = 0; frame < database->num_frames(); frame += 7) {
+    ASSERT_TRUE(database->GetFeatures(frame, make_span(query)));
+    for (int accelerate = 0; accelerate < 2; ++accelerate) {
+      job.accelerate = accelerate != 0;
+      ASSERT_TRUE(job.Run());
+      EXPECT_EQ(match.frame, frame);
+      EXPECT_NEAR(match.cost, 0.f, 1e-5f);
+      EXPECT_EQ(match.clip, database->clip(frame));
+      EXPECT_FLOAT_EQ(match.ratio, database->ratio(frame));
+    }
+  }
+}
+
+TEST(Accelerate, MotionMatchingJob) {
+  const ozz::unique_ptr<FeatureDatabase> database = BuildDatabase();
+  ASSERT_TRUE(database);
+  const int num_features = database->num_features();
+  ozz::vector<float> query(num_features);
+
+  MotionMatchingJob job;
+  job.database = database.get();
+  job.query = make_span(query);
+  MotionMatchingJob::Match brute, accelerated;
+
+  // Queries are frames features, moved in pseudo random directions.
+  uint32_t seed = 0;
+  for (int i = 0; i < 64; ++i) {
+    const int frame = (i * 37) % database->num_frames();
+    ASSERT_TRUE(database->GetFeatures(frame, make_span(query)));
+    for (float& value : query) {
+      seed = seed * 1664525u + 1013904223u;
+      value += (static_cast<float>(seed >> 8) / (1 << 24) - .5f) * i * .05f;
+    }
+
+    job.accelerate = false;
+    job.output = &brute;
+    ASSERT_TRUE(job.Run());
+
+    job.accelerate = true;
+    job.output = &accelerated;
+    ASSERT_TRUE(job.Run());
+
+    EXPECT_EQ(brute.frame, accelerated.frame);
+    EXPECT_FLOAT_EQ(brute.cost, accelerated.cost);
+  }
+}
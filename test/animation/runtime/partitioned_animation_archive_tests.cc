@@ -0,0 +1,112 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/partitioned_animation.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/partitioned_animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::PartitionedAnimation;
+using ozz::animation::offline::PartitionedAnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+TEST(Empty, PartitionedAnimationSerialize) {
+  ozz::io::MemoryStream stream;
+
+  // Streams out.
+  ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+
+  PartitionedAnimation o_animation;
+  o << o_animation;
+
+  // Streams in.
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+
+  PartitionedAnimation i_animation;
+  i >> i_animation;
+
+  EXPECT_EQ(o_animation.num_tracks(), i_animation.num_tracks());
+  EXPECT_EQ(i_animation.num_partitions(), 0);
+}
+
+TEST(Filled, PartitionedAnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 5.f;
+  raw_animation.name = "partitioned";
+  raw_animation.tracks.resize(11);
+  for (int i = 0; i <= 10; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i * .5f, ozz::math::Float3(i * 1.f, 0.f, 0.f)};
+    raw_animation.tracks[i].translations.push_back(key);
+  }
+
+  PartitionedAnimationBuilder builder;
+  builder.partition_tracks = 4;
+  ozz::unique_ptr<PartitionedAnimation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+  ASSERT_EQ(o_animation->num_partitions(), 3);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    PartitionedAnimation i_animation;
+    i >> i_animation;
+
+    // The whole stream was read.
+    EXPECT_EQ(static_cast<size_t>(stream.Tell()), stream.Size());
+
+    EXPECT_FLOAT_EQ(i_animation.duration(), o_animation->duration());
+    EXPECT_EQ(i_animation.num_tracks(), o_animation->num_tracks());
+    EXPECT_EQ(i_animation.partition_soa_tracks(),
+              o_animation->partition_soa_tracks());
+    EXPECT_STREQ(i_animation.name(), o_animation->name());
+    ASSERT_EQ(i_animation.num_partitions(), o_animation->num_partitions());
+    EXPECT_EQ(i_animation.size(), o_animation->size());
+    for (int p = 0; p < i_animation.num_partitions(); ++p) {
+      EXPECT_FLOAT_EQ(i_animation.partition(p).duration(),
+                      o_animation->partition(p).duration());
+      EXPECT_EQ(i_animation.partition(p).num_tracks(),
+                o_animation->partition(p).num_tracks());
+      EXPECT_EQ(i_animation.partition(p).size(),
+                o_animation->partition(p).size());
+    }
+  }
+}
@@ -0,0 +1,209 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/partitioned_sampling_job.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/partitioned_animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/partitioned_animation.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/gtest_parallel_for_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+#include "ozz/base/task_scheduler.h"
+
+using ozz::animation::Animation;
+using ozz::animation::PartitionedAnimation;
+using ozz::animation::PartitionedSamplingJob;
+using ozz::animation::SamplingJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::PartitionedAnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+
+namespace {
+// Builds a raw animation whose tracks all have different keys.
+void BuildRawAnimation(int _num_tracks, RawAnimation* _raw) {
+  _raw->duration = 2.f;
+  _raw->tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = _raw->tracks[i];
+    for (int k = 0; k <= i % 5; ++k) {
+      const float time = k * _raw->duration / (i % 5 + 1);
+      const RawAnimation::TranslationKey t = {
+          time, ozz::math::Float3(i * 1.f, k * 2.f, -i * .5f)};
+      track.translations.push_back(t);
+      const RawAnimation::RotationKey r = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::y_axis(), i * .1f + k * .3f)};
+      track.rotations.push_back(r);
+      const RawAnimation::ScaleKey s = {
+          time, ozz::math::Float3(1.f + k * .1f, 1.f, 1.f + i * .01f)};
+      track.scales.push_back(s);
+    }
+  }
+}
+}  // namespace
+
+TEST(JobValidity, PartitionedSamplingJob) {
+  RawAnimation raw;
+  BuildRawAnimation(37, &raw);
+  PartitionedAnimationBuilder builder;
+  builder.partition_tracks = 8;
+  ozz::unique_ptr<PartitionedAnimation> animation = builder(raw);
+  ASSERT_TRUE(animation);
+  ASSERT_EQ(animation->num_partitions(), 5);
+
+  SamplingJob::ContextBank bank(5, 8);
+  SamplingJob::ContextBank small_bank(5, 4);
+  ozz::vector<ozz::math::SoaTransform> output(animation->num_soa_tracks());
+
+  {  // Empty/default job.
+    PartitionedSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Missing contexts.
+    PartitionedSamplingJob job;
+    job.animation = animation.get();
+    job.contexts = bank.contexts().first(4);
+    job.output = make_span(output);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Contexts too small.
+    PartitionedSamplingJob job;
+    job.animation = animation.get();
+    job.contexts = small_bank.contexts();
+    job.output = make_span(output);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Output too small.
+    PartitionedSamplingJob job;
+    job.animation = animation.get();
+    job.contexts = bank.contexts();
+    job.output = make_span(output).first(output.size() - 1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid.
+    PartitionedSamplingJob job;
+    job.animation = animation.get();
+    job.contexts = bank.contexts();
+    job.output = make_span(output);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid, empty animation.
+    PartitionedAnimation empty;
+    PartitionedSamplingJob job;
+    job.animation = &empty;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Sampling, PartitionedSamplingJob) {
+  const int num_tracks = 37;
+  RawAnimation raw;
+  BuildRawAnimation(num_tracks, &raw);
+
+  AnimationBuilder animation_builder;
+  ozz::unique_ptr<Animation> reference = animation_builder(raw);
+  ASSERT_TRUE(reference);
+
+  // Partition size is rounded up to a multiple of 4.
+  PartitionedAnimationBuilder builder;
+  builder.partition_tracks = 6;
+  ozz::unique_ptr<PartitionedAnimation> animation = builder(raw);
+  ASSERT_TRUE(animation);
+  ASSERT_EQ(animation->num_partitions(), 5);
+  ASSERT_EQ(animation->num_soa_tracks(), reference->num_soa_tracks());
+
+  SamplingJob::Context reference_context(num_tracks);
+  SamplingJob::ContextBank serial_bank(animation->num_partitions(), 8);
+  SamplingJob::ContextBank parallel_bank(animation->num_partitions(), 8);
+  ozz::WorkStealingScheduler scheduler(3);
+  SamplingJob::ContextBank scheduled_bank(animation->num_partitions(), 8);
+
+  const size_t num_soa_tracks = reference->num_soa_tracks();
+  ozz::vector<ozz::math::SoaTransform> expected(num_soa_tracks);
+  ozz::vector<ozz::math::SoaTransform> serial(num_soa_tracks);
+  ozz::vector<ozz::math::SoaTransform> parallel(num_soa_tracks);
+  ozz::vector<ozz::math::SoaTransform> scheduled(num_soa_tracks);
+
+  // Forward, then backward to also test context rewinding.
+  const float ratios[] = {0.f, .1f, .33f, .5f, .9f, 1.f, .7f, .2f, 0.f};
+  for (float ratio : ratios) {
+    SamplingJob reference_job;
+    reference_job.ratio = ratio;
+    reference_job.animation = reference.get();
+    reference_job.context = &reference_context;
+    reference_job.output = make_span(expected);
+    ASSERT_TRUE(reference_job.Run());
+
+    PartitionedSamplingJob job;
+    job.ratio = ratio;
+    job.animation = animation.get();
+    job.contexts = serial_bank.contexts();
+    job.output = make_span(serial);
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(memcmp(serial.data(), expected.data(),
+                     sizeof(ozz::math::SoaTransform) * num_soa_tracks),
+              0);
+
+    int tasks = 0;
+    job.contexts = parallel_bank.contexts();
+    job.output = make_span(parallel);
+    job.parallel_for = &ReverseParallelFor;
+    job.parallel_for_user_data = &tasks;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(tasks, animation->num_partitions());
+    EXPECT_EQ(memcmp(parallel.data(), expected.data(),
+                     sizeof(ozz::math::SoaTransform) * num_soa_tracks),
+              0);
+
+    job.contexts = scheduled_bank.contexts();
+    job.output = make_span(scheduled);
+    job.parallel_for = &ozz::TaskScheduler::ParallelForHook;
+    job.parallel_for_user_data = &scheduler;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(memcmp(scheduled.data(), expected.data(),
+                     sizeof(ozz::math::SoaTransform) * num_soa_tracks),
+              0);
+  }
+}
@@ -0,0 +1,170 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/pose_buffer.h"
+
+#include <string>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::PoseBuffer;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton of _num_joints joints.
+ozz::unique_ptr<Skeleton> BuildSkeleton(int _num_joints) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(_num_joints);
+  for (int i = 0; i < _num_joints; ++i) {
+    raw_skeleton.roots[i].name = std::to_string(i).c_str();
+  }
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+// Fills all _pose matrices translation with _value.
+void FillPose(ozz::span<ozz::math::Float4x4> _pose, float _value) {
+  for (ozz::math::Float4x4& matrix : _pose) {
+    matrix = ozz::math::Float4x4::Translation(
+        ozz::math::simd_float4::Load1(_value));
+  }
+}
+
+// Gets the first matrix x translation of _pose.
+float PoseValue(ozz::span<const ozz::math::Float4x4> _pose) {
+  return ozz::math::GetX(_pose[0].cols[3]);
+}
+}  // namespace
+
+TEST(Empty, PoseBuffer) {
+  PoseBuffer buffer;
+  EXPECT_EQ(buffer.num_joints(), 0);
+  EXPECT_TRUE(buffer.back().empty());
+  EXPECT_TRUE(buffer.front().empty());
+  buffer.Publish();
+  EXPECT_FALSE(buffer.Acquire());
+  EXPECT_TRUE(buffer.front().empty());
+
+  EXPECT_FALSE(buffer.Allocate(Skeleton()));
+  EXPECT_EQ(buffer.num_joints(), 0);
+}
+
+TEST(Exchange, PoseBuffer) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton(7);
+  ASSERT_TRUE(skeleton);
+
+  PoseBuffer buffer;
+  ASSERT_TRUE(buffer.Allocate(*skeleton));
+  EXPECT_EQ(buffer.num_joints(), 7);
+  ASSERT_EQ(buffer.back().size(), 7u);
+
+  // Buffers are aligned to a cache line.
+  EXPECT_TRUE(ozz::IsAligned(buffer.back().data(), 64));
+
+  // Nothing published yet.
+  EXPECT_FALSE(buffer.Acquire());
+  EXPECT_TRUE(buffer.front().empty());
+
+  FillPose(buffer.back(), 1.f);
+  const ozz::math::Float4x4* first = buffer.back().data();
+  buffer.Publish();
+  EXPECT_NE(buffer.back().data(), first);
+
+  // Acquires published pose, without copy.
+  EXPECT_TRUE(buffer.Acquire());
+  ASSERT_EQ(buffer.front().size(), 7u);
+  EXPECT_EQ(buffer.front().data(), first);
+  EXPECT_FLOAT_EQ(PoseValue(buffer.front()), 1.f);
+
+  // Nothing new, front is unchanged.
+  EXPECT_FALSE(buffer.Acquire());
+  EXPECT_FLOAT_EQ(PoseValue(buffer.front()), 1.f);
+
+  // Writer never gets the buffer the reader holds.
+  for (int i = 2; i < 6; ++i) {
+    EXPECT_NE(buffer.back().data(), buffer.front().data());
+    FillPose(buffer.back(), static_cast<float>(i));
+    buffer.Publish();
+  }
+
+  // Only the latest pose is acquired, others are skipped.
+  EXPECT_TRUE(buffer.Acquire());
+  EXPECT_FLOAT_EQ(PoseValue(buffer.front()), 5.f);
+  EXPECT_FALSE(buffer.Acquire());
+
+  // Deallocation resets the buffer.
+  buffer.Deallocate();
+  EXPECT_TRUE(buffer.back().empty());
+  EXPECT_TRUE(buffer.front().empty());
+}
+
+TEST(Threaded, PoseBuffer) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton(32);
+  ASSERT_TRUE(skeleton);
+
+  PoseBuffer buffer;
+  ASSERT_TRUE(buffer.Allocate(*skeleton));
+
+  // Writer publishes increasing values, reader checks acquired poses are
+  // never torn and never go backward.
+  const int kNumFrames = 20000;
+  std::thread writer([&buffer]() {
+    for (int i = 1; i <= kNumFrames; ++i) {
+      FillPose(buffer.back(), static_cast<float>(i));
+      buffer.Publish();
+    }
+  });
+
+  float last = 0.f;
+  bool torn = false;
+  bool backward = false;
+  while (last < kNumFrames) {
+    if (!buffer.Acquire()) {
+      std::this_thread::yield();
+      continue;
+    }
+    const ozz::span<const ozz::math::Float4x4> pose = buffer.front();
+    const float value = PoseValue(pose);
+    for (const ozz::math::Float4x4& matrix : pose) {
+      torn |= ozz::math::GetX(matrix.cols[3]) != value;
+    }
+    backward |= value <= last;
+    last = value;
+  }
+  writer.join();
+
+  EXPECT_FALSE(torn);
+  EXPECT_FALSE(backward);
+  EXPECT_FLOAT_EQ(last, static_cast<float>(kNumFrames));
+}
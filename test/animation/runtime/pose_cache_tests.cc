@@ -0,0 +1,239 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/pose_cache.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::PoseCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 3 joints chain skeleton.
+ozz::unique_ptr<Skeleton> BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "j0";
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].name = "j1";
+  raw_skeleton.roots[0].children[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].children[0].name = "j2";
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+// Builds an animation of _num_tracks tracks, translating along x from 0 to
+// _x.
+ozz::unique_ptr<Animation> BuildAnimation(int _num_tracks, float _x) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    const RawAnimation::TranslationKey first = {0.f, ozz::math::Float3::zero()};
+    const RawAnimation::TranslationKey last = {
+        1.f, ozz::math::Float3(_x, 0.f, 0.f)};
+    raw_animation.tracks[i].translations.push_back(first);
+    raw_animation.tracks[i].translations.push_back(last);
+  }
+  return AnimationBuilder()(raw_animation);
+}
+
+// Checks that _cache entry _entry matches _animation sampled at _ratio.
+void ExpectPose(const PoseCache& _cache, int _entry,
+                const Animation& _animation, const Skeleton& _skeleton,
+                float _ratio) {
+  SamplingJob::Context context(_animation.num_tracks());
+  ozz::math::SoaTransform locals[1];
+  ozz::math::Float4x4 models[3];
+
+  SamplingJob sampling_job;
+  sampling_job.animation = &_animation;
+  sampling_job.context = &context;
+  sampling_job.ratio = _ratio;
+  sampling_job.output = locals;
+  ASSERT_TRUE(sampling_job.Run());
+
+  ASSERT_EQ(_cache.locals(_entry).size(), 1u);
+  EXPECT_EQ(std::memcmp(_cache.locals(_entry).data(), locals, sizeof(locals)),
+            0);
+
+  if (!_cache.models(_entry).empty()) {
+    LocalToModelJob ltm_job;
+    ltm_job.skeleton = &_skeleton;
+    ltm_job.input = locals;
+    ltm_job.output = models;
+    ASSERT_TRUE(ltm_job.Run());
+    ASSERT_EQ(_cache.models(_entry).size(), 3u);
+    EXPECT_EQ(
+        std::memcmp(_cache.models(_entry).data(), models, sizeof(models)), 0);
+  }
+}
+}  // namespace
+
+TEST(Allocate, PoseCache) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ozz::unique_ptr<Skeleton> empty_skeleton = SkeletonBuilder()(RawSkeleton());
+  ozz::unique_ptr<Animation> animation = BuildAnimation(3, 1.f);
+  ASSERT_TRUE(skeleton && empty_skeleton && animation);
+
+  PoseCache cache;
+  EXPECT_EQ(cache.capacity(), 0);
+  EXPECT_EQ(cache.num_entries(), 0);
+  EXPECT_EQ(cache.Request(*animation, 0.f), -1);
+  EXPECT_TRUE(cache.Evaluate());
+
+  EXPECT_FALSE(cache.Allocate(*skeleton, 0, true));
+  EXPECT_FALSE(cache.Allocate(*empty_skeleton, 4, true));
+  EXPECT_EQ(cache.capacity(), 0);
+
+  EXPECT_TRUE(cache.Allocate(*skeleton, 4, true));
+  EXPECT_EQ(cache.capacity(), 4);
+  EXPECT_EQ(cache.num_entries(), 0);
+  EXPECT_EQ(cache.Request(*animation, 0.f), 0);
+
+  cache.Deallocate();
+  EXPECT_EQ(cache.capacity(), 0);
+  EXPECT_EQ(cache.Request(*animation, 0.f), -1);
+}
+
+TEST(Share, PoseCache) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ozz::unique_ptr<Animation> animation1 = BuildAnimation(3, 1.f);
+  ozz::unique_ptr<Animation> animation2 = BuildAnimation(3, 2.f);
+  ozz::unique_ptr<Animation> bad_animation = BuildAnimation(2, 1.f);
+  ASSERT_TRUE(skeleton && animation1 && animation2 && bad_animation);
+
+  for (int model_space = 0; model_space < 2; ++model_space) {
+    PoseCache cache;
+    ASSERT_TRUE(cache.Allocate(*skeleton, 4, model_space != 0));
+
+    for (int frame = 0; frame < 3; ++frame) {
+      cache.Clear();
+      EXPECT_EQ(cache.num_entries(), 0);
+      EXPECT_EQ(cache.hits(), 0);
+
+      // Lockstep instances, with a phase offset.
+      const float ratio = .1f * frame;
+      const Animation* animations[] = {animation1.get(), animation1.get(),
+                                       animation1.get(), animation2.get(),
+                                       animation1.get(), animation2.get()};
+      const float ratios[] = {ratio, ratio + .5f, ratio,
+                              ratio, ratio + .5f, ratio};
+      const int expected[] = {0, 1, 0, 2, 1, 2};
+      for (int i = 0; i < 6; ++i) {
+        EXPECT_EQ(cache.Request(*animations[i], ratios[i]), expected[i]);
+      }
+      EXPECT_EQ(cache.num_entries(), 3);
+      EXPECT_EQ(cache.hits(), 3);
+
+      // Tracks don't match skeleton.
+      EXPECT_EQ(cache.Request(*bad_animation, ratio), -1);
+
+      ASSERT_TRUE(cache.Evaluate());
+      EXPECT_EQ(cache.models(0).empty(), model_space == 0);
+      ExpectPose(cache, 0, *animation1, *skeleton, ratio);
+      ExpectPose(cache, 1, *animation1, *skeleton, ratio + .5f);
+      ExpectPose(cache, 2, *animation2, *skeleton, ratio);
+      EXPECT_FLOAT_EQ(cache.ratio(1), ratio + .5f);
+
+      // Fills the cache, after evaluation.
+      EXPECT_EQ(cache.Request(*animation2, .9f), 3);
+      EXPECT_EQ(cache.Request(*animation2, .95f), -1);
+      EXPECT_EQ(cache.Request(*animation1, ratio), 0);
+      ASSERT_TRUE(cache.Evaluate());
+      ExpectPose(cache, 3, *animation2, *skeleton, .9f);
+    }
+
+    // Invalid entries.
+    EXPECT_TRUE(cache.locals(-1).empty());
+    EXPECT_TRUE(cache.locals(4).empty());
+    EXPECT_TRUE(cache.models(4).empty());
+  }
+}
+
+TEST(Quantization, PoseCache) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ozz::unique_ptr<Animation> animation = BuildAnimation(3, 1.f);
+  ASSERT_TRUE(skeleton && animation);
+
+  PoseCache cache;
+  ASSERT_TRUE(cache.Allocate(*skeleton, 8, true));
+
+  cache.set_ratio_step(-1.f);
+  EXPECT_FLOAT_EQ(cache.ratio_step(), 0.f);
+
+  // Exact ratios.
+  EXPECT_EQ(cache.Request(*animation, .2f), 0);
+  EXPECT_EQ(cache.Request(*animation, .21f), 1);
+  EXPECT_EQ(cache.Request(*animation, -1.f), 2);
+  EXPECT_EQ(cache.Request(*animation, 0.f), 2);
+
+  // Changing step clears the cache.
+  cache.set_ratio_step(.25f);
+  EXPECT_FLOAT_EQ(cache.ratio_step(), .25f);
+  EXPECT_EQ(cache.num_entries(), 0);
+
+  EXPECT_EQ(cache.Request(*animation, .2f), 0);
+  EXPECT_EQ(cache.Request(*animation, .3f), 0);
+  EXPECT_EQ(cache.Request(*animation, .375f), 1);
+  EXPECT_EQ(cache.Request(*animation, 1.f), 2);
+  EXPECT_EQ(cache.Request(*animation, 2.f), 2);
+  EXPECT_EQ(cache.hits(), 2);
+  EXPECT_FLOAT_EQ(cache.ratio(0), .25f);
+  EXPECT_FLOAT_EQ(cache.ratio(1), .5f);
+  EXPECT_FLOAT_EQ(cache.ratio(2), 1.f);
+
+  // Poses are sampled at quantized ratios.
+  ASSERT_TRUE(cache.Evaluate());
+  ExpectPose(cache, 0, *animation, *skeleton, .25f);
+  ExpectPose(cache, 1, *animation, *skeleton, .5f);
+  ExpectPose(cache, 2, *animation, *skeleton, 1.f);
+
+  // Last step is clamped.
+  cache.set_ratio_step(.3f);
+  EXPECT_EQ(cache.Request(*animation, 1.f), 0);
+  EXPECT_FLOAT_EQ(cache.ratio(0), .9f);
+}
@@ -0,0 +1,291 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/pose_codec.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::PoseDecodeJob;
+using ozz::animation::PoseEncodeJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 5 joints chain skeleton, with non identity rest poses.
+ozz::unique_ptr<Skeleton> BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* joint = &raw_skeleton.roots[0];
+  for (int i = 0; i < 5; ++i) {
+    joint->name = "joint";
+    joint->transform.translation =
+        ozz::math::Float3(1.f + i, -2.f * i, .5f);
+    joint->transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+        ozz::math::Float3::y_axis(), .3f * i);
+    joint->transform.scale = ozz::math::Float3(1.f + .5f * i);
+    if (i != 4) {
+      joint->children.resize(1);
+      joint = &joint->children[0];
+    }
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Extracts AoS transform of joint _index from a SoA pose.
+ozz::math::Transform GetTransform(
+    ozz::span<const ozz::math::SoaTransform> _pose, int _index) {
+  const ozz::math::SoaTransform& soa = _pose[_index / 4];
+  const int lane = _index & 3;
+  float values[10][4];
+  ozz::math::StorePtrU(soa.translation.x, values[0]);
+  ozz::math::StorePtrU(soa.translation.y, values[1]);
+  ozz::math::StorePtrU(soa.translation.z, values[2]);
+  ozz::math::StorePtrU(soa.rotation.x, values[3]);
+  ozz::math::StorePtrU(soa.rotation.y, values[4]);
+  ozz::math::StorePtrU(soa.rotation.z, values[5]);
+  ozz::math::StorePtrU(soa.rotation.w, values[6]);
+  ozz::math::StorePtrU(soa.scale.x, values[7]);
+  ozz::math::StorePtrU(soa.scale.y, values[8]);
+  ozz::math::StorePtrU(soa.scale.z, values[9]);
+  ozz::math::Transform transform;
+  transform.translation = ozz::math::Float3(values[0][lane], values[1][lane],
+                                            values[2][lane]);
+  transform.rotation = ozz::math::Quaternion(values[3][lane], values[4][lane],
+                                             values[5][lane], values[6][lane]);
+  transform.scale =
+      ozz::math::Float3(values[7][lane], values[8][lane], values[9][lane]);
+  return transform;
+}
+
+// Sets AoS transform of joint _index to a SoA pose.
+void SetTransform(ozz::span<ozz::math::SoaTransform> _pose, int _index,
+                  const ozz::math::Transform& _transform) {
+  ozz::math::SoaTransform& soa = _pose[_index / 4];
+  const int lane = _index & 3;
+  float values[10][4];
+  ozz::math::SimdFloat4* components[10] = {
+      &soa.translation.x, &soa.translation.y, &soa.translation.z,
+      &soa.rotation.x,    &soa.rotation.y,    &soa.rotation.z,
+      &soa.rotation.w,    &soa.scale.x,       &soa.scale.y,
+      &soa.scale.z};
+  const float aos[10] = {
+      _transform.translation.x, _transform.translation.y,
+      _transform.translation.z, _transform.rotation.x,
+      _transform.rotation.y,    _transform.rotation.z,
+      _transform.rotation.w,    _transform.scale.x,
+      _transform.scale.y,       _transform.scale.z};
+  for (int i = 0; i < 10; ++i) {
+    ozz::math::StorePtrU(*components[i], values[i]);
+    values[i][lane] = aos[i];
+    *components[i] = ozz::math::simd_float4::LoadPtrU(values[i]);
+  }
+}
+
+void ExpectTransformNear(const ozz::math::Transform& _expected,
+                         const ozz::math::Transform& _actual,
+                         float _tolerance) {
+  EXPECT_NEAR(_expected.translation.x, _actual.translation.x, _tolerance);
+  EXPECT_NEAR(_expected.translation.y, _actual.translation.y, _tolerance);
+  EXPECT_NEAR(_expected.translation.z, _actual.translation.z, _tolerance);
+  // q and -q are the same rotation.
+  const float dot = _expected.rotation.x * _actual.rotation.x +
+                    _expected.rotation.y * _actual.rotation.y +
+                    _expected.rotation.z * _actual.rotation.z +
+                    _expected.rotation.w * _actual.rotation.w;
+  EXPECT_NEAR(std::abs(dot), 1.f, _tolerance);
+  EXPECT_NEAR(_expected.scale.x, _actual.scale.x, _tolerance);
+  EXPECT_NEAR(_expected.scale.y, _actual.scale.y, _tolerance);
+  EXPECT_NEAR(_expected.scale.z, _actual.scale.z, _tolerance);
+}
+}  // namespace
+
+TEST(JobValidity, PoseCodec) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+  EXPECT_EQ(PoseEncodeJob::MaxEncodedSize(num_joints), 2u + 18u * 5u);
+
+  ozz::math::SoaTransform pose[2] = {ozz::math::SoaTransform::identity(),
+                                     ozz::math::SoaTransform::identity()};
+  ozz::vector<ozz::byte> buffer(PoseEncodeJob::MaxEncodedSize(num_joints));
+  size_t size;
+
+  {  // Default jobs.
+    PoseEncodeJob encode;
+    EXPECT_FALSE(encode.Validate());
+    EXPECT_FALSE(encode.Run());
+    PoseDecodeJob decode;
+    EXPECT_FALSE(decode.Validate());
+    EXPECT_FALSE(decode.Run());
+  }
+
+  {  // Valid encode job.
+    PoseEncodeJob encode;
+    encode.skeleton = skeleton.get();
+    encode.input = pose;
+    encode.output = make_span(buffer);
+    encode.size = &size;
+    EXPECT_TRUE(encode.Validate());
+
+    // Missing size.
+    encode.size = nullptr;
+    EXPECT_FALSE(encode.Validate());
+    encode.size = &size;
+
+    // Input too small.
+    encode.input = ozz::span<const ozz::math::SoaTransform>(pose, 1);
+    EXPECT_FALSE(encode.Validate());
+    encode.input = pose;
+
+    // Output too small.
+    encode.output = ozz::span<ozz::byte>(buffer.data(), buffer.size() - 1);
+    EXPECT_FALSE(encode.Validate());
+    encode.output = make_span(buffer);
+
+    // Negative tolerances.
+    encode.translation_tolerance = -1.f;
+    EXPECT_FALSE(encode.Validate());
+    encode.translation_tolerance = 0.f;
+    encode.scale_tolerance = -1.f;
+    EXPECT_FALSE(encode.Validate());
+    encode.scale_tolerance = 0.f;
+    EXPECT_TRUE(encode.Validate());
+    EXPECT_TRUE(encode.Run());
+  }
+
+  {  // Decode job.
+    PoseDecodeJob decode;
+    decode.skeleton = skeleton.get();
+    decode.input = ozz::span<const ozz::byte>(buffer.data(), size);
+    decode.output = ozz::span<ozz::math::SoaTransform>(pose, 1);
+    EXPECT_FALSE(decode.Validate());
+    decode.output = pose;
+    EXPECT_TRUE(decode.Validate());
+    EXPECT_TRUE(decode.Run());
+  }
+}
+
+TEST(RoundTrip, PoseCodec) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+
+  // Builds a pose that differs from rest pose on all components, and covers
+  // all rotation largest component cases.
+  ozz::math::SoaTransform input[2];
+  const ozz::math::Float3 axes[] = {
+      ozz::math::Float3::x_axis(), ozz::math::Float3::y_axis(),
+      ozz::math::Float3::z_axis(), ozz::math::Float3(1.f, -1.f, 1.f)};
+  const float angles[] = {3.f, -2.8f, 2.9f, .7f, -1.2f};
+  for (int i = 0; i < num_joints; ++i) {
+    ozz::math::Transform transform;
+    transform.translation = ozz::math::Float3(.1f * i, 3.f, -5.f + i);
+    transform.rotation = ozz::math::Quaternion::FromAxisAngle(
+        Normalize(axes[i % 4]), angles[i]);
+    transform.scale = ozz::math::Float3(2.f, .5f, 1.f + i);
+    SetTransform(input, i, transform);
+  }
+
+  ozz::vector<ozz::byte> buffer(PoseEncodeJob::MaxEncodedSize(num_joints));
+  size_t size = 0;
+  PoseEncodeJob encode;
+  encode.skeleton = skeleton.get();
+  encode.input = input;
+  encode.output = make_span(buffer);
+  encode.size = &size;
+  ASSERT_TRUE(encode.Run());
+  EXPECT_EQ(size, buffer.size());
+
+  ozz::math::SoaTransform output[2];
+  PoseDecodeJob decode;
+  decode.skeleton = skeleton.get();
+  decode.input = ozz::span<const ozz::byte>(buffer.data(), size);
+  decode.output = output;
+  ASSERT_TRUE(decode.Run());
+
+  for (int i = 0; i < num_joints; ++i) {
+    ExpectTransformNear(GetTransform(input, i), GetTransform(output, i),
+                        5e-3f);
+  }
+
+  // Truncated stream.
+  decode.input = ozz::span<const ozz::byte>(buffer.data(), size - 1);
+  EXPECT_FALSE(decode.Run());
+  decode.input = ozz::span<const ozz::byte>(buffer.data(), 1);
+  EXPECT_FALSE(decode.Run());
+}
+
+TEST(RestPose, PoseCodec) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+
+  // Rest pose, with a rotation and a translation change on joint 2.
+  ozz::math::SoaTransform input[2];
+  input[0] = skeleton->joint_rest_poses()[0];
+  input[1] = skeleton->joint_rest_poses()[1];
+  ozz::math::Transform transform = GetTransform(input, 2);
+  transform.translation.y += 1.f;
+  transform.rotation =
+      transform.rotation * ozz::math::Quaternion::FromAxisAngle(
+                               ozz::math::Float3::x_axis(), .5f);
+  SetTransform(input, 2, transform);
+
+  ozz::vector<ozz::byte> buffer(PoseEncodeJob::MaxEncodedSize(num_joints));
+  size_t size = 0;
+  PoseEncodeJob encode;
+  encode.skeleton = skeleton.get();
+  encode.input = input;
+  encode.output = make_span(buffer);
+  encode.size = &size;
+  ASSERT_TRUE(encode.Run());
+
+  // Presence bits, rotations, and a single translation.
+  EXPECT_EQ(size, 2u + 6u * 5u + 6u);
+
+  ozz::math::SoaTransform output[2];
+  PoseDecodeJob decode;
+  decode.skeleton = skeleton.get();
+  decode.input = ozz::span<const ozz::byte>(buffer.data(), size);
+  decode.output = output;
+  ASSERT_TRUE(decode.Run());
+
+  for (int i = 0; i < num_joints; ++i) {
+    ExpectTransformNear(GetTransform(input, i), GetTransform(output, i),
+                        1e-3f);
+  }
+}
@@ -0,0 +1,173 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/replicated_assets.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+#include "ozz/base/numa.h"
+
+using ozz::animation::Animation;
+using ozz::animation::ReplicatedAssets;
+using ozz::animation::SamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 2 joints skeleton.
+ozz::unique_ptr<Skeleton> BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "j0";
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].name = "j1";
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+// Builds a 2 tracks animation translating along x from 0 to _x.
+ozz::unique_ptr<Animation> BuildAnimation(float _x) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  const RawAnimation::TranslationKey first = {0.f, ozz::math::Float3::zero()};
+  const RawAnimation::TranslationKey last = {
+      1.f, ozz::math::Float3(_x, 0.f, 0.f)};
+  raw_animation.tracks[1].translations.push_back(first);
+  raw_animation.tracks[1].translations.push_back(last);
+  return AnimationBuilder()(raw_animation);
+}
+
+// Samples _animation second track x translation at _ratio.
+float SampleX(const Animation& _animation, float _ratio) {
+  SamplingJob::Context context(_animation.num_tracks());
+  ozz::math::SoaTransform output[1];
+  SamplingJob job;
+  job.animation = &_animation;
+  job.context = &context;
+  job.ratio = _ratio;
+  job.output = output;
+  EXPECT_TRUE(job.Run());
+  return ozz::math::GetY(output[0].translation.x);
+}
+}  // namespace
+
+TEST(Error, ReplicatedAssets) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ozz::unique_ptr<Animation> animation = BuildAnimation(1.f);
+  ASSERT_TRUE(skeleton && animation);
+
+  ReplicatedAssets replicas;
+  EXPECT_EQ(replicas.num_nodes(), 0);
+  EXPECT_EQ(replicas.skeleton(0), nullptr);
+  EXPECT_EQ(replicas.animation(0, 0), nullptr);
+  EXPECT_EQ(replicas.local_skeleton(), nullptr);
+
+  const Animation* animations[] = {animation.get(), nullptr};
+  EXPECT_FALSE(replicas.Replicate(skeleton.get(), animations, 2));
+  EXPECT_FALSE(replicas.Replicate(skeleton.get(), {animations, 1}, 0));
+  EXPECT_EQ(replicas.num_nodes(), 0);
+  EXPECT_EQ(replicas.num_animations(), 0);
+}
+
+TEST(SingleNode, ReplicatedAssets) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ozz::unique_ptr<Animation> animation = BuildAnimation(1.f);
+  ASSERT_TRUE(skeleton && animation);
+
+  // Single node uses source assets.
+  ReplicatedAssets replicas;
+  const Animation* animations[] = {animation.get()};
+  ASSERT_TRUE(replicas.Replicate(skeleton.get(), animations, 1));
+  EXPECT_EQ(replicas.num_nodes(), 1);
+  EXPECT_EQ(replicas.num_animations(), 1);
+  EXPECT_EQ(replicas.skeleton(0), skeleton.get());
+  EXPECT_EQ(replicas.animation(0, 0), animation.get());
+  EXPECT_EQ(replicas.local_skeleton(), skeleton.get());
+  EXPECT_EQ(replicas.local_animation(0), animation.get());
+  EXPECT_EQ(replicas.skeleton(1), nullptr);
+  EXPECT_EQ(replicas.animation(0, 1), nullptr);
+
+  // Host nodes.
+  ASSERT_TRUE(replicas.Replicate(skeleton.get(), animations));
+  EXPECT_EQ(replicas.num_nodes(), ozz::numa::NumNodes());
+  EXPECT_NE(replicas.local_animation(0), nullptr);
+}
+
+TEST(MultipleNodes, ReplicatedAssets) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ozz::unique_ptr<Animation> animation0 = BuildAnimation(1.f);
+  ozz::unique_ptr<Animation> animation1 = BuildAnimation(2.f);
+  ASSERT_TRUE(skeleton && animation0 && animation1);
+
+  // Replicates to more nodes than the host has, which still copies assets.
+  const int kNumNodes = 3;
+  ReplicatedAssets replicas;
+  const Animation* animations[] = {animation0.get(), animation1.get()};
+  ASSERT_TRUE(replicas.Replicate(skeleton.get(), animations, kNumNodes));
+  EXPECT_EQ(replicas.num_nodes(), kNumNodes);
+  EXPECT_EQ(replicas.num_animations(), 2);
+
+  for (int node = 0; node < kNumNodes; ++node) {
+    const Skeleton* replica_skeleton = replicas.skeleton(node);
+    ASSERT_NE(replica_skeleton, nullptr);
+    EXPECT_NE(replica_skeleton, skeleton.get());
+    EXPECT_EQ(replica_skeleton->num_joints(), 2);
+    EXPECT_STREQ(replica_skeleton->joint_names()[1], "j1");
+
+    for (int i = 0; i < 2; ++i) {
+      const Animation* replica = replicas.animation(node, i);
+      ASSERT_NE(replica, nullptr);
+      EXPECT_NE(replica, animations[i]);
+      EXPECT_FLOAT_EQ(replica->duration(), 1.f);
+      EXPECT_FLOAT_EQ(SampleX(*replica, .5f), SampleX(*animations[i], .5f));
+    }
+    EXPECT_NE(replicas.animation(node, 0), replicas.animation(node, 1));
+  }
+  EXPECT_NE(replicas.animation(0, 0), replicas.animation(1, 0));
+  EXPECT_NE(replicas.local_animation(1), nullptr);
+
+  // Without skeleton.
+  ASSERT_TRUE(replicas.Replicate(nullptr, animations, 2));
+  EXPECT_EQ(replicas.skeleton(0), nullptr);
+  EXPECT_NE(replicas.animation(1, 1), nullptr);
+
+  replicas.Release();
+  EXPECT_EQ(replicas.num_nodes(), 0);
+  EXPECT_EQ(replicas.animation(0, 0), nullptr);
+}
@@ -25,17 +25,29 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include <algorithm>
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "ozz/animation/offline/animation_builder.h"
 #include "ozz/animation/offline/raw_animation.h"
 #include "ozz/animation/runtime/animation.h"
 #include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/gtest_helper.h"
+#include "ozz/base/gtest_parallel_for_helper.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
 #include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/soa_half_transform.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/tracking_allocator.h"
 #include "ozz/base/memory/unique_ptr.h"
 
 using ozz::animation::Animation;
 using ozz::animation::SamplingJob;
+using ozz::animation::StatelessSamplingJob;
 using ozz::animation::offline::AnimationBuilder;
 using ozz::animation::offline::RawAnimation;
 
@@ -623,6 +635,87 @@ TEST(Cache, SamplingJob) {
                           0.f, 0.f, -5.f, 0.f, 0.f, 0.f);
 }
 
+TEST(HotReload, SamplingJob) {
+  // Animation to reload has the same keys times but different values, so that
+  // keys cached by the context would be outdated.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  for (int i = 0; i <= 1; ++i) {
+    const RawAnimation::TranslationKey key = {
+        static_cast<float>(i), ozz::math::Float3(i * 1.f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation = builder(raw_animation);
+  ASSERT_TRUE(animation);
+
+  raw_animation.tracks[0].translations.clear();
+  for (int i = 0; i <= 1; ++i) {
+    const RawAnimation::TranslationKey key = {
+        static_cast<float>(i), ozz::math::Float3(i * 2.f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+  ozz::io::MemoryStream stream;
+  {
+    ozz::unique_ptr<Animation> reloaded = builder(raw_animation);
+    ASSERT_TRUE(reloaded);
+    ozz::io::OArchive archive(&stream);
+    archive << *reloaded;
+  }
+
+  SamplingJob::Context context(1);
+  ozz::math::SoaTransform output[1];
+  SamplingJob job;
+  job.animation = animation.get();
+  job.context = &context;
+  job.ratio = .5f;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, .5f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Fails reloading from an invalid archive, keeping animation unchanged.
+  const uint32_t generation = animation->generation();
+  {
+    ozz::io::MemoryStream invalid;
+    ozz::io::OArchive o(&invalid);
+    o << 46;
+    invalid.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&invalid);
+    EXPECT_FALSE(animation->Reload(i));
+  }
+  EXPECT_EQ(animation->generation(), generation);
+  job.ratio = .75f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, .75f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Reloads in place, context is lazily reset without being invalidated.
+  {
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive archive(&stream);
+    EXPECT_TRUE(animation->Reload(archive));
+  }
+  EXPECT_NE(animation->generation(), generation);
+  EXPECT_EQ(animation->num_tracks(), 1);
+  job.ratio = .875f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.75f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Rebuilding in place is detected as well.
+  ASSERT_TRUE(builder(raw_animation, animation.get()));
+  job.ratio = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 2.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Every animation has its own generation.
+  Animation other;
+  EXPECT_NE(other.generation(), animation->generation());
+}
+
 TEST(CacheResize, SamplingJob) {
   RawAnimation raw_animation;
   raw_animation.duration = 46.f;
@@ -655,3 +748,2237 @@ TEST(CacheResize, SamplingJob) {
   context.Resize(1);
   EXPECT_FALSE(job.Validate());
 }
+
+TEST(BatchJobValidity, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  SamplingJob::Context context0(5);
+  SamplingJob::Context context1(5);
+  SamplingJob::Context small_context(1);
+  ozz::math::SoaTransform output0[2];
+  ozz::math::SoaTransform output1[2];
+
+  {  // Empty/default job
+    ozz::animation::BatchSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Empty batch is valid.
+    ozz::animation::BatchSamplingJob job;
+    job.animation = animation.get();
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Ratios and instances size mismatch.
+    const float ratios[] = {0.f};
+    const ozz::animation::BatchSamplingJob::Instance instances[] = {
+        {&context0, output0}, {&context1, output1}};
+    ozz::animation::BatchSamplingJob job;
+    job.animation = animation.get();
+    job.ratios = ratios;
+    job.instances = instances;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid context.
+    const float ratios[] = {0.f, .5f};
+    const ozz::animation::BatchSamplingJob::Instance instances[] = {
+        {&context0, output0}, {nullptr, output1}};
+    ozz::animation::BatchSamplingJob job;
+    job.animation = animation.get();
+    job.ratios = ratios;
+    job.instances = instances;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Context too small.
+    const float ratios[] = {0.f, .5f};
+    const ozz::animation::BatchSamplingJob::Instance instances[] = {
+        {&context0, output0}, {&small_context, output1}};
+    ozz::animation::BatchSamplingJob job;
+    job.animation = animation.get();
+    job.ratios = ratios;
+    job.instances = instances;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Empty output.
+    const float ratios[] = {0.f, .5f};
+    const ozz::animation::BatchSamplingJob::Instance instances[] = {
+        {&context0, output0}, {&context1, {}}};
+    ozz::animation::BatchSamplingJob job;
+    job.animation = animation.get();
+    job.ratios = ratios;
+    job.instances = instances;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    const float ratios[] = {0.f, 2155.f};
+    const ozz::animation::BatchSamplingJob::Instance instances[] = {
+        {&context0, output0}, {&context1, output1}};
+    ozz::animation::BatchSamplingJob job;
+    job.animation = animation.get();
+    job.ratios = ratios;
+    job.instances = instances;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Batch, SamplingJob) {
+  // Builds an animation with keys spread on all tracks.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(9);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i);
+    for (int k = 0; k <= 10 + static_cast<int>(i); ++k) {
+      const float time = raw_animation.duration * k / (10.f + fi);
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi + k, fi * k, -fi - k)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::y_axis(), .1f * (fi + k))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f + fi * k, 1.f, 1.f + k)};
+      track.scales.push_back(skey);
+    }
+  }
+  ASSERT_TRUE(raw_animation.Validate());
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  const int kInstances = 6;
+  SamplingJob::Context contexts[kInstances];
+  SamplingJob::Context ref_contexts[kInstances];
+  ozz::math::SoaTransform outputs[kInstances][3];
+  ozz::math::SoaTransform ref_output[3];
+  for (int i = 0; i < kInstances; ++i) {
+    contexts[i].Resize(animation->num_tracks());
+    ref_contexts[i].Resize(animation->num_tracks());
+  }
+
+  ozz::animation::BatchSamplingJob::Instance instances[kInstances];
+  for (int i = 0; i < kInstances; ++i) {
+    instances[i].context = &contexts[i];
+    instances[i].output = outputs[i];
+  }
+
+  // Frames of ratios, including sorted, unsorted, duplicated, backward and out
+  // of range ratios.
+  const float frames[][kInstances] = {
+      {0.f, .1f, .1f, .3f, .5f, 1.f},       {.05f, .15f, .15f, .36f, .6f, 0.f},
+      {.9f, .1f, .45f, .45f, .45f, .2f},    {-1.f, 0.f, .2f, .2f, 2.f, .99f},
+      {.31f, .32f, .33f, .34f, .35f, .36f}, {.7f, .71f, .72f, .1f, .2f, .3f}};
+
+  for (size_t f = 0; f < OZZ_ARRAY_SIZE(frames); ++f) {
+    ozz::animation::BatchSamplingJob job;
+    job.animation = animation.get();
+    job.ratios = frames[f];
+    job.instances = instances;
+    ASSERT_TRUE(job.Validate());
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < kInstances; ++i) {
+      SamplingJob ref_job;
+      ref_job.animation = animation.get();
+      ref_job.context = &ref_contexts[i];
+      ref_job.ratio = frames[f][i];
+      ref_job.output = ref_output;
+      ASSERT_TRUE(ref_job.Run());
+
+      // Batch sampling shares decompressed keys, but shall output exactly the
+      // same transforms.
+      EXPECT_EQ(memcmp(outputs[i], ref_output, sizeof(ref_output)), 0);
+    }
+  }
+}
+
+TEST(MultiRatioJobValidity, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  SamplingJob::Context context(5);
+  SamplingJob::Context small_context(1);
+  ozz::math::SoaTransform output0[2];
+  ozz::math::SoaTransform output1[2];
+  const ozz::span<ozz::math::SoaTransform> outputs[] = {output0, output1};
+  const float ratios[] = {.2f, .5f};
+
+  {  // Empty/default job
+    ozz::animation::MultiRatioSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // No ratio is valid.
+    ozz::animation::MultiRatioSamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // No context.
+    ozz::animation::MultiRatioSamplingJob job;
+    job.animation = animation.get();
+    job.ratios = ratios;
+    job.outputs = outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Context too small.
+    ozz::animation::MultiRatioSamplingJob job;
+    job.animation = animation.get();
+    job.context = &small_context;
+    job.ratios = ratios;
+    job.outputs = outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Ratios and outputs size mismatch.
+    ozz::animation::MultiRatioSamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.ratios = {ratios, 1};
+    job.outputs = outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Unsorted ratios.
+    const float unsorted[] = {.5f, .2f};
+    ozz::animation::MultiRatioSamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.ratios = unsorted;
+    job.outputs = outputs;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Empty output.
+    const ozz::span<ozz::math::SoaTransform> empty[] = {output0, {}};
+    ozz::animation::MultiRatioSamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.ratios = ratios;
+    job.outputs = empty;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job, with out of range ratios.
+    const float out_of_range[] = {-1.f, 2155.f};
+    ozz::animation::MultiRatioSamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.ratios = out_of_range;
+    job.outputs = outputs;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(MultiRatio, SamplingJob) {
+  // Builds an animation with keys spread on all tracks.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(9);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i);
+    for (int k = 0; k <= 10 + static_cast<int>(i); ++k) {
+      const float time = raw_animation.duration * k / (10.f + fi);
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi + k, fi * k, -fi - k)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::y_axis(), .1f * (fi + k))};
+      track.rotations.push_back(rkey);
+    }
+  }
+
+  AnimationBuilder builder;
+  builder.random_access = false;
+  builder.seek_interval = 0.f;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  const int kRatios = 7;
+  SamplingJob::Context context(animation->num_tracks());
+  SamplingJob::Context ref_context(animation->num_tracks());
+  ozz::math::SoaTransform outputs[kRatios][3];
+  ozz::math::SoaTransform ref_output[3];
+  ozz::span<ozz::math::SoaTransform> output_spans[kRatios];
+  for (int i = 0; i < kRatios; ++i) {
+    output_spans[i] = outputs[i];
+  }
+
+  // Counts the keys of a single pass through the whole animation.
+  SamplingJob::Stats pass_stats;
+  {
+    SamplingJob::Context pass_context(animation->num_tracks());
+    SamplingJob pass_job;
+    pass_job.animation = animation.get();
+    pass_job.context = &pass_context;
+    pass_job.ratio = 1.f;
+    pass_job.output = ref_output;
+    pass_job.stats = &pass_stats;
+    ASSERT_TRUE(pass_job.Run());
+  }
+
+  // Sorted ratios, including duplicated and out of range ratios.
+  const float frames[][kRatios] = {
+      {-1.f, 0.f, .1f, .1f, .3f, .5f, 1.f},
+      {.05f, .15f, .15f, .36f, .6f, .9f, 2.f},
+      {0.f, .2f, .2f, .2f, .21f, .22f, .8f}};
+
+  for (size_t f = 0; f < OZZ_ARRAY_SIZE(frames); ++f) {
+    SamplingJob::Stats stats;
+    ozz::animation::MultiRatioSamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.ratios = frames[f];
+    job.outputs = output_spans;
+    job.stats = &stats;
+    ASSERT_TRUE(job.Validate());
+    ASSERT_TRUE(job.Run());
+
+    // A single pass over the keys: the context restarts at most once, when
+    // the first ratio is behind the previous frame last one.
+    EXPECT_LE(stats.invalidations, 1);
+    EXPECT_LE(stats.keys_advanced, pass_stats.keys_advanced);
+
+    for (int i = 0; i < kRatios; ++i) {
+      SamplingJob ref_job;
+      ref_job.animation = animation.get();
+      ref_job.context = &ref_context;
+      ref_job.ratio = frames[f][i];
+      ref_job.output = ref_output;
+      ASSERT_TRUE(ref_job.Run());
+
+      // Multi ratio sampling shall output exactly the same transforms.
+      EXPECT_EQ(memcmp(outputs[i], ref_output, sizeof(ref_output)), 0);
+    }
+  }
+}
+
+TEST(Prefetch, SamplingJob) {
+  // Builds an animation with keys spread on all tracks, with a different
+  // number of keys per track.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(37);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i);
+    const int num_keys = 2 + static_cast<int>(i * 7 % 23);
+    for (int k = 0; k <= num_keys; ++k) {
+      const float time = raw_animation.duration * k / num_keys;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi + k, fi * k, -fi - k)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::y_axis(), .1f * (fi + k))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f + fi * k, 1.f, 1.f + k)};
+      track.scales.push_back(skey);
+    }
+  }
+
+  AnimationBuilder builder;
+  builder.cubic_interpolation = true;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  SamplingJob::Context ref_context(animation->num_tracks(), true);
+  SamplingJob::Context context(animation->num_tracks(), true);
+  ozz::math::SoaTransform ref_output[10];
+  ozz::math::SoaTransform output[10];
+  const uint8_t mask[] = {0x5b, 0x3};
+
+  SamplingJob job;
+  EXPECT_EQ(job.prefetch_distance, SamplingJob::kDefaultPrefetchDistance);
+  job.animation = animation.get();
+  job.context = &context;
+  job.output = {output, static_cast<size_t>(num_soa_tracks)};
+
+  job.prefetch_distance = -1;
+  EXPECT_FALSE(job.Validate());
+  EXPECT_FALSE(job.Run());
+
+  // Prefetching shall not change the output, whatever the distance and the
+  // way the context is updated (forward, backward, reset, masked out
+  // entries).
+  const int distances[] = {1, 3, 8, 64, 100000};
+  const float ratios[] = {0.f, .1f, .5f, .51f, .3f, 1.f, .9f, 0.f, .7f};
+  for (size_t d = 0; d < OZZ_ARRAY_SIZE(distances); ++d) {
+    ref_context.Invalidate();
+    context.Invalidate();
+    for (size_t r = 0; r < OZZ_ARRAY_SIZE(ratios); ++r) {
+      SamplingJob ref_job;
+      ref_job.animation = animation.get();
+      ref_job.context = &ref_context;
+      ref_job.ratio = ratios[r];
+      ref_job.output = {ref_output, static_cast<size_t>(num_soa_tracks)};
+      ref_job.prefetch_distance = 0;
+
+      job.ratio = ratios[r];
+      job.prefetch_distance = distances[d];
+
+      if (r % 3 == 1) {
+        ref_job.mask = mask;
+        job.mask = mask;
+      } else {
+        ref_job.mask = {};
+        job.mask = {};
+      }
+
+      ASSERT_TRUE(ref_job.Run());
+      ASSERT_TRUE(job.Run());
+      EXPECT_EQ(memcmp(output, ref_output,
+                       sizeof(ozz::math::SoaTransform) * num_soa_tracks),
+                0);
+    }
+  }
+}
+
+TEST(CrowdJobValidity, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  SamplingJob::ContextBank bank(2, 5);
+  SamplingJob::Context small_context(1);
+  ozz::math::SoaTransform outputs[2][2];
+  int order[2];
+
+  ozz::animation::CrowdSamplingJob::Instance instances[2];
+  for (int i = 0; i < 2; ++i) {
+    instances[i].animation = animation.get();
+    instances[i].ratio = 0.f;
+    instances[i].context = &bank.contexts()[i];
+    instances[i].output = outputs[i];
+  }
+
+  {  // Empty crowd is valid.
+    ozz::animation::CrowdSamplingJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  {  // Valid.
+    ozz::animation::CrowdSamplingJob job;
+    job.instances = instances;
+    job.order = order;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+  {  // Order too small.
+    ozz::animation::CrowdSamplingJob job;
+    job.instances = instances;
+    job.order = {order, 1};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // No animation.
+    ozz::animation::CrowdSamplingJob::Instance invalid[2] = {instances[0],
+                                                             instances[1]};
+    invalid[1].animation = nullptr;
+    ozz::animation::CrowdSamplingJob job;
+    job.instances = invalid;
+    job.order = order;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // No context.
+    ozz::animation::CrowdSamplingJob::Instance invalid[2] = {instances[0],
+                                                             instances[1]};
+    invalid[0].context = nullptr;
+    ozz::animation::CrowdSamplingJob job;
+    job.instances = invalid;
+    job.order = order;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Context too small.
+    ozz::animation::CrowdSamplingJob::Instance invalid[2] = {instances[0],
+                                                             instances[1]};
+    invalid[0].context = &small_context;
+    ozz::animation::CrowdSamplingJob job;
+    job.instances = invalid;
+    job.order = order;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // No output.
+    ozz::animation::CrowdSamplingJob::Instance invalid[2] = {instances[0],
+                                                             instances[1]};
+    invalid[1].output = {};
+    ozz::animation::CrowdSamplingJob job;
+    job.instances = invalid;
+    job.order = order;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+}
+
+TEST(Crowd, SamplingJob) {
+  // Builds animations with keys spread on all tracks.
+  const int kAnimations = 3;
+  ozz::unique_ptr<Animation> animations[kAnimations];
+  for (int a = 0; a < kAnimations; ++a) {
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f + a;
+    raw_animation.tracks.resize(6);
+    for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+      RawAnimation::JointTrack& track = raw_animation.tracks[i];
+      const float fi = static_cast<float>(i + a);
+      for (int k = 0; k <= 8 + static_cast<int>(i); ++k) {
+        const float time = raw_animation.duration * k / (8.f + i);
+        const RawAnimation::TranslationKey tkey = {
+            time, ozz::math::Float3(fi + k, fi * k, -fi - k)};
+        track.translations.push_back(tkey);
+        const RawAnimation::RotationKey rkey = {
+            time, ozz::math::Quaternion::FromAxisAngle(
+                      ozz::math::Float3::y_axis(), .1f * (fi + k))};
+        track.rotations.push_back(rkey);
+      }
+    }
+    ASSERT_TRUE(raw_animation.Validate());
+    animations[a] = AnimationBuilder()(raw_animation);
+    ASSERT_TRUE(animations[a]);
+  }
+
+  // More instances than a chunk, interleaving animations.
+  const int kInstances = 150;
+  SamplingJob::ContextBank bank(kInstances, 6);
+  SamplingJob::ContextBank ref_bank(kInstances, 6);
+  ozz::math::SoaTransform outputs[kInstances][2];
+  ozz::math::SoaTransform ref_output[2];
+  int order[kInstances];
+  ozz::animation::CrowdSamplingJob::Instance instances[kInstances];
+  for (int i = 0; i < kInstances; ++i) {
+    instances[i].animation = animations[(i * 7) % kAnimations].get();
+    instances[i].context = &bank.contexts()[i];
+    instances[i].output = outputs[i];
+  }
+
+  int tasks = 0;
+  for (int f = 0; f < 8; ++f) {
+    for (int i = 0; i < kInstances; ++i) {
+      instances[i].ratio = ((i * 37 + f * 11) % 101) / 100.f;
+    }
+
+    ozz::animation::CrowdSamplingJob job;
+    job.instances = instances;
+    job.order = order;
+    if (f & 1) {
+      job.parallel_for = &ReverseParallelFor;
+      job.parallel_for_user_data = &tasks;
+    }
+    ASSERT_TRUE(job.Run());
+
+    // Order is sorted by animation, then ratio.
+    for (int i = 1; i < kInstances; ++i) {
+      const ozz::animation::CrowdSamplingJob::Instance& prev =
+          instances[order[i - 1]];
+      const ozz::animation::CrowdSamplingJob::Instance& cur =
+          instances[order[i]];
+      if (prev.animation == cur.animation) {
+        EXPECT_LE(prev.ratio, cur.ratio);
+      }
+    }
+    int switches = 0;
+    for (int i = 1; i < kInstances; ++i) {
+      switches += instances[order[i - 1]].animation !=
+                  instances[order[i]].animation;
+    }
+    EXPECT_EQ(switches, kAnimations - 1);
+
+    for (int i = 0; i < kInstances; ++i) {
+      SamplingJob ref_job;
+      ref_job.animation = instances[i].animation;
+      ref_job.context = &ref_bank.contexts()[i];
+      ref_job.ratio = instances[i].ratio;
+      ref_job.output = ref_output;
+      ASSERT_TRUE(ref_job.Run());
+
+      // Crowd sampling shall output exactly the same transforms.
+      EXPECT_EQ(memcmp(outputs[i], ref_output, sizeof(ref_output)), 0);
+    }
+  }
+  EXPECT_EQ(tasks, 4 * 3);
+}
+
+TEST(SeekPoints, SamplingJob) {
+  // Builds an animation with keys spread on all tracks.
+  RawAnimation raw_animation;
+  raw_animation.duration = 3.f;
+  raw_animation.tracks.resize(7);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i);
+    for (int k = 0; k <= 20 + static_cast<int>(i) * 3; ++k) {
+      const float time = raw_animation.duration * k / (20.f + fi * 3.f);
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi + k, fi * k, -fi - k)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::x_axis(), .1f * (fi + k))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f + fi * k, 1.f, 1.f + k)};
+      track.scales.push_back(skey);
+    }
+  }
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+  EXPECT_EQ(animation->num_seek_points(), 0);
+
+  builder.seek_interval = .25f;
+  ozz::unique_ptr<Animation> seek_animation(builder(raw_animation));
+  ASSERT_TRUE(seek_animation);
+  EXPECT_EQ(seek_animation->num_seek_points(), 11);
+  EXPECT_GT(seek_animation->size(), animation->size());
+
+  SamplingJob::Context context(7);
+  SamplingJob::Context ref_context(7);
+  ozz::math::SoaTransform output[2];
+  ozz::math::SoaTransform ref_output[2];
+
+  // Forward, backward, far jumps and seek points exact ratios.
+  const float ratios[] = {0.f,  .01f, .02f, .5f,  .51f,       .1f,
+                          1.f,  0.f,  .99f, .3f,  1.f / 12.f, 2.f / 12.f,
+                          .9f,  .05f, .06f, .7f,  .3f,        .31f,
+                          .95f, 1.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+    SamplingJob job;
+    job.animation = seek_animation.get();
+    job.context = &context;
+    job.ratio = ratios[i];
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    // Reference is always sampled from an invalidated context.
+    ref_context.Invalidate();
+    SamplingJob ref_job;
+    ref_job.animation = animation.get();
+    ref_job.context = &ref_context;
+    ref_job.ratio = ratios[i];
+    ref_job.output = ref_output;
+    ASSERT_TRUE(ref_job.Run());
+
+    EXPECT_EQ(memcmp(output, ref_output, sizeof(ref_output)), 0);
+  }
+}
+
+TEST(Bidirectional, SamplingJob) {
+  // Builds an animation with keys spread on all tracks.
+  RawAnimation raw_animation;
+  raw_animation.duration = 3.f;
+  raw_animation.tracks.resize(6);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i);
+    for (int k = 0; k <= 15 + static_cast<int>(i) * 4; ++k) {
+      const float time = raw_animation.duration * k / (15.f + fi * 4.f);
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi + k, fi * k, -fi - k)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::z_axis(), .1f * (fi + k))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f + fi * k, 1.f, 1.f + k)};
+      track.scales.push_back(skey);
+    }
+  }
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+  EXPECT_FALSE(animation->bidirectional());
+
+  builder.bidirectional = true;
+  ozz::unique_ptr<Animation> bidir_animation(builder(raw_animation));
+  ASSERT_TRUE(bidir_animation);
+  EXPECT_TRUE(bidir_animation->bidirectional());
+  EXPECT_EQ(bidir_animation->translation_previouses().size(),
+            bidir_animation->translations().size());
+  EXPECT_GT(bidir_animation->size(), animation->size());
+
+  // Also combines with seek points.
+  builder.seek_interval = .5f;
+  ozz::unique_ptr<Animation> seek_animation(builder(raw_animation));
+  ASSERT_TRUE(seek_animation);
+
+  SamplingJob::Context context(6);
+  SamplingJob::Context seek_context(6);
+  SamplingJob::Context ref_context(6);
+  ozz::math::SoaTransform output[2];
+  ozz::math::SoaTransform seek_output[2];
+  ozz::math::SoaTransform ref_output[2];
+
+  // Backward playback, ping-pong, and far jumps.
+  ozz::vector<float> ratios;
+  for (float r = 1.f; r >= 0.f; r -= .013f) {
+    ratios.push_back(r);
+  }
+  for (float r = 0.f; r <= 1.f; r += .021f) {
+    ratios.push_back(r);
+  }
+  const float jumps[] = {.5f, .49f, .9f, .1f, .11f, 0.f, 1.f, .97f, .2f};
+  ratios.insert(ratios.end(), jumps, jumps + OZZ_ARRAY_SIZE(jumps));
+
+  for (size_t i = 0; i < ratios.size(); ++i) {
+    SamplingJob job;
+    job.animation = bidir_animation.get();
+    job.context = &context;
+    job.ratio = ratios[i];
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    SamplingJob seek_job;
+    seek_job.animation = seek_animation.get();
+    seek_job.context = &seek_context;
+    seek_job.ratio = ratios[i];
+    seek_job.output = seek_output;
+    ASSERT_TRUE(seek_job.Run());
+
+    // Reference is always sampled from an invalidated context.
+    ref_context.Invalidate();
+    SamplingJob ref_job;
+    ref_job.animation = animation.get();
+    ref_job.context = &ref_context;
+    ref_job.ratio = ratios[i];
+    ref_job.output = ref_output;
+    ASSERT_TRUE(ref_job.Run());
+
+    EXPECT_EQ(memcmp(output, ref_output, sizeof(ref_output)), 0);
+    EXPECT_EQ(memcmp(seek_output, ref_output, sizeof(ref_output)), 0);
+  }
+}
+
+TEST(BidirectionalFarPrevious, SamplingJob) {
+  // Track 0 has only 4 keys, while track 1 has too many keys for track 0
+  // previous key offsets to be stored.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  const float times[] = {0.f, .96f, .98f, 1.f};
+  for (size_t k = 0; k < OZZ_ARRAY_SIZE(times); ++k) {
+    const RawAnimation::TranslationKey key = {
+        times[k], ozz::math::Float3(static_cast<float>(k), 1.f, 2.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+  const int kKeys = 70000;
+  for (int k = 0; k <= kKeys; ++k) {
+    const RawAnimation::TranslationKey key = {
+        static_cast<float>(k) / kKeys,
+        ozz::math::Float3(static_cast<float>(k % 3), 0.f, 0.f)};
+    raw_animation.tracks[1].translations.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  builder.bidirectional = true;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  // Ensures at least one offset couldn't be stored (first 4 keys, one per soa
+  // track, have no previous).
+  const ozz::span<const uint16_t> previouses =
+      animation->translation_previouses();
+  EXPECT_NE(std::count(previouses.begin() + 4, previouses.end(), 0), 0);
+
+  SamplingJob::Context context(2);
+  SamplingJob::Context ref_context(2);
+  ozz::math::SoaTransform output[1];
+  ozz::math::SoaTransform ref_output[1];
+
+  const float ratios[] = {1.f, .99f, .97f, .5f, .00001f, .7f, .69f, 0.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+    SamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.ratio = ratios[i];
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    ref_context.Invalidate();
+    SamplingJob ref_job;
+    ref_job.animation = animation.get();
+    ref_job.context = &ref_context;
+    ref_job.ratio = ratios[i];
+    ref_job.output = ref_output;
+    ASSERT_TRUE(ref_job.Run());
+
+    EXPECT_EQ(memcmp(output, ref_output, sizeof(ref_output)), 0);
+  }
+}
+
+TEST(RotationFormats, SamplingJob) {
+  // Builds an animation with keys spread on all tracks.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(5);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i);
+    for (int k = 0; k <= 10 + static_cast<int>(i) * 5; ++k) {
+      const float time = raw_animation.duration * k / (10.f + fi * 5.f);
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi + k, fi * k, -fi - k)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromEuler(.1f * (fi + k), .3f * fi,
+                                                 -.2f * k)};
+      track.rotations.push_back(rkey);
+    }
+  }
+
+  AnimationBuilder builder;
+  builder.bidirectional = true;
+  builder.seek_interval = .5f;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+  EXPECT_TRUE(animation->compact_rotations().empty());
+  EXPECT_TRUE(animation->packed_rotations().empty());
+
+  builder.rotation_format = AnimationBuilder::kRotationCompact48;
+  ozz::unique_ptr<Animation> animation48(builder(raw_animation));
+  ASSERT_TRUE(animation48);
+  EXPECT_TRUE(animation48->rotations().empty());
+  EXPECT_EQ(animation48->compact_rotations().size(),
+            animation->rotations().size());
+  EXPECT_TRUE(animation48->packed_rotations().empty());
+  EXPECT_LT(animation48->size(), animation->size());
+
+  builder.rotation_format = AnimationBuilder::kRotationCompact32;
+  ozz::unique_ptr<Animation> animation32(builder(raw_animation));
+  ASSERT_TRUE(animation32);
+  EXPECT_TRUE(animation32->rotations().empty());
+  EXPECT_TRUE(animation32->compact_rotations().empty());
+  EXPECT_EQ(animation32->packed_rotations().size(),
+            animation->rotations().size());
+  EXPECT_LT(animation32->size(), animation48->size());
+
+  const Animation* animations[] = {animation48.get(), animation32.get()};
+  const float tolerances[] = {1e-4f, 2e-3f};
+  for (size_t a = 0; a < OZZ_ARRAY_SIZE(animations); ++a) {
+    SamplingJob::Context context(5);
+    SamplingJob::Context ref_context(5);
+    SamplingJob::Context exact_context(5);
+    ozz::math::SoaTransform output[2];
+    ozz::math::SoaTransform ref_output[2];
+    ozz::math::SoaTransform exact_output[2];
+
+    // Forward, backward and far jumps.
+    const float ratios[] = {0.f, .01f, .3f, .29f, .8f, 1.f, .99f, .1f, .5f};
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+      SamplingJob job;
+      job.animation = animations[a];
+      job.context = &context;
+      job.ratio = ratios[i];
+      job.output = output;
+      ASSERT_TRUE(job.Run());
+
+      // Compact formats sampling is independent of context history.
+      exact_context.Invalidate();
+      SamplingJob exact_job;
+      exact_job.animation = animations[a];
+      exact_job.context = &exact_context;
+      exact_job.ratio = ratios[i];
+      exact_job.output = exact_output;
+      ASSERT_TRUE(exact_job.Run());
+      EXPECT_EQ(memcmp(output, exact_output, sizeof(exact_output)), 0);
+
+      // Compares with default format.
+      SamplingJob ref_job;
+      ref_job.animation = animation.get();
+      ref_job.context = &ref_context;
+      ref_job.ratio = ratios[i];
+      ref_job.output = ref_output;
+      ASSERT_TRUE(ref_job.Run());
+
+      for (size_t s = 0; s < OZZ_ARRAY_SIZE(output); ++s) {
+        EXPECT_EQ(memcmp(&output[s].translation, &ref_output[s].translation,
+                         sizeof(ref_output[s].translation)),
+                  0);
+        const ozz::math::SoaQuaternion& q = output[s].rotation;
+        const ozz::math::SoaQuaternion& ref_q = ref_output[s].rotation;
+        const ozz::math::SimdFloat4 cpnts[] = {q.x, q.y, q.z, q.w};
+        const ozz::math::SimdFloat4 ref_cpnts[] = {ref_q.x, ref_q.y, ref_q.z,
+                                                   ref_q.w};
+        for (int c = 0; c < 4; ++c) {
+          float values[4], ref_values[4];
+          ozz::math::StorePtrU(cpnts[c], values);
+          ozz::math::StorePtrU(ref_cpnts[c], ref_values);
+          for (int l = 0; l < 4; ++l) {
+            EXPECT_NEAR(values[l], ref_values[l], tolerances[a]);
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(RotationFormatsFallback, SamplingJob) {
+  // Keys closer than duration / 65535 can't be quantized.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  const RawAnimation::RotationKey keys[] = {
+      {0.f, ozz::math::Quaternion::identity()},
+      {.5f, ozz::math::Quaternion::FromEuler(.5f, 0.f, 0.f)},
+      {.500001f, ozz::math::Quaternion::FromEuler(.6f, 0.f, 0.f)},
+      {1.f, ozz::math::Quaternion::identity()}};
+  raw_animation.tracks[0].rotations.assign(keys, keys + OZZ_ARRAY_SIZE(keys));
+
+  AnimationBuilder builder;
+  builder.rotation_format = AnimationBuilder::kRotationCompact48;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+  EXPECT_EQ(animation->rotations().size(), 10u);
+  EXPECT_TRUE(animation->compact_rotations().empty());
+}
+
+TEST(CompactRatios, SamplingJob) {
+  // Builds an animation with keys spread on all tracks.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(6);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i);
+    for (int k = 0; k <= 8 + static_cast<int>(i) * 3; ++k) {
+      const float time = raw_animation.duration * k / (8.f + fi * 3.f);
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi + k, fi * k, -fi - k)};
+      track.translations.push_back(tkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f + fi * k, 1.f, 1.f + k)};
+      track.scales.push_back(skey);
+    }
+  }
+
+  AnimationBuilder builder;
+  builder.bidirectional = true;
+  builder.seek_interval = .4f;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+  EXPECT_TRUE(animation->compact_translations().empty());
+  EXPECT_TRUE(animation->compact_scales().empty());
+
+  builder.compact_ratios = true;
+  ozz::unique_ptr<Animation> compact_animation(builder(raw_animation));
+  ASSERT_TRUE(compact_animation);
+  EXPECT_TRUE(compact_animation->translations().empty());
+  EXPECT_EQ(compact_animation->compact_translations().size(),
+            animation->translations().size());
+  EXPECT_TRUE(compact_animation->scales().empty());
+  EXPECT_EQ(compact_animation->compact_scales().size(),
+            animation->scales().size());
+  EXPECT_LT(compact_animation->size(), animation->size());
+
+  SamplingJob::Context context(6);
+  SamplingJob::Context ref_context(6);
+  SamplingJob::Context exact_context(6);
+  ozz::math::SoaTransform output[2];
+  ozz::math::SoaTransform ref_output[2];
+  ozz::math::SoaTransform exact_output[2];
+
+  // Forward, backward and far jumps.
+  const float ratios[] = {0.f, .02f, .4f, .39f, .75f, 1.f, .98f, .2f, .6f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+    SamplingJob job;
+    job.animation = compact_animation.get();
+    job.context = &context;
+    job.ratio = ratios[i];
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    // Sampling is independent of context history.
+    exact_context.Invalidate();
+    SamplingJob exact_job;
+    exact_job.animation = compact_animation.get();
+    exact_job.context = &exact_context;
+    exact_job.ratio = ratios[i];
+    exact_job.output = exact_output;
+    ASSERT_TRUE(exact_job.Run());
+    EXPECT_EQ(memcmp(output, exact_output, sizeof(exact_output)), 0);
+
+    // Compares with 32 bits ratios.
+    SamplingJob ref_job;
+    ref_job.animation = animation.get();
+    ref_job.context = &ref_context;
+    ref_job.ratio = ratios[i];
+    ref_job.output = ref_output;
+    ASSERT_TRUE(ref_job.Run());
+
+    for (size_t s = 0; s < OZZ_ARRAY_SIZE(output); ++s) {
+      const ozz::math::SimdFloat4 cpnts[] = {
+          output[s].translation.x, output[s].translation.y,
+          output[s].translation.z, output[s].scale.x,
+          output[s].scale.y,       output[s].scale.z};
+      const ozz::math::SimdFloat4 ref_cpnts[] = {
+          ref_output[s].translation.x, ref_output[s].translation.y,
+          ref_output[s].translation.z, ref_output[s].scale.x,
+          ref_output[s].scale.y,       ref_output[s].scale.z};
+      for (size_t c = 0; c < OZZ_ARRAY_SIZE(cpnts); ++c) {
+        float values[4], ref_values[4];
+        ozz::math::StorePtrU(cpnts[c], values);
+        ozz::math::StorePtrU(ref_cpnts[c], ref_values);
+        for (int l = 0; l < 4; ++l) {
+          EXPECT_NEAR(values[l], ref_values[l], 2e-2f);
+        }
+      }
+      EXPECT_EQ(memcmp(&output[s].rotation, &ref_output[s].rotation,
+                       sizeof(ref_output[s].rotation)),
+                0);
+    }
+  }
+}
+
+TEST(ConstantTracks, SamplingJob) {
+  // Tracks 0 to 3 have animated translations, 4 to 5 constant ones. Only
+  // track 5 has animated rotations. All scales are constant.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+  for (int i = 0; i < 6; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i);
+    const RawAnimation::TranslationKey t0 = {0.f,
+                                             ozz::math::Float3(fi, 0.f, 0.f)};
+    track.translations.push_back(t0);
+    const RawAnimation::TranslationKey t1 = {
+        .5f, ozz::math::Float3(fi, i < 4 ? 1.f : 0.f, 0.f)};
+    track.translations.push_back(t1);
+    const RawAnimation::ScaleKey s0 = {.3f, ozz::math::Float3(2.f, 2.f, fi)};
+    track.scales.push_back(s0);
+    const RawAnimation::ScaleKey s1 = {.7f, ozz::math::Float3(2.f, 2.f, fi)};
+    track.scales.push_back(s1);
+  }
+  const RawAnimation::RotationKey r0 = {
+      .2f, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                1.f)};
+  raw_animation.tracks[5].rotations.push_back(r0);
+  const RawAnimation::RotationKey r1 = {
+      .8f, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                2.f)};
+  raw_animation.tracks[5].rotations.push_back(r1);
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  // SoA entry 0 has animated translations, entry 1 animated rotations.
+  ASSERT_EQ(animation->constant_translations().size(), 1u);
+  EXPECT_EQ(animation->constant_translations()[0], 2);
+  ASSERT_EQ(animation->constant_rotations().size(), 1u);
+  EXPECT_EQ(animation->constant_rotations()[0], 1);
+  ASSERT_EQ(animation->constant_scales().size(), 1u);
+  EXPECT_EQ(animation->constant_scales()[0], 3);
+
+  SamplingJob::Context context(6);
+  ozz::math::SoaTransform output[2];
+  SamplingJob job;
+  job.animation = animation.get();
+  job.context = &context;
+  job.output = output;
+
+  const float ratios[] = {0.f, .25f, .9f, .1f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+    const float ratio = ratios[i];
+    job.ratio = ratio;
+    ASSERT_TRUE(job.Run());
+
+    const float ty = ratio < .5f ? ratio * 2.f : 1.f;
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 0.f, 1.f, 2.f, 3.f, ty, ty,
+                            ty, ty, 0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 4.f, 5.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, 0.f, 0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f,
+                                1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 2.f, 2.f, 2.f, 2.f, 2.f, 2.f,
+                            2.f, 2.f, 0.f, 1.f, 2.f, 3.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].scale, 2.f, 2.f, 1.f, 1.f, 2.f, 2.f,
+                            1.f, 1.f, 4.f, 5.f, 1.f, 1.f);
+  }
+}
+
+TEST(Mask, SamplingJob) {
+  // Builds an animation with keys on 9 tracks (3 SoA tracks).
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(9);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i);
+    for (int k = 0; k <= 5; ++k) {
+      const float time = k / 5.f;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi, fi * k, 0.f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::x_axis(), .1f * (fi + k))};
+      track.rotations.push_back(rkey);
+    }
+  }
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  SamplingJob::Context context(9);
+  SamplingJob::Context ref_context(9);
+  ozz::math::SoaTransform output[3];
+  ozz::math::SoaTransform ref_output[3];
+
+  {  // Mask too small.
+    RawAnimation big_raw_animation;
+    big_raw_animation.duration = 1.f;
+    big_raw_animation.tracks.resize(40);
+    ozz::unique_ptr<Animation> big_animation(builder(big_raw_animation));
+    ASSERT_TRUE(big_animation);
+    SamplingJob::Context big_context(40);
+
+    SamplingJob job;
+    job.animation = big_animation.get();
+    job.context = &big_context;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    const uint8_t mask[2] = {0xff, 0x03};
+    job.mask = ozz::span<const uint8_t>(mask, 1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+    job.mask = mask;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  // Alternates masks, including one that disables everything.
+  const uint8_t masks[] = {5, 2, 0, 7, 1, 6};
+  const float ratios[] = {0.f, .3f, .5f, .7f, .75f, 1.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(masks); ++i) {
+    // Fills output with a pattern, to detect untouched tracks.
+    memset(output, 0xcd, sizeof(output));
+    const ozz::math::SoaTransform untouched = output[0];
+
+    SamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.ratio = ratios[i];
+    job.output = output;
+    job.mask = ozz::span<const uint8_t>(masks + i, 1);
+    ASSERT_TRUE(job.Run());
+
+    ref_context.Invalidate();
+    SamplingJob ref_job;
+    ref_job.animation = animation.get();
+    ref_job.context = &ref_context;
+    ref_job.ratio = ratios[i];
+    ref_job.output = ref_output;
+    ASSERT_TRUE(ref_job.Run());
+
+    for (int s = 0; s < 3; ++s) {
+      const ozz::math::SoaTransform& expected =
+          (masks[i] & (1 << s)) ? ref_output[s] : untouched;
+      EXPECT_EQ(memcmp(&output[s], &expected, sizeof(expected)), 0);
+    }
+  }
+}
+
+TEST(Stats, SamplingJob) {
+  // Builds an animation with 6 translation and rotation keys on 9 tracks (3
+  // SoA tracks). Scales are left to default, aka 2 keys per track.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(9);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i);
+    for (int k = 0; k <= 5; ++k) {
+      const float time = k / 5.f;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi, fi * k, 0.f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::x_axis(), .1f * (fi + k))};
+      track.rotations.push_back(rkey);
+    }
+  }
+
+  AnimationBuilder builder;
+  builder.random_access = false;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  SamplingJob::Context context(9);
+  ozz::math::SoaTransform output[3];
+
+  SamplingJob::Stats stats;
+  EXPECT_EQ(stats.keys_advanced, 0);
+  EXPECT_EQ(stats.refreshed_entries, 0);
+  EXPECT_EQ(stats.interpolated_entries, 0);
+  EXPECT_EQ(stats.invalidations, 0);
+
+  SamplingJob job;
+  EXPECT_TRUE(job.stats == nullptr);
+  job.animation = animation.get();
+  job.context = &context;
+  job.output = output;
+  job.stats = &stats;
+
+  {  // First sampling invalidates the context, all entries are refreshed.
+    job.ratio = 0.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(stats.keys_advanced, 0);
+    EXPECT_EQ(stats.refreshed_entries, 3 * 3);
+    EXPECT_EQ(stats.interpolated_entries, 3);
+    EXPECT_EQ(stats.invalidations, 1);
+  }
+
+  {  // Same ratio, nothing to refresh. Stats are accumulated.
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(stats.keys_advanced, 0);
+    EXPECT_EQ(stats.refreshed_entries, 3 * 3);
+    EXPECT_EQ(stats.interpolated_entries, 3 * 2);
+    EXPECT_EQ(stats.invalidations, 1);
+  }
+
+  {  // Steps over the key at .2 of 9 translation and 9 rotation tracks.
+    stats.Reset();
+    job.ratio = .3f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(stats.keys_advanced, 9 * 2);
+    EXPECT_EQ(stats.refreshed_entries, 3 * 2);
+    EXPECT_EQ(stats.interpolated_entries, 3);
+    EXPECT_EQ(stats.invalidations, 0);
+  }
+
+  {  // Rewinding invalidates the context.
+    stats.Reset();
+    job.ratio = .1f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(stats.keys_advanced, 0);
+    EXPECT_EQ(stats.refreshed_entries, 3 * 3);
+    EXPECT_EQ(stats.interpolated_entries, 3);
+    EXPECT_EQ(stats.invalidations, 1);
+  }
+
+  {  // Masked out entries are neither refreshed nor interpolated.
+    stats.Reset();
+    const uint8_t mask = 5;
+    job.mask = ozz::span<const uint8_t>(&mask, 1);
+    job.ratio = .5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(stats.keys_advanced, 9 * 2 * 2);
+    EXPECT_EQ(stats.refreshed_entries, 2 * 2);
+    EXPECT_EQ(stats.interpolated_entries, 2);
+    EXPECT_EQ(stats.invalidations, 0);
+  }
+
+  {  // Changing animation invalidates the context.
+    ozz::unique_ptr<Animation> other(builder(raw_animation));
+    ASSERT_TRUE(other);
+    stats.Reset();
+    job.animation = other.get();
+    job.mask = {};
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(stats.invalidations, 1);
+    EXPECT_EQ(stats.refreshed_entries, 3 * 3);
+    job.animation = animation.get();
+  }
+
+  {  // No stats.
+    job.stats = nullptr;
+    stats.Reset();
+    job.ratio = 1.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(stats.keys_advanced, 0);
+    EXPECT_EQ(stats.interpolated_entries, 0);
+  }
+}
+
+TEST(StatelessJobValidity, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+  EXPECT_FALSE(animation->random_access());
+  EXPECT_TRUE(animation->translation_track_index().empty());
+
+  builder.random_access = true;
+  ozz::unique_ptr<Animation> ra_animation(builder(raw_animation));
+  ASSERT_TRUE(ra_animation);
+  EXPECT_TRUE(ra_animation->random_access());
+  EXPECT_GT(ra_animation->size(), animation->size());
+
+  ozz::math::SoaTransform output[1];
+
+  {  // Empty/default job.
+    StatelessSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output.
+    StatelessSamplingJob job;
+    job.animation = ra_animation.get();
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Animation without track indices.
+    StatelessSamplingJob job;
+    job.animation = animation.get();
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    StatelessSamplingJob job;
+    job.animation = ra_animation.get();
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job with empty animation.
+    RawAnimation empty_raw_animation;
+    empty_raw_animation.duration = 1.f;
+    ozz::unique_ptr<Animation> empty_animation(builder(empty_raw_animation));
+    ASSERT_TRUE(empty_animation);
+
+    StatelessSamplingJob job;
+    job.animation = empty_animation.get();
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Stateless, SamplingJob) {
+  // Builds an animation with a different number of keys per track, and a few
+  // constant tracks.
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(7);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i);
+    const int num_keys = i < 4 ? 2 + static_cast<int>(i) * 5 : 1;
+    for (int k = 0; k < num_keys; ++k) {
+      const float time = raw_animation.duration * (k + .5f) / num_keys;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi + k, fi * k, -fi - k)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::y_axis(), .3f * (fi + k))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f + fi * k, 1.f, 1.f + k)};
+      track.scales.push_back(skey);
+    }
+  }
+
+  AnimationBuilder builder;
+  builder.random_access = true;
+
+  // Tests all keys formats.
+  const AnimationBuilder::RotationFormat formats[] = {
+      AnimationBuilder::kRotationDefault, AnimationBuilder::kRotationCompact48,
+      AnimationBuilder::kRotationCompact32};
+  for (size_t f = 0; f < OZZ_ARRAY_SIZE(formats); ++f) {
+    builder.rotation_format = formats[f];
+    builder.compact_ratios = f != 0;
+    ozz::unique_ptr<Animation> animation(builder(raw_animation));
+    ASSERT_TRUE(animation);
+    ASSERT_TRUE(animation->random_access());
+
+    SamplingJob::Context context(7);
+    ozz::math::SoaTransform output[2];
+    ozz::math::SoaTransform ref_output[2];
+
+    // Unordered ratios, including key ratios and out of range ones.
+    const float ratios[] = {0.f,  .7f, .125f, 1.f, -1.f, .5f,
+                            .25f, .3f, 2.f,   .99f, .01f};
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+      StatelessSamplingJob job;
+      job.animation = animation.get();
+      job.ratio = ratios[i];
+      job.output = output;
+      ASSERT_TRUE(job.Run());
+
+      // Compares with a SamplingJob sampling the same ratio.
+      SamplingJob ref_job;
+      ref_job.animation = animation.get();
+      ref_job.context = &context;
+      ref_job.ratio = ratios[i];
+      ref_job.output = ref_output;
+      ASSERT_TRUE(ref_job.Run());
+
+      EXPECT_EQ(memcmp(output, ref_output, sizeof(ref_output)), 0);
+    }
+
+    {  // Output smaller than the animation.
+      ozz::math::SoaTransform small_output[1];
+      StatelessSamplingJob job;
+      job.animation = animation.get();
+      job.ratio = .3f;
+      job.output = small_output;
+      ASSERT_TRUE(job.Run());
+
+      SamplingJob ref_job;
+      ref_job.animation = animation.get();
+      ref_job.context = &context;
+      ref_job.ratio = .3f;
+      ref_job.output = ref_output;
+      ASSERT_TRUE(ref_job.Run());
+
+      EXPECT_EQ(memcmp(small_output, ref_output, sizeof(small_output)), 0);
+    }
+  }
+}
+
+TEST(ContextBuffer, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(7);
+  for (int i = 0; i < 4; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i * .3f, ozz::math::Float3(static_cast<float>(i), 0.f, 0.f)};
+    raw_animation.tracks[5].translations.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  // Buffer size is aligned, and grows with the number of tracks.
+  const size_t size = SamplingJob::Context::BufferSize(7);
+  EXPECT_EQ(size % SamplingJob::Context::kBufferAlignment, 0u);
+  EXPECT_EQ(SamplingJob::Context::BufferSize(8), size);
+  EXPECT_LT(SamplingJob::Context::BufferSize(4), size);
+  EXPECT_GT(SamplingJob::Context::BufferSize(9), size);
+
+  alignas(SamplingJob::Context::kBufferAlignment) ozz::byte buffer[4096];
+  ASSERT_LE(size + SamplingJob::Context::kBufferAlignment, sizeof(buffer));
+
+  // Invalid buffers.
+  {
+    SamplingJob::Context context;
+    EXPECT_ASSERTION(context.Resize(7, ozz::span<ozz::byte>(buffer, size - 1)),
+                     "Invalid context buffer.");
+    EXPECT_ASSERTION(context.Resize(7, ozz::span<ozz::byte>(buffer + 1, size)),
+                     "Invalid context buffer.");
+  }
+
+  SamplingJob::Context context(7, ozz::span<ozz::byte>(buffer, size));
+  EXPECT_EQ(context.max_tracks(), 8);
+  SamplingJob::Context ref_context(7);
+
+  ozz::math::SoaTransform output[2];
+  ozz::math::SoaTransform ref_output[2];
+  const float ratios[] = {0.f, .5f, .2f, 1.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+    SamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.ratio = ratios[i];
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    job.context = &ref_context;
+    job.output = ref_output;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(memcmp(output, ref_output, sizeof(ref_output)), 0);
+  }
+
+  // Context can switch back to an allocated buffer.
+  context.Resize(9);
+  EXPECT_EQ(context.max_tracks(), 12);
+}
+
+TEST(ContextBank, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+  for (int i = 0; i < 4; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i * .3f, ozz::math::Float3(0.f, static_cast<float>(i), 0.f)};
+    raw_animation.tracks[4].translations.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  {  // Empty bank.
+    SamplingJob::ContextBank bank;
+    EXPECT_EQ(bank.num_contexts(), 0);
+    EXPECT_TRUE(bank.contexts().empty());
+    bank.Resize(0, 5);
+    EXPECT_EQ(bank.num_contexts(), 0);
+  }
+
+  SamplingJob::ContextBank bank(6, 5);
+  ASSERT_EQ(bank.num_contexts(), 6);
+
+  // Contexts buffers are contiguous.
+  const ozz::span<SamplingJob::Context> contexts = bank.contexts();
+  for (SamplingJob::Context& context : contexts) {
+    EXPECT_EQ(context.max_tracks(), 8);
+  }
+
+  // Samples contexts with different ratios, using a batch job.
+  ozz::math::SoaTransform outputs[6][2];
+  ozz::animation::BatchSamplingJob::Instance instances[6];
+  float ratios[6];
+  for (int i = 0; i < 6; ++i) {
+    instances[i].context = &contexts[i];
+    instances[i].output = outputs[i];
+    ratios[i] = i / 5.f;
+  }
+  ozz::animation::BatchSamplingJob batch_job;
+  batch_job.animation = animation.get();
+  batch_job.ratios = ratios;
+  batch_job.instances = instances;
+  ASSERT_TRUE(batch_job.Run());
+
+  SamplingJob::Context ref_context(5);
+  for (int i = 0; i < 6; ++i) {
+    ozz::math::SoaTransform ref_output[2];
+    SamplingJob job;
+    job.animation = animation.get();
+    job.context = &ref_context;
+    job.ratio = ratios[i];
+    job.output = ref_output;
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(memcmp(outputs[i], ref_output, sizeof(ref_output)), 0);
+  }
+
+  // Resizing destroys previous contexts.
+  bank.Resize(2, 40);
+  ASSERT_EQ(bank.num_contexts(), 2);
+  EXPECT_EQ(bank.contexts()[1].max_tracks(), 40);
+}
+
+TEST(Snapshot, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(9);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i);
+    for (int k = 0; k <= 20; ++k) {
+      const float time = k / 20.f;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi, fi * k, -fi - k)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::x_axis(), .1f * (fi + k))};
+      track.rotations.push_back(rkey);
+    }
+  }
+
+  AnimationBuilder builder;
+  builder.random_access = false;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  // Snapshot size grows with the number of tracks, it's aligned to soa tracks.
+  const size_t size = SamplingJob::Context::SnapshotSize(9);
+  EXPECT_EQ(SamplingJob::Context::SnapshotSize(12), size);
+  EXPECT_LT(SamplingJob::Context::SnapshotSize(8), size);
+  EXPECT_LT(size, SamplingJob::Context::BufferSize(9) + 64);
+
+  ozz::byte snapshot[4096];
+  ASSERT_LE(size + 1, sizeof(snapshot));
+
+  SamplingJob::Context context(9);
+  SamplingJob::Context ref_context(9);
+  ozz::math::SoaTransform output[3];
+  ozz::math::SoaTransform ref_output[3];
+
+  SamplingJob::Stats stats;
+  SamplingJob job;
+  job.animation = animation.get();
+  job.context = &context;
+  job.output = output;
+  job.stats = &stats;
+
+  // An invalid context snapshot has no track.
+  EXPECT_LT(context.Snapshot(snapshot), size);
+
+  // Plays forward, saving context state at frame 10.
+  for (int f = 0; f <= 20; ++f) {
+    job.ratio = f / 30.f;
+    ASSERT_TRUE(job.Run());
+    if (f == 10) {
+      EXPECT_EQ(context.Snapshot({snapshot, size - 1}), 0u);
+      EXPECT_EQ(context.Snapshot({snapshot, sizeof(snapshot)}), size);
+    }
+  }
+
+  // Rolls back to frame 10 and resimulates. Playback continues forward from
+  // the restored state, without invalidation, and matches a context that
+  // played frames 0 to 10 only.
+  EXPECT_TRUE(context.Restore({snapshot, size}));
+  stats = SamplingJob::Stats();
+  for (int f = 0; f <= 20; ++f) {
+    SamplingJob ref_job;
+    ref_job.animation = animation.get();
+    ref_job.context = &ref_context;
+    ref_job.ratio = f / 30.f;
+    ref_job.output = ref_output;
+    ASSERT_TRUE(ref_job.Run());
+    if (f > 10) {
+      job.ratio = ref_job.ratio;
+      ASSERT_TRUE(job.Run());
+      EXPECT_EQ(memcmp(output, ref_output, sizeof(ref_output)), 0);
+    }
+  }
+  EXPECT_EQ(stats.invalidations, 0);
+
+  // A snapshot can be restored to another big enough context.
+  SamplingJob::Context other(12);
+  EXPECT_TRUE(other.Restore({snapshot, size}));
+  job.context = &other;
+  job.ratio = 11.f / 30.f;
+  stats = SamplingJob::Stats();
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(stats.invalidations, 0);
+
+  // Invalid snapshots invalidate the context.
+  SamplingJob::Context small(4);
+  EXPECT_FALSE(small.Restore({snapshot, size}));
+  EXPECT_FALSE(other.Restore({snapshot, size - 1}));
+  stats = SamplingJob::Stats();
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(stats.invalidations, 1);
+}
+
+TEST(Plan, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(7);
+  for (int i = 0; i < 4; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i * .3f, ozz::math::Float3(static_cast<float>(i), 0.f, 0.f)};
+    raw_animation.tracks[5].translations.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  SamplingJob::Context context(7);
+  SamplingJob::Context ref_context(7);
+  ozz::math::SoaTransform output[2];
+  ozz::math::SoaTransform ref_output[2];
+
+  // Invalid plans.
+  ozz::JobPlan<SamplingJob> plan;
+  EXPECT_FALSE(plan.valid());
+  EXPECT_ASSERTION(plan.Execute(), "Plan job isn't valid.");
+
+  SamplingJob job;
+  job.animation = animation.get();
+  job.output = output;
+  EXPECT_FALSE(plan.Reset(job));
+  EXPECT_FALSE(plan.valid());
+
+  // Valid plan, whose ratio is updated before each execution.
+  job.context = &context;
+  EXPECT_TRUE(plan.Reset(job));
+  EXPECT_TRUE(plan.valid());
+  EXPECT_EQ(plan.job().context, &context);
+
+  const float ratios[] = {0.f, .5f, .2f, 1.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+    plan.mutable_job()->ratio = ratios[i];
+    EXPECT_TRUE(plan.Execute());
+
+    SamplingJob ref_job;
+    ref_job.animation = animation.get();
+    ref_job.context = &ref_context;
+    ref_job.ratio = ratios[i];
+    ref_job.output = ref_output;
+    ASSERT_TRUE(ref_job.Run());
+    EXPECT_EQ(memcmp(output, ref_output, sizeof(ref_output)), 0);
+  }
+
+  // Reloaded animations are detected in all builds, until the plan is reset.
+  {
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream);
+    o << *animation;
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    ASSERT_TRUE(animation->Reload(i));
+  }
+  EXPECT_FALSE(plan.Execute());
+  EXPECT_FALSE(plan.Execute());
+  EXPECT_TRUE(plan.Reset(plan.job()));
+  EXPECT_TRUE(plan.Execute());
+
+  // Changes that invalidate the job are detected in debug builds.
+  context.Resize(4);
+  EXPECT_ASSERTION(plan.Execute(), "Plan job was invalidated.");
+}
+
+TEST(SearchKeys, SamplingJob) {
+  // Builds an animation with many keys, so that large ratio steps are
+  // searched for rather than iterated.
+  RawAnimation raw_animation;
+  raw_animation.duration = 4.f;
+  raw_animation.tracks.resize(6);
+  for (size_t i = 0; i < raw_animation.tracks.size(); ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    const float fi = static_cast<float>(i);
+    const int num_keys = 60 + static_cast<int>(i) * 7;
+    for (int k = 0; k < num_keys; ++k) {
+      const float time = raw_animation.duration * k / num_keys;
+      const RawAnimation::TranslationKey tkey = {
+          time, ozz::math::Float3(fi + k, fi * k, -fi - k)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+          time, ozz::math::Quaternion::FromAxisAngle(
+                    ozz::math::Float3::z_axis(), .05f * (fi + k))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+          time, ozz::math::Float3(1.f + fi * k, 1.f, 1.f + k)};
+      track.scales.push_back(skey);
+    }
+  }
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+  builder.random_access = true;
+  ozz::unique_ptr<Animation> ra_animation(builder(raw_animation));
+  ASSERT_TRUE(ra_animation);
+  builder.bidirectional = true;
+  ozz::unique_ptr<Animation> ra_bidir_animation(builder(raw_animation));
+  ASSERT_TRUE(ra_bidir_animation);
+
+  const Animation* animations[] = {ra_animation.get(),
+                                   ra_bidir_animation.get()};
+  for (size_t a = 0; a < OZZ_ARRAY_SIZE(animations); ++a) {
+    SamplingJob::Context context(6);
+    SamplingJob::Context ref_context(6);
+    ozz::math::SoaTransform output[2];
+    ozz::math::SoaTransform ref_output[2];
+
+    // Small and large steps, forward and backward, exact key ratios.
+    const float ratios[] = {0.f,  .01f, .02f, .3f,  .31f, .9f, .5f, .49f,
+                            .48f, 1.f,  .1f,  .75f, .76f, 0.f, .6f, .25f};
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+      SamplingJob job;
+      job.animation = animations[a];
+      job.context = &context;
+      job.ratio = ratios[i];
+      job.output = output;
+      ASSERT_TRUE(job.Run());
+
+      // Compares with keys iterated from scratch.
+      ref_context.Invalidate();
+      SamplingJob ref_job;
+      ref_job.animation = animation.get();
+      ref_job.context = &ref_context;
+      ref_job.ratio = ratios[i];
+      ref_job.output = ref_output;
+      ASSERT_TRUE(ref_job.Run());
+
+      EXPECT_EQ(memcmp(output, ref_output, sizeof(ref_output)), 0);
+    }
+  }
+}
+
+TEST(Cubic, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  RawAnimation::JointTrack& track = raw_animation.tracks[0];
+  const RawAnimation::TranslationKey tkeys[] = {
+      {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+      {.5f, ozz::math::Float3(1.f, 2.f, 4.f)},
+      {1.f, ozz::math::Float3(0.f, 0.f, 0.f)}};
+  track.translations.assign(tkeys, tkeys + OZZ_ARRAY_SIZE(tkeys));
+  const RawAnimation::ScaleKey skeys[] = {
+      {0.f, ozz::math::Float3(1.f, 1.f, 1.f)},
+      {.5f, ozz::math::Float3(2.f, 2.f, 2.f)},
+      {1.f, ozz::math::Float3(1.f, 1.f, 1.f)}};
+  track.scales.assign(skeys, skeys + OZZ_ARRAY_SIZE(skeys));
+
+  AnimationBuilder builder;
+  builder.cubic_interpolation = true;
+  builder.random_access = true;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+  ASSERT_TRUE(animation->cubic());
+  EXPECT_EQ(animation->translation_tangents().size(),
+            animation->translations().size() * 3);
+  EXPECT_EQ(animation->scale_tangents().size(),
+            animation->scales().size() * 3);
+
+  SamplingJob::Context context(1, true);
+  ozz::math::SoaTransform output[1];
+  SamplingJob job;
+  job.animation = animation.get();
+  job.context = &context;
+  job.output = output;
+
+  // Keys values are matched.
+  job.ratio = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 0.f, 0.f, 0.f, 2.f, 0.f,
+                          0.f, 0.f, 4.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 2.f, 1.f, 1.f, 1.f, 2.f, 1.f, 1.f,
+                          1.f, 2.f, 1.f, 1.f, 1.f);
+
+  // Between keys, the curve overshoots linear interpolation (.5 of the key
+  // value), as first and last keys tangents point to the middle key.
+  job.ratio = .25f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, .625f, 0.f, 0.f, 0.f, 1.25f,
+                          0.f, 0.f, 0.f, 2.5f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 1.625f, 1.f, 1.f, 1.f, 1.625f, 1.f,
+                          1.f, 1.f, 1.625f, 1.f, 1.f, 1.f);
+  job.ratio = .75f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, .625f, 0.f, 0.f, 0.f, 1.25f,
+                          0.f, 0.f, 0.f, 2.5f, 0.f, 0.f, 0.f);
+
+  // StatelessSamplingJob gives the same result.
+  const float ratios[] = {0.f, .1f, .25f, .5f, .6f, 1.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+    job.ratio = ratios[i];
+    ASSERT_TRUE(job.Run());
+
+    ozz::math::SoaTransform stateless_output[1];
+    StatelessSamplingJob stateless_job;
+    stateless_job.animation = animation.get();
+    stateless_job.ratio = ratios[i];
+    stateless_job.output = stateless_output;
+    ASSERT_TRUE(stateless_job.Run());
+
+    EXPECT_EQ(memcmp(output, stateless_output, sizeof(output)), 0);
+  }
+}
+
+TEST(CubicTangents, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+  for (int i = 0; i < 5; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k < 5; ++k) {
+      const float value = static_cast<float>((i + 1) * (k % 3));
+      const RawAnimation::TranslationKey tkey = {
+          k * .25f, ozz::math::Float3(value, -value, 1.f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::ScaleKey skey = {
+          k * .25f, ozz::math::Float3(1.f + value)};
+      track.scales.push_back(skey);
+    }
+  }
+
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> linear(builder(raw_animation));
+  builder.cubic_interpolation = true;
+  ozz::unique_ptr<Animation> cubic(builder(raw_animation));
+  ASSERT_TRUE(linear && cubic);
+
+  // References are sampled with a fresh context per ratio.
+  const float ratios[] = {.1f, .3f, .6f, .9f};
+  ozz::math::SoaTransform expected[OZZ_ARRAY_SIZE(ratios)][2];
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+    SamplingJob::Context context(5, true);
+    SamplingJob job;
+    job.animation = cubic.get();
+    job.context = &context;
+    job.ratio = ratios[i];
+    job.output = expected[i];
+    ASSERT_TRUE(job.Run());
+  }
+
+  // Tangents are only stored by contexts resized for cubic animations.
+  EXPECT_GT(SamplingJob::Context::BufferSize(5, true),
+            SamplingJob::Context::BufferSize(5));
+  {
+    SamplingJob::Context context(5);
+    EXPECT_FALSE(context.cubic());
+    ozz::math::SoaTransform output[2];
+    SamplingJob job;
+    job.context = &context;
+    job.output = output;
+    job.animation = linear.get();
+    EXPECT_TRUE(job.Run());
+
+    // Cubic animations fail validation rather than allocating tangents.
+    job.animation = cubic.get();
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+
+    context.Resize(5, true);
+    EXPECT_TRUE(context.cubic());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::TrackingAllocator tracking;
+  ozz::memory::Allocator* previous =
+      ozz::memory::SetDefaulAllocator(&tracking);
+  {
+    // Contexts bound to a caller buffer never allocate, even for cubic
+    // animations.
+    const size_t size = SamplingJob::Context::BufferSize(5, true);
+    alignas(SamplingJob::Context::kBufferAlignment) ozz::byte buffer[4096];
+    ASSERT_LE(size, sizeof(buffer));
+    SamplingJob::Context context(5, {buffer, size}, true);
+    EXPECT_TRUE(context.cubic());
+
+    ozz::math::SoaTransform output[2];
+    SamplingJob job;
+    job.context = &context;
+    job.output = output;
+    job.animation = linear.get();
+    job.ratio = ratios[0];
+    ASSERT_TRUE(job.Run());
+    job.animation = cubic.get();
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+      job.ratio = ratios[i];
+      ASSERT_TRUE(job.Run());
+      EXPECT_EQ(memcmp(output, expected[i], sizeof(output)), 0);
+    }
+    EXPECT_EQ(tracking.stats(ozz::memory::kTagContext).live_allocations, 0u);
+  }
+  {
+    SamplingJob::ContextBank bank(2, 5, true);
+    EXPECT_EQ(tracking.stats(ozz::memory::kTagContext).live_allocations, 1u);
+    const ozz::span<SamplingJob::Context> contexts = bank.contexts();
+    EXPECT_TRUE(contexts[0].cubic() && contexts[1].cubic());
+
+    ozz::math::SoaTransform output[2];
+    SamplingJob job;
+    job.context = &contexts[0];
+    job.output = output;
+    job.animation = cubic.get();
+
+    // Snapshots don't include tangents, which are decompressed again once
+    // restored.
+    job.ratio = ratios[1];
+    ASSERT_TRUE(job.Run());
+    ozz::vector<ozz::byte> snapshot(SamplingJob::Context::SnapshotSize(5));
+    ASSERT_NE(contexts[0].Snapshot(make_span(snapshot)), 0u);
+    ASSERT_TRUE(contexts[1].Restore(make_span(snapshot)));
+    job.context = &contexts[1];
+    job.ratio = ratios[2];
+    ASSERT_TRUE(job.Run());
+    EXPECT_EQ(memcmp(output, expected[2], sizeof(output)), 0);
+    EXPECT_EQ(tracking.stats(ozz::memory::kTagContext).live_allocations, 1u);
+  }
+  ozz::memory::SetDefaulAllocator(previous);
+  {
+    // Batch seeding copies tangents from the previous instance context.
+    SamplingJob::Context context0(5, true);
+    SamplingJob::Context context1(5, true);
+    ozz::math::SoaTransform outputs[2][2];
+    const ozz::animation::BatchSamplingJob::Instance instances[2] = {
+        {&context0, outputs[0]}, {&context1, outputs[1]}};
+    const float batch_ratios[2] = {ratios[1], ratios[2]};
+    ozz::animation::BatchSamplingJob batch;
+    batch.animation = cubic.get();
+    batch.instances = instances;
+    batch.ratios = batch_ratios;
+    ASSERT_TRUE(batch.Run());
+    EXPECT_EQ(memcmp(outputs[0], expected[1], sizeof(outputs[0])), 0);
+    EXPECT_EQ(memcmp(outputs[1], expected[2], sizeof(outputs[1])), 0);
+
+    // Batch fails validation if any instance context can't sample cubic
+    // animations.
+    context1.Resize(5);
+    EXPECT_FALSE(batch.Validate());
+  }
+}
+
+namespace {
+// Expects _velocities to match the central finite difference of
+// _animation translations (or rotations if _angular), sampled around _ratio.
+void ExpectFiniteDifferences(
+    const Animation& _animation, float _ratio, bool _angular,
+    ozz::span<const ozz::math::SoaFloat3> _velocities) {
+  const float h = 1e-3f;
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  ozz::vector<ozz::math::SoaTransform> before(num_soa_tracks);
+  ozz::vector<ozz::math::SoaTransform> after(num_soa_tracks);
+  SamplingJob::Context context(_animation.num_tracks(), _animation.cubic());
+  SamplingJob job;
+  job.animation = &_animation;
+  job.context = &context;
+  job.ratio = _ratio - h;
+  job.output = make_span(before);
+  ASSERT_TRUE(job.Run());
+  job.ratio = _ratio + h;
+  job.output = make_span(after);
+  ASSERT_TRUE(job.Run());
+
+  const float rcp_dt = 1.f / (2.f * h * _animation.duration());
+  for (size_t i = 0; i < _velocities.size(); ++i) {
+    ozz::math::SoaFloat3 expected;
+    if (_angular) {
+      // Vector part of the rotation from before to after, which is half the
+      // rotation angle for small angles.
+      const ozz::math::SoaQuaternion delta =
+          after[i].rotation * Conjugate(before[i].rotation);
+      const ozz::math::SimdFloat4 scale =
+          ozz::math::simd_float4::Load1(2.f * rcp_dt);
+      expected = ozz::math::SoaFloat3::Load(delta.x * scale, delta.y * scale,
+                                            delta.z * scale);
+    } else {
+      expected = (after[i].translation - before[i].translation) *
+                 ozz::math::simd_float4::Load1(rcp_dt);
+    }
+    const ozz::math::SimdFloat4 values[2][3] = {
+        {expected.x, expected.y, expected.z},
+        {_velocities[i].x, _velocities[i].y, _velocities[i].z}};
+    for (int c = 0; c < 3; ++c) {
+      float e[4], v[4];
+      ozz::math::StorePtrU(values[0][c], e);
+      ozz::math::StorePtrU(values[1][c], v);
+      for (int l = 0; l < 4; ++l) {
+        EXPECT_NEAR(v[l], e[l], 1e-2f);
+      }
+    }
+  }
+}
+}  // namespace
+
+TEST(Velocities, SamplingJob) {
+  // 2s animation, with 5 tracks (2 SoA entries).
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(5);
+
+  // Track 0 moves along x at 1 unit per second, and turns a quarter around y
+  // over the whole animation.
+  const RawAnimation::TranslationKey t0[] = {
+      {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+      {2.f, ozz::math::Float3(2.f, 0.f, 0.f)}};
+  raw_animation.tracks[0].translations.assign(t0, t0 + OZZ_ARRAY_SIZE(t0));
+  const RawAnimation::RotationKey r0[] = {
+      {0.f, ozz::math::Quaternion::identity()},
+      {2.f, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                 ozz::math::kPi_2)}};
+  raw_animation.tracks[0].rotations.assign(r0, r0 + OZZ_ARRAY_SIZE(r0));
+
+  // Track 4 has 3 keys on both translation and rotation.
+  const RawAnimation::TranslationKey t4[] = {
+      {0.f, ozz::math::Float3(0.f, 0.f, 0.f)},
+      {.5f, ozz::math::Float3(0.f, 1.f, 0.f)},
+      {2.f, ozz::math::Float3(0.f, 1.f, 3.f)}};
+  raw_animation.tracks[4].translations.assign(t4, t4 + OZZ_ARRAY_SIZE(t4));
+  const RawAnimation::RotationKey r4[] = {
+      {0.f, ozz::math::Quaternion::identity()},
+      {1.f, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::x_axis(),
+                                                 1.f)},
+      {2.f, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::z_axis(),
+                                                 .5f)}};
+  raw_animation.tracks[4].rotations.assign(r4, r4 + OZZ_ARRAY_SIZE(r4));
+
+  for (int cubic = 0; cubic < 2; ++cubic) {
+    AnimationBuilder builder;
+    builder.cubic_interpolation = cubic != 0;
+    ozz::unique_ptr<Animation> animation(builder(raw_animation));
+    ASSERT_TRUE(animation);
+
+    SamplingJob::Context context(5, animation->cubic());
+    ozz::math::SoaTransform output[2];
+    ozz::math::SoaFloat3 linear[2];
+    ozz::math::SoaFloat3 angular[2];
+    SamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.output = output;
+    job.linear_velocities = linear;
+    job.angular_velocities = angular;
+
+    if (!cubic) {
+      // Analytic values.
+      job.ratio = .3f;
+      ASSERT_TRUE(job.Run());
+      EXPECT_SOAFLOAT3_EQ_EST(linear[0], 1.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f, 0.f);
+      // Tracks 1 to 3 don't move.
+      float constant_y[4];
+      ozz::math::StorePtrU(angular[0].y, constant_y);
+      EXPECT_EQ(constant_y[1], 0.f);
+      EXPECT_EQ(constant_y[2], 0.f);
+      EXPECT_EQ(constant_y[3], 0.f);
+      // Normalized lerp angular velocity is around y, faster than slerp
+      // (pi/4 per second) in the middle of the interval.
+      job.ratio = .5f;
+      ASSERT_TRUE(job.Run());
+      float y[4];
+      ozz::math::StorePtrU(angular[0].y, y);
+      EXPECT_GT(y[0], ozz::math::kPi_4);
+      EXPECT_LT(y[0], ozz::math::kPi_4 * 1.2f);
+    }
+
+    const float ratios[] = {0.1f, .2f, .3f, .55f, .7f, .9f};
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(ratios); ++i) {
+      job.ratio = ratios[i];
+      ASSERT_TRUE(job.Run());
+      ExpectFiniteDifferences(*animation, ratios[i], false, linear);
+      ExpectFiniteDifferences(*animation, ratios[i], true, angular);
+    }
+  }
+
+  {  // Velocities outputs can be smaller than the output, or missing.
+    ozz::unique_ptr<Animation> animation(AnimationBuilder()(raw_animation));
+    ASSERT_TRUE(animation);
+    SamplingJob::Context context(5);
+    ozz::math::SoaTransform output[2];
+    ozz::math::SoaFloat3 linear[1];
+    ozz::math::SoaFloat3 angular[2];
+    const ozz::math::SimdFloat4 sentinel =
+        ozz::math::simd_float4::Load1(42.f);
+    angular[1] = ozz::math::SoaFloat3::Load(sentinel, sentinel, sentinel);
+    SamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.output = output;
+    job.linear_velocities = linear;
+    job.angular_velocities = ozz::make_span(angular).first(1);
+    job.ratio = .3f;
+    ASSERT_TRUE(job.Run());
+    ExpectFiniteDifferences(*animation, .3f, false, linear);
+    EXPECT_SOAFLOAT3_EQ(angular[1], 42.f, 42.f, 42.f, 42.f, 42.f, 42.f, 42.f,
+                        42.f, 42.f, 42.f, 42.f, 42.f);
+  }
+}
+
+TEST(HalfOutput, SamplingJob) {
+  // Builds an animation of 6 tracks (2 SoA tracks).
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+  for (int t = 0; t < 6; ++t) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[t];
+    const float f = static_cast<float>(t);
+    const RawAnimation::TranslationKey t0 = {0.f,
+                                             ozz::math::Float3(f, 0.f, -f)};
+    const RawAnimation::TranslationKey t1 = {
+        1.f, ozz::math::Float3(2.f * f, 1.f, 0.f)};
+    track.translations.push_back(t0);
+    track.translations.push_back(t1);
+    const RawAnimation::RotationKey r0 = {
+        0.f, ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                                  f * .1f)};
+    track.rotations.push_back(r0);
+    const RawAnimation::ScaleKey s0 = {0.f, ozz::math::Float3(1.f, 2.f, .5f)};
+    track.scales.push_back(s0);
+  }
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation = builder(raw_animation);
+  ASSERT_TRUE(animation);
+
+  SamplingJob::Context context(6);
+  ozz::math::SoaTransform output[2];
+  ozz::math::SoaHalfTransform half_output[2];
+  SamplingJob job;
+  job.animation = animation.get();
+  job.context = &context;
+  job.ratio = .5f;
+
+  // Exactly one of output and half_output must be set.
+  EXPECT_FALSE(job.Validate());
+  job.output = output;
+  job.half_output = half_output;
+  EXPECT_FALSE(job.Validate());
+
+  job.half_output = {};
+  ASSERT_TRUE(job.Run());
+  job.output = {};
+  job.half_output = half_output;
+  ASSERT_TRUE(job.Run());
+
+  for (int i = 0; i < 2; ++i) {
+    ozz::math::SoaTransform unpacked;
+    ozz::math::UnpackHalf(half_output[i], &unpacked);
+    const float* expected = reinterpret_cast<const float*>(&output[i]);
+    const float* actual = reinterpret_cast<const float*>(&unpacked);
+    for (size_t j = 0; j < sizeof(unpacked) / sizeof(float); ++j) {
+      EXPECT_NEAR(actual[j], expected[j], 2e-3f) << i << " " << j;
+    }
+  }
+
+  // Masked out entries are left unchanged.
+  ozz::math::SoaHalfTransform sentinel;
+  std::memset(&sentinel, 0x3c, sizeof(sentinel));
+  half_output[1] = sentinel;
+  const uint8_t mask[] = {0x1};
+  job.mask = mask;
+  job.ratio = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(std::memcmp(&half_output[1], &sentinel, sizeof(sentinel)), 0);
+  ozz::math::SoaTransform unpacked;
+  ozz::math::UnpackHalf(half_output[0], &unpacked);
+  EXPECT_SOAFLOAT3_EQ_EST(unpacked.translation, 0.f, 2.f, 4.f, 6.f, 1.f, 1.f,
+                          1.f, 1.f, 0.f, 0.f, 0.f, 0.f);
+
+  // Only as much as there's half output for is sampled.
+  job.mask = {};
+  half_output[1] = sentinel;
+  job.half_output = {half_output, 1};
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(std::memcmp(&half_output[1], &sentinel, sizeof(sentinel)), 0);
+}
@@ -0,0 +1,112 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/segmented_animation.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/segmented_animation_builder.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::SegmentedAnimation;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::SegmentedAnimationBuilder;
+
+TEST(Empty, SegmentedAnimationSerialize) {
+  ozz::io::MemoryStream stream;
+
+  // Streams out.
+  ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+
+  SegmentedAnimation o_animation;
+  o << o_animation;
+
+  // Streams in.
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+
+  SegmentedAnimation i_animation;
+  i >> i_animation;
+
+  EXPECT_EQ(o_animation.num_tracks(), i_animation.num_tracks());
+  EXPECT_EQ(i_animation.num_segments(), 0);
+}
+
+TEST(Filled, SegmentedAnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 5.f;
+  raw_animation.name = "segmented";
+  raw_animation.tracks.resize(2);
+  for (int i = 0; i <= 10; ++i) {
+    const RawAnimation::TranslationKey key = {
+        i * .5f, ozz::math::Float3(i * 1.f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+
+  SegmentedAnimationBuilder builder;
+  builder.segment_duration = 2.f;
+  ozz::unique_ptr<SegmentedAnimation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+  ASSERT_EQ(o_animation->num_segments(), 3);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    SegmentedAnimation i_animation;
+    i >> i_animation;
+
+    // The whole stream was read.
+    EXPECT_EQ(static_cast<size_t>(stream.Tell()), stream.Size());
+
+    EXPECT_FLOAT_EQ(i_animation.duration(), o_animation->duration());
+    EXPECT_EQ(i_animation.num_tracks(), o_animation->num_tracks());
+    EXPECT_STREQ(i_animation.name(), o_animation->name());
+    ASSERT_EQ(i_animation.num_segments(), o_animation->num_segments());
+    EXPECT_EQ(i_animation.size(), o_animation->size());
+    for (int s = 0; s < i_animation.num_segments(); ++s) {
+      EXPECT_FLOAT_EQ(i_animation.segment_ratios()[s],
+                      o_animation->segment_ratios()[s]);
+      EXPECT_FLOAT_EQ(i_animation.segment(s).duration(),
+                      o_animation->segment(s).duration());
+      EXPECT_EQ(i_animation.segment(s).num_tracks(),
+                o_animation->segment(s).num_tracks());
+      EXPECT_EQ(i_animation.segment(s).size(), o_animation->segment(s).size());
+    }
+  }
+}
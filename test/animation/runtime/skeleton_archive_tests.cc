@@ -25,13 +25,19 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
 #include "ozz/animation/runtime/skeleton.h"
 #include "ozz/base/io/archive.h"
+#include "ozz/base/io/asset_registry.h"
+#include "ozz/base/io/async_load.h"
 #include "ozz/base/io/stream.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
 #include "ozz/base/memory/unique_ptr.h"
 
 using ozz::animation::Skeleton;
@@ -106,6 +112,11 @@ TEST(Filled, SkeletonSerialize) {
     for (int i = 0; i < i_skeleton.num_joints(); ++i) {
       EXPECT_EQ(i_skeleton.joint_parents()[i], o_skeleton->joint_parents()[i]);
       EXPECT_STREQ(i_skeleton.joint_names()[i], o_skeleton->joint_names()[i]);
+      EXPECT_EQ(i_skeleton.joint_subtree_ends()[i],
+                o_skeleton->joint_subtree_ends()[i]);
+      EXPECT_EQ(i_skeleton.joint_depths()[i], o_skeleton->joint_depths()[i]);
+      EXPECT_EQ(i_skeleton.joint_children(i).size(),
+                o_skeleton->joint_children(i).size());
     }
     for (int i = 0; i < (i_skeleton.num_joints() + 3) / 4; ++i) {
       EXPECT_TRUE(
@@ -171,3 +182,254 @@ TEST(AlreadyInitialized, SkeletonSerialize) {
     EXPECT_STREQ(i_skeleton.joint_names()[1], o_skeleton[1]->joint_names()[1]);
   }
 }
+
+TEST(Image, SkeletonSerialize) {
+  ozz::unique_ptr<Skeleton> o_skeleton;
+  {
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    RawSkeleton::Joint& root = raw_skeleton.roots[0];
+    root.name = "root";
+    root.transform.translation = ozz::math::Float3(1.f, 2.f, 3.f);
+    root.children.resize(5);
+    for (size_t i = 0; i < root.children.size(); ++i) {
+      root.children[i].name = "joint" + ozz::string(i, 'x');
+      root.children[i].transform.scale = ozz::math::Float3(i * 1.f);
+    }
+
+    SkeletonBuilder builder;
+    o_skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(o_skeleton);
+  }
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t image_size = o_skeleton->image_size();
+  ozz::span<ozz::byte> image = {
+      static_cast<ozz::byte*>(
+          allocator->Allocate(image_size + 1, Skeleton::kImageAlignment)),
+      image_size + 1};
+
+  // Invalid buffers.
+  EXPECT_FALSE(o_skeleton->ToImage({image.data(), image_size - 1}));
+  EXPECT_FALSE(o_skeleton->ToImage({image.data() + 1, image_size}));
+  ASSERT_TRUE(o_skeleton->ToImage({image.data(), image_size}));
+
+  {  // Invalid images.
+    Skeleton i_skeleton;
+    EXPECT_FALSE(i_skeleton.FromImage({image.data(), image_size - 1}));
+    EXPECT_FALSE(i_skeleton.FromImage({image.data() + 1, image_size}));
+    EXPECT_FALSE(i_skeleton.FromImage({image.data(), 4}));
+    EXPECT_EQ(i_skeleton.num_joints(), 0);
+
+    image[0] = static_cast<ozz::byte>(~image[0]);
+    EXPECT_FALSE(i_skeleton.FromImage({image.data(), image_size}));
+    image[0] = static_cast<ozz::byte>(~image[0]);
+  }
+
+  // Images are relocatable, so it's tested from a copy.
+  ozz::span<ozz::byte> copy = {
+      static_cast<ozz::byte*>(
+          allocator->Allocate(image_size, Skeleton::kImageAlignment)),
+      image_size};
+  std::memcpy(copy.data(), image.data(), image_size);
+  allocator->Deallocate(image.data());
+
+  {
+    Skeleton i_skeleton;
+    ASSERT_TRUE(i_skeleton.FromImage({copy.data(), copy.size()}));
+    EXPECT_EQ(i_skeleton.image_size(), image_size);
+
+    // Data point to the image.
+    const ozz::byte* poses = reinterpret_cast<const ozz::byte*>(
+        i_skeleton.joint_rest_poses().data());
+    EXPECT_TRUE(poses > copy.data() && poses < copy.data() + image_size);
+
+    // Compares skeletons.
+    ASSERT_EQ(o_skeleton->num_joints(), i_skeleton.num_joints());
+    for (int i = 0; i < i_skeleton.num_joints(); ++i) {
+      EXPECT_EQ(i_skeleton.joint_parents()[i], o_skeleton->joint_parents()[i]);
+      EXPECT_STREQ(i_skeleton.joint_names()[i], o_skeleton->joint_names()[i]);
+      EXPECT_EQ(i_skeleton.joint_subtree_ends()[i],
+                o_skeleton->joint_subtree_ends()[i]);
+      EXPECT_EQ(i_skeleton.joint_depths()[i], o_skeleton->joint_depths()[i]);
+      EXPECT_EQ(i_skeleton.joint_children(i).size(),
+                o_skeleton->joint_children(i).size());
+    }
+    for (int i = 0; i < i_skeleton.num_soa_joints(); ++i) {
+      EXPECT_TRUE(
+          ozz::math::AreAllTrue(i_skeleton.joint_rest_poses()[i].translation ==
+                                o_skeleton->joint_rest_poses()[i].translation));
+      EXPECT_TRUE(
+          ozz::math::AreAllTrue(i_skeleton.joint_rest_poses()[i].rotation ==
+                                o_skeleton->joint_rest_poses()[i].rotation));
+      EXPECT_TRUE(
+          ozz::math::AreAllTrue(i_skeleton.joint_rest_poses()[i].scale ==
+                                o_skeleton->joint_rest_poses()[i].scale));
+    }
+  }
+  allocator->Deallocate(copy.data());
+}
+
+TEST(NameHashes, SkeletonSerialize) {
+  ozz::unique_ptr<Skeleton> o_skeleton;
+  {
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    RawSkeleton::Joint& root = raw_skeleton.roots[0];
+    root.name = "root";
+    root.children.resize(5);
+    for (size_t i = 0; i < root.children.size(); ++i) {
+      root.children[i].name = "joint" + ozz::string(i, 'x');
+    }
+
+    SkeletonBuilder builder;
+    o_skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(o_skeleton);
+  }
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::OArchive o(&stream, endianess);
+      o << *o_skeleton;
+    }
+
+    // Names are only hashed while loading.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    Skeleton hashes(nullptr, Skeleton::kNameHashes);
+    {
+      ozz::io::IArchive ia(&stream);
+      ia >> hashes;
+    }
+    ASSERT_EQ(hashes.num_joints(), o_skeleton->num_joints());
+    EXPECT_TRUE(hashes.joint_names().empty());
+    for (int i = 0; i < hashes.num_joints(); ++i) {
+      EXPECT_EQ(hashes.joint_parents()[i], o_skeleton->joint_parents()[i]);
+      EXPECT_EQ(hashes.joint_name_hashes()[i],
+                o_skeleton->joint_name_hashes()[i]);
+      EXPECT_EQ(hashes.FindJointByHash(Skeleton::HashName(
+                    o_skeleton->joint_names()[i])),
+                i);
+    }
+
+    // Skeleton is saved with empty names.
+    ozz::io::MemoryStream hashes_stream;
+    {
+      ozz::io::OArchive o(&hashes_stream, endianess);
+      o << hashes;
+    }
+    hashes_stream.Seek(0, ozz::io::Stream::kSet);
+    Skeleton strings;
+    {
+      ozz::io::IArchive ia(&hashes_stream);
+      ia >> strings;
+    }
+    ASSERT_EQ(strings.num_joints(), o_skeleton->num_joints());
+    for (int i = 0; i < strings.num_joints(); ++i) {
+      EXPECT_EQ(strings.joint_parents()[i], o_skeleton->joint_parents()[i]);
+      EXPECT_STREQ(strings.joint_names()[i], "");
+    }
+  }
+
+  // Images.
+  Skeleton hashes(nullptr, Skeleton::kNameHashes);
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t image_size = o_skeleton->image_size();
+  ozz::span<ozz::byte> image = {
+      static_cast<ozz::byte*>(
+          allocator->Allocate(image_size, Skeleton::kImageAlignment)),
+      image_size};
+  ASSERT_TRUE(o_skeleton->ToImage(image));
+  ASSERT_TRUE(hashes.FromImage(image));
+  ASSERT_EQ(hashes.num_joints(), o_skeleton->num_joints());
+  EXPECT_TRUE(hashes.joint_names().empty());
+  for (int i = 0; i < hashes.num_joints(); ++i) {
+    EXPECT_EQ(hashes.joint_name_hashes()[i],
+              o_skeleton->joint_name_hashes()[i]);
+  }
+
+  // Skeletons storing hashes are imaged with empty names.
+  const size_t hashes_image_size = hashes.image_size();
+  EXPECT_LT(hashes_image_size, image_size);
+  ozz::span<ozz::byte> hashes_image = {
+      static_cast<ozz::byte*>(
+          allocator->Allocate(hashes_image_size, Skeleton::kImageAlignment)),
+      hashes_image_size};
+  ASSERT_TRUE(hashes.ToImage(hashes_image));
+  {
+    Skeleton strings;
+    ASSERT_TRUE(strings.FromImage(hashes_image));
+    ASSERT_EQ(strings.num_joints(), o_skeleton->num_joints());
+    for (int i = 0; i < strings.num_joints(); ++i) {
+      EXPECT_STREQ(strings.joint_names()[i], "");
+    }
+  }
+  hashes = Skeleton();
+  allocator->Deallocate(hashes_image.data());
+  allocator->Deallocate(image.data());
+}
+
+TEST(AsyncLoad, SkeletonSerialize) {
+  // Saves a skeleton to a file.
+  {
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    raw_skeleton.roots[0].name = "root";
+    raw_skeleton.roots[0].children.resize(2);
+
+    SkeletonBuilder builder;
+    ozz::unique_ptr<Skeleton> skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton);
+
+    ozz::io::File file("async_skeleton.ozz", "wb");
+    ASSERT_TRUE(file.opened());
+    ozz::io::OArchive archive(&file);
+    archive << *skeleton;
+  }
+
+  ozz::io::FileAsyncReader reader;
+  ozz::io::AsyncLoad<Skeleton> load;
+  EXPECT_TRUE(load.Start(&reader, "async_skeleton.ozz"));
+  EXPECT_EQ(load.status(), ozz::io::kAsyncSucceeded);
+  EXPECT_EQ(load.object().num_joints(), 3);
+  EXPECT_STREQ(load.object().joint_names()[0], "root");
+
+  // Skeleton archive isn't an animation one.
+  ozz::io::AsyncLoad<ozz::animation::Animation> animation_load;
+  EXPECT_TRUE(animation_load.Start(&reader, "async_skeleton.ozz"));
+  EXPECT_EQ(animation_load.status(), ozz::io::kAsyncFailed);
+}
+
+TEST(AssetRegistry, SkeletonSerialize) {
+  ozz::io::MemoryStream stream;
+  {
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    raw_skeleton.roots[0].name = "root";
+    raw_skeleton.roots[0].children.resize(2);
+
+    SkeletonBuilder builder;
+    ozz::unique_ptr<Skeleton> skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(skeleton);
+
+    ozz::io::OArchive archive(&stream);
+    archive << *skeleton;
+  }
+
+  // Same skeleton is shared by all acquirers.
+  ozz::io::AssetRegistry<Skeleton> registry;
+  const ozz::io::AssetRegistry<Skeleton>::Asset* assets[2];
+  for (auto& asset : assets) {
+    stream.Seek(0, ozz::io::Stream::kSet);
+    asset = registry.Acquire(&stream);
+    ASSERT_TRUE(asset != nullptr);
+  }
+  EXPECT_EQ(assets[0], assets[1]);
+  EXPECT_EQ(assets[0]->status(), ozz::io::kAsyncSucceeded);
+  EXPECT_EQ(assets[0]->object().num_joints(), 3);
+  EXPECT_STREQ(assets[0]->object().joint_names()[0], "root");
+  registry.Release(assets[0]);
+  registry.Release(assets[1]);
+  EXPECT_EQ(registry.size(), 0u);
+}
@@ -27,6 +27,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <string>
 
 #include "gtest/gtest.h"
 #include "ozz/animation/offline/raw_skeleton.h"
@@ -412,6 +413,134 @@ TEST(IsLeaf, SkeletonUtils) {
   EXPECT_TRUE(IsLeaf(*skeleton, 7));
   EXPECT_FALSE(IsLeaf(*skeleton, 8));
   EXPECT_TRUE(IsLeaf(*skeleton, 9));
+
+  // Leaves don't depend on ordering.
+  builder.ordering = SkeletonBuilder::kSiblingsGrouped;
+  skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton);
+  for (int i = 0; i < skeleton->num_joints(); ++i) {
+    const char* name = skeleton->joint_names()[i];
+    const bool leaf = !std::strcmp(name, "j3") || !std::strcmp(name, "j5") ||
+                      !std::strcmp(name, "j7") || !std::strcmp(name, "j9");
+    EXPECT_EQ(IsLeaf(*skeleton, i), leaf);
+  }
+}
+
+TEST(Topology, SkeletonUtils) {
+  // Empty skeleton.
+  {
+    Skeleton skeleton;
+    EXPECT_EQ(skeleton.joint_children(Skeleton::kNoParent).size(), 0u);
+    EXPECT_EQ(skeleton.joint_subtree_ends().size(), 0u);
+    EXPECT_EQ(skeleton.joint_depths().size(), 0u);
+  }
+
+  /*
+  7 joints (2 roots)
+     *
+    /  \
+   j0   j4
+   |  \   \
+   j1  j3  j5
+   |        |
+   j2       j6
+  */
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  raw_skeleton.roots[0].children.resize(2);
+  raw_skeleton.roots[0].children[0].children.resize(1);
+  raw_skeleton.roots[1].children.resize(1);
+  raw_skeleton.roots[1].children[0].children.resize(1);
+
+  SkeletonBuilder builder;
+  ozz::unique_ptr<Skeleton> skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton);
+  ASSERT_EQ(skeleton->num_joints(), 7);
+
+  EXPECT_ASSERTION(skeleton->joint_children(7), "_joint index out of range");
+  EXPECT_ASSERTION(skeleton->joint_children(-2), "_joint index out of range");
+
+  const int roots[] = {0, 4};
+  const int children[][2] = {{1, 3}, {2, -1}, {-1, -1}, {-1, -1},
+                             {5, -1}, {6, -1}, {-1, -1}};
+  const int ends[] = {4, 3, 3, 4, 7, 7, 7};
+  const int depths[] = {0, 1, 2, 1, 0, 1, 2};
+
+  const ozz::span<const int16_t> root_children =
+      skeleton->joint_children(Skeleton::kNoParent);
+  ASSERT_EQ(root_children.size(), 2u);
+  EXPECT_EQ(root_children[0], roots[0]);
+  EXPECT_EQ(root_children[1], roots[1]);
+  for (int i = 0; i < skeleton->num_joints(); ++i) {
+    const ozz::span<const int16_t> joint_children = skeleton->joint_children(i);
+    const size_t count = (children[i][0] != -1) + (children[i][1] != -1);
+    ASSERT_EQ(joint_children.size(), count);
+    for (size_t c = 0; c < count; ++c) {
+      EXPECT_EQ(joint_children[c], children[i][c]);
+      EXPECT_EQ(skeleton->joint_parents()[joint_children[c]], i);
+    }
+    EXPECT_EQ(skeleton->joint_subtree_ends()[i], ends[i]);
+    EXPECT_EQ(skeleton->joint_depths()[i], depths[i]);
+  }
+
+  // With siblings grouped, j0 j4 j1 j3 j2 j5 j6.
+  builder.ordering = SkeletonBuilder::kSiblingsGrouped;
+  skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton);
+  const int grouped_children[][2] = {{2, 3}, {5, -1}, {4, -1}, {-1, -1},
+                                     {-1, -1}, {6, -1}, {-1, -1}};
+  const int grouped_depths[] = {0, 0, 1, 1, 2, 1, 2};
+  const int grouped_sizes[] = {4, 3, 2, 1, 1, 2, 1};
+  for (int i = 0; i < skeleton->num_joints(); ++i) {
+    const ozz::span<const int16_t> joint_children = skeleton->joint_children(i);
+    const size_t count =
+        (grouped_children[i][0] != -1) + (grouped_children[i][1] != -1);
+    ASSERT_EQ(joint_children.size(), count);
+    for (size_t c = 0; c < count; ++c) {
+      EXPECT_EQ(joint_children[c], grouped_children[i][c]);
+    }
+    EXPECT_EQ(skeleton->joint_subtree_ends()[i] - i, grouped_sizes[i]);
+    EXPECT_EQ(skeleton->joint_depths()[i], grouped_depths[i]);
+  }
+}
+
+TEST(IsDepthFirst, SkeletonUtils) {
+  // Empty skeleton.
+  EXPECT_TRUE(IsDepthFirst(Skeleton()));
+
+  /*
+  7 joints (2 roots)
+     *
+    /  \
+   j0   j4
+   |  \   \
+   j1  j3  j5
+   |        |
+   j2       j6
+  */
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  raw_skeleton.roots[0].children.resize(2);
+  raw_skeleton.roots[0].children[0].children.resize(1);
+  raw_skeleton.roots[1].children.resize(1);
+  raw_skeleton.roots[1].children[0].children.resize(1);
+
+  SkeletonBuilder builder;
+  ozz::unique_ptr<Skeleton> skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton);
+  EXPECT_TRUE(IsDepthFirst(*skeleton));
+
+  builder.ordering = SkeletonBuilder::kSiblingsGrouped;
+  skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton);
+  EXPECT_FALSE(IsDepthFirst(*skeleton));
+
+  // A single chain is depth-first whatever the ordering.
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(1);
+  skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton);
+  EXPECT_TRUE(IsDepthFirst(*skeleton));
 }
 
 TEST(Name, SkeletonUtils) {
@@ -435,4 +564,52 @@ TEST(Name, SkeletonUtils) {
 
   EXPECT_TRUE(FindJoint(*skeleton, "aj0") < 0);
   EXPECT_TRUE(FindJoint(*skeleton, "j0a") < 0);
-}
\ No newline at end of file
+}
+TEST(NameHashes, SkeletonUtils) {
+  SkeletonBuilder builder;
+
+  {  // Empty skeleton.
+    Skeleton skeleton;
+    EXPECT_EQ(FindJoint(skeleton, "j0"), -1);
+    EXPECT_EQ(skeleton.FindJointByHash(Skeleton::HashName("j0")), -1);
+  }
+
+  // Enough joints to have hash table collisions. Duplicated names are
+  // allowed, the first joint is found.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(300);
+  for (size_t i = 0; i < raw_skeleton.roots.size(); ++i) {
+    raw_skeleton.roots[i].name = "joint";
+    raw_skeleton.roots[i].name += std::to_string(i % 250).c_str();
+  }
+
+  Skeleton strings;
+  ASSERT_TRUE(builder(raw_skeleton, &strings));
+  EXPECT_EQ(strings.name_storage(), Skeleton::kNameStrings);
+  EXPECT_EQ(strings.joint_names().size(), 300u);
+
+  Skeleton hashes(nullptr, Skeleton::kNameHashes);
+  ASSERT_TRUE(builder(raw_skeleton, &hashes));
+  EXPECT_EQ(hashes.name_storage(), Skeleton::kNameHashes);
+  EXPECT_EQ(hashes.num_joints(), 300);
+  EXPECT_TRUE(hashes.joint_names().empty());
+
+  for (int i = 0; i < 300; ++i) {
+    const ozz::string& name = raw_skeleton.roots[i].name;
+    const uint32_t hash = Skeleton::HashName(name.c_str());
+    EXPECT_EQ(strings.joint_name_hashes()[i], hash);
+    EXPECT_EQ(hashes.joint_name_hashes()[i], hash);
+
+    EXPECT_EQ(FindJoint(strings, name.c_str()), i % 250);
+    EXPECT_EQ(FindJoint(hashes, name.c_str()), i % 250);
+    EXPECT_EQ(hashes.FindJointByHash(hash), i % 250);
+  }
+  EXPECT_EQ(FindJoint(strings, "joint250"), -1);
+  EXPECT_EQ(FindJoint(hashes, "joint250"), -1);
+  EXPECT_EQ(FindJoint(hashes, ""), -1);
+
+  // Move keeps names storage.
+  Skeleton moved(std::move(hashes));
+  EXPECT_EQ(moved.name_storage(), Skeleton::kNameHashes);
+  EXPECT_EQ(FindJoint(moved, "joint46"), 46);
+}
@@ -0,0 +1,326 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/spring_bone_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::LocalToModelJob;
+using ozz::animation::Skeleton;
+using ozz::animation::SpringBoneJob;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton whose root has one horizontal chain (along x) per
+// _lengths element.
+ozz::unique_ptr<Skeleton> BuildSkeleton(const int* _lengths,
+                                        int _num_chains) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.transform = ozz::math::Transform::identity();
+  root.transform.translation = ozz::math::Float3(0.f, 2.f, 0.f);
+  root.children.resize(_num_chains);
+  for (int c = 0; c < _num_chains; ++c) {
+    RawSkeleton::Joint* joint = &root.children[c];
+    for (int j = 0; j < _lengths[c]; ++j) {
+      joint->name = "c";
+      joint->name += static_cast<char>('0' + c);
+      joint->name += static_cast<char>('0' + j);
+      joint->transform = ozz::math::Transform::identity();
+      joint->transform.translation =
+          j == 0 ? ozz::math::Float3(0.f, 0.f, static_cast<float>(c))
+                 : ozz::math::Float3(1.f, 0.f, 0.f);
+      if (j + 1 < _lengths[c]) {
+        joint->children.resize(1);
+        joint = &joint->children[0];
+      }
+    }
+  }
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+// Gets chain _chain joint _joint index.
+int ChainJoint(const Skeleton& _skeleton, int _chain, int _joint) {
+  const char name[] = {'c', static_cast<char>('0' + _chain),
+                       static_cast<char>('0' + _joint), 0};
+  return ozz::animation::FindJoint(_skeleton, name);
+}
+
+ozz::math::Float3 Position(const ozz::math::Float4x4& _m) {
+  ozz::math::Float3 p;
+  ozz::math::Store3PtrU(_m.cols[3], &p.x);
+  return p;
+}
+}  // namespace
+
+TEST(Setup, SpringBoneJob) {
+  const int lengths[] = {3};
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton(lengths, 1);
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+  const int c0 = ChainJoint(*skeleton, 0, 0);
+  const int c2 = ChainJoint(*skeleton, 0, 2);
+  const ozz::vector<float> settings(num_joints, .5f);
+
+  SpringBoneJob::Context context;
+  EXPECT_EQ(context.num_joints(), 0);
+
+  // Valid.
+  const SpringBoneJob::Chain chain = {c0, c2};
+  EXPECT_TRUE(context.Setup(*skeleton, {&chain, 1}, make_span(settings),
+                            make_span(settings)));
+  EXPECT_EQ(context.num_chains(), 1);
+  EXPECT_EQ(context.num_joints(), num_joints);
+  ASSERT_EQ(context.dirty().size(), static_cast<size_t>(1));
+  EXPECT_EQ(context.dirty()[0], 1 << c0);
+
+  // Tip isn't a descendant of root.
+  const SpringBoneJob::Chain reversed = {c2, c0};
+  EXPECT_FALSE(context.Setup(*skeleton, {&reversed, 1}, make_span(settings),
+                             make_span(settings)));
+  EXPECT_EQ(context.num_joints(), 0);
+
+  // Root is tip.
+  const SpringBoneJob::Chain single = {c0, c0};
+  EXPECT_FALSE(context.Setup(*skeleton, {&single, 1}, make_span(settings),
+                             make_span(settings)));
+
+  // Out of range.
+  const SpringBoneJob::Chain out = {c0, num_joints};
+  EXPECT_FALSE(context.Setup(*skeleton, {&out, 1}, make_span(settings),
+                             make_span(settings)));
+
+  // Settings too small.
+  EXPECT_FALSE(context.Setup(*skeleton, {&chain, 1}, {}, make_span(settings)));
+  EXPECT_FALSE(context.Setup(*skeleton, {&chain, 1}, make_span(settings), {}));
+}
+
+TEST(Validate, SpringBoneJob) {
+  const int lengths[] = {3};
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton(lengths, 1);
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+  const ozz::vector<float> settings(num_joints, .5f);
+  const SpringBoneJob::Chain chain = {ChainJoint(*skeleton, 0, 0),
+                                      ChainJoint(*skeleton, 0, 2)};
+
+  ozz::vector<ozz::math::Float4x4> models(num_joints);
+  ozz::vector<ozz::math::SoaTransform> locals(skeleton->num_soa_joints());
+
+  SpringBoneJob::Context context;
+  {  // No context.
+    SpringBoneJob job;
+    job.models = make_span(models);
+    job.locals = make_span(locals);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Context isn't setup.
+    SpringBoneJob job;
+    job.context = &context;
+    job.models = make_span(models);
+    job.locals = make_span(locals);
+    EXPECT_FALSE(job.Validate());
+  }
+  ASSERT_TRUE(context.Setup(*skeleton, {&chain, 1}, make_span(settings),
+                            make_span(settings)));
+  {  // Valid.
+    SpringBoneJob job;
+    job.context = &context;
+    job.models = make_span(models);
+    job.locals = make_span(locals);
+    EXPECT_TRUE(job.Validate());
+  }
+  {  // Models too small.
+    SpringBoneJob job;
+    job.context = &context;
+    job.models = {models.data(), models.size() - 1};
+    job.locals = make_span(locals);
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Locals too small.
+    SpringBoneJob job;
+    job.context = &context;
+    job.models = make_span(models);
+    job.locals = {};
+    EXPECT_FALSE(job.Validate());
+  }
+  {  // Negative dt.
+    SpringBoneJob job;
+    job.context = &context;
+    job.models = make_span(models);
+    job.locals = make_span(locals);
+    job.dt = -1.f;
+    EXPECT_FALSE(job.Validate());
+  }
+}
+
+TEST(Stiff, SpringBoneJob) {
+  const int lengths[] = {3, 2};
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton(lengths, 2);
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+  const ozz::vector<float> stiffness(num_joints, 1.f);
+  const ozz::vector<float> damping(num_joints, 0.f);
+  const SpringBoneJob::Chain chains[] = {
+      {ChainJoint(*skeleton, 0, 0), ChainJoint(*skeleton, 0, 2)},
+      {ChainJoint(*skeleton, 1, 0), ChainJoint(*skeleton, 1, 1)}};
+
+  SpringBoneJob::Context context;
+  ASSERT_TRUE(context.Setup(*skeleton, chains, make_span(stiffness),
+                            make_span(damping)));
+
+  ozz::vector<ozz::math::Float4x4> models(num_joints);
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = skeleton.get();
+  ltm_job.input = skeleton->joint_rest_poses();
+  ltm_job.output = make_span(models);
+  ASSERT_TRUE(ltm_job.Run());
+
+  // A fully stiff chain follows animation.
+  ozz::vector<ozz::math::SoaTransform> locals(
+      skeleton->joint_rest_poses().begin(), skeleton->joint_rest_poses().end());
+  SpringBoneJob job;
+  job.context = &context;
+  job.dt = 1.f / 30.f;
+  job.gravity = ozz::math::Float3(0.f, -10.f, 0.f);
+  job.models = make_span(models);
+  job.locals = make_span(locals);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(job.Run());
+  }
+  for (size_t i = 0; i < locals.size(); ++i) {
+    const ozz::math::SoaQuaternion& rest =
+        skeleton->joint_rest_poses()[i].rotation;
+    EXPECT_SOAQUATERNION_EQ_EST(
+        locals[i].rotation, ozz::math::GetX(rest.x),
+        ozz::math::GetY(rest.x), ozz::math::GetZ(rest.x),
+        ozz::math::GetW(rest.x), ozz::math::GetX(rest.y),
+        ozz::math::GetY(rest.y), ozz::math::GetZ(rest.y),
+        ozz::math::GetW(rest.y), ozz::math::GetX(rest.z),
+        ozz::math::GetY(rest.z), ozz::math::GetZ(rest.z),
+        ozz::math::GetW(rest.z), ozz::math::GetX(rest.w),
+        ozz::math::GetY(rest.w), ozz::math::GetZ(rest.w),
+        ozz::math::GetW(rest.w));
+  }
+}
+
+TEST(Gravity, SpringBoneJob) {
+  // 5 chains, so that 2 SoA groups are used, with different lengths.
+  const int lengths[] = {3, 2, 4, 3, 2};
+  const int num_chains = 5;
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton(lengths, num_chains);
+  ASSERT_TRUE(skeleton);
+  const int num_joints = skeleton->num_joints();
+  const ozz::vector<float> stiffness(num_joints, 0.f);
+  const ozz::vector<float> damping(num_joints, .1f);
+  SpringBoneJob::Chain chains[num_chains];
+  for (int c = 0; c < num_chains; ++c) {
+    chains[c].root = ChainJoint(*skeleton, c, 0);
+    chains[c].tip = ChainJoint(*skeleton, c, lengths[c] - 1);
+  }
+
+  SpringBoneJob::Context context;
+  ASSERT_TRUE(context.Setup(*skeleton, chains, make_span(stiffness),
+                            make_span(damping)));
+  EXPECT_EQ(context.num_chains(), num_chains);
+
+  ozz::vector<ozz::math::Float4x4> animated(num_joints);
+  LocalToModelJob ltm_job;
+  ltm_job.skeleton = skeleton.get();
+  ltm_job.input = skeleton->joint_rest_poses();
+  ltm_job.output = make_span(animated);
+  ASSERT_TRUE(ltm_job.Run());
+
+  ozz::vector<ozz::math::SoaTransform> locals;
+  ozz::vector<ozz::math::Float4x4> models;
+  SpringBoneJob job;
+  job.context = &context;
+  job.dt = 1.f / 30.f;
+  job.gravity = ozz::math::Float3(0.f, -10.f, 0.f);
+  for (int i = 0; i < 300; ++i) {
+    // Restarts from the animated pose every frame.
+    locals.assign(skeleton->joint_rest_poses().begin(),
+                  skeleton->joint_rest_poses().end());
+    models = animated;
+    job.models = make_span(animated);
+    job.locals = make_span(locals);
+    ASSERT_TRUE(job.Run());
+
+    // Updates chains only.
+    LocalToModelJob update_job;
+    update_job.skeleton = skeleton.get();
+    update_job.input = make_span(locals);
+    update_job.output = make_span(models);
+    update_job.dirty = context.dirty();
+    ASSERT_TRUE(update_job.Run());
+  }
+
+  // Chains hang down, preserving bones length.
+  const int root = ozz::animation::FindJoint(*skeleton, "root");
+  EXPECT_FLOAT3_EQ(Position(models[root]), 0.f, 2.f, 0.f);
+  for (int c = 0; c < num_chains; ++c) {
+    const int chain_root = ChainJoint(*skeleton, c, 0);
+    EXPECT_FLOAT3_EQ(Position(models[chain_root]), 0.f, 2.f,
+                     static_cast<float>(c));
+    for (int j = 1; j < lengths[c]; ++j) {
+      const ozz::math::Float3 parent =
+          Position(models[ChainJoint(*skeleton, c, j - 1)]);
+      const ozz::math::Float3 child =
+          Position(models[ChainJoint(*skeleton, c, j)]);
+      EXPECT_NEAR(Length(child - parent), 1.f, 1e-3f);
+      EXPECT_NEAR(child.x, 0.f, 1e-2f);
+      EXPECT_NEAR(child.y, 2.f - j, 1e-2f);
+      EXPECT_NEAR(child.z, static_cast<float>(c), 1e-3f);
+    }
+  }
+
+  // Reset goes back to animated pose.
+  context.Reset();
+  job.gravity = ozz::math::Float3::zero();
+  locals.assign(skeleton->joint_rest_poses().begin(),
+                skeleton->joint_rest_poses().end());
+  ASSERT_TRUE(job.Run());
+  ltm_job.input = make_span(locals);
+  ltm_job.output = make_span(models);
+  ASSERT_TRUE(ltm_job.Run());
+  const int tip = ChainJoint(*skeleton, 2, 3);
+  EXPECT_FLOAT3_EQ(Position(models[tip]), 3.f, 2.f, 2.f);
+}
@@ -0,0 +1,254 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/sync_group_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_track.h"
+#include "ozz/animation/offline/track_builder.h"
+#include "ozz/animation/runtime/track.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::FloatTrack;
+using ozz::animation::SyncClip;
+using ozz::animation::SyncGroup;
+using ozz::animation::SyncGroupJob;
+using ozz::animation::offline::RawFloatTrack;
+using ozz::animation::offline::RawTrackInterpolation;
+using ozz::animation::offline::TrackBuilder;
+
+TEST(ExtractSyncMarkers, SyncGroupJob) {
+  // Values go through 1 upward at .25 and .75.
+  RawFloatTrack raw_track;
+  const float values[] = {0.f, 2.f, 0.f, 2.f};
+  for (int i = 0; i < 4; ++i) {
+    const RawFloatTrack::Keyframe key = {RawTrackInterpolation::kStep,
+                                         .25f * i, values[i]};
+    raw_track.keyframes.push_back(key);
+  }
+  TrackBuilder builder;
+  ozz::unique_ptr<FloatTrack> track(builder(raw_track));
+  ASSERT_TRUE(track);
+
+  float markers[3] = {-1.f, -1.f, -1.f};
+  EXPECT_EQ(ozz::animation::ExtractSyncMarkers(*track, 1.f, markers), 2);
+  EXPECT_FLOAT_EQ(markers[0], .25f);
+  EXPECT_FLOAT_EQ(markers[1], .75f);
+  EXPECT_FLOAT_EQ(markers[2], -1.f);
+
+  // Buffer too small.
+  markers[0] = markers[1] = -1.f;
+  EXPECT_EQ(ozz::animation::ExtractSyncMarkers(
+                *track, 1.f, ozz::span<float>(markers, 1)),
+            2);
+  EXPECT_FLOAT_EQ(markers[0], .25f);
+  EXPECT_FLOAT_EQ(markers[1], -1.f);
+
+  // No edge.
+  EXPECT_EQ(ozz::animation::ExtractSyncMarkers(*track, 3.f, markers), 0);
+}
+
+TEST(JobValidity, SyncGroupJob) {
+  const float markers2[] = {0.f, .5f};
+  const float markers1[] = {.2f};
+  SyncClip clips[2];
+  clips[0].markers = markers2;
+  clips[1].markers = markers2;
+  SyncGroup groups[1];
+  groups[0].num_clips = 2;
+  float ratios[2];
+
+  {  // Default job is valid, there's nothing to do.
+    SyncGroupJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  SyncGroupJob job;
+  job.clips = clips;
+  job.groups = groups;
+  job.ratios = ratios;
+  EXPECT_TRUE(job.Validate());
+
+  // Ratios too small.
+  job.ratios = ozz::span<float>(ratios, 1);
+  EXPECT_FALSE(job.Validate());
+  job.ratios = ratios;
+
+  // Invalid clips ranges.
+  groups[0].num_clips = 3;
+  EXPECT_FALSE(job.Validate());
+  groups[0].num_clips = 0;
+  EXPECT_FALSE(job.Validate());
+  groups[0].num_clips = 1;
+  groups[0].clips_begin = -1;
+  EXPECT_FALSE(job.Validate());
+  groups[0].clips_begin = 1;
+  EXPECT_TRUE(job.Validate());
+  groups[0].clips_begin = 0;
+  groups[0].num_clips = 2;
+
+  // Number of markers mismatch.
+  clips[1].markers = markers1;
+  EXPECT_FALSE(job.Validate());
+  groups[0].num_clips = 1;
+  EXPECT_TRUE(job.Validate());
+  groups[0].num_clips = 2;
+  clips[1].markers = markers2;
+
+  // Invalid markers.
+  clips[0].markers = {};
+  EXPECT_FALSE(job.Validate());
+  const float unsorted[] = {.5f, .2f};
+  clips[0].markers = unsorted;
+  EXPECT_FALSE(job.Validate());
+  const float out_of_range[] = {0.f, 1.f};
+  clips[0].markers = out_of_range;
+  EXPECT_FALSE(job.Validate());
+  clips[0].markers = markers2;
+
+  // Invalid duration.
+  clips[0].duration = 0.f;
+  EXPECT_FALSE(job.Validate());
+  clips[0].duration = 1.f;
+
+  EXPECT_TRUE(job.Validate());
+  EXPECT_TRUE(job.Run());
+}
+
+TEST(Phase, SyncGroupJob) {
+  // Clip 0 lasts 1s, clip 1 2s, with markers at different ratios.
+  const float markers0[] = {0.f, .5f};
+  const float markers1[] = {.25f, .75f};
+  SyncClip clips[2];
+  clips[0].markers = markers0;
+  clips[0].duration = 1.f;
+  clips[0].weight = .8f;
+  clips[1].markers = markers1;
+  clips[1].duration = 2.f;
+  clips[1].weight = .2f;
+
+  SyncGroup groups[1];
+  groups[0].num_clips = 2;
+  float ratios[2];
+
+  SyncGroupJob job;
+  job.clips = clips;
+  job.groups = groups;
+  job.ratios = ratios;
+
+  // Clip 0 leads, 0.1s is 20% of its first segment.
+  job.delta_time = .1f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(groups[0].leader, 0);
+  EXPECT_FLOAT_EQ(groups[0].phase, .2f);
+  EXPECT_FLOAT_EQ(ratios[0], .1f);
+  EXPECT_FLOAT_EQ(ratios[1], .35f);
+
+  // Passes a marker.
+  job.delta_time = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT_EQ(groups[0].phase, 1.2f);
+  EXPECT_FLOAT_EQ(ratios[0], .6f);
+  EXPECT_FLOAT_EQ(ratios[1], .85f);
+
+  // Loops.
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(groups[0].phase, .2f, 1e-5f);
+  EXPECT_NEAR(ratios[0], .1f, 1e-5f);
+  EXPECT_NEAR(ratios[1], .35f, 1e-5f);
+
+  // Many loops.
+  job.delta_time = 10.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(groups[0].phase, .2f, 1e-4f);
+
+  // Backward, looping.
+  groups[0].playback_speed = -1.f;
+  job.delta_time = .3f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(groups[0].phase, 1.6f, 1e-4f);
+  EXPECT_NEAR(ratios[0], .8f, 1e-4f);
+  EXPECT_NEAR(ratios[1], 0.05f, 1e-4f);
+  groups[0].playback_speed = 1.f;
+
+  // Clip 1 leads, its 2nd segment lasts 1s.
+  clips[1].weight = .9f;
+  job.delta_time = .2f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(groups[0].leader, 1);
+  EXPECT_NEAR(groups[0].phase, 1.8f, 1e-4f);
+  EXPECT_NEAR(ratios[0], .9f, 1e-4f);
+  EXPECT_NEAR(ratios[1], .15f, 1e-4f);
+
+  // Out of range phase is wrapped.
+  groups[0].phase = -.5f;
+  job.delta_time = 0.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_NEAR(groups[0].phase, 1.5f, 1e-5f);
+}
+
+TEST(MultipleGroups, SyncGroupJob) {
+  // Uneven markers.
+  const float markers0[] = {.1f, .4f};
+  const float markers1[] = {.2f};
+  SyncClip clips[3];
+  clips[0].markers = markers0;
+  clips[0].duration = 1.f;
+  clips[0].weight = 1.f;
+  clips[1].markers = markers0;
+  clips[1].duration = 2.f;
+  clips[1].weight = 0.f;
+  clips[2].markers = markers1;
+  clips[2].duration = 4.f;
+
+  SyncGroup groups[2];
+  groups[0].clips_begin = 0;
+  groups[0].num_clips = 2;
+  groups[1].clips_begin = 2;
+  groups[1].num_clips = 1;
+  groups[1].playback_speed = 2.f;
+  float ratios[3];
+
+  SyncGroupJob job;
+  job.clips = clips;
+  job.groups = groups;
+  job.ratios = ratios;
+  job.delta_time = .6f;
+  ASSERT_TRUE(job.Run());
+
+  // Group 0 moves from .1 to .7 on clip 0, 3/7 of the second segment.
+  EXPECT_EQ(groups[0].leader, 0);
+  EXPECT_NEAR(groups[0].phase, 1.f + 3.f / 7.f, 1e-5f);
+  EXPECT_NEAR(ratios[0], .7f, 1e-5f);
+  EXPECT_NEAR(ratios[1], .7f, 1e-5f);
+
+  // Group 1 moves 1.2s, from .2 to .5.
+  EXPECT_EQ(groups[1].leader, 2);
+  EXPECT_NEAR(groups[1].phase, .3f, 1e-5f);
+  EXPECT_NEAR(ratios[2], .5f, 1e-5f);
+}
@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/timeline_animation.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/timeline_animation_builder.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/animation/runtime/timeline_sampling_job.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::TimelineAnimation;
+using ozz::animation::TimelineSamplingJob;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::TimelineAnimationBuilder;
+
+namespace {
+template <typename _Ty>
+bool EqualSpans(ozz::span<const _Ty> _a, ozz::span<const _Ty> _b) {
+  return _a.size() == _b.size() &&
+         (_a.empty() ||
+          std::memcmp(_a.data(), _b.data(), _a.size_bytes()) == 0);
+}
+}  // namespace
+
+TEST(Empty, TimelineAnimationSerialize) {
+  ozz::io::MemoryStream stream;
+
+  // Streams out.
+  ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+
+  TimelineAnimation o_animation;
+  o << o_animation;
+
+  // Streams in.
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+
+  TimelineAnimation i_animation;
+  i >> i_animation;
+
+  EXPECT_EQ(o_animation.num_tracks(), i_animation.num_tracks());
+  EXPECT_EQ(i_animation.num_frames(), 0);
+}
+
+TEST(Filled, TimelineAnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 3.f;
+  raw_animation.name = "timeline";
+  raw_animation.tracks.resize(6);
+  for (int i = 0; i <= 40; ++i) {
+    const float time = i * 3.f / 40.f;
+    const RawAnimation::TranslationKey t = {
+        time, ozz::math::Float3(i * 1.f, 0.f, -i * 1.f)};
+    raw_animation.tracks[0].translations.push_back(t);
+    const RawAnimation::RotationKey r = {
+        time, ozz::math::Quaternion::FromEuler(i * .1f, 0.f, 0.f)};
+    raw_animation.tracks[i % 6].rotations.push_back(r);
+    const RawAnimation::ScaleKey s = {time, ozz::math::Float3(i * .5f)};
+    raw_animation.tracks[5].scales.push_back(s);
+  }
+
+  TimelineAnimationBuilder builder;
+  ozz::unique_ptr<TimelineAnimation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    TimelineAnimation i_animation;
+    i >> i_animation;
+
+    EXPECT_FLOAT_EQ(o_animation->duration(), i_animation.duration());
+    EXPECT_EQ(o_animation->num_tracks(), i_animation.num_tracks());
+    EXPECT_STREQ(o_animation->name(), i_animation.name());
+    EXPECT_TRUE(EqualSpans(o_animation->ratios(), i_animation.ratios()));
+    EXPECT_TRUE(EqualSpans(o_animation->translation_presence(),
+                           i_animation.translation_presence()));
+    EXPECT_TRUE(EqualSpans(o_animation->rotation_presence(),
+                           i_animation.rotation_presence()));
+    EXPECT_TRUE(EqualSpans(o_animation->scale_offsets(),
+                           i_animation.scale_offsets()));
+    EXPECT_EQ(o_animation->size(), i_animation.size());
+
+    // Key values are compared through sampling.
+    TimelineSamplingJob::Context context(6);
+    for (float ratio = 0.f; ratio <= 1.f; ratio += .05f) {
+      ozz::math::SoaTransform o_output[2];
+      ozz::math::SoaTransform i_output[2];
+      TimelineSamplingJob job;
+      job.context = &context;
+      job.ratio = ratio;
+      job.animation = o_animation.get();
+      job.output = o_output;
+      ASSERT_TRUE(job.Run());
+      job.animation = &i_animation;
+      job.output = i_output;
+      ASSERT_TRUE(job.Run());
+      EXPECT_EQ(std::memcmp(o_output, i_output, sizeof(o_output)), 0);
+    }
+  }
+}
+
+TEST(Invalid, TimelineAnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  const RawAnimation::TranslationKey t = {.5f, ozz::math::Float3(1.f)};
+  raw_animation.tracks[0].translations.push_back(t);
+
+  TimelineAnimationBuilder builder;
+  ozz::unique_ptr<TimelineAnimation> o_animation(builder(raw_animation));
+  ASSERT_TRUE(o_animation);
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+  o << *o_animation;
+
+  // Clears first track translation presence word, which is located before
+  // presence, offsets and values buffers at the end of the archive. Presence
+  // doesn't match the track keys count anymore.
+  const size_t tail_size =
+      3 * o_animation->translation_presence().size_bytes() +
+      3 * o_animation->translation_offsets().size_bytes() +
+      o_animation->translations().size() * 6 +
+      o_animation->rotations().size() * 7 + o_animation->scales().size() * 6;
+  const uint32_t zero = 0;
+  stream.Seek(static_cast<int>(stream.Size() - tail_size),
+              ozz::io::Stream::kSet);
+  stream.Write(&zero, sizeof(zero));
+
+  // Loading fails, leaving an empty animation.
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  TimelineAnimation i_animation;
+  i >> i_animation;
+  EXPECT_EQ(i_animation.num_tracks(), 0);
+  EXPECT_EQ(i_animation.num_frames(), 0);
+  EXPECT_TRUE(i_animation.translations().empty());
+}
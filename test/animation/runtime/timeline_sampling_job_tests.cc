@@ -0,0 +1,221 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/timeline_sampling_job.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/timeline_animation_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/timeline_animation.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingJob;
+using ozz::animation::TimelineAnimation;
+using ozz::animation::TimelineSamplingJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::TimelineAnimationBuilder;
+
+namespace {
+// Builds an animation whose even tracks are keyed every frame, and odd tracks
+// every 3 frames plus a few keys out of the timeline.
+void BuildRawAnimation(int _num_tracks, int _num_frames,
+                       RawAnimation* _raw_animation) {
+  _raw_animation->duration = 2.f;
+  _raw_animation->tracks.resize(_num_tracks);
+  const float step = _raw_animation->duration / (_num_frames - 1);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = _raw_animation->tracks[i];
+    const int stride = i % 2 ? 3 : 1;
+    for (int f = 0; f < _num_frames; f += stride) {
+      const bool shift = i % 4 == 3 && f % 9 == 3 && f + 1 < _num_frames;
+      const float time = f * step + (shift ? step / 2 : 0.f);
+      const float v = std::sin(time * 3.f + i);
+      const RawAnimation::TranslationKey t = {
+          time, ozz::math::Float3(v, i * .1f, -v * 2.f)};
+      track.translations.push_back(t);
+      const RawAnimation::RotationKey r = {
+          time, ozz::math::Quaternion::FromEuler(v * 3.f, v, i * .2f)};
+      track.rotations.push_back(r);
+      if (i % 3 == 0) {
+        const RawAnimation::ScaleKey s = {time,
+                                          ozz::math::Float3(1.f + v * .5f)};
+        track.scales.push_back(s);
+      }
+    }
+  }
+}
+
+void ExpectSoaNear(const ozz::math::SimdFloat4* _a,
+                   const ozz::math::SimdFloat4* _b, int _count) {
+  for (int i = 0; i < _count; ++i) {
+    float a[4], b[4];
+    ozz::math::StorePtrU(_a[i], a);
+    ozz::math::StorePtrU(_b[i], b);
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_NEAR(a[j], b[j], 1e-5f);
+    }
+  }
+}
+
+void ExpectTransformsNear(const ozz::math::SoaTransform* _a,
+                          const ozz::math::SoaTransform* _b, int _count) {
+  for (int i = 0; i < _count; ++i) {
+    ExpectSoaNear(&_a[i].translation.x, &_b[i].translation.x, 3);
+    ExpectSoaNear(&_a[i].rotation.x, &_b[i].rotation.x, 4);
+    ExpectSoaNear(&_a[i].scale.x, &_b[i].scale.x, 3);
+  }
+}
+}  // namespace
+
+TEST(JobValidity, TimelineSamplingJob) {
+  RawAnimation raw_animation;
+  BuildRawAnimation(5, 4, &raw_animation);
+  TimelineAnimationBuilder builder;
+  ozz::unique_ptr<TimelineAnimation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  ozz::math::SoaTransform output[2];
+  TimelineSamplingJob::Context context(8);
+  TimelineSamplingJob::Context small_context(4);
+
+  {  // Empty/default job.
+    TimelineSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output.
+    TimelineSamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid context.
+    TimelineSamplingJob job;
+    job.animation = animation.get();
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    job.context = &small_context;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job, with a smaller output.
+    TimelineSamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.output = {output, 1};
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job, empty animation.
+    TimelineAnimation empty;
+    TimelineSamplingJob job;
+    job.animation = &empty;
+    job.context = &context;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Sampling, TimelineSamplingJob) {
+  const int kTracks = 11;
+  const int kSoaTracks = (kTracks + 3) / 4;
+  RawAnimation raw_animation;
+  BuildRawAnimation(kTracks, 40, &raw_animation);
+
+  TimelineAnimationBuilder timeline_builder;
+  ozz::unique_ptr<TimelineAnimation> timeline(timeline_builder(raw_animation));
+  ASSERT_TRUE(timeline);
+  AnimationBuilder builder;
+  ozz::unique_ptr<Animation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  TimelineSamplingJob::Context timeline_context(kTracks);
+  SamplingJob::Context context(kTracks);
+
+  // Samples forward, including ratios out of range and exactly on frames,
+  // backward, and with large jumps.
+  const float ratios[] = {-.1f, 0.f,   .001f, .01f, .0125f, .02f, .1f,
+                          .25f, .2501f, .6f,  .59f,  .7f,   .95f, 1.f,
+                          1.1f, .3f,   0.f,  .99f,  .5f,   .55f};
+  for (float ratio : ratios) {
+    ozz::math::SoaTransform timeline_output[kSoaTracks];
+    TimelineSamplingJob timeline_job;
+    timeline_job.animation = timeline.get();
+    timeline_job.context = &timeline_context;
+    timeline_job.ratio = ratio;
+    timeline_job.output = timeline_output;
+    ASSERT_TRUE(timeline_job.Run());
+
+    ozz::math::SoaTransform output[kSoaTracks];
+    SamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.ratio = ratio;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    ExpectTransformsNear(timeline_output, output, kSoaTracks);
+  }
+
+  // Samples every frame of the timeline and in between.
+  timeline_context.Invalidate();
+  for (int i = 0; i <= 200; ++i) {
+    const float ratio = i / 200.f;
+    ozz::math::SoaTransform timeline_output[kSoaTracks];
+    TimelineSamplingJob timeline_job;
+    timeline_job.animation = timeline.get();
+    timeline_job.context = &timeline_context;
+    timeline_job.ratio = ratio;
+    timeline_job.output = timeline_output;
+    ASSERT_TRUE(timeline_job.Run());
+
+    ozz::math::SoaTransform output[kSoaTracks];
+    SamplingJob job;
+    job.animation = animation.get();
+    job.context = &context;
+    job.ratio = ratio;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    ExpectTransformsNear(timeline_output, output, kSoaTracks);
+  }
+}
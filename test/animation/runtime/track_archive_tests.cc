@@ -32,8 +32,11 @@
 
 #include "ozz/base/io/archive.h"
 #include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/memory/tracking_allocator.h"
 #include "ozz/base/memory/unique_ptr.h"
 
+#include "ozz/animation/runtime/event_track.h"
 #include "ozz/animation/runtime/track_sampling_job.h"
 
 #include "ozz/animation/offline/raw_track.h"
@@ -452,3 +455,271 @@ TEST(AlreadyInitialized, TrackSerialize) {
     ASSERT_TRUE(i_track.size() > size);
   }
 }
+
+TEST(Allocator, TrackSerialize) {
+  ozz::io::MemoryStream stream;
+  ozz::memory::TrackingAllocator allocator;
+  {
+    RawFloatTrack raw_float_track;
+    const RawFloatTrack::Keyframe key = {RawTrackInterpolation::kLinear, .5f,
+                                         46.f};
+    raw_float_track.keyframes.push_back(key);
+
+    // Builds in place with a specific allocator.
+    FloatTrack o_track(&allocator);
+    EXPECT_EQ(o_track.allocator(), &allocator);
+    TrackBuilder builder;
+    ASSERT_TRUE(builder(raw_float_track, &o_track));
+    EXPECT_EQ(allocator.total().live_allocations, 1u);
+
+    ozz::io::OArchive o(&stream);
+    o << o_track;
+  }
+  EXPECT_EQ(allocator.total().live_allocations, 0u);
+
+  {
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    // Loads with a specific allocator.
+    FloatTrack i_track(&allocator);
+    i >> i_track;
+    EXPECT_EQ(allocator.total().live_allocations, 1u);
+    ASSERT_EQ(i_track.values().size(), 2u);
+    EXPECT_FLOAT_EQ(i_track.values()[0], 46.f);
+  }
+  EXPECT_EQ(allocator.total().live_allocations, 0u);
+
+  {
+    ozz::animation::offline::RawMultiFloatTrack raw_track;
+    raw_track.num_channels = 2;
+    const ozz::animation::offline::RawMultiFloatTrack::Keyframe key = {
+        RawTrackInterpolation::kLinear, .3f, {1.f, 2.f}};
+    raw_track.keyframes.push_back(key);
+
+    ozz::animation::MultiFloatTrack track(&allocator);
+    TrackBuilder builder;
+    ASSERT_TRUE(builder(raw_track, &track));
+    EXPECT_EQ(allocator.total().live_allocations, 1u);
+  }
+  EXPECT_EQ(allocator.total().live_allocations, 0u);
+
+  {  // Event track without toggles still allocates its name.
+    ozz::animation::offline::RawEventTrack raw_track;
+    raw_track.name = "empty";
+
+    ozz::animation::EventTrack track(&allocator);
+    TrackBuilder builder;
+    ASSERT_TRUE(builder(raw_track, &track));
+    EXPECT_EQ(allocator.total().live_allocations, 1u);
+    EXPECT_STREQ(track.name(), "empty");
+  }
+  EXPECT_EQ(allocator.total().live_allocations, 0u);
+}
+
+TEST(MultiFloat, TrackSerialize) {
+  TrackBuilder builder;
+  ozz::animation::offline::RawMultiFloatTrack raw_track;
+  raw_track.num_channels = 3;
+  raw_track.name = "blend shapes";
+  const ozz::animation::offline::RawMultiFloatTrack::Keyframe key0 = {
+      RawTrackInterpolation::kLinear, .3f, {1.f, 2.f, 3.f}};
+  raw_track.keyframes.push_back(key0);
+  const ozz::animation::offline::RawMultiFloatTrack::Keyframe key1 = {
+      RawTrackInterpolation::kStep, .7f, {4.f, 5.f, 6.f}};
+  raw_track.keyframes.push_back(key1);
+
+  ozz::unique_ptr<ozz::animation::MultiFloatTrack> o_track(
+      builder(raw_track));
+  ASSERT_TRUE(o_track);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_track;
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    ozz::animation::MultiFloatTrack i_track;
+    i >> i_track;
+
+    EXPECT_STREQ(i_track.name(), "blend shapes");
+    EXPECT_EQ(i_track.num_channels(), 3);
+    EXPECT_EQ(i_track.size(), o_track->size());
+    ASSERT_EQ(i_track.values().size(), o_track->values().size());
+    for (size_t v = 0; v < i_track.values().size(); ++v) {
+      EXPECT_FLOAT_EQ(i_track.values()[v], o_track->values()[v]);
+    }
+
+    float results[3];
+    ozz::animation::MultiFloatTrackSamplingJob sampling;
+    sampling.track = &i_track;
+    sampling.results = results;
+    sampling.ratio = .5f;
+    ASSERT_TRUE(sampling.Run());
+    EXPECT_FLOAT_EQ(results[0], 2.5f);
+    EXPECT_FLOAT_EQ(results[2], 4.5f);
+    sampling.ratio = .8f;
+    ASSERT_TRUE(sampling.Run());
+    EXPECT_FLOAT_EQ(results[1], 5.f);
+  }
+}
+
+TEST(Event, TrackSerialize) {
+  TrackBuilder builder;
+  ozz::animation::offline::RawEventTrack raw_track;
+  raw_track.name = "hit window";
+  const ozz::animation::offline::RawEventTrack::Keyframe key0 = {.3f, true};
+  raw_track.keyframes.push_back(key0);
+  const ozz::animation::offline::RawEventTrack::Keyframe key1 = {.7f, false};
+  raw_track.keyframes.push_back(key1);
+
+  ozz::unique_ptr<ozz::animation::EventTrack> o_track(builder(raw_track));
+  ASSERT_TRUE(o_track);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_track;
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    ozz::animation::EventTrack i_track;
+    i >> i_track;
+
+    EXPECT_STREQ(i_track.name(), "hit window");
+    EXPECT_EQ(i_track.size(), o_track->size());
+    ASSERT_EQ(i_track.num_toggles(), 2);
+    EXPECT_EQ(i_track.toggles()[0], o_track->toggles()[0]);
+    EXPECT_EQ(i_track.toggles()[1], o_track->toggles()[1]);
+    EXPECT_FALSE(i_track.State(.2f));
+    EXPECT_TRUE(i_track.State(.5f));
+    EXPECT_FALSE(i_track.State(.8f));
+  }
+}
+
+TEST(Quantized, TrackSerialize) {
+  TrackBuilder builder;
+  builder.quantize = true;
+
+  RawFloat2Track raw_track;
+  const RawFloat2Track::Keyframe key0 = {RawTrackInterpolation::kLinear, .3f,
+                                         ozz::math::Float2(1.f, -2.f)};
+  raw_track.keyframes.push_back(key0);
+  const RawFloat2Track::Keyframe key1 = {RawTrackInterpolation::kStep, .7f,
+                                         ozz::math::Float2(3.f, 5.f)};
+  raw_track.keyframes.push_back(key1);
+
+  ozz::unique_ptr<Float2Track> o_track(builder(raw_track));
+  ASSERT_TRUE(o_track);
+  ASSERT_TRUE(o_track->quantized());
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_track;
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    Float2Track i_track;
+    i >> i_track;
+
+    EXPECT_TRUE(i_track.quantized());
+    EXPECT_EQ(i_track.size(), o_track->size());
+    ASSERT_EQ(i_track.compact_values().size(),
+              o_track->compact_values().size());
+    for (size_t v = 0; v < i_track.compact_values().size(); ++v) {
+      EXPECT_EQ(i_track.compact_values()[v], o_track->compact_values()[v]);
+    }
+
+    ozz::math::Float2 result;
+    Float2TrackSamplingJob sampling;
+    sampling.track = &i_track;
+    sampling.result = &result;
+    sampling.ratio = .5f;
+    ASSERT_TRUE(sampling.Run());
+    EXPECT_NEAR(result.x, 2.f, 1e-3f);
+    EXPECT_NEAR(result.y, 1.5f, 1e-3f);
+    sampling.ratio = .8f;
+    ASSERT_TRUE(sampling.Run());
+    EXPECT_FLOAT2_EQ(result, 3.f, 5.f);
+  }
+}
+
+TEST(Image, TrackSerialize) {
+  TrackBuilder builder;
+  RawFloat3Track raw_track;
+  raw_track.name = "image";
+  const RawFloat3Track::Keyframe key0 = {RawTrackInterpolation::kLinear, 0.f,
+                                         ozz::math::Float3(0.f, 26.f, 93.f)};
+  raw_track.keyframes.push_back(key0);
+  const RawFloat3Track::Keyframe key1 = {RawTrackInterpolation::kStep, .5f,
+                                         ozz::math::Float3(46.f, 0.f, 25.f)};
+  raw_track.keyframes.push_back(key1);
+
+  for (int q = 0; q < 2; ++q) {
+    builder.quantize = q != 0;
+    ozz::unique_ptr<Float3Track> o_track(builder(raw_track));
+    ASSERT_TRUE(o_track);
+    EXPECT_EQ(o_track->quantized(), builder.quantize);
+
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+    const size_t image_size = o_track->image_size();
+    ozz::span<ozz::byte> image = {
+        static_cast<ozz::byte*>(
+            allocator->Allocate(image_size, Float3Track::kImageAlignment)),
+        image_size};
+
+    // Invalid buffers.
+    EXPECT_FALSE(o_track->ToImage({image.data(), image_size - 1}));
+    EXPECT_FALSE(o_track->ToImage({image.data() + 1, image_size - 1}));
+    ASSERT_TRUE(o_track->ToImage(image));
+
+    {  // Invalid images.
+      Float3Track i_track;
+      EXPECT_FALSE(i_track.FromImage({image.data(), image_size - 1}));
+      EXPECT_FALSE(i_track.FromImage({image.data() + 1, image_size - 1}));
+      image[0] = static_cast<ozz::byte>(~image[0]);
+      EXPECT_FALSE(i_track.FromImage(image));
+      image[0] = static_cast<ozz::byte>(~image[0]);
+
+      // Type mismatch.
+      Float4Track i_float4_track;
+      EXPECT_FALSE(i_float4_track.FromImage(image));
+      EXPECT_EQ(i_float4_track.num_keys(), 0u);
+    }
+
+    {
+      Float3Track i_track;
+      ASSERT_TRUE(i_track.FromImage(image));
+      EXPECT_EQ(i_track.image_size(), image_size);
+      EXPECT_STREQ(i_track.name(), "image");
+      EXPECT_EQ(i_track.quantized(), builder.quantize);
+
+      // Data point to the image.
+      const ozz::byte* steps = i_track.steps().data();
+      EXPECT_TRUE(steps > image.data() && steps < image.data() + image_size);
+
+      Float3TrackSamplingJob sampling;
+      sampling.track = &i_track;
+      ozz::math::Float3 result;
+      sampling.result = &result;
+
+      sampling.ratio = .25f;
+      ASSERT_TRUE(sampling.Run());
+      EXPECT_NEAR(result.x, 23.f, 5e-2f);
+      EXPECT_NEAR(result.y, 13.f, 5e-2f);
+      EXPECT_NEAR(result.z, 59.f, 5e-2f);
+
+      sampling.ratio = .75f;
+      ASSERT_TRUE(sampling.Run());
+      EXPECT_NEAR(result.x, 46.f, 5e-2f);
+      EXPECT_NEAR(result.y, 0.f, 5e-2f);
+      EXPECT_NEAR(result.z, 25.f, 5e-2f);
+    }
+    allocator->Deallocate(image.data());
+  }
+}
@@ -30,6 +30,7 @@
 #include "gtest/gtest.h"
 
 #include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_quaternion.h"
 #include "ozz/base/memory/unique_ptr.h"
 
 #include "ozz/animation/offline/raw_track.h"
@@ -465,3 +466,356 @@ TEST(Quaternion, TrackSamplingJob) {
   ASSERT_TRUE(sampling.Run());
   EXPECT_QUATERNION_EQ(result, 0.f, 0.f, 0.f, 1.f);
 }
+
+TEST(BatchJobValidity, TrackSamplingJob) {
+  TrackBuilder builder;
+  RawFloatTrack raw_float_track;
+  ozz::unique_ptr<FloatTrack> track(builder(raw_float_track));
+  ASSERT_TRUE(track);
+
+  const FloatTrack* tracks[2] = {track.get(), track.get()};
+  float results[2];
+  uint32_t cursors[2] = {};
+
+  {  // Empty/default job is valid, as it has nothing to sample.
+    ozz::animation::BatchFloatTrackSamplingJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Output too small.
+    ozz::animation::BatchFloatTrackSamplingJob job;
+    job.tracks = tracks;
+    job.results = ozz::span<float>(results, 1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Cursors too small.
+    ozz::animation::BatchFloatTrackSamplingJob job;
+    job.tracks = tracks;
+    job.results = results;
+    job.cursors = ozz::span<uint32_t>(cursors, 1);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Null track.
+    const FloatTrack* null_tracks[2] = {track.get(), nullptr};
+    ozz::animation::BatchFloatTrackSamplingJob job;
+    job.tracks = null_tracks;
+    job.results = results;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid, with and without cursors.
+    ozz::animation::BatchFloatTrackSamplingJob job;
+    job.tracks = tracks;
+    job.results = results;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    EXPECT_FLOAT_EQ(results[0], 0.f);
+    EXPECT_FLOAT_EQ(results[1], 0.f);
+
+    job.cursors = cursors;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Batch, TrackSamplingJob) {
+  TrackBuilder builder;
+
+  // Builds tracks with different keyframes count, including steps.
+  const int kTracks = 5;
+  ozz::unique_ptr<FloatTrack> tracks[kTracks];
+  const FloatTrack* tracks_ptr[kTracks];
+  for (int t = 0; t < kTracks; ++t) {
+    RawFloatTrack raw_track;
+    const int keys = t * 7;
+    for (int k = 0; k < keys; ++k) {
+      const RawFloatTrack::Keyframe key = {
+          k % 3 == 2 ? RawTrackInterpolation::kStep
+                     : RawTrackInterpolation::kLinear,
+          static_cast<float>(k) / keys, static_cast<float>(k * (t + 1) % 11)};
+      raw_track.keyframes.push_back(key);
+    }
+    tracks[t] = builder(raw_track);
+    ASSERT_TRUE(tracks[t]);
+    tracks_ptr[t] = tracks[t].get();
+  }
+
+  uint32_t cursors[kTracks] = {};
+  float results[kTracks];
+  float cursor_results[kTracks];
+
+  ozz::animation::BatchFloatTrackSamplingJob batch;
+  batch.tracks = tracks_ptr;
+  batch.results = results;
+
+  ozz::animation::BatchFloatTrackSamplingJob cursor_batch;
+  cursor_batch.tracks = tracks_ptr;
+  cursor_batch.cursors = cursors;
+  cursor_batch.results = cursor_results;
+
+  // Plays forward, then jumps backward and forward. All results must match
+  // single track sampling.
+  const float ratios[] = {-.1f, 0.f,  .01f, .02f, .1f, .11f, .3f,  .31f, .5f,
+                          .56f, .57f, .9f,  1.f,  1.1f, .6f, .2f,  .0f,  .8f,
+                          .81f, .05f, .95f, .96f, .99f, 1.f};
+  for (size_t r = 0; r < OZZ_ARRAY_SIZE(ratios); ++r) {
+    batch.ratio = ratios[r];
+    ASSERT_TRUE(batch.Run());
+    cursor_batch.ratio = ratios[r];
+    ASSERT_TRUE(cursor_batch.Run());
+
+    for (int t = 0; t < kTracks; ++t) {
+      float expected;
+      FloatTrackSamplingJob single;
+      single.track = tracks_ptr[t];
+      single.ratio = ratios[r];
+      single.result = &expected;
+      ASSERT_TRUE(single.Run());
+      EXPECT_FLOAT_EQ(results[t], expected);
+      EXPECT_FLOAT_EQ(cursor_results[t], expected);
+    }
+  }
+}
+
+TEST(MultiFloat, TrackSamplingJob) {
+  TrackBuilder builder;
+
+  // Builds a multi float track, and a FloatTrack per channel with the same
+  // keys.
+  const int kChannels = 7;
+  ozz::animation::offline::RawMultiFloatTrack raw_multi;
+  raw_multi.num_channels = kChannels;
+  RawFloatTrack raw_tracks[kChannels];
+  const float ratios[] = {0.f, .1f, .3f, .35f, .6f, .9f};
+  for (size_t k = 0; k < OZZ_ARRAY_SIZE(ratios); ++k) {
+    ozz::animation::offline::RawMultiFloatTrack::Keyframe multi_key;
+    multi_key.interpolation = k == 3 ? RawTrackInterpolation::kStep
+                                     : RawTrackInterpolation::kLinear;
+    multi_key.ratio = ratios[k];
+    for (int c = 0; c < kChannels; ++c) {
+      const float value = static_cast<float>((k * 7 + c * 3) % 5) - c;
+      multi_key.values.push_back(value);
+      const RawFloatTrack::Keyframe key = {multi_key.interpolation, ratios[k],
+                                           value};
+      raw_tracks[c].keyframes.push_back(key);
+    }
+    raw_multi.keyframes.push_back(multi_key);
+  }
+  ozz::unique_ptr<ozz::animation::MultiFloatTrack> multi(builder(raw_multi));
+  ASSERT_TRUE(multi);
+  ozz::unique_ptr<FloatTrack> tracks[kChannels];
+  for (int c = 0; c < kChannels; ++c) {
+    tracks[c] = builder(raw_tracks[c]);
+    ASSERT_TRUE(tracks[c]);
+  }
+
+  float results[kChannels + 1];
+  uint32_t cursor = 0;
+  ozz::animation::MultiFloatTrackSamplingJob job;
+
+  {  // Invalid jobs.
+    EXPECT_FALSE(job.Validate());
+    job.track = multi.get();
+    EXPECT_FALSE(job.Run());
+    job.results = ozz::span<float>(results, kChannels - 1);
+    EXPECT_FALSE(job.Validate());
+  }
+
+  // Guard value checks channels beyond num_channels aren't written.
+  results[kChannels] = 46.f;
+  job.results = ozz::span<float>(results, kChannels);
+  EXPECT_TRUE(job.Validate());
+
+  const float samples[] = {-1.f, 0.f,  .05f, .1f, .2f, .33f, .35f, .4f,
+                           .7f,  .95f, 1.f,  .2f, .0f, .36f, 1.f};
+  for (int use_cursor = 0; use_cursor < 2; ++use_cursor) {
+    job.cursor = use_cursor ? &cursor : nullptr;
+    for (size_t s = 0; s < OZZ_ARRAY_SIZE(samples); ++s) {
+      job.ratio = samples[s];
+      ASSERT_TRUE(job.Run());
+      for (int c = 0; c < kChannels; ++c) {
+        float expected;
+        FloatTrackSamplingJob single;
+        single.track = tracks[c].get();
+        single.ratio = samples[s];
+        single.result = &expected;
+        ASSERT_TRUE(single.Run());
+        EXPECT_FLOAT_EQ(results[c], expected);
+      }
+      EXPECT_FLOAT_EQ(results[kChannels], 46.f);
+    }
+  }
+}
+
+TEST(Quantized, TrackSamplingJob) {
+  TrackBuilder builder;
+  TrackBuilder quantizer;
+  quantizer.quantize = true;
+
+  ozz::animation::offline::RawFloat3Track raw_float3;
+  ozz::animation::offline::RawQuaternionTrack raw_quaternion;
+  const float ratios[] = {0.f, .1f, .3f, .35f, .6f, .9f};
+  for (size_t k = 0; k < OZZ_ARRAY_SIZE(ratios); ++k) {
+    const RawTrackInterpolation::Value interpolation =
+        k == 3 ? RawTrackInterpolation::kStep : RawTrackInterpolation::kLinear;
+    const float v = static_cast<float>(k);
+    const ozz::animation::offline::RawFloat3Track::Keyframe float3 = {
+        interpolation, ratios[k], ozz::math::Float3(v, -v * 10.f, 46.f)};
+    raw_float3.keyframes.push_back(float3);
+    const ozz::animation::offline::RawQuaternionTrack::Keyframe quaternion = {
+        interpolation, ratios[k],
+        ozz::math::Quaternion::FromAxisAngle(ozz::math::Float3::y_axis(),
+                                             v * .5f)};
+    raw_quaternion.keyframes.push_back(quaternion);
+  }
+
+  ozz::unique_ptr<Float3Track> float3(builder(raw_float3));
+  ozz::unique_ptr<Float3Track> q_float3(quantizer(raw_float3));
+  ozz::unique_ptr<QuaternionTrack> quaternion(builder(raw_quaternion));
+  ozz::unique_ptr<QuaternionTrack> q_quaternion(quantizer(raw_quaternion));
+  ASSERT_TRUE(float3 && q_float3 && quaternion && q_quaternion);
+  EXPECT_TRUE(q_float3->quantized());
+  EXPECT_TRUE(q_quaternion->quantized());
+  EXPECT_LT(q_float3->size(), float3->size());
+  EXPECT_LT(q_quaternion->size(), quaternion->size());
+
+  ozz::math::Float3 float3_result, q_float3_result;
+  ozz::math::Quaternion quaternion_result, q_quaternion_result;
+  uint32_t cursors[2] = {};
+  for (int s = 0; s <= 100; ++s) {
+    const float ratio = s / 100.f;
+
+    ozz::animation::Float3TrackSamplingJob float3_job;
+    float3_job.ratio = ratio;
+    float3_job.track = float3.get();
+    float3_job.result = &float3_result;
+    ASSERT_TRUE(float3_job.Run());
+    float3_job.track = q_float3.get();
+    float3_job.result = &q_float3_result;
+    ASSERT_TRUE(float3_job.Run());
+    // Error is bounded by values precision (range / 65535), plus ratios
+    // precision (1 / 65535) times the slope between keys.
+    EXPECT_NEAR(q_float3_result.x, float3_result.x, 25.f / 65535.f);
+    EXPECT_NEAR(q_float3_result.y, float3_result.y, 250.f / 65535.f);
+    EXPECT_NEAR(q_float3_result.z, float3_result.z, 1e-6f);
+
+    ozz::animation::QuaternionTrackSamplingJob quaternion_job;
+    quaternion_job.ratio = ratio;
+    quaternion_job.track = quaternion.get();
+    quaternion_job.result = &quaternion_result;
+    ASSERT_TRUE(quaternion_job.Run());
+    quaternion_job.track = q_quaternion.get();
+    quaternion_job.result = &q_quaternion_result;
+    ASSERT_TRUE(quaternion_job.Run());
+    EXPECT_NEAR(q_quaternion_result.x, quaternion_result.x, 1e-4f);
+    EXPECT_NEAR(q_quaternion_result.y, quaternion_result.y, 1e-4f);
+    EXPECT_NEAR(q_quaternion_result.z, quaternion_result.z, 1e-4f);
+    EXPECT_NEAR(q_quaternion_result.w, quaternion_result.w, 1e-4f);
+
+    // Batch job with cursors.
+    const Float3Track* tracks[2] = {q_float3.get(), float3.get()};
+    ozz::math::Float3 results[2];
+    ozz::animation::BatchFloat3TrackSamplingJob batch;
+    batch.ratio = ratio;
+    batch.tracks = tracks;
+    batch.cursors = cursors;
+    batch.results = results;
+    ASSERT_TRUE(batch.Run());
+    EXPECT_FLOAT3_EQ(results[0], q_float3_result.x, q_float3_result.y,
+                     q_float3_result.z);
+    EXPECT_FLOAT3_EQ(results[1], float3_result.x, float3_result.y,
+                     float3_result.z);
+  }
+}
+
+TEST(SoaQuaternion, TrackSamplingJob) {
+  TrackBuilder builder;
+  TrackBuilder quantizer;
+  quantizer.quantize = true;
+
+  // Builds tracks with different keyframes count, including an empty track,
+  // steps and quantized tracks. 6 tracks leave 2 unused lanes.
+  const int kTracks = 6;
+  ozz::unique_ptr<QuaternionTrack> tracks[kTracks];
+  const QuaternionTrack* tracks_ptr[kTracks];
+  for (int t = 0; t < kTracks; ++t) {
+    ozz::animation::offline::RawQuaternionTrack raw_track;
+    const int keys = t * 5;
+    for (int k = 0; k < keys; ++k) {
+      const ozz::animation::offline::RawQuaternionTrack::Keyframe key = {
+          k % 3 == 2 ? RawTrackInterpolation::kStep
+                     : RawTrackInterpolation::kLinear,
+          static_cast<float>(k) / keys,
+          ozz::math::Quaternion::FromAxisAngle(
+              Normalize(ozz::math::Float3(k % 2 ? 1.f : 0.f, 1.f, t * .1f)),
+              k * (t + 1) * .3f)};
+      raw_track.keyframes.push_back(key);
+    }
+    tracks[t] = t % 2 ? quantizer(raw_track) : builder(raw_track);
+    ASSERT_TRUE(tracks[t]);
+    tracks_ptr[t] = tracks[t].get();
+  }
+
+  uint32_t cursors[kTracks] = {};
+  ozz::math::SoaQuaternion results[2];
+  ozz::math::SoaQuaternion cursor_results[2];
+
+  ozz::animation::SoaQuaternionTrackSamplingJob job;
+  job.tracks = tracks_ptr;
+
+  // Validation.
+  EXPECT_FALSE(job.Validate());
+  job.results = ozz::make_span(results).first(1);
+  EXPECT_FALSE(job.Validate());
+  EXPECT_FALSE(job.Run());
+  job.results = results;
+  EXPECT_TRUE(job.Validate());
+  job.cursors = ozz::make_span(cursors).first(kTracks - 1);
+  EXPECT_FALSE(job.Validate());
+  job.cursors = {};
+  EXPECT_TRUE(job.Validate());
+
+  ozz::animation::SoaQuaternionTrackSamplingJob cursor_job;
+  cursor_job.tracks = tracks_ptr;
+  cursor_job.cursors = cursors;
+  cursor_job.results = cursor_results;
+
+  // Plays forward, then jumps backward and forward. All results must match
+  // single track sampling.
+  const float ratios[] = {-.1f, 0.f, .01f, .1f, .3f, .31f, .5f, .57f,
+                          1.f,  1.1f, .6f, .2f, .0f, .8f,  .95f, 1.f};
+  for (size_t r = 0; r < OZZ_ARRAY_SIZE(ratios); ++r) {
+    job.ratio = ratios[r];
+    ASSERT_TRUE(job.Run());
+    cursor_job.ratio = ratios[r];
+    ASSERT_TRUE(cursor_job.Run());
+
+    for (int t = 0; t < 8; ++t) {
+      ozz::math::Quaternion single_result = ozz::math::Quaternion::identity();
+      if (t < kTracks) {
+        ozz::animation::QuaternionTrackSamplingJob single;
+        single.track = tracks_ptr[t];
+        single.ratio = ratios[r];
+        single.result = &single_result;
+        ASSERT_TRUE(single.Run());
+      }
+      const ozz::math::SoaQuaternion* soas[] = {&results[t / 4],
+                                                &cursor_results[t / 4]};
+      for (int s = 0; s < 2; ++s) {
+        float x[4], y[4], z[4], w[4];
+        ozz::math::StorePtrU(soas[s]->x, x);
+        ozz::math::StorePtrU(soas[s]->y, y);
+        ozz::math::StorePtrU(soas[s]->z, z);
+        ozz::math::StorePtrU(soas[s]->w, w);
+        EXPECT_QUATERNION_EQ(single_result, x[t % 4], y[t % 4], z[t % 4],
+                             w[t % 4]);
+      }
+    }
+  }
+}
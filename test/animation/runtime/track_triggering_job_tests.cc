@@ -34,7 +34,9 @@
 #include "ozz/base/maths/gtest_math_helper.h"
 #include "ozz/base/memory/unique_ptr.h"
 
+using ozz::animation::BatchTrackTriggeringJob;
 using ozz::animation::FloatTrack;
+using ozz::animation::TrackEdgeIndex;
 using ozz::animation::TrackTriggeringJob;
 using ozz::animation::offline::RawFloatTrack;
 using ozz::animation::offline::RawTrackInterpolation;
@@ -96,6 +98,33 @@ TEST(JobValidity, TrackTriggeringJob) {
     EXPECT_TRUE(job.Validate());
     EXPECT_TRUE(job.Run());
   }
+  {  // Valid index, without track
+    TrackEdgeIndex index;
+    ASSERT_TRUE(index.Build(*track, 0.f));
+    TrackTriggeringJob job;
+    job.index = &index;
+    TrackTriggeringJob::Iterator iterator;
+    job.iterator = &iterator;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Quantized track isn't supported
+    builder.quantize = true;
+    ozz::unique_ptr<FloatTrack> quantized(builder(raw_track));
+    ASSERT_TRUE(quantized);
+    ASSERT_TRUE(quantized->quantized());
+    TrackTriggeringJob job;
+    job.track = quantized.get();
+    TrackTriggeringJob::Iterator iterator;
+    job.iterator = &iterator;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+
+    TrackEdgeIndex index;
+    EXPECT_FALSE(index.Build(*quantized, 0.f));
+    EXPECT_TRUE(index.edges().empty());
+  }
 }
 
 TEST(Default, TrackEdgeTriggerJob) {
@@ -862,6 +891,64 @@ void TestEdgesExpectation(
       TestEdgesExpectationBackward(iterator, job);
     }
   }
+  {  // Randomized tests indexed/detected edges coherency
+    TrackEdgeIndex index;
+    ASSERT_TRUE(index.Build(*track, _threshold));
+    EXPECT_FLOAT_EQ(index.threshold(), _threshold);
+    ASSERT_EQ(index.edges().size(), _size);
+
+    TrackTriggeringJob indexed_job;
+    indexed_job.index = &index;
+
+    const float kMaxRange = 10.f;
+    const size_t kMaxIterations = 1000;
+    for (size_t i = 0; i < kMaxIterations; ++i) {
+      job.from = kMaxRange * (1.f - 2.f * static_cast<float>(rand()) /
+                                        static_cast<float>(RAND_MAX));
+      job.to = kMaxRange * (1.f - 2.f * static_cast<float>(rand()) /
+                                      static_cast<float>(RAND_MAX));
+      if (rand() % 4 == 0) {
+        // Set ratio to a keyframe ratio.
+        job.from = _expected[rand() % _size].ratio + floorf(job.from);
+      }
+      TrackTriggeringJob::Iterator iterator;
+      job.iterator = &iterator;
+      ASSERT_TRUE(job.Run());
+
+      indexed_job.from = job.from;
+      indexed_job.to = job.to;
+      TrackTriggeringJob::Iterator indexed_iterator;
+      indexed_job.iterator = &indexed_iterator;
+      ASSERT_TRUE(indexed_job.Run());
+
+      ASSERT_EQ(CountEdges(iterator, job.end()),
+                CountEdges(indexed_iterator, indexed_job.end()));
+
+      // Batch job, the track being queried twice.
+      const BatchTrackTriggeringJob::Query queries[] = {
+          {track.get(), job.from, job.to, _threshold},
+          {track.get(), job.from, job.to, _threshold}};
+      TrackTriggeringJob::Edge edges[256];
+      uint32_t counts[2];
+      BatchTrackTriggeringJob batch_job;
+      batch_job.queries = queries;
+      batch_job.edges = edges;
+      batch_job.counts = counts;
+      ASSERT_TRUE(batch_job.Run());
+      ASSERT_EQ(counts[0], CountEdges(iterator, job.end()));
+      ASSERT_EQ(counts[1], counts[0]);
+
+      for (size_t e = 0; iterator != job.end();
+           ++iterator, ++indexed_iterator, ++e) {
+        EXPECT_EQ(iterator->ratio, indexed_iterator->ratio);
+        EXPECT_EQ(iterator->rising, indexed_iterator->rising);
+        EXPECT_EQ(iterator->ratio, edges[e].ratio);
+        EXPECT_EQ(iterator->rising, edges[e].rising);
+        EXPECT_EQ(iterator->ratio, edges[counts[0] + e].ratio);
+        EXPECT_EQ(iterator->rising, edges[counts[0] + e].rising);
+      }
+    }
+  }
   {  // Randomized tests rising/falling coherency
     const float kMaxRange = 2.f;
     const size_t kMaxIterations = 1000;
@@ -1404,3 +1491,103 @@ TEST(LinearThreshold, TrackEdgeTriggerJob) {
     ASSERT_EQ(CountEdges(iterator, job.end()), 0u);
   }
 }
+
+TEST(Batch, TrackTriggeringJob) {
+  // Builds a track with enough keys to be processed 4 at a time.
+  ozz::animation::offline::RawFloatTrack raw_track;
+  for (int i = 0; i < 23; ++i) {
+    const ozz::animation::offline::RawFloatTrack::Keyframe key = {
+        i % 3 == 0 ? RawTrackInterpolation::kStep
+                   : RawTrackInterpolation::kLinear,
+        i / 22.f, static_cast<float>((i * 7) % 5)};
+    raw_track.keyframes.push_back(key);
+  }
+  ozz::unique_ptr<FloatTrack> track(TrackBuilder()(raw_track));
+  ASSERT_TRUE(track);
+
+  const BatchTrackTriggeringJob::Query queries[] = {
+      {track.get(), 0.f, 1.f, 2.f},
+      {track.get(), .3f, .6f, 2.5f},
+      {track.get(), 2.7f, -1.2f, 1.f},
+      {track.get(), .5f, .5f, 1.f}};
+  TrackTriggeringJob::Edge edges[128];
+  uint32_t counts[OZZ_ARRAY_SIZE(queries)];
+
+  {  // Default is valid, nothing to do.
+    BatchTrackTriggeringJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Counts too small
+    BatchTrackTriggeringJob job;
+    job.queries = queries;
+    job.edges = edges;
+    job.counts = ozz::span<uint32_t>(counts, 2);
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid track
+    const BatchTrackTriggeringJob::Query invalid[] = {
+        {track.get(), 0.f, 1.f, 2.f}, {nullptr, 0.f, 1.f, 2.f}};
+    BatchTrackTriggeringJob job;
+    job.queries = invalid;
+    job.edges = edges;
+    job.counts = counts;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  // Computes expected edges with TrackTriggeringJob.
+  ozz::vector<TrackTriggeringJob::Edge> expected;
+  uint32_t expected_counts[OZZ_ARRAY_SIZE(queries)];
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(queries); ++i) {
+    TrackTriggeringJob job;
+    job.track = queries[i].track;
+    job.from = queries[i].from;
+    job.to = queries[i].to;
+    job.threshold = queries[i].threshold;
+    TrackTriggeringJob::Iterator iterator;
+    job.iterator = &iterator;
+    ASSERT_TRUE(job.Run());
+    expected_counts[i] = 0;
+    for (; iterator != job.end(); ++iterator, ++expected_counts[i]) {
+      expected.push_back(*iterator);
+    }
+  }
+  EXPECT_EQ(expected_counts[3], 0u);
+
+  {  // Valid
+    BatchTrackTriggeringJob job;
+    job.queries = queries;
+    job.edges = edges;
+    job.counts = counts;
+    ASSERT_TRUE(job.Validate());
+    ASSERT_TRUE(job.Run());
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(queries); ++i) {
+      EXPECT_EQ(counts[i], expected_counts[i]);
+    }
+    for (size_t e = 0; e < expected.size(); ++e) {
+      EXPECT_EQ(edges[e].ratio, expected[e].ratio);
+      EXPECT_EQ(edges[e].rising, expected[e].rising);
+    }
+  }
+
+  {  // Edges buffer too small
+    const size_t size = expected_counts[0] + 2;
+    BatchTrackTriggeringJob job;
+    job.queries = queries;
+    job.edges = ozz::span<TrackTriggeringJob::Edge>(edges, size);
+    job.counts = counts;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_FALSE(job.Run());
+    EXPECT_EQ(counts[0], expected_counts[0]);
+    EXPECT_EQ(counts[1], 2u);
+    EXPECT_EQ(counts[2], 0u);
+    EXPECT_EQ(counts[3], 0u);
+    for (size_t e = 0; e < size; ++e) {
+      EXPECT_EQ(edges[e].ratio, expected[e].ratio);
+    }
+  }
+}
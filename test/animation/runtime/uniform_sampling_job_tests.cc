@@ -0,0 +1,252 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/uniform_sampling_job.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/uniform_animation_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/uniform_animation.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingJob;
+using ozz::animation::UniformAnimation;
+using ozz::animation::UniformSamplingJob;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::UniformAnimationBuilder;
+
+namespace {
+// Builds an animation keyed every 30th of second, so that keys match uniform
+// frames.
+void BuildRawAnimation(int _num_tracks, RawAnimation* _raw_animation) {
+  _raw_animation->duration = 2.f;
+  _raw_animation->tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = _raw_animation->tracks[i];
+    for (int f = 0; f <= 60; ++f) {
+      const float time = f / 30.f;
+      const float v = std::sin(time * 3.f + i);
+      const RawAnimation::TranslationKey t = {
+          time, ozz::math::Float3(v, i * .1f, -v * 2.f)};
+      track.translations.push_back(t);
+      const RawAnimation::RotationKey r = {
+          time, ozz::math::Quaternion::FromEuler(v * 3.f, v, i * .2f)};
+      track.rotations.push_back(r);
+      if (i % 3 == 0) {
+        const RawAnimation::ScaleKey s = {time,
+                                          ozz::math::Float3(1.f + v * .5f)};
+        track.scales.push_back(s);
+      }
+    }
+  }
+}
+
+void ExpectSoaNear(const ozz::math::SimdFloat4* _a,
+                   const ozz::math::SimdFloat4* _b, int _count,
+                   float _tolerance) {
+  for (int i = 0; i < _count; ++i) {
+    float a[4], b[4];
+    ozz::math::StorePtrU(_a[i], a);
+    ozz::math::StorePtrU(_b[i], b);
+    for (int j = 0; j < 4; ++j) {
+      EXPECT_NEAR(a[j], b[j], _tolerance);
+    }
+  }
+}
+
+// Animation stores translations and scales as half floats, hence the
+// tolerance. Rotations are compared up to sign, as both formats can output
+// either hemisphere.
+void ExpectTransformsNear(const ozz::math::SoaTransform* _a,
+                          const ozz::math::SoaTransform* _b, int _count) {
+  for (int i = 0; i < _count; ++i) {
+    ExpectSoaNear(&_a[i].translation.x, &_b[i].translation.x, 3, 2e-3f);
+    ExpectSoaNear(&_a[i].scale.x, &_b[i].scale.x, 3, 2e-3f);
+    const ozz::math::SimdFloat4 dot = ozz::math::Abs(
+        _a[i].rotation.x * _b[i].rotation.x +
+        _a[i].rotation.y * _b[i].rotation.y +
+        _a[i].rotation.z * _b[i].rotation.z +
+        _a[i].rotation.w * _b[i].rotation.w);
+    const ozz::math::SimdFloat4 one = ozz::math::simd_float4::one();
+    ExpectSoaNear(&dot, &one, 1, 2e-3f);
+  }
+}
+}  // namespace
+
+TEST(JobValidity, UniformSamplingJob) {
+  RawAnimation raw_animation;
+  BuildRawAnimation(5, &raw_animation);
+  UniformAnimationBuilder builder;
+  ozz::unique_ptr<UniformAnimation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  ozz::math::SoaTransform output[2];
+
+  {  // Empty/default job.
+    UniformSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output.
+    UniformSamplingJob job;
+    job.animation = animation.get();
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid animation.
+    UniformSamplingJob job;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job, with a smaller output.
+    UniformSamplingJob job;
+    job.animation = animation.get();
+    job.output = ozz::span<ozz::math::SoaTransform>(output, 1);
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job.
+    UniformSamplingJob job;
+    job.animation = animation.get();
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job, empty animation.
+    UniformAnimation empty;
+    UniformSamplingJob job;
+    job.animation = &empty;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Sampling, UniformSamplingJob) {
+  RawAnimation raw_animation;
+  BuildRawAnimation(7, &raw_animation);
+
+  AnimationBuilder animation_builder;
+  ozz::unique_ptr<Animation> animation(animation_builder(raw_animation));
+  ASSERT_TRUE(animation);
+  UniformAnimationBuilder uniform_builder;
+  ozz::unique_ptr<UniformAnimation> uniform(uniform_builder(raw_animation));
+  ASSERT_TRUE(uniform);
+  EXPECT_EQ(uniform->num_frames(), 61);
+
+  SamplingJob::Context context(animation->num_tracks());
+  ozz::math::SoaTransform expected_output[2];
+  ozz::math::SoaTransform output[2];
+
+  // Samples on frames and in between, in both directions as the uniform job
+  // has no context.
+  for (int i = 0; i <= 240; ++i) {
+    const float ratio = (i % 2 ? 240 - i : i) / 240.f;
+
+    SamplingJob sampling_job;
+    sampling_job.animation = animation.get();
+    sampling_job.context = &context;
+    sampling_job.ratio = ratio;
+    sampling_job.output = expected_output;
+    ASSERT_TRUE(sampling_job.Run());
+
+    UniformSamplingJob job;
+    job.animation = uniform.get();
+    job.ratio = ratio;
+    job.output = output;
+    ASSERT_TRUE(job.Run());
+
+    ExpectTransformsNear(output, expected_output, 2);
+  }
+}
+
+TEST(Bounds, UniformSamplingJob) {
+  RawAnimation raw_animation;
+  BuildRawAnimation(3, &raw_animation);
+  UniformAnimationBuilder builder;
+  ozz::unique_ptr<UniformAnimation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  ozz::math::SoaTransform first[1];
+  ozz::math::SoaTransform last[1];
+  ozz::math::SoaTransform output[1];
+
+  UniformSamplingJob job;
+  job.animation = animation.get();
+  job.ratio = 0.f;
+  job.output = first;
+  ASSERT_TRUE(job.Run());
+  job.ratio = 1.f;
+  job.output = last;
+  ASSERT_TRUE(job.Run());
+
+  // Ratios are clamped.
+  job.output = output;
+  job.ratio = -1.f;
+  ASSERT_TRUE(job.Run());
+  ExpectTransformsNear(output, first, 1);
+  job.ratio = 2.f;
+  ASSERT_TRUE(job.Run());
+  ExpectTransformsNear(output, last, 1);
+}
+
+TEST(Unchanged, UniformSamplingJob) {
+  RawAnimation raw_animation;
+  BuildRawAnimation(3, &raw_animation);
+  UniformAnimationBuilder builder;
+  ozz::unique_ptr<UniformAnimation> animation(builder(raw_animation));
+  ASSERT_TRUE(animation);
+
+  // Output entries beyond animation tracks are left unchanged.
+  ozz::math::SoaTransform output[2];
+  output[1] = ozz::math::SoaTransform::identity();
+  output[1].translation.x = ozz::math::simd_float4::Load1(46.f);
+
+  UniformSamplingJob job;
+  job.animation = animation.get();
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  float x[4];
+  ozz::math::StorePtrU(output[1].translation.x, x);
+  EXPECT_FLOAT_EQ(x[0], 46.f);
+  EXPECT_FLOAT_EQ(x[3], 46.f);
+}
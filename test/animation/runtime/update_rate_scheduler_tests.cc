@@ -0,0 +1,215 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/animation/runtime/update_rate_scheduler.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/unique_ptr.h"
+
+using ozz::animation::Animation;
+using ozz::animation::Skeleton;
+using ozz::animation::UpdateRateScheduler;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a 2 joints chain skeleton.
+ozz::unique_ptr<Skeleton> BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "j0";
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].name = "j1";
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+// Builds an animation of _num_tracks tracks, whose first track translates
+// along x from 0 to 1.
+ozz::unique_ptr<Animation> BuildAnimation(int _num_tracks) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(_num_tracks);
+  const RawAnimation::TranslationKey first = {0.f, ozz::math::Float3::zero()};
+  const RawAnimation::TranslationKey last = {1.f, ozz::math::Float3::x_axis()};
+  raw_animation.tracks[0].translations.push_back(first);
+  raw_animation.tracks[0].translations.push_back(last);
+  return AnimationBuilder()(raw_animation);
+}
+
+// Gets x translation of _instance root joint.
+float RootX(const UpdateRateScheduler& _scheduler, int _instance) {
+  return ozz::math::GetX(_scheduler.models(_instance)[0].cols[3]);
+}
+}  // namespace
+
+TEST(Error, UpdateRateScheduler) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ozz::unique_ptr<Animation> animation = BuildAnimation(2);
+  ozz::unique_ptr<Animation> mismatching = BuildAnimation(3);
+  ASSERT_TRUE(skeleton && animation && mismatching);
+
+  UpdateRateScheduler scheduler;
+  const float ratios[2] = {0.f, 0.f};
+
+  // Not allocated.
+  EXPECT_FALSE(scheduler.Update(ratios));
+  EXPECT_FALSE(scheduler.set_animation(0, animation.get()));
+  EXPECT_FALSE(scheduler.set_period(0, 2));
+  EXPECT_EQ(scheduler.period(0), 0);
+  EXPECT_TRUE(scheduler.models(0).empty());
+
+  // Invalid allocation.
+  EXPECT_FALSE(scheduler.Allocate(*skeleton, 0));
+  EXPECT_FALSE(scheduler.Allocate(Skeleton(), 2));
+  EXPECT_EQ(scheduler.num_instances(), 0);
+
+  ASSERT_TRUE(scheduler.Allocate(*skeleton, 2));
+  EXPECT_EQ(scheduler.num_instances(), 2);
+
+  // Invalid instance or animation.
+  EXPECT_FALSE(scheduler.set_animation(2, animation.get()));
+  EXPECT_FALSE(scheduler.set_animation(-1, animation.get()));
+  EXPECT_FALSE(scheduler.set_animation(0, mismatching.get()));
+  EXPECT_FALSE(scheduler.set_period(2, 2));
+
+  // Not enough ratios.
+  EXPECT_FALSE(scheduler.Update({ratios, 1}));
+
+  // Disabled instances have no pose.
+  EXPECT_TRUE(scheduler.Update(ratios));
+  EXPECT_EQ(scheduler.num_updates(), 0);
+  EXPECT_TRUE(scheduler.models(0).empty());
+}
+
+TEST(PeriodFromDistance, UpdateRateScheduler) {
+  EXPECT_EQ(UpdateRateScheduler::PeriodFromDistance(5.f, 10.f, 8), 1);
+  EXPECT_EQ(UpdateRateScheduler::PeriodFromDistance(10.f, 10.f, 8), 1);
+  EXPECT_EQ(UpdateRateScheduler::PeriodFromDistance(15.f, 10.f, 8), 2);
+  EXPECT_EQ(UpdateRateScheduler::PeriodFromDistance(25.f, 10.f, 8), 4);
+  EXPECT_EQ(UpdateRateScheduler::PeriodFromDistance(45.f, 10.f, 8), 8);
+  EXPECT_EQ(UpdateRateScheduler::PeriodFromDistance(1e3f, 10.f, 8), 8);
+  EXPECT_EQ(UpdateRateScheduler::PeriodFromDistance(1e6f, 10.f, 64),
+            UpdateRateScheduler::kMaxPeriod);
+  EXPECT_EQ(UpdateRateScheduler::PeriodFromDistance(1e3f, 10.f, 0), 1);
+}
+
+TEST(Period, UpdateRateScheduler) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+
+  UpdateRateScheduler scheduler;
+  ASSERT_TRUE(scheduler.Allocate(*skeleton, 2));
+  EXPECT_EQ(scheduler.period(0), 1);
+  EXPECT_TRUE(scheduler.set_period(0, 4));
+  EXPECT_EQ(scheduler.period(0), 4);
+  EXPECT_TRUE(scheduler.set_period(0, 0));
+  EXPECT_EQ(scheduler.period(0), 1);
+  EXPECT_TRUE(scheduler.set_period(0, 1000));
+  EXPECT_EQ(scheduler.period(0), UpdateRateScheduler::kMaxPeriod);
+}
+
+TEST(Staggering, UpdateRateScheduler) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ozz::unique_ptr<Animation> animation = BuildAnimation(2);
+  ASSERT_TRUE(skeleton && animation);
+
+  const int kNumInstances = 12;
+  UpdateRateScheduler scheduler;
+  ASSERT_TRUE(scheduler.Allocate(*skeleton, kNumInstances));
+  for (int i = 0; i < kNumInstances; ++i) {
+    EXPECT_TRUE(scheduler.set_animation(i, animation.get()));
+    EXPECT_TRUE(scheduler.set_period(i, i < 8 ? 4 : 2));
+  }
+  float ratios[kNumInstances] = {};
+
+  // First update samples all instances.
+  ASSERT_TRUE(scheduler.Update(ratios));
+  EXPECT_EQ(scheduler.num_updates(), kNumInstances);
+  EXPECT_EQ(scheduler.frame(), 1);
+
+  // Then 8/4 + 4/2 instances per frame.
+  for (int f = 0; f < 8; ++f) {
+    ASSERT_TRUE(scheduler.Update(ratios));
+    EXPECT_EQ(scheduler.num_updates(), 4);
+  }
+
+  // Instance 0 now updates every frame, others keep their rate: 4 + 7 + 8
+  // updates over 4 frames.
+  EXPECT_TRUE(scheduler.set_period(0, 1));
+  int num_updates = 0;
+  for (int f = 0; f < 4; ++f) {
+    ASSERT_TRUE(scheduler.Update(ratios));
+    num_updates += scheduler.num_updates();
+  }
+  EXPECT_EQ(num_updates, 19);
+
+  // So does changing animation, disabling stops updates.
+  EXPECT_TRUE(scheduler.set_animation(1, nullptr));
+  EXPECT_TRUE(scheduler.set_animation(2, nullptr));
+  EXPECT_TRUE(scheduler.models(1).empty());
+  EXPECT_TRUE(scheduler.set_animation(2, animation.get()));
+  ASSERT_TRUE(scheduler.Update(ratios));
+  EXPECT_EQ(scheduler.models(2).size(), 2u);
+}
+
+TEST(Interpolation, UpdateRateScheduler) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ozz::unique_ptr<Animation> animation = BuildAnimation(2);
+  ASSERT_TRUE(skeleton && animation);
+
+  UpdateRateScheduler scheduler;
+  ASSERT_TRUE(scheduler.Allocate(*skeleton, 2));
+  EXPECT_TRUE(scheduler.set_animation(0, animation.get()));
+  EXPECT_TRUE(scheduler.set_animation(1, animation.get()));
+  EXPECT_TRUE(scheduler.set_period(1, 4));
+
+  for (int f = 0; f < 16; ++f) {
+    const float ratio = f * .05f;
+    const float ratios[2] = {ratio, ratio};
+    ASSERT_TRUE(scheduler.Update(ratios));
+
+    // Period 1 is exact.
+    EXPECT_NEAR(RootX(scheduler, 0), ratio, 1e-3f);
+
+    // Period 4 is interpolated, reaching latest update pose 3 frames later.
+    const float expected = f < 4 ? 0.f : (f - 3) * .05f;
+    EXPECT_NEAR(RootX(scheduler, 1), expected, 1e-3f);
+
+    // Child inherits root interpolated translation.
+    EXPECT_NEAR(ozz::math::GetX(scheduler.models(1)[1].cols[3]), expected,
+                1e-3f);
+  }
+}
@@ -0,0 +1,145 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/containers/pose_block.h"
+
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
+namespace {
+// Tells if _ptr is aligned to a cache line.
+bool IsCacheAligned(const void* _ptr) {
+  return (reinterpret_cast<uintptr_t>(_ptr) &
+          (ozz::PoseBlock::kCacheLineSize - 1)) == 0;
+}
+
+// Mimics animation::Skeleton interface used to size a block.
+struct Skeleton {
+  int num_joints() const { return 9; }
+};
+}  // namespace
+
+TEST(Empty, PoseBlock) {
+  const ozz::PoseBlock block;
+  EXPECT_EQ(block.num_joints(), 0);
+  EXPECT_EQ(block.num_local_poses(), 0);
+  EXPECT_EQ(block.size(), 0u);
+  EXPECT_TRUE(block.locals().empty());
+  EXPECT_TRUE(block.models().empty());
+  EXPECT_TRUE(block.palette().empty());
+
+  ozz::PoseBlock no_joint(0);
+  EXPECT_EQ(no_joint.num_local_poses(), 1);
+  EXPECT_TRUE(no_joint.locals().empty());
+  EXPECT_TRUE(no_joint.models().empty());
+
+  ozz::PoseBlock invalid;
+  EXPECT_FALSE(invalid.Resize(-1));
+  EXPECT_FALSE(invalid.Resize(4, -1));
+  EXPECT_EQ(invalid.num_joints(), 0);
+  EXPECT_EQ(invalid.size(), 0u);
+}
+
+TEST(Layout, PoseBlock) {
+  ozz::PoseBlock block;
+  ASSERT_TRUE(block.Resize(5, 2));
+  EXPECT_EQ(block.num_joints(), 5);
+  EXPECT_EQ(block.num_soa_joints(), 2);
+  EXPECT_EQ(block.num_local_poses(), 2);
+  EXPECT_EQ(block.size() % ozz::PoseBlock::kCacheLineSize, 0u);
+
+  ASSERT_EQ(block.locals(0).size(), 2u);
+  ASSERT_EQ(block.locals(1).size(), 2u);
+  EXPECT_TRUE(block.locals(2).empty());
+  EXPECT_TRUE(block.locals(-1).empty());
+  ASSERT_EQ(block.models().size(), 5u);
+  ASSERT_EQ(block.palette().size(), 5u);
+
+  // Buffers are cache aligned, and don't overlap.
+  EXPECT_TRUE(IsCacheAligned(block.locals(0).data()));
+  EXPECT_TRUE(IsCacheAligned(block.locals(1).data()));
+  EXPECT_TRUE(IsCacheAligned(block.models().data()));
+  EXPECT_TRUE(IsCacheAligned(block.palette().data()));
+  EXPECT_LE(static_cast<const void*>(block.locals(0).end()),
+            static_cast<const void*>(block.locals(1).begin()));
+  EXPECT_LE(static_cast<const void*>(block.locals(1).end()),
+            static_cast<const void*>(block.models().begin()));
+  EXPECT_LE(static_cast<const void*>(block.models().end()),
+            static_cast<const void*>(block.palette().begin()));
+  EXPECT_LE(reinterpret_cast<const char*>(block.palette().end()),
+            reinterpret_cast<const char*>(block.locals(0).begin()) +
+                block.size());
+
+  // Buffers are initialized to identity.
+  for (const ozz::math::SoaTransform& transform : block.locals(1)) {
+    EXPECT_SOAFLOAT3_EQ(transform.translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAQUATERNION_EQ(transform.rotation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f);
+  }
+  for (const ozz::math::Float4x4& matrix : block.palette()) {
+    EXPECT_FLOAT4x4_EQ(matrix, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f,
+                       1.f, 0.f, 0.f, 0.f, 0.f, 1.f);
+  }
+}
+
+TEST(Skeleton, PoseBlock) {
+  const ozz::PoseBlock block((Skeleton()));
+  EXPECT_EQ(block.num_joints(), 9);
+  EXPECT_EQ(block.num_local_poses(), 1);
+  EXPECT_EQ(block.locals().size(), 3u);
+  EXPECT_EQ(block.models().size(), 9u);
+
+  const ozz::PoseBlock layers(Skeleton(), 3);
+  EXPECT_EQ(layers.num_local_poses(), 3);
+  EXPECT_EQ(layers.locals(2).size(), 3u);
+}
+
+TEST(Move, PoseBlock) {
+  ozz::PoseBlock block(6);
+  const ozz::math::Float4x4* models = block.models().data();
+
+  ozz::PoseBlock moved(std::move(block));
+  EXPECT_EQ(moved.num_joints(), 6);
+  EXPECT_EQ(moved.models().data(), models);
+  EXPECT_EQ(block.num_joints(), 0);
+  EXPECT_TRUE(block.models().empty());
+
+  ozz::PoseBlock assigned(2);
+  assigned = std::move(moved);
+  EXPECT_EQ(assigned.num_joints(), 6);
+  EXPECT_EQ(assigned.models().data(), models);
+
+  // Resizing releases previous buffers.
+  EXPECT_TRUE(assigned.Resize(1));
+  EXPECT_EQ(assigned.num_joints(), 1);
+  EXPECT_EQ(assigned.models().size(), 1u);
+}
@@ -0,0 +1,201 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/containers/small_vector.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/memory/linear_allocator.h"
+
+namespace {
+// Counts allocations forwarded to the default allocator.
+class CountingAllocator : public ozz::memory::Allocator {
+ public:
+  CountingAllocator() : allocations_(0), deallocations_(0) {}
+
+  virtual void* Allocate(size_t _size, size_t _alignment) {
+    ++allocations_;
+    return ozz::memory::default_allocator()->Allocate(_size, _alignment);
+  }
+
+  virtual void Deallocate(void* _block) {
+    if (_block) {
+      ++deallocations_;
+    }
+    ozz::memory::default_allocator()->Deallocate(_block);
+  }
+
+  int allocations() const { return allocations_; }
+  int deallocations() const { return deallocations_; }
+
+ private:
+  int allocations_;
+  int deallocations_;
+};
+
+// Counts living instances, to test elements construction and destruction.
+struct Counted {
+  Counted() : value(0) { ++instances; }
+  explicit Counted(int _value) : value(_value) { ++instances; }
+  Counted(const Counted& _other) : value(_other.value) { ++instances; }
+  ~Counted() { --instances; }
+  int value;
+  static int instances;
+};
+int Counted::instances = 0;
+}  // namespace
+
+TEST(Inline, SmallVector) {
+  CountingAllocator allocator;
+  {
+    ozz::SmallVector<int, 4> vector(&allocator);
+    EXPECT_TRUE(vector.empty());
+    EXPECT_EQ(vector.size(), 0u);
+    EXPECT_EQ(vector.capacity(), 4u);
+    EXPECT_TRUE(vector.is_inline());
+
+    for (int i = 0; i < 4; ++i) {
+      vector.push_back(i);
+    }
+    EXPECT_EQ(vector.size(), 4u);
+    EXPECT_TRUE(vector.is_inline());
+    EXPECT_EQ(vector.front(), 0);
+    EXPECT_EQ(vector.back(), 3);
+    EXPECT_EQ(vector.end() - vector.begin(), 4);
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_EQ(vector[i], i);
+    }
+
+    vector.pop_back();
+    EXPECT_EQ(vector.size(), 3u);
+    EXPECT_EQ(vector.back(), 2);
+    vector.clear();
+    EXPECT_TRUE(vector.empty());
+  }
+  EXPECT_EQ(allocator.allocations(), 0);
+}
+
+TEST(Grow, SmallVector) {
+  CountingAllocator allocator;
+  {
+    ozz::SmallVector<int, 4> vector(&allocator);
+    for (int i = 0; i < 100; ++i) {
+      vector.push_back(i);
+    }
+    EXPECT_FALSE(vector.is_inline());
+    EXPECT_EQ(vector.size(), 100u);
+    EXPECT_GE(vector.capacity(), 100u);
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_EQ(vector[i], i);
+    }
+    EXPECT_GE(allocator.allocations(), 1);
+
+    // Pushes one of its own elements while growing.
+    ozz::SmallVector<int, 1> self(&allocator);
+    self.push_back(42);
+    self.push_back(self.back());
+    self.push_back(self.front());
+    EXPECT_EQ(self[0], 42);
+    EXPECT_EQ(self[1], 42);
+    EXPECT_EQ(self[2], 42);
+
+    // Clear doesn't release storage.
+    const size_t capacity = vector.capacity();
+    vector.clear();
+    EXPECT_EQ(vector.capacity(), capacity);
+
+    // Reserve.
+    ozz::SmallVector<int, 4> reserved(&allocator);
+    reserved.reserve(2);
+    EXPECT_TRUE(reserved.is_inline());
+    reserved.reserve(16);
+    EXPECT_FALSE(reserved.is_inline());
+    EXPECT_EQ(reserved.capacity(), 16u);
+  }
+  EXPECT_EQ(allocator.allocations(), allocator.deallocations());
+}
+
+TEST(Resize, SmallVector) {
+  ozz::SmallVector<float, 8> zeros(5);
+  ASSERT_EQ(zeros.size(), 5u);
+  for (size_t i = 0; i < zeros.size(); ++i) {
+    EXPECT_EQ(zeros[i], 0.f);
+  }
+
+  ozz::SmallVector<float, 8> vector(20, 46.f);
+  EXPECT_EQ(vector.size(), 20u);
+  EXPECT_FALSE(vector.is_inline());
+  for (size_t i = 0; i < vector.size(); ++i) {
+    EXPECT_EQ(vector[i], 46.f);
+  }
+  vector.resize(2);
+  EXPECT_EQ(vector.size(), 2u);
+  vector.resize(4, 3.f);
+  EXPECT_EQ(vector.size(), 4u);
+  EXPECT_EQ(vector[1], 46.f);
+  EXPECT_EQ(vector[2], 3.f);
+  EXPECT_EQ(vector[3], 3.f);
+}
+
+TEST(Elements, SmallVector) {
+  {
+    ozz::SmallVector<Counted, 2> vector;
+    vector.push_back(Counted(1));
+    vector.push_back(Counted(2));
+    EXPECT_EQ(Counted::instances, 2);
+
+    // Growth moves elements.
+    vector.push_back(Counted(3));
+    EXPECT_EQ(Counted::instances, 3);
+    EXPECT_EQ(vector[0].value, 1);
+    EXPECT_EQ(vector[1].value, 2);
+    EXPECT_EQ(vector[2].value, 3);
+
+    vector.pop_back();
+    EXPECT_EQ(Counted::instances, 2);
+    vector.resize(6);
+    EXPECT_EQ(Counted::instances, 6);
+    vector.resize(1);
+    EXPECT_EQ(Counted::instances, 1);
+  }
+  EXPECT_EQ(Counted::instances, 0);
+}
+
+TEST(Scratch, SmallVector) {
+  CountingAllocator parent;
+  ozz::memory::LinearAllocator arena(1024, &parent);
+
+  for (int i = 0; i < 3; ++i) {
+    const ozz::memory::ScratchScope scratch(&arena);
+    ozz::SmallVector<int, 4> vector(64, 0, scratch.allocator());
+    EXPECT_FALSE(vector.is_inline());
+    EXPECT_GE(arena.used(), 64 * sizeof(int));
+  }
+
+  // Scope rewinds the arena, which never needed more than a block.
+  EXPECT_EQ(arena.used(), 0u);
+  EXPECT_EQ(parent.allocations(), 1);
+}
@@ -101,3 +101,37 @@ TEST(Swap, Endianness) {
     EXPECT_EQ(uo[1], 0x3507086946261458ull);
   }
 }
+
+TEST(BulkSwap, Endianness) {
+  // Covers SIMD and remaining elements paths, with unaligned buffers.
+  ozz::byte buffer[4 * 67 + 1];
+  for (size_t offset = 0; offset < 2; ++offset) {
+    ozz::byte* data = buffer + offset;
+    for (size_t count = 0; count < 67; ++count) {
+      for (size_t i = 0; i < sizeof(buffer); ++i) {
+        buffer[i] = static_cast<ozz::byte>(i * 7);
+      }
+      ozz::EndianSwap16(data, count);
+      for (size_t i = 0; i < count * 2; i += 2) {
+        EXPECT_EQ(data[i + 0], static_cast<ozz::byte>((offset + i + 1) * 7));
+        EXPECT_EQ(data[i + 1], static_cast<ozz::byte>((offset + i + 0) * 7));
+      }
+      // Following bytes aren't modified.
+      EXPECT_EQ(data[count * 2],
+                static_cast<ozz::byte>((offset + count * 2) * 7));
+
+      for (size_t i = 0; i < sizeof(buffer); ++i) {
+        buffer[i] = static_cast<ozz::byte>(i * 7);
+      }
+      ozz::EndianSwap32(data, count);
+      for (size_t i = 0; i < count * 4; i += 4) {
+        EXPECT_EQ(data[i + 0], static_cast<ozz::byte>((offset + i + 3) * 7));
+        EXPECT_EQ(data[i + 1], static_cast<ozz::byte>((offset + i + 2) * 7));
+        EXPECT_EQ(data[i + 2], static_cast<ozz::byte>((offset + i + 1) * 7));
+        EXPECT_EQ(data[i + 3], static_cast<ozz::byte>((offset + i + 0) * 7));
+      }
+      EXPECT_EQ(data[count * 4],
+                static_cast<ozz::byte>((offset + count * 4) * 7));
+    }
+  }
+}
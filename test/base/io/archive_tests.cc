@@ -194,6 +194,49 @@ TEST(PrimitiveArrays, Archive) {
   }
 }
 
+TEST(LargePrimitiveArrays, Archive) {
+  // Arrays bigger than the chunks used to swap arrays when saving.
+  const size_t kCount = 1001;
+  uint16_t ui16o[kCount];
+  uint32_t ui32o[kCount];
+  for (size_t j = 0; j < kCount; ++j) {
+    ui16o[j] = static_cast<uint16_t>(j * 0x0102);
+    ui32o[j] = static_cast<uint32_t>(j * 0x01020304);
+  }
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+
+    ozz::io::MemoryStream stream;
+    ASSERT_TRUE(stream.opened());
+
+    ozz::io::OArchive o(&stream, endianess);
+    o << ozz::io::MakeArray(ui16o);
+    o << ozz::io::MakeArray(ui32o);
+
+    // Checks stored endianness.
+    stream.Seek(1, ozz::io::Stream::kSet);  // Skips endianness tag.
+    uint16_t ui16s[kCount];
+    stream.Read(ui16s, sizeof(ui16s));
+    uint32_t ui32s[kCount];
+    stream.Read(ui32s, sizeof(ui32s));
+    const bool swapped = endianess != ozz::GetNativeEndianness();
+    for (size_t j = 0; j < kCount; ++j) {
+      EXPECT_EQ(swapped ? ozz::EndianSwap(ui16s[j]) : ui16s[j], ui16o[j]);
+      EXPECT_EQ(swapped ? ozz::EndianSwap(ui32s[j]) : ui32s[j], ui32o[j]);
+    }
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    uint16_t ui16i[kCount];
+    i >> ozz::io::MakeArray(ui16i);
+    EXPECT_EQ(std::memcmp(ui16i, ui16o, sizeof(ui16o)), 0);
+    uint32_t ui32i[kCount];
+    i >> ozz::io::MakeArray(ui32i);
+    EXPECT_EQ(std::memcmp(ui32i, ui32o, sizeof(ui32o)), 0);
+  }
+}
+
 TEST(Class, Archive) {
   for (int e = 0; e < 2; ++e) {
     ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
@@ -256,6 +299,35 @@ TEST(ClassArrays, Archive) {
   }
 }
 
+TEST(BulkArrays, Archive) {
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    const bool swap = endianess != ozz::GetNativeEndianness();
+
+    ozz::io::MemoryStream stream;
+    ASSERT_TRUE(stream.opened());
+
+    // Write bulk objects. Extern is only used if endian swap is required.
+    ozz::io::Extern<Plain>::count = 0;
+    ozz::io::OArchive o(&stream, endianess);
+    const Plain ob[] = {{46, {1, 2}}, {58, {3, 4}}, {0xfeed, {0xbeef, 5}}};
+    o << ozz::io::MakeArray(ob);
+    EXPECT_EQ(ozz::io::Extern<Plain>::count, swap ? OZZ_ARRAY_SIZE(ob) : 0u);
+
+    // Archive layout doesn't depend on the path. First byte is the endianness.
+    EXPECT_EQ(stream.Tell(), static_cast<int64_t>(1 + sizeof(ob)));
+
+    // Read bulk objects.
+    ozz::io::Extern<Plain>::count = 0;
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    Plain ib[OZZ_ARRAY_SIZE(ob)];
+    i >> ozz::io::MakeArray(ib);
+    EXPECT_EQ(ozz::io::Extern<Plain>::count, swap ? OZZ_ARRAY_SIZE(ob) : 0u);
+    EXPECT_EQ(std::memcmp(ob, ib, sizeof(ob)), 0);
+  }
+}
+
 TEST(Tag, Archive) {
   ozz::io::MemoryStream stream;
   ASSERT_TRUE(stream.opened());
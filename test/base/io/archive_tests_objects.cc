@@ -51,6 +51,26 @@ void Extern<Extrusive>::Load(IArchive& _archive, Extrusive* _test,
   EXPECT_EQ(_version, 0u);
   _archive >> ozz::io::MakeArray(&_test->i, _count);
 }
+
+size_t Extern<Plain>::count = 0;
+
+void Extern<Plain>::Save(OArchive& _archive, const Plain* _test,
+                         size_t _count) {
+  for (size_t i = 0; i < _count; ++i) {
+    _archive << _test[i].i;
+    _archive << ozz::io::MakeArray(_test[i].j);
+  }
+  count += _count;
+}
+void Extern<Plain>::Load(IArchive& _archive, Plain* _test, size_t _count,
+                         uint32_t _version) {
+  EXPECT_EQ(_version, 0u);
+  for (size_t i = 0; i < _count; ++i) {
+    _archive >> _test[i].i;
+    _archive >> ozz::io::MakeArray(_test[i].j);
+  }
+  count += _count;
+}
 }  // namespace io
 }  // namespace ozz
 
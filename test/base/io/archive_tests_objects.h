@@ -67,6 +67,29 @@ struct Extern<Extrusive> {
 }  // namespace io
 }  // namespace ozz
 
+// Plain type, whose archive layout matches its memory layout, declared bulk.
+struct Plain {
+  uint32_t i;
+  uint16_t j[2];
+};
+
+namespace ozz {
+namespace io {
+OZZ_IO_TYPE_NOT_VERSIONABLE(Plain)
+OZZ_IO_TYPE_BULK(Plain)
+
+// Plain Extern functions are only used when endian swap is required. They count
+// the number of objects they save or load.
+template <>
+struct Extern<Plain> {
+  static void Save(OArchive& _archive, const Plain* _test, size_t _count);
+  static void Load(IArchive& _archive, Plain* _test, size_t _count,
+                   uint32_t _version);
+  static size_t count;
+};
+}  // namespace io
+}  // namespace ozz
+
 class Tagged1 {
  public:
   void Save(ozz::io::OArchive& _archive) const;
@@ -0,0 +1,190 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/asset_registry.h"
+
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+
+// Tagged object to share.
+struct SharedObject {
+  void Save(ozz::io::OArchive& _archive) const { _archive << i; }
+  void Load(ozz::io::IArchive& _archive, uint32_t _version) {
+    EXPECT_EQ(_version, 1u);
+    _archive >> i;
+    ++loads;
+  }
+  int32_t i = 0;
+  static int loads;
+};
+int SharedObject::loads = 0;
+
+namespace ozz {
+namespace io {
+OZZ_IO_TYPE_VERSION(1, SharedObject)
+OZZ_IO_TYPE_TAG("ozz-shared_object", SharedObject)
+}  // namespace io
+}  // namespace ozz
+
+namespace {
+// Saves an SharedObject of value _i to _stream, and rewinds it.
+void SaveObject(ozz::io::MemoryStream* _stream, int32_t _i) {
+  {
+    ozz::io::OArchive archive(_stream);
+    SharedObject object;
+    object.i = _i;
+    archive << object;
+  }
+  _stream->Seek(0, ozz::io::Stream::kSet);
+}
+}  // namespace
+
+TEST(Share, AssetRegistry) {
+  typedef ozz::io::AssetRegistry<SharedObject> Registry;
+  Registry registry;
+  EXPECT_EQ(registry.size(), 0u);
+  SharedObject::loads = 0;
+
+  ozz::io::MemoryStream stream0;
+  SaveObject(&stream0, 46);
+  ozz::io::MemoryStream stream1;
+  SaveObject(&stream1, 46);
+  ozz::io::MemoryStream stream2;
+  SaveObject(&stream2, 93);
+
+  // Identical contents are shared.
+  const Registry::Asset* asset0 = registry.Acquire(&stream0);
+  ASSERT_TRUE(asset0 != nullptr);
+  EXPECT_EQ(asset0->status(), ozz::io::kAsyncSucceeded);
+  EXPECT_EQ(asset0->object().i, 46);
+  const Registry::Asset* asset1 = registry.Acquire(&stream1);
+  EXPECT_EQ(asset1, asset0);
+  EXPECT_EQ(SharedObject::loads, 1);
+  EXPECT_EQ(registry.size(), 1u);
+
+  // Different contents aren't.
+  const Registry::Asset* asset2 = registry.Acquire(&stream2);
+  ASSERT_TRUE(asset2 != nullptr);
+  EXPECT_NE(asset2, asset0);
+  EXPECT_NE(asset2->hash(), asset0->hash());
+  EXPECT_EQ(asset2->object().i, 93);
+  EXPECT_EQ(SharedObject::loads, 2);
+  EXPECT_EQ(registry.size(), 2u);
+
+  // Finds by hash.
+  EXPECT_EQ(registry.Find(asset0->hash()), asset0);
+  EXPECT_EQ(registry.Find(asset0->hash() + 1), nullptr);
+
+  // Assets are destroyed with their last reference.
+  registry.Release(asset0);
+  registry.Release(asset0);
+  EXPECT_EQ(registry.size(), 2u);
+  registry.Release(asset1);
+  EXPECT_EQ(registry.size(), 1u);
+  registry.Release(asset2);
+  EXPECT_EQ(registry.size(), 0u);
+  registry.Release(nullptr);
+
+  // Reloads once released.
+  stream0.Seek(0, ozz::io::Stream::kSet);
+  const Registry::Asset* reloaded = registry.Acquire(&stream0);
+  ASSERT_TRUE(reloaded != nullptr);
+  EXPECT_EQ(reloaded->object().i, 46);
+  EXPECT_EQ(SharedObject::loads, 3);
+  registry.Release(reloaded);
+}
+
+TEST(Failure, AssetRegistry) {
+  typedef ozz::io::AssetRegistry<SharedObject> Registry;
+  Registry registry;
+
+  // Invalid streams.
+  EXPECT_EQ(registry.Acquire(nullptr), nullptr);
+  ozz::io::MemoryStream empty;
+  EXPECT_EQ(registry.Acquire(&empty), nullptr);
+  ozz::io::File not_opened("root_that_does_not_exist:/file.ozz", "rb");
+  EXPECT_EQ(registry.Acquire(&not_opened), nullptr);
+  EXPECT_EQ(registry.size(), 0u);
+
+  // Not a SharedObject.
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive archive(&stream);
+    archive << int32_t(46);
+  }
+  stream.Seek(0, ozz::io::Stream::kSet);
+  const Registry::Asset* asset = registry.Acquire(&stream);
+  ASSERT_TRUE(asset != nullptr);
+  EXPECT_EQ(asset->status(), ozz::io::kAsyncFailed);
+  EXPECT_EQ(registry.size(), 1u);
+  registry.Release(asset);
+  EXPECT_EQ(registry.size(), 0u);
+}
+
+TEST(Threaded, AssetRegistry) {
+  typedef ozz::io::AssetRegistry<SharedObject> Registry;
+  Registry registry;
+  SharedObject::loads = 0;
+
+  // Each thread acquires the same content from its own stream.
+  const int kThreads = 8;
+  ozz::io::MemoryStream streams[kThreads];
+  const Registry::Asset* assets[kThreads];
+  ozz::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    SaveObject(&streams[i], 46);
+    threads.emplace_back([&registry, &streams, &assets, i]() {
+      assets[i] = registry.Acquire(&streams[i]);
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(SharedObject::loads, 1);
+  EXPECT_EQ(registry.size(), 1u);
+  for (int i = 0; i < kThreads; ++i) {
+    ASSERT_EQ(assets[i], assets[0]);
+    EXPECT_EQ(assets[i]->status(), ozz::io::kAsyncSucceeded);
+    EXPECT_EQ(assets[i]->object().i, 46);
+  }
+
+  // Releases concurrently.
+  threads.clear();
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back(
+        [&registry, &assets, i]() { registry.Release(assets[i]); });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(registry.size(), 0u);
+}
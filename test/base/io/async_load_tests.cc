@@ -0,0 +1,205 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/async_load.h"
+
+#include <cstdio>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+
+// Tagged object to load.
+struct AsyncObject {
+  void Save(ozz::io::OArchive& _archive) const { _archive << i; }
+  void Load(ozz::io::IArchive& _archive, uint32_t _version) {
+    EXPECT_EQ(_version, 2u);
+    _archive >> i;
+  }
+  int32_t i = 0;
+};
+
+namespace ozz {
+namespace io {
+OZZ_IO_TYPE_VERSION(2, AsyncObject)
+OZZ_IO_TYPE_TAG("ozz-async_object", AsyncObject)
+}  // namespace io
+}  // namespace ozz
+
+namespace {
+// Saves an AsyncObject of value _i to file _filename.
+void SaveObject(const char* _filename, int32_t _i) {
+  ozz::io::File file(_filename, "wb");
+  ASSERT_TRUE(file.opened());
+  ozz::io::OArchive archive(&file);
+  AsyncObject object;
+  object.i = _i;
+  archive << object;
+}
+
+// Records completion callback calls.
+struct Completions {
+  int count = 0;
+  ozz::io::AsyncStatus status = ozz::io::kAsyncIdle;
+};
+
+void OnComplete(ozz::io::AsyncLoad<AsyncObject>* _load,
+                ozz::io::AsyncStatus _status, void* _user_data) {
+  // Status is published after the callback.
+  EXPECT_EQ(_load->status(), ozz::io::kAsyncPending);
+  Completions* completions = static_cast<Completions*>(_user_data);
+  ++completions->count;
+  completions->status = _status;
+}
+
+// Defers tasks, which are run on demand.
+struct DeferredTask {
+  ozz::io::FileAsyncReader::Task task;
+  void* data;
+};
+
+void DeferredDispatch(ozz::io::FileAsyncReader::Task _task, void* _task_data,
+                      void* _user_data) {
+  const DeferredTask task = {_task, _task_data};
+  static_cast<ozz::vector<DeferredTask>*>(_user_data)->push_back(task);
+}
+
+// Runs tasks on threads.
+void ThreadDispatch(ozz::io::FileAsyncReader::Task _task, void* _task_data,
+                    void* _user_data) {
+  static_cast<ozz::vector<std::thread>*>(_user_data)
+      ->emplace_back(_task, _task_data);
+}
+}  // namespace
+
+TEST(Synchronous, AsyncLoad) {
+  SaveObject("async_object.ozz", 46);
+
+  // Without dispatcher, loading completes immediately.
+  ozz::io::FileAsyncReader reader;
+  ozz::io::AsyncLoad<AsyncObject> load;
+  EXPECT_EQ(load.status(), ozz::io::kAsyncIdle);
+
+  Completions completions;
+  EXPECT_TRUE(load.Start(&reader, "async_object.ozz", &OnComplete,
+                         &completions));
+  EXPECT_EQ(load.status(), ozz::io::kAsyncSucceeded);
+  EXPECT_EQ(completions.count, 1);
+  EXPECT_EQ(completions.status, ozz::io::kAsyncSucceeded);
+  EXPECT_EQ(load.object().i, 46);
+
+  // Callback is optional, and a load can be restarted.
+  SaveObject("async_object.ozz", 58);
+  EXPECT_TRUE(load.Start(&reader, "async_object.ozz"));
+  EXPECT_EQ(load.status(), ozz::io::kAsyncSucceeded);
+  EXPECT_EQ(load.object().i, 58);
+}
+
+TEST(Failure, AsyncLoad) {
+  ozz::io::FileAsyncReader reader;
+  ozz::io::AsyncLoad<AsyncObject> load;
+
+  // Invalid request.
+  EXPECT_FALSE(load.Start(&reader, nullptr));
+  EXPECT_EQ(load.status(), ozz::io::kAsyncIdle);
+
+  // Unexisting file.
+  Completions completions;
+  EXPECT_TRUE(
+      load.Start(&reader, "unexisting.ozz", &OnComplete, &completions));
+  EXPECT_EQ(load.status(), ozz::io::kAsyncFailed);
+  EXPECT_EQ(completions.count, 1);
+  EXPECT_EQ(completions.status, ozz::io::kAsyncFailed);
+
+  // Not an AsyncObject.
+  {
+    ozz::io::File file("async_invalid.ozz", "wb");
+    ASSERT_TRUE(file.opened());
+    ozz::io::OArchive archive(&file);
+    archive << int32_t(46);
+  }
+  EXPECT_TRUE(
+      load.Start(&reader, "async_invalid.ozz", &OnComplete, &completions));
+  EXPECT_EQ(load.status(), ozz::io::kAsyncFailed);
+  EXPECT_EQ(completions.count, 2);
+}
+
+TEST(Deferred, AsyncLoad) {
+  SaveObject("async_object.ozz", 46);
+
+  ozz::vector<DeferredTask> tasks;
+  ozz::io::FileAsyncReader reader(&DeferredDispatch, &tasks);
+  ozz::io::AsyncLoad<AsyncObject> load;
+  Completions completions;
+  EXPECT_TRUE(load.Start(&reader, "async_object.ozz", &OnComplete,
+                         &completions));
+  EXPECT_EQ(load.status(), ozz::io::kAsyncPending);
+  ASSERT_EQ(tasks.size(), 1u);
+  EXPECT_EQ(completions.count, 0);
+
+  // A pending load cannot be restarted.
+  EXPECT_FALSE(load.Start(&reader, "async_object.ozz"));
+  EXPECT_EQ(tasks.size(), 1u);
+
+  tasks[0].task(tasks[0].data);
+  EXPECT_EQ(load.status(), ozz::io::kAsyncSucceeded);
+  EXPECT_EQ(completions.count, 1);
+  EXPECT_EQ(load.object().i, 46);
+}
+
+TEST(Threaded, AsyncLoad) {
+  const int kCount = 8;
+  for (int i = 0; i < kCount; ++i) {
+    char filename[32];
+    std::snprintf(filename, sizeof(filename), "async_object%d.ozz", i);
+    SaveObject(filename, i);
+  }
+
+  ozz::vector<std::thread> threads;
+  ozz::io::FileAsyncReader reader(&ThreadDispatch, &threads, 64);
+  ozz::io::AsyncLoad<AsyncObject> loads[kCount];
+  for (int i = 0; i < kCount; ++i) {
+    char filename[32];
+    std::snprintf(filename, sizeof(filename), "async_object%d.ozz", i);
+    EXPECT_TRUE(loads[i].Start(&reader, filename));
+  }
+
+  // Polls loads status.
+  for (int i = 0; i < kCount; ++i) {
+    while (loads[i].status() == ozz::io::kAsyncPending) {
+      std::this_thread::yield();
+    }
+    EXPECT_EQ(loads[i].status(), ozz::io::kAsyncSucceeded);
+    EXPECT_EQ(loads[i].object().i, i);
+  }
+
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
@@ -0,0 +1,337 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/compressed_stream.h"
+
+#include <stdint.h>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/containers/vector_archive.h"
+#include "ozz/base/gtest_parallel_for_helper.h"
+#include "ozz/base/io/archive.h"
+
+namespace {
+// Builds compressible data: a slowly varying alternating pattern.
+ozz::vector<uint32_t> BuildData(size_t _count) {
+  ozz::vector<uint32_t> data(_count);
+  for (size_t i = 0; i < _count; ++i) {
+    data[i] = static_cast<uint32_t>((i / 16) ^ (i % 2));
+  }
+  return data;
+}
+}  // namespace
+
+TEST(Error, CompressedStream) {
+  ozz::io::MemoryStream wrapped;
+  {  // Empty stream.
+    ozz::io::CompressedStream stream(&wrapped,
+                                     ozz::io::CompressedStream::kRead);
+    EXPECT_FALSE(stream.opened());
+    EXPECT_EQ(stream.Tell(), -1);
+    EXPECT_EQ(stream.Size(), 0u);
+    char c;
+    EXPECT_EQ(stream.Read(&c, 1), 0u);
+  }
+  {  // Not a compressed stream.
+    const char data[64] = {0};
+    wrapped.Write(data, sizeof(data));
+    wrapped.Seek(0, ozz::io::Stream::kSet);
+    EXPECT_FALSE(ozz::io::CompressedStream::Test(&wrapped));
+    EXPECT_EQ(wrapped.Tell(), 0);
+    ozz::io::CompressedStream stream(&wrapped,
+                                     ozz::io::CompressedStream::kRead);
+    EXPECT_FALSE(stream.opened());
+  }
+  {  // Invalid block size.
+    ozz::io::CompressedStream stream(
+        &wrapped, ozz::io::CompressedStream::kWrite, 0);
+    EXPECT_FALSE(stream.opened());
+  }
+}
+
+TEST(ReadWrite, CompressedStream) {
+  const ozz::vector<uint32_t> data = BuildData(100000);
+  const size_t size = data.size() * sizeof(uint32_t);
+  const size_t block_sizes[] = {1, 7, 4096,
+                                ozz::io::CompressedStream::kDefaultBlockSize,
+                                size, size * 2};
+  for (size_t block_size : block_sizes) {
+    ozz::io::MemoryStream wrapped;
+
+    // Prepends some data to test a compressed stream not starting at 0.
+    const char prefix[3] = {1, 2, 3};
+    wrapped.Write(prefix, sizeof(prefix));
+    {
+      ozz::io::CompressedStream stream(
+          &wrapped, ozz::io::CompressedStream::kWrite, block_size);
+      ASSERT_TRUE(stream.opened());
+      EXPECT_EQ(stream.Tell(), 0);
+
+      // Writes with varying sizes, to cross blocks boundaries.
+      size_t written = 0;
+      for (size_t i = 1; written < size; ++i) {
+        const size_t chunk = i * 13 < size - written ? i * 13 : size - written;
+        EXPECT_EQ(stream.Write(reinterpret_cast<const char*>(data.data()) +
+                                   written,
+                               chunk),
+                  chunk);
+        written += chunk;
+      }
+      EXPECT_EQ(stream.Tell(), static_cast<int64_t>(size));
+      EXPECT_EQ(stream.Size(), size);
+
+      // Data are written sequentially.
+      EXPECT_EQ(stream.Seek(0, ozz::io::Stream::kCurrent), 0);
+      EXPECT_EQ(stream.Seek(0, ozz::io::Stream::kEnd), 0);
+      EXPECT_NE(stream.Seek(0, ozz::io::Stream::kSet), 0);
+      char c;
+      EXPECT_EQ(stream.Read(&c, 1), 0u);
+
+      EXPECT_TRUE(stream.Close());
+      EXPECT_FALSE(stream.opened());
+      EXPECT_EQ(stream.Write(&c, 1), 0u);
+    }
+
+    // Wrapped stream is positioned at the end of the compressed stream.
+    EXPECT_EQ(wrapped.Tell(), static_cast<int64_t>(wrapped.Size()));
+    if (block_size >= 4096) {
+      EXPECT_LT(wrapped.Size(), size / 2);
+    }
+
+    // Reads back.
+    EXPECT_EQ(wrapped.Seek(sizeof(prefix), ozz::io::Stream::kSet), 0);
+    EXPECT_TRUE(ozz::io::CompressedStream::Test(&wrapped));
+    ozz::io::CompressedStream stream(&wrapped,
+                                     ozz::io::CompressedStream::kRead);
+    ASSERT_TRUE(stream.opened());
+    EXPECT_EQ(stream.Size(), size);
+    EXPECT_EQ(stream.Tell(), 0);
+    ozz::vector<uint32_t> read(data.size() + 1);
+    EXPECT_EQ(stream.Read(read.data(), size + 4), size);
+    read.pop_back();
+    EXPECT_TRUE(read == data);
+    EXPECT_EQ(stream.Tell(), static_cast<int64_t>(size));
+    EXPECT_EQ(stream.Write(read.data(), 4), 0u);
+
+    // Random access.
+    const size_t indices[] = {46, 99999, 0, 12345, 12346, 50000, 7};
+    for (size_t index : indices) {
+      EXPECT_EQ(stream.Seek(static_cast<int64_t>(index * 4),
+                            ozz::io::Stream::kSet),
+                0);
+      uint32_t value;
+      EXPECT_EQ(stream.Read(&value, sizeof(value)), sizeof(value));
+      EXPECT_EQ(value, data[index]);
+    }
+    EXPECT_EQ(stream.Seek(-8, ozz::io::Stream::kEnd), 0);
+    uint32_t values[2];
+    EXPECT_EQ(stream.Read(values, sizeof(values)), sizeof(values));
+    EXPECT_EQ(values[0], data[data.size() - 2]);
+    EXPECT_EQ(values[1], data[data.size() - 1]);
+    EXPECT_EQ(stream.Seek(-4, ozz::io::Stream::kCurrent), 0);
+    EXPECT_EQ(stream.Tell(), static_cast<int64_t>(size - 4));
+    EXPECT_NE(stream.Seek(-1, ozz::io::Stream::kSet), 0);
+    EXPECT_EQ(stream.Tell(), static_cast<int64_t>(size - 4));
+
+    // Reading beyond the end.
+    EXPECT_EQ(stream.Seek(46, ozz::io::Stream::kEnd), 0);
+    EXPECT_EQ(stream.Read(values, sizeof(values)), 0u);
+  }
+}
+
+TEST(Incompressible, CompressedStream) {
+  // Pseudo random data don't compress, so blocks are stored raw.
+  ozz::vector<uint32_t> data(10000);
+  uint32_t seed = 46;
+  for (size_t i = 0; i < data.size(); ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    data[i] = seed;
+  }
+  const size_t size = data.size() * sizeof(uint32_t);
+
+  ozz::io::MemoryStream wrapped;
+  {
+    ozz::io::CompressedStream stream(
+        &wrapped, ozz::io::CompressedStream::kWrite, 1000);
+    EXPECT_EQ(stream.Write(data.data(), size), size);
+  }
+  // Header and block table are the only overhead.
+  EXPECT_LE(wrapped.Size(), size + 28 + 12 * 40);
+
+  wrapped.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::CompressedStream stream(&wrapped, ozz::io::CompressedStream::kRead);
+  ASSERT_TRUE(stream.opened());
+  ozz::vector<uint32_t> read(data.size());
+  EXPECT_EQ(stream.Read(read.data(), size), size);
+  EXPECT_TRUE(read == data);
+}
+
+TEST(Empty, CompressedStream) {
+  ozz::io::MemoryStream wrapped;
+  {
+    ozz::io::CompressedStream stream(&wrapped,
+                                     ozz::io::CompressedStream::kWrite);
+    EXPECT_TRUE(stream.opened());
+  }
+  wrapped.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::CompressedStream stream(&wrapped, ozz::io::CompressedStream::kRead);
+  ASSERT_TRUE(stream.opened());
+  EXPECT_EQ(stream.Size(), 0u);
+  char c;
+  EXPECT_EQ(stream.Read(&c, 1), 0u);
+}
+
+TEST(Corrupted, CompressedStream) {
+  const ozz::vector<uint32_t> data = BuildData(10000);
+  const size_t size = data.size() * sizeof(uint32_t);
+  ozz::io::MemoryStream wrapped;
+  {
+    ozz::io::CompressedStream stream(
+        &wrapped, ozz::io::CompressedStream::kWrite, 4096);
+    EXPECT_EQ(stream.Write(data.data(), size), size);
+  }
+
+  // Truncated stream can't be opened, as block table is missing.
+  {
+    ozz::io::MemoryStream truncated;
+    ozz::vector<char> buffer(static_cast<size_t>(wrapped.Size()) - 1);
+    wrapped.Seek(0, ozz::io::Stream::kSet);
+    wrapped.Read(buffer.data(), buffer.size());
+    truncated.Write(buffer.data(), buffer.size());
+    truncated.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::CompressedStream stream(&truncated,
+                                     ozz::io::CompressedStream::kRead);
+    EXPECT_FALSE(stream.opened());
+  }
+
+  // Altering compressed data never reads out of bounds. Only the altered block
+  // can fail to decompress.
+  for (int64_t offset = 28; offset < 28 + 64; ++offset) {
+    ozz::io::MemoryStream altered;
+    ozz::vector<char> buffer(static_cast<size_t>(wrapped.Size()));
+    wrapped.Seek(0, ozz::io::Stream::kSet);
+    wrapped.Read(buffer.data(), buffer.size());
+    buffer[static_cast<size_t>(offset)] ^= 0x5a;
+    altered.Write(buffer.data(), buffer.size());
+    altered.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::CompressedStream stream(&altered,
+                                     ozz::io::CompressedStream::kRead);
+    ASSERT_TRUE(stream.opened());
+    ozz::vector<uint32_t> read(data.size());
+    const size_t read_size = stream.Read(read.data(), size);
+    EXPECT_TRUE(read_size == 0 || read_size == size);
+    EXPECT_EQ(stream.Seek(4096, ozz::io::Stream::kSet), 0);
+    EXPECT_EQ(stream.Read(read.data(), 4), 4u);
+    EXPECT_EQ(read[0], data[1024]);
+  }
+}
+
+TEST(Archive, CompressedStream) {
+  const ozz::vector<uint32_t> data = BuildData(10000);
+  for (int e = 0; e < 2; ++e) {
+    const ozz::Endianness endianness =
+        e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::OArchive o(&stream, endianness, true);
+      o << data;
+      o << 46.f;
+    }
+
+    // Compressed archive is smaller.
+    EXPECT_LT(stream.Size(), data.size() * sizeof(uint32_t) / 2);
+    EXPECT_EQ(stream.Tell(), static_cast<int64_t>(stream.Size()));
+
+    // Loads compressed archive transparently.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    EXPECT_EQ(i.endian_swap(), endianness != ozz::GetNativeEndianness());
+    EXPECT_NE(i.stream(), &stream);
+    ozz::vector<uint32_t> read(data.size());
+    i >> read;
+    EXPECT_TRUE(read == data);
+    float f;
+    i >> f;
+    EXPECT_EQ(f, 46.f);
+  }
+}
+
+TEST(ParallelFor, CompressedStream) {
+  const ozz::vector<uint32_t> data = BuildData(100000);
+  const size_t size = data.size() * sizeof(uint32_t);
+  const size_t block_size = 4096;
+
+  ozz::io::MemoryStream wrapped;
+  {
+    ozz::io::CompressedStream stream(
+        &wrapped, ozz::io::CompressedStream::kWrite, block_size);
+    ASSERT_EQ(stream.Write(data.data(), size), size);
+  }
+
+  wrapped.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::CompressedStream stream(&wrapped, ozz::io::CompressedStream::kRead);
+  ASSERT_TRUE(stream.opened());
+  int tasks = 0;
+  stream.set_parallel_for(&ReverseParallelFor, &tasks);
+
+  // Reads a partial block first, then many whole blocks and the last partial
+  // one at once.
+  ozz::vector<uint32_t> read(data.size());
+  const size_t first = 1000;
+  ASSERT_EQ(stream.Read(read.data(), first), first);
+  EXPECT_EQ(tasks, 0);
+  ASSERT_EQ(stream.Read(reinterpret_cast<char*>(read.data()) + first,
+                        size - first),
+            size - first);
+  EXPECT_EQ(tasks, static_cast<int>(size / block_size));
+  EXPECT_EQ(stream.Tell(), static_cast<int64_t>(size));
+  EXPECT_TRUE(read == data);
+
+  // Reads again, from the beginning.
+  ASSERT_EQ(stream.Seek(0, ozz::io::Stream::kSet), 0);
+  ozz::vector<uint32_t> reread(data.size());
+  ASSERT_EQ(stream.Read(reread.data(), size), size);
+  EXPECT_TRUE(reread == data);
+
+  // Corrupted blocks fail.
+  ozz::vector<char> corrupted(static_cast<size_t>(wrapped.Size()));
+  wrapped.Seek(0, ozz::io::Stream::kSet);
+  wrapped.Read(corrupted.data(), corrupted.size());
+  for (size_t i = 64; i < corrupted.size() / 2; i += 7) {
+    corrupted[i] = static_cast<char>(~corrupted[i]);
+  }
+  ozz::io::MemoryStream corrupted_wrapped;
+  corrupted_wrapped.Write(corrupted.data(), corrupted.size());
+  corrupted_wrapped.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::CompressedStream corrupted_stream(&corrupted_wrapped,
+                                             ozz::io::CompressedStream::kRead);
+  ASSERT_TRUE(corrupted_stream.opened());
+  corrupted_stream.set_parallel_for(&ReverseParallelFor, &tasks);
+  EXPECT_LT(corrupted_stream.Read(reread.data(), size), size);
+}
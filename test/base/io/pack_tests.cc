@@ -0,0 +1,217 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/io/pack.h"
+
+#include <cstdio>
+
+#include "gtest/gtest.h"
+#include "ozz/base/containers/string.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+
+#include "archive_tests_objects.h"
+
+namespace {
+struct Packed {
+  void Save(ozz::io::OArchive& _archive) const { _archive << value; }
+  void Load(ozz::io::IArchive& _archive, uint32_t _version) {
+    EXPECT_EQ(_version, 3u);
+    _archive >> value;
+  }
+  int32_t value;
+};
+
+ozz::string Name(int _i) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "packed%d", _i);
+  return name;
+}
+}  // namespace
+
+namespace ozz {
+namespace io {
+OZZ_IO_TYPE_VERSION(3, Packed)
+OZZ_IO_TYPE_TAG("packed", Packed)
+}  // namespace io
+}  // namespace ozz
+
+TEST(Hash, Pack) {
+  // FNV-1a reference values.
+  EXPECT_EQ(ozz::io::PackHash(""), 14695981039346656037ull);
+  EXPECT_EQ(ozz::io::PackHash("a"), 0xaf63dc4c8601ec8cull);
+  EXPECT_EQ(ozz::io::PackHash("foobar"), 0x85944171f73967e8ull);
+  EXPECT_NE(ozz::io::PackType<Tagged1>(), ozz::io::PackType<Tagged2>());
+}
+
+TEST(Error, Pack) {
+  ozz::io::Pack pack;
+  EXPECT_FALSE(pack.opened());
+  EXPECT_EQ(pack.num_entries(), 0);
+  EXPECT_EQ(pack.Find("any"), -1);
+
+  Packed packed;
+  EXPECT_FALSE(pack.Load(0, &packed));
+
+  {  // No stream.
+    EXPECT_FALSE(pack.Open(nullptr));
+  }
+
+  {  // Not a pack.
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream);
+    o << Tagged1();
+    stream.Seek(0, ozz::io::Stream::kSet);
+    EXPECT_FALSE(pack.Open(&stream));
+  }
+
+  {  // Not finalized.
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::PackWriter writer(&stream);
+      stream.Seek(0, ozz::io::Stream::kSet);
+      EXPECT_FALSE(pack.Open(&stream));
+      stream.Seek(0, ozz::io::Stream::kEnd);
+    }
+    stream.Seek(0, ozz::io::Stream::kSet);
+    EXPECT_TRUE(pack.Open(&stream));
+    EXPECT_EQ(pack.num_entries(), 0);
+  }
+
+  {  // Corrupted entries count.
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::PackWriter writer(&stream);
+      EXPECT_TRUE(writer.Add("a", Tagged1()));
+      EXPECT_TRUE(writer.Finalize());
+    }
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ASSERT_TRUE(pack.Open(&stream));
+    const int64_t toc_offset =
+        pack.entry(0).offset + static_cast<int64_t>(pack.entry(0).size);
+    pack.Close();
+
+    // Table of contents begins with entries count.
+    const uint32_t count = 0xffffffff;
+    stream.Seek(toc_offset, ozz::io::Stream::kSet);
+    stream.Write(&count, sizeof(count));
+    stream.Seek(0, ozz::io::Stream::kSet);
+    EXPECT_FALSE(pack.Open(&stream));
+    EXPECT_EQ(pack.num_entries(), 0);
+
+    // Restores a valid count.
+    const uint32_t valid_count = 1;
+    stream.Seek(toc_offset, ozz::io::Stream::kSet);
+    stream.Write(&valid_count, sizeof(valid_count));
+    stream.Seek(0, ozz::io::Stream::kSet);
+    EXPECT_TRUE(pack.Open(&stream));
+    pack.Close();
+  }
+
+  {  // Writer errors.
+    ozz::io::MemoryStream stream;
+    ozz::io::PackWriter writer(&stream);
+    EXPECT_TRUE(writer.Add("a", Tagged1()));
+    EXPECT_FALSE(writer.Add("a", Tagged2()));
+    EXPECT_TRUE(writer.Finalize());
+    EXPECT_FALSE(writer.Finalize());
+    EXPECT_FALSE(writer.Add("b", Tagged1()));
+  }
+}
+
+TEST(Pack, Pack) {
+  const int kCount = 100;
+  for (int e = 0; e < 2; ++e) {
+    const ozz::Endianness endianess =
+        e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::PackWriter writer(&stream, endianess);
+      for (int i = 0; i < kCount; ++i) {
+        const Packed packed = {i * 3};
+        EXPECT_TRUE(writer.Add(Name(i).c_str(), packed));
+      }
+      EXPECT_TRUE(writer.Add("tagged1", Tagged1()));
+      EXPECT_TRUE(writer.Finalize());
+    }
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::Pack pack;
+    ASSERT_TRUE(pack.Open(&stream));
+    EXPECT_TRUE(pack.opened());
+    ASSERT_EQ(pack.num_entries(), kCount + 1);
+
+    // Entries are sorted by offset.
+    for (int i = 1; i < pack.num_entries(); ++i) {
+      EXPECT_EQ(pack.entry(i).offset,
+                pack.entry(i - 1).offset +
+                    static_cast<int64_t>(pack.entry(i - 1).size));
+    }
+
+    // Finds and loads in any order.
+    for (int i = kCount - 1; i >= 0; --i) {
+      const ozz::string name = Name(i);
+      const int index = pack.Find(name.c_str());
+      ASSERT_EQ(index, i);
+      EXPECT_STREQ(pack.entry(index).name.c_str(), name.c_str());
+      EXPECT_EQ(pack.entry(index).type, ozz::io::PackType<Packed>());
+
+      Packed packed = {-1};
+      EXPECT_TRUE(pack.Load(name.c_str(), &packed));
+      EXPECT_EQ(packed.value, i * 3);
+    }
+    EXPECT_EQ(pack.Find("packed"), -1);
+    EXPECT_EQ(pack.Find("tagged1"), kCount);
+
+    // Type mismatch.
+    Packed packed = {-1};
+    EXPECT_FALSE(pack.Load("tagged1", &packed));
+    EXPECT_EQ(packed.value, -1);
+    Tagged2 tagged2;
+    EXPECT_FALSE(pack.Load("tagged1", &tagged2));
+    Tagged1 tagged1;
+    EXPECT_TRUE(pack.Load("tagged1", &tagged1));
+
+    // Unknown entry.
+    EXPECT_FALSE(pack.Load("unknown", &packed));
+
+    // Loads from another stream.
+    ozz::io::MemoryStream other;
+    {
+      stream.Seek(0, ozz::io::Stream::kSet);
+      ozz::vector<char> buffer(static_cast<size_t>(stream.Size()));
+      stream.Read(buffer.data(), buffer.size());
+      other.Write(buffer.data(), buffer.size());
+    }
+    EXPECT_TRUE(pack.Load("packed46", &packed, &other));
+    EXPECT_EQ(packed.value, 46 * 3);
+
+    pack.Close();
+    EXPECT_FALSE(pack.opened());
+    EXPECT_EQ(pack.num_entries(), 0);
+  }
+}
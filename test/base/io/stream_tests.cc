@@ -28,6 +28,7 @@
 #include "ozz/base/io/stream.h"
 
 #include <stdint.h>
+#include <cstddef>
 #include <limits>
 
 #include "gtest/gtest.h"
@@ -135,7 +136,7 @@ void TestSeek(ozz::io::Stream* _stream) {
 }
 
 void TestTooBigStream(ozz::io::Stream* _stream) {
-  const int max_size = std::numeric_limits<int>::max();
+  const int64_t max_size = std::numeric_limits<ptrdiff_t>::max();
   ASSERT_TRUE(_stream->opened());
   EXPECT_EQ(_stream->Seek(0, ozz::io::Stream::kSet), 0);
   EXPECT_EQ(_stream->Tell(), 0);
@@ -152,11 +153,31 @@ void TestTooBigStream(ozz::io::Stream* _stream) {
   EXPECT_EQ(_stream->Seek(1, ozz::io::Stream::kSet), 0);
   EXPECT_EQ(_stream->Tell(), 1);
   char c;
-  EXPECT_EQ(_stream->Write(&c, max_size), 0u);
-  EXPECT_EQ(_stream->Read(&c, max_size), 0u);
+  EXPECT_EQ(_stream->Write(&c, static_cast<size_t>(max_size)), 0u);
+  EXPECT_EQ(_stream->Read(&c, static_cast<size_t>(max_size)), 0u);
   EXPECT_EQ(_stream->Size(), 0u);
 }
 
+void TestLargeOffsets(ozz::io::Stream* _stream) {
+  ASSERT_TRUE(_stream->opened());
+
+  // Seeks beyond 32 bits range, without writing.
+  const int64_t kFar = (int64_t(1) << 32) + 46;
+  EXPECT_EQ(_stream->Seek(kFar, ozz::io::Stream::kSet), 0);
+  EXPECT_EQ(_stream->Tell(), kFar);
+  EXPECT_EQ(_stream->Seek(kFar, ozz::io::Stream::kCurrent), 0);
+  EXPECT_EQ(_stream->Tell(), kFar * 2);
+  EXPECT_EQ(_stream->Seek(-kFar, ozz::io::Stream::kCurrent), 0);
+  EXPECT_EQ(_stream->Tell(), kFar);
+  EXPECT_EQ(_stream->Seek(-kFar, ozz::io::Stream::kCurrent), 0);
+  EXPECT_EQ(_stream->Tell(), 0);
+
+  char c;
+  EXPECT_EQ(_stream->Seek(kFar, ozz::io::Stream::kSet), 0);
+  EXPECT_EQ(_stream->Read(&c, 1), 0u);
+  EXPECT_EQ(_stream->Tell(), kFar);
+}
+
 TEST(File, Stream) {
   {
     ozz::io::File file(nullptr);
@@ -168,6 +189,11 @@ TEST(File, Stream) {
     EXPECT_TRUE(file.opened());
     TestSeek(&file);
   }
+  {
+    ozz::io::File file("test.bin", "w+b");
+    EXPECT_TRUE(file.opened());
+    TestLargeOffsets(&file);
+  }
   { EXPECT_TRUE(ozz::io::File::Exist("test.bin")); }
 }
 
@@ -184,4 +210,189 @@ TEST(MemoryStream, Stream) {
     ozz::io::MemoryStream stream;
     TestTooBigStream(&stream);
   }
+  {
+    ozz::io::MemoryStream stream;
+    TestLargeOffsets(&stream);
+  }
+}
+
+// Counts reads reaching a MemoryStream.
+class CountingStream : public ozz::io::MemoryStream {
+ public:
+  CountingStream() : reads(0) {}
+  virtual size_t Read(void* _buffer, size_t _size) {
+    ++reads;
+    return MemoryStream::Read(_buffer, _size);
+  }
+  int reads;
+};
+
+TEST(BufferedStream, Stream) {
+  // Buffered streams must behave as the stream they wrap, whatever the buffer
+  // size.
+  const size_t sizes[] = {0, 1, 3, ozz::io::BufferedStream::kDefaultBufferSize};
+  for (size_t size : sizes) {
+    {
+      ozz::io::MemoryStream wrapped;
+      ozz::io::BufferedStream stream(&wrapped, size);
+      TestStream(&stream);
+    }
+    {
+      ozz::io::MemoryStream wrapped;
+      ozz::io::BufferedStream stream(&wrapped, size);
+      TestSeek(&stream);
+    }
+    {
+      ozz::io::MemoryStream wrapped;
+      ozz::io::BufferedStream stream(&wrapped, size);
+      TestTooBigStream(&stream);
+    }
+    {
+      ozz::io::MemoryStream wrapped;
+      ozz::io::BufferedStream stream(&wrapped, size);
+      TestLargeOffsets(&stream);
+    }
+  }
+
+  // Writes values to read back.
+  const int kCount = 1000;
+  CountingStream wrapped;
+  for (int i = 0; i < kCount; ++i) {
+    EXPECT_EQ(wrapped.Write(&i, sizeof(i)), sizeof(i));
+  }
+  EXPECT_EQ(wrapped.Seek(0, ozz::io::Stream::kSet), 0);
+
+  {
+    ozz::io::BufferedStream stream(&wrapped, 64);
+    EXPECT_TRUE(stream.opened());
+    EXPECT_EQ(stream.Size(), kCount * sizeof(int));
+
+    // Small reads are buffered.
+    for (int i = 0; i < kCount / 2; ++i) {
+      int value = -1;
+      EXPECT_EQ(stream.Read(&value, sizeof(value)), sizeof(value));
+      EXPECT_EQ(value, i);
+      EXPECT_EQ(stream.Tell(), static_cast<int64_t>((i + 1) * sizeof(int)));
+    }
+    EXPECT_EQ(wrapped.reads, (kCount / 2 * 4 + 63) / 64);
+
+    // Seeks within and outside of buffered data.
+    int value = -1;
+    EXPECT_EQ(stream.Seek(-4, ozz::io::Stream::kCurrent), 0);
+    EXPECT_EQ(stream.Read(&value, sizeof(value)), sizeof(value));
+    EXPECT_EQ(value, kCount / 2 - 1);
+    EXPECT_EQ(stream.Seek(8, ozz::io::Stream::kSet), 0);
+    EXPECT_EQ(stream.Read(&value, sizeof(value)), sizeof(value));
+    EXPECT_EQ(value, 2);
+    EXPECT_EQ(stream.Seek(-8, ozz::io::Stream::kEnd), 0);
+    EXPECT_EQ(stream.Read(&value, sizeof(value)), sizeof(value));
+    EXPECT_EQ(value, kCount - 2);
+
+    // Big reads are direct.
+    int values[100];
+    EXPECT_EQ(stream.Seek(40, ozz::io::Stream::kSet), 0);
+    const int reads = wrapped.reads;
+    EXPECT_EQ(stream.Read(values, sizeof(values)), sizeof(values));
+    EXPECT_EQ(wrapped.reads, reads + 1);
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_EQ(values[i], i + 10);
+    }
+
+    // Writes at the current position.
+    EXPECT_EQ(stream.Read(&value, sizeof(value)), sizeof(value));
+    EXPECT_EQ(value, 110);
+    const int to_write = -46;
+    EXPECT_EQ(stream.Write(&to_write, sizeof(to_write)), sizeof(to_write));
+    EXPECT_EQ(stream.Tell(), 112 * 4);
+    EXPECT_EQ(stream.Seek(-4, ozz::io::Stream::kCurrent), 0);
+    EXPECT_EQ(stream.Read(&value, sizeof(value)), sizeof(value));
+    EXPECT_EQ(value, to_write);
+
+    // Leaves buffered data unread.
+    EXPECT_EQ(stream.Read(&value, sizeof(value)), sizeof(value));
+    EXPECT_EQ(value, 112);
+  }
+
+  // Wrapped stream is restored to buffered stream position.
+  EXPECT_EQ(wrapped.Tell(), 113 * 4);
+}
+
+TEST(MappedFile, Stream) {
+  {  // Unexisting file.
+    ozz::io::MappedFile file("unexisting.file");
+    EXPECT_FALSE(file.opened());
+    EXPECT_EQ(file.data(), nullptr);
+    EXPECT_EQ(file.Size(), 0u);
+  }
+
+  {  // Empty file.
+    { ozz::io::File file("empty.bin", "wb"); }
+    ozz::io::MappedFile file("empty.bin");
+    EXPECT_TRUE(file.opened());
+    EXPECT_EQ(file.data(), nullptr);
+    EXPECT_EQ(file.Size(), 0u);
+    int to_read = 0;
+    EXPECT_EQ(file.Read(&to_read, sizeof(to_read)), 0u);
+  }
+
+  // Writes a file to map.
+  const int kCount = 1000;
+  {
+    ozz::io::File file("mapped.bin", "wb");
+    ASSERT_TRUE(file.opened());
+    for (int i = 0; i < kCount; ++i) {
+      ASSERT_EQ(file.Write(&i, sizeof(i)), sizeof(i));
+    }
+  }
+
+  ozz::io::MappedFile file("mapped.bin");
+  ASSERT_TRUE(file.opened());
+  ASSERT_EQ(file.Size(), kCount * sizeof(int));
+  ASSERT_TRUE(file.data() != nullptr);
+  EXPECT_TRUE(ozz::IsAligned(file.data(), 16));
+  EXPECT_EQ(file.Tell(), 0);
+
+  // Direct access.
+  const int* values = reinterpret_cast<const int*>(file.data());
+  for (int i = 0; i < kCount; ++i) {
+    EXPECT_EQ(values[i], i);
+  }
+
+  // Reads.
+  int to_read = -1;
+  EXPECT_EQ(file.Read(&to_read, sizeof(to_read)), sizeof(to_read));
+  EXPECT_EQ(to_read, 0);
+  EXPECT_EQ(file.Tell(), static_cast<int>(sizeof(int)));
+
+  // Writing isn't allowed.
+  EXPECT_EQ(file.Write(&to_read, sizeof(to_read)), 0u);
+  EXPECT_EQ(file.Tell(), static_cast<int>(sizeof(int)));
+
+  // Seeks.
+  EXPECT_EQ(file.Seek(10 * sizeof(int), ozz::io::Stream::kSet), 0);
+  EXPECT_EQ(file.Read(&to_read, sizeof(to_read)), sizeof(to_read));
+  EXPECT_EQ(to_read, 10);
+  EXPECT_EQ(file.Seek(sizeof(int), ozz::io::Stream::kCurrent), 0);
+  EXPECT_EQ(file.Read(&to_read, sizeof(to_read)), sizeof(to_read));
+  EXPECT_EQ(to_read, 12);
+  EXPECT_EQ(file.Seek(-static_cast<int>(sizeof(int)), ozz::io::Stream::kEnd),
+            0);
+  EXPECT_EQ(file.Read(&to_read, sizeof(to_read)), sizeof(to_read));
+  EXPECT_EQ(to_read, kCount - 1);
+  EXPECT_NE(file.Seek(-1, ozz::io::Stream::kSet), 0);
+  EXPECT_EQ(file.Seek(46, ozz::io::Stream::Origin(27)), -1);
+  EXPECT_EQ(file.Tell(), static_cast<int>(kCount * sizeof(int)));
+
+  // Reads at and beyond the end.
+  EXPECT_EQ(file.Read(&to_read, sizeof(to_read)), 0u);
+  EXPECT_EQ(file.Seek(-2, ozz::io::Stream::kEnd), 0);
+  EXPECT_EQ(file.Read(&to_read, sizeof(to_read)), 2u);
+  EXPECT_EQ(file.Seek(4, ozz::io::Stream::kEnd), 0);
+  EXPECT_EQ(file.Read(&to_read, sizeof(to_read)), 0u);
+  EXPECT_EQ(file.Size(), kCount * sizeof(int));
+  TestLargeOffsets(&file);
+
+  file.Close();
+  EXPECT_FALSE(file.opened());
+  EXPECT_EQ(file.data(), nullptr);
 }
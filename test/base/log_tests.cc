@@ -27,6 +27,10 @@
 
 #include "ozz/base/log.h"
 
+#include <sstream>
+#include <string>
+#include <thread>
+
 #include "gtest/gtest.h"
 #include "ozz/base/gtest_helper.h"
 
@@ -67,3 +71,142 @@ TEST(FloatPrecision, Log) {
   }
   EXPECT_LOG_LOG(log << number << '-' << std::endl, "47-");
 }
+
+TEST(MaxLevel, Log) {
+  const ozz::log::Level level = ozz::log::SetLevel(ozz::log::kVerbose);
+  EXPECT_EQ(ozz::log::GetLevel(), OZZ_LOG_MAX_LEVEL);
+  ozz::log::SetLevel(level);
+}
+
+// Asynchronous logs are pushed when the logger is destroyed, so the logger
+// must be out of scope before flushing.
+template <typename _Logger>
+int TestAsyncFunction(const char* _log) {
+  TestFunction(_Logger(), _log);
+  ozz::log::Flush();
+  return 46;
+}
+
+void TestAsyncLogLevel(ozz::log::Level _level) {
+  ozz::log::SetLevel(_level);
+
+  EXPECT_LOG_LOGV(TestAsyncFunction<ozz::log::LogV>("logv"), "logv");
+  EXPECT_LOG_LOG(TestAsyncFunction<ozz::log::Log>("log"), "log");
+  EXPECT_LOG_OUT(TestAsyncFunction<ozz::log::Out>("out"), "out");
+  EXPECT_LOG_ERR(TestAsyncFunction<ozz::log::Err>("err"), "err");
+}
+
+void TestAsyncFloatPrecision() {
+  {
+    ozz::log::Log log;
+    ozz::log::FloatPrecision mod(log, 2);
+    log << 46.9352099f << '-' << std::endl;
+  }
+  ozz::log::Flush();
+}
+
+void TestAsyncNested() {
+  ozz::log::Log() << "outer " << TestFunction(ozz::log::Log(), "inner")
+                  << std::endl;
+  ozz::log::Flush();
+}
+
+void TestAsyncLong(const std::string& _log) {
+  ozz::log::Log() << '<' << _log << '>';
+  ozz::log::Flush();
+}
+
+TEST(Async, Log) {
+  EXPECT_FALSE(ozz::log::IsAsync());
+  EXPECT_FALSE(ozz::log::EnableAsync(0));
+  EXPECT_TRUE(ozz::log::EnableAsync());
+  EXPECT_TRUE(ozz::log::IsAsync());
+  EXPECT_FALSE(ozz::log::EnableAsync());
+
+  TestAsyncLogLevel(ozz::log::kSilent);
+  TestAsyncLogLevel(ozz::log::kStandard);
+  TestAsyncLogLevel(ozz::log::kVerbose);
+
+  // Float precision applies to buffered logs.
+  EXPECT_LOG_LOG(TestAsyncFloatPrecision(), "46.94-");
+
+  // Nested logs use their own buffer.
+  EXPECT_LOG_LOG(TestAsyncNested(), "outer 46");
+  EXPECT_LOG_LOG(TestAsyncNested(), "inner");
+
+  // Longer messages than a ring buffer slot.
+  const std::string long_message(1000, 'o');
+  const std::string expected_long = "<" + long_message + ">";
+  EXPECT_LOG_LOG(TestAsyncLong(long_message), expected_long.c_str());
+
+  ozz::log::SetLevel(ozz::log::kStandard);
+  ozz::log::DisableAsync();
+  EXPECT_FALSE(ozz::log::IsAsync());
+  EXPECT_EQ(ozz::log::Dropped(), 0u);
+
+  // Logs synchronously again.
+  EXPECT_LOG_LOG(TestFunction(ozz::log::Log(), "sync"), "sync");
+}
+
+TEST(AsyncThreads, Log) {
+  std::ostringstream output;
+  std::streambuf* clog = std::clog.rdbuf(output.rdbuf());
+
+  // Large enough for all messages.
+  const int kThreads = 4;
+  const int kLogs = 1000;
+  ASSERT_TRUE(ozz::log::EnableAsync(kThreads * kLogs));
+
+  std::thread threads[kThreads];
+  for (int i = 0; i < kThreads; ++i) {
+    threads[i] = std::thread([i] {
+      for (int j = 0; j < kLogs; ++j) {
+        ozz::log::Log() << i << ':' << j << std::endl;
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  ozz::log::Flush();
+  EXPECT_EQ(ozz::log::Dropped(), 0u);
+  ozz::log::DisableAsync();
+  std::clog.rdbuf(clog);
+
+  // Every message is output, and each thread messages are ordered.
+  int next[kThreads] = {0};
+  std::istringstream lines(output.str());
+  for (std::string line; std::getline(lines, line);) {
+    const size_t colon = line.find(':');
+    ASSERT_NE(colon, std::string::npos);
+    const int i = std::stoi(line.substr(0, colon));
+    ASSERT_TRUE(i >= 0 && i < kThreads);
+    EXPECT_EQ(std::stoi(line.substr(colon + 1)), next[i]++);
+  }
+  for (int i = 0; i < kThreads; ++i) {
+    EXPECT_EQ(next[i], kLogs);
+  }
+}
+
+TEST(AsyncDropped, Log) {
+  std::ostringstream output;
+  std::streambuf* clog = std::clog.rdbuf(output.rdbuf());
+
+  // Messages that don't fit are dropped rather than waiting.
+  const int kLogs = 1000;
+  ASSERT_TRUE(ozz::log::EnableAsync(1));
+  for (int j = 0; j < kLogs; ++j) {
+    ozz::log::Log() << j << std::endl;
+  }
+  ozz::log::Flush();
+  const size_t dropped = ozz::log::Dropped();
+  ozz::log::DisableAsync();
+  std::clog.rdbuf(clog);
+
+  size_t written = 0;
+  std::istringstream lines(output.str());
+  for (std::string line; std::getline(lines, line);) {
+    ++written;
+  }
+  EXPECT_EQ(written + dropped, static_cast<size_t>(kLogs));
+}
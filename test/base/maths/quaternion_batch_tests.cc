@@ -0,0 +1,286 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/maths/quaternion_batch.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/quaternion.h"
+#include "ozz/base/maths/vec_float.h"
+
+using ozz::math::Float3;
+using ozz::math::Quaternion;
+using ozz::math::SimdFloat4;
+using ozz::math::SimdQuaternion;
+using ozz::math::SoaFloat3;
+using ozz::math::SoaQuaternion;
+
+namespace {
+const size_t kCount = 11;  // Not a multiple of 4.
+const size_t kSoaCount = (kCount + 3) / 4;
+
+// Builds a set of normalized quaternions, some of them in opposite
+// hemispheres.
+Quaternion BuildQuaternion(size_t _i, float _offset) {
+  const Float3 axis =
+      Normalize(Float3(1.f + _i, -2.f + _offset, .5f * _i - 1.f));
+  const Quaternion q = Quaternion::FromAxisAngle(axis, .3f * _i + _offset);
+  return _i % 3 == 0 ? -q : q;
+}
+
+Float3 BuildVector(size_t _i) { return Float3(_i * .5f, -1.f, 2.f - _i); }
+
+SimdQuaternion ToSimd(const Quaternion& _q) {
+  const SimdQuaternion q = {ozz::math::simd_float4::LoadPtrU(&_q.x)};
+  return q;
+}
+
+Quaternion FromSimd(const SimdQuaternion& _q) {
+  float f[4];
+  ozz::math::StorePtrU(_q.xyzw, f);
+  return Quaternion(f[0], f[1], f[2], f[3]);
+}
+
+Float3 FromSimd(SimdFloat4 _v) {
+  float f[4];
+  ozz::math::StorePtrU(_v, f);
+  return Float3(f[0], f[1], f[2]);
+}
+
+// Packs _aos quaternions to SoA.
+void ToSoa(const Quaternion* _aos, SoaQuaternion* _soa) {
+  for (size_t i = 0; i < kSoaCount; ++i) {
+    float c[4][4];
+    for (size_t j = 0; j < 4; ++j) {
+      const size_t k = i * 4 + j;
+      const Quaternion q = k < kCount ? _aos[k] : Quaternion::identity();
+      c[0][j] = q.x;
+      c[1][j] = q.y;
+      c[2][j] = q.z;
+      c[3][j] = q.w;
+    }
+    const SoaQuaternion soa = {ozz::math::simd_float4::LoadPtrU(c[0]),
+                               ozz::math::simd_float4::LoadPtrU(c[1]),
+                               ozz::math::simd_float4::LoadPtrU(c[2]),
+                               ozz::math::simd_float4::LoadPtrU(c[3])};
+    _soa[i] = soa;
+  }
+}
+
+Quaternion FromSoa(const SoaQuaternion* _soa, size_t _k) {
+  float c[4][4];
+  const SoaQuaternion& soa = _soa[_k / 4];
+  ozz::math::StorePtrU(soa.x, c[0]);
+  ozz::math::StorePtrU(soa.y, c[1]);
+  ozz::math::StorePtrU(soa.z, c[2]);
+  ozz::math::StorePtrU(soa.w, c[3]);
+  const size_t j = _k % 4;
+  return Quaternion(c[0][j], c[1][j], c[2][j], c[3][j]);
+}
+
+void ExpectNear(const Quaternion& _a, const Quaternion& _b, float _tol) {
+  EXPECT_NEAR(_a.x, _b.x, _tol);
+  EXPECT_NEAR(_a.y, _b.y, _tol);
+  EXPECT_NEAR(_a.z, _b.z, _tol);
+  EXPECT_NEAR(_a.w, _b.w, _tol);
+}
+
+void ExpectNear(const Float3& _a, const Float3& _b, float _tol) {
+  EXPECT_NEAR(_a.x, _b.x, _tol);
+  EXPECT_NEAR(_a.y, _b.y, _tol);
+  EXPECT_NEAR(_a.z, _b.z, _tol);
+}
+
+// Batch quaternion functions test fixture, filling AoS and SoA inputs.
+struct Inputs {
+  Inputs() {
+    for (size_t i = 0; i < kCount; ++i) {
+      a[i] = BuildQuaternion(i, 0.f);
+      b[i] = BuildQuaternion(i * 7 % kCount, .7f);
+      simd_a[i] = ToSimd(a[i]);
+      simd_b[i] = ToSimd(b[i]);
+      v[i] = BuildVector(i);
+      simd_v[i] = ozz::math::simd_float4::Load3PtrU(&v[i].x);
+    }
+    ToSoa(a, soa_a);
+    ToSoa(b, soa_b);
+    for (size_t i = 0; i < kSoaCount; ++i) {
+      const SoaFloat3 soa = {
+          ozz::math::simd_float4::Load(
+              BuildVector(i * 4).x, BuildVector(i * 4 + 1).x,
+              BuildVector(i * 4 + 2).x, BuildVector(i * 4 + 3).x),
+          ozz::math::simd_float4::Load(
+              BuildVector(i * 4).y, BuildVector(i * 4 + 1).y,
+              BuildVector(i * 4 + 2).y, BuildVector(i * 4 + 3).y),
+          ozz::math::simd_float4::Load(
+              BuildVector(i * 4).z, BuildVector(i * 4 + 1).z,
+              BuildVector(i * 4 + 2).z, BuildVector(i * 4 + 3).z)};
+      soa_v[i] = soa;
+    }
+  }
+  Quaternion a[kCount];
+  Quaternion b[kCount];
+  Float3 v[kCount];
+  SimdQuaternion simd_a[kCount];
+  SimdQuaternion simd_b[kCount];
+  SimdFloat4 simd_v[kCount];
+  SoaQuaternion soa_a[kSoaCount];
+  SoaQuaternion soa_b[kSoaCount];
+  SoaFloat3 soa_v[kSoaCount];
+};
+}  // namespace
+
+TEST(Validate, QuaternionBatch) {
+  const Inputs in;
+  SimdQuaternion simd_out[kCount];
+  SoaQuaternion soa_out[kSoaCount];
+
+  // Output too small.
+  EXPECT_FALSE(ozz::math::Normalize(ozz::make_span(in.simd_a),
+                                    {simd_out, kCount - 1}));
+  EXPECT_FALSE(ozz::math::Normalize(ozz::make_span(in.soa_a),
+                                    {soa_out, kSoaCount - 1}));
+  EXPECT_FALSE(ozz::math::SLerp(ozz::make_span(in.simd_a),
+                                ozz::make_span(in.simd_b), .5f,
+                                {simd_out, kCount - 1}));
+
+  // Smallest input defines the count.
+  EXPECT_TRUE(ozz::math::Multiply(ozz::make_span(in.simd_a),
+                                  {in.simd_b, kCount - 1},
+                                  {simd_out, kCount - 1}));
+  EXPECT_TRUE(ozz::math::NLerp({in.soa_a, 1}, ozz::make_span(in.soa_b), .5f,
+                               {soa_out, 1}));
+
+  // Empty spans.
+  EXPECT_TRUE(ozz::math::Normalize(ozz::span<const SimdQuaternion>(),
+                                   ozz::span<SimdQuaternion>()));
+}
+
+TEST(Normalize, QuaternionBatch) {
+  const Inputs in;
+  SimdQuaternion simd_in[kCount];
+  SoaQuaternion soa_in[kSoaCount];
+  for (size_t i = 0; i < kCount; ++i) {
+    simd_in[i] = ToSimd(in.a[i] * 3.f);
+  }
+  for (size_t i = 0; i < kSoaCount; ++i) {
+    soa_in[i] = in.soa_a[i] * ozz::math::simd_float4::Load1(.1f);
+  }
+
+  // In place.
+  ASSERT_TRUE(ozz::math::Normalize(ozz::make_span(simd_in),
+                                   ozz::make_span(simd_in)));
+  ASSERT_TRUE(
+      ozz::math::Normalize(ozz::make_span(soa_in), ozz::make_span(soa_in)));
+
+  for (size_t i = 0; i < kCount; ++i) {
+    ExpectNear(FromSimd(simd_in[i]), in.a[i], 1e-6f);
+    ExpectNear(FromSoa(soa_in, i), in.a[i], 1e-6f);
+  }
+}
+
+TEST(NLerp, QuaternionBatch) {
+  const Inputs in;
+  SimdQuaternion simd_out[kCount];
+  SoaQuaternion soa_out[kSoaCount];
+  const float alphas[] = {0.f, .3f, 1.f};
+  for (float alpha : alphas) {
+    ASSERT_TRUE(ozz::math::NLerp(ozz::make_span(in.simd_a),
+                                 ozz::make_span(in.simd_b), alpha,
+                                 ozz::make_span(simd_out)));
+    ASSERT_TRUE(ozz::math::NLerp(ozz::make_span(in.soa_a),
+                                 ozz::make_span(in.soa_b), alpha,
+                                 ozz::make_span(soa_out)));
+    for (size_t i = 0; i < kCount; ++i) {
+      const Quaternion expected = NLerp(in.a[i], in.b[i], alpha);
+      ExpectNear(FromSimd(simd_out[i]), expected, 1e-6f);
+      ExpectNear(FromSoa(soa_out, i), expected, 1e-6f);
+    }
+  }
+}
+
+TEST(SLerp, QuaternionBatch) {
+  const Inputs in;
+  SimdQuaternion simd_out[kCount];
+  SoaQuaternion soa_out[kSoaCount];
+  const float alphas[] = {0.f, .1f, .5f, .8f, 1.f};
+  for (float alpha : alphas) {
+    ASSERT_TRUE(ozz::math::SLerp(ozz::make_span(in.simd_a),
+                                 ozz::make_span(in.simd_b), alpha,
+                                 ozz::make_span(simd_out)));
+    ASSERT_TRUE(ozz::math::SLerp(ozz::make_span(in.soa_a),
+                                 ozz::make_span(in.soa_b), alpha,
+                                 ozz::make_span(soa_out)));
+    for (size_t i = 0; i < kCount; ++i) {
+      // Reference takes the shortest path.
+      const Quaternion& a = in.a[i];
+      const Quaternion& b = in.b[i];
+      const float dot = a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+      const Quaternion expected = SLerp(a, dot < 0.f ? -b : b, alpha);
+      ExpectNear(FromSimd(simd_out[i]), expected, 2e-5f);
+      ExpectNear(FromSoa(soa_out, i), expected, 2e-5f);
+    }
+  }
+}
+
+TEST(Multiply, QuaternionBatch) {
+  const Inputs in;
+  SimdQuaternion simd_out[kCount];
+  SoaQuaternion soa_out[kSoaCount];
+  ASSERT_TRUE(ozz::math::Multiply(ozz::make_span(in.simd_a),
+                                  ozz::make_span(in.simd_b),
+                                  ozz::make_span(simd_out)));
+  ASSERT_TRUE(ozz::math::Multiply(ozz::make_span(in.soa_a),
+                                  ozz::make_span(in.soa_b),
+                                  ozz::make_span(soa_out)));
+  for (size_t i = 0; i < kCount; ++i) {
+    const Quaternion expected = in.a[i] * in.b[i];
+    ExpectNear(FromSimd(simd_out[i]), expected, 1e-6f);
+    ExpectNear(FromSoa(soa_out, i), expected, 1e-6f);
+  }
+}
+
+TEST(TransformVector, QuaternionBatch) {
+  const Inputs in;
+  SimdFloat4 simd_out[kCount];
+  SoaFloat3 soa_out[kSoaCount];
+  ASSERT_TRUE(ozz::math::TransformVector(ozz::make_span(in.simd_a),
+                                         ozz::make_span(in.simd_v),
+                                         ozz::make_span(simd_out)));
+  ASSERT_TRUE(ozz::math::TransformVector(ozz::make_span(in.soa_a),
+                                         ozz::make_span(in.soa_v),
+                                         ozz::make_span(soa_out)));
+  for (size_t i = 0; i < kCount; ++i) {
+    const Float3 expected = TransformVector(in.a[i], in.v[i]);
+    ExpectNear(FromSimd(simd_out[i]), expected, 1e-5f);
+
+    float c[3][4];
+    ozz::math::StorePtrU(soa_out[i / 4].x, c[0]);
+    ozz::math::StorePtrU(soa_out[i / 4].y, c[1]);
+    ozz::math::StorePtrU(soa_out[i / 4].z, c[2]);
+    ExpectNear(Float3(c[0][i % 4], c[1][i % 4], c[2][i % 4]), expected, 1e-5f);
+  }
+}
@@ -0,0 +1,94 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/maths/simd_dual_quaternion.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+
+using ozz::math::DualQuaternion;
+using ozz::math::Float4x4;
+using ozz::math::SimdFloat4;
+using ozz::math::SimdQuaternion;
+
+TEST(DualQuaternionConstant, ozz_simd_math) {
+  const DualQuaternion identity = DualQuaternion::identity();
+  EXPECT_SIMDFLOAT_EQ(identity.real.xyzw, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(identity.dual.xyzw, 0.f, 0.f, 0.f, 0.f);
+
+  const SimdFloat4 p = ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f);
+  EXPECT_SIMDFLOAT3_EQ(TransformPoint(identity, p), 1.f, 2.f, 3.f);
+  EXPECT_SIMDFLOAT3_EQ(TransformVector(identity, p), 1.f, 2.f, 3.f);
+}
+
+TEST(DualQuaternionTransform, ozz_simd_math) {
+  const SimdFloat4 translation =
+      ozz::math::simd_float4::Load(4.f, -5.f, 6.f, 99.f);
+  const SimdQuaternion rotation = SimdQuaternion::FromAxisAngle(
+      ozz::math::simd_float4::y_axis(),
+      ozz::math::simd_float4::Load1(ozz::math::kPi_2));
+  const DualQuaternion dq = DualQuaternion::FromAffine(translation, rotation);
+  EXPECT_SIMDFLOAT3_EQ_EST(GetTranslation(dq), 4.f, -5.f, 6.f);
+
+  // Matches the equivalent matrix transformation.
+  const Float4x4 m = Float4x4::FromAffine(translation, rotation.xyzw,
+                                          ozz::math::simd_float4::one());
+  const SimdFloat4 p = ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f);
+  const SimdFloat4 mp = TransformPoint(m, p);
+  const SimdFloat4 mv = TransformVector(m, p);
+  EXPECT_SIMDFLOAT3_EQ_EST(TransformPoint(dq, p), ozz::math::GetX(mp),
+                           ozz::math::GetY(mp), ozz::math::GetZ(mp));
+  EXPECT_SIMDFLOAT3_EQ_EST(TransformVector(dq, p), ozz::math::GetX(mv),
+                           ozz::math::GetY(mv), ozz::math::GetZ(mv));
+
+  // Can be built back from the matrix.
+  const DualQuaternion from_m = DualQuaternion::FromFloat4x4(m);
+  EXPECT_SIMDFLOAT3_EQ_EST(TransformPoint(from_m, p), ozz::math::GetX(mp),
+                           ozz::math::GetY(mp), ozz::math::GetZ(mp));
+}
+
+TEST(DualQuaternionBlend, ozz_simd_math) {
+  const SimdFloat4 translation =
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f);
+  const DualQuaternion a =
+      DualQuaternion::FromAffine(translation, SimdQuaternion::identity());
+  const DualQuaternion b = DualQuaternion::FromAffine(
+      translation, SimdQuaternion::FromAxisAngle(
+                       ozz::math::simd_float4::z_axis(),
+                       ozz::math::simd_float4::Load1(ozz::math::kPi_2)));
+
+  // Blending 2 rotations around the same axis rotates half way, and doesn't
+  // scale.
+  const SimdFloat4 half = ozz::math::simd_float4::Load1(.5f);
+  const DualQuaternion blended = Normalize(a * half + b * half);
+  EXPECT_SIMDINT_EQ(IsNormalized(blended.real), 0xffffffff, 0, 0, 0);
+  const SimdFloat4 v = ozz::math::simd_float4::x_axis();
+  EXPECT_SIMDFLOAT3_EQ_EST(TransformVector(blended, v), .70710677f,
+                           .70710677f, 0.f);
+  EXPECT_SIMDFLOAT3_EQ_EST(GetTranslation(blended), 1.f, 2.f, 3.f);
+}
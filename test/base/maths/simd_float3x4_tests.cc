@@ -0,0 +1,106 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/maths/simd_float3x4.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+
+using ozz::math::Float3x4;
+using ozz::math::Float4x4;
+using ozz::math::SimdFloat4;
+
+namespace {
+// Expects the 3 first rows of _m4 to match _m3.
+void ExpectAffineEq(const Float4x4& _m4, const Float3x4& _m3) {
+  const Float4x4 m = ToFloat4x4(_m3);
+  for (int c = 0; c < 4; ++c) {
+    const SimdFloat4 expected = _m4.cols[c];
+    const SimdFloat4 col = m.cols[c];
+    EXPECT_NEAR(ozz::math::GetX(col), ozz::math::GetX(expected), 1e-5f);
+    EXPECT_NEAR(ozz::math::GetY(col), ozz::math::GetY(expected), 1e-5f);
+    EXPECT_NEAR(ozz::math::GetZ(col), ozz::math::GetZ(expected), 1e-5f);
+  }
+}
+}  // namespace
+
+TEST(Float3x4Constant, ozz_simd_math) {
+  const Float3x4 identity = Float3x4::identity();
+  EXPECT_SIMDFLOAT_EQ(identity.rows[0], 1.f, 0.f, 0.f, 0.f);
+  EXPECT_SIMDFLOAT_EQ(identity.rows[1], 0.f, 1.f, 0.f, 0.f);
+  EXPECT_SIMDFLOAT_EQ(identity.rows[2], 0.f, 0.f, 1.f, 0.f);
+
+  EXPECT_FLOAT4x4_EQ(ToFloat4x4(identity), 1.f, 0.f, 0.f, 0.f, 0.f, 1.f, 0.f,
+                     0.f, 0.f, 0.f, 1.f, 0.f, 0.f, 0.f, 0.f, 1.f);
+}
+
+TEST(Float3x4Conversion, ozz_simd_math) {
+  const Float4x4 m4 = Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, .70710677f),
+      ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 0.f));
+  const Float3x4 m3 = Float3x4::FromFloat4x4(m4);
+  EXPECT_SIMDFLOAT_EQ(m3.rows[0], 0.f, 0.f, 6.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(m3.rows[1], 0.f, 5.f, 0.f, 2.f);
+  EXPECT_SIMDFLOAT_EQ(m3.rows[2], -4.f, 0.f, 0.f, 3.f);
+
+  EXPECT_FLOAT4x4_EQ(ToFloat4x4(m3), 0.f, 0.f, -4.f, 0.f, 0.f, 5.f, 0.f, 0.f,
+                     6.f, 0.f, 0.f, 0.f, 1.f, 2.f, 3.f, 1.f);
+}
+
+TEST(Float3x4Arithmetic, ozz_simd_math) {
+  const Float4x4 a4 = Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(1.f, -2.f, 3.f, 0.f),
+      ozz::math::simd_float4::Load(.5f, .5f, .5f, .5f),
+      ozz::math::simd_float4::Load(2.f, 1.f, 3.f, 0.f));
+  const Float4x4 b4 = Float4x4::FromAffine(
+      ozz::math::simd_float4::Load(-4.f, 5.f, 6.f, 0.f),
+      ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, .70710677f),
+      ozz::math::simd_float4::Load(1.f, 2.f, .5f, 0.f));
+  const Float3x4 a3 = Float3x4::FromFloat4x4(a4);
+  const Float3x4 b3 = Float3x4::FromFloat4x4(b4);
+
+  ExpectAffineEq(a4 * b4, a3 * b3);
+  ExpectAffineEq(b4 * a4, b3 * a3);
+  ExpectAffineEq(a4 + b4, a3 + b3);
+
+  const SimdFloat4 w = ozz::math::simd_float4::Load1(.25f);
+  ExpectAffineEq(ColumnMultiply(a4, w), RowMultiply(a3, w));
+
+  const SimdFloat4 v = ozz::math::simd_float4::Load(2.f, -3.f, 4.f, 99.f);
+  const SimdFloat4 p4 = TransformPoint(a4, v);
+  const SimdFloat4 p3 = TransformPoint(a3, v);
+  EXPECT_NEAR(ozz::math::GetX(p3), ozz::math::GetX(p4), 1e-5f);
+  EXPECT_NEAR(ozz::math::GetY(p3), ozz::math::GetY(p4), 1e-5f);
+  EXPECT_NEAR(ozz::math::GetZ(p3), ozz::math::GetZ(p4), 1e-5f);
+  const SimdFloat4 v4 = TransformVector(a4, v);
+  const SimdFloat4 v3 = TransformVector(a3, v);
+  EXPECT_NEAR(ozz::math::GetX(v3), ozz::math::GetX(v4), 1e-5f);
+  EXPECT_NEAR(ozz::math::GetY(v3), ozz::math::GetY(v4), 1e-5f);
+  EXPECT_NEAR(ozz::math::GetZ(v3), ozz::math::GetZ(v4), 1e-5f);
+}
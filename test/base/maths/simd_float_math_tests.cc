@@ -50,6 +50,32 @@ TEST(Name, ozz_simd_math) {
   EXPECT_TRUE(ozz::math::SimdImplementationName() != nullptr);
 }
 
+TEST(HostSupports, ozz_simd_math) {
+  using ozz::math::SimdHostSupports;
+
+  // Instruction sets enabled at build time are necessarily supported.
+#if defined(OZZ_SIMD_AVX)
+  EXPECT_TRUE(SimdHostSupports(ozz::math::kSimdHostAvx));
+#endif  // OZZ_SIMD_AVX
+#if defined(OZZ_SIMD_AVX2)
+  EXPECT_TRUE(SimdHostSupports(ozz::math::kSimdHostAvx2));
+#endif  // OZZ_SIMD_AVX2
+#if defined(OZZ_SIMD_FMA)
+  EXPECT_TRUE(SimdHostSupports(ozz::math::kSimdHostFma));
+#endif  // OZZ_SIMD_FMA
+
+  // AVX2 implies AVX.
+  if (SimdHostSupports(ozz::math::kSimdHostAvx2)) {
+    EXPECT_TRUE(SimdHostSupports(ozz::math::kSimdHostAvx));
+  }
+
+  // Detection is stable.
+  EXPECT_EQ(SimdHostSupports(ozz::math::kSimdHostAvx),
+            SimdHostSupports(ozz::math::kSimdHostAvx));
+
+  EXPECT_FALSE(SimdHostSupports(ozz::math::kSimdHostFeatureCount));
+}
+
 TEST(LoadFloat, ozz_simd_math) {
   const SimdFloat4 fX = ozz::math::simd_float4::LoadX(15.f);
   EXPECT_SIMDFLOAT_EQ(fX, 15.f, 0.f, 0.f, 0.f);
@@ -236,6 +262,41 @@ TEST(StoreFloatPtr, ozz_simd_math) {
   }
 }
 
+TEST(StreamFloatPtr, ozz_simd_math) {
+  const SimdFloat4 f4 = ozz::math::simd_float4::Load(-1.f, 1.f, 2.f, 3.f);
+
+  union Data {
+    float f[4 + 4];    // The 2nd float isn't aligned to a SimdFloat4.
+    SimdFloat4 f4[2];  // Forces alignment.
+    char c[(4 + 4) * sizeof(float)];  // The 2nd char isn't aligned to a float.
+  };
+
+  {
+    Data d_out = {};
+    ozz::math::StreamPtr(f4, d_out.f + 4);
+    ozz::math::StreamFence();
+    EXPECT_FLOAT_EQ(d_out.f[3], 0.f);
+    EXPECT_FLOAT_EQ(d_out.f[4], -1.f);
+    EXPECT_FLOAT_EQ(d_out.f[5], 1.f);
+    EXPECT_FLOAT_EQ(d_out.f[6], 2.f);
+    EXPECT_FLOAT_EQ(d_out.f[7], 3.f);
+    EXPECT_ASSERTION(ozz::math::StreamPtr(f4, d_out.f + 1), "alignment");
+  }
+  {
+    Data d_out = {};
+    ozz::math::Stream3PtrU(f4, d_out.f + 1);
+    ozz::math::StreamFence();
+    EXPECT_FLOAT_EQ(d_out.f[0], 0.f);
+    EXPECT_FLOAT_EQ(d_out.f[1], -1.f);
+    EXPECT_FLOAT_EQ(d_out.f[2], 1.f);
+    EXPECT_FLOAT_EQ(d_out.f[3], 2.f);
+    EXPECT_FLOAT_EQ(d_out.f[4], 0.f);
+    EXPECT_ASSERTION(
+        ozz::math::Stream3PtrU(f4, reinterpret_cast<float*>(d_out.c + 1)),
+        "alignment");
+  }
+}
+
 TEST(ConstantFloat, ozz_simd_math) {
   const SimdFloat4 zero = ozz::math::simd_float4::zero();
   EXPECT_SIMDFLOAT_EQ(zero, 0.f, 0.f, 0.f, 0.f);
@@ -0,0 +1,179 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/maths/soa_transform8.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/gtest_helper.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+using ozz::math::SimdFloat8;
+using ozz::math::SoaFloat3;
+using ozz::math::SoaFloat3x8;
+using ozz::math::SoaQuaternion;
+using ozz::math::SoaQuaternion8;
+using ozz::math::SoaTransform;
+using ozz::math::SoaTransform8;
+
+namespace {
+// Expects 8 wide _v to be equal to 4 wide _lo and _hi.
+void ExpectEq(const SimdFloat8& _v, ozz::math::_SimdFloat4 _lo,
+              ozz::math::_SimdFloat4 _hi) {
+  float expected[8];
+  ozz::math::StorePtrU(_lo, expected);
+  ozz::math::StorePtrU(_hi, expected + 4);
+  float actual[8];
+  ozz::math::StorePtrU(_v.low(), actual);
+  ozz::math::StorePtrU(_v.high(), actual + 4);
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_FLOAT_EQ(actual[i], expected[i]);
+  }
+}
+
+void ExpectEq(const SoaFloat3x8& _v, const SoaFloat3& _lo,
+              const SoaFloat3& _hi) {
+  ExpectEq(_v.x, _lo.x, _hi.x);
+  ExpectEq(_v.y, _lo.y, _hi.y);
+  ExpectEq(_v.z, _lo.z, _hi.z);
+}
+
+void ExpectEq(const SoaQuaternion8& _v, const SoaQuaternion& _lo,
+              const SoaQuaternion& _hi) {
+  ExpectEq(_v.x, _lo.x, _hi.x);
+  ExpectEq(_v.y, _lo.y, _hi.y);
+  ExpectEq(_v.z, _lo.z, _hi.z);
+  ExpectEq(_v.w, _lo.w, _hi.w);
+}
+
+const SoaQuaternion kQuaternionLo = SoaQuaternion::Load(
+    ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, .382683432f),
+    ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(.70710677f, 1.f, .70710677f, .9238795f));
+const SoaQuaternion kQuaternionHi = SoaQuaternion::Load(
+    ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, -.382683432f),
+    ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(1.f, .70710677f, .70710677f, .9238795f));
+const SoaFloat3 kFloat3Lo =
+    SoaFloat3::Load(ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f),
+                    ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 7.f),
+                    ozz::math::simd_float4::Load(8.f, 9.f, 10.f, 11.f));
+const SoaFloat3 kFloat3Hi =
+    SoaFloat3::Load(ozz::math::simd_float4::Load(-1.f, -2.f, 46.f, .5f),
+                    ozz::math::simd_float4::Load(12.f, -5.f, 3.f, 2.f),
+                    ozz::math::simd_float4::Load(0.f, 19.f, -10.f, 1.f));
+}  // namespace
+
+TEST(SoaTransform8Constant, ozz_soa_math) {
+  const SoaTransform8 identity = SoaTransform8::identity();
+  const SoaTransform lo = identity.low();
+  const SoaTransform hi = identity.high();
+  EXPECT_SOAFLOAT3_EQ(lo.translation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                      0.f, 0.f, 0.f, 0.f);
+  EXPECT_SOAQUATERNION_EQ(hi.rotation, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, 0.f, 0.f, 0.f, 1.f, 1.f, 1.f, 1.f);
+  EXPECT_SOAFLOAT3_EQ(hi.scale, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f, 1.f,
+                      1.f, 1.f, 1.f);
+}
+
+TEST(SoaTransform8Load, ozz_soa_math) {
+  const SoaTransform lo = {kFloat3Lo, kQuaternionLo, kFloat3Hi};
+  const SoaTransform hi = {kFloat3Hi, kQuaternionHi, kFloat3Lo};
+  const SoaTransform8 transform = SoaTransform8::Load(lo, hi);
+  ExpectEq(transform.translation, kFloat3Lo, kFloat3Hi);
+  ExpectEq(transform.rotation, kQuaternionLo, kQuaternionHi);
+  ExpectEq(transform.scale, kFloat3Hi, kFloat3Lo);
+
+  // Low and high parts round trip.
+  EXPECT_SOAQUATERNION_EQ(transform.low().rotation, .70710677f, 0.f, 0.f,
+                          .382683432f, 0.f, 0.f, .70710677f, 0.f, 0.f, 0.f, 0.f,
+                          0.f, .70710677f, 1.f, .70710677f, .9238795f);
+  EXPECT_SOAFLOAT3_EQ(transform.high().translation, -1.f, -2.f, 46.f, .5f, 12.f,
+                      -5.f, 3.f, 2.f, 0.f, 19.f, -10.f, 1.f);
+}
+
+TEST(SimdFloat8Arithmetic, ozz_soa_math) {
+  const SimdFloat8 a = SimdFloat8::Load(kFloat3Lo.x, kFloat3Hi.y);
+  const SimdFloat8 b = SimdFloat8::Load(kFloat3Lo.z, kFloat3Hi.x);
+
+  ExpectEq(a + b, kFloat3Lo.x + kFloat3Lo.z, kFloat3Hi.y + kFloat3Hi.x);
+  ExpectEq(a - b, kFloat3Lo.x - kFloat3Lo.z, kFloat3Hi.y - kFloat3Hi.x);
+  ExpectEq(a * b, kFloat3Lo.x * kFloat3Lo.z, kFloat3Hi.y * kFloat3Hi.x);
+  ExpectEq(a / b, kFloat3Lo.x / kFloat3Lo.z, kFloat3Hi.y / kFloat3Hi.x);
+  ExpectEq(-a, -kFloat3Lo.x, -kFloat3Hi.y);
+
+  const SimdFloat8 positive = SimdFloat8::Load(kFloat3Lo.y, kFloat3Lo.z);
+  ExpectEq(Sqrt(positive), ozz::math::Sqrt(kFloat3Lo.y),
+           ozz::math::Sqrt(kFloat3Lo.z));
+  ExpectEq(RSqrtEstNR(positive), ozz::math::RSqrtEstNR(kFloat3Lo.y),
+           ozz::math::RSqrtEstNR(kFloat3Lo.z));
+
+  ExpectEq(FlipSign(b, a),
+           ozz::math::Xor(kFloat3Lo.z, ozz::math::Sign(kFloat3Lo.x)),
+           ozz::math::Xor(kFloat3Hi.x, ozz::math::Sign(kFloat3Hi.y)));
+}
+
+TEST(SoaFloat3x8Arithmetic, ozz_soa_math) {
+  const SoaFloat3x8 a = SoaFloat3x8::Load(kFloat3Lo, kFloat3Hi);
+  const SoaFloat3x8 b = SoaFloat3x8::Load(kFloat3Hi, kFloat3Lo);
+  const SimdFloat8 f = SimdFloat8::Load(kQuaternionLo.x, kQuaternionHi.w);
+
+  ExpectEq(a + b, kFloat3Lo + kFloat3Hi, kFloat3Hi + kFloat3Lo);
+  ExpectEq(a - b, kFloat3Lo - kFloat3Hi, kFloat3Hi - kFloat3Lo);
+  ExpectEq(a * b, kFloat3Lo * kFloat3Hi, kFloat3Hi * kFloat3Lo);
+  ExpectEq(a * f, kFloat3Lo * kQuaternionLo.x, kFloat3Hi * kQuaternionHi.w);
+  ExpectEq(Lerp(a, b, f), Lerp(kFloat3Lo, kFloat3Hi, kQuaternionLo.x),
+           Lerp(kFloat3Hi, kFloat3Lo, kQuaternionHi.w));
+  ExpectEq(SoaFloat3x8::zero(), SoaFloat3::zero(), SoaFloat3::zero());
+  ExpectEq(SoaFloat3x8::one(), SoaFloat3::one(), SoaFloat3::one());
+}
+
+TEST(SoaQuaternion8Arithmetic, ozz_soa_math) {
+  const SoaQuaternion8 a = SoaQuaternion8::Load(kQuaternionLo, kQuaternionHi);
+  const SoaQuaternion8 b = SoaQuaternion8::Load(kQuaternionHi, kQuaternionLo);
+  const SimdFloat8 f = SimdFloat8::Load(ozz::math::simd_float4::Load1(.3f),
+                                        ozz::math::simd_float4::Load1(.7f));
+
+  ExpectEq(Conjugate(a), Conjugate(kQuaternionLo), Conjugate(kQuaternionHi));
+  ExpectEq(Dot(a, b), Dot(kQuaternionLo, kQuaternionHi),
+           Dot(kQuaternionHi, kQuaternionLo));
+  ExpectEq(a + b, kQuaternionLo + kQuaternionHi, kQuaternionHi + kQuaternionLo);
+  ExpectEq(a * f, kQuaternionLo * ozz::math::simd_float4::Load1(.3f),
+           kQuaternionHi * ozz::math::simd_float4::Load1(.7f));
+  ExpectEq(a * b, kQuaternionLo * kQuaternionHi, kQuaternionHi * kQuaternionLo);
+  ExpectEq(NormalizeEst(a + b), NormalizeEst(kQuaternionLo + kQuaternionHi),
+           NormalizeEst(kQuaternionHi + kQuaternionLo));
+  ExpectEq(NLerpEst(a, b, f),
+           NLerpEst(kQuaternionLo, kQuaternionHi,
+                    ozz::math::simd_float4::Load1(.3f)),
+           NLerpEst(kQuaternionHi, kQuaternionLo,
+                    ozz::math::simd_float4::Load1(.7f)));
+  ExpectEq(SoaQuaternion8::identity(), SoaQuaternion::identity(),
+           SoaQuaternion::identity());
+}
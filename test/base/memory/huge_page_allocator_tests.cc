@@ -0,0 +1,181 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/huge_page_allocator.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using ozz::memory::HugePageAllocator;
+
+namespace {
+size_t MappedRegions(const HugePageAllocator::Stats& _stats) {
+  return _stats.huge_regions + _stats.transparent_regions;
+}
+size_t MappedBytes(const HugePageAllocator::Stats& _stats) {
+  return _stats.huge_bytes + _stats.transparent_bytes;
+}
+}  // namespace
+
+TEST(Allocate, HugePageAllocator) {
+  HugePageAllocator allocator;
+  EXPECT_EQ(allocator.page_size(), 2u << 20);
+
+  HugePageAllocator::Stats stats = allocator.stats();
+  EXPECT_EQ(MappedRegions(stats), 0u);
+  EXPECT_EQ(stats.used_blocks, 0u);
+
+  void* p0 = allocator.Allocate(12, 4);
+  ASSERT_TRUE(p0 != nullptr);
+  EXPECT_TRUE(ozz::IsAligned(p0, 4));
+  memset(p0, 0xaa, 12);
+  void* p1 = allocator.Allocate(1000, 64);
+  ASSERT_TRUE(p1 != nullptr);
+  EXPECT_TRUE(ozz::IsAligned(p1, 64));
+  memset(p1, 0xbb, 1000);
+  void* p2 = allocator.Allocate(0, 16);
+  ASSERT_TRUE(p2 != nullptr);
+  EXPECT_TRUE(ozz::IsAligned(p2, 16));
+
+  // Blocks share a single region of whole pages.
+  stats = allocator.stats();
+  EXPECT_EQ(MappedRegions(stats), 1u);
+  EXPECT_EQ(MappedBytes(stats), allocator.page_size());
+  EXPECT_EQ(stats.forwarded, 0u);
+  EXPECT_EQ(stats.used_blocks, 3u);
+  EXPECT_GE(stats.used_bytes, 1012u);
+  EXPECT_EQ(static_cast<unsigned char*>(p0)[11], 0xaa);
+
+  // Deallocating nullptr is valid.
+  allocator.Deallocate(nullptr);
+
+  allocator.Deallocate(p0);
+  allocator.Deallocate(p1);
+  allocator.Deallocate(p2);
+
+  // Current region is kept for next allocations.
+  stats = allocator.stats();
+  EXPECT_EQ(MappedRegions(stats), 1u);
+  EXPECT_EQ(stats.used_blocks, 0u);
+  EXPECT_EQ(stats.used_bytes, 0u);
+
+  void* p3 = allocator.Allocate(12, 4);
+  EXPECT_EQ(p3, p0);
+  allocator.Deallocate(p3);
+}
+
+TEST(Regions, HugePageAllocator) {
+  HugePageAllocator allocator;
+  const size_t page_size = allocator.page_size();
+
+  void* p0 = allocator.Allocate(page_size / 2, 16);
+  ASSERT_TRUE(p0 != nullptr);
+
+  // Allocations bigger than a page get a dedicated region.
+  void* p1 = allocator.Allocate(page_size * 3, 16);
+  ASSERT_TRUE(p1 != nullptr);
+  memset(p1, 0, page_size * 3);
+  HugePageAllocator::Stats stats = allocator.stats();
+  EXPECT_EQ(MappedRegions(stats), 2u);
+  EXPECT_EQ(MappedBytes(stats), page_size * 5);
+
+  // Allocation continues in the first region, which has more free space.
+  void* p2 = allocator.Allocate(page_size / 4, 16);
+  ASSERT_TRUE(p2 != nullptr);
+  EXPECT_GT(p2, p0);
+  EXPECT_LT(static_cast<char*>(p2), static_cast<char*>(p0) + page_size);
+  EXPECT_EQ(MappedRegions(allocator.stats()), 2u);
+
+  // Empty dedicated region is unmapped.
+  allocator.Deallocate(p1);
+  stats = allocator.stats();
+  EXPECT_EQ(MappedRegions(stats), 1u);
+  EXPECT_EQ(MappedBytes(stats), page_size);
+
+  // A full region is replaced, and unmapped once empty.
+  void* p3 = allocator.Allocate(page_size / 2, 16);
+  ASSERT_TRUE(p3 != nullptr);
+  EXPECT_EQ(MappedRegions(allocator.stats()), 2u);
+  allocator.Deallocate(p0);
+  EXPECT_EQ(MappedRegions(allocator.stats()), 2u);
+  allocator.Deallocate(p2);
+  EXPECT_EQ(MappedRegions(allocator.stats()), 1u);
+  allocator.Deallocate(p3);
+  EXPECT_EQ(MappedRegions(allocator.stats()), 1u);
+  EXPECT_EQ(allocator.stats().used_blocks, 0u);
+}
+
+TEST(Forward, HugePageAllocator) {
+  HugePageAllocator allocator;
+
+  // Alignments bigger than a page are forwarded to the parent.
+  const size_t alignment = allocator.page_size() * 2;
+  void* p0 = allocator.Allocate(16, alignment);
+  ASSERT_TRUE(p0 != nullptr);
+  EXPECT_TRUE(ozz::IsAligned(p0, alignment));
+  memset(p0, 0, 16);
+
+  HugePageAllocator::Stats stats = allocator.stats();
+  EXPECT_EQ(stats.forwarded, 1u);
+  EXPECT_EQ(stats.used_blocks, 0u);
+  EXPECT_EQ(MappedRegions(stats), 0u);
+
+  allocator.Deallocate(p0);
+  EXPECT_EQ(allocator.stats().forwarded, 0u);
+}
+
+TEST(Threads, HugePageAllocator) {
+  HugePageAllocator allocator;
+
+  const int kThreads = 4;
+  const int kBlocks = 1000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&allocator, i]() {
+      std::vector<void*> blocks;
+      for (int j = 0; j < kBlocks; ++j) {
+        const size_t size = 16 + (j % 7) * 100;
+        char* block = static_cast<char*>(allocator.Allocate(size, 16));
+        ASSERT_TRUE(block != nullptr);
+        memset(block, i, size);
+        blocks.push_back(block);
+      }
+      for (size_t j = 0; j < blocks.size(); ++j) {
+        EXPECT_EQ(static_cast<char*>(blocks[j])[0], i);
+        allocator.Deallocate(blocks[j]);
+      }
+    });
+  }
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i].join();
+  }
+  EXPECT_EQ(allocator.stats().used_blocks, 0u);
+  EXPECT_LE(MappedRegions(allocator.stats()), 1u);
+}
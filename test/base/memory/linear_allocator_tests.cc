@@ -0,0 +1,244 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/linear_allocator.h"
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/math_ex.h"
+
+namespace {
+// Counts allocations forwarded to the default allocator, and fails them once
+// allowed count is reached.
+class CountingAllocator : public ozz::memory::Allocator {
+ public:
+  explicit CountingAllocator(int _allowed = 1000)
+      : allowed_(_allowed), allocations_(0), deallocations_(0) {}
+
+  virtual void* Allocate(size_t _size, size_t _alignment) {
+    if (allocations_ >= allowed_) {
+      return nullptr;
+    }
+    ++allocations_;
+    return ozz::memory::default_allocator()->Allocate(_size, _alignment);
+  }
+
+  virtual void Deallocate(void* _block) {
+    if (_block) {
+      ++deallocations_;
+    }
+    ozz::memory::default_allocator()->Deallocate(_block);
+  }
+
+  int allocations() const { return allocations_; }
+  int deallocations() const { return deallocations_; }
+
+ private:
+  int allowed_;
+  int allocations_;
+  int deallocations_;
+};
+}  // namespace
+
+TEST(Allocate, LinearAllocator) {
+  CountingAllocator parent;
+  {
+    ozz::memory::LinearAllocator allocator(1024, &parent);
+    EXPECT_EQ(allocator.used(), 0u);
+    EXPECT_EQ(allocator.capacity(), 0u);
+    EXPECT_EQ(parent.allocations(), 0);
+
+    void* p0 = allocator.Allocate(12, 16);
+    ASSERT_TRUE(p0 != nullptr);
+    EXPECT_TRUE(ozz::IsAligned(p0, 16));
+    memset(p0, 0, 12);
+    EXPECT_EQ(parent.allocations(), 1);
+    EXPECT_EQ(allocator.capacity(), 1024u);
+
+    // Allocations are contiguous, up to alignment.
+    void* p1 = allocator.Allocate(4, 4);
+    ASSERT_TRUE(p1 != nullptr);
+    EXPECT_EQ(static_cast<char*>(p1), static_cast<char*>(p0) + 12);
+    const size_t used = allocator.used();
+    EXPECT_GE(used, 16u);
+
+    void* p2 = allocator.Allocate(8, 256);
+    ASSERT_TRUE(p2 != nullptr);
+    EXPECT_TRUE(ozz::IsAligned(p2, 256));
+    EXPECT_GE(allocator.used(), used + 8);
+
+    // Allocating 0 byte gives a valid pointer.
+    EXPECT_TRUE(allocator.Allocate(0, 4) != nullptr);
+
+    // Deallocating does nothing, nullptr included.
+    allocator.Deallocate(p0);
+    allocator.Deallocate(nullptr);
+    EXPECT_EQ(parent.deallocations(), 0);
+  }
+  EXPECT_EQ(parent.deallocations(), 1);
+}
+
+TEST(Grow, LinearAllocator) {
+  CountingAllocator parent;
+  {
+    ozz::memory::LinearAllocator allocator(64, &parent);
+
+    // Exhausts first block.
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_TRUE(allocator.Allocate(32, 4) != nullptr);
+    }
+    EXPECT_GE(parent.allocations(), 2);
+
+    // Allocation bigger than block size.
+    void* big = allocator.Allocate(1000, 64);
+    ASSERT_TRUE(big != nullptr);
+    EXPECT_TRUE(ozz::IsAligned(big, 64));
+    memset(big, 0, 1000);
+    const int allocations = parent.allocations();
+    const size_t capacity = allocator.capacity();
+    EXPECT_GE(capacity, 1128u);
+
+    // Reset merges all blocks.
+    allocator.Reset();
+    EXPECT_EQ(allocator.used(), 0u);
+    EXPECT_EQ(allocator.capacity(), capacity);
+    EXPECT_EQ(parent.allocations(), allocations + 1);
+    EXPECT_EQ(parent.deallocations(), allocations);
+
+    // A similar frame doesn't allocate anymore.
+    for (int frame = 0; frame < 3; ++frame) {
+      for (int i = 0; i < 4; ++i) {
+        EXPECT_TRUE(allocator.Allocate(32, 4) != nullptr);
+      }
+      EXPECT_TRUE(allocator.Allocate(1000, 64) != nullptr);
+      allocator.Reset();
+    }
+    EXPECT_EQ(parent.allocations(), allocations + 1);
+  }
+  EXPECT_EQ(parent.allocations(), parent.deallocations());
+}
+
+TEST(Reset, LinearAllocator) {
+  CountingAllocator parent;
+  ozz::memory::LinearAllocator allocator(1024, &parent);
+
+  // Reset without any allocation.
+  allocator.Reset();
+  EXPECT_EQ(parent.allocations(), 0);
+
+  // Single block is reused.
+  void* p0 = allocator.Allocate(12, 16);
+  allocator.Reset();
+  EXPECT_EQ(allocator.used(), 0u);
+  void* p1 = allocator.Allocate(12, 16);
+  EXPECT_EQ(p0, p1);
+  EXPECT_EQ(parent.allocations(), 1);
+}
+
+TEST(ParentFailure, LinearAllocator) {
+  CountingAllocator parent(1);
+  ozz::memory::LinearAllocator allocator(64, &parent);
+  EXPECT_TRUE(allocator.Allocate(32, 4) != nullptr);
+  EXPECT_TRUE(allocator.Allocate(64, 4) == nullptr);
+
+  // Remaining space can still be used.
+  EXPECT_TRUE(allocator.Allocate(16, 4) != nullptr);
+}
+
+TEST(ThreadFrameAllocator, LinearAllocator) {
+  ozz::memory::LinearAllocator* allocator =
+      ozz::memory::thread_frame_allocator();
+  ASSERT_TRUE(allocator != nullptr);
+  EXPECT_EQ(allocator, ozz::memory::thread_frame_allocator());
+
+  {
+    std::vector<float, ozz::FrameStdAllocator<float>> floats;
+    for (int i = 0; i < 1000; ++i) {
+      floats.push_back(static_cast<float>(i));
+    }
+    EXPECT_EQ(floats[999], 999.f);
+    EXPECT_GE(allocator->used(), 1000 * sizeof(float));
+  }
+  allocator->Reset();
+  EXPECT_EQ(allocator->used(), 0u);
+}
+
+TEST(Rewind, LinearAllocator) {
+  CountingAllocator parent;
+  ozz::memory::LinearAllocator allocator(64, &parent);
+
+  void* p0 = allocator.Allocate(16, 4);
+  const ozz::memory::LinearAllocator::Marker marker = allocator.marker();
+  const size_t used = allocator.used();
+
+  // Rewinds within the same block.
+  void* p1 = allocator.Allocate(16, 4);
+  allocator.Rewind(marker);
+  EXPECT_EQ(allocator.used(), used);
+  EXPECT_EQ(allocator.Allocate(16, 4), p1);
+  allocator.Rewind(marker);
+
+  // Rewinds after new blocks were allocated. Last block is reused.
+  EXPECT_TRUE(allocator.Allocate(48, 4) != nullptr);
+  void* big = allocator.Allocate(256, 4);
+  ASSERT_TRUE(big != nullptr);
+  const int allocations = parent.allocations();
+  allocator.Rewind(marker);
+  EXPECT_EQ(allocator.used(), used);
+  EXPECT_EQ(allocator.Allocate(256, 4), big);
+  EXPECT_EQ(parent.allocations(), allocations);
+
+  // Memory allocated before the marker is preserved.
+  EXPECT_TRUE(p0 != nullptr);
+  EXPECT_GE(allocator.capacity(), 64u + 256u);
+}
+
+TEST(ScratchScope, LinearAllocator) {
+  CountingAllocator parent;
+  ozz::memory::LinearAllocator allocator(1024, &parent);
+  EXPECT_TRUE(allocator.Allocate(16, 4) != nullptr);
+  const size_t used = allocator.used();
+  {
+    ozz::memory::ScratchScope scope(&allocator);
+    EXPECT_EQ(scope.allocator(), &allocator);
+    EXPECT_TRUE(scope.allocator()->Allocate(128, 4) != nullptr);
+    {
+      ozz::memory::ScratchScope nested(&allocator);
+      EXPECT_TRUE(nested.allocator()->Allocate(128, 4) != nullptr);
+      EXPECT_GE(allocator.used(), used + 256);
+    }
+    EXPECT_GE(allocator.used(), used + 128);
+    EXPECT_LT(allocator.used(), used + 256);
+  }
+  EXPECT_EQ(allocator.used(), used);
+
+  // Defaults to thread frame allocator.
+  ozz::memory::ScratchScope scope;
+  EXPECT_EQ(scope.allocator(), ozz::memory::thread_frame_allocator());
+}
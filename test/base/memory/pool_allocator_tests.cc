@@ -0,0 +1,234 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/pool_allocator.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/math_ex.h"
+
+namespace {
+// Counts allocations forwarded to the default allocator.
+class CountingAllocator : public ozz::memory::Allocator {
+ public:
+  CountingAllocator() : allocations_(0), deallocations_(0) {}
+
+  virtual void* Allocate(size_t _size, size_t _alignment) {
+    ++allocations_;
+    return ozz::memory::default_allocator()->Allocate(_size, _alignment);
+  }
+
+  virtual void Deallocate(void* _block) {
+    if (_block) {
+      ++deallocations_;
+    }
+    ozz::memory::default_allocator()->Deallocate(_block);
+  }
+
+  int allocations() const { return allocations_; }
+  int deallocations() const { return deallocations_; }
+
+ private:
+  int allocations_;
+  int deallocations_;
+};
+}  // namespace
+
+TEST(SizeClass, PoolAllocator) {
+  ozz::memory::PoolAllocator allocator(1000);
+  EXPECT_EQ(allocator.SizeClass(0), 0);
+  EXPECT_EQ(allocator.SizeClass(1), 0);
+  EXPECT_EQ(allocator.SizeClass(16), 0);
+  EXPECT_EQ(allocator.SizeClass(17), 1);
+  EXPECT_EQ(allocator.SizeClass(32), 1);
+  EXPECT_EQ(allocator.SizeClass(1000), 6);
+  EXPECT_EQ(allocator.SizeClass(1024), 6);
+  EXPECT_EQ(allocator.SizeClass(1025), -1);
+}
+
+TEST(Allocate, PoolAllocator) {
+  CountingAllocator parent;
+  {
+    ozz::memory::PoolAllocator allocator(1024, 4096, &parent);
+    const int internal_allocations = parent.allocations();
+
+    void* p0 = allocator.Allocate(12, 4);
+    ASSERT_TRUE(p0 != nullptr);
+    EXPECT_TRUE(ozz::IsAligned(p0, ozz::memory::PoolAllocator::kAlignment));
+    memset(p0, 0, 12);
+    EXPECT_EQ(parent.allocations(), internal_allocations + 1);
+
+    // Following blocks come from the same chunk.
+    void* p1 = allocator.Allocate(16, 16);
+    ASSERT_TRUE(p1 != nullptr);
+    EXPECT_NE(p0, p1);
+    EXPECT_TRUE(ozz::IsAligned(p1, 16));
+    void* p2 = allocator.Allocate(100, 16);
+    ASSERT_TRUE(p2 != nullptr);
+    EXPECT_TRUE(ozz::IsAligned(p2, 16));
+    memset(p2, 0, 100);
+    EXPECT_EQ(parent.allocations(), internal_allocations + 2);
+
+    ozz::memory::PoolAllocator::Stats stats = allocator.stats();
+    EXPECT_EQ(stats.allocations, 3u);
+    EXPECT_EQ(stats.deallocations, 0u);
+    EXPECT_EQ(stats.forwarded, 0u);
+    EXPECT_EQ(stats.chunks, 2u);
+    EXPECT_EQ(stats.used_blocks, 3u);
+    EXPECT_EQ(stats.used_bytes, 16u + 16u + 128u);
+
+    // Deallocated blocks are recycled.
+    allocator.Deallocate(p1);
+    void* p3 = allocator.Allocate(8, 8);
+    EXPECT_EQ(p1, p3);
+
+    // Deallocating nullptr is valid.
+    allocator.Deallocate(nullptr);
+
+    allocator.Deallocate(p0);
+    allocator.Deallocate(p2);
+    allocator.Deallocate(p3);
+
+    stats = allocator.stats();
+    EXPECT_EQ(stats.allocations, 4u);
+    EXPECT_EQ(stats.deallocations, 4u);
+    EXPECT_EQ(stats.used_blocks, 0u);
+    EXPECT_EQ(stats.used_bytes, 0u);
+    EXPECT_EQ(parent.deallocations(), 0);
+  }
+  EXPECT_EQ(parent.allocations(), parent.deallocations());
+}
+
+TEST(Grow, PoolAllocator) {
+  CountingAllocator parent;
+  ozz::memory::PoolAllocator allocator(64, 256, &parent);
+
+  // A chunk of 256 bytes holds 8 blocks of 32 bytes (header included).
+  std::vector<void*> blocks;
+  for (int i = 0; i < 10; ++i) {
+    void* block = allocator.Allocate(16, 16);
+    ASSERT_TRUE(block != nullptr);
+    for (size_t j = 0; j < blocks.size(); ++j) {
+      EXPECT_NE(blocks[j], block);
+    }
+    memset(block, i, 16);
+    blocks.push_back(block);
+  }
+  EXPECT_EQ(allocator.stats().chunks, 2u);
+  EXPECT_EQ(allocator.stats().chunk_bytes, 2u * 256u);
+
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    allocator.Deallocate(blocks[i]);
+  }
+
+  // No more chunk is needed.
+  const size_t recycled = allocator.stats().recycled;
+  for (int i = 0; i < 10; ++i) {
+    blocks[i] = allocator.Allocate(16, 16);
+  }
+  const ozz::memory::PoolAllocator::Stats stats = allocator.stats();
+  EXPECT_EQ(stats.chunks, 2u);
+  EXPECT_EQ(stats.recycled, recycled + 10u);
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    allocator.Deallocate(blocks[i]);
+  }
+}
+
+TEST(Forward, PoolAllocator) {
+  CountingAllocator parent;
+  {
+    ozz::memory::PoolAllocator allocator(64, 256, &parent);
+    const int internal_allocations = parent.allocations();
+
+    // Too big.
+    void* big = allocator.Allocate(65, 4);
+    ASSERT_TRUE(big != nullptr);
+    EXPECT_TRUE(ozz::IsAligned(big, 16));
+    memset(big, 0, 65);
+    EXPECT_EQ(parent.allocations(), internal_allocations + 1);
+
+    // Over-aligned.
+    void* aligned = allocator.Allocate(8, 256);
+    ASSERT_TRUE(aligned != nullptr);
+    EXPECT_TRUE(ozz::IsAligned(aligned, 256));
+    memset(aligned, 0, 8);
+    EXPECT_EQ(parent.allocations(), internal_allocations + 2);
+
+    const ozz::memory::PoolAllocator::Stats stats = allocator.stats();
+    EXPECT_EQ(stats.allocations, 2u);
+    EXPECT_EQ(stats.forwarded, 2u);
+    EXPECT_EQ(stats.chunks, 0u);
+    EXPECT_EQ(stats.used_blocks, 0u);
+
+    allocator.Deallocate(big);
+    allocator.Deallocate(aligned);
+    EXPECT_EQ(parent.deallocations(), 2);
+  }
+  EXPECT_EQ(parent.allocations(), parent.deallocations());
+}
+
+namespace {
+void Stress(ozz::memory::PoolAllocator* _allocator, int _seed) {
+  std::vector<unsigned char*> blocks;
+  for (int i = 0; i < 2000; ++i) {
+    const size_t size = 1 + (i * 7 + _seed * 13) % 200;
+    unsigned char* block =
+        static_cast<unsigned char*>(_allocator->Allocate(size, 16));
+    ASSERT_TRUE(block != nullptr);
+    block[0] = static_cast<unsigned char>(_seed);
+    blocks.push_back(block);
+    if (i % 3 == 2) {
+      // Releases a block, ensuring no other thread used it.
+      unsigned char* released = blocks[blocks.size() / 2];
+      EXPECT_EQ(released[0], static_cast<unsigned char>(_seed));
+      _allocator->Deallocate(released);
+      blocks.erase(blocks.begin() + blocks.size() / 2);
+    }
+  }
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    EXPECT_EQ(blocks[i][0], static_cast<unsigned char>(_seed));
+    _allocator->Deallocate(blocks[i]);
+  }
+}
+}  // namespace
+
+TEST(Threading, PoolAllocator) {
+  ozz::memory::PoolAllocator allocator(256, 1024);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.push_back(std::thread(Stress, &allocator, i));
+  }
+  for (size_t i = 0; i < threads.size(); ++i) {
+    threads[i].join();
+  }
+  const ozz::memory::PoolAllocator::Stats stats = allocator.stats();
+  EXPECT_EQ(stats.allocations, stats.deallocations);
+  EXPECT_EQ(stats.used_blocks, 0u);
+}
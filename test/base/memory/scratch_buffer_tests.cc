@@ -0,0 +1,81 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/scratch_buffer.h"
+
+#include <cstdint>
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/memory/tracking_allocator.h"
+
+TEST(Inline, ScratchBuffer) {
+  ozz::memory::TrackingAllocator tracking;
+  ozz::memory::Allocator* previous =
+      ozz::memory::SetDefaulAllocator(&tracking);
+  {
+    ozz::memory::ScratchBuffer<int, 16> empty(0);
+    EXPECT_TRUE(empty.is_inline());
+    EXPECT_EQ(empty.size(), 0u);
+
+    ozz::memory::ScratchBuffer<int, 16> buffer(16);
+    EXPECT_TRUE(buffer.is_inline());
+    EXPECT_EQ(buffer.size(), 16u);
+    for (int i = 0; i < 16; ++i) {
+      buffer[i] = i;
+    }
+    const ozz::memory::ScratchBuffer<int, 16>& cbuffer = buffer;
+    for (int i = 0; i < 16; ++i) {
+      EXPECT_EQ(cbuffer[i], i);
+      EXPECT_EQ(cbuffer.data() + i, &buffer[i]);
+    }
+  }
+  EXPECT_EQ(tracking.total().allocations, 0u);
+  ozz::memory::SetDefaulAllocator(previous);
+}
+
+TEST(Allocated, ScratchBuffer) {
+  ozz::memory::TrackingAllocator tracking;
+  ozz::memory::Allocator* previous =
+      ozz::memory::SetDefaulAllocator(&tracking);
+  {
+    ozz::memory::ScratchBuffer<ozz::math::SimdFloat4, 4> buffer(33);
+    EXPECT_FALSE(buffer.is_inline());
+    EXPECT_EQ(buffer.size(), 33u);
+    EXPECT_TRUE(ozz::IsAligned(buffer.data(), alignof(ozz::math::SimdFloat4)));
+    EXPECT_EQ(tracking.total().live_allocations, 1u);
+    for (int i = 0; i < 33; ++i) {
+      buffer[i] = ozz::math::simd_float4::Load1(static_cast<float>(i));
+    }
+    for (int i = 0; i < 33; ++i) {
+      EXPECT_EQ(ozz::math::GetX(buffer[i]), static_cast<float>(i));
+    }
+  }
+  EXPECT_EQ(tracking.total().allocations, 1u);
+  EXPECT_EQ(tracking.total().live_allocations, 0u);
+  ozz::memory::SetDefaulAllocator(previous);
+}
@@ -0,0 +1,146 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/memory/tracking_allocator.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/math_ex.h"
+
+TEST(TagScope, TrackingAllocator) {
+  EXPECT_EQ(ozz::memory::current_tag(), ozz::memory::kTagUntagged);
+  {
+    ozz::memory::TagScope animation(ozz::memory::kTagAnimation);
+    EXPECT_EQ(ozz::memory::current_tag(), ozz::memory::kTagAnimation);
+    {
+      ozz::memory::TagScope context(ozz::memory::kTagContext);
+      EXPECT_EQ(ozz::memory::current_tag(), ozz::memory::kTagContext);
+    }
+    EXPECT_EQ(ozz::memory::current_tag(), ozz::memory::kTagAnimation);
+  }
+  EXPECT_EQ(ozz::memory::current_tag(), ozz::memory::kTagUntagged);
+
+  EXPECT_STREQ(ozz::memory::TagName(ozz::memory::kTagSkeleton), "skeleton");
+  EXPECT_STREQ(ozz::memory::TagName(ozz::memory::kTagOffline), "offline");
+  EXPECT_STREQ(ozz::memory::TagName(ozz::memory::kTagCount), "invalid");
+}
+
+TEST(Allocate, TrackingAllocator) {
+  ozz::memory::TrackingAllocator allocator;
+
+  void* untagged = allocator.Allocate(10, 4);
+  ASSERT_TRUE(untagged != nullptr);
+  EXPECT_TRUE(ozz::IsAligned(untagged, 4));
+  memset(untagged, 0, 10);
+
+  void* animation;
+  void* context;
+  {
+    ozz::memory::TagScope scope(ozz::memory::kTagAnimation);
+    animation = allocator.Allocate(100, 64);
+    ASSERT_TRUE(animation != nullptr);
+    EXPECT_TRUE(ozz::IsAligned(animation, 64));
+    memset(animation, 0, 100);
+    {
+      ozz::memory::TagScope nested(ozz::memory::kTagContext);
+      context = allocator.Allocate(1000, 16);
+      ASSERT_TRUE(context != nullptr);
+      EXPECT_TRUE(ozz::IsAligned(context, 16));
+      memset(context, 0, 1000);
+    }
+  }
+
+  ozz::memory::TrackingAllocator::Stats stats =
+      allocator.stats(ozz::memory::kTagUntagged);
+  EXPECT_EQ(stats.live_bytes, 10u);
+  EXPECT_EQ(stats.live_allocations, 1u);
+  EXPECT_EQ(stats.peak_bytes, 10u);
+  EXPECT_EQ(stats.allocations, 1u);
+
+  stats = allocator.stats(ozz::memory::kTagAnimation);
+  EXPECT_EQ(stats.live_bytes, 100u);
+  EXPECT_EQ(stats.live_allocations, 1u);
+
+  stats = allocator.stats(ozz::memory::kTagContext);
+  EXPECT_EQ(stats.live_bytes, 1000u);
+
+  stats = allocator.stats(ozz::memory::kTagSkeleton);
+  EXPECT_EQ(stats.live_bytes, 0u);
+  EXPECT_EQ(stats.allocations, 0u);
+
+  stats = allocator.total();
+  EXPECT_EQ(stats.live_bytes, 1110u);
+  EXPECT_EQ(stats.live_allocations, 3u);
+  EXPECT_EQ(stats.peak_bytes, 1110u);
+
+  // Deallocation is attributed to the allocation tag, whatever current tag.
+  {
+    ozz::memory::TagScope scope(ozz::memory::kTagSkeleton);
+    allocator.Deallocate(context);
+  }
+  allocator.Deallocate(nullptr);
+  stats = allocator.stats(ozz::memory::kTagContext);
+  EXPECT_EQ(stats.live_bytes, 0u);
+  EXPECT_EQ(stats.live_allocations, 0u);
+  EXPECT_EQ(stats.peak_bytes, 1000u);
+  EXPECT_EQ(stats.allocations, 1u);
+  EXPECT_EQ(stats.deallocations, 1u);
+  EXPECT_EQ(stats.allocated_bytes, 1000u);
+  EXPECT_EQ(allocator.stats(ozz::memory::kTagSkeleton).deallocations, 0u);
+
+  stats = allocator.total();
+  EXPECT_EQ(stats.live_bytes, 110u);
+  EXPECT_EQ(stats.peak_bytes, 1110u);
+
+  allocator.ResetPeaks();
+  EXPECT_EQ(allocator.total().peak_bytes, 110u);
+  EXPECT_EQ(allocator.stats(ozz::memory::kTagContext).peak_bytes, 0u);
+
+  allocator.Deallocate(untagged);
+  allocator.Deallocate(animation);
+  stats = allocator.total();
+  EXPECT_EQ(stats.live_bytes, 0u);
+  EXPECT_EQ(stats.live_allocations, 0u);
+  EXPECT_EQ(stats.allocations, 3u);
+  EXPECT_EQ(stats.deallocations, 3u);
+  EXPECT_EQ(stats.allocated_bytes, 1110u);
+}
+
+TEST(DefaultAllocator, TrackingAllocator) {
+  ozz::memory::TrackingAllocator allocator;
+  ozz::memory::Allocator* previous =
+      ozz::memory::SetDefaulAllocator(&allocator);
+
+  int* i = ozz::New<int>(46);
+  EXPECT_EQ(allocator.total().live_allocations, 1u);
+  EXPECT_EQ(allocator.total().live_bytes, sizeof(int));
+  ozz::Delete(i);
+  EXPECT_EQ(allocator.total().live_allocations, 0u);
+
+  EXPECT_EQ(ozz::memory::SetDefaulAllocator(previous), &allocator);
+}
@@ -0,0 +1,141 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/profile.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+namespace {
+// Records zones begin/end events.
+struct Recorder {
+  int depth;
+  int max_depth;
+  int begins;
+  int ends;
+  const ozz::profile::ZoneDesc* last;
+  const ozz::profile::ZoneDesc* stack[8];
+};
+
+void RecordBegin(const ozz::profile::ZoneDesc& _zone, void* _user_data) {
+  Recorder* recorder = static_cast<Recorder*>(_user_data);
+  ++recorder->begins;
+  ASSERT_LT(recorder->depth, 8);
+  recorder->stack[recorder->depth] = &_zone;
+  if (++recorder->depth > recorder->max_depth) {
+    recorder->max_depth = recorder->depth;
+  }
+  recorder->last = &_zone;
+}
+
+void RecordEnd(const ozz::profile::ZoneDesc& _zone, void* _user_data) {
+  Recorder* recorder = static_cast<Recorder*>(_user_data);
+  ++recorder->ends;
+  ASSERT_GT(recorder->depth, 0);
+  // Zones are nested.
+  EXPECT_EQ(recorder->stack[--recorder->depth], &_zone);
+}
+
+void ProfiledFunction() { OZZ_PROFILE_ZONE("ProfiledFunction"); }
+}  // namespace
+
+TEST(Hooks, Profile) {
+  const ozz::profile::Hooks initial = ozz::profile::GetHooks();
+  EXPECT_TRUE(initial.begin == nullptr);
+  EXPECT_TRUE(initial.end == nullptr);
+  EXPECT_TRUE(initial.user_data == nullptr);
+
+  Recorder recorder = {};
+  const ozz::profile::Hooks hooks = {&RecordBegin, &RecordEnd, &recorder};
+  const ozz::profile::Hooks previous = ozz::profile::SetHooks(hooks);
+  EXPECT_TRUE(previous.begin == nullptr);
+  EXPECT_TRUE(ozz::profile::GetHooks().begin == &RecordBegin);
+  EXPECT_TRUE(ozz::profile::GetHooks().end == &RecordEnd);
+  EXPECT_TRUE(ozz::profile::GetHooks().user_data == &recorder);
+
+  // Restores initial hooks.
+  const ozz::profile::Hooks restored = ozz::profile::SetHooks(initial);
+  EXPECT_TRUE(restored.user_data == &recorder);
+  EXPECT_TRUE(ozz::profile::GetHooks().begin == nullptr);
+}
+
+TEST(Zone, Profile) {
+  const ozz::profile::ZoneDesc desc = {"zone", "function", "file", 46};
+
+  // No hook.
+  { const ozz::profile::Zone zone(desc); }
+
+  Recorder recorder = {};
+  const ozz::profile::Hooks hooks = {&RecordBegin, &RecordEnd, &recorder};
+  const ozz::profile::Hooks previous = ozz::profile::SetHooks(hooks);
+  {
+    const ozz::profile::Zone zone(desc);
+    EXPECT_EQ(recorder.begins, 1);
+    EXPECT_EQ(recorder.ends, 0);
+    EXPECT_EQ(recorder.last, &desc);
+  }
+  EXPECT_EQ(recorder.begins, 1);
+  EXPECT_EQ(recorder.ends, 1);
+  EXPECT_EQ(recorder.depth, 0);
+
+  // Partial hooks.
+  const ozz::profile::Hooks begin_only = {&RecordBegin, nullptr, &recorder};
+  ozz::profile::SetHooks(begin_only);
+  { const ozz::profile::Zone zone(desc); }
+  EXPECT_EQ(recorder.begins, 2);
+  EXPECT_EQ(recorder.ends, 1);
+
+  ozz::profile::SetHooks(previous);
+}
+
+TEST(Macro, Profile) {
+  Recorder recorder = {};
+  const ozz::profile::Hooks hooks = {&RecordBegin, &RecordEnd, &recorder};
+  const ozz::profile::Hooks previous = ozz::profile::SetHooks(hooks);
+  {
+    OZZ_PROFILE_ZONE("outer");
+    ProfiledFunction();
+    ProfiledFunction();
+  }
+  ozz::profile::SetHooks(previous);
+
+#if defined(OZZ_BUILD_PROFILE)
+  EXPECT_EQ(recorder.begins, 3);
+  EXPECT_EQ(recorder.ends, 3);
+  EXPECT_EQ(recorder.max_depth, 2);
+  EXPECT_EQ(recorder.depth, 0);
+  ASSERT_TRUE(recorder.last != nullptr);
+  EXPECT_STREQ(recorder.last->name, "ProfiledFunction");
+  EXPECT_TRUE(std::strstr(recorder.last->file, "profile_tests") != nullptr);
+  EXPECT_GT(recorder.last->line, 0);
+#else   // OZZ_BUILD_PROFILE
+  // Zones compile to nothing.
+  EXPECT_EQ(recorder.begins, 0);
+  EXPECT_EQ(recorder.ends, 0);
+#endif  // OZZ_BUILD_PROFILE
+}
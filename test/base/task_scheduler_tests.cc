@@ -0,0 +1,257 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/base/task_scheduler.h"
+
+#include <atomic>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/numa.h"
+
+namespace {
+// Counts how many times each task is run.
+struct CountData {
+  explicit CountData(int _count) : runs(_count) {
+    for (size_t i = 0; i < runs.size(); ++i) {
+      runs[i].store(0);
+    }
+  }
+  ozz::vector<std::atomic<int>> runs;
+};
+
+void CountTask(int _task, void* _data) {
+  static_cast<CountData*>(_data)->runs[_task]++;
+}
+
+void ExpectRunOnce(const CountData& _data) {
+  for (size_t i = 0; i < _data.runs.size(); ++i) {
+    EXPECT_EQ(_data.runs[i].load(), 1);
+  }
+}
+
+// Runs a nested ParallelFor from each task.
+struct NestedData {
+  ozz::TaskScheduler* scheduler;
+  CountData** counts;  // One per outer task.
+  int inner;
+};
+
+void NestedTask(int _task, void* _data) {
+  NestedData* data = static_cast<NestedData*>(_data);
+  data->scheduler->ParallelFor(data->inner, &CountTask, data->counts[_task]);
+}
+}  // namespace
+
+TEST(ParallelFor, TaskScheduler) {
+  for (int workers = 0; workers < 4; ++workers) {
+    ozz::WorkStealingScheduler scheduler(workers);
+    EXPECT_EQ(scheduler.num_workers(), workers);
+
+    // No task.
+    scheduler.ParallelFor(0, &CountTask, nullptr);
+
+    const int counts[] = {1, 2, 7, 64, 1023};
+    for (size_t c = 0; c < OZZ_ARRAY_SIZE(counts); ++c) {
+      CountData data(counts[c]);
+      scheduler.ParallelFor(counts[c], &CountTask, &data);
+      ExpectRunOnce(data);
+    }
+  }
+}
+
+TEST(DefaultWorkers, TaskScheduler) {
+  ozz::WorkStealingScheduler scheduler;
+  EXPECT_GE(scheduler.num_workers(), 0);
+
+  CountData data(100);
+  scheduler.ParallelFor(100, &CountTask, &data);
+  ExpectRunOnce(data);
+}
+
+TEST(PinnedWorkers, TaskScheduler) {
+  ozz::WorkStealingScheduler scheduler(3, true);
+  EXPECT_EQ(scheduler.num_workers(), 3);
+  for (int i = 0; i < scheduler.num_workers(); ++i) {
+    EXPECT_GE(scheduler.worker_node(i), 0);
+    EXPECT_LT(scheduler.worker_node(i), ozz::numa::NumNodes());
+  }
+  EXPECT_EQ(scheduler.worker_node(-1), 0);
+  EXPECT_EQ(scheduler.worker_node(3), 0);
+
+  CountData data(1023);
+  scheduler.ParallelFor(1023, &CountTask, &data);
+  ExpectRunOnce(data);
+}
+
+TEST(Numa, TaskScheduler) {
+  EXPECT_GE(ozz::numa::NumNodes(), 1);
+  EXPECT_GE(ozz::numa::NumCpus(), 1);
+  EXPECT_EQ(ozz::numa::CpuNode(-1), 0);
+  EXPECT_EQ(ozz::numa::CpuNode(1 << 20), 0);
+  EXPECT_GE(ozz::numa::CurrentNode(), 0);
+  EXPECT_LT(ozz::numa::CurrentNode(), ozz::numa::NumNodes());
+  EXPECT_FALSE(ozz::numa::PinThreadToNode(ozz::numa::NumNodes()));
+
+  // Runs on any node, even an unexisting one.
+  int value = 0;
+  for (int node = 0; node <= ozz::numa::NumNodes(); ++node) {
+    ozz::numa::RunOnNode(
+        node, [](void* _data) { ++*static_cast<int*>(_data); }, &value);
+  }
+  EXPECT_EQ(value, ozz::numa::NumNodes() + 1);
+}
+
+TEST(Nested, TaskScheduler) {
+  ozz::WorkStealingScheduler scheduler(3);
+
+  const int kOuter = 16;
+  CountData* outer[kOuter];
+  for (int i = 0; i < kOuter; ++i) {
+    outer[i] = new CountData(33);
+  }
+  NestedData data = {&scheduler, outer, 33};
+  scheduler.ParallelFor(kOuter, &NestedTask, &data);
+  for (int i = 0; i < kOuter; ++i) {
+    ExpectRunOnce(*outer[i]);
+    delete outer[i];
+  }
+}
+
+TEST(Concurrent, TaskScheduler) {
+  ozz::WorkStealingScheduler scheduler(2);
+
+  // ParallelFor concurrently called from external threads.
+  CountData data0(500), data1(500);
+  std::thread thread(
+      [&scheduler, &data0] { scheduler.ParallelFor(500, &CountTask, &data0); });
+  scheduler.ParallelFor(500, &CountTask, &data1);
+  thread.join();
+  ExpectRunOnce(data0);
+  ExpectRunOnce(data1);
+}
+
+TEST(Hook, TaskScheduler) {
+  ozz::WorkStealingScheduler scheduler(2);
+
+  // Hook signature matches jobs parallel_for ones.
+  void (*hook)(int, void (*)(int, void*), void*, void*) =
+      &ozz::TaskScheduler::ParallelForHook;
+
+  CountData data(42);
+  hook(42, &CountTask, &data, &scheduler);
+  ExpectRunOnce(data);
+}
+
+namespace {
+// Node of a test graph, whose tasks record the maximum completion order of
+// nodes it depends on.
+struct GraphNode {
+  std::atomic<int>* clock;
+  std::atomic<int> done;  // Completion order, -1 if not completed.
+  std::atomic<int> remaining;
+  ozz::vector<const GraphNode*> dependencies;
+  std::atomic<bool> valid;
+};
+
+void GraphTask(int, void* _data) {
+  GraphNode* node = static_cast<GraphNode*>(_data);
+  for (size_t i = 0; i < node->dependencies.size(); ++i) {
+    if (node->dependencies[i]->done.load() < 0) {
+      node->valid = false;
+    }
+  }
+  if (--node->remaining == 0) {
+    node->done = (*node->clock)++;
+  }
+}
+}  // namespace
+
+TEST(Graph, TaskScheduler) {
+  ozz::WorkStealingScheduler scheduler(3);
+
+  for (int s = 0; s < 2; ++s) {
+    ozz::TaskScheduler* run_scheduler = s == 0 ? nullptr : &scheduler;
+
+    // Diamond graph, plus an independent node, and an empty one.
+    const int kNodes = 6;
+    const int counts[kNodes] = {10, 20, 5, 30, 0, 100};
+    std::atomic<int> clock(0);
+    GraphNode nodes[kNodes];
+    ozz::TaskGraph graph;
+    for (int i = 0; i < kNodes; ++i) {
+      nodes[i].clock = &clock;
+      nodes[i].done = -1;
+      nodes[i].remaining = counts[i];
+      nodes[i].valid = true;
+      EXPECT_EQ(graph.AddNode(counts[i], &GraphTask, &nodes[i]), i);
+    }
+    EXPECT_EQ(graph.num_nodes(), kNodes);
+
+    const int deps[][2] = {{0, 1}, {0, 2}, {1, 3}, {2, 3}};
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(deps); ++i) {
+      EXPECT_TRUE(graph.AddDependency(deps[i][0], deps[i][1]));
+      nodes[deps[i][1]].dependencies.push_back(&nodes[deps[i][0]]);
+    }
+    // Empty node has no task, so it's never marked completed.
+    EXPECT_TRUE(graph.AddDependency(4, 3));
+
+    EXPECT_TRUE(graph.Run(run_scheduler));
+    for (int i = 0; i < kNodes; ++i) {
+      EXPECT_TRUE(nodes[i].valid.load());
+      EXPECT_EQ(nodes[i].remaining.load(), 0);
+      EXPECT_EQ(nodes[i].done.load() >= 0, counts[i] != 0);
+    }
+    EXPECT_LT(nodes[0].done.load(), nodes[1].done.load());
+    EXPECT_LT(nodes[0].done.load(), nodes[2].done.load());
+    EXPECT_LT(nodes[1].done.load(), nodes[3].done.load());
+    EXPECT_LT(nodes[2].done.load(), nodes[3].done.load());
+
+    graph.Clear();
+    EXPECT_EQ(graph.num_nodes(), 0);
+    EXPECT_TRUE(graph.Run(run_scheduler));
+  }
+}
+
+TEST(GraphError, TaskScheduler) {
+  ozz::TaskGraph graph;
+  CountData data(1);
+  EXPECT_EQ(graph.AddNode(1, &CountTask, &data), 0);
+  EXPECT_EQ(graph.AddNode(1, &CountTask, &data), 1);
+
+  // Invalid dependencies.
+  EXPECT_FALSE(graph.AddDependency(0, 0));
+  EXPECT_FALSE(graph.AddDependency(-1, 0));
+  EXPECT_FALSE(graph.AddDependency(0, 2));
+
+  // Cycles prevent any node from running.
+  EXPECT_TRUE(graph.AddDependency(0, 1));
+  EXPECT_TRUE(graph.AddDependency(1, 0));
+  EXPECT_FALSE(graph.Run(nullptr));
+  EXPECT_EQ(data.runs[0].load(), 0);
+}
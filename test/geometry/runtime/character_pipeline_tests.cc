@@ -0,0 +1,297 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/character_pipeline.h"
+
+#include "gtest/gtest.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/unique_ptr.h"
+#include "ozz/base/task_scheduler.h"
+
+using ozz::animation::Animation;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::SkeletonBuilder;
+using ozz::geometry::CharacterPipeline;
+using ozz::geometry::SkinningJob;
+
+namespace {
+// Builds a 2 joints skeleton, a root and its child.
+ozz::unique_ptr<Skeleton> BuildSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].name = "root";
+  raw_skeleton.roots[0].children.resize(1);
+  raw_skeleton.roots[0].children[0].name = "child";
+  return SkeletonBuilder()(raw_skeleton);
+}
+
+// Builds a 2 tracks animation, translating root along x.
+ozz::unique_ptr<Animation> BuildAnimation(float _x) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  const RawAnimation::TranslationKey key = {0.f,
+                                            ozz::math::Float3(_x, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(key);
+  return AnimationBuilder()(raw_animation);
+}
+}  // namespace
+
+TEST(Allocate, CharacterPipeline) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ASSERT_TRUE(skeleton);
+
+  CharacterPipeline pipeline;
+  EXPECT_TRUE(pipeline.skeleton() == nullptr);
+  EXPECT_EQ(pipeline.max_layers(), 0);
+  EXPECT_FALSE(pipeline.Run());
+  EXPECT_FALSE(pipeline.succeeded());
+
+  ozz::TaskGraph graph;
+  EXPECT_EQ(pipeline.AddTasks(&graph), -1);
+  EXPECT_EQ(graph.num_nodes(), 0);
+
+  EXPECT_FALSE(pipeline.Allocate(*skeleton, 0, 2));
+  EXPECT_FALSE(pipeline.Allocate(*skeleton, 2, -1));
+  EXPECT_TRUE(pipeline.skeleton() == nullptr);
+
+  EXPECT_TRUE(pipeline.Allocate(*skeleton, 3, 2));
+  EXPECT_EQ(pipeline.skeleton(), skeleton.get());
+  EXPECT_EQ(pipeline.max_layers(), 3);
+  EXPECT_EQ(pipeline.layers().size(), 3u);
+  EXPECT_EQ(pipeline.locals().size(), 1u);
+  EXPECT_EQ(pipeline.models().size(), 2u);
+  EXPECT_EQ(pipeline.skinning_matrices().size(), 2u);
+  EXPECT_EQ(pipeline.layer_locals(2).size(), 1u);
+  EXPECT_EQ(pipeline.layer_locals(3).size(), 0u);
+
+  // Buffers are cache line aligned.
+  EXPECT_TRUE(ozz::IsAligned(pipeline.locals().data(), 64));
+  EXPECT_TRUE(ozz::IsAligned(pipeline.models().data(), 64));
+  EXPECT_TRUE(ozz::IsAligned(pipeline.layer_locals(1).data(), 64));
+
+  // No layer outputs rest pose.
+  EXPECT_TRUE(pipeline.Run());
+  EXPECT_TRUE(pipeline.succeeded());
+  EXPECT_SIMDFLOAT_EQ(pipeline.models()[1].cols[3], 0.f, 0.f, 0.f, 1.f);
+
+  pipeline.Deallocate();
+  EXPECT_TRUE(pipeline.skeleton() == nullptr);
+  EXPECT_FALSE(pipeline.Run());
+}
+
+TEST(Run, CharacterPipeline) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ozz::unique_ptr<Animation> animation1 = BuildAnimation(1.f);
+  ozz::unique_ptr<Animation> animation3 = BuildAnimation(3.f);
+  ASSERT_TRUE(skeleton && animation1 && animation3);
+
+  CharacterPipeline pipeline;
+  ASSERT_TRUE(pipeline.Allocate(*skeleton, 3, 2));
+
+  // Blends 2 layers, the last one is left empty.
+  pipeline.layers()[0].animation = animation1.get();
+  pipeline.layers()[1].animation = animation3.get();
+  EXPECT_TRUE(pipeline.Run());
+  EXPECT_TRUE(pipeline.succeeded());
+  EXPECT_SIMDFLOAT_EQ(pipeline.layer_locals(0)[0].translation.x, 1.f, 0.f,
+                      0.f, 0.f);
+  EXPECT_SIMDFLOAT_EQ(pipeline.models()[0].cols[3], 2.f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(pipeline.models()[1].cols[3], 2.f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(pipeline.skinning_matrices()[1].cols[3], 2.f, 0.f, 0.f,
+                      1.f);
+
+  // Additive layer.
+  pipeline.layers()[2].animation = animation1.get();
+  pipeline.layers()[2].additive = true;
+  EXPECT_TRUE(pipeline.Run());
+  EXPECT_SIMDFLOAT_EQ(pipeline.models()[1].cols[3], 3.f, 0.f, 0.f, 1.f);
+
+  // Inverse bind poses.
+  const ozz::math::Float4x4 inverse_bind_poses[] = {
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(-1.f, 0.f, 0.f, 0.f)),
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(-2.f, 0.f, 0.f, 0.f))};
+  pipeline.set_inverse_bind_poses(inverse_bind_poses);
+  EXPECT_TRUE(pipeline.Run());
+  EXPECT_SIMDFLOAT_EQ(pipeline.skinning_matrices()[0].cols[3], 2.f, 0.f, 0.f,
+                      1.f);
+  EXPECT_SIMDFLOAT_EQ(pipeline.skinning_matrices()[1].cols[3], 1.f, 0.f, 0.f,
+                      1.f);
+
+  // Not enough inverse bind poses.
+  pipeline.set_inverse_bind_poses({inverse_bind_poses, 1});
+  EXPECT_FALSE(pipeline.Run());
+  EXPECT_FALSE(pipeline.succeeded());
+  pipeline.set_inverse_bind_poses(inverse_bind_poses);
+
+  // Skinning, a vertex influenced by the child joint.
+  const uint16_t joint_indices[] = {1};
+  const float in_positions[] = {0.f, 1.f, 0.f};
+  float out_positions[3] = {0.f, 0.f, 0.f};
+  SkinningJob skinning_job;
+  skinning_job.vertex_count = 1;
+  skinning_job.influences_count = 1;
+  skinning_job.joint_indices = joint_indices;
+  skinning_job.joint_indices_stride = sizeof(uint16_t);
+  skinning_job.in_positions = in_positions;
+  skinning_job.in_positions_stride = sizeof(float) * 3;
+  skinning_job.out_positions = out_positions;
+  skinning_job.out_positions_stride = sizeof(float) * 3;
+  pipeline.set_skinning_jobs({&skinning_job, 1});
+  EXPECT_TRUE(pipeline.Run());
+  EXPECT_TRUE(pipeline.succeeded());
+  EXPECT_FLOAT_EQ(out_positions[0], 1.f);
+  EXPECT_FLOAT_EQ(out_positions[1], 1.f);
+  EXPECT_FLOAT_EQ(out_positions[2], 0.f);
+
+  // Invalid skinning job.
+  skinning_job.influences_count = 0;
+  pipeline.set_skinning_jobs({&skinning_job, 1});
+  EXPECT_FALSE(pipeline.Run());
+  EXPECT_FALSE(pipeline.succeeded());
+}
+
+TEST(SamplingFailure, CharacterPipeline) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ozz::unique_ptr<Animation> animation = BuildAnimation(1.f);
+  ASSERT_TRUE(skeleton && animation);
+
+  // Context doesn't support animation tracks.
+  CharacterPipeline pipeline;
+  ASSERT_TRUE(pipeline.Allocate(*skeleton, 1, 0));
+  pipeline.layers()[0].animation = animation.get();
+  EXPECT_FALSE(pipeline.RunStage(CharacterPipeline::kSampleStage));
+  EXPECT_FALSE(pipeline.RunStage(CharacterPipeline::kBlendStage) &&
+               pipeline.succeeded());
+  EXPECT_FALSE(pipeline.Run());
+  EXPECT_FALSE(pipeline.succeeded());
+}
+
+namespace {
+// IK callback that moves the child joint along y.
+bool MoveChild(CharacterPipeline* _pipeline, int* _update_from,
+               void* _user_data) {
+  EXPECT_EQ(*_update_from, CharacterPipeline::kNoUpdate);
+  const float y = *static_cast<const float*>(_user_data);
+  ozz::math::SoaTransform& locals = _pipeline->locals()[0];
+  locals.translation.y = ozz::math::simd_float4::Load(0.f, y, 0.f, 0.f);
+  *_update_from = 1;
+  return y >= 0.f;
+}
+}  // namespace
+
+TEST(IK, CharacterPipeline) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ozz::unique_ptr<Animation> animation = BuildAnimation(1.f);
+  ASSERT_TRUE(skeleton && animation);
+
+  CharacterPipeline pipeline;
+  ASSERT_TRUE(pipeline.Allocate(*skeleton, 1, 2));
+  pipeline.layers()[0].animation = animation.get();
+
+  float y = 5.f;
+  pipeline.set_ik_callback(&MoveChild, &y);
+  EXPECT_TRUE(pipeline.Run());
+  EXPECT_TRUE(pipeline.succeeded());
+  EXPECT_SIMDFLOAT_EQ(pipeline.models()[0].cols[3], 1.f, 0.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(pipeline.models()[1].cols[3], 1.f, 5.f, 0.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(pipeline.skinning_matrices()[1].cols[3], 1.f, 5.f, 0.f,
+                      1.f);
+
+  // Failing callback.
+  y = -1.f;
+  EXPECT_FALSE(pipeline.Run());
+  EXPECT_FALSE(pipeline.succeeded());
+
+  // Disabled.
+  pipeline.set_ik_callback(nullptr, nullptr);
+  EXPECT_TRUE(pipeline.Run());
+  EXPECT_SIMDFLOAT_EQ(pipeline.models()[1].cols[3], 1.f, 0.f, 0.f, 1.f);
+}
+
+TEST(TaskGraph, CharacterPipeline) {
+  ozz::unique_ptr<Skeleton> skeleton = BuildSkeleton();
+  ozz::unique_ptr<Animation> animation1 = BuildAnimation(1.f);
+  ozz::unique_ptr<Animation> animation3 = BuildAnimation(3.f);
+  ASSERT_TRUE(skeleton && animation1 && animation3);
+
+  const uint16_t joint_indices[] = {1};
+  const float in_positions[] = {0.f, 1.f, 0.f};
+
+  const int kCharacters = 16;
+  CharacterPipeline pipelines[kCharacters];
+  float out_positions[kCharacters][3];
+  ozz::TaskGraph graph;
+  for (int i = 0; i < kCharacters; ++i) {
+    CharacterPipeline& pipeline = pipelines[i];
+    ASSERT_TRUE(pipeline.Allocate(*skeleton, 2, 2));
+    pipeline.layers()[0].animation = animation1.get();
+    pipeline.layers()[1].animation = animation3.get();
+    pipeline.layers()[1].weight = static_cast<float>(i);
+
+    SkinningJob skinning_job;
+    skinning_job.vertex_count = 1;
+    skinning_job.influences_count = 1;
+    skinning_job.joint_indices = joint_indices;
+    skinning_job.joint_indices_stride = sizeof(uint16_t);
+    skinning_job.in_positions = in_positions;
+    skinning_job.in_positions_stride = sizeof(float) * 3;
+    skinning_job.out_positions = out_positions[i];
+    skinning_job.out_positions_stride = sizeof(float) * 3;
+    pipeline.set_skinning_jobs({&skinning_job, 1});
+
+    EXPECT_EQ(pipeline.AddTasks(&graph),
+              i * CharacterPipeline::kStageCount);
+  }
+  EXPECT_EQ(graph.num_nodes(), kCharacters * CharacterPipeline::kStageCount);
+
+  ozz::WorkStealingScheduler scheduler(3);
+  for (int run = 0; run < 2; ++run) {
+    ASSERT_TRUE(graph.Run(run == 0 ? nullptr : &scheduler));
+    for (int i = 0; i < kCharacters; ++i) {
+      // Weighted average of 1 and 3.
+      const float x = (1.f + 3.f * i) / (1.f + i);
+      EXPECT_TRUE(pipelines[i].succeeded());
+      EXPECT_SIMDFLOAT_EQ(pipelines[i].models()[1].cols[3], x, 0.f, 0.f, 1.f);
+      EXPECT_FLOAT_EQ(out_positions[i][0], x);
+      EXPECT_FLOAT_EQ(out_positions[i][1], 1.f);
+    }
+  }
+}
@@ -0,0 +1,133 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/inverse_transpose_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::geometry::InverseTransposeJob;
+
+TEST(JobValidity, InverseTransposeJob) {
+  ozz::math::Float4x4 input[3];
+  ozz::math::Float4x4 output[3];
+
+  {  // Default job is valid, with nothing to process.
+    InverseTransposeJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Output too small.
+    InverseTransposeJob job;
+    job.input = input;
+    job.output = {output, 2};
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid.
+    InverseTransposeJob job;
+    job.input = input;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+  }
+}
+
+namespace {
+// Builds _count affine matrices with rotation, non-uniform (and negative)
+// scale and translation.
+void BuildMatrices(ozz::math::Float4x4* _matrices, int _count) {
+  for (int i = 0; i < _count; ++i) {
+    const float fi = static_cast<float>(i);
+    const ozz::math::SimdFloat4 rotation = ozz::math::NormalizeEst4(
+        ozz::math::simd_float4::Load(.1f * fi, -.3f, .2f + fi, 1.f));
+    const ozz::math::SimdFloat4 scale = ozz::math::simd_float4::Load(
+        1.f + fi, .5f, i % 3 == 2 ? -2.f : 2.f + fi * .1f, 0.f);
+    _matrices[i] = ozz::math::Float4x4::FromAffine(
+        ozz::math::simd_float4::Load(fi, -fi, 3.f, 1.f), rotation, scale);
+  }
+}
+}  // namespace
+
+TEST(Result, InverseTransposeJob) {
+  // Not a multiple of 4, to cover the last partial batch.
+  const int kCount = 11;
+  ozz::math::Float4x4 input[kCount];
+  BuildMatrices(input, kCount);
+  ozz::math::Float4x4 output[kCount];
+
+  InverseTransposeJob job;
+  job.input = input;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+
+  const ozz::math::SimdFloat4 v =
+      ozz::math::simd_float4::Load(.3f, -.7f, .2f, 0.f);
+  for (int i = 0; i < kCount; ++i) {
+    const ozz::math::Float4x4 reference =
+        ozz::math::Transpose(ozz::math::Invert(input[i]));
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_SIMDFLOAT3_EQ_TOL(output[i].cols[c],
+                               ozz::math::GetX(reference.cols[c]),
+                               ozz::math::GetY(reference.cols[c]),
+                               ozz::math::GetZ(reference.cols[c]), 1e-5f);
+      EXPECT_EQ(ozz::math::GetW(output[i].cols[c]), 0.f);
+    }
+    EXPECT_SIMDFLOAT_EQ(output[i].cols[3], 0.f, 0.f, 0.f, 1.f);
+
+    // Cofactor only differs by the determinant.
+    const ozz::math::SimdFloat4 ref_v =
+        ozz::math::TransformVector(reference, v);
+    InverseTransposeJob cofactor_job;
+    cofactor_job.input = {input + i, 1};
+    ozz::math::Float4x4 cofactor;
+    cofactor_job.output = {&cofactor, 1};
+    cofactor_job.cofactor = true;
+    ASSERT_TRUE(cofactor_job.Run());
+    const float det = ozz::math::GetX(ozz::math::Dot3(
+        input[i].cols[0],
+        ozz::math::Cross3(input[i].cols[1], input[i].cols[2])));
+    EXPECT_SIMDFLOAT3_EQ_TOL(ozz::math::TransformVector(cofactor, v),
+                             ozz::math::GetX(ref_v) * det,
+                             ozz::math::GetY(ref_v) * det,
+                             ozz::math::GetZ(ref_v) * det, 1e-4f);
+  }
+
+  // In place.
+  job.output = input;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < kCount; ++i) {
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ(input[i].cols[c], ozz::math::GetX(output[i].cols[c]),
+                          ozz::math::GetY(output[i].cols[c]),
+                          ozz::math::GetZ(output[i].cols[c]),
+                          ozz::math::GetW(output[i].cols[c]));
+    }
+  }
+}
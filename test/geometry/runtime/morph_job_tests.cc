@@ -0,0 +1,215 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/morph_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/platform.h"
+
+using ozz::geometry::MorphJob;
+using ozz::geometry::MorphTarget;
+
+TEST(JobValidity, MorphJob) {
+  const uint32_t indices[] = {0, 2};
+  const float deltas[6] = {};
+  MorphTarget targets[1];
+  targets[0].indices = indices;
+  targets[0].position_deltas = deltas;
+  const float weights[1] = {1.f};
+  const float in[9] = {};
+  float out[9];
+
+  {  // Default job is valid, with no vertex.
+    MorphJob job;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Invalid vertex count and first vertex.
+    MorphJob job;
+    job.vertex_count = -1;
+    EXPECT_FALSE(job.Validate());
+    job.vertex_count = 0;
+    job.first_vertex = -1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  MorphJob job;
+  job.vertex_count = 3;
+  job.targets = targets;
+  job.weights = weights;
+  job.in_positions = in;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.out_positions = out;
+  job.out_positions_stride = sizeof(float) * 3;
+  EXPECT_TRUE(job.Validate());
+
+  {  // Missing weights.
+    MorphJob invalid = job;
+    invalid.weights = {};
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  {  // Too small deltas.
+    MorphTarget small = targets[0];
+    small.position_deltas = {deltas, 5};
+    MorphJob invalid = job;
+    invalid.targets = {&small, 1};
+    EXPECT_FALSE(invalid.Validate());
+    small.position_deltas = deltas;
+    small.normal_deltas = {deltas, 3};
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  {  // Too small inputs and outputs.
+    MorphJob invalid = job;
+    invalid.in_positions = {in, 8};
+    EXPECT_FALSE(invalid.Validate());
+    invalid = job;
+    invalid.out_positions = {out, 8};
+    EXPECT_FALSE(invalid.Validate());
+    invalid = job;
+    invalid.out_positions = {};
+    EXPECT_FALSE(invalid.Validate());
+  }
+
+  {  // Normals must be provided as input and output.
+    MorphJob invalid = job;
+    invalid.in_normals = in;
+    invalid.in_normals_stride = sizeof(float) * 3;
+    EXPECT_FALSE(invalid.Validate());
+    invalid.out_normals = out;
+    invalid.out_normals_stride = sizeof(float) * 3;
+    EXPECT_TRUE(invalid.Validate());
+  }
+}
+
+TEST(Result, MorphJob) {
+  const int kVertices = 6;
+
+  // Target 0 displaces vertices 1 and 4, target 1 vertices 0, 1 and 5, and
+  // target 2 vertex 3.
+  const uint32_t indices0[] = {1, 4};
+  const float positions0[] = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+  const float normals0[] = {0.f, 1.f, 0.f, 0.f, 0.f, 1.f};
+  const uint32_t indices1[] = {0, 1, 5};
+  const float positions1[] = {10.f, 0.f, 0.f, 0.f, 10.f, 0.f,
+                              0.f,  0.f, 10.f};
+  const uint32_t indices2[] = {3};
+  const float positions2[] = {100.f, 100.f, 100.f};
+  MorphTarget targets[3];
+  targets[0].indices = indices0;
+  targets[0].position_deltas = positions0;
+  targets[0].normal_deltas = normals0;
+  targets[1].indices = indices1;
+  targets[1].position_deltas = positions1;
+  targets[2].indices = indices2;
+  targets[2].position_deltas = positions2;
+  const float weights[] = {.5f, 2.f, 0.f};
+
+  // Interleaved positions and normals.
+  float in[kVertices * 6];
+  for (int i = 0; i < kVertices * 6; ++i) {
+    in[i] = static_cast<float>(i);
+  }
+
+  // Expected result, target 2 has a 0 weight.
+  float result[kVertices * 6];
+  for (int i = 0; i < kVertices * 6; ++i) {
+    result[i] = in[i];
+  }
+  for (int c = 0; c < 3; ++c) {
+    result[1 * 6 + c] += .5f * positions0[c] + 2.f * positions1[3 + c];
+    result[4 * 6 + c] += .5f * positions0[3 + c];
+    result[0 * 6 + c] += 2.f * positions1[c];
+    result[5 * 6 + c] += 2.f * positions1[6 + c];
+    result[1 * 6 + 3 + c] += .5f * normals0[c];
+    result[4 * 6 + 3 + c] += .5f * normals0[3 + c];
+  }
+
+  MorphJob job;
+  job.vertex_count = kVertices;
+  job.targets = targets;
+  job.weights = weights;
+  job.in_positions = {in, kVertices * 6 - 3};
+  job.in_positions_stride = sizeof(float) * 6;
+  job.in_normals = {in + 3, kVertices * 6 - 3};
+  job.in_normals_stride = sizeof(float) * 6;
+
+  {  // Interleaved output.
+    float out[kVertices * 6] = {};
+    job.out_positions = {out, kVertices * 6 - 3};
+    job.out_positions_stride = sizeof(float) * 6;
+    job.out_normals = {out + 3, kVertices * 6 - 3};
+    job.out_normals_stride = sizeof(float) * 6;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < kVertices * 6; ++i) {
+      EXPECT_FLOAT_EQ(out[i], result[i]);
+    }
+  }
+
+  {  // Separate positions buffer, without normals.
+    float out[kVertices * 3] = {};
+    MorphJob positions = job;
+    positions.in_normals = {};
+    positions.out_positions = out;
+    positions.out_positions_stride = sizeof(float) * 3;
+    positions.out_normals = {};
+    ASSERT_TRUE(positions.Run());
+    for (int v = 0; v < kVertices; ++v) {
+      for (int c = 0; c < 3; ++c) {
+        EXPECT_FLOAT_EQ(out[v * 3 + c], result[v * 6 + c]);
+      }
+    }
+  }
+
+  {  // In place, by ranges.
+    float inout[kVertices * 6];
+    for (int i = 0; i < kVertices * 6; ++i) {
+      inout[i] = in[i];
+    }
+    const int ranges[][2] = {{0, 2}, {2, 0}, {2, 3}, {5, 1}};
+    for (size_t r = 0; r < OZZ_ARRAY_SIZE(ranges); ++r) {
+      MorphJob range = job;
+      range.first_vertex = ranges[r][0];
+      range.vertex_count = ranges[r][1];
+      float* begin = inout + ranges[r][0] * 6;
+      const size_t size = static_cast<size_t>(ranges[r][1]) * 6;
+      range.in_positions = {begin, size};
+      range.in_normals = {begin + 3, size};
+      range.out_positions = {begin, size};
+      range.out_positions_stride = sizeof(float) * 6;
+      range.out_normals = {begin + 3, size};
+      range.out_normals_stride = sizeof(float) * 6;
+      ASSERT_TRUE(range.Run());
+    }
+    for (int i = 0; i < kVertices * 6; ++i) {
+      EXPECT_FLOAT_EQ(inout[i], result[i]);
+    }
+  }
+}
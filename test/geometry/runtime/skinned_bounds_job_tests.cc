@@ -0,0 +1,210 @@
+//----------------------------------------------------------------------------//
+//                                                                            //
+// ozz-animation is hosted at http://github.com/guillaumeblanc/ozz-animation  //
+// and distributed under the MIT License (MIT).                               //
+//                                                                            //
+// Copyright (c) Guillaume Blanc                                              //
+//                                                                            //
+// Permission is hereby granted, free of charge, to any person obtaining a    //
+// copy of this software and associated documentation files (the "Software"), //
+// to deal in the Software without restriction, including without limitation  //
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,   //
+// and/or sell copies of the Software, and to permit persons to whom the      //
+// Software is furnished to do so, subject to the following conditions:       //
+//                                                                            //
+// The above copyright notice and this permission notice shall be included in //
+// all copies or substantial portions of the Software.                        //
+//                                                                            //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,   //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL    //
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING    //
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER        //
+// DEALINGS IN THE SOFTWARE.                                                  //
+//                                                                            //
+//----------------------------------------------------------------------------//
+
+#include "ozz/geometry/runtime/skinned_bounds_job.h"
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/box.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/simd_math.h"
+
+using ozz::geometry::SkinnedBoundsJob;
+
+TEST(JobValidity, SkinnedBoundsJob) {
+  const ozz::math::Box boxes[2] = {
+      ozz::math::Box(ozz::math::Float3(-1.f), ozz::math::Float3(1.f)),
+      ozz::math::Box(ozz::math::Float3(-1.f), ozz::math::Float3(1.f))};
+  const ozz::math::Float4x4 matrices[2] = {ozz::math::Float4x4::identity(),
+                                           ozz::math::Float4x4::identity()};
+  const uint16_t remaps[2] = {1, 0};
+  ozz::math::Box joint_bounds[2];
+  ozz::math::Box bound;
+
+  {  // Default is invalid, as there's no output.
+    SkinnedBoundsJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid with no joint, bound is invalid.
+    SkinnedBoundsJob job;
+    job.bound = &bound;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+    EXPECT_FALSE(bound.is_valid());
+  }
+
+  {  // Not enough matrices.
+    SkinnedBoundsJob job;
+    job.joint_boxes = boxes;
+    job.joint_matrices = {matrices, 1};
+    job.bound = &bound;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+
+    // Remapped, matrices count doesn't matter anymore.
+    job.joint_remaps = {remaps, 1};
+    EXPECT_FALSE(job.Validate());
+    job.joint_remaps = remaps;
+    job.joint_matrices = matrices;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Not enough joint bounds.
+    SkinnedBoundsJob job;
+    job.joint_boxes = boxes;
+    job.joint_matrices = matrices;
+    job.joint_bounds = {joint_bounds, 1};
+    job.bound = &bound;
+    EXPECT_FALSE(job.Validate());
+    job.joint_bounds = joint_bounds;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+}
+
+TEST(Bounds, SkinnedBoundsJob) {
+  const ozz::math::Box boxes[3] = {
+      ozz::math::Box(ozz::math::Float3(-1.f, -2.f, -3.f),
+                     ozz::math::Float3(1.f, 2.f, 3.f)),
+      ozz::math::Box(),  // Invalid box is skipped.
+      ozz::math::Box(ozz::math::Float3(0.f), ozz::math::Float3(1.f))};
+  const ozz::math::Float4x4 matrices[3] = {
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(10.f, 0.f, 0.f, 1.f)),
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(1000.f, 0.f, 0.f, 1.f)),
+      ozz::math::Float4x4::FromAffine(
+          ozz::math::simd_float4::Load(0.f, 0.f, 5.f, 1.f),
+          ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, .70710677f),
+          ozz::math::simd_float4::Load(2.f, 2.f, 2.f, 1.f))};
+  ozz::math::Box joint_bounds[3];
+  ozz::math::Box bound;
+
+  SkinnedBoundsJob job;
+  job.joint_boxes = boxes;
+  job.joint_matrices = matrices;
+  job.joint_bounds = joint_bounds;
+  job.bound = &bound;
+  ASSERT_TRUE(job.Run());
+
+  EXPECT_FLOAT3_EQ(joint_bounds[0].min, 9.f, -2.f, -3.f);
+  EXPECT_FLOAT3_EQ(joint_bounds[0].max, 11.f, 2.f, 3.f);
+  EXPECT_FALSE(joint_bounds[1].is_valid());
+  // 90 degrees rotation around z, scaled by 2.
+  EXPECT_FLOAT3_EQ(joint_bounds[2].min, -2.f, 0.f, 5.f);
+  EXPECT_FLOAT3_EQ(joint_bounds[2].max, 0.f, 2.f, 7.f);
+
+  EXPECT_FLOAT3_EQ(bound.min, -2.f, -2.f, -3.f);
+  EXPECT_FLOAT3_EQ(bound.max, 11.f, 2.f, 7.f);
+
+  // Remapping.
+  const uint16_t remaps[3] = {2, 2, 0};
+  job.joint_remaps = remaps;
+  ASSERT_TRUE(job.Run());
+  EXPECT_FLOAT3_EQ(joint_bounds[2].min, 10.f, 0.f, 0.f);
+  EXPECT_FLOAT3_EQ(joint_bounds[2].max, 11.f, 1.f, 1.f);
+  EXPECT_FLOAT3_EQ(bound.min, -4.f, -2.f, -1.f);
+  EXPECT_FLOAT3_EQ(bound.max, 11.f, 2.f, 11.f);
+}
+
+TEST(SkinnedVertices, SkinnedBoundsJob) {
+  // Vertices of a bent cylinder like mesh, influenced by 2 joints.
+  const int kVertices = 6;
+  const float positions[kVertices * 3] = {0.f, 0.f,  0.f, 0.f, 1.f,  0.f,
+                                          0.f, 2.f,  0.f, 1.f, 0.f,  1.f,
+                                          1.f, 1.f, -1.f, 1.f, 2.f, -1.f};
+  const uint16_t indices[kVertices * 2] = {0, 1, 0, 1, 1, 0,
+                                           0, 1, 1, 0, 1, 0};
+  const float weights[kVertices] = {1.f, .5f, .2f, .7f, .5f, 1.f};
+  const ozz::math::Float4x4 inverse_bind_poses[2] = {
+      ozz::math::Float4x4::identity(),
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(0.f, -1.f, 0.f, 1.f))};
+  ozz::math::Box boxes[2];
+
+  // Invalid parameters.
+  EXPECT_FALSE(ozz::geometry::ComputeJointBoxes(
+      kVertices, 2, {positions, 5}, sizeof(float) * 3, indices,
+      sizeof(uint16_t) * 2, weights, sizeof(float), inverse_bind_poses,
+      boxes));
+  EXPECT_FALSE(ozz::geometry::ComputeJointBoxes(
+      kVertices, 2, positions, sizeof(float) * 3, indices,
+      sizeof(uint16_t) * 2, weights, sizeof(float), inverse_bind_poses,
+      {boxes, 1}));
+  const uint16_t out_of_range[kVertices * 2] = {2, 0};
+  EXPECT_FALSE(ozz::geometry::ComputeJointBoxes(
+      kVertices, 2, positions, sizeof(float) * 3, out_of_range,
+      sizeof(uint16_t) * 2, weights, sizeof(float), inverse_bind_poses,
+      boxes));
+
+  ASSERT_TRUE(ozz::geometry::ComputeJointBoxes(
+      kVertices, 2, positions, sizeof(float) * 3, indices,
+      sizeof(uint16_t) * 2, weights, sizeof(float), inverse_bind_poses,
+      boxes));
+
+  // First vertex only influences joint 0, last one only joint 1.
+  EXPECT_FLOAT3_EQ(boxes[0].min, 0.f, 0.f, -1.f);
+  EXPECT_FLOAT3_EQ(boxes[0].max, 1.f, 2.f, 1.f);
+  EXPECT_FLOAT3_EQ(boxes[1].min, 0.f, -1.f, -1.f);
+  EXPECT_FLOAT3_EQ(boxes[1].max, 1.f, 1.f, 1.f);
+
+  // Poses the mesh and compares with brute force skinning.
+  const ozz::math::Float4x4 matrices[2] = {
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(3.f, 0.f, 0.f, 1.f)),
+      ozz::math::Float4x4::FromAffine(
+          ozz::math::simd_float4::Load(3.f, 1.f, 0.f, 1.f),
+          ozz::math::simd_float4::Load(.38268343f, 0.f, 0.f, .92387953f),
+          ozz::math::simd_float4::one())};
+
+  ozz::math::Box bound;
+  SkinnedBoundsJob job;
+  job.joint_boxes = boxes;
+  job.joint_matrices = matrices;
+  job.bound = &bound;
+  ASSERT_TRUE(job.Run());
+  ASSERT_TRUE(bound.is_valid());
+
+  for (int i = 0; i < kVertices; ++i) {
+    const ozz::math::SimdFloat4 position =
+        ozz::math::simd_float4::Load3PtrU(positions + i * 3);
+    const float weight = weights[i];
+    const ozz::math::SimdFloat4 skinned =
+        ozz::math::TransformPoint(
+            matrices[indices[i * 2]] * inverse_bind_poses[indices[i * 2]],
+            position) *
+            ozz::math::simd_float4::Load1(weight) +
+        ozz::math::TransformPoint(matrices[indices[i * 2 + 1]] *
+                                      inverse_bind_poses[indices[i * 2 + 1]],
+                                  position) *
+            ozz::math::simd_float4::Load1(1.f - weight);
+    ozz::math::Float3 vertex;
+    ozz::math::Store3PtrU(skinned, &vertex.x);
+    EXPECT_TRUE(bound.is_inside(vertex));
+  }
+}
@@ -25,13 +25,22 @@
 //                                                                            //
 //----------------------------------------------------------------------------//
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "ozz/base/containers/vector.h"
+#include "ozz/base/gtest_parallel_for_helper.h"
 #include "ozz/base/log.h"
 #include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/simd_dual_quaternion.h"
+#include "ozz/base/maths/simd_float3x4.h"
 #include "ozz/base/maths/simd_math.h"
+#include "ozz/geometry/runtime/morph_job.h"
 #include "ozz/geometry/runtime/skinning_job.h"
 
+using ozz::geometry::MorphJob;
+using ozz::geometry::MorphTarget;
 using ozz::geometry::SkinningJob;
 
 TEST(JobValidity, SkinningJob) {
@@ -1101,6 +1110,771 @@ struct BenchVertexOut {
   float tangents[3];
 };
 
+TEST(AffineResult, SkinningJob) {
+  const ozz::math::Float4x4 matrices[4] = {
+      ozz::math::Float4x4::FromAffine(
+          ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f),
+          ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, .70710677f),
+          ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(-1.f, 2.f, 3.f, 0.f)),
+      ozz::math::Float4x4::Scaling(
+          ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+      ozz::math::Float4x4::FromAffine(
+          ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 0.f),
+          ozz::math::simd_float4::Load(.5f, .5f, .5f, .5f),
+          ozz::math::simd_float4::Load(.5f, 1.f, 1.5f, 0.f))};
+  ozz::math::Float4x4 it_matrices[4];
+  ozz::math::Float3x4 affine_matrices[4];
+  ozz::math::Float3x4 affine_it_matrices[4];
+  for (int i = 0; i < 4; ++i) {
+    it_matrices[i] = Transpose(Invert(matrices[i]));
+    affine_matrices[i] = ozz::math::Float3x4::FromFloat4x4(matrices[i]);
+    affine_it_matrices[i] = ozz::math::Float3x4::FromFloat4x4(it_matrices[i]);
+  }
+  uint16_t joint_indices[10] = {0, 1, 2, 3, 0, 3, 2, 1, 0, 3};
+  float joint_weights[8] = {.5f, .25f, .125f, .1f, .1f, .25f, .2f, .15f};
+  float in_positions[6] = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f};
+  float in_normals[6] = {.1f, .2f, .3f, .4f, .5f, .6f};
+  float in_tangents[6] = {.01f, .02f, .03f, .04f, .05f, .06f};
+
+  SkinningJob job;
+  job.vertex_count = 2;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t) * 5;
+  job.joint_weights = joint_weights;
+  job.joint_weights_stride = sizeof(float) * 4;
+  job.in_positions = in_positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.in_normals = in_normals;
+  job.in_normals_stride = sizeof(float) * 3;
+  job.in_tangents = in_tangents;
+  job.in_tangents_stride = sizeof(float) * 3;
+  job.out_positions_stride = sizeof(float) * 3;
+  job.out_normals_stride = sizeof(float) * 3;
+  job.out_tangents_stride = sizeof(float) * 3;
+
+  // Affine and inverse transpose matrices types can't be mixed.
+  job.influences_count = 1;
+  job.joint_affine_matrices = affine_matrices;
+  job.joint_inverse_transpose_matrices = it_matrices;
+  EXPECT_FALSE(job.Validate());
+  job.joint_matrices = matrices;
+  job.joint_inverse_transpose_matrices = {};
+  EXPECT_FALSE(job.Validate());
+
+  // Affine matrices must output the same result as Float4x4 ones, for all
+  // influences count and with or without inverse transpose matrices.
+  for (int it = 0; it < 2; ++it) {
+    for (int inf = 1; inf <= 5; ++inf) {
+      float positions[2][6], normals[2][6], tangents[2][6];
+      job.influences_count = inf;
+
+      job.joint_matrices = matrices;
+      job.joint_inverse_transpose_matrices =
+          it ? ozz::span<const ozz::math::Float4x4>(it_matrices)
+             : ozz::span<const ozz::math::Float4x4>();
+      job.joint_affine_matrices = {};
+      job.joint_affine_inverse_transpose_matrices = {};
+      job.out_positions = positions[0];
+      job.out_normals = normals[0];
+      job.out_tangents = tangents[0];
+      ASSERT_TRUE(job.Run());
+
+      job.joint_matrices = {};
+      job.joint_inverse_transpose_matrices = {};
+      job.joint_affine_matrices = affine_matrices;
+      job.joint_affine_inverse_transpose_matrices =
+          it ? ozz::span<const ozz::math::Float3x4>(affine_it_matrices)
+             : ozz::span<const ozz::math::Float3x4>();
+      job.out_positions = positions[1];
+      job.out_normals = normals[1];
+      job.out_tangents = tangents[1];
+      ASSERT_TRUE(job.Run());
+
+      for (int i = 0; i < 6; ++i) {
+        EXPECT_NEAR(positions[0][i], positions[1][i], 1e-5f);
+        EXPECT_NEAR(normals[0][i], normals[1][i], 1e-5f);
+        EXPECT_NEAR(tangents[0][i], tangents[1][i], 1e-5f);
+      }
+    }
+  }
+}
+
+TEST(DualQuaternionResult, SkinningJob) {
+  const ozz::math::SimdFloat4 translation =
+      ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f);
+  const ozz::math::SimdQuaternion rotation =
+      ozz::math::SimdQuaternion::FromAxisAngle(
+          ozz::math::simd_float4::z_axis(),
+          ozz::math::simd_float4::Load1(ozz::math::kPi_2));
+  const ozz::math::DualQuaternion dqs[3] = {
+      ozz::math::DualQuaternion::FromAffine(
+          translation, ozz::math::SimdQuaternion::identity()),
+      ozz::math::DualQuaternion::FromAffine(translation, rotation),
+      // Same transformation as dqs[1], but in the opposite hemisphere.
+      ozz::math::DualQuaternion::FromAffine(translation, -rotation)};
+  const ozz::math::Float4x4 matrices[1] = {ozz::math::Float4x4::FromAffine(
+      translation, rotation.xyzw, ozz::math::simd_float4::one())};
+  uint16_t joint_indices[10] = {1, 0, 2, 1, 1, 1, 0, 2, 1, 1};
+  float joint_weights[8] = {.5f, .5f, 0.f, 0.f, .5f, .5f, 0.f, 0.f};
+  float in_positions[6] = {1.f, 0.f, 0.f, 0.f, 1.f, 0.f};
+  float in_normals[6] = {1.f, 0.f, 0.f, 0.f, 1.f, 0.f};
+  float out_positions[6];
+  float out_normals[6];
+
+  SkinningJob job;
+  job.vertex_count = 2;
+  job.influences_count = 1;
+  job.joint_dual_quaternions = dqs;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t) * 5;
+  job.joint_weights = joint_weights;
+  job.joint_weights_stride = sizeof(float) * 4;
+  job.in_positions = in_positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.in_normals = in_normals;
+  job.in_normals_stride = sizeof(float) * 3;
+  job.out_positions = out_positions;
+  job.out_positions_stride = sizeof(float) * 3;
+  job.out_normals = out_normals;
+  job.out_normals_stride = sizeof(float) * 3;
+
+  // Dual quaternions can't be mixed with matrices.
+  job.joint_matrices = matrices;
+  EXPECT_FALSE(job.Validate());
+  job.joint_matrices = {};
+  job.joint_inverse_transpose_matrices = matrices;
+  EXPECT_FALSE(job.Validate());
+  job.joint_inverse_transpose_matrices = {};
+  EXPECT_TRUE(job.Validate());
+
+  {  // 1 influence matches matrix skinning.
+    EXPECT_TRUE(job.Run());
+    EXPECT_NEAR(1.f, out_positions[0], 1e-5f);
+    EXPECT_NEAR(3.f, out_positions[1], 1e-5f);
+    EXPECT_NEAR(3.f, out_positions[2], 1e-5f);
+    EXPECT_NEAR(0.f, out_normals[0], 1e-5f);
+    EXPECT_NEAR(1.f, out_normals[1], 1e-5f);
+    EXPECT_NEAR(0.f, out_normals[2], 1e-5f);
+    EXPECT_NEAR(0.f, out_positions[3], 1e-5f);
+    EXPECT_NEAR(2.f, out_positions[4], 1e-5f);
+    EXPECT_NEAR(3.f, out_positions[5], 1e-5f);
+  }
+
+  // Blending a rotation of 0 and 90 degrees rotates by 45 degrees, without
+  // shrinking. This is the same for all influences count, whatever the
+  // hemisphere of the blended dual quaternions.
+  for (int inf = 2; inf <= 5; ++inf) {
+    job.influences_count = inf;
+    EXPECT_TRUE(job.Run());
+    EXPECT_NEAR(1.f + .70710677f, out_positions[0], 1e-5f);
+    EXPECT_NEAR(2.f + .70710677f, out_positions[1], 1e-5f);
+    EXPECT_NEAR(3.f, out_positions[2], 1e-5f);
+    EXPECT_NEAR(.70710677f, out_normals[0], 1e-5f);
+    EXPECT_NEAR(.70710677f, out_normals[1], 1e-5f);
+    EXPECT_NEAR(0.f, out_normals[2], 1e-5f);
+    EXPECT_NEAR(1.f - .70710677f, out_positions[3], 1e-5f);
+    EXPECT_NEAR(2.f + .70710677f, out_positions[4], 1e-5f);
+    EXPECT_NEAR(3.f, out_positions[5], 1e-5f);
+    EXPECT_NEAR(-.70710677f, out_normals[3], 1e-5f);
+    EXPECT_NEAR(.70710677f, out_normals[4], 1e-5f);
+    EXPECT_NEAR(0.f, out_normals[5], 1e-5f);
+  }
+}
+
+TEST(ManyVertices, SkinningJob) {
+  // Enough vertices to exercise vectorized paths, which process multiple
+  // vertices at once, as well as their remainder.
+  const int kVertices = 11;
+  const int kMaxInfluences = 6;
+  const int kJoints = 5;
+  ozz::math::Float4x4 matrices[kJoints];
+  ozz::math::Float4x4 it_matrices[kJoints];
+  for (int i = 0; i < kJoints; ++i) {
+    const float fi = static_cast<float>(i);
+    matrices[i] = ozz::math::Float4x4::FromAffine(
+        ozz::math::simd_float4::Load(fi, -fi, 2.f * fi, 0.f),
+        ozz::math::SimdQuaternion::FromAxisAngle(
+            ozz::math::simd_float4::y_axis(),
+            ozz::math::simd_float4::Load1(fi * .3f))
+            .xyzw,
+        ozz::math::simd_float4::Load(1.f + fi, 1.f, 2.f, 0.f));
+    it_matrices[i] = Transpose(Invert(matrices[i]));
+  }
+  uint16_t joint_indices[kVertices][kMaxInfluences];
+  float joint_weights[kVertices][kMaxInfluences];
+  float in_vertices[kVertices][3];
+  for (int v = 0; v < kVertices; ++v) {
+    for (int j = 0; j < kMaxInfluences; ++j) {
+      joint_indices[v][j] = static_cast<uint16_t>((v + j * 3) % kJoints);
+      joint_weights[v][j] = .1f + .02f * ((v + j) % 3);
+    }
+    for (int c = 0; c < 3; ++c) {
+      in_vertices[v][c] = static_cast<float>(v * 3 + c) * .1f - 1.f;
+    }
+  }
+
+  for (int it = 0; it < 2; ++it) {
+    for (int inf = 1; inf <= kMaxInfluences; ++inf) {
+      float out_positions[kVertices][3];
+      float out_normals[kVertices][3];
+      float out_tangents[kVertices][3];
+
+      SkinningJob job;
+      job.vertex_count = kVertices;
+      job.influences_count = inf;
+      job.joint_matrices = matrices;
+      if (it) {
+        job.joint_inverse_transpose_matrices = it_matrices;
+      }
+      job.joint_indices = {joint_indices[0], kVertices * kMaxInfluences};
+      job.joint_indices_stride = sizeof(joint_indices[0]);
+      job.joint_weights = {joint_weights[0], kVertices * kMaxInfluences};
+      job.joint_weights_stride = sizeof(joint_weights[0]);
+      job.in_positions = {in_vertices[0], kVertices * 3};
+      job.in_positions_stride = sizeof(in_vertices[0]);
+      job.in_normals = job.in_positions;
+      job.in_normals_stride = sizeof(in_vertices[0]);
+      job.in_tangents = job.in_positions;
+      job.in_tangents_stride = sizeof(in_vertices[0]);
+      job.out_positions = {out_positions[0], kVertices * 3};
+      job.out_positions_stride = sizeof(out_positions[0]);
+      job.out_normals = {out_normals[0], kVertices * 3};
+      job.out_normals_stride = sizeof(out_normals[0]);
+      job.out_tangents = {out_tangents[0], kVertices * 3};
+      job.out_tangents_stride = sizeof(out_tangents[0]);
+      ASSERT_TRUE(job.Run());
+
+      // Compares with the reference linear blend skinning.
+      for (int v = 0; v < kVertices; ++v) {
+        ozz::math::Float4x4 m = {};
+        ozz::math::Float4x4 mit = {};
+        float wsum = 0.f;
+        for (int j = 0; j < inf; ++j) {
+          const float w = j == inf - 1 ? 1.f - wsum : joint_weights[v][j];
+          wsum += w;
+          const ozz::math::SimdFloat4 w4 = ozz::math::simd_float4::Load1(w);
+          m = m + ColumnMultiply(matrices[joint_indices[v][j]], w4);
+          mit = mit + ColumnMultiply(it_matrices[joint_indices[v][j]], w4);
+        }
+        const ozz::math::SimdFloat4 in = ozz::math::simd_float4::Load(
+            in_vertices[v][0], in_vertices[v][1], in_vertices[v][2], 0.f);
+        const ozz::math::SimdFloat4 p = TransformPoint(m, in);
+        const ozz::math::SimdFloat4 n = TransformVector(it ? mit : m, in);
+        EXPECT_NEAR(out_positions[v][0], ozz::math::GetX(p), 1e-4f);
+        EXPECT_NEAR(out_positions[v][1], ozz::math::GetY(p), 1e-4f);
+        EXPECT_NEAR(out_positions[v][2], ozz::math::GetZ(p), 1e-4f);
+        EXPECT_NEAR(out_normals[v][0], ozz::math::GetX(n), 1e-4f);
+        EXPECT_NEAR(out_normals[v][1], ozz::math::GetY(n), 1e-4f);
+        EXPECT_NEAR(out_normals[v][2], ozz::math::GetZ(n), 1e-4f);
+        EXPECT_NEAR(out_tangents[v][0], ozz::math::GetX(n), 1e-4f);
+        EXPECT_NEAR(out_tangents[v][1], ozz::math::GetY(n), 1e-4f);
+        EXPECT_NEAR(out_tangents[v][2], ozz::math::GetZ(n), 1e-4f);
+      }
+
+      // Streaming stores output the same vertices.
+      float streamed_positions[kVertices][3];
+      float streamed_normals[kVertices][3];
+      float streamed_tangents[kVertices][3];
+      job.streaming_output = true;
+      job.out_positions = {streamed_positions[0], kVertices * 3};
+      job.out_normals = {streamed_normals[0], kVertices * 3};
+      job.out_tangents = {streamed_tangents[0], kVertices * 3};
+      ASSERT_TRUE(job.Run());
+      EXPECT_EQ(std::memcmp(out_positions, streamed_positions,
+                            sizeof(out_positions)),
+                0);
+      EXPECT_EQ(
+          std::memcmp(out_normals, streamed_normals, sizeof(out_normals)), 0);
+      EXPECT_EQ(
+          std::memcmp(out_tangents, streamed_tangents, sizeof(out_tangents)),
+          0);
+
+      // Validated plan outputs the same vertices.
+      const ozz::JobPlan<SkinningJob> plan(job);
+      ASSERT_TRUE(plan.valid());
+      std::memset(streamed_positions, 0, sizeof(streamed_positions));
+      std::memset(streamed_normals, 0, sizeof(streamed_normals));
+      std::memset(streamed_tangents, 0, sizeof(streamed_tangents));
+      EXPECT_TRUE(plan.Execute());
+      EXPECT_EQ(std::memcmp(out_positions, streamed_positions,
+                            sizeof(out_positions)),
+                0);
+      EXPECT_EQ(
+          std::memcmp(out_normals, streamed_normals, sizeof(out_normals)), 0);
+      EXPECT_EQ(
+          std::memcmp(out_tangents, streamed_tangents, sizeof(out_tangents)),
+          0);
+    }
+  }
+}
+
+namespace {
+// Encodes unit vector _v to octahedral snorm16 _out.
+void EncodeOctahedral(const float* _v, int16_t* _out) {
+  const float l1 = std::abs(_v[0]) + std::abs(_v[1]) + std::abs(_v[2]);
+  float x = _v[0] / l1;
+  float y = _v[1] / l1;
+  if (_v[2] < 0.f) {
+    const float fx = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+    const float fy = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+    x = fx;
+    y = fy;
+  }
+  _out[0] = static_cast<int16_t>(std::floor(x * 32767.f + .5f));
+  _out[1] = static_cast<int16_t>(std::floor(y * 32767.f + .5f));
+}
+
+// Interleaved compressed vertex.
+struct CompressedVertex {
+  uint16_t position[3];
+  int16_t normal[2];
+  int16_t tangent[2];
+  uint8_t indices[5];
+  uint8_t weights[4];
+};
+}  // namespace
+
+TEST(Compressed, SkinningJob) {
+  // More vertices than a decoding chunk.
+  const int kVertices = 150;
+  const int kMaxInfluences = 5;
+  const int kJoints = 7;
+  ozz::math::Float4x4 matrices[kJoints];
+  ozz::math::Float4x4 it_matrices[kJoints];
+  for (int i = 0; i < kJoints; ++i) {
+    const float fi = static_cast<float>(i);
+    matrices[i] = ozz::math::Float4x4::FromAffine(
+        ozz::math::simd_float4::Load(fi, -fi, 2.f * fi, 0.f),
+        ozz::math::SimdQuaternion::FromAxisAngle(
+            ozz::math::simd_float4::x_axis(),
+            ozz::math::simd_float4::Load1(fi * .4f))
+            .xyzw,
+        ozz::math::simd_float4::Load(1.f + fi, 1.f, 2.f, 0.f));
+    it_matrices[i] = Transpose(Invert(matrices[i]));
+  }
+
+  // Builds compressed vertices, and the matching float ones.
+  CompressedVertex compressed[kVertices];
+  uint16_t joint_indices[kVertices][kMaxInfluences];
+  float joint_weights[kVertices][kMaxInfluences - 1];
+  float positions[kVertices][3];
+  float normals[kVertices][3];
+  float tangents[kVertices][3];
+  for (int v = 0; v < kVertices; ++v) {
+    CompressedVertex& cv = compressed[v];
+    for (int j = 0; j < kMaxInfluences; ++j) {
+      cv.indices[j] = static_cast<uint8_t>((v + j * 3) % kJoints);
+      joint_indices[v][j] = cv.indices[j];
+    }
+    for (int j = 0; j < kMaxInfluences - 1; ++j) {
+      cv.weights[j] = static_cast<uint8_t>(20 + (v * 7 + j * 13) % 40);
+      joint_weights[v][j] = cv.weights[j] / 255.f;
+    }
+    const float fv = static_cast<float>(v);
+    const float normal[3] = {std::cos(fv * .7f) * std::sin(fv * .3f),
+                             std::sin(fv * .7f) * std::sin(fv * .3f),
+                             std::cos(fv * .3f)};
+    for (int c = 0; c < 3; ++c) {
+      cv.position[c] = ozz::math::FloatToHalf(fv * .01f * (c + 1) - .5f);
+      positions[v][c] = ozz::math::HalfToFloat(cv.position[c]);
+      normals[v][c] = normal[c];
+    }
+    EncodeOctahedral(normals[v], cv.normal);
+    tangents[v][0] = -normal[1];
+    tangents[v][1] = normal[0];
+    tangents[v][2] = normal[2];
+    EncodeOctahedral(tangents[v], cv.tangent);
+  }
+
+  for (int it = 0; it < 2; ++it) {
+    for (int inf = 1; inf <= kMaxInfluences; ++inf) {
+      float expected[kVertices][9];
+      float out[kVertices][9];
+
+      SkinningJob job;
+      job.vertex_count = kVertices;
+      job.influences_count = inf;
+      job.joint_matrices = matrices;
+      if (it) {
+        job.joint_inverse_transpose_matrices = it_matrices;
+      }
+      job.out_positions = {&expected[0][0], kVertices * 9};
+      job.out_positions_stride = sizeof(expected[0]);
+      job.out_normals = {&expected[0][3], kVertices * 9 - 3};
+      job.out_normals_stride = sizeof(expected[0]);
+      job.out_tangents = {&expected[0][6], kVertices * 9 - 6};
+      job.out_tangents_stride = sizeof(expected[0]);
+
+      // Float reference.
+      job.joint_indices = {joint_indices[0], kVertices * kMaxInfluences};
+      job.joint_indices_stride = sizeof(joint_indices[0]);
+      job.joint_weights = {joint_weights[0], kVertices * (kMaxInfluences - 1)};
+      job.joint_weights_stride = sizeof(joint_weights[0]);
+      job.in_positions = {positions[0], kVertices * 3};
+      job.in_positions_stride = sizeof(positions[0]);
+      job.in_normals = {normals[0], kVertices * 3};
+      job.in_normals_stride = sizeof(normals[0]);
+      job.in_tangents = {tangents[0], kVertices * 3};
+      job.in_tangents_stride = sizeof(tangents[0]);
+      ASSERT_TRUE(job.Run());
+
+      // Both formats can't be used for the same input.
+      job.in_half_positions = {compressed[0].position,
+                               kVertices * sizeof(CompressedVertex) / 2};
+      EXPECT_FALSE(job.Validate());
+
+      // Compressed job.
+      job.joint_indices = {};
+      job.joint_weights = {};
+      job.in_positions = {};
+      job.in_normals = {};
+      job.in_tangents = {};
+      job.joint_indices8 = {compressed[0].indices,
+                            kVertices * sizeof(CompressedVertex)};
+      job.joint_indices_stride = sizeof(CompressedVertex);
+      job.joint_weights8 = {compressed[0].weights,
+                            kVertices * sizeof(CompressedVertex)};
+      job.joint_weights_stride = sizeof(CompressedVertex);
+      job.in_positions_stride = sizeof(CompressedVertex);
+      job.in_oct_normals = {compressed[0].normal,
+                            kVertices * sizeof(CompressedVertex) / 2};
+      job.in_normals_stride = sizeof(CompressedVertex);
+      job.in_oct_tangents = {compressed[0].tangent,
+                             kVertices * sizeof(CompressedVertex) / 2};
+      job.in_tangents_stride = sizeof(CompressedVertex);
+      job.out_positions = {&out[0][0], kVertices * 9};
+      job.out_positions_stride = sizeof(out[0]);
+      job.out_normals = {&out[0][3], kVertices * 9 - 3};
+      job.out_normals_stride = sizeof(out[0]);
+      job.out_tangents = {&out[0][6], kVertices * 9 - 6};
+      job.out_tangents_stride = sizeof(out[0]);
+      ASSERT_TRUE(job.Run());
+
+      for (int v = 0; v < kVertices; ++v) {
+        for (int c = 0; c < 3; ++c) {
+          EXPECT_NEAR(out[v][c], expected[v][c], 1e-4f);
+          EXPECT_NEAR(out[v][3 + c], expected[v][3 + c], 2e-3f);
+          EXPECT_NEAR(out[v][6 + c], expected[v][6 + c], 2e-3f);
+        }
+      }
+
+      // Compressed indices and weights are limited in influences count.
+      job.vertex_count = 1;
+      job.influences_count = SkinningJob::kMaxCompressedInfluences;
+      EXPECT_TRUE(job.Validate());
+      job.influences_count = SkinningJob::kMaxCompressedInfluences + 1;
+      EXPECT_FALSE(job.Validate());
+    }
+  }
+}
+
+TEST(Remap, SkinningJob) {
+  // More vertices than a decoding chunk.
+  const int kVertices = 150;
+  const int kInfluences = 3;
+  const int kJoints = 5;
+  ozz::math::Float4x4 matrices[kJoints];
+  for (int i = 0; i < kJoints; ++i) {
+    const float fi = static_cast<float>(i);
+    matrices[i] = ozz::math::Float4x4::FromAffine(
+        ozz::math::simd_float4::Load(fi, -fi, 2.f * fi, 0.f),
+        ozz::math::SimdQuaternion::FromAxisAngle(
+            ozz::math::simd_float4::y_axis(),
+            ozz::math::simd_float4::Load1(fi * .3f))
+            .xyzw,
+        ozz::math::simd_float4::Load(1.f + fi, 1.f, 1.f, 0.f));
+  }
+
+  // Joints 1 and 3 are redirected to 0 and 2.
+  const uint16_t remaps[kJoints] = {0, 0, 2, 2, 4};
+
+  uint16_t joint_indices[kVertices][kInfluences];
+  uint8_t joint_indices8[kVertices][kInfluences];
+  uint16_t remapped_indices[kVertices][kInfluences];
+  float joint_weights[kVertices][kInfluences - 1];
+  float positions[kVertices][3];
+  for (int v = 0; v < kVertices; ++v) {
+    for (int j = 0; j < kInfluences; ++j) {
+      joint_indices[v][j] = static_cast<uint16_t>((v + j * 2) % kJoints);
+      joint_indices8[v][j] = static_cast<uint8_t>(joint_indices[v][j]);
+      remapped_indices[v][j] = remaps[joint_indices[v][j]];
+    }
+    for (int j = 0; j < kInfluences - 1; ++j) {
+      joint_weights[v][j] = .1f + .1f * j;
+    }
+    for (int c = 0; c < 3; ++c) {
+      positions[v][c] = v * .01f * (c + 1) - .5f;
+    }
+  }
+
+  float expected[kVertices][3];
+  float out[kVertices][3];
+
+  SkinningJob job;
+  job.vertex_count = kVertices;
+  job.influences_count = kInfluences;
+  job.joint_matrices = matrices;
+  job.joint_weights = {joint_weights[0], kVertices * (kInfluences - 1)};
+  job.joint_weights_stride = sizeof(joint_weights[0]);
+  job.in_positions = {positions[0], kVertices * 3};
+  job.in_positions_stride = sizeof(positions[0]);
+  job.out_positions_stride = sizeof(expected[0]);
+
+  // Reference, with remapped indices.
+  job.joint_indices = {remapped_indices[0], kVertices * kInfluences};
+  job.joint_indices_stride = sizeof(remapped_indices[0]);
+  job.out_positions = {expected[0], kVertices * 3};
+  ASSERT_TRUE(job.Run());
+
+  // Remapped by the job.
+  job.joint_indices = {joint_indices[0], kVertices * kInfluences};
+  job.joint_indices_stride = sizeof(joint_indices[0]);
+  job.joint_remaps = remaps;
+  job.out_positions = {out[0], kVertices * 3};
+  ASSERT_TRUE(job.Run());
+  for (int v = 0; v < kVertices; ++v) {
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_FLOAT_EQ(out[v][c], expected[v][c]);
+    }
+  }
+
+  // Remapped 8 bits indices.
+  job.joint_indices = {};
+  job.joint_indices8 = {joint_indices8[0], kVertices * kInfluences};
+  job.joint_indices_stride = sizeof(joint_indices8[0]);
+  ASSERT_TRUE(job.Run());
+  for (int v = 0; v < kVertices; ++v) {
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_FLOAT_EQ(out[v][c], expected[v][c]);
+    }
+  }
+
+  // Remapped indices are limited in influences count.
+  job.vertex_count = 1;
+  job.influences_count = SkinningJob::kMaxCompressedInfluences + 1;
+  EXPECT_FALSE(job.Validate());
+}
+
+TEST(Range, SkinningJob) {
+  const int kVertices = 13;
+  const ozz::math::Float4x4 matrices[2] = {
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+      ozz::math::Float4x4::Scaling(
+          ozz::math::simd_float4::Load(2.f, 3.f, 4.f, 0.f))};
+  uint16_t joint_indices[kVertices * 2];
+  float joint_weights[kVertices];
+  float in_vertices[kVertices * 4];
+  for (int v = 0; v < kVertices; ++v) {
+    joint_indices[v * 2 + 0] = static_cast<uint16_t>(v & 1);
+    joint_indices[v * 2 + 1] = static_cast<uint16_t>(!(v & 1));
+    joint_weights[v] = .1f * (v % 10);
+    for (int c = 0; c < 4; ++c) {
+      in_vertices[v * 4 + c] = static_cast<float>(v + c);
+    }
+  }
+
+  SkinningJob job;
+  job.vertex_count = kVertices;
+  job.influences_count = 2;
+  job.joint_matrices = matrices;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t) * 2;
+  job.joint_weights = joint_weights;
+  job.joint_weights_stride = sizeof(float);
+  job.in_positions = {in_vertices, kVertices * 4 - 1};
+  job.in_positions_stride = sizeof(float) * 4;
+  job.in_normals = {in_vertices + 1, kVertices * 4 - 1};
+  job.in_normals_stride = sizeof(float) * 4;
+
+  // Reference.
+  float expected[kVertices * 6];
+  job.out_positions = {expected, kVertices * 6 - 3};
+  job.out_positions_stride = sizeof(float) * 6;
+  job.out_normals = {expected + 3, kVertices * 6 - 3};
+  job.out_normals_stride = sizeof(float) * 6;
+  ASSERT_TRUE(job.Run());
+
+  {  // Skins by ranges, including empty and clamped ones.
+    float output[kVertices * 6] = {};
+    job.out_positions = {output, kVertices * 6 - 3};
+    job.out_normals = {output + 3, kVertices * 6 - 3};
+
+    const int ranges[][2] = {{0, 0}, {0, 1}, {1, 5}, {6, 6}, {12, 10}, {13, 2}};
+    for (size_t r = 0; r < OZZ_ARRAY_SIZE(ranges); ++r) {
+      const SkinningJob range = job.Range(ranges[r][0], ranges[r][1]);
+      EXPECT_TRUE(range.Validate());
+      EXPECT_TRUE(range.Run());
+    }
+    EXPECT_EQ(job.Range(12, 10).vertex_count, 1);
+    EXPECT_EQ(job.Range(13, 2).vertex_count, 0);
+    EXPECT_EQ(job.Range(-2, 3).vertex_count, 3);
+    for (int i = 0; i < kVertices * 6; ++i) {
+      EXPECT_FLOAT_EQ(output[i], expected[i]);
+    }
+  }
+
+  {  // Skins with a task scheduler.
+    float output[kVertices * 6] = {};
+    job.out_positions = {output, kVertices * 6 - 3};
+    job.out_normals = {output + 3, kVertices * 6 - 3};
+
+    int chunks = 0;
+    job.parallel_for = &ReverseParallelFor;
+    job.parallel_for_user_data = &chunks;
+    job.parallel_grain = 0;
+    EXPECT_FALSE(job.Validate());
+    job.parallel_grain = 4;
+    EXPECT_TRUE(job.Run());
+    EXPECT_EQ(chunks, 4);
+    for (int i = 0; i < kVertices * 6; ++i) {
+      EXPECT_FLOAT_EQ(output[i], expected[i]);
+    }
+
+    // A single chunk isn't dispatched.
+    job.parallel_grain = kVertices;
+    EXPECT_TRUE(job.Run());
+    EXPECT_EQ(chunks, 4);
+  }
+}
+
+TEST(Morph, SkinningJob) {
+  const int kVertices = 150;
+  const ozz::math::Float4x4 matrices[2] = {
+      ozz::math::Float4x4::Translation(
+          ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+      ozz::math::Float4x4::Scaling(
+          ozz::math::simd_float4::Load(2.f, 3.f, 4.f, 0.f))};
+  uint16_t joint_indices[kVertices * 2];
+  float joint_weights[kVertices];
+  float in_vertices[kVertices * 6];
+  for (int v = 0; v < kVertices; ++v) {
+    joint_indices[v * 2 + 0] = static_cast<uint16_t>(v & 1);
+    joint_indices[v * 2 + 1] = static_cast<uint16_t>(!(v & 1));
+    joint_weights[v] = .1f * (v % 10);
+    for (int c = 0; c < 6; ++c) {
+      in_vertices[v * 6 + c] = static_cast<float>(v % 7 + c);
+    }
+  }
+
+  // Sparse targets, spanning many skinning chunks.
+  ozz::vector<uint32_t> indices[2];
+  ozz::vector<float> deltas[2];
+  for (uint32_t v = 0; v < kVertices; ++v) {
+    for (int t = 0; t < 2; ++t) {
+      if (v % (t + 2) == 0) {
+        indices[t].push_back(v);
+        for (int c = 0; c < 3; ++c) {
+          deltas[t].push_back((t + 1) * .1f * (c + 1));
+        }
+      }
+    }
+  }
+  MorphTarget targets[2];
+  for (int t = 0; t < 2; ++t) {
+    targets[t].indices = make_span(indices[t]);
+    targets[t].position_deltas = make_span(deltas[t]);
+    targets[t].normal_deltas = make_span(deltas[t]);
+  }
+  float weights[2] = {.7f, -1.5f};
+
+  // Reference is computed by morphing, then skinning.
+  float morphed[kVertices * 6];
+  MorphJob morph;
+  morph.vertex_count = kVertices;
+  morph.targets = targets;
+  morph.weights = weights;
+  morph.in_positions = {in_vertices, kVertices * 6 - 3};
+  morph.in_positions_stride = sizeof(float) * 6;
+  morph.in_normals = {in_vertices + 3, kVertices * 6 - 3};
+  morph.in_normals_stride = sizeof(float) * 6;
+  morph.out_positions = {morphed, kVertices * 6 - 3};
+  morph.out_positions_stride = sizeof(float) * 6;
+  morph.out_normals = {morphed + 3, kVertices * 6 - 3};
+  morph.out_normals_stride = sizeof(float) * 6;
+  ASSERT_TRUE(morph.Run());
+
+  SkinningJob job;
+  job.vertex_count = kVertices;
+  job.influences_count = 2;
+  job.joint_matrices = matrices;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t) * 2;
+  job.joint_weights = joint_weights;
+  job.joint_weights_stride = sizeof(float);
+  job.in_positions = {morphed, kVertices * 6 - 3};
+  job.in_positions_stride = sizeof(float) * 6;
+  job.in_normals = {morphed + 3, kVertices * 6 - 3};
+  job.in_normals_stride = sizeof(float) * 6;
+
+  float expected_output[kVertices * 6];
+  job.out_positions = {expected_output, kVertices * 6 - 3};
+  job.out_positions_stride = sizeof(float) * 6;
+  job.out_normals = {expected_output + 3, kVertices * 6 - 3};
+  job.out_normals_stride = sizeof(float) * 6;
+  ASSERT_TRUE(job.Run());
+
+  // Fused morphing.
+  job.in_positions = {in_vertices, kVertices * 6 - 3};
+  job.in_normals = {in_vertices + 3, kVertices * 6 - 3};
+  job.morph_targets = targets;
+  job.morph_weights = {weights, 1};
+  EXPECT_FALSE(job.Validate());
+  job.morph_weights = weights;
+  EXPECT_TRUE(job.Validate());
+
+  float output[kVertices * 6] = {};
+  job.out_positions = {output, kVertices * 6 - 3};
+  job.out_normals = {output + 3, kVertices * 6 - 3};
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < kVertices * 6; ++i) {
+    EXPECT_NEAR(output[i], expected_output[i], 1e-5f);
+  }
+
+  {  // By ranges and with a task scheduler, morph_first_vertex is offset.
+    float range_output[kVertices * 6] = {};
+    SkinningJob ranged = job;
+    ranged.out_positions = {range_output, kVertices * 6 - 3};
+    ranged.out_normals = {range_output + 3, kVertices * 6 - 3};
+    const SkinningJob first = ranged.Range(0, 71);
+    const SkinningJob second = ranged.Range(71, kVertices);
+    EXPECT_EQ(second.morph_first_vertex, 71);
+    EXPECT_TRUE(second.Run());
+    EXPECT_TRUE(first.Run());
+    for (int i = 0; i < kVertices * 6; ++i) {
+      EXPECT_NEAR(range_output[i], expected_output[i], 1e-5f);
+    }
+
+    int chunks = 0;
+    ranged.parallel_for = &ReverseParallelFor;
+    ranged.parallel_for_user_data = &chunks;
+    ranged.parallel_grain = 33;
+    std::fill(range_output, range_output + kVertices * 6, 0.f);
+    EXPECT_TRUE(ranged.Run());
+    EXPECT_EQ(chunks, 5);
+    for (int i = 0; i < kVertices * 6; ++i) {
+      EXPECT_NEAR(range_output[i], expected_output[i], 1e-5f);
+    }
+  }
+
+  {  // Null weights skip morphing.
+    float unmorphed[kVertices * 6];
+    SkinningJob reference = job;
+    reference.morph_targets = {};
+    reference.out_positions = {unmorphed, kVertices * 6 - 3};
+    reference.out_normals = {unmorphed + 3, kVertices * 6 - 3};
+    ASSERT_TRUE(reference.Run());
+
+    weights[0] = weights[1] = 0.f;
+    ASSERT_TRUE(job.Run());
+    for (int i = 0; i < kVertices * 6; ++i) {
+      EXPECT_FLOAT_EQ(output[i], unmorphed[i]);
+    }
+  }
+}
+
 TEST(Benchmark, SkinningJob) {
   const int vertex_count = 10000;
   const int joint_count = 100;